@@ -0,0 +1,135 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Benchmark.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _BENCHMARK_CPP
+#define _BENCHMARK_CPP
+
+#include "Benchmark.h"
+
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Every allocation in the program goes through these, which is how the benchmarks count them. The count is atomic because the physics
+// spreads work over the job system's threads, and their allocations count too. They're passed on to the engine as well, so each step can
+// count its own (see CountHeapAllocation).
+static std::atomic<long long> allocationCount(0);
+
+void* operator new(size_t size)
+{
+	allocationCount++;
+	CountHeapAllocation(size);
+
+	// malloc(0) is allowed to return nullptr, but new has to give back a unique pointer.
+	void* memory = malloc(size > 0 ? size : 1);
+
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory)
+{
+	free(memory);
+}
+
+void operator delete[](void* memory)
+{
+	free(memory);
+}
+
+// C++14 compilers call these instead when they know the size, so they have to go to free too rather than to the library's.
+void operator delete(void* memory, size_t)
+{
+	free(memory);
+}
+
+void operator delete[](void* memory, size_t)
+{
+	free(memory);
+}
+
+long long GetAllocationCount()
+{
+	return allocationCount.load();
+}
+
+volatile float benchmarkSink = 0.0f;
+
+BenchmarkRunner::BenchmarkRunner(const std::string& inFilter)
+{
+	filter = inFilter;
+
+	minRuns = 5;
+	minSeconds = 0.25;
+
+	printedHeader = false;
+}
+
+void BenchmarkRunner::print(const BenchmarkResult& result)
+{
+	if (!printedHeader)
+	{
+		printf("%-44s %10s %6s %12s %12s %12s\n", "benchmark", "queries", "runs", "ns/query", "iter/query", "alloc/query");
+		printedHeader = true;
+	}
+
+	// Benchmarks that don't run GJK have no iterations to show.
+	if (result.iterationsPerQuery >= 0.0)
+	{
+		printf("%-44s %10d %6d %12.2f %12.2f %12.3f\n", result.name.c_str(), result.queries, result.runs, result.nsPerQuery,
+			result.iterationsPerQuery, result.allocationsPerQuery);
+	}
+	else
+	{
+		printf("%-44s %10d %6d %12.2f %12s %12.3f\n", result.name.c_str(), result.queries, result.runs, result.nsPerQuery,
+			"-", result.allocationsPerQuery);
+	}
+
+	fflush(stdout);
+}
+
+#endif // _BENCHMARK_CPP
@@ -0,0 +1,221 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Benchmark.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _BENCHMARK_H
+#define _BENCHMARK_H
+
+#include "Clock.h"
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include <string>
+#include <vector>
+
+// The number of times the global operator new has been called since the program started (see Benchmark.cpp).
+// Taking the difference before and after some code tells you how many heap allocations it made.
+long long GetAllocationCount();
+
+// Somewhere for benchmarks to put their answers, so the compiler can't decide that nobody uses them and skip the work.
+// Add to it once per run rather than once per query, so that writing to it doesn't show up in the timings.
+extern volatile float benchmarkSink;
+
+inline void Consume(float value)
+{
+	benchmarkSink = benchmarkSink + value;
+}
+
+// A small, fast random number generator (xorshift). The standard ones are allowed to give different numbers on different compilers,
+// and every scenario has to be exactly the same on every machine and every run for the numbers to be comparable.
+class BenchmarkRandom
+{
+	unsigned int state;
+
+public:
+	BenchmarkRandom(unsigned int seed)
+	{
+		// A state of 0 would stay 0 forever.
+		state = seed != 0 ? seed : 1;
+	}
+
+	unsigned int NextInt()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		return state;
+	}
+
+	// A number in [0, 1).
+	float Next()
+	{
+		return (NextInt() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// A number in [min, max).
+	float Range(float min, float max)
+	{
+		return min + (max - min) * Next();
+	}
+
+	// A random unit length direction (uniform over the sphere).
+	glm::vec3 Direction()
+	{
+		float z = Range(-1.0f, 1.0f);
+		float angle = Range(0.0f, 6.2831853f);
+		float r = sqrtf(1.0f - z * z);
+
+		return glm::vec3(r * cosf(angle), r * sinf(angle), z);
+	}
+
+	// A random orientation.
+	glm::quat Orientation()
+	{
+		return glm::angleAxis(Range(0.0f, 6.2831853f), Direction());
+	}
+};
+
+// What one benchmark measured. Everything is per query. A "query" is whatever the benchmark does once per item (one GJK test, one support
+// call, one transform), so numbers from different benchmarks of the same kind can be compared directly.
+struct BenchmarkResult
+{
+	std::string name;
+	int queries;				// How many queries each run made.
+	int runs;					// How many times it was run (not counting the warm up).
+	double nsPerQuery;			// From the fastest run. Anything slower was slowed down by something other than the code being measured.
+	double iterationsPerQuery;	// The average number of GJK iterations, or less than 0 when the benchmark doesn't run GJK.
+	double allocationsPerQuery;	// The average number of heap allocations. Most of the core is meant to keep this at 0.
+};
+
+// Runs benchmarks, prints their results as they finish, and keeps them for anyone who wants them afterwards.
+// Each benchmark is run once to warm up the caches (and to fill them, for benchmarks that cache things between queries), and then over and
+// over until it has run at least minRuns times and for at least minSeconds in total.
+class BenchmarkRunner
+{
+	SteadyClock clock;
+
+	// Only benchmarks with this in their name are run. Empty runs everything.
+	std::string filter;
+
+	int minRuns;
+	double minSeconds;
+
+	std::vector<BenchmarkResult> results;
+
+	// Prints the column headings the first time a result is printed.
+	bool printedHeader;
+
+	void print(const BenchmarkResult& result);
+
+public:
+	BenchmarkRunner(const std::string& inFilter);
+
+	void SetMinRuns(int runs)
+	{
+		minRuns = runs;
+	}
+	void SetMinSeconds(double seconds)
+	{
+		minSeconds = seconds;
+	}
+
+	// Whether a benchmark with the given name would be run. Benchmarks with a lot of set up can check this first and skip it.
+	bool Wants(const std::string& name) const
+	{
+		return filter.empty() || name.find(filter) != std::string::npos;
+	}
+
+	// Runs one benchmark. run() makes the given number of queries and returns however many GJK iterations they took in total (or -1 if
+	// it doesn't run GJK). It has to do exactly the same work every time it's called.
+	template<typename Function>
+	void Run(const std::string& name, int queries, Function& run);
+
+	const std::vector<BenchmarkResult>& GetResults() const
+	{
+		return results;
+	}
+};
+
+template<typename Function>
+void BenchmarkRunner::Run(const std::string& name, int queries, Function& run)
+{
+	if (!Wants(name) || queries <= 0)
+	{
+		return;
+	}
+
+	BenchmarkResult result;
+	result.name = name;
+	result.queries = queries;
+	result.runs = 0;
+
+	run();
+
+	double fastest = 0.0;
+	double total = 0.0;
+	long long iterations = 0;
+	long long allocations = 0;
+
+	while (result.runs < minRuns || total < minSeconds)
+	{
+		long long allocationsBefore = GetAllocationCount();
+		double start = clock.Now();
+
+		iterations += run();
+
+		double time = clock.Now() - start;
+		allocations += GetAllocationCount() - allocationsBefore;
+
+		if (result.runs == 0 || time < fastest)
+		{
+			fastest = time;
+		}
+
+		total += time;
+		result.runs++;
+	}
+
+	double count = (double)queries * result.runs;
+
+	result.nsPerQuery = fastest * 1e9 / queries;
+	result.iterationsPerQuery = iterations >= 0 ? iterations / count : -1.0;
+	result.allocationsPerQuery = allocations / count;
+
+	print(result);
+
+	results.push_back(result);
+}
+
+#endif //_BENCHMARK_H
@@ -0,0 +1,3427 @@
+/*
+Title: GJK-3D (OBB)
+File Name: CoreBenchmarks.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CORE_BENCHMARKS_CPP
+#define _CORE_BENCHMARKS_CPP
+
+#include "CoreBenchmarks.h"
+
+#include "AABB.h"
+#include "AssetStore.h"
+#include "BodyStore.h"
+#include "CompoundShape.h"
+#include "ContactSolver.h"
+#include "ConvexDecomposition.h"
+#include "ConvexHull.h"
+#include "ContactManifold.h"
+#include "EPA.h"
+#include "GJK.h"
+#include "GJKDistance.h"
+#include "HeightField.h"
+#include "HullCache.h"
+#include "HullHierarchy.h"
+#include "JobSystem.h"
+#include "MarginGJK.h"
+#include "MeshImport.h"
+#include "MeshOptimize.h"
+#include "MeshSimplify.h"
+#include "MixedGJK.h"
+#include "ParticleCollision.h"
+#include "PointCloud.h"
+#include "QBVH.h"
+#include "SceneBenchmark.h"
+#include "SceneQuery.h"
+#include "ShapeCast.h"
+#include "ShapePairs.h"
+#include "Shapes.h"
+#include "Shapes2D.h"
+#include "SIMDSupport.h"
+#include "TimeOfImpact.h"
+#include "TransformHierarchy.h"
+#include "TriangleMesh.h"
+#include "glm\gtc\matrix_transform.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// How many pairs each box scenario tests, how many pairs of hulls, how many directions each support benchmark uses, and how many bodies
+// the transform benchmarks build. Big enough to be well over the timer's resolution, and small enough to stay in the cache, so that we
+// measure the code rather than the memory.
+static const int NUM_PAIRS = 1024;
+static const int NUM_HULL_PAIRS = 256;
+static const int NUM_DIRECTIONS = 4096;
+static const int NUM_BODIES = 4096;
+
+// How many cubes the cast benchmarks put in their scene, how many casts they make, and how far each one goes.
+static const int NUM_QUERY_CUBES = 10000;
+static const int NUM_CASTS = 256;
+static const float CAST_LENGTH = 10.0f;
+
+// The batched query benchmarks' agents, each looking around itself with a few rays (and checking a box around itself for what's near).
+static const int NUM_AGENTS = 512;
+static const int AGENT_RAYS = 8;
+
+// The particles collided against one shape at a time, and their radius.
+static const int NUM_PARTICLES = 16384;
+static const float PARTICLE_RADIUS = 0.05f;
+
+// Short names for the broadphases (the same ones --scene takes), so the benchmark names are easy to filter on.
+static const char* BROADPHASE_NAMES[PhysicsWorld::NUM_BROADPHASES] = { "tree", "sap", "grid", "lbvh" };
+
+// Every box is a unit cube, like the ones in the demo.
+static const glm::vec3 CUBE_HALF_EXTENTS = glm::vec3(0.5f);
+
+// Whether GJK starts each query from scratch, or from where the last query of the same pair (or of one pair moving over time) ended.
+enum CacheMode
+{
+	CACHE_NONE,		// No cache. Every query is a cold start.
+	CACHE_PER_PAIR,	// One cache per pair. After the warm up, each query starts from its own last answer.
+	CACHE_SHARED	// One cache for every query. For when the pairs are the frames of one pair moving, in order.
+};
+
+static const char* cacheModeName(CacheMode mode)
+{
+	switch (mode)
+	{
+	case CACHE_PER_PAIR:
+		return "cached";
+	case CACHE_SHARED:
+		return "coherent";
+	case CACHE_NONE:
+	default:
+		return "cold";
+	}
+}
+
+// Builds the world space box of a unit cube at the given position and orientation.
+static OBBShape makeBox(const glm::vec3& position, const glm::quat& orientation, const glm::vec3& halfExtents = CUBE_HALF_EXTENTS)
+{
+	glm::mat4 transform = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(orientation);
+
+	return OBBShape(transform, glm::vec3(0.0f), halfExtents);
+}
+
+// The 8 corners of a box, for the original OBB support function.
+static OBB makeCorners(const OBBShape& box)
+{
+	OBB obb;
+
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner = box.center;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float sign = (i & (1 << axis)) ? 1.0f : -1.0f;
+			corner += box.axes[axis] * (box.halfExtents[axis] * sign);
+		}
+
+		obb.corners[i] = corner;
+	}
+
+	return obb;
+}
+
+// Runs GJK over every pair (a[i], b[i]) once per query, with the given solver (anything with TestGJK and GetIterations, like GJKSolver or
+// MixedGJKSolver).
+template<typename Solver, typename ShapeA, typename ShapeB>
+static void runPairsWith(BenchmarkRunner& runner, Solver& solver, const std::string& name, const std::vector<ShapeA>& a, const std::vector<ShapeB>& b,
+	CacheMode mode)
+{
+	std::string fullName = name + "/" + cacheModeName(mode);
+
+	if (!runner.Wants(fullName))
+	{
+		return;
+	}
+
+	std::vector<GJKCache> caches(mode == CACHE_PER_PAIR ? a.size() : 1);
+
+	auto run = [&]() -> long long
+	{
+		long long iterations = 0;
+		int hits = 0;
+
+		for (int i = 0; i < (int)a.size(); i++)
+		{
+			GJKCache* cache = nullptr;
+
+			if (mode == CACHE_PER_PAIR)
+			{
+				cache = &caches[i];
+			}
+			else if (mode == CACHE_SHARED)
+			{
+				cache = &caches[0];
+			}
+
+			if (solver.TestGJK(a[i], b[i], cache))
+			{
+				hits++;
+			}
+
+			iterations += solver.GetIterations();
+		}
+
+		Consume((float)hits);
+
+		return iterations;
+	};
+
+	runner.Run(fullName, (int)a.size(), run);
+}
+
+// The same with a plain GJKSolver, which is what most of the benchmarks use.
+template<typename ShapeA, typename ShapeB>
+static void runPairs(BenchmarkRunner& runner, const std::string& name, const std::vector<ShapeA>& a, const std::vector<ShapeB>& b, CacheMode mode)
+{
+	GJKSolver solver;
+
+	runPairsWith(runner, solver, name, a, b, mode);
+}
+
+// The same as runPairs for boxes, but through GJKSolver::TestGJKBatch, so the first support point of each pair is found several pairs at a time.
+static void runBatchPairs(BenchmarkRunner& runner, const std::string& name, const std::vector<OBBShape>& a, const std::vector<OBBShape>& b,
+	CacheMode mode)
+{
+	std::string fullName = name + "/" + cacheModeName(mode);
+
+	if (!runner.Wants(fullName))
+	{
+		return;
+	}
+
+	GJKSolver solver;
+	GJKStats stats;
+	solver.SetStats(&stats);
+
+	std::vector<GJKCache> caches(a.size());
+	std::vector<const OBBShape*> shapesA(a.size());
+	std::vector<const OBBShape*> shapesB(b.size());
+	std::vector<GJKCache*> cachePointers(a.size());
+	std::vector<unsigned char> colliding(a.size());
+
+	for (int i = 0; i < (int)a.size(); i++)
+	{
+		shapesA[i] = &a[i];
+		shapesB[i] = &b[i];
+		cachePointers[i] = &caches[i];
+	}
+
+	auto run = [&]() -> long long
+	{
+		stats.Reset();
+
+		solver.TestGJKBatch(shapesA.data(), shapesB.data(), (int)a.size(), colliding.data(), mode == CACHE_PER_PAIR ? cachePointers.data() : nullptr);
+
+		Consume((float)colliding[a.size() - 1]);
+
+		return stats.iterations;
+	};
+
+	runner.Run(fullName, (int)a.size(), run);
+}
+
+// A unit sphere (well, a sphere of radius 0.5, so it matches the cubes) built out of rings of points, as a triangle mesh.
+// Unlike a cube, a hull like this has as many vertices as we like, which is how we see how the support functions scale.
+// There are rings - 1 rings of segments points each, plus one point at each pole.
+static void makeSphereMesh(int rings, int segments, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+{
+	positions.clear();
+	indices.clear();
+
+	positions.push_back(glm::vec3(0.0f, 0.5f, 0.0f));
+
+	for (int ring = 1; ring < rings; ring++)
+	{
+		float theta = 3.14159265f * ring / rings;
+
+		for (int segment = 0; segment < segments; segment++)
+		{
+			float phi = 6.2831853f * segment / segments;
+
+			positions.push_back(0.5f * glm::vec3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)));
+		}
+	}
+
+	positions.push_back(glm::vec3(0.0f, -0.5f, 0.0f));
+
+	unsigned int bottom = (unsigned int)positions.size() - 1;
+
+	for (int segment = 0; segment < segments; segment++)
+	{
+		unsigned int next = (segment + 1) % segments;
+
+		// The fan around the top pole.
+		indices.push_back(0);
+		indices.push_back(1 + next);
+		indices.push_back(1 + segment);
+
+		// The quads between each pair of rings, as two triangles each.
+		for (int ring = 1; ring + 1 < rings; ring++)
+		{
+			unsigned int upper = 1 + (ring - 1) * segments;
+			unsigned int lower = upper + segments;
+
+			indices.push_back(upper + segment);
+			indices.push_back(upper + next);
+			indices.push_back(lower + segment);
+
+			indices.push_back(upper + next);
+			indices.push_back(lower + next);
+			indices.push_back(lower + segment);
+		}
+
+		// And the fan around the bottom pole.
+		unsigned int last = 1 + (rings - 2) * segments;
+
+		indices.push_back(last + segment);
+		indices.push_back(last + next);
+		indices.push_back(bottom);
+	}
+}
+
+static ConvexHull makeSphereHull(int rings, int segments)
+{
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+
+	makeSphereMesh(rings, segments, positions, indices);
+
+	return ConvexHull(positions.data(), (int)positions.size(), indices.data(), (int)indices.size());
+}
+
+// The sizes of hull we test, as (rings, segments). These give 10, 42, 178 and 738 vertices.
+// Runs TestShapes over every pair (a[i], b[i]) once per query, so pairs with a closed form skip GJK. (There are no iterations to count.)
+template<typename ShapeA, typename ShapeB>
+static void runShapePairs(BenchmarkRunner& runner, const std::string& name, const std::vector<ShapeA>& a, const std::vector<ShapeB>& b)
+{
+	GJKSolver solver;
+
+	auto run = [&]() -> long long
+	{
+		int hits = 0;
+
+		for (int i = 0; i < (int)a.size(); i++)
+		{
+			if (TestShapes(solver, a[i], b[i]))
+			{
+				hits++;
+			}
+		}
+
+		Consume((float)hits);
+
+		return -1;
+	};
+
+	runner.Run(name, (int)a.size(), run);
+}
+
+// Runs TestBoxesSAT (through TestShapes) over every pair of boxes, after checking that it agrees with GJK on every one of them. If it doesn't,
+// that's printed above its numbers.
+static void runBoxSAT(BenchmarkRunner& runner, const std::string& name, const std::vector<OBBShape>& a, const std::vector<OBBShape>& b)
+{
+	if (!runner.Wants(name))
+	{
+		return;
+	}
+
+	GJKSolver solver;
+	int disagreements = 0;
+
+	for (int i = 0; i < (int)a.size(); i++)
+	{
+		if (TestBoxesSAT(a[i], b[i]) != solver.TestGJK(a[i], b[i], nullptr))
+		{
+			disagreements++;
+		}
+	}
+
+	if (disagreements > 0)
+	{
+		printf("%s: SAT and GJK disagree on %d of %d pairs.\n", name.c_str(), disagreements, (int)a.size());
+	}
+
+	runShapePairs(runner, name, a, b);
+}
+
+// Runs the distance query over every pair (a[i], b[i]) with the given sub-algorithm.
+template<typename ShapeA, typename ShapeB>
+static void runDistancePairs(BenchmarkRunner& runner, const std::string& name, const std::vector<ShapeA>& a, const std::vector<ShapeB>& b,
+	GJKSubAlgorithm algorithm)
+{
+	std::string fullName = name + (algorithm == GJK_SUB_SIGNED_VOLUMES ? "/signed-volumes" : "/johnson");
+
+	if (!runner.Wants(fullName))
+	{
+		return;
+	}
+
+	GJKDistanceSolver solver;
+	solver.SetSubAlgorithm(algorithm);
+
+	auto run = [&]() -> long long
+	{
+		long long iterations = 0;
+		float total = 0.0f;
+
+		for (int i = 0; i < (int)a.size(); i++)
+		{
+			GJKDistanceResult result;
+
+			total += solver.Distance(a[i], b[i], result);
+			iterations += result.iterations;
+		}
+
+		Consume(total);
+
+		return iterations;
+	};
+
+	runner.Run(fullName, (int)a.size(), run);
+}
+
+// How far a distance query's answer could be from the truth: the shapes can't be closer than how far apart they are along its normal, so
+// that's subtracted from the distance it found. (0 for a pair it says overlaps.)
+template<typename ShapeA, typename ShapeB>
+static float distanceError(const ShapeA& a, const ShapeB& b, const GJKDistanceResult& result)
+{
+	if (result.overlapping)
+	{
+		return 0.0f;
+	}
+
+	float apart = glm::dot(result.normal, getFarthestPointInDirection(b, -result.normal) - getFarthestPointInDirection(a, result.normal));
+
+	return result.distance - apart;
+}
+
+// Runs both sub-algorithms over the same pairs, after checking how close each one gets to the true distance. If one of them is off by more
+// than the solver's tolerance allows on any pair, how many (and how far off the worst is) is printed above its numbers.
+template<typename ShapeA, typename ShapeB>
+static void runDistanceComparison(BenchmarkRunner& runner, const std::string& name, const std::vector<ShapeA>& a, const std::vector<ShapeB>& b)
+{
+	const GJKSubAlgorithm algorithms[2] = { GJK_SUB_JOHNSON, GJK_SUB_SIGNED_VOLUMES };
+	const char* algorithmNames[2] = { "johnson", "signed-volumes" };
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (!runner.Wants(name + "/" + algorithmNames[i]))
+		{
+			continue;
+		}
+
+		GJKDistanceSolver solver;
+		solver.SetSubAlgorithm(algorithms[i]);
+
+		int wrong = 0;
+		float worst = 0.0f;
+
+		for (int j = 0; j < (int)a.size(); j++)
+		{
+			GJKDistanceResult result;
+			solver.Distance(a[j], b[j], result);
+
+			float error = distanceError(a[j], b[j], result);
+
+			if (error > 1e-3f * glm::max(result.distance, 1e-2f))
+			{
+				wrong++;
+				worst = glm::max(worst, error);
+			}
+		}
+
+		if (wrong > 0)
+		{
+			printf("%s/%s: %d of %d distances are off, by up to %g.\n", name.c_str(), algorithmNames[i], wrong, (int)a.size(), worst);
+		}
+
+		runDistancePairs(runner, name, a, b, algorithms[i]);
+	}
+}
+
+// How far a box reaches along a direction from its center.
+static float boxReach(const OBBShape& box, const glm::vec3& direction)
+{
+	float reach = 0.0f;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		reach += fabsf(glm::dot(box.axes[axis], direction)) * box.halfExtents[axis];
+	}
+
+	return reach;
+}
+
+// The distance query with each sub-algorithm, on boxes that are far apart, nearly touching (which is where Johnson's sub-algorithm loses
+// the most precision, and where GJK takes the most iterations to close in), and overlapping, and on spheres nearly touching boxes (a
+// round shape has no corner for GJK to settle on, so it only ever gets closer).
+static void runDistanceBenchmarks(BenchmarkRunner& runner)
+{
+	BenchmarkRandom random(19);
+	std::vector<OBBShape> a(NUM_PAIRS);
+	std::vector<OBBShape> b(NUM_PAIRS);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		a[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+		b[i] = makeBox(random.Direction() * random.Range(2.0f, 4.0f), random.Orientation());
+	}
+
+	runDistanceComparison(runner, "distance/box/separated", a, b);
+
+	// Nearly touching: B is moved along a random direction until the boxes are between 0.0001 and 0.01 apart along it.
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		glm::vec3 direction = random.Direction();
+
+		a[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+		b[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+
+		b[i].center = direction * (boxReach(a[i], direction) + boxReach(b[i], direction) + random.Range(0.0001f, 0.01f));
+	}
+
+	runDistanceComparison(runner, "distance/box/near", a, b);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		a[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+		b[i] = makeBox(random.Direction() * random.Range(0.9f, 1.3f), random.Orientation());
+	}
+
+	runDistanceComparison(runner, "distance/box/shallow", a, b);
+
+	std::vector<SphereShape> spheres(NUM_PAIRS);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		glm::vec3 direction = random.Direction();
+
+		a[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+		spheres[i] = SphereShape(direction * (boxReach(a[i], direction) + 0.5f + random.Range(0.0001f, 0.01f)), 0.5f);
+	}
+
+	runDistanceComparison(runner, "distance/box-sphere/near", a, spheres);
+}
+
+// Counts the pairs the planar solver and the 3D solver disagree on, when the 3D pairs are the planar ones given some thickness.
+template<typename Shape2DA, typename Shape2DB, typename ShapeA, typename ShapeB>
+static int countPlanarMismatches(const std::vector<Shape2DA>& a2D, const std::vector<Shape2DB>& b2D, const std::vector<ShapeA>& a,
+	const std::vector<ShapeB>& b)
+{
+	GJKSolver2D solver2D;
+	GJKSolver solver;
+	int mismatches = 0;
+
+	for (int i = 0; i < (int)a.size(); i++)
+	{
+		if (solver2D.TestGJK(a2D[i], b2D[i]) != solver.TestGJK(a[i], b[i]))
+		{
+			mismatches++;
+		}
+	}
+
+	return mismatches;
+}
+
+// The planar solver against the 3D one, on the same pairs: rectangles (and circles) turned only about z, and the same shapes as boxes
+// (and spheres) lying in the z = 0 plane.
+static void runPlanarBenchmarks(BenchmarkRunner& runner)
+{
+	BenchmarkRandom random(23);
+	std::vector<RectShape> rectsA(NUM_PAIRS);
+	std::vector<RectShape> rectsB(NUM_PAIRS);
+	std::vector<CircleShape> circles(NUM_PAIRS);
+	std::vector<OBBShape> boxesA(NUM_PAIRS);
+	std::vector<OBBShape> boxesB(NUM_PAIRS);
+	std::vector<SphereShape> spheres(NUM_PAIRS);
+
+	// Shallow, so about half of the pairs overlap.
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		float angleA = random.Range(0.0f, 6.2831853f);
+		float angleB = random.Range(0.0f, 6.2831853f);
+		float heading = random.Range(0.0f, 6.2831853f);
+		glm::vec2 offset = glm::vec2(cosf(heading), sinf(heading)) * random.Range(0.8f, 1.3f);
+
+		rectsA[i] = RectShape(glm::vec2(0.0f), glm::vec2(0.5f), angleA);
+		rectsB[i] = RectShape(offset, glm::vec2(0.5f), angleB);
+		circles[i] = CircleShape(offset, 0.5f);
+
+		boxesA[i] = makeBox(glm::vec3(0.0f), glm::angleAxis(angleA, glm::vec3(0.0f, 0.0f, 1.0f)));
+		boxesB[i] = makeBox(glm::vec3(offset, 0.0f), glm::angleAxis(angleB, glm::vec3(0.0f, 0.0f, 1.0f)));
+		spheres[i] = SphereShape(glm::vec3(offset, 0.0f), 0.5f);
+	}
+
+	GJKSolver2D solver2D;
+	runPairsWith(runner, solver2D, "gjk2d/rect/shallow", rectsA, rectsB, CACHE_NONE);
+	runPairsWith(runner, solver2D, "gjk2d/rect/shallow", rectsA, rectsB, CACHE_PER_PAIR);
+	runPairs(runner, "gjk/planar-box/shallow", boxesA, boxesB, CACHE_NONE);
+	runPairs(runner, "gjk/planar-box/shallow", boxesA, boxesB, CACHE_PER_PAIR);
+
+	runPairsWith(runner, solver2D, "gjk2d/rect-circle/shallow", rectsA, circles, CACHE_NONE);
+	runPairs(runner, "gjk/planar-box-sphere/shallow", boxesA, spheres, CACHE_NONE);
+
+	// Both solvers should give the same answer for every pair (other than ones that are touching to within rounding, which random pairs aren't).
+	if (runner.Wants("gjk2d/rect/shallow/cold"))
+	{
+		int mismatches = countPlanarMismatches(rectsA, rectsB, boxesA, boxesB) + countPlanarMismatches(rectsA, circles, boxesA, spheres);
+
+		if (mismatches > 0)
+		{
+			printf("  gjk2d: %d pairs disagree with the 3D solver\n", mismatches);
+		}
+	}
+}
+
+// Time of impact queries on fast pairs like the ones PhysicsWorld::sweep gets: a box flying past another one that its stretched bounds
+// reach, which it only actually hits now and then. Once with conservative advancement on every pair, and once with the swept hull test
+// (TimeOfImpactSolver::MightHit) ruling out the pairs that can't hit first.
+static void runSweptBenchmarks(BenchmarkRunner& runner)
+{
+	const float dt = 1.0f / 60.0f;
+
+	BenchmarkRandom random(31);
+	std::vector<OBBShape> boxesA(NUM_PAIRS);
+	std::vector<OBBShape> boxesB(NUM_PAIRS);
+	std::vector<ShapeMotion> motionsA(NUM_PAIRS);
+	std::vector<ShapeMotion> motionsB(NUM_PAIRS);
+	float radius = glm::length(CUBE_HALF_EXTENTS);
+
+	// a moves 1 to 4 units this step in any direction, spinning a little, so b (which is somewhere in reach, and drifting) is only in its
+	// path some of the time.
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		glm::vec3 velocity = random.Direction() * random.Range(60.0f, 240.0f);
+
+		boxesA[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+		boxesB[i] = makeBox(random.Direction() * random.Range(1.8f, 4.0f), random.Orientation());
+		motionsA[i] = ShapeMotion(velocity, random.Direction() * random.Range(0.0f, 10.0f), radius);
+		motionsB[i] = ShapeMotion(random.Direction() * random.Range(0.0f, 2.0f), random.Direction() * random.Range(0.0f, 2.0f), radius);
+	}
+
+	TimeOfImpactSolver solver;
+	bool reject = false;
+
+	auto run = [&]() -> long long
+	{
+		long long iterations = 0;
+		float time = 0.0f;
+
+		for (int i = 0; i < NUM_PAIRS; i++)
+		{
+			if (reject && !solver.MightHit(boxesA[i], motionsA[i], boxesB[i], motionsB[i], dt))
+			{
+				iterations++;
+				continue;
+			}
+
+			TimeOfImpactResult result;
+
+			if (solver.TimeOfImpact(boxesA[i], motionsA[i], boxesB[i], motionsB[i], dt, result))
+			{
+				time += result.time;
+			}
+
+			iterations += result.iterations;
+		}
+
+		Consume(time);
+
+		return iterations;
+	};
+
+	runner.Run("toi/fast-box/advancement", NUM_PAIRS, run);
+
+	reject = true;
+	runner.Run("toi/fast-box/swept-hull", NUM_PAIRS, run);
+
+	// The swept hull has to be conservative: a pair it rules out can't be one conservative advancement finds a hit for. (Every so often
+	// advancement's warm started distance query comes back overlapping when the shapes aren't, so a hit only counts if a fresh query at
+	// that time agrees the shapes are touching.)
+	if (runner.Wants("toi/fast-box/swept-hull"))
+	{
+		GJKDistanceSolver distance;
+		int missed = 0;
+		int rejected = 0;
+
+		for (int i = 0; i < NUM_PAIRS; i++)
+		{
+			if (!solver.MightHit(boxesA[i], motionsA[i], boxesB[i], motionsB[i], dt))
+			{
+				TimeOfImpactResult result;
+				rejected++;
+
+				if (solver.TimeOfImpact(boxesA[i], motionsA[i], boxesB[i], motionsB[i], dt, result) && result.state == TOI_HIT)
+				{
+					GJKDistanceResult gap;
+					distance.Distance(moveShape(boxesA[i], motionsA[i], result.time), moveShape(boxesB[i], motionsB[i], result.time), gap);
+
+					if (gap.distance <= solver.GetTolerance())
+					{
+						missed++;
+					}
+				}
+			}
+		}
+
+		if (missed > 0)
+		{
+			printf("  toi: the swept hull ruled out %d of %d pairs that hit\n", missed, rejected);
+		}
+	}
+}
+
+// Compares GJK with the closed form tests in ShapePairs.h, and the ConvexShape pair table with a switch at every support call.
+static void runShapePairBenchmarks(BenchmarkRunner& runner, BenchmarkRandom& random)
+{
+	std::vector<SphereShape> spheresA(NUM_PAIRS);
+	std::vector<SphereShape> spheresB(NUM_PAIRS);
+	std::vector<OBBShape> boxes(NUM_PAIRS);
+
+	// Shallow again: about half of each kind of pair overlaps.
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		spheresA[i] = SphereShape(glm::vec3(0.0f), 0.5f);
+		spheresB[i] = SphereShape(random.Direction() * random.Range(0.8f, 1.2f), 0.5f);
+		boxes[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+	}
+
+	runPairs(runner, "gjk/sphere-sphere", spheresA, spheresB, CACHE_NONE);
+	runShapePairs(runner, "shortcut/sphere-sphere", spheresA, spheresB);
+
+	runPairs(runner, "gjk/sphere-box", spheresB, boxes, CACHE_NONE);
+	runShapePairs(runner, "shortcut/sphere-box", spheresB, boxes);
+
+	// Every kind of pair mixed together (other than hulls), as ConvexShapes.
+	std::vector<ConvexShape> convexA(NUM_PAIRS);
+	std::vector<ConvexShape> convexB(NUM_PAIRS);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			glm::vec3 center = j == 0 ? glm::vec3(0.0f) : random.Direction() * random.Range(0.8f, 1.2f);
+			glm::vec3 axis = random.Direction();
+			ConvexShape& shape = j == 0 ? convexA[i] : convexB[i];
+
+			switch (random.NextInt() % 5)
+			{
+			case 0:
+				shape = ConvexShape(SphereShape(center, 0.5f));
+				break;
+			case 1:
+				shape = ConvexShape(CapsuleShape(center - axis * 0.25f, center + axis * 0.25f, 0.25f));
+				break;
+			case 2:
+				shape = ConvexShape(CylinderShape(center, axis, 0.5f, 0.5f));
+				break;
+			case 3:
+				shape = ConvexShape(ConeShape(center - axis * 0.5f, axis, 1.0f, 0.5f));
+				break;
+			default:
+				shape = ConvexShape(makeBox(center, random.Orientation()));
+				break;
+			}
+		}
+	}
+
+	runPairs(runner, "gjk/convex-mixed/switch", convexA, convexB, CACHE_NONE);
+	runShapePairs(runner, "gjk/convex-mixed/table", convexA, convexB);
+}
+
+// Finds the contact of every pair (a[i], b[i]) with GJK and then EPA for the pairs that collide, like the narrowphase does. The iterations are
+// GJK's and EPA's together.
+template<typename ShapeA, typename ShapeB>
+static void runExactContacts(BenchmarkRunner& runner, const std::string& name, const std::vector<ShapeA>& a, const std::vector<ShapeB>& b)
+{
+	GJKSolver solver;
+	EPASolver epa;
+
+	auto run = [&]() -> long long
+	{
+		long long iterations = 0;
+		float depth = 0.0f;
+
+		for (int i = 0; i < (int)a.size(); i++)
+		{
+			bool colliding = solver.TestGJK(a[i], b[i]);
+			iterations += solver.GetIterations();
+
+			EPAResult result;
+
+			if (colliding && epa.Penetration(a[i], b[i], solver.GetSimplex(), result))
+			{
+				depth += result.depth;
+				iterations += result.iterations;
+			}
+		}
+
+		Consume(depth);
+
+		return iterations;
+	};
+
+	runner.Run(name, (int)a.size(), run);
+}
+
+// The same, but with MarginGJKSolver, which only needs EPA when the cores overlap.
+template<typename ShapeA, typename ShapeB>
+static void runMarginContacts(BenchmarkRunner& runner, const std::string& name, const std::vector<ShapeA>& a, const std::vector<ShapeB>& b)
+{
+	MarginGJKSolver solver;
+
+	auto run = [&]() -> long long
+	{
+		long long iterations = 0;
+		float depth = 0.0f;
+
+		for (int i = 0; i < (int)a.size(); i++)
+		{
+			EPAResult result;
+
+			if (solver.Penetration(a[i], b[i], result))
+			{
+				depth += result.depth;
+			}
+
+			iterations += solver.GetIterations();
+		}
+
+		Consume(depth);
+
+		return iterations;
+	};
+
+	runner.Run(name, (int)a.size(), run);
+}
+
+// Resting contacts: boxes sitting on top of each other, sunk in by less than their margin (as a settled stack would be), and a little
+// turned. The same boxes go through GJK and EPA exactly, and as rounded boxes through MarginGJKSolver.
+static void runMarginBenchmarks(BenchmarkRunner& runner, BenchmarkRandom& random)
+{
+	const float margin = 0.04f;
+
+	std::vector<OBBShape> a(NUM_PAIRS);
+	std::vector<OBBShape> b(NUM_PAIRS);
+	std::vector<RoundedShape<OBBShape> > roundedA(NUM_PAIRS);
+	std::vector<RoundedShape<OBBShape> > roundedB(NUM_PAIRS);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		glm::vec3 slide = glm::vec3(random.Range(-0.5f, 0.5f), 0.0f, random.Range(-0.5f, 0.5f));
+
+		a[i] = makeBox(glm::vec3(0.0f), glm::angleAxis(random.Range(-0.05f, 0.05f), random.Direction()));
+		b[i] = makeBox(slide + glm::vec3(0.0f, 1.0f - random.Range(0.0f, margin), 0.0f), glm::angleAxis(random.Range(-0.05f, 0.05f), random.Direction()));
+		roundedA[i] = MakeRoundedBox(a[i], margin);
+		roundedB[i] = MakeRoundedBox(b[i], margin);
+	}
+
+	runExactContacts(runner, "contact/box/resting/exact", a, b);
+	runMarginContacts(runner, "contact/box/resting/margin", roundedA, roundedB);
+
+	// Spheres and capsules are a point and a segment with a margin, so they never need more than the distance query until they're sunk in
+	// all the way to their cores.
+	std::vector<SphereShape> spheres(NUM_PAIRS);
+	std::vector<CapsuleShape> capsules(NUM_PAIRS);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		glm::vec3 axis = random.Direction();
+		glm::vec3 center = random.Direction() * random.Range(0.6f, 0.75f);
+
+		spheres[i] = SphereShape(glm::vec3(0.0f), 0.5f);
+		capsules[i] = CapsuleShape(center - axis * 0.5f, center + axis * 0.5f, 0.25f);
+	}
+
+	runExactContacts(runner, "contact/sphere-capsule/exact", spheres, capsules);
+	runMarginContacts(runner, "contact/sphere-capsule/margin", spheres, capsules);
+}
+
+static const int NUM_HULL_SIZES = 4;
+static const int HULL_SIZES[NUM_HULL_SIZES][2] = { { 3, 4 }, { 6, 8 }, { 12, 16 }, { 24, 32 } };
+
+// Points in the point cloud benchmarks: a small depth camera's frame, and a lidar sweep.
+static const int NUM_POINT_CLOUD_SIZES = 2;
+static const int POINT_CLOUD_SIZES[NUM_POINT_CLOUD_SIZES] = { 4096, 65536 };
+
+// How many vertices hulls are simplified down to.
+static const int HULL_VERTEX_BUDGET = 32;
+
+static void runHullBenchmarks(BenchmarkRunner& runner, int rings, int segments)
+{
+	ConvexHull hull = makeSphereHull(rings, segments);
+	int numPoints = hull.NumPoints();
+
+	std::string name = "gjk/hull-" + std::to_string(numPoints);
+
+	if (!runner.Wants(name))
+	{
+		return;
+	}
+
+	// Shape A sits at the origin, so its world points are just the hull's. Each shape B is a copy of the hull moved to somewhere around
+	// A, close enough that about half of the pairs overlap.
+	BenchmarkRandom random(7);
+	std::vector<glm::vec3> offsets(NUM_HULL_PAIRS);
+	std::vector<glm::vec3> worldPoints(NUM_HULL_PAIRS * numPoints);
+
+	for (int i = 0; i < NUM_HULL_PAIRS; i++)
+	{
+		offsets[i] = random.Direction() * random.Range(0.9f, 1.1f);
+
+		for (int j = 0; j < numPoints; j++)
+		{
+			worldPoints[i * numPoints + j] = hull.Points()[j] + offsets[i];
+		}
+	}
+
+	// Checking every vertex.
+	std::vector<HullShape> bruteA(NUM_HULL_PAIRS, HullShape(hull.Points(), numPoints));
+	std::vector<HullShape> bruteB(NUM_HULL_PAIRS);
+
+	for (int i = 0; i < NUM_HULL_PAIRS; i++)
+	{
+		bruteB[i] = HullShape(&worldPoints[i * numPoints], numPoints);
+	}
+
+	runPairs(runner, name + "/brute", bruteA, bruteB, CACHE_NONE);
+	runPairs(runner, name + "/brute", bruteA, bruteB, CACHE_PER_PAIR);
+
+	// Hill-climbing, where each pair remembers where each of its searches ended (like the narrowphase does).
+	std::vector<int> lastVertices(NUM_HULL_PAIRS * 2, 0);
+	std::vector<HillClimbHullShape> climbA(NUM_HULL_PAIRS);
+	std::vector<HillClimbHullShape> climbB(NUM_HULL_PAIRS);
+
+	for (int i = 0; i < NUM_HULL_PAIRS; i++)
+	{
+		climbA[i] = HillClimbHullShape(&hull, hull.Points(), &lastVertices[i * 2]);
+		climbB[i] = HillClimbHullShape(&hull, &worldPoints[i * numPoints], &lastVertices[i * 2 + 1]);
+	}
+
+	runPairs(runner, name + "/hill-climb", climbA, climbB, CACHE_NONE);
+	runPairs(runner, name + "/hill-climb", climbA, climbB, CACHE_PER_PAIR);
+
+	// Turned hulls, the way a moving body's hull would be: either every point is brought into world space before the tests (as a hull in
+	// world space needs every time its body moves), or the hull keeps its local points and a pose, and only the support points are.
+	std::vector<glm::quat> orientations(NUM_HULL_PAIRS);
+
+	for (int i = 0; i < NUM_HULL_PAIRS; i++)
+	{
+		orientations[i] = random.Orientation();
+	}
+
+	if (runner.Wants(name + "/refit"))
+	{
+		GJKSolver solver;
+
+		auto runRefit = [&]() -> long long
+		{
+			long long iterations = 0;
+			int hits = 0;
+
+			for (int i = 0; i < NUM_HULL_PAIRS; i++)
+			{
+				glm::vec3* points = &worldPoints[i * numPoints];
+
+				for (int j = 0; j < numPoints; j++)
+				{
+					points[j] = offsets[i] + orientations[i] * hull.Points()[j];
+				}
+
+				if (solver.TestGJK(bruteA[i], HullShape(points, numPoints), nullptr))
+				{
+					hits++;
+				}
+
+				iterations += solver.GetIterations();
+			}
+
+			Consume((float)hits);
+
+			return iterations;
+		};
+
+		runner.Run(name + "/refit", NUM_HULL_PAIRS, runRefit);
+	}
+
+	std::vector<HullShape> localB(NUM_HULL_PAIRS);
+
+	for (int i = 0; i < NUM_HULL_PAIRS; i++)
+	{
+		localB[i] = HullShape(hull.Points(), numPoints, offsets[i], orientations[i]);
+	}
+
+	runPairs(runner, name + "/local", bruteA, localB, CACHE_NONE);
+
+	// The same posed hulls, walking down a hierarchy instead of checking every vertex (once there are enough vertices for one).
+	if (numPoints >= HULL_HIERARCHY_MIN_VERTICES)
+	{
+		HullHierarchy hierarchy(&hull);
+		std::vector<HierarchyHullShape> hierarchyA(NUM_HULL_PAIRS, HierarchyHullShape(&hierarchy));
+		std::vector<HierarchyHullShape> hierarchyB(NUM_HULL_PAIRS);
+
+		for (int i = 0; i < NUM_HULL_PAIRS; i++)
+		{
+			hierarchyB[i] = HierarchyHullShape(&hierarchy, offsets[i], orientations[i]);
+		}
+
+		runPairs(runner, name + "/hierarchy", hierarchyA, hierarchyB, CACHE_NONE);
+	}
+
+	// Both hulls posed, somewhere away from the origin: with both poses applied at every support call, or through TestShapes, which tests
+	// the pair in A's frame so that only B's support points get transformed.
+	std::vector<HullShape> posedA(NUM_HULL_PAIRS);
+	std::vector<HullShape> posedB(NUM_HULL_PAIRS);
+
+	for (int i = 0; i < NUM_HULL_PAIRS; i++)
+	{
+		glm::vec3 base = random.Direction() * random.Range(10.0f, 20.0f);
+
+		posedA[i] = HullShape(hull.Points(), numPoints, base, random.Orientation());
+		posedB[i] = HullShape(hull.Points(), numPoints, base + offsets[i], orientations[i]);
+	}
+
+	runPairs(runner, name + "/posed", posedA, posedB, CACHE_NONE);
+	runShapePairs(runner, name + "/relative", posedA, posedB);
+
+	// The hull simplified down to a budget, checking every vertex of that instead.
+	if (numPoints <= HULL_VERTEX_BUDGET)
+	{
+		return;
+	}
+
+	ConvexHull simple = ConvexHull::Simplify(hull, HULL_VERTEX_BUDGET);
+	int numSimple = simple.NumPoints();
+	std::vector<glm::vec3> simpleWorldPoints(NUM_HULL_PAIRS * numSimple);
+
+	std::vector<HullShape> simpleA(NUM_HULL_PAIRS, HullShape(simple.Points(), numSimple));
+	std::vector<HullShape> simpleB(NUM_HULL_PAIRS);
+
+	for (int i = 0; i < NUM_HULL_PAIRS; i++)
+	{
+		for (int j = 0; j < numSimple; j++)
+		{
+			simpleWorldPoints[i * numSimple + j] = simple.Points()[j] + offsets[i];
+		}
+
+		simpleB[i] = HullShape(&simpleWorldPoints[i * numSimple], numSimple);
+	}
+
+	runPairs(runner, name + "/simplified-" + std::to_string(numSimple), simpleA, simpleB, CACHE_NONE);
+}
+
+// Tests compound shapes (see CompoundShape) the way they're meant to be tested, where the tree picks out the children near the other shape,
+// against testing every child in turn.
+static void runCompoundBenchmarks(BenchmarkRunner& runner, BenchmarkRandom& random)
+{
+	// A lattice of 4x4x4 small boxes a unit apart, like a scaffold: lots of children, each only near a few of the others.
+	const int side = 4;
+	CompoundShape lattice;
+
+	for (int x = 0; x < side; x++)
+	{
+		for (int y = 0; y < side; y++)
+		{
+			for (int z = 0; z < side; z++)
+			{
+				glm::vec3 offset = glm::vec3((float)x, (float)y, (float)z) - glm::vec3((side - 1) * 0.5f);
+
+				lattice.AddChild(ConvexShape(makeBox(glm::vec3(0.0f), glm::quat(), glm::vec3(0.3f))), offset, random.Orientation());
+			}
+		}
+	}
+
+	lattice.Build();
+	lattice.SetPose(glm::vec3(0.0f), random.Orientation());
+
+	std::string name = "gjk/compound-" + std::to_string(lattice.NumChildren());
+
+	// Cubes anywhere in and around the lattice. Some fall between the children and touch none of them.
+	std::vector<OBBShape> boxes(NUM_PAIRS);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		boxes[i] = makeBox(random.Direction() * random.Range(0.0f, side * 0.5f), random.Orientation(), glm::vec3(0.25f));
+	}
+
+	GJKSolver solver;
+	std::vector<int> found;
+
+	auto runTree = [&]() -> long long
+	{
+		int hits = 0;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			if (TestCompound(solver, lattice, boxes[i], found))
+			{
+				hits++;
+			}
+		}
+
+		Consume((float)hits);
+
+		return -1;
+	};
+
+	auto runEveryChild = [&]() -> long long
+	{
+		int hits = 0;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			for (int j = 0; j < lattice.NumChildren(); j++)
+			{
+				if (TestShapes(solver, lattice.GetChild(j), boxes[i]))
+				{
+					hits++;
+					break;
+				}
+			}
+		}
+
+		Consume((float)hits);
+
+		return -1;
+	};
+
+	runner.Run(name + "-box/tree", (int)boxes.size(), runTree);
+	runner.Run(name + "-box/every-child", (int)boxes.size(), runEveryChild);
+
+	// Two lattices, one turning through the other.
+	std::vector<CompoundShape> others(NUM_HULL_PAIRS, lattice);
+
+	for (int i = 0; i < NUM_HULL_PAIRS; i++)
+	{
+		others[i].SetPose(random.Direction() * random.Range(0.0f, (float)side), random.Orientation());
+	}
+
+	std::vector<BroadphasePair> childPairs;
+
+	auto runCompounds = [&]() -> long long
+	{
+		int hits = 0;
+
+		for (int i = 0; i < (int)others.size(); i++)
+		{
+			if (TestCompounds(solver, lattice, others[i], childPairs, found))
+			{
+				hits++;
+			}
+		}
+
+		Consume((float)hits);
+
+		return -1;
+	};
+
+	runner.Run(name + "-pair/tree", (int)others.size(), runCompounds);
+}
+
+void RunGJKBenchmarks(BenchmarkRunner& runner)
+{
+	std::vector<OBBShape> a(NUM_PAIRS);
+	std::vector<OBBShape> b(NUM_PAIRS);
+
+	// Separated: B is somewhere between 2 and 4 units away from A, further than the two cubes can reach no matter how they are turned.
+	// Most of these are decided by the very first support point or two.
+	BenchmarkRandom random(1);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		a[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+		b[i] = makeBox(random.Direction() * random.Range(2.0f, 4.0f), random.Orientation());
+	}
+
+	runPairs(runner, "gjk/box/separated", a, b, CACHE_NONE);
+	runPairs(runner, "gjk/box/separated", a, b, CACHE_PER_PAIR);
+	runBatchPairs(runner, "gjk/box-batch/separated", a, b, CACHE_NONE);
+	runBatchPairs(runner, "gjk/box-batch/separated", a, b, CACHE_PER_PAIR);
+	runBoxSAT(runner, "sat/box/separated", a, b);
+
+	// Touching: two cubes that aren't turned, with a face of B lying exactly on a face of A. The origin is right on the boundary of the
+	// Minkowski Difference, which is where GJK has the hardest time deciding.
+	const glm::vec3 faceAxes[3] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		int axis = i % 3;
+		float side = (i / 3) % 2 == 0 ? 1.0f : -1.0f;
+
+		// Slide B along the face by up to most of its width, so that the faces still overlap.
+		glm::vec3 slide = glm::vec3(random.Range(-0.9f, 0.9f), random.Range(-0.9f, 0.9f), random.Range(-0.9f, 0.9f));
+		slide[axis] = 0.0f;
+
+		a[i] = makeBox(glm::vec3(0.0f), glm::quat());
+		b[i] = makeBox(faceAxes[axis] * side + slide, glm::quat());
+	}
+
+	runPairs(runner, "gjk/box/touching", a, b, CACHE_NONE);
+	runPairs(runner, "gjk/box/touching", a, b, CACHE_PER_PAIR);
+	runBatchPairs(runner, "gjk/box-batch/touching", a, b, CACHE_NONE);
+	runBatchPairs(runner, "gjk/box-batch/touching", a, b, CACHE_PER_PAIR);
+	runBoxSAT(runner, "sat/box/touching", a, b);
+
+	// Deeply penetrating: B's center is within 0.1 of A's. The origin is deep inside the Minkowski Difference, so GJK has to build the
+	// whole tetrahedron to prove it.
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		a[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+		b[i] = makeBox(random.Direction() * random.Range(0.0f, 0.1f), random.Orientation());
+	}
+
+	runPairs(runner, "gjk/box/penetrating", a, b, CACHE_NONE);
+	runPairs(runner, "gjk/box/penetrating", a, b, CACHE_PER_PAIR);
+	runBatchPairs(runner, "gjk/box-batch/penetrating", a, b, CACHE_NONE);
+	runBatchPairs(runner, "gjk/box-batch/penetrating", a, b, CACHE_PER_PAIR);
+	runBoxSAT(runner, "sat/box/penetrating", a, b);
+
+	// Shallow: turned boxes whose centers are only just close enough for them to touch. Some overlap a little and some miss by a little, and
+	// either way GJK tries several tetrahedra (and throws most of them away) before it can tell, so this is where the tetrahedron case
+	// (ContainsOrigin and checkTetrahedron) does the most work.
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		a[i] = makeBox(glm::vec3(0.0f), random.Orientation());
+		b[i] = makeBox(random.Direction() * random.Range(0.9f, 1.3f), random.Orientation());
+	}
+
+	runPairs(runner, "gjk/box/shallow", a, b, CACHE_NONE);
+	runPairs(runner, "gjk/box/shallow", a, b, CACHE_PER_PAIR);
+	runBoxSAT(runner, "sat/box/shallow", a, b);
+
+	// Far: the same shallow pairs, but 10,000 units from the origin, where a float is only good to about a millimeter. The same pairs go
+	// through each precision (see MixedGJKSolver), so mixed can be compared with both plain float and all double.
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		glm::vec3 offset = random.Direction() * 10000.0f;
+
+		a[i] = makeBox(offset, random.Orientation());
+		b[i] = makeBox(offset + random.Direction() * random.Range(0.9f, 1.3f), random.Orientation());
+	}
+
+	const GJKPrecision precisions[3] = { GJK_PRECISION_FLOAT, GJK_PRECISION_DOUBLE, GJK_PRECISION_MIXED };
+	const char* precisionNames[3] = { "float", "double", "mixed" };
+
+	for (int i = 0; i < 3; i++)
+	{
+		MixedGJKSolver solver(precisions[i]);
+
+		runPairsWith(runner, solver, std::string("gjk/box-far/") + precisionNames[i], a, b, CACHE_NONE);
+		runPairsWith(runner, solver, std::string("gjk/box-far/") + precisionNames[i], a, b, CACHE_PER_PAIR);
+	}
+
+	runBoxSAT(runner, "sat/box-far", a, b);
+
+	// Degenerate: boxes with no thickness lying in the same plane, some overlapping and some not. Their Minkowski Difference is flat,
+	// so there's no tetrahedron to enclose the origin with. This is where the no-progress check and the iteration cap come in.
+	const glm::vec3 flatHalfExtents = glm::vec3(0.5f, 0.5f, 0.0f);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		a[i] = makeBox(glm::vec3(0.0f), glm::quat(), flatHalfExtents);
+		b[i] = makeBox(glm::vec3(random.Range(-1.5f, 1.5f), random.Range(-1.5f, 1.5f), 0.0f), glm::quat(), flatHalfExtents);
+	}
+
+	runPairs(runner, "gjk/box/degenerate-flat", a, b, CACHE_NONE);
+	runPairs(runner, "gjk/box/degenerate-flat", a, b, CACHE_PER_PAIR);
+
+	// GJK says every one of these is apart (it gives up without a tetrahedron), so SAT, which gets them right, is expected to disagree with
+	// it on the ones that overlap.
+	runBoxSAT(runner, "sat/box/degenerate-flat", a, b);
+
+	// Also degenerate: two copies of the same box in the same place, so that support points in opposite directions cancel out exactly.
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		a[i] = makeBox(random.Direction() * random.Range(0.0f, 4.0f), random.Orientation());
+		b[i] = a[i];
+	}
+
+	runPairs(runner, "gjk/box/degenerate-coincident", a, b, CACHE_NONE);
+	runPairs(runner, "gjk/box/degenerate-coincident", a, b, CACHE_PER_PAIR);
+	runBoxSAT(runner, "sat/box/degenerate-coincident", a, b);
+
+	// Rotating: one pair over time. B circles A, just close enough to keep going in and out of contact as both of them spin. Each "pair" is
+	// one frame of that, in order, so the shared cache sees the same frame to frame coherence that it does in the demo.
+	glm::vec3 spinA = random.Direction();
+	glm::vec3 spinB = random.Direction();
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		float t = 6.2831853f * i / NUM_PAIRS;
+
+		a[i] = makeBox(glm::vec3(0.0f), glm::angleAxis(t * 3.0f, spinA));
+		b[i] = makeBox(glm::vec3(cosf(t), 0.2f * sinf(t * 5.0f), sinf(t)) * 1.15f, glm::angleAxis(t * 7.0f, spinB));
+	}
+
+	runPairs(runner, "gjk/box/rotating", a, b, CACHE_NONE);
+	runPairs(runner, "gjk/box/rotating", a, b, CACHE_SHARED);
+	runBoxSAT(runner, "sat/box/rotating", a, b);
+
+	// The same shapes, as the 8-corner OBBs and their SoA version the demo started out with.
+	std::vector<OBB> cornersA(NUM_PAIRS);
+	std::vector<OBB> cornersB(NUM_PAIRS);
+	std::vector<OBBSoA> soaA(NUM_PAIRS);
+	std::vector<OBBSoA> soaB(NUM_PAIRS);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		cornersA[i] = makeCorners(a[i]);
+		cornersB[i] = makeCorners(b[i]);
+		soaA[i] = OBBSoA(cornersA[i]);
+		soaB[i] = OBBSoA(cornersB[i]);
+	}
+
+	runPairs(runner, "gjk/obb-corners/rotating", cornersA, cornersB, CACHE_NONE);
+	runPairs(runner, "gjk/obb-soa/rotating", soaA, soaB, CACHE_NONE);
+
+	runShapePairBenchmarks(runner, random);
+	runMarginBenchmarks(runner, random);
+	runCompoundBenchmarks(runner, random);
+
+	for (int i = 0; i < NUM_HULL_SIZES; i++)
+	{
+		runHullBenchmarks(runner, HULL_SIZES[i][0], HULL_SIZES[i][1]);
+	}
+
+	runDistanceBenchmarks(runner);
+	runPlanarBenchmarks(runner);
+	runSweptBenchmarks(runner);
+}
+
+// Calls the support function of a shape once per direction.
+template<typename Shape>
+static void runSupport(BenchmarkRunner& runner, const std::string& name, const Shape& shape, const std::vector<glm::vec3>& directions)
+{
+	auto run = [&]() -> long long
+	{
+		glm::vec3 sum = glm::vec3(0.0f);
+
+		for (int i = 0; i < (int)directions.size(); i++)
+		{
+			sum += getFarthestPointInDirection(shape, directions[i]);
+		}
+
+		Consume(sum.x + sum.y + sum.z);
+
+		return -1;
+	};
+
+	runner.Run(name, (int)directions.size(), run);
+}
+
+void RunSupportBenchmarks(BenchmarkRunner& runner)
+{
+	BenchmarkRandom random(2);
+
+	// Directions all over the place, as a cold query (or a different pair each time) would use.
+	std::vector<glm::vec3> randomDirections(NUM_DIRECTIONS);
+
+	for (int i = 0; i < NUM_DIRECTIONS; i++)
+	{
+		randomDirections[i] = random.Direction();
+	}
+
+	// And directions that turn a little bit each time, as one pair does from one step to the next.
+	std::vector<glm::vec3> coherentDirections(NUM_DIRECTIONS);
+	glm::vec3 axis = random.Direction();
+
+	for (int i = 0; i < NUM_DIRECTIONS; i++)
+	{
+		float t = 6.2831853f * i / NUM_DIRECTIONS;
+
+		coherentDirections[i] = glm::angleAxis(t, axis) * glm::vec3(cosf(t * 3.0f), 0.5f, sinf(t * 3.0f));
+	}
+
+	OBBShape box = makeBox(glm::vec3(1.0f, 2.0f, 3.0f), random.Orientation());
+	OBB corners = makeCorners(box);
+	OBBSoA soa = OBBSoA(corners);
+	ConvexShape convex = ConvexShape(box);
+
+	runSupport(runner, "support/obb-corners", corners, randomDirections);
+	runSupport(runner, "support/obb-soa", soa, randomDirections);
+	runSupport(runner, "support/obb-shape", box, randomDirections);
+	runSupport(runner, "support/convex-shape(obb)", convex, randomDirections);
+	runSupport(runner, "support/sphere", SphereShape(glm::vec3(1.0f, 2.0f, 3.0f), 0.5f), randomDirections);
+
+	// The Minkowski Difference support, which is what GJK actually calls (twice the work of one shape).
+	OBBShape other = makeBox(glm::vec3(1.5f, 2.0f, 3.0f), random.Orientation());
+
+	auto minkowski = [&]() -> long long
+	{
+		glm::vec3 sum = glm::vec3(0.0f);
+
+		for (int i = 0; i < NUM_DIRECTIONS; i++)
+		{
+			sum += Support(box, other, randomDirections[i]);
+		}
+
+		Consume(sum.x + sum.y + sum.z);
+
+		return -1;
+	};
+
+	runner.Run("support/minkowski(obb-shape)", NUM_DIRECTIONS, minkowski);
+
+	for (int i = 0; i < NUM_HULL_SIZES; i++)
+	{
+		ConvexHull hull = makeSphereHull(HULL_SIZES[i][0], HULL_SIZES[i][1]);
+		std::string name = "support/hull-" + std::to_string(hull.NumPoints());
+
+		int lastVertex = 0;
+		HullShape brute = HullShape(hull.Points(), hull.NumPoints());
+		HillClimbHullShape climb = HillClimbHullShape(&hull, hull.Points(), &lastVertex);
+
+		runSupport(runner, name + "/brute", brute, randomDirections);
+		runSupport(runner, name + "/hill-climb-random", climb, randomDirections);
+		runSupport(runner, name + "/hill-climb-coherent", climb, coherentDirections);
+
+		// Hill-climbing from the same vertex every time, with nothing to go on (the worst case, about the square root of the vertices in
+		// steps on a sphere), against walking down a hierarchy, which takes O(log n) whichever way the direction points.
+		if (hull.NumPoints() >= HULL_HIERARCHY_MIN_VERTICES)
+		{
+			int coldVertex = 0;
+			HillClimbHullShape cold = HillClimbHullShape(&hull, hull.Points(), &coldVertex);
+
+			auto runCold = [&]() -> long long
+			{
+				glm::vec3 sum = glm::vec3(0.0f);
+
+				for (int j = 0; j < NUM_DIRECTIONS; j++)
+				{
+					coldVertex = 0;
+					sum += getFarthestPointInDirection(cold, randomDirections[j]);
+				}
+
+				Consume(sum.x + sum.y + sum.z);
+
+				return -1;
+			};
+
+			runner.Run(name + "/hill-climb-cold", NUM_DIRECTIONS, runCold);
+
+			HullHierarchy hierarchy(&hull);
+
+			runSupport(runner, name + "/hierarchy", HierarchyHullShape(&hierarchy), randomDirections);
+		}
+	}
+
+	// A sensor frame: points scattered through a blob (not just on its surface, as a scan of a cluttered scene would be), with an intensity
+	// after each position and the odd missing return. Brute force is a HullShape over the same points (after copying them out, which the
+	// point cloud never has to); the point cloud projects them a lane at a time and skips blocks that can't win.
+	for (int i = 0; i < NUM_POINT_CLOUD_SIZES; i++)
+	{
+		int numPoints = POINT_CLOUD_SIZES[i];
+		std::string name = "support/point-cloud-" + std::to_string(numPoints);
+
+		std::vector<float> frame(numPoints * 4);
+		std::vector<glm::vec3> packed;
+
+		for (int j = 0; j < numPoints; j++)
+		{
+			glm::vec3 p = random.Direction() * glm::vec3(2.0f, 1.0f, 1.5f) * random.Range(0.5f, 1.0f);
+
+			if (random.Next() < 0.01f)
+			{
+				p.z = NAN;
+			}
+			else
+			{
+				packed.push_back(p);
+			}
+
+			frame[j * 4] = p.x;
+			frame[j * 4 + 1] = p.y;
+			frame[j * 4 + 2] = p.z;
+			frame[j * 4 + 3] = random.Next();
+		}
+
+		PointCloud cloud(frame.data(), numPoints, 4);
+
+		runSupport(runner, name + "/brute", HullShape(packed.data(), (int)packed.size()), randomDirections);
+		runSupport(runner, name + "/lanes", PointCloudShape(&cloud), randomDirections);
+
+		// What a new frame costs before its first query.
+		auto runBuild = [&]() -> long long
+		{
+			cloud.SetPoints(frame.data(), numPoints, 4);
+			cloud.Build();
+
+			Consume((float)cloud.NumValidPoints());
+
+			return -1;
+		};
+
+		runner.Run(name + "/build", numPoints, runBuild);
+	}
+}
+
+// Fills a BodyStore with bodies scattered around, turned and scaled every which way, and moving.
+static void fillBodies(BodyStore& bodies, std::vector<BodyHandle>& handles, BenchmarkRandom& random)
+{
+	for (int i = 0; i < NUM_BODIES; i++)
+	{
+		BodyHandle handle = bodies.Create();
+
+		bodies.Position(handle) = glm::vec3(random.Range(-50.0f, 50.0f), random.Range(-50.0f, 50.0f), random.Range(-50.0f, 50.0f));
+		bodies.Velocity(handle) = random.Direction() * random.Range(0.0f, 2.0f);
+		bodies.Orientation(handle) = random.Orientation();
+		bodies.Scale(handle) = glm::vec3(random.Range(0.5f, 2.0f));
+		bodies.MarkDirty(handle);
+
+		handles.push_back(handle);
+	}
+
+	bodies.UpdateTransforms(0, bodies.Size());
+	bodies.SavePrevious();
+}
+
+void RunTransformBenchmarks(BenchmarkRunner& runner)
+{
+	BenchmarkRandom random(3);
+	BodyStore bodies;
+	std::vector<BodyHandle> handles;
+
+	fillBodies(bodies, handles, random);
+
+	// One body at a time, by handle. This is what GameObject::CalculateMatrices does for each object.
+	auto single = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			bodies.CalculateTransform(handles[i]);
+		}
+
+		Consume(bodies.Transforms()[NUM_BODIES - 1][3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/calculate-matrices", NUM_BODIES, single);
+
+	// Every body marked dirty (as moving them does), then all rebuilt at once.
+	auto dirty = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			bodies.MarkDirty(handles[i]);
+		}
+
+		bodies.UpdateTransforms(0, NUM_BODIES);
+
+		Consume(bodies.Transforms()[NUM_BODIES - 1][3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/update-dirty", NUM_BODIES, dirty);
+
+	// The batched builder straight from the arrays, with no dirty flags to check.
+	std::vector<glm::mat4> transforms(NUM_BODIES);
+
+	auto batched = [&]() -> long long
+	{
+		BodyStore::BuildTransforms(bodies.Positions(), bodies.Orientations(), bodies.Scales(), transforms.data(), NUM_BODIES);
+
+		Consume(transforms[NUM_BODIES - 1][3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/build-batched", NUM_BODIES, batched);
+
+	// Then an OBB (and its bounds) around each body, one at a time the way the physics step used to, and all at once with BuildOBBShapes.
+	std::vector<const glm::mat4*> transformPointers(NUM_BODIES);
+	std::vector<glm::vec3> localCenters(NUM_BODIES, glm::vec3(0.0f));
+	std::vector<glm::vec3> localHalfExtents(NUM_BODIES, glm::vec3(0.5f));
+	std::vector<int> objects(NUM_BODIES);
+	std::vector<OBBShape> shapes(NUM_BODIES);
+	std::vector<ShapeBounds> shapeBounds(NUM_BODIES);
+
+	for (int i = 0; i < NUM_BODIES; i++)
+	{
+		transformPointers[i] = &transforms[i];
+		objects[i] = i;
+	}
+
+	auto shapesSingle = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			shapes[i] = OBBShape(*transformPointers[i], localCenters[i], localHalfExtents[i]);
+			shapeBounds[i] = getShapeBounds(shapes[i]);
+		}
+
+		Consume(shapeBounds[NUM_BODIES - 1].radius);
+
+		return -1;
+	};
+
+	runner.Run("transform/obb-single", NUM_BODIES, shapesSingle);
+
+	auto shapesBatched = [&]() -> long long
+	{
+		BuildOBBShapes(objects.data(), NUM_BODIES, transformPointers.data(), localCenters.data(), localHalfExtents.data(), shapes.data(), shapeBounds.data());
+
+		Consume(shapeBounds[NUM_BODIES - 1].radius);
+
+		return -1;
+	};
+
+	runner.Run("transform/obb-batched", NUM_BODIES, shapesBatched);
+
+	// What the renderer does every frame: blend each body between the last two steps, then build its transform.
+	auto interpolated = [&]() -> long long
+	{
+		bodies.InterpolateTransforms(0.5f, 0, NUM_BODIES, transforms.data());
+
+		Consume(transforms[NUM_BODIES - 1][3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/interpolate", NUM_BODIES, interpolated);
+
+	// And what the physics does every step: move every body, then rebuild its transform.
+	auto integrated = [&]() -> long long
+	{
+		bodies.Integrate(1.0f / 60.0f, 0, NUM_BODIES);
+
+		Consume(bodies.Transforms()[NUM_BODIES - 1][3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/integrate", NUM_BODIES, integrated);
+
+	// The same, split into jobs across every thread: a whole number of BODY_BLOCKs each (the way the world does it), and 60 bodies each, so
+	// that neighbouring jobs write to either end of the same cache lines.
+	JobSystem jobs;
+
+	auto integrateJob = [&](int begin, int end, int thread)
+	{
+		bodies.Integrate(1.0f / 60.0f, begin, end);
+	};
+
+	auto integratedBlocks = [&]() -> long long
+	{
+		jobs.ParallelFor(NUM_BODIES, BODY_BLOCK * 4, integrateJob);
+
+		Consume(bodies.Transforms()[NUM_BODIES - 1][3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/integrate/jobs-blocked", NUM_BODIES, integratedBlocks);
+
+	auto integratedSplit = [&]() -> long long
+	{
+		jobs.ParallelFor(NUM_BODIES, 60, integrateJob);
+
+		Consume(bodies.Transforms()[NUM_BODIES - 1][3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/integrate/jobs-split-lines", NUM_BODIES, integratedSplit);
+
+	// Every body spinning as well: the way the demo used to turn its objects, with a quaternion built from Euler angles multiplied in by hand
+	// before each step, against giving them an angular velocity for Integrate to turn them by.
+	const glm::vec3 eulerStep = glm::vec3(glm::radians(1.0f), glm::radians(1.0f), 0.0f);
+
+	auto rotatedEuler = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			bodies.Orientation(handles[i]) *= glm::quat(eulerStep);
+			bodies.MarkDirty(handles[i]);
+		}
+
+		bodies.Integrate(1.0f / 60.0f, 0, NUM_BODIES);
+
+		Consume(bodies.Transforms()[NUM_BODIES - 1][0][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/spin/euler", NUM_BODIES, rotatedEuler);
+
+	for (int i = 0; i < NUM_BODIES; i++)
+	{
+		bodies.AngularVelocity(handles[i]) = bodies.Orientation(handles[i]) * eulerStep * 60.0f;
+	}
+
+	auto spun = [&]() -> long long
+	{
+		bodies.Integrate(1.0f / 60.0f, 0, NUM_BODIES);
+
+		Consume(bodies.Transforms()[NUM_BODIES - 1][0][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/spin/angular-velocity", NUM_BODIES, spun);
+
+	for (int i = 0; i < NUM_BODIES; i++)
+	{
+		bodies.AngularVelocity(handles[i]) = glm::vec3(0.0f);
+	}
+
+	// Moving the origin (see PhysicsWorld::ShiftOrigin), back and forth so the bodies stay put.
+	float shift = 16.0f;
+
+	auto shifted = [&]() -> long long
+	{
+		bodies.ShiftOrigin(glm::vec3(shift, -shift, shift));
+		shift = -shift;
+
+		Consume(bodies.Transforms()[NUM_BODIES - 1][3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/shift-origin", NUM_BODIES, shifted);
+
+	// Spawning and despawning a burst of bodies, the way debris does, in a store that already has room for them. Destroyed bodies' slots
+	// are reused, so this shouldn't allocate at all.
+	BodyStore debris;
+	std::vector<BodyHandle> debrisHandles(NUM_BODIES);
+
+	debris.Reserve(NUM_BODIES);
+
+	auto spawn = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			debrisHandles[i] = debris.Create();
+			debris.Position(debrisHandles[i]) = glm::vec3((float)i, 0.0f, 0.0f);
+		}
+
+		// Every other one first, then the rest, so bodies get moved into the holes.
+		for (int i = 0; i < NUM_BODIES; i += 2)
+		{
+			debris.Destroy(debrisHandles[i]);
+		}
+		for (int i = 1; i < NUM_BODIES; i += 2)
+		{
+			debris.Destroy(debrisHandles[i]);
+		}
+
+		Consume(debris.IsValid(debrisHandles[0]) ? 1.0f : 0.0f);
+
+		return -1;
+	};
+
+	runner.Run("transform/spawn-despawn", NUM_BODIES, spawn);
+
+	// A hierarchy with a root following each body and props hanging off them a few levels deep (four under each root, two under each of
+	// those, and two more under each of those: 29 nodes per root, 4 levels).
+	TransformHierarchy hierarchy;
+	std::vector<TransformNode> roots(NUM_BODIES);
+
+	for (int i = 0; i < NUM_BODIES; i++)
+	{
+		roots[i] = hierarchy.Add(-1, bodies.Transforms()[i]);
+
+		for (int j = 0; j < 4; j++)
+		{
+			TransformNode prop = hierarchy.Add(roots[i], glm::translate(glm::mat4(1.0f), glm::vec3((float)j, 1.0f, 0.0f)));
+
+			for (int k = 0; k < 2; k++)
+			{
+				TransformNode part = hierarchy.Add(prop, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, (float)k, 0.5f)));
+
+				hierarchy.Add(part, glm::rotate(glm::mat4(1.0f), 0.5f, glm::vec3(0.0f, 1.0f, 0.0f)));
+				hierarchy.Add(part, glm::scale(glm::mat4(1.0f), glm::vec3(0.5f)));
+			}
+		}
+	}
+
+	hierarchy.Update();
+
+	int numNodes = hierarchy.Size();
+	TransformNode lastNode = numNodes - 1;
+
+	// The same hierarchy as plain objects with their children, walked down from each root. This is how it would look as a scene graph.
+	struct SceneNode
+	{
+		glm::mat4 local;
+		glm::mat4 world;
+		std::vector<SceneNode*> children;
+	};
+	std::vector<SceneNode> sceneNodes(numNodes);
+
+	for (TransformNode node = 0; node < numNodes; node++)
+	{
+		sceneNodes[node].local = hierarchy.GetLocal(node);
+
+		if (hierarchy.GetParent(node) >= 0)
+		{
+			sceneNodes[hierarchy.GetParent(node)].children.push_back(&sceneNodes[node]);
+		}
+	}
+
+	struct Recurse
+	{
+		static void Update(SceneNode& node, const glm::mat4& parentWorld)
+		{
+			node.world = parentWorld * node.local;
+
+			for (size_t i = 0; i < node.children.size(); i++)
+			{
+				Update(*node.children[i], node.world);
+			}
+		}
+	};
+
+	auto recursive = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			Recurse::Update(sceneNodes[roots[i]], glm::mat4(1.0f));
+		}
+
+		Consume(sceneNodes[lastNode].world[3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/hierarchy/recursive", numNodes, recursive);
+
+	// Every body moved, so every node is rebuilt. (Setting the roots' transforms counts too, since the world has to do that each step.)
+	auto allDirty = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			hierarchy.SetLocal(roots[i], bodies.Transforms()[i]);
+		}
+
+		hierarchy.Update();
+
+		Consume(hierarchy.GetWorld(lastNode)[3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/hierarchy/all-moved", numNodes, allDirty);
+
+	auto allDirtyJobs = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			hierarchy.SetLocal(roots[i], bodies.Transforms()[i]);
+		}
+
+		hierarchy.Update(&jobs);
+
+		Consume(hierarchy.GetWorld(lastNode)[3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/hierarchy/all-moved-jobs", numNodes, allDirtyJobs);
+
+	// One body in 16 moved (the rest asleep or resting), so most subtrees are skipped.
+	auto someDirty = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i += 16)
+		{
+			hierarchy.SetLocal(roots[i], bodies.Transforms()[i]);
+		}
+
+		hierarchy.Update();
+
+		Consume(hierarchy.GetWorld(lastNode)[3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/hierarchy/some-moved", numNodes, someDirty);
+
+	// Nothing moved: only the flags are checked.
+	auto noneDirty = [&]() -> long long
+	{
+		hierarchy.Update();
+
+		Consume(hierarchy.GetWorld(lastNode)[3][0]);
+
+		return -1;
+	};
+
+	runner.Run("transform/hierarchy/none-moved", numNodes, noneDirty);
+
+	// A dense block of bodies (one per cell of a 48 x 48 x 48 grid, far more than fit in the cache), created in a random order the way a
+	// store ends up after a lot of spawning and despawning. Each body looks at the bodies in the cells next to it, the way the solver and
+	// narrowphase look at the bodies they're touching, once with the bodies scattered through the arrays and once sorted by position.
+	const int gridSize = 48;
+	const int numCells = gridSize * gridSize * gridSize;
+	BodyStore dense;
+	std::vector<BodyHandle> cellBodies(numCells);
+	std::vector<int> cellOrder(numCells);
+
+	for (int i = 0; i < numCells; i++)
+	{
+		cellOrder[i] = i;
+	}
+	for (int i = numCells - 1; i > 0; i--)
+	{
+		std::swap(cellOrder[i], cellOrder[random.NextInt() % (i + 1)]);
+	}
+
+	dense.Reserve(numCells);
+
+	for (int i = 0; i < numCells; i++)
+	{
+		int cell = cellOrder[i];
+		BodyHandle body = dense.Create();
+
+		dense.Position(body) = glm::vec3((float)(cell % gridSize), (float)(cell / gridSize % gridSize), (float)(cell / (gridSize * gridSize)));
+		dense.Velocity(body) = random.Direction();
+		cellBodies[cell] = body;
+	}
+
+	const int neighbourSteps[3] = { 1, gridSize, gridSize * gridSize };
+
+	auto neighbours = [&]() -> long long
+	{
+		glm::vec3 total(0.0f);
+
+		for (int index = 0; index < numCells; index++)
+		{
+			BodyHandle body = dense.GetHandle(index);
+			glm::vec3 position = dense.Position(body);
+			int cell = (int)position.x + ((int)position.y + (int)position.z * gridSize) * gridSize;
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				int next = cell + neighbourSteps[axis];
+
+				if ((int)position[axis] + 1 < gridSize)
+				{
+					BodyHandle other = cellBodies[next];
+
+					total += (dense.Velocity(other) - dense.Velocity(body)) * glm::dot(dense.Position(other) - position, dense.Orientation(other) * glm::vec3(1.0f, 0.0f, 0.0f));
+				}
+			}
+		}
+
+		Consume(total.x);
+
+		return -1;
+	};
+
+	runner.Run("transform/neighbours/scattered", numCells, neighbours);
+
+	// Only the first run sorts anything; the rest find the bodies already in order, which is what sorting every so often costs.
+	auto sort = [&]() -> long long
+	{
+		Consume(dense.SortByPosition() ? 1.0f : 0.0f);
+
+		return -1;
+	};
+
+	runner.Run("transform/sort-by-position", numCells, sort);
+	runner.Run("transform/neighbours/sorted", numCells, neighbours);
+
+	// Setting every body's velocity in a world, straight into the bodies, and through the command queue: pushed one at a time and then all
+	// made at once between steps, the way another thread's changes get made. The difference is what it costs not to race with the step.
+	PhysicsWorld world(1);
+	std::vector<glm::vec3> velocities(NUM_BODIES);
+
+	world.Reserve(NUM_BODIES);
+
+	for (int i = 0; i < NUM_BODIES; i++)
+	{
+		velocities[i] = random.Direction();
+		world.AddBox(glm::vec3(0.0f), glm::vec3(0.5f), random.Direction() * 50.0f, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+	}
+
+	auto direct = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			world.Bodies().Velocity(world.GetBody(i)) = velocities[i];
+		}
+
+		Consume(world.Bodies().Velocity(world.GetBody(NUM_BODIES - 1)).x);
+
+		return -1;
+	};
+
+	runner.Run("transform/commands/direct", NUM_BODIES, direct);
+
+	auto queued = [&]() -> long long
+	{
+		for (int i = 0; i < NUM_BODIES; i++)
+		{
+			world.Commands().SetVelocity(i, velocities[i]);
+		}
+
+		world.ApplyCommands();
+
+		Consume(world.Bodies().Velocity(world.GetBody(NUM_BODIES - 1)).x);
+
+		return -1;
+	};
+
+	runner.Run("transform/commands/queued", NUM_BODIES, queued);
+}
+
+// The solver benchmark's pile: columns of boxes stacked on a floor, each box touching the one under it along a whole face (4 points).
+static const int NUM_COLUMNS = 64;
+static const int COLUMN_HEIGHT = 8;
+
+// Whole steps of a scene of cubes, on several threads, played again and again from a saved state once it has warmed up. Every step has
+// been run before, so every container a step uses is already as big as it needs to be, and no step should allocate anything (see
+// CountHeapAllocation). The restores themselves can, but they aren't part of a step.
+static void runSteadyStepBenchmarks(BenchmarkRunner& runner)
+{
+	const float dt = 1.0f / 60.0f;
+	const int warmup = 30;
+	const int replayed = 10;
+
+	SceneSettings settings;
+	settings.count = 2000;
+
+	std::string name = "step/replayed-" + std::to_string(settings.count);
+	std::string advancedName = "step/advanced-" + std::to_string(settings.count);
+
+	// Building and warming up the world is most of the work here, so it isn't done unless one of the benchmarks is going to run.
+	if (!runner.Wants(name) && !runner.Wants(advancedName))
+	{
+		return;
+	}
+
+	PhysicsWorld world(4);
+	BuildScene(world, settings);
+
+	for (int i = 0; i < warmup; i++)
+	{
+		world.Step(dt);
+	}
+
+	PhysicsWorldState state;
+	world.SaveState(state);
+
+	for (int i = 0; i < replayed; i++)
+	{
+		world.Step(dt);
+	}
+
+	long long stepAllocations = 0;
+
+	auto replay = [&]() -> long long
+	{
+		world.RestoreState(state);
+
+		for (int i = 0; i < replayed; i++)
+		{
+			world.Step(dt);
+			stepAllocations += world.GetStepStats().allocations;
+		}
+
+		return -1;
+	};
+
+	runner.Run(name, replayed, replay);
+
+	if (stepAllocations > 0)
+	{
+		printf("  step: replaying warmed up steps allocated %lld times\n", stepAllocations);
+	}
+
+	// The same steps again, fast forwarded (see PhysicsWorld::Advance).
+	auto advance = [&]() -> long long
+	{
+		world.RestoreState(state);
+		world.Advance(replayed, dt);
+
+		return -1;
+	};
+
+	runner.Run(advancedName, replayed, advance);
+}
+
+void RunSolverBenchmarks(BenchmarkRunner& runner)
+{
+	const float dt = 1.0f / 60.0f;
+	const int numContacts = NUM_COLUMNS * COLUMN_HEIGHT;
+
+	// Contact c is between box c - 1 (or the floor, for the bottom of a column) and box c, pointing up.
+	std::vector<ContactManifold> manifolds(numContacts);
+	std::vector<NarrowphaseContact> contacts(numContacts);
+	std::vector<glm::vec3> velocities(numContacts);
+	glm::vec3 floorVelocity(0.0f);
+	std::vector<int> bodies(numContacts);
+
+	for (int i = 0; i < numContacts; i++)
+	{
+		const glm::vec3 corners[4] =
+		{
+			glm::vec3(-0.5f, 0.0f, -0.5f), glm::vec3(0.5f, 0.0f, -0.5f), glm::vec3(0.5f, 0.0f, 0.5f), glm::vec3(-0.5f, 0.0f, 0.5f)
+		};
+
+		for (int corner = 0; corner < 4; corner++)
+		{
+			EPAResult result;
+			result.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+			result.pointA = corners[corner];
+			result.pointB = corners[corner];
+			result.depth = 0.001f;
+
+			manifolds[i].Add(result, glm::mat4(), glm::mat4());
+		}
+
+		contacts[i].a = i % COLUMN_HEIGHT == 0 ? -1 : i - 1;
+		contacts[i].b = i;
+		contacts[i].contact.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+		contacts[i].contact.depth = 0.001f;
+		contacts[i].manifold = &manifolds[i];
+	}
+
+	// One step's solve of the whole pile, from the same falling velocities every time (the impulses are warm started from the last run).
+	auto solve = [&](ContactSolver& solver) -> long long
+	{
+		solver.Clear();
+
+		for (int i = 0; i < numContacts; i++)
+		{
+			velocities[i] = glm::vec3(0.0f, -0.1f, 0.0f);
+
+			SolverBody body;
+			body.velocity = &velocities[i];
+			body.acceleration = glm::vec3(0.0f, -9.8f, 0.0f);
+			body.inverseMass = 1.0f;
+
+			bodies[i] = solver.AddBody(body);
+		}
+
+		for (int i = 0; i < numContacts; i++)
+		{
+			int a;
+
+			if (contacts[i].a == -1)
+			{
+				SolverBody floor;
+				floor.velocity = &floorVelocity;
+				floor.acceleration = glm::vec3(0.0f);
+				floor.inverseMass = 0.0f;
+
+				a = solver.AddBody(floor);
+			}
+			else
+			{
+				a = bodies[contacts[i].a];
+			}
+
+			solver.Add(contacts[i], a, bodies[contacts[i].b], dt);
+		}
+
+		solver.Solve();
+
+		Consume(velocities[numContacts - 1].y);
+
+		return -1;
+	};
+
+	ContactSolver sequentialSolver;
+	sequentialSolver.SetBatching(false);
+
+	auto sequential = [&]() -> long long
+	{
+		return solve(sequentialSolver);
+	};
+
+	runner.Run("solver/sequential", numContacts * 4, sequential);
+
+	ContactSolver batchedSolver;
+
+	auto batched = [&]() -> long long
+	{
+		return solve(batchedSolver);
+	};
+
+	runner.Run("solver/batched", numContacts * 4, batched);
+
+	// The same pile from scratch (no warm starting, and no bounce), which is where it shows how many iterations the solver really needs.
+	// Each way of solving it is checked by how fast the worst point is still sinking once the step is over. (4 substeps cost about as much
+	// as 8 iterations, since each substep also has to get its points ready.)
+	const int stackSettings[4][2] = { { 4, 1 }, { 1, 4 }, { 8, 1 }, { 16, 1 } };
+	float sinking[4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		ContactSolver coldSolver;
+		coldSolver.SetWarmStarting(false);
+		coldSolver.SetRestitution(0.0f);
+		coldSolver.SetIterations(stackSettings[i][0]);
+		coldSolver.SetSubsteps(stackSettings[i][1]);
+
+		auto cold = [&]() -> long long
+		{
+			return solve(coldSolver);
+		};
+
+		std::string name = stackSettings[i][1] > 1 ? "solver/cold/substeps-" + std::to_string(stackSettings[i][1]) :
+			"solver/cold/iterations-" + std::to_string(stackSettings[i][0]);
+
+		runner.Run(name, numContacts * 4, cold);
+
+		solve(coldSolver);
+		sinking[i] = 0.0f;
+
+		for (int j = 0; j < numContacts; j++)
+		{
+			float below = contacts[j].a == -1 ? 0.0f : velocities[contacts[j].a].y;
+			float closing = velocities[j].y - below - (contacts[j].a == -1 ? 9.8f * dt : 0.0f);
+
+			sinking[i] = glm::max(sinking[i], -closing);
+		}
+	}
+
+	// Splitting the step up should settle the pile at least as well as the same number of iterations over the whole step.
+	if (sinking[1] > sinking[0])
+	{
+		printf("solver/cold: 4 substeps leave the pile sinking at %f, and 4 iterations at %f\n", sinking[1], sinking[0]);
+	}
+
+	runSteadyStepBenchmarks(runner);
+}
+
+// Collides particles with a shape PARTICLE_LANES at a time, and then one at a time with a GJK distance query each.
+template<typename Shape>
+static void runParticles(BenchmarkRunner& runner, const std::string& name, const Shape& collider, const ParticleBuffer& particles)
+{
+	ParticleCollisionSolver solver;
+	std::vector<ParticleContact> contacts;
+
+	auto lanes = [&]() -> long long
+	{
+		contacts.clear();
+		solver.Collide(collider, particles, contacts);
+
+		Consume((float)contacts.size());
+
+		return -1;
+	};
+
+	runner.Run(name + "/lanes", particles.Size(), lanes);
+
+	GJKDistanceSolver distance;
+
+	auto oneAtATime = [&]() -> long long
+	{
+		int touching = 0;
+
+		for (int i = 0; i < particles.Size(); i++)
+		{
+			GJKDistanceResult result;
+
+			if (distance.Distance(collider, SphereShape(particles.GetPosition(i), 0.0f), result) <= particles.GetRadius())
+			{
+				touching++;
+			}
+		}
+
+		Consume((float)touching);
+
+		return -1;
+	};
+
+	runner.Run(name + "/gjk", particles.Size(), oneAtATime);
+}
+
+void RunQueryBenchmarks(BenchmarkRunner& runner)
+{
+	SceneSettings settings;
+	settings.count = NUM_QUERY_CUBES;
+
+	// The casts start anywhere in the scene and go off in every direction.
+	BenchmarkRandom random(4);
+	float halfWidth = 0.5f * powf(settings.count / settings.density, 1.0f / 3.0f);
+
+	std::vector<glm::vec3> from(NUM_CASTS);
+	std::vector<glm::vec3> to(NUM_CASTS);
+
+	for (int i = 0; i < NUM_CASTS; i++)
+	{
+		from[i] = glm::vec3(random.Range(-halfWidth, halfWidth), random.Range(-halfWidth, halfWidth), random.Range(-halfWidth, halfWidth));
+		to[i] = from[i] + random.Direction() * CAST_LENGTH;
+	}
+
+	for (int broadphase = 0; broadphase < PhysicsWorld::NUM_BROADPHASES; broadphase++)
+	{
+		PhysicsWorld world(1);
+		world.SetBroadphase(broadphase);
+
+		BuildScene(world, settings);
+
+		std::string name = std::string("query/") + BROADPHASE_NAMES[broadphase];
+
+		auto rays = [&]() -> long long
+		{
+			PhysicsCastHit hit;
+			float total = 0.0f;
+
+			for (int i = 0; i < NUM_CASTS; i++)
+			{
+				if (world.RayCast(from[i], to[i], hit))
+				{
+					total += hit.fraction;
+				}
+			}
+
+			Consume(total);
+
+			return -1;
+		};
+
+		runner.Run(name + "/raycast", NUM_CASTS, rays);
+
+		auto spheres = [&]() -> long long
+		{
+			PhysicsCastHit hit;
+			float total = 0.0f;
+
+			for (int i = 0; i < NUM_CASTS; i++)
+			{
+				if (world.CastShape(SphereShape(from[i], 0.25f), to[i] - from[i], hit))
+				{
+					total += hit.fraction;
+				}
+			}
+
+			Consume(total);
+
+			return -1;
+		};
+
+		runner.Run(name + "/spherecast", NUM_CASTS, spheres);
+
+		// Everything within a couple of units of each ray's start, the query explosions use to find what they push.
+		auto overlaps = [&]() -> long long
+		{
+			std::vector<int> objects;
+			std::vector<float> distances;
+			float total = 0.0f;
+
+			for (int i = 0; i < NUM_CASTS; i++)
+			{
+				world.OverlapSphere(from[i], 2.0f, objects, &distances);
+				total += (float)objects.size();
+			}
+
+			Consume(total);
+
+			return -1;
+		};
+
+		runner.Run(name + "/overlap sphere", NUM_CASTS, overlaps);
+
+		// Only needs doing once, since it doesn't use the broadphase.
+		if (broadphase != 0)
+		{
+			continue;
+		}
+
+		// The same rays again, with the ray cast cache on. Nothing moves between them, so after the first time through every one of them
+		// is answered from the cache, which is the best case for rays cast again every frame at things that stay put.
+		world.SetRayCastCache(NUM_CASTS);
+
+		runner.Run(name + "/raycast cached", NUM_CASTS, rays);
+
+		world.SetRayCastCache(0);
+
+		// Every ray against every cube, with no broadphase at all.
+		const std::vector<OBBShape>& shapes = world.GetShapes();
+
+		auto brute = [&]() -> long long
+		{
+			ShapeCastSolver solver;
+			float total = 0.0f;
+
+			for (int i = 0; i < NUM_CASTS; i++)
+			{
+				float closest = 1.0f;
+				SphereShape point(from[i], 0.0f);
+
+				for (int j = 0; j < (int)shapes.size(); j++)
+				{
+					ShapeCastResult result;
+
+					if (solver.Cast(point, to[i] - from[i], shapes[j], closest, result))
+					{
+						closest = result.fraction;
+					}
+				}
+
+				total += closest;
+			}
+
+			Consume(total);
+
+			return -1;
+		};
+
+		runner.Run("query/brute-force/raycast", NUM_CASTS, brute);
+
+		// The same rays against a copy of the world, the way other threads query it while it steps (see SceneQueryBuffer), and what the copy
+		// costs to make after each step.
+		SceneQuerySnapshot snapshot;
+		SceneQueryScratch scratch;
+
+		auto capture = [&]() -> long long
+		{
+			snapshot.Capture(world);
+
+			Consume(snapshot.GetBounds(0).min.x);
+
+			return -1;
+		};
+
+		runner.Run("query/snapshot/capture", settings.count, capture);
+
+		auto snapshotRays = [&]() -> long long
+		{
+			PhysicsCastHit hit;
+			float total = 0.0f;
+
+			for (int i = 0; i < NUM_CASTS; i++)
+			{
+				if (snapshot.RayCast(from[i], to[i], hit, scratch))
+				{
+					total += hit.fraction;
+				}
+			}
+
+			Consume(total);
+
+			return -1;
+		};
+
+		runner.Run("query/snapshot/raycast", NUM_CASTS, snapshotRays);
+
+		// The agents' rays and boxes, shuffled, the way a frame's worth of queries comes in from all over, one at a time and as batches.
+		const int numAgentRays = NUM_AGENTS * AGENT_RAYS;
+		std::vector<glm::vec3> agentFrom(numAgentRays);
+		std::vector<glm::vec3> agentTo(numAgentRays);
+		std::vector<AABB> agentBoxes(NUM_AGENTS);
+
+		for (int i = 0; i < NUM_AGENTS; i++)
+		{
+			glm::vec3 agent(random.Range(-halfWidth, halfWidth), random.Range(-halfWidth, halfWidth), random.Range(-halfWidth, halfWidth));
+
+			for (int j = 0; j < AGENT_RAYS; j++)
+			{
+				agentFrom[i * AGENT_RAYS + j] = agent;
+				agentTo[i * AGENT_RAYS + j] = agent + random.Direction() * CAST_LENGTH;
+			}
+
+			agentBoxes[i] = AABB(agent - glm::vec3(2.0f), agent + glm::vec3(2.0f));
+		}
+		for (int i = numAgentRays - 1; i > 0; i--)
+		{
+			int other = random.NextInt() % (i + 1);
+
+			std::swap(agentFrom[i], agentFrom[other]);
+			std::swap(agentTo[i], agentTo[other]);
+		}
+
+		std::vector<PhysicsCastHit> agentHits(numAgentRays);
+
+		auto agentRays = [&]() -> long long
+		{
+			float total = 0.0f;
+
+			for (int i = 0; i < numAgentRays; i++)
+			{
+				if (snapshot.RayCast(agentFrom[i], agentTo[i], agentHits[i], scratch))
+				{
+					total += agentHits[i].fraction;
+				}
+			}
+
+			Consume(total);
+
+			return -1;
+		};
+
+		runner.Run("query/snapshot/agent-rays/one-at-a-time", numAgentRays, agentRays);
+
+		SceneQueryBatchScratch batchScratch;
+		JobSystem jobs;
+
+		auto agentRayBatch = [&]() -> long long
+		{
+			snapshot.RayCastBatch(agentFrom.data(), agentTo.data(), numAgentRays, agentHits.data(), batchScratch);
+
+			Consume(agentHits[numAgentRays - 1].fraction);
+
+			return -1;
+		};
+
+		runner.Run("query/snapshot/agent-rays/batch", numAgentRays, agentRayBatch);
+
+		auto agentRayBatchJobs = [&]() -> long long
+		{
+			snapshot.RayCastBatch(agentFrom.data(), agentTo.data(), numAgentRays, agentHits.data(), batchScratch, &jobs);
+
+			Consume(agentHits[numAgentRays - 1].fraction);
+
+			return -1;
+		};
+
+		runner.Run("query/snapshot/agent-rays/batch-jobs", numAgentRays, agentRayBatchJobs);
+
+		std::vector<int> nearby;
+		std::vector<int> nearbyFirsts;
+
+		auto agentOverlaps = [&]() -> long long
+		{
+			long long total = 0;
+
+			for (int i = 0; i < NUM_AGENTS; i++)
+			{
+				snapshot.Overlap(agentBoxes[i], nearby, scratch);
+				total += nearby.size();
+			}
+
+			Consume((float)total);
+
+			return -1;
+		};
+
+		runner.Run("query/snapshot/agent-overlaps/one-at-a-time", NUM_AGENTS, agentOverlaps);
+
+		auto agentOverlapBatch = [&]() -> long long
+		{
+			snapshot.OverlapBatch(agentBoxes.data(), NUM_AGENTS, nearby, nearbyFirsts, batchScratch);
+
+			Consume((float)nearby.size());
+
+			return -1;
+		};
+
+		runner.Run("query/snapshot/agent-overlaps/batch", NUM_AGENTS, agentOverlapBatch);
+
+		// The same cubes as a static tree: inserted one at a time, and then rebuilt with the surface area heuristic. Each cube's bounds are
+		// looked up in the tree, the way every object that can move looks itself up among the static ones each step.
+		AABBTree inserted;
+
+		for (int i = 0; i < world.NumObjects(); i++)
+		{
+			inserted.CreateProxy(world.GetBounds(i), i);
+		}
+
+		AABBTree rebuilt = inserted;
+
+		auto rebuild = [&]() -> long long
+		{
+			rebuilt = inserted;
+			rebuilt.Rebuild();
+
+			Consume((float)rebuilt.GetHeight());
+
+			return -1;
+		};
+
+		runner.Run("query/static-tree/rebuild", world.NumObjects(), rebuild);
+
+		auto lookups = [&](const AABBTree& tree) -> long long
+		{
+			int found = 0;
+
+			auto count = [&found](int proxy)
+			{
+				found++;
+				return true;
+			};
+
+			for (int i = 0; i < world.NumObjects(); i++)
+			{
+				tree.Query(world.GetBounds(i), count);
+			}
+
+			Consume((float)found);
+
+			return -1;
+		};
+
+		auto insertedLookups = [&]() { return lookups(inserted); };
+		auto rebuiltLookups = [&]() { return lookups(rebuilt); };
+
+		runner.Run("query/static-tree/inserted/box", world.NumObjects(), insertedLookups);
+		runner.Run("query/static-tree/sah/box", world.NumObjects(), rebuiltLookups);
+
+		// The same lookups in the flattened copy of the rebuilt tree, which is what the world actually looks static objects up in.
+		QBVH flat;
+
+		auto flatten = [&]() -> long long
+		{
+			rebuilt.Flatten(flat);
+
+			Consume((float)flat.GetNodeCount());
+
+			return -1;
+		};
+
+		runner.Run("query/static-tree/flatten", world.NumObjects(), flatten);
+
+		auto flatLookups = [&]() -> long long
+		{
+			int found = 0;
+
+			auto count = [&found](int proxy)
+			{
+				found++;
+				return true;
+			};
+
+			for (int i = 0; i < world.NumObjects(); i++)
+			{
+				flat.Query(world.GetBounds(i), count);
+			}
+
+			Consume((float)found);
+
+			return -1;
+		};
+
+		runner.Run("query/static-tree/qbvh/box", world.NumObjects(), flatLookups);
+	}
+
+	// Sorting a broadphase's worth of pairs (in the order they'd be found in, which is no order at all) before the narrowphase: by
+	// comparison, and with the radix sort every broadphase uses (see SortPairs). Both copy the unsorted pairs in first.
+	{
+		const int numPairs = 50000;
+		const int numObjects = 100000;
+
+		std::vector<BroadphasePair> found(numPairs);
+		std::vector<BroadphasePair> pairs;
+		std::vector<BroadphasePair> scratch;
+
+		for (int i = 0; i < numPairs; i++)
+		{
+			int a = random.NextInt() % numObjects;
+			found[i] = BroadphasePair(a, (a + 1 + random.NextInt() % 64) % numObjects);
+		}
+
+		auto comparison = [&]() -> long long
+		{
+			pairs = found;
+			std::sort(pairs.begin(), pairs.end());
+
+			Consume((float)pairs[0].a);
+
+			return -1;
+		};
+
+		auto radix = [&]() -> long long
+		{
+			pairs = found;
+			SortPairs(pairs, scratch);
+
+			Consume((float)pairs[0].a);
+
+			return -1;
+		};
+
+		runner.Run("query/pair-sort/std", numPairs, comparison);
+		runner.Run("query/pair-sort/radix", numPairs, radix);
+
+		if (runner.Wants("query/pair-sort/radix"))
+		{
+			std::vector<BroadphasePair> sorted = found;
+			std::sort(sorted.begin(), sorted.end());
+
+			if (pairs != sorted)
+			{
+				printf("  pair-sort: the radix sort's order differs from std::sort's\n");
+			}
+		}
+	}
+
+	// A cloud of particles around a box and a hull, PARTICLE_LANES at a time, and one at a time through GJK distance, which is what a
+	// particle effect would have had to do otherwise. About one in twenty of them is touching.
+	{
+		ParticleBuffer particles(PARTICLE_RADIUS);
+
+		for (int i = 0; i < NUM_PARTICLES; i++)
+		{
+			particles.Add(glm::vec3(random.Range(-3.0f, 3.0f), random.Range(-3.0f, 3.0f), random.Range(-3.0f, 3.0f)), glm::vec3(0.0f));
+		}
+
+		OBBShape box = makeBox(glm::vec3(0.2f, -0.1f, 0.3f), glm::angleAxis(0.6f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f))),
+			glm::vec3(1.0f, 0.5f, 1.5f));
+		ConvexHull sphere = makeSphereHull(HULL_SIZES[1][0], HULL_SIZES[1][1]);
+		HullShape hull(sphere.Points(), sphere.NumPoints());
+
+		runParticles(runner, "query/particles/box", box, particles);
+		runParticles(runner, "query/particles/hull-" + std::to_string(hull.numPoints), hull, particles);
+	}
+}
+
+
+// The sizes of point cloud quickhull is tried on.
+static const int NUM_CLOUD_SIZES = 3;
+static const int CLOUD_SIZES[NUM_CLOUD_SIZES] = { 1000, 10000, 100000 };
+
+// Builds a square of terrain cells on a side, one unit each, two triangles per cell, with gentle hills.
+static void makeTerrain(int cells, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+{
+	positions.clear();
+	indices.clear();
+
+	for (int z = 0; z <= cells; z++)
+	{
+		for (int x = 0; x <= cells; x++)
+		{
+			positions.push_back(glm::vec3((float)x, sinf(x * 0.3f) * cosf(z * 0.2f) * 2.0f, (float)z));
+		}
+	}
+
+	for (int z = 0; z < cells; z++)
+	{
+		for (int x = 0; x < cells; x++)
+		{
+			unsigned int corner = z * (cells + 1) + x;
+
+			indices.push_back(corner);
+			indices.push_back(corner + cells + 1);
+			indices.push_back(corner + 1);
+
+			indices.push_back(corner + 1);
+			indices.push_back(corner + cells + 1);
+			indices.push_back(corner + cells + 2);
+		}
+	}
+}
+
+// Tests cubes resting on (or just above, or sunk into) terrain through a TriangleMesh's tree, through a HeightField of the same terrain,
+// and, for the smaller terrain, against every triangle, which is what the tree saves.
+// A ring (around y, through the origin) with a hole big enough for the benchmark boxes to go through, which one hull would fill in.
+static void makeTorusMesh(int rings, int segments, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+{
+	positions.clear();
+	indices.clear();
+
+	for (int ring = 0; ring < rings; ring++)
+	{
+		float theta = 6.2831853f * ring / rings;
+		glm::vec3 out = glm::vec3(cosf(theta), 0.0f, sinf(theta));
+
+		for (int segment = 0; segment < segments; segment++)
+		{
+			float phi = 6.2831853f * segment / segments;
+
+			positions.push_back(out * (1.0f + 0.3f * cosf(phi)) + glm::vec3(0.0f, 0.3f * sinf(phi), 0.0f));
+		}
+	}
+
+	for (int ring = 0; ring < rings; ring++)
+	{
+		unsigned int current = ring * segments;
+		unsigned int next = ((ring + 1) % rings) * segments;
+
+		for (int segment = 0; segment < segments; segment++)
+		{
+			unsigned int following = (segment + 1) % segments;
+
+			indices.push_back(current + segment);
+			indices.push_back(current + following);
+			indices.push_back(next + segment);
+
+			indices.push_back(next + segment);
+			indices.push_back(current + following);
+			indices.push_back(next + following);
+		}
+	}
+}
+
+// Decomposing a torus, reading the pieces back from the cache, and GJK against them as a compound, next to GJK against the one hull around
+// the whole torus (which is faster per test than it should be, since it's wrong about everything in the hole).
+static void runDecompositionBenchmarks(BenchmarkRunner& runner)
+{
+	if (!runner.Wants("mesh/decompose"))
+	{
+		return;
+	}
+
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+
+	makeTorusMesh(48, 24, positions, indices);
+
+	std::string name = "mesh/decompose/torus-" + std::to_string(indices.size() / 3);
+	DecompositionSettings settings;
+	std::vector<ConvexHull> hulls;
+
+	auto decompose = [&]() -> long long
+	{
+		DecomposeMesh(positions.data(), (int)positions.size(), indices.data(), (int)indices.size(), settings, hulls);
+		Consume((float)hulls.size());
+
+		return -1;
+	};
+
+	runner.Run(name + "/build", (int)indices.size() / 3, decompose);
+
+	// Reading the pieces back out of the cache instead, which is what every start after the first does.
+	HullCache cache(".");
+	unsigned long long key = HashBytes(positions.data(), positions.size() * sizeof(glm::vec3));
+
+	cache.SaveDecomposition(key, hulls);
+
+	auto cached = [&]() -> long long
+	{
+		cache.LoadDecomposition(key, hulls);
+		Consume((float)hulls.size());
+
+		return -1;
+	};
+
+	runner.Run(name + "/cache", (int)indices.size() / 3, cached);
+
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.hulls", key);
+	remove(fileName);
+
+	CompoundShape torus;
+	AddHullsToCompound(hulls, torus);
+	torus.Build();
+	torus.SetPose(glm::vec3(0.0f), glm::quat());
+
+	ConvexHull whole = ConvexHull::FromPoints(positions.data(), (int)positions.size());
+	HullShape wholeShape(whole.Points(), whole.NumPoints());
+
+	// Boxes around the ring, in the hole, and above and below it.
+	BenchmarkRandom random(17);
+	std::vector<OBBShape> boxes(NUM_PAIRS);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		glm::vec3 position = random.Direction() * random.Range(0.0f, 1.5f);
+		position.y *= 0.5f;
+
+		boxes[i] = makeBox(position, random.Orientation(), glm::vec3(0.15f));
+	}
+
+	GJKSolver solver;
+	std::vector<int> found;
+
+	auto runPieces = [&]() -> long long
+	{
+		int hits = 0;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			if (TestCompound(solver, torus, boxes[i], found))
+			{
+				hits++;
+			}
+		}
+
+		Consume((float)hits);
+
+		return -1;
+	};
+
+	auto runWhole = [&]() -> long long
+	{
+		int hits = 0;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			if (TestShapes(solver, wholeShape, boxes[i]))
+			{
+				hits++;
+			}
+		}
+
+		Consume((float)hits);
+
+		return -1;
+	};
+
+	runner.Run(name + "/gjk-" + std::to_string(hulls.size()) + "-pieces", (int)boxes.size(), runPieces);
+	runner.Run(name + "/gjk-whole-hull-" + std::to_string(whole.NumPoints()), (int)boxes.size(), runWhole);
+}
+
+static void runTerrainBenchmarks(BenchmarkRunner& runner, int cells, bool everyTriangle)
+{
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+
+	makeTerrain(cells, positions, indices);
+
+	std::string name = "mesh/terrain-" + std::to_string(indices.size() / 3);
+
+	if (!runner.Wants(name))
+	{
+		return;
+	}
+
+	auto build = [&]() -> long long
+	{
+		TriangleMesh mesh(positions.data(), (int)positions.size(), indices.data(), (int)indices.size());
+		Consume((float)mesh.NumNodes());
+
+		return -1;
+	};
+
+	runner.Run(name + "/build", (int)indices.size() / 3, build);
+
+	TriangleMesh mesh(positions.data(), (int)positions.size(), indices.data(), (int)indices.size());
+
+	// Mapping a saved copy instead, which is what loading a level's collision from the cache costs (the file is only checked, not read in).
+	std::string fileName = "terrain-" + std::to_string(indices.size() / 3) + ".tris";
+	TriangleMesh mapped;
+
+	mesh.Save(fileName);
+
+	auto open = [&]() -> long long
+	{
+		mapped.Open(fileName);
+		Consume((float)mapped.NumNodes());
+
+		return -1;
+	};
+
+	runner.Run(name + "/open", (int)indices.size() / 3, open);
+
+	BenchmarkRandom random(13);
+	std::vector<OBBShape> boxes(NUM_PAIRS);
+
+	for (int i = 0; i < NUM_PAIRS; i++)
+	{
+		float x = random.Range(1.0f, cells - 1.0f);
+		float z = random.Range(1.0f, cells - 1.0f);
+		float height = sinf(x * 0.3f) * cosf(z * 0.2f) * 2.0f;
+
+		boxes[i] = makeBox(glm::vec3(x, height + random.Range(-0.5f, 1.0f), z), random.Orientation());
+	}
+
+	GJKSolver solver;
+	EPASolver epa;
+	std::vector<int> found;
+	std::vector<TriangleMeshContact> contacts;
+
+	auto test = [&]() -> long long
+	{
+		int hits = 0;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			if (TestMesh(solver, mesh, boxes[i], found))
+			{
+				hits++;
+			}
+		}
+
+		Consume((float)hits);
+
+		return -1;
+	};
+
+	auto collide = [&]() -> long long
+	{
+		contacts.clear();
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			CollideMesh(solver, epa, mesh, boxes[i], found, contacts);
+		}
+
+		Consume((float)contacts.size());
+
+		return -1;
+	};
+
+	runner.Run(name + "/test-box", (int)boxes.size(), test);
+	runner.Run(name + "/contacts-box", (int)boxes.size(), collide);
+
+	// The mapped mesh has to find exactly what the one it was saved from does.
+	if (!mapped.IsMapped() || mapped.NumTriangles() != mesh.NumTriangles())
+	{
+		printf("%s: the saved mesh didn't open.\n", name.c_str());
+	}
+	else
+	{
+		std::vector<int> mappedFound;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			found.clear();
+			mappedFound.clear();
+			mesh.Query(getBoundsFromSupport(boxes[i]), found);
+			mapped.Query(getBoundsFromSupport(boxes[i]), mappedFound);
+
+			if (found != mappedFound)
+			{
+				printf("%s: the saved mesh finds different triangles.\n", name.c_str());
+				break;
+			}
+		}
+	}
+
+	mapped = TriangleMesh();
+	remove(fileName.c_str());
+
+	// The same terrain as a HeightField, which finds the cells under each cube straight from its bounds instead of walking a tree.
+	std::vector<float> heights(positions.size());
+
+	for (int i = 0; i < (int)positions.size(); i++)
+	{
+		heights[i] = positions[i].y;
+	}
+
+	HeightField field(heights.data(), cells + 1, cells + 1, 1.0f);
+
+	auto testField = [&]() -> long long
+	{
+		int hits = 0;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			if (TestMesh(solver, field, boxes[i], found))
+			{
+				hits++;
+			}
+		}
+
+		Consume((float)hits);
+
+		return -1;
+	};
+
+	auto collideField = [&]() -> long long
+	{
+		contacts.clear();
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			CollideMesh(solver, epa, field, boxes[i], found, contacts);
+		}
+
+		Consume((float)contacts.size());
+
+		return -1;
+	};
+
+	runner.Run(name + "/test-box/heightfield", (int)boxes.size(), testField);
+	runner.Run(name + "/contacts-box/heightfield", (int)boxes.size(), collideField);
+
+	if (!everyTriangle)
+	{
+		return;
+	}
+
+	auto testEvery = [&]() -> long long
+	{
+		int hits = 0;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			for (int j = 0; j < mesh.NumTriangles(); j++)
+			{
+				if (solver.TestGJK(mesh.GetTriangle(j), boxes[i]))
+				{
+					hits++;
+					break;
+				}
+			}
+		}
+
+		Consume((float)hits);
+
+		return -1;
+	};
+
+	runner.Run(name + "/test-box/every-triangle", (int)boxes.size(), testEvery);
+}
+
+// Cubes lying flat on a floor cut up into triangles a tenth of their size, so each one touches dozens of triangles: finding all of those
+// contacts, and then reducing them down to a manifold's worth (see ContactManifold::AddReduced).
+static void runContactReductionBenchmarks(BenchmarkRunner& runner)
+{
+	const int cells = 64;
+	const float spacing = 0.1f;
+	std::string name = "mesh/fine-floor-" + std::to_string(cells * cells * 2);
+
+	if (!runner.Wants(name))
+	{
+		return;
+	}
+
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+
+	makeTerrain(cells, positions, indices);
+
+	for (int i = 0; i < (int)positions.size(); i++)
+	{
+		positions[i] = glm::vec3(positions[i].x * spacing, 0.0f, positions[i].z * spacing);
+	}
+
+	TriangleMesh mesh(positions.data(), (int)positions.size(), indices.data(), (int)indices.size());
+
+	// Sunk a hundredth of a unit into the floor, and turned only about the vertical, so the whole bottom face is touching.
+	BenchmarkRandom random(29);
+	std::vector<OBBShape> boxes(NUM_HULL_PAIRS);
+	float floorSize = cells * spacing;
+
+	for (int i = 0; i < NUM_HULL_PAIRS; i++)
+	{
+		glm::vec3 position = glm::vec3(random.Range(1.0f, floorSize - 1.0f), 0.49f, random.Range(1.0f, floorSize - 1.0f));
+
+		boxes[i] = makeBox(position, glm::angleAxis(random.Range(0.0f, 6.2831853f), glm::vec3(0.0f, 1.0f, 0.0f)));
+	}
+
+	GJKSolver solver;
+	EPASolver epa;
+	std::vector<int> found;
+	std::vector<TriangleMeshContact> contacts;
+	std::vector<const EPAResult*> results;
+	std::vector<ContactManifold> manifolds(boxes.size());
+	glm::mat4 identity = glm::mat4(1.0f);
+
+	auto collide = [&]() -> long long
+	{
+		int total = 0;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			contacts.clear();
+			total += CollideMesh(solver, epa, mesh, boxes[i], found, contacts);
+		}
+
+		Consume((float)total);
+
+		return -1;
+	};
+
+	auto reduce = [&]() -> long long
+	{
+		int total = 0;
+
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			contacts.clear();
+			CollideMesh(solver, epa, mesh, boxes[i], found, contacts);
+
+			results.resize(contacts.size());
+
+			for (int j = 0; j < (int)contacts.size(); j++)
+			{
+				results[j] = &contacts[j].contact;
+			}
+
+			manifolds[i].Clear();
+			manifolds[i].AddReduced(results.data(), (int)results.size(), identity, identity);
+			total += manifolds[i].Size();
+		}
+
+		Consume((float)total);
+
+		return -1;
+	};
+
+	runner.Run(name + "/contacts-box", (int)boxes.size(), collide);
+	runner.Run(name + "/contacts-box/reduced", (int)boxes.size(), reduce);
+
+	// The four points kept should still span most of each cube's unit square footprint (they can only be in as far as the triangles they
+	// came from), and the normal should point straight up out of the floor.
+	reduce();
+
+	for (int i = 0; i < (int)manifolds.size(); i++)
+	{
+		const ContactManifold& manifold = manifolds[i];
+		float area = 0.0f;
+
+		if (manifold.Size() == 4)
+		{
+			glm::vec3 p[4];
+
+			for (int j = 0; j < 4; j++)
+			{
+				p[j] = manifold[j].worldA;
+			}
+
+			// The four points could be in any order, so take the biggest of the three ways of splitting them into two triangles.
+			for (int j = 1; j < 4; j++)
+			{
+				int k = j == 1 ? 2 : 1;
+				int l = 6 - j - k;
+				glm::vec3 diagonal = glm::cross(p[j] - p[0], p[l] - p[k]);
+
+				area = glm::max(area, 0.5f * glm::length(diagonal));
+			}
+		}
+
+		if (area < 0.5f || manifold.GetNormal().y < 0.99f)
+		{
+			printf("%s: cube %d kept %d points covering %.3f with normal y %.3f\n", name.c_str(), i, manifold.Size(), area,
+				manifold.GetNormal().y);
+			break;
+		}
+	}
+}
+
+void RunMeshBenchmarks(BenchmarkRunner& runner)
+{
+	// Points scattered through a ball, like the vertices of a detailed (and not at all convex) model: only a few hundred of them end up on
+	// the hull, and the rest are thrown away along the way.
+	for (int i = 0; i < NUM_CLOUD_SIZES; i++)
+	{
+		BenchmarkRandom random(11);
+		std::vector<glm::vec3> cloud(CLOUD_SIZES[i]);
+
+		for (int j = 0; j < CLOUD_SIZES[i]; j++)
+		{
+			cloud[j] = random.Direction() * 0.5f * powf(random.Next(), 1.0f / 3.0f);
+		}
+
+		auto build = [&]() -> long long
+		{
+			ConvexHull hull = ConvexHull::FromPoints(cloud.data(), (int)cloud.size());
+			Consume((float)hull.NumPoints());
+
+			return -1;
+		};
+
+		runner.Run("mesh/quickhull/cloud-" + std::to_string(CLOUD_SIZES[i]), CLOUD_SIZES[i], build);
+	}
+
+	// A sphere, where every point is on the hull, which is the most work quickhull can be given for its size.
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+
+	makeSphereMesh(64, 128, positions, indices);
+
+	auto sphere = [&]() -> long long
+	{
+		ConvexHull hull = ConvexHull::FromPoints(positions.data(), (int)positions.size());
+		Consume((float)hull.NumPoints());
+
+		return -1;
+	};
+
+	runner.Run("mesh/quickhull/sphere-" + std::to_string(positions.size()), (int)positions.size(), sphere);
+
+	// Simplifying the sphere's hull down to a budget.
+	ConvexHull sphereHull = ConvexHull::FromPoints(positions.data(), (int)positions.size());
+
+	auto simplify = [&]() -> long long
+	{
+		ConvexHull simple = ConvexHull::Simplify(sphereHull, HULL_VERTEX_BUDGET);
+		Consume((float)simple.NumPoints());
+
+		return -1;
+	};
+
+	runner.Run("mesh/simplify/sphere-" + std::to_string(sphereHull.NumPoints()) + "-to-" + std::to_string(HULL_VERTEX_BUDGET), sphereHull.NumPoints(), simplify);
+
+	// Building levels of detail for the sphere's mesh, per triangle of the full mesh.
+	auto lodChain = [&]() -> long long
+	{
+		std::vector<MeshLOD> lods;
+		BuildMeshLODs(positions.data(), (int)positions.size(), indices.data(), (int)indices.size(), 4, lods);
+		Consume((float)lods.size());
+
+		return -1;
+	};
+
+	runner.Run("mesh/lod-chain/sphere-" + std::to_string(indices.size() / 3), (int)indices.size() / 3, lodChain);
+
+	// Reordering the sphere's triangles for the vertex cache and then for overdraw, from a shuffled order (the worst there is for the cache),
+	// per triangle.
+	std::vector<unsigned int> shuffled = indices;
+	BenchmarkRandom shuffleRandom(17);
+
+	for (int i = (int)shuffled.size() / 3 - 1; i > 0; i--)
+	{
+		int j = (int)(shuffleRandom.NextInt() % (unsigned int)(i + 1));
+
+		std::swap_ranges(shuffled.begin() + i * 3, shuffled.begin() + i * 3 + 3, shuffled.begin() + j * 3);
+	}
+
+	std::vector<unsigned int> optimized;
+
+	auto vertexCache = [&]() -> long long
+	{
+		optimized = shuffled;
+		OptimizeVertexCache(optimized.data(), (int)optimized.size(), (int)positions.size());
+		Consume((float)optimized[0]);
+
+		return -1;
+	};
+
+	runner.Run("mesh/vertex-cache/sphere-" + std::to_string(indices.size() / 3), (int)indices.size() / 3, vertexCache);
+
+	auto overdraw = [&]() -> long long
+	{
+		OptimizeOverdraw(positions.data(), optimized.data(), (int)optimized.size(), (int)positions.size());
+		Consume((float)optimized[0]);
+
+		return -1;
+	};
+
+	runner.Run("mesh/overdraw/sphere-" + std::to_string(indices.size() / 3), (int)indices.size() / 3, overdraw);
+
+	// Reading the same hull back out of the cache instead, which is what every start after the first does.
+	if (runner.Wants("mesh/hull-cache"))
+	{
+		HullCache cache(".");
+		unsigned long long key = HashBytes(positions.data(), positions.size() * sizeof(glm::vec3));
+
+		cache.Save(key, ConvexHull::FromPoints(positions.data(), (int)positions.size()));
+
+		auto cached = [&]() -> long long
+		{
+			ConvexHull hull;
+			cache.Load(key, hull);
+			Consume((float)hull.NumPoints());
+
+			return -1;
+		};
+
+		runner.Run("mesh/hull-cache/sphere-" + std::to_string(positions.size()), (int)positions.size(), cached);
+
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "%016llx.hull", key);
+		remove(fileName);
+	}
+
+	// Getting the sphere (mesh and hull) into an AssetStore, per vertex: added from the mesh, which copies it and builds the hull, or opened
+	// from an asset pack, which only maps it. Then 50 worlds' worth of references to it, which cost a lookup each and no copies.
+	if (runner.Wants("mesh/assets"))
+	{
+		const char* packName = "bench-assets.gjka";
+		std::string name = "mesh/assets/sphere-" + std::to_string(positions.size());
+
+		{
+			AssetStore store;
+			const SharedMesh* sphere = store.AddMesh("sphere", positions.data(), (int)positions.size(), indices.data(), (int)indices.size());
+
+			store.SavePack(packName);
+			store.Release(sphere);
+		}
+
+		auto add = [&]() -> long long
+		{
+			AssetStore store;
+			const SharedMesh* asset = store.AddMesh("sphere", positions.data(), (int)positions.size(), indices.data(), (int)indices.size());
+			Consume((float)asset->numHullPoints);
+
+			return -1;
+		};
+
+		auto open = [&]() -> long long
+		{
+			AssetStore store;
+			store.OpenPack(packName);
+			const SharedMesh* asset = store.Acquire("sphere");
+			Consume((float)asset->numHullPoints);
+
+			return -1;
+		};
+
+		runner.Run(name + "/add", (int)positions.size(), add);
+		runner.Run(name + "/open-pack", (int)positions.size(), open);
+
+		AssetStore shared;
+		shared.OpenPack(packName);
+
+		const SharedMesh* held[50];
+
+		auto acquire = [&]() -> long long
+		{
+			for (int i = 0; i < 50; i++)
+			{
+				held[i] = shared.Acquire("sphere");
+				Consume((float)held[i]->numPositions);
+			}
+			for (int i = 0; i < 50; i++)
+			{
+				shared.Release(held[i]);
+			}
+
+			return -1;
+		};
+
+		runner.Run(name + "/acquire-50", 50, acquire);
+
+		remove(packName);
+	}
+
+	// Importing the sphere as an OBJ, per vertex.
+	std::string obj;
+	char line[128];
+
+	for (int i = 0; i < (int)positions.size(); i++)
+	{
+		snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", positions[i].x, positions[i].y, positions[i].z);
+		obj += line;
+	}
+
+	for (int i = 0; i + 2 < (int)indices.size(); i += 3)
+	{
+		snprintf(line, sizeof(line), "f %u %u %u\n", indices[i] + 1, indices[i + 1] + 1, indices[i + 2] + 1);
+		obj += line;
+	}
+
+	auto import = [&]() -> long long
+	{
+		SceneModel model;
+		std::string error;
+
+		ImportOBJ(obj.data(), obj.size(), model, error);
+		Consume((float)model.indices.size());
+
+		return -1;
+	};
+
+	runner.Run("mesh/import-obj/sphere-" + std::to_string(positions.size()), (int)positions.size(), import);
+
+	runDecompositionBenchmarks(runner);
+
+	runTerrainBenchmarks(runner, 16, true);
+	runTerrainBenchmarks(runner, 256, false);
+	runContactReductionBenchmarks(runner);
+}
+
+#endif // _CORE_BENCHMARKS_CPP
@@ -0,0 +1,73 @@
+/*
+Title: GJK-3D (OBB)
+File Name: CoreBenchmarks.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CORE_BENCHMARKS_H
+#define _CORE_BENCHMARKS_H
+
+#include "Benchmark.h"
+
+// GJK queries between pairs of boxes in each of the situations that behave differently (separated, touching, deeply penetrating,
+// degenerate and rotating), and between hulls of increasing size with both support functions.
+// Each one is run from scratch ("cold") and again with a GJKCache, which is how the narrowphase runs them.
+// Then the distance query, with each sub-algorithm (see GJKSubAlgorithm), on pairs that are far apart, nearly touching and overlapping.
+// Then the planar solver (GJKSolver2D) against the 3D one on the same flat pairs. And last, time of impact queries on fast pairs, with
+// and without the swept hull test ruling out the ones that can't hit first.
+void RunGJKBenchmarks(BenchmarkRunner& runner);
+
+// The support function of every shape on its own, in random directions (and, for hill-climbing, in slowly turning ones).
+void RunSupportBenchmarks(BenchmarkRunner& runner);
+
+// Building transformation matrices: one body at a time (what GameObject::CalculateMatrices does), all of the dirty ones at once, and
+// the batched, interpolated and integrated versions (integrating on every thread too, split on blocks of bodies and not). Also creating
+// and destroying bodies, for debris.
+void RunTransformBenchmarks(BenchmarkRunner& runner);
+
+// The contact solver on a pile of stacked boxes, one point at a time and colored into SIMD blocks. Then whole steps of a scene played
+// again from a saved state, which once warmed up mustn't allocate anything, and the same steps fast forwarded (see PhysicsWorld::Advance).
+void RunSolverBenchmarks(BenchmarkRunner& runner);
+
+// Ray and sphere casts into a scene of cubes: through each broadphase, and against every cube one by one (which is what the broadphase saves).
+// Also rebuilding the cubes' tree with the surface area heuristic, and looking up each cube's bounds in it before and after, sorting a
+// broadphase's worth of pairs (see SortPairs), and colliding particles against a box and a hull a group at a time (see
+// ParticleCollisionSolver) and one at a time.
+void RunQueryBenchmarks(BenchmarkRunner& runner);
+
+// Building convex hulls with quickhull (from clouds of points and from a sphere, where every point is on the hull), reading one back from a
+// HullCache instead, importing a mesh from an OBJ, and building (or mapping a saved one) and testing cubes against terrain as a TriangleMesh
+// and as a HeightField.
+void RunMeshBenchmarks(BenchmarkRunner& runner);
+
+#endif //_CORE_BENCHMARKS_H
@@ -0,0 +1,648 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Main.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+// Benchmarks for the physics core, with no window. Every benchmark runs the same scenario every time, so its numbers can be compared from
+// one build (or one change) to the next.
+//
+// Usage: Benchmarks [--quick] [regression options] [filter]
+// Only benchmarks with the filter in their name are run (so "gjk/box" runs just the box GJK ones, "support" just the support functions,
+// "query" just the ray and shape casts, "mesh" just importing meshes and building their hulls).
+// --quick runs each benchmark only once, to check that they all work, rather than to time them.
+//
+// The regression options (which --scene takes too) keep track of the numbers from one run to the next (see Regression.h):
+//   --json FILE			Writes every benchmark's ns/query (or every scene's ms/step) to FILE as JSON, which can be the next run's baseline.
+//   --baseline FILE		Compares them with a file written by --json, and exits with 2 if any got slower by more than the threshold.
+//   --threshold F			How much slower counts as a regression, as a fraction (0.1, which is 10%).
+//   --threshold-for NAME F	A different threshold for the benchmarks with NAME in their names, for the noisy ones. Can be given more than once.
+//
+// Usage: Benchmarks --scene [options]
+// Builds scenes of moving cubes and times each stage of the physics step, for each number of cubes and each broadphase. The options are:
+//   --count N				Adds N to the cube counts to run. Without any, it runs 10, 100, 1000 and so on up to 1000000.
+//   --steps K				Runs K steps of each scene (10).
+//   --broadphase NAME		tree, sap, grid, lbvh or all (tree). Can be given more than once.
+//   --threads T			The threads to run on, counting the main one (0, which is one per hardware thread).
+//   --density D			Cubes per unit of volume (0.125).
+//   --speed S				The fastest a cube can move, in units per second (2).
+//   --sizes fixed|uniform|mixed, --size MIN MAX	How big the cubes are (uniform, from 0.1 to 0.5).
+//   --seed S				Picks a different (but still repeatable) scene.
+//   --debris F			Makes a fraction F of the cubes debris, which doesn't collide with other debris (see CollisionFilter) (0).
+//   --triggers F			Makes a fraction F of the cubes triggers, which only report overlaps (see PhysicsWorld::SetTrigger) (0).
+//   --static F			Makes a fraction F of the cubes static, which never move (see PhysicsWorld::SetBodyType) (0).
+//   --speculative			Gives the fast cubes speculative contacts instead of sweeping them (see PhysicsWorld::SetSpeculativeContacts).
+//   --maintenance MS		Gives each step MS milliseconds for upkeep, which puts the tree back in shape a slice at a time rather than
+//							rebuilding it all at once every 60 steps (see PhysicsWorld::SetMaintenanceBudget).
+//   --pair-costs N		Times every pair the narrowphase tests, and prints the N that cost the most over the run under each scene's row,
+//							with their shapes (see PhysicsWorld::SetPairCosts).
+//   --limits				Sets the world's limits to the scene's count of objects, pairs and contacts before building it, so everything a
+//							step uses is set aside up front and the allocs column should be 0 (see PhysicsWorld::SetLimits).
+//   --pipelined			Moves the tree's proxies and finds its pairs for each step during the step before, alongside the solver (see
+//							PhysicsWorld::SetPipelinedBroadphase).
+//   --island-rates S		Steps the islands whose objects are all going slower than S less often, up to every 4 steps (see
+//							PhysicsWorld::SetIslandRates).
+//   --hulls F			Gives a fraction F of the cubes a hull with their corners cut off, which the pairs their boxes hit are tested
+//							again with (see PhysicsWorld::SetHull) (0).
+//   --large-islands N	Solves the islands with at least N contacts on their own, with each color of their points split between the threads
+//							(see PhysicsWorld::SetLargeIslandSize) (0, off).
+//   --huge-pages			Puts the bodies, broadphase nodes and step arenas on huge pages where the OS will give them (see AllocatePages),
+//							and prints how many of the big allocations got them.
+//   --shadow F			Tests a fraction F of the pairs again every step with the plain TestGJK, and prints how many answers were different
+//							under each scene's row (see PhysicsWorld::SetShadowChecks).
+//   --trace FILE			Profiles every step, and writes it all out as a Chrome trace (see Profiler.h).
+//   --metrics FILE		Appends a line of JSON to FILE every second, and one at the end, with the step time percentiles, counts, GJK
+//							iterations and memory use (see PhysicsMetrics), the way a headless server would log them.
+//   --gjk-stats			Counts how every GJK query goes, and prints a breakdown (see GJKStats) under each scene's row.
+//   --files				Rather than running the scenes, saves each one as a scene file and times loading it (see SceneFile.h), and the
+//							same for the world built from it (see WorldSnapshot).
+//   --determinism			Rather than timing the scenes, runs each one in deterministic mode on one thread and on T threads, and checks that
+//							they come out exactly the same after every step (see PhysicsWorld::SetDeterministic).
+//   --record FILE			Rather than timing the scenes, records the first one to FILE (see SimulationRecorder).
+//   --snapshots			Rather than timing the steps, measures how big each step's StateSnapshot is, on its own and as a delta against the
+//							step before, and how long they take to encode and decode.
+//   --rollback			Rather than timing the steps, saves the world's state every step and every 10 steps rolls back 10 and runs them
+//							again, timing the saves, restores and steps run again, and checks it comes out the same (see
+//							PhysicsWorld::SaveState).
+//   --stream			Rather than running the scenes, saves a row of 16 regions, each a scene of N cubes, and times streaming them in
+//							and out (see WorldStreamer) around a point that moves along the row over the steps.
+//   --lod				Runs each scene in full and then again with level of detail around its middle (see
+//							PhysicsWorld::SetLevelOfDetail), and times them side by side.
+//   --interest C		Runs each scene with C clients, each following a cube and interested in everything near it, and times
+//							working out what each one can see after every step (see InterestManager).
+//   --worlds W			Runs W worlds of each scene on one job system, one world after another and then all at once with StepWorlds,
+//							and times them side by side.
+//   --numa P			With --worlds, lays the job system's threads out over the NUMA nodes as P says: spread (a thread on each node
+//							in turn) or compact (filling one node before the next). The default is off, treating the machine as one node.
+//   --pin				With --worlds, pins each of the job system's threads to a core of its own (see JobSystemSettings).
+//   --background P		Builds debug drawing for every cube (P passes over its box) alongside each step, once as critical work and once
+//							as background work (see JobPriority), and times the steps and whole frames side by side.
+//   --batch W			Rather than running the scenes, runs W copies of the demo's two cubes as a PhysicsWorld each and as one
+//							WorldBatch, and times them side by side.
+// Note that sweep and prune sorts its endpoints with an insertion sort, which is quick when they've barely moved since the last step, but
+// goes over every pair of endpoints the first time around. Give it no more than about 100000 cubes.
+//
+// Usage: Benchmarks --replay FILE [--threads T]
+// Plays back a recording as fast as it goes, and compares how long its steps take with how long they took when they were recorded. A spike
+// that was recorded somewhere else can be played back here as many times as it takes to find out what it was, and to check that a change
+// fixed it.
+//
+// Make sure to time a Release build. Debug builds check every std::vector access, which is most of what they'd be timing.
+
+#include "Benchmark.h"
+#include "CoreBenchmarks.h"
+#include "MemoryTracker.h"
+#include "Regression.h"
+#include "SceneBenchmark.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Turns a broadphase's name on the command line into its number, or -1 for all of them (or -2 if there's no such broadphase).
+static int parseBroadphase(const char* name)
+{
+	if (strcmp(name, "tree") == 0)
+	{
+		return 0;
+	}
+	if (strcmp(name, "sap") == 0)
+	{
+		return 1;
+	}
+	if (strcmp(name, "grid") == 0)
+	{
+		return 2;
+	}
+	if (strcmp(name, "lbvh") == 0)
+	{
+		return 3;
+	}
+	if (strcmp(name, "all") == 0)
+	{
+		return -1;
+	}
+
+	return -2;
+}
+
+// Where the measurements go and what they're compared against (see the regression options above).
+struct RegressionOptions
+{
+	std::string jsonFileName;
+	std::string baselineFileName;
+	RegressionSettings settings;
+};
+
+// Reads the regression option at argv[i], if it is one, moving i past its values. Returns false if it isn't one.
+static bool parseRegressionOption(int argc, char** argv, int& i, RegressionOptions& options)
+{
+	if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+	{
+		options.jsonFileName = argv[++i];
+	}
+	else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+	{
+		options.baselineFileName = argv[++i];
+	}
+	else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+	{
+		options.settings.threshold = atof(argv[++i]);
+	}
+	else if (strcmp(argv[i], "--threshold-for") == 0 && i + 2 < argc)
+	{
+		std::string name = argv[++i];
+		options.settings.thresholds.push_back(std::make_pair(name, atof(argv[++i])));
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+// Writes and compares the measurements as the options say. Returns the exit code: 0 if all went well, 1 if a file couldn't be written or
+// read, and 2 if anything regressed.
+static int checkRegressions(const std::vector<BenchmarkMeasurement>& measurements, const RegressionOptions& options)
+{
+	// The baseline is read first, so it can be the same file that this run's measurements are about to replace.
+	std::vector<BenchmarkMeasurement> baseline;
+
+	if (!options.baselineFileName.empty() && !ReadMeasurements(options.baselineFileName, baseline))
+	{
+		printf("Couldn't read any measurements from %s.\n", options.baselineFileName.c_str());
+		return 1;
+	}
+
+	if (!options.jsonFileName.empty() && !WriteMeasurements(options.jsonFileName, measurements))
+	{
+		printf("Couldn't write the measurements to %s.\n", options.jsonFileName.c_str());
+		return 1;
+	}
+
+	if (options.baselineFileName.empty())
+	{
+		return 0;
+	}
+
+	printf("\n");
+
+	return CompareMeasurements(baseline, measurements, options.settings) > 0 ? 2 : 0;
+}
+
+static int runScenes(int argc, char** argv)
+{
+	SceneSettings settings;
+	std::vector<int> counts;
+	std::vector<int> broadphases;
+	int steps = 10;
+	int threads = 0;
+	std::string traceFileName;
+	std::string metricsFileName;
+	bool gjkStats = false;
+	bool files = false;
+	bool determinism = false;
+	bool snapshots = false;
+	bool rollback = false;
+	bool stream = false;
+	bool lod = false;
+	int worlds = 0;
+	int batch = 0;
+	int background = 0;
+	int interest = 0;
+	JobSystemSettings jobSettings;
+	std::string recordFileName;
+	RegressionOptions regression;
+
+	for (int i = 2; i < argc; i++)
+	{
+		// Every option but --gjk-stats, --files, --determinism, --snapshots, --rollback, --stream, --lod, --speculative and --huge-pages takes
+		// a value (and --size takes two).
+		bool hasValue = i + 1 < argc;
+
+		if (parseRegressionOption(argc, argv, i, regression))
+		{
+			continue;
+		}
+
+		if (strcmp(argv[i], "--gjk-stats") == 0)
+		{
+			gjkStats = true;
+		}
+		else if (strcmp(argv[i], "--files") == 0)
+		{
+			files = true;
+		}
+		else if (strcmp(argv[i], "--determinism") == 0)
+		{
+			determinism = true;
+		}
+		else if (strcmp(argv[i], "--snapshots") == 0)
+		{
+			snapshots = true;
+		}
+		else if (strcmp(argv[i], "--rollback") == 0)
+		{
+			rollback = true;
+		}
+		else if (strcmp(argv[i], "--stream") == 0)
+		{
+			stream = true;
+		}
+		else if (strcmp(argv[i], "--lod") == 0)
+		{
+			lod = true;
+		}
+		else if (strcmp(argv[i], "--speculative") == 0)
+		{
+			settings.speculative = true;
+		}
+		else if (strcmp(argv[i], "--shadow") == 0 && hasValue)
+		{
+			settings.shadowChecks = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--interest") == 0 && hasValue)
+		{
+			interest = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--worlds") == 0 && hasValue)
+		{
+			worlds = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--numa") == 0 && hasValue)
+		{
+			i++;
+
+			if (strcmp(argv[i], "spread") == 0)
+			{
+				jobSettings.numa = NUMA_SPREAD;
+			}
+			else if (strcmp(argv[i], "compact") == 0)
+			{
+				jobSettings.numa = NUMA_COMPACT;
+			}
+			else if (strcmp(argv[i], "off") != 0)
+			{
+				printf("There is no NUMA policy called \"%s\". Use off, spread or compact.\n", argv[i]);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--background") == 0 && hasValue)
+		{
+			background = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--pin") == 0)
+		{
+			jobSettings.pinThreads = true;
+		}
+		else if (strcmp(argv[i], "--maintenance") == 0 && hasValue)
+		{
+			settings.maintenance = atof(argv[++i]) / 1000.0;
+		}
+		else if (strcmp(argv[i], "--pair-costs") == 0 && hasValue)
+		{
+			settings.pairCosts = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--limits") == 0)
+		{
+			settings.limits = true;
+		}
+		else if (strcmp(argv[i], "--pipelined") == 0)
+		{
+			settings.pipelined = true;
+		}
+		else if (strcmp(argv[i], "--island-rates") == 0 && hasValue)
+		{
+			settings.islandRates = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--hulls") == 0 && hasValue)
+		{
+			settings.hulls = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--large-islands") == 0 && hasValue)
+		{
+			settings.largeIslands = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--huge-pages") == 0)
+		{
+			SetHugePages(true);
+		}
+		else if (strcmp(argv[i], "--batch") == 0 && hasValue)
+		{
+			batch = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--record") == 0 && hasValue)
+		{
+			recordFileName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--count") == 0 && hasValue)
+		{
+			counts.push_back(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--steps") == 0 && hasValue)
+		{
+			steps = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+		{
+			threads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--density") == 0 && hasValue)
+		{
+			settings.density = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--speed") == 0 && hasValue)
+		{
+			settings.speed = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--metrics") == 0 && hasValue)
+		{
+			metricsFileName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && hasValue)
+		{
+			traceFileName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+		{
+			settings.seed = (unsigned int)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--debris") == 0 && hasValue)
+		{
+			settings.debris = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--triggers") == 0 && hasValue)
+		{
+			settings.triggers = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--static") == 0 && hasValue)
+		{
+			settings.statics = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--size") == 0 && i + 2 < argc)
+		{
+			settings.minSize = (float)atof(argv[++i]);
+			settings.maxSize = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--sizes") == 0 && hasValue)
+		{
+			const char* sizes = argv[++i];
+
+			settings.sizes = strcmp(sizes, "fixed") == 0 ? SIZES_FIXED : strcmp(sizes, "mixed") == 0 ? SIZES_MIXED : SIZES_UNIFORM;
+		}
+		else if (strcmp(argv[i], "--broadphase") == 0 && hasValue)
+		{
+			int broadphase = parseBroadphase(argv[++i]);
+
+			if (broadphase == -2)
+			{
+				printf("There is no broadphase called \"%s\". Use tree, sap, grid, lbvh or all.\n", argv[i]);
+				return 1;
+			}
+
+			for (int j = 0; j < PhysicsWorld::NUM_BROADPHASES; j++)
+			{
+				if ((broadphase == -1 || broadphase == j) && std::find(broadphases.begin(), broadphases.end(), j) == broadphases.end())
+				{
+					broadphases.push_back(j);
+				}
+			}
+		}
+		else
+		{
+			printf("Unknown option \"%s\".\n", argv[i]);
+			return 1;
+		}
+	}
+
+	if (counts.empty())
+	{
+		for (int count = 10; count <= 1000000; count *= 10)
+		{
+			counts.push_back(count);
+		}
+	}
+
+	if (broadphases.empty())
+	{
+		broadphases.push_back(0);
+	}
+
+	if (files)
+	{
+		return RunSceneFileBenchmarks(settings, counts, threads) ? 0 : 1;
+	}
+
+	if (determinism)
+	{
+		return RunDeterminismChecks(settings, counts, broadphases, steps, threads) ? 0 : 1;
+	}
+
+	if (!recordFileName.empty())
+	{
+		SceneSettings scene = settings;
+		scene.count = counts[0];
+
+		return RecordScene(scene, steps, broadphases[0], threads, recordFileName) ? 0 : 1;
+	}
+
+	if (snapshots)
+	{
+		return RunSnapshotBenchmarks(settings, counts, steps, threads) ? 0 : 1;
+	}
+
+	if (rollback)
+	{
+		return RunRollbackBenchmarks(settings, counts, steps, threads) ? 0 : 1;
+	}
+
+	if (stream)
+	{
+		return RunStreamingBenchmarks(settings, counts, steps, threads) ? 0 : 1;
+	}
+
+	if (lod)
+	{
+		RunLevelOfDetailBenchmarks(settings, counts, steps, threads);
+		return 0;
+	}
+
+	if (interest > 0)
+	{
+		RunInterestBenchmarks(settings, counts, steps, interest, threads);
+		return 0;
+	}
+
+	if (background > 0)
+	{
+		RunPriorityBenchmarks(settings, counts, steps, background, threads);
+		return 0;
+	}
+
+	if (batch > 0)
+	{
+		RunBatchedWorldBenchmarks(settings, batch, steps, threads);
+		return 0;
+	}
+
+	if (worlds > 0)
+	{
+		jobSettings.threadCount = threads;
+		RunManyWorldBenchmarks(settings, counts, worlds, steps, jobSettings);
+		return 0;
+	}
+
+	Profiler& profiler = Profiler::Get();
+
+	if (!traceFileName.empty())
+	{
+		profiler.SetEnabled(true);
+		profiler.StartCapture();
+	}
+
+	PhysicsMetrics metrics;
+
+	if (!metricsFileName.empty() && !metrics.OpenLog(metricsFileName, 1.0))
+	{
+		printf("Couldn't open %s for the metrics.\n", metricsFileName.c_str());
+		return 1;
+	}
+
+	std::vector<SceneResult> results;
+
+	RunSceneBenchmarks(settings, counts, broadphases, steps, threads, gjkStats, metricsFileName.empty() ? nullptr : &metrics, &results);
+
+	if (GetHugePages())
+	{
+		HugePageUsage usage = GetHugePageUsage();
+
+		printf("Huge pages: %lld of %lld big allocations got them.\n", usage.granted, usage.requested);
+	}
+
+	if (!traceFileName.empty() && !profiler.WriteChromeTrace(traceFileName))
+	{
+		printf("Couldn't write the trace to %s.\n", traceFileName.c_str());
+		return 1;
+	}
+
+	std::vector<BenchmarkMeasurement> measurements;
+	AddMeasurements(results, measurements);
+
+	return checkRegressions(measurements, regression);
+}
+
+// Plays back a recording (see --replay above).
+static int runReplay(int argc, char** argv)
+{
+	std::string fileName = argv[2];
+	int threads = 0;
+
+	for (int i = 3; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = atoi(argv[++i]);
+		}
+		else
+		{
+			printf("Unknown option \"%s\".\n", argv[i]);
+			return 1;
+		}
+	}
+
+	return ReplayRecording(fileName, threads) ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1 && strcmp(argv[1], "--scene") == 0)
+	{
+		return runScenes(argc, argv);
+	}
+
+	if (argc > 2 && strcmp(argv[1], "--replay") == 0)
+	{
+		return runReplay(argc, argv);
+	}
+
+	std::string filter;
+	bool quick = false;
+	RegressionOptions regression;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (parseRegressionOption(argc, argv, i, regression))
+		{
+			continue;
+		}
+
+		if (strcmp(argv[i], "--quick") == 0)
+		{
+			quick = true;
+		}
+		else
+		{
+			filter = argv[i];
+		}
+	}
+
+	BenchmarkRunner runner(filter);
+
+	if (quick)
+	{
+		runner.SetMinRuns(1);
+		runner.SetMinSeconds(0.0);
+	}
+
+	RunGJKBenchmarks(runner);
+	RunSupportBenchmarks(runner);
+	RunTransformBenchmarks(runner);
+	RunSolverBenchmarks(runner);
+	RunQueryBenchmarks(runner);
+	RunMeshBenchmarks(runner);
+
+	if (runner.GetResults().empty())
+	{
+		printf("No benchmarks matched \"%s\".\n", filter.c_str());
+		return 1;
+	}
+
+	std::vector<BenchmarkMeasurement> measurements;
+	AddMeasurements(runner.GetResults(), measurements);
+
+	return checkRegressions(measurements, regression);
+}
@@ -0,0 +1,268 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Regression.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _REGRESSION_CPP
+#define _REGRESSION_CPP
+
+#include "Regression.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+double RegressionSettings::GetThreshold(const std::string& name) const
+{
+	double found = threshold;
+
+	for (int i = 0; i < (int)thresholds.size(); i++)
+	{
+		if (name.find(thresholds[i].first) != std::string::npos)
+		{
+			found = thresholds[i].second;
+		}
+	}
+
+	return found;
+}
+
+void AddMeasurements(const std::vector<BenchmarkResult>& results, std::vector<BenchmarkMeasurement>& measurements)
+{
+	for (int i = 0; i < (int)results.size(); i++)
+	{
+		BenchmarkMeasurement measurement;
+		measurement.name = results[i].name;
+		measurement.unit = "ns/query";
+		measurement.value = results[i].nsPerQuery;
+
+		measurements.push_back(measurement);
+	}
+}
+
+void AddMeasurements(const std::vector<SceneResult>& results, std::vector<BenchmarkMeasurement>& measurements)
+{
+	for (int i = 0; i < (int)results.size(); i++)
+	{
+		// The thread count is part of the name, since the same scene on a different number of threads is a different measurement.
+		BenchmarkMeasurement measurement;
+		measurement.name = "scene/" + std::to_string(results[i].count) + "/" + results[i].broadphaseName + "/" + std::to_string(results[i].threads) +
+			"/step";
+		measurement.unit = "ms/step";
+		measurement.value = results[i].average.total * 1000.0;
+
+		measurements.push_back(measurement);
+	}
+}
+
+// The names are made by the benchmarks, so there's nothing to escape but quotes and backslashes, and they're never in them anyway.
+static std::string quoted(const std::string& text)
+{
+	std::string result = "\"";
+
+	for (int i = 0; i < (int)text.size(); i++)
+	{
+		if (text[i] == '"' || text[i] == '\\')
+		{
+			result += '\\';
+		}
+
+		result += text[i];
+	}
+
+	return result + "\"";
+}
+
+bool WriteMeasurements(const std::string& fileName, const std::vector<BenchmarkMeasurement>& measurements)
+{
+	FILE* file = fopen(fileName.c_str(), "w");
+
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	char date[32] = "";
+	time_t now = time(nullptr);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+#ifdef NDEBUG
+	const char* build = "release";
+#else
+	const char* build = "debug";
+#endif
+
+	fprintf(file, "{\n\"date\": \"%s\",\n\"build\": \"%s\",\n\"measurements\": [\n", date, build);
+
+	for (int i = 0; i < (int)measurements.size(); i++)
+	{
+		// Seventeen significant digits reads back as exactly the same double.
+		fprintf(file, "{\"name\": %s, \"unit\": %s, \"value\": %.17g}%s\n", quoted(measurements[i].name).c_str(),
+			quoted(measurements[i].unit).c_str(), measurements[i].value, i + 1 < (int)measurements.size() ? "," : "");
+	}
+
+	fprintf(file, "]\n}\n");
+
+	return fclose(file) == 0;
+}
+
+// Finds "key": in a line and reads the string after it. Returns false if it isn't there.
+static bool readString(const char* line, const char* key, std::string& value)
+{
+	const char* found = strstr(line, key);
+
+	if (found == nullptr)
+	{
+		return false;
+	}
+
+	const char* at = strchr(found + strlen(key), '"');
+
+	if (at == nullptr)
+	{
+		return false;
+	}
+
+	value.clear();
+
+	for (at++; *at != '\0' && *at != '"'; at++)
+	{
+		if (*at == '\\' && at[1] != '\0')
+		{
+			at++;
+		}
+
+		value += *at;
+	}
+
+	return *at == '"';
+}
+
+bool ReadMeasurements(const std::string& fileName, std::vector<BenchmarkMeasurement>& measurements)
+{
+	FILE* file = fopen(fileName.c_str(), "r");
+
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	measurements.clear();
+
+	// Every measurement is on a line of its own, which is all the parsing this needs.
+	char line[1024];
+
+	while (fgets(line, sizeof(line), file) != nullptr)
+	{
+		BenchmarkMeasurement measurement;
+		const char* value = strstr(line, "\"value\":");
+
+		if (value == nullptr || !readString(line, "\"name\":", measurement.name) || !readString(line, "\"unit\":", measurement.unit))
+		{
+			continue;
+		}
+
+		measurement.value = strtod(value + strlen("\"value\":"), nullptr);
+		measurements.push_back(measurement);
+	}
+
+	fclose(file);
+
+	return !measurements.empty();
+}
+
+int CompareMeasurements(const std::vector<BenchmarkMeasurement>& baseline, const std::vector<BenchmarkMeasurement>& measurements,
+	const RegressionSettings& settings)
+{
+	int regressions = 0;
+	std::vector<bool> matched(baseline.size(), false);
+
+	printf("%-44s %10s %12s %12s %9s %9s  %s\n", "benchmark", "unit", "baseline", "now", "change", "allowed", "result");
+
+	for (int i = 0; i < (int)measurements.size(); i++)
+	{
+		const BenchmarkMeasurement& measurement = measurements[i];
+		int found = -1;
+
+		for (int j = 0; j < (int)baseline.size() && found == -1; j++)
+		{
+			if (!matched[j] && baseline[j].name == measurement.name && baseline[j].unit == measurement.unit)
+			{
+				found = j;
+			}
+		}
+
+		if (found == -1)
+		{
+			printf("%-44s %10s %12s %12.3f %9s %9s  new\n", measurement.name.c_str(), measurement.unit.c_str(), "-", measurement.value, "-", "-");
+			continue;
+		}
+
+		matched[found] = true;
+
+		double before = baseline[found].value;
+		double change = before > 0.0 ? (measurement.value - before) / before : 0.0;
+		double threshold = settings.GetThreshold(measurement.name);
+		const char* result = "ok";
+
+		if (change > threshold)
+		{
+			result = "REGRESSED";
+			regressions++;
+		}
+		else if (change < -threshold)
+		{
+			result = "faster";
+		}
+
+		printf("%-44s %10s %12.3f %12.3f %+8.1f%% %8.1f%%  %s\n", measurement.name.c_str(), measurement.unit.c_str(), before, measurement.value,
+			change * 100.0, threshold * 100.0, result);
+	}
+
+	// Whatever the baseline had that didn't run this time (filtered out, say) can't have regressed, but it's worth knowing about.
+	for (int j = 0; j < (int)baseline.size(); j++)
+	{
+		if (!matched[j])
+		{
+			printf("%-44s %10s %12.3f %12s %9s %9s  missing\n", baseline[j].name.c_str(), baseline[j].unit.c_str(), baseline[j].value, "-", "-", "-");
+		}
+	}
+
+	printf("%d of %d regressed.\n", regressions, (int)measurements.size());
+	fflush(stdout);
+
+	return regressions;
+}
+
+#endif // _REGRESSION_CPP
@@ -0,0 +1,87 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Regression.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _REGRESSION_H
+#define _REGRESSION_H
+
+#include "Benchmark.h"
+#include "SceneBenchmark.h"
+#include <string>
+#include <vector>
+
+// One number a benchmark run came up with, under a name that stays the same from one run (and one build) to the next, so it can be lined up
+// with the same number from another run. Every one of them is a time, so lower is always better.
+struct BenchmarkMeasurement
+{
+	std::string name;	// Like "gjk/box/separated/cold" or "scene/10000/tree/step".
+	std::string unit;	// "ns/query" or "ms/step".
+	double value;
+};
+
+// How much slower a measurement can get before it counts as a regression, as a fraction of its baseline (0.1 is 10% slower).
+// Some benchmarks are noisier than others, so a threshold can be given for just the ones with something in their names; the last one that
+// matches wins, and the rest get the default.
+struct RegressionSettings
+{
+	double threshold;
+	std::vector<std::pair<std::string, double> > thresholds;
+
+	RegressionSettings()
+	{
+		threshold = 0.1;
+	}
+
+	double GetThreshold(const std::string& name) const;
+};
+
+// The measurements of the microbenchmarks (ns per query) and the scenes (ms per step).
+void AddMeasurements(const std::vector<BenchmarkResult>& results, std::vector<BenchmarkMeasurement>& measurements);
+void AddMeasurements(const std::vector<SceneResult>& results, std::vector<BenchmarkMeasurement>& measurements);
+
+// Writes measurements out as JSON, one object per measurement, one per line, in an array called "measurements", along with when and on
+// what they were measured. A file from one run is the baseline for the next. Returns false if the file can't be written.
+bool WriteMeasurements(const std::string& fileName, const std::vector<BenchmarkMeasurement>& measurements);
+
+// Reads back what WriteMeasurements wrote. (It only understands that layout, not JSON in general.) Returns false if the file can't be read,
+// or has no measurements in it.
+bool ReadMeasurements(const std::string& fileName, std::vector<BenchmarkMeasurement>& measurements);
+
+// Lines each measurement up with the baseline's of the same name, and prints a row for each with how much it changed, marking the ones
+// that got slower by more than their threshold, and those that are only in one of them. Returns how many regressed.
+int CompareMeasurements(const std::vector<BenchmarkMeasurement>& baseline, const std::vector<BenchmarkMeasurement>& measurements,
+	const RegressionSettings& settings);
+
+#endif //_REGRESSION_H
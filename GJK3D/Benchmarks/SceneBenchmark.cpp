@@ -0,0 +1,1331 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SceneBenchmark.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SCENE_BENCHMARK_CPP
+#define _SCENE_BENCHMARK_CPP
+
+#include "SceneBenchmark.h"
+#include "Benchmark.h"
+#include "InterestManager.h"
+#include "Profiler.h"
+#include "SimulationRecording.h"
+#include "StateSnapshot.h"
+#include "WorldSnapshot.h"
+#include "WorldStreamer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+// The box around the unit cube every object is drawn with (the same one the demo works out from its cube model).
+static const glm::vec3 CUBE_CENTER = glm::vec3(0.0f);
+static const glm::vec3 CUBE_HALF_EXTENTS = glm::vec3(0.5f);
+
+static const float STEP = 1.0f / 60.0f;
+
+// The layer debris is on (see SceneSettings::debris). Everything else stays on layer 1.
+static const unsigned int SCENE_DEBRIS_LAYER = 2;
+
+// How far along each edge the corners of the cubes with hulls are cut off, as a fraction of the half extent (see SceneSettings::hulls).
+static const float SCENE_HULL_BEVEL = 0.25f;
+
+// The hull the cubes with one are given: the cube with its corners cut off, which is three points for each corner, each pulled in along
+// one of the edges that meet there. It's the same for all of them, and the worlds only point at it, so there's just the one.
+static const std::vector<glm::vec3>& getSceneHull()
+{
+	static std::vector<glm::vec3> points;
+
+	if (points.empty())
+	{
+		for (int corner = 0; corner < 8; corner++)
+		{
+			glm::vec3 signs((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				glm::vec3 point = signs * CUBE_HALF_EXTENTS;
+				point[axis] *= 1.0f - SCENE_HULL_BEVEL;
+
+				points.push_back(CUBE_CENTER + point);
+			}
+		}
+	}
+
+	return points;
+}
+
+void MakeSceneBodies(const SceneSettings& settings, std::vector<SceneBody>& bodies)
+{
+	BenchmarkRandom random(settings.seed);
+
+	// The cubes go in a cube of space centered on the origin, just big enough to give them the density asked for.
+	float halfWidth = 0.5f * powf(settings.count / settings.density, 1.0f / 3.0f);
+
+	bodies.resize(settings.count);
+
+	for (int i = 0; i < settings.count; i++)
+	{
+		SceneBody& body = bodies[i];
+
+		float size = settings.minSize;
+
+		if (settings.sizes == SIZES_UNIFORM)
+		{
+			size = random.Range(settings.minSize, settings.maxSize);
+		}
+		else if (settings.sizes == SIZES_MIXED && random.NextInt() % 100 == 0)
+		{
+			size = settings.maxSize;
+		}
+
+		body.center = CUBE_CENTER;
+		body.halfExtents = CUBE_HALF_EXTENTS;
+		body.position = glm::vec3(random.Range(-halfWidth, halfWidth), random.Range(-halfWidth, halfWidth), random.Range(-halfWidth, halfWidth));
+		body.velocity = random.Direction() * random.Range(0.0f, settings.speed);
+		body.orientation = random.Orientation();
+		body.scale = glm::vec3(size);
+	}
+}
+
+void BuildScene(PhysicsWorld& world, const SceneSettings& settings)
+{
+	std::vector<SceneBody> scene;
+	MakeSceneBodies(settings, scene);
+
+	BodyStore& bodies = world.Bodies();
+
+	world.SetLargeIslandSize(settings.largeIslands);
+
+	// These are added at the origin and then all moved at once when the bulk add ends, rather than with AddSceneBodies, which is how every
+	// scene has been set up so far. (The tree is built from scratch at the end either way, so it comes out the same.)
+	world.BeginBulkAdd();
+
+	for (int i = 0; i < (int)scene.size(); i++)
+	{
+		int object = world.AddBox(CUBE_CENTER, CUBE_HALF_EXTENTS);
+		BodyHandle body = world.GetBody(object);
+
+		bodies.Position(body) = scene[i].position;
+		bodies.Velocity(body) = scene[i].velocity;
+		bodies.Orientation(body) = scene[i].orientation;
+		bodies.Scale(body) = scene[i].scale;
+		bodies.MarkDirty(body);
+
+		// The cubes are scattered at random anyway, so the first ones might as well be the debris.
+		if (i < (int)(settings.debris * scene.size()))
+		{
+			world.SetCollisionFilter(object, CollisionFilter(SCENE_DEBRIS_LAYER, ~SCENE_DEBRIS_LAYER));
+		}
+
+		// The static ones come after the debris.
+		int firstStatic = (int)(settings.debris * scene.size());
+
+		if (i >= firstStatic && i < firstStatic + (int)(settings.statics * scene.size()))
+		{
+			world.SetBodyType(object, BODY_STATIC);
+		}
+
+		// And the last ones the triggers, so a scene can have both without them being the same cubes.
+		if (i >= (int)scene.size() - (int)(settings.triggers * scene.size()))
+		{
+			world.SetTrigger(object, true);
+		}
+
+		// Hulls go to every so many of them, wherever they are, since they work the same on all of them.
+		if (settings.hulls > 0.0f && (int)(i * settings.hulls) != (int)((i + 1) * settings.hulls))
+		{
+			const std::vector<glm::vec3>& hull = getSceneHull();
+
+			world.SetHull(object, hull.data(), (int)hull.size());
+		}
+	}
+
+	world.EndBulkAdd();
+
+	world.SetSpeculativeContacts(settings.speculative);
+	world.SetShadowChecks(settings.shadowChecks);
+	world.SetMaintenanceBudget(settings.maintenance);
+}
+
+SceneResult RunScene(const SceneSettings& settings, int steps, int broadphase, int threads, bool gjkStats, PhysicsMetrics* metrics)
+{
+	SteadyClock clock;
+
+	SceneResult result;
+	result.count = settings.count;
+	result.broadphase = broadphase;
+
+	double setupStart = clock.Now();
+
+	// Picking the broadphase before there's anything in the world means the cubes only ever get put into the one we want.
+	PhysicsWorld world(threads);
+	world.SetBroadphase(broadphase);
+	world.SetGJKStatsEnabled(gjkStats);
+	world.SetPipelinedBroadphase(settings.pipelined);
+	world.SetIslandRates(settings.islandRates);
+
+	// With room for everything set aside before the cubes go in, the steps shouldn't allocate at all.
+	if (settings.limits)
+	{
+		world.SetLimits(PhysicsWorldLimits(settings.count, settings.count, settings.count));
+	}
+
+	BuildScene(world, settings);
+
+	// One window for the whole run, so the report at the end covers every step.
+	world.SetPairCosts(settings.pairCosts, steps);
+
+	result.setupSeconds = clock.Now() - setupStart;
+	result.broadphaseName = world.GetBroadphaseName(broadphase);
+	result.threads = world.GetJobSystem()->GetThreadCount();
+
+	PhysicsStepStats& average = result.average;
+	long long allocationsBefore = GetAllocationCount();
+
+	for (int i = 0; i < steps; i++)
+	{
+		world.Step(STEP);
+
+		// Each step is a frame, as far as the profiler is concerned (if it's on).
+		Profiler::Get().EndFrame();
+
+		if (metrics != nullptr)
+		{
+			metrics->Record(world);
+		}
+
+		const PhysicsStepStats& stats = world.GetStepStats();
+
+		average.transforms += stats.transforms;
+		average.refit += stats.refit;
+		average.broadphase += stats.broadphase;
+		average.narrowphase += stats.narrowphase;
+		average.solve += stats.solve;
+		average.integrate += stats.integrate;
+		average.maintenance += stats.maintenance;
+		average.total += stats.total;
+		average.pairs += stats.pairs;
+		average.contacts += stats.contacts;
+		average.swept += stats.swept;
+		average.impacts += stats.impacts;
+
+		result.gjk.Add(world.GetGJKStats());
+		result.shadow.Add(world.GetShadowStats());
+	}
+
+	result.allocationsPerStep = 0.0;
+
+	if (steps > 0)
+	{
+		average.transforms /= steps;
+		average.refit /= steps;
+		average.broadphase /= steps;
+		average.narrowphase /= steps;
+		average.solve /= steps;
+		average.integrate /= steps;
+		average.maintenance /= steps;
+		average.total /= steps;
+		average.pairs /= steps;
+		average.contacts /= steps;
+		average.swept /= steps;
+		average.impacts /= steps;
+
+		result.allocationsPerStep = (double)(GetAllocationCount() - allocationsBefore) / steps;
+	}
+
+	result.pairCosts = world.GetPairCostReport();
+
+	return result;
+}
+
+// A count as a percentage of total (or 0 if there's no total).
+static double percent(long long count, long long total)
+{
+	return total > 0 ? 100.0 * count / total : 0.0;
+}
+
+void PrintGJKStats(const GJKStats& stats)
+{
+	printf("  gjk: %lld queries, %.2f iterations and %.2f support calls per query\n", stats.queries, stats.AverageIterations(),
+		stats.queries > 0 ? (double)stats.supportCalls / stats.queries : 0.0);
+
+	printf("  ended:");
+
+	for (int i = 0; i < GJK_NUM_TERMINATIONS; i++)
+	{
+		printf(" %s %.1f%%%s", GetTerminationName((GJKTermination)i), percent(stats.terminations[i], stats.queries), i + 1 < GJK_NUM_TERMINATIONS ? "," : "\n");
+	}
+
+	printf("  final simplex:");
+
+	for (int i = 1; i <= 4; i++)
+	{
+		printf(" %d points %.1f%%%s", i, percent(stats.simplexSizes[i], stats.queries), i < 4 ? "," : "\n");
+	}
+
+	printf("  tetrahedron tests: %lld (%.3f per query), rewound to a triangle: %lld (%.1f%%)\n", stats.tetrahedronTests,
+		stats.queries > 0 ? (double)stats.tetrahedronTests / stats.queries : 0.0, stats.tetrahedronRewinds,
+		percent(stats.tetrahedronRewinds, stats.tetrahedronTests));
+
+	if (stats.doubleQueries > 0)
+	{
+		printf("  run in double: %lld (%.2f%%)\n", stats.doubleQueries, percent(stats.doubleQueries, stats.queries));
+	}
+
+	// Only the iteration counts that some query actually took, or the histogram would mostly be empty rows.
+	printf("  iterations:\n");
+
+	for (int i = 0; i <= GJKStats::MAX_ITERATIONS; i++)
+	{
+		if (stats.iterationHistogram[i] > 0)
+		{
+			printf("  %6d%s %12lld %6.2f%%\n", i, i == GJKStats::MAX_ITERATIONS ? "+" : " ", stats.iterationHistogram[i],
+				percent(stats.iterationHistogram[i], stats.queries));
+		}
+	}
+}
+
+void RunSceneBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, const std::vector<int>& broadphases, int steps, int threads,
+	bool gjkStats, PhysicsMetrics* metrics, std::vector<SceneResult>* results)
+{
+	// Every time is in milliseconds, and every number after the setup is per step.
+	printf("%9s %-16s %7s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n", "bodies", "broadphase", "threads", "setup ms",
+		"step ms", "transforms", "refit", "broadphase", "narrow", "solve", "integrate", "pairs", "contacts", "swept", "impacts", "allocs");
+
+	for (int i = 0; i < (int)counts.size(); i++)
+	{
+		for (int j = 0; j < (int)broadphases.size(); j++)
+		{
+			SceneSettings scene = settings;
+			scene.count = counts[i];
+
+			if (metrics != nullptr)
+			{
+				metrics->Reset();
+			}
+
+			SceneResult result = RunScene(scene, steps, broadphases[j], threads, gjkStats, metrics);
+			const PhysicsStepStats& average = result.average;
+
+			printf("%9d %-16s %7d %10.2f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10d %10d %10d %10d %10.1f\n", result.count,
+				result.broadphaseName, result.threads, result.setupSeconds * 1000.0, average.total * 1000.0, average.transforms * 1000.0,
+				average.refit * 1000.0, average.broadphase * 1000.0, average.narrowphase * 1000.0, average.solve * 1000.0, average.integrate * 1000.0,
+				average.pairs, average.contacts, average.swept, average.impacts, result.allocationsPerStep);
+
+			if (gjkStats)
+			{
+				PrintGJKStats(result.gjk);
+			}
+
+			if (scene.maintenance > 0.0)
+			{
+				printf("  Maintenance took %.3f ms a step.\n", average.maintenance * 1000.0);
+			}
+
+			if (!result.pairCosts.empty())
+			{
+				printf("  most expensive pairs:\n");
+
+				for (int k = 0; k < (int)result.pairCosts.size(); k++)
+				{
+					const PairCost& cost = result.pairCosts[k];
+
+					printf("  %8d %8d %10.3f us %4d gjk %4d epa iterations   %s (%d points) and %s (%d points)\n", cost.a, cost.b, cost.seconds * 1e6,
+						cost.gjkIterations, cost.epaIterations, GetShapeTypeName(cost.typeA), cost.pointsA, GetShapeTypeName(cost.typeB), cost.pointsB);
+				}
+			}
+
+			if (scene.shadowChecks > 0.0f)
+			{
+				const ShadowCheckStats& shadow = result.shadow;
+
+				printf("          shadow checks %lld, disagreements %lld (%lld missed, %lld extra)", shadow.checks, shadow.disagreements, shadow.missed,
+					shadow.extra);
+
+				if (shadow.firstA != -1)
+				{
+					printf(", first between %d and %d", shadow.firstA, shadow.firstB);
+				}
+
+				printf("\n");
+			}
+
+			if (results != nullptr)
+			{
+				results->push_back(result);
+			}
+
+			fflush(stdout);
+		}
+	}
+}
+
+bool RunDeterminismChecks(const SceneSettings& settings, const std::vector<int>& counts, const std::vector<int>& broadphases, int steps,
+	int threads)
+{
+	bool allSame = true;
+
+	printf("%9s %-16s %7s %10s %10s  %s\n", "bodies", "broadphase", "threads", "steps", "contacts", "result");
+
+	for (int i = 0; i < (int)counts.size(); i++)
+	{
+		for (int j = 0; j < (int)broadphases.size(); j++)
+		{
+			SceneSettings scene = settings;
+			scene.count = counts[i];
+
+			PhysicsWorld single(1);
+			PhysicsWorld threaded(threads);
+
+			single.SetBroadphase(broadphases[j]);
+			threaded.SetBroadphase(broadphases[j]);
+			single.SetDeterministic(true);
+			threaded.SetDeterministic(true);
+
+			BuildScene(single, scene);
+			BuildScene(threaded, scene);
+
+			// Every contact is a chance for the order things are done in to matter, so it's worth knowing there were some.
+			int contacts = 0;
+			int diverged = -1;
+
+			for (int step = 0; step < steps && diverged == -1; step++)
+			{
+				single.Step(STEP);
+				threaded.Step(STEP);
+
+				contacts += single.GetStepStats().contacts;
+
+				if (single.StateHash() != threaded.StateHash())
+				{
+					diverged = step;
+				}
+			}
+
+			printf("%9d %-16s %7d %10d %10d  ", scene.count, single.GetBroadphaseName(broadphases[j]),
+				threaded.GetJobSystem()->GetThreadCount(), steps, contacts);
+
+			if (diverged == -1)
+			{
+				printf("same\n");
+			}
+			else
+			{
+				printf("different after step %d\n", diverged + 1);
+				allSame = false;
+			}
+
+			fflush(stdout);
+		}
+	}
+
+	return allSame;
+}
+
+bool RunSnapshotBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int threads)
+{
+	SteadyClock clock;
+
+	// Sizes are in bytes per object, and times in milliseconds per step. A float position, orientation and velocity are 40 bytes.
+	printf("%9s %10s %10s %10s %12s %12s %12s\n", "bodies", "floats", "snapshot", "delta", "capture ms", "encode ms", "decode ms");
+
+	for (int i = 0; i < (int)counts.size(); i++)
+	{
+		SceneSettings scene = settings;
+		scene.count = counts[i];
+
+		PhysicsWorld world(threads);
+		BuildScene(world, scene);
+
+		StateSnapshot previous, current, received;
+		std::vector<unsigned char> full, delta;
+
+		previous.Capture(world, 0);
+
+		double fullBytes = 0.0, deltaBytes = 0.0;
+		double captureTime = 0.0, encodeTime = 0.0, decodeTime = 0.0;
+
+		for (int step = 1; step <= steps; step++)
+		{
+			world.Step(STEP);
+
+			double start = clock.Now();
+			current.Capture(world, step);
+			captureTime += clock.Now() - start;
+
+			full.clear();
+			current.Encode(full);
+
+			start = clock.Now();
+			delta.clear();
+			current.Encode(delta, &previous);
+			encodeTime += clock.Now() - start;
+
+			start = clock.Now();
+			bool decoded = received.Decode(delta.data(), delta.size(), &previous);
+			decodeTime += clock.Now() - start;
+
+			if (!decoded || !(received == current))
+			{
+				printf("The delta for step %d of %d bodies didn't decode to the snapshot it was made from.\n", step, scene.count);
+				return false;
+			}
+
+			fullBytes += full.size();
+			deltaBytes += delta.size();
+
+			std::swap(previous, current);
+		}
+
+		double perObject = 1.0 / ((double)glm::max(steps, 1) * glm::max(scene.count, 1));
+		double perStep = 1000.0 / glm::max(steps, 1);
+
+		printf("%9d %10d %10.2f %10.2f %12.3f %12.3f %12.3f\n", scene.count, (int)(sizeof(glm::vec3) * 2 + sizeof(glm::quat)),
+			fullBytes * perObject, deltaBytes * perObject, captureTime * perStep, encodeTime * perStep, decodeTime * perStep);
+
+		fflush(stdout);
+	}
+
+	return true;
+}
+
+bool RunRollbackBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int threads)
+{
+	// How many steps each rollback goes back, which is also how many states are kept.
+	const int ROLLBACK_STEPS = 10;
+
+	SteadyClock clock;
+	bool allSame = true;
+
+	printf("%9s %10s %12s %12s %14s  %s\n", "bodies", "rollbacks", "save ms", "restore ms", "rollback ms", "result");
+
+	for (int i = 0; i < (int)counts.size(); i++)
+	{
+		SceneSettings scene = settings;
+		scene.count = counts[i];
+
+		PhysicsWorld world(threads);
+		world.SetDeterministic(true);
+
+		BuildScene(world, scene);
+
+		PhysicsWorldState states[ROLLBACK_STEPS];
+
+		int saves = 0, rollbacks = 0, diverged = -1;
+		double saveTime = 0.0, restoreTime = 0.0, rollbackTime = 0.0;
+
+		for (int step = 0; step < steps; step++)
+		{
+			double start = clock.Now();
+			world.SaveState(states[step % ROLLBACK_STEPS]);
+			saveTime += clock.Now() - start;
+			saves++;
+
+			world.Step(STEP);
+
+			if ((step + 1) % ROLLBACK_STEPS != 0)
+			{
+				continue;
+			}
+
+			// Go back to the oldest state (the start of the step ROLLBACK_STEPS - 1 steps ago), and run back up to here, saving along the way
+			// just like the first time.
+			unsigned long long hash = world.StateHash();
+			int from = step + 1 - ROLLBACK_STEPS;
+
+			double rollbackStart = clock.Now();
+
+			start = clock.Now();
+			world.RestoreState(states[from % ROLLBACK_STEPS]);
+			restoreTime += clock.Now() - start;
+
+			for (int again = from; again <= step; again++)
+			{
+				world.SaveState(states[again % ROLLBACK_STEPS]);
+				world.Step(STEP);
+			}
+
+			rollbackTime += clock.Now() - rollbackStart;
+			rollbacks++;
+
+			if (world.StateHash() != hash && diverged == -1)
+			{
+				diverged = step;
+			}
+		}
+
+		printf("%9d %10d %12.3f %12.3f %14.3f  ", scene.count, rollbacks, saveTime * 1000.0 / glm::max(saves, 1), restoreTime * 1000.0 / glm::max(rollbacks, 1), rollbackTime * 1000.0 / glm::max(rollbacks, 1));
+
+		if (diverged == -1)
+		{
+			printf("same\n");
+		}
+		else
+		{
+			printf("different after step %d\n", diverged + 1);
+			allSame = false;
+		}
+
+		fflush(stdout);
+	}
+
+	return allSame;
+}
+
+bool RecordScene(const SceneSettings& settings, int steps, int broadphase, int threads, const std::string& fileName)
+{
+	PhysicsWorld world(threads);
+	world.SetBroadphase(broadphase);
+	world.SetIslandRates(settings.islandRates);
+
+	BuildScene(world, settings);
+
+	SimulationRecorder recorder;
+
+	if (!recorder.Open(fileName))
+	{
+		printf("Couldn't create %s.\n", fileName.c_str());
+		return false;
+	}
+
+	for (int i = 0; i < steps; i++)
+	{
+		if (i > 0 && i % 60 == 0 && world.NumObjects() > 0)
+		{
+			BodyHandle body = world.GetBody(0);
+
+			world.Bodies().Velocity(body) = -world.Bodies().Velocity(body);
+		}
+
+		recorder.Step(world, STEP);
+	}
+
+	if (!recorder.Close())
+	{
+		printf("Couldn't write %s.\n", fileName.c_str());
+		return false;
+	}
+
+	printf("Recorded %d steps of %d bodies to %s.\n", steps, world.NumObjects(), fileName.c_str());
+
+	return true;
+}
+
+// One step of a replay: which it was, and how long it took when it was recorded and when it was played back.
+struct ReplayedStep
+{
+	int step;
+	double recorded;
+	double replayed;
+	int pairs;
+	int contacts;
+
+	bool operator<(const ReplayedStep& other) const
+	{
+		return recorded > other.recorded;
+	}
+};
+
+bool ReplayRecording(const std::string& fileName, int threads)
+{
+	PhysicsWorld world(threads);
+	SimulationReplayer replayer;
+
+	if (!replayer.Open(fileName))
+	{
+		printf("%s\n", replayer.GetError().c_str());
+		return false;
+	}
+
+	std::vector<ReplayedStep> replayed;
+	int firstMismatch = -1;
+	int mismatches = 0;
+
+	while (replayer.Step(world))
+	{
+		const RecordedStep& recorded = replayer.GetRecordedStep();
+
+		ReplayedStep step;
+		step.step = (int)replayed.size();
+		step.recorded = recorded.seconds;
+		step.replayed = world.GetStepStats().total;
+		step.pairs = recorded.pairs;
+		step.contacts = recorded.contacts;
+
+		replayed.push_back(step);
+
+		if (!replayer.StateMatched())
+		{
+			mismatches++;
+			firstMismatch = firstMismatch == -1 ? step.step : firstMismatch;
+		}
+	}
+
+	if (!replayer.GetError().empty())
+	{
+		printf("%s (after %d steps)\n", replayer.GetError().c_str(), (int)replayed.size());
+		return false;
+	}
+
+	double recordedTotal = 0.0, replayedTotal = 0.0;
+
+	for (int i = 0; i < (int)replayed.size(); i++)
+	{
+		recordedTotal += replayed[i].recorded;
+		replayedTotal += replayed[i].replayed;
+	}
+
+	int count = glm::max((int)replayed.size(), 1);
+
+	printf("%d steps of %d bodies, on %d threads.\n", (int)replayed.size(), world.NumObjects(), world.GetJobSystem()->GetThreadCount());
+	printf("Recorded: %.3f ms a step, %.3f ms in all.\n", recordedTotal * 1000.0 / count, recordedTotal * 1000.0);
+	printf("Replayed: %.3f ms a step, %.3f ms in all.\n", replayedTotal * 1000.0 / count, replayedTotal * 1000.0);
+
+	if (!replayer.GetHeader().hashed)
+	{
+		printf("The recording isn't hashed, so there's no telling whether the replay matched it.\n");
+	}
+	else if (mismatches == 0)
+	{
+		printf("Every step came out exactly as it was recorded.\n");
+	}
+	else
+	{
+		printf("%d steps came out differently from the recording, starting with step %d.\n", mismatches, firstMismatch + 1);
+	}
+
+	// The slowest steps as they were recorded, which are the ones worth looking at.
+	std::sort(replayed.begin(), replayed.end());
+
+	printf("\n%9s %12s %12s %10s %10s\n", "step", "recorded ms", "replayed ms", "pairs", "contacts");
+
+	for (int i = 0; i < (int)replayed.size() && i < 10; i++)
+	{
+		printf("%9d %12.3f %12.3f %10d %10d\n", replayed[i].step + 1, replayed[i].recorded * 1000.0, replayed[i].replayed * 1000.0,
+			replayed[i].pairs, replayed[i].contacts);
+	}
+
+	return true;
+}
+
+// The size of a file in megabytes (or 0 if it can't be opened).
+static double fileMegabytes(const std::string& fileName)
+{
+	MappedFile file;
+	return file.Open(fileName) ? file.GetSize() / (1024.0 * 1024.0) : 0.0;
+}
+
+bool RunSceneFileBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int threads)
+{
+	const std::string textFileName = "SceneBenchmark.txt";
+	const std::string binaryFileName = "SceneBenchmark.gjks";
+	const std::string snapshotFileName = "SceneBenchmark.gjkw";
+
+	SteadyClock clock;
+
+	// Loading is what we're timing, but the saves are shown too, since a level's text has to be turned into binary at some point.
+	printf("%9s %10s %10s %12s %12s %12s %12s %12s %12s %12s %12s\n", "bodies", "text MB", "binary MB", "save text", "save binary", "load text",
+		"load binary", "open view", "add bodies", "snapshot MB", "load world");
+
+	for (int i = 0; i < (int)counts.size(); i++)
+	{
+		SceneSettings scene = settings;
+		scene.count = counts[i];
+
+		Scene saved;
+		MakeSceneBodies(scene, saved.bodies);
+
+		double start = clock.Now();
+		bool ok = saved.SaveText(textFileName);
+		double saveText = clock.Now() - start;
+
+		start = clock.Now();
+		ok = ok && saved.SaveBinary(binaryFileName);
+		double saveBinary = clock.Now() - start;
+
+		if (!ok)
+		{
+			printf("%s\n", saved.GetError().c_str());
+			return false;
+		}
+
+		Scene loaded;
+		start = clock.Now();
+		ok = loaded.LoadText(textFileName);
+		double loadText = clock.Now() - start;
+
+		start = clock.Now();
+		ok = ok && loaded.LoadBinary(binaryFileName);
+		double loadBinary = clock.Now() - start;
+
+		// Opening the view is all a server would have to do before it starts adding the bodies, straight out of the file.
+		SceneView view;
+		start = clock.Now();
+		ok = ok && view.Open(binaryFileName);
+		double openView = clock.Now() - start;
+
+		if (!ok)
+		{
+			printf("%s\n", loaded.GetError().empty() ? "Couldn't open the binary scene." : loaded.GetError().c_str());
+			return false;
+		}
+
+		PhysicsWorld world(threads);
+		start = clock.Now();
+		AddSceneBodies(world, view.GetBodies(), view.GetBodyCount());
+		double addBodies = clock.Now() - start;
+
+		// And the world those bodies made, loaded straight back into a new one (see WorldSnapshot), which is the other way to start a server.
+		WorldSnapshot snapshot;
+		PhysicsWorld snapshotWorld(threads);
+
+		if (!snapshot.Save(world, snapshotFileName))
+		{
+			printf("%s\n", snapshot.GetError().c_str());
+			return false;
+		}
+
+		start = clock.Now();
+		ok = snapshot.Load(snapshotWorld, snapshotFileName);
+		double loadWorld = clock.Now() - start;
+
+		if (!ok)
+		{
+			printf("%s\n", snapshot.GetError().c_str());
+			return false;
+		}
+
+		printf("%9d %10.2f %10.2f %12.2f %12.2f %12.2f %12.2f %12.3f %12.2f %12.2f %12.2f\n", scene.count, fileMegabytes(textFileName),
+			fileMegabytes(binaryFileName), saveText * 1000.0, saveBinary * 1000.0, loadText * 1000.0, loadBinary * 1000.0, openView * 1000.0,
+			addBodies * 1000.0, fileMegabytes(snapshotFileName), loadWorld * 1000.0);
+		fflush(stdout);
+
+		view.Close();
+	}
+
+	remove(textFileName.c_str());
+	remove(binaryFileName.c_str());
+	remove(snapshotFileName.c_str());
+
+	return true;
+}
+
+bool RunStreamingBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int threads)
+{
+	const int REGIONS = 16;
+
+	SteadyClock clock;
+	bool ok = true;
+
+	printf("%9s %9s %12s %12s %12s %12s %12s %12s %12s  %s\n", "bodies", "regions", "waited ms", "update ms", "worst ms", "step ms", "worst ms",
+		"most in", "objects", "result");
+
+	for (int i = 0; i < (int)counts.size() && ok; i++)
+	{
+		SceneSettings scene = settings;
+		scene.count = counts[i];
+
+		// Each region is the same scene, a region's width further along the x axis than the last.
+		Scene region;
+		MakeSceneBodies(scene, region.bodies);
+
+		float width = powf(scene.count / scene.density, 1.0f / 3.0f);
+		std::vector<std::string> fileNames;
+
+		for (int j = 0; j < REGIONS && ok; j++)
+		{
+			char fileName[64];
+			sprintf(fileName, "StreamBenchmark%d.gjks", j);
+			fileNames.push_back(fileName);
+
+			ok = region.SaveBinary(fileName);
+
+			for (int k = 0; k < (int)region.bodies.size(); k++)
+			{
+				region.bodies[k].position.x += width;
+			}
+		}
+
+		if (!ok)
+		{
+			printf("%s\n", region.GetError().c_str());
+			break;
+		}
+
+		PhysicsWorld world(threads);
+		WorldStreamer streamer(world);
+
+		// The point sees the region it's in and the ones either side of it.
+		streamer.SetDistances(width, width * 1.5f);
+
+		for (int j = 0; j < REGIONS; j++)
+		{
+			glm::vec3 min(-0.5f * width + j * width, -0.5f * width, -0.5f * width);
+			streamer.AddRegion(fileNames[j], AABB(min, min + glm::vec3(width)));
+		}
+
+		double waitTime = 0.0, updateTime = 0.0, worstUpdate = 0.0, stepTime = 0.0, worstStep = 0.0;
+		int mostIn = 0;
+
+		for (int step = 0; step < steps; step++)
+		{
+			float along = steps > 1 ? (float)step / (steps - 1) : 0.0f;
+			glm::vec3 focus((REGIONS - 1) * width * along, 0.0f, 0.0f);
+
+			// The regions asked for last time have had a step to be read in. Waiting for them keeps the benchmark the same from one run to
+			// the next, and how long it waits is how much longer the reads took than the step.
+			double start = clock.Now();
+			streamer.WaitForLoads();
+			waitTime += clock.Now() - start;
+
+			start = clock.Now();
+			streamer.Update(focus);
+			double update = clock.Now() - start;
+
+			start = clock.Now();
+			world.Step(STEP);
+			double stepped = clock.Now() - start;
+
+			updateTime += update;
+			worstUpdate = glm::max(worstUpdate, update);
+			stepTime += stepped;
+			worstStep = glm::max(worstStep, stepped);
+			mostIn = glm::max(mostIn, streamer.GetActiveBodies());
+		}
+
+		for (int j = 0; j < REGIONS; j++)
+		{
+			if (streamer.GetRegionState(j) == REGION_FAILED)
+			{
+				printf("%s\n", streamer.GetRegionError(j).c_str());
+				ok = false;
+			}
+		}
+
+		printf("%9d %9d %12.3f %12.3f %12.3f %12.3f %12.3f %12d %12d  %s\n", scene.count * REGIONS, REGIONS, waitTime * 1000.0 / glm::max(steps, 1),
+			updateTime * 1000.0 / glm::max(steps, 1), worstUpdate * 1000.0, stepTime * 1000.0 / glm::max(steps, 1), worstStep * 1000.0, mostIn, world.NumObjects(), ok ? "ok" : "failed");
+		fflush(stdout);
+
+		for (int j = 0; j < REGIONS; j++)
+		{
+			remove(fileNames[j].c_str());
+		}
+	}
+
+	return ok;
+}
+
+void RunLevelOfDetailBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int threads)
+{
+	// How many steps each of a far cube's steps stands for.
+	const int LOD_INTERVAL = 4;
+
+	printf("%9s %8s %9s %12s %12s %10s %10s\n", "bodies", "detail", "far", "step ms", "worst ms", "pairs", "contacts");
+
+	for (int i = 0; i < (int)counts.size(); i++)
+	{
+		SceneSettings scene = settings;
+		scene.count = counts[i];
+
+		// The cubes fill a cube of space (see MakeSceneBodies), and a sphere in the middle of it with a radius of 0.73 of its half width
+		// holds a fifth of it.
+		float halfWidth = 0.5f * powf(scene.count / scene.density, 1.0f / 3.0f);
+
+		for (int lod = 0; lod < 2; lod++)
+		{
+			PhysicsWorld world(threads);
+
+			BuildScene(world, scene);
+
+			if (lod)
+			{
+				world.SetLevelOfDetail(0.73f * halfWidth, LOD_INTERVAL);
+				world.SetInterestPoints(std::vector<glm::vec3>(1, glm::vec3(0.0f)));
+			}
+
+			PhysicsStepStats total;
+			double worst = 0.0;
+			long long far = 0;
+
+			for (int step = 0; step < steps; step++)
+			{
+				world.Step(STEP);
+
+				const PhysicsStepStats& stats = world.GetStepStats();
+
+				total.total += stats.total;
+				total.pairs += stats.pairs;
+				total.contacts += stats.contacts;
+				far += stats.far;
+				worst = glm::max(worst, stats.total);
+			}
+
+			int divisor = glm::max(steps, 1);
+
+			printf("%9d %8s %9lld %12.3f %12.3f %10d %10d\n", scene.count, lod ? "lod" : "full", far / divisor, total.total * 1000.0 / divisor,
+				worst * 1000.0, total.pairs / divisor, total.contacts / divisor);
+
+			fflush(stdout);
+		}
+	}
+}
+
+void RunInterestBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int numClients, int threads)
+{
+	// How far each client can see. At the default density that takes in about 500 cubes.
+	const float INTEREST_RADIUS = 10.0f;
+
+	SteadyClock clock;
+
+	printf("%9s %8s %12s %12s %10s %10s %10s\n", "bodies", "clients", "update ms", "worst ms", "in view", "entered", "left");
+
+	for (int i = 0; i < (int)counts.size(); i++)
+	{
+		SceneSettings scene = settings;
+		scene.count = counts[i];
+
+		PhysicsWorld world(threads);
+
+		BuildScene(world, scene);
+
+		InterestManager interest(world);
+
+		// Each client follows a cube of its own, spread out through the scene.
+		std::vector<int> followed(numClients);
+
+		for (int j = 0; j < numClients; j++)
+		{
+			interest.AddClient();
+			followed[j] = (int)((long long)j * world.NumObjects() / numClients);
+		}
+
+		double total = 0.0;
+		double worst = 0.0;
+		long long inView = 0;
+		long long entered = 0;
+		long long left = 0;
+
+		for (int step = 0; step < steps; step++)
+		{
+			world.Step(STEP);
+
+			for (int j = 0; j < numClients; j++)
+			{
+				AABB box = world.GetBounds(followed[j]);
+
+				interest.SetSphere(j, 0.5f * (box.min + box.max), INTEREST_RADIUS);
+			}
+
+			double start = clock.Now();
+
+			interest.Update();
+
+			double seconds = clock.Now() - start;
+
+			total += seconds;
+			worst = glm::max(worst, seconds);
+
+			// The first update has everything come into view, which isn't what a usual step is like.
+			for (int j = 0; j < numClients && step > 0; j++)
+			{
+				inView += interest.GetObjects(j).size();
+				entered += interest.GetEntered(j).size();
+				left += interest.GetLeft(j).size();
+			}
+		}
+
+		long long divisor = glm::max((long long)(steps - 1) * numClients, 1LL);
+
+		printf("%9d %8d %12.3f %12.3f %10lld %10.2f %10.2f\n", scene.count, numClients, total * 1000.0 / glm::max(steps, 1), worst * 1000.0,
+			inView / divisor, (double)entered / divisor, (double)left / divisor);
+
+		fflush(stdout);
+	}
+}
+
+void RunPriorityBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int passes, int threads)
+{
+	// How many cubes' lines each debug drawing job builds.
+	const int DRAW_GRAIN = 256;
+
+	SteadyClock clock;
+	JobSystem jobs(threads);
+
+	printf("%9s %8s %11s %12s %12s %12s\n", "bodies", "threads", "drawing", "step ms", "worst ms", "frame ms");
+
+	for (int i = 0; i < (int)counts.size(); i++)
+	{
+		SceneSettings scene = settings;
+		scene.count = counts[i];
+
+		for (int background = 0; background < 2; background++)
+		{
+			PhysicsWorld world(jobs);
+
+			BuildScene(world, scene);
+
+			// The boxes the drawing works from (picked up between steps, since the step moves everything), and the lines it makes: the
+			// 12 edges of each box, two ends each.
+			std::vector<AABB> boxes(world.NumObjects());
+			std::vector<glm::vec3> lines(boxes.size() * 24);
+
+			auto drawBoxes = [&boxes, &lines, passes](int begin, int end, int thread)
+			{
+				for (int pass = 0; pass < passes; pass++)
+				{
+					for (int j = begin; j < end; j++)
+					{
+						glm::vec3 corners[8];
+
+						for (int k = 0; k < 8; k++)
+						{
+							corners[k] = glm::vec3((k & 1) ? boxes[j].max.x : boxes[j].min.x, (k & 2) ? boxes[j].max.y : boxes[j].min.y,
+								(k & 4) ? boxes[j].max.z : boxes[j].min.z);
+						}
+
+						// The corners one bit apart are joined by an edge.
+						glm::vec3* line = &lines[j * 24];
+
+						for (int k = 0; k < 8; k++)
+						{
+							for (int bit = 1; bit < 8; bit <<= 1)
+							{
+								if ((k & bit) == 0)
+								{
+									*line++ = corners[k];
+									*line++ = corners[k | bit];
+								}
+							}
+						}
+					}
+				}
+			};
+
+			double worst = 0.0;
+			double stepTotal = 0.0;
+			double start = clock.Now();
+
+			for (int step = 0; step < steps; step++)
+			{
+				for (int j = 0; j < (int)boxes.size(); j++)
+				{
+					boxes[j] = world.GetBounds(j);
+				}
+
+				JobCounter drawn(background ? JOB_BACKGROUND : JOB_CRITICAL);
+
+				jobs.SubmitFor((int)boxes.size(), DRAW_GRAIN, drawBoxes, drawn);
+
+				world.Step(STEP);
+
+				jobs.Wait(drawn);
+
+				stepTotal += world.GetStepStats().total;
+				worst = glm::max(worst, world.GetStepStats().total);
+			}
+
+			double finish = clock.Now();
+			int divisor = glm::max(steps, 1);
+
+			printf("%9d %8d %11s %12.3f %12.3f %12.3f\n", scene.count, jobs.GetThreadCount(), background ? "background" : "critical",
+				stepTotal * 1000.0 / divisor, worst * 1000.0, (finish - start) * 1000.0 / divisor);
+
+			fflush(stdout);
+		}
+	}
+}
+
+void RunManyWorldBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int numWorlds, int steps,
+	const JobSystemSettings& jobSettings)
+{
+	SteadyClock clock;
+	JobSystem jobs(jobSettings);
+
+	printf("%d NUMA node(s), %d of %d thread(s) pinned\n", jobs.GetNodeCount(), jobs.GetStats().pinnedThreads, jobs.GetThreadCount());
+	printf("%9s %8s %8s %16s %16s %18s %18s\n", "bodies", "worlds", "threads", "one by one ms", "together ms", "one by one steals",
+		"together steals");
+
+	for (int i = 0; i < (int)counts.size(); i++)
+	{
+		SceneSettings scene = settings;
+		scene.count = counts[i];
+
+		// Two sets of the same worlds, so each way starts from the same place.
+		std::vector<PhysicsWorld*> oneByOne;
+		std::vector<PhysicsWorld*> together;
+
+		for (int j = 0; j < numWorlds; j++)
+		{
+			scene.seed = settings.seed + j;
+
+			oneByOne.push_back(new PhysicsWorld(jobs));
+			together.push_back(new PhysicsWorld(jobs));
+
+			BuildScene(*oneByOne.back(), scene);
+			BuildScene(*together.back(), scene);
+		}
+
+		jobs.ResetStats();
+
+		double start = clock.Now();
+
+		for (int step = 0; step < steps; step++)
+		{
+			for (int j = 0; j < numWorlds; j++)
+			{
+				oneByOne[j]->Step(STEP);
+			}
+		}
+
+		double middle = clock.Now();
+		JobSystemStats oneByOneStats = jobs.GetStats();
+
+		jobs.ResetStats();
+
+		for (int step = 0; step < steps; step++)
+		{
+			StepWorlds(together.data(), numWorlds, STEP, jobs);
+		}
+
+		double finish = clock.Now();
+		JobSystemStats togetherStats = jobs.GetStats();
+		int divisor = glm::max(steps, 1);
+
+		// The steals are shown as "all/from another node".
+		char oneByOneSteals[32];
+		char togetherSteals[32];
+
+		snprintf(oneByOneSteals, sizeof(oneByOneSteals), "%lld/%lld", oneByOneStats.steals, oneByOneStats.remoteSteals);
+		snprintf(togetherSteals, sizeof(togetherSteals), "%lld/%lld", togetherStats.steals, togetherStats.remoteSteals);
+
+		printf("%9d %8d %8d %16.3f %16.3f %18s %18s\n", scene.count, numWorlds, jobs.GetThreadCount(), (middle - start) * 1000.0 / divisor,
+			(finish - middle) * 1000.0 / divisor, oneByOneSteals, togetherSteals);
+
+		fflush(stdout);
+
+		for (int j = 0; j < numWorlds; j++)
+		{
+			delete oneByOne[j];
+			delete together[j];
+		}
+	}
+}
+
+void RunBatchedWorldBenchmarks(const SceneSettings& settings, int numWorlds, int steps, int threads)
+{
+	SteadyClock clock;
+	JobSystem jobs(threads);
+	BenchmarkRandom random(settings.seed);
+
+	glm::vec3 halfExtents(0.5f);
+	std::vector<PhysicsWorld*> worlds;
+	WorldBatch batch(numWorlds);
+
+	batch.AddBox(halfExtents, 1.0f);
+	batch.AddBox(halfExtents, 1.0f);
+	batch.SetRestitution(1.0f);
+
+	for (int i = 0; i < numWorlds; i++)
+	{
+		// The moving cube starts a little way off to the left, headed for the other one (give or take), spinning.
+		glm::vec3 position(-1.5f, random.Range(-0.3f, 0.3f), random.Range(-0.3f, 0.3f));
+		glm::vec3 velocity = glm::vec3(random.Range(1.0f, 4.0f), random.Range(-0.5f, 0.5f), random.Range(-0.5f, 0.5f));
+		glm::quat orientation = random.Orientation();
+		glm::vec3 spin = random.Direction() * random.Range(0.0f, 2.0f);
+
+		PhysicsWorld* world = new PhysicsWorld(jobs);
+		BodyStore& bodies = world->Bodies();
+		int moving = world->AddBox(glm::vec3(0.0f), halfExtents);
+		int still = world->AddBox(glm::vec3(0.0f), halfExtents);
+
+		bodies.Position(world->GetBody(moving)) = position;
+		bodies.Velocity(world->GetBody(moving)) = velocity;
+		bodies.Orientation(world->GetBody(moving)) = orientation;
+		bodies.AngularVelocity(world->GetBody(moving)) = spin;
+		bodies.MarkDirty(world->GetBody(moving));
+		bodies.Position(world->GetBody(still)) = glm::vec3(1.5f, 0.0f, 0.0f);
+		bodies.MarkDirty(world->GetBody(still));
+		world->SetRestitution(1.0f);
+		worlds.push_back(world);
+
+		batch.SetPosition(i, 0, position);
+		batch.SetVelocity(i, 0, velocity);
+		batch.SetOrientation(i, 0, orientation);
+		batch.SetAngularVelocity(i, 0, spin);
+		batch.SetPosition(i, 1, glm::vec3(1.5f, 0.0f, 0.0f));
+	}
+
+	long long worldContacts = 0;
+	long long batchContacts = 0;
+	double worldSeconds = 0.0;
+	double batchSeconds = 0.0;
+
+	for (int step = 0; step < steps; step++)
+	{
+		double start = clock.Now();
+
+		StepWorlds(worlds.data(), numWorlds, STEP, jobs);
+
+		double middle = clock.Now();
+
+		batch.Step(STEP, &jobs);
+
+		double finish = clock.Now();
+
+		worldSeconds += middle - start;
+		batchSeconds += finish - middle;
+
+		for (int i = 0; i < numWorlds; i++)
+		{
+			worldContacts += worlds[i]->GetStepStats().contacts > 0 ? 1 : 0;
+			batchContacts += batch.GetContactCount(i);
+		}
+	}
+
+	int divisor = glm::max(steps, 1);
+
+	printf("%8s %8s %16s %16s %16s %16s\n", "worlds", "threads", "worlds ms", "batch ms", "worlds touching", "batch touching");
+	printf("%8d %8d %16.3f %16.3f %16lld %16lld\n", numWorlds, jobs.GetThreadCount(), worldSeconds * 1000.0 / divisor,
+		batchSeconds * 1000.0 / divisor, worldContacts, batchContacts);
+
+	for (int i = 0; i < numWorlds; i++)
+	{
+		delete worlds[i];
+	}
+}
+
+#endif // _SCENE_BENCHMARK_CPP
@@ -0,0 +1,212 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SceneBenchmark.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SCENE_BENCHMARK_H
+#define _SCENE_BENCHMARK_H
+
+#include "PhysicsMetrics.h"
+#include "PhysicsWorld.h"
+#include "SceneFile.h"
+#include "WorldBatch.h"
+#include <string>
+#include <vector>
+
+// How the cubes' sizes are picked.
+enum SceneSizes
+{
+	SIZES_FIXED,	// Every cube is minSize.
+	SIZES_UNIFORM,	// Anywhere from minSize to maxSize.
+	SIZES_MIXED		// Mostly minSize, with one in a hundred at maxSize. Grids and trees both have a harder time with a few big objects among small ones.
+};
+
+// Describes a scene of cubes, like obj2 in the demo, scattered at random through a cube of space and all moving in random directions.
+struct SceneSettings
+{
+	int count;			// How many cubes.
+	float density;		// How many cubes per unit of volume. The space they're spread through grows with the count, so this stays the same.
+	float speed;		// Each cube's speed is anywhere from 0 to this (in units per second), in a random direction.
+	SceneSizes sizes;
+	float minSize;		// The cubes' scale. (obj2 is 0.2.)
+	float maxSize;
+	unsigned int seed;	// The same seed always gives the same scene.
+	float debris;		// The fraction of the cubes that are debris: on a layer of their own, colliding with everything but each other.
+	float triggers;		// The fraction of the cubes that are triggers, which only find out what they overlap.
+	float statics;		// The fraction of the cubes that are static, and never move (like the walls and floors of a level).
+	bool speculative;	// Whether the fast cubes get speculative contacts rather than being swept (see PhysicsWorld::SetSpeculativeContacts).
+	float shadowChecks;	// The fraction of the pairs checked again with the plain TestGJK every step (see PhysicsWorld::SetShadowChecks).
+	double maintenance;	// Each step's budget for upkeep, in seconds, or 0 to rebuild the tree all at once (see
+						// PhysicsWorld::SetMaintenanceBudget).
+	int pairCosts;		// How many of the most expensive pairs to report, over all of the steps (see PhysicsWorld::SetPairCosts), or 0 for none.
+	bool limits;		// Whether the world is given limits of count objects, pairs and contacts up front (see PhysicsWorld::SetLimits).
+	bool pipelined;		// Whether the tree finds each step's pairs during the step before (see PhysicsWorld::SetPipelinedBroadphase).
+	float islandRates;	// The speed under which islands are stepped less often (see PhysicsWorld::SetIslandRates), or 0 to step them all every step.
+	float hulls;		// The fraction of the cubes with a hull inside their box, tested once their boxes hit (see PhysicsWorld::SetHull).
+	int largeIslands;	// How many contacts an island needs to be solved a color at a time across the threads (see
+						// PhysicsWorld::SetLargeIslandSize), or 0 to solve every island on one thread.
+
+	SceneSettings()
+	{
+		count = 1000;
+		density = 0.125f;
+		speed = 2.0f;
+		sizes = SIZES_UNIFORM;
+		minSize = 0.1f;
+		maxSize = 0.5f;
+		seed = 1;
+		debris = 0.0f;
+		triggers = 0.0f;
+		statics = 0.0f;
+		speculative = false;
+		shadowChecks = 0.0f;
+		maintenance = 0.0;
+		pairCosts = 0;
+		limits = false;
+		pipelined = false;
+		islandRates = 0.0f;
+		hulls = 0.0f;
+		largeIslands = 0;
+	}
+};
+
+// Picks where each of a scene's cubes starts out, and how it's moving.
+void MakeSceneBodies(const SceneSettings& settings, std::vector<SceneBody>& bodies);
+
+// Adds the cubes of a scene to a world (which should be empty), and refreshes it so the broadphase knows where they all are.
+void BuildScene(PhysicsWorld& world, const SceneSettings& settings);
+
+// What running a scene measured.
+struct SceneResult
+{
+	int count;
+	int broadphase;
+	const char* broadphaseName;
+	int threads;
+
+	double setupSeconds;		// Building the scene, including putting every cube into the broadphase.
+	PhysicsStepStats average;	// Each stage's time, and the pairs and contacts, averaged over every step.
+	double allocationsPerStep;
+
+	GJKStats gjk;				// Every GJK query over all of the steps (only filled in if they were counted).
+	ShadowCheckStats shadow;	// Every shadow check over all of the steps (only filled in if the scene asked for them).
+	std::vector<PairCost> pairCosts;	// The most expensive pairs over all of the steps, the most expensive first (if the scene asked for them).
+};
+
+// Builds the scene in a new world with the given broadphase (see PhysicsWorld::SetBroadphase) and number of threads (0 is one per hardware
+// thread), and then runs steps fixed physics steps of 1/60th of a second. With no window and no real time to keep up with, they run back to
+// back as fast as they can. If gjkStats is true, it also counts how every GJK query went (see GJKStats), which costs a little time. If
+// metrics is given, every step is recorded in it (see PhysicsMetrics).
+SceneResult RunScene(const SceneSettings& settings, int steps, int broadphase, int threads, bool gjkStats = false, PhysicsMetrics* metrics = nullptr);
+
+// Prints how a batch of GJK queries went: how they ended, the size of the simplex they ended with, how often the tetrahedron case came up
+// and had to go back to a triangle, and a histogram of how many iterations they took.
+void PrintGJKStats(const GJKStats& stats);
+
+// Runs the scene once for each count and broadphase, and prints a row for each as it finishes (followed by its GJK stats, if gjkStats is true,
+// and what its shadow checks found, if it had any).
+// If metrics is given, it's reset for each run and records its steps. If results is given, each run's result is added to it.
+void RunSceneBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, const std::vector<int>& broadphases, int steps, int threads,
+	bool gjkStats = false, PhysicsMetrics* metrics = nullptr, std::vector<SceneResult>* results = nullptr);
+
+// For each count, saves the scene as a text and a binary scene file (in the working directory) and times loading them back: parsing the
+// text, copying the binary into a Scene, opening the binary as a SceneView, and adding the bodies from the view to a new world. Then it
+// saves that world as a WorldSnapshot, and times loading it into another one, tree and all.
+// Returns false (after saying why) if the files can't be written or read.
+bool RunSceneFileBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int threads);
+
+// For each count and broadphase, runs the scene in deterministic mode (see PhysicsWorld::SetDeterministic) on one thread and on threads
+// threads (0 is one per hardware thread) side by side, and compares their StateHash after every step. Prints whether they stayed the same,
+// or the first step where they didn't. Returns false if any of them didn't.
+bool RunDeterminismChecks(const SceneSettings& settings, const std::vector<int>& counts, const std::vector<int>& broadphases, int steps,
+	int threads);
+
+// For each count, runs the scene and takes a StateSnapshot after every step, then encodes it on its own and as a delta against the step
+// before, and decodes the delta again (checking it comes back the same). Prints the average size of each per object, next to full float
+// state, and how long encoding and decoding took. Returns false if any delta didn't decode to its snapshot.
+bool RunSnapshotBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int threads);
+
+// For each count, runs the scene in deterministic mode, saving its state (see PhysicsWorld::SaveState) into a ring of the last 10 steps
+// every step, and every 10 steps restores the oldest and runs those 10 steps again, the way rollback does when an input turns up late.
+// Prints how long the saves and restores took on average, how long each rollback took all together, and whether every rollback ended up
+// exactly where it had been. Returns false if any didn't.
+bool RunRollbackBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int threads);
+
+// Runs the scene for the given count and broadphase like RunScene, but through a SimulationRecorder, saving it all to fileName. Every 60th
+// step the first cube is turned around by hand, so the recording has some changes in it as well as the steps. Returns false (after saying
+// why) if the recording can't be written.
+bool RecordScene(const SceneSettings& settings, int steps, int broadphase, int threads, const std::string& fileName);
+
+// Plays back a recording (see SimulationReplayer) as fast as it goes, on threads threads, and prints how long its steps took when they were
+// recorded and when they were played back, the slowest steps, and whether the replay did exactly what the recording did. Returns false if
+// the recording couldn't be played back.
+bool ReplayRecording(const std::string& fileName, int threads);
+
+// For each count, saves a row of regions, each a scene of that many cubes, as binary scene files (in the working directory), and runs
+// steps steps with a WorldStreamer streaming them in and out around a point that moves from one end of the row to the other. Prints how
+// long the streamer's updates and the steps took (on average and at worst), and how many cubes were in the world at most, next to how many
+// there are in the whole row. Returns false (after saying why) if the files can't be written or read.
+bool RunStreamingBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int threads);
+
+// For each count, runs the scene twice: once in full, and once with level of detail (see PhysicsWorld::SetLevelOfDetail) around an interest
+// point in the middle, close enough that only about a fifth of the cubes are near it. Prints how long the steps took (on average and at
+// worst), how many pairs and contacts they had and how many of the cubes were far.
+void RunLevelOfDetailBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int threads);
+
+// For each count, runs the scene with an InterestManager of numClients clients, each following a cube of its own and interested in
+// everything within 10 units of it, and updates them after each step, the way a server works out what to replicate to each player. Prints
+// how long the updates took (on average and at worst), and how many cubes each client had in view and how many came into and went out of
+// view each step, on average.
+void RunInterestBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int numClients, int threads);
+
+// For each count, runs the scene on a job system of threads threads with a batch of debug drawing submitted ahead of each step (passes
+// times over the box of every cube, from where they were before the step) and waited on after it, the way a game builds the drawing for
+// the frame alongside the physics. It runs once with the drawing as critical as the step, which is what having no priorities was like,
+// and once as background work. Prints how long the steps took (on average and at worst) and how long the whole frames took.
+void RunPriorityBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int steps, int passes, int threads);
+
+// For each count, builds numWorlds worlds of that many cubes (each from its own seed), all on one job system set up as jobSettings says, and
+// runs steps steps of all of them twice: stepping one world after another, each spread across every thread, and all at once with
+// StepWorlds. Prints how long a step of every world took each way, on average, and how many jobs were stolen each way (and how many of
+// those from another NUMA node).
+void RunManyWorldBenchmarks(const SceneSettings& settings, const std::vector<int>& counts, int numWorlds, int steps,
+	const JobSystemSettings& jobSettings);
+
+// Runs numWorlds copies of the demo's two cubes (one thrown at the other, at its own speed and spin in each world, from the settings' seed)
+// for steps steps, once as a PhysicsWorld apiece stepped with StepWorlds and once as a WorldBatch, both on a job system of threads threads.
+// Prints how long a step of every world took each way, and in how many steps of how many worlds the cubes were touching each way (which
+// should be close, as a check that the batch is simulating the same thing).
+void RunBatchedWorldBenchmarks(const SceneSettings& settings, int numWorlds, int steps, int threads);
+
+#endif //_SCENE_BENCHMARK_H
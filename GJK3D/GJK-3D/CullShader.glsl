@@ -0,0 +1,220 @@
+/*
+Title: GJK-3D (OBB)
+File Name: CullShader.glsl
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#version 430 core // Compute shaders and shader storage buffers need OpenGL 4.3.
+
+// Each invocation tests one instance. 64 at a time is a good size for a work group on most GPUs.
+layout(local_size_x = 64) in;
+
+// An instance's transform, as the vertex shader reads it: a position, a quaternion packed into 16 bit fixed point, and a scale in half floats
+// (see InstanceTransform in VertexLayout.h). The shader only ever copies it, so it's left packed.
+struct InstanceTransform
+{
+	float position[3];
+	uint rotation[2];
+	uint scale[2];
+};
+
+// One object to draw: its transform, its bounds in world space, and where its model's levels of detail are in the pool's levels.
+// (This is laid out the same as CullInstance in ModelPool.h.)
+struct CullInstance
+{
+	InstanceTransform transform;
+	vec3 boundsMin;
+	uint firstLevel;
+	vec3 boundsMax;
+	uint numLevels;
+};
+
+// The same as DrawElementsIndirectCommand in ModelPool.h.
+struct DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Instances
+{
+	CullInstance instances[];
+};
+
+// One command per level of detail of each model. They start out with no instances, and each visible instance adds one to its level's command.
+layout(std430, binding = 1) buffer Commands
+{
+	DrawCommand commands[];
+};
+
+// Where the visible instances' transforms go, packed together by level. This is the buffer the vertex shader reads its instance transform
+// from. (The view projection is applied there, from the Camera block.)
+layout(std430, binding = 2) writeonly buffer VisibleTransforms
+{
+	InstanceTransform transforms[];
+};
+
+// How far out of place each level is, as a fraction of its model's size (see PooledLevel in ModelPool.h).
+layout(std430, binding = 3) readonly buffer LevelErrors
+{
+	float levelErrors[];
+};
+
+// How many of the instances were inside the frustum, and how many of those were then found to be hidden. They start at 0 every frame.
+layout(std430, binding = 4) buffer CullCounts
+{
+	uint inFrustum;
+	uint occluded;
+};
+
+uniform mat4 viewProjection;
+uniform vec4 planes[6];		// The camera's frustum planes, pointing inwards (see Frustum.h).
+uniform uint numInstances;
+uniform float lodScale;		// How tall something one unit across and one unit away is on screen, as a fraction of its height.
+uniform float lodError;		// How far out of place a level can look on screen, as a fraction of its height (see ModelPool::SetLODError).
+
+// The depth pyramid from the last frame to test against (see DepthPyramid.h), if occlusion is on: the camera it was drawn with, the size of
+// the depth buffer it was made from, and how many levels it has.
+uniform bool occlusion;
+uniform sampler2D pyramid;
+uniform mat4 pyramidViewProjection;
+uniform ivec2 depthSize;
+uniform int pyramidLevels;
+
+// Whether the box from boundsMin to boundsMax was hidden behind what the depth pyramid's frame drew. Anything that can't be tested (off the
+// edge of that frame's screen, or crossing the camera's near plane) counts as not hidden.
+bool isOccluded(vec3 boundsMin, vec3 boundsMax)
+{
+	vec3 screenMin = vec3(1.0e30);
+	vec3 screenMax = vec3(-1.0e30);
+
+	for (int i = 0; i < 8; i++)
+	{
+		vec3 corner = mix(boundsMin, boundsMax, vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+		vec4 clip = pyramidViewProjection * vec4(corner, 1.0);
+
+		if (clip.w <= 0.0)
+		{
+			return false;
+		}
+
+		vec3 ndc = clip.xyz / clip.w;
+		screenMin = min(screenMin, ndc);
+		screenMax = max(screenMax, ndc);
+	}
+
+	if (screenMin.z < -1.0 || any(lessThan(screenMax.xy, vec2(-1.0))) || any(greaterThan(screenMin.xy, vec2(1.0))))
+	{
+		return false;
+	}
+
+	// The rectangle in the depth buffer's pixels, and the nearest depth of the box (in the same 0 to 1 range as the depth buffer).
+	vec2 pixelMin = clamp(screenMin.xy * 0.5 + 0.5, 0.0, 1.0) * vec2(depthSize);
+	vec2 pixelMax = clamp(screenMax.xy * 0.5 + 0.5, 0.0, 1.0) * vec2(depthSize);
+	float nearest = screenMin.z * 0.5 + 0.5;
+
+	// A texel of level L covers 2^(L+1) pixels on a side, so the level where the rectangle is no more than 2 texels across is the one to read.
+	float extent = max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y);
+	int level = clamp(int(ceil(log2(max(extent, 1.0)))) - 1, 0, pyramidLevels - 1);
+
+	ivec2 levelSize = textureSize(pyramid, level);
+	ivec2 first = min(ivec2(pixelMin) >> (level + 1), levelSize - 1);
+	ivec2 last = min(ivec2(pixelMax) >> (level + 1), levelSize - 1);
+	float farthest = 0.0;
+
+	for (int y = first.y; y <= last.y; y++)
+	{
+		for (int x = first.x; x <= last.x; x++)
+		{
+			farthest = max(farthest, texelFetch(pyramid, ivec2(x, y), level).r);
+		}
+	}
+
+	return nearest > farthest;
+}
+
+void main(void)
+{
+	uint index = gl_GlobalInvocationID.x;
+
+	// The last work group can go past the end.
+	if (index >= numInstances)
+	{
+		return;
+	}
+
+	CullInstance instance = instances[index];
+
+	// The box is outside if the corner farthest along any plane's normal is still behind that plane.
+	for (int i = 0; i < 6; i++)
+	{
+		vec3 farthest = mix(instance.boundsMin, instance.boundsMax, greaterThanEqual(planes[i].xyz, vec3(0.0)));
+
+		if (dot(planes[i].xyz, farthest) + planes[i].w < 0.0)
+		{
+			return;
+		}
+	}
+
+	atomicAdd(inFrustum, 1u);
+
+	// Then whether it's hidden behind something.
+	if (occlusion && isOccluded(instance.boundsMin, instance.boundsMax))
+	{
+		atomicAdd(occluded, 1u);
+		return;
+	}
+
+	// Pick the coarsest level that doesn't look too far off at this size on screen, the same way ModelPool::SelectLOD does. (The camera
+	// being inside the box means the real thing.)
+	uint level = instance.firstLevel;
+	float size = length(instance.boundsMax - instance.boundsMin);
+	float w = (viewProjection * vec4((instance.boundsMin + instance.boundsMax) * 0.5, 1.0)).w;
+
+	if (lodError > 0.0 && w > size * 0.5)
+	{
+		float screenSize = size * lodScale / w;
+
+		while (level + 1u < instance.firstLevel + instance.numLevels && levelErrors[level + 1u] * screenSize <= lodError)
+		{
+			level++;
+		}
+	}
+
+	// Take the next spot in this level's part of the buffer, and put the transform there.
+	uint slot = atomicAdd(commands[level].instanceCount, 1u);
+
+	transforms[commands[level].baseInstance + slot] = instance.transform;
+}
@@ -0,0 +1,302 @@
+/*
+Title: GJK-3D (OBB)
+File Name: DebrisShader.glsl
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#version 430 core // Compute shaders and shader storage buffers need OpenGL 4.3.
+
+// GPUDebris's step (see GPUDebris.h), as two dispatches of this one shader, which stage picks between:
+// 0 integrates every piece in Source into Destination, bounces it off the floor, and puts it in the grid by its center.
+// 1 bounces every piece in Source off the others it overlaps, writes it back into Destination, and writes out its transform.
+// The overlap test is the boolean GJK test in GJKFunctions.glsl, which this is linked with.
+layout(local_size_x = 64) in;
+
+// (This is declared the same as in GJKFunctions.glsl.)
+struct Box
+{
+	vec4 center;
+	vec4 axes[3];
+};
+
+// One piece of debris. (This is laid out the same as GPUDebrisBody in GPUDebris.h.)
+struct Body
+{
+	vec4 position;			// The center, with the half extent in w.
+	vec4 orientation;		// A quaternion, as x, y, z, w.
+	vec4 velocity;
+	vec4 angularVelocity;
+};
+
+layout(std430, binding = 0) readonly buffer Source
+{
+	Body source[];
+};
+
+layout(std430, binding = 1) writeonly buffer Destination
+{
+	Body destination[];
+};
+
+// The hashed grid: how many pieces went into each cell (which can be more than it has room for), and the ones that fit, cellCapacity to a cell.
+layout(std430, binding = 2) buffer CellCounts
+{
+	uint cellCounts[];
+};
+
+layout(std430, binding = 3) buffer CellEntries
+{
+	uint cellEntries[];
+};
+
+// Each piece's transform, which is drawn straight from this buffer, packed the way the vertex shader reads it (see InstanceTransform in
+// VertexLayout.h): a position, a quaternion in 16 bit fixed point, and a scale in half floats.
+struct InstanceTransform
+{
+	float position[3];
+	uint rotation[2];
+	uint scale[2];
+};
+
+layout(std430, binding = 4) writeonly buffer Transforms
+{
+	InstanceTransform transforms[];
+};
+
+uniform int stage;
+uniform uint numBodies;
+uniform float dt;
+uniform vec3 gravity;
+uniform float floorHeight;
+uniform float restitution;
+uniform float cellSize;
+uniform uint numCells;
+uniform uint cellCapacity;
+uniform float modelHalfExtent;
+
+// See GJKFunctions.glsl.
+bool testGJK(Box a, Box b);
+
+// How far it is from a piece's center to its corners, for its half extent.
+const float CORNER_DISTANCE = 1.7320508;
+
+// The rotation matrix of a quaternion (each column being where one of the axes ends up).
+mat3 toMatrix(vec4 q)
+{
+	return mat3(
+		1.0 - 2.0 * (q.y * q.y + q.z * q.z), 2.0 * (q.x * q.y + q.w * q.z), 2.0 * (q.x * q.z - q.w * q.y),
+		2.0 * (q.x * q.y - q.w * q.z), 1.0 - 2.0 * (q.x * q.x + q.z * q.z), 2.0 * (q.y * q.z + q.w * q.x),
+		2.0 * (q.x * q.z + q.w * q.y), 2.0 * (q.y * q.z - q.w * q.x), 1.0 - 2.0 * (q.x * q.x + q.y * q.y));
+}
+
+Box toBox(Body body, mat3 rotation)
+{
+	Box box;
+	box.center = vec4(body.position.xyz, 0.0);
+
+	for (int i = 0; i < 3; i++)
+	{
+		box.axes[i] = vec4(rotation[i], body.position.w);
+	}
+
+	return box;
+}
+
+// Which of the hashed cells a cell lands in. (This is the same hash as the HashGrid broadphase's.)
+uint hashCell(ivec3 cell)
+{
+	uint hash = (uint(cell.x) * 73856093u) ^ (uint(cell.y) * 19349663u) ^ (uint(cell.z) * 83492791u);
+
+	return hash % numCells;
+}
+
+ivec3 cellOf(vec3 point)
+{
+	return ivec3(floor(point / cellSize));
+}
+
+void integrate(uint index)
+{
+	Body body = source[index];
+
+	body.velocity.xyz += gravity * dt;
+	body.position.xyz += body.velocity.xyz * dt;
+
+	// The orientation changes by half of the angular velocity (as a quaternion) times the orientation.
+	vec3 spin = body.angularVelocity.xyz;
+	vec4 q = body.orientation;
+
+	body.orientation = normalize(q + vec4(q.w * spin + cross(spin, q.xyz), -dot(spin, q.xyz)) * (0.5 * dt));
+
+	// How far the piece reaches down from its center, which is how much of each of its axes points down.
+	mat3 rotation = toMatrix(body.orientation);
+	float reach = body.position.w * (abs(rotation[0].y) + abs(rotation[1].y) + abs(rotation[2].y));
+	float depth = floorHeight - (body.position.y - reach);
+
+	if (depth > 0.0)
+	{
+		body.position.y += depth;
+
+		if (body.velocity.y < 0.0)
+		{
+			body.velocity.y *= -restitution;
+		}
+
+		// Sliding along the floor and rolling on it both slow the piece down, until it comes to rest (in about a second).
+		float damping = exp(-4.0 * dt);
+
+		body.velocity.xz *= damping;
+		body.angularVelocity.xyz *= damping;
+	}
+
+	destination[index] = body;
+
+	// If the cell is full, the piece is left out of it, and just doesn't run into anything this step.
+	uint cell = hashCell(cellOf(body.position.xyz));
+	uint slot = atomicAdd(cellCounts[cell], 1u);
+
+	if (slot < cellCapacity)
+	{
+		cellEntries[cell * cellCapacity + slot] = index;
+	}
+}
+
+void collide(uint index)
+{
+	Body body = source[index];
+	mat3 rotation = toMatrix(body.orientation);
+	Box box = toBox(body, rotation);
+
+	ivec3 home = cellOf(body.position.xyz);
+	vec3 push = vec3(0.0);
+
+	// The cells around this one can hash to the same cell, whose pieces should only be looked at once.
+	uint visited[27];
+	int numVisited = 0;
+
+	for (int z = -1; z <= 1; z++)
+	{
+		for (int y = -1; y <= 1; y++)
+		{
+			for (int x = -1; x <= 1; x++)
+			{
+				uint cell = hashCell(home + ivec3(x, y, z));
+				bool seen = false;
+
+				for (int i = 0; i < numVisited; i++)
+				{
+					seen = seen || visited[i] == cell;
+				}
+
+				if (seen)
+				{
+					continue;
+				}
+
+				visited[numVisited] = cell;
+				numVisited++;
+
+				uint count = min(cellCounts[cell], cellCapacity);
+
+				for (uint i = 0u; i < count; i++)
+				{
+					uint other = cellEntries[cell * cellCapacity + i];
+
+					if (other == index)
+					{
+						continue;
+					}
+
+					// Don't bother with GJK unless the spheres around the two pieces overlap.
+					Body otherBody = source[other];
+					vec3 offset = body.position.xyz - otherBody.position.xyz;
+					float distanceSquared = dot(offset, offset);
+					float reach = (body.position.w + otherBody.position.w) * CORNER_DISTANCE;
+
+					if (distanceSquared >= reach * reach || !testGJK(box, toBox(otherBody, toMatrix(otherBody.orientation))))
+					{
+						continue;
+					}
+
+					// Bounce off along the line between the centers (or straight up, if they're right on top of each other). The other piece
+					// does the same from its side, so with equal masses, each takes half of the change in their relative velocity.
+					float centerDistance = sqrt(distanceSquared);
+					vec3 normal = centerDistance > 1e-6 ? offset / centerDistance : vec3(0.0, 1.0, 0.0);
+					float approach = dot(body.velocity.xyz - otherBody.velocity.xyz, normal);
+
+					if (approach < 0.0)
+					{
+						body.velocity.xyz -= normal * approach * (1.0 + restitution) * 0.5;
+					}
+
+					// And move out of the way of the other piece, by half of how far the spheres inside them overlap, so that pieces lying on
+					// each other settle instead of sinking through.
+					push += normal * max(body.position.w + otherBody.position.w - centerDistance, 0.0) * 0.5;
+				}
+			}
+		}
+	}
+
+	body.position.xyz += push;
+
+	destination[index] = body;
+
+	// The model is scaled from its own size to the piece's.
+	float scale = body.position.w / modelHalfExtent;
+
+	InstanceTransform transform;
+	transform.position = float[3](body.position.x, body.position.y, body.position.z);
+	transform.rotation = uint[2](packSnorm2x16(body.orientation.xy), packSnorm2x16(body.orientation.zw));
+	transform.scale = uint[2](packHalf2x16(vec2(scale)), packHalf2x16(vec2(scale, 0.0)));
+
+	transforms[index] = transform;
+}
+
+void main(void)
+{
+	uint index = gl_GlobalInvocationID.x;
+
+	// The last work group can go past the end.
+	if (index >= numBodies)
+	{
+		return;
+	}
+
+	if (stage == 0)
+	{
+		integrate(index);
+	}
+	else
+	{
+		collide(index);
+	}
+}
@@ -0,0 +1,252 @@
+/*
+Title: GJK-3D (OBB)
+File Name: DebugDraw.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _DEBUG_DRAW_CPP
+#define _DEBUG_DRAW_CPP
+
+#include "DebugDraw.h"
+#include "VertexLayout.h"
+#include <cmath>
+#include <cstddef>
+
+DebugDraw::DebugDraw()
+{
+	enabled = false;
+
+	glGenVertexArrays(1, &vao);
+
+	// Room for a few thousand lines to start with. The buffer grows if a frame needs more.
+	buffer.Reserve(sizeof(DebugVertex) * 8192);
+	setAttributes();
+}
+
+DebugDraw::~DebugDraw()
+{
+	glDeleteVertexArrays(1, &vao);
+}
+
+void DebugDraw::setAttributes()
+{
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer.GetBuffer());
+
+	// The same locations as the models' vertices (see VertexLayout), so the models' shaders can draw these too.
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (void*)offsetof(DebugVertex, position));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugVertex), (void*)offsetof(DebugVertex, color));
+
+	glBindVertexArray(0);
+}
+
+GLuint DebugDraw::PackColor(const glm::vec4& color)
+{
+	glm::vec4 bytes = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+
+	return (GLuint)bytes.r | ((GLuint)bytes.g << 8) | ((GLuint)bytes.b << 16) | ((GLuint)bytes.a << 24);
+}
+
+void DebugDraw::AddLine(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color)
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	DebugVertex vertex;
+	vertex.color = PackColor(color);
+
+	vertex.position = a;
+	vertices.push_back(vertex);
+
+	vertex.position = b;
+	vertices.push_back(vertex);
+}
+
+void DebugDraw::AddPoint(const glm::vec3& point, float size, const glm::vec4& color)
+{
+	float half = size * 0.5f;
+
+	AddLine(point - glm::vec3(half, 0.0f, 0.0f), point + glm::vec3(half, 0.0f, 0.0f), color);
+	AddLine(point - glm::vec3(0.0f, half, 0.0f), point + glm::vec3(0.0f, half, 0.0f), color);
+	AddLine(point - glm::vec3(0.0f, 0.0f, half), point + glm::vec3(0.0f, 0.0f, half), color);
+}
+
+void DebugDraw::AddArrow(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color)
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	AddLine(from, to, color);
+
+	glm::vec3 direction = to - from;
+	float length = glm::length(direction);
+
+	if (length <= 0.0f)
+	{
+		return;
+	}
+
+	direction /= length;
+
+	// Two lines across the arrow, perpendicular to it (and to each other), make the head. Any axis that isn't along the arrow gives a
+	// perpendicular one.
+	glm::vec3 side = glm::normalize(glm::cross(direction, fabsf(direction.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f)));
+	glm::vec3 up = glm::cross(direction, side);
+	glm::vec3 back = to - direction * (length * 0.2f);
+	float width = length * 0.1f;
+
+	AddLine(to, back + side * width, color);
+	AddLine(to, back - side * width, color);
+	AddLine(to, back + up * width, color);
+	AddLine(to, back - up * width, color);
+}
+
+// The 12 edges of a box, as pairs of corners numbered by which sides they're on (bit 0 for x, 1 for y, 2 for z).
+static const int BOX_EDGES[12][2] =
+{
+	{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+	{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+	{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+};
+
+void DebugDraw::AddBox(const AABB& box, const glm::vec4& color)
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	glm::vec3 corners[8];
+
+	for (int i = 0; i < 8; i++)
+	{
+		corners[i] = glm::vec3((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+	}
+
+	for (int i = 0; i < 12; i++)
+	{
+		AddLine(corners[BOX_EDGES[i][0]], corners[BOX_EDGES[i][1]], color);
+	}
+}
+
+void DebugDraw::AddOBB(const OBBShape& box, const glm::vec4& color)
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	glm::vec3 corners[8];
+
+	for (int i = 0; i < 8; i++)
+	{
+		corners[i] = box.center;
+		corners[i] += box.axes[0] * ((i & 1) ? box.halfExtents.x : -box.halfExtents.x);
+		corners[i] += box.axes[1] * ((i & 2) ? box.halfExtents.y : -box.halfExtents.y);
+		corners[i] += box.axes[2] * ((i & 4) ? box.halfExtents.z : -box.halfExtents.z);
+	}
+
+	for (int i = 0; i < 12; i++)
+	{
+		AddLine(corners[BOX_EDGES[i][0]], corners[BOX_EDGES[i][1]], color);
+	}
+}
+
+void DebugDraw::AddSimplex(const glm::vec3* points, int count, const glm::vec4& color)
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	if (count == 1)
+	{
+		AddPoint(points[0], 0.05f, color);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		for (int j = i + 1; j < count; j++)
+		{
+			AddLine(points[i], points[j], color);
+		}
+	}
+}
+
+void DebugDraw::Draw(GLuint program)
+{
+	if (vertices.empty())
+	{
+		return;
+	}
+
+	GLsizeiptr size = sizeof(DebugVertex) * vertices.size();
+
+	if (buffer.Reserve(size))
+	{
+		setAttributes();
+	}
+
+	// Every write starts on a 256 byte boundary, which is a whole number of vertices, so the draw can start at the first one.
+	GLsizeiptr offset = buffer.Write(vertices.data(), size);
+
+	glBindVertexArray(vao);
+	glUseProgram(program);
+
+	// The vao doesn't have the instance transform (locations 2 through 4), so the shader reads the current value of those attributes
+	// instead, the same as the overlay does. The lines are already in world space, so that's a transform that does nothing, and the camera
+	// does the rest.
+	VertexLayout::SetIdentityInstance();
+
+	glDisable(GL_DEPTH_TEST);
+
+	glDrawArrays(GL_LINES, (GLint)(offset / sizeof(DebugVertex)), (GLsizei)vertices.size());
+
+	glEnable(GL_DEPTH_TEST);
+
+	glBindVertexArray(0);
+
+	// Once the GPU gets past this draw, that part of the buffer can be written again.
+	buffer.Fence();
+
+	vertices.clear();
+}
+
+#endif // _DEBUG_DRAW_CPP
@@ -0,0 +1,113 @@
+/*
+Title: GJK-3D (OBB)
+File Name: DebugDraw.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _DEBUG_DRAW_H
+#define _DEBUG_DRAW_H
+
+#include "GLIncludes.h"
+#include "StreamBuffer.h"
+#include "AABB.h"
+#include "Shapes.h"
+#include <vector>
+
+// One end of a debug line: where it is in world space, and its color as 8 bits each of red, green, blue and alpha (red in the lowest byte).
+struct DebugVertex
+{
+	glm::vec3 position;
+	GLuint color;
+};
+
+// Collects lines for seeing what the collision detection is doing (boxes, contact points, normals, GJK simplices) and draws all of them at
+// once. Each Add only appends a few vertices to an array, and Draw sends the whole frame's worth up through a persistently mapped stream buffer
+// in one write and draws it with a single glDrawArrays, so even a line around every object costs one draw call. Points are drawn as little
+// crosses, so that everything can be lines and go in the same call.
+// While it's disabled, every Add returns right away, so the calls can be left in.
+class DebugDraw
+{
+	GLuint vao;
+
+	// The lines, two vertices each, added since the last Draw.
+	std::vector<DebugVertex> vertices;
+	StreamBuffer buffer;
+
+	bool enabled;
+
+	// Points the vertex attributes at the stream buffer. This has to happen again whenever the buffer is recreated.
+	void setAttributes();
+
+public:
+	DebugDraw();
+	~DebugDraw();
+
+	void SetEnabled(bool inEnabled)
+	{
+		enabled = inEnabled;
+	}
+	bool IsEnabled() const
+	{
+		return enabled;
+	}
+
+	// Packs a color for a DebugVertex.
+	static GLuint PackColor(const glm::vec4& color);
+
+	void AddLine(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color);
+
+	// A cross of three lines, size across, centered on the point.
+	void AddPoint(const glm::vec3& point, float size, const glm::vec4& color);
+
+	// A line from one point to another, with a small head on the end.
+	void AddArrow(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color);
+
+	// The 12 edges of a box.
+	void AddBox(const AABB& box, const glm::vec4& color);
+	void AddOBB(const OBBShape& box, const glm::vec4& color);
+
+	// Every edge between count points (1 to 4): a point, a line, a triangle or a tetrahedron, like a GJK simplex.
+	void AddSimplex(const glm::vec3* points, int count, const glm::vec4& color);
+
+	int NumLines() const
+	{
+		return (int)vertices.size() / 2;
+	}
+
+	// Draws everything added since the last Draw with the given shader program (which should be the models' program), seen through
+	// whatever camera is bound for its Camera block, and starts over. The lines are drawn over everything else, without the depth test, so
+	// the contacts inside objects still show. The depth test is put back afterwards.
+	void Draw(GLuint program);
+};
+
+#endif //_DEBUG_DRAW_H
@@ -0,0 +1,214 @@
+/*
+Title: GJK-3D (OBB)
+File Name: DepthPyramid.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _DEPTH_PYRAMID_CPP
+#define _DEPTH_PYRAMID_CPP
+
+#include "DepthPyramid.h"
+#include "MemoryTracker.h"
+
+// The size of a level from the size of the one below it, rounding up.
+static int halfSize(int size)
+{
+	return size > 1 ? (size + 1) / 2 : 1;
+}
+
+// How many bytes a pyramid of numLevels levels takes, starting from width by height, one float per texel.
+static size_t pyramidBytes(int width, int height, int numLevels)
+{
+	size_t bytes = 0;
+
+	for (int i = 0; i < numLevels; i++)
+	{
+		bytes += sizeof(float) * width * height;
+		width = halfSize(width);
+		height = halfSize(height);
+	}
+
+	return bytes;
+}
+
+DepthPyramid::DepthPyramid()
+{
+	depthCopy = 0;
+	pyramid = 0;
+	depthWidth = 0;
+	depthHeight = 0;
+	numLevels = 0;
+
+	program = 0;
+	sourceSizeLocation = -1;
+	fromDepthLocation = -1;
+
+	viewProjection = glm::mat4(1.0f);
+	valid = false;
+}
+
+DepthPyramid::~DepthPyramid()
+{
+	resize(0, 0);
+}
+
+bool DepthPyramid::SetProgram(const ShaderProgram& inProgram)
+{
+	if (!GLEW_VERSION_4_3 || inProgram.GetProgram() == 0)
+	{
+		program = 0;
+		valid = false;
+		return false;
+	}
+
+	program = inProgram.GetProgram();
+	sourceSizeLocation = inProgram.GetUniform("sourceSize");
+	fromDepthLocation = inProgram.GetUniform("fromDepth");
+
+	return true;
+}
+
+void DepthPyramid::resize(int width, int height)
+{
+	if (depthCopy != 0)
+	{
+		glDeleteTextures(1, &depthCopy);
+		glDeleteTextures(1, &pyramid);
+
+		TrackFree(MEMORY_GPU, sizeof(float) * depthWidth * depthHeight + pyramidBytes(halfSize(depthWidth), halfSize(depthHeight), numLevels));
+
+		depthCopy = 0;
+		pyramid = 0;
+	}
+
+	depthWidth = width;
+	depthHeight = height;
+	numLevels = 0;
+	valid = false;
+
+	if (width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	// Level 0 is half the depth buffer, and there's a level for every halving after that, down to 1 by 1.
+	int levelWidth = halfSize(width);
+	int levelHeight = halfSize(height);
+
+	for (numLevels = 1; levelWidth > 1 || levelHeight > 1; numLevels++)
+	{
+		levelWidth = halfSize(levelWidth);
+		levelHeight = halfSize(levelHeight);
+	}
+
+	glGenTextures(1, &depthCopy);
+	glBindTexture(GL_TEXTURE_2D, depthCopy);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// Every read of the pyramid is a texelFetch of a particular level, so the filtering never comes into it, but the texture has to count
+	// as complete at every level to be read at all.
+	glGenTextures(1, &pyramid);
+	glBindTexture(GL_TEXTURE_2D, pyramid);
+	glTexStorage2D(GL_TEXTURE_2D, numLevels, GL_R32F, halfSize(width), halfSize(height));
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	TrackAllocation(MEMORY_GPU, sizeof(float) * width * height + pyramidBytes(halfSize(width), halfSize(height), numLevels));
+}
+
+void DepthPyramid::Build(int width, int height, const glm::mat4& inViewProjection)
+{
+	if (program == 0 || width <= 0 || height <= 0)
+	{
+		valid = false;
+		return;
+	}
+
+	if (width != depthWidth || height != depthHeight)
+	{
+		resize(width, height);
+	}
+
+	// Copying from a depth buffer into a depth texture copies the depth, whatever format either of them is in.
+	glBindTexture(GL_TEXTURE_2D, depthCopy);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	GLint drawProgram;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &drawProgram);
+
+	glUseProgram(program);
+
+	// The first level is made from the depth copy, which can only be read as a texture (depth formats can't be images), and every level
+	// after it from the level before, as an image. Each pass has to see everything the one before it wrote.
+	int sourceWidth = width;
+	int sourceHeight = height;
+
+	for (int level = 0; level < numLevels; level++)
+	{
+		int levelWidth = halfSize(sourceWidth);
+		int levelHeight = halfSize(sourceHeight);
+
+		glUniform2i(sourceSizeLocation, sourceWidth, sourceHeight);
+		glUniform1i(fromDepthLocation, level == 0 ? 1 : 0);
+
+		if (level == 0)
+		{
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, depthCopy);
+		}
+		else
+		{
+			glBindImageTexture(1, pyramid, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		}
+
+		glBindImageTexture(0, pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		sourceWidth = levelWidth;
+		sourceHeight = levelHeight;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glUseProgram(drawProgram);
+
+	viewProjection = inViewProjection;
+	valid = true;
+}
+
+#endif // _DEPTH_PYRAMID_CPP
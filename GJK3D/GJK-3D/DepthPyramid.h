@@ -0,0 +1,128 @@
+/*
+Title: GJK-3D (OBB)
+File Name: DepthPyramid.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _DEPTH_PYRAMID_H
+#define _DEPTH_PYRAMID_H
+
+#include "GLIncludes.h"
+#include "ShaderProgram.h"
+
+// A hierarchical depth buffer (a "Hi-Z" pyramid) for occlusion culling: a chain of mip levels where each texel holds the farthest depth of
+// the block of pixels under it. Level 0 is half the size of the depth buffer, and each level after it is half the one before (rounding up,
+// so a level's texel always covers whole texels of the one below), down to 1 by 1.
+// To test something, take the rectangle its bounds cover on screen and the level where that's at most 2 by 2 texels. If even the nearest
+// point of its bounds is farther than the farthest depth in those texels, something that was drawn is in front of all of it.
+// It's built from the depth of the frame that was just drawn, with the camera that drew it, and culls the next frame's objects (see
+// ModelPool::SetOcclusion), since the depth of the frame being culled doesn't exist yet. So something that's just come out from behind
+// something else shows up a frame late.
+// The depth is copied out of whatever framebuffer is bound for reading (the window's or a RenderTarget's), and the levels are made with a
+// compute shader (DepthPyramidShader.glsl), so this needs OpenGL 4.3. Everything has to be on the thread with the context.
+class DepthPyramid
+{
+	// The depth buffer copied into a texture (the window's depth can't be read by a shader any other way), and the pyramid itself.
+	GLuint depthCopy;
+	GLuint pyramid;
+
+	// The size of the depth buffer the pyramid was made for, and how many levels it has.
+	int depthWidth;
+	int depthHeight;
+	int numLevels;
+
+	// The compute shader program (0 if there isn't one), and its uniforms.
+	GLuint program;
+	GLint sourceSizeLocation;
+	GLint fromDepthLocation;
+
+	// The camera the depth was drawn with, and whether there's a pyramid to test against yet.
+	glm::mat4 viewProjection;
+	bool valid;
+
+	// Makes the textures for a depth buffer of the given size, throwing away the old ones.
+	void resize(int width, int height);
+
+	// Can't be copied, since it owns the textures.
+	DepthPyramid(const DepthPyramid&);
+	DepthPyramid& operator=(const DepthPyramid&);
+
+public:
+	DepthPyramid();
+	~DepthPyramid();
+
+	// Hands the pyramid a linked compute shader program (made from DepthPyramidShader.glsl). Call this again whenever the program is reloaded.
+	// Returns false if compute shaders aren't supported, and the pyramid is never built.
+	bool SetProgram(const ShaderProgram& inProgram);
+
+	bool CanBuild() const
+	{
+		return program != 0;
+	}
+
+	// Copies the depth of the framebuffer bound for reading (width by height pixels, drawn with inViewProjection) and builds the pyramid
+	// from it. The textures are only made again if the size changes.
+	void Build(int width, int height, const glm::mat4& inViewProjection);
+
+	// Throws the pyramid away, so nothing is culled against it until the next Build.
+	void Invalidate()
+	{
+		valid = false;
+	}
+
+	bool IsValid() const
+	{
+		return valid;
+	}
+	GLuint GetTexture() const
+	{
+		return pyramid;
+	}
+	int GetDepthWidth() const
+	{
+		return depthWidth;
+	}
+	int GetDepthHeight() const
+	{
+		return depthHeight;
+	}
+	int GetNumLevels() const
+	{
+		return numLevels;
+	}
+	const glm::mat4& GetViewProjection() const
+	{
+		return viewProjection;
+	}
+};
+
+#endif //_DEPTH_PYRAMID_H
@@ -0,0 +1,80 @@
+/*
+Title: GJK-3D (OBB)
+File Name: DepthPyramidShader.glsl
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#version 430 core // Compute shaders and images need OpenGL 4.3.
+
+// Each invocation makes one texel of a level of the depth pyramid (see DepthPyramid.h), from the block of up to 2 by 2 texels under it in
+// the level below (or the depth buffer, for level 0).
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// The level being made, and the level below it.
+layout(r32f, binding = 0) uniform writeonly image2D destination;
+layout(r32f, binding = 1) uniform readonly image2D source;
+
+// The copy of the depth buffer, for level 0. (Depth textures can't be images.)
+uniform sampler2D depth;
+
+uniform ivec2 sourceSize;	// How big the level below (or the depth buffer) is.
+uniform bool fromDepth;		// Whether the level below is the depth buffer.
+
+void main(void)
+{
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 size = (sourceSize + 1) / 2;
+
+	// The last work groups can go past the edges.
+	if (texel.x >= size.x || texel.y >= size.y)
+	{
+		return;
+	}
+
+	// The farthest of the texels under this one. The sizes round up, so on an odd edge there's only one texel under it, not two.
+	ivec2 first = texel * 2;
+	ivec2 last = min(first + 1, sourceSize - 1);
+	float farthest = 0.0;
+
+	for (int y = first.y; y <= last.y; y++)
+	{
+		for (int x = first.x; x <= last.x; x++)
+		{
+			float value = fromDepth ? texelFetch(depth, ivec2(x, y), 0).r : imageLoad(source, ivec2(x, y)).r;
+
+			farthest = max(farthest, value);
+		}
+	}
+
+	imageStore(destination, texel, vec4(farthest));
+}
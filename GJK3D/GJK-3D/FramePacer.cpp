@@ -0,0 +1,199 @@
+/*
+Title: GJK-3D (OBB)
+File Name: FramePacer.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _FRAME_PACER_CPP
+#define _FRAME_PACER_CPP
+
+#include "FramePacer.h"
+#include "Profiler.h"
+#include <string>
+#include <thread>
+#include <chrono>
+
+FramePacer::FramePacer()
+{
+	pacing = PACING_UNCAPPED;
+	capRate = 60.0;
+	nextFrame = 0.0;
+	inputTime = glfwGetTime();
+	nextQuery = 0;
+	gpuToCpu = 0.0;
+	latency = 0.0;
+
+	// Adaptive vsync is an extension of the window system's side of OpenGL, so it's WGL on Windows and GLX on Linux.
+	adaptiveSupported = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+
+	glGenQueries(NUM_QUERIES, queries);
+
+	for (int i = 0; i < NUM_QUERIES; i++)
+	{
+		queryInputTimes[i] = 0.0;
+		pending[i] = false;
+	}
+}
+
+FramePacer::~FramePacer()
+{
+	glDeleteQueries(NUM_QUERIES, queries);
+}
+
+void FramePacer::SetPacing(FramePacing newPacing, double rate)
+{
+	pacing = newPacing;
+	capRate = rate > 1.0 ? rate : 1.0;
+	nextFrame = glfwGetTime();
+
+	// The swap interval is how many refreshes to wait for before a swap goes out. 0 doesn't wait at all, and -1 waits for one unless the
+	// frame is already late.
+	if (pacing == PACING_VSYNC || (pacing == PACING_ADAPTIVE && !adaptiveSupported))
+	{
+		glfwSwapInterval(1);
+	}
+	else if (pacing == PACING_ADAPTIVE)
+	{
+		glfwSwapInterval(-1);
+	}
+	else
+	{
+		glfwSwapInterval(0);
+	}
+}
+
+std::string FramePacer::GetName() const
+{
+	switch (pacing)
+	{
+	case PACING_VSYNC:
+		return "VSYNC";
+	case PACING_ADAPTIVE:
+		return adaptiveSupported ? "ADAPTIVE VSYNC" : "VSYNC (NO ADAPTIVE)";
+	case PACING_CAPPED:
+		return "CAPPED " + std::to_string((int)(capRate + 0.5));
+	default:
+		return "UNCAPPED";
+	}
+}
+
+void FramePacer::Wait()
+{
+	if (pacing != PACING_CAPPED)
+	{
+		return;
+	}
+
+	GJK_PROFILE_ZONE("frame pacing");
+
+	double interval = 1.0 / capRate;
+	double now = glfwGetTime();
+
+	if (now - nextFrame > interval)
+	{
+		nextFrame = now;
+	}
+
+	// Sleeping can overshoot by a millisecond or more, depending on the OS's timer, so sleep until just before the frame is due and spin
+	// the rest of the way.
+	const double SPIN_TIME = 0.002;
+
+	if (nextFrame - now > SPIN_TIME)
+	{
+		std::this_thread::sleep_for(std::chrono::duration<double>(nextFrame - now - SPIN_TIME));
+	}
+
+	while (glfwGetTime() < nextFrame)
+	{
+		std::this_thread::yield();
+	}
+
+	nextFrame += interval;
+}
+
+void FramePacer::InputPolled()
+{
+	inputTime = glfwGetTime();
+}
+
+void FramePacer::Presented()
+{
+	readQueries();
+
+	// If the GPU is so far behind that the next query is still waiting, skip measuring this frame rather than wait for it.
+	if (pending[nextQuery])
+	{
+		return;
+	}
+
+	// The timestamp is taken once the GPU has got through everything before it, which includes this frame and its swap.
+	glQueryCounter(queries[nextQuery], GL_TIMESTAMP);
+	queryInputTimes[nextQuery] = inputTime;
+	pending[nextQuery] = true;
+	nextQuery = (nextQuery + 1) % NUM_QUERIES;
+
+	// Asking for the GPU's time right now doesn't wait for anything, so it lines the two clocks up.
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	gpuToCpu = glfwGetTime() - gpuNow * 1e-9;
+}
+
+void FramePacer::readQueries()
+{
+	for (int i = 0; i < NUM_QUERIES; i++)
+	{
+		if (!pending[i])
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available)
+		{
+			continue;
+		}
+
+		GLuint64 gpuTime = 0;
+		glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &gpuTime);
+		pending[i] = false;
+
+		latency = gpuTime * 1e-9 + gpuToCpu - queryInputTimes[i];
+
+		GJK_PROFILE_COUNT("input latency us", (long long)(latency * 1e6));
+		GJK_PROFILE_COUNT("input latency samples", 1);
+	}
+}
+
+#endif // _FRAME_PACER_CPP
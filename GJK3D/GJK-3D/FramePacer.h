@@ -0,0 +1,131 @@
+/*
+Title: GJK-3D (OBB)
+File Name: FramePacer.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _FRAME_PACER_H
+#define _FRAME_PACER_H
+
+#include "GLIncludes.h"
+#include <string>
+
+// How the frames are paced against the display.
+enum FramePacing
+{
+	PACING_UNCAPPED,	// As fast as we can, tearing and all. This is what shows how fast a frame really is.
+	PACING_VSYNC,		// One frame per refresh, waiting in glfwSwapBuffers.
+	PACING_ADAPTIVE,	// Like vsync, but a frame that misses its refresh goes out right away (and tears) rather than waiting a whole refresh.
+	PACING_CAPPED,		// At most a given rate, sleeping between frames. This saves power without tying the rate to the display.
+	NUM_FRAME_PACINGS
+};
+
+// Sets up how fast frames go out, and waits between them if there's a cap. It also measures the latency from input to present: how long
+// from when the frame's input was polled until the GPU finished the frame and its swap. That's read back with a timestamp query a few frames
+// later, so measuring never waits on the GPU. (With vsync, the frame can still sit in the display's queue for up to another refresh after
+// that, which nothing in OpenGL can see.)
+// Call InputPolled right after polling events, Wait right before it, and Presented right after swapping, all on the thread with the context.
+class FramePacer
+{
+	// How many frames of timestamp queries can be in flight at once. The GPU is never more than a few frames behind.
+	static const int NUM_QUERIES = 4;
+
+	FramePacing pacing;
+	double capRate;
+
+	// When the next frame is due, while capped.
+	double nextFrame;
+
+	// Whether the driver can do adaptive vsync (a negative swap interval). Without it, adaptive is the same as vsync.
+	bool adaptiveSupported;
+
+	// When the input for the frame being drawn was polled.
+	double inputTime;
+
+	// The timestamp queries going around in a ring, and the input time of the frame each one is measuring. A query is pending until its
+	// result has been read.
+	GLuint queries[NUM_QUERIES];
+	double queryInputTimes[NUM_QUERIES];
+	bool pending[NUM_QUERIES];
+	int nextQuery;
+
+	// The difference between the GPU's timestamps (in seconds) and glfwGetTime, worked out again every frame, since the two clocks drift.
+	double gpuToCpu;
+
+	// The most recent latency measured, in seconds (0 until there is one).
+	double latency;
+
+	// Reads back every query that's finished.
+	void readQueries();
+
+	// Can't be copied, since it owns the queries.
+	FramePacer(const FramePacer&);
+	FramePacer& operator=(const FramePacer&);
+
+public:
+	FramePacer();
+	~FramePacer();
+
+	// Switches to a pacing (setting the swap interval of the current context). rate is the cap, in frames per second, for PACING_CAPPED.
+	void SetPacing(FramePacing newPacing, double rate = 60.0);
+
+	FramePacing GetPacing() const
+	{
+		return pacing;
+	}
+	double GetCapRate() const
+	{
+		return capRate;
+	}
+
+	// A short name for the pacing, like "VSYNC" or "CAPPED 60".
+	std::string GetName() const;
+
+	// While capped, sleeps until the next frame is due (and a little before that, spins). If we've fallen more than a frame behind, the
+	// schedule starts over from now, rather than rushing through frames to catch up. Does nothing otherwise.
+	void Wait();
+
+	// Notes that the input for the next frame was just polled.
+	void InputPolled();
+
+	// Notes that the frame was just swapped: starts measuring when the GPU gets through it, and picks up any earlier measurements that are
+	// ready. Each one goes to the profiler as the "input latency us" counter (in microseconds), with "input latency samples" counting them.
+	void Presented();
+
+	double GetLatency() const
+	{
+		return latency;
+	}
+};
+
+#endif //_FRAME_PACER_H
@@ -0,0 +1,291 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GJKFunctions.glsl
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#version 430 core // Compute shaders and shader storage buffers need OpenGL 4.3.
+
+// This is the same boolean GJK test as GJKSolver::TestGJK and ContainsOrigin (see GJK.h and GJK.cpp), written out again for the GPU.
+// It's a shader of its own, with no main, so that every compute shader that needs it can be linked with it rather than having its own copy:
+// GJKShader.glsl tests the broadphase's pairs with it, and DebrisShader.glsl tests the debris against each other.
+// Those declare Box exactly the same way, and testGJK before they call it.
+// There's no cache here (every query starts from the same direction), no stats and no simplex kept for EPA: all it answers is yes or no.
+
+// One box: its center, and each of its axes with the half extent along that axis in w.
+// (This is laid out the same as GPUBox in GPUNarrowphase.h, and every shader linked with this one has to declare it the same way.)
+struct Box
+{
+	vec4 center;
+	vec4 axes[3];
+};
+
+// The same limits as the CPU solver (see GJKSolver).
+uniform int maxIterations;
+uniform float epsilon;
+
+// The simplex: simplex[0] is the oldest point, and simplex[size - 1] is the newest (a).
+vec3 simplex[4];
+int size;
+
+// The same as getFarthestPointInDirection for an OBBShape.
+vec3 farthestPoint(Box box, vec3 dir)
+{
+	vec3 farthest = box.center.xyz;
+
+	for (int i = 0; i < 3; i++)
+	{
+		float extent = dot(dir, box.axes[i].xyz) >= 0.0 ? box.axes[i].w : -box.axes[i].w;
+
+		farthest += box.axes[i].xyz * extent;
+	}
+
+	return farthest;
+}
+
+vec3 support(Box a, Box b, vec3 dir)
+{
+	return farthestPoint(a, dir) - farthestPoint(b, -dir);
+}
+
+// See GJKSolver::checkTetrahedron. simplex[0] = d, simplex[1] = c, simplex[2] = b, simplex[3] = a.
+bool checkTetrahedron(vec3 ao, vec3 ab, vec3 ac, vec3 abc, inout vec3 dir)
+{
+	vec3 ab_abc = cross(ab, abc);
+
+	if (dot(ab_abc, ao) > 0.0)
+	{
+		// Keep b and a.
+		simplex[0] = simplex[2];
+		simplex[1] = simplex[3];
+		size = 2;
+
+		dir = cross(cross(ab, ao), ab);
+
+		return false;
+	}
+
+	vec3 acp = cross(abc, ac);
+
+	if (dot(acp, ao) > 0.0)
+	{
+		// Keep c and a.
+		simplex[0] = simplex[1];
+		simplex[1] = simplex[3];
+		size = 2;
+
+		dir = cross(cross(ac, ao), ac);
+
+		return false;
+	}
+
+	// Keep c, b and a.
+	simplex[0] = simplex[1];
+	simplex[1] = simplex[2];
+	simplex[2] = simplex[3];
+	size = 3;
+
+	dir = abc;
+
+	return false;
+}
+
+// See GJKSolver::ContainsOrigin.
+bool containsOrigin(inout vec3 dir)
+{
+	vec3 a = simplex[size - 1];
+
+	if (size == 3)
+	{
+		// simplex[0] = c, simplex[1] = b, simplex[2] = a
+		vec3 ab = simplex[1] - a;
+		vec3 ac = simplex[0] - a;
+
+		vec3 abc = cross(ab, ac);
+		vec3 ab_abc = cross(ab, abc);
+
+		if (dot(ab_abc, -a) > 0.0)
+		{
+			// Keep b and a.
+			simplex[0] = simplex[1];
+			simplex[1] = simplex[2];
+			size = 2;
+
+			dir = cross(cross(ab, -a), ab);
+
+			return false;
+		}
+
+		vec3 abc_ac = cross(abc, ac);
+
+		if (dot(abc_ac, -a) > 0.0)
+		{
+			// Keep c and a.
+			simplex[1] = simplex[2];
+			size = 2;
+
+			dir = cross(cross(ac, -a), ac);
+
+			return false;
+		}
+
+		if (dot(abc, -a) > 0.0)
+		{
+			dir = abc;
+		}
+		else
+		{
+			// Upside down tetrahedron.
+			vec3 c = simplex[0];
+			simplex[0] = simplex[1];
+			simplex[1] = c;
+
+			dir = -abc;
+		}
+
+		return false;
+	}
+	else if (size == 2)
+	{
+		// simplex[0] = b, simplex[1] = a
+		vec3 ab = simplex[0] - a;
+
+		dir = cross(cross(ab, -a), ab);
+
+		return false;
+	}
+	else if (size == 4)
+	{
+		// simplex[0] = d, simplex[1] = c, simplex[2] = b, simplex[3] = a
+		vec3 ab = simplex[2] - a;
+		vec3 ac = simplex[1] - a;
+		vec3 ad = simplex[0] - a;
+
+		vec3 abc = cross(ab, ac);
+
+		if (dot(abc, -a) > 0.0)
+		{
+			return checkTetrahedron(-a, ab, ac, abc, dir);
+		}
+
+		vec3 acd = cross(ac, ad);
+
+		if (dot(acd, -a) > 0.0)
+		{
+			// b is eliminated.
+			simplex[2] = simplex[1];
+			simplex[1] = simplex[0];
+
+			return checkTetrahedron(-a, ac, ad, acd, dir);
+		}
+
+		vec3 adb = cross(ad, ab);
+
+		if (dot(adb, -a) > 0.0)
+		{
+			// c is eliminated.
+			simplex[1] = simplex[2];
+			simplex[2] = simplex[0];
+
+			return checkTetrahedron(-a, ad, ab, adb, dir);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+// See GJKSolver::TestGJK.
+bool testGJK(Box a, Box b)
+{
+	vec3 dir = vec3(1.0);
+
+	simplex[0] = support(a, b, dir);
+	size = 1;
+
+	if (dot(simplex[0], dir) < 0.0)
+	{
+		return false;
+	}
+
+	dir = -simplex[0];
+
+	simplex[1] = support(a, b, dir);
+	size = 2;
+
+	if (dot(simplex[1], dir) < 0.0)
+	{
+		return false;
+	}
+
+	dir = cross(cross(simplex[0] - simplex[1], -simplex[1]), simplex[0] - simplex[1]);
+
+	float epsilonSquared = epsilon * epsilon;
+
+	for (int iteration = 0; iteration < maxIterations; iteration++)
+	{
+		// Just touching.
+		if (all(equal(dir, vec3(0.0))))
+		{
+			return true;
+		}
+
+		vec3 point = support(a, b, dir);
+
+		if (dot(point, dir) <= 0.0)
+		{
+			return false;
+		}
+
+		// No progress.
+		for (int i = 0; i < size; i++)
+		{
+			vec3 difference = point - simplex[i];
+
+			if (dot(difference, difference) <= epsilonSquared)
+			{
+				return false;
+			}
+		}
+
+		simplex[size] = point;
+		size++;
+
+		if (containsOrigin(dir))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,88 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GJKShader.glsl
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#version 430 core // Compute shaders and shader storage buffers need OpenGL 4.3.
+
+// Each invocation tests one pair from the broadphase with the boolean GJK test, and sets that pair's bit in the output if the two boxes overlap.
+// The test itself is in GJKFunctions.glsl, which this is linked with.
+layout(local_size_x = 64) in;
+
+// One box: its center, and each of its axes with the half extent along that axis in w.
+// (This is laid out the same as GPUBox in GPUNarrowphase.h.)
+struct Box
+{
+	vec4 center;
+	vec4 axes[3];
+};
+
+layout(std430, binding = 0) readonly buffer Boxes
+{
+	Box boxes[];
+};
+
+// The pairs to test, as the two boxes' numbers.
+layout(std430, binding = 1) readonly buffer Pairs
+{
+	uvec2 pairs[];
+};
+
+// One bit per pair, 32 pairs to a uint. They all start out cleared, and only the pairs that overlap set theirs.
+layout(std430, binding = 2) buffer Hits
+{
+	uint hits[];
+};
+
+uniform uint numPairs;
+
+// See GJKFunctions.glsl.
+bool testGJK(Box a, Box b);
+
+void main(void)
+{
+	uint index = gl_GlobalInvocationID.x;
+
+	// The last work group can go past the end.
+	if (index >= numPairs)
+	{
+		return;
+	}
+
+	uvec2 pair = pairs[index];
+
+	if (testGJK(boxes[pair.x], boxes[pair.y]))
+	{
+		atomicOr(hits[index >> 5u], 1u << (index & 31u));
+	}
+}
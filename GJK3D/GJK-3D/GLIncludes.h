@@ -49,12 +49,14 @@ struct VertexFormat
 {
 	glm::vec4 color;	// A vector4 for color has 4 floats: red, green, blue, and alpha
 	glm::vec3 position;	// A vector3 for position has 3 float: x, y, and z coordinates
+	glm::vec3 normal;	// A vector3 for the normal, which only gets to the GPU if the model's VertexLayout stores normals
 
 	// Default constructor
 	VertexFormat()
 	{
 		color = glm::vec4(0.0f);
 		position = glm::vec3(0.0f);
+		normal = glm::vec3(0.0f);
 	}
 
 	// Constructor
@@ -62,6 +64,14 @@ struct VertexFormat
 	{
 		position = pos;
 		color = iColor;
+		normal = glm::vec3(0.0f);
+	}
+
+	VertexFormat(const glm::vec3 &pos, const glm::vec4 &iColor, const glm::vec3 &iNormal)
+	{
+		position = pos;
+		color = iColor;
+		normal = iNormal;
 	}
 };
 
@@ -0,0 +1,291 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GPUDebris.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _GPU_DEBRIS_CPP
+#define _GPU_DEBRIS_CPP
+
+#include "GPUDebris.h"
+#include "GJK.h"
+#include "MemoryTracker.h"
+
+GPUDebris::GPUDebris(int maxBodies, float inModelHalfExtent)
+{
+	program = 0;
+	stageLocation = -1;
+	numBodiesLocation = -1;
+	dtLocation = -1;
+	gravityLocation = -1;
+	floorHeightLocation = -1;
+	restitutionLocation = -1;
+	cellSizeLocation = -1;
+	numCellsLocation = -1;
+	cellCapacityLocation = -1;
+	modelHalfExtentLocation = -1;
+	maxIterationsLocation = -1;
+	epsilonLocation = -1;
+
+	// Take the limits from a default solver, the same as the GPU narrowphase.
+	GJKSolver solver;
+	maxIterations = solver.GetMaxIterations();
+	epsilon = solver.GetEpsilon();
+
+	capacity = maxBodies > 0 ? maxBodies : 1;
+	numBodies = 0;
+	nextBody = 0;
+
+	bodies = 0;
+	integrated = 0;
+	transforms = 0;
+
+	// About as many cells as pieces (it's hashed, so the cells don't have to cover anywhere in particular), and room for 8 pieces in each.
+	// The cells start out no size at all, and Spawn makes them big enough for the biggest piece.
+	cellCounts = 0;
+	cellEntries = 0;
+	numCells = capacity;
+	cellCapacity = 8;
+	cellSize = 0.0f;
+
+	floorHeight = -0.8f;
+	restitution = 0.3f;
+	gravity = glm::vec3(0.0f, -9.8f, 0.0f);
+
+	modelHalfExtent = inModelHalfExtent;
+
+	randomState = 2463534242u;
+}
+
+GPUDebris::~GPUDebris()
+{
+	if (bodies != 0)
+	{
+		TrackFree(MEMORY_GPU, (sizeof(GPUDebrisBody) * 2 + sizeof(InstanceTransform)) * capacity + sizeof(GLuint) * numCells * (cellCapacity + 1));
+	}
+
+	glDeleteBuffers(1, &bodies);
+	glDeleteBuffers(1, &integrated);
+	glDeleteBuffers(1, &transforms);
+	glDeleteBuffers(1, &cellCounts);
+	glDeleteBuffers(1, &cellEntries);
+}
+
+void GPUDebris::create()
+{
+	glGenBuffers(1, &bodies);
+	glGenBuffers(1, &integrated);
+	glGenBuffers(1, &transforms);
+	glGenBuffers(1, &cellCounts);
+	glGenBuffers(1, &cellEntries);
+
+	// Spawn writes into the bodies, and the shader does everything else, so none of them are ever read back.
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, bodies);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPUDebrisBody) * capacity, nullptr, GL_DYNAMIC_DRAW);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, integrated);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPUDebrisBody) * capacity, nullptr, GL_DYNAMIC_COPY);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, transforms);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(InstanceTransform) * capacity, nullptr, GL_DYNAMIC_COPY);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellCounts);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * numCells, nullptr, GL_DYNAMIC_COPY);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellEntries);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * numCells * cellCapacity, nullptr, GL_DYNAMIC_COPY);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	TrackAllocation(MEMORY_GPU, (sizeof(GPUDebrisBody) * 2 + sizeof(InstanceTransform)) * capacity + sizeof(GLuint) * numCells * (cellCapacity + 1));
+}
+
+bool GPUDebris::SetProgram(const ShaderProgram& inProgram)
+{
+	if (!GLEW_VERSION_4_3 || inProgram.GetProgram() == 0)
+	{
+		program = 0;
+		return false;
+	}
+
+	program = inProgram.GetProgram();
+	stageLocation = inProgram.GetUniform("stage");
+	numBodiesLocation = inProgram.GetUniform("numBodies");
+	dtLocation = inProgram.GetUniform("dt");
+	gravityLocation = inProgram.GetUniform("gravity");
+	floorHeightLocation = inProgram.GetUniform("floorHeight");
+	restitutionLocation = inProgram.GetUniform("restitution");
+	cellSizeLocation = inProgram.GetUniform("cellSize");
+	numCellsLocation = inProgram.GetUniform("numCells");
+	cellCapacityLocation = inProgram.GetUniform("cellCapacity");
+	modelHalfExtentLocation = inProgram.GetUniform("modelHalfExtent");
+	maxIterationsLocation = inProgram.GetUniform("maxIterations");
+	epsilonLocation = inProgram.GetUniform("epsilon");
+
+	return true;
+}
+
+float GPUDebris::random()
+{
+	// xorshift, which is plenty for scattering debris (and gives the same pieces on every compiler).
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+
+	return (randomState & 0xFFFFFF) / (float)0x1000000;
+}
+
+void GPUDebris::Spawn(const glm::vec3& center, int count, float halfExtent, float speed, float spin)
+{
+	if (program == 0 || count <= 0)
+	{
+		return;
+	}
+
+	if (bodies == 0)
+	{
+		create();
+	}
+
+	// A piece's neighbours are only looked for in the cells next to its own, so a cell has to be at least as wide as the two biggest pieces
+	// could be apart while still touching (twice the distance from a piece's center to its corners).
+	cellSize = glm::max(cellSize, halfExtent * 2.0f * 1.7320508f);
+
+	// There's no point writing more pieces than there's room for, since they'd only write over each other.
+	if (count > capacity)
+	{
+		count = capacity;
+	}
+
+	std::vector<GPUDebrisBody> spawned(count);
+
+	// Spread them out over about as much room as they'd take up packed together, so they don't start out deep inside each other.
+	float spread = halfExtent * 2.0f * powf((float)count, 1.0f / 3.0f);
+
+	for (int i = 0; i < count; i++)
+	{
+		// A random direction and speed (out to the edge of a cube, rather than a sphere, which nobody will notice in a cloud of debris).
+		glm::vec3 direction = glm::vec3(random(), random(), random()) * 2.0f - 1.0f;
+		glm::vec3 axis = glm::vec3(random(), random(), random()) * 2.0f - 1.0f;
+
+		spawned[i].position = glm::vec4(center + direction * spread, halfExtent);
+		spawned[i].orientation = glm::quat(glm::vec3(random(), random(), random()) * 6.2831853f);
+		spawned[i].velocity = glm::vec4(direction * speed, 0.0f);
+		spawned[i].angularVelocity = glm::vec4(axis * spin, 0.0f);
+	}
+
+	// Write them in after the last ones, going around to the start (over the oldest) once the end is reached.
+	int first = count < capacity - nextBody ? count : capacity - nextBody;
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, bodies);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(GPUDebrisBody) * nextBody, sizeof(GPUDebrisBody) * first, spawned.data());
+
+	if (first < count)
+	{
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GPUDebrisBody) * (count - first), spawned.data() + first);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	nextBody = (nextBody + count) % capacity;
+	numBodies = numBodies + count < capacity ? numBodies + count : capacity;
+}
+
+void GPUDebris::Step(float dt)
+{
+	if (program == 0 || numBodies == 0)
+	{
+		return;
+	}
+
+	// (Whatever program was in use gets put back afterwards.)
+	GLint lastProgram;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &lastProgram);
+
+	glUseProgram(program);
+	glUniform1ui(numBodiesLocation, (GLuint)numBodies);
+	glUniform1f(dtLocation, dt);
+	glUniform3fv(gravityLocation, 1, glm::value_ptr(gravity));
+	glUniform1f(floorHeightLocation, floorHeight);
+	glUniform1f(restitutionLocation, restitution);
+	glUniform1f(cellSizeLocation, cellSize);
+	glUniform1ui(numCellsLocation, (GLuint)numCells);
+	glUniform1ui(cellCapacityLocation, (GLuint)cellCapacity);
+	glUniform1f(modelHalfExtentLocation, modelHalfExtent);
+	glUniform1i(maxIterationsLocation, maxIterations);
+	glUniform1f(epsilonLocation, epsilon);
+
+	// Empty the grid.
+	GLuint zero = 0;
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellCounts);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, cellCounts);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, cellEntries);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, transforms);
+
+	GLuint groups = (GLuint)(numBodies + 63) / 64;
+
+	// Integrate every piece from the last step into integrated, and fill in the grid.
+	glUniform1i(stageLocation, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, bodies);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, integrated);
+	glDispatchCompute(groups, 1, 1);
+
+	// The collisions read every piece that was integrated, and the whole grid.
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// Then bounce them off each other, back into bodies, and write out their transforms.
+	glUniform1i(stageLocation, 1);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, integrated);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, bodies);
+	glDispatchCompute(groups, 1, 1);
+
+	// The next step reads the bodies, and the draw reads the transforms as vertex attributes.
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+	glUseProgram(lastProgram);
+}
+
+void GPUDebris::Draw(ModelPool& pool, int modelId)
+{
+	if (program == 0 || numBodies == 0)
+	{
+		return;
+	}
+
+	pool.DrawInstancedFromBuffer(modelId, transforms, numBodies);
+}
+
+#endif // _GPU_DEBRIS_CPP
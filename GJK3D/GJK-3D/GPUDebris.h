@@ -0,0 +1,196 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GPUDebris.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _GPU_DEBRIS_H
+#define _GPU_DEBRIS_H
+
+#include "GLIncludes.h"
+#include "ShaderProgram.h"
+#include "ModelPool.h"
+#include <vector>
+
+// One piece of debris, laid out the same as Body in DebrisShader.glsl. Only Spawn ever writes one from here; after that it only lives on the GPU.
+struct GPUDebrisBody
+{
+	glm::vec4 position;			// The center, with the half extent (the same along every axis) in w.
+	glm::quat orientation;		// (glm keeps a quaternion as x, y, z, w, which is what the shader reads it as.)
+	glm::vec4 velocity;
+	glm::vec4 angularVelocity;
+};
+
+// Cosmetic debris that lives entirely on the GPU: lots of small cubes that bounce off the floor and each other, and that nothing in the
+// PhysicsWorld ever knows about (they can't push the real bodies, or be hit by them). Each Step is two dispatches of DebrisShader.glsl, and
+// Draw hands the transforms the shader wrote straight to the instanced draw, so the CPU never reads a piece back, and tens of thousands of them
+// cost it next to nothing.
+// The first dispatch integrates every piece (gravity, velocity and spin), bounces it off the floor, and drops it into a hashed grid by its
+// center. The second looks through the 27 cells around each piece for others close enough to touch, tests them with the same boolean GJK
+// test GJKShader.glsl uses (see GJKFunctions.glsl), and bounces the piece off each one it overlaps. Each invocation only writes its own piece,
+// so a collision is handled from both sides, by each piece pushing itself away from the other, with no atomics on the bodies. That's only as
+// good as debris needs to be: the pieces are all treated as equal in mass, there's no friction or spin from a collision (only from the floor),
+// and a cell only holds so many pieces (the rest are left out of it for that step).
+// There's a fixed number of pieces, and Spawn reuses the oldest ones once they're all in use, so nothing is ever allocated after the first Spawn.
+// This needs OpenGL 4.3 for compute shaders, and all of it has to be used from the thread with the OpenGL context.
+class GPUDebris
+{
+	// The compute shader program (made from DebrisShader.glsl and GJKFunctions.glsl, 0 if there isn't one), and its uniforms.
+	GLuint program;
+	GLint stageLocation;
+	GLint numBodiesLocation;
+	GLint dtLocation;
+	GLint gravityLocation;
+	GLint floorHeightLocation;
+	GLint restitutionLocation;
+	GLint cellSizeLocation;
+	GLint numCellsLocation;
+	GLint cellCapacityLocation;
+	GLint modelHalfExtentLocation;
+	GLint maxIterationsLocation;
+	GLint epsilonLocation;
+
+	// The same limits as the CPU solver (see GJKSolver).
+	int maxIterations;
+	float epsilon;
+
+	// How many pieces there's room for, how many have been spawned (up to capacity), and where the next one goes.
+	int capacity;
+	int numBodies;
+	int nextBody;
+
+	// The pieces as of the last step, and as the first dispatch leaves them (integrated, but not yet bounced off each other).
+	GLuint bodies;
+	GLuint integrated;
+
+	// The grid: how many pieces are in each cell, and their numbers, cellCapacity to a cell.
+	GLuint cellCounts;
+	GLuint cellEntries;
+	int numCells;
+	int cellCapacity;
+	float cellSize;
+
+	// Every piece's transform (see InstanceTransform in VertexLayout.h), which Draw reads as the instance data.
+	GLuint transforms;
+
+	float floorHeight;
+	float restitution;
+	glm::vec3 gravity;
+
+	// How far the model the pieces are drawn with goes out from its center, so a piece's transform can scale it to the piece's size.
+	float modelHalfExtent;
+
+	// Where Spawn scatters the pieces from.
+	unsigned int randomState;
+
+	// A random number from 0 up to (not including) 1.
+	float random();
+
+	// Makes the buffers. This waits until the first Spawn, since there might not be an OpenGL context before then.
+	void create();
+
+	// Can't be copied, since it owns the buffers.
+	GPUDebris(const GPUDebris&);
+	GPUDebris& operator=(const GPUDebris&);
+
+public:
+	// maxBodies is how many pieces there can be at once, and inModelHalfExtent is how far the model they're drawn with goes out from its center.
+	GPUDebris(int maxBodies, float inModelHalfExtent);
+	~GPUDebris();
+
+	// Hands over a linked compute shader program made from DebrisShader.glsl and GJKFunctions.glsl. Call this again whenever the program is
+	// reloaded. Returns false (and Spawn, Step and Draw do nothing) if compute shaders aren't supported, which needs OpenGL 4.3.
+	bool SetProgram(const ShaderProgram& inProgram);
+
+	bool CanSimulate() const
+	{
+		return program != 0;
+	}
+
+	// Adds count pieces, each halfExtent from its center to its sides, thrown out in every direction from center at up to speed (and spinning
+	// at up to spin radians a second). Once there are as many as there's room for, the oldest ones are reused.
+	void Spawn(const glm::vec3& center, int count, float halfExtent, float speed, float spin);
+
+	// Moves every piece forward by dt seconds.
+	void Step(float dt);
+
+	// Draws every piece with a model from the pool, reading the transforms straight from the GPU. Only call this between the pool's Begin and
+	// End.
+	void Draw(ModelPool& pool, int modelId);
+
+	// Removes every piece.
+	void Clear()
+	{
+		numBodies = 0;
+		nextBody = 0;
+	}
+
+	int NumBodies() const
+	{
+		return numBodies;
+	}
+	int GetCapacity() const
+	{
+		return capacity;
+	}
+
+	// Where the floor is, which the pieces land on. The default is -0.8, the bottom of the box obj2 bounces around in.
+	void SetFloorHeight(float height)
+	{
+		floorHeight = height;
+	}
+	float GetFloorHeight() const
+	{
+		return floorHeight;
+	}
+
+	// How much of its speed into a floor or another piece a piece keeps when it bounces (0 to 1). The default is 0.3.
+	void SetRestitution(float inRestitution)
+	{
+		restitution = inRestitution;
+	}
+	float GetRestitution() const
+	{
+		return restitution;
+	}
+
+	void SetGravity(const glm::vec3& inGravity)
+	{
+		gravity = inGravity;
+	}
+	const glm::vec3& GetGravity() const
+	{
+		return gravity;
+	}
+};
+
+#endif //_GPU_DEBRIS_H
@@ -0,0 +1,130 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GPUDeletionQueue.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _GPU_DELETION_QUEUE_CPP
+#define _GPU_DELETION_QUEUE_CPP
+
+#include "GPUDeletionQueue.h"
+
+GPUDeletionQueue::GPUDeletionQueue()
+{
+	lastFlushed = 0;
+}
+
+void GPUDeletionQueue::DeleteBuffer(GLuint buffer)
+{
+	if (buffer == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	buffers.push_back(buffer);
+}
+
+void GPUDeletionQueue::DeleteVertexArray(GLuint vertexArray)
+{
+	if (vertexArray == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	vertexArrays.push_back(vertexArray);
+}
+
+void GPUDeletionQueue::DeleteSync(GLsync sync)
+{
+	if (sync == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	syncs.push_back(sync);
+}
+
+int GPUDeletionQueue::Flush()
+{
+	// Take everything that's waiting, and leave the (empty) lists from last time in its place, so the other threads can carry on handing
+	// things over while we delete.
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		buffers.swap(flushBuffers);
+		vertexArrays.swap(flushVertexArrays);
+		syncs.swap(flushSyncs);
+	}
+
+	// A mapped buffer is unmapped by deleting it, so a StreamBuffer's persistent mapping doesn't need undoing first.
+	if (!flushBuffers.empty())
+	{
+		glDeleteBuffers((GLsizei)flushBuffers.size(), flushBuffers.data());
+	}
+	if (!flushVertexArrays.empty())
+	{
+		glDeleteVertexArrays((GLsizei)flushVertexArrays.size(), flushVertexArrays.data());
+	}
+
+	// Fences are the one kind that has to go one at a time.
+	for (int i = 0; i < (int)flushSyncs.size(); i++)
+	{
+		glDeleteSync(flushSyncs[i]);
+	}
+
+	lastFlushed = (int)(flushBuffers.size() + flushVertexArrays.size() + flushSyncs.size());
+
+	flushBuffers.clear();
+	flushVertexArrays.clear();
+	flushSyncs.clear();
+
+	return lastFlushed;
+}
+
+int GPUDeletionQueue::GetPending()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return (int)(buffers.size() + vertexArrays.size() + syncs.size());
+}
+
+GPUDeletionQueue& GetGPUDeletionQueue()
+{
+	static GPUDeletionQueue queue;
+
+	return queue;
+}
+
+#endif //_GPU_DELETION_QUEUE_CPP
@@ -0,0 +1,93 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GPUDeletionQueue.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _GPU_DELETION_QUEUE_H
+#define _GPU_DELETION_QUEUE_H
+
+#include "GLIncludes.h"
+#include <mutex>
+#include <vector>
+
+// OpenGL objects can only be deleted on the thread with the context (the render thread), so anything that frees them on another thread
+// (a model let go of by the streaming, say) hands them to one of these instead, and the render thread deletes them all at the end of the
+// frame, a call per kind of object however many there are.
+// Handing one over only takes the lock for as long as a push_back, and deleting them swaps the lists out first, so the two never wait on
+// each other for longer than that. Anything handed over on the render thread itself is deleted the same way, a frame later at most,
+// which is soon enough for something nothing draws with anymore.
+class GPUDeletionQueue
+{
+	std::mutex mutex;
+
+	// What's waiting to be deleted, and the lists Flush swaps them out into, which are kept so their room gets reused every frame.
+	std::vector<GLuint> buffers;
+	std::vector<GLuint> vertexArrays;
+	std::vector<GLsync> syncs;
+
+	std::vector<GLuint> flushBuffers;
+	std::vector<GLuint> flushVertexArrays;
+	std::vector<GLsync> flushSyncs;
+
+	// How many objects the last Flush deleted.
+	int lastFlushed;
+
+	// There's only the one list of what's waiting, so the queue can't be copied.
+	GPUDeletionQueue(const GPUDeletionQueue&);
+	GPUDeletionQueue& operator=(const GPUDeletionQueue&);
+
+public:
+	GPUDeletionQueue();
+
+	// Hands over a buffer, vertex array or fence to be deleted on the render thread. 0 is ignored, like glDelete* do. Can be called from any
+	// thread.
+	void DeleteBuffer(GLuint buffer);
+	void DeleteVertexArray(GLuint vertexArray);
+	void DeleteSync(GLsync sync);
+
+	// Deletes everything handed over so far. Render thread only, once a frame (and once more before the context goes away).
+	// Returns how many objects were deleted.
+	int Flush();
+
+	// How many objects the last Flush deleted, and how many are waiting for the next one.
+	int GetLastFlushed() const
+	{
+		return lastFlushed;
+	}
+	int GetPending();
+};
+
+// The queue every Model (and StreamBuffer) hands its objects to when it's freed, which the demo flushes at the end of every frame.
+GPUDeletionQueue& GetGPUDeletionQueue();
+
+#endif //_GPU_DELETION_QUEUE_H
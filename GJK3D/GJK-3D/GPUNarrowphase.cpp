@@ -0,0 +1,214 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GPUNarrowphase.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _GPU_NARROWPHASE_CPP
+#define _GPU_NARROWPHASE_CPP
+
+#include "GPUNarrowphase.h"
+#include "GJK.h"
+#include "MemoryTracker.h"
+
+GPUNarrowphase::GPUNarrowphase()
+{
+	program = 0;
+	numPairsLocation = -1;
+	maxIterationsLocation = -1;
+	epsilonLocation = -1;
+
+	// Take the limits from a default solver, so the GPU gives up (and calls it a miss) at the same point the CPU would.
+	GJKSolver solver;
+	maxIterations = solver.GetMaxIterations();
+	epsilon = solver.GetEpsilon();
+
+	hitBuffer = 0;
+	hitCapacity = 0;
+
+	pendingPairs = 0;
+}
+
+GPUNarrowphase::~GPUNarrowphase()
+{
+	glDeleteBuffers(1, &hitBuffer);
+
+	TrackFree(MEMORY_GPU, sizeof(GLuint) * hitCapacity);
+}
+
+bool GPUNarrowphase::SetProgram(const ShaderProgram& inProgram)
+{
+	if (!GLEW_VERSION_4_3 || inProgram.GetProgram() == 0)
+	{
+		program = 0;
+		return false;
+	}
+
+	program = inProgram.GetProgram();
+	numPairsLocation = inProgram.GetUniform("numPairs");
+	maxIterationsLocation = inProgram.GetUniform("maxIterations");
+	epsilonLocation = inProgram.GetUniform("epsilon");
+
+	return true;
+}
+
+bool GPUNarrowphase::Test(const OBBShape* shapes, int numShapes, const BroadphasePair* pairs, int numPairs)
+{
+	if (program == 0 || IsBusy())
+	{
+		return false;
+	}
+
+	int numWords = (numPairs + 31) / 32;
+
+	// (There's always at least one box and one pair uploaded, so that neither buffer is ever empty.)
+	boxScratch.resize(numShapes > 0 ? numShapes : 1);
+
+	for (int i = 0; i < numShapes; i++)
+	{
+		boxScratch[i].center = glm::vec4(shapes[i].center, 0.0f);
+
+		for (int j = 0; j < 3; j++)
+		{
+			boxScratch[i].axes[j] = glm::vec4(shapes[i].axes[j], shapes[i].halfExtents[j]);
+		}
+	}
+
+	pairScratch.resize(numPairs > 0 ? numPairs * 2 : 2);
+
+	for (int i = 0; i < numPairs; i++)
+	{
+		pairScratch[i * 2] = (GLuint)pairs[i].a;
+		pairScratch[i * 2 + 1] = (GLuint)pairs[i].b;
+	}
+
+	// Upload the boxes and pairs. (Both writes start on a 256 byte boundary, which is enough for binding them as storage buffers.)
+	GLsizeiptr boxSize = sizeof(GPUBox) * boxScratch.size();
+	GLsizeiptr pairSize = sizeof(GLuint) * pairScratch.size();
+
+	boxBuffer.Reserve(boxSize);
+	GLsizeiptr boxOffset = boxBuffer.Write(boxScratch.data(), boxSize);
+
+	pairBuffer.Reserve(pairSize);
+	GLsizeiptr pairOffset = pairBuffer.Write(pairScratch.data(), pairSize);
+
+	// Make sure there's room for every pair's bit, and clear them all.
+	if (numWords > hitCapacity || hitBuffer == 0)
+	{
+		int oldCapacity = hitCapacity;
+
+		hitCapacity = hitCapacity * 2 > numWords ? hitCapacity * 2 : (numWords > 0 ? numWords : 1);
+		TrackResize(MEMORY_GPU, sizeof(GLuint) * oldCapacity, sizeof(GLuint) * hitCapacity);
+
+		if (hitBuffer == 0)
+		{
+			glGenBuffers(1, &hitBuffer);
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, hitBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * hitCapacity, nullptr, GL_DYNAMIC_READ);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	GLuint zero = 0;
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, hitBuffer);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// Run the GJK shader, one invocation per pair. (Whatever program was in use gets put back afterwards.)
+	if (numPairs > 0)
+	{
+		GLint lastProgram;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &lastProgram);
+
+		glUseProgram(program);
+		glUniform1ui(numPairsLocation, (GLuint)numPairs);
+		glUniform1i(maxIterationsLocation, maxIterations);
+		glUniform1f(epsilonLocation, epsilon);
+
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, boxBuffer.GetBuffer(), boxOffset, boxSize);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, pairBuffer.GetBuffer(), pairOffset, pairSize);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, hitBuffer, 0, sizeof(GLuint) * numWords);
+
+		glDispatchCompute((numPairs + 63) / 64, 1, 1);
+
+		// The copy into the readback buffer has to see everything the shader wrote.
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+		glUseProgram(lastProgram);
+	}
+
+	// The uploads can be written over once the GPU is past this point.
+	boxBuffer.Fence();
+	pairBuffer.Fence();
+
+	// Then the hits are copied out behind the shader, and fenced, for Read to pick up once they've landed. (Nothing is waiting in the
+	// readback buffer, since there's no test in flight, so it's free to grow.)
+	readback.Reserve(sizeof(GLuint) * (numWords > 0 ? numWords : 1));
+	readback.Copy(hitBuffer, 0, sizeof(GLuint) * numWords);
+	pendingPairs = numPairs;
+
+	// Make sure the fence actually gets to the GPU, so that IsReady doesn't wait forever on a fence that's still in our command buffer.
+	glFlush();
+
+	return true;
+}
+
+bool GPUNarrowphase::IsReady()
+{
+	return readback.IsReady();
+}
+
+int GPUNarrowphase::Read(std::vector<unsigned int>& hits)
+{
+	if (!IsBusy())
+	{
+		return 0;
+	}
+
+	const GLuint* words = (const GLuint*)readback.Read();
+
+	if (words == nullptr)
+	{
+		return -1;
+	}
+
+	int numWords = (pendingPairs + 31) / 32;
+
+	hits.assign(words, words + numWords);
+	readback.Release();
+
+	return pendingPairs;
+}
+
+#endif // _GPU_NARROWPHASE_CPP
@@ -0,0 +1,129 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GPUNarrowphase.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _GPU_NARROWPHASE_H
+#define _GPU_NARROWPHASE_H
+
+#include "GLIncludes.h"
+#include "ReadbackBuffer.h"
+#include "StreamBuffer.h"
+#include "ShaderProgram.h"
+#include "Shapes.h"
+#include "Broadphase.h"
+#include <vector>
+
+// One box for the GJK shader, laid out the same as Box in GJKShader.glsl: the center, and each axis with its half extent in w.
+// (An OBBShape's vec3s would each get padded out to 16 bytes by std430 anyway, so this just puts the half extents in the padding.)
+struct GPUBox
+{
+	glm::vec4 center;
+	glm::vec4 axes[3];
+};
+
+// Runs the boolean GJK test (the same one as GJKSolver::TestGJK) on the GPU, one compute shader invocation per pair, for when there are far
+// more pairs than the CPU wants to deal with (lots of small debris, say). It takes every box and the pairs the broadphase found, and writes
+// back one bit per pair: set if the two boxes overlap.
+// It only answers yes or no. There's no separating axis cache, and no contact (the pairs that hit would still need EPA on the CPU if you want
+// to push them apart), so it's best at cutting a huge set of pairs down to the few that are actually touching.
+// Neither Test nor Read waits for the GPU: Test runs the shader and has the hits copied into a ReadbackBuffer behind it, so the CPU can get on
+// with something else and come back for the answers (with IsReady and Read) a frame later, once they've landed. Only one test can be in
+// flight at a time.
+// This needs OpenGL 4.3 for compute shaders, and all of it has to be used from the thread with the OpenGL context.
+class GPUNarrowphase
+{
+	// The compute shader program (made from GJKShader.glsl and GJKFunctions.glsl, 0 if there isn't one), and its uniforms.
+	GLuint program;
+	GLint numPairsLocation;
+	GLint maxIterationsLocation;
+	GLint epsilonLocation;
+
+	// The same limits as the CPU solver (see GJKSolver).
+	int maxIterations;
+	float epsilon;
+
+	// The boxes and pairs, uploaded for every test.
+	StreamBuffer boxBuffer;
+	StreamBuffer pairBuffer;
+	std::vector<GPUBox> boxScratch;
+	std::vector<GLuint> pairScratch;
+
+	// Where the shader writes the hits, and how many 32 bit words it has room for. Only the GPU uses it: the hits are copied from it into
+	// readback, which is where we read them.
+	GLuint hitBuffer;
+	int hitCapacity;
+	ReadbackBuffer readback;
+
+	// How many pairs the test in flight had.
+	int pendingPairs;
+
+public:
+	GPUNarrowphase();
+	~GPUNarrowphase();
+
+	// Hands over a linked compute shader program made from GJKShader.glsl and GJKFunctions.glsl. Call this again whenever the program is reloaded.
+	// Returns false (and Test does nothing) if compute shaders aren't supported, which needs OpenGL 4.3.
+	bool SetProgram(const ShaderProgram& inProgram);
+
+	bool CanTest() const
+	{
+		return program != 0;
+	}
+
+	// Whether there's a test in flight that hasn't been read yet.
+	bool IsBusy() const
+	{
+		return readback.GetPending() > 0;
+	}
+
+	// Starts testing the given pairs of the given boxes on the GPU. Returns false if it can't: there's no program, or the last test hasn't
+	// been read yet.
+	bool Test(const OBBShape* shapes, int numShapes, const BroadphasePair* pairs, int numPairs);
+
+	// Whether the test in flight has finished and its hits have landed, so that Read has them. This never waits.
+	bool IsReady();
+
+	// Reads back the hits of the test in flight, once it has finished: bit i % 32 of hits[i / 32] is set if pair i overlapped. Returns how
+	// many pairs there were, or 0 (and hits is left alone) if there was no test in flight, or -1 if it hasn't finished yet. This never
+	// waits: until IsReady, there's nothing to read.
+	int Read(std::vector<unsigned int>& hits);
+
+	// Whether a pair's bit is set in the hits from Read.
+	static bool IsHit(const std::vector<unsigned int>& hits, int pair)
+	{
+		return (hits[pair >> 5] & (1u << (pair & 31))) != 0;
+	}
+};
+
+#endif //_GPU_NARROWPHASE_H
@@ -0,0 +1,212 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GPUTimer.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _GPU_TIMER_CPP
+#define _GPU_TIMER_CPP
+
+#include "GPUTimer.h"
+#include "Profiler.h"
+
+GPUTimer::GPUTimer()
+{
+	glGenQueries(NUM_FRAMES * NUM_GPU_PASSES, &queries[0][0]);
+
+	for (int i = 0; i < NUM_FRAMES; i++)
+	{
+		pending[i] = false;
+
+		for (int j = 0; j < NUM_GPU_PASSES; j++)
+		{
+			used[i][j] = false;
+		}
+	}
+
+	for (int j = 0; j < NUM_GPU_PASSES; j++)
+	{
+		passSeconds[j] = 0.0;
+	}
+
+	nextFrame = 0;
+	timing = false;
+	currentPass = NUM_GPU_PASSES;
+}
+
+GPUTimer::~GPUTimer()
+{
+	glDeleteQueries(NUM_FRAMES * NUM_GPU_PASSES, &queries[0][0]);
+}
+
+const char* GPUTimer::GetPassName(GPUPass pass)
+{
+	switch (pass)
+	{
+	case GPU_PASS_CLEAR:
+		return "clear";
+	case GPU_PASS_DEBRIS:
+		return "debris";
+	case GPU_PASS_OPAQUE:
+		return "opaque";
+	case GPU_PASS_DEPTH_PYRAMID:
+		return "depth pyramid";
+	case GPU_PASS_DEBUG_DRAW:
+		return "debug draw";
+	default:
+		return "unknown";
+	}
+}
+
+void GPUTimer::BeginFrame()
+{
+	readQueries();
+
+	// If the GPU is so far behind that this part of the ring is still waiting, skip measuring this frame rather than wait for it.
+	timing = !pending[nextFrame];
+
+	for (int j = 0; j < NUM_GPU_PASSES && timing; j++)
+	{
+		used[nextFrame][j] = false;
+	}
+}
+
+void GPUTimer::BeginPass(GPUPass pass)
+{
+	if (!timing || currentPass != NUM_GPU_PASSES)
+	{
+		return;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, queries[nextFrame][pass]);
+	used[nextFrame][pass] = true;
+	currentPass = pass;
+}
+
+void GPUTimer::EndPass()
+{
+	if (currentPass == NUM_GPU_PASSES)
+	{
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	currentPass = NUM_GPU_PASSES;
+}
+
+void GPUTimer::EndFrame()
+{
+	EndPass();
+
+	if (!timing)
+	{
+		return;
+	}
+
+	// A frame with nothing measured (the window was minimized, say) has nothing to wait for.
+	for (int j = 0; j < NUM_GPU_PASSES; j++)
+	{
+		pending[nextFrame] = pending[nextFrame] || used[nextFrame][j];
+	}
+
+	nextFrame = (nextFrame + 1) % NUM_FRAMES;
+	timing = false;
+}
+
+void GPUTimer::readQueries()
+{
+	for (int i = 0; i < NUM_FRAMES; i++)
+	{
+		if (!pending[i])
+		{
+			continue;
+		}
+
+		// The frame is only read once all of its passes are done, so the counters always add up to whole frames.
+		bool available = true;
+
+		for (int j = 0; j < NUM_GPU_PASSES && available; j++)
+		{
+			if (used[i][j])
+			{
+				GLint done = 0;
+				glGetQueryObjectiv(queries[i][j], GL_QUERY_RESULT_AVAILABLE, &done);
+				available = done != 0;
+			}
+		}
+
+		if (!available)
+		{
+			continue;
+		}
+
+		for (int j = 0; j < NUM_GPU_PASSES; j++)
+		{
+			if (!used[i][j])
+			{
+				continue;
+			}
+
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(queries[i][j], GL_QUERY_RESULT, &nanoseconds);
+			passSeconds[j] = nanoseconds * 1e-9;
+
+			// The profiler keeps the counters' names, so they have to be literals.
+			long long microseconds = (long long)(nanoseconds / 1000);
+
+			switch (j)
+			{
+			case GPU_PASS_CLEAR:
+				GJK_PROFILE_COUNT("gpu clear us", microseconds);
+				break;
+			case GPU_PASS_DEBRIS:
+				GJK_PROFILE_COUNT("gpu debris us", microseconds);
+				break;
+			case GPU_PASS_OPAQUE:
+				GJK_PROFILE_COUNT("gpu opaque us", microseconds);
+				break;
+			case GPU_PASS_DEPTH_PYRAMID:
+				GJK_PROFILE_COUNT("gpu depth pyramid us", microseconds);
+				break;
+			case GPU_PASS_DEBUG_DRAW:
+				GJK_PROFILE_COUNT("gpu debug draw us", microseconds);
+				break;
+			}
+		}
+
+		GJK_PROFILE_COUNT("gpu frames timed", 1);
+		pending[i] = false;
+	}
+}
+
+#endif // _GPU_TIMER_CPP
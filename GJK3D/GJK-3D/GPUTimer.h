@@ -0,0 +1,109 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GPUTimer.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _GPU_TIMER_H
+#define _GPU_TIMER_H
+
+#include "GLIncludes.h"
+
+// The parts of a frame the GPU's time is measured for, in the order renderScene draws them.
+enum GPUPass
+{
+	GPU_PASS_CLEAR,			// Clearing the color and depth buffers.
+	GPU_PASS_DEBRIS,		// Stepping the debris (see GPUDebris.h).
+	GPU_PASS_OPAQUE,		// The models (and the culling, if it's on the GPU).
+	GPU_PASS_DEPTH_PYRAMID,	// Building the depth pyramid for the next frame's occlusion culling (see DepthPyramid.h).
+	GPU_PASS_DEBUG_DRAW,	// The collision lines and points.
+	NUM_GPU_PASSES
+};
+
+// Measures how long the GPU spends on each pass of a frame, with a time elapsed query around each one. Like the FramePacer's timestamps,
+// the queries go around in a ring and are read back a few frames later, once they're done, so measuring never waits on the GPU. (If it gets
+// so far behind that the whole ring is still waiting, the frame just isn't measured.)
+// Each pass's time goes to the profiler as a counter ("gpu clear us", "gpu debris us", "gpu opaque us", "gpu depth pyramid us" and "gpu debug
+// draw us", in microseconds), with "gpu frames timed" counting the frames, so it lines up with the CPU's zones in the overlay and in captures.
+// Only one time elapsed query can be running at once, so the passes can't overlap. Everything here has to be on the thread with the context.
+class GPUTimer
+{
+	// How many frames of queries can be in flight at once.
+	static const int NUM_FRAMES = 4;
+
+	// One query per pass per frame in the ring. A frame is pending until its queries have been read, and used says which of its passes were
+	// measured (a pass that wasn't drawn that frame has nothing to read).
+	GLuint queries[NUM_FRAMES][NUM_GPU_PASSES];
+	bool used[NUM_FRAMES][NUM_GPU_PASSES];
+	bool pending[NUM_FRAMES];
+	int nextFrame;
+
+	// Whether this frame is being measured, and the pass being measured right now (or NUM_GPU_PASSES for none).
+	bool timing;
+	int currentPass;
+
+	// The most recent time measured for each pass, in seconds (0 until there is one).
+	double passSeconds[NUM_GPU_PASSES];
+
+	// Reads back every frame that's finished.
+	void readQueries();
+
+	// Can't be copied, since it owns the queries.
+	GPUTimer(const GPUTimer&);
+	GPUTimer& operator=(const GPUTimer&);
+
+public:
+	GPUTimer();
+	~GPUTimer();
+
+	// Picks up the frames that are ready, and starts measuring a new one, if there's room in the ring.
+	void BeginFrame();
+
+	// Starts and stops measuring a pass. Passes can be skipped, but not nested.
+	void BeginPass(GPUPass pass);
+	void EndPass();
+
+	// Done with the frame's passes. The results come back in a later BeginFrame.
+	void EndFrame();
+
+	// The most recent time measured for a pass, in seconds.
+	double GetPassSeconds(GPUPass pass) const
+	{
+		return passSeconds[pass];
+	}
+
+	// A short name for a pass, like "opaque".
+	static const char* GetPassName(GPUPass pass);
+};
+
+#endif //_GPU_TIMER_H
@@ -38,81 +38,125 @@ since they are aligned on the same axis.
 
 #include "GameObject.h"
 
-// Note that the model does not actually get copied, but instead we just save a pointer to it.
-// So make sure that model is stored and cleaned up elsewhere!
-GameObject::GameObject(Model* inModel)
+// Note that the model does not actually get copied, but instead we just save a pointer to it, and hold a reference to it so it stays
+// around. The BodyStore isn't counted, so make sure that's stored and cleaned up elsewhere!
+GameObject::GameObject(Model* inModel, BodyStore* inBodies)
 {
 	model = inModel;
+	bodies = inBodies;
 
-	// Initialize identity matrices.
-	translation = glm::mat4();
-	rotation = glm::mat4();
-	scale = glm::mat4();
-	transformation = glm::mat4();
+	if (model != nullptr)
+	{
+		model->Acquire();
+	}
 
-	// And default vectors.
-	position = glm::vec3();
-	velocity = glm::vec3();
-	acceleration = glm::vec3();
+	// A new body starts at the origin with no velocity or acceleration, no rotation and a scale of 1, and an identity transform.
+	body = bodies->Create();
+}
 
-	// And a default quaternion.
-	quaternion = glm::quat();
+GameObject::GameObject(Model* inModel, BodyStore* inBodies, BodyHandle inBody)
+{
+	model = inModel;
+	bodies = inBodies;
+	body = inBody;
+
+	if (model != nullptr)
+	{
+		model->Acquire();
+	}
+}
+
+GameObject::GameObject(const GameObject& other)
+{
+	model = other.model;
+	bodies = other.bodies;
+	body = other.body;
+
+	if (model != nullptr)
+	{
+		model->Acquire();
+	}
+}
+
+GameObject& GameObject::operator=(const GameObject& other)
+{
+	// Acquiring the new model first means assigning an object to itself (or to one with the same model) can't free the model.
+	if (other.model != nullptr)
+	{
+		other.model->Acquire();
+	}
+	if (model != nullptr)
+	{
+		model->Release();
+	}
+
+	model = other.model;
+	bodies = other.bodies;
+	body = other.body;
+
+	return *this;
+}
+
+GameObject::~GameObject()
+{
+	if (model != nullptr)
+	{
+		model->Release();
+	}
 }
 
 void GameObject::Update(float dt)
 {
-	// Do basic physics calcuations based on dt.
-	velocity += acceleration * dt;
-	position += velocity * dt;
+	// Do basic physics calcuations based on dt, and recalculate the transformation matrix.
+	// (To update every object at once, call BodyStore::Integrate over all of them instead.)
+	int index = bodies->GetIndex(body);
 
-	// Set the translation equal to the new position of the object.
-	SetTranslation(position); // Note that this will also recalculate the transformation matrix.
+	bodies->Integrate(dt, index, index + 1);
 }
 
 // Calculates the transformation matrix based on translation, then rotation, then scale.
+// There's usually no need to call this, since GetTransform rebuilds the matrix whenever it's out of date.
 void GameObject::CalculateMatrices()
 {
-	transformation = translation * rotation * scale;
+	bodies->CalculateTransform(body);
 }
 
-// Adds the incoming vec3 pos to the position, and then translates the object to that position.
+// Adds the incoming vec3 pos to the position.
 void GameObject::AddPosition(glm::vec3 pos)
 {
-	position += pos;
+	bodies->Position(body) += pos;
 
-	Translate(pos);
+	bodies->MarkDirty(body);
 }
 
 // Adds the incoming vec3 vel to the velocity.
 void GameObject::AddVelocity(glm::vec3 vel)
 {
-	velocity += vel;
+	bodies->Velocity(body) += vel;
 }
 
 // Adds the incoming vec3 accel to the acceleration.
 void GameObject::AddAcceleration(glm::vec3 accel)
 {
-	acceleration += accel;
+	bodies->Acceleration(body) += accel;
 }
 
 // Scales the current scale value by the x, y and z values given. (So if the scale is [0.5, 0.5, 0.5] and we pass in [0.5, 0.5, 0.5] we end up with [0.25, 0.25, 0.25].)
 void GameObject::Scale(glm::vec3 scaleFactor)
 {
-	// Scales the scale matrix.
-	scale = glm::scale(scale, scaleFactor);
+	bodies->Scale(body) *= scaleFactor;
 
-	// Then we have to recalculate the transformation matrix.
-	CalculateMatrices();
+	// Then mark the transformation matrix as out of date, so it gets rebuilt the next time something asks for it.
+	bodies->MarkDirty(body);
 }
 
 // Sets the scale in the x, y, and z position to the given values.
 void GameObject::SetScale(glm::vec3 scaleFactor)
 {
-	// Scales the identity matrix.
-	scale = glm::scale(glm::mat4(), scaleFactor);
+	bodies->Scale(body) = scaleFactor;
 
-	// Then we have to recalculate the transformation matrix.
-	CalculateMatrices();
+	// Then mark the transformation matrix as out of date, so it gets rebuilt the next time something asks for it.
+	bodies->MarkDirty(body);
 }
 
 // Rotates in x, y, and z radians based on given values.
@@ -124,22 +168,20 @@ void GameObject::Rotate(glm::vec3 rotFactor)
 	glm::quat q = glm::quat(rotFactor);
 
 	// Rotate our quaternion by that quaternion's value.
-	quaternion *= q;
+	bodies->Orientation(body) *= q;
 
-	// Turn our quaternion into a mat4.
-	rotation = glm::toMat4(quaternion);
-
-	// Then we have to recalculate the transformation matrix.
-	CalculateMatrices();
+	// Then mark the transformation matrix as out of date, so it gets rebuilt the next time something asks for it.
+	bodies->MarkDirty(body);
 }
 
-// Sets the rotation matrix to a given value.
+// Sets the rotation to a given rotation matrix.
 void GameObject::SetRotation(glm::mat4* rotMatrix)
 {
-	rotation = *rotMatrix;
+	// We only store the orientation as a quaternion, so turn the matrix into one.
+	bodies->Orientation(body) = glm::quat_cast(*rotMatrix);
 
-	// Then we have to recalculate the transformation matrix.
-	CalculateMatrices();
+	// Then mark the transformation matrix as out of date, so it gets rebuilt the next time something asks for it.
+	bodies->MarkDirty(body);
 }
 
 // Sets the rotation matrix to a given value of x, y, and z radians.
@@ -148,33 +190,24 @@ void GameObject::SetRotation(glm::vec3 rotFactor)
 	// WARNING: These are interpreted as radian values, so be sure to specify them not as degrees.
 
 	// Set our quaternion equal to a quaternion created from the given euler angles.
-	quaternion = glm::quat(rotFactor);
-
-	// Turn our quaternion into a mat4.
-	rotation = glm::toMat4(quaternion);
+	bodies->Orientation(body) = glm::quat(rotFactor);
 
-	// Then we have to recalculate the transformation matrix.
-	CalculateMatrices();
+	// Then mark the transformation matrix as out of date, so it gets rebuilt the next time something asks for it.
+	bodies->MarkDirty(body);
 }
 
 // Translates in the x, y, and z directions based on the given values.
+// The translation is the position, so this is the same as AddPosition.
 void GameObject::Translate(glm::vec3 transFactor)
 {
-	// Translates the translation matrix.
-	translation = glm::translate(translation, transFactor);
-
-	// Then we have to recalculate the transformation matrix.
-	CalculateMatrices();
+	AddPosition(transFactor);
 }
 
 // Sets the translations to the exact x, y, and z position values given.
+// The translation is the position, so this is the same as SetPosition.
 void GameObject::SetTranslation(glm::vec3 transFactor)
 {
-	// Translates the identity matrix.
-	translation = glm::translate(glm::mat4(), transFactor);
-
-	// Then we have to recalculate the transformation matrix.
-	CalculateMatrices();
+	SetPosition(transFactor);
 }
 
-#endif // _GAME_OBJECT_CPP
\ No newline at end of file
+#endif // _GAME_OBJECT_CPP
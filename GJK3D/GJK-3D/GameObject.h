@@ -37,24 +37,32 @@ since they are aligned on the same axis.
 #define _GAME_OBJECT_H
 
 #include "Model.h"
-
+#include "BodyStore.h"
+
+// A GameObject is a model drawn with one body's transform.
+// The body's state (position, velocity, orientation and so on) lives in a BodyStore, so the GameObject itself is just a handle to it plus the
+// model. It's small enough to keep in a std::vector by value, rather than allocating each one separately.
+// Copying a GameObject copies the handle, not the body, and the body isn't removed when a GameObject goes away (the BodyStore owns it).
+// The model is different: every GameObject holds a reference to its model (see Model::Acquire), so the model lasts as long as the last
+// object drawn with it, wherever that goes away.
 class GameObject
 {
-	glm::vec3 position;
-	glm::vec3 velocity;
-	glm::vec3 acceleration;
-
-	glm::mat4 translation;
-	glm::mat4 rotation;
-	glm::mat4 scale;
-	glm::mat4 transformation;
-
-	glm::quat quaternion;
+	BodyStore* bodies;
+	BodyHandle body;
 
 	Model* model;
 
 public:
-	GameObject(Model*);
+	// Creates a new body for this object in the given store.
+	GameObject(Model*, BodyStore*);
+
+	// Draws a body that's already in the store (like one a PhysicsWorld made).
+	GameObject(Model*, BodyStore*, BodyHandle);
+
+	// These move the model's reference along with the handle.
+	GameObject(const GameObject& other);
+	GameObject& operator=(const GameObject& other);
+	~GameObject();
 
 	void CalculateMatrices();
 
@@ -64,39 +72,67 @@ public:
 	{
 		return model;
 	}
-	glm::mat4* GetTransform()
+	BodyHandle GetBody()
 	{
-		return &transformation;
+		return body;
+	}
+
+	// Whether the body is still there. Once a body is destroyed, every GameObject with its handle says so (see BodyStore::IsValid).
+	bool IsAlive()
+	{
+		return bodies->IsValid(body);
+	}
+
+	// Removes the body from the store, for objects that made their own (a PhysicsWorld's bodies belong to the world). Its slot is reused
+	// by the next body created, so spawning and despawning objects doesn't allocate once the store is big enough (see BodyStore::Reserve).
+	void Destroy()
+	{
+		bodies->Destroy(body);
+	}
+	// The transformation matrix, which is only rebuilt here (at most once) after the position, rotation or scale have changed.
+	// Note that this points into the BodyStore, so it's only good until the next body is created or destroyed, or the store is sorted
+	// (see BodyStore::SortByPosition).
+	const glm::mat4* GetTransform()
+	{
+		return &bodies->GetTransform(body);
 	}
 	glm::vec3 GetPosition()
 	{
-		return position;
+		return bodies->Position(body);
 	}
 	glm::vec3 GetVelocity()
 	{
-		return velocity;
+		return bodies->Velocity(body);
 	}
 	glm::vec3 GetAcceleration()
 	{
-		return acceleration;
+		return bodies->Acceleration(body);
 	}
-
 	void AddPosition(glm::vec3);
 	void SetPosition(glm::vec3 pos)
 	{
-		position = pos;
-
-		SetTranslation(pos);
+		bodies->Position(body) = pos;
+		bodies->MarkDirty(body);
 	}
 	void AddVelocity(glm::vec3);
 	void SetVelocity(glm::vec3 vel)
 	{
-		velocity = vel;
+		bodies->Velocity(body) = vel;
 	}
 	void AddAcceleration(glm::vec3);
 	void SetAcceleration(glm::vec3 accel)
 	{
-		acceleration = accel;
+		bodies->Acceleration(body) = accel;
+	}
+	// The spin, in radians per second about the world space axis it points along. Integrating it turns the body a little each step, the
+	// same way the velocity moves it.
+	glm::vec3 GetAngularVelocity()
+	{
+		return bodies->AngularVelocity(body);
+	}
+	void SetAngularVelocity(glm::vec3 spin)
+	{
+		bodies->AngularVelocity(body) = spin;
 	}
 
 	// Scales the current scale value by the x, y and z values given.
@@ -25,58 +25,181 @@ Description:
 This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
 Contains two cubes, one that is stationary and one that is moving. They are bounded
 by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
-"bounces" on the x axis (because that is the only direction the object is moving).
-The algorithm will detect any axis of collision, but will not output the axis that was
-collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+"bounces" off the other one. GJK on its own will detect any collision, but will not output
+the axis that was collided (because it doesn't know), so when it finds one we run EPA
+(the Expanding Polytope Algorithm) to get the collision normal and penetration depth,
+push the moving object back out, and reflect its velocity about that normal.
 There is a physics timestep such that every update runs at the same delta time, regardless
 of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
 since they are aligned on the same axis.
 */
 
 #include "GLIncludes.h"
+#include "GLFWClock.h"
 #include "GameObject.h"
+#include "ModelPool.h"
+#include "PhysicsWorld.h"
+#include "PhysicsSnapshot.h"
+#include "SceneQuery.h"
+#include "StepScheduler.h"
+#include "Profiler.h"
+#include "PerformanceOverlay.h"
+#include "DebugDraw.h"
+#include "RenderTarget.h"
+#include "DepthPyramid.h"
+#include "FramePacer.h"
+#include "GPUTimer.h"
+#include "GPUNarrowphase.h"
+#include "GPUDebris.h"
+#include "GPUDeletionQueue.h"
+#include "SceneFile.h"
+#include "Primitives.h"
+#include "HullCache.h"
+#include "ShaderProgram.h"
+#include "SimulationRecording.h"
+#include "FlightRecorder.h"
+#include "MemoryTracker.h"
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <string>
 #include <algorithm>
-
-// This is your reference to your shader program.
-// This will be assigned with glCreateProgram().
-// This program will run on your GPU.
-GLuint program;
-
-// These are your references to your actual compiled shaders
-GLuint vertex_shader;
-GLuint fragment_shader;
-
-// This is a reference to your uniform MVP matrix in your vertex shader
-GLuint uniMVP;
-
-// These are 4x4 transformation matrices, which you will locally modify before passing into the vertex shader via uniMVP
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <random>
+
+// This is your reference to your shader program, which will run on your GPU.
+ShaderProgram* program;
+
+// The program with the compute shader that culls the objects on the GPU. (This never loads if there's no OpenGL 4.3.)
+ShaderProgram* cullProgram;
+
+// The program with the compute shader that builds the depth pyramid (no OpenGL 4.3, no pyramid), and the pyramid, built from every frame's
+// depth for the next frame's cull to throw out whatever's hidden (see DepthPyramid.h). Press H to turn occlusion culling off and on.
+ShaderProgram* pyramidProgram;
+DepthPyramid* depthPyramid;
+bool occlusionCulling = true;
+
+// The program with the compute shader that runs GJK on the GPU (which doesn't load without OpenGL 4.3 either), and what runs the tests with it.
+ShaderProgram* gjkProgram;
+GPUNarrowphase* gpuNarrowphase;
+
+// The program with the compute shader that moves the debris (linked with the same GJK test), and the debris itself, which lives entirely on
+// the GPU and is drawn straight from there (see GPUDebris.h). Press D to throw another burst of it out over obj1. It's stepped once a frame,
+// on the render thread, by however long the last frame took (up to debrisMaxStep, so a hitch doesn't throw it through the floor).
+ShaderProgram* debrisProgram;
+GPUDebris* debris;
+const int maxDebris = 65536;
+const int debrisBurst = 4096;
+const float debrisMaxStep = 1.0f / 30.0f;
+double lastDebrisStep;
+
+// When we last checked whether any of the shader files had changed.
+double lastShaderCheck;
+
+// These are 4x4 transformation matrices, which you will locally modify before passing into the vertex shader
 glm::mat4 proj;
 glm::mat4 view;
 
 // proj * view = PV
 glm::mat4 PV;
 
-// MVP is PV * Model (model is the transformation matrix of whatever object is being rendered)
-glm::mat4 MVP;
-glm::mat4 MVP2;
-
-// Variables for FPS and Physics Timestep calculations.
-int frame = 0;
-double time = 0;
-double timebase = 0;
-double accumulator = 0.0;
-int fps = 0;
-double FPSTime = 0.0;
+// PV goes to the vertex shader once a frame, in this uniform buffer (the shader's Camera block), and the shader multiplies each vertex by it
+// after placing it with the transform of whatever object is being rendered. So the CPU never has to put together a whole MVP matrix for each object.
+GLuint cameraBuffer;
+
+// The size of the window's framebuffer, in pixels, which framebufferSizeCallback keeps up to date. The projection has to match its shape,
+// but however many resize events come in, the projection, PV and the camera buffer are only worked out again once, at the start of the next
+// frame (see updateCamera).
+int framebufferWidth;
+int framebufferHeight;
+bool cameraDirty = true;
+
+// How big the scene is drawn, as a fraction of the window's width and height. Below 1, it's drawn into renderTarget and then stretched over
+// the window, which keeps the frame time down on a GPU that can't shade every pixel in time. (The overlay is always drawn at full size, so
+// its text stays sharp.) Press R to cycle through RENDER_SCALES, or start the demo with --render-scale <scale>.
+float renderScale = 1.0f;
+const float RENDER_SCALES[] = { 1.0f, 0.75f, 0.5f };
+const int NUM_RENDER_SCALES = 3;
+RenderTarget* renderTarget;
+
+// How fast frames go out (see FramePacer), and the input to present latency. It starts uncapped, so the overlay shows how fast a frame really
+// is, and pressing V cycles through vsync, adaptive vsync and a cap (of 60 frames per second, or whatever --fps-cap says). Start the demo with
+// --pacing uncapped, vsync, adaptive or capped to pick one from the start.
+FramePacer* framePacer;
+double fpsCap = 60.0;
+
+// How long the GPU spends on each pass of renderScene (see GPUTimer), to set against the CPU's time for the same frame in the overlay.
+GPUTimer* gpuTimer;
+
+// The transform of each visible object (in the same order as visibleObjects), which all go to the vertex shader at once so every object
+// can be drawn in one call.
+std::vector<InstanceTransform> visibleTransforms;
+
+// The id in modelPool of each object's model (in the same order as objects), so the renderer can group the objects by model.
+std::vector<int> drawModels;
+
+// The objects that are at least partly inside the view frustum, and the model and level of detail of each one (in the same order), which is
+// what actually gets drawn.
+std::vector<int> visibleObjects;
+std::vector<int> visibleModels;
+std::vector<int> visibleLevels;
+
+// When the GPU does the culling, it gets every object's transform and bounds instead (in the same order as objects), and works out the rest itself.
+std::vector<InstanceTransform> drawTransforms;
+std::vector<AABB> drawBounds;
+
+// Whether each object's transform or bounds changed since the last frame (see ModelPool::DrawCulled), and the pose each one was last sent
+// with, if it was resting then (asleep or static, and not moving between the poses being blended). An object that's still resting, right
+// where it was sent, isn't packed or sent to the GPU again, which in most scenes is most of them. (The pose is checked as well as the
+// sleeping, since a sleeping or static object can still be moved by hand.)
+std::vector<unsigned char> changedInstances;
+std::vector<unsigned char> sentResting;
+std::vector<glm::vec3> sentPositions;
+std::vector<glm::quat> sentOrientations;
+std::vector<glm::vec3> sentScales;
+
+// With a physics thread, whether each object is resting in the snapshots (see SnapshotBuffer::InterpolatePoses).
+std::vector<unsigned char> restingObjects;
+
+// Every body's position, orientation and scale blended between the last two physics steps (by index in the world's BodyStore without a
+// physics thread, or by object from the snapshots with one), which is what gets drawn. These go straight into the instance transforms,
+// without ever being made into matrices.
+std::vector<glm::vec3> interpolatedPositions;
+std::vector<glm::quat> interpolatedOrientations;
+std::vector<glm::vec3> interpolatedScales;
+
+// Variable for the Physics Timestep calculations.
 double physicsStep = 0.012; // This is the number of milliseconds we intend for the physics to update.
 
-// Variable for the speed of the moving object.
-float speed = 0.90f;
-
-bool antiStuck = false;
+// What the physics is timed with. This is GLFW's timer, since the renderer blends between steps using the same clock. (Without a window,
+// a SteadyClock does the same job, and a ManualClock makes every step happen exactly when it's told to.)
+GLFWClock physicsClock;
+
+// Decides how many physics steps to run each time around, keeping track of the time that hasn't been stepped yet (the accumulator).
+// If the steps start taking too long, it runs fewer of them rather than letting each frame get slower than the last, and goes into degraded
+// mode (see update).
+StepScheduler scheduler(physicsStep, &physicsClock);
+
+// Whether the physics runs on a thread of its own. If it does, the render loop never waits on a physics step: the physics thread publishes
+// a snapshot of the scene after each round of steps, and the renderer draws a blend of the last two. Set this to false to run everything on
+// one thread, one after the other, the way it used to.
+bool threadedPhysics = true;
+std::thread physicsThread;
+std::atomic<bool> physicsRunning(false);
+
+// The snapshots the physics thread hands to the renderer.
+SnapshotBuffer snapshots;
+
+// The threads that get each frame's draw data ready: packing the instance transforms, and picking the levels of detail, a slice of the
+// objects on each thread. Only the GL calls themselves have to stay on this thread, since that's the one the context is current on.
+// With a physics thread, the world's job system belongs to it, so the renderer has a few threads of its own (renderJobsOwned). Without
+// one, the physics and the rendering take turns on this thread, and they can share the world's.
+// Each slice is RENDER_GRAIN objects, which is plenty to be worth handing to another thread.
+JobSystem* renderJobs;
+bool renderJobsOwned = false;
+const int RENDER_GRAIN = 1024;
 
 // Reference to the window object being created by GLFW.
 GLFWwindow* window;
@@ -84,545 +207,893 @@ GLFWwindow* window;
 // An array of vertices stored in an std::vector for our object.
 std::vector<VertexFormat> vertices;
 
+// The physics: every body in the scene with a box around it, and the whole physics step (broadphase, GJK, EPA and so on). None of it has
+// anything to do with drawing, so it lives in the PhysicsCore library, and everything here just draws what it does.
+PhysicsWorld* world;
+
+// Records every physics step to a file, when the demo is started with --record <file>, so the session can be played back later (see
+// SimulationReplayer, and the benchmarks' --replay).
+SimulationRecorder recorder;
+
+// Keeps the last 10 seconds of step stats, and when the demo is started with --flight-recorder <prefix>, writes them out to <prefix><step>.jsonl
+// whenever a step takes longer than two steps' worth of time (see FlightRecorder).
+FlightRecorder flightRecorder;
+
 // References to our two GameObjects and the one Model we'll be using.
+// These point into objects, so they get set once every object has been added.
 GameObject* obj1;
 GameObject* obj2;
 Model* cube;
 
-struct OBB
+// Every model we draw lives in one set of shared buffers, so drawing different models doesn't mean binding different buffers.
+ModelPool* modelPool;
+
+// Every object in the scene, in the same order as the world's objects. obj1 and obj2 are the first two.
+// A GameObject is only a handle to its body in the world's BodyStore (plus its model), so they're stored by value.
+TrackedVector<GameObject, MEMORY_OBJECTS> objects;
+
+// Stress mode, for trying the whole demo out on a new machine: start it with --stress <count>, and it adds that many more cubes around obj1
+// and obj2, each spinning the way they do (see addStressCubes). They're packed in STRESS_SPACING apart, closer than they are across
+// corner to corner, so as they turn they keep knocking into each other, and every part of the frame (the broadphase, the narrowphase and
+// solver, and the culled, instanced drawing) has thousands of objects to get through. The camera is pulled back to take them all in, and
+// the overlay shows how it's going.
+int stressCount = 0;
+const float STRESS_SPACING = 0.5f;
+const float STRESS_MIN_SCALE = 0.5f;
+const float STRESS_MAX_SCALE = 0.9f;
+
+// Pressing B cycles through the broadphases while running so you can compare them (the window title shows which is in use).
+// This is set when B is pressed, and the switch itself happens at the start of the next update, on whichever thread runs the physics.
+std::atomic<bool> broadphaseSwitchRequested(false);
+
+// The broadphase in use, for the window title (which the render thread sets, while the physics thread might be switching broadphases).
+std::atomic<int> currentBroadphase(0);
+
+// Shows the frame rate, frame times, how the physics is doing and the memory use over the corner of the window. Press O to hide or show it.
+PerformanceOverlay* overlay;
+
+// Pressing P starts capturing a trace of every profiled zone, and pressing it again writes the trace out to this file.
+// Open it in chrome://tracing or Perfetto (or import it into Tracy) to see what every thread was doing, frame by frame.
+const char* traceFileName = "trace.json";
+
+// Pressing G turns on (or off) checking the narrowphase on the GPU. Every frame, the GJK shader tests the pairs from the latest physics step,
+// and the overlay shows how many of them it found overlapping, and how many of its answers were different from the CPU's (see
+// checkNarrowphaseOnGPU).
+std::atomic<bool> gpuCheck(false);
+
+// The boxes, pairs and contacts the GPU test in flight was started with, and its hits once they come back.
+PhysicsSnapshot gpuSnapshot;
+std::vector<unsigned int> gpuHits;
+
+// Pressing C turns on (or off) drawing what the collision detection is doing over the scene: every object's OBB and broadphase bounds, the
+// contact points and normals from the last step, and the final GJK simplex of the first few contacts (see drawCollisions).
+std::atomic<bool> collisionView(false);
+DebugDraw* debugDraw;
+
+// Pressing K kicks obj2 straight up at this speed. The key callback runs on the render thread, which can't touch the bodies while the physics
+// thread might be stepping them, so it pushes the change to the world's command queue instead, and it's made before the next step.
+const float kickSpeed = 2.0f;
+
+// A copy of the world after each step, for the other threads to raycast and query while the physics thread runs the next one (see
+// SceneQueryBuffer). Pressing Q casts a ray from the camera straight through the middle of the screen, from the render thread.
+SceneQueryBuffer sceneQueries;
+SceneQueryScratch renderQueryScratch;
+
+// What drawCollisions draws from, and how many contacts it reruns GJK on to show their simplices (each one is a whole query, every frame).
+PhysicsSnapshot debugSnapshot;
+const int MAX_DEBUG_SIMPLICES = 64;
+
+// This gets called by GLFW whenever a key is pressed or released.
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-	glm::vec3 corners[8];
-};
+	if (key == GLFW_KEY_B && action == GLFW_PRESS)
+	{
+		broadphaseSwitchRequested = true;
+	}
 
-OBB obb1;
-OBB obb2;
+	if (key == GLFW_KEY_O && action == GLFW_PRESS)
+	{
+		overlay->SetVisible(!overlay->IsVisible());
+	}
 
-std::vector<glm::vec3> simplex;
+	if (key == GLFW_KEY_P && action == GLFW_PRESS)
+	{
+		Profiler& profiler = Profiler::Get();
 
-// Gets the farthest point of a given OBB in a given direction
-glm::vec3 getFarthestPointInDirection(OBB obj, glm::vec3& dir)
-{
-	// Project the first point onto the direction and make it the farthestPoint.
-	float maxDist = glm::dot(obj.corners[0], dir);
-	glm::vec3 farthestPoint = obj.corners[0];
+		if (!profiler.IsCapturing())
+		{
+			profiler.StartCapture();
+			std::cout << "Capturing a trace. Press P again to save it." << std::endl;
+		}
+		else
+		{
+			profiler.StopCapture();
+
+			if (profiler.WriteChromeTrace(traceFileName))
+			{
+				std::cout << "Saved the trace to " << traceFileName << "." << std::endl;
+			}
+			else
+			{
+				std::cout << "Couldn't write the trace to " << traceFileName << "." << std::endl;
+			}
+		}
+	}
 
-	for (int i = 1; i < 8; i++)
+	if (key == GLFW_KEY_C && action == GLFW_PRESS)
 	{
-		// Project point onto the direction, no need to divide by dir.length() as every point will have this same value, as it is an extra calculation
-		// that is not necessary, since we don't need the exact scalar projection value, just the maximum.
-		if (glm::dot(obj.corners[i], dir) > maxDist)
+		collisionView = !collisionView;
+		debugDraw->SetEnabled(collisionView);
+	}
+
+	if (key == GLFW_KEY_G && action == GLFW_PRESS)
+	{
+		if (!gpuNarrowphase->CanTest())
 		{
-			maxDist = glm::dot(obj.corners[i], dir);
-			farthestPoint = obj.corners[i];
+			std::cout << "Running GJK on the GPU needs OpenGL 4.3." << std::endl;
+		}
+		else
+		{
+			gpuCheck = !gpuCheck;
+			std::cout << (gpuCheck ? "Checking the narrowphase on the GPU." : "Stopped checking the narrowphase on the GPU.") << std::endl;
 		}
 	}
 
-	return farthestPoint;
-}
+	if (key == GLFW_KEY_V && action == GLFW_PRESS)
+	{
+		framePacer->SetPacing((FramePacing)((framePacer->GetPacing() + 1) % NUM_FRAME_PACINGS), fpsCap);
+		std::cout << "Frame pacing: " << framePacer->GetName() << "." << std::endl;
+	}
 
-// Gets the farthest points in opposite directions for two OBBs and a given direction to project along, and then returns the difference between those points.
-glm::vec3 Support(OBB a, OBB b, glm::vec3& dir)
-{
-	glm::vec3 p1 = getFarthestPointInDirection(a, dir); // = a.getFarthestPointInDirection(dir)
-	glm::vec3 p2 = getFarthestPointInDirection(b, -dir); // = b.getFarthestPointInDirection(-dir)
+	if (key == GLFW_KEY_K && action == GLFW_PRESS)
+	{
+		world->Commands().SetVelocity(1, glm::vec3(0.0f, kickSpeed, 0.0f));
+	}
 
-	glm::vec3 p3 = p1 - p2;
+	if (key == GLFW_KEY_D && action == GLFW_PRESS)
+	{
+		if (!debris->CanSimulate())
+		{
+			std::cout << "Debris needs OpenGL 4.3." << std::endl;
+		}
+		else
+		{
+			debris->Spawn(glm::vec3(0.0f, 0.6f, 0.0f), debrisBurst, 0.01f, 1.5f, 20.0f);
+			std::cout << debris->NumBodies() << " pieces of debris." << std::endl;
+		}
+	}
 
-	return p3;
-}
+	if (key == GLFW_KEY_Q && action == GLFW_PRESS)
+	{
+		const SceneQuerySnapshot* scene = sceneQueries.Acquire();
+		PhysicsCastHit hit;
 
-// Checks the tetrahedron for a proper value for dir and re-adjusts the simplex vector. (Returns false no matter what.)
-bool checkTetrahedron(const glm::vec3& ao, const glm::vec3& ab, const glm::vec3& ac, const glm::vec3& abc, glm::vec3& dir)
-{
-	// simplex[0] = d, simplex[1] = c, simplex[2] = b, simplex[3] = a
+		if (scene != nullptr && scene->RayCast(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 0.0f, -2.0f), hit, renderQueryScratch))
+		{
+			std::cout << "The ray from the camera hits object " << hit.object << " at (" << hit.point.x << ", " << hit.point.y << ", "
+				<< hit.point.z << ")." << std::endl;
+		}
+		else
+		{
+			std::cout << "The ray from the camera doesn't hit anything." << std::endl;
+		}
 
-	// Very similar to triangle checks
-	glm::vec3 ab_abc = glm::cross(ab, abc);
+		sceneQueries.Release(scene);
+	}
 
-	if (glm::dot(ab_abc, ao) > 0)
+	if (key == GLFW_KEY_H && action == GLFW_PRESS)
 	{
-		// Update our simplex vertices
-		simplex[1] = simplex[2]; // c = b
-		simplex[2] = simplex[3]; // b = a
+		if (!depthPyramid->CanBuild())
+		{
+			std::cout << "Occlusion culling needs OpenGL 4.3." << std::endl;
+		}
+		else
+		{
+			occlusionCulling = !occlusionCulling;
+			std::cout << (occlusionCulling ? "Occlusion culling is on." : "Occlusion culling is off.") << std::endl;
 
-		// The direction is not a_abc because it does not point toward the origin.
-		dir = glm::cross(glm::cross(ab, ao), ab);
+			// The pyramid is from whenever it was last built, so it has to start again from the next frame's depth.
+			depthPyramid->Invalidate();
+			modelPool->SetOcclusion(occlusionCulling ? depthPyramid : nullptr);
+		}
+	}
 
-		// Erase d and a
-		simplex.erase(simplex.begin());
-		simplex.erase(simplex.end() - 1);
+	if (key == GLFW_KEY_R && action == GLFW_PRESS)
+	{
+		int next = 0;
 
-		return false;
+		for (int i = 0; i < NUM_RENDER_SCALES; i++)
+		{
+			if (RENDER_SCALES[i] < renderScale)
+			{
+				next = i;
+				break;
+			}
+		}
+
+		renderScale = RENDER_SCALES[next];
+		std::cout << "Rendering at " << (int)(renderScale * 100.0f + 0.5f) << "% of the window's size." << std::endl;
 	}
+}
 
-	glm::vec3 acp = glm::cross(abc, ac);
+// This gets called by GLFW whenever the window's framebuffer changes size. It only notes the new size; the projection catches up on the next
+// frame.
+void framebufferSizeCallback(GLFWwindow* window, int width, int height)
+{
+	framebufferWidth = width;
+	framebufferHeight = height;
+	cameraDirty = true;
+}
 
-	if (glm::dot(acp, ao) > 0)
+// Works out the projection again for the shape of the window, if that's changed since the last frame, and sends the new camera to the GPU.
+void updateCamera()
+{
+	// A minimized window has no size, and no shape to match.
+	if (!cameraDirty || framebufferWidth <= 0 || framebufferHeight <= 0)
 	{
-		simplex[2] = simplex[3]; // b = a
+		return;
+	}
+
+	// Creates a projection matrix using glm::perspective.
+	// First parameter is the vertical FoV (Field of View), second paramter is the aspect ratio, 3rd parameter is the near clipping plane, 4th parameter is the far clipping plane.
+	proj = glm::perspective(45.0f, (float)framebufferWidth / (float)framebufferHeight, 0.1f, 100.0f);
 
-		dir = glm::cross(glm::cross(ac, ao), ac);
+	// Allows us to make one less calculation per frame, since the projection and view matrices only change when the window does.
+	PV = proj * view;
 
-		// Erase d and a
-		simplex.erase(simplex.begin());
-		simplex.erase(simplex.end() - 1);
+	glBindBuffer(GL_UNIFORM_BUFFER, cameraBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), &PV[0][0]);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+	cameraDirty = false;
+}
+
+// Makes room for count objects' instances (for the GPU to cull). New objects haven't been sent yet, so they're always packed.
+void resizeInstances(int count)
+{
+	drawTransforms.resize(count);
+	drawBounds.resize(count);
+	changedInstances.resize(count);
+	sentResting.resize(count, 0);
+	sentPositions.resize(count);
+	sentOrientations.resize(count);
+	sentScales.resize(count);
+}
+
+// Packs object's instance transform from the interpolated pose at index pose, unless it's resting and was last sent resting exactly where
+// it is now, and marks whether it changed. Returns whether it did.
+bool packChangedInstance(int object, int pose, bool resting)
+{
+	const glm::vec3& position = interpolatedPositions[pose];
+	const glm::quat& orientation = interpolatedOrientations[pose];
+	const glm::vec3& scale = interpolatedScales[pose];
+
+	if (resting && sentResting[object] && position == sentPositions[object] && orientation == sentOrientations[object] &&
+		scale == sentScales[object])
+	{
+		changedInstances[object] = 0;
 		return false;
 	}
 
-	simplex[0] = simplex[1]; // d = c
-	simplex[1] = simplex[2]; // c = b
-	simplex[2] = simplex[3]; // b = a
-
-	// Only erase a
-	simplex.erase(simplex.end() - 1);
+	drawTransforms[object] = PackInstance(position, orientation, scale);
+	changedInstances[object] = 1;
+	sentResting[object] = resting ? 1 : 0;
 
-	dir = abc;
+	if (resting)
+	{
+		sentPositions[object] = position;
+		sentOrientations[object] = orientation;
+		sentScales[object] = scale;
+	}
 
-	return false;
+	return true;
 }
 
-// Tests if the global simplex contains the origin.
-bool ContainsOrigin(glm::vec3& dir)
+// Finds the objects the camera can see, and gathers up their transforms.
+// The broadphase already keeps (fat) bounds around every object, so the culling is done against those, and with the AABB tree whole branches
+// of objects off the screen get skipped at once. Anything outside the frustum is never sent to the GPU at all.
+// If the GPU can cull, none of that happens here: we only gather up the transform and bounds of each object that changed for it.
+// The transforms are blended between the last two physics steps by how far the accumulator has got towards the next one, so motion stays
+// smooth when there are more frames than steps.
+void updateTransforms()
 {
-	glm::vec3 a = simplex.back(); // a will always equal the last value in the simplex
-	glm::vec3 b, c, d, ab, ac, ad;
+	GJK_PROFILE_ZONE("update transforms");
 
-	// If we have a triangle.
-	if (simplex.size() == 3)
-	{
-		// Setup up our b and c variables.
-		b = simplex[1];
-		c = simplex[0];
+	float alpha = (float)scheduler.GetAlpha();
 
-		// Calculate ab, ac
-		ab = b - a;
-		ac = c - a;
+	BodyStore& bodies = world->Bodies();
 
-		// Create abc and ab_abc to test if the origin is away from the ab edge.
-		glm::vec3 abc = glm::cross(ab, ac);
-		glm::vec3 ab_abc = glm::cross(ab, abc);
+	interpolatedPositions.resize(bodies.Size());
+	interpolatedOrientations.resize(bodies.Size());
+	interpolatedScales.resize(bodies.Size());
+	bodies.InterpolatePoses(alpha, 0, bodies.Size(), interpolatedPositions.data(), interpolatedOrientations.data(), interpolatedScales.data());
 
-		// If this is true, then ab_abc is not pointing toward the origin.
-		if (glm::dot(ab_abc, -a) > 0)
+	// Every object (or visible object) is packed on its own, into its own slot, so the render jobs can each take a slice of them.
+	if (modelPool->CanCull())
+	{
+		resizeInstances((int)objects.size());
+
+		auto pack = [&bodies](int begin, int end, int thread)
 		{
-			// c's value is lost.
-			simplex[0] = simplex[1]; // c = b
-			simplex[1] = simplex[2]; // b = a
+			for (int i = begin; i < end; i++)
+			{
+				int body = bodies.GetIndex(objects[i].GetBody());
 
-			// doubleCross(ab, -a)
-			dir = glm::cross(glm::cross(ab, -a), ab); // The dir can't be ab_abc since it's in the wrong direction.
+				if (packChangedInstance(i, body, bodies.IsResting(body)))
+				{
+					drawBounds[i] = world->GetBounds(i);
+				}
+			}
+		};
 
-			// Remove a.
-			simplex.erase(simplex.end() - 1);
+		renderJobs->ParallelFor((int)objects.size(), RENDER_GRAIN, pack);
 
-			return false;
-		}
+		return;
+	}
 
-		glm::vec3 abc_ac = glm::cross(abc, ac);
+	world->Cull(Frustum(PV), visibleObjects);
 
-		if (glm::dot(abc_ac, -a) > 0)
+	visibleTransforms.resize(visibleObjects.size());
+	visibleModels.resize(visibleObjects.size());
+	visibleLevels.resize(visibleObjects.size());
+
+	auto pack = [&bodies](int begin, int end, int thread)
+	{
+		for (int i = begin; i < end; i++)
 		{
-			simplex[1] = simplex[2]; // b = a
+			int object = visibleObjects[i];
 
-			// doubleCross(ac, -a)
-			dir = glm::cross(glm::cross(ac, -a), ac);
-			simplex.erase(simplex.end() - 1);
+			int body = bodies.GetIndex(objects[object].GetBody());
 
-			return false;
+			visibleTransforms[i] = PackInstance(interpolatedPositions[body], interpolatedOrientations[body], interpolatedScales[body]);
+			visibleModels[i] = drawModels[object];
+			visibleLevels[i] = modelPool->SelectLOD(visibleModels[i], world->GetBounds(object), PV);
 		}
+	};
 
-		// If we've made it this far, we still have 3 points.
-		// simplex[0] = c, simplex[1] = b, simplex[2] = a
-		// We wish to make a tetrahedron
-		
-		if (glm::dot(abc, -a) > 0)
-		{
-			// Leave simplex as-is
-			// d = c, c = b, b = a (naturally done)
-			// simplex[0] = d, simplex[1] = c, simplex[2] = b, simplex[3] = a (does not exist yet)
-			dir = abc;
-		}
-		else
-		{
-			// Upside down tetrahedron
-			// simplex[0] = d, simplex[1] = c, simplex[2] = b, simplex[3] = a (does not exist yet)
-			glm::vec3 temp = simplex[1];
-			simplex[1] = simplex[0]; // c = oldC
-			simplex[0] = temp; // d = b
-			// b = a (naturally done)
+	renderJobs->ParallelFor((int)visibleObjects.size(), RENDER_GRAIN, pack);
+}
 
-			dir = -abc;
-		}
+// This runs once every physics timestep.
+void update(float dt)
+{
+	GJK_PROFILE_ZONE("update");
 
-		return false;
-	}
-	else if (simplex.size() == 2)
+	if (broadphaseSwitchRequested.exchange(false))
 	{
-		// Line segment
-		b = simplex[0];
+		int next = (world->GetBroadphaseIndex() + 1) % PhysicsWorld::NUM_BROADPHASES;
 
-		ab = b - a;
-		
-		// Triple product
-		// doubleCross(ab, -a)
-		dir = glm::cross(glm::cross(ab, -a), ab);
+		world->SetBroadphase(next);
+		currentBroadphase = next;
+	}
 
-		// We still have 2 points
-		// simplex[0] = b, simplex[1] = a
-		// We wish to make a triangle such that:
-		// simplex[0] = c, simplex[1] = b, simplex[2] = a
-		// c = b, b = a (naturally done)
+	// If the physics is falling behind, skip the work that can be skipped.
+	world->SetDegraded(scheduler.IsDegraded());
 
-		return false;
+	// Make the changes the other threads have queued up, detect and resolve the collisions, and move everything forward. (If nothing's
+	// being recorded, this is just world->ApplyCommands and world->Step.)
+	recorder.Step(*world, dt);
+	flightRecorder.Record(*world);
 
-		// ab, -a, ab
-		//dir = (-a * glm::dot(ab, ab)) - (ab * glm::dot(ab, -a));
-	}
-	else if (simplex.size() == 4) // We have a tetrahedron
+#pragma region Boundaries
+	// This section just checks to make sure the object stays within a certain boundary. This is not really collision detection.
 	{
-		d = simplex[0];
-		c = simplex[1];
-		b = simplex[2];
+		GJK_PROFILE_ZONE("boundaries");
 
-		ab = b - a;
-		ac = c - a;
-		ad = d - a;
+		glm::vec3 tempPos = obj2->GetPosition();
 
-		// simplex[0] = d, simplex[1] = c, simplex[2] = b, simplex[3] = a
-
-		glm::vec3 abc = glm::cross(ab, ac);
+		if (fabsf(tempPos.x) > 1.35f)
+		{
+			glm::vec3 tempVel = obj2->GetVelocity();
 
-		if (glm::dot(abc, -a) > 0)
+			// "Bounce" the velocity along the axis that was over-extended.
+			obj2->SetVelocity(glm::vec3(-1.0f * tempVel.x, tempVel.y, tempVel.z));
+		}
+		if (fabsf(tempPos.y) > 0.8f)
 		{
-			// This is in front of triangle ABC, so we don't have to change variables around.
-			return checkTetrahedron(-a, ab, ac, abc, dir);
+			glm::vec3 tempVel = obj2->GetVelocity();
+			obj2->SetVelocity(glm::vec3(tempVel.x, -1.0f * tempVel.y, tempVel.z));
 		}
+		if (fabsf(tempPos.z) > 1.0f)
+		{
+			glm::vec3 tempVel = obj2->GetVelocity();
+			obj2->SetVelocity(glm::vec3(tempVel.x, tempVel.y, -1.0f * tempVel.z));
+		}
+	}
+#pragma endregion Boundaries section just bounces the object so it does not fly off the side of the screen infinitely.
 
-		glm::vec3 acd = glm::cross(ac, ad);
+	// Hand the step over to the queries. (If the render thread is still reading the snapshot before last, this step is skipped.)
+	sceneQueries.Publish(*world);
+}
 
-		if (glm::dot(acd, -a) > 0)
-		{
-			// Since this is in front of triangle ACD
+// Copies every object's OBB, the pairs the broadphase found and the ones that collided in the last step (and where) into a snapshot.
+void copyCollisions(PhysicsSnapshot& snapshot)
+{
+	const std::vector<NarrowphaseContact>& contacts = world->GetContacts();
 
-			// b value eliminated
-			simplex[2] = simplex[1]; // b = c
-			simplex[1] = simplex[0]; // c = d
-			ab = ac;
-			ac = ad;
-			abc = acd;
+	snapshot.shapes = world->GetShapes();
+	snapshot.pairs = world->GetPairs();
+	snapshot.contacts.clear();
+	snapshot.contactPoints.clear();
 
-			return checkTetrahedron(-a, ab, ac, abc, dir);
+	// The contacts are already sorted by pair, so these are too. The speculative ones aren't touching yet, so they aren't collisions.
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		if (contacts[i].speculative)
+		{
+			continue;
 		}
-		
-		glm::vec3 adb = glm::cross(ad, ab);
 
-		if (glm::dot(adb, -a) > 0)
-		{
-			// Since this is in front of triangle ADB
+		snapshot.contacts.push_back(BroadphasePair(contacts[i].a, contacts[i].b));
+		snapshot.contactPoints.push_back(contacts[i].contact);
+	}
+}
 
-			// c value eliminated
-			simplex[1] = simplex[2]; // c = b
-			simplex[2] = simplex[0]; // b = d
+// Copies where every object is now into a snapshot, and hands it to the renderer.
+// If the GPU is checking the narrowphase, or the collisions are being drawn, it gets what the last step collided too.
+void publishSnapshot(double now)
+{
+	PhysicsSnapshot& snapshot = snapshots.GetWriting();
+	int count = (int)objects.size();
 
-			ac = ab;
-			ab = ad;
+	snapshot.Resize(count);
 
-			abc = adb;
-			return checkTetrahedron(-a, ab, ac, abc, dir);
-		}
+	for (int i = 0; i < count; i++)
+	{
+		BodyHandle body = objects[i].GetBody();
 
-		// If you made it this far and then you are overlapping the origin which means there is a collision!
-		return true;
+		BodyStore& bodies = world->Bodies();
+
+		snapshot.positions[i] = bodies.Position(body);
+		snapshot.orientations[i] = bodies.Orientation(body);
+		snapshot.scales[i] = bodies.Scale(body);
+		snapshot.bounds[i] = world->GetBounds(i);
+		snapshot.resting[i] = bodies.IsSleeping(body) || bodies.GetType(body) == BODY_STATIC ? 1 : 0;
+	}
+
+	if (gpuCheck || collisionView)
+	{
+		copyCollisions(snapshot);
 	}
-	/*else // If you have something unexpected coming through here, maybe your simplex is too big or too small? Uncomment below and add a break statement.
+	else
 	{
-		std::cout << "ERROR";
-	}*/
+		snapshot.shapes.clear();
+		snapshot.pairs.clear();
+		snapshot.contacts.clear();
+	}
+
+	snapshot.time = now;
+	snapshot.accumulator = scheduler.GetAccumulator();
 
-	return false;
+	snapshots.Publish();
 }
 
-bool TestGJK(OBB a, OBB b)
+// Draws what the collision detection is doing, if C has turned it on: every object's OBB (green) and its bounds in the broadphase (grey),
+// where each contact from the last step is on both objects (red on the first, yellow on the second) with an arrow along its normal, and for the
+// first MAX_DEBUG_SIMPLICES contacts, the points on each object that GJK's final simplex was made from (blue on the first, cyan on the second).
+// All of it goes through the debug draw in one draw call.
+void drawCollisions()
 {
-	simplex.clear();
-	
-	glm::vec3 dir = glm::vec3(1.0f);// a.corners[0] - b.corners[1]; // Choose a start direction
+	if (!collisionView)
+	{
+		return;
+	}
+
+	GJK_PROFILE_ZONE("debug draw");
+
+	// With a physics thread, the world could be in the middle of a step, so it all comes from the latest snapshot instead.
+	if (threadedPhysics)
+	{
+		if (!snapshots.CopyLatest(debugSnapshot))
+		{
+			return;
+		}
+	}
+	else
+	{
+		copyCollisions(debugSnapshot);
 
-	simplex.push_back(Support(a, b, dir)); // c
+		debugSnapshot.bounds.resize(objects.size());
+
+		for (int i = 0; i < (int)objects.size(); i++)
+		{
+			debugSnapshot.bounds[i] = world->GetBounds(i);
+		}
+	}
 
-	dir = -simplex.back(); // -c
+	static const glm::vec4 OBB_COLOR(0.2f, 0.9f, 0.3f, 1.0f);
+	static const glm::vec4 BOUNDS_COLOR(0.5f, 0.5f, 0.5f, 1.0f);
+	static const glm::vec4 POINT_A_COLOR(1.0f, 0.2f, 0.2f, 1.0f);
+	static const glm::vec4 POINT_B_COLOR(1.0f, 0.9f, 0.2f, 1.0f);
+	static const glm::vec4 NORMAL_COLOR(1.0f, 1.0f, 1.0f, 1.0f);
+	static const glm::vec4 SIMPLEX_A_COLOR(0.3f, 0.4f, 1.0f, 1.0f);
+	static const glm::vec4 SIMPLEX_B_COLOR(0.3f, 0.9f, 1.0f, 1.0f);
 
-	simplex.push_back(Support(a, b, dir)); // b
+	for (int i = 0; i < (int)debugSnapshot.shapes.size(); i++)
+	{
+		debugDraw->AddOBB(debugSnapshot.shapes[i], OBB_COLOR);
+	}
 
-	if (glm::dot(simplex.back(), dir) < 0)
+	for (int i = 0; i < (int)debugSnapshot.bounds.size(); i++)
 	{
-		return false;
+		debugDraw->AddBox(debugSnapshot.bounds[i], BOUNDS_COLOR);
 	}
 
-	dir = glm::cross(glm::cross(simplex[0] - simplex[1], -simplex[1]), simplex[0] - simplex[1]);
+	for (int i = 0; i < (int)debugSnapshot.contactPoints.size(); i++)
+	{
+		const EPAResult& contact = debugSnapshot.contactPoints[i];
+
+		debugDraw->AddPoint(contact.pointA, 0.1f, POINT_A_COLOR);
+		debugDraw->AddPoint(contact.pointB, 0.1f, POINT_B_COLOR);
+		debugDraw->AddArrow(contact.pointA, contact.pointA + contact.normal * 0.5f, NORMAL_COLOR);
+	}
 
+	// GJK doesn't keep its simplices, so the first few contacts are tested again to get them. Each simplex point is the difference of a point
+	// on each object, and those are what get drawn, since the difference itself is off in Minkowski space.
+	GJKSolver solver;
+	int numSimplices = glm::min((int)debugSnapshot.contacts.size(), MAX_DEBUG_SIMPLICES);
 
-	while (true)
+	for (int i = 0; i < numSimplices; i++)
 	{
-		simplex.push_back(Support(a, b, dir)); // a
+		const OBBShape& a = debugSnapshot.shapes[debugSnapshot.contacts[i].a];
+		const OBBShape& b = debugSnapshot.shapes[debugSnapshot.contacts[i].b];
 
-		if (glm::dot(simplex.back(), dir) <= 0)
+		solver.TestGJK(a, b);
+
+		const Simplex& simplex = solver.GetSimplex();
+		glm::vec3 pointsA[4];
+		glm::vec3 pointsB[4];
+
+		for (int j = 0; j < simplex.count; j++)
 		{
-			// Sometimes you get unexpected values, so uncommenting below and putting a break statement can help you debug what might throw a zero in your dot product.
-			/*if (glm::dot(simplex.back(), dir) == 0)
-			{
-				return false;
-			}*/
+			pointsA[j] = simplex.pointsA[j];
+			pointsB[j] = simplex.pointsA[j] - simplex.points[j];
+		}
 
+		debugDraw->AddSimplex(pointsA, simplex.count, SIMPLEX_A_COLOR);
+		debugDraw->AddSimplex(pointsB, simplex.count, SIMPLEX_B_COLOR);
+	}
 
-			// If the point added last was not past the origin in the direction of d, then the Minkowski Sum cannot contain the origin since the last 
-			// point added is on the edge of the Minkowski Difference.
-			return false;
+	debugDraw->Draw(program->GetProgram());
+}
+
+// The physics thread. It steps the physics whenever it's time to, and publishes a snapshot after each round of steps.
+void physicsLoop()
+{
+	while (physicsRunning)
+	{
+		// (glfwGetTime, which the scheduler's clock reads, can be called from any thread.)
+		if (scheduler.Advance(update) > 0)
+		{
+			publishSnapshot(scheduler.GetLastTime());
 		}
 		else
 		{
-			if (ContainsOrigin(dir))
-			{
-				return true;
-			}
+			// Not time for a step yet. Give the time to the render thread (and the job system's workers) instead of spinning.
+			std::this_thread::yield();
 		}
 	}
 }
 
-// This runs once every physics timestep.
-void update(float dt)
+// This runs once every frame to determine how often to call update based on the physics step.
+// (How fast the frames and steps are going is up to the overlay now, which gets it from the profiler.)
+void checkTime()
 {
-#pragma region Boundaries
-	// This section just checks to make sure the object stays within a certain boundary. This is not really collision detection.
-	glm::vec3 tempPos = obj2->GetPosition();
-	
-	if (fabsf(tempPos.x) > 1.35f)
+	// With a physics thread, the stepping happens over there.
+	if (!threadedPhysics)
 	{
-		glm::vec3 tempVel = obj2->GetVelocity();
+		scheduler.Advance(update);
+	}
+}
+
+// This function runs every frame
+void renderScene()
+{
+	GJK_PROFILE_ZONE("render");
 
-		// "Bounce" the velocity along the axis that was over-extended.
-		obj2->SetVelocity(glm::vec3(-1.0f * tempVel.x, tempVel.y, tempVel.z));
+	// There's nothing to draw into while the window is minimized.
+	if (framebufferWidth <= 0 || framebufferHeight <= 0)
+	{
+		return;
 	}
-	if (fabsf(tempPos.y) > 0.8f)
+
+	// Catch the projection up with the window, if it's been resized.
+	updateCamera();
+
+	// Draw the scene into the smaller target, if we're rendering at less than full size, or straight into the window.
+	bool scaled = renderScale < 1.0f;
+
+	if (scaled)
 	{
-		glm::vec3 tempVel = obj2->GetVelocity();
-		obj2->SetVelocity(glm::vec3(tempVel.x, -1.0f * tempVel.y, tempVel.z));
+		renderTarget->Resize((int)(framebufferWidth * renderScale), (int)(framebufferHeight * renderScale));
+		renderTarget->Bind();
 	}
-	if (fabsf(tempPos.z) > 1.0f)
+	else
 	{
-		glm::vec3 tempVel = obj2->GetVelocity();
-		obj2->SetVelocity(glm::vec3(tempVel.x, tempVel.y, -1.0f * tempVel.z));
+		glViewport(0, 0, framebufferWidth, framebufferHeight);
 	}
-#pragma endregion Boundaries section just bounces the object so it does not fly off the side of the screen infinitely.
 
-	// Rotate the objects. This helps illustrate how the OBB follows the object's orientation.
-	 obj1->Rotate(glm::vec3(glm::radians(1.0f), glm::radians(1.0f), glm::radians(0.0f)));
-	 obj2->Rotate(glm::vec3(glm::radians(1.0f), glm::radians(1.0f), glm::radians(0.0f)));
+	gpuTimer->BeginFrame();
+
+	// Clear the color buffer (to the clear color init set) and the depth buffer
+	gpuTimer->BeginPass(GPU_PASS_CLEAR);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	gpuTimer->EndPass();
 
-	// Re-calculate the Object-Oriented Bounding Box for your object.
-	// We do this because if the object's orientation changes, we should update the bounding box as well.
-	// Be warned: For some objects this can actually cause a collision to be missed, so be careful.
-	// (This is because we determine the collision based on the OBB, but if the OBB changes significantly, the time of collision can change between frames,
-	// and if that lines up just right you'll miss the collision altogether.)
-	 glm::vec4 pointsA[8];
-	 glm::vec4 pointsB[8];
+	// Move the debris on, all on the GPU.
+	double now = glfwGetTime();
+	float debrisStep = (float)(now - lastDebrisStep);
 
-	 for (int i = 0; i < 8; i++)
-	 {
-		 pointsA[i] = *obj1->GetTransform() * glm::vec4(obj1->GetModel()->Vertices()[i].position, 1.0f);
-		 pointsB[i] = *obj2->GetTransform() * glm::vec4(obj2->GetModel()->Vertices()[i].position, 1.0f);
+	lastDebrisStep = now;
 
-		 obb1.corners[i] = glm::vec3(pointsA[i].x, pointsA[i].y, pointsA[i].z);
-		 obb2.corners[i] = glm::vec3(pointsB[i].x, pointsB[i].y, pointsB[i].z);
-	 }
+	if (debris->NumBodies() > 0)
+	{
+		gpuTimer->BeginPass(GPU_PASS_DEBRIS);
+		debris->Step(debrisStep < debrisMaxStep ? debrisStep : debrisMaxStep);
+		gpuTimer->EndPass();
+	}
 
-	// Pass in our two objects to the GJK test, if it returns true then they are colliding because the Minkowski Sum (Difference) contains the origin.
-	 if (TestGJK(obb2, obb1) && !antiStuck)
+	// Tell OpenGL to use the shader program you've created.
+	program->Use();
+
+	// Everything drawn below reads the camera from the same buffer. (It only gets new contents when the window changes, in updateCamera.)
+	glBindBufferBase(GL_UNIFORM_BUFFER, VertexLayout::CAMERA_BINDING, cameraBuffer);
+
+	// Draw every visible object, each with its own transform.
+	// Objects with the same model are drawn with the same data, just different transforms, so that we can use less data overall.
+	// This is a technique called instancing: the transforms go into a buffer that the vertex shader reads one of per instance. The pool groups
+	// the objects by model and sends one indirect command per model, all in a single call, so no matter how many objects (or models) there are,
+	// it's only one draw call. (Every model is in the same buffers and drawn with the same program, so there's no other state to sort the
+	// draws by; the pool sorts them front to back instead, which lets the depth test skip shading whatever's hidden. A separate depth-only
+	// pass first wouldn't pay for itself here: it would transform every vertex twice to save fragment work that's only a flat color.)
+	// With compute shaders, the culling happens on the GPU right before the draw, and the GPU fills in the commands' instance counts itself.
+	// The GPU keeps every object from frame to frame then, so only the ones that changed are sent (the asleep and static ones hardly ever).
+	// With a physics thread, everything the renderer draws comes from the physics snapshots (and none of it from the objects themselves,
+	// which the physics thread could be in the middle of moving). The culling is against the snapshots' bounds, on the GPU if it can.
+	gpuTimer->BeginPass(GPU_PASS_OPAQUE);
+	modelPool->Begin();
+
+	if (threadedPhysics)
 	{
-		glm::vec3 velocity = obj2->GetVelocity();
-		
-		// Reverse the velocity in the x direction
-		// This is the "bounce" effect, only we don't actually know the axis of collision from the test. Instead, we assume it because the object is only moving in the x 
-		// direction.
-		velocity.x *= -1;
+		if (snapshots.InterpolatePoses(physicsClock.Now(), physicsStep, interpolatedPositions, interpolatedOrientations, interpolatedScales,
+			drawBounds, &restingObjects))
+		{
+			resizeInstances((int)interpolatedPositions.size());
+
+			auto pack = [](int begin, int end, int thread)
+			{
+				for (int i = begin; i < end; i++)
+				{
+					packChangedInstance(i, i, restingObjects[i] != 0);
+				}
+			};
 
-		obj2->SetVelocity(velocity);
+			renderJobs->ParallelFor((int)drawTransforms.size(), RENDER_GRAIN, pack);
+		}
 
-		// This variable exists to allow an extra frame/update to pass when they collide so that the objects do not get stuck as a result of tunneling and 
-		// recalculating the OBB.
-		antiStuck = true;
+		modelPool->DrawCulled(drawModels.data(), drawTransforms.data(), drawBounds.data(), (int)drawTransforms.size(), PV,
+			changedInstances.data());
 	}
-	else if (antiStuck)
+	else
 	{
-		antiStuck = false;
-	}
-	
-	// Update the objects based on their velocities.
-	obj1->Update(dt);
-	obj2->Update(dt);
+		// Find the visible objects and their transforms.
+		updateTransforms();
 
-	// Update your MVP matrices based on the objects' transforms.
-	MVP = PV * *obj1->GetTransform();
-	MVP2 = PV * *obj2->GetTransform();
-}
+		if (modelPool->CanCull())
+		{
+			modelPool->DrawCulled(drawModels.data(), drawTransforms.data(), drawBounds.data(), (int)drawTransforms.size(), PV,
+				changedInstances.data());
+		}
+		else
+		{
+			modelPool->DrawBatched(visibleModels.data(), visibleTransforms.data(), (int)visibleTransforms.size(), PV, visibleLevels.data());
+		}
+	}
 
-// This runs once every frame to determine the FPS and how often to call update based on the physics step.
-void checkTime()
-{
-	// Get the current time.
-	time = glfwGetTime();
+	// The debris is drawn from the transforms its shader just wrote, without the CPU ever seeing them (or culling them).
+	debris->Draw(*modelPool, modelPool->Find(cube));
 
-	// Get the time since we last ran an update.
-	double dt = time - timebase;
+	modelPool->End();
+	gpuTimer->EndPass();
 
-	// If more time has passed than our physics timestep.
-	if (dt > physicsStep)
+	// Keep this frame's depth for the next frame's occlusion culling. (The debug drawing comes after, since it shouldn't hide anything.)
+	if (occlusionCulling && depthPyramid->CanBuild())
 	{
-		// Calculate FPS: Take the number of frames (frame) since the last time we calculated FPS, and divide by the amount of time that has passed since the 
-		// last time we calculated FPS (time - FPSTime).
-		if (time - FPSTime > 1.0)
+		gpuTimer->BeginPass(GPU_PASS_DEPTH_PYRAMID);
+
+		if (scaled)
 		{
-			fps = frame / (time - FPSTime);
+			depthPyramid->Build(renderTarget->GetWidth(), renderTarget->GetHeight(), PV);
+		}
+		else
+		{
+			depthPyramid->Build(framebufferWidth, framebufferHeight, PV);
+		}
 
-			FPSTime = time; // Now we set FPSTime = time, so that we have a reference for when we calculated the FPS
-			
-			frame = 0; // Reset our frame counter to 0, to mark that 0 frames have passed since we calculated FPS (since we literally just did it)
+		gpuTimer->EndPass();
+	}
 
-			std::string s = "FPS: " + std::to_string(fps); // This just creates a string that looks like "FPS: 60" or however much.
+	gpuTimer->BeginPass(GPU_PASS_DEBUG_DRAW);
+	drawCollisions();
+	gpuTimer->EndPass();
 
-			glfwSetWindowTitle(window, s.c_str()); // This will set the window title to that string, displaying the FPS as the window title.
-		}
+	gpuTimer->EndFrame();
 
-		timebase = time; // Set timebase = time so we have a reference for when we ran the last physics timestep.
+	// Stretch the scene over the window.
+	if (scaled)
+	{
+		renderTarget->BlitToScreen(framebufferWidth, framebufferHeight);
+	}
+
+	// The overlay goes over everything else.
+	overlay->Draw(program->GetProgram(), framebufferWidth, framebufferHeight);
+}
+
+// Checks the narrowphase on the GPU, if G has turned it on: the GJK shader tests the same pairs the CPU did, and we count how many of its
+// answers were different. (They should almost all agree. The GPU starts every query from scratch rather than from the cache, and its floats
+// don't round quite the same, so a pair that's only just touching can go either way.)
+// This never waits on the GPU. The hits for the pairs sent off last frame get read back if they're ready, and then the latest pairs go off,
+// to be read back next frame or whenever they're done.
+void checkNarrowphaseOnGPU()
+{
+	if (!gpuCheck || !gpuNarrowphase->CanTest())
+	{
+		return;
+	}
+
+	GJK_PROFILE_ZONE("gpu narrowphase");
 
-		// Limit dt so that we if we experience any sort of delay in processing power or the window is resizing/moving or anything, it doesn't update a bunch of times while the player can't see.
-		// This will limit it to a .25 seconds.
-		if (dt > 0.25)
+	if (gpuNarrowphase->IsBusy())
+	{
+		if (!gpuNarrowphase->IsReady())
 		{
-			dt = 0.25;
+			return;
 		}
 
-		// The accumulator is here so that we can track the amount of time that needs to be updated based on dt, but not actually update at dt intervals and instead use our physicsStep.
-		accumulator += dt;
+		int numPairs = gpuNarrowphase->Read(gpuHits);
+		long long hits = 0;
+		long long different = 0;
 
-		// Run a while loop, that runs update(physicsStep) until the accumulator no longer has any time left in it (or the time left is less than physicsStep, at which point it save that 
-		// leftover time and use it in the next checkTime() call.
-		while (accumulator >= physicsStep)
+		for (int i = 0; i < numPairs; i++)
 		{
-			update(physicsStep);
+			bool gpuHit = GPUNarrowphase::IsHit(gpuHits, i);
+			bool cpuHit = std::binary_search(gpuSnapshot.contacts.begin(), gpuSnapshot.contacts.end(), gpuSnapshot.pairs[i]);
 
-			accumulator -= physicsStep;
+			hits += gpuHit ? 1 : 0;
+			different += gpuHit != cpuHit ? 1 : 0;
 		}
+
+		GJK_PROFILE_COUNT("gpu checks", 1);
+		GJK_PROFILE_COUNT("gpu pairs", numPairs);
+		GJK_PROFILE_COUNT("gpu hits", hits);
+		GJK_PROFILE_COUNT("gpu different", different);
 	}
+
+	// With a physics thread, the world could be in the middle of a step, so the pairs come from the latest snapshot instead.
+	if (threadedPhysics)
+	{
+		if (!snapshots.CopyLatest(gpuSnapshot))
+		{
+			return;
+		}
+	}
+	else
+	{
+		copyCollisions(gpuSnapshot);
+	}
+
+	gpuNarrowphase->Test(gpuSnapshot.shapes.data(), (int)gpuSnapshot.shapes.size(), gpuSnapshot.pairs.data(), (int)gpuSnapshot.pairs.size());
 }
 
-// This function runs every frame
-void renderScene()
+// Reloads any of the shaders whose files have changed, so they can be edited while the demo runs. (Twice a second is plenty, and keeps us
+// from asking the file system every frame.)
+void reloadShaders()
 {
-	// Clear the color buffer and the depth buffer
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	double now = glfwGetTime();
 
-	// Clear the screen to white
-	glClearColor(1.0, 1.0, 1.0, 1.0);
-
-	// Tell OpenGL to use the shader program you've created.
-	glUseProgram(program);
+	if (now - lastShaderCheck < 0.5)
+	{
+		return;
+	}
 
-	// Set the uniform matrix in our shader to our MVP matrix for the first object.
-	glUniformMatrix4fv(uniMVP, 1, GL_FALSE, glm::value_ptr(MVP));
+	lastShaderCheck = now;
 
-	// Draw the cube.
-	cube->Draw();
+	// (The compute shaders can't load at all without OpenGL 4.3, so there's no point trying.)
+	ShaderProgram* programs[5] = { program, cullProgram, pyramidProgram, gjkProgram, debrisProgram };
+	int numPrograms = GLEW_VERSION_4_3 ? 5 : 1;
 
-	// Set the uniform matrix in our shader to our MVP matrix for the second object.
-	glUniformMatrix4fv(uniMVP, 1, GL_FALSE, glm::value_ptr(MVP2));
+	for (int i = 0; i < numPrograms; i++)
+	{
+		if (!programs[i]->HasChanged())
+		{
+			continue;
+		}
 
-	// Draw the cube again.
-	cube->Draw();
+		if (programs[i]->Reload())
+		{
+			std::cout << "Reloaded the " << programs[i]->GetName() << " shaders." << std::endl;
+		}
+		else
+		{
+			// We're still on the old one.
+			std::cout << programs[i]->GetError() << std::endl;
+		}
+	}
 
-	// We're using the same model here to draw, but different transformation matrices so that we can use less data overall.
-	// This is a technique called instancing, although "true" instancing involves binding a matrix array to the uniform variable and using DrawInstanced in place of draw.
+	// The cull, pyramid, GJK and debris programs might be new ones now.
+	modelPool->SetCullProgram(*cullProgram);
+	depthPyramid->SetProgram(*pyramidProgram);
+	gpuNarrowphase->SetProgram(*gjkProgram);
+	debris->SetProgram(*debrisProgram);
 }
 
-// This method reads the text from a file.
-// Realistically, we wouldn't want plain text shaders hardcoded in, we'd rather read them in from a separate file so that the shader code is separated.
-std::string readShader(std::string fileName)
+// Adds the stress cubes (see stressCount) to the world and objects, drawn with the cube, which model is. They fill a cube of space
+// around the origin a grid cell at a time, leaving out the cells where obj1 and obj2 are, each at a random scale and orientation, and
+// spinning about its own x and y axes like they do. Returns how far the cubes go out from the origin.
+float addStressCubes(const SceneModel& model)
 {
-	std::string shaderCode;
-	std::string line;
+	if (stressCount <= 0)
+	{
+		return 0.0f;
+	}
 
-	// We choose ifstream and std::ios::in because we are opening the file for input into our program.
-	// If we were writing to the file, we would use ofstream and std::ios::out.
-	std::ifstream file(fileName, std::ios::in);
+	// The box around the cube's vertices, the same as the scene gives its own bodies.
+	glm::vec3 boundsMin = model.positions.empty() ? glm::vec3(-0.25f) : model.positions[0];
+	glm::vec3 boundsMax = boundsMin;
 
-	// This checks to make sure that we didn't encounter any errors when getting the file.
-	if (!file.good())
+	for (int i = 1; i < (int)model.positions.size(); i++)
 	{
-		std::cout << "Can't read file: " << fileName.data() << std::endl;
-
-		// Return so we don't error out.
-		return "";
+		boundsMin = glm::min(boundsMin, model.positions[i]);
+		boundsMax = glm::max(boundsMax, model.positions[i]);
 	}
 
-	// ifstream keeps an internal "get" position determining the location of the element to be read next
-	// seekg allows you to modify this location, and tellg allows you to get this location
-	// This location is stored as a streampos member type, and the parameters passed in must be of this type as well
-	// seekg parameters are (offset, direction) or you can just use an absolute (position).
-	// The offset parameter is of the type streamoff, and the direction is of the type seekdir (an enum which can be ios::beg, ios::cur, or ios::end referring to the beginning, 
-	// current position, or end of the stream).
-	file.seekg(0, std::ios::end);					// Moves the "get" position to the end of the file.
-	shaderCode.resize((unsigned int)file.tellg());	// Resizes the shaderCode string to the size of the file being read, given that tellg will give the current "get" which is at the end of the file.
-	file.seekg(0, std::ios::beg);					// Moves the "get" position to the start of the file.
+	// Enough cells each way for all of them, with a few spare for the ones that are left out.
+	int side = (int)ceilf(cbrtf((float)stressCount)) + 1;
+	float extent = side * STRESS_SPACING * 0.5f;
 
-	// File streams contain two member functions for reading and writing binary data (read, write). The read function belongs to ifstream, and the write function belongs to ofstream.
-	// The parameters are (memoryBlock, size) where memoryBlock is of type char* and represents the address of an array of bytes are to be read from/written to.
-	// The size parameter is an integer that determines the number of characters to be read/written from/to the memory block.
-	file.read(&shaderCode[0], shaderCode.size());	// Reads from the file (starting at the "get" position which is currently at the start of the file) and writes that data to the beginning
-	// of the shaderCode variable, up until the full size of shaderCode. This is done with binary data, which is why we must ensure that the sizes are all correct.
+	// The same seed every time, so a machine is always tested with the same scene.
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
 
-	file.close(); // Now that we're done, close the file and return the shaderCode.
+	glm::vec3 spin = glm::vec3(glm::radians(1.0f), glm::radians(1.0f), 0.0f) / (float)physicsStep;
 
-	return shaderCode;
-}
+	std::vector<SceneBody> bodies;
+	bodies.reserve(stressCount);
 
-// This method will consolidate some of the shader code we've written to return a GLuint to the compiled shader.
-// It only requires the shader source code and the shader type.
-GLuint createShader(std::string sourceCode, GLenum shaderType)
-{
-	// glCreateShader, creates a shader given a type (such as GL_VERTEX_SHADER) and returns a GLuint reference to that shader.
-	GLuint shader = glCreateShader(shaderType);
-	const char *shader_code_ptr = sourceCode.c_str(); // We establish a pointer to our shader code string
-	const int shader_code_size = sourceCode.size();   // And we get the size of that string.
-
-	// glShaderSource replaces the source code in a shader object
-	// It takes the reference to the shader (a GLuint), a count of the number of elements in the string array (in case you're passing in multiple strings), a pointer to the string array 
-	// that contains your source code, and a size variable determining the length of the array.
-	glShaderSource(shader, 1, &shader_code_ptr, &shader_code_size);
-	glCompileShader(shader); // This just compiles the shader, given the source code.
+	for (int i = 0; i < side * side * side && (int)bodies.size() < stressCount; i++)
+	{
+		glm::vec3 position = (glm::vec3((float)(i % side), (float)(i / side % side), (float)(i / (side * side))) + 0.5f) * STRESS_SPACING - extent;
 
-	GLint isCompiled = 0;
+		// obj1 and obj2 are near the origin.
+		if (glm::length(position) < 1.0f)
+		{
+			continue;
+		}
 
-	// Check the compile status to see if the shader compiled correctly.
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+		SceneBody body;
+		body.center = (boundsMin + boundsMax) * 0.5f;
+		body.halfExtents = (boundsMax - boundsMin) * 0.5f;
+		body.position = position;
+		body.orientation = glm::normalize(glm::quat(unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f,
+			unit(random) * 2.0f - 1.0f));
+		body.scale = glm::vec3(STRESS_MIN_SCALE + (STRESS_MAX_SCALE - STRESS_MIN_SCALE) * unit(random));
 
-	if (isCompiled == GL_FALSE)
-	{
-		char infolog[1024];
-		glGetShaderInfoLog(shader, 1024, NULL, infolog);
+		bodies.push_back(body);
+	}
 
-		// Print the compile error.
-		std::cout << "The shader failed to compile with the error:" << std::endl << infolog << std::endl;
+	int first = AddSceneBodies(*world, bodies.data(), (int)bodies.size());
 
-		// Provide the infolog in whatever manor you deem best.
-		// Exit with failure.
-		glDeleteShader(shader); // Don't leak the shader.
+	objects.reserve(objects.size() + bodies.size());
 
-		// NOTE: I almost always put a break point here, so that instead of the program continuing with a deleted/failed shader, it stops and gives me a chance to look at what may 
-		// have gone wrong. You can check the console output to see what the error was, and usually that will point you in the right direction.
+	for (int i = 0; i < (int)bodies.size(); i++)
+	{
+		objects.push_back(GameObject(cube, &world->Bodies(), world->GetBody(first + i)));
+		objects.back().SetAngularVelocity(bodies[i].orientation * spin);
 	}
 
-	return shader;
+	std::cout << "Stress mode: " << bodies.size() << " more cubes." << std::endl;
+
+	return extent;
 }
 
 // Initialization code
@@ -634,80 +1105,252 @@ void init()
 	// Enables the depth test, which you will want in most cases. You can disable this in the render loop if you need to.
 	glEnable(GL_DEPTH_TEST);
 
-	// An element array, which determines which of the vertices to display in what order. This is sometimes known as an index array.
-	GLuint elements[] = {
-		0, 1, 2, 0, 2, 3, 3, 2, 4, 3, 4, 5, 5, 4, 6, 5, 6, 7, 7, 6, 1, 7, 1, 0, 1, 6, 4, 1, 4, 2, 7, 0, 3, 7, 3, 5
-	};
-	// These are the indices for a cube.
-	vertices.push_back(VertexFormat(glm::vec3(-0.25, -0.25, 0.25),		// Front, Bottom, Left		0
-		glm::vec4(1.0, 0.0, 0.0, 1.0))); //red
-	vertices.push_back(VertexFormat(glm::vec3(-0.25, 0.25, 0.25),		// Front, Top, Left			1
-		glm::vec4(1.0, 0.0, 0.0, 1.0))); //red
-	vertices.push_back(VertexFormat(glm::vec3(0.25, 0.25, 0.25),		// Front, Top, Right		2
-		glm::vec4(1.0, 0.0, 1.0, 1.0))); //yellow
-	vertices.push_back(VertexFormat(glm::vec3(0.25, -0.25, 0.25),		// Front, Bottom, Right		3
-		glm::vec4(1.0, 0.0, 1.0, 1.0))); //yellow
-	vertices.push_back(VertexFormat(glm::vec3(0.25, 0.25, -0.25),		// Back, Top, Right			4
-		glm::vec4(0.0, 1.0, 1.0, 1.0))); //cyan
-	vertices.push_back(VertexFormat(glm::vec3(0.25, -0.25, -0.25),		// Back, Bottom, Right		5
-		glm::vec4(0.0, 1.0, 1.0, 1.0))); //cyan
-	vertices.push_back(VertexFormat(glm::vec3(-0.25, 0.25, -0.25),		// Back, Top, Left			6
-		glm::vec4(0.0, 1.0, 0.0, 1.0))); //blue
-	vertices.push_back(VertexFormat(glm::vec3(-0.25, -0.25, -0.25),		// Back, Bottom, Left		7
-		glm::vec4(0.0, 1.0, 0.0, 1.0))); //blue
-
-	// Create our cube model from the calculated data.
-	cube = new Model(vertices.size(), vertices.data(), 36, elements);
-
-	// Create two GameObjects based off of the cube model (note that they are both holding pointers to the cube, not actual copies of the cube vertex data).
-	obj1 = new GameObject(cube);
-	obj2 = new GameObject(cube);
-
-	// Set beginning properties of GameObjects.
-	obj1->SetVelocity(glm::vec3(0, 0.0f, 0.0f)); // The first object doesn't move.
-	obj2->SetVelocity(glm::vec3(-speed, 0.0f, 0.0f));
-	obj1->SetPosition(glm::vec3(0.0f, 0.0f, 0.0f));
-	obj2->SetPosition(glm::vec3(-0.7f, 0.0f, 0.0f));
-	obj1->SetScale(glm::vec3(0.85f, 0.85f, 0.85f));
-	obj2->SetScale(glm::vec3(0.20f, 0.20f, 0.20f));
-
-	// Read in the shader code from a file.
-	std::string vertShader = readShader("VertexShader.glsl");
-	std::string fragShader = readShader("FragmentShader.glsl");
-
-	// createShader consolidates all of the shader compilation code
-	vertex_shader = createShader(vertShader, GL_VERTEX_SHADER);
-	fragment_shader = createShader(fragShader, GL_FRAGMENT_SHADER);
-
-	// A shader is a program that runs on your GPU instead of your CPU. In this sense, OpenGL refers to your groups of shaders as "programs".
-	// Using glCreateProgram creates a shader program and returns a GLuint reference to it.
-	program = glCreateProgram();
-	glAttachShader(program, vertex_shader);		// This attaches our vertex shader to our program.
-	glAttachShader(program, fragment_shader);	// This attaches our fragment shader to our program.
-
-	// This links the program, using the vertex and fragment shaders to create executables to run on the GPU.
-	glLinkProgram(program);
-	// End of shader and program creation
+	// Clear the screen to white. The clear color stays set, so every frame's glClear uses it.
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+
+	// Start loading the shaders before anything else, so that their files are read on other threads while we build the scene below.
+	// After the first run, each program's binary is cached (next to the scene), and it doesn't need compiling at all.
+	ShaderLoader shaders(".");
+
+	program = new ShaderProgram("Main");
+	program->AddStage(GL_VERTEX_SHADER, "VertexShader.glsl");
+	program->AddStage(GL_FRAGMENT_SHADER, "FragmentShader.glsl");
+	program->SetBlockBinding("Camera", VertexLayout::CAMERA_BINDING);
+	int mainShaders = program->Queue(shaders);
+
+	// Room for the camera, which renderScene fills in every frame.
+	glGenBuffers(1, &cameraBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, cameraBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// The cull shader is a compute shader, which runs on its own in a program of its own (see CullShader.glsl), and so are the depth
+	// pyramid's shader (see DepthPyramidShader.glsl), the GJK shader, for checking the narrowphase on the GPU (see GJKShader.glsl and
+	// checkNarrowphaseOnGPU), and the debris shader (see DebrisShader.glsl). The last two are both linked with GJKFunctions.glsl, which has
+	// the GJK test itself. They need OpenGL 4.3, and without it the objects get culled on the CPU instead (against the frustum alone), the
+	// narrowphase can't be checked, and there's no debris.
+	cullProgram = new ShaderProgram("Cull");
+	cullProgram->AddStage(GL_COMPUTE_SHADER, "CullShader.glsl");
+
+	pyramidProgram = new ShaderProgram("DepthPyramid");
+	pyramidProgram->AddStage(GL_COMPUTE_SHADER, "DepthPyramidShader.glsl");
+
+	gjkProgram = new ShaderProgram("GJK");
+	gjkProgram->AddStage(GL_COMPUTE_SHADER, "GJKShader.glsl");
+	gjkProgram->AddStage(GL_COMPUTE_SHADER, "GJKFunctions.glsl");
+
+	debrisProgram = new ShaderProgram("Debris");
+	debrisProgram->AddStage(GL_COMPUTE_SHADER, "DebrisShader.glsl");
+	debrisProgram->AddStage(GL_COMPUTE_SHADER, "GJKFunctions.glsl");
+
+	int cullShaders = -1;
+	int pyramidShaders = -1;
+	int gjkShaders = -1;
+	int debrisShaders = -1;
+
+	if (GLEW_VERSION_4_3)
+	{
+		cullShaders = cullProgram->Queue(shaders);
+		pyramidShaders = pyramidProgram->Queue(shaders);
+		gjkShaders = gjkProgram->Queue(shaders);
+		debrisShaders = debrisProgram->Queue(shaders);
+	}
+
+	shaders.Start();
+
+	// The scene is read from a file, rather than built here: the cube model, and the objects that are drawn with it.
+	Scene scene;
+
+	if (!scene.LoadText("Scene.txt"))
+	{
+		std::cout << scene.GetError() << std::endl;
+	}
+
+	int cubeModel = scene.FindModel("cube");
+
+	if (cubeModel == -1)
+	{
+		std::cout << "Scene.txt has no cube model, so it's a unit box." << std::endl;
+
+		scene.models.push_back(SceneModel());
+		scene.models.back().name = "cube";
+		BuildPrimitive(PRIMITIVE_BOX, scene.models.back());
+		cubeModel = (int)scene.models.size() - 1;
+	}
+
+	// The cube is stored compactly on the GPU (half float positions and 8 bit colors), which is less than half the size of a VertexFormat per vertex.
+	// Once it's been packed like that, it's saved in Cube.gjkm, and from then on it's loaded straight from that file into its buffers, without
+	// keeping a copy here (nothing else reads the cube's vertices). The file remembers a hash of the scene's cube, so if the scene changes,
+	// the cube is built and saved again. Its levels of detail are built along with it, and saved in the same file.
+	SceneModel& cubeData = scene.models[cubeModel];
+
+	unsigned long long cubeKey = HashBytes(cubeData.positions.data(), cubeData.positions.size() * sizeof(glm::vec3));
+	cubeKey = HashBytes(cubeData.colors.data(), cubeData.colors.size() * sizeof(glm::vec4), cubeKey);
+	cubeKey = HashBytes(cubeData.indices.data(), cubeData.indices.size() * sizeof(GLuint), cubeKey);
+
+	ModelFile cubeFile;
+
+	if (cubeFile.Open("Cube.gjkm") && cubeFile.GetSourceKey() == cubeKey && cubeFile.GetLayout() == VertexLayout::Compact())
+	{
+		cube = new Model(cubeFile);
+		cubeFile.Close();
+	}
+	else
+	{
+		// Turn the cube's vertices into the format we draw with.
+		for (int i = 0; i < (int)cubeData.positions.size(); i++)
+		{
+			vertices.push_back(VertexFormat(cubeData.positions[i], cubeData.colors[i]));
+		}
+
+		cubeFile.Close();
+
+		// Create our cube model from the calculated data.
+		cube = new Model(vertices.size(), vertices.data(), cubeData.indices.size(), cubeData.indices.data(), VertexLayout::Compact());
+		cube->GenerateLODs();
+
+		std::vector<ModelLOD> cubeLods(cube->NumLODs());
+
+		for (int i = 0; i < cube->NumLODs(); i++)
+		{
+			cubeLods[i] = cube->GetLOD(i);
+		}
+
+		ModelFile::Save("Cube.gjkm", vertices.data(), (int)vertices.size(), cubeData.indices.data(), (int)cubeData.indices.size(), VertexLayout::Compact(),
+			cubeKey, cubeLods.data(), (int)cubeLods.size(), cube->LODIndices().data(), (int)cube->LODIndices().size());
+	}
+
+	// Then put it in the model pool, which is what we actually draw it from.
+	modelPool = new ModelPool(cube->Layout());
+	modelPool->Add(cube);
+
+	// The shader files have probably been read by now, so get them compiling while we set up the rest.
+	shaders.Update();
+
+	// The overlay has its own vertices, but draws them with the same shaders.
+	overlay = new PerformanceOverlay();
+	debugDraw = new DebugDraw();
+
+	// The physics world, with one thread per hardware thread, counting this one.
+	world = new PhysicsWorld();
 
-	// This gets us a reference to the uniform variable in the vertex shader, which is called "MVP".
-	// We're using this variable as a 4x4 transformation matrix
-	// Only 2 parameters required: A reference to the shader program and the name of the uniform variable within the shader code.
-	uniMVP = glGetUniformLocation(program, "MVP");
+	// The render jobs (see renderJobs), up to 4 threads counting this one when the world's are busy on the physics thread.
+	if (threadedPhysics)
+	{
+		renderJobs = new JobSystem(std::max(1, std::min(4, (int)std::thread::hardware_concurrency())));
+		renderJobsOwned = true;
+	}
+	else
+	{
+		renderJobs = world->GetJobSystem();
+	}
+
+	// Add the scene's bodies to the world (each with the box around its model, unless the scene gives it another), and a GameObject to draw each
+	// one with the cube model (note that they are all holding pointers to the cube, not actual copies of the cube vertex data). Once they're all in
+	// objects, obj1 and obj2 can point at the first two.
+	int first = AddSceneBodies(*world, scene.bodies.data(), (int)scene.bodies.size());
+
+	for (int i = 0; i < (int)scene.bodies.size(); i++)
+	{
+		objects.push_back(GameObject(cube, &world->Bodies(), world->GetBody(first + i)));
+	}
+
+	// The rest of the demo moves these two around, so make sure they're there even if the scene didn't have them.
+	while (objects.size() < 2)
+	{
+		int object = world->AddBox(glm::vec3(0.0f), glm::vec3(0.25f));
+
+		objects.push_back(GameObject(cube, &world->Bodies(), world->GetBody(object)));
+	}
+
+	// The stress cubes (if there are any) go in before obj1 and obj2 are pointed at, since adding them can move the objects.
+	float stressExtent = addStressCubes(cubeData);
+
+	obj1 = &objects[0];
+	obj2 = &objects[1];
+
+	// obj1 only ever turns on the spot, so it's kinematic: it's integrated (which is what turns it), but nothing it runs into can push it.
+	world->SetBodyType(0, BODY_KINEMATIC);
+
+	// Both of them spin, which helps illustrate how the OBB follows the object's orientation. This is the rate they used to be turned by hand
+	// at, a degree about their own x and y axes every step. Spinning about an axis of its own doesn't move that axis, so it's the same axis
+	// in world space the whole time.
+	glm::vec3 spin = glm::vec3(glm::radians(1.0f), glm::radians(1.0f), 0.0f) / (float)physicsStep;
+
+	obj1->SetAngularVelocity(world->Bodies().Orientation(obj1->GetBody()) * spin);
+	obj2->SetAngularVelocity(world->Bodies().Orientation(obj2->GetBody()) * spin);
+
+	for (int i = 0; i < (int)objects.size(); i++)
+	{
+		drawModels.push_back(modelPool->Find(objects[i].GetModel()));
+	}
+
+	// Wait for whatever's left of the shaders.
+	shaders.Finish();
+
+	if (!program->Take(shaders, mainShaders))
+	{
+		std::cout << program->GetError() << std::endl;
+	}
+
+	if (cullShaders != -1 && !cullProgram->Take(shaders, cullShaders))
+	{
+		std::cout << cullProgram->GetError() << std::endl << "Culling will be done on the CPU." << std::endl;
+	}
+
+	modelPool->SetCullProgram(*cullProgram);
+
+	if (pyramidShaders != -1 && !pyramidProgram->Take(shaders, pyramidShaders))
+	{
+		std::cout << pyramidProgram->GetError() << std::endl << "There won't be any occlusion culling." << std::endl;
+	}
+
+	depthPyramid = new DepthPyramid();
+	depthPyramid->SetProgram(*pyramidProgram);
+	modelPool->SetOcclusion(depthPyramid);
+
+	if (gjkShaders != -1 && !gjkProgram->Take(shaders, gjkShaders))
+	{
+		std::cout << gjkProgram->GetError() << std::endl << "The narrowphase can't be checked on the GPU." << std::endl;
+	}
+
+	gpuNarrowphase = new GPUNarrowphase();
+	gpuNarrowphase->SetProgram(*gjkProgram);
+
+	if (debrisShaders != -1 && !debrisProgram->Take(shaders, debrisShaders))
+	{
+		std::cout << debrisProgram->GetError() << std::endl << "There won't be any debris." << std::endl;
+	}
+
+	// The cube in Scene.txt goes out 0.25 from its center, which the debris is scaled down from.
+	debris = new GPUDebris(maxDebris, 0.25f);
+	debris->SetProgram(*debrisProgram);
+	lastDebrisStep = glfwGetTime();
+
+	lastShaderCheck = glfwGetTime();
+	// End of shader and program creation
 
 	// Creates the view matrix using glm::lookAt.
 	// First parameter is camera position, second parameter is point to be centered on-screen, and the third paramter is the up axis.
-	view = glm::lookAt(	glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	// In stress mode, the camera goes back far enough to see all of the stress cubes, and the overlay is shown.
+	view = glm::lookAt(	glm::vec3(0.0f, 0.0f, 2.0f + stressExtent * 3.5f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 
-	// Creates a projection matrix using glm::perspective.
-	// First parameter is the vertical FoV (Field of View), second paramter is the aspect ratio, 3rd parameter is the near clipping plane, 4th parameter is the far clipping plane.
-	proj = glm::perspective(45.0f, 800.0f / 600.0f, 0.1f, 100.0f);
+	if (stressCount > 0)
+	{
+		overlay->SetVisible(true);
+	}
 
-	// Allows us to make one less calculation per frame, as long as we don't update the projection and view matrices every frame.
-	PV = proj * view;
+	// The projection depends on the window's shape, so it (and PV) are made by updateCamera, starting from the size the window was created at.
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	updateCamera();
+
+	renderTarget = new RenderTarget();
+
+	// Everything starts out where it was placed, rather than blending in from the origin.
+	world->Bodies().SavePrevious();
 
-	// Create your MVP matrices based on the objects' transforms.
-	MVP = PV * *obj1->GetTransform();
-	MVP2 = PV * *obj2->GetTransform();
+	// Find the visible objects and their transforms.
+	updateTransforms();
 
 	// This is not necessary, but I prefer to handle my vertices in the clockwise order. glFrontFace defines which face of the triangles you're drawing is the front.
 	// Essentially, if you draw your vertices in counter-clockwise order, by default (in OpenGL) the front face will be facing you/the screen. If you draw them clockwise, the front face 
@@ -737,16 +1380,89 @@ int main(int argc, char **argv)
 
 	// Makes the OpenGL context current for the created window.
 	glfwMakeContextCurrent(window);
-	
-	// Sets the number of screen updates to wait before swapping the buffers.
-	// Setting this to zero will disable VSync, which allows us to actually get a read on our FPS. Otherwise we'd be consistently getting 60FPS or lower, 
-	// since it would match our FPS to the screen refresh rate.
-	// Set to 1 to enable VSync.
-	glfwSwapInterval(0);
+
+	// Tells GLFW to call keyCallback whenever a key is pressed, and framebufferSizeCallback whenever the window is resized.
+	glfwSetKeyCallback(window, keyCallback);
+	glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+
+	// The stress cubes go in with the rest of the scene, so init has to know how many there are.
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (strcmp(argv[i], "--stress") == 0)
+		{
+			stressCount = std::max(0, atoi(argv[i + 1]));
+		}
+	}
 
 	// Initializes most things needed before the main loop
 	init();
 
+	// Sets the number of screen updates to wait before swapping the buffers (see FramePacer).
+	// Uncapped disables VSync, which allows us to actually get a read on our FPS. Otherwise we'd be consistently getting 60FPS or lower, 
+	// since it would match our FPS to the screen refresh rate. The others save power, and V switches between them while running.
+	framePacer = new FramePacer();
+	gpuTimer = new GPUTimer();
+	FramePacing pacing = PACING_UNCAPPED;
+
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (strcmp(argv[i], "--record") == 0 && !recorder.Open(argv[i + 1]))
+		{
+			std::cout << "Couldn't create the recording " << argv[i + 1] << "." << std::endl;
+		}
+
+		if (strcmp(argv[i], "--flight-recorder") == 0)
+		{
+			flightRecorder.SetSpikeDumps(argv[i + 1], physicsStep * 2.0);
+		}
+
+		if (strcmp(argv[i], "--pacing") == 0)
+		{
+			const char* names[NUM_FRAME_PACINGS] = { "uncapped", "vsync", "adaptive", "capped" };
+
+			for (int p = 0; p < NUM_FRAME_PACINGS; p++)
+			{
+				if (strcmp(argv[i + 1], names[p]) == 0)
+				{
+					pacing = (FramePacing)p;
+				}
+			}
+		}
+
+		if (strcmp(argv[i], "--fps-cap") == 0)
+		{
+			fpsCap = atof(argv[i + 1]);
+			pacing = PACING_CAPPED;
+		}
+
+		if (strcmp(argv[i], "--render-scale") == 0)
+		{
+			float scale = (float)atof(argv[i + 1]);
+			renderScale = scale < 0.25f ? 0.25f : (scale > 1.0f ? 1.0f : scale);
+		}
+
+		// Starts the scene that many physics steps in, run back to back before the first frame (see PhysicsWorld::Advance), the way a
+		// server would catch up. None of them are recorded.
+		if (strcmp(argv[i], "--fast-forward") == 0)
+		{
+			world->Advance(atoi(argv[i + 1]), (float)physicsStep);
+		}
+	}
+
+	framePacer->SetPacing(pacing, fpsCap);
+
+	// Start recording the profiled zones and counters, so there's something to capture when P is pressed.
+	Profiler::Get().SetEnabled(true);
+
+	// Start the physics thread, with a first snapshot for the renderer to draw until the physics gets going.
+	if (threadedPhysics)
+	{
+		publishSnapshot(physicsClock.Now());
+
+		physicsRunning = true;
+		physicsThread = std::thread(physicsLoop);
+	}
+
 	// Enter the main loop.
 	while (!glfwWindowShouldClose(window))
 	{
@@ -756,26 +1472,72 @@ int main(int argc, char **argv)
 		// Call the render function.
 		renderScene();
 
+		// Send the latest pairs to the GPU, if it's checking the narrowphase.
+		checkNarrowphaseOnGPU();
+
+		// Pick up any changes to the shaders.
+		reloadShaders();
+
 		// Swaps the back buffer to the front buffer
 		// Remember, you're rendering to the back buffer, then once rendering is complete, you're moving the back buffer to the front so it can be displayed.
 		glfwSwapBuffers(window);
+		framePacer->Presented();
+
+		// Delete the GPU objects of every model (and anything else) that was let go of this frame, on any thread, all together.
+		GetGPUDeletionQueue().Flush();
+
+		// Add up what every profiled zone and counter did this frame (on every thread), and start on the next one, and show it in the overlay.
+		Profiler::Get().EndFrame();
+		overlay->Update(world->GetBroadphaseName(currentBroadphase), framePacer->GetName(), scheduler.GetCounters());
 
-		// Add one to our frame counter, since we've successfully 
-		frame++;
+		// If frames are capped, wait for the next one here, before the input is polled, so what it draws is as fresh as it can be.
+		framePacer->Wait();
 
 		// Checks to see if any events are pending and then processes them.
 		glfwPollEvents();
+		framePacer->InputPolled();
+	}
+
+	// Let the physics thread finish the step it's on before anything it uses goes away.
+	if (threadedPhysics)
+	{
+		physicsRunning = false;
+		physicsThread.join();
+	}
+
+	if (recorder.IsOpen() && !recorder.Close())
+	{
+		std::cout << "Couldn't finish writing the recording." << std::endl;
 	}
 
 	// After the program is over, cleanup your data!
-	glDeleteShader(vertex_shader);
-	glDeleteShader(fragment_shader);
-	glDeleteProgram(program);
 	// Note: If at any point you stop using a "program" or shaders, you should free the data up then and there.
+	delete(program);
+	delete(cullProgram);
+	delete(pyramidProgram);
+	delete(gjkProgram);
+	delete(debrisProgram);
+
+	delete(gpuNarrowphase);
+	delete(debris);
+	delete(depthPyramid);
+	delete(overlay);
+	delete(renderTarget);
+	delete(framePacer);
+	delete(gpuTimer);
+	if (renderJobsOwned)
+	{
+		delete(renderJobs);
+	}
+
+	// The objects and the pool each hold a reference to the cube, so it goes with the last of these, and then its buffers go with the
+	// rest of what's waiting, while there's still a context to delete them in.
+	objects.clear();
+	delete(world);
+	delete(modelPool);
+	cube->Release();
 
-	delete(obj1);
-	delete(obj2);
-	delete(cube);
+	GetGPUDeletionQueue().Flush();
 
 	// Frees up GLFW memory
 	glfwTerminate();
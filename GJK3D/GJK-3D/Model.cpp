@@ -37,16 +37,44 @@ since they are aligned on the same axis.
 #define _MODEL_CPP
 
 #include "Model.h"
+#include "GPUDeletionQueue.h"
+#include "MemoryTracker.h"
+#include "MeshSimplify.h"
+#include <algorithm>
 
 // Creates a new model with a given vertices and indices.
-// If no vertices are passed in (numVerts = 0) then it will skip initialization completely.
+// If no vertices are passed in (numVerts = 0) then it starts out empty.
 // If no indices are passed in (numInds = 0) but vertices are, it will set the indices equal to the vertices in order. (So just 0, 1, 2, 3, 4, etc.)
-Model::Model(int numVerts, VertexFormat* verts, int numInds, GLuint* inds)
+Model::Model(int numVerts, VertexFormat* verts, int numInds, GLuint* inds, const VertexLayout& vertexLayout)
 {
+	references.store(1, std::memory_order_relaxed);
+	layout = vertexLayout;
+
+	vao = 0;
+	vbo = 0;
+	ebo = 0;
+
+	vertices = nullptr;
+	numVertices = 0;
+	vertexCapacity = 0;
+	indices = nullptr;
+	numIndices = 0;
+	indexCapacity = 0;
+	dirtyVertexBegin = dirtyVertexEnd = 0;
+	dirtyIndexBegin = dirtyIndexEnd = 0;
+	gpuVertexCapacity = 0;
+	gpuIndexCapacity = 0;
+	indexType = GL_UNSIGNED_INT;
+	hasCPUCopy = true;
+	boundsMin = glm::vec3(0.0f);
+	boundsMax = glm::vec3(0.0f);
+
 	if (numVerts > 0)
 	{
 		// Allocate space for the size of the vertices array.
 		vertices = (VertexFormat*)malloc(sizeof(VertexFormat) * numVerts);
+		vertexCapacity = numVerts;
+		TrackAllocation(MEMORY_MODELS, sizeof(VertexFormat) * numVerts);
 
 		// Copy the data from the passed in verts to the vertices array.
 		memcpy(vertices, verts, sizeof(VertexFormat) * numVerts);
@@ -58,6 +86,8 @@ Model::Model(int numVerts, VertexFormat* verts, int numInds, GLuint* inds)
 		{
 			// Allocate space for the size of the indices array.
 			indices = (GLuint*)malloc(sizeof(GLuint) * numInds);
+			indexCapacity = numInds;
+			TrackAllocation(MEMORY_MODELS, sizeof(GLuint) * numInds);
 
 			// Copy the data from the passed in inds to the indices array.
 			memcpy(indices, inds, sizeof(GLuint) * numInds);
@@ -69,6 +99,8 @@ Model::Model(int numVerts, VertexFormat* verts, int numInds, GLuint* inds)
 		{
 			// Allocate space for enough indices to have one index per vertex.
 			indices = (GLuint*)malloc(sizeof(GLuint) * numVerts);
+			indexCapacity = numVerts;
+			TrackAllocation(MEMORY_MODELS, sizeof(GLuint) * numVerts);
 
 			// Loop through and set each index to be in sequential order. (0, 1, 2, 3, 4, etc.)
 			for (int i = 0; i < numVerts; i++)
@@ -80,26 +112,120 @@ Model::Model(int numVerts, VertexFormat* verts, int numInds, GLuint* inds)
 			numIndices = numVerts;
 		}
 
-		// Initialize the buffer.
-		InitBuffer();
+		// The buffers get created the first time the model is drawn, so a model that's only ever drawn through a ModelPool never makes its own.
+		MarkVerticesDirty(0, numVertices);
+		MarkIndicesDirty(0, numIndices);
+	}
+}
+
+Model::Model(const ModelFile& file, bool keepCPUCopy)
+{
+	references.store(1, std::memory_order_relaxed);
+	layout = file.GetLayout();
+
+	numVertices = file.NumVertices();
+	numIndices = file.NumIndices();
+	dirtyVertexBegin = dirtyVertexEnd = 0;
+	dirtyIndexBegin = dirtyIndexEnd = 0;
+	file.GetBounds(boundsMin, boundsMax);
+	indexType = file.IndexSize() == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	// The buffers are made right away, straight from the mapping, with exactly enough room. The file's vertices were packed for a buffer
+	// with room for just them, so they go in as they are, even when they aren't interleaved.
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, file.GetVerticesSize(), file.GetVertices(), GL_STATIC_DRAW);
+	gpuVertexCapacity = numVertices;
+	layout.SetAttributes(gpuVertexCapacity);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexSize() * numIndices, file.GetIndices(), GL_STATIC_DRAW);
+	gpuIndexCapacity = numIndices;
+
+	TrackAllocation(MEMORY_GPU, layout.VertexSize() * gpuVertexCapacity);
+	TrackAllocation(MEMORY_GPU, indexSize() * gpuIndexCapacity);
+
+	glBindVertexArray(0);
+
+	lods.assign(file.GetLODs(), file.GetLODs() + file.NumLODs());
+	lodIndices.assign(file.GetLODIndices(), file.GetLODIndices() + file.NumLODIndices());
+
+	instances.Reserve(sizeof(glm::mat4));
+	setInstanceAttributes();
+
+	vertices = nullptr;
+	vertexCapacity = 0;
+	indices = nullptr;
+	indexCapacity = 0;
+	hasCPUCopy = keepCPUCopy;
+
+	if (keepCPUCopy)
+	{
+		// Only now do the vertices get unpacked, for whatever needs to read them. (They come back as they were stored, so half float
+		// positions stay rounded to half floats.)
+		vertices = (VertexFormat*)malloc(sizeof(VertexFormat) * numVertices);
+		vertexCapacity = numVertices;
+		TrackAllocation(MEMORY_MODELS, sizeof(VertexFormat) * numVertices);
+		layout.Unpack(file.GetVertices(), numVertices, vertices);
+
+		indices = (GLuint*)malloc(sizeof(GLuint) * numIndices);
+		indexCapacity = numIndices;
+		TrackAllocation(MEMORY_MODELS, sizeof(GLuint) * numIndices);
+
+		if (indexType == GL_UNSIGNED_SHORT)
+		{
+			const GLushort* fileIndices = (const GLushort*)file.GetIndices();
+			std::copy(fileIndices, fileIndices + numIndices, indices);
+		}
+		else
+		{
+			memcpy(indices, file.GetIndices(), sizeof(GLuint) * numIndices);
+		}
 	}
 }
 
 Model::~Model()
 {
 	// Free up any remaining data.
+	TrackFree(MEMORY_MODELS, sizeof(VertexFormat) * vertexCapacity);
+	TrackFree(MEMORY_MODELS, sizeof(GLuint) * indexCapacity);
+	TrackFree(MEMORY_GPU, layout.VertexSize() * gpuVertexCapacity);
+	TrackFree(MEMORY_GPU, indexSize() * gpuIndexCapacity);
+
 	free(vertices);
 	free(indices);
 
 	numVertices = 0;
 	numIndices = 0;
-
-	glDeleteBuffers(1, &vbo);
-	glDeleteBuffers(1, &ebo);
+	vertexCapacity = 0;
+	indexCapacity = 0;
+
+	// This could be any thread, so the render thread deletes them at the end of the frame. (The instance buffer does the same with its own.)
+	GPUDeletionQueue& deletions = GetGPUDeletionQueue();
+	deletions.DeleteBuffer(vbo);
+	deletions.DeleteBuffer(ebo);
+	deletions.DeleteVertexArray(vao);
 }
 
 void Model::InitBuffer()
 {
+	// If the buffers are already set up, they just need the new data.
+	if (vao != 0)
+	{
+		UpdateBuffer();
+		return;
+	}
+
+	// First create our vertex array object and bind it. Everything we set up below (the buffer bindings and the attribute pointers) gets
+	// recorded into it, rather than into whatever happened to be bound before.
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
 	// This generates buffer object names
 	// The first parameter is the number of buffer objects, and the second parameter is a pointer to an array of buffer objects (yes, before this call, vbo was an empty variable)
 	// (In this example, there's only one buffer object.)
@@ -116,52 +242,169 @@ void Model::InitBuffer()
 	//// GL_ELEMENT_ARRAY_BUFFER is for vertex array indices, all drawing commands of glDrawElements will use indices from that buffer.
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 
-	//// Creates and initializes a buffer object's data.
-	//// First parameter is the target, second parameter is the size of the buffer, third parameter is a pointer to the data that will copied into the buffer, and fourth parameter is the 
-	//// expected usage pattern of the data. Possible usage patterns: GL_STREAM_DRAW, GL_STREAM_READ, GL_STREAM_COPY, GL_STATIC_DRAW, GL_STATIC_READ, GL_STATIC_COPY, GL_DYNAMIC_DRAW, 
-	//// GL_DYNAMIC_READ, or GL_DYNAMIC_COPY
-	//// Stream means that the data will be modified once, and used only a few times at most. Static means that the data will be modified once, and used a lot. Dynamic means that the data 
-	//// will be modified repeatedly, and used a lot. Draw means that the data is modified by the application, and used as a source for GL drawing. Read means the data is modified by 
-	//// reading data from GL, and used to return that data when queried by the application. Copy means that the data is modified by reading from the GL, and used as a source for drawing.
-	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexFormat) * numVertices, vertices, GL_STATIC_DRAW);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * numIndices, indices, GL_STATIC_DRAW);
-
-	//// By default, all client-side capabilities are disabled, including all generic vertex attribute arrays.
-	//// When enabled, the values in a generic vertex attribute array will be accessed and used for rendering when calls are made to vertex array commands (like glDrawArrays/glDrawElements)
-	//// A GL_INVALID_VALUE will be generated if the index parameter is greater than or equal to GL_MAX_VERTEX_ATTRIBS
-	glEnableVertexAttribArray(0);
-
-	//// Defines an array of generic vertex attribute data. Takes an index, a size specifying the number of components (in this case, floats)(has a max of 4)
-	//// The third parameter, type, can be GL_BYTE, GL_UNSIGNED_BYTE, GL_SHORT, GL_UNSIGNED_SHORT, GL_FIXED, or GL_FLOAT
-	//// The fourth parameter specifies whether to normalize fixed-point data values, the fifth parameter is the stride which is the offset (in bytes) between generic vertex attributes
-	//// The fifth parameter is a pointer to the first component of the first generic vertex attribute in the array. If a named buffer object is bound to GL_ARRAY_BUFFER (and it is, in this case) 
-	//// then the pointer parameter is treated as a byte offset into the buffer object's data.
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexFormat), (void*)16);
-	//// You'll note sizeof(VertexFormat) is our stride, because each vertex contains data that adds up to that size.
-	//// You'll also notice we offset this parameter by 16 bytes, this is because the vec3 position attribute is after the vec4 color attribute. A vec4 has 4 floats, each being 4 bytes 
-	//// so we offset by 4*4=16 to make sure that our first attribute is actually the position. The reason we put position after color in the struct has to do with padding.
-	//// For more info on padding, Google it.
-
-	//// This is our color attribute, so the offset is 0, and the size is 4 since there are 4 floats for color.
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(VertexFormat), (void*)0);
+	// The buffers don't have any room yet, so this first upload creates them at the right size.
+	gpuVertexCapacity = 0;
+	gpuIndexCapacity = 0;
+	MarkVerticesDirty(0, numVertices);
+	MarkIndicesDirty(0, numIndices);
+	UpdateBuffer();
+
+	// Then the per-instance transform for DrawInstanced. Start with room for one, and it'll grow as needed.
+	instances.Reserve(sizeof(InstanceTransform));
+	setInstanceAttributes();
+}
+
+void Model::setInstanceAttributes()
+{
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, instances.GetBuffer());
+	VertexLayout::SetInstanceAttributes();
+
+	glBindVertexArray(0);
 }
 
 void Model::UpdateBuffer()
 {
-	//// Creates and initializes a buffer object's data.
-	//// First parameter is the target, second parameter is the size of the buffer, third parameter is a pointer to the data that will copied into the buffer, and fourth parameter is the 
-	//// expected usage pattern of the data. Possible usage patterns: GL_STREAM_DRAW, GL_STREAM_READ, GL_STREAM_COPY, GL_STATIC_DRAW, GL_STATIC_READ, GL_STATIC_COPY, GL_DYNAMIC_DRAW, 
-	//// GL_DYNAMIC_READ, or GL_DYNAMIC_COPY
-	//// Stream means that the data will be modified once, and used only a few times at most. Static means that the data will be modified once, and used a lot. Dynamic means that the data 
-	//// will be modified repeatedly, and used a lot. Draw means that the data is modified by the application, and used as a source for GL drawing. Read means the data is modified by 
-	//// reading data from GL, and used to return that data when queried by the application. Copy means that the data is modified by reading from the GL, and used as a source for drawing.
-	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexFormat) * numVertices, vertices, GL_STATIC_DRAW);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * numIndices, indices, GL_STATIC_DRAW);
+	// Make sure we're updating our own buffers. The element buffer is part of the vao, so binding the vao binds it.
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+	// If there are more vertices than the buffer has room for, it has to be made bigger, which throws away what was in it.
+	// Like the arrays on our side, we at least double it, so growing a little at a time doesn't mean reallocating it every time.
+	if (numVertices > gpuVertexCapacity)
+	{
+		int oldCapacity = gpuVertexCapacity;
+
+		gpuVertexCapacity = numVertices > gpuVertexCapacity * 2 ? numVertices : gpuVertexCapacity * 2;
+		TrackResize(MEMORY_GPU, layout.VertexSize() * oldCapacity, layout.VertexSize() * gpuVertexCapacity);
+
+		//// Creates and initializes a buffer object's data.
+		//// First parameter is the target, second parameter is the size of the buffer, third parameter is a pointer to the data that will copied into the buffer, and fourth parameter is the 
+		//// expected usage pattern of the data. Possible usage patterns: GL_STREAM_DRAW, GL_STREAM_READ, GL_STREAM_COPY, GL_STATIC_DRAW, GL_STATIC_READ, GL_STATIC_COPY, GL_DYNAMIC_DRAW, 
+		//// GL_DYNAMIC_READ, or GL_DYNAMIC_COPY
+		//// Stream means that the data will be modified once, and used only a few times at most. Static means that the data will be modified once, and used a lot. Dynamic means that the data 
+		//// will be modified repeatedly, and used a lot. Draw means that the data is modified by the application, and used as a source for GL drawing. Read means the data is modified by 
+		//// reading data from GL, and used to return that data when queried by the application. Copy means that the data is modified by reading from the GL, and used as a source for drawing.
+		//// We pass nullptr for the data, which just makes room. The vertices get copied in below.
+		glBufferData(GL_ARRAY_BUFFER, layout.VertexSize() * gpuVertexCapacity, nullptr, GL_STATIC_DRAW);
+
+		//// By default, all client-side capabilities are disabled, including all generic vertex attribute arrays.
+		//// When enabled, the values in a generic vertex attribute array will be accessed and used for rendering when calls are made to vertex array commands (like glDrawArrays/glDrawElements)
+		//// glVertexAttribPointer then defines an array of generic vertex attribute data: which type each component is, whether to normalize fixed-point values, the stride
+		//// (the offset in bytes between one vertex's attribute and the next), and the offset of the first one in the buffer.
+		//// The layout knows all of that for each of our attributes (position, color and maybe a normal), so it sets them up for us.
+		//// (Without interleaving, where each attribute starts depends on the size of the buffer, which is why this happens here.)
+		layout.SetAttributes(gpuVertexCapacity);
+
+		// Everything has to go into the new buffer.
+		dirtyVertexBegin = 0;
+		dirtyVertexEnd = numVertices;
+	}
+
+	// 16 bit indices can only reach the first 65536 vertices. If the model's grown past that, every index goes up again as 32 bits, in a
+	// new buffer.
+	GLenum neededType = numVertices <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	size_t oldIndexBytes = indexSize() * gpuIndexCapacity;
+
+	if (neededType != indexType)
+	{
+		indexType = neededType;
+		gpuIndexCapacity = 0;
+	}
+
+	if (numIndices > gpuIndexCapacity)
+	{
+		gpuIndexCapacity = numIndices > gpuIndexCapacity * 2 ? numIndices : gpuIndexCapacity * 2;
+		TrackResize(MEMORY_GPU, oldIndexBytes, indexSize() * gpuIndexCapacity);
+
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexSize() * gpuIndexCapacity, nullptr, GL_STATIC_DRAW);
+
+		dirtyIndexBegin = 0;
+		dirtyIndexEnd = numIndices;
+	}
+
+	// Then only copy over the vertices and indices that changed. (The vertices are converted into the model's layout on the way, which
+	// might be smaller than a VertexFormat.)
+	layout.Upload(vertices, dirtyVertexBegin, dirtyVertexEnd - dirtyVertexBegin, gpuVertexCapacity);
+
+	if (dirtyIndexEnd > dirtyIndexBegin && indexType == GL_UNSIGNED_SHORT)
+	{
+		shortIndices.assign(indices + dirtyIndexBegin, indices + dirtyIndexEnd);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * dirtyIndexBegin, sizeof(GLushort) * shortIndices.size(), shortIndices.data());
+	}
+	else if (dirtyIndexEnd > dirtyIndexBegin)
+	{
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * dirtyIndexBegin, sizeof(GLuint) * (dirtyIndexEnd - dirtyIndexBegin), indices + dirtyIndexBegin);
+	}
+
+	// Unbind the vao, so nothing else changes it by accident.
+	glBindVertexArray(0);
+
+	dirtyVertexBegin = dirtyVertexEnd = 0;
+	dirtyIndexBegin = dirtyIndexEnd = 0;
+}
+
+void Model::MarkVerticesDirty(int first, int count)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// We only keep one range, so if there's already one, it grows to cover both.
+	if (dirtyVertexEnd > dirtyVertexBegin)
+	{
+		dirtyVertexBegin = dirtyVertexBegin < first ? dirtyVertexBegin : first;
+		dirtyVertexEnd = dirtyVertexEnd > first + count ? dirtyVertexEnd : first + count;
+	}
+	else
+	{
+		dirtyVertexBegin = first;
+		dirtyVertexEnd = first + count;
+	}
+}
+
+void Model::MarkIndicesDirty(int first, int count)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	if (dirtyIndexEnd > dirtyIndexBegin)
+	{
+		dirtyIndexBegin = dirtyIndexBegin < first ? dirtyIndexBegin : first;
+		dirtyIndexEnd = dirtyIndexEnd > first + count ? dirtyIndexEnd : first + count;
+	}
+	else
+	{
+		dirtyIndexBegin = first;
+		dirtyIndexEnd = first + count;
+	}
+}
+
+void Model::SetVertices(int first, const VertexFormat* verts, int count)
+{
+	memcpy(vertices + first, verts, sizeof(VertexFormat) * count);
+
+	MarkVerticesDirty(first, count);
+}
+
+void Model::SetIndices(int first, const GLuint* inds, int count)
+{
+	memcpy(indices + first, inds, sizeof(GLuint) * count);
+
+	MarkIndicesDirty(first, count);
 }
 
 void Model::Draw()
 {
+	// Upload anything that's been added since the last draw.
+	flushBuffers();
+
+	// Binding the vao brings back our buffers and attributes all at once.
+	glBindVertexArray(vao);
+
 	// Draw vertices from the buffer as GL_TRIANGLES
 	// There are several different drawing modes, GL_TRIANGLES takes every 3 vertices and makes them a triangle.
 	// For reference, GL_TRIANGLE_STRIP would take each additional vertex after the first 3 and consider that a 
@@ -176,99 +419,225 @@ void Model::Draw()
 	// For reference, GL_TRIANGLE_STRIP would take each additional vertex after the first 3 and consider that a 
 	// triangle with the previous 2 vertices (so you could make 2 triangles with 4 vertices)
 	// The second parameter is the number of vertices, the third parameter is the type of the element buffer data, and the fourth parameter is the offset.
-	glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0);
+	glDrawElements(GL_TRIANGLES, numIndices, indexType, 0);
+
+	glBindVertexArray(0);
 }
 
-GLuint Model::AddVertex(VertexFormat* vert)
+void Model::DrawInstanced(const InstanceTransform* transforms, int count)
 {
-	if (numVertices > 0)
+	if (count <= 0)
 	{
-		// Allocate space equivalent to our current vertices array.
-		VertexFormat* tempVerts = (VertexFormat*)malloc(sizeof(VertexFormat) * numVertices);
-		
-		// Copy our current vertices array into our temporary array.
-		memcpy(tempVerts, vertices, numVertices);
-
-		// Increase the number of vertices count by 1.
-		numVertices++;
-
-		// Free the vertices array.
-		free(vertices);
+		return;
+	}
 
-		// Allocate space equivalent to our new vertices size.
-		vertices = (VertexFormat*)malloc(sizeof(VertexFormat) * numVertices);
+	flushBuffers();
 
-		// Copy the data from the temporary array back into the vertices array.
-		memcpy(vertices, tempVerts, numVertices - 1);
+	GLsizeiptr size = sizeof(InstanceTransform) * count;
 
-		// Free the temporary array.
-		free(tempVerts);
+	// If there are more transforms than fit, the instance buffer gets recreated, and the attributes have to point at the new one.
+	if (instances.Reserve(size, sizeof(InstanceTransform)))
+	{
+		setInstanceAttributes();
+	}
 
-		// Set the last value in the vertices array to the new vertex.
-		vertices[numVertices - 1] = *vert;
+	// Copy this draw's transforms into the next part of the instance buffer.
+	GLsizeiptr offset = instances.Write(transforms, size, sizeof(InstanceTransform));
 
-		// Update our buffer to match this change.
-		UpdateBuffer();
+	// Then draw every instance at once. This is the same as Draw, only the last parameter is how many copies to draw.
+	// The transforms might not be at the start of the buffer, but the base instance tells the instanced attributes where to start reading.
+	glBindVertexArray(vao);
 
-		// Return the index reference to this vertex.
-		return numVertices - 1;
+	if (offset == 0)
+	{
+		glDrawElementsInstanced(GL_TRIANGLES, numIndices, indexType, 0, count);
 	}
 	else
 	{
-		// Create a new vertices array of size 1.
-		vertices = (VertexFormat*)malloc(sizeof(VertexFormat));
+		glDrawElementsInstancedBaseInstance(GL_TRIANGLES, numIndices, indexType, 0, count, (GLuint)(offset / sizeof(InstanceTransform)));
+	}
+
+	glBindVertexArray(0);
 
-		// Set the value to the new vertex.
-		vertices[0] = *vert;
+	// Once the GPU gets past this draw, that part of the buffer is free to be written again.
+	instances.Fence();
+}
 
-		// Set the number of vertices to 1.
-		numVertices = 1;
+void Model::ReserveVertices(int count)
+{
+	if (count <= vertexCapacity)
+	{
+		return;
+	}
 
-		// Initialize the buffer.
-		InitBuffer();
+	// Grow to at least double what we had, so that adding vertices one at a time only reallocates every so often (log n times for n
+	// vertices) instead of every time. realloc keeps whatever was already there.
+	int newCapacity = vertexCapacity * 2 > count ? vertexCapacity * 2 : count;
 
-		// Return the index reference to this vertex (zero).
-		return 0;
+	vertices = (VertexFormat*)realloc(vertices, sizeof(VertexFormat) * newCapacity);
+	TrackResize(MEMORY_MODELS, sizeof(VertexFormat) * vertexCapacity, sizeof(VertexFormat) * newCapacity);
+	vertexCapacity = newCapacity;
+}
+
+void Model::ReserveIndices(int count)
+{
+	if (count <= indexCapacity)
+	{
+		return;
 	}
+
+	// Same as ReserveVertices.
+	int newCapacity = indexCapacity * 2 > count ? indexCapacity * 2 : count;
+
+	indices = (GLuint*)realloc(indices, sizeof(GLuint) * newCapacity);
+	TrackResize(MEMORY_MODELS, sizeof(GLuint) * indexCapacity, sizeof(GLuint) * newCapacity);
+	indexCapacity = newCapacity;
 }
+
+GLuint Model::AddVertex(VertexFormat* vert)
+{
+	return AddVertices(vert, 1);
+}
+
+GLuint Model::AddVertices(const VertexFormat* verts, int count)
+{
+	GLuint first = numVertices;
+
+	// Make room for them (if there isn't already) and copy them onto the end.
+	ReserveVertices(numVertices + count);
+	memcpy(vertices + numVertices, verts, sizeof(VertexFormat) * count);
+	// Rather than uploading the buffer after every vertex, we just remember which ones changed, and upload them once the next time we draw.
+	MarkVerticesDirty(numVertices, count);
+	numVertices += count;
+
+	// Return the index reference to the first new vertex.
+	return first;
+}
+
 void Model::AddIndex(GLuint index)
 {
-	if (numIndices > 0)
+	AddIndices(&index, 1);
+}
+
+void Model::AddIndices(const GLuint* inds, int count)
+{
+	ReserveIndices(numIndices + count);
+	memcpy(indices + numIndices, inds, sizeof(GLuint) * count);
+	MarkIndicesDirty(numIndices, count);
+	numIndices += count;
+}
+
+void Model::flushBuffers()
+{
+	if (dirtyVertexEnd == dirtyVertexBegin && dirtyIndexEnd == dirtyIndexBegin)
+	{
+		return;
+	}
+
+	// A model that started out empty hasn't made its buffers yet.
+	if (vao == 0)
+	{
+		InitBuffer();
+	}
+	else
+	{
+		UpdateBuffer();
+	}
+}
+
+
+void Model::ReleaseCPUCopy()
+{
+	if (!hasCPUCopy)
 	{
-		// Allocate space equivalent to our current indices array.
-		GLuint* tempInds = (GLuint*)malloc(sizeof(GLuint) * numIndices);
+		return;
+	}
 
-		// Copy our current indices array into our temporary array.
-		memcpy(tempInds, indices, numIndices);
+	// Make sure the buffers have everything first, since they're about to be all there is. (A model that's only been drawn through a
+	// ModelPool won't have made them yet.)
+	if (vao == 0)
+	{
+		InitBuffer();
+	}
+	else
+	{
+		flushBuffers();
+	}
 
-		// Increase the number of indices count by 1.
-		numIndices++;
+	// Keep the bounds while we still have the vertices to work them out from.
+	CalculateBounds(boundsMin, boundsMax);
 
-		// Free the indices array.
-		free(indices);
+	TrackFree(MEMORY_MODELS, sizeof(VertexFormat) * vertexCapacity);
+	TrackFree(MEMORY_MODELS, sizeof(GLuint) * indexCapacity);
 
-		// Allocate space equivalent to our new indices size.
-		indices = (GLuint*)malloc(sizeof(GLuint) * numIndices);
+	free(vertices);
+	free(indices);
 
-		// Copy the data from the temporary array back into the indices array.
-		memcpy(indices, tempInds, numIndices - 1);
+	vertices = nullptr;
+	indices = nullptr;
+	vertexCapacity = 0;
+	indexCapacity = 0;
+	hasCPUCopy = false;
+}
 
-		// Free the temporary array.
-		free(tempInds);
+int Model::GenerateLODs(int maxLevels)
+{
+	lods.clear();
+	lodIndices.clear();
 
-		// Set the last value in the indices array to the new index.
-		indices[numIndices - 1] = index;
+	if (!hasCPUCopy)
+	{
+		return 0;
 	}
-	else
+
+	std::vector<glm::vec3> positions(numVertices);
+
+	for (int i = 0; i < numVertices; i++)
 	{
-		// Create a new indices array of size 1.
-		indices = (GLuint*)malloc(sizeof(GLuint));
+		positions[i] = vertices[i].position;
+	}
+
+	std::vector<MeshLOD> levels;
+	BuildMeshLODs(positions.data(), numVertices, indices, numIndices, maxLevels, levels);
+
+	// All of the levels go one after another in the same indices.
+	for (int i = 0; i < (int)levels.size(); i++)
+	{
+		ModelLOD lod;
+		lod.firstIndex = (int)lodIndices.size();
+		lod.numIndices = (int)levels[i].indices.size();
+		lod.error = levels[i].error;
 
-		// Set the value to the new index.
-		indices[0] = index;
+		lods.push_back(lod);
+		lodIndices.insert(lodIndices.end(), levels[i].indices.begin(), levels[i].indices.end());
+	}
 
-		// Set the numIndices to 1.
-		numIndices = 1;
+	return (int)lods.size();
+}
+
+void Model::CalculateBounds(glm::vec3& min, glm::vec3& max)
+{
+	if (!hasCPUCopy)
+	{
+		min = boundsMin;
+		max = boundsMax;
+		return;
+	}
+
+	min = glm::vec3(0.0f);
+	max = glm::vec3(0.0f);
+
+	if (numVertices > 0)
+	{
+		min = vertices[0].position;
+		max = vertices[0].position;
+
+		// Grow the box to fit every vertex.
+		for (int i = 1; i < numVertices; i++)
+		{
+			min = glm::min(min, vertices[i].position);
+			max = glm::max(max, vertices[i].position);
+		}
 	}
 }
 
@@ -37,34 +37,158 @@ since they are aligned on the same axis.
 #define _MODEL_H
 
 #include "GLIncludes.h"
+#include "StreamBuffer.h"
+#include "VertexLayout.h"
+#include "ModelFile.h"
+#include <atomic>
+#include <vector>
 
+// A model is counted (see Acquire and Release), so it can be let go of from any thread, and its buffers are deleted on the render thread
+// (see GPUDeletionQueue) whichever thread that happens on.
 class Model
 {
 private:
+	// How many references there are. The last one to be released deletes the model.
+	mutable std::atomic<int> references;
+
+	// The vertices and indices arrays have room for vertexCapacity and indexCapacity of each, of which the first numVertices and numIndices are used.
 	int numVertices;
+	int vertexCapacity;
 	VertexFormat* vertices;
 
 	int numIndices;
+	int indexCapacity;
 	GLuint* indices;
 
+	// Whether vertices and indices hold the model (see ReleaseCPUCopy). If not, numVertices and numIndices are still how many are in the buffers.
+	bool hasCPUCopy;
+
+	// The box around the vertices, for when there aren't any vertices to work it out from.
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+
+	// The model's levels of detail (see GenerateLODs), and the indices they draw from. These are always kept on our side, even after
+	// ReleaseCPUCopy, since it's a ModelPool that draws them.
+	std::vector<ModelLOD> lods;
+	std::vector<GLuint> lodIndices;
+
+	// The vertices and indices from begin up to (not including) end have changed since the buffers were last uploaded. (begin == end if none have.)
+	int dirtyVertexBegin, dirtyVertexEnd;
+	int dirtyIndexBegin, dirtyIndexEnd;
+
+	// How many vertices and indices the buffers on the GPU have room for. They're only reallocated when the model outgrows them,
+	// otherwise only the ranges that changed get uploaded.
+	int gpuVertexCapacity;
+	int gpuIndexCapacity;
+
+	// What the index buffer holds: GL_UNSIGNED_SHORT while the model has few enough vertices for 16 bit indices (which halves the buffer, and
+	// what the GPU has to read for every vertex it draws), otherwise GL_UNSIGNED_INT. The indices on our side are always GLuints, and get
+	// narrowed in shortIndices on the way up.
+	GLenum indexType;
+	std::vector<GLushort> shortIndices;
+
+	int indexSize() const
+	{
+		return indexType == GL_UNSIGNED_SHORT ? (int)sizeof(GLushort) : (int)sizeof(GLuint);
+	}
+
+	// Uploads the buffers if anything has been added. Drawing calls this first, so that many additions only cost one upload.
+	void flushBuffers();
+
+	// How the vertices are stored in the vertex buffer. The vertices array above is always full VertexFormats.
+	VertexLayout layout;
+
+	// The vertex array object remembers which buffers this model uses and how its vertex attributes are laid out in them, so all of that
+	// only has to be set up once (in InitBuffer). Drawing is then just binding the vao.
+	GLuint vao;
 	GLuint vbo;
 	GLuint ebo;
 
+	// Holds one transform per instance for DrawInstanced. It's refilled every time we draw, straight through a persistent mapping where we can.
+	StreamBuffer instances;
+
+	// Points the per-instance attributes at the instance buffer. This has to happen again whenever the buffer is recreated.
+	void setInstanceAttributes();
+
 	//GLuint shaderProgram;
 	//GLuint m_Buffer;
 
-public:
-	Model(int numVerts = 0, VertexFormat* verts = nullptr, int numInds = 0, GLuint* inds = nullptr);
+	// Only the last Release deletes a model, so nothing else can. It hands the buffers, vertex array and instance buffer over to
+	// GetGPUDeletionQueue instead of deleting them itself, so it doesn't need the OpenGL context, and doesn't wait on the GPU either.
 	~Model();
 
+	// A model can't be copied, since it owns its buffers.
+	Model(const Model&);
+	Model& operator=(const Model&);
+
+public:
+	Model(int numVerts = 0, VertexFormat* verts = nullptr, int numInds = 0, GLuint* inds = nullptr, const VertexLayout& vertexLayout = VertexLayout());
+
+	// Creates a model from a model file. The vertices and indices go straight from the mapping into the model's buffers (the file is already in
+	// the model's layout, so there's nothing to convert), and unless keepCPUCopy is true, that's the only place they're kept: a model that's
+	// only ever drawn needs nothing on our side. The file can be closed once this returns. Needs an OpenGL context.
+	Model(const ModelFile& file, bool keepCPUCopy = false);
+
+	// Whoever makes a model holds its first reference, and everything else that keeps hold of it (a GameObject, a ModelPool) adds one of its
+	// own. Release takes one away, and the last one deletes the model, on whatever thread it's on. Both can be called from any thread.
+	void Acquire() const
+	{
+		references.fetch_add(1, std::memory_order_relaxed);
+	}
+	void Release() const
+	{
+		if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			delete this;
+		}
+	}
+	int GetReferences() const
+	{
+		return references.load(std::memory_order_relaxed);
+	}
+
+	// Frees the vertices and indices on our side, leaving only the copies in the buffers (which get created first, if they haven't been).
+	// The model can still be drawn and added to a ModelPool with the same layout, and keeps its bounds, but everything that reads or changes the
+	// vertices or indices (including Vertices() and Indices(), which return nullptr) can't be used anymore.
+	void ReleaseCPUCopy();
+
+	bool HasCPUCopy() const
+	{
+		return hasCPUCopy;
+	}
+
+	// These add to the end of the vertices or indices. The new data gets uploaded the next time the model is drawn (or UpdateBuffer is called).
+	// Each returns the index of the first vertex it added.
 	GLuint AddVertex(VertexFormat*);
+	GLuint AddVertices(const VertexFormat* verts, int count);
 	void AddIndex(GLuint);
+	void AddIndices(const GLuint* inds, int count);
+
+	// These change existing vertices or indices (first up to first + count), and only those get uploaded.
+	void SetVertices(int first, const VertexFormat* verts, int count);
+	void SetIndices(int first, const GLuint* inds, int count);
+
+	// If you change the vertices or indices through Vertices() or Indices() instead, call these so that they get uploaded.
+	void MarkVerticesDirty(int first, int count);
+	void MarkIndicesDirty(int first, int count);
+
+	// Makes room for at least count vertices or indices in total, so that adding up to that many won't need to reallocate.
+	void ReserveVertices(int count);
+	void ReserveIndices(int count);
 
 	void InitBuffer();
+
+	// Uploads whatever has changed. Drawing does this for you.
 	void UpdateBuffer();
 
 	void Draw();
 
+	// Draws count copies of the model in one draw call, the i-th one with transforms[i] as its transform.
+	// The transforms go to the vertex shader as per-instance attributes (in locations 2 through 4), not a uniform. The camera is the same
+	// for all of them, so it comes from the Camera uniform block instead (see VertexLayout::CAMERA_BINDING).
+	// The instance buffer goes around a ring of 3 parts, so this should only be called once per model per frame (or the GPU may need to catch up).
+	void DrawInstanced(const InstanceTransform* transforms, int count);
+
 	// Our get variables.
 	int NumVertices()
 	{
@@ -82,6 +206,49 @@ public:
 	{
 		return indices;
 	}
+	const VertexLayout& Layout()
+	{
+		return layout;
+	}
+
+	// The model's own buffers (0 if they haven't been created yet), with its vertices in its layout and its indices.
+	GLuint VertexBuffer() const
+	{
+		return vbo;
+	}
+	GLuint IndexBuffer() const
+	{
+		return ebo;
+	}
+
+	// The type of the indices in the index buffer (see indexType). This can change as the model grows, the next time it's uploaded.
+	GLenum IndexType() const
+	{
+		return indexType;
+	}
+
+	// Calculates the axis-aligned box around all of the vertices, in the model's local space.
+	void CalculateBounds(glm::vec3& min, glm::vec3& max);
+
+	// Builds up to maxLevels levels of detail for the model, each with half as many triangles as the one before or fewer, by clustering its
+	// vertices (see BuildMeshLODs). They use the model's own vertices, so they only add indices. Returns how many there are, which can be
+	// fewer (or none, for a model too simple to simplify). Needs the CPU copy, and has to be called again if the model changes afterwards.
+	// Models made from a model file that was saved with levels of detail already have them.
+	int GenerateLODs(int maxLevels = 4);
+
+	// The levels of detail, coarsest last. Level 0 (the model itself) isn't one of these, so GetLOD(0) is level 1.
+	int NumLODs() const
+	{
+		return (int)lods.size();
+	}
+	const ModelLOD& GetLOD(int i) const
+	{
+		return lods[i];
+	}
+	const std::vector<GLuint>& LODIndices() const
+	{
+		return lodIndices;
+	}
 
 	/*Model(int p_nVertices = 3, float _size = 1.0f, float _originX = 0.0f, float _originY = 0.0f, float _originZ = 0.0f)
 	{
@@ -0,0 +1,206 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ModelFile.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MODEL_FILE_CPP
+#define _MODEL_FILE_CPP
+
+#include "ModelFile.h"
+#include <cstdio>
+#include <cstring>
+
+// Rounds an offset up to the next 16 byte boundary.
+static unsigned int alignSection(unsigned int offset)
+{
+	return (offset + 15) & ~15u;
+}
+
+ModelFile::ModelFile()
+{
+	header = nullptr;
+}
+
+bool ModelFile::Open(const std::string& fileName)
+{
+	Close();
+
+	if (!file.Open(fileName) || file.GetSize() < sizeof(ModelFileHeader))
+	{
+		Close();
+		return false;
+	}
+
+	const ModelFileHeader* fileHeader = (const ModelFileHeader*)file.GetData();
+
+	if (memcmp(fileHeader->magic, MODEL_FILE_MAGIC, sizeof(MODEL_FILE_MAGIC)) != 0 || fileHeader->version != MODEL_FILE_VERSION ||
+		fileHeader->position > VERTEX_SNORM10 || fileHeader->color > VERTEX_SNORM10 || fileHeader->normal > VERTEX_SNORM10 ||
+		fileHeader->position == VERTEX_NONE || fileHeader->interleaved > 1 || (fileHeader->indexSize != 2 && fileHeader->indexSize != 4))
+	{
+		Close();
+		return false;
+	}
+
+	// Make sure both sections fit in the file (in 64 bits, so a broken header can't overflow). These get handed to OpenGL as they are, so
+	// they had better not go past the end of the mapping.
+	header = fileHeader;
+	unsigned long long size = file.GetSize();
+
+	if (header->verticesOffset + (unsigned long long)GetVerticesSize() > size ||
+		header->indicesOffset + (unsigned long long)header->numIndices * header->indexSize > size ||
+		header->lodsOffset + (unsigned long long)header->numLods * sizeof(ModelLOD) > size ||
+		header->lodIndicesOffset + (unsigned long long)header->numLodIndices * sizeof(GLuint) > size)
+	{
+		Close();
+		return false;
+	}
+
+	// And that every level of detail's indices are in the level of detail section.
+	const ModelLOD* lods = GetLODs();
+
+	for (unsigned int i = 0; i < header->numLods; i++)
+	{
+		if (lods[i].firstIndex < 0 || lods[i].numIndices < 0 ||
+			(unsigned long long)lods[i].firstIndex + (unsigned long long)lods[i].numIndices > header->numLodIndices)
+		{
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ModelFile::Close()
+{
+	file.Close();
+
+	header = nullptr;
+}
+
+VertexLayout ModelFile::GetLayout() const
+{
+	return VertexLayout((VertexAttributeFormat)header->position, (VertexAttributeFormat)header->color, (VertexAttributeFormat)header->normal,
+		header->interleaved != 0);
+}
+
+bool ModelFile::Save(const std::string& fileName, const VertexFormat* verts, int numVerts, const GLuint* inds, int numInds, const VertexLayout& layout,
+	unsigned long long sourceKey, const ModelLOD* lods, int numLods, const GLuint* lodInds, int numLodInds)
+{
+	ModelFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MODEL_FILE_MAGIC, sizeof(header.magic));
+	header.version = MODEL_FILE_VERSION;
+	header.position = (unsigned char)layout.position;
+	header.color = (unsigned char)layout.color;
+	header.normal = (unsigned char)layout.normal;
+	header.interleaved = layout.interleaved ? 1 : 0;
+	header.numVertices = (unsigned int)numVerts;
+	header.numIndices = (unsigned int)numInds;
+	header.sourceKey = sourceKey;
+	header.numLods = (unsigned int)numLods;
+	header.numLodIndices = (unsigned int)numLodInds;
+	header.indexSize = numVerts <= 65536 ? 2 : 4;
+
+	if (numVerts > 0)
+	{
+		header.boundsMin = verts[0].position;
+		header.boundsMax = verts[0].position;
+
+		for (int i = 1; i < numVerts; i++)
+		{
+			header.boundsMin = glm::min(header.boundsMin, verts[i].position);
+			header.boundsMax = glm::max(header.boundsMax, verts[i].position);
+		}
+	}
+
+	std::vector<unsigned char> packed;
+	layout.Pack(verts, numVerts, packed);
+
+	header.verticesOffset = alignSection(sizeof(ModelFileHeader));
+	header.indicesOffset = alignSection(header.verticesOffset + (unsigned int)packed.size());
+	header.lodsOffset = alignSection(header.indicesOffset + header.indexSize * numInds);
+	header.lodIndicesOffset = alignSection(header.lodsOffset + sizeof(ModelLOD) * numLods);
+
+	FILE* out = fopen(fileName.c_str(), "wb");
+
+	if (out == nullptr)
+	{
+		return false;
+	}
+
+	// Writes a section, after padding out to where it starts.
+	auto writeSection = [out](unsigned int offset, const void* data, size_t size)
+	{
+		static const char zeros[16] = { 0 };
+
+		long position = ftell(out);
+
+		if (position >= 0 && (unsigned int)position < offset)
+		{
+			fwrite(zeros, 1, offset - (unsigned int)position, out);
+		}
+
+		if (size > 0)
+		{
+			fwrite(data, 1, size, out);
+		}
+	};
+
+	writeSection(0, &header, sizeof(header));
+	writeSection(header.verticesOffset, packed.data(), packed.size());
+	if (header.indexSize == 2)
+	{
+		std::vector<GLushort> shortIndices(inds, inds + numInds);
+		writeSection(header.indicesOffset, shortIndices.data(), sizeof(GLushort) * numInds);
+	}
+	else
+	{
+		writeSection(header.indicesOffset, inds, sizeof(GLuint) * numInds);
+	}
+	writeSection(header.lodsOffset, lods, sizeof(ModelLOD) * numLods);
+	writeSection(header.lodIndicesOffset, lodInds, sizeof(GLuint) * numLodInds);
+
+	bool written = ferror(out) == 0;
+
+	// Don't leave half a file behind for Open to find.
+	if (fclose(out) != 0 || !written)
+	{
+		remove(fileName.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+#endif //_MODEL_FILE_CPP
@@ -0,0 +1,176 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ModelFile.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MODEL_FILE_H
+#define _MODEL_FILE_H
+
+#include "VertexLayout.h"
+#include "MappedFile.h"
+#include <string>
+
+// A model file is a header, then the model's vertices exactly as VertexLayout::Pack lays them out (for a buffer with room for just those
+// vertices), then its indices, then its levels of detail (if it has any) and their indices. Each section starts on a 16 byte boundary.
+// The model's indices are stored in 16 bits each if it has few enough vertices for that (see Model::IndexType), so they can go straight into
+// its index buffer too; the levels of detail's are always 32 bits, since they only go into a ModelPool.
+static const char MODEL_FILE_MAGIC[4] = { 'G', 'J', 'K', 'M' };
+static const unsigned int MODEL_FILE_VERSION = 3;
+
+// A level of detail of a model: a range of its level of detail indices (see Model::GenerateLODs), over the model's own vertices, and how far
+// out of place they are as a fraction of the model's size (see MeshLOD).
+struct ModelLOD
+{
+	int firstIndex;
+	int numIndices;
+	float error;
+};
+
+struct ModelFileHeader
+{
+	char magic[4];
+	unsigned int version;
+
+	// The VertexLayout the vertices are stored in. (One byte each, so the file doesn't depend on the size of an enum or a bool.)
+	unsigned char position;
+	unsigned char color;
+	unsigned char normal;
+	unsigned char interleaved;
+
+	unsigned int numVertices;
+	unsigned int numIndices;
+
+	// Where the vertices and indices start, in bytes from the start of the file.
+	unsigned int verticesOffset;
+	unsigned int indicesOffset;
+	unsigned int numLods;
+
+	// Whatever the model was made from (a hash of its source data, say), so that a file that's out of date can be told apart.
+	unsigned long long sourceKey;
+
+	// The box around the vertices, so it doesn't have to be worked out again from (possibly rounded) packed vertices.
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+
+	// The levels of detail, coarser and coarser (not counting the model itself), and the indices they all draw from.
+	unsigned int lodsOffset;
+	unsigned int numLodIndices;
+	unsigned int lodIndicesOffset;
+
+	// How many bytes each of the model's indices takes: 2 or 4.
+	unsigned int indexSize;
+};
+
+// A model's vertices and indices, already in the layout they're drawn with, mapped straight out of a file.
+// Opening one only maps the file and checks the header. A Model made from it (see Model's ModelFile constructor) hands the mapped vertices and
+// indices straight to OpenGL, so they're never parsed, converted or copied on our side, and the model doesn't have to keep them either.
+class ModelFile
+{
+	MappedFile file;
+	const ModelFileHeader* header;
+
+public:
+	ModelFile();
+
+	// Returns false if the file can't be opened, or isn't a model file this version can read.
+	bool Open(const std::string& fileName);
+	void Close();
+
+	// Writes numVerts vertices (stored in the given layout) and numInds indices to a model file, along with numLods levels of detail over
+	// numLodInds more indices. Returns false if it can't be written.
+	static bool Save(const std::string& fileName, const VertexFormat* verts, int numVerts, const GLuint* inds, int numInds, const VertexLayout& layout,
+		unsigned long long sourceKey = 0, const ModelLOD* lods = nullptr, int numLods = 0, const GLuint* lodInds = nullptr, int numLodInds = 0);
+
+	bool IsOpen() const
+	{
+		return header != nullptr;
+	}
+
+	VertexLayout GetLayout() const;
+
+	int NumVertices() const
+	{
+		return (int)header->numVertices;
+	}
+	int NumIndices() const
+	{
+		return (int)header->numIndices;
+	}
+	unsigned long long GetSourceKey() const
+	{
+		return header->sourceKey;
+	}
+	void GetBounds(glm::vec3& min, glm::vec3& max) const
+	{
+		min = header->boundsMin;
+		max = header->boundsMax;
+	}
+
+	// The packed vertices (GetVerticesSize bytes of them) and the indices (IndexSize bytes each). These point into the mapping, so they're good
+	// until the file is closed.
+	const unsigned char* GetVertices() const
+	{
+		return (const unsigned char*)file.GetData() + header->verticesOffset;
+	}
+	size_t GetVerticesSize() const
+	{
+		return (size_t)GetLayout().VertexSize() * header->numVertices;
+	}
+	const void* GetIndices() const
+	{
+		return file.GetData() + header->indicesOffset;
+	}
+	int IndexSize() const
+	{
+		return (int)header->indexSize;
+	}
+
+	int NumLODs() const
+	{
+		return (int)header->numLods;
+	}
+	int NumLODIndices() const
+	{
+		return (int)header->numLodIndices;
+	}
+	const ModelLOD* GetLODs() const
+	{
+		return (const ModelLOD*)(file.GetData() + header->lodsOffset);
+	}
+	const GLuint* GetLODIndices() const
+	{
+		return (const GLuint*)(file.GetData() + header->lodIndicesOffset);
+	}
+};
+
+#endif //_MODEL_FILE_H
@@ -0,0 +1,931 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ModelPool.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MODEL_POOL_CPP
+#define _MODEL_POOL_CPP
+
+#include "ModelPool.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cfloat>
+
+// How many bands DrawBatched splits the distance from the nearest object to the farthest into, to sort each level's objects front to back.
+// The sort only has to be roughly right for the depth test to throw away most of what's hidden, and bands keep it a counting sort.
+static const int DEPTH_BANDS = 64;
+
+ModelPool::ModelPool(const VertexLayout& vertexLayout)
+{
+	layout = vertexLayout;
+	layout.interleaved = true;
+
+	vao = 0;
+	vbo = 0;
+	ebo = 0;
+
+	vertexCapacity = 0;
+	indexCapacity = 0;
+	numVertices = 0;
+	numIndices = 0;
+
+	cullProgram = 0;
+	cullViewProjection = -1;
+	cullPlanes = -1;
+	cullNumInstances = -1;
+	cullLodScale = -1;
+	cullLodError = -1;
+	cullOcclusion = -1;
+	cullPyramid = -1;
+	cullPyramidViewProjection = -1;
+	cullDepthSize = -1;
+	cullPyramidLevels = -1;
+
+	occlusion = nullptr;
+
+	for (int i = 0; i < NUM_COUNT_BUFFERS; i++)
+	{
+		countBuffers[i] = 0;
+		countFences[i] = 0;
+	}
+
+	nextCountBuffer = 0;
+
+	culledInstances = 0;
+	culledCapacity = 0;
+
+	residentInputs = 0;
+	residentCapacity = 0;
+	residentCount = 0;
+
+	lodError = 0.002f;
+	levelErrors = 0;
+	levelErrorCount = 0;
+}
+
+ModelPool::~ModelPool()
+{
+	for (int i = 0; i < (int)models.size(); i++)
+	{
+		models[i].model->Release();
+	}
+
+	TrackFree(MEMORY_GPU, layout.VertexSize() * vertexCapacity);
+	TrackFree(MEMORY_GPU, sizeof(GLuint) * indexCapacity);
+	TrackFree(MEMORY_GPU, sizeof(InstanceTransform) * culledCapacity);
+	TrackFree(MEMORY_GPU, sizeof(CullInstance) * residentCapacity);
+	TrackFree(MEMORY_GPU, sizeof(float) * levelErrorCount);
+
+	for (int i = 0; i < NUM_COUNT_BUFFERS; i++)
+	{
+		if (countFences[i] != 0)
+		{
+			glDeleteSync(countFences[i]);
+		}
+	}
+
+	if (countBuffers[0] != 0)
+	{
+		TrackFree(MEMORY_GPU, sizeof(GLuint) * 2 * NUM_COUNT_BUFFERS);
+	}
+
+	glDeleteBuffers(NUM_COUNT_BUFFERS, countBuffers);
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ebo);
+	glDeleteBuffers(1, &culledInstances);
+	glDeleteBuffers(1, &residentInputs);
+	glDeleteBuffers(1, &levelErrors);
+	glDeleteVertexArrays(1, &vao);
+}
+
+void ModelPool::create()
+{
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+
+	// The instance transforms, with room for one to start with. They grow as needed.
+	instances.Reserve(sizeof(InstanceTransform), sizeof(InstanceTransform));
+
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, instances.GetBuffer());
+	VertexLayout::SetInstanceAttributes();
+	glBindVertexArray(0);
+}
+
+GLuint ModelPool::grow(GLuint buffer, GLsizeiptr oldSize, GLsizeiptr newSize)
+{
+	GLuint newBuffer;
+	glGenBuffers(1, &newBuffer);
+
+	// The copy read and copy write targets aren't used for anything else, so binding buffers to them doesn't disturb any other state.
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+
+	// Copy the old buffer into the start of the new one, all on the GPU.
+	if (oldSize > 0)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+	}
+
+	glDeleteBuffers(1, &buffer);
+
+	TrackResize(MEMORY_GPU, oldSize, newSize);
+
+	return newBuffer;
+}
+
+int ModelPool::Add(Model* model)
+{
+	// Without a copy on our side, the model's vertices can only be copied over from its own buffer as they are, which means they have to be
+	// in the same layout as ours.
+	if (!model->HasCPUCopy() && model->Layout() != layout)
+	{
+		return -1;
+	}
+
+	if (vao == 0)
+	{
+		create();
+	}
+
+	int modelVertices = model->NumVertices();
+	int modelIndices = model->NumIndices();
+
+	// The levels of detail's indices go right after the model's. (A model keeps these on our side even without its CPU copy.)
+	const std::vector<GLuint>& lodIndices = model->LODIndices();
+	int totalIndices = modelIndices + (int)lodIndices.size();
+
+	glBindVertexArray(vao);
+
+	// Make room if there isn't enough, at least doubling the buffers so that adding models one at a time doesn't mean growing every time.
+	if (numVertices + modelVertices > vertexCapacity)
+	{
+		int newCapacity = vertexCapacity * 2 > numVertices + modelVertices ? vertexCapacity * 2 : numVertices + modelVertices;
+
+		vbo = grow(vbo, (GLsizeiptr)layout.VertexSize() * vertexCapacity, (GLsizeiptr)layout.VertexSize() * newCapacity);
+		vertexCapacity = newCapacity;
+
+		// The attributes have to point at the new buffer.
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		layout.SetAttributes(vertexCapacity);
+	}
+
+	if (numIndices + totalIndices > indexCapacity)
+	{
+		int newCapacity = indexCapacity * 2 > numIndices + totalIndices ? indexCapacity * 2 : numIndices + totalIndices;
+
+		ebo = grow(ebo, sizeof(GLuint) * indexCapacity, sizeof(GLuint) * newCapacity);
+		indexCapacity = newCapacity;
+
+		// The element buffer binding is part of the vao, so this points the vao at the new one.
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	}
+
+	PooledModel pooled;
+	pooled.model = model;
+	pooled.baseVertex = numVertices;
+	pooled.firstIndex = numIndices;
+	pooled.numIndices = modelIndices;
+	pooled.firstLevel = (int)levels.size();
+	pooled.numLevels = model->NumLODs() + 1;
+
+	// Copy the model in after everything that's already there.
+	if (model->HasCPUCopy())
+	{
+		std::vector<unsigned char> packed;
+		layout.Pack(model->Vertices(), modelVertices, packed);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferSubData(GL_ARRAY_BUFFER, (GLsizeiptr)layout.VertexSize() * pooled.baseVertex, packed.size(), packed.data());
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * pooled.firstIndex, sizeof(GLuint) * modelIndices, model->Indices());
+	}
+	else
+	{
+		// Otherwise it's copied from the model's buffers, all on the GPU, the same way grow copies the old buffers.
+		glBindBuffer(GL_COPY_READ_BUFFER, model->VertexBuffer());
+		glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)layout.VertexSize() * pooled.baseVertex,
+			(GLsizeiptr)layout.VertexSize() * modelVertices);
+
+		glBindBuffer(GL_COPY_READ_BUFFER, model->IndexBuffer());
+
+		if (model->IndexType() == GL_UNSIGNED_SHORT)
+		{
+			// The pool's indices are always 32 bits (all of its models together can have any number of vertices), so 16 bit ones have to
+			// be read back and widened. This only happens once per model, when it's added.
+			std::vector<GLushort> shortIndices(modelIndices);
+			glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(GLushort) * modelIndices, shortIndices.data());
+
+			std::vector<GLuint> wideIndices(shortIndices.begin(), shortIndices.end());
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * pooled.firstIndex, sizeof(GLuint) * modelIndices, wideIndices.data());
+		}
+		else
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, sizeof(GLuint) * pooled.firstIndex, sizeof(GLuint) * modelIndices);
+		}
+	}
+
+	if (!lodIndices.empty())
+	{
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * (pooled.firstIndex + modelIndices), sizeof(GLuint) * lodIndices.size(),
+			lodIndices.data());
+	}
+
+	glBindVertexArray(0);
+
+	PooledLevel level;
+	level.firstIndex = pooled.firstIndex;
+	level.numIndices = modelIndices;
+	level.error = 0.0f;
+	levels.push_back(level);
+
+	for (int i = 0; i < model->NumLODs(); i++)
+	{
+		level.firstIndex = pooled.firstIndex + modelIndices + model->GetLOD(i).firstIndex;
+		level.numIndices = model->GetLOD(i).numIndices;
+		level.error = model->GetLOD(i).error;
+		levels.push_back(level);
+	}
+
+	// The cull shader picks levels by their errors, so it needs all of them again.
+	std::vector<float> errors(levels.size());
+
+	for (int i = 0; i < (int)levels.size(); i++)
+	{
+		errors[i] = levels[i].error;
+	}
+
+	if (levelErrors == 0)
+	{
+		glGenBuffers(1, &levelErrors);
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, levelErrors);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(float) * errors.size(), errors.data(), GL_STATIC_DRAW);
+
+	TrackResize(MEMORY_GPU, sizeof(float) * levelErrorCount, sizeof(float) * errors.size());
+	levelErrorCount = (int)errors.size();
+
+	numVertices += modelVertices;
+	numIndices += totalIndices;
+
+	models.push_back(pooled);
+	model->Acquire();
+
+	return (int)models.size() - 1;
+}
+
+int ModelPool::Find(const Model* model) const
+{
+	for (int i = 0; i < (int)models.size(); i++)
+	{
+		if (models[i].model == model)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+int ModelPool::selectLevel(const PooledModel& pooled, const AABB& bounds, const glm::mat4& viewProjection) const
+{
+	int level = pooled.firstLevel;
+
+	if (pooled.numLevels == 1 || lodError <= 0.0f)
+	{
+		return level;
+	}
+
+	glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+	float size = glm::length(bounds.max - bounds.min);
+	float w = (viewProjection * glm::vec4(center, 1.0f)).w;
+
+	// The camera is inside the bounds (or close enough that the size on screen means nothing), so it gets the real thing.
+	if (w <= size * 0.5f)
+	{
+		return level;
+	}
+
+	// How tall the bounds are on screen, as a fraction of its height: clip space y changes by (at most) the length of the projection's y row
+	// for every unit moved, out of 2w for the whole screen at that depth.
+	float scale = glm::length(glm::vec3(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1])) * 0.5f;
+	float screenSize = size * scale / w;
+
+	// The levels get coarser as they go, so take them until one would look too far off.
+	while (level + 1 < pooled.firstLevel + pooled.numLevels && levels[level + 1].error * screenSize <= lodError)
+	{
+		level++;
+	}
+
+	return level;
+}
+
+void ModelPool::Begin()
+{
+	glBindVertexArray(vao);
+}
+
+void ModelPool::DrawInstanced(int id, const InstanceTransform* transforms, int count, int level)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	GLuint baseInstance = writeInstances(transforms, count);
+	const PooledModel& pooled = models[id];
+	const PooledLevel& pooledLevel = levels[pooled.firstLevel + level];
+
+	// Start at the level's first index, add the model's base vertex to every index, and (if the transforms aren't at the start of the instance
+	// buffer) start the instances at the right one.
+	void* firstIndex = (void*)(sizeof(GLuint) * pooledLevel.firstIndex);
+
+	if (baseInstance == 0)
+	{
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, pooledLevel.numIndices, GL_UNSIGNED_INT, firstIndex, count, pooled.baseVertex);
+	}
+	else
+	{
+		glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, pooledLevel.numIndices, GL_UNSIGNED_INT, firstIndex, count, pooled.baseVertex,
+			baseInstance);
+	}
+}
+
+void ModelPool::DrawInstancedFromBuffer(int id, GLuint buffer, int count, int level)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	const PooledModel& pooled = models[id];
+	const PooledLevel& pooledLevel = levels[pooled.firstLevel + level];
+
+	void* firstIndex = (void*)(sizeof(GLuint) * pooledLevel.firstIndex);
+
+	// Read the instance transforms from the caller's buffer for this draw, then point them back at the instance buffer for everything else.
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	VertexLayout::SetInstanceAttributes();
+
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, pooledLevel.numIndices, GL_UNSIGNED_INT, firstIndex, count, pooled.baseVertex);
+
+	glBindBuffer(GL_ARRAY_BUFFER, instances.GetBuffer());
+	VertexLayout::SetInstanceAttributes();
+}
+
+GLuint ModelPool::writeInstances(const InstanceTransform* transforms, int count)
+{
+	GLsizeiptr size = sizeof(InstanceTransform) * count;
+
+	// If the instance buffer had to be recreated, point the instance attributes at the new one.
+	if (instances.Reserve(size, sizeof(InstanceTransform)))
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, instances.GetBuffer());
+		VertexLayout::SetInstanceAttributes();
+	}
+
+	return (GLuint)(instances.Write(transforms, size, sizeof(InstanceTransform)) / sizeof(InstanceTransform));
+}
+
+void ModelPool::End()
+{
+	glBindVertexArray(0);
+
+	// Every draw this frame has been issued, so once the GPU gets past them the instance data and the commands can be written over.
+	instances.Fence();
+	commandBuffer.Fence();
+	cullInputs.Fence();
+}
+
+void ModelPool::DrawBatched(const int* modelIds, const InstanceTransform* transforms, int count, const glm::mat4& viewProjection, const int* levelIds)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	int numModels = (int)models.size();
+	int numLevels = (int)levels.size();
+
+	// How far away each object is: w in clip space (the last row of the view projection times the object's position) is the distance along
+	// the view direction. The nearest and farthest set out the depth bands.
+	glm::vec4 depthRow(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+	float nearest = FLT_MAX;
+	float farthest = -FLT_MAX;
+
+	depths.resize(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		depths[i] = glm::dot(depthRow, glm::vec4(transforms[i].position, 1.0f));
+		nearest = glm::min(nearest, depths[i]);
+		farthest = glm::max(farthest, depths[i]);
+	}
+
+	float bandScale = farthest > nearest ? (DEPTH_BANDS - 1) / (farthest - nearest) : 0.0f;
+
+	// Group the transforms by level, and within each level by depth band, with a counting sort: count how many objects go in each group,
+	// turn that into where each group starts, then put each transform into the next spot in its group. So each level's objects come out
+	// nearest first, and the ones in front fill in the depth buffer before the ones behind them get shaded.
+	groupKeys.resize(count);
+	groupStart.assign(numLevels * DEPTH_BANDS + 1, 0);
+
+	for (int i = 0; i < count; i++)
+	{
+		int level = models[modelIds[i]].firstLevel + (levelIds != nullptr ? levelIds[i] : 0);
+		int band = (int)((depths[i] - nearest) * bandScale);
+
+		groupKeys[i] = level * DEPTH_BANDS + band;
+		groupStart[groupKeys[i] + 1]++;
+	}
+
+	for (int g = 0; g < numLevels * DEPTH_BANDS; g++)
+	{
+		groupStart[g + 1] += groupStart[g];
+	}
+
+	sortedTransforms.resize(count);
+	commands.clear();
+
+	// (Reuses the counts as the next free spot in each group, which leaves groupStart[g] at the end of g's group when we're done.)
+	for (int i = 0; i < count; i++)
+	{
+		sortedTransforms[groupStart[groupKeys[i]]++] = transforms[i];
+	}
+
+	if (!GLEW_VERSION_4_3 && !GLEW_ARB_multi_draw_indirect)
+	{
+		// Without indirect draws, fall back on one instanced draw per level.
+		int start = 0;
+
+		for (int m = 0; m < numModels; m++)
+		{
+			for (int l = 0; l < models[m].numLevels; l++)
+			{
+				int end = groupStart[(models[m].firstLevel + l) * DEPTH_BANDS + DEPTH_BANDS - 1];
+
+				DrawInstanced(m, sortedTransforms.data() + start, end - start, l);
+				start = end;
+			}
+		}
+
+		return;
+	}
+
+	// Now all of the transforms can go up at once, and each level's instances start at its group within them.
+	GLuint baseInstance = writeInstances(sortedTransforms.data(), count);
+	int start = 0;
+
+	for (int m = 0; m < numModels; m++)
+	{
+		for (int l = models[m].firstLevel; l < models[m].firstLevel + models[m].numLevels; l++)
+		{
+			int end = groupStart[l * DEPTH_BANDS + DEPTH_BANDS - 1];
+
+			if (end > start)
+			{
+				DrawElementsIndirectCommand command;
+				command.count = levels[l].numIndices;
+				command.instanceCount = end - start;
+				command.firstIndex = levels[l].firstIndex;
+				command.baseVertex = models[m].baseVertex;
+				command.baseInstance = baseInstance + start;
+
+				commands.push_back(command);
+			}
+
+			start = end;
+		}
+	}
+
+	// The commands are drawn in order, so the levels with the nearest objects go first. (Each one's nearest object is its first.)
+	std::stable_sort(commands.begin(), commands.end(), [this, baseInstance, depthRow](const DrawElementsIndirectCommand& a, const DrawElementsIndirectCommand& b)
+	{
+		return glm::dot(depthRow, glm::vec4(sortedTransforms[a.baseInstance - baseInstance].position, 1.0f)) <
+			glm::dot(depthRow, glm::vec4(sortedTransforms[b.baseInstance - baseInstance].position, 1.0f));
+	});
+
+	// Upload the commands, and hand all of them to the GPU in one call. The offset tells it where in the indirect buffer they start.
+	GLsizeiptr size = sizeof(DrawElementsIndirectCommand) * commands.size();
+
+	commandBuffer.Reserve(size);
+	GLsizeiptr offset = commandBuffer.Write(commands.data(), size);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.GetBuffer());
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)offset, (GLsizei)commands.size(), 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+bool ModelPool::SetCullProgram(const ShaderProgram& program)
+{
+	if (!GLEW_VERSION_4_3 || program.GetProgram() == 0)
+	{
+		cullProgram = 0;
+		return false;
+	}
+
+	cullProgram = program.GetProgram();
+	cullViewProjection = program.GetUniform("viewProjection");
+	cullPlanes = program.GetUniform("planes");
+	cullNumInstances = program.GetUniform("numInstances");
+	cullLodScale = program.GetUniform("lodScale");
+	cullLodError = program.GetUniform("lodError");
+	cullOcclusion = program.GetUniform("occlusion");
+	cullPyramid = program.GetUniform("pyramid");
+	cullPyramidViewProjection = program.GetUniform("pyramidViewProjection");
+	cullDepthSize = program.GetUniform("depthSize");
+	cullPyramidLevels = program.GetUniform("pyramidLevels");
+
+	return true;
+}
+
+void ModelPool::DrawCulled(const int* modelIds, const InstanceTransform* transforms, const AABB* bounds, int count,
+	const glm::mat4& viewProjection, const unsigned char* changed)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	Frustum frustum(viewProjection);
+
+	// Bring cullScratch up to date: every object, unless we've been told which ones changed (and have them all from last time).
+	bool all = changed == nullptr || (int)cullScratch.size() != count;
+
+	cullScratch.resize(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		if (all || changed[i])
+		{
+			cullScratch[i].transform = transforms[i];
+			cullScratch[i].padding = 0;
+			cullScratch[i].boundsMin = bounds[i].min;
+			cullScratch[i].firstLevel = models[modelIds[i]].firstLevel;
+			cullScratch[i].boundsMax = bounds[i].max;
+			cullScratch[i].numLevels = models[modelIds[i]].numLevels;
+		}
+	}
+
+	if (cullProgram == 0)
+	{
+		// Cull on the CPU instead (from cullScratch, which has every object even when transforms and bounds don't), and draw what's left the
+		// usual way. The objects on the GPU are out of date after this.
+		residentCount = 0;
+
+		visibleModels.clear();
+		visibleLevels.clear();
+		visibleTransforms.clear();
+
+		for (int i = 0; i < count; i++)
+		{
+			AABB objectBounds(cullScratch[i].boundsMin, cullScratch[i].boundsMax);
+
+			if (frustum.Overlaps(objectBounds))
+			{
+				visibleModels.push_back(modelIds[i]);
+				visibleLevels.push_back(SelectLOD(modelIds[i], objectBounds, viewProjection));
+				visibleTransforms.push_back(cullScratch[i].transform);
+			}
+		}
+
+		GJK_PROFILE_COUNT("instances in frustum", (long long)visibleTransforms.size());
+
+		DrawBatched(visibleModels.data(), visibleTransforms.data(), (int)visibleTransforms.size(), viewProjection, visibleLevels.data());
+		return;
+	}
+
+	int numModels = (int)models.size();
+	int numLevels = (int)levels.size();
+
+	// We don't know how many of each model will be visible, or at which levels, but it can't be more than how many there are, so give each
+	// of a model's levels that much room in the output. Each command starts out with no instances, and the shader counts them up.
+	groupStart.assign(numModels, 0);
+
+	for (int i = 0; i < count; i++)
+	{
+		groupStart[modelIds[i]]++;
+	}
+
+	commands.resize(numLevels);
+	int outputSize = 0;
+
+	for (int m = 0; m < numModels; m++)
+	{
+		for (int l = models[m].firstLevel; l < models[m].firstLevel + models[m].numLevels; l++)
+		{
+			commands[l].count = levels[l].numIndices;
+			commands[l].instanceCount = 0;
+			commands[l].firstIndex = levels[l].firstIndex;
+			commands[l].baseVertex = models[m].baseVertex;
+			commands[l].baseInstance = outputSize;
+
+			outputSize += groupStart[m];
+		}
+	}
+
+	// Upload the objects and the commands. (Both writes start on a 256 byte boundary, which is enough for binding them as storage buffers.)
+	// Without changed, every object goes into the stream buffer. With it, only the changed ones are sent, and the shader reads the objects
+	// from residentInputs.
+	GLsizeiptr inputSize = sizeof(CullInstance) * count;
+	GLsizeiptr commandSize = sizeof(DrawElementsIndirectCommand) * numLevels;
+	GLuint inputBuffer;
+	GLsizeiptr inputOffset;
+
+	if (changed == nullptr)
+	{
+		cullInputs.Reserve(inputSize);
+		inputOffset = cullInputs.Write(cullScratch.data(), inputSize);
+		inputBuffer = cullInputs.GetBuffer();
+
+		residentCount = 0;
+	}
+	else
+	{
+		uploadResident(changed, count);
+
+		inputOffset = 0;
+		inputBuffer = residentInputs;
+	}
+
+	commandBuffer.Reserve(commandSize);
+	GLsizeiptr commandOffset = commandBuffer.Write(commands.data(), commandSize);
+
+	// Make sure there's room for every object at every level in the output.
+	if (outputSize > culledCapacity)
+	{
+		int oldCapacity = culledCapacity;
+
+		culledCapacity = culledCapacity * 2 > outputSize ? culledCapacity * 2 : outputSize;
+		TrackResize(MEMORY_GPU, sizeof(InstanceTransform) * oldCapacity, sizeof(InstanceTransform) * culledCapacity);
+
+		if (culledInstances == 0)
+		{
+			glGenBuffers(1, &culledInstances);
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, culledInstances);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(InstanceTransform) * culledCapacity, nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	// Pick up the counts from earlier frames that are ready, and start this frame's from 0. (If the GPU is so far behind that this buffer's
+	// counts still haven't been read, they're dropped rather than waited for.)
+	readCounts();
+
+	if (countBuffers[0] == 0)
+	{
+		glGenBuffers(NUM_COUNT_BUFFERS, countBuffers);
+
+		for (int i = 0; i < NUM_COUNT_BUFFERS; i++)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffers[i]);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * 2, nullptr, GL_DYNAMIC_READ);
+		}
+
+		TrackAllocation(MEMORY_GPU, sizeof(GLuint) * 2 * NUM_COUNT_BUFFERS);
+	}
+
+	if (countFences[nextCountBuffer] != 0)
+	{
+		glDeleteSync(countFences[nextCountBuffer]);
+		countFences[nextCountBuffer] = 0;
+	}
+
+	GLuint zeros[2] = { 0, 0 };
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffers[nextCountBuffer]);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zeros), zeros);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// Run the cull shader, one invocation per object. (The program being used for drawing gets put back afterwards.)
+	GLint drawProgram;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &drawProgram);
+
+	glUseProgram(cullProgram);
+	glUniformMatrix4fv(cullViewProjection, 1, GL_FALSE, &viewProjection[0][0]);
+	glUniform4fv(cullPlanes, 6, &frustum.planes[0][0]);
+	glUniform1ui(cullNumInstances, (GLuint)count);
+
+	// (The same scale selectLevel works out, so both paths pick the same levels.)
+	glUniform1f(cullLodScale, glm::length(glm::vec3(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1])) * 0.5f);
+	glUniform1f(cullLodError, lodError);
+
+	// The pyramid goes on texture unit 0, which nothing else in the cull uses.
+	bool occluding = occlusion != nullptr && occlusion->IsValid();
+
+	glUniform1i(cullOcclusion, occluding ? 1 : 0);
+
+	if (occluding)
+	{
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, occlusion->GetTexture());
+
+		glUniform1i(cullPyramid, 0);
+		glUniformMatrix4fv(cullPyramidViewProjection, 1, GL_FALSE, &occlusion->GetViewProjection()[0][0]);
+		glUniform2i(cullDepthSize, occlusion->GetDepthWidth(), occlusion->GetDepthHeight());
+		glUniform1i(cullPyramidLevels, occlusion->GetNumLevels());
+	}
+
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, inputBuffer, inputOffset, inputSize);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer.GetBuffer(), commandOffset, commandSize);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, culledInstances, 0, sizeof(InstanceTransform) * outputSize);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, levelErrors, 0, sizeof(float) * numLevels);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, countBuffers[nextCountBuffer]);
+
+	glDispatchCompute((count + 63) / 64, 1, 1);
+
+	// Reading the counts back with glGetBufferSubData has to see what the shader wrote, once the fence says it's done.
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	countFences[nextCountBuffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	nextCountBuffer = (nextCountBuffer + 1) % NUM_COUNT_BUFFERS;
+
+	if (occluding)
+	{
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	// The draw reads the commands and the transforms the shader just wrote, so it has to wait for the shader to finish writing them.
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+	glUseProgram(drawProgram);
+
+	// Read the instance transforms from the shader's output for this draw, then point them back at the instance buffer for everything else.
+	glBindBuffer(GL_ARRAY_BUFFER, culledInstances);
+	VertexLayout::SetInstanceAttributes();
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.GetBuffer());
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)commandOffset, numLevels, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, instances.GetBuffer());
+	VertexLayout::SetInstanceAttributes();
+}
+
+void ModelPool::uploadResident(const unsigned char* changed, int count)
+{
+	// Runs of changed objects with fewer unchanged ones than this between them are copied as one (unchanged ones and all), since a few more
+	// bytes in one copy cost less than another copy.
+	static const int MERGE_GAP = 8;
+
+	// Make room for every object. Growing loses what was there, so it all has to be sent again.
+	if (count > residentCapacity)
+	{
+		int oldCapacity = residentCapacity;
+
+		residentCapacity = residentCapacity * 2 > count ? residentCapacity * 2 : count;
+		TrackResize(MEMORY_GPU, sizeof(CullInstance) * oldCapacity, sizeof(CullInstance) * residentCapacity);
+
+		if (residentInputs == 0)
+		{
+			glGenBuffers(1, &residentInputs);
+		}
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, residentInputs);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(CullInstance) * residentCapacity, nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		residentCount = 0;
+	}
+
+	// Find the runs to copy: everything if what's there is out of date, otherwise just the changed objects.
+	residentRuns.clear();
+
+	if (residentCount != count)
+	{
+		residentRuns.push_back(0);
+		residentRuns.push_back(count);
+	}
+	else
+	{
+		int i = 0;
+
+		while (i < count)
+		{
+			if (!changed[i])
+			{
+				i++;
+				continue;
+			}
+
+			int last = i;
+
+			for (int j = i + 1; j < count && j - last <= MERGE_GAP; j++)
+			{
+				if (changed[j])
+				{
+					last = j;
+				}
+			}
+
+			residentRuns.push_back(i);
+			residentRuns.push_back(last + 1);
+
+			i = last + 1;
+		}
+	}
+
+	residentCount = count;
+
+	// Write the runs one after another into the stream buffer, then have the GPU copy each one over its objects' old place. (The copies
+	// happen in order with the draws, so last frame's cull still reads what was there before.)
+	residentScratch.clear();
+
+	for (int r = 0; r < (int)residentRuns.size(); r += 2)
+	{
+		residentScratch.insert(residentScratch.end(), cullScratch.begin() + residentRuns[r], cullScratch.begin() + residentRuns[r + 1]);
+	}
+
+	GJK_PROFILE_COUNT("instances uploaded", (long long)residentScratch.size());
+
+	if (residentScratch.empty())
+	{
+		return;
+	}
+
+	GLsizeiptr size = sizeof(CullInstance) * residentScratch.size();
+
+	cullInputs.Reserve(size);
+	GLsizeiptr offset = cullInputs.Write(residentScratch.data(), size);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, cullInputs.GetBuffer());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, residentInputs);
+
+	for (int r = 0; r < (int)residentRuns.size(); r += 2)
+	{
+		GLsizeiptr runSize = sizeof(CullInstance) * (residentRuns[r + 1] - residentRuns[r]);
+
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, sizeof(CullInstance) * residentRuns[r], runSize);
+		offset += runSize;
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void ModelPool::readCounts()
+{
+	for (int i = 0; i < NUM_COUNT_BUFFERS; i++)
+	{
+		if (countFences[i] == 0)
+		{
+			continue;
+		}
+
+		GLenum result = glClientWaitSync(countFences[i], 0, 0);
+
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+		{
+			continue;
+		}
+
+		glDeleteSync(countFences[i]);
+		countFences[i] = 0;
+
+		GLuint counts[2] = { 0, 0 };
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffers[i]);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(counts), counts);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		GJK_PROFILE_COUNT("instances in frustum", (long long)counts[0]);
+		GJK_PROFILE_COUNT("instances occluded", (long long)counts[1]);
+	}
+}
+
+#endif // _MODEL_POOL_CPP
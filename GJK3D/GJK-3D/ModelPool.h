@@ -0,0 +1,317 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ModelPool.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MODEL_POOL_H
+#define _MODEL_POOL_H
+
+#include "Model.h"
+#include "DepthPyramid.h"
+#include "Frustum.h"
+#include "ShaderProgram.h"
+#include <vector>
+
+// Where one model's vertices and indices are in a ModelPool's buffers.
+struct PooledModel
+{
+	const Model* model;
+
+	// The model's first vertex and first index in the shared buffers, and how many indices it has.
+	// Its indices are stored as they are in the model (starting from 0), and the draw adds baseVertex to each one.
+	int baseVertex;
+	int firstIndex;
+	int numIndices;
+
+	// The model's levels of detail in the pool's levels, starting with the model itself (level 0), so there's always at least one.
+	int firstLevel;
+	int numLevels;
+};
+
+// One level of detail of a pooled model: where its indices are in the shared index buffer, and how far out of place it is as a fraction of
+// the model's size (see ModelLOD; 0 for the model itself).
+struct PooledLevel
+{
+	int firstIndex;
+	int numIndices;
+	float error;
+};
+
+// One draw in a glMultiDrawElementsIndirect call, laid out exactly the way OpenGL reads it from the indirect buffer.
+struct DrawElementsIndirectCommand
+{
+	GLuint count;			// How many indices to draw.
+	GLuint instanceCount;	// How many instances.
+	GLuint firstIndex;		// The first index to read, counted in indices (not bytes).
+	GLint baseVertex;		// Added to every index.
+	GLuint baseInstance;	// The first instance's transform in the instance buffer.
+};
+
+// One object for the cull shader to test, laid out the same as CullInstance in CullShader.glsl (std430 puts each vec3 on a 16 byte boundary,
+// so the uints fill in the gaps after them, and there's a gap after the transform).
+struct CullInstance
+{
+	InstanceTransform transform;
+	GLuint padding;
+	glm::vec3 boundsMin;
+	GLuint firstLevel;
+	glm::vec3 boundsMax;
+	GLuint numLevels;
+};
+
+// Keeps the vertices and indices of many models together in one big vertex buffer and one big index buffer.
+// Every model having its own buffers (and vao) means switching models between draws is a rebind every time. Here all of them share one
+// vao, so we bind once and then each model is just a different part of the same buffers: a base-vertex draw starts reading the index buffer at
+// the model's first index, and adds its base vertex to every index. This is also what's needed to draw many different models from one
+// command buffer (multi-draw indirect).
+// All of the models in a pool are stored in the same VertexLayout (always interleaved, so that growing the buffers can copy them over as is).
+class ModelPool
+{
+	VertexLayout layout;
+
+	GLuint vao;
+	GLuint vbo;
+	GLuint ebo;
+
+	// How many vertices and indices the buffers have room for, and how many are used.
+	int vertexCapacity;
+	int indexCapacity;
+	int numVertices;
+	int numIndices;
+
+	std::vector<PooledModel> models;
+	std::vector<PooledLevel> levels;
+
+	// How far out of place a level of detail is allowed to look, as a fraction of the screen's height (see SetLODError).
+	float lodError;
+
+	// Every level's error, one float each, for the cull shader (and how many there are). This is remade whenever a model is added.
+	GLuint levelErrors;
+	int levelErrorCount;
+
+	// Picks the level of detail (in levels) to draw a model at, for an object with the given bounds in world space.
+	int selectLevel(const PooledModel& pooled, const AABB& bounds, const glm::mat4& viewProjection) const;
+
+	// The per-instance transforms for every draw this frame, one after another.
+	StreamBuffer instances;
+
+	// The indirect draw commands for DrawBatched.
+	StreamBuffer commandBuffer;
+
+	// DrawBatched's working space, kept around so it doesn't have to allocate every frame: which group (level and depth band) each object
+	// goes in, how far away it is, where each group's instances start, the transforms sorted by group, and the commands.
+	std::vector<int> groupKeys;
+	std::vector<float> depths;
+	std::vector<int> groupStart;
+	std::vector<InstanceTransform> sortedTransforms;
+	std::vector<DrawElementsIndirectCommand> commands;
+
+	// The compute shader program for DrawCulled (0 if there isn't one), and its uniforms.
+	GLuint cullProgram;
+	GLint cullViewProjection;
+	GLint cullPlanes;
+	GLint cullNumInstances;
+	GLint cullLodScale;
+	GLint cullLodError;
+	GLint cullOcclusion;
+	GLint cullPyramid;
+	GLint cullPyramidViewProjection;
+	GLint cullDepthSize;
+	GLint cullPyramidLevels;
+
+	// The depth pyramid the cull shader tests against (see SetOcclusion), or nullptr for none.
+	const DepthPyramid* occlusion;
+
+	// Where the cull shader counts how many instances were in the frustum and how many of those were hidden, one buffer per frame in a ring,
+	// with a fence after each frame's cull. A frame's counts are read back once its fence has passed, so counting never waits on the GPU.
+	static const int NUM_COUNT_BUFFERS = 4;
+
+	GLuint countBuffers[NUM_COUNT_BUFFERS];
+	GLsync countFences[NUM_COUNT_BUFFERS];
+	int nextCountBuffer;
+
+	// Reads back the counts of every frame whose cull has finished.
+	void readCounts();
+
+	// The objects for the cull shader to test, uploaded every frame (unless DrawCulled is told which ones changed). cullScratch always has
+	// every object as of the last DrawCulled, so the ones that didn't change can be left as they are.
+	StreamBuffer cullInputs;
+	std::vector<CullInstance> cullScratch;
+
+	// When DrawCulled is told which objects changed, the cull shader reads them from here instead, which keeps every object between frames,
+	// and only the changed ones are copied over (see uploadResident). residentCount is how many of them are the same as cullScratch (0
+	// once it's out of date), and residentCapacity how many there's room for.
+	GLuint residentInputs;
+	int residentCapacity;
+	int residentCount;
+
+	// uploadResident's working space: each run of objects to copy (its first object and one past its last), and the objects themselves.
+	std::vector<int> residentRuns;
+	std::vector<CullInstance> residentScratch;
+
+	// Brings residentInputs up to date with the first count objects in cullScratch, copying over only the changed ones (all of them, if
+	// it's out of date).
+	void uploadResident(const unsigned char* changed, int count);
+
+	// Where the cull shader writes the transforms of the visible objects. Only the GPU ever touches it, so it's a plain buffer.
+	GLuint culledInstances;
+	int culledCapacity;
+
+	// DrawCulled's working space when it has to cull on the CPU: the objects that passed, their levels of detail, and their transforms.
+	std::vector<int> visibleModels;
+	std::vector<int> visibleLevels;
+	std::vector<InstanceTransform> visibleTransforms;
+
+	// Writes transforms into the instance buffer (setting up the attributes again if it had to grow), and returns the first one's instance
+	// number.
+	GLuint writeInstances(const InstanceTransform* transforms, int count);
+
+	// Creates the vao and buffers. This waits until the first model is added, since there might not be an OpenGL context before then.
+	void create();
+
+	// Makes a buffer bigger, keeping what was in it, and returns the new one.
+	GLuint grow(GLuint buffer, GLsizeiptr oldSize, GLsizeiptr newSize);
+
+public:
+	ModelPool(const VertexLayout& vertexLayout = VertexLayout::Compact());
+	~ModelPool();
+
+	// Copies a model's vertices and indices into the pool, along with its levels of detail (see Model::GenerateLODs), and returns the id to
+	// draw it with. The pool holds a reference to the model until it goes away, so the model can't be freed and another one made at the same
+	// address while Find still knows it. Changes to the model after this won't show up in the pool. (The model doesn't need buffers of its own to be added.)
+	// A model that's released its CPU copy is copied from its own buffers instead, which only works if it's in the pool's layout (interleaved);
+	// if it isn't, it isn't added, and this returns -1.
+	int Add(Model* model);
+
+	// The id a model was added with, or -1 if it hasn't been.
+	int Find(const Model* model) const;
+
+	const PooledModel& GetModel(int id) const
+	{
+		return models[id];
+	}
+	int NumModels() const
+	{
+		return (int)models.size();
+	}
+	const PooledLevel& GetLevel(int id, int level) const
+	{
+		return levels[models[id].firstLevel + level];
+	}
+
+	// Sets how far out of place a level of detail can look before a finer one is drawn instead, as a fraction of the screen's height: an object
+	// gets the coarsest level whose error (a fraction of the model's size) times how tall the object's bounds are on screen is no more than
+	// this. The default is 0.002, or about 2 pixels at 1080p. 0 always draws the models themselves.
+	void SetLODError(float error)
+	{
+		lodError = error;
+	}
+	float GetLODError() const
+	{
+		return lodError;
+	}
+
+	// Picks the level of detail to draw a model at (0 being the model itself), for an object with the given bounds in world space seen
+	// through viewProjection. Objects the camera is inside of always get level 0.
+	int SelectLOD(int id, const AABB& bounds, const glm::mat4& viewProjection) const
+	{
+		return selectLevel(models[id], bounds, viewProjection) - models[id].firstLevel;
+	}
+
+	// Binds the pool's vao. Call this once before drawing any number of the pool's models.
+	void Begin();
+
+	// Draws count copies of a model at the given level of detail, the i-th one with transforms[i] as its transform (see InstanceTransform
+	// in VertexLayout.h). The camera is whatever's bound for the vertex shader's Camera block (see VertexLayout::CAMERA_BINDING). Only call
+	// this between Begin and End.
+	void DrawInstanced(int id, const InstanceTransform* transforms, int count, int level = 0);
+
+	// The same, but with the transforms already in a buffer of the caller's (the first count in it), such as one a compute shader wrote, so
+	// they never come back to the CPU. Whatever wrote them has to be finished with them (see glMemoryBarrier) before this is called.
+	void DrawInstancedFromBuffer(int id, GLuint buffer, int count, int level = 0);
+
+	// Draws count objects, the i-th one being model modelIds[i] with transforms[i] as its transform, in any order, at level of
+	// detail levelIds[i] (or all at level 0, without levelIds). viewProjection should be the camera the Camera block holds; it's only used
+	// here to tell how far away each object is.
+	// The objects are grouped by level, with one indirect command per level of each model, and all of them go out in a single
+	// glMultiDrawElementsIndirect call (which needs OpenGL 4.3 or ARB_multi_draw_indirect; without it, each level is its own DrawInstanced).
+	// Within each level the objects are drawn roughly front to back, and the commands go in order of their nearest objects, so that the depth
+	// test can throw away as much of what's hidden as it can before it's shaded. Only call this between Begin and End.
+	void DrawBatched(const int* modelIds, const InstanceTransform* transforms, int count, const glm::mat4& viewProjection,
+		const int* levelIds = nullptr);
+
+	// Hands the pool a linked compute shader program (made from CullShader.glsl) for DrawCulled to use. Call this again whenever the program
+	// is reloaded. Returns false (and keeps culling on the CPU) if compute shaders aren't supported, which needs OpenGL 4.3.
+	bool SetCullProgram(const ShaderProgram& program);
+
+	// Whether DrawCulled culls on the GPU.
+	bool CanCull() const
+	{
+		return cullProgram != 0;
+	}
+
+	// Has DrawCulled's cull shader also throw out the objects that were hidden in the depth pyramid's frame (see DepthPyramid.h), as well as
+	// the ones outside the frustum, while the pyramid is valid. This is the pyramid from the last frame, so build it after the objects have
+	// been drawn. Pass nullptr to turn it off. Only the GPU path does this: the CPU would have to wait for the depth to be read back.
+	// Either way, how many of the objects were in the frustum goes to the profiler as "instances in frustum" every frame, and how many of
+	// those were hidden as "instances occluded" (a few frames late, once the GPU has counted them).
+	void SetOcclusion(const DepthPyramid* pyramid)
+	{
+		occlusion = pyramid;
+	}
+	const DepthPyramid* GetOcclusion() const
+	{
+		return occlusion;
+	}
+
+	// Draws whichever of count objects are inside the frustum of viewProjection, the i-th one being model modelIds[i] with transforms[i] as
+	// its transform and bounds[i] as its bounds in world space.
+	// Each visible object is drawn at the level of detail SelectLOD picks for it. (Only the CPU path sorts them front to back, as DrawBatched
+	// does: the cull shader writes the visible objects out in whatever order its invocations finish.)
+	// With a cull program, everything goes to the GPU as is: a compute shader tests each object's bounds, picks its level, and writes the
+	// transforms of the visible ones, packed together by level, along with how many there are of each straight into the indirect commands. So
+	// the CPU never looks at the frustum or touches a transform, and the draw is still a single glMultiDrawElementsIndirect. Without
+	// one, the objects are culled on the CPU and go through DrawBatched. Only call this between Begin and End.
+	// Most objects in most scenes are asleep or static, and sending every one of them again each frame is mostly sending what the GPU already
+	// has. Given changed (count flags), the pool keeps every object from one frame to the next, and only object i's with changed[i] set
+	// are read from transforms and bounds and sent to the GPU (as "instances uploaded" to the profiler); the others stay as they were, and
+	// what's in transforms and bounds for them doesn't matter. So an object has to be changed whenever its transform, bounds or model are
+	// different from the last time it was. Every object is sent the first time, and whenever count is different from the last call.
+	void DrawCulled(const int* modelIds, const InstanceTransform* transforms, const AABB* bounds, int count, const glm::mat4& viewProjection,
+		const unsigned char* changed = nullptr);
+
+	// Unbinds the vao, and marks the end of this frame's instance data.
+	void End();
+};
+
+#endif //_MODEL_POOL_H
@@ -0,0 +1,647 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PerformanceOverlay.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PERFORMANCE_OVERLAY_CPP
+#define _PERFORMANCE_OVERLAY_CPP
+
+#include "PerformanceOverlay.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include <cctype>
+#include <cstring>
+#include <sstream>
+
+// The memory use comes from Windows. With PSAPI_VERSION 2, GetProcessMemoryInfo is the one in kernel32 (Windows 7 and up), so there's no
+// extra library to link.
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+// The font. Each character is 3 pixels wide and 5 tall, given here one row at a time from the top, with a 1 for each pixel that's lit.
+// It only has what the overlay needs: capital letters (lower case is drawn as upper case), numbers and a few symbols.
+struct FontGlyph
+{
+	char character;
+	const char* pixels;
+};
+
+static const FontGlyph font[] =
+{
+	{ '0', "111101101101111" }, { '1', "010110010010111" }, { '2', "111001111100111" }, { '3', "111001111001111" },
+	{ '4', "101101111001001" }, { '5', "111100111001111" }, { '6', "111100111101111" }, { '7', "111001001001001" },
+	{ '8', "111101111101111" }, { '9', "111101111001111" },
+	{ 'A', "010101111101101" }, { 'B', "110101110101110" }, { 'C', "011100100100011" }, { 'D', "110101101101110" },
+	{ 'E', "111100110100111" }, { 'F', "111100110100100" }, { 'G', "011100101101011" }, { 'H', "101101111101101" },
+	{ 'I', "111010010010111" }, { 'J', "001001001101010" }, { 'K', "101101110101101" }, { 'L', "100100100100111" },
+	{ 'M', "101111111101101" }, { 'N', "110101101101101" }, { 'O', "010101101101010" }, { 'P', "110101110100100" },
+	{ 'Q', "010101101110011" }, { 'R', "110101110101101" }, { 'S', "011100010001110" }, { 'T', "111010010010010" },
+	{ 'U', "101101101101111" }, { 'V', "101101101101010" }, { 'W', "101101111111101" }, { 'X', "101101010101101" },
+	{ 'Y', "101101010010010" }, { 'Z', "111001010100111" },
+	{ '.', "000000000000010" }, { '/', "001001010100100" }, { ':', "000010000010000" }, { '-', "000000111000000" },
+	{ '+', "000010111010000" }, { '=', "000111000111000" }, { '(', "010100100100010" }, { ')', "010001001001010" },
+	{ '%', "101001010100101" }, { '<', "001010100010001" }, { '>', "100010001010100" }
+};
+
+// How big each pixel of the font is on the screen, and how far apart the characters and lines are, in screen pixels.
+static const float FONT_SCALE = 2.0f;
+static const float CHARACTER_ADVANCE = 4.0f * FONT_SCALE;
+static const float LINE_HEIGHT = 7.0f * FONT_SCALE;
+
+// How often the text is refreshed, in seconds.
+static const double REFRESH_INTERVAL = 0.25;
+
+// The frame times that the graph and histogram are colored by (60 and 30 frames per second), in seconds.
+static const double GOOD_FRAME = 1.0 / 60.0;
+static const double OK_FRAME = 1.0 / 30.0;
+
+static const glm::vec4 BACKGROUND_COLOR = glm::vec4(0.0f, 0.0f, 0.0f, 0.65f);
+static const glm::vec4 TEXT_COLOR = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+static const glm::vec4 GUIDE_COLOR = glm::vec4(1.0f, 1.0f, 1.0f, 0.25f);
+static const glm::vec4 GOOD_COLOR = glm::vec4(0.3f, 0.9f, 0.3f, 1.0f);
+static const glm::vec4 OK_COLOR = glm::vec4(0.95f, 0.8f, 0.2f, 1.0f);
+static const glm::vec4 BAD_COLOR = glm::vec4(0.95f, 0.3f, 0.25f, 1.0f);
+
+// The longest frame time (in seconds) that goes into each bucket of the histogram, and what's written under it.
+static const double BUCKET_LIMITS[] = { 0.004, 0.008, GOOD_FRAME, OK_FRAME, 2.0 * OK_FRAME, 1e30 };
+static const char* BUCKET_NAMES[] = { "<4", "<8", "<17", "<33", "<67", "67+" };
+
+// The color for a frame that took the given time.
+static const glm::vec4& frameColor(double seconds)
+{
+	if (seconds <= GOOD_FRAME)
+	{
+		return GOOD_COLOR;
+	}
+
+	return seconds <= OK_FRAME ? OK_COLOR : BAD_COLOR;
+}
+
+// Writes a number with the given number of decimal places.
+static std::string formatNumber(double value, int decimals)
+{
+	std::ostringstream stream;
+	stream.setf(std::ios::fixed);
+	stream.precision(decimals);
+	stream << value;
+
+	return stream.str();
+}
+
+// How much memory the program is using (its working set), in megabytes, or less than 0 if we can't tell.
+static double memoryMegabytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS memory;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory)))
+	{
+		return memory.WorkingSetSize / (1024.0 * 1024.0);
+	}
+#endif
+
+	return -1.0;
+}
+
+PerformanceOverlay::PerformanceOverlay()
+{
+	visible = true;
+
+	for (int i = 0; i < HISTORY; i++)
+	{
+		frameTimes[i] = 0.0;
+	}
+
+	next = 0;
+	recorded = 0;
+
+	elapsed = 0.0;
+	frames = 0;
+	longestFrame = 0.0;
+	steps = 0;
+	stepSeconds = 0.0;
+	queries = 0;
+	iterations = 0;
+	supportCalls = 0;
+	pairs = 0;
+	contacts = 0;
+	gpuChecks = 0;
+	gpuPairs = 0;
+	gpuHits = 0;
+	gpuDifferent = 0;
+	latencyMicroseconds = 0;
+	latencySamples = 0;
+	renderSeconds = 0.0;
+	gpuFrames = 0;
+	gpuClearMicroseconds = 0;
+	gpuDebrisMicroseconds = 0;
+	gpuOpaqueMicroseconds = 0;
+	gpuPyramidMicroseconds = 0;
+	gpuDebugDrawMicroseconds = 0;
+	instancesInFrustum = 0;
+	instancesOccluded = 0;
+	instancesUploaded = 0;
+	uploadFrames = 0;
+
+	// Turn the font into one bit per pixel, with the top left pixel in the highest bit.
+	memset(glyphs, 0, sizeof(glyphs));
+
+	for (int i = 0; i < (int)(sizeof(font) / sizeof(font[0])); i++)
+	{
+		unsigned short bits = 0;
+
+		for (int pixel = 0; pixel < 15; pixel++)
+		{
+			bits = (unsigned short)((bits << 1) | (font[i].pixels[pixel] == '1' ? 1 : 0));
+		}
+
+		glyphs[(int)font[i].character] = bits;
+	}
+
+	// The vertices are plain VertexFormats (a float color and position, and no normal), so the default layout fits them.
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+	layout.SetAttributes(0);
+
+	glBindVertexArray(0);
+
+	glm::mat4 identity(1.0f);
+
+	glGenBuffers(1, &camera);
+	glBindBuffer(GL_UNIFORM_BUFFER, camera);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), &identity[0][0], GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+PerformanceOverlay::~PerformanceOverlay()
+{
+	glDeleteBuffers(1, &camera);
+	glDeleteBuffers(1, &vbo);
+	glDeleteVertexArrays(1, &vao);
+}
+
+void PerformanceOverlay::Update(const char* broadphaseName, const std::string& pacingName, const StepCounters& counters)
+{
+	Profiler& profiler = Profiler::Get();
+	double frameTime = profiler.GetFrameTime();
+
+	frameTimes[next] = frameTime;
+	next = (next + 1) % HISTORY;
+
+	if (recorded < HISTORY)
+	{
+		recorded++;
+	}
+
+	elapsed += frameTime;
+	frames++;
+	longestFrame = frameTime > longestFrame ? frameTime : longestFrame;
+
+	// Every physics step is a "physics step" zone, wherever it ran, and drawing the scene is the "render" zone.
+	std::vector<ProfileZoneStats> zones = profiler.GetFrameZones();
+
+	for (int i = 0; i < (int)zones.size(); i++)
+	{
+		if (strcmp(zones[i].name, "physics step") == 0)
+		{
+			steps += zones[i].calls;
+			stepSeconds += zones[i].seconds;
+		}
+		else if (strcmp(zones[i].name, "render") == 0)
+		{
+			renderSeconds += zones[i].seconds;
+		}
+	}
+
+	std::vector<ProfileCounterStats> frameCounters = profiler.GetFrameCounters();
+
+	for (int i = 0; i < (int)frameCounters.size(); i++)
+	{
+		const char* name = frameCounters[i].name;
+		long long value = frameCounters[i].value;
+
+		if (strcmp(name, "gjk queries") == 0)
+		{
+			queries += value;
+		}
+		else if (strcmp(name, "gjk iterations") == 0)
+		{
+			iterations += value;
+		}
+		else if (strcmp(name, "gjk support calls") == 0)
+		{
+			supportCalls += value;
+		}
+		else if (strcmp(name, "pairs tested") == 0)
+		{
+			pairs += value;
+		}
+		else if (strcmp(name, "contacts") == 0)
+		{
+			contacts += value;
+		}
+		else if (strcmp(name, "gpu checks") == 0)
+		{
+			gpuChecks += value;
+		}
+		else if (strcmp(name, "gpu pairs") == 0)
+		{
+			gpuPairs += value;
+		}
+		else if (strcmp(name, "gpu hits") == 0)
+		{
+			gpuHits += value;
+		}
+		else if (strcmp(name, "gpu different") == 0)
+		{
+			gpuDifferent += value;
+		}
+		else if (strcmp(name, "input latency us") == 0)
+		{
+			latencyMicroseconds += value;
+		}
+		else if (strcmp(name, "input latency samples") == 0)
+		{
+			latencySamples += value;
+		}
+		else if (strcmp(name, "gpu frames timed") == 0)
+		{
+			gpuFrames += value;
+		}
+		else if (strcmp(name, "gpu clear us") == 0)
+		{
+			gpuClearMicroseconds += value;
+		}
+		else if (strcmp(name, "gpu debris us") == 0)
+		{
+			gpuDebrisMicroseconds += value;
+		}
+		else if (strcmp(name, "gpu opaque us") == 0)
+		{
+			gpuOpaqueMicroseconds += value;
+		}
+		else if (strcmp(name, "gpu depth pyramid us") == 0)
+		{
+			gpuPyramidMicroseconds += value;
+		}
+		else if (strcmp(name, "gpu debug draw us") == 0)
+		{
+			gpuDebugDrawMicroseconds += value;
+		}
+		else if (strcmp(name, "instances in frustum") == 0)
+		{
+			instancesInFrustum += value;
+		}
+		else if (strcmp(name, "instances occluded") == 0)
+		{
+			instancesOccluded += value;
+		}
+		else if (strcmp(name, "instances uploaded") == 0)
+		{
+			instancesUploaded += value;
+			uploadFrames++;
+		}
+	}
+
+	if (elapsed >= REFRESH_INTERVAL || lines.empty())
+	{
+		refresh(broadphaseName, pacingName, counters);
+	}
+}
+
+void PerformanceOverlay::refresh(const char* broadphaseName, const std::string& pacingName, const StepCounters& counters)
+{
+	lines.clear();
+
+	double fps = elapsed > 0.0 ? frames / elapsed : 0.0;
+	double averageFrame = frames > 0 ? elapsed / frames : 0.0;
+
+	lines.push_back("FPS " + formatNumber(fps, 0) + "  FRAME " + formatNumber(averageFrame * 1000.0, 2) + " MS  MAX " +
+		formatNumber(longestFrame * 1000.0, 2) + " MS");
+	lines.push_back("PACING " + pacingName + "  LATENCY " +
+		(latencySamples > 0 ? formatNumber(latencyMicroseconds / 1000.0 / latencySamples, 2) + " MS" : std::string("-")));
+
+	// Until the first physics step has been profiled, there's nothing to show for it.
+	if (steps > 0)
+	{
+		lines.push_back("PHYSICS " + formatNumber(stepSeconds * 1000.0 / steps, 3) + " MS/STEP  " + formatNumber((double)steps / frames, 2) +
+			" STEPS/FRAME");
+		lines.push_back("GJK " + formatNumber((double)queries / steps, 1) + " QUERIES/STEP  " +
+			formatNumber(queries > 0 ? (double)iterations / queries : 0.0, 2) + " ITER/QUERY");
+		lines.push_back("SUPPORT " + formatNumber(queries > 0 ? (double)supportCalls / queries : 0.0, 2) + "/QUERY  PAIRS " +
+			formatNumber((double)pairs / steps, 1) + "/STEP  CONTACTS " + formatNumber((double)contacts / steps, 1) + "/STEP");
+	}
+	else
+	{
+		lines.push_back("PHYSICS -");
+		lines.push_back("GJK -");
+		lines.push_back("SUPPORT -");
+	}
+
+	// What a frame costs the CPU to draw, next to what it costs the GPU, pass by pass (see GPUTimer), and whichever of those or the physics
+	// takes the longest per frame, which is what's holding the frame rate back.
+	double renderMilliseconds = frames > 0 ? renderSeconds * 1000.0 / frames : 0.0;
+	double physicsMilliseconds = frames > 0 ? stepSeconds * 1000.0 / frames : 0.0;
+
+	if (gpuFrames > 0)
+	{
+		double clearMilliseconds = gpuClearMicroseconds / 1000.0 / gpuFrames;
+		double debrisMilliseconds = gpuDebrisMicroseconds / 1000.0 / gpuFrames;
+		double opaqueMilliseconds = gpuOpaqueMicroseconds / 1000.0 / gpuFrames;
+		double pyramidMilliseconds = gpuPyramidMicroseconds / 1000.0 / gpuFrames;
+		double debugDrawMilliseconds = gpuDebugDrawMicroseconds / 1000.0 / gpuFrames;
+		double gpuMilliseconds = clearMilliseconds + debrisMilliseconds + opaqueMilliseconds + pyramidMilliseconds + debugDrawMilliseconds;
+
+		const char* limit = "GPU";
+
+		if (renderMilliseconds >= gpuMilliseconds && renderMilliseconds >= physicsMilliseconds)
+		{
+			limit = "RENDER";
+		}
+		else if (physicsMilliseconds >= gpuMilliseconds)
+		{
+			limit = "PHYSICS";
+		}
+
+		lines.push_back("RENDER CPU " + formatNumber(renderMilliseconds, 2) + " MS  GPU " + formatNumber(gpuMilliseconds, 2) + " MS (CLEAR " +
+			formatNumber(clearMilliseconds, 2) + " DEBRIS " + formatNumber(debrisMilliseconds, 2) + " OPAQUE " + formatNumber(opaqueMilliseconds, 2) +
+			" HI-Z " + formatNumber(pyramidMilliseconds, 2) + " DEBUG " + formatNumber(debugDrawMilliseconds, 2) + ")  LIMIT " + limit);
+	}
+	else
+	{
+		lines.push_back("RENDER CPU " + formatNumber(renderMilliseconds, 2) + " MS  GPU -");
+	}
+
+	// How many of the objects the culling let through, and how many of the ones in the frustum were hidden (see ModelPool::SetOcclusion).
+	// (With the culling on the GPU, its counts come back a few frames late, so these are over whichever frames they came back for.)
+	if (instancesInFrustum > 0)
+	{
+		lines.push_back("CULLING " + formatNumber((double)instancesInFrustum / frames, 0) + " IN FRUSTUM/FRAME  " +
+			formatNumber(100.0 * instancesOccluded / instancesInFrustum, 1) + "% OCCLUDED");
+	}
+
+	// How many objects had changed, and had to be sent to the GPU again.
+	if (uploadFrames > 0)
+	{
+		lines.push_back("UPLOADED " + formatNumber((double)instancesUploaded / uploadFrames, 0) + " INSTANCES/FRAME");
+	}
+
+	// The GPU check only gets a line while it's running.
+	if (gpuChecks > 0)
+	{
+		lines.push_back("GPU GJK " + formatNumber((double)gpuPairs / gpuChecks, 1) + " PAIRS/CHECK  " + formatNumber((double)gpuHits / gpuChecks, 1) +
+			" HITS/CHECK  " + std::to_string(gpuDifferent) + " DIFFERENT");
+	}
+
+	lines.push_back("BROADPHASE " + std::string(broadphaseName) + "  DROPPED " + std::to_string(counters.droppedSteps) + " STEPS" +
+		(counters.degraded ? "  (DEGRADED)" : ""));
+
+	double memory = memoryMegabytes();
+
+	lines.push_back("MEMORY " + (memory >= 0.0 ? formatNumber(memory, 1) + " MB" : std::string("-")));
+
+	// Then where it's going, as far as we count it (see MemoryTracker.h), with the peak of each.
+	std::string tracked;
+
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+	{
+		MemoryUsage usage = GetMemoryUsage((MemoryTag)i);
+
+		tracked += std::string(i > 0 ? "  " : "") + GetMemoryTagName((MemoryTag)i) + " " + formatNumber(usage.current / 1048576.0, 1) + "/" +
+			formatNumber(usage.peak / 1048576.0, 1);
+	}
+
+	lines.push_back(tracked + " MB");
+
+	elapsed = 0.0;
+	frames = 0;
+	longestFrame = 0.0;
+	steps = 0;
+	stepSeconds = 0.0;
+	queries = 0;
+	iterations = 0;
+	supportCalls = 0;
+	pairs = 0;
+	contacts = 0;
+	gpuChecks = 0;
+	gpuPairs = 0;
+	gpuHits = 0;
+	gpuDifferent = 0;
+	latencyMicroseconds = 0;
+	latencySamples = 0;
+	renderSeconds = 0.0;
+	gpuFrames = 0;
+	gpuClearMicroseconds = 0;
+	gpuDebrisMicroseconds = 0;
+	gpuOpaqueMicroseconds = 0;
+	gpuPyramidMicroseconds = 0;
+	gpuDebugDrawMicroseconds = 0;
+	instancesInFrustum = 0;
+	instancesOccluded = 0;
+	instancesUploaded = 0;
+	uploadFrames = 0;
+}
+
+void PerformanceOverlay::addRect(float x, float y, float width, float height, const glm::vec4& color)
+{
+	// Two triangles, with the corners at z = 0 (the overlay is drawn with no depth test, so it goes over everything).
+	glm::vec3 topLeft = glm::vec3(x, y, 0.0f);
+	glm::vec3 topRight = glm::vec3(x + width, y, 0.0f);
+	glm::vec3 bottomLeft = glm::vec3(x, y + height, 0.0f);
+	glm::vec3 bottomRight = glm::vec3(x + width, y + height, 0.0f);
+
+	vertices.push_back(VertexFormat(topLeft, color));
+	vertices.push_back(VertexFormat(topRight, color));
+	vertices.push_back(VertexFormat(bottomRight, color));
+
+	vertices.push_back(VertexFormat(topLeft, color));
+	vertices.push_back(VertexFormat(bottomRight, color));
+	vertices.push_back(VertexFormat(bottomLeft, color));
+}
+
+float PerformanceOverlay::addText(float x, float y, const std::string& text, const glm::vec4& color)
+{
+	for (int i = 0; i < (int)text.size(); i++)
+	{
+		int character = toupper((unsigned char)text[i]);
+		unsigned short bits = character < 128 ? glyphs[character] : 0;
+
+		// Each lit pixel of the character is one square.
+		for (int pixel = 0; pixel < 15; pixel++)
+		{
+			if (bits & (1 << (14 - pixel)))
+			{
+				addRect(x + CHARACTER_ADVANCE * i + (pixel % 3) * FONT_SCALE, y + (pixel / 3) * FONT_SCALE, FONT_SCALE, FONT_SCALE, color);
+			}
+		}
+	}
+
+	return CHARACTER_ADVANCE * text.size();
+}
+
+void PerformanceOverlay::Draw(GLuint program, int width, int height)
+{
+	if (!visible || width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	vertices.clear();
+
+	const float margin = 8.0f;
+	const float padding = 6.0f;
+	const float graphHeight = 40.0f;
+	const float barWidth = 2.0f;
+	const float bucketWidth = 36.0f;
+
+	// Work out how big the panel has to be before adding anything, since the background has to go first to be drawn behind the rest.
+	float textWidth = 0.0f;
+
+	for (int i = 0; i < (int)lines.size(); i++)
+	{
+		textWidth = glm::max(textWidth, CHARACTER_ADVANCE * lines[i].size());
+	}
+
+	float panelWidth = glm::max(textWidth, glm::max(HISTORY * barWidth, NUM_BUCKETS * bucketWidth)) + padding * 2.0f;
+	float panelHeight = padding + LINE_HEIGHT * lines.size() + padding + graphHeight + padding + graphHeight + LINE_HEIGHT + padding;
+
+	addRect(margin, margin, panelWidth, panelHeight, BACKGROUND_COLOR);
+
+	float x = margin + padding;
+	float y = margin + padding;
+
+	for (int i = 0; i < (int)lines.size(); i++)
+	{
+		addText(x, y, lines[i], TEXT_COLOR);
+		y += LINE_HEIGHT;
+	}
+
+	y += padding;
+
+	// The graph: one bar per frame, oldest on the left, where the full height is two 30 FPS frames. The lines across it mark 60 and 30 FPS.
+	double graphScale = graphHeight / (2.0 * OK_FRAME);
+
+	addRect(x, y + graphHeight - (float)(GOOD_FRAME * graphScale), HISTORY * barWidth, 1.0f, GUIDE_COLOR);
+	addRect(x, y + graphHeight - (float)(OK_FRAME * graphScale), HISTORY * barWidth, 1.0f, GUIDE_COLOR);
+
+	for (int i = 0; i < recorded; i++)
+	{
+		double frameTime = frameTimes[(next - recorded + i + HISTORY) % HISTORY];
+		float barHeight = glm::min((float)(frameTime * graphScale), graphHeight);
+
+		addRect(x + i * barWidth, y + graphHeight - barHeight, barWidth, barHeight, frameColor(frameTime));
+	}
+
+	y += graphHeight + padding;
+
+	// The histogram: how many of those frames fell into each bucket, with the tallest bucket at the full height.
+	int bucketCounts[NUM_BUCKETS] = { 0 };
+	int tallest = 1;
+
+	for (int i = 0; i < recorded; i++)
+	{
+		int bucket = 0;
+
+		while (bucket < NUM_BUCKETS - 1 && frameTimes[i] > BUCKET_LIMITS[bucket])
+		{
+			bucket++;
+		}
+
+		bucketCounts[bucket]++;
+		tallest = bucketCounts[bucket] > tallest ? bucketCounts[bucket] : tallest;
+	}
+
+	for (int i = 0; i < NUM_BUCKETS; i++)
+	{
+		float barHeight = graphHeight * bucketCounts[i] / tallest;
+
+		addRect(x + i * bucketWidth, y + graphHeight - barHeight, bucketWidth - 4.0f, barHeight, frameColor(BUCKET_LIMITS[i]));
+		addText(x + i * bucketWidth, y + graphHeight + 2.0f, BUCKET_NAMES[i], TEXT_COLOR);
+	}
+
+	// Everything so far was in pixels from the top left of the window, and the shader wants it from -1 to 1 with y going up.
+	for (int i = 0; i < (int)vertices.size(); i++)
+	{
+		glm::vec3& position = vertices[i].position;
+
+		position.x = position.x / width * 2.0f - 1.0f;
+		position.y = 1.0f - position.y / height * 2.0f;
+	}
+
+	layout.Pack(vertices.data(), (int)vertices.size(), packed);
+
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+	// The whole thing is a few thousand vertices, rebuilt every frame, so it's simplest to hand the driver a new buffer each time.
+	glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STREAM_DRAW);
+
+	glUseProgram(program);
+
+	// The overlay's vao doesn't have the instance transform (locations 2 through 4), so the shader reads the current value of those
+	// attributes instead. Setting them to a transform that does nothing leaves the positions as they are, and so does swapping in an
+	// identity camera for the real one (which is put back afterwards).
+	VertexLayout::SetIdentityInstance();
+
+	GLint sceneCamera;
+	glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, VertexLayout::CAMERA_BINDING, &sceneCamera);
+	glBindBufferBase(GL_UNIFORM_BUFFER, VertexLayout::CAMERA_BINDING, camera);
+
+	// Draw over everything, see through where the background is, and from either side.
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+
+	glDisable(GL_BLEND);
+	glEnable(GL_CULL_FACE);
+	glEnable(GL_DEPTH_TEST);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, VertexLayout::CAMERA_BINDING, (GLuint)sceneCamera);
+
+	glBindVertexArray(0);
+}
+
+#endif // _PERFORMANCE_OVERLAY_CPP
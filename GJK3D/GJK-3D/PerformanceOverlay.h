@@ -0,0 +1,157 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PerformanceOverlay.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PERFORMANCE_OVERLAY_H
+#define _PERFORMANCE_OVERLAY_H
+
+#include "GLIncludes.h"
+#include "VertexLayout.h"
+#include "StepScheduler.h"
+#include <string>
+#include <vector>
+
+// A panel drawn over the top left corner of the window, showing how the frame and the physics are doing: the frame rate, a graph of the
+// last few seconds of frame times and a histogram of them, how long a physics step takes and how many run each frame, how much GJK work
+// each step does, and how much memory the program is using.
+// Almost all of it comes from the profiler (see Profiler.h), so it shows whatever the profiled zones and counters measured, on every thread.
+// Everything is drawn as flat colored quads with the same shader as the models (with an identity transform and camera), using a tiny built in pixel font,
+// so it needs nothing more than what the demo already has.
+class PerformanceOverlay
+{
+	// How many frames the graph and histogram cover.
+	static const int HISTORY = 120;
+
+	// The histogram's buckets, as the longest frame time (in milliseconds) that goes in each one. The last bucket takes everything longer.
+	static const int NUM_BUCKETS = 6;
+
+	GLuint vao;
+	GLuint vbo;
+
+	// A uniform buffer holding just the identity matrix, which stands in for the camera while the overlay's drawn.
+	GLuint camera;
+
+	// The layout of the overlay's vertices (float colors and positions), and the vertices themselves, rebuilt every frame.
+	VertexLayout layout;
+	std::vector<VertexFormat> vertices;
+	std::vector<unsigned char> packed;
+
+	bool visible;
+
+	// The frame times of the last HISTORY frames, in seconds, going around in a ring. next is where the next one goes.
+	double frameTimes[HISTORY];
+	int next;
+	int recorded;
+
+	// What's been added up since the text was last refreshed. The numbers would be unreadable if they changed every frame, so they're
+	// averaged over a quarter of a second at a time.
+	double elapsed;
+	int frames;
+	double longestFrame;
+	int steps;
+	double stepSeconds;
+	long long queries;
+	long long iterations;
+	long long supportCalls;
+	long long pairs;
+	long long contacts;
+
+	// The same for the GPU narrowphase check (see checkNarrowphaseOnGPU in Main.cpp), if it's on: how many times it came back, and how many
+	// pairs it tested, found overlapping, and answered differently from the CPU.
+	long long gpuChecks;
+	long long gpuPairs;
+	long long gpuHits;
+	long long gpuDifferent;
+
+	// The input to present latency the FramePacer measured (in microseconds), added up, and how many times it measured it.
+	long long latencyMicroseconds;
+	long long latencySamples;
+
+	// How long the CPU spent drawing the scene (the "render" zone), and the GPU's time for each pass of it (see GPUTimer), in microseconds,
+	// added up over the frames the GPU timer read back.
+	double renderSeconds;
+	long long gpuFrames;
+	long long gpuClearMicroseconds;
+	long long gpuDebrisMicroseconds;
+	long long gpuOpaqueMicroseconds;
+	long long gpuPyramidMicroseconds;
+	long long gpuDebugDrawMicroseconds;
+
+	// How many objects were in the frustum, and how many of those occlusion culling threw out (see ModelPool::SetOcclusion), added up.
+	long long instancesInFrustum;
+	long long instancesOccluded;
+
+	// How many objects were sent to the GPU to be culled (only the ones that changed; see ModelPool::DrawCulled), and over how many frames.
+	long long instancesUploaded;
+	int uploadFrames;
+
+	// The text, as of the last refresh.
+	std::vector<std::string> lines;
+
+	// Each character's pixels, by ASCII code (see the font in PerformanceOverlay.cpp). 0 means the character isn't in the font.
+	unsigned short glyphs[128];
+
+	// Adds a rectangle (in pixels, from the top left of the window) in the given color.
+	void addRect(float x, float y, float width, float height, const glm::vec4& color);
+
+	// Adds a line of text, with its top left corner at (x, y) in pixels. Returns how wide it was.
+	float addText(float x, float y, const std::string& text, const glm::vec4& color);
+
+	// Rebuilds the text from what's been added up since the last refresh, and starts adding up again.
+	void refresh(const char* broadphaseName, const std::string& pacingName, const StepCounters& counters);
+
+public:
+	PerformanceOverlay();
+	~PerformanceOverlay();
+
+	void SetVisible(bool inVisible)
+	{
+		visible = inVisible;
+	}
+	bool IsVisible() const
+	{
+		return visible;
+	}
+
+	// Takes in the frame that just ended. Call this once a frame, after Profiler::EndFrame. The broadphase name, the frame pacing (see
+	// FramePacer) and the scheduler's counters are shown along with everything from the profiler.
+	void Update(const char* broadphaseName, const std::string& pacingName, const StepCounters& counters);
+
+	// Draws the overlay over a window of the given size (in pixels) with the given shader program (which should be the models' program).
+	// The depth test, face culling and blending are put back the way the demo has them afterwards.
+	void Draw(GLuint program, int width, int height);
+};
+
+#endif //_PERFORMANCE_OVERLAY_H
@@ -0,0 +1,242 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ReadbackBuffer.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _READBACK_BUFFER_CPP
+#define _READBACK_BUFFER_CPP
+
+#include "ReadbackBuffer.h"
+#include "MemoryTracker.h"
+
+ReadbackBuffer::ReadbackBuffer()
+{
+	buffer = 0;
+	mapped = nullptr;
+	regionSize = 0;
+	bufferSize = 0;
+	first = 0;
+	count = 0;
+	persistent = false;
+
+	for (int i = 0; i < REGIONS; i++)
+	{
+		fences[i] = 0;
+		sizes[i] = 0;
+	}
+}
+
+ReadbackBuffer::~ReadbackBuffer()
+{
+	clear();
+
+	if (mapped != nullptr)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	glDeleteBuffers(1, &buffer);
+
+	TrackFree(MEMORY_GPU, bufferSize);
+}
+
+void ReadbackBuffer::clear()
+{
+	for (int i = 0; i < REGIONS; i++)
+	{
+		if (fences[i] != 0)
+		{
+			glDeleteSync(fences[i]);
+			fences[i] = 0;
+		}
+	}
+
+	first = 0;
+	count = 0;
+}
+
+void ReadbackBuffer::Reserve(GLsizeiptr size)
+{
+	if (size <= regionSize && buffer != 0)
+	{
+		return;
+	}
+
+	// At least double it, so that results that grow a little every frame don't make a new buffer every frame.
+	GLsizeiptr newSize = regionSize * 2 > size ? regionSize * 2 : size;
+
+	if (newSize < 256)
+	{
+		newSize = 256;
+	}
+
+	clear();
+
+	if (mapped != nullptr)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		mapped = nullptr;
+	}
+
+	glDeleteBuffers(1, &buffer);
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+	regionSize = newSize;
+	persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+
+	if (persistent)
+	{
+		// Coherent means whatever the GPU copies in is there for us to see once the fence after it has passed, without any more barriers.
+		GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glBufferStorage(GL_COPY_WRITE_BUFFER, regionSize * REGIONS, nullptr, flags);
+		mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, regionSize * REGIONS, flags);
+
+		// If the mapping didn't work for whatever reason, we can still read it the old way.
+		persistent = mapped != nullptr;
+	}
+	else
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, regionSize * REGIONS, nullptr, GL_STREAM_READ);
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	GLsizeiptr oldSize = bufferSize;
+
+	bufferSize = regionSize * REGIONS;
+	TrackResize(MEMORY_GPU, oldSize, bufferSize);
+}
+
+bool ReadbackBuffer::Copy(GLuint source, GLintptr offset, GLsizeiptr size)
+{
+	if (count == REGIONS || size > regionSize)
+	{
+		return false;
+	}
+
+	int region = (first + count) % REGIONS;
+
+	if (size > 0)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, source);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, regionSize * region, size);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	sizes[region] = size;
+	count++;
+
+	return true;
+}
+
+bool ReadbackBuffer::IsReady()
+{
+	if (count == 0)
+	{
+		return false;
+	}
+
+	// Once the fence has passed it's done with, so asking again is free.
+	if (fences[first] != 0)
+	{
+		GLenum result = glClientWaitSync(fences[first], 0, 0);
+
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+		{
+			return false;
+		}
+
+		glDeleteSync(fences[first]);
+		fences[first] = 0;
+	}
+
+	return true;
+}
+
+const void* ReadbackBuffer::Read(GLsizeiptr* size)
+{
+	if (!IsReady())
+	{
+		return nullptr;
+	}
+
+	if (size != nullptr)
+	{
+		*size = sizes[first];
+	}
+
+	if (persistent)
+	{
+		return mapped + regionSize * first;
+	}
+
+	// The copy has already landed, so this doesn't wait for the GPU.
+	fallback.resize(sizes[first] > 0 ? sizes[first] : 1);
+
+	if (sizes[first] > 0)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, regionSize * first, sizes[first], fallback.data());
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	}
+
+	return fallback.data();
+}
+
+void ReadbackBuffer::Release()
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (fences[first] != 0)
+	{
+		glDeleteSync(fences[first]);
+		fences[first] = 0;
+	}
+
+	first = (first + 1) % REGIONS;
+	count--;
+}
+
+#endif // _READBACK_BUFFER_CPP
@@ -0,0 +1,111 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ReadbackBuffer.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _READBACK_BUFFER_H
+#define _READBACK_BUFFER_H
+
+#include "GLIncludes.h"
+#include <vector>
+
+// The other way around from a StreamBuffer: for results the GPU writes (like the GPU narrowphase's hits) that the CPU needs back, without
+// ever waiting for them.
+// Reading a buffer back with glGetBufferSubData straight after the shader that writes it makes the driver wait for the GPU to catch up with
+// everything before it, which stalls the whole frame. Instead, Copy has the GPU copy the results into one of REGIONS regions of this buffer
+// and puts a fence after it, and Read only hands them over once the fence has passed (usually the next frame), returning nothing until
+// then. The buffer is mapped into our memory once, for good (a persistent, coherent mapping, which needs OpenGL 4.4 or ARB_buffer_storage),
+// so reading is just looking at the memory. Without buffer storage, Read falls back on glGetBufferSubData, but still only once the fence has
+// passed, so it doesn't wait either.
+// The copies are read in the order they were made, and up to REGIONS of them can be waiting at once.
+class ReadbackBuffer
+{
+	static const int REGIONS = 3;
+
+	GLuint buffer;
+
+	// Where the buffer is mapped, or nullptr if we're using the fallback.
+	char* mapped;
+
+	// The size of each region, and of the whole buffer, in bytes.
+	GLsizeiptr regionSize;
+	GLsizeiptr bufferSize;
+
+	// The copies that haven't been released yet, oldest first, in a ring: first is the oldest one's region, and count is how many there are.
+	// Each region has the fence after its copy (0 once it has passed) and how many bytes were copied.
+	int first;
+	int count;
+	GLsync fences[REGIONS];
+	GLsizeiptr sizes[REGIONS];
+
+	bool persistent;
+
+	// Where Read copies a region to, for the fallback.
+	std::vector<char> fallback;
+
+	// Forgets every copy that hasn't been released.
+	void clear();
+
+public:
+	ReadbackBuffer();
+	~ReadbackBuffer();
+
+	// Makes sure each region can hold size bytes. If the buffer has to grow, any copies that haven't been released are dropped, so call it
+	// when there's nothing waiting.
+	void Reserve(GLsizeiptr size);
+
+	// Has the GPU copy size bytes from source (starting at offset) into the next region, once everything before it is done, and fences it.
+	// Anything a shader wrote to source needs a glMemoryBarrier with GL_BUFFER_UPDATE_BARRIER_BIT first. The fence has to get to the GPU
+	// before it can pass, so flush (glFlush) once everything for the frame has been sent. Returns false (and copies nothing) if every region
+	// is still waiting to be released.
+	bool Copy(GLuint source, GLintptr offset, GLsizeiptr size);
+
+	// Whether the oldest copy has landed, so that Read will give it back. This never waits.
+	bool IsReady();
+
+	// The oldest copy's data (and its size in size, if given), or nullptr if it hasn't landed yet or there isn't one. This never waits. The
+	// data stays where it is until Release.
+	const void* Read(GLsizeiptr* size = nullptr);
+
+	// Done with the oldest copy, so its region can be copied into again.
+	void Release();
+
+	// How many copies haven't been released yet.
+	int GetPending() const
+	{
+		return count;
+	}
+};
+
+#endif //_READBACK_BUFFER_H
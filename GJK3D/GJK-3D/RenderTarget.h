@@ -0,0 +1,83 @@
+/*
+Title: GJK-3D (OBB)
+File Name: RenderTarget.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _RENDER_TARGET_H
+#define _RENDER_TARGET_H
+
+#include "GLIncludes.h"
+
+// An offscreen framebuffer (a color and a depth renderbuffer) to draw the scene into at a lower resolution than the window, and then stretch
+// over the window. Shading is usually what limits the frame rate on a weak GPU, and that goes down with the number of pixels, so rendering
+// at 3/4 of the size takes a little over half the work.
+// Nothing is reallocated unless the size actually changes, so it's fine to Resize every frame.
+class RenderTarget
+{
+	GLuint framebuffer;
+	GLuint color;
+	GLuint depth;
+
+	int width;
+	int height;
+
+	// Can't be copied, since it owns the framebuffer.
+	RenderTarget(const RenderTarget&);
+	RenderTarget& operator=(const RenderTarget&);
+
+public:
+	RenderTarget();
+	~RenderTarget();
+
+	// Makes the target newWidth by newHeight pixels (at least 1 by 1). What was drawn in it is lost if the size changes.
+	void Resize(int newWidth, int newHeight);
+
+	// Draws into the target from now on, over all of it.
+	void Bind() const;
+
+	// Stretches what was drawn over the window's framebuffer, which is screenWidth by screenHeight pixels, with linear filtering, and then
+	// draws into the window again, over all of it.
+	void BlitToScreen(int screenWidth, int screenHeight) const;
+
+	int GetWidth() const
+	{
+		return width;
+	}
+	int GetHeight() const
+	{
+		return height;
+	}
+};
+
+#endif //_RENDER_TARGET_H
@@ -0,0 +1,428 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ShaderLoader.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _SHADER_LOADER_CPP
+#define _SHADER_LOADER_CPP
+
+#include "ShaderLoader.h"
+#include "HullCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// Our version of GLEW is too old to know about parallel shader compiling, so we look it up ourselves.
+// (KHR_parallel_shader_compile and ARB_parallel_shader_compile are the same, down to the values.)
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (GLAPIENTRY *MaxShaderCompilerThreadsFunction)(GLuint count);
+
+// Hashes a string from OpenGL onto the end of hash. (Some drivers don't give us one at all.)
+static unsigned long long hashString(const GLubyte* text, unsigned long long hash = 14695981039346656037ULL)
+{
+	return text != nullptr ? HashBytes(text, strlen((const char*)text), hash) : hash;
+}
+
+ShaderLoader::ShaderLoader(const std::string& programCacheDirectory)
+{
+	cacheDirectory = programCacheDirectory;
+	started = false;
+
+	driverKey = hashString(glGetString(GL_VENDOR));
+	driverKey = hashString(glGetString(GL_RENDERER), driverKey);
+	driverKey = hashString(glGetString(GL_VERSION), driverKey);
+
+	// A driver can support program binaries and still not have any formats to save them in, in which case there's no point.
+	binariesSupported = false;
+
+	if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+	{
+		GLint numFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+
+		binariesSupported = numFormats > 0;
+	}
+
+	// Tell the driver it can use as many threads as it likes to compile. Until we do, it may not use any.
+	MaxShaderCompilerThreadsFunction maxShaderCompilerThreads = nullptr;
+
+	if (glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+	{
+		maxShaderCompilerThreads = (MaxShaderCompilerThreadsFunction)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+	}
+	else if (glfwExtensionSupported("GL_ARB_parallel_shader_compile"))
+	{
+		maxShaderCompilerThreads = (MaxShaderCompilerThreadsFunction)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+	}
+
+	parallelCompile = maxShaderCompilerThreads != nullptr;
+
+	if (parallelCompile)
+	{
+		maxShaderCompilerThreads(0xFFFFFFFF);
+	}
+}
+
+ShaderLoader::~ShaderLoader()
+{
+	for (int i = 0; i < (int)programs.size(); i++)
+	{
+		LoadingProgram& program = programs[i];
+
+		// A program nobody could have been handed yet is ours to clean up.
+		if (program.state == PROGRAM_LINKING)
+		{
+			for (int s = 0; s < (int)program.stages.size(); s++)
+			{
+				glDeleteShader(program.stages[s].shader);
+			}
+
+			glDeleteProgram(program.program);
+		}
+	}
+}
+
+int ShaderLoader::Add(const std::string& name)
+{
+	LoadingProgram program;
+	program.name = name;
+	program.cacheFile = -1;
+	program.key = 0;
+	program.state = PROGRAM_READING;
+	program.program = 0;
+	program.fromCache = false;
+
+	programs.push_back(program);
+
+	return (int)programs.size() - 1;
+}
+
+void ShaderLoader::AddStage(int id, GLenum type, const std::string& fileName)
+{
+	ShaderStage stage;
+	stage.type = type;
+	stage.fileName = fileName;
+	stage.file = -1;
+	stage.shader = 0;
+
+	programs[id].stages.push_back(stage);
+}
+
+std::string ShaderLoader::getCacheFileName(const LoadingProgram& program) const
+{
+	return cacheDirectory + "/" + program.name + ".glprogram";
+}
+
+void ShaderLoader::Start()
+{
+	if (started)
+	{
+		return;
+	}
+
+	started = true;
+
+	// Every source file, and every cached binary we might be able to use instead, goes into the one batch. The binaries can't be checked
+	// until we know what the sources hash to, so they're loaded whether they get used or not (they're small, and usually do).
+	for (int i = 0; i < (int)programs.size(); i++)
+	{
+		LoadingProgram& program = programs[i];
+
+		for (int s = 0; s < (int)program.stages.size(); s++)
+		{
+			program.stages[s].file = files.Add(program.stages[s].fileName);
+		}
+
+		if (binariesSupported && !cacheDirectory.empty())
+		{
+			program.cacheFile = files.Add(getCacheFileName(program));
+		}
+	}
+
+	files.Start();
+}
+
+bool ShaderLoader::isLoaded(const LoadingProgram& program) const
+{
+	for (int s = 0; s < (int)program.stages.size(); s++)
+	{
+		if (!files.IsDone(program.stages[s].file))
+		{
+			return false;
+		}
+	}
+
+	return program.cacheFile < 0 || files.IsDone(program.cacheFile);
+}
+
+void ShaderLoader::startProgram(LoadingProgram& program)
+{
+	// The key covers the driver and every stage's type and source, so that changing any of them means compiling again.
+	unsigned long long key = driverKey;
+
+	for (int s = 0; s < (int)program.stages.size(); s++)
+	{
+		ShaderStage& stage = program.stages[s];
+
+		// The file's already loaded, so this doesn't actually wait.
+		if (!files.Wait(stage.file))
+		{
+			program.error = "Couldn't read " + stage.fileName + " for the " + program.name + " program.";
+			program.state = PROGRAM_DONE;
+			return;
+		}
+
+		key = HashBytes(&stage.type, sizeof(stage.type), key);
+		key = HashBytes(files.GetData(stage.file), files.GetSize(stage.file), key);
+	}
+
+	program.key = key;
+
+	// A shader is a program that runs on your GPU instead of your CPU. In this sense, OpenGL refers to your groups of shaders as "programs".
+	program.program = glCreateProgram();
+
+	// See if there's a binary from the last time we linked these exact shaders. (There's no cache file the first time, so that can fail.)
+	if (program.cacheFile >= 0 && files.Wait(program.cacheFile) && files.GetSize(program.cacheFile) > sizeof(ProgramCacheHeader))
+	{
+		// Copied out, since nothing says the buffer is aligned for it.
+		ProgramCacheHeader header;
+		memcpy(&header, files.GetData(program.cacheFile), sizeof(header));
+
+		if (memcmp(header.magic, PROGRAM_CACHE_MAGIC, sizeof(header.magic)) == 0 && header.version == PROGRAM_CACHE_VERSION && header.key == key &&
+			header.size == files.GetSize(program.cacheFile) - sizeof(header))
+		{
+			// The cached binary is the linked program, so there's nothing to compile.
+			glProgramBinary(program.program, header.format, files.GetData(program.cacheFile) + sizeof(header), (GLsizei)header.size);
+
+			GLint isLinked = 0;
+			glGetProgramiv(program.program, GL_LINK_STATUS, &isLinked);
+
+			if (isLinked == GL_TRUE)
+			{
+				program.fromCache = true;
+				program.stages.clear();
+				program.state = PROGRAM_DONE;
+				return;
+			}
+
+			// The driver doesn't like it anymore (a driver update can do that even when the version string stays the same), so compile it
+			// after all, and the new binary will replace it.
+			glDeleteProgram(program.program);
+			program.program = glCreateProgram();
+		}
+	}
+
+	for (int s = 0; s < (int)program.stages.size(); s++)
+	{
+		ShaderStage& stage = program.stages[s];
+
+		// glShaderSource takes an array of strings (we only have one, straight out of the batch) and their lengths, and glCompileShader
+		// compiles them. With parallel compiling, this returns straight away, and the driver compiles it in the background.
+		const char* source = files.GetSize(stage.file) > 0 ? files.GetData(stage.file) : "";
+		GLint length = (GLint)files.GetSize(stage.file);
+
+		stage.shader = glCreateShader(stage.type);
+		glShaderSource(stage.shader, 1, &source, &length);
+		glCompileShader(stage.shader);
+
+		glAttachShader(program.program, stage.shader);
+	}
+
+	// Ask for a binary we can save. (Without this, glGetProgramBinary may not give us one.)
+	if (binariesSupported)
+	{
+		glProgramParameteri(program.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	// This links the program, using the shaders to create executables to run on the GPU.
+	glLinkProgram(program.program);
+
+	program.state = PROGRAM_LINKING;
+}
+
+bool ShaderLoader::finishProgram(LoadingProgram& program, bool wait)
+{
+	// Asking whether it linked waits for the link to finish, so if the driver can tell us whether it's done, ask that first.
+	if (!wait && parallelCompile)
+	{
+		GLint isComplete = 0;
+		glGetProgramiv(program.program, GL_COMPLETION_STATUS_KHR, &isComplete);
+
+		if (isComplete == GL_FALSE)
+		{
+			return false;
+		}
+	}
+
+	GLint isLinked = 0;
+	glGetProgramiv(program.program, GL_LINK_STATUS, &isLinked);
+
+	if (isLinked == GL_FALSE)
+	{
+		program.error = "The " + program.name + " program failed to link.";
+
+		// Whichever shader failed to compile has the error that matters, so give those first.
+		char infoLog[1024];
+
+		for (int s = 0; s < (int)program.stages.size(); s++)
+		{
+			GLint isCompiled = 0;
+			glGetShaderiv(program.stages[s].shader, GL_COMPILE_STATUS, &isCompiled);
+
+			if (isCompiled == GL_FALSE)
+			{
+				glGetShaderInfoLog(program.stages[s].shader, sizeof(infoLog), nullptr, infoLog);
+				program.error += "\n" + program.stages[s].fileName + " failed to compile with the error:\n" + infoLog;
+			}
+		}
+
+		glGetProgramInfoLog(program.program, sizeof(infoLog), nullptr, infoLog);
+		program.error += std::string("\n") + infoLog;
+
+		glDeleteProgram(program.program);
+		program.program = 0;
+	}
+
+	// The linked program doesn't need the shaders anymore, so free them up (a shader that's still attached isn't actually deleted).
+	for (int s = 0; s < (int)program.stages.size(); s++)
+	{
+		if (program.program != 0)
+		{
+			glDetachShader(program.program, program.stages[s].shader);
+		}
+
+		glDeleteShader(program.stages[s].shader);
+	}
+
+	if (program.program != 0 && binariesSupported && !cacheDirectory.empty())
+	{
+		saveBinary(program);
+	}
+
+	program.stages.clear();
+	program.state = PROGRAM_DONE;
+
+	return true;
+}
+
+void ShaderLoader::saveBinary(const LoadingProgram& program) const
+{
+	GLint length = 0;
+	glGetProgramiv(program.program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program.program, length, &length, &format, binary.data());
+
+	ProgramCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(header.magic));
+	header.version = PROGRAM_CACHE_VERSION;
+	header.key = program.key;
+	header.format = format;
+	header.size = (unsigned int)length;
+
+	std::string fileName = getCacheFileName(program);
+	FILE* out = fopen(fileName.c_str(), "wb");
+
+	if (out == nullptr)
+	{
+		return;
+	}
+
+	fwrite(&header, sizeof(header), 1, out);
+	fwrite(binary.data(), 1, header.size, out);
+
+	bool written = ferror(out) == 0;
+
+	// Don't leave half a binary behind. (It would fail to load and get replaced anyway, but only after a wasted try.)
+	if (fclose(out) != 0 || !written)
+	{
+		remove(fileName.c_str());
+	}
+}
+
+bool ShaderLoader::Update()
+{
+	Start();
+
+	bool done = true;
+
+	for (int i = 0; i < (int)programs.size(); i++)
+	{
+		LoadingProgram& program = programs[i];
+
+		if (program.state == PROGRAM_READING && isLoaded(program))
+		{
+			startProgram(program);
+		}
+
+		if (program.state == PROGRAM_LINKING)
+		{
+			finishProgram(program, false);
+		}
+
+		done = done && program.state == PROGRAM_DONE;
+	}
+
+	return done;
+}
+
+void ShaderLoader::Finish()
+{
+	Start();
+
+	// Once every file is loaded, the programs can all be started (if they haven't been) before we wait on any of them.
+	files.WaitAll();
+
+	Update();
+
+	for (int i = 0; i < (int)programs.size(); i++)
+	{
+		if (programs[i].state == PROGRAM_LINKING)
+		{
+			finishProgram(programs[i], true);
+		}
+	}
+}
+
+#endif //_SHADER_LOADER_CPP
@@ -0,0 +1,179 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ShaderLoader.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _SHADER_LOADER_H
+#define _SHADER_LOADER_H
+
+#include "GLIncludes.h"
+#include "FileLoader.h"
+#include <string>
+#include <vector>
+
+// A program cache file is a header followed by the program binary, exactly as glGetProgramBinary gave it to us.
+static const char PROGRAM_CACHE_MAGIC[4] = { 'G', 'J', 'K', 'P' };
+static const unsigned int PROGRAM_CACHE_VERSION = 1;
+
+struct ProgramCacheHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned long long key;		// The hash of the driver and every shader's source, so a binary from other shaders or another driver is never used.
+	unsigned int format;		// What glGetProgramBinary said the binary's format was.
+	unsigned int size;
+};
+
+// Loads shader programs without holding everything else up.
+// Add the programs, then Start: the shader files (and any cached binaries) are loaded by a FileBatch on worker threads while this thread gets on
+// with something else, like loading the models. The sources go to the driver straight out of the batch's buffers. Then Update (or Finish) compiles and links them here, since that has to happen on the thread
+// with the OpenGL context. Where the driver has GL_KHR_parallel_shader_compile (or the ARB version), the compiling and linking happens on the
+// driver's own threads too, so every program compiles at once and Update never has to wait for one.
+// Once a program has been linked, its binary is saved in the cache directory (if the driver can give us one), and from then on it's loaded
+// from there instead of being compiled at all. The directory has to exist already, and an empty one means nothing is cached.
+class ShaderLoader
+{
+	enum ProgramState
+	{
+		PROGRAM_READING,	// Waiting for its files to be loaded.
+		PROGRAM_LINKING,	// Compiling and linking (on the driver's threads, if it can).
+		PROGRAM_DONE		// Linked, or failed.
+	};
+
+	struct ShaderStage
+	{
+		GLenum type;
+		std::string fileName;
+		int file;		// Its index in the batch.
+		GLuint shader;
+	};
+
+	struct LoadingProgram
+	{
+		std::string name;
+		std::vector<ShaderStage> stages;
+
+		// The cached binary's index in the batch (-1 if there's no cache), and the key it has to have to be used.
+		int cacheFile;
+		unsigned long long key;
+
+		ProgramState state;
+		GLuint program;
+		bool fromCache;
+		std::string error;
+	};
+
+	std::string cacheDirectory;
+
+	// A hash of the driver (its vendor, renderer and version), which every program's key starts from, since a binary is only good for the
+	// driver that made it.
+	unsigned long long driverKey;
+
+	// Whether we can use program binaries, and whether the driver compiles on threads of its own.
+	bool binariesSupported;
+	bool parallelCompile;
+
+	std::vector<LoadingProgram> programs;
+
+	// Every program's files.
+	FileBatch files;
+	bool started;
+
+	std::string getCacheFileName(const LoadingProgram& program) const;
+
+	// Whether all of a program's files have been loaded.
+	bool isLoaded(const LoadingProgram& program) const;
+
+	// Makes the program from its binary, or starts compiling and linking it.
+	void startProgram(LoadingProgram& program);
+
+	// Checks how the link went (only waiting for it if wait is true) and saves the binary. Returns false if it's still linking.
+	bool finishProgram(LoadingProgram& program, bool wait);
+
+	void saveBinary(const LoadingProgram& program) const;
+
+	// Can't be copied, since it owns programs.
+	ShaderLoader(const ShaderLoader&);
+	ShaderLoader& operator=(const ShaderLoader&);
+
+public:
+	// Needs the OpenGL context to be current (and glewInit to have been called).
+	ShaderLoader(const std::string& programCacheDirectory = "");
+
+	// Waits for the files, and deletes any programs that aren't done yet. (The ones that are belong to whoever got them from GetProgram.)
+	~ShaderLoader();
+
+	// Adds a program (name is what its cache file is called), and returns its id. Then add each of its shaders with AddStage.
+	// These can only be called before Start.
+	int Add(const std::string& name);
+	void AddStage(int id, GLenum type, const std::string& fileName);
+
+	// Starts loading every program's files on worker threads.
+	void Start();
+
+	// Makes whatever progress it can without waiting: programs that have been read start compiling (or load their binaries), and programs
+	// that have finished linking are checked and cached. Returns true once every program is done.
+	bool Update();
+
+	// Waits until every program is done.
+	void Finish();
+
+	// A program once it's done, or 0 if it isn't done yet or failed to load (GetError says why). The program belongs to whoever asks for it,
+	// and has to be deleted by them.
+	GLuint GetProgram(int id) const
+	{
+		return programs[id].state == PROGRAM_DONE ? programs[id].program : 0;
+	}
+	const std::string& GetError(int id) const
+	{
+		return programs[id].error;
+	}
+
+	// Whether the program was loaded from its cached binary rather than compiled.
+	bool FromCache(int id) const
+	{
+		return programs[id].fromCache;
+	}
+
+	const std::string& GetCacheDirectory() const
+	{
+		return cacheDirectory;
+	}
+
+	bool CanCompileInParallel() const
+	{
+		return parallelCompile;
+	}
+};
+
+#endif //_SHADER_LOADER_H
@@ -0,0 +1,248 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ShaderProgram.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _SHADER_PROGRAM_CPP
+#define _SHADER_PROGRAM_CPP
+
+#include "ShaderProgram.h"
+#include <sys/stat.h>
+
+// When a file was last changed, or 0 if it can't be found.
+static long long getLastWriteTime(const std::string& fileName)
+{
+	struct stat info;
+
+	if (stat(fileName.c_str(), &info) != 0)
+	{
+		return 0;
+	}
+
+	return (long long)info.st_mtime;
+}
+
+ShaderProgram::ShaderProgram(const std::string& programName)
+{
+	name = programName;
+	program = 0;
+}
+
+ShaderProgram::~ShaderProgram()
+{
+	glDeleteProgram(program);
+}
+
+void ShaderProgram::AddStage(GLenum type, const std::string& fileName)
+{
+	Stage stage;
+	stage.type = type;
+	stage.fileName = fileName;
+	stage.lastWriteTime = 0;
+
+	stages.push_back(stage);
+}
+
+int ShaderProgram::Queue(ShaderLoader& loader)
+{
+	int id = loader.Add(name);
+
+	for (int i = 0; i < (int)stages.size(); i++)
+	{
+		loader.AddStage(id, stages[i].type, stages[i].fileName);
+	}
+
+	// Remember when the files were changed before they're read, so that a change while they're being read still counts as a change.
+	for (int i = 0; i < (int)stages.size(); i++)
+	{
+		stages[i].lastWriteTime = getLastWriteTime(stages[i].fileName);
+	}
+
+	cacheDirectory = loader.GetCacheDirectory();
+
+	return id;
+}
+
+bool ShaderProgram::Take(ShaderLoader& loader, int id)
+{
+	GLuint newProgram = loader.GetProgram(id);
+
+	if (newProgram == 0)
+	{
+		error = loader.GetError(id);
+		return false;
+	}
+
+	error.clear();
+	setProgram(newProgram);
+
+	return true;
+}
+
+bool ShaderProgram::Load(const std::string& programCacheDirectory)
+{
+	ShaderLoader loader(programCacheDirectory);
+	int id = Queue(loader);
+
+	loader.Finish();
+
+	return Take(loader, id);
+}
+
+bool ShaderProgram::HasChanged() const
+{
+	for (int i = 0; i < (int)stages.size(); i++)
+	{
+		if (getLastWriteTime(stages[i].fileName) != stages[i].lastWriteTime)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ShaderProgram::Reload()
+{
+	return Load(cacheDirectory);
+}
+
+void ShaderProgram::setProgram(GLuint newProgram)
+{
+	glDeleteProgram(program);
+	program = newProgram;
+
+	readLocations();
+	bindBlocks();
+}
+
+void ShaderProgram::bindBlocks()
+{
+	if (program == 0)
+	{
+		return;
+	}
+
+	for (std::unordered_map<std::string, GLuint>::const_iterator it = blockBindings.begin(); it != blockBindings.end(); ++it)
+	{
+		GLuint index = glGetUniformBlockIndex(program, it->first.c_str());
+
+		if (index != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(program, index, it->second);
+		}
+	}
+}
+
+void ShaderProgram::SetBlockBinding(const std::string& blockName, GLuint binding)
+{
+	blockBindings[blockName] = binding;
+
+	bindBlocks();
+}
+
+void ShaderProgram::readLocations()
+{
+	uniforms.clear();
+	attributes.clear();
+
+	GLint count = 0;
+	GLint maxLength = 0;
+	std::vector<char> nameBuffer;
+
+	// Uniforms. The ones in uniform blocks don't have locations (they come back as -1), so they're left out.
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	nameBuffer.resize(maxLength + 1);
+
+	for (int i = 0; i < count; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(program, i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+
+		std::string uniformName(nameBuffer.data(), length);
+		GLint location = glGetUniformLocation(program, uniformName.c_str());
+
+		if (location == -1)
+		{
+			continue;
+		}
+
+		uniforms[uniformName] = location;
+
+		// Arrays are listed as their first element, so they can be found by the plain name as well.
+		if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+		{
+			uniforms[uniformName.substr(0, uniformName.size() - 3)] = location;
+		}
+	}
+
+	// Attributes. The built in ones (like gl_VertexID) don't have locations either.
+	glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+	glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+	nameBuffer.resize(maxLength + 1);
+
+	for (int i = 0; i < count; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveAttrib(program, i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+
+		std::string attributeName(nameBuffer.data(), length);
+		GLint location = glGetAttribLocation(program, attributeName.c_str());
+
+		if (location != -1)
+		{
+			attributes[attributeName] = location;
+		}
+	}
+}
+
+GLint ShaderProgram::GetUniform(const std::string& uniformName) const
+{
+	std::unordered_map<std::string, GLint>::const_iterator found = uniforms.find(uniformName);
+
+	return found != uniforms.end() ? found->second : -1;
+}
+
+GLint ShaderProgram::GetAttribute(const std::string& attributeName) const
+{
+	std::unordered_map<std::string, GLint>::const_iterator found = attributes.find(attributeName);
+
+	return found != attributes.end() ? found->second : -1;
+}
+
+#endif //_SHADER_PROGRAM_CPP
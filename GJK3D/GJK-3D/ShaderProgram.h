@@ -0,0 +1,142 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ShaderProgram.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _SHADER_PROGRAM_H
+#define _SHADER_PROGRAM_H
+
+#include "ShaderLoader.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A linked shader program, the files it's made from, and where its uniforms and attributes are.
+// Every uniform and attribute location is looked up once, when the program is linked, and kept in a hash table, so asking for one by name
+// never goes to the driver (and nothing outside needs its own glGetUniformLocation calls to keep up with the shaders).
+// The program keeps track of when its files were last changed, and ReloadIfChanged rebuilds it when any of them are, so shaders can be edited
+// while the demo is running. It's loaded through a ShaderLoader, so it compiles alongside everything else and its binary is cached.
+class ShaderProgram
+{
+	struct Stage
+	{
+		GLenum type;
+		std::string fileName;
+		long long lastWriteTime;	// When the file was last changed (as far as we knew when it was loaded), or 0 if we can't tell.
+	};
+
+	std::string name;
+	std::vector<Stage> stages;
+
+	// Where the program's binary is cached (see ShaderLoader), so a reload caches the new one there too.
+	std::string cacheDirectory;
+
+	GLuint program;
+
+	std::unordered_map<std::string, GLint> uniforms;
+	std::unordered_map<std::string, GLint> attributes;
+
+	// Which binding point each uniform block should read its buffer from (see SetBlockBinding).
+	std::unordered_map<std::string, GLuint> blockBindings;
+
+	std::string error;
+
+	// Fills in the tables from the linked program.
+	void readLocations();
+
+	// Points the program's uniform blocks at the binding points they were given.
+	void bindBlocks();
+
+	// Takes over a program, replacing (and deleting) the one we had.
+	void setProgram(GLuint newProgram);
+
+	// Can't be copied, since it owns the program.
+	ShaderProgram(const ShaderProgram&);
+	ShaderProgram& operator=(const ShaderProgram&);
+
+public:
+	// name is what the program's binary is cached as.
+	ShaderProgram(const std::string& programName);
+	~ShaderProgram();
+
+	void AddStage(GLenum type, const std::string& fileName);
+
+	// Adds the program to a loader, returning its id there. Once the loader's finished with it, hand it to Take.
+	int Queue(ShaderLoader& loader);
+
+	// Takes the program the loader made for it. Returns false (keeping whatever program it had) if the program failed to load, and
+	// GetError says why.
+	bool Take(ShaderLoader& loader, int id);
+
+	// Compiles and links the program right away (waiting for it), for when there's nothing to load alongside it.
+	bool Load(const std::string& programCacheDirectory = "");
+
+	// Whether any of the program's files have changed since it was loaded.
+	bool HasChanged() const;
+
+	// Loads the program again from its files. If the new version doesn't load, this returns false and the old one is kept. Either way,
+	// HasChanged is false again until the files change again.
+	bool Reload();
+
+	// The program (0 if it hasn't loaded), which changes when it's reloaded.
+	GLuint GetProgram() const
+	{
+		return program;
+	}
+
+	void Use() const
+	{
+		glUseProgram(program);
+	}
+
+	// Where a uniform or attribute is, or -1 if the program doesn't have one by that name (or the compiler optimized it out). An array's
+	// first element can be found by the array's name, with or without the [0].
+	GLint GetUniform(const std::string& uniformName) const;
+	GLint GetAttribute(const std::string& attributeName) const;
+
+	// Has the uniform block by this name read from the buffer bound to the given GL_UNIFORM_BUFFER binding point. (Our shaders are too old
+	// a version to say so themselves.) This is remembered, so it carries over to whatever program a reload makes. Blocks the program doesn't
+	// have are ignored.
+	void SetBlockBinding(const std::string& blockName, GLuint binding);
+
+	const std::string& GetName() const
+	{
+		return name;
+	}
+	const std::string& GetError() const
+	{
+		return error;
+	}
+};
+
+#endif //_SHADER_PROGRAM_H
@@ -0,0 +1,224 @@
+/*
+Title: GJK-3D (OBB)
+File Name: StreamBuffer.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _STREAM_BUFFER_CPP
+#define _STREAM_BUFFER_CPP
+
+#include "StreamBuffer.h"
+#include "GPUDeletionQueue.h"
+#include "MemoryTracker.h"
+#include <cstring>
+
+StreamBuffer::StreamBuffer()
+{
+	buffer = 0;
+	mapped = nullptr;
+	regionSize = 0;
+	bufferSize = 0;
+	region = 0;
+	cursor = 0;
+	persistent = false;
+
+	for (int i = 0; i < REGIONS; i++)
+	{
+		fences[i] = 0;
+	}
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	// A model's instance buffer goes when the model does, which can be on any thread, so the fences and the buffer are deleted on the render
+	// thread instead (and deleting the buffer unmaps it, so there's no need to first).
+	GPUDeletionQueue& deletions = GetGPUDeletionQueue();
+
+	for (int i = 0; i < REGIONS; i++)
+	{
+		deletions.DeleteSync(fences[i]);
+	}
+
+	deletions.DeleteBuffer(buffer);
+
+	TrackFree(MEMORY_GPU, bufferSize);
+}
+
+void StreamBuffer::waitForRegion(int index)
+{
+	if (fences[index] == 0)
+	{
+		return;
+	}
+
+	// The first wait flushes the commands, so that the fence is sure to actually get to the GPU. After that we just keep waiting (a second
+	// at a time) until it's signaled.
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+	while (true)
+	{
+		GLenum result = glClientWaitSync(fences[index], flags, 1000000000);
+
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+		{
+			break;
+		}
+
+		flags = 0;
+	}
+
+	glDeleteSync(fences[index]);
+	fences[index] = 0;
+}
+
+// Rounds up to the next multiple of 256 bytes.
+static GLsizeiptr alignStream(GLsizeiptr size)
+{
+	return (size + 255) / 256 * 256;
+}
+
+GLsizeiptr StreamBuffer::nextStart(GLsizeiptr elementSize) const
+{
+	// Elements are counted from the start of the buffer, not the region.
+	GLsizeiptr regionStart = regionSize * region;
+	GLsizeiptr start = regionStart + alignStream(cursor);
+
+	return (start + elementSize - 1) / elementSize * elementSize - regionStart;
+}
+
+bool StreamBuffer::Reserve(GLsizeiptr size, GLsizeiptr elementSize)
+{
+	// The fallback orphans the buffer for every write, so each write always starts at the beginning of it.
+	GLsizeiptr needed = persistent ? nextStart(elementSize) + size : size;
+
+	if (buffer != 0 && needed <= regionSize)
+	{
+		return false;
+	}
+
+	// Grow to at least double the old size, so that a slowly growing size doesn't recreate the buffer every frame. Regions are kept to a
+	// multiple of 256 bytes, so every region starts on a boundary that's fine for any kind of data.
+	GLsizeiptr newSize = size > regionSize * 2 ? size : regionSize * 2;
+	newSize = alignStream(newSize);
+
+	// The GPU might still be reading from the old buffer, so wait for it before we throw the buffer away.
+	for (int i = 0; i < REGIONS; i++)
+	{
+		waitForRegion(i);
+	}
+
+	if (mapped != nullptr)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		mapped = nullptr;
+	}
+
+	glDeleteBuffers(1, &buffer);
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	regionSize = newSize;
+	region = 0;
+	cursor = 0;
+	persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+
+	if (persistent)
+	{
+		// Coherent means whatever we write is visible to the GPU without having to flush it ourselves.
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glBufferStorage(GL_ARRAY_BUFFER, regionSize * REGIONS, nullptr, flags);
+		mapped = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * REGIONS, flags);
+
+		// If the mapping didn't work for whatever reason, we can still write to it the old way.
+		persistent = mapped != nullptr;
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+	}
+
+	GLsizeiptr oldSize = bufferSize;
+
+	bufferSize = persistent ? regionSize * REGIONS : regionSize;
+	TrackResize(MEMORY_GPU, oldSize, bufferSize);
+
+	return true;
+}
+
+GLsizeiptr StreamBuffer::Write(const void* data, GLsizeiptr size, GLsizeiptr elementSize)
+{
+	if (!persistent)
+	{
+		// The fallback: orphan the buffer so the driver can give us fresh memory, then copy the data in the regular way.
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+
+		return 0;
+	}
+
+	// The first write to a region has to make sure the GPU is done with it from REGIONS fences ago before we write over it. Almost always it already is.
+	if (cursor == 0)
+	{
+		waitForRegion(region);
+	}
+
+	GLsizeiptr start = nextStart(elementSize);
+	GLsizeiptr offset = regionSize * region + start;
+	memcpy(mapped + offset, data, size);
+
+	cursor = start + size;
+
+	return offset;
+}
+
+void StreamBuffer::Fence()
+{
+	if (!persistent)
+	{
+		return;
+	}
+
+	// Nothing to fence if nothing was written.
+	if (cursor == 0)
+	{
+		return;
+	}
+
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	region = (region + 1) % REGIONS;
+	cursor = 0;
+}
+
+#endif // _STREAM_BUFFER_CPP
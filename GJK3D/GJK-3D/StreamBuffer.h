@@ -0,0 +1,99 @@
+/*
+Title: GJK-3D (OBB)
+File Name: StreamBuffer.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _STREAM_BUFFER_H
+#define _STREAM_BUFFER_H
+
+#include "GLIncludes.h"
+
+// A GPU buffer for data that changes every frame (like the transformation matrices for instancing).
+// Normally we'd upload new data with glBufferData or glBufferSubData, which means the driver has to copy it somewhere first, and if the GPU is
+// still drawing with the old data, either keep another copy around or wait for it.
+// Instead, this buffer is split into REGIONS parts and mapped into our memory once, for good (a "persistent" mapping, which needs OpenGL 4.4
+// or ARB_buffer_storage). Writes copy straight into the current region, one after another, until Fence moves on to the next region, going
+// around in a ring. The fence goes in after the draws that read each region, and we only ever wait on it if the GPU is still REGIONS
+// fences behind, so normally the CPU and GPU never wait on each other.
+// Without buffer storage it falls back on orphaning a regular buffer for every Write.
+class StreamBuffer
+{
+	static const int REGIONS = 3;
+
+	GLuint buffer;
+
+	// Where the buffer is mapped, or nullptr if we're using the fallback.
+	char* mapped;
+
+	// The size of each region, and of the whole buffer (which is REGIONS regions, unless it's the fallback), in bytes.
+	GLsizeiptr regionSize;
+	GLsizeiptr bufferSize;
+
+	// The region the next Write goes to, how much of it has been written so far, and the fence for each region's last use (0 if there wasn't one).
+	int region;
+	GLsizeiptr cursor;
+	GLsync fences[REGIONS];
+
+	bool persistent;
+
+	// Waits until the GPU is done with the given region.
+	void waitForRegion(int index);
+
+	// Where the next write of elements elementSize bytes each would start in the current region.
+	GLsizeiptr nextStart(GLsizeiptr elementSize) const;
+
+public:
+	StreamBuffer();
+	~StreamBuffer();
+
+	// Makes sure that the next Write can hold size bytes (of elements elementSize bytes each).
+	// Returns true if the buffer was (re)created, in which case anything that points at it (like the vertex attributes in a vao) has to be set up again.
+	bool Reserve(GLsizeiptr size, GLsizeiptr elementSize = 1);
+
+	// Copies size bytes of data into the current region, after anything already written there, and returns its byte offset in the buffer.
+	// Call Reserve with the same sizes first. Each write starts on a 256 byte boundary, and then on the next whole element from the start of
+	// the buffer, so that data read by element number (like instances, with a base instance of offset / elementSize) can start at it even
+	// when its elements don't divide 256.
+	GLsizeiptr Write(const void* data, GLsizeiptr size, GLsizeiptr elementSize = 1);
+
+	// Call this after the draw calls that read the data from the Writes since the last Fence, so we know when the GPU is done with it.
+	// (Usually once a frame.) The next Write goes to the next region.
+	void Fence();
+
+	GLuint GetBuffer()
+	{
+		return buffer;
+	}
+};
+
+#endif //_STREAM_BUFFER_H
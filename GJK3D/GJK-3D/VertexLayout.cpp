@@ -0,0 +1,391 @@
+/*
+Title: GJK-3D (OBB)
+File Name: VertexLayout.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _VERTEX_LAYOUT_CPP
+#define _VERTEX_LAYOUT_CPP
+
+#include "VertexLayout.h"
+#include "glm\gtc\packing.hpp"
+#include <cstddef>
+#include <cstring>
+
+int VertexLayout::PositionSize() const
+{
+	// Half positions are padded out to 4 halves (8 bytes), so that each attribute starts on a 4 byte boundary like the GPU likes.
+	return position == VERTEX_HALF ? 8 : 12;
+}
+
+int VertexLayout::ColorSize() const
+{
+	if (color == VERTEX_NONE)
+	{
+		return 0;
+	}
+
+	return color == VERTEX_UNORM8 ? 4 : 16;
+}
+
+int VertexLayout::NormalSize() const
+{
+	if (normal == VERTEX_NONE)
+	{
+		return 0;
+	}
+
+	return normal == VERTEX_SNORM10 ? 4 : 12;
+}
+
+void VertexLayout::getOffsets(int capacity, int offsets[3], int strides[3]) const
+{
+	int sizes[3] = { ColorSize(), PositionSize(), NormalSize() };
+	int start = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (interleaved)
+		{
+			// Each attribute is a little further into the vertex, and the next vertex is a whole vertex away.
+			offsets[i] = start;
+			strides[i] = VertexSize();
+			start += sizes[i];
+		}
+		else
+		{
+			// Each attribute gets its own block, and they're packed tightly inside it.
+			offsets[i] = start;
+			strides[i] = sizes[i];
+			start += sizes[i] * capacity;
+		}
+	}
+}
+
+void VertexLayout::packAttribute(int attribute, const VertexFormat& vert, unsigned char* dest) const
+{
+	if (attribute == 0)
+	{
+		// Color.
+		if (color == VERTEX_FLOAT)
+		{
+			memcpy(dest, &vert.color, sizeof(glm::vec4));
+		}
+		else if (color == VERTEX_UNORM8)
+		{
+			glm::uint packed = glm::packUnorm4x8(vert.color);
+			memcpy(dest, &packed, sizeof(packed));
+		}
+	}
+	else if (attribute == 1)
+	{
+		// Position.
+		if (position == VERTEX_HALF)
+		{
+			glm::uint64 packed = glm::packHalf4x16(glm::vec4(vert.position, 1.0f));
+			memcpy(dest, &packed, sizeof(packed));
+		}
+		else
+		{
+			memcpy(dest, &vert.position, sizeof(glm::vec3));
+		}
+	}
+	else
+	{
+		// Normal.
+		if (normal == VERTEX_FLOAT)
+		{
+			memcpy(dest, &vert.normal, sizeof(glm::vec3));
+		}
+		else if (normal == VERTEX_SNORM10)
+		{
+			glm::uint32 packed = glm::packSnorm3x10_1x2(glm::vec4(vert.normal, 0.0f));
+			memcpy(dest, &packed, sizeof(packed));
+		}
+	}
+}
+
+void VertexLayout::unpackAttribute(int attribute, const unsigned char* source, VertexFormat& vert) const
+{
+	if (attribute == 0)
+	{
+		if (color == VERTEX_FLOAT)
+		{
+			memcpy(&vert.color, source, sizeof(glm::vec4));
+		}
+		else if (color == VERTEX_UNORM8)
+		{
+			glm::uint packed;
+			memcpy(&packed, source, sizeof(packed));
+			vert.color = glm::unpackUnorm4x8(packed);
+		}
+		else
+		{
+			vert.color = glm::vec4(1.0f);
+		}
+	}
+	else if (attribute == 1)
+	{
+		if (position == VERTEX_HALF)
+		{
+			glm::uint64 packed;
+			memcpy(&packed, source, sizeof(packed));
+			vert.position = glm::vec3(glm::unpackHalf4x16(packed));
+		}
+		else
+		{
+			memcpy(&vert.position, source, sizeof(glm::vec3));
+		}
+	}
+	else
+	{
+		if (normal == VERTEX_FLOAT)
+		{
+			memcpy(&vert.normal, source, sizeof(glm::vec3));
+		}
+		else if (normal == VERTEX_SNORM10)
+		{
+			glm::uint32 packed;
+			memcpy(&packed, source, sizeof(packed));
+			vert.normal = glm::vec3(glm::unpackSnorm3x10_1x2(packed));
+		}
+		else
+		{
+			vert.normal = glm::vec3(0.0f);
+		}
+	}
+}
+
+void VertexLayout::Pack(const VertexFormat* vertices, int numVertices, std::vector<unsigned char>& out) const
+{
+	int offsets[3], strides[3];
+	getOffsets(numVertices, offsets, strides);
+
+	int sizes[3] = { ColorSize(), PositionSize(), NormalSize() };
+
+	out.resize(VertexSize() * numVertices);
+
+	for (int a = 0; a < 3; a++)
+	{
+		// Attributes that aren't stored take up no space at all.
+		if (sizes[a] == 0)
+		{
+			continue;
+		}
+
+		for (int i = 0; i < numVertices; i++)
+		{
+			packAttribute(a, vertices[i], &out[offsets[a] + strides[a] * i]);
+		}
+	}
+}
+
+void VertexLayout::Unpack(const unsigned char* packed, int numVertices, VertexFormat* out) const
+{
+	int offsets[3], strides[3];
+	getOffsets(numVertices, offsets, strides);
+
+	int sizes[3] = { ColorSize(), PositionSize(), NormalSize() };
+
+	for (int a = 0; a < 3; a++)
+	{
+		for (int i = 0; i < numVertices; i++)
+		{
+			unpackAttribute(a, sizes[a] > 0 ? packed + offsets[a] + strides[a] * i : nullptr, out[i]);
+		}
+	}
+}
+
+void VertexLayout::Upload(const VertexFormat* vertices, int first, int count, int capacity) const
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> packed;
+
+	if (interleaved)
+	{
+		// Interleaved vertices are all in one piece, so the range is just that many whole vertices, starting first vertices in.
+		Pack(vertices + first, count, packed);
+		glBufferSubData(GL_ARRAY_BUFFER, VertexSize() * first, packed.size(), packed.data());
+
+		return;
+	}
+
+	// Otherwise the range is a separate piece of each attribute's block.
+	int offsets[3], strides[3];
+	getOffsets(capacity, offsets, strides);
+
+	int sizes[3] = { ColorSize(), PositionSize(), NormalSize() };
+
+	for (int a = 0; a < 3; a++)
+	{
+		if (sizes[a] == 0)
+		{
+			continue;
+		}
+
+		packed.resize(sizes[a] * count);
+
+		for (int i = 0; i < count; i++)
+		{
+			packAttribute(a, vertices[first + i], &packed[sizes[a] * i]);
+		}
+
+		glBufferSubData(GL_ARRAY_BUFFER, offsets[a] + sizes[a] * first, packed.size(), packed.data());
+	}
+}
+
+void VertexLayout::SetAttributes(int capacity) const
+{
+	int offsets[3], strides[3];
+	getOffsets(capacity, offsets, strides);
+
+	// Position (location 0). For half floats only the first 3 of the 4 halves are read.
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, position == VERTEX_HALF ? GL_HALF_FLOAT : GL_FLOAT, GL_FALSE, strides[1], (void*)(size_t)offsets[1]);
+
+	// Color (location 1). The normalized flag tells the GPU to turn the 8 bit values (0 to 255) back into 0 to 1.
+	// With no color stored, the shader just gets white.
+	if (color == VERTEX_NONE)
+	{
+		glDisableVertexAttribArray(1);
+		glVertexAttrib4f(1, 1.0f, 1.0f, 1.0f, 1.0f);
+	}
+	else
+	{
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, color == VERTEX_UNORM8 ? GL_UNSIGNED_BYTE : GL_FLOAT, color == VERTEX_UNORM8 ? GL_TRUE : GL_FALSE, strides[0], (void*)(size_t)offsets[0]);
+	}
+
+	// Normal (location 6).
+	if (normal == VERTEX_NONE)
+	{
+		glDisableVertexAttribArray(6);
+	}
+	else if (normal == VERTEX_SNORM10)
+	{
+		glEnableVertexAttribArray(6);
+		glVertexAttribPointer(6, 4, GL_INT_2_10_10_10_REV, GL_TRUE, strides[2], (void*)(size_t)offsets[2]);
+	}
+	else
+	{
+		glEnableVertexAttribArray(6);
+		glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, strides[2], (void*)(size_t)offsets[2]);
+	}
+}
+
+void VertexLayout::SetInstanceAttributes()
+{
+	// Position (location 2), rotation (3, which the normalized flag turns back into -1 to 1) and scale (4, only the first 3 halves of
+	// which are read). The divisor of 1 means these advance once per instance instead of once per vertex.
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (void*)offsetof(InstanceTransform, position));
+	glVertexAttribDivisor(2, 1);
+
+	glEnableVertexAttribArray(3);
+	glVertexAttribPointer(3, 4, GL_SHORT, GL_TRUE, sizeof(InstanceTransform), (void*)offsetof(InstanceTransform, rotation));
+	glVertexAttribDivisor(3, 1);
+
+	glEnableVertexAttribArray(4);
+	glVertexAttribPointer(4, 3, GL_HALF_FLOAT, GL_FALSE, sizeof(InstanceTransform), (void*)offsetof(InstanceTransform, scale));
+	glVertexAttribDivisor(4, 1);
+}
+
+void VertexLayout::SetIdentityInstance()
+{
+	glVertexAttrib3f(2, 0.0f, 0.0f, 0.0f);
+	glVertexAttrib4f(3, 0.0f, 0.0f, 0.0f, 1.0f);
+	glVertexAttrib3f(4, 1.0f, 1.0f, 1.0f);
+}
+
+// A float as a half float, rounded to the nearest. This is what glm::packHalf1x16 does, but that handles every case one at a time and takes
+// a few times as long, which adds up over every instance every frame. This only handles what a scale can sensibly be: anything too small
+// to be a normal half float comes out as 0, and anything too big as the biggest half float (rather than infinity).
+static unsigned short toHalf(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	unsigned int sign = (bits >> 16) & 0x8000;
+	unsigned int magnitude = bits & 0x7fffffff;
+
+	if (magnitude < 0x38800000)
+	{
+		return (unsigned short)sign;
+	}
+
+	if (magnitude >= 0x477ff000)
+	{
+		return (unsigned short)(sign | 0x7bff);
+	}
+
+	// Move the exponent from float's bias (127) to half's (15), and round the 13 bits of mantissa that don't fit.
+	return (unsigned short)(sign | ((magnitude - 0x38000000 + 0x1000) >> 13));
+}
+
+// A number from -1 to 1 in 16 bit fixed point, rounded to the nearest, the way OpenGL reads a normalized GL_SHORT back.
+static short toSnorm16(float value)
+{
+	value = glm::clamp(value, -1.0f, 1.0f) * 32767.0f;
+
+	return (short)(value + (value >= 0.0f ? 0.5f : -0.5f));
+}
+
+InstanceTransform PackInstance(const glm::vec3& position, const glm::quat& orientation, const glm::vec3& scale)
+{
+	InstanceTransform instance;
+
+	instance.position = position;
+	instance.rotation[0] = toSnorm16(orientation.x);
+	instance.rotation[1] = toSnorm16(orientation.y);
+	instance.rotation[2] = toSnorm16(orientation.z);
+	instance.rotation[3] = toSnorm16(orientation.w);
+	instance.scale[0] = toHalf(scale.x);
+	instance.scale[1] = toHalf(scale.y);
+	instance.scale[2] = toHalf(scale.z);
+	instance.scale[3] = 0;
+
+	return instance;
+}
+
+void PackInstances(const glm::vec3* positions, const glm::quat* orientations, const glm::vec3* scales, InstanceTransform* instances, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		instances[i] = PackInstance(positions[i], orientations[i], scales[i]);
+	}
+}
+
+#endif // _VERTEX_LAYOUT_CPP
@@ -0,0 +1,164 @@
+/*
+Title: GJK-3D (OBB)
+File Name: VertexLayout.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _VERTEX_LAYOUT_H
+#define _VERTEX_LAYOUT_H
+
+#include "GLIncludes.h"
+#include <vector>
+
+// How one attribute of a vertex is stored on the GPU.
+enum VertexAttributeFormat
+{
+	VERTEX_NONE,	// Not stored at all.
+	VERTEX_FLOAT,	// Full 32 bit floats.
+	VERTEX_HALF,	// 16 bit floats. Plenty for positions in a model's local space. (Positions only.)
+	VERTEX_UNORM8,	// 8 bits per channel, from 0 to 1, all four channels packed into 4 bytes. (Colors only.)
+	VERTEX_SNORM10	// 10 bits per channel, from -1 to 1, packed into 4 bytes (as GL_INT_2_10_10_10_REV). (Normals only.)
+};
+
+// Describes how a model's vertices are laid out in its vertex buffer.
+// Models are always built from VertexFormats (full floats, which is also what CalculateBounds and the collision code read), but that isn't
+// necessarily how they're best stored on the GPU. A float color and position are 28 bytes (40 with a normal), while half float positions and an
+// 8 bit color come in at 12, and the shader can't tell the difference: the GPU turns them all back into floats as it reads them.
+// The attributes go to the vertex shader at location 0 (position), 1 (color) and 6 (normal). 2 through 4 are the instance's transform.
+struct VertexLayout
+{
+	VertexAttributeFormat position;
+	VertexAttributeFormat color;
+	VertexAttributeFormat normal;
+
+	// If true, each vertex's attributes are stored next to each other (color, position, normal, then the next vertex). If false, every
+	// vertex's color comes first, then every vertex's position, then every normal, which is handy for passes that only read positions.
+	bool interleaved;
+
+	// The same layout as VertexFormat itself: a float color and then a float position, interleaved, with no normal.
+	VertexLayout()
+	{
+		position = VERTEX_FLOAT;
+		color = VERTEX_FLOAT;
+		normal = VERTEX_NONE;
+		interleaved = true;
+	}
+
+	VertexLayout(VertexAttributeFormat pos, VertexAttributeFormat col, VertexAttributeFormat norm, bool inter = true)
+	{
+		position = pos;
+		color = col;
+		normal = norm;
+		interleaved = inter;
+	}
+
+	// Half float positions and an 8 bit color (12 bytes a vertex), plus packed normals if withNormals is true (16 bytes).
+	static VertexLayout Compact(bool withNormals = false)
+	{
+		return VertexLayout(VERTEX_HALF, VERTEX_UNORM8, withNormals ? VERTEX_SNORM10 : VERTEX_NONE);
+	}
+
+	bool operator==(const VertexLayout& other) const
+	{
+		return position == other.position && color == other.color && normal == other.normal && interleaved == other.interleaved;
+	}
+	bool operator!=(const VertexLayout& other) const
+	{
+		return !(*this == other);
+	}
+
+	// The size of each attribute of one vertex, in bytes (0 if it isn't stored).
+	int PositionSize() const;
+	int ColorSize() const;
+	int NormalSize() const;
+
+	// The size of one whole vertex, in bytes.
+	int VertexSize() const
+	{
+		return PositionSize() + ColorSize() + NormalSize();
+	}
+
+	// Converts the vertices into this layout, ready to be uploaded. out is resized to fit.
+	void Pack(const VertexFormat* vertices, int numVertices, std::vector<unsigned char>& out) const;
+
+	// Turns vertices packed in this layout (as Pack writes them) back into VertexFormats. Anything the layout doesn't store comes back as 0
+	// (or white, for a color), and whatever Pack rounded off stays rounded.
+	void Unpack(const unsigned char* packed, int numVertices, VertexFormat* out) const;
+
+	// Converts vertices[first] up to (but not including) vertices[first + count] into this layout, and copies them into their spot in the
+	// buffer bound to GL_ARRAY_BUFFER, which has room for capacity vertices. Nothing else in the buffer changes.
+	void Upload(const VertexFormat* vertices, int first, int count, int capacity) const;
+
+	// Points the vertex attributes of the currently bound vao at a buffer (bound to GL_ARRAY_BUFFER) with room for capacity vertices in this layout.
+	void SetAttributes(int capacity) const;
+
+	// Points the per-instance transform attributes (locations 2 through 4) of the currently bound vao at the buffer bound to GL_ARRAY_BUFFER,
+	// which holds one InstanceTransform per instance.
+	static void SetInstanceAttributes();
+
+	// Sets the current value of the instance attributes to a transform that leaves everything where it is, for a vao without them (which
+	// reads the current value instead), such as one for lines that are already in world space.
+	static void SetIdentityInstance();
+
+	// The GL_UNIFORM_BUFFER binding point the vertex shader's Camera block (the view projection matrix) reads from.
+	static const GLuint CAMERA_BINDING = 0;
+
+private:
+	// Writes one attribute (0 for color, 1 for position, 2 for normal) of a vertex to dest.
+	void packAttribute(int attribute, const VertexFormat& vert, unsigned char* dest) const;
+
+	// And reads it back.
+	void unpackAttribute(int attribute, const unsigned char* source, VertexFormat& vert) const;
+
+	// Where the first color, position and normal are in a buffer with room for capacity vertices, and how far apart each one is from the next.
+	void getOffsets(int capacity, int offsets[3], int strides[3]) const;
+};
+
+// One instance's transform as the vertex shader reads it (see SetInstanceAttributes): its position, its orientation as a quaternion in 16
+// bit fixed point (-32767 to 32767 for -1 to 1), and its scale in half floats. That's 28 bytes where a matrix is 64, so uploading a
+// frame's instances takes less than half the bandwidth, and the vertex shader turns it back into a rotation and scale for next to nothing.
+// 16 bits is about 1/30000 of a turn for each part of the quaternion, far finer than a pixel, and a half float keeps a scale to 3 digits.
+// (The position stays a full float, since it's in world space.) This is laid out the same as InstanceTransform in CullShader.glsl.
+struct InstanceTransform
+{
+	glm::vec3 position;
+	short rotation[4];			// x, y, z, w.
+	unsigned short scale[4];	// x, y, z, and a fourth that's always 0, so the next instance starts on a 4 byte boundary.
+};
+
+// Packs the transform of each of count instances from its position, orientation and scale (each array having count of them), into instances.
+void PackInstances(const glm::vec3* positions, const glm::quat* orientations, const glm::vec3* scales, InstanceTransform* instances, int count);
+
+// The same for one instance.
+InstanceTransform PackInstance(const glm::vec3& position, const glm::quat& orientation, const glm::vec3& scale);
+
+#endif //_VERTEX_LAYOUT_H
@@ -38,12 +38,32 @@ since they are aligned on the same axis.
 layout(location = 0) in vec3 in_position;	// Get in a vec3 for position
 layout(location = 1) in vec4 in_color;		// Get in a vec4 for color
 
+// This instance's transform, which puts it in the world (see InstanceTransform in VertexLayout.h). It comes in as a position, rotation and
+// scale rather than a matrix, which is less than half the size to upload.
+layout(location = 2) in vec3 instancePosition;
+layout(location = 3) in vec4 instanceRotation;	// A quaternion, as x, y, z, w (from 16 bit fixed point, so only nearly unit length).
+layout(location = 4) in vec3 instanceScale;
+
+// The camera, which is the same for everything drawn in a frame, so it's uploaded once per frame rather than baked into every instance's matrix.
+layout(std140) uniform Camera
+{
+	mat4 viewProjection;
+};
+
 out vec4 color; // Our vec4 color variable containing r, g, b, a
 
-uniform mat4 MVP; // Our uniform MVP matrix to modify our position values
+// Rotates v by the unit quaternion q. This is q * v * q's conjugate, worked out and simplified to two cross products.
+vec3 rotate(vec4 q, vec3 v)
+{
+	return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
 
 void main(void)
 {
 	color = in_color;	// Pass the color through
-	gl_Position = MVP * vec4(in_position, 1.0); //w is 1.0, also notice cast to a vec4
+
+	// Scale, then rotate, then move, the same order the matrix would have done it in.
+	vec3 world = instancePosition + rotate(normalize(instanceRotation), in_position * instanceScale);
+
+	gl_Position = viewProjection * vec4(world, 1.0); //w is 1.0, also notice cast to a vec4
 }
\ No newline at end of file
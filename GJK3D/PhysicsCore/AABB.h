@@ -0,0 +1,226 @@
+/*
+Title: GJK-3D (OBB)
+File Name: AABB.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _AABB_H
+#define _AABB_H
+
+#include "Shapes.h"
+
+// An Axis-Aligned Bounding Box, stored as its minimum and maximum corners.
+// This is what the broadphase works with. Two AABBs can be tested against each other with six comparisons, which is far cheaper than GJK,
+// so we use them to throw out every pair of objects that can't possibly be touching before any real collision test runs.
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	AABB()
+	{
+		min = glm::vec3(0.0f);
+		max = glm::vec3(0.0f);
+	}
+
+	AABB(const glm::vec3& inMin, const glm::vec3& inMax)
+	{
+		min = inMin;
+		max = inMax;
+	}
+
+	bool Overlaps(const AABB& other) const
+	{
+		return min.x <= other.max.x && max.x >= other.min.x &&
+			min.y <= other.max.y && max.y >= other.min.y &&
+			min.z <= other.max.z && max.z >= other.min.z;
+	}
+
+	// Returns true if other fits completely inside this box.
+	bool Contains(const AABB& other) const
+	{
+		return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+			max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+	}
+
+	// Returns true if the segment from from to from + delta passes through this box grown by extents on every side. (Growing the box by the
+	// half size of a second box means the segment hits it exactly when that second box, centered on the segment, would touch this one.)
+	// This is the slab test: the segment is inside the box between when it has entered the slabs of all three axes and when it leaves the
+	// first of them.
+	bool SegmentOverlaps(const glm::vec3& from, const glm::vec3& delta, const glm::vec3& extents) const
+	{
+		float enter = 0.0f;
+		float exit = 1.0f;
+
+		for (int i = 0; i < 3; i++)
+		{
+			float low = min[i] - extents[i] - from[i];
+			float high = max[i] + extents[i] - from[i];
+
+			// Parallel to this slab, so it's either inside it the whole way or never.
+			if (delta[i] == 0.0f)
+			{
+				if (low > 0.0f || high < 0.0f)
+				{
+					return false;
+				}
+
+				continue;
+			}
+
+			float t0 = low / delta[i];
+			float t1 = high / delta[i];
+
+			if (t0 > t1)
+			{
+				float temp = t0;
+				t0 = t1;
+				t1 = temp;
+			}
+
+			enter = t0 > enter ? t0 : enter;
+			exit = t1 < exit ? t1 : exit;
+
+			if (enter > exit)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Half of the surface area. Only ever used to compare boxes against each other, so the factor of 2 doesn't matter.
+	float Area() const
+	{
+		glm::vec3 size = max - min;
+
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	// The smallest box around both a and b.
+	static AABB Union(const AABB& a, const AABB& b)
+	{
+		return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+	}
+};
+
+// Gets the AABB around an OBBShape. How far the box reaches along each world axis is the sum of how far each of its own axes reaches along it.
+inline AABB getBounds(const OBBShape& obj)
+{
+	glm::vec3 extent = glm::abs(obj.axes[0]) * obj.halfExtents.x + glm::abs(obj.axes[1]) * obj.halfExtents.y + glm::abs(obj.axes[2]) * obj.halfExtents.z;
+
+	return AABB(obj.center - extent, obj.center + extent);
+}
+
+inline AABB getBounds(const SphereShape& obj)
+{
+	return AABB(obj.center - glm::vec3(obj.radius), obj.center + glm::vec3(obj.radius));
+}
+
+// Gets the AABB of any shape from its support function, using the farthest point along each of the six axis directions.
+// This works for every shape, but costs six support calls, so shapes with a cheaper answer have their own getBounds above.
+template<typename Shape>
+inline AABB getBoundsFromSupport(const Shape& obj)
+{
+	AABB bounds;
+
+	for (int i = 0; i < 3; i++)
+	{
+		glm::vec3 axis(0.0f);
+		axis[i] = 1.0f;
+
+		bounds.max[i] = getFarthestPointInDirection(obj, axis)[i];
+		bounds.min[i] = getFarthestPointInDirection(obj, -axis)[i];
+	}
+
+	return bounds;
+}
+
+// The two cheapest shapes to test against each other, kept around a shape so a pair can be thrown out before GJK ever sees it.
+// The broadphase pairs objects by their fattened bounds, and also by where they're heading, so plenty of the pairs it finds aren't even
+// close. An AABB that fits the shape tightly and a sphere around it each catch pairs the other misses (the AABB of a turned box is loose
+// at its corners, and a sphere is loose along a long box's sides), and together they cost only a few comparisons.
+struct ShapeBounds
+{
+	AABB box;
+	glm::vec3 center;
+	float radius;
+
+	ShapeBounds()
+	{
+		center = glm::vec3(0.0f);
+		radius = 0.0f;
+	}
+
+	// False if the shapes these are around can't be touching. (True doesn't mean they are, only that GJK has to decide.)
+	bool Overlaps(const ShapeBounds& other) const
+	{
+		glm::vec3 offset = other.center - center;
+		float radii = radius + other.radius;
+
+		return glm::dot(offset, offset) <= radii * radii && box.Overlaps(other.box);
+	}
+};
+
+// The bounds of an OBBShape. The sphere is centered on the box and reaches its corners.
+inline ShapeBounds getShapeBounds(const OBBShape& obj)
+{
+	ShapeBounds bounds;
+	bounds.box = getBounds(obj);
+	bounds.center = obj.center;
+	bounds.radius = glm::length(obj.halfExtents);
+
+	return bounds;
+}
+
+// Builds the OBBs of several objects at once, the same as OBBShape(*transforms[object], localCenters[object], localHalfExtents[object])
+// and getShapeBounds would for each of the count objects listed in objects. Everything is indexed by object number, and only the listed
+// objects' shapes and bounds are written, so a caller can pass just the objects that have moved.
+// With SSE this builds 4 boxes at a time (see Shapes.cpp), and it comes out the same as building them one by one.
+void BuildOBBShapes(const int* objects, int count, const glm::mat4* const* transforms, const glm::vec3* localCenters,
+	const glm::vec3* localHalfExtents, OBBShape* shapes, ShapeBounds* bounds);
+
+// The bounds of any shape, from its AABB. The sphere is the one around the AABB, which is looser than it could be, but always right.
+template<typename Shape>
+inline ShapeBounds getShapeBoundsFromSupport(const Shape& obj)
+{
+	ShapeBounds bounds;
+	bounds.box = getBoundsFromSupport(obj);
+	bounds.center = (bounds.box.min + bounds.box.max) * 0.5f;
+	bounds.radius = glm::length(bounds.box.max - bounds.center);
+
+	return bounds;
+}
+
+#endif //_AABB_H
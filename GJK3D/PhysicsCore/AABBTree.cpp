@@ -0,0 +1,1027 @@
+/*
+Title: GJK-3D (OBB)
+File Name: AABBTree.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _AABB_TREE_CPP
+#define _AABB_TREE_CPP
+
+#include "AABBTree.h"
+#include "QBVH.h"
+#include "JobSystem.h"
+#include <algorithm>
+
+// How many places along each axis Rebuild tries splitting at. The leaves are put into this many bins by their centers, and the splits are
+// between the bins.
+static const int SAH_BINS = 12;
+
+// Rebuild splits the top of the tree into subtrees of at least this many leaves, and about this many for each thread, to build in
+// parallel. Below that, the tasks would be too small to be worth handing out.
+static const int REBUILD_TASK_LEAVES = 1024;
+static const int REBUILD_TASKS_PER_THREAD = 4;
+
+// FindPairs flattens the tree (see QBVH) for its queries when at least one proxy in this many has changed.
+static const int PAIRS_FLATTEN_FRACTION = 10;
+
+AABBTree::AABBTree(float inMargin)
+{
+	root = -1;
+	freeList = -1;
+	proxyCount = 0;
+
+	margin = inMargin;
+	displacementMultiplier = 2.0f;
+
+	deferInserts = false;
+	refitInPlace = false;
+	queryFlat = false;
+}
+
+int AABBTree::allocateNode()
+{
+	// If there are no free nodes, add one to the end of the array.
+	if (freeList == -1)
+	{
+		AABBTreeNode node;
+		node.height = -1;
+		node.parent = -1;
+		nodes.push_back(node);
+
+		freeList = (int)nodes.size() - 1;
+	}
+
+	int index = freeList;
+	freeList = nodes[index].parent;
+
+	AABBTreeNode& node = nodes[index];
+	node.parent = -1;
+	node.left = -1;
+	node.right = -1;
+	node.height = 0;
+	node.userData = -1;
+
+	return index;
+}
+
+void AABBTree::freeNode(int node)
+{
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+int AABBTree::CreateProxy(const AABB& bounds, int userData)
+{
+	int proxy = allocateNode();
+
+	nodes[proxy].bounds = AABB(bounds.min - glm::vec3(margin), bounds.max + glm::vec3(margin));
+	nodes[proxy].userData = userData;
+
+	if (!deferInserts)
+	{
+		insertLeaf(proxy);
+	}
+
+	bufferMove(proxy);
+	proxyCount++;
+
+	return proxy;
+}
+
+void AABBTree::DestroyProxy(int proxy)
+{
+	if (isLinked(proxy))
+	{
+		removeLeaf(proxy);
+	}
+
+	// Its pairs have to go. (If the node is reused before the next FindPairs, it'll still be in the buffer, and the pairs that came from
+	// it still get looked at again.)
+	bufferMove(proxy);
+
+	freeNode(proxy);
+	proxyCount--;
+}
+
+void AABBTree::Reserve(int numProxies, int numPairs, int threads)
+{
+	Broadphase::Reserve(numProxies, numPairs, threads);
+
+	// A tree over n leaves has n - 1 nodes above them.
+	int nodeCount = 2 * numProxies;
+
+	nodes.reserve(nodeCount);
+	moved.reserve(nodeCount);
+	moveBuffer.reserve(numProxies);
+
+	buildLeaves.reserve(numProxies);
+	buildInternal.reserve(numProxies);
+	buildTasks.reserve(threads * REBUILD_TASKS_PER_THREAD);
+	buildUpper.reserve(threads * REBUILD_TASKS_PER_THREAD);
+
+	flat.Reserve(numProxies);
+
+	trackedPairs.reserve(numPairs);
+	foundPairs.reserve(numPairs);
+	mergedPairs.reserve(numPairs);
+
+	// Any one thread could find every pair.
+	if ((int)threadPairs.size() < threads)
+	{
+		threadPairs.resize(threads);
+	}
+
+	for (int i = 0; i < (int)threadPairs.size(); i++)
+	{
+		threadPairs[i].reserve(numPairs);
+	}
+}
+
+void AABBTree::bufferMove(int proxy)
+{
+	if ((int)moved.size() < (int)nodes.size())
+	{
+		moved.resize(nodes.size(), 0);
+	}
+
+	if (!moved[proxy])
+	{
+		moved[proxy] = 1;
+		moveBuffer.push_back(proxy);
+	}
+}
+
+bool AABBTree::MoveProxy(int proxy, const AABB& bounds, const glm::vec3& displacement)
+{
+	// Still inside the fat bounds, so the tree doesn't need to change.
+	if (nodes[proxy].bounds.Contains(bounds))
+	{
+		return false;
+	}
+
+	// A proxy that isn't in the tree yet just takes its new bounds, ready for the Rebuild.
+	bool linked = isLinked(proxy);
+	bool reinsert = linked && !refitInPlace;
+
+	if (reinsert)
+	{
+		removeLeaf(proxy);
+	}
+
+	// Grow the new bounds by the margin (and more, the faster the object is going), and stretch them in the direction it's moving so it
+	// stays inside them for longer.
+	AABB fat = MakeFatBounds(bounds, margin, displacement, displacementMultiplier);
+
+	nodes[proxy].bounds = fat;
+
+	if (reinsert)
+	{
+		insertLeaf(proxy);
+	}
+	else if (linked)
+	{
+		// The heights and the shape of the tree stay the same, so only the boxes need growing.
+		for (int node = nodes[proxy].parent; node != -1 && !nodes[node].bounds.Contains(fat); node = nodes[node].parent)
+		{
+			nodes[node].bounds = AABB::Union(nodes[node].bounds, fat);
+		}
+	}
+
+	bufferMove(proxy);
+
+	return true;
+}
+
+void AABBTree::ShiftOrigin(const glm::vec3& origin)
+{
+	// (The free nodes' boxes don't matter, so there's no need to skip them.)
+	for (int i = 0; i < (int)nodes.size(); i++)
+	{
+		nodes[i].bounds.min -= origin;
+		nodes[i].bounds.max -= origin;
+	}
+}
+
+void AABBTree::Rebuild(JobSystem* jobs)
+{
+	int tasks = PrepareRebuild(jobs == nullptr ? 1 : jobs->GetThreadCount() * REBUILD_TASKS_PER_THREAD);
+
+	if (jobs == nullptr)
+	{
+		for (int i = 0; i < tasks; i++)
+		{
+			RunRebuildTask(i);
+		}
+	}
+	else
+	{
+		auto build = [this](int begin, int end, int thread)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				RunRebuildTask(i);
+			}
+		};
+
+		jobs->ParallelFor(tasks, 1, build);
+	}
+
+	FinishRebuild();
+}
+
+int AABBTree::ReinsertLeaves(int node, int count)
+{
+	// Taking a leaf out frees its parent, and putting it back takes that same node off the free list, so this never grows the array.
+	for (; node < (int)nodes.size(); node++)
+	{
+		if (count == 0)
+		{
+			return node;
+		}
+
+		if (nodes[node].height != 0 || !isLinked(node) || node == root)
+		{
+			continue;
+		}
+
+		removeLeaf(node);
+		insertLeaf(node);
+		count--;
+	}
+
+	return -1;
+}
+
+int AABBTree::PrepareRebuild(int maxTasks)
+{
+	buildLeaves.clear();
+	buildInternal.clear();
+	buildTasks.clear();
+	buildUpper.clear();
+
+	// Leaves have a height of 0 (whether they're in the tree yet or not), free nodes -1, and everything else is above the leaves, so it
+	// can all go.
+	for (int i = 0; i < (int)nodes.size(); i++)
+	{
+		if (nodes[i].height == 0)
+		{
+			buildLeaves.push_back(i);
+		}
+		else if (nodes[i].height > 0)
+		{
+			freeNode(i);
+		}
+	}
+
+	if (buildLeaves.empty())
+	{
+		root = -1;
+		return 0;
+	}
+
+	// A tree over n leaves always has n - 1 nodes above them, so they can all be handed out now. That way nothing allocates (or grows the
+	// array) while the tasks run, and each subtree knows which of them are its own: the first is its root, then its left subtree's, then
+	// its right subtree's.
+	buildInternal.resize(buildLeaves.size() - 1);
+
+	for (int i = 0; i < (int)buildInternal.size(); i++)
+	{
+		buildInternal[i] = allocateNode();
+	}
+
+	root = splitTop(0, (int)buildLeaves.size(), 0, maxTasks);
+	nodes[root].parent = -1;
+
+	return (int)buildTasks.size();
+}
+
+void AABBTree::RunRebuildTask(int task)
+{
+	const RebuildTask& range = buildTasks[task];
+
+	buildNodes(&buildLeaves[range.first], range.count, &buildInternal[range.internal]);
+}
+
+void AABBTree::FinishRebuild()
+{
+	// splitTop finished each node after both of its children, so going through them in order always has the children's boxes ready.
+	for (int i = 0; i < (int)buildUpper.size(); i++)
+	{
+		AABBTreeNode& node = nodes[buildUpper[i]];
+
+		node.bounds = AABB::Union(nodes[node.left].bounds, nodes[node.right].bounds);
+		node.height = 1 + std::max(nodes[node.left].height, nodes[node.right].height);
+	}
+
+	// Keep the room, but not the contents, so copying the tree (see PhysicsWorld::SaveState) doesn't copy them too.
+	buildLeaves.clear();
+	buildInternal.clear();
+	buildTasks.clear();
+	buildUpper.clear();
+}
+
+int AABBTree::splitTop(int first, int count, int internal, int maxTasks)
+{
+	if (count == 1)
+	{
+		return buildLeaves[first];
+	}
+
+	int node = buildInternal[internal];
+
+	// Small enough (or split enough ways) to be built as one task.
+	if (maxTasks <= 1 || count < REBUILD_TASK_LEAVES)
+	{
+		RebuildTask task;
+		task.first = first;
+		task.count = count;
+		task.internal = internal;
+
+		buildTasks.push_back(task);
+
+		return node;
+	}
+
+	int middle = splitLeaves(&buildLeaves[first], count);
+	int left = splitTop(first, middle, internal + 1, maxTasks / 2);
+	int right = splitTop(first + middle, count - middle, internal + middle, maxTasks - maxTasks / 2);
+
+	nodes[node].left = left;
+	nodes[node].right = right;
+	nodes[left].parent = node;
+	nodes[right].parent = node;
+
+	// Its box and height wait until its children have been built (see FinishRebuild).
+	buildUpper.push_back(node);
+
+	return node;
+}
+
+int AABBTree::splitLeaves(int* leaves, int count)
+{
+	// The box around the leaves' centers, which is what gets split into bins.
+	glm::vec3 low = nodes[leaves[0]].bounds.min + nodes[leaves[0]].bounds.max;
+	glm::vec3 high = low;
+
+	for (int i = 1; i < count; i++)
+	{
+		glm::vec3 center = nodes[leaves[i]].bounds.min + nodes[leaves[i]].bounds.max;
+
+		low = glm::min(low, center);
+		high = glm::max(high, center);
+	}
+
+	glm::vec3 extent = high - low;
+
+	// Try every split on every axis, and keep the cheapest. (The centers are doubled, to save halving them, which doesn't change the bins.)
+	int bestAxis = -1;
+	int bestSplit = 0;
+	float bestCost = 0.0f;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (extent[axis] <= 0.0f)
+		{
+			continue;
+		}
+
+		AABB binBounds[SAH_BINS];
+		int binCounts[SAH_BINS] = {};
+		float scale = SAH_BINS / extent[axis];
+
+		for (int i = 0; i < count; i++)
+		{
+			const AABB& bounds = nodes[leaves[i]].bounds;
+			int bin = std::min((int)(((bounds.min + bounds.max)[axis] - low[axis]) * scale), SAH_BINS - 1);
+
+			binBounds[bin] = binCounts[bin] == 0 ? bounds : AABB::Union(binBounds[bin], bounds);
+			binCounts[bin]++;
+		}
+
+		// Sweep from the right to get the area and count on the right of each split, then from the left to finish each one's cost.
+		float rightAreas[SAH_BINS];
+		int rightCounts[SAH_BINS];
+		AABB right;
+		int rightCount = 0;
+
+		for (int bin = SAH_BINS - 1; bin > 0; bin--)
+		{
+			if (binCounts[bin] > 0)
+			{
+				right = rightCount == 0 ? binBounds[bin] : AABB::Union(right, binBounds[bin]);
+				rightCount += binCounts[bin];
+			}
+
+			rightAreas[bin] = rightCount > 0 ? right.Area() : 0.0f;
+			rightCounts[bin] = rightCount;
+		}
+
+		AABB left;
+		int leftCount = 0;
+
+		for (int split = 1; split < SAH_BINS; split++)
+		{
+			int bin = split - 1;
+
+			if (binCounts[bin] > 0)
+			{
+				left = leftCount == 0 ? binBounds[bin] : AABB::Union(left, binBounds[bin]);
+				leftCount += binCounts[bin];
+			}
+
+			if (leftCount == 0 || rightCounts[split] == 0)
+			{
+				continue;
+			}
+
+			float cost = leftCount * left.Area() + rightCounts[split] * rightAreas[split];
+
+			if (bestAxis == -1 || cost < bestCost)
+			{
+				bestAxis = axis;
+				bestSplit = split;
+				bestCost = cost;
+			}
+		}
+	}
+
+	int middle = count / 2;
+
+	// With every center in the same place there's nothing to split on, so the leaves are just halved.
+	if (bestAxis != -1)
+	{
+		float scale = SAH_BINS / extent[bestAxis];
+		float axisLow = low[bestAxis];
+		int axis = bestAxis;
+		int split = bestSplit;
+
+		int* firstRight = std::partition(leaves, leaves + count, [this, scale, axisLow, axis, split](int leaf)
+		{
+			const AABB& bounds = nodes[leaf].bounds;
+
+			return std::min((int)(((bounds.min + bounds.max)[axis] - axisLow) * scale), SAH_BINS - 1) < split;
+		});
+
+		middle = (int)(firstRight - leaves);
+	}
+
+	return middle;
+}
+
+int AABBTree::buildNodes(int* leaves, int count, const int* internal)
+{
+	if (count == 1)
+	{
+		return leaves[0];
+	}
+
+	int middle = splitLeaves(leaves, count);
+	int leftChild = buildNodes(leaves, middle, internal + 1);
+	int rightChild = buildNodes(leaves + middle, count - middle, internal + middle);
+	int node = internal[0];
+
+	nodes[node].left = leftChild;
+	nodes[node].right = rightChild;
+	nodes[node].bounds = AABB::Union(nodes[leftChild].bounds, nodes[rightChild].bounds);
+	nodes[node].height = 1 + std::max(nodes[leftChild].height, nodes[rightChild].height);
+
+	nodes[leftChild].parent = node;
+	nodes[rightChild].parent = node;
+
+	return node;
+}
+
+void AABBTree::insertLeaf(int leaf)
+{
+	if (root == -1)
+	{
+		root = leaf;
+		nodes[root].parent = -1;
+		return;
+	}
+
+	// Find the best sibling for the new leaf by walking down from the root. At each node we compare the cost of making the leaf a sibling of
+	// this node against the cheapest it could be to push it further down either child. The cost is surface area, since the bigger a box is
+	// the more queries will have to look inside it.
+	// (A copy, not a reference, because allocating the new parent below can grow the node array.)
+	AABB leafBounds = nodes[leaf].bounds;
+	int index = root;
+
+	while (!nodes[index].IsLeaf())
+	{
+		int left = nodes[index].left;
+		int right = nodes[index].right;
+
+		float area = nodes[index].bounds.Area();
+		float combinedArea = AABB::Union(nodes[index].bounds, leafBounds).Area();
+
+		// The cost of a new parent for this node and the leaf.
+		float cost = 2.0f * combinedArea;
+
+		// Anything we push further down also grows this node (and everything above it) by this much.
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		// The cost of going down each child.
+		float costLeft = AABB::Union(leafBounds, nodes[left].bounds).Area() + inheritanceCost;
+
+		if (!nodes[left].IsLeaf())
+		{
+			costLeft -= nodes[left].bounds.Area();
+		}
+
+		float costRight = AABB::Union(leafBounds, nodes[right].bounds).Area() + inheritanceCost;
+
+		if (!nodes[right].IsLeaf())
+		{
+			costRight -= nodes[right].bounds.Area();
+		}
+
+		if (cost < costLeft && cost < costRight)
+		{
+			break;
+		}
+
+		index = costLeft < costRight ? left : right;
+	}
+
+	int sibling = index;
+
+	// Make a new parent for the sibling and the leaf, in the sibling's old spot.
+	int oldParent = nodes[sibling].parent;
+	int newParent = allocateNode();
+
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].bounds = AABB::Union(leafBounds, nodes[sibling].bounds);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].left = sibling;
+	nodes[newParent].right = leaf;
+
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == -1)
+	{
+		root = newParent;
+	}
+	else if (nodes[oldParent].left == sibling)
+	{
+		nodes[oldParent].left = newParent;
+	}
+	else
+	{
+		nodes[oldParent].right = newParent;
+	}
+
+	refitUpward(nodes[leaf].parent);
+}
+
+void AABBTree::removeLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = -1;
+		return;
+	}
+
+	// The leaf's parent goes away, and the leaf's sibling takes the parent's place.
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+	if (grandParent == -1)
+	{
+		root = sibling;
+		nodes[sibling].parent = -1;
+		freeNode(parent);
+		return;
+	}
+
+	if (nodes[grandParent].left == parent)
+	{
+		nodes[grandParent].left = sibling;
+	}
+	else
+	{
+		nodes[grandParent].right = sibling;
+	}
+
+	nodes[sibling].parent = grandParent;
+	freeNode(parent);
+
+	refitUpward(grandParent);
+}
+
+void AABBTree::refitUpward(int node)
+{
+	while (node != -1)
+	{
+		node = balance(node);
+
+		int left = nodes[node].left;
+		int right = nodes[node].right;
+
+		nodes[node].height = 1 + std::max(nodes[left].height, nodes[right].height);
+		nodes[node].bounds = AABB::Union(nodes[left].bounds, nodes[right].bounds);
+
+		node = nodes[node].parent;
+	}
+}
+
+int AABBTree::balance(int a)
+{
+	if (nodes[a].IsLeaf() || nodes[a].height < 2)
+	{
+		return a;
+	}
+
+	// Say a's children are b and c, and c's children are f and g.
+	// If one child is taller than the other by more than one, the taller child (say c) moves up into a's place, a becomes its child, and the
+	// taller of c's children (say f) stays with c while the other (g) moves over to a. That takes one level off the tall side.
+	int b = nodes[a].left;
+	int c = nodes[a].right;
+
+	int heightDifference = nodes[c].height - nodes[b].height;
+
+	if (heightDifference > 1)
+	{
+		int f = nodes[c].left;
+		int g = nodes[c].right;
+
+		// Swap a and c.
+		nodes[c].left = a;
+		nodes[c].parent = nodes[a].parent;
+		nodes[a].parent = c;
+
+		if (nodes[c].parent == -1)
+		{
+			root = c;
+		}
+		else if (nodes[nodes[c].parent].left == a)
+		{
+			nodes[nodes[c].parent].left = c;
+		}
+		else
+		{
+			nodes[nodes[c].parent].right = c;
+		}
+
+		// Keep the taller of f and g on c, and give the other to a.
+		if (nodes[f].height > nodes[g].height)
+		{
+			nodes[c].right = f;
+			nodes[a].right = g;
+			nodes[g].parent = a;
+		}
+		else
+		{
+			nodes[c].right = g;
+			nodes[a].right = f;
+			nodes[f].parent = a;
+		}
+
+		nodes[a].bounds = AABB::Union(nodes[b].bounds, nodes[nodes[a].right].bounds);
+		nodes[a].height = 1 + std::max(nodes[b].height, nodes[nodes[a].right].height);
+
+		return c;
+	}
+
+	if (heightDifference < -1)
+	{
+		// The same thing on the other side, where b is the taller child.
+		int d = nodes[b].left;
+		int e = nodes[b].right;
+
+		nodes[b].left = a;
+		nodes[b].parent = nodes[a].parent;
+		nodes[a].parent = b;
+
+		if (nodes[b].parent == -1)
+		{
+			root = b;
+		}
+		else if (nodes[nodes[b].parent].left == a)
+		{
+			nodes[nodes[b].parent].left = b;
+		}
+		else
+		{
+			nodes[nodes[b].parent].right = b;
+		}
+
+		if (nodes[d].height > nodes[e].height)
+		{
+			nodes[b].right = d;
+			nodes[a].left = e;
+			nodes[e].parent = a;
+		}
+		else
+		{
+			nodes[b].right = e;
+			nodes[a].left = d;
+			nodes[d].parent = a;
+		}
+
+		nodes[a].bounds = AABB::Union(nodes[nodes[a].left].bounds, nodes[c].bounds);
+		nodes[a].height = 1 + std::max(nodes[nodes[a].left].height, nodes[c].height);
+
+		return b;
+	}
+
+	return a;
+}
+
+void AABBTree::Flatten(QBVH& flat) const
+{
+	flat.Build(nodes.data(), root);
+}
+
+void AABBTree::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+	int count = PreparePairs(1);
+
+	FindPairsRange(0, count, 0);
+	FinishPairs(pairs);
+}
+
+int AABBTree::PreparePairs(int threads)
+{
+	if ((int)threadPairs.size() < threads)
+	{
+		threadPairs.resize(threads);
+	}
+
+	// Flattening the tree costs about as much as querying a tenth of the proxies in it, so it's only worth it when enough have changed.
+	queryFlat = (int)moveBuffer.size() * PAIRS_FLATTEN_FRACTION >= proxyCount;
+
+	if (queryFlat)
+	{
+		Flatten(flat);
+	}
+
+	return (int)moveBuffer.size();
+}
+
+void AABBTree::FindPairsRange(int begin, int end, int thread)
+{
+	std::vector<TrackedPair>& found = threadPairs[thread];
+
+	// Find every pair of each proxy that has changed. A proxy's query finds the proxy itself, and a pair of two changed proxies from both
+	// sides, so for those we only keep the one found from the proxy with the smaller index.
+	for (int i = begin; i < end; i++)
+	{
+		int proxy = moveBuffer[i];
+
+		// Destroyed ones (even if the node has gone to a new proxy, which will be in the buffer too) only need their pairs dropping, and
+		// one waiting for a Rebuild isn't in the tree for the others to find yet, so it waits in the buffer until it is.
+		if (nodes[proxy].height != 0 || !isLinked(proxy))
+		{
+			continue;
+		}
+
+		auto addPair = [this, proxy, &found](int other)
+		{
+			if (other != proxy && (!moved[other] || other > proxy) && CanPair(nodes[proxy].userData, nodes[other].userData))
+			{
+				TrackedPair pair;
+				pair.pair = BroadphasePair(nodes[proxy].userData, nodes[other].userData);
+				pair.proxyA = proxy;
+				pair.proxyB = other;
+
+				found.push_back(pair);
+			}
+
+			return true;
+		};
+
+		if (queryFlat)
+		{
+			flat.Query(nodes[proxy].bounds, addPair);
+		}
+		else
+		{
+			Query(nodes[proxy].bounds, addPair);
+		}
+	}
+}
+
+void AABBTree::FinishPairs(std::vector<BroadphasePair>& pairs)
+{
+	addedPairs.clear();
+	removedPairs.clear();
+
+	if (!moveBuffer.empty())
+	{
+		// Keep the memory for next time, but not the nodes.
+		flat.Clear();
+
+		// Which thread found which pair depends on how the jobs were picked up, but sorting puts them back in the one order there is.
+		foundPairs.clear();
+
+		for (int i = 0; i < (int)threadPairs.size(); i++)
+		{
+			foundPairs.insert(foundPairs.end(), threadPairs[i].begin(), threadPairs[i].end());
+			threadPairs[i].clear();
+		}
+
+		// Any thread could find all of them next time, so each one gets room for that rather than growing whenever it gets the most.
+		for (int i = 0; i < (int)threadPairs.size(); i++)
+		{
+			threadPairs[i].reserve(foundPairs.size());
+		}
+
+		SortPairs(foundPairs, mergedPairs);
+
+		// Walk the old pairs and the ones just found together (both are sorted). An old pair between two proxies that haven't changed is
+		// still there, and one with a proxy that has is only still there if it was found again.
+		mergedPairs.clear();
+
+		int last = 0;
+		int now = 0;
+
+		while (last < (int)trackedPairs.size() || now < (int)foundPairs.size())
+		{
+			if (now == (int)foundPairs.size() || (last < (int)trackedPairs.size() && trackedPairs[last] < foundPairs[now]))
+			{
+				const TrackedPair& old = trackedPairs[last++];
+
+				if (moved[old.proxyA] || moved[old.proxyB])
+				{
+					removedPairs.push_back(old.pair);
+				}
+				else
+				{
+					mergedPairs.push_back(old);
+				}
+			}
+			else if (last == (int)trackedPairs.size() || foundPairs[now] < trackedPairs[last])
+			{
+				addedPairs.push_back(foundPairs[now].pair);
+				mergedPairs.push_back(foundPairs[now++]);
+			}
+			else
+			{
+				mergedPairs.push_back(foundPairs[now++]);
+				last++;
+			}
+		}
+
+		trackedPairs.swap(mergedPairs);
+		mergedPairs.clear();
+		foundPairs.clear();
+
+		// Empty the buffer, except for the proxies still waiting to go in the tree.
+		int waiting = 0;
+
+		for (int i = 0; i < (int)moveBuffer.size(); i++)
+		{
+			int proxy = moveBuffer[i];
+
+			if (nodes[proxy].height == 0 && !isLinked(proxy))
+			{
+				moveBuffer[waiting++] = proxy;
+			}
+			else
+			{
+				moved[proxy] = 0;
+			}
+		}
+
+		moveBuffer.resize(waiting);
+	}
+
+	// The tracked pairs are sorted already, so the narrowphase always sees the pairs in the same order no matter how the tree happens to be
+	// built.
+	pairs.resize(trackedPairs.size());
+
+	for (int i = 0; i < (int)trackedPairs.size(); i++)
+	{
+		pairs[i] = trackedPairs[i].pair;
+	}
+}
+
+void AABBTree::Cull(const Frustum& frustum, std::vector<int>& visible) const
+{
+	visible.clear();
+
+	if (root == -1)
+	{
+		return;
+	}
+
+	// The same walk as Query, except that each node on the stack also remembers whether one of the nodes above it was already found to be
+	// completely inside the frustum. If so, it's visible too and doesn't need testing.
+	int stack[256];
+	bool inside[256];
+	int count = 0;
+
+	stack[count] = root;
+	inside[count] = false;
+	count++;
+
+	while (count > 0)
+	{
+		count--;
+
+		int index = stack[count];
+		bool nodeInside = inside[count];
+		const AABBTreeNode& node = nodes[index];
+
+		if (!nodeInside)
+		{
+			FrustumTest test = frustum.Classify(node.bounds);
+
+			if (test == FRUSTUM_OUTSIDE)
+			{
+				continue;
+			}
+
+			nodeInside = test == FRUSTUM_INSIDE;
+		}
+
+		if (node.IsLeaf())
+		{
+			visible.push_back(node.userData);
+		}
+		else
+		{
+			stack[count] = node.left;
+			inside[count] = nodeInside;
+			count++;
+
+			stack[count] = node.right;
+			inside[count] = nodeInside;
+			count++;
+		}
+	}
+}
+
+void AABBTree::CastSegment(const glm::vec3& from, const glm::vec3& to, const glm::vec3& extents, std::vector<int>& hits) const
+{
+	hits.clear();
+
+	if (root == -1)
+	{
+		return;
+	}
+
+	glm::vec3 delta = to - from;
+
+	// The same walk as Query, with the segment test in place of the overlap test.
+	int stack[256];
+	int count = 0;
+
+	stack[count++] = root;
+
+	while (count > 0)
+	{
+		const AABBTreeNode& node = nodes[stack[--count]];
+
+		if (!node.bounds.SegmentOverlaps(from, delta, extents))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			hits.push_back(node.userData);
+		}
+		else
+		{
+			stack[count++] = node.left;
+			stack[count++] = node.right;
+		}
+	}
+}
+
+#endif //_AABB_TREE_CPP
@@ -0,0 +1,337 @@
+/*
+Title: GJK-3D (OBB)
+File Name: AABBTree.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _AABB_TREE_H
+#define _AABB_TREE_H
+
+#include "Broadphase.h"
+#include "MemoryTracker.h"
+#include "QBVH.h"
+
+class JobSystem;
+
+// A node of the tree. Leaves hold one object's (fattened) bounds, and every other node holds the bounds around both of its children.
+struct AABBTreeNode
+{
+	AABB bounds;
+
+	// For a node in the tree this is its parent. For a node on the free list it is the next free node instead.
+	int parent;
+
+	int left;
+	int right;
+
+	// How far this node is from its deepest leaf (0 for a leaf). Free nodes have a height of -1.
+	int height;
+
+	// The number the object was added with, which is handed back in pairs and queries.
+	int userData;
+
+	bool IsLeaf() const
+	{
+		return left == -1;
+	}
+};
+
+// A dynamic bounding volume tree broadphase, in the style of Box2D's b2DynamicTree.
+// Every object gets a leaf, called a proxy, holding its bounds, and the nodes above hold boxes around everything below them. To find what
+// overlaps a box we only go down the branches whose boxes overlap it, which makes queries O(log N) instead of checking every object.
+// - The leaves are "fat": they are grown by a margin (and stretched in the direction the object is moving) so that an object can move a
+//   little without its leaf having to change. Most steps, most objects stay inside their fat bounds and the tree isn't touched at all.
+// - When an object does leave its fat bounds, its leaf is taken out and put back in, refitting the boxes above it on the way.
+// - Inserting picks the sibling that grows the tree's total surface area the least, and rotations keep the tree balanced, so it stays shallow
+//   no matter what order objects are added or moved in.
+// The nodes live in one array and refer to each other by index, so growing the tree never invalidates anything and there is a free list
+// to reuse the nodes of removed proxies. (With a million proxies that's tens of megabytes, so it can go on huge pages; see AllocatePages.)
+class AABBTree : public Broadphase
+{
+	// Saves and loads the arrays straight from a file (see WorldSnapshot).
+	friend class WorldSnapshot;
+
+	AlignedTrackedVector<AABBTreeNode, MEMORY_BROADPHASE> nodes;
+	int root;
+	int freeList;
+	int proxyCount;
+
+	// How much each leaf is grown by on every side, and how much further it is stretched in the direction of motion per unit of displacement.
+	float margin;
+	float displacementMultiplier;
+
+	// Whether new proxies are left out of the tree until the next Rebuild (see BeginBulkInsert).
+	bool deferInserts;
+
+	// Whether MoveProxy grows the boxes above a leaf to fit it, rather than taking it out and putting it back in (see SetRefitInPlace).
+	bool refitInPlace;
+
+	// While a Rebuild is going: every leaf, the nodes handed out to go above them, the subtrees still to be built (each a range of the
+	// leaves, and where its nodes start), and the nodes above those subtrees, to be finished once they're built.
+	struct RebuildTask
+	{
+		int first;
+		int count;
+		int internal;
+	};
+	std::vector<int> buildLeaves;
+	std::vector<int> buildInternal;
+	std::vector<RebuildTask> buildTasks;
+	std::vector<int> buildUpper;
+
+	// The flattened copy FindPairs queries (see Flatten). It's only kept for the length of one FindPairs, so saving a copy of the tree
+	// doesn't copy it too.
+	QBVH flat;
+
+	// The pairs the last FindPairs found, and the proxies they're between, sorted by pair. Only the proxies in moveBuffer (the ones created,
+	// destroyed, touched, or moved far enough to change their fat bounds since then) have their pairs looked for again; every other pair
+	// is between two fat boxes that haven't changed, so it must still be there. moved says which nodes are in the buffer, so that none go
+	// in twice.
+	struct TrackedPair
+	{
+		BroadphasePair pair;
+		int proxyA;
+		int proxyB;
+
+		bool operator<(const TrackedPair& other) const
+		{
+			return pair < other.pair;
+		}
+
+		friend const BroadphasePair& GetPair(const TrackedPair& tracked)
+		{
+			return tracked.pair;
+		}
+	};
+	std::vector<TrackedPair> trackedPairs;
+	std::vector<TrackedPair> foundPairs;
+	std::vector<TrackedPair> mergedPairs;
+	std::vector<int> moveBuffer;
+	std::vector<unsigned char> moved;
+
+	// What each thread has found so far in FindPairsRange, so that the threads never write to the same place, and whether the queries are
+	// going through the flattened copy this time.
+	std::vector<std::vector<TrackedPair> > threadPairs;
+	bool queryFlat;
+
+	void bufferMove(int proxy);
+
+	int allocateNode();
+	void freeNode(int node);
+
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+
+	// Rotates the tree at node if one side is more than one level taller than the other. Returns the node now in its place.
+	int balance(int node);
+
+	// Walks from node up to the root, refitting bounds and heights (and balancing) as it goes.
+	void refitUpward(int node);
+
+	// Whether a leaf is in the tree (as opposed to waiting for a Rebuild).
+	bool isLinked(int leaf) const
+	{
+		return leaf == root || nodes[leaf].parent != -1;
+	}
+
+	// Reorders count leaves so the first ones go on the left and the rest on the right, split where the surface area heuristic says (see
+	// Rebuild), and returns how many went on the left.
+	int splitLeaves(int* leaves, int count);
+
+	// Builds the subtree over count leaves from the top down, using the count - 1 nodes in internal, and returns its root.
+	int buildNodes(int* leaves, int count, const int* internal);
+
+	// Splits buildLeaves[first, first + count) the same way, but only far enough to make about maxTasks subtrees, which go in buildTasks.
+	int splitTop(int first, int count, int internal, int maxTasks);
+
+public:
+	AABBTree(float inMargin = 0.05f);
+
+	int CreateProxy(const AABB& bounds, int userData);
+
+	void DestroyProxy(int proxy);
+
+	// If the proxy has to change, it is taken out of the tree and re-inserted (or refit in place, see SetRefitInPlace).
+	bool MoveProxy(int proxy, const AABB& bounds, const glm::vec3& displacement);
+
+	// Every node's box moves, so the tree keeps its shape.
+	void ShiftOrigin(const glm::vec3& origin);
+
+	// With this on, MoveProxy leaves a leaf where it is in the tree, and only grows the boxes above it until it reaches one that already
+	// holds it. That's a handful of unions instead of a removal and an insert (each balancing the tree on the way back up), so a step that
+	// moves thousands of proxies costs a fraction of what it did. The boxes never shrink, though, so as objects move about the tree gets
+	// looser and slower to query, and it has to be rebuilt every so often (see Rebuild) to put it right. It's off to begin with.
+	void SetRefitInPlace(bool enabled)
+	{
+		refitInPlace = enabled;
+	}
+
+	// Throws away every node above the leaves and builds them again from the top down, with the surface area heuristic (SAH): each node's
+	// leaves are split in two wherever makes the two boxes' areas, weighted by how many leaves are in each, smallest, trying a handful of
+	// places along every axis. Inserting one leaf at a time only ever gets to pick a sibling for the leaf it's adding, so the tree it ends
+	// up with depends on the order they came in; building it all at once sees every leaf, and gives a tree that queries go through
+	// noticeably quicker. It's too slow to do every step, but it's just right for proxies that hardly ever change, like the static ones,
+	// for loading a whole scene, and for putting a tree back in shape every so often after lots of objects have moved.
+	// The proxies stay the same. With jobs, the subtrees under the top few levels are built across every thread (from the thread that
+	// owns the job system, outside of any job).
+	void Rebuild(JobSystem* jobs = nullptr);
+
+	// Rebuild in three parts, for running the middle one as jobs from inside another job: PrepareRebuild splits the top of the tree into at
+	// most maxTasks subtrees and returns how many, RunRebuildTask builds one of them (each can be on a different thread), and FinishRebuild
+	// puts the top back together once they're all built. Nothing else can use the tree in between.
+	int PrepareRebuild(int maxTasks);
+	void RunRebuildTask(int task);
+	void FinishRebuild();
+
+	// Putting the tree back in shape a little at a time instead of all at once (see TreeOptimizeTask): takes up to count leaves out and puts
+	// them back in, going through the nodes from node on, and returns the node to carry on from next time (or -1 once it's been through
+	// them all). Each one is inserted again where it fits the tree as it is now, and the boxes above where it was and where it goes are
+	// shrunk to fit, which undoes what SetRefitInPlace leaves behind. It isn't as good a tree as Rebuild makes, but the tree can be used
+	// as usual between calls, and the leaves and their fat bounds stay the same, so the pairs don't change.
+	int ReinsertLeaves(int node, int count);
+
+	// Between these, CreateProxy only makes the proxy, and leaves putting it in the tree to the next Rebuild: one build of the whole tree
+	// is much quicker than inserting a big scene's proxies one at a time, and makes a better tree too. The new proxies can be moved or
+	// destroyed as usual, but won't turn up in pairs, culls or casts until the Rebuild.
+	void BeginBulkInsert()
+	{
+		deferInserts = true;
+	}
+	void EndBulkInsert()
+	{
+		deferInserts = false;
+	}
+
+	const AABB& GetFatBounds(int proxy) const
+	{
+		return nodes[proxy].bounds;
+	}
+
+	int GetUserData(int proxy) const
+	{
+		return nodes[proxy].userData;
+	}
+
+	const char* GetName() const
+	{
+		return "AABB tree";
+	}
+
+	int GetProxyCount() const
+	{
+		return proxyCount;
+	}
+
+	// The height of the tree, which is a rough measure of how much work a query is. (0 for an empty tree or just one proxy.)
+	int GetHeight() const
+	{
+		return root == -1 ? 0 : nodes[root].height;
+	}
+
+	// Calls callback(proxy) for every proxy whose fat bounds overlap bounds. If the callback returns false, the query stops.
+	template<typename Callback>
+	void Query(const AABB& bounds, Callback& callback) const;
+
+	// Builds a flattened, four-wide copy of the tree, for querying it quicker while it isn't changing (see QBVH).
+	void Flatten(QBVH& flat) const;
+
+	// Only looks for the pairs of the proxies that have changed since the last time, and keeps every other pair it found then: most steps
+	// most objects stay inside their fat bounds, so this costs about as much as what changed, rather than as much as every pair there is.
+	// Each changed proxy queries the tree with its own bounds. They all query the same tree, so rather than walk the tree's own nodes each
+	// time, it flattens the tree first and queries the flattened copy, which is well over twice as fast and more than pays for building it.
+	void FindPairs(std::vector<BroadphasePair>& pairs);
+
+	void TouchProxy(int proxy)
+	{
+		bufferMove(proxy);
+	}
+
+	void Reserve(int numProxies, int numPairs, int threads);
+
+	// FindPairs in three parts, for running the queries as jobs: PreparePairs gets the tree ready to be queried by up to threads threads
+	// and returns how many proxies need querying, FindPairsRange queries the ones from begin up to end on the given thread (different
+	// ranges can be on different threads at once, since each thread keeps what it finds to itself), and FinishPairs puts together what
+	// they all found and fills pairs. Nothing else can change the tree in between.
+	int PreparePairs(int threads);
+	void FindPairsRange(int begin, int end, int thread);
+	void FinishPairs(std::vector<BroadphasePair>& pairs);
+
+	// Goes down the tree skipping every branch that's outside the frustum. Once a branch is completely inside, everything under it is
+	// visible without testing any more boxes.
+	void Cull(const Frustum& frustum, std::vector<int>& visible) const;
+
+	// Goes down the branches whose boxes the segment passes through, so a short ray through a big scene only tests a few boxes.
+	void CastSegment(const glm::vec3& from, const glm::vec3& to, const glm::vec3& extents, std::vector<int>& hits) const;
+};
+
+template<typename Callback>
+void AABBTree::Query(const AABB& bounds, Callback& callback) const
+{
+	if (root == -1)
+	{
+		return;
+	}
+
+	// The nodes still to visit. Each node we visit swaps itself for at most two children, so a tree as shallow as balancing keeps this one
+	// never gets anywhere near 256 (that would take far more proxies than fit in memory).
+	int stack[256];
+	int count = 0;
+
+	stack[count++] = root;
+
+	while (count > 0)
+	{
+		int index = stack[--count];
+		const AABBTreeNode& node = nodes[index];
+
+		if (!node.bounds.Overlaps(bounds))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			if (!callback(index))
+			{
+				return;
+			}
+		}
+		else
+		{
+			stack[count++] = node.left;
+			stack[count++] = node.right;
+		}
+	}
+}
+
+#endif //_AABB_TREE_H
@@ -0,0 +1,476 @@
+/*
+Title: GJK-3D (OBB)
+File Name: AssetStore.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _ASSET_STORE_CPP
+#define _ASSET_STORE_CPP
+
+#include "AssetStore.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// Rounds offset up to the next 16 byte boundary, where every section of a pack starts.
+static size_t alignSection(size_t offset)
+{
+	return (offset + 15) & ~(size_t)15;
+}
+
+// Writes zeros up to offset (where the next section starts), then size bytes of data.
+static void writeSection(FILE* out, size_t& written, size_t offset, const void* data, size_t size)
+{
+	static const char zeros[16] = {};
+
+	while (written < offset)
+	{
+		size_t padding = offset - written < sizeof(zeros) ? offset - written : sizeof(zeros);
+
+		fwrite(zeros, 1, padding, out);
+		written += padding;
+	}
+
+	if (size > 0)
+	{
+		fwrite(data, 1, size, out);
+		written += size;
+	}
+}
+
+// Whether count items of itemSize bytes starting at offset are all inside a file of fileSize bytes (and start on a boundary they can be
+// read from where they are).
+static bool sectionFits(unsigned int offset, unsigned int count, size_t itemSize, size_t fileSize)
+{
+	return offset % 4 == 0 && offset <= fileSize && count <= (fileSize - offset) / itemSize;
+}
+
+AssetStore::AssetStore()
+{
+}
+
+AssetStore::~AssetStore()
+{
+	for (int i = 0; i < (int)entries.size(); i++)
+	{
+		delete entries[i];
+	}
+
+	for (int i = 0; i < (int)packs.size(); i++)
+	{
+		delete packs[i];
+	}
+}
+
+AssetStore::Entry* AssetStore::find(const std::string& name) const
+{
+	std::string shortName = name.substr(0, ASSET_NAME_LENGTH - 1);
+
+	for (int i = 0; i < (int)entries.size(); i++)
+	{
+		if (entries[i]->name == shortName)
+		{
+			return entries[i];
+		}
+	}
+
+	return nullptr;
+}
+
+AssetStore::Entry* AssetStore::find(const SharedMesh* asset) const
+{
+	for (int i = 0; i < (int)entries.size(); i++)
+	{
+		if (&entries[i]->asset == asset)
+		{
+			return entries[i];
+		}
+	}
+
+	return nullptr;
+}
+
+// Points asset at an entry's own copies of a mesh, and copies the hull in next to them.
+static void fillEntry(SharedMesh& asset, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices, std::vector<glm::vec3>& hullPoints,
+	std::vector<int>& hullNeighborStart, std::vector<int>& hullNeighbors, const ConvexHull& hull)
+{
+	hullPoints.assign(hull.Points(), hull.Points() + hull.NumPoints());
+	hullNeighborStart.assign(hull.NeighborStarts(), hull.NeighborStarts() + hull.NumPoints() + 1);
+
+	if (hullNeighborStart.back() > 0)
+	{
+		hullNeighbors.assign(hull.Neighbors(0), hull.Neighbors(0) + hullNeighborStart.back());
+	}
+
+	asset.positions = positions.data();
+	asset.numPositions = (int)positions.size();
+	asset.indices = indices.data();
+	asset.numIndices = (int)indices.size();
+	asset.hullPoints = hullPoints.data();
+	asset.numHullPoints = (int)hullPoints.size();
+	asset.hullNeighborStart = hullNeighborStart.data();
+	asset.hullNeighbors = hullNeighbors.data();
+	asset.boundsMin = glm::vec3(0.0f);
+	asset.boundsMax = glm::vec3(0.0f);
+	asset.key = HashBytes(positions.data(), positions.size() * sizeof(glm::vec3));
+
+	for (int i = 0; i < (int)positions.size(); i++)
+	{
+		asset.boundsMin = i == 0 ? positions[i] : glm::min(asset.boundsMin, positions[i]);
+		asset.boundsMax = i == 0 ? positions[i] : glm::max(asset.boundsMax, positions[i]);
+	}
+}
+
+const SharedMesh* AssetStore::AddMesh(const std::string& name, const glm::vec3* positions, int numPositions, const unsigned int* indices,
+	int numIndices, HullCache* cache)
+{
+	const SharedMesh* existing = Acquire(name);
+
+	if (existing != nullptr)
+	{
+		return existing;
+	}
+
+	// The hull is built without holding the lock, since it can take a while and other threads may want other assets in the meantime.
+	Entry* entry = new Entry();
+	entry->name = name.substr(0, ASSET_NAME_LENGTH - 1);
+	entry->references = 1;
+	entry->mapped = false;
+	entry->positions.assign(positions, positions + numPositions);
+	entry->indices.assign(indices, indices + numIndices);
+
+	ConvexHull hull = cache != nullptr ? cache->GetHull(positions, numPositions) : ConvexHull::FromPoints(positions, numPositions);
+
+	fillEntry(entry->asset, entry->positions, entry->indices, entry->hullPoints, entry->hullNeighborStart, entry->hullNeighbors, hull);
+
+	return insert(entry);
+}
+
+const SharedMesh* AssetStore::AddMesh(const MeshAsset& asset)
+{
+	const SharedMesh* existing = Acquire(asset.model.name);
+
+	if (existing != nullptr)
+	{
+		return existing;
+	}
+
+	Entry* entry = new Entry();
+	entry->name = asset.model.name.substr(0, ASSET_NAME_LENGTH - 1);
+	entry->references = 1;
+	entry->mapped = false;
+	entry->positions = asset.model.positions;
+	entry->indices = asset.model.indices;
+
+	fillEntry(entry->asset, entry->positions, entry->indices, entry->hullPoints, entry->hullNeighborStart, entry->hullNeighbors, asset.hull);
+
+	return insert(entry);
+}
+
+const SharedMesh* AssetStore::insert(Entry* entry)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Another thread may have added the same one while we were building ours. Theirs wins, and ours is thrown away.
+	Entry* existing = find(entry->name);
+
+	if (existing != nullptr)
+	{
+		delete entry;
+
+		existing->references++;
+		return &existing->asset;
+	}
+
+	entries.push_back(entry);
+
+	return &entry->asset;
+}
+
+const SharedMesh* AssetStore::Acquire(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Entry* entry = find(name);
+
+	if (entry == nullptr)
+	{
+		return nullptr;
+	}
+
+	entry->references++;
+
+	return &entry->asset;
+}
+
+void AssetStore::Acquire(const SharedMesh* asset)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Entry* entry = find(asset);
+
+	if (entry != nullptr)
+	{
+		entry->references++;
+	}
+}
+
+void AssetStore::Release(const SharedMesh* asset)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Entry* entry = find(asset);
+
+	if (entry == nullptr || entry->references == 0)
+	{
+		return;
+	}
+
+	entry->references--;
+
+	// A pack's assets cost nothing but their entry, and the mapping stays either way, so they're kept for the next world that wants them.
+	if (entry->references == 0 && !entry->mapped)
+	{
+		entries.erase(std::find(entries.begin(), entries.end(), entry));
+		delete entry;
+	}
+}
+
+bool AssetStore::OpenPack(const std::string& fileName)
+{
+	MappedFile* file = new MappedFile();
+
+	if (!file->Open(fileName) || file->GetSize() < sizeof(AssetPackHeader))
+	{
+		delete file;
+		return false;
+	}
+
+	const char* data = file->GetData();
+	size_t size = file->GetSize();
+	const AssetPackHeader* header = (const AssetPackHeader*)data;
+
+	if (memcmp(header->magic, ASSET_PACK_MAGIC, sizeof(header->magic)) != 0 || header->version != ASSET_PACK_VERSION ||
+		header->recordsOffset % 16 != 0 || !sectionFits(header->recordsOffset, header->assetCount, sizeof(AssetPackRecord), size))
+	{
+		delete file;
+		return false;
+	}
+
+	// Check every record before adding any of them, so a broken pack adds nothing.
+	const AssetPackRecord* records = (const AssetPackRecord*)(data + header->recordsOffset);
+
+	for (unsigned int i = 0; i < header->assetCount; i++)
+	{
+		const AssetPackRecord& record = records[i];
+
+		if (record.name[sizeof(record.name) - 1] != '\0' ||
+			!sectionFits(record.positionsOffset, record.positionCount, sizeof(glm::vec3), size) ||
+			!sectionFits(record.indicesOffset, record.indexCount, sizeof(unsigned int), size) ||
+			!sectionFits(record.hullPointsOffset, record.hullPointCount, sizeof(glm::vec3), size) ||
+			!sectionFits(record.neighborStartOffset, record.hullPointCount + 1, sizeof(int), size) ||
+			!sectionFits(record.neighborsOffset, record.neighborCount, sizeof(int), size))
+		{
+			delete file;
+			return false;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (unsigned int i = 0; i < header->assetCount; i++)
+	{
+		const AssetPackRecord& record = records[i];
+
+		if (find(record.name) != nullptr)
+		{
+			continue;
+		}
+
+		Entry* entry = new Entry();
+		entry->name = record.name;
+		entry->references = 0;
+		entry->mapped = true;
+
+		SharedMesh& asset = entry->asset;
+		asset.positions = (const glm::vec3*)(data + record.positionsOffset);
+		asset.numPositions = (int)record.positionCount;
+		asset.indices = (const unsigned int*)(data + record.indicesOffset);
+		asset.numIndices = (int)record.indexCount;
+		asset.hullPoints = (const glm::vec3*)(data + record.hullPointsOffset);
+		asset.numHullPoints = (int)record.hullPointCount;
+		asset.hullNeighborStart = (const int*)(data + record.neighborStartOffset);
+		asset.hullNeighbors = (const int*)(data + record.neighborsOffset);
+		asset.boundsMin = record.boundsMin;
+		asset.boundsMax = record.boundsMax;
+		asset.key = record.key;
+
+		entries.push_back(entry);
+	}
+
+	packs.push_back(file);
+
+	return true;
+}
+
+bool AssetStore::SavePack(const std::string& fileName) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Lay the file out first, so the records can say where everything is before any of it is written.
+	AssetPackHeader header;
+	memcpy(header.magic, ASSET_PACK_MAGIC, sizeof(header.magic));
+	header.version = ASSET_PACK_VERSION;
+	header.assetCount = (unsigned int)entries.size();
+	header.recordsOffset = (unsigned int)alignSection(sizeof(AssetPackHeader));
+
+	std::vector<AssetPackRecord> records(entries.size());
+	size_t offset = header.recordsOffset + records.size() * sizeof(AssetPackRecord);
+
+	for (int i = 0; i < (int)entries.size(); i++)
+	{
+		const SharedMesh& asset = entries[i]->asset;
+		AssetPackRecord& record = records[i];
+
+		// The vector value-initialized the records, so they start zeroed: the rest of the name and the padding are written as zeros.
+		strncpy(record.name, entries[i]->name.c_str(), sizeof(record.name) - 1);
+		record.key = asset.key;
+		record.boundsMin = asset.boundsMin;
+		record.boundsMax = asset.boundsMax;
+
+		record.positionCount = (unsigned int)asset.numPositions;
+		record.indexCount = (unsigned int)asset.numIndices;
+		record.hullPointCount = (unsigned int)asset.numHullPoints;
+		record.neighborCount = (unsigned int)asset.hullNeighborStart[asset.numHullPoints];
+
+		record.positionsOffset = (unsigned int)(offset = alignSection(offset));
+		offset += record.positionCount * sizeof(glm::vec3);
+		record.indicesOffset = (unsigned int)(offset = alignSection(offset));
+		offset += record.indexCount * sizeof(unsigned int);
+		record.hullPointsOffset = (unsigned int)(offset = alignSection(offset));
+		offset += record.hullPointCount * sizeof(glm::vec3);
+		record.neighborStartOffset = (unsigned int)(offset = alignSection(offset));
+		offset += (record.hullPointCount + 1) * sizeof(int);
+		record.neighborsOffset = (unsigned int)(offset = alignSection(offset));
+		offset += record.neighborCount * sizeof(int);
+	}
+
+	FILE* out = fopen(fileName.c_str(), "wb");
+
+	if (out == nullptr)
+	{
+		return false;
+	}
+
+	size_t written = 0;
+
+	writeSection(out, written, 0, &header, sizeof(header));
+	writeSection(out, written, header.recordsOffset, records.data(), records.size() * sizeof(AssetPackRecord));
+
+	for (int i = 0; i < (int)entries.size(); i++)
+	{
+		const SharedMesh& asset = entries[i]->asset;
+		const AssetPackRecord& record = records[i];
+
+		writeSection(out, written, record.positionsOffset, asset.positions, record.positionCount * sizeof(glm::vec3));
+		writeSection(out, written, record.indicesOffset, asset.indices, record.indexCount * sizeof(unsigned int));
+		writeSection(out, written, record.hullPointsOffset, asset.hullPoints, record.hullPointCount * sizeof(glm::vec3));
+		writeSection(out, written, record.neighborStartOffset, asset.hullNeighborStart, (record.hullPointCount + 1) * sizeof(int));
+		writeSection(out, written, record.neighborsOffset, asset.hullNeighbors, record.neighborCount * sizeof(int));
+	}
+
+	bool succeeded = ferror(out) == 0;
+
+	// The same as HullCache::Save: a half written pack would be turned away by OpenPack, but may as well not be left lying around.
+	if (fclose(out) != 0 || !succeeded)
+	{
+		remove(fileName.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+int AssetStore::GetAssetCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return (int)entries.size();
+}
+
+int AssetStore::GetReferences(const std::string& name) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Entry* entry = find(name);
+
+	return entry != nullptr ? entry->references : 0;
+}
+
+size_t AssetStore::GetOwnedBytes() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t bytes = 0;
+
+	for (int i = 0; i < (int)entries.size(); i++)
+	{
+		const Entry& entry = *entries[i];
+
+		bytes += entry.positions.size() * sizeof(glm::vec3) + entry.indices.size() * sizeof(unsigned int) +
+			entry.hullPoints.size() * sizeof(glm::vec3) + (entry.hullNeighborStart.size() + entry.hullNeighbors.size()) * sizeof(int);
+	}
+
+	return bytes;
+}
+
+size_t AssetStore::GetMappedBytes() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t bytes = 0;
+
+	for (int i = 0; i < (int)packs.size(); i++)
+	{
+		bytes += packs[i]->GetSize();
+	}
+
+	return bytes;
+}
+
+void AcquireSceneModels(AssetStore& store, const Scene& scene, std::vector<const SharedMesh*>& assets, HullCache* cache)
+{
+	assets.clear();
+
+	for (int i = 0; i < (int)scene.models.size(); i++)
+	{
+		const SceneModel& model = scene.models[i];
+
+		assets.push_back(store.AddMesh(model.name, model.positions.data(), (int)model.positions.size(), model.indices.data(),
+			(int)model.indices.size(), cache));
+	}
+}
+
+#endif // _ASSET_STORE_CPP
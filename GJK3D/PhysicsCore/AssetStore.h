@@ -0,0 +1,197 @@
+/*
+Title: GJK-3D (OBB)
+File Name: AssetStore.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _ASSET_STORE_H
+#define _ASSET_STORE_H
+
+#include "HullCache.h"
+#include "MappedFile.h"
+#include "MeshImport.h"
+#include "SceneFile.h"
+#include "Shapes.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+// An asset pack file is a header, then a record for each asset, then each asset's positions, indices, hull points, hull neighborStart array
+// and hull neighbors. Each section starts on a 16 byte boundary, and is laid out exactly as a SharedMesh points at it, so the assets are used
+// straight out of the mapping.
+static const char ASSET_PACK_MAGIC[4] = { 'G', 'J', 'K', 'A' };
+static const unsigned int ASSET_PACK_VERSION = 1;
+
+// The longest an asset's name can be, counting the terminating zero.
+static const int ASSET_NAME_LENGTH = 32;
+
+struct AssetPackHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned int assetCount;
+	unsigned int recordsOffset;		// Where the records start, in bytes from the start of the file.
+};
+
+// Where one asset's arrays are, in bytes from the start of the file, and how long they are.
+struct AssetPackRecord
+{
+	char name[ASSET_NAME_LENGTH];
+	unsigned long long key;
+	unsigned int positionsOffset;
+	unsigned int positionCount;
+	unsigned int indicesOffset;
+	unsigned int indexCount;
+	unsigned int hullPointsOffset;
+	unsigned int hullPointCount;
+	unsigned int neighborStartOffset;	// hullPointCount + 1 of them.
+	unsigned int neighborsOffset;
+	unsigned int neighborCount;
+	unsigned int padding;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+
+// A mesh and the convex hull around it, as an AssetStore holds it: the same as a MeshAsset, except that none of it ever changes once it's
+// in the store, so every world (on any thread) can use the same one, and it's only pointed at, so it can be in a mapped file.
+struct SharedMesh
+{
+	const glm::vec3* positions;
+	int numPositions;
+	const unsigned int* indices;
+	int numIndices;
+
+	// The hull, the same as a ConvexHull keeps it (see ConvexHull::NeighborStarts).
+	const glm::vec3* hullPoints;
+	int numHullPoints;
+	const int* hullNeighborStart;
+	const int* hullNeighbors;
+
+	// The box around the positions, and the hash of them (the same key HullCache uses).
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	unsigned long long key;
+
+	// A hull shape over the asset's hull points, which it only points at.
+	HullShape GetHullShape() const
+	{
+		return HullShape(hullPoints, numHullPoints);
+	}
+};
+
+// Keeps one copy of each mesh (and its hull) for everything in the process to share, however many worlds use it, instead of each world (or
+// each copy of a scene) having its own. Assets are found by name, and counted: Acquire adds a reference and Release takes it away, and an
+// asset added with AddMesh is freed when its last reference is released.
+// An asset pack (see SavePack) goes further: OpenPack maps the file read-only, and its assets point straight into the mapping, so they aren't
+// read or copied at all, and every process that opens the same pack (50 servers on one machine, say) shares the same pages of memory
+// through the operating system's file cache. A pack's assets are never freed: they're only mapped, and stay until the store goes away.
+// Every function can be called from any thread.
+class AssetStore
+{
+	struct Entry
+	{
+		std::string name;
+		SharedMesh asset;
+		int references;
+
+		// Where an asset added with AddMesh keeps its arrays. A pack's assets leave these empty.
+		std::vector<glm::vec3> positions;
+		std::vector<unsigned int> indices;
+		std::vector<glm::vec3> hullPoints;
+		std::vector<int> hullNeighborStart;
+		std::vector<int> hullNeighbors;
+		bool mapped;
+	};
+
+	// Entries are never moved (the MeshAssets handed out point into them), so they're kept by pointer.
+	std::vector<Entry*> entries;
+	std::vector<MappedFile*> packs;
+	mutable std::mutex mutex;
+
+	// Adds entry (which holds a reference for the caller) and returns its asset, unless there's one of that name already, which gets the
+	// reference instead, and entry is thrown away. Takes the lock.
+	const SharedMesh* insert(Entry* entry);
+
+	// Returns the entry for name, or nullptr. The caller holds the lock.
+	Entry* find(const std::string& name) const;
+
+	// The same as find, for an asset we handed out.
+	Entry* find(const SharedMesh* asset) const;
+
+	// The store can't be copied, since the assets it hands out point into it.
+	AssetStore(const AssetStore&);
+	AssetStore& operator=(const AssetStore&);
+
+public:
+	AssetStore();
+
+	// Frees every asset, and closes the packs. Nothing the store handed out can be used after this.
+	~AssetStore();
+
+	// Returns the asset called name with a reference added, adding it first (with a copy of the positions and indices, and the hull around
+	// them) if there isn't one. The hull comes from cache if one is given (see HullCache::GetHull), otherwise it's built.
+	// Names are cut short at ASSET_NAME_LENGTH - 1 characters (here and everywhere else), so they fit in a pack.
+	const SharedMesh* AddMesh(const std::string& name, const glm::vec3* positions, int numPositions, const unsigned int* indices, int numIndices,
+		HullCache* cache = nullptr);
+
+	// The same for a mesh that's been loaded already (see LoadMeshAsset), named after its model, with the hull it came with (simplified or
+	// not). The MeshAsset can be thrown away afterwards.
+	const SharedMesh* AddMesh(const MeshAsset& asset);
+
+	// Returns the asset called name with a reference added, or nullptr if there isn't one.
+	const SharedMesh* Acquire(const std::string& name);
+
+	// Adds another reference to an asset that's already held.
+	void Acquire(const SharedMesh* asset);
+
+	// Takes away a reference. An asset added with AddMesh is freed when its last one goes.
+	void Release(const SharedMesh* asset);
+
+	// Maps an asset pack and adds every asset in it, except those with the name of one that's already here. Returns false if it can't be
+	// opened, or isn't an asset pack this version can read (and then adds nothing).
+	bool OpenPack(const std::string& fileName);
+
+	// Writes every asset in the store to an asset pack. Returns false if it can't be written.
+	bool SavePack(const std::string& fileName) const;
+
+	// How many assets there are, how many references one has, and how many bytes of them were copied in (by AddMesh) and are mapped.
+	int GetAssetCount() const;
+	int GetReferences(const std::string& name) const;
+	size_t GetOwnedBytes() const;
+	size_t GetMappedBytes() const;
+};
+
+// Acquires every model in a scene from store (adding the ones it doesn't have yet), into assets in the same order as scene.models, so a
+// scene loaded once can be handed to many worlds without them each keeping its meshes. Release each one when the world is done with it.
+void AcquireSceneModels(AssetStore& store, const Scene& scene, std::vector<const SharedMesh*>& assets, HullCache* cache = nullptr);
+
+#endif //_ASSET_STORE_H
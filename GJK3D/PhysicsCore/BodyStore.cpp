@@ -0,0 +1,581 @@
+/*
+Title: GJK-3D (OBB)
+File Name: BodyStore.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _BODY_STORE_CPP
+#define _BODY_STORE_CPP
+
+#include "BodyStore.h"
+#include "Morton.h"
+#include "SIMD.h"
+#include "glm\gtc\matrix_transform.hpp"
+#include "glm\gtx\quaternion.hpp"
+#include <algorithm>
+#include <cmath>
+
+// How many bodies Integrate moves before it builds their transforms. This is small enough that the positions it just wrote are still in the
+// cache when the transforms read them back, but big enough that the vector loops get a good run at it.
+static const int INTEGRATE_BLOCK = BODY_BLOCK * 4;
+
+// Builds a translation * rotation * scale matrix straight from its parts.
+// The rotation part is the usual quaternion-to-matrix formula (the same one glm::toMat4 uses), with column i scaled by scale[i], and the
+// translation is just the last column. That's the same matrix as multiplying the three together, without two full mat4 multiplies.
+static void composeTransform(const glm::vec3& position, const glm::quat& q, const glm::vec3& scale, glm::mat4& out)
+{
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+	out[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * scale.x, 2.0f * (xy + wz) * scale.x, 2.0f * (xz - wy) * scale.x, 0.0f);
+	out[1] = glm::vec4(2.0f * (xy - wz) * scale.y, (1.0f - 2.0f * (xx + zz)) * scale.y, 2.0f * (yz + wx) * scale.y, 0.0f);
+	out[2] = glm::vec4(2.0f * (xz + wy) * scale.z, 2.0f * (yz - wx) * scale.z, (1.0f - 2.0f * (xx + yy)) * scale.z, 0.0f);
+	out[3] = glm::vec4(position, 1.0f);
+}
+
+// Does velocity += acceleration * dt, then position += velocity * dt, for count floats.
+// Since every one of these is done the same way to x, y and z, we don't need to care where one body ends and the next begins: the arrays
+// of vec3s are just treated as long arrays of floats, and we go through them 8 (AVX) or 4 (SSE/NEON) at a time.
+static void integrateFloats(float* positions, float* velocities, const float* accelerations, int count, float dt)
+{
+	int i = 0;
+
+#if defined(GJK_SIMD_AVX)
+	__m256 dt8 = _mm256_set1_ps(dt);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 v = _mm256_add_ps(_mm256_loadu_ps(velocities + i), _mm256_mul_ps(_mm256_loadu_ps(accelerations + i), dt8));
+		_mm256_storeu_ps(velocities + i, v);
+		_mm256_storeu_ps(positions + i, _mm256_add_ps(_mm256_loadu_ps(positions + i), _mm256_mul_ps(v, dt8)));
+	}
+#endif
+#if defined(GJK_SIMD_SSE)
+	__m128 dt4 = _mm_set1_ps(dt);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 v = _mm_add_ps(_mm_loadu_ps(velocities + i), _mm_mul_ps(_mm_loadu_ps(accelerations + i), dt4));
+		_mm_storeu_ps(velocities + i, v);
+		_mm_storeu_ps(positions + i, _mm_add_ps(_mm_loadu_ps(positions + i), _mm_mul_ps(v, dt4)));
+	}
+#elif defined(GJK_SIMD_NEON)
+	float32x4_t dt4 = vdupq_n_f32(dt);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4_t v = vaddq_f32(vld1q_f32(velocities + i), vmulq_f32(vld1q_f32(accelerations + i), dt4));
+		vst1q_f32(velocities + i, v);
+		vst1q_f32(positions + i, vaddq_f32(vld1q_f32(positions + i), vmulq_f32(v, dt4)));
+	}
+#endif
+
+	// Whatever is left over (or everything, without SIMD).
+	for (; i < count; i++)
+	{
+		velocities[i] += accelerations[i] * dt;
+		positions[i] += velocities[i] * dt;
+	}
+}
+
+// How far an orientation's squared length can drift from 1 before integrateOrientations scales it back.
+static const float ORIENTATION_DRIFT = 1e-4f;
+
+// Turns each of count orientations by its angular velocity over dt, with the first order step q += dt / 2 * (w, 0) * q (the derivative of
+// a quaternion spinning at w). That's 16 multiplies and no trig, where building a quaternion from the angle turned (or from Euler angles)
+// takes a sine and a cosine. Each step leaves q a little longer than 1, by about (|w| dt / 2)^2, so it's only scaled back to unit length
+// once that's added up to ORIENTATION_DRIFT, which at any sensible spin per step is every few dozen steps rather than every one. The
+// scale is the first order 1 / sqrt near 1 ((3 - |q|^2) / 2), so that's no square root either.
+// Bodies that aren't spinning (most of them) are left exactly as they are.
+static void integrateOrientations(glm::quat* orientations, const glm::vec3* angularVelocities, int count, float dt)
+{
+	float halfDt = dt * 0.5f;
+
+	for (int i = 0; i < count; i++)
+	{
+		const glm::vec3& w = angularVelocities[i];
+
+		if (w.x == 0.0f && w.y == 0.0f && w.z == 0.0f)
+		{
+			continue;
+		}
+
+		glm::quat& q = orientations[i];
+		glm::quat spin = glm::quat(0.0f, w.x * halfDt, w.y * halfDt, w.z * halfDt) * q;
+
+		q.x += spin.x;
+		q.y += spin.y;
+		q.z += spin.z;
+		q.w += spin.w;
+
+		float lengthSquared = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+
+		if (fabsf(lengthSquared - 1.0f) > ORIENTATION_DRIFT)
+		{
+			float scale = (3.0f - lengthSquared) * 0.5f;
+
+			q.x *= scale;
+			q.y *= scale;
+			q.z *= scale;
+			q.w *= scale;
+		}
+	}
+}
+
+// Does vectors[i] -= origin for count vectors. As in integrateFloats, the vectors are just a long array of floats; 4 vectors are 12 floats,
+// or 3 registers, and origin lines up with them as (x y z x), (y z x y) and (z x y z).
+static void shiftVectors(glm::vec3* vectors, int count, const glm::vec3& origin)
+{
+	int i = 0;
+
+#if defined(GJK_SIMD_SSE)
+	__m128 o0 = _mm_setr_ps(origin.x, origin.y, origin.z, origin.x);
+	__m128 o1 = _mm_setr_ps(origin.y, origin.z, origin.x, origin.y);
+	__m128 o2 = _mm_setr_ps(origin.z, origin.x, origin.y, origin.z);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		float* floats = &vectors[i].x;
+
+		_mm_storeu_ps(floats, _mm_sub_ps(_mm_loadu_ps(floats), o0));
+		_mm_storeu_ps(floats + 4, _mm_sub_ps(_mm_loadu_ps(floats + 4), o1));
+		_mm_storeu_ps(floats + 8, _mm_sub_ps(_mm_loadu_ps(floats + 8), o2));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		vectors[i] -= origin;
+	}
+}
+
+// Builds the transforms of count bodies, 4 at a time where we can.
+// The SSE path is also the formula in composeTransform, done for 4 bodies side by side.
+static void buildTransforms(const glm::vec3* positions, const glm::quat* orientations, const glm::vec3* scales, glm::mat4* transforms, int count)
+{
+	int i = 0;
+
+#if defined(GJK_SIMD_SSE)
+	// Each register holds one value (like qx, or the top left of the matrix) for all 4 bodies. Transposing gets us between that and the way the bodies are actually stored (each quaternion is x, y, z, w in a row,
+	// and each column of a matrix is 4 floats in a row).
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 two = _mm_set1_ps(2.0f);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 qx = _mm_loadu_ps(&orientations[i].x);
+		__m128 qy = _mm_loadu_ps(&orientations[i + 1].x);
+		__m128 qz = _mm_loadu_ps(&orientations[i + 2].x);
+		__m128 qw = _mm_loadu_ps(&orientations[i + 3].x);
+		_MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+		const glm::vec3* s = scales + i;
+		__m128 sx = _mm_set_ps(s[3].x, s[2].x, s[1].x, s[0].x);
+		__m128 sy = _mm_set_ps(s[3].y, s[2].y, s[1].y, s[0].y);
+		__m128 sz = _mm_set_ps(s[3].z, s[2].z, s[1].z, s[0].z);
+
+		__m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+		__m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+		__m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+		// Column 0, 1 and 2 of each matrix, one row per register, and then a row of zeros underneath.
+		__m128 c0x = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+		__m128 c0y = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+		__m128 c0z = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+		__m128 c0w = _mm_setzero_ps();
+
+		__m128 c1x = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+		__m128 c1y = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+		__m128 c1z = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+		__m128 c1w = _mm_setzero_ps();
+
+		__m128 c2x = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+		__m128 c2y = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+		__m128 c2z = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+		__m128 c2w = _mm_setzero_ps();
+
+		// After transposing, register k holds that column for body k.
+		_MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+		_MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+		_MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+
+		glm::mat4* m = transforms + i;
+		_mm_storeu_ps(&m[0][0].x, c0x);
+		_mm_storeu_ps(&m[1][0].x, c0y);
+		_mm_storeu_ps(&m[2][0].x, c0z);
+		_mm_storeu_ps(&m[3][0].x, c0w);
+		_mm_storeu_ps(&m[0][1].x, c1x);
+		_mm_storeu_ps(&m[1][1].x, c1y);
+		_mm_storeu_ps(&m[2][1].x, c1z);
+		_mm_storeu_ps(&m[3][1].x, c1w);
+		_mm_storeu_ps(&m[0][2].x, c2x);
+		_mm_storeu_ps(&m[1][2].x, c2y);
+		_mm_storeu_ps(&m[2][2].x, c2z);
+		_mm_storeu_ps(&m[3][2].x, c2w);
+
+		// The translation column doesn't need any math.
+		for (int k = 0; k < 4; k++)
+		{
+			m[k][3] = glm::vec4(positions[i + k], 1.0f);
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		composeTransform(positions[i], orientations[i], scales[i], transforms[i]);
+	}
+}
+
+BodyStore::BodyStore()
+{
+	freeSlot = -1;
+}
+
+BodyHandle BodyStore::Create()
+{
+	int slot;
+
+	if (freeSlot != -1)
+	{
+		slot = freeSlot;
+		freeSlot = handleToIndex[slot];
+	}
+	else
+	{
+		slot = (int)handleToIndex.size();
+		handleToIndex.push_back(0);
+		generations.push_back(0);
+	}
+
+	BodyHandle handle = slot | (generations[slot] << BODY_SLOT_BITS);
+
+	handleToIndex[slot] = (int)positions.size();
+	indexToHandle.push_back(handle);
+
+	positions.push_back(glm::vec3());
+	velocities.push_back(glm::vec3());
+	accelerations.push_back(glm::vec3());
+	inverseMasses.push_back(1.0f);
+	orientations.push_back(glm::quat());
+	angularVelocities.push_back(glm::vec3());
+	scales.push_back(glm::vec3(1.0f));
+	transforms.push_back(glm::mat4());
+	dirty.push_back(0);
+	sleeping.push_back(0);
+	types.push_back(BODY_DYNAMIC);
+	timeScales.push_back(1.0f);
+
+	// It starts out having been there all along.
+	previousPositions.push_back(positions.back());
+	previousOrientations.push_back(orientations.back());
+	previousScales.push_back(scales.back());
+
+	return handle;
+}
+
+void BodyStore::Destroy(BodyHandle handle)
+{
+	int slot = slotOf(handle);
+	int index = handleToIndex[slot];
+	int last = (int)positions.size() - 1;
+
+	// Move the last body into the hole, so the arrays stay packed.
+	positions[index] = positions[last];
+	velocities[index] = velocities[last];
+	accelerations[index] = accelerations[last];
+	inverseMasses[index] = inverseMasses[last];
+	orientations[index] = orientations[last];
+	angularVelocities[index] = angularVelocities[last];
+	scales[index] = scales[last];
+	transforms[index] = transforms[last];
+	dirty[index] = dirty[last];
+	sleeping[index] = sleeping[last];
+	types[index] = types[last];
+	timeScales[index] = timeScales[last];
+	previousPositions[index] = previousPositions[last];
+	previousOrientations[index] = previousOrientations[last];
+	previousScales[index] = previousScales[last];
+
+	BodyHandle moved = indexToHandle[last];
+	indexToHandle[index] = moved;
+	handleToIndex[slotOf(moved)] = index;
+
+	positions.pop_back();
+	velocities.pop_back();
+	accelerations.pop_back();
+	inverseMasses.pop_back();
+	orientations.pop_back();
+	angularVelocities.pop_back();
+	scales.pop_back();
+	transforms.pop_back();
+	dirty.pop_back();
+	sleeping.pop_back();
+	types.pop_back();
+	timeScales.pop_back();
+	previousPositions.pop_back();
+	previousOrientations.pop_back();
+	previousScales.pop_back();
+	indexToHandle.pop_back();
+
+	// Put the slot on the free list, with the generation its next body will have.
+	generations[slot] = (generations[slot] + 1) % BODY_GENERATIONS;
+	handleToIndex[slot] = freeSlot;
+	freeSlot = slot;
+}
+
+void BodyStore::Reserve(int count)
+{
+	positions.reserve(count);
+	velocities.reserve(count);
+	accelerations.reserve(count);
+	inverseMasses.reserve(count);
+	orientations.reserve(count);
+	angularVelocities.reserve(count);
+	scales.reserve(count);
+	transforms.reserve(count);
+	dirty.reserve(count);
+	sleeping.reserve(count);
+	types.reserve(count);
+	timeScales.reserve(count);
+	previousPositions.reserve(count);
+	previousOrientations.reserve(count);
+	previousScales.reserve(count);
+	indexToHandle.reserve(count);
+	handleToIndex.reserve(count);
+	generations.reserve(count);
+}
+
+bool BodyStore::SortByPosition()
+{
+	int count = (int)positions.size();
+
+	if (count < 2)
+	{
+		return false;
+	}
+
+	glm::vec3 boundsMin = positions[0];
+	glm::vec3 boundsMax = positions[0];
+
+	for (int i = 1; i < count; i++)
+	{
+		boundsMin = glm::min(boundsMin, positions[i]);
+		boundsMax = glm::max(boundsMax, positions[i]);
+	}
+
+	glm::vec3 scale = mortonScale(boundsMin, boundsMax);
+
+	// The code goes in the top half of each key and the body's index in the bottom, so bodies with the same code keep the order they were
+	// in, and the same bodies always end up in the same order.
+	sortKeys.resize(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		unsigned int code = mortonCode(positions[i], boundsMin, scale);
+
+		sortKeys[i] = ((unsigned long long)code << 32) | (unsigned int)i;
+	}
+
+	std::sort(sortKeys.begin(), sortKeys.end());
+
+	// Swap each body straight into its place. Swapping keeps the handles pointing at the right places as it goes, so the body that belongs
+	// at i is found by its handle wherever the swaps before have put it, and each swap puts at least one body where it belongs for good.
+	for (int i = 0; i < count; i++)
+	{
+		sortKeys[i] = (unsigned long long)indexToHandle[(int)(sortKeys[i] & 0xFFFFFFFF)];
+	}
+
+	bool moved = false;
+
+	for (int i = 0; i < count; i++)
+	{
+		int index = handleToIndex[slotOf((BodyHandle)sortKeys[i])];
+
+		if (index != i)
+		{
+			swapBodies(i, index);
+			moved = true;
+		}
+	}
+
+	return moved;
+}
+
+void BodyStore::swapBodies(int a, int b)
+{
+	std::swap(positions[a], positions[b]);
+	std::swap(velocities[a], velocities[b]);
+	std::swap(accelerations[a], accelerations[b]);
+	std::swap(inverseMasses[a], inverseMasses[b]);
+	std::swap(orientations[a], orientations[b]);
+	std::swap(angularVelocities[a], angularVelocities[b]);
+	std::swap(scales[a], scales[b]);
+	std::swap(transforms[a], transforms[b]);
+	std::swap(dirty[a], dirty[b]);
+	std::swap(sleeping[a], sleeping[b]);
+	std::swap(types[a], types[b]);
+	std::swap(timeScales[a], timeScales[b]);
+	std::swap(previousPositions[a], previousPositions[b]);
+	std::swap(previousOrientations[a], previousOrientations[b]);
+	std::swap(previousScales[a], previousScales[b]);
+
+	std::swap(indexToHandle[a], indexToHandle[b]);
+	handleToIndex[slotOf(indexToHandle[a])] = a;
+	handleToIndex[slotOf(indexToHandle[b])] = b;
+}
+
+void BodyStore::buildTransform(int index)
+{
+	composeTransform(positions[index], orientations[index], scales[index], transforms[index]);
+
+	dirty[index] = 0;
+}
+
+void BodyStore::UpdateTransforms(int begin, int end)
+{
+	for (int i = begin; i < end; i++)
+	{
+		if (dirty[i])
+		{
+			buildTransform(i);
+		}
+	}
+}
+
+void BodyStore::SavePrevious()
+{
+	// These are the same size as the current arrays, so this is just three copies, with no allocation.
+	previousPositions.assign(positions.begin(), positions.end());
+	previousOrientations.assign(orientations.begin(), orientations.end());
+	previousScales.assign(scales.begin(), scales.end());
+}
+
+void BodyStore::ShiftOrigin(const glm::vec3& origin)
+{
+	shiftVectors(positions.data(), (int)positions.size(), origin);
+	shiftVectors(previousPositions.data(), (int)previousPositions.size(), origin);
+
+	// A transform's translation is its body's position, as it is (see composeTransform), so taking the same off both leaves them matching.
+	// (A dirty transform is rebuilt from the position anyway.)
+	for (int i = 0; i < (int)transforms.size(); i++)
+	{
+		transforms[i][3].x -= origin.x;
+		transforms[i][3].y -= origin.y;
+		transforms[i][3].z -= origin.z;
+	}
+}
+
+void BodyStore::InterpolateTransforms(float alpha, int begin, int end, glm::mat4* out) const
+{
+	// Blend one block at a time into space on the stack, then build that block's transforms the same way Integrate does.
+	glm::vec3 blendedPositions[INTEGRATE_BLOCK];
+	glm::quat blendedOrientations[INTEGRATE_BLOCK];
+	glm::vec3 blendedScales[INTEGRATE_BLOCK];
+
+	for (int block = begin; block < end; block += INTEGRATE_BLOCK)
+	{
+		int count = std::min(INTEGRATE_BLOCK, end - block);
+
+		for (int i = 0; i < count; i++)
+		{
+			int index = block + i;
+
+			blendedPositions[i] = glm::mix(previousPositions[index], positions[index], alpha);
+			blendedOrientations[i] = glm::slerp(previousOrientations[index], orientations[index], alpha);
+			blendedScales[i] = glm::mix(previousScales[index], scales[index], alpha);
+		}
+
+		buildTransforms(blendedPositions, blendedOrientations, blendedScales, out + block, count);
+	}
+}
+
+void BodyStore::InterpolatePoses(float alpha, int begin, int end, glm::vec3* outPositions, glm::quat* outOrientations, glm::vec3* outScales) const
+{
+	for (int i = begin; i < end; i++)
+	{
+		outPositions[i] = glm::mix(previousPositions[i], positions[i], alpha);
+		outOrientations[i] = glm::slerp(previousOrientations[i], orientations[i], alpha);
+		outScales[i] = glm::mix(previousScales[i], scales[i], alpha);
+	}
+}
+
+void BodyStore::BuildTransforms(const glm::vec3* positions, const glm::quat* orientations, const glm::vec3* scales, glm::mat4* transforms, int count)
+{
+	buildTransforms(positions, orientations, scales, transforms, count);
+}
+
+void BodyStore::Integrate(float dt, int begin, int end)
+{
+	// Work through the range one block at a time, moving the bodies and then building their transforms while they're still in the cache.
+	for (int block = begin; block < end; block += INTEGRATE_BLOCK)
+	{
+		int blockEnd = std::min(block + INTEGRATE_BLOCK, end);
+
+		// The sleeping (and static) bodies split the block into runs of moving ones, and each run (of bodies with the same time scale) is
+		// integrated on its own. When nothing in the block is asleep or static (the usual case), that's the whole block in one run.
+		int run = block;
+
+		while (run < blockEnd)
+		{
+			if (isFrozen(run))
+			{
+				run++;
+				continue;
+			}
+
+			int runEnd = run + 1;
+
+			while (runEnd < blockEnd && !isFrozen(runEnd) && timeScales[runEnd] == timeScales[run])
+			{
+				runEnd++;
+			}
+
+			int count = runEnd - run;
+
+			// Do basic physics calcuations based on dt.
+			integrateFloats(&positions[run].x, &velocities[run].x, &accelerations[run].x, count * 3, dt * timeScales[run]);
+			integrateOrientations(&orientations[run], &angularVelocities[run], count, dt * timeScales[run]);
+
+			buildTransforms(&positions[run], &orientations[run], &scales[run], &transforms[run], count);
+
+			// Every transform in the run is up to date now.
+			std::fill(dirty.begin() + run, dirty.begin() + runEnd, (unsigned char)0);
+
+			run = runEnd;
+		}
+	}
+}
+
+#endif //_BODY_STORE_CPP
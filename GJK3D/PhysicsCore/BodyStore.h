@@ -0,0 +1,372 @@
+/*
+Title: GJK-3D (OBB)
+File Name: BodyStore.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _BODY_STORE_H
+#define _BODY_STORE_H
+
+#include "MemoryTracker.h"
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include <vector>
+
+// Refers to one body in a BodyStore. Handles stay the same for as long as the body exists, even as other bodies come and go.
+// The low BODY_SLOT_BITS bits are the handle's slot, and the bits above them are the slot's generation. Slots are reused once their
+// body is destroyed, but each reuse bumps the generation, so a handle kept around after its body was destroyed doesn't quietly refer to
+// whatever body got the slot next (see BodyStore::IsValid).
+typedef int BodyHandle;
+
+static const int BODY_SLOT_BITS = 24;
+static const int BODY_SLOT_MASK = (1 << BODY_SLOT_BITS) - 1;
+
+// The generations wrap around at this, which keeps handles positive. A handle would have to be kept through 128 reuses of its slot to
+// be mistaken for a live one.
+static const int BODY_GENERATIONS = 1 << (31 - BODY_SLOT_BITS);
+
+// Bodies are moved (and handed out to jobs) in blocks of this many. 16 is the fewest bodies whose vec3s (and floats) fill whole cache lines,
+// so with every array starting on a cache line (see AlignedTrackedVector), each block of every array does too: a block's positions are 3
+// lines, its orientations 4, and so on. Jobs that start on a block never share a line with each other, and the AVX loads in a block
+// never straddle two.
+static const int BODY_BLOCK = 16;
+
+// How a body moves.
+// - A dynamic body is moved by its velocity and acceleration, and pushed around by whatever it runs into.
+// - A kinematic body is moved by its velocity too, but nothing it runs into can push it (the same as an inverse mass of 0). It's usually
+//   steered by giving it somewhere to be each step (see PhysicsWorld::SetKinematicTarget), like a moving platform or a door.
+// - A static body never moves at all, like the floor or a wall. Integrate skips it, and the world keeps it out of the way of everything
+//   that does move (see PhysicsWorld::SetBodyType).
+enum BodyType
+{
+	BODY_DYNAMIC,
+	BODY_KINEMATIC,
+	BODY_STATIC
+};
+
+// Stores the state of every body, with one array per property (a "structure of arrays").
+// Each GameObject used to be allocated on its own, with its position, velocity and acceleration next to four separate matrices (translation,
+// rotation, scale and the combined transformation) and a quaternion. That's ~300 bytes per object, mostly matrices that can be rebuilt from
+// the position, orientation and scale whenever we want.
+// Here each property of every body sits in one contiguous array. Integration only touches the positions, velocities and accelerations, so it
+// streams through exactly the memory it needs (and can be vectorized), and only the combined transform is kept as a matrix.
+// The arrays are packed: when a body is destroyed the last one is moved into its place. That means a body's index can change, which is why
+// everything outside the store refers to bodies by handle instead.
+// Each array starts on a cache line, and bodies are worked on in blocks of BODY_BLOCK. (Going further and interleaving the arrays a block at
+// a time, so a block's x's, then its y's and so on sit together, would mean the bodies' vec3s weren't vec3s any more, and everything that
+// reads or writes one by reference would have to change.)
+// The arrays' memory is counted as the bodies' (see MemoryTracker.h).
+class BodyStore
+{
+	// Saves and loads the arrays straight from a file (see WorldSnapshot).
+	friend class WorldSnapshot;
+
+	AlignedTrackedVector<glm::vec3, MEMORY_BODIES> positions;
+	AlignedTrackedVector<glm::vec3, MEMORY_BODIES> velocities;
+	AlignedTrackedVector<glm::vec3, MEMORY_BODIES> accelerations;
+	AlignedTrackedVector<float, MEMORY_BODIES> inverseMasses;
+	AlignedTrackedVector<glm::quat, MEMORY_BODIES> orientations;
+	AlignedTrackedVector<glm::vec3, MEMORY_BODIES> angularVelocities;
+	AlignedTrackedVector<glm::vec3, MEMORY_BODIES> scales;
+	AlignedTrackedVector<glm::mat4, MEMORY_BODIES> transforms;
+
+	// Where each body was, which way it faced and how big it was as of the last SavePrevious (the start of the last physics step), so the
+	// renderer can draw it partway between then and now.
+	AlignedTrackedVector<glm::vec3, MEMORY_BODIES> previousPositions;
+	AlignedTrackedVector<glm::quat, MEMORY_BODIES> previousOrientations;
+	AlignedTrackedVector<glm::vec3, MEMORY_BODIES> previousScales;
+
+	// Whether each body's transform is out of date. The setters only mark a body as dirty, and the transform gets rebuilt the next time
+	// it's asked for, so moving, rotating and scaling a body all in one step only builds its transform once.
+	// (These are chars rather than a std::vector<bool>, so that different threads can work on different bodies without sharing bytes.)
+	AlignedTrackedVector<unsigned char, MEMORY_BODIES> dirty;
+
+	// Whether each body is asleep. Integrate leaves sleeping bodies where they are (see PhysicsWorld::SetSleeping, which decides when they
+	// sleep and wake).
+	AlignedTrackedVector<unsigned char, MEMORY_BODIES> sleeping;
+
+	// Each body's BodyType. Bodies start out dynamic.
+	AlignedTrackedVector<unsigned char, MEMORY_BODIES> types;
+
+	// How many steps' worth of time Integrate moves each body by (see SetTimeScale). Bodies start out at 1.
+	AlignedTrackedVector<float, MEMORY_BODIES> timeScales;
+
+	// Whether Integrate leaves a body where it is.
+	bool isFrozen(int index) const
+	{
+		return sleeping[index] || types[index] == BODY_STATIC || timeScales[index] == 0.0f;
+	}
+
+	// handleToIndex[slot] is where the slot's body is in the arrays (or the next free slot, for slots not in use), and indexToHandle goes
+	// back the other way. generations[slot] is the generation of the slot's current (or next) body.
+	// Destroyed bodies' slots go on a free list, so creating and destroying bodies over and over reuses the same slots (and, once Reserve
+	// has been called or the arrays have grown big enough, never allocates).
+	TrackedVector<int, MEMORY_BODIES> handleToIndex;
+	TrackedVector<BodyHandle, MEMORY_BODIES> indexToHandle;
+	TrackedVector<int, MEMORY_BODIES> generations;
+	int freeSlot;
+
+	static int slotOf(BodyHandle handle)
+	{
+		return handle & BODY_SLOT_MASK;
+	}
+
+	void buildTransform(int index);
+
+	// Swaps two bodies' places in the arrays (and their handles' indices), for SortByPosition.
+	void swapBodies(int a, int b);
+
+	// SortByPosition's keys, kept so that sorting again doesn't allocate.
+	std::vector<unsigned long long> sortKeys;
+
+public:
+	BodyStore();
+
+	// Adds a body at the origin, not moving, not rotated, with a scale of 1.
+	BodyHandle Create();
+
+	// Removes a body. The last body in the arrays is moved into its place, and its handle stops being valid.
+	void Destroy(BodyHandle handle);
+
+	// Makes room for count bodies in total, so creating that many doesn't have to grow any of the arrays.
+	void Reserve(int count);
+
+	// Reorders the arrays so that bodies near each other in space are near each other in memory too, by the Morton code of their positions
+	// (x, y and z each cut into 1024 steps across the bounds of every body, with their bits interleaved, so sorting by it walks space in a
+	// Z shape, one block at a time). Bodies get created wherever they're needed and packed in wherever a destroyed one leaves a hole, so after
+	// a while the ones that touch are all over the arrays, and everything that works on pairs of them misses the cache on nearly every body.
+	// Handles stay the same, but indices change, as with Destroy (and so does which transform a pointer into Transforms() points at).
+	// Returns whether any body moved.
+	bool SortByPosition();
+
+	// Whether handle refers to a body that still exists. The accessors don't check, so use this first on a handle that might be stale.
+	bool IsValid(BodyHandle handle) const
+	{
+		int slot = slotOf(handle);
+
+		if (handle < 0 || slot >= (int)generations.size() || generations[slot] != (handle >> BODY_SLOT_BITS))
+		{
+			return false;
+		}
+
+		// A free slot already has its next body's generation, so check the slot is in use too.
+		int index = handleToIndex[slot];
+
+		return index >= 0 && index < (int)indexToHandle.size() && indexToHandle[index] == handle;
+	}
+
+	int Size() const
+	{
+		return (int)positions.size();
+	}
+
+	// Where a body is in the arrays. This is only good until the next Destroy.
+	int GetIndex(BodyHandle handle) const
+	{
+		return handleToIndex[slotOf(handle)];
+	}
+
+	BodyHandle GetHandle(int index) const
+	{
+		return indexToHandle[index];
+	}
+
+	// The properties of each body, by handle.
+	glm::vec3& Position(BodyHandle handle)
+	{
+		return positions[handleToIndex[slotOf(handle)]];
+	}
+	glm::vec3& Velocity(BodyHandle handle)
+	{
+		return velocities[handleToIndex[slotOf(handle)]];
+	}
+	glm::vec3& Acceleration(BodyHandle handle)
+	{
+		return accelerations[handleToIndex[slotOf(handle)]];
+	}
+	// 1 over the body's mass, which is what the contact solver works with. It starts out at 1. An inverse mass of 0 is an infinite mass:
+	// nothing the body runs into can move it (though it still moves at its own velocity).
+	float& InverseMass(BodyHandle handle)
+	{
+		return inverseMasses[handleToIndex[slotOf(handle)]];
+	}
+	glm::quat& Orientation(BodyHandle handle)
+	{
+		return orientations[handleToIndex[slotOf(handle)]];
+	}
+	// How fast the body spins, in radians per second about the (world space) axis it points along. It starts out at 0.
+	glm::vec3& AngularVelocity(BodyHandle handle)
+	{
+		return angularVelocities[handleToIndex[slotOf(handle)]];
+	}
+	glm::vec3& Scale(BodyHandle handle)
+	{
+		return scales[handleToIndex[slotOf(handle)]];
+	}
+
+	// Call this after changing a body's position, orientation or scale, so that its transform gets rebuilt.
+	void MarkDirty(BodyHandle handle)
+	{
+		dirty[handleToIndex[slotOf(handle)]] = 1;
+	}
+
+	// Puts a body to sleep, or wakes it up. A sleeping body isn't moved (or has its transform rebuilt) by Integrate, whatever its velocity
+	// and acceleration.
+	void SetSleeping(BodyHandle handle, bool asleep)
+	{
+		sleeping[handleToIndex[slotOf(handle)]] = asleep ? 1 : 0;
+	}
+	bool IsSleeping(BodyHandle handle) const
+	{
+		return sleeping[handleToIndex[slotOf(handle)]] != 0;
+	}
+
+	// Changes how a body moves (see BodyType). This only changes the type; PhysicsWorld::SetBodyType also takes care of its mass, velocity
+	// and which broadphase it's in, and is what to use for a body in a world.
+	void SetType(BodyHandle handle, BodyType type)
+	{
+		types[handleToIndex[slotOf(handle)]] = (unsigned char)type;
+	}
+	BodyType GetType(BodyHandle handle) const
+	{
+		return (BodyType)types[handleToIndex[slotOf(handle)]];
+	}
+
+	// How far Integrate moves a body, as a multiple of the dt it's given: 1 is the usual, 0 leaves it where it is (like sleeping, but without
+	// waking or sleeping anything), and 4 catches it up on the three steps it was left out of before this one. PhysicsWorld uses this for
+	// the objects far from everything that's watching (see PhysicsWorld::SetLevelOfDetail).
+	void SetTimeScale(BodyHandle handle, float scale)
+	{
+		timeScales[handleToIndex[slotOf(handle)]] = scale;
+	}
+	float GetTimeScale(BodyHandle handle) const
+	{
+		return timeScales[handleToIndex[slotOf(handle)]];
+	}
+
+	// A body's transform, rebuilt first if it's out of date.
+	const glm::mat4& GetTransform(BodyHandle handle)
+	{
+		int index = handleToIndex[slotOf(handle)];
+
+		if (dirty[index])
+		{
+			buildTransform(index);
+		}
+
+		return transforms[index];
+	}
+
+	// The whole arrays, by index, for code that works through every body at once.
+	glm::vec3* Positions()
+	{
+		return positions.data();
+	}
+	glm::vec3* Velocities()
+	{
+		return velocities.data();
+	}
+	glm::vec3* Accelerations()
+	{
+		return accelerations.data();
+	}
+	glm::quat* Orientations()
+	{
+		return orientations.data();
+	}
+	glm::vec3* AngularVelocities()
+	{
+		return angularVelocities.data();
+	}
+	glm::vec3* Scales()
+	{
+		return scales.data();
+	}
+	// Note that some of these may be out of date, unless UpdateTransforms has been called over them.
+	const glm::mat4* Transforms()
+	{
+		return transforms.data();
+	}
+
+	// Rebuilds one body's transform (translation, then rotation, then scale) from its position, orientation and scale, dirty or not.
+	void CalculateTransform(BodyHandle handle)
+	{
+		buildTransform(handleToIndex[slotOf(handle)]);
+	}
+
+	// Rebuilds the transforms of the dirty bodies in [begin, end) (by index).
+	void UpdateTransforms(int begin, int end);
+
+	// Moves the bodies in [begin, end) (by index) forward by dt using their velocities and accelerations, turns the ones that are spinning
+	// by their angular velocities, then rebuilds their transforms.
+	// Both the moving and the rebuilding run on several bodies at once with SIMD (see SIMD.h), and fall back to plain loops without it.
+	// Sleeping and static bodies are skipped, and the rest are each moved by dt times their time scale (see SetTimeScale).
+	// Ranges that don't overlap can be integrated on different threads at the same time, and if they start on a multiple of BODY_BLOCK they
+	// don't share any cache lines either.
+	void Integrate(float dt, int begin, int end);
+
+	// Remembers every body's position, orientation and scale as they are now. Call this at the start of each physics step.
+	void SavePrevious();
+
+	// Takes origin off every body's position (the current one and the one SavePrevious saved) and off the translation of its transform,
+	// so everything stays exactly where it was relative to everything else, with origin as the new (0, 0, 0). The positions are one array
+	// of floats, so this is a single pass over it with SIMD. The transforms come out just as they would if they were rebuilt.
+	void ShiftOrigin(const glm::vec3& origin);
+
+	// Builds transforms for the bodies in [begin, end) (by index) partway between the last SavePrevious and now: alpha = 0 is where they
+	// were, and 1 is where they are. out[i] gets body i's transform.
+	// Physics steps at a fixed rate, so when the frame rate is higher, most frames fall between two steps. Drawing every body where it is
+	// would show the same pose for several frames and then jump, so instead we draw a step behind, alpha of the way from the last step's
+	// pose to this one (where alpha is how far the accumulator has got towards the next step). That lets the physics run at a lower rate
+	// without the motion looking any worse. Positions and scales are blended linearly, and orientations with slerp.
+	void InterpolateTransforms(float alpha, int begin, int end, glm::mat4* out) const;
+
+	// The same blend, but handing back the blended positions, orientations and scales themselves rather than building transforms from them,
+	// for a renderer that sends those to the GPU instead of matrices. outPositions[i] (and so on) gets body i's.
+	void InterpolatePoses(float alpha, int begin, int end, glm::vec3* outPositions, glm::quat* outOrientations, glm::vec3* outScales) const;
+
+	// Whether the body at index is asleep or static, and exactly where it was at the last SavePrevious, so that the blend gives it the same
+	// pose whatever alpha is. A renderer that keeps what it drew last frame can leave a resting body as it was (once it's drawn it resting),
+	// so long as it checks that it wasn't moved by hand in between.
+	bool IsResting(int index) const
+	{
+		return (sleeping[index] || types[index] == BODY_STATIC) && positions[index] == previousPositions[index] &&
+			orientations[index] == previousOrientations[index] && scales[index] == previousScales[index];
+	}
+
+	// Builds count transforms from arrays of positions, orientations and scales that don't have to be in a BodyStore (like the interpolated
+	// ones the renderer draws with), the same way and just as fast as the store builds its own.
+	static void BuildTransforms(const glm::vec3* positions, const glm::quat* orientations, const glm::vec3* scales, glm::mat4* transforms, int count);
+};
+
+#endif //_BODY_STORE_H
@@ -0,0 +1,342 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Broadphase.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _BROADPHASE_H
+#define _BROADPHASE_H
+
+#include "AABB.h"
+#include "Frustum.h"
+#include <algorithm>
+#include <vector>
+
+// A pair of objects whose bounds overlap, so the narrowphase (GJK) should take a closer look.
+// The objects are given by the user data they were added to the broadphase with, smaller one first.
+struct BroadphasePair
+{
+	int a;
+	int b;
+
+	BroadphasePair()
+	{
+		a = 0;
+		b = 0;
+	}
+
+	BroadphasePair(int first, int second)
+	{
+		a = first < second ? first : second;
+		b = first < second ? second : first;
+	}
+
+	bool operator<(const BroadphasePair& other) const
+	{
+		return a < other.a || (a == other.a && b < other.b);
+	}
+
+	bool operator==(const BroadphasePair& other) const
+	{
+		return a == other.a && b == other.b;
+	}
+};
+
+// Below this many pairs, std::sort is quicker than clearing and going over the radix sort's count tables.
+static const int BROADPHASE_RADIX_MIN = 256;
+
+// Sorts pairs into the order BroadphasePair::operator< gives (by a, then b), with scratch as somewhere to put them in between. The pairs come
+// out of every broadphase in whatever order the proxies happened to be in, so this is what has the narrowphase go through the objects in
+// order, running GJK on the same a's shape over and over while it's still in cache, and getting the same order on every run.
+// It's a radix sort a byte at a time, b's bytes first and then a's. They're object indices, so the top bytes are usually the same (0) in
+// every pair, and those passes get skipped: with fewer than 65536 objects it's four passes, each a straight run over the pairs.
+// Anything that holds a pair can be sorted by it, as long as there's a GetPair for it (see AABBTree's TrackedPair).
+inline const BroadphasePair& GetPair(const BroadphasePair& pair)
+{
+	return pair;
+}
+
+template<typename Pair>
+void SortPairs(std::vector<Pair>& pairs, std::vector<Pair>& scratch)
+{
+	int count = (int)pairs.size();
+
+	if (count < BROADPHASE_RADIX_MIN)
+	{
+		std::sort(pairs.begin(), pairs.end());
+
+		return;
+	}
+
+	// One table per pass, all counted in one go. Indices are never negative, so their bytes sort the same as unsigned ones.
+	static const int PASSES = 8;
+	int counts[PASSES][256] = {};
+
+	for (int i = 0; i < count; i++)
+	{
+		unsigned int a = (unsigned int)GetPair(pairs[i]).a;
+		unsigned int b = (unsigned int)GetPair(pairs[i]).b;
+
+		for (int byte = 0; byte < 4; byte++)
+		{
+			counts[byte][(b >> (byte * 8)) & 255]++;
+			counts[byte + 4][(a >> (byte * 8)) & 255]++;
+		}
+	}
+
+	scratch.resize(count);
+
+	Pair* from = pairs.data();
+	Pair* to = scratch.data();
+
+	for (int pass = 0; pass < PASSES; pass++)
+	{
+		int* table = counts[pass];
+		int shift = (pass & 3) * 8;
+		bool sortA = pass >= 4;
+
+		// Every pair has the same byte here, so this pass wouldn't move anything.
+		unsigned int first = (unsigned int)(sortA ? GetPair(from[0]).a : GetPair(from[0]).b);
+
+		if (table[(first >> shift) & 255] == count)
+		{
+			continue;
+		}
+
+		// Turn the counts into where each byte's pairs start.
+		int offset = 0;
+
+		for (int digit = 0; digit < 256; digit++)
+		{
+			int digitCount = table[digit];
+			table[digit] = offset;
+			offset += digitCount;
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			unsigned int key = (unsigned int)(sortA ? GetPair(from[i]).a : GetPair(from[i]).b);
+			to[table[(key >> shift) & 255]++] = from[i];
+		}
+
+		std::swap(from, to);
+	}
+
+	// An odd number of passes leaves the sorted pairs in scratch.
+	if (from != pairs.data())
+	{
+		pairs.swap(scratch);
+	}
+}
+
+// Which objects an object can collide with. Each object is on some layers, and has a mask of the layers it collides with. Two objects only
+// collide if each one's mask has a layer the other is on, so debris on its own layer, left out of its own mask, never collides with other
+// debris but still lands on the floor. On top of that, objects in the same group (other than group 0, which is no group) never collide
+// with each other, whatever their layers, like the parts of one ragdoll or a vehicle and its wheels.
+struct CollisionFilter
+{
+	unsigned int layers;
+	unsigned int mask;
+	int group;
+
+	// On layer 1, colliding with everything, in no group.
+	CollisionFilter()
+	{
+		layers = 1;
+		mask = 0xFFFFFFFF;
+		group = 0;
+	}
+
+	CollisionFilter(unsigned int onLayers, unsigned int collidesWith, int inGroup = 0)
+	{
+		layers = onLayers;
+		mask = collidesWith;
+		group = inGroup;
+	}
+
+	bool CollidesWith(const CollisionFilter& other) const
+	{
+		return (layers & other.mask) != 0 && (other.layers & mask) != 0 && (group == 0 || group != other.group);
+	}
+};
+
+// How much further a proxy's fat bounds reach on every side for each unit of its displacement (see MakeFatBounds).
+static const float BROADPHASE_PREDICTED_MARGIN = 1.0f;
+
+// The fat bounds every broadphase gives a proxy that's moved (or been made): its bounds grown by margin on every side, plus, on every side
+// too, how far it's expected to move this step times BROADPHASE_PREDICTED_MARGIN, and then stretched by displacement * multiplier in the
+// direction it's going. The stretch alone keeps an object going in a straight line inside its bounds for a few steps, but one that turns
+// around (bouncing off something, or arcing under gravity) would leave them straight away, so the faster it's going the more room it gets
+// the other ways too. A resting object's displacement is zero, so it only gets the margin, and doesn't pick up any pairs it doesn't need.
+inline AABB MakeFatBounds(const AABB& bounds, float margin, const glm::vec3& displacement, float multiplier)
+{
+	glm::vec3 grow = glm::vec3(margin + glm::length(displacement) * BROADPHASE_PREDICTED_MARGIN);
+	glm::vec3 stretch = displacement * multiplier;
+
+	return AABB(bounds.min - grow + glm::min(stretch, glm::vec3(0.0f)), bounds.max + grow + glm::max(stretch, glm::vec3(0.0f)));
+}
+
+// The interface every broadphase provides, so the simulation can use any of them (and switch between them while running, to compare).
+// Each one keeps a "proxy" per object holding its bounds, fattened a little so that small movements don't have to change anything, and
+// reports the pairs of proxies whose fat bounds overlap.
+class Broadphase
+{
+	// Each object's collision filter, by user data (or nullptr, if everything collides). See SetFilters.
+	const std::vector<CollisionFilter>* filters;
+
+protected:
+	// What changed in the last FindPairs (see GetAddedPairs), and the pairs it found, for the broadphases that find every pair from scratch
+	// each time and compare them against the last ones to see what changed (see comparePairs).
+	std::vector<BroadphasePair> addedPairs;
+	std::vector<BroadphasePair> removedPairs;
+	std::vector<BroadphasePair> lastPairs;
+
+	// Where SortPairs puts the pairs in between passes.
+	std::vector<BroadphasePair> sortScratch;
+
+	// Fills addedPairs and removedPairs by walking the new pairs and lastPairs together (both are sorted), and keeps the new ones as lastPairs
+	// for next time.
+	void comparePairs(const std::vector<BroadphasePair>& pairs)
+	{
+		addedPairs.clear();
+		removedPairs.clear();
+
+		int last = 0;
+		int now = 0;
+
+		while (last < (int)lastPairs.size() || now < (int)pairs.size())
+		{
+			if (now == (int)pairs.size() || (last < (int)lastPairs.size() && lastPairs[last] < pairs[now]))
+			{
+				removedPairs.push_back(lastPairs[last++]);
+			}
+			else if (last == (int)lastPairs.size() || pairs[now] < lastPairs[last])
+			{
+				addedPairs.push_back(pairs[now++]);
+			}
+			else
+			{
+				last++;
+				now++;
+			}
+		}
+
+		lastPairs = pairs;
+	}
+
+public:
+	Broadphase()
+	{
+		filters = nullptr;
+	}
+
+	virtual ~Broadphase()
+	{
+	}
+
+	// Has FindPairs leave out every pair whose filters (filters[userData] for each proxy) say they can't collide, as it finds them, so the
+	// pairs that could never collide cost no more than the overlap test that found them: they aren't sorted, or tested, or even stored.
+	// The vector is only read while finding pairs, so it can keep growing as objects are added. Pass nullptr to stop filtering.
+	void SetFilters(const std::vector<CollisionFilter>* objectFilters)
+	{
+		filters = objectFilters;
+	}
+
+	// Whether the objects with the given user data can collide.
+	bool CanPair(int userDataA, int userDataB) const
+	{
+		return filters == nullptr || (*filters)[userDataA].CollidesWith((*filters)[userDataB]);
+	}
+
+	// Adds an object with the given bounds. Returns its proxy, which is how the object is referred to from then on.
+	virtual int CreateProxy(const AABB& bounds, int userData) = 0;
+
+	virtual void DestroyProxy(int proxy) = 0;
+
+	// Tells the broadphase an object has moved. displacement is how far it is expected to move this step, which is used to stretch its fat bounds.
+	// Returns true if the proxy's fat bounds had to change, and false if the new bounds were still inside them.
+	virtual bool MoveProxy(int proxy, const AABB& bounds, const glm::vec3& displacement) = 0;
+
+	// Moves every proxy by -origin, for when the world's origin is moved to origin (see PhysicsWorld::ShiftOrigin). They all move together,
+	// so (bar rounding) the same ones overlap as before, and nothing else about them changes.
+	virtual void ShiftOrigin(const glm::vec3& origin) = 0;
+
+	virtual const AABB& GetFatBounds(int proxy) const = 0;
+
+	virtual int GetUserData(int proxy) const = 0;
+
+	// Fills pairs with every pair of proxies whose fat bounds overlap (and whose filters let them collide), sorted, with no duplicates.
+	virtual void FindPairs(std::vector<BroadphasePair>& pairs) = 0;
+
+	// The pairs the last FindPairs found that the one before it didn't, and the ones the one before found that it didn't, each sorted.
+	// Most pairs carry on from one step to the next, so these are usually short, and they're all that something keeping its own data for
+	// each pair (like PhysicsWorld's pair cache) needs to look at, rather than every pair.
+	const std::vector<BroadphasePair>& GetAddedPairs() const
+	{
+		return addedPairs;
+	}
+	const std::vector<BroadphasePair>& GetRemovedPairs() const
+	{
+		return removedPairs;
+	}
+
+	// Has the next FindPairs look at a proxy's pairs again even though it hasn't moved, because something else about it (its filter) has
+	// changed. Broadphases that find every pair from scratch anyway don't need to do anything.
+	virtual void TouchProxy(int /*proxy*/)
+	{
+	}
+
+	// Makes room for numProxies proxies, and for numPairs pairs found by up to threads threads at once, so that a broadphase that stays inside
+	// them never has to grow its arrays once it's in use (see PhysicsWorld::SetLimits). Each broadphase adds its own arrays to these.
+	virtual void Reserve(int /*numProxies*/, int numPairs, int /*threads*/)
+	{
+		addedPairs.reserve(numPairs);
+		removedPairs.reserve(numPairs);
+		lastPairs.reserve(numPairs);
+		sortScratch.reserve(numPairs);
+	}
+
+	// Fills visible with the user data of every proxy whose fat bounds are at least partly inside the frustum, in no particular order.
+	// This is for culling what gets drawn: the broadphase already has bounds for everything, so there's no need to build them again.
+	virtual void Cull(const Frustum& frustum, std::vector<int>& visible) const = 0;
+
+	// Fills hits with the user data of every proxy whose fat bounds, grown by extents on every side, the segment from from to to passes
+	// through, in no particular order. With extents of zero that's everything a ray might hit, and with the half size of the box around a
+	// shape it's everything that shape might hit moving along the segment. (See PhysicsWorld::RayCast and CastShape.)
+	virtual void CastSegment(const glm::vec3& from, const glm::vec3& to, const glm::vec3& extents, std::vector<int>& hits) const = 0;
+
+	// A short name for showing which broadphase is in use.
+	virtual const char* GetName() const = 0;
+};
+
+#endif //_BROADPHASE_H
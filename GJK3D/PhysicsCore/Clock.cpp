@@ -0,0 +1,90 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Clock.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CLOCK_CPP
+#define _CLOCK_CPP
+
+#include "Clock.h"
+
+#include <chrono>
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+// Visual Studio's steady_clock before 2015 only ticks about once a millisecond (too coarse to time a physics step with), so there we use the
+// performance counter it should have been built on. Everywhere else, steady_clock is the real thing.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+static long long steadyTicks()
+{
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+
+	return ticks.QuadPart;
+}
+
+static double steadyTicksPerSecond()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+
+	return (double)frequency.QuadPart;
+}
+#else
+static long long steadyTicks()
+{
+	return (long long)std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+static double steadyTicksPerSecond()
+{
+	return (double)std::chrono::steady_clock::period::den / (double)std::chrono::steady_clock::period::num;
+}
+#endif
+
+SteadyClock::SteadyClock()
+{
+	start = steadyTicks();
+}
+
+double SteadyClock::Now()
+{
+	return (double)(steadyTicks() - start) / steadyTicksPerSecond();
+}
+
+#endif // _CLOCK_CPP
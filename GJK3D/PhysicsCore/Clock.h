@@ -0,0 +1,95 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Clock.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CLOCK_H
+#define _CLOCK_H
+
+// Something that tells the time, in seconds, for timing the physics.
+// Where the time comes from is up to the clock, so the same loop can run off the window's timer (see GLFWClock in the demo), off the
+// system's timer with no window at all, or off a clock that only moves when it's told to.
+class Clock
+{
+public:
+	virtual ~Clock()
+	{
+	}
+
+	// The time now, in seconds. It never goes backwards. Only the differences between times mean anything, not the times themselves.
+	virtual double Now() = 0;
+};
+
+// The system's steady (monotonic) high resolution timer, which doesn't need GLFW or a window.
+class SteadyClock : public Clock
+{
+	// When the clock was made, so that Now starts from 0 and doubles keep their precision.
+	long long start;
+
+public:
+	SteadyClock();
+
+	double Now();
+};
+
+// A clock that only moves when it's told to. Advancing it by exactly one physics step before each Advance of a StepScheduler (after
+// StepScheduler::Start) runs exactly one step, every time, no matter how long the step actually took. That's what you want for tests (the same steps every run) or for batch jobs
+// that want to simulate as fast as the machine can go, rather than in real time.
+class ManualClock : public Clock
+{
+	double now;
+
+public:
+	ManualClock()
+	{
+		now = 0.0;
+	}
+
+	double Now()
+	{
+		return now;
+	}
+
+	void Advance(double seconds)
+	{
+		now += seconds;
+	}
+
+	void Set(double seconds)
+	{
+		now = seconds;
+	}
+};
+
+#endif //_CLOCK_H
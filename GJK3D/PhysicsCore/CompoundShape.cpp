@@ -0,0 +1,326 @@
+/*
+Title: GJK-3D (OBB)
+File Name: CompoundShape.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _COMPOUND_SHAPE_CPP
+#define _COMPOUND_SHAPE_CPP
+
+#include "CompoundShape.h"
+#include <algorithm>
+
+// Leaves hold up to this many children. Testing a couple of boxes is cheaper than walking another level down to them.
+static const int COMPOUND_LEAF_SIZE = 2;
+
+// The smallest box around two boxes.
+static AABB mergeBounds(const AABB& a, const AABB& b)
+{
+	return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+}
+
+CompoundShape::CompoundShape()
+{
+	position = glm::vec3(0.0f);
+	orientation = glm::quat();
+}
+
+CompoundShape::CompoundShape(const CompoundShape& other)
+{
+	*this = other;
+}
+
+CompoundShape& CompoundShape::operator=(const CompoundShape& other)
+{
+	localChildren = other.localChildren;
+	children = other.children;
+	childBounds = other.childBounds;
+	localPoints = other.localPoints;
+	pointOffsets = other.pointOffsets;
+	nodes = other.nodes;
+	order = other.order;
+	position = other.position;
+	orientation = other.orientation;
+	bounds = other.bounds;
+
+	pointHulls();
+
+	return *this;
+}
+
+void CompoundShape::pointHulls()
+{
+	for (int i = 0; i < (int)localChildren.size(); i++)
+	{
+		if (pointOffsets[i] != -1)
+		{
+			localChildren[i].As<HullShape>().points = localPoints.data() + pointOffsets[i];
+			children[i].As<HullShape>().points = localPoints.data() + pointOffsets[i];
+		}
+	}
+}
+
+int CompoundShape::AddChild(const ConvexShape& shape, const glm::vec3& childPosition, const glm::quat& childOrientation)
+{
+	int child = (int)localChildren.size();
+
+	if (shape.type == SHAPE_HULL)
+	{
+		const HullShape& hull = shape.As<HullShape>();
+		int offset = (int)localPoints.size();
+
+		for (int i = 0; i < hull.numPoints; i++)
+		{
+			localPoints.push_back(childPosition + childOrientation * (hull.position + hull.orientation * hull.points[i]));
+		}
+
+		localChildren.push_back(HullShape(nullptr, hull.numPoints));
+		pointOffsets.push_back(offset);
+	}
+	else
+	{
+		ConvexShape child = shape;
+		transformShape(child, childPosition, childOrientation);
+
+		localChildren.push_back(child);
+		pointOffsets.push_back(-1);
+	}
+
+	children.push_back(localChildren[child]);
+	childBounds.push_back(AABB());
+
+	// Adding points may have moved them all.
+	pointHulls();
+
+	return child;
+}
+
+int CompoundShape::buildNode(int first, int count, std::vector<AABB>& localBounds)
+{
+	int index = (int)nodes.size();
+	nodes.push_back(CompoundNode());
+
+	AABB nodeBounds = localBounds[order[first]];
+	AABB centers(nodeBounds.min + nodeBounds.max, nodeBounds.min + nodeBounds.max);
+
+	for (int i = first + 1; i < first + count; i++)
+	{
+		const AABB& box = localBounds[order[i]];
+
+		nodeBounds = mergeBounds(nodeBounds, box);
+		centers = mergeBounds(centers, AABB(box.min + box.max, box.min + box.max));
+	}
+
+	nodes[index].bounds = nodeBounds;
+	nodes[index].first = first;
+
+	if (count <= COMPOUND_LEAF_SIZE)
+	{
+		nodes[index].count = count;
+		nodes[index].right = -1;
+
+		return index;
+	}
+
+	// Split the children in half along the axis their centers are most spread out on. (The centers are doubled here, which doesn't change
+	// their order.)
+	glm::vec3 spread = centers.max - centers.min;
+	int axis = spread.x >= spread.y && spread.x >= spread.z ? 0 : (spread.y >= spread.z ? 1 : 2);
+	int half = count / 2;
+
+	std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count, [&](int a, int b)
+	{
+		return localBounds[a].min[axis] + localBounds[a].max[axis] < localBounds[b].min[axis] + localBounds[b].max[axis];
+	});
+
+	nodes[index].count = 0;
+
+	buildNode(first, half, localBounds);
+	int right = buildNode(first + half, count - half, localBounds);
+
+	nodes[index].right = right;
+
+	return index;
+}
+
+void CompoundShape::Build()
+{
+	std::vector<AABB> localBounds(localChildren.size());
+
+	for (int i = 0; i < (int)localChildren.size(); i++)
+	{
+		localBounds[i] = getBoundsFromSupport(localChildren[i]);
+	}
+
+	nodes.clear();
+	order.resize(localChildren.size());
+
+	for (int i = 0; i < (int)order.size(); i++)
+	{
+		order[i] = i;
+	}
+
+	if (!order.empty())
+	{
+		buildNode(0, (int)order.size(), localBounds);
+	}
+
+	SetPose(position, orientation);
+}
+
+void CompoundShape::SetPose(const glm::vec3& inPosition, const glm::quat& inOrientation)
+{
+	position = inPosition;
+	orientation = inOrientation;
+
+	for (int i = 0; i < (int)localChildren.size(); i++)
+	{
+		// (A hull child only takes on the pose. Its points stay in local space.)
+		children[i] = localChildren[i];
+		transformShape(children[i], position, orientation);
+
+		childBounds[i] = getBoundsFromSupport(children[i]);
+		bounds = i == 0 ? childBounds[i] : mergeBounds(bounds, childBounds[i]);
+	}
+
+	if (localChildren.empty())
+	{
+		bounds = AABB(position, position);
+	}
+}
+
+void CompoundShape::Query(const AABB& box, std::vector<int>& found) const
+{
+	if (nodes.empty() || !bounds.Overlaps(box))
+	{
+		return;
+	}
+
+	// The box, turned into local space: its center goes back through the pose, and its half size becomes the half size of the box around
+	// it once it's turned.
+	glm::quat inverse = glm::conjugate(orientation);
+	glm::mat3 rotation = glm::mat3_cast(inverse);
+	glm::vec3 center = inverse * ((box.min + box.max) * 0.5f - position);
+	glm::vec3 halfSize = (box.max - box.min) * 0.5f;
+	glm::vec3 extent = glm::abs(rotation[0]) * halfSize.x + glm::abs(rotation[1]) * halfSize.y + glm::abs(rotation[2]) * halfSize.z;
+	AABB localBox(center - extent, center + extent);
+
+	// The tree is balanced, so it's only as deep as the log of the number of children.
+	int stack[64];
+	int count = 0;
+
+	stack[count++] = 0;
+
+	while (count > 0)
+	{
+		int index = stack[--count];
+		const CompoundNode& node = nodes[index];
+
+		if (!node.bounds.Overlaps(localBox))
+		{
+			continue;
+		}
+
+		if (node.count > 0)
+		{
+			for (int i = node.first; i < node.first + node.count; i++)
+			{
+				if (childBounds[order[i]].Overlaps(box))
+				{
+					found.push_back(order[i]);
+				}
+			}
+		}
+		else
+		{
+			stack[count++] = node.right;
+			stack[count++] = index + 1;
+		}
+	}
+}
+
+void CompoundShape::FindChildPairs(const CompoundShape& a, const CompoundShape& b, std::vector<BroadphasePair>& pairs, std::vector<int>& found)
+{
+	found.clear();
+	a.Query(b.GetBounds(), found);
+
+	int childrenOfA = (int)found.size();
+
+	for (int i = 0; i < childrenOfA; i++)
+	{
+		int child = found[i];
+		int start = (int)found.size();
+
+		b.Query(a.GetChildBounds(child), found);
+
+		// BroadphasePair's constructor would put the smaller number first, which doesn't mean anything here.
+		for (int j = start; j < (int)found.size(); j++)
+		{
+			BroadphasePair pair;
+			pair.a = child;
+			pair.b = found[j];
+
+			pairs.push_back(pair);
+		}
+
+		found.resize(start);
+	}
+}
+
+bool TestCompounds(GJKSolver& solver, const CompoundShape& a, const CompoundShape& b, std::vector<BroadphasePair>& pairs, std::vector<int>& found,
+	int* childA, int* childB)
+{
+	pairs.clear();
+	CompoundShape::FindChildPairs(a, b, pairs, found);
+
+	for (int i = 0; i < (int)pairs.size(); i++)
+	{
+		if (TestShapes(solver, a.GetChild(pairs[i].a), b.GetChild(pairs[i].b)))
+		{
+			if (childA)
+			{
+				*childA = pairs[i].a;
+			}
+			if (childB)
+			{
+				*childB = pairs[i].b;
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#endif //_COMPOUND_SHAPE_CPP
@@ -0,0 +1,214 @@
+/*
+Title: GJK-3D (OBB)
+File Name: CompoundShape.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _COMPOUND_SHAPE_H
+#define _COMPOUND_SHAPE_H
+
+#include "AABB.h"
+#include "Broadphase.h"
+#include "EPA.h"
+#include "ShapePairs.h"
+#include "glm\gtc\quaternion.hpp"
+#include <vector>
+
+// One node of a CompoundShape's tree. A leaf holds count children (the ones listed from first on in the tree's order), and any other node
+// has count 0, its left child right after it and its right child at right.
+struct CompoundNode
+{
+	AABB bounds;
+	int first;
+	int count;
+	int right;
+};
+
+// A shape made of several convex children, each placed in the compound's local space, for props that are more than one box but would make a
+// poor (and expensive) single hull: a table, a chair, an L shaped wall. GJK only works on convex shapes, so a compound is never handed to it
+// as a whole; instead, a small tree over the children's bounds (built once, in local space, since the children never move relative to each
+// other) finds which children are close enough to what it's being tested against, and only those go through GJK.
+// Add the children, Build the tree, then SetPose whenever the body moves to bring the children into world space. The pose is rigid: the
+// children are already the size they're meant to be, so there's no scale.
+class CompoundShape
+{
+	// The children as they were added, in local space, and as of the last SetPose, in world space, along with the world box around each.
+	std::vector<ConvexShape> localChildren;
+	std::vector<ConvexShape> children;
+	std::vector<AABB> childBounds;
+
+	// A hull child's points are copied in here (in the compound's local space), and its HullShape points at its own run of them, starting
+	// from its offset (which is -1 for the children that aren't hulls). The world space child is the same points with the compound's pose,
+	// so moving the compound never touches them.
+	std::vector<glm::vec3> localPoints;
+	std::vector<int> pointOffsets;
+
+	// The tree, root first, with the children's local bounds, and the children in the order the leaves list them.
+	std::vector<CompoundNode> nodes;
+	std::vector<int> order;
+
+	glm::vec3 position;
+	glm::quat orientation;
+	AABB bounds;
+
+	// Builds the node for the children in order[first] up to (not including) order[first + count], and everything under it. Returns the node's
+	// index.
+	int buildNode(int first, int count, std::vector<AABB>& localBounds);
+
+	// Fixes up the hull children's point pointers, which the point arrays growing (or being copied) leaves behind.
+	void pointHulls();
+
+public:
+	CompoundShape();
+
+	// Copying a compound has to point its hulls at its own copies of their points.
+	CompoundShape(const CompoundShape& other);
+	CompoundShape& operator=(const CompoundShape& other);
+
+	// Adds a child, given in the compound's local space, and then moved to position and turned by orientation (also in local space) on top of
+	// that. Returns the child's number. A hull's points are copied, so they don't have to outlive the call.
+	// Call Build once every child has been added.
+	int AddChild(const ConvexShape& shape, const glm::vec3& childPosition = glm::vec3(0.0f), const glm::quat& childOrientation = glm::quat());
+
+	// Builds the tree over the children, and brings them into world space where the compound is (at the origin, until SetPose moves it).
+	void Build();
+
+	// Moves the compound (rebuilding every child in world space, and their bounds). A hull child only takes on the new pose.
+	void SetPose(const glm::vec3& inPosition, const glm::quat& inOrientation);
+
+	const glm::vec3& GetPosition() const
+	{
+		return position;
+	}
+	const glm::quat& GetOrientation() const
+	{
+		return orientation;
+	}
+
+	int NumChildren() const
+	{
+		return (int)children.size();
+	}
+
+	// A child in world space, and the box around it.
+	const ConvexShape& GetChild(int child) const
+	{
+		return children[child];
+	}
+	const AABB& GetChildBounds(int child) const
+	{
+		return childBounds[child];
+	}
+
+	// The box around every child, in world space.
+	const AABB& GetBounds() const
+	{
+		return bounds;
+	}
+
+	// Finds the children whose boxes overlap box (in world space), and adds their numbers to found. The box is turned into the compound's
+	// local space to walk the tree, which loosens it some for a compound that's turned, so each child is then checked against it again with
+	// its own world box.
+	void Query(const AABB& box, std::vector<int>& found) const;
+
+	// Finds the pairs of children, one from a and one from b, whose boxes overlap, and adds them to pairs (with a as the child of a and b as
+	// the child of b). found is just somewhere to put the children from each query, which is worth keeping around between calls.
+	static void FindChildPairs(const CompoundShape& a, const CompoundShape& b, std::vector<BroadphasePair>& pairs, std::vector<int>& found);
+};
+
+// Tests a compound against any convex shape: only the children whose boxes overlap the shape's run GJK. Returns true as soon as one of them
+// collides, with its number in child (if that isn't nullptr). found is as in CompoundShape::Query.
+template<typename Shape>
+bool TestCompound(GJKSolver& solver, const CompoundShape& compound, const Shape& shape, std::vector<int>& found, int* child = nullptr)
+{
+	found.clear();
+	compound.Query(getBoundsFromSupport(shape), found);
+
+	for (int i = 0; i < (int)found.size(); i++)
+	{
+		if (TestShapes(solver, compound.GetChild(found[i]), shape))
+		{
+			if (child)
+			{
+				*child = found[i];
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// What a shape touching a CompoundShape touches: which child, and EPA's answer for the pair (with the child as A, so the normal points from
+// the compound into the shape).
+struct CompoundContact
+{
+	int child;
+	EPAResult contact;
+};
+
+// Finds every child of a compound a convex shape is touching, and adds a contact for each to contacts. Returns how many it added. Like
+// CollideMesh, that can be a handful for one shape, so ContactManifold::AddReduced is the way to keep them.
+template<typename Shape>
+int CollideCompound(GJKSolver& solver, EPASolver& epa, const CompoundShape& compound, const Shape& shape, std::vector<int>& found,
+	std::vector<CompoundContact>& contacts)
+{
+	int added = 0;
+
+	found.clear();
+	compound.Query(getBoundsFromSupport(shape), found);
+
+	for (int i = 0; i < (int)found.size(); i++)
+	{
+		const ConvexShape& child = compound.GetChild(found[i]);
+		CompoundContact contact;
+
+		if (solver.TestGJK(child, shape) && epa.Penetration(child, shape, solver.GetSimplex(), contact.contact))
+		{
+			contact.child = found[i];
+			contacts.push_back(contact);
+			added++;
+		}
+	}
+
+	return added;
+}
+
+// Tests two compounds against each other, running GJK only on the pairs of children whose boxes overlap. Returns true as soon as one pair
+// collides, with its children in childA and childB (if they aren't nullptr). pairs and found are just somewhere to work, which are worth keeping
+// around between calls.
+bool TestCompounds(GJKSolver& solver, const CompoundShape& a, const CompoundShape& b, std::vector<BroadphasePair>& pairs, std::vector<int>& found,
+	int* childA = nullptr, int* childB = nullptr);
+
+#endif //_COMPOUND_SHAPE_H
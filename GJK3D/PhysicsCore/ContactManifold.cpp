@@ -0,0 +1,338 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ContactManifold.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CONTACT_MANIFOLD_CPP
+#define _CONTACT_MANIFOLD_CPP
+
+#include "ContactManifold.h"
+
+void ContactManifold::Update(const glm::mat4& transformA, const glm::mat4& transformB)
+{
+	float breakingSquared = breakingThreshold * breakingThreshold;
+
+	// Go backward so removing a point (which moves the last one into its place) doesn't skip any.
+	for (int i = count - 1; i >= 0; i--)
+	{
+		ContactPoint& point = points[i];
+
+		point.worldA = glm::vec3(transformA * glm::vec4(point.localA, 1.0f));
+		point.worldB = glm::vec3(transformB * glm::vec4(point.localB, 1.0f));
+		point.depth = glm::dot(point.worldA - point.worldB, normal);
+
+		// The points have pulled apart along the normal.
+		if (point.depth < -breakingThreshold)
+		{
+			removePoint(i);
+			continue;
+		}
+
+		// The points have slid apart along the contact plane. Take the depth out of the difference, and whatever's left is sideways movement.
+		glm::vec3 slide = (point.worldA - point.worldB) - normal * point.depth;
+
+		if (glm::dot(slide, slide) > breakingSquared)
+		{
+			removePoint(i);
+		}
+	}
+}
+
+void ContactManifold::Add(const EPAResult& contact, const glm::mat4& transformA, const glm::mat4& transformB)
+{
+	ContactPoint point;
+	point.worldA = contact.pointA;
+	point.worldB = contact.pointB;
+	point.localA = glm::vec3(glm::inverse(transformA) * glm::vec4(contact.pointA, 1.0f));
+	point.localB = glm::vec3(glm::inverse(transformB) * glm::vec4(contact.pointB, 1.0f));
+	point.depth = contact.depth;
+	point.impulse = 0.0f;
+
+	normal = contact.normal;
+
+	// If we already have a point in about the same spot, this is just a fresher version of it.
+	float breakingSquared = breakingThreshold * breakingThreshold;
+
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 difference = points[i].localA - point.localA;
+
+		if (glm::dot(difference, difference) < breakingSquared)
+		{
+			// It's the same contact, so it keeps the impulse the solver has built up on it.
+			point.impulse = points[i].impulse;
+			points[i] = point;
+			return;
+		}
+	}
+
+	if (count < MAX_POINTS)
+	{
+		points[count++] = point;
+	}
+	else
+	{
+		points[pointToReplace(point)] = point;
+	}
+}
+
+void ContactManifold::AddReduced(const EPAResult* const* contacts, int count, const glm::mat4& transformA, const glm::mat4& transformB)
+{
+	int kept[MAX_POINTS];
+	glm::vec3 reducedNormal;
+	int reduced = ReduceContacts(contacts, count, kept, reducedNormal);
+
+	for (int i = 0; i < reduced; i++)
+	{
+		Add(*contacts[kept[i]], transformA, transformB);
+	}
+
+	// Add leaves the normal of whichever point went in last, but the points share the one they were picked around.
+	if (reduced > 0)
+	{
+		normal = reducedNormal;
+	}
+}
+
+// The middle of a contact, between the point on A and the point on B.
+static glm::vec3 contactMiddle(const EPAResult& contact)
+{
+	return (contact.pointA + contact.pointB) * 0.5f;
+}
+
+// Twice the area of the triangle p0, p1, p2 as seen looking down normal. It's negative if the corners go clockwise around normal.
+static float signedArea(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& normal)
+{
+	return glm::dot(glm::cross(p1 - p0, p2 - p0), normal);
+}
+
+int ReduceContacts(const EPAResult* const* contacts, int count, int* kept, glm::vec3& normal)
+{
+	if (count <= 0)
+	{
+		return 0;
+	}
+
+	int deepest = 0;
+	glm::vec3 normalSum = glm::vec3(0.0f);
+
+	for (int i = 0; i < count; i++)
+	{
+		if (contacts[i]->depth > contacts[deepest]->depth)
+		{
+			deepest = i;
+		}
+
+		normalSum += contacts[i]->normal * glm::max(contacts[i]->depth, 0.0f);
+	}
+
+	float lengthSquared = glm::dot(normalSum, normalSum);
+	normal = lengthSquared > 1e-12f ? normalSum / sqrtf(lengthSquared) : contacts[deepest]->normal;
+
+	// Few enough already. (Any that are in the same spot get merged by Add.)
+	if (count <= ContactManifold::MAX_POINTS)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			kept[i] = i;
+		}
+
+		return count;
+	}
+
+	// The deepest point matters most for pushing the objects apart, so it always stays.
+	kept[0] = deepest;
+	glm::vec3 p0 = contactMiddle(*contacts[deepest]);
+
+	// Then whichever is farthest from it along the contact plane.
+	int second = -1;
+	float bestDistance = 0.0f;
+
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 offset = contactMiddle(*contacts[i]) - p0;
+		offset -= normal * glm::dot(offset, normal);
+
+		float distance = glm::dot(offset, offset);
+
+		if (distance > bestDistance)
+		{
+			bestDistance = distance;
+			second = i;
+		}
+	}
+
+	// Every contact is in the same spot, so one is as good as all of them.
+	if (second < 0)
+	{
+		return 1;
+	}
+
+	kept[1] = second;
+	glm::vec3 p1 = contactMiddle(*contacts[second]);
+
+	// Then whichever makes the biggest triangle with those two, on either side of them.
+	int third = -1;
+	float bestArea = 0.0f;
+	float thirdArea = 0.0f;
+
+	for (int i = 0; i < count; i++)
+	{
+		float area = signedArea(p0, p1, contactMiddle(*contacts[i]), normal);
+
+		if (fabsf(area) > bestArea)
+		{
+			bestArea = fabsf(area);
+			thirdArea = area;
+			third = i;
+		}
+	}
+
+	// They're all on one line, so its two ends cover it.
+	if (third < 0)
+	{
+		return 2;
+	}
+
+	kept[2] = third;
+	glm::vec3 p2 = contactMiddle(*contacts[third]);
+
+	// Last, whichever is farthest outside the triangle, which is the one that adds the most area to it. Turned so the triangle goes
+	// counterclockwise, a point is outside an edge when its area with that edge is negative, and the most negative edge is how far out it is.
+	float winding = thirdArea > 0.0f ? 1.0f : -1.0f;
+	int fourth = -1;
+	float bestAdded = 0.0f;
+
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 p = contactMiddle(*contacts[i]);
+		float inside = glm::min(signedArea(p0, p1, p, normal) * winding, glm::min(signedArea(p1, p2, p, normal) * winding,
+			signedArea(p2, p0, p, normal) * winding));
+
+		if (-inside > bestAdded)
+		{
+			bestAdded = -inside;
+			fourth = i;
+		}
+	}
+
+	// Everything else is inside the triangle already.
+	if (fourth < 0)
+	{
+		return 3;
+	}
+
+	kept[3] = fourth;
+
+	return 4;
+}
+
+// Roughly how much area four points cover: the largest cross product of the two "diagonals" over the three ways of pairing them up.
+// (We only compare these against each other, so there is no need for the real area.)
+static float quadArea(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3)
+{
+	glm::vec3 a = glm::cross(p0 - p1, p2 - p3);
+	glm::vec3 b = glm::cross(p0 - p2, p1 - p3);
+	glm::vec3 c = glm::cross(p0 - p3, p1 - p2);
+
+	return glm::max(glm::dot(a, a), glm::max(glm::dot(b, b), glm::dot(c, c)));
+}
+
+int ContactManifold::pointToReplace(const ContactPoint& point)
+{
+	// The deepest point is the one that matters most for pushing the objects apart, so it always stays.
+	int deepest = 0;
+
+	for (int i = 1; i < count; i++)
+	{
+		if (points[i].depth > points[deepest].depth)
+		{
+			deepest = i;
+		}
+	}
+
+	// If the new point is the deepest of them all, we can lose any of the old ones.
+	if (point.depth > points[deepest].depth)
+	{
+		deepest = -1;
+	}
+
+	int best = -1;
+	float bestArea = -1.0f;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (i == deepest)
+		{
+			continue;
+		}
+
+		// The area we'd have with the new point in place of point i.
+		glm::vec3 corners[MAX_POINTS];
+
+		for (int j = 0; j < count; j++)
+		{
+			corners[j] = (j == i) ? point.localA : points[j].localA;
+		}
+
+		float area = quadArea(corners[0], corners[1], corners[2], corners[3]);
+
+		if (area > bestArea)
+		{
+			bestArea = area;
+			best = i;
+		}
+	}
+
+	return best;
+}
+
+void ContactManifold::removePoint(int index)
+{
+	points[index] = points[--count];
+}
+
+float ContactManifold::GetMaxDepth() const
+{
+	float depth = 0.0f;
+
+	for (int i = 0; i < count; i++)
+	{
+		depth = glm::max(depth, points[i].depth);
+	}
+
+	return depth;
+}
+
+#endif //_CONTACT_MANIFOLD_CPP
@@ -0,0 +1,145 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ContactManifold.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CONTACT_MANIFOLD_H
+#define _CONTACT_MANIFOLD_H
+
+#include "EPA.h"
+
+// One point of contact between two objects.
+// The points are kept in each object's local space, so that as the objects move we can find where the same two points are now without
+// running any collision queries at all.
+struct ContactPoint
+{
+	glm::vec3 localA;	// The contact point on A, in A's local space.
+	glm::vec3 localB;	// The contact point on B, in B's local space.
+	glm::vec3 worldA;	// The contact point on A, in world space, as of the last Add or Update.
+	glm::vec3 worldB;	// The contact point on B, in world space, as of the last Add or Update.
+	float depth;		// How far the points overlap along the manifold's normal. Negative once they have come apart.
+	float impulse;		// The impulse the contact solver has pushed the objects apart with here, kept to start the next step from.
+};
+
+// The contacts between one pair of objects, kept from step to step.
+// A box resting on another touches along a whole face, but GJK and EPA only ever give us one point at a time. Rather than clipping the two
+// shapes against each other every step to find the whole contact area, we keep up to 4 points and each step:
+// - Update moves the points we already have along with the objects, and throws away the ones that have come apart or slid off.
+// - Add puts in the one new point from EPA, replacing an old one if the manifold is full.
+// After a few steps of resting contact the manifold has built up the corners of the contact area, which is what a stack needs to stay stable.
+class ContactManifold
+{
+public:
+	static const int MAX_POINTS = 4;
+
+private:
+	ContactPoint points[MAX_POINTS];
+	int count;
+
+	// The contact normal, in world space, pointing from A to B. It comes from the most recent point added.
+	glm::vec3 normal;
+
+	// How far a point can separate or slide before we stop trusting it, and how close a new point has to be to an old one to count as the same point.
+	float breakingThreshold;
+
+	// Picks which existing point a new one should replace when the manifold is full. (Never the deepest, and otherwise whichever gives the
+	// biggest contact area once it's gone.)
+	int pointToReplace(const ContactPoint& point);
+
+	void removePoint(int index);
+
+public:
+	ContactManifold()
+	{
+		count = 0;
+		normal = glm::vec3(0.0f);
+		breakingThreshold = 0.02f;
+	}
+
+	// Re-projects every point using the objects' current transforms, and removes any that have separated or slid more than the breaking threshold.
+	void Update(const glm::mat4& transformA, const glm::mat4& transformB);
+
+	// Adds the point EPA found this step. transformA and transformB are the transforms of the shapes EPA was run on.
+	void Add(const EPAResult& contact, const glm::mat4& transformA, const glm::mat4& transformB);
+
+	// Adds a whole set of contacts found together this step, like one per triangle a box is touching on a TriangleMesh (see CollideMesh) or
+	// one per child of a CompoundShape (see CollideCompound). Only the few ReduceContacts picks go in, and the manifold takes the normal it
+	// works out for them, so however finely the mesh is cut up, the solver never has more than MAX_POINTS points to work on.
+	void AddReduced(const EPAResult* const* contacts, int count, const glm::mat4& transformA, const glm::mat4& transformB);
+
+	void Clear()
+	{
+		count = 0;
+	}
+
+	int Size() const
+	{
+		return count;
+	}
+
+	const ContactPoint& operator[](int index) const
+	{
+		return points[index];
+	}
+	ContactPoint& operator[](int index)
+	{
+		return points[index];
+	}
+
+	const glm::vec3& GetNormal() const
+	{
+		return normal;
+	}
+
+	// The deepest depth in the manifold, or 0 if it is empty.
+	float GetMaxDepth() const;
+
+	void SetBreakingThreshold(float threshold)
+	{
+		breakingThreshold = threshold;
+	}
+	float GetBreakingThreshold() const
+	{
+		return breakingThreshold;
+	}
+};
+
+// Picks at most ContactManifold::MAX_POINTS of count contacts between the same two objects, which cover as much of the contact area as those
+// points can: the deepest one first, then the one farthest from it, then the one that makes the biggest triangle with those two, and last the
+// one farthest outside that triangle. The numbers of the ones picked go in kept (which needs room for MAX_POINTS), and how many is returned.
+// Each contact has its own normal, so normal gets the one they share, which is all of their normals weighted by how deep each is (or the
+// deepest one's normal, if that comes out to nothing). The areas are measured around it.
+int ReduceContacts(const EPAResult* const* contacts, int count, int* kept, glm::vec3& normal);
+
+#endif //_CONTACT_MANIFOLD_H
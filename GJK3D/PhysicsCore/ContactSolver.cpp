@@ -0,0 +1,906 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ContactSolver.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+
+#ifndef _CONTACT_SOLVER_CPP
+#define _CONTACT_SOLVER_CPP
+
+#include "ContactSolver.h"
+#include "JobSystem.h"
+#include <algorithm>
+
+// A color with fewer blocks than this is solved on the calling thread: handing it out would take longer than solving it.
+static const int PARALLEL_COLOR_BLOCKS = 32;
+
+// How many blocks each of a color's jobs takes.
+static const int COLOR_GRAIN = 16;
+
+// The blocks are solved in terms of a few operations on a whole register of lanes, with a version for each instruction set (the same way
+// as the box batch in GJKBatch.cpp). AVX fits 8 constraints, everything else 4.
+#if defined(GJK_SIMD_AVX)
+typedef __m256 Lanes;
+
+static inline Lanes load(const float* values)
+{
+	return _mm256_loadu_ps(values);
+}
+static inline void store(float* values, Lanes lanes)
+{
+	_mm256_storeu_ps(values, lanes);
+}
+static inline Lanes add(Lanes a, Lanes b)
+{
+	return _mm256_add_ps(a, b);
+}
+static inline Lanes sub(Lanes a, Lanes b)
+{
+	return _mm256_sub_ps(a, b);
+}
+static inline Lanes mul(Lanes a, Lanes b)
+{
+	return _mm256_mul_ps(a, b);
+}
+static inline Lanes max(Lanes a, Lanes b)
+{
+	return _mm256_max_ps(a, b);
+}
+static inline Lanes zero()
+{
+	return _mm256_setzero_ps();
+}
+static inline Lanes splat(float value)
+{
+	return _mm256_set1_ps(value);
+}
+// Each lane of ifNegative where value is negative, and of otherwise where it isn't.
+static inline Lanes selectNegative(Lanes value, Lanes ifNegative, Lanes otherwise)
+{
+	return _mm256_blendv_ps(otherwise, ifNegative, _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_LT_OQ));
+}
+#elif defined(GJK_SIMD_SSE)
+typedef __m128 Lanes;
+
+static inline Lanes load(const float* values)
+{
+	return _mm_loadu_ps(values);
+}
+static inline void store(float* values, Lanes lanes)
+{
+	_mm_storeu_ps(values, lanes);
+}
+static inline Lanes add(Lanes a, Lanes b)
+{
+	return _mm_add_ps(a, b);
+}
+static inline Lanes sub(Lanes a, Lanes b)
+{
+	return _mm_sub_ps(a, b);
+}
+static inline Lanes mul(Lanes a, Lanes b)
+{
+	return _mm_mul_ps(a, b);
+}
+static inline Lanes max(Lanes a, Lanes b)
+{
+	return _mm_max_ps(a, b);
+}
+static inline Lanes zero()
+{
+	return _mm_setzero_ps();
+}
+static inline Lanes splat(float value)
+{
+	return _mm_set1_ps(value);
+}
+static inline Lanes selectNegative(Lanes value, Lanes ifNegative, Lanes otherwise)
+{
+	Lanes mask = _mm_cmplt_ps(value, _mm_setzero_ps());
+
+	return _mm_or_ps(_mm_and_ps(mask, ifNegative), _mm_andnot_ps(mask, otherwise));
+}
+#elif defined(GJK_SIMD_NEON)
+typedef float32x4_t Lanes;
+
+static inline Lanes load(const float* values)
+{
+	return vld1q_f32(values);
+}
+static inline void store(float* values, Lanes lanes)
+{
+	vst1q_f32(values, lanes);
+}
+static inline Lanes add(Lanes a, Lanes b)
+{
+	return vaddq_f32(a, b);
+}
+static inline Lanes sub(Lanes a, Lanes b)
+{
+	return vsubq_f32(a, b);
+}
+static inline Lanes mul(Lanes a, Lanes b)
+{
+	return vmulq_f32(a, b);
+}
+static inline Lanes max(Lanes a, Lanes b)
+{
+	return vmaxq_f32(a, b);
+}
+static inline Lanes zero()
+{
+	return vdupq_n_f32(0.0f);
+}
+static inline Lanes splat(float value)
+{
+	return vdupq_n_f32(value);
+}
+static inline Lanes selectNegative(Lanes value, Lanes ifNegative, Lanes otherwise)
+{
+	return vbslq_f32(vcltq_f32(value, vdupq_n_f32(0.0f)), ifNegative, otherwise);
+}
+#else
+// No SIMD available, so a "register" is just an array of floats, and each operation is a loop over them.
+struct Lanes
+{
+	float values[SOLVER_LANES];
+};
+
+static inline Lanes load(const float* values)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < SOLVER_LANES; i++)
+	{
+		lanes.values[i] = values[i];
+	}
+
+	return lanes;
+}
+static inline void store(float* values, Lanes lanes)
+{
+	for (int i = 0; i < SOLVER_LANES; i++)
+	{
+		values[i] = lanes.values[i];
+	}
+}
+static inline Lanes add(Lanes a, Lanes b)
+{
+	for (int i = 0; i < SOLVER_LANES; i++)
+	{
+		a.values[i] += b.values[i];
+	}
+
+	return a;
+}
+static inline Lanes sub(Lanes a, Lanes b)
+{
+	for (int i = 0; i < SOLVER_LANES; i++)
+	{
+		a.values[i] -= b.values[i];
+	}
+
+	return a;
+}
+static inline Lanes mul(Lanes a, Lanes b)
+{
+	for (int i = 0; i < SOLVER_LANES; i++)
+	{
+		a.values[i] *= b.values[i];
+	}
+
+	return a;
+}
+static inline Lanes max(Lanes a, Lanes b)
+{
+	for (int i = 0; i < SOLVER_LANES; i++)
+	{
+		a.values[i] = a.values[i] > b.values[i] ? a.values[i] : b.values[i];
+	}
+
+	return a;
+}
+static inline Lanes splat(float value)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < SOLVER_LANES; i++)
+	{
+		lanes.values[i] = value;
+	}
+
+	return lanes;
+}
+static inline Lanes zero()
+{
+	return splat(0.0f);
+}
+static inline Lanes selectNegative(Lanes value, Lanes ifNegative, Lanes otherwise)
+{
+	for (int i = 0; i < SOLVER_LANES; i++)
+	{
+		otherwise.values[i] = value.values[i] < 0.0f ? ifNegative.values[i] : otherwise.values[i];
+	}
+
+	return otherwise;
+}
+#endif
+
+ContactSolver::ContactSolver()
+{
+	iterations = 4;
+	substeps = 1;
+	restitution = 1.0f;
+	restitutionThreshold = 0.1f;
+	warmStarting = true;
+	batching = true;
+	peakBodies = 0;
+	peakConstraints = 0;
+	coloringReused = false;
+	jobs = nullptr;
+}
+
+void ContactSolver::Clear()
+{
+	velocityX.clear();
+	velocityY.clear();
+	velocityZ.clear();
+	accelerations.clear();
+	inverseMasses.clear();
+	velocities.clear();
+
+	constraints.clear();
+}
+
+void ContactSolver::Reserve(int bodies, int constraintCount)
+{
+	// Coloring adds an object of its own, for the padding lanes.
+	int withPadding = bodies + 1;
+
+	velocityX.reserve(withPadding);
+	velocityY.reserve(withPadding);
+	velocityZ.reserve(withPadding);
+	accelerations.reserve(withPadding);
+	inverseMasses.reserve(withPadding);
+	velocities.reserve(withPadding);
+	travelX.reserve(withPadding);
+	travelY.reserve(withPadding);
+	travelZ.reserve(withPadding);
+
+	constraints.reserve(constraintCount);
+
+	// Each color's last block can be partly padding.
+	blocks.reserve(constraintCount / SOLVER_LANES + MAX_COLORS);
+	unbatched.reserve(constraintCount);
+	colorStarts.reserve(MAX_COLORS + 1);
+	coloredPairs.reserve(constraintCount);
+	constraintColors.reserve(constraintCount);
+
+	for (int color = 0; color < MAX_COLORS; color++)
+	{
+		colors[color].reserve(constraintCount);
+	}
+
+	colorBodies.reserve(MAX_COLORS * ((withPadding + 31) / 32));
+}
+
+int ContactSolver::AddBody(const SolverBody& body)
+{
+	velocityX.push_back(body.velocity->x);
+	velocityY.push_back(body.velocity->y);
+	velocityZ.push_back(body.velocity->z);
+	accelerations.push_back(body.acceleration);
+	inverseMasses.push_back(body.inverseMass);
+
+	// An object that can't move never has its velocity changed, so it's never written back (and other threads can share it).
+	velocities.push_back(body.inverseMass > 0.0f ? body.velocity : nullptr);
+
+	return (int)velocities.size() - 1;
+}
+
+void ContactSolver::applyImpulse(const ContactConstraint& constraint, float impulse)
+{
+	glm::vec3 impulseA = constraint.normal * (impulse * inverseMasses[constraint.bodyA]);
+	glm::vec3 impulseB = constraint.normal * (impulse * inverseMasses[constraint.bodyB]);
+
+	velocityX[constraint.bodyA] -= impulseA.x;
+	velocityY[constraint.bodyA] -= impulseA.y;
+	velocityZ[constraint.bodyA] -= impulseA.z;
+
+	velocityX[constraint.bodyB] += impulseB.x;
+	velocityY[constraint.bodyB] += impulseB.y;
+	velocityZ[constraint.bodyB] += impulseB.z;
+}
+
+void ContactSolver::Add(const NarrowphaseContact& contact, int a, int b, float dt)
+{
+	// Two objects that can't be moved have nothing to solve.
+	if (inverseMasses[a] + inverseMasses[b] <= 0.0f)
+	{
+		return;
+	}
+
+	ContactManifold& manifold = *contact.manifold;
+	glm::vec3 normal = manifold.GetNormal();
+	glm::vec3 velocityA(velocityX[a], velocityY[a], velocityZ[a]);
+	glm::vec3 velocityB(velocityX[b], velocityY[b], velocityZ[b]);
+	float acceleration = glm::dot(accelerations[b] - accelerations[a], normal) * dt;
+	float closing = glm::dot(velocityB - velocityA, normal) + acceleration;
+
+	for (int i = 0; i < manifold.Size(); i++)
+	{
+		ContactPoint& point = manifold[i];
+
+		ContactConstraint constraint;
+		constraint.bodyA = a;
+		constraint.bodyB = b;
+		constraint.normal = normal;
+		constraint.normalMass = 1.0f / (inverseMasses[a] + inverseMasses[b]);
+		constraint.acceleration = acceleration;
+		constraint.impulse = point.impulse;
+		constraint.savedImpulse = &point.impulse;
+		constraint.depth = point.depth;
+		constraint.step = dt;
+		constraint.stepAcceleration = acceleration;
+		constraint.bounceVelocity = closing < -restitutionThreshold ? -restitution * closing : 0.0f;
+
+		// A point that has come apart can close by as much as the gap this step. One that's touching stops closing, and bounces back if
+		// it was closing fast enough. (This is worked out before warm starting, from how the objects were really moving.)
+		constraint.targetVelocity = point.depth < 0.0f ? point.depth / dt : constraint.bounceVelocity;
+
+		constraints.push_back(constraint);
+	}
+}
+
+void ContactSolver::solveConstraint(ContactConstraint& constraint)
+{
+	glm::vec3 velocityA(velocityX[constraint.bodyA], velocityY[constraint.bodyA], velocityZ[constraint.bodyA]);
+	glm::vec3 velocityB(velocityX[constraint.bodyB], velocityY[constraint.bodyB], velocityZ[constraint.bodyB]);
+
+	float closing = glm::dot(velocityB - velocityA, constraint.normal) + constraint.acceleration;
+	float impulse = (constraint.targetVelocity - closing) * constraint.normalMass;
+
+	// The total impulse can only ever push. If this would take it below 0, it takes it to 0 instead.
+	float total = glm::max(constraint.impulse + impulse, 0.0f);
+
+	impulse = total - constraint.impulse;
+	constraint.impulse = total;
+
+	applyImpulse(constraint, impulse);
+}
+
+void ContactSolver::solveBlock(ConstraintBlock& block)
+{
+	// No two lanes share an object, so every lane's velocities can be read in, changed and written back without stepping on another's.
+	GJK_ALIGN(32) float values[6][SOLVER_LANES];
+
+	for (int lane = 0; lane < SOLVER_LANES; lane++)
+	{
+		values[0][lane] = velocityX[block.bodyA[lane]];
+		values[1][lane] = velocityY[block.bodyA[lane]];
+		values[2][lane] = velocityZ[block.bodyA[lane]];
+		values[3][lane] = velocityX[block.bodyB[lane]];
+		values[4][lane] = velocityY[block.bodyB[lane]];
+		values[5][lane] = velocityZ[block.bodyB[lane]];
+	}
+
+	Lanes velocityAX = load(values[0]);
+	Lanes velocityAY = load(values[1]);
+	Lanes velocityAZ = load(values[2]);
+	Lanes velocityBX = load(values[3]);
+	Lanes velocityBY = load(values[4]);
+	Lanes velocityBZ = load(values[5]);
+
+	Lanes normalX = load(block.normalX);
+	Lanes normalY = load(block.normalY);
+	Lanes normalZ = load(block.normalZ);
+
+	// The same as solveConstraint, a lane per constraint.
+	Lanes closing = add(add(mul(sub(velocityBX, velocityAX), normalX), mul(sub(velocityBY, velocityAY), normalY)),
+		mul(sub(velocityBZ, velocityAZ), normalZ));
+	closing = add(closing, load(block.acceleration));
+
+	Lanes impulse = mul(sub(load(block.targetVelocity), closing), load(block.normalMass));
+	Lanes previous = load(block.impulse);
+	Lanes total = max(add(previous, impulse), zero());
+
+	impulse = sub(total, previous);
+	store(block.impulse, total);
+
+	Lanes impulseA = mul(impulse, load(block.inverseMassA));
+	Lanes impulseB = mul(impulse, load(block.inverseMassB));
+
+	store(values[0], sub(velocityAX, mul(normalX, impulseA)));
+	store(values[1], sub(velocityAY, mul(normalY, impulseA)));
+	store(values[2], sub(velocityAZ, mul(normalZ, impulseA)));
+	store(values[3], add(velocityBX, mul(normalX, impulseB)));
+	store(values[4], add(velocityBY, mul(normalY, impulseB)));
+	store(values[5], add(velocityBZ, mul(normalZ, impulseB)));
+
+	for (int lane = 0; lane < SOLVER_LANES; lane++)
+	{
+		velocityX[block.bodyA[lane]] = values[0][lane];
+		velocityY[block.bodyA[lane]] = values[1][lane];
+		velocityZ[block.bodyA[lane]] = values[2][lane];
+		velocityX[block.bodyB[lane]] = values[3][lane];
+		velocityY[block.bodyB[lane]] = values[4][lane];
+		velocityZ[block.bodyB[lane]] = values[5][lane];
+	}
+}
+
+void ContactSolver::colorConstraints()
+{
+	// Whether each object can move decides whether it counts against a color, so it's part of what has to match.
+	int count = (int)constraints.size();
+	bool same = count == (int)coloredPairs.size();
+
+	coloredPairs.resize(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		int a = constraints[i].bodyA * 2 + (inverseMasses[constraints[i].bodyA] > 0.0f ? 1 : 0);
+		int b = constraints[i].bodyB * 2 + (inverseMasses[constraints[i].bodyB] > 0.0f ? 1 : 0);
+		long long pair = ((long long)a << 32) | (unsigned int)b;
+
+		same = same && coloredPairs[i] == pair;
+		coloredPairs[i] = pair;
+	}
+
+	coloringReused = same && count > 0;
+
+	if (coloringReused)
+	{
+		return;
+	}
+
+	constraintColors.resize(count);
+
+	int words = ((int)velocities.size() + 31) / 32;
+
+	colorBodies.assign(MAX_COLORS * words, 0);
+
+	for (int i = 0; i < count; i++)
+	{
+		int a = constraints[i].bodyA;
+		int b = constraints[i].bodyB;
+		unsigned int bitA = 1u << (a & 31);
+		unsigned int bitB = 1u << (b & 31);
+
+		// Objects that can't move are never written to, so they can be in any number of the same color's constraints.
+		bool movesA = inverseMasses[a] > 0.0f;
+		bool movesB = inverseMasses[b] > 0.0f;
+
+		int found = -1;
+
+		for (int color = 0; color < MAX_COLORS && found == -1; color++)
+		{
+			unsigned int* bodies = &colorBodies[color * words];
+
+			if ((movesA && (bodies[a >> 5] & bitA)) || (movesB && (bodies[b >> 5] & bitB)))
+			{
+				continue;
+			}
+
+			if (movesA)
+			{
+				bodies[a >> 5] |= bitA;
+			}
+			if (movesB)
+			{
+				bodies[b >> 5] |= bitB;
+			}
+
+			found = color;
+		}
+
+		constraintColors[i] = (signed char)found;
+	}
+}
+
+void ContactSolver::buildBlocks()
+{
+	blocks.clear();
+	unbatched.clear();
+	colorStarts.clear();
+
+	colorConstraints();
+
+	for (int color = 0; color < MAX_COLORS; color++)
+	{
+		colors[color].clear();
+	}
+
+	for (int i = 0; i < (int)constraints.size(); i++)
+	{
+		if (constraintColors[i] == -1)
+		{
+			unbatched.push_back(i);
+		}
+		else
+		{
+			colors[constraintColors[i]].push_back(i);
+		}
+	}
+
+	// The padding lanes need an object to point at, and one that can't move is never changed by them.
+	SolverBody padding;
+	glm::vec3 paddingVelocity(0.0f);
+	padding.velocity = &paddingVelocity;
+	padding.acceleration = glm::vec3(0.0f);
+	padding.inverseMass = 0.0f;
+
+	int paddingBody = AddBody(padding);
+
+	for (int color = 0; color < MAX_COLORS; color++)
+	{
+		const std::vector<int>& list = colors[color];
+
+		// Not enough to fill a register, so it isn't worth turning around.
+		if ((int)list.size() < SOLVER_LANES)
+		{
+			unbatched.insert(unbatched.end(), list.begin(), list.end());
+			continue;
+		}
+
+		colorStarts.push_back((int)blocks.size());
+
+		for (int start = 0; start < (int)list.size(); start += SOLVER_LANES)
+		{
+			ConstraintBlock block;
+
+			for (int lane = 0; lane < SOLVER_LANES; lane++)
+			{
+				if (start + lane < (int)list.size())
+				{
+					const ContactConstraint& constraint = constraints[list[start + lane]];
+
+					block.normalX[lane] = constraint.normal.x;
+					block.normalY[lane] = constraint.normal.y;
+					block.normalZ[lane] = constraint.normal.z;
+					block.inverseMassA[lane] = inverseMasses[constraint.bodyA];
+					block.inverseMassB[lane] = inverseMasses[constraint.bodyB];
+					block.normalMass[lane] = constraint.normalMass;
+					block.acceleration[lane] = constraint.acceleration;
+					block.targetVelocity[lane] = constraint.targetVelocity;
+					block.impulse[lane] = constraint.impulse;
+					block.depth[lane] = constraint.depth;
+					block.substepLength[lane] = constraint.step / substeps;
+					block.inverseSubstepLength[lane] = substeps / constraint.step;
+					block.stepAcceleration[lane] = constraint.stepAcceleration;
+					block.bounceVelocity[lane] = constraint.bounceVelocity;
+					block.bodyA[lane] = constraint.bodyA;
+					block.bodyB[lane] = constraint.bodyB;
+					block.constraint[lane] = list[start + lane];
+				}
+				else
+				{
+					block.normalX[lane] = 0.0f;
+					block.normalY[lane] = 0.0f;
+					block.normalZ[lane] = 0.0f;
+					block.inverseMassA[lane] = 0.0f;
+					block.inverseMassB[lane] = 0.0f;
+					block.normalMass[lane] = 0.0f;
+					block.acceleration[lane] = 0.0f;
+					block.targetVelocity[lane] = 0.0f;
+					block.impulse[lane] = 0.0f;
+					block.depth[lane] = 0.0f;
+					block.substepLength[lane] = 0.0f;
+					block.inverseSubstepLength[lane] = 0.0f;
+					block.stepAcceleration[lane] = 0.0f;
+					block.bounceVelocity[lane] = 0.0f;
+					block.bodyA[lane] = paddingBody;
+					block.bodyB[lane] = paddingBody;
+					block.constraint[lane] = -1;
+				}
+			}
+
+			blocks.push_back(block);
+		}
+	}
+
+	colorStarts.push_back((int)blocks.size());
+}
+
+template<typename Function>
+void ContactSolver::forEachBlock(Function& function)
+{
+	// The colors go one after another, since each one's blocks read the velocities the color before wrote.
+	for (int color = 0; color + 1 < (int)colorStarts.size(); color++)
+	{
+		int first = colorStarts[color];
+		int count = colorStarts[color + 1] - first;
+
+		if (jobs == nullptr || count < PARALLEL_COLOR_BLOCKS)
+		{
+			for (int i = first; i < first + count; i++)
+			{
+				function(blocks[i]);
+			}
+
+			continue;
+		}
+
+		auto run = [this, first, &function](int begin, int end, int /*thread*/)
+		{
+			for (int i = first + begin; i < first + end; i++)
+			{
+				function(blocks[i]);
+			}
+		};
+
+		jobs->ParallelFor(count, COLOR_GRAIN, run);
+	}
+}
+
+void ContactSolver::orderConstraints()
+{
+	if (batching)
+	{
+		buildBlocks();
+	}
+	else
+	{
+		blocks.clear();
+		colorStarts.clear();
+		coloringReused = false;
+		unbatched.resize(constraints.size());
+
+		for (int i = 0; i < (int)constraints.size(); i++)
+		{
+			unbatched[i] = i;
+		}
+	}
+}
+
+void ContactSolver::copyBlockImpulses()
+{
+	for (int i = 0; i < (int)blocks.size(); i++)
+	{
+		for (int lane = 0; lane < SOLVER_LANES; lane++)
+		{
+			if (blocks[i].constraint[lane] != -1)
+			{
+				constraints[blocks[i].constraint[lane]].impulse = blocks[i].impulse[lane];
+			}
+		}
+	}
+}
+
+void ContactSolver::solveStep()
+{
+	for (int i = 0; i < (int)constraints.size(); i++)
+	{
+		if (warmStarting)
+		{
+			applyImpulse(constraints[i], constraints[i].impulse);
+		}
+		else
+		{
+			constraints[i].impulse = 0.0f;
+		}
+	}
+
+	// The blocks take their impulses from the constraints, so they're built after warm starting.
+	orderConstraints();
+
+	auto solve = [this](ConstraintBlock& block)
+	{
+		solveBlock(block);
+	};
+
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		forEachBlock(solve);
+
+		for (int i = 0; i < (int)unbatched.size(); i++)
+		{
+			solveConstraint(constraints[unbatched[i]]);
+		}
+	}
+
+	copyBlockImpulses();
+}
+
+void ContactSolver::prepareConstraint(ContactConstraint& constraint, int substep, float share)
+{
+	glm::vec3 travelA(travelX[constraint.bodyA], travelY[constraint.bodyA], travelZ[constraint.bodyA]);
+	glm::vec3 travelB(travelX[constraint.bodyB], travelY[constraint.bodyB], travelZ[constraint.bodyB]);
+	float substepLength = constraint.step * share;
+
+	// How far the points have moved apart over the substeps so far: the objects' velocities in each, and what the accelerations had added
+	// by then (a share of the step's for the first substep, two for the second, and so on).
+	float travel = glm::dot(travelB - travelA, constraint.normal) + constraint.stepAcceleration * share * (substep * (substep + 1) / 2);
+	float depth = constraint.depth - travel * substepLength;
+
+	// Like a whole step: a gap can close by as much as is left of it this substep, and a point that's touching stops (or bounces).
+	constraint.acceleration = constraint.stepAcceleration * share * (substep + 1);
+	constraint.targetVelocity = depth < 0.0f ? depth / substepLength : constraint.bounceVelocity;
+
+	applyImpulse(constraint, constraint.impulse);
+}
+
+void ContactSolver::prepareBlock(ConstraintBlock& block, int substep, float share)
+{
+	// The same as prepareConstraint, a lane per constraint. No two lanes share an object, as in solveBlock.
+	GJK_ALIGN(32) float values[6][SOLVER_LANES];
+	GJK_ALIGN(32) float travels[6][SOLVER_LANES];
+
+	for (int lane = 0; lane < SOLVER_LANES; lane++)
+	{
+		values[0][lane] = velocityX[block.bodyA[lane]];
+		values[1][lane] = velocityY[block.bodyA[lane]];
+		values[2][lane] = velocityZ[block.bodyA[lane]];
+		values[3][lane] = velocityX[block.bodyB[lane]];
+		values[4][lane] = velocityY[block.bodyB[lane]];
+		values[5][lane] = velocityZ[block.bodyB[lane]];
+
+		travels[0][lane] = travelX[block.bodyA[lane]];
+		travels[1][lane] = travelY[block.bodyA[lane]];
+		travels[2][lane] = travelZ[block.bodyA[lane]];
+		travels[3][lane] = travelX[block.bodyB[lane]];
+		travels[4][lane] = travelY[block.bodyB[lane]];
+		travels[5][lane] = travelZ[block.bodyB[lane]];
+	}
+
+	Lanes normalX = load(block.normalX);
+	Lanes normalY = load(block.normalY);
+	Lanes normalZ = load(block.normalZ);
+	Lanes stepAcceleration = load(block.stepAcceleration);
+
+	Lanes travel = add(add(mul(sub(load(travels[3]), load(travels[0])), normalX), mul(sub(load(travels[4]), load(travels[1])), normalY)),
+		mul(sub(load(travels[5]), load(travels[2])), normalZ));
+	travel = add(travel, mul(stepAcceleration, splat(share * (substep * (substep + 1) / 2))));
+
+	Lanes depth = sub(load(block.depth), mul(travel, load(block.substepLength)));
+
+	store(block.acceleration, mul(stepAcceleration, splat(share * (substep + 1))));
+	store(block.targetVelocity, selectNegative(depth, mul(depth, load(block.inverseSubstepLength)), load(block.bounceVelocity)));
+
+	Lanes impulse = load(block.impulse);
+	Lanes impulseA = mul(impulse, load(block.inverseMassA));
+	Lanes impulseB = mul(impulse, load(block.inverseMassB));
+
+	store(values[0], sub(load(values[0]), mul(normalX, impulseA)));
+	store(values[1], sub(load(values[1]), mul(normalY, impulseA)));
+	store(values[2], sub(load(values[2]), mul(normalZ, impulseA)));
+	store(values[3], add(load(values[3]), mul(normalX, impulseB)));
+	store(values[4], add(load(values[4]), mul(normalY, impulseB)));
+	store(values[5], add(load(values[5]), mul(normalZ, impulseB)));
+
+	for (int lane = 0; lane < SOLVER_LANES; lane++)
+	{
+		velocityX[block.bodyA[lane]] = values[0][lane];
+		velocityY[block.bodyA[lane]] = values[1][lane];
+		velocityZ[block.bodyA[lane]] = values[2][lane];
+		velocityX[block.bodyB[lane]] = values[3][lane];
+		velocityY[block.bodyB[lane]] = values[4][lane];
+		velocityZ[block.bodyB[lane]] = values[5][lane];
+	}
+}
+
+void ContactSolver::solveSubsteps()
+{
+	float share = 1.0f / substeps;
+
+	// A point's impulse is for one substep while the substeps run, and each substep pushes with it again. The manifold keeps the whole
+	// step's, so it's split up here and added back up at the end, and the impulses mean the same thing however many substeps there are.
+	for (int i = 0; i < (int)constraints.size(); i++)
+	{
+		constraints[i].impulse = warmStarting ? constraints[i].impulse * share : 0.0f;
+	}
+
+	// The blocks take their impulses from the constraints, like in solveStep.
+	orderConstraints();
+
+	travelX.assign(velocities.size(), 0.0f);
+	travelY.assign(velocities.size(), 0.0f);
+	travelZ.assign(velocities.size(), 0.0f);
+
+	auto solve = [this](ConstraintBlock& block)
+	{
+		solveBlock(block);
+	};
+
+	for (int substep = 0; substep < substeps; substep++)
+	{
+		auto prepare = [this, substep, share](ConstraintBlock& block)
+		{
+			prepareBlock(block, substep, share);
+		};
+
+		forEachBlock(prepare);
+
+		for (int i = 0; i < (int)unbatched.size(); i++)
+		{
+			prepareConstraint(constraints[unbatched[i]], substep, share);
+		}
+
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			forEachBlock(solve);
+
+			for (int i = 0; i < (int)unbatched.size(); i++)
+			{
+				solveConstraint(constraints[unbatched[i]]);
+			}
+		}
+
+		// Every object moves on at the velocity the substep left it with.
+		for (int i = 0; i < (int)velocities.size(); i++)
+		{
+			travelX[i] += velocityX[i];
+			travelY[i] += velocityY[i];
+			travelZ[i] += velocityZ[i];
+		}
+	}
+
+	copyBlockImpulses();
+
+	for (int i = 0; i < (int)constraints.size(); i++)
+	{
+		constraints[i].impulse *= substeps;
+	}
+}
+
+void ContactSolver::Solve(JobSystem* inJobs)
+{
+	jobs = inJobs;
+
+	peakBodies = std::max(peakBodies, (int)velocities.size());
+	peakConstraints = std::max(peakConstraints, (int)constraints.size());
+
+	if (substeps > 1)
+	{
+		solveSubsteps();
+	}
+	else
+	{
+		solveStep();
+	}
+
+	for (int i = 0; i < (int)constraints.size(); i++)
+	{
+		*constraints[i].savedImpulse = constraints[i].impulse;
+	}
+
+	for (int i = 0; i < (int)velocities.size(); i++)
+	{
+		if (velocities[i])
+		{
+			*velocities[i] = glm::vec3(velocityX[i], velocityY[i], velocityZ[i]);
+		}
+	}
+}
+
+#endif //_CONTACT_SOLVER_CPP
@@ -0,0 +1,354 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ContactSolver.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+
+#ifndef _CONTACT_SOLVER_H
+#define _CONTACT_SOLVER_H
+
+#include "Narrowphase.h"
+#include "SIMD.h"
+#include <vector>
+
+class JobSystem;
+
+// How many constraints the solver works on at once: one per lane of a SIMD register.
+#if defined(GJK_SIMD_AVX)
+static const int SOLVER_LANES = 8;
+#else
+static const int SOLVER_LANES = 4;
+#endif
+
+// One object, as the solver sees it.
+struct SolverBody
+{
+	glm::vec3* velocity;	// Where the object's velocity is. The solver changes it in place.
+	glm::vec3 acceleration;	// What the object's velocity is going to gain per second when it's integrated.
+	float inverseMass;		// 1 over its mass, or 0 for an object that can't be moved.
+};
+
+// One point of contact, as the solver pushes on it.
+struct ContactConstraint
+{
+	int bodyA;				// The solver's numbers for the two objects (see ContactSolver::AddBody).
+	int bodyB;
+
+	glm::vec3 normal;		// Points from A to B.
+	float normalMass;		// How much impulse it takes to change how fast the points close by 1: 1 / (inverseMassA + inverseMassB).
+	float acceleration;		// How much faster the points will be separating once the step's accelerations are added in.
+	float targetVelocity;	// The least the points can be moving apart along the normal once the solver is done.
+	float impulse;			// The total impulse on this point so far.
+	float* savedImpulse;	// Where the total is kept from one step to the next: in the pair's manifold.
+
+	// What the substeps work from (see ContactSolver::SetSubsteps): how far the points overlapped at the start of the step, the length of the
+	// whole step, the velocity the step's accelerations add along the normal, and the velocity to bounce back at if it's touching.
+	float depth;
+	float step;
+	float stepAcceleration;
+	float bounceVelocity;
+};
+
+// SOLVER_LANES constraints that share no objects, turned around so that each number has all of the constraints' values in a row (one
+// per lane). Lanes past the end of a color are padding, pointing at a body that can't move, with no mass, so they never push on anything.
+struct ConstraintBlock
+{
+	float normalX[SOLVER_LANES];
+	float normalY[SOLVER_LANES];
+	float normalZ[SOLVER_LANES];
+	float inverseMassA[SOLVER_LANES];
+	float inverseMassB[SOLVER_LANES];
+	float normalMass[SOLVER_LANES];
+	float acceleration[SOLVER_LANES];
+	float targetVelocity[SOLVER_LANES];
+	float impulse[SOLVER_LANES];
+
+	// The same for the substeps, with each constraint's step already split into substeps (and 1 over that).
+	float depth[SOLVER_LANES];
+	float substepLength[SOLVER_LANES];
+	float inverseSubstepLength[SOLVER_LANES];
+	float stepAcceleration[SOLVER_LANES];
+	float bounceVelocity[SOLVER_LANES];
+
+	int bodyA[SOLVER_LANES];
+	int bodyB[SOLVER_LANES];
+	int constraint[SOLVER_LANES];		// Which constraint each lane came from, or -1 for padding.
+};
+
+// Works out the velocities that stop colliding objects moving into each other, with sequential impulses.
+// Each point of contact can only push (never pull), and how hard it has to push depends on all of the other points touching the same
+// objects. Rather than solving all of them at once, the solver goes around the points one at a time, each time giving one the impulse that
+// would stop its objects closing, given what the others are doing. A few times around and the impulses have settled.
+// Each point keeps its total impulse in its manifold from one step to the next (warm starting). Something resting on something else needs
+// about the same impulse every step, so starting from last step's answer means the solver is nearly done before it starts, and a few
+// iterations are enough even for a stack.
+// The bodies have no spin of their own, so only their linear velocities (and masses) come into it.
+// Points that don't share an object don't affect each other, so they can be solved at the same time. Before it starts, the solver colors
+// the points (greedily: each one gets the first color none of its objects has yet), then solves each color SOLVER_LANES points at a time,
+// one per SIMD lane. Objects that can't move are never written to, so they don't count against a color, and each point that touches one
+// gets its own copy of it. Colors with too few points to fill a register, and the points that run out of colors, are solved one at a time
+// after the others (so a small island, like two boxes touching, is solved exactly as before).
+// A color's blocks share no objects either, so given a job system, Solve splits each big enough color between its threads, one color after
+// another. Nothing is locked or atomic, and since the blocks' order within a color doesn't change anything, the answer is the same to the
+// bit as solving them on one thread. The colors only depend on which objects each point is between, so when the points are between the same
+// objects as last time (an island whose contacts haven't changed), last time's colors are used again instead of being worked out.
+class ContactSolver
+{
+public:
+	// The most colors the solver will use. A point whose objects already have every color is solved one at a time instead.
+	static const int MAX_COLORS = 16;
+
+private:
+	// The objects, by the solver's number for them: their velocities (split into x, y and z, so the lanes can be filled from them), how
+	// fast they're speeding up, their inverse masses, and where to write their velocities back to (null for objects that can't move).
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> velocityZ;
+	std::vector<glm::vec3> accelerations;
+	std::vector<float> inverseMasses;
+	std::vector<glm::vec3*> velocities;
+
+	// While the substeps run, the objects' velocities at the end of each substep so far, added up. Times a substep's length that's how far
+	// each one has moved, which is what tells each point how much of its gap is left.
+	std::vector<float> travelX;
+	std::vector<float> travelY;
+	std::vector<float> travelZ;
+
+	std::vector<ContactConstraint> constraints;
+
+	// The colored constraints in blocks, one color after another, and the ones that are solved one at a time.
+	std::vector<ConstraintBlock> blocks;
+	std::vector<int> unbatched;
+
+	// Where each color's blocks start in blocks, with where the last one ends after them.
+	std::vector<int> colorStarts;
+
+	// Scratch for the coloring: each color's constraints, and a bit for each object that's already in one of that color's constraints.
+	std::vector<int> colors[MAX_COLORS];
+	std::vector<unsigned int> colorBodies;
+
+	// The objects each constraint was between when the colors were last worked out (with whether each can move), and the color each got
+	// (-1 for none), to use again if they're the same this time.
+	std::vector<long long> coloredPairs;
+	std::vector<signed char> constraintColors;
+	bool coloringReused;
+
+	// The job system Solve is splitting the colors between the threads of, if any.
+	JobSystem* jobs;
+
+	// The most objects and constraints any Solve has had (see GetPeakBodies).
+	int peakBodies;
+	int peakConstraints;
+
+	int iterations;
+	int substeps;
+	float restitution;
+	float restitutionThreshold;
+	bool warmStarting;
+	bool batching;
+
+	// Changes the velocities of a constraint's objects by impulse along its normal (pushing them apart if it's positive).
+	void applyImpulse(const ContactConstraint& constraint, float impulse);
+
+	// One iteration of one constraint on its own.
+	void solveConstraint(ContactConstraint& constraint);
+
+	// One iteration of a block of constraints, all at once.
+	void solveBlock(ConstraintBlock& block);
+
+	// Gives each constraint a color (or -1, for none), or keeps last time's if the constraints are between the same objects.
+	void colorConstraints();
+
+	// Colors the constraints and packs them into blocks.
+	void buildBlocks();
+
+	// Calls function on every block, a color at a time, splitting a color between the job system's threads if it has enough blocks.
+	template<typename Function>
+	void forEachBlock(Function& function);
+
+	// Packs the constraints into blocks if batching is on, or lines them all up to be solved one at a time if not.
+	void orderConstraints();
+
+	// Copies the blocks' impulses back to their constraints.
+	void copyBlockImpulses();
+
+	// Warm starts and runs the iterations over the whole step at once.
+	void solveStep();
+
+	// Splits the step into substeps, and runs the iterations in each (see SetSubsteps).
+	void solveSubsteps();
+
+	// Gets a constraint (or a block of them) ready for a substep: works out its acceleration and target velocity from how far its objects
+	// have moved so far, and warm starts it.
+	void prepareConstraint(ContactConstraint& constraint, int substep, float share);
+	void prepareBlock(ConstraintBlock& block, int substep, float share);
+
+public:
+	ContactSolver();
+
+	// How many times Solve goes around the points.
+	void SetIterations(int inIterations)
+	{
+		iterations = inIterations;
+	}
+	int GetIterations() const
+	{
+		return iterations;
+	}
+
+	// How many pieces Solve splits each step into (1, the default, doesn't split it). Each substep adds its share of the step's accelerations,
+	// pushes again with the impulse the substep before settled on, runs the iterations, and then moves each point's depth on by how fast
+	// the substep left it closing. That way a point only closes by as much of a gap as is left in its substep, and the velocities settle
+	// substep by substep as gravity builds them up. Meant for 1 iteration per substep: for a tall stack that's steadier than the same
+	// number of iterations over the whole step, for about the same work (the contacts are the same ones, found once per step).
+	void SetSubsteps(int inSubsteps)
+	{
+		substeps = inSubsteps > 1 ? inSubsteps : 1;
+	}
+	int GetSubsteps() const
+	{
+		return substeps;
+	}
+
+	// How bouncy collisions are: 0 stops the objects dead along the normal, and 1 sends them apart as fast as they came together. Contacts
+	// closing slower than threshold don't bounce at all, so resting objects settle instead of jittering.
+	void SetRestitution(float inRestitution, float threshold = 0.1f)
+	{
+		restitution = inRestitution;
+		restitutionThreshold = threshold;
+	}
+	float GetRestitution() const
+	{
+		return restitution;
+	}
+	float GetRestitutionThreshold() const
+	{
+		return restitutionThreshold;
+	}
+
+	// Whether to start each point from last step's impulse (on by default). Off, every step starts from nothing.
+	void SetWarmStarting(bool enabled)
+	{
+		warmStarting = enabled;
+	}
+	bool IsWarmStarting() const
+	{
+		return warmStarting;
+	}
+
+	// Whether to color the points and solve them SOLVER_LANES at a time (on by default). Off, every point is solved one at a time, in the
+	// order it was added. The answers differ slightly, since the points are visited in a different order.
+	void SetBatching(bool enabled)
+	{
+		batching = enabled;
+	}
+	bool IsBatching() const
+	{
+		return batching;
+	}
+
+	// Takes on another solver's settings (the iterations, substeps, restitution, warm starting and batching), keeping its own objects and
+	// constraints.
+	void CopySettings(const ContactSolver& other)
+	{
+		iterations = other.iterations;
+		substeps = other.substeps;
+		restitution = other.restitution;
+		restitutionThreshold = other.restitutionThreshold;
+		warmStarting = other.warmStarting;
+		batching = other.batching;
+	}
+
+	// Forgets the objects and constraints added so far.
+	void Clear();
+
+	// Makes room for bodies objects and constraints points of contact, so that adding that many and solving them allocates nothing.
+	void Reserve(int bodies, int constraints);
+
+	// The most objects and points of contact one Solve has had so far. A solver per thread each only sees the islands its thread happens to
+	// get, so giving every one of them room for the most any of them has seen (with Reserve) keeps any of them from having to grow later.
+	int GetPeakBodies() const
+	{
+		return peakBodies;
+	}
+	int GetPeakConstraints() const
+	{
+		return peakConstraints;
+	}
+
+	// Adds an object, and returns the solver's number for it (counting up from 0 after each Clear). Each object that can move must only be
+	// added once, and every constraint it's in has to go through the same solver. An object that can't move can be added as many times as
+	// you like, and in any number of solvers at once, since it's never written to.
+	int AddBody(const SolverBody& body);
+
+	int Size() const
+	{
+		return (int)constraints.size();
+	}
+
+	// How many blocks and one-at-a-time constraints the last Solve ended up with.
+	int GetBlockCount() const
+	{
+		return (int)blocks.size();
+	}
+	int GetUnbatchedCount() const
+	{
+		return (int)unbatched.size();
+	}
+
+	// How many colors the last Solve packed into blocks, and whether it used the colors from the one before.
+	int GetColorCount() const
+	{
+		return colorStarts.empty() ? 0 : (int)colorStarts.size() - 1;
+	}
+	bool IsColoringReused() const
+	{
+		return coloringReused;
+	}
+
+	// Adds a constraint for every point in a contact's manifold, between objects a and b (the numbers AddBody gave back). Their velocities
+	// get changed by Solve, so that the velocities they'll have once the step's accelerations are added (the ones they'll actually move at)
+	// don't close any contact. dt is the length of the step, which is also what lets points that have just come apart close the gap between
+	// them.
+	void Add(const NarrowphaseContact& contact, int a, int b, float dt);
+
+	// Warm starts, runs the iterations (in each substep) over every constraint added since the last Clear, then writes the velocities and
+	// impulses back.
+	// With a job system, the colors with enough blocks are split between its threads (waiting on them, so this can be called from inside
+	// a job). Then the same object that can't move mustn't be in more than one contact, or two threads could write it at once: add it
+	// again for each one, as PhysicsWorld does.
+	void Solve(JobSystem* inJobs = nullptr);
+};
+
+#endif //_CONTACT_SOLVER_H
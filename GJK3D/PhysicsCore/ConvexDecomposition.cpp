@@ -0,0 +1,583 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ConvexDecomposition.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CONVEX_DECOMPOSITION_CPP
+#define _CONVEX_DECOMPOSITION_CPP
+
+#include "ConvexDecomposition.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+// How many cutting planes are tried along each axis of a piece.
+static const int PLANES_PER_AXIS = 8;
+
+// The voxels of a mesh, and which piece each one is in (-1 for the empty ones).
+struct VoxelGrid
+{
+	glm::vec3 origin;
+	float voxelSize;
+	int size[3];
+
+	std::vector<int> labels;
+
+	int Index(int x, int y, int z) const
+	{
+		return (z * size[1] + y) * size[0] + x;
+	}
+
+	void Coordinates(int index, int& x, int& y, int& z) const
+	{
+		x = index % size[0];
+		y = (index / size[0]) % size[1];
+		z = index / (size[0] * size[1]);
+	}
+
+	int Cell(float value, int axis) const
+	{
+		return glm::clamp((int)floorf((value - origin[axis]) / voxelSize), 0, size[axis] - 1);
+	}
+};
+
+// Where buildVoxelHull puts the hull it builds (and the points it builds it from), kept between calls so they don't reallocate every time.
+struct VoxelHull
+{
+	std::vector<glm::vec3> points;
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+};
+
+// A piece of the mesh: its voxels, and how much its hull reaches past them.
+struct DecompositionPiece
+{
+	std::vector<int> voxels;
+	float concavity;
+};
+
+// Whether the center of a column of voxels (at p in the plane of the other two axes) is inside the triangle a, b, c in that plane, which has
+// to be wound counterclockwise. A point right on an edge counts for only one of the two triangles sharing it, so a ray down a column that
+// goes exactly through an edge is only counted once.
+static bool columnInTriangle(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+{
+	const glm::vec2* corners[3] = { &a, &b, &c };
+
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec2& from = *corners[i];
+		const glm::vec2& to = *corners[(i + 1) % 3];
+		glm::vec2 edge = to - from;
+		float side = edge.x * (p.y - from.y) - edge.y * (p.x - from.x);
+
+		if (side < 0.0f || (side == 0.0f && !(edge.y < 0.0f || (edge.y == 0.0f && edge.x > 0.0f))))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Fills in the voxels of the mesh: every voxel a triangle passes through, and (for each column along x whose ray goes in and out of the
+// mesh evenly, which it does for a closed mesh) every voxel between where it goes in and where it comes back out.
+static void voxelize(const glm::vec3* positions, int numPositions, const unsigned int* indices, int numTriangles, VoxelGrid& grid)
+{
+	std::vector<std::vector<float> > crossings(grid.size[1] * grid.size[2]);
+
+	for (int t = 0; t < numTriangles; t++)
+	{
+		glm::vec3 a = positions[indices[t * 3]];
+		glm::vec3 b = positions[indices[t * 3 + 1]];
+		glm::vec3 c = positions[indices[t * 3 + 2]];
+
+		// The surface: points across the triangle, no more than half a voxel apart.
+		float longest = glm::max(glm::length(b - a), glm::max(glm::length(c - b), glm::length(a - c)));
+		int steps = (int)ceilf(longest / (grid.voxelSize * 0.5f)) + 1;
+
+		for (int i = 0; i <= steps; i++)
+		{
+			for (int j = 0; i + j <= steps; j++)
+			{
+				glm::vec3 point = a + (b - a) * ((float)i / steps) + (c - a) * ((float)j / steps);
+
+				grid.labels[grid.Index(grid.Cell(point.x, 0), grid.Cell(point.y, 1), grid.Cell(point.z, 2))] = 0;
+			}
+		}
+
+		// Where the rays down the columns along x cross the triangle.
+		glm::vec2 a2(a.y, a.z), b2(b.y, b.z), c2(c.y, c.z);
+		float area = (b2.x - a2.x) * (c2.y - a2.y) - (b2.y - a2.y) * (c2.x - a2.x);
+
+		if (area == 0.0f)
+		{
+			continue;
+		}
+
+		if (area < 0.0f)
+		{
+			std::swap(b, c);
+			std::swap(b2, c2);
+			area = -area;
+		}
+
+		int firstY = grid.Cell(glm::min(a.y, glm::min(b.y, c.y)), 1), lastY = grid.Cell(glm::max(a.y, glm::max(b.y, c.y)), 1);
+		int firstZ = grid.Cell(glm::min(a.z, glm::min(b.z, c.z)), 2), lastZ = grid.Cell(glm::max(a.z, glm::max(b.z, c.z)), 2);
+
+		for (int z = firstZ; z <= lastZ; z++)
+		{
+			for (int y = firstY; y <= lastY; y++)
+			{
+				glm::vec2 p(grid.origin.y + (y + 0.5f) * grid.voxelSize, grid.origin.z + (z + 0.5f) * grid.voxelSize);
+
+				if (!columnInTriangle(p, a2, b2, c2))
+				{
+					continue;
+				}
+
+				// How much of b and c there is at p, which gives the x there.
+				float weightB = ((p.x - a2.x) * (c2.y - a2.y) - (p.y - a2.y) * (c2.x - a2.x)) / area;
+				float weightC = ((b2.x - a2.x) * (p.y - a2.y) - (b2.y - a2.y) * (p.x - a2.x)) / area;
+
+				crossings[z * grid.size[1] + y].push_back(a.x + (b.x - a.x) * weightB + (c.x - a.x) * weightC);
+			}
+		}
+	}
+
+	for (int column = 0; column < (int)crossings.size(); column++)
+	{
+		std::vector<float>& xs = crossings[column];
+
+		if (xs.empty() || xs.size() % 2 != 0)
+		{
+			continue;
+		}
+
+		std::sort(xs.begin(), xs.end());
+
+		int y = column % grid.size[1];
+		int z = column / grid.size[1];
+
+		for (int i = 0; i < (int)xs.size(); i += 2)
+		{
+			for (int x = grid.Cell(xs[i], 0); x <= grid.Cell(xs[i + 1], 0); x++)
+			{
+				float center = grid.origin.x + (x + 0.5f) * grid.voxelSize;
+
+				if (center >= xs[i] && center <= xs[i + 1])
+				{
+					grid.labels[grid.Index(x, y, z)] = 0;
+				}
+			}
+		}
+	}
+}
+
+// Builds the hull around some voxels with quickhull, and returns its volume. Only the voxels at either end of each row along x can have
+// corners on the hull (any corner of a voxel between them is on the line between theirs), and only the corners on their outer faces, so
+// those are all that go in.
+static float buildVoxelHull(const VoxelGrid& grid, const std::vector<int>& voxels, VoxelHull& hull)
+{
+	std::vector<glm::vec3>& points = hull.points;
+	std::vector<glm::vec3>& hullPositions = hull.positions;
+	std::vector<unsigned int>& hullIndices = hull.indices;
+
+	int rows = grid.size[1] * grid.size[2];
+	std::vector<int> rowMin(rows, INT_MAX);
+	std::vector<int> rowMax(rows, -1);
+
+	for (int i = 0; i < (int)voxels.size(); i++)
+	{
+		int coordinates[3];
+		grid.Coordinates(voxels[i], coordinates[0], coordinates[1], coordinates[2]);
+
+		int row = coordinates[2] * grid.size[1] + coordinates[1];
+
+		rowMin[row] = glm::min(rowMin[row], coordinates[0]);
+		rowMax[row] = glm::max(rowMax[row], coordinates[0]);
+	}
+
+	points.clear();
+
+	for (int row = 0; row < rows; row++)
+	{
+		if (rowMax[row] == -1)
+		{
+			continue;
+		}
+
+		float y = grid.origin.y + (row % grid.size[1]) * grid.voxelSize;
+		float z = grid.origin.z + (row / grid.size[1]) * grid.voxelSize;
+		float ends[2] = { grid.origin.x + rowMin[row] * grid.voxelSize, grid.origin.x + (rowMax[row] + 1) * grid.voxelSize };
+
+		for (int end = 0; end < 2; end++)
+		{
+			points.push_back(glm::vec3(ends[end], y, z));
+			points.push_back(glm::vec3(ends[end], y + grid.voxelSize, z));
+			points.push_back(glm::vec3(ends[end], y, z + grid.voxelSize));
+			points.push_back(glm::vec3(ends[end], y + grid.voxelSize, z + grid.voxelSize));
+		}
+	}
+
+	hullPositions.clear();
+	hullIndices.clear();
+
+	if (points.empty())
+	{
+		return 0.0f;
+	}
+
+	BuildQuickHull(points.data(), (int)points.size(), hullPositions, hullIndices);
+
+	// The triangles are wound counterclockwise from outside, so each one and the origin make a tetrahedron of positive volume for the parts
+	// of the hull facing away from the origin and negative for the rest, which leaves the hull's volume.
+	float volume = 0.0f;
+
+	for (int i = 0; i + 2 < (int)hullIndices.size(); i += 3)
+	{
+		const glm::vec3& a = hullPositions[hullIndices[i]];
+		const glm::vec3& b = hullPositions[hullIndices[i + 1]];
+		const glm::vec3& c = hullPositions[hullIndices[i + 2]];
+
+		volume += glm::dot(a, glm::cross(b, c));
+	}
+
+	return volume / 6.0f;
+}
+
+// The lowest and highest voxel coordinates of some voxels along each axis.
+static void voxelBounds(const VoxelGrid& grid, const std::vector<int>& voxels, int low[3], int high[3])
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		low[axis] = INT_MAX;
+		high[axis] = -1;
+	}
+
+	for (int i = 0; i < (int)voxels.size(); i++)
+	{
+		int coordinates[3];
+		grid.Coordinates(voxels[i], coordinates[0], coordinates[1], coordinates[2]);
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			low[axis] = glm::min(low[axis], coordinates[axis]);
+			high[axis] = glm::max(high[axis], coordinates[axis]);
+		}
+	}
+}
+
+// Splits some voxels into the ones before the plane between voxels cut - 1 and cut along axis, and the ones after it.
+static void splitVoxels(const VoxelGrid& grid, const std::vector<int>& voxels, int axis, int cut, std::vector<int> halves[2])
+{
+	halves[0].clear();
+	halves[1].clear();
+
+	for (int i = 0; i < (int)voxels.size(); i++)
+	{
+		int coordinates[3];
+		grid.Coordinates(voxels[i], coordinates[0], coordinates[1], coordinates[2]);
+
+		halves[coordinates[axis] < cut ? 0 : 1].push_back(voxels[i]);
+	}
+}
+
+// How much the hulls of the two halves of some voxels (split as in splitVoxels) hold in all, which is what cutting them there is judged on.
+// With lookAhead, each half also gets the best of cutting it in half again across each axis, if that's less. Otherwise a shape like a ring
+// never gets cut the right way: cutting it in half across its middle leaves two hulls that are just as big as cutting it into two thinner
+// rings, but only the first can go on to get a lot smaller.
+static float cutVolume(const VoxelGrid& grid, const std::vector<int>& voxels, int axis, int cut, bool lookAhead, VoxelHull& hull)
+{
+	std::vector<int> halves[2];
+	splitVoxels(grid, voxels, axis, cut, halves);
+
+	float total = 0.0f;
+
+	for (int side = 0; side < 2; side++)
+	{
+		float volume = buildVoxelHull(grid, halves[side], hull);
+
+		if (lookAhead && halves[side].size() > 1)
+		{
+			int low[3], high[3];
+			voxelBounds(grid, halves[side], low, high);
+
+			for (int next = 0; next < 3; next++)
+			{
+				if (high[next] > low[next])
+				{
+					volume = glm::min(volume, cutVolume(grid, halves[side], next, (low[next] + high[next] + 1) / 2, false, hull));
+				}
+			}
+		}
+
+		total += volume;
+	}
+
+	return total;
+}
+
+// Splits voxels (which all have the label from) into the parts that are joined face to face, giving each a label of its own from
+// nextLabel on, and adds them to pieces.
+static void splitConnected(VoxelGrid& grid, const std::vector<int>& voxels, int from, int& nextLabel, std::vector<DecompositionPiece>& pieces)
+{
+	std::vector<int> stack;
+
+	for (int i = 0; i < (int)voxels.size(); i++)
+	{
+		if (grid.labels[voxels[i]] != from)
+		{
+			continue;
+		}
+
+		DecompositionPiece piece;
+		piece.concavity = 0.0f;
+
+		int label = nextLabel++;
+		grid.labels[voxels[i]] = label;
+		stack.push_back(voxels[i]);
+
+		while (!stack.empty())
+		{
+			int voxel = stack.back();
+			stack.pop_back();
+			piece.voxels.push_back(voxel);
+
+			int coordinates[3];
+			grid.Coordinates(voxel, coordinates[0], coordinates[1], coordinates[2]);
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				for (int step = -1; step <= 1; step += 2)
+				{
+					int neighbor[3] = { coordinates[0], coordinates[1], coordinates[2] };
+					neighbor[axis] += step;
+
+					if (neighbor[axis] < 0 || neighbor[axis] >= grid.size[axis])
+					{
+						continue;
+					}
+
+					int index = grid.Index(neighbor[0], neighbor[1], neighbor[2]);
+
+					if (grid.labels[index] == from)
+					{
+						grid.labels[index] = label;
+						stack.push_back(index);
+					}
+				}
+			}
+		}
+
+		// Keep the voxels in grid order, so the piece comes out the same however the flood fill went.
+		std::sort(piece.voxels.begin(), piece.voxels.end());
+		pieces.push_back(piece);
+	}
+}
+
+void DecomposeMesh(const glm::vec3* positions, int numPositions, const unsigned int* indices, int numIndices, const DecompositionSettings& settings,
+	std::vector<ConvexHull>& hulls)
+{
+	hulls.clear();
+
+	// Only whole triangles with every index in range.
+	std::vector<unsigned int> triangles;
+
+	for (int i = 0; i + 2 < numIndices; i += 3)
+	{
+		if (indices[i] < (unsigned int)numPositions && indices[i + 1] < (unsigned int)numPositions && indices[i + 2] < (unsigned int)numPositions)
+		{
+			triangles.insert(triangles.end(), indices + i, indices + i + 3);
+		}
+	}
+
+	if (triangles.empty())
+	{
+		return;
+	}
+
+	glm::vec3 min = positions[triangles[0]];
+	glm::vec3 max = min;
+
+	for (int i = 1; i < (int)triangles.size(); i++)
+	{
+		min = glm::min(min, positions[triangles[i]]);
+		max = glm::max(max, positions[triangles[i]]);
+	}
+
+	glm::vec3 extent = max - min;
+	float longest = glm::max(extent.x, glm::max(extent.y, extent.z));
+	int resolution = glm::max(settings.resolution, 1);
+
+	VoxelGrid grid;
+	grid.origin = min;
+	grid.voxelSize = longest > 0.0f ? longest / resolution : 1.0f;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		grid.size[axis] = glm::clamp((int)ceilf(extent[axis] / grid.voxelSize), 1, resolution);
+	}
+
+	grid.labels.assign(grid.size[0] * grid.size[1] * grid.size[2], -1);
+
+	voxelize(positions, numPositions, triangles.data(), (int)triangles.size() / 3, grid);
+
+	std::vector<int> filled;
+
+	for (int i = 0; i < (int)grid.labels.size(); i++)
+	{
+		if (grid.labels[i] == 0)
+		{
+			filled.push_back(i);
+		}
+	}
+
+	// The labels start at 1, after the 0 everything was filled in with.
+	int nextLabel = 1;
+	std::vector<DecompositionPiece> pieces;
+	splitConnected(grid, filled, 0, nextLabel, pieces);
+
+	float voxelVolume = grid.voxelSize * grid.voxelSize * grid.voxelSize;
+	float totalVolume = filled.size() * voxelVolume;
+
+	VoxelHull hull;
+
+	for (int i = 0; i < (int)pieces.size(); i++)
+	{
+		float volume = buildVoxelHull(grid, pieces[i].voxels, hull);
+		pieces[i].concavity = (volume - pieces[i].voxels.size() * voxelVolume) / totalVolume;
+	}
+
+	while ((int)pieces.size() < settings.maxHulls)
+	{
+		// Split whichever piece is furthest from convex, as long as any is too far.
+		int worst = -1;
+
+		for (int i = 0; i < (int)pieces.size(); i++)
+		{
+			if (pieces[i].concavity > settings.concavity && pieces[i].voxels.size() > 1 && (worst == -1 || pieces[i].concavity > pieces[worst].concavity))
+			{
+				worst = i;
+			}
+		}
+
+		if (worst == -1)
+		{
+			break;
+		}
+
+		DecompositionPiece piece = pieces[worst];
+		pieces.erase(pieces.begin() + worst);
+
+		int low[3], high[3];
+		voxelBounds(grid, piece.voxels, low, high);
+
+		// Try planes spread evenly across each axis the piece is more than one voxel thick along, and keep whichever leaves the two halves
+		// (or the pieces they could be cut into next) reaching the least past their voxels in all.
+		int bestAxis = -1, bestCut = 0;
+		float bestCost = 0.0f;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			int span = high[axis] - low[axis];
+
+			int planes = glm::min(span, PLANES_PER_AXIS);
+
+			// The cuts go between voxels, from just past the first (low + 1) to just before the last (high).
+			for (int plane = 0; plane < planes; plane++)
+			{
+				int cut = low[axis] + 1 + (planes > 1 ? (span - 1) * plane / (planes - 1) : 0);
+
+				float cost = cutVolume(grid, piece.voxels, axis, cut, true, hull);
+
+				if (bestAxis == -1 || cost < bestCost)
+				{
+					bestAxis = axis;
+					bestCut = cut;
+					bestCost = cost;
+				}
+			}
+		}
+
+		// A piece that's one voxel thick every way can't be cut. (It's one voxel, which was ruled out above, but just in case.)
+		if (bestAxis == -1)
+		{
+			piece.concavity = 0.0f;
+			pieces.push_back(piece);
+			continue;
+		}
+
+		// Give each half a label of its own, then split each into its joined parts.
+		int sides[2] = { nextLabel, nextLabel + 1 };
+		nextLabel += 2;
+
+		for (int i = 0; i < (int)piece.voxels.size(); i++)
+		{
+			int coordinates[3];
+			grid.Coordinates(piece.voxels[i], coordinates[0], coordinates[1], coordinates[2]);
+
+			grid.labels[piece.voxels[i]] = sides[coordinates[bestAxis] < bestCut ? 0 : 1];
+		}
+
+		int firstNew = (int)pieces.size();
+
+		splitConnected(grid, piece.voxels, sides[0], nextLabel, pieces);
+		splitConnected(grid, piece.voxels, sides[1], nextLabel, pieces);
+
+		for (int i = firstNew; i < (int)pieces.size(); i++)
+		{
+			float volume = buildVoxelHull(grid, pieces[i].voxels, hull);
+			pieces[i].concavity = (volume - pieces[i].voxels.size() * voxelVolume) / totalVolume;
+		}
+	}
+
+	for (int i = 0; i < (int)pieces.size(); i++)
+	{
+		buildVoxelHull(grid, pieces[i].voxels, hull);
+
+		ConvexHull piece(hull.positions.data(), (int)hull.positions.size(), hull.indices.data(), (int)hull.indices.size());
+
+		hulls.push_back(settings.maxVertices > 0 ? ConvexHull::Simplify(piece, settings.maxVertices) : piece);
+	}
+}
+
+void AddHullsToCompound(const std::vector<ConvexHull>& hulls, CompoundShape& compound)
+{
+	for (int i = 0; i < (int)hulls.size(); i++)
+	{
+		compound.AddChild(ConvexShape(HullShape(hulls[i].Points(), hulls[i].NumPoints())));
+	}
+}
+
+#endif //_CONVEX_DECOMPOSITION_CPP
@@ -0,0 +1,83 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ConvexDecomposition.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CONVEX_DECOMPOSITION_H
+#define _CONVEX_DECOMPOSITION_H
+
+#include "CompoundShape.h"
+#include "ConvexHull.h"
+#include <vector>
+
+// How finely DecomposeMesh works, and when it stops.
+struct DecompositionSettings
+{
+	// How many voxels the mesh is cut into along its longest side. More follows the mesh more closely, for (a lot) more time.
+	int resolution;
+
+	// How much a piece's hull can reach past the voxels it's around, as a fraction of the whole mesh's volume, before the piece gets split.
+	float concavity;
+
+	// Pieces stop being split once there are this many. (Splitting a piece can leave it in several parts that aren't joined, and each of
+	// those becomes a piece of its own, so there can end up being a few more.)
+	int maxHulls;
+
+	// Each piece's hull is simplified to no more than this many vertices (see ConvexHull::Simplify), or left as it is if this is 0.
+	int maxVertices;
+
+	DecompositionSettings()
+	{
+		resolution = 32;
+		concavity = 0.01f;
+		maxHulls = 16;
+		maxVertices = 32;
+	}
+};
+
+// Splits a mesh that isn't convex (like a Model's, or a SceneModel's) into convex pieces, each of which GJK can handle on its own, so an
+// object shaped like a chair or a mug can be a CompoundShape of a few small hulls rather than one huge hull that fills in all its gaps
+// (and has hundreds of points for every support call to go over).
+// This is in the spirit of V-HACD: the mesh is filled with voxels (the triangles themselves, and everything between them, for a closed
+// mesh), and then the piece whose hull is furthest from fitting its voxels is cut in two, at whichever plane across each axis leaves the
+// two halves fitting their hulls best, over and over until every piece fits its hull well enough.
+// It takes a while (seconds for a detailed mesh), so it's meant for when meshes are loaded: see HullCache::GetDecomposition, which only
+// does it once. Each hull is around whole voxels, so it can stand up to a voxel further out than the mesh does.
+void DecomposeMesh(const glm::vec3* positions, int numPositions, const unsigned int* indices, int numIndices, const DecompositionSettings& settings,
+	std::vector<ConvexHull>& hulls);
+
+// Adds each hull to compound as a child (without building it). The hulls' points are copied, so the hulls don't have to stay around.
+void AddHullsToCompound(const std::vector<ConvexHull>& hulls, CompoundShape& compound);
+
+#endif //_CONVEX_DECOMPOSITION_H
@@ -0,0 +1,844 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ConvexHull.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CONVEX_HULL_CPP
+#define _CONVEX_HULL_CPP
+
+#include "ConvexHull.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+ConvexHull::ConvexHull(const glm::vec3* positions, int numPositions, const unsigned int* indices, int numIndices, std::vector<int>* mapping)
+{
+	// First merge positions that are exactly the same, so that each corner of the hull is only one vertex in the graph. Sorting them brings
+	// the copies of each position together (the stable sort keeps them in order, so the first one is what the rest merge into), and then
+	// the hull vertices are numbered in the order they first appear.
+	std::vector<int> order(numPositions);
+	std::vector<int> first(numPositions);
+	std::vector<int> hullIndex(numPositions, -1);
+
+	for (int i = 0; i < numPositions; i++)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [positions](int a, int b)
+	{
+		const glm::vec3& p = positions[a];
+		const glm::vec3& q = positions[b];
+
+		return p.x < q.x || (p.x == q.x && (p.y < q.y || (p.y == q.y && p.z < q.z)));
+	});
+
+	for (int i = 0; i < numPositions; i++)
+	{
+		first[order[i]] = (i > 0 && positions[order[i]] == positions[order[i - 1]]) ? first[order[i - 1]] : order[i];
+	}
+
+	for (int i = 0; i < numPositions; i++)
+	{
+		if (first[i] == i)
+		{
+			hullIndex[i] = (int)points.size();
+			points.push_back(positions[i]);
+		}
+		else
+		{
+			hullIndex[i] = hullIndex[first[i]];
+		}
+	}
+
+	// Then gather every edge of every triangle, in both directions. We store each edge as a (from, to) pair so we can sort them.
+	std::vector<std::pair<int, int> > edges;
+	edges.reserve(numIndices * 2);
+
+	for (int i = 0; i + 2 < numIndices; i += 3)
+	{
+		int corners[3] = { hullIndex[indices[i]], hullIndex[indices[i + 1]], hullIndex[indices[i + 2]] };
+
+		for (int e = 0; e < 3; e++)
+		{
+			int from = corners[e];
+			int to = corners[(e + 1) % 3];
+
+			if (from != to)
+			{
+				edges.push_back(std::make_pair(from, to));
+				edges.push_back(std::make_pair(to, from));
+			}
+		}
+	}
+
+	// Sorting groups all of the edges leaving each vertex together, and puts duplicates (edges shared by two triangles) side by side so we can drop them.
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+	// Now the sorted edges are already in the order we want, we just need to know where each vertex's run of neighbors starts.
+	neighborStart.assign(points.size() + 1, 0);
+	neighbors.resize(edges.size());
+
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		neighborStart[edges[i].first + 1]++;
+		neighbors[i] = edges[i].second;
+	}
+
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		neighborStart[i + 1] += neighborStart[i];
+	}
+
+	if (mapping != nullptr)
+	{
+		*mapping = hullIndex;
+	}
+}
+
+ConvexHull::ConvexHull(const glm::vec3* hullPoints, int numPoints, const int* hullNeighborStart, const int* hullNeighbors)
+{
+	points.assign(hullPoints, hullPoints + numPoints);
+	neighborStart.assign(hullNeighborStart, hullNeighborStart + numPoints + 1);
+	neighbors.assign(hullNeighbors, hullNeighbors + neighborStart[numPoints]);
+}
+
+ConvexHull ConvexHull::FromPoints(const glm::vec3* positions, int numPositions)
+{
+	std::vector<glm::vec3> hullPositions;
+	std::vector<unsigned int> hullIndices;
+
+	BuildQuickHull(positions, numPositions, hullPositions, hullIndices);
+
+	return ConvexHull(hullPositions.data(), (int)hullPositions.size(), hullIndices.data(), (int)hullIndices.size());
+}
+
+// The planes of the faces of a hull built by BuildQuickHull (normalized, pointing out), skipping any faces too thin to have one.
+static void getFacePlanes(const std::vector<glm::vec3>& hullPositions, const std::vector<unsigned int>& hullIndices, std::vector<glm::vec4>& planes)
+{
+	planes.clear();
+
+	for (int i = 0; i + 2 < (int)hullIndices.size(); i += 3)
+	{
+		const glm::vec3& a = hullPositions[hullIndices[i]];
+		glm::vec3 normal = glm::cross(hullPositions[hullIndices[i + 1]] - a, hullPositions[hullIndices[i + 2]] - a);
+		float length = glm::length(normal);
+
+		if (length > 0.0f)
+		{
+			normal /= length;
+			planes.push_back(glm::vec4(normal, glm::dot(normal, a)));
+		}
+	}
+}
+
+ConvexHull ConvexHull::Simplify(const ConvexHull& hull, int maxVertices, float* enlargement)
+{
+	if (enlargement != nullptr)
+	{
+		*enlargement = 0.0f;
+	}
+
+	int numPoints = hull.NumPoints();
+	const glm::vec3* points = hull.Points();
+
+	if (numPoints <= maxVertices || maxVertices < 4)
+	{
+		return hull;
+	}
+
+	// Start from the biggest tetrahedron we can easily find, the same way quickhull does: the vertex with the lowest x, the vertex farthest
+	// from that, the one farthest from the line between them, and the one farthest from the plane through all three.
+	int corners[4] = { 0, 0, 0, 0 };
+
+	for (int i = 1; i < numPoints; i++)
+	{
+		if (points[i].x < points[corners[0]].x)
+		{
+			corners[0] = i;
+		}
+	}
+
+	float best = 0.0f;
+
+	for (int i = 0; i < numPoints; i++)
+	{
+		float dist = glm::length(points[i] - points[corners[0]]);
+
+		if (dist > best)
+		{
+			corners[1] = i;
+			best = dist;
+		}
+	}
+
+	best = 0.0f;
+
+	for (int i = 0; i < numPoints; i++)
+	{
+		float dist = glm::length(glm::cross(points[i] - points[corners[0]], points[corners[1]] - points[corners[0]]));
+
+		if (dist > best)
+		{
+			corners[2] = i;
+			best = dist;
+		}
+	}
+
+	glm::vec3 normal = glm::cross(points[corners[1]] - points[corners[0]], points[corners[2]] - points[corners[0]]);
+	best = 0.0f;
+
+	for (int i = 0; i < numPoints; i++)
+	{
+		float dist = fabsf(glm::dot(points[i] - points[corners[0]], normal));
+
+		if (dist > best)
+		{
+			corners[3] = i;
+			best = dist;
+		}
+	}
+
+	// A flat hull (or a line, or a point) has nothing to scale up about.
+	float extent = glm::length(points[corners[1]] - points[corners[0]]);
+
+	if (best <= 1e-6f * extent * extent * extent)
+	{
+		return hull;
+	}
+
+	std::vector<bool> picked(numPoints, false);
+	std::vector<glm::vec3> chosen;
+
+	for (int i = 0; i < 4; i++)
+	{
+		picked[corners[i]] = true;
+		chosen.push_back(points[corners[i]]);
+	}
+
+	std::vector<glm::vec3> hullPositions;
+	std::vector<unsigned int> hullIndices;
+	std::vector<glm::vec4> planes;
+
+	BuildQuickHull(chosen.data(), (int)chosen.size(), hullPositions, hullIndices);
+
+	while ((int)chosen.size() < maxVertices)
+	{
+		getFacePlanes(hullPositions, hullIndices, planes);
+
+		// How far outside a point is is how far it is past the face it's furthest past.
+		int farthest = -1;
+		float farthestDist = 0.0f;
+
+		for (int i = 0; i < numPoints; i++)
+		{
+			if (picked[i])
+			{
+				continue;
+			}
+
+			float dist = -FLT_MAX;
+
+			for (int f = 0; f < (int)planes.size(); f++)
+			{
+				dist = glm::max(dist, glm::dot(glm::vec3(planes[f]), points[i]) - planes[f].w);
+			}
+
+			if (dist > farthestDist)
+			{
+				farthest = i;
+				farthestDist = dist;
+			}
+		}
+
+		// Everything left is inside already.
+		if (farthest == -1)
+		{
+			break;
+		}
+
+		picked[farthest] = true;
+		chosen.push_back(points[farthest]);
+
+		BuildQuickHull(chosen.data(), (int)chosen.size(), hullPositions, hullIndices);
+	}
+
+	// Scaling by s about center moves each face out to s times as far from center as it was, so s has to be big enough that every
+	// vertex is no further past center along each face's normal than that.
+	glm::vec3 center = glm::vec3(0.0f);
+
+	for (int i = 0; i < (int)hullPositions.size(); i++)
+	{
+		center += hullPositions[i];
+	}
+
+	center /= (float)hullPositions.size();
+
+	getFacePlanes(hullPositions, hullIndices, planes);
+
+	float scale = 1.0f;
+
+	for (int f = 0; f < (int)planes.size(); f++)
+	{
+		glm::vec3 faceNormal = glm::vec3(planes[f]);
+		float height = planes[f].w - glm::dot(faceNormal, center);
+
+		if (height <= 0.0f)
+		{
+			return hull;
+		}
+
+		for (int i = 0; i < numPoints; i++)
+		{
+			float needed = glm::dot(faceNormal, points[i] - center) / height;
+
+			if (needed > scale)
+			{
+				scale = needed;
+			}
+		}
+	}
+
+	// Every point of the smaller hull is inside the original, and moves out by scale - 1 times its distance from center, so the vertex
+	// furthest from center moves the furthest.
+	float growth = 0.0f;
+
+	for (int i = 0; i < (int)hullPositions.size(); i++)
+	{
+		growth = glm::max(growth, (scale - 1.0f) * glm::length(hullPositions[i] - center));
+		hullPositions[i] = center + (hullPositions[i] - center) * scale;
+	}
+
+	if (enlargement != nullptr)
+	{
+		*enlargement = growth;
+	}
+
+	return ConvexHull(hullPositions.data(), (int)hullPositions.size(), hullIndices.data(), (int)hullIndices.size());
+}
+
+int ConvexHull::FindFarthestVertex(const glm::vec3* worldPoints, const glm::vec3& dir, int start) const
+{
+	int current = (start >= 0 && start < NumPoints()) ? start : 0;
+	float currentDist = glm::dot(worldPoints[current], dir);
+
+	// Keep moving to a better neighbor until there isn't one. Every move strictly increases the distance, so this can't loop forever.
+	bool improved = true;
+
+	while (improved)
+	{
+		improved = false;
+
+		const int* adjacent = Neighbors(current);
+		int count = NumNeighbors(current);
+
+		for (int i = 0; i < count; i++)
+		{
+			float dist = glm::dot(worldPoints[adjacent[i]], dir);
+
+			if (dist > currentDist)
+			{
+				current = adjacent[i];
+				currentDist = dist;
+				improved = true;
+				break;
+			}
+		}
+	}
+
+	return current;
+}
+
+// A triangle of the hull while quickhull is building it. Edge e goes from v[e] to v[(e + 1) % 3], and adjacent[e] is the face on the
+// other side of it.
+struct QuickHullFace
+{
+	int v[3];
+	int adjacent[3];
+	glm::vec3 normal;
+	float offset;
+
+	// The points still left that are in front of this face (and so outside the hull so far), and the farthest of them.
+	std::vector<int> outside;
+	int farthest;
+	float farthestDistance;
+
+	bool deleted;
+
+	float Distance(const glm::vec3& point) const
+	{
+		return glm::dot(normal, point) - offset;
+	}
+};
+
+class QuickHull
+{
+	const glm::vec3* positions;
+	float epsilon;
+
+	std::vector<QuickHullFace> faces;
+
+	// The edges around the faces the current point can see, in order, each with the face it can't see on the other side.
+	struct HorizonEdge
+	{
+		int from;
+		int to;
+		int face;
+	};
+	std::vector<HorizonEdge> horizon;
+	std::vector<int> visible;
+	std::vector<int> orphans;
+
+	int addFace(int a, int b, int c)
+	{
+		QuickHullFace face;
+		face.v[0] = a;
+		face.v[1] = b;
+		face.v[2] = c;
+		face.adjacent[0] = face.adjacent[1] = face.adjacent[2] = -1;
+
+		glm::vec3 normal = glm::cross(positions[b] - positions[a], positions[c] - positions[a]);
+		float length = glm::length(normal);
+
+		face.normal = length > 0.0f ? normal / length : glm::vec3(0.0f);
+		face.offset = glm::dot(face.normal, (positions[a] + positions[b] + positions[c]) / 3.0f);
+		face.farthest = -1;
+		face.farthestDistance = 0.0f;
+		face.deleted = false;
+
+		faces.push_back(face);
+
+		return (int)faces.size() - 1;
+	}
+
+	// Gives a point to the first face it's outside of, or drops it if it's inside them all.
+	void assign(int point, const int* candidates, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			QuickHullFace& face = faces[candidates[i]];
+			float distance = face.Distance(positions[point]);
+
+			if (distance > epsilon)
+			{
+				face.outside.push_back(point);
+
+				if (distance > face.farthestDistance)
+				{
+					face.farthest = point;
+					face.farthestDistance = distance;
+				}
+
+				return;
+			}
+		}
+	}
+
+	int edgeTo(int face, int neighbor) const
+	{
+		for (int e = 0; e < 3; e++)
+		{
+			if (faces[face].adjacent[e] == neighbor)
+			{
+				return e;
+			}
+		}
+
+		return -1;
+	}
+
+	// Deletes every face the eye can see, starting from one it can, and collects the horizon: the edges between the faces it can see and
+	// the ones it can't. Each face's edges are visited starting just after the one we came in by, which keeps the horizon in order around
+	// the eye (the usual depth first walk from quickhull).
+	void findHorizon(const glm::vec3& eye, int face, int entered)
+	{
+		faces[face].deleted = true;
+		visible.push_back(face);
+
+		for (int i = (entered == -1 ? 0 : 1); i < 3; i++)
+		{
+			int e = entered == -1 ? i : (entered + i) % 3;
+			int neighbor = faces[face].adjacent[e];
+
+			if (faces[neighbor].deleted)
+			{
+				continue;
+			}
+
+			if (faces[neighbor].Distance(eye) > epsilon)
+			{
+				findHorizon(eye, neighbor, edgeTo(neighbor, face));
+			}
+			else
+			{
+				HorizonEdge edge;
+				edge.from = faces[face].v[e];
+				edge.to = faces[face].v[(e + 1) % 3];
+				edge.face = neighbor;
+				horizon.push_back(edge);
+			}
+		}
+	}
+
+	// Adds the farthest point outside a face to the hull.
+	void addPoint(int start)
+	{
+		int eye = faces[start].farthest;
+		const glm::vec3& eyePosition = positions[eye];
+
+		horizon.clear();
+		visible.clear();
+
+		findHorizon(eyePosition, start, -1);
+
+		// A fan of new faces from the horizon to the eye, each one joined to the face across its horizon edge and to the new faces either side.
+		int first = (int)faces.size();
+		int count = (int)horizon.size();
+
+		for (int i = 0; i < count; i++)
+		{
+			int face = addFace(horizon[i].from, horizon[i].to, eye);
+			int across = horizon[i].face;
+
+			faces[face].adjacent[0] = across;
+			faces[face].adjacent[1] = first + (i + 1) % count;
+			faces[face].adjacent[2] = first + (i + count - 1) % count;
+
+			for (int e = 0; e < 3; e++)
+			{
+				if (faces[across].v[e] == horizon[i].to && faces[across].v[(e + 1) % 3] == horizon[i].from)
+				{
+					faces[across].adjacent[e] = face;
+				}
+			}
+		}
+
+		// The points that were outside the faces that are gone now go to whichever new face they're outside of (or nowhere, if the hull now
+		// covers them).
+		orphans.clear();
+
+		for (int i = 0; i < (int)visible.size(); i++)
+		{
+			std::vector<int>& outside = faces[visible[i]].outside;
+
+			for (int j = 0; j < (int)outside.size(); j++)
+			{
+				if (outside[j] != eye)
+				{
+					orphans.push_back(outside[j]);
+				}
+			}
+
+			std::vector<int>().swap(outside);
+		}
+
+		std::vector<int> newFaces(count);
+
+		for (int i = 0; i < count; i++)
+		{
+			newFaces[i] = first + i;
+		}
+
+		for (int i = 0; i < (int)orphans.size(); i++)
+		{
+			assign(orphans[i], newFaces.data(), count);
+		}
+	}
+
+public:
+	QuickHull(const glm::vec3* inPositions, int numPositions)
+	{
+		positions = inPositions;
+
+		// How far off a plane a point can be before it counts as being on one side of it, which has to grow with the size of the numbers.
+		glm::vec3 largest(0.0f);
+
+		for (int i = 0; i < numPositions; i++)
+		{
+			largest = glm::max(largest, glm::abs(positions[i]));
+		}
+
+		epsilon = 3.0f * FLT_EPSILON * (largest.x + largest.y + largest.z);
+	}
+
+	float GetEpsilon() const
+	{
+		return epsilon;
+	}
+
+	// Builds the hull from a tetrahedron of four of the points to start with.
+	void Build(const int* tetrahedron, int numPositions, std::vector<glm::vec3>& hullPositions, std::vector<unsigned int>& hullIndices)
+	{
+		int a = tetrahedron[0];
+		int b = tetrahedron[1];
+		int c = tetrahedron[2];
+		int d = tetrahedron[3];
+
+		// Wind the base so that it faces away from d, and so do the sides.
+		if (glm::dot(glm::cross(positions[b] - positions[a], positions[c] - positions[a]), positions[d] - positions[a]) > 0.0f)
+		{
+			std::swap(b, c);
+		}
+
+		int base = addFace(a, b, c);
+		int sideAB = addFace(a, d, b);
+		int sideBC = addFace(b, d, c);
+		int sideCA = addFace(c, d, a);
+
+		int adjacency[4][3] = { { sideAB, sideBC, sideCA }, { sideCA, sideBC, base }, { sideAB, sideCA, base }, { sideBC, sideAB, base } };
+
+		for (int i = 0; i < 4; i++)
+		{
+			for (int e = 0; e < 3; e++)
+			{
+				faces[i].adjacent[e] = adjacency[i][e];
+			}
+		}
+
+		int all[4] = { base, sideAB, sideBC, sideCA };
+
+		for (int i = 0; i < numPositions; i++)
+		{
+			if (i != a && i != b && i != c && i != d)
+			{
+				assign(i, all, 4);
+			}
+		}
+
+		// Keep adding the farthest point outside any face, until there aren't any.
+		for (int i = 0; i < (int)faces.size(); i++)
+		{
+			while (!faces[i].deleted && !faces[i].outside.empty())
+			{
+				addPoint(i);
+			}
+		}
+
+		// Only the points that are corners of faces that are left are on the hull.
+		std::vector<int> hullIndex(numPositions, -1);
+
+		for (int i = 0; i < (int)faces.size(); i++)
+		{
+			if (faces[i].deleted)
+			{
+				continue;
+			}
+
+			for (int j = 0; j < 3; j++)
+			{
+				int point = faces[i].v[j];
+
+				if (hullIndex[point] == -1)
+				{
+					hullIndex[point] = (int)hullPositions.size();
+					hullPositions.push_back(positions[point]);
+				}
+
+				hullIndices.push_back(hullIndex[point]);
+			}
+		}
+	}
+};
+
+// The point farthest from a line (or -1 if they're all on it, give or take epsilon).
+static int farthestFromLine(const glm::vec3* positions, int numPositions, const glm::vec3& from, const glm::vec3& to, float epsilon)
+{
+	glm::vec3 direction = glm::normalize(to - from);
+	int farthest = -1;
+	float farthestDistance = epsilon;
+
+	for (int i = 0; i < numPositions; i++)
+	{
+		glm::vec3 offset = positions[i] - from;
+		float distance = glm::length(offset - direction * glm::dot(offset, direction));
+
+		if (distance > farthestDistance)
+		{
+			farthest = i;
+			farthestDistance = distance;
+		}
+	}
+
+	return farthest;
+}
+
+// The hull of points that are all in one plane (with the given normal): Andrew's monotone chain, on the points projected onto the plane.
+static void buildFlatHull(const glm::vec3* positions, int numPositions, const glm::vec3& normal, std::vector<glm::vec3>& hullPositions,
+	std::vector<unsigned int>& hullIndices)
+{
+	glm::vec3 u = glm::normalize(glm::abs(normal.x) > 0.5f ? glm::cross(normal, glm::vec3(0.0f, 1.0f, 0.0f)) : glm::cross(normal, glm::vec3(1.0f, 0.0f, 0.0f)));
+	glm::vec3 v = glm::cross(normal, u);
+
+	std::vector<std::pair<glm::vec2, int> > projected(numPositions);
+
+	for (int i = 0; i < numPositions; i++)
+	{
+		projected[i] = std::make_pair(glm::vec2(glm::dot(positions[i], u), glm::dot(positions[i], v)), i);
+	}
+
+	std::sort(projected.begin(), projected.end(), [](const std::pair<glm::vec2, int>& a, const std::pair<glm::vec2, int>& b)
+	{
+		return a.first.x < b.first.x || (a.first.x == b.first.x && a.first.y < b.first.y);
+	});
+
+	// Only strict left turns are kept, so points along an edge of the polygon are left out.
+	auto turn = [](const glm::vec2& o, const glm::vec2& a, const glm::vec2& b)
+	{
+		return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+	};
+
+	std::vector<int> chain(2 * numPositions);
+	int count = 0;
+
+	for (int i = 0; i < numPositions; i++)
+	{
+		while (count >= 2 && turn(projected[chain[count - 2]].first, projected[chain[count - 1]].first, projected[i].first) <= 0.0f)
+		{
+			count--;
+		}
+
+		chain[count++] = i;
+	}
+
+	for (int i = numPositions - 2, lower = count + 1; i >= 0; i--)
+	{
+		while (count >= lower && turn(projected[chain[count - 2]].first, projected[chain[count - 1]].first, projected[i].first) <= 0.0f)
+		{
+			count--;
+		}
+
+		chain[count++] = i;
+	}
+
+	// The last point is the first one again.
+	count--;
+
+	for (int i = 0; i < count; i++)
+	{
+		hullPositions.push_back(positions[projected[chain[i]].second]);
+	}
+
+	for (int i = 1; i + 1 < count; i++)
+	{
+		hullIndices.push_back(0);
+		hullIndices.push_back(i);
+		hullIndices.push_back(i + 1);
+	}
+}
+
+void BuildQuickHull(const glm::vec3* positions, int numPositions, std::vector<glm::vec3>& hullPositions, std::vector<unsigned int>& hullIndices)
+{
+	hullPositions.clear();
+	hullIndices.clear();
+
+	if (numPositions <= 0)
+	{
+		return;
+	}
+
+	QuickHull quickHull(positions, numPositions);
+	float epsilon = quickHull.GetEpsilon();
+
+	// Start from the two points farthest apart along any axis...
+	int tetrahedron[4] = { 0, 0, -1, -1 };
+	float widest = -1.0f;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		int min = 0;
+		int max = 0;
+
+		for (int i = 1; i < numPositions; i++)
+		{
+			min = positions[i][axis] < positions[min][axis] ? i : min;
+			max = positions[i][axis] > positions[max][axis] ? i : max;
+		}
+
+		if (positions[max][axis] - positions[min][axis] > widest)
+		{
+			widest = positions[max][axis] - positions[min][axis];
+			tetrahedron[0] = min;
+			tetrahedron[1] = max;
+		}
+	}
+
+	if (widest <= epsilon)
+	{
+		hullPositions.push_back(positions[tetrahedron[0]]);
+		hullIndices.assign(3, 0);
+		return;
+	}
+
+	// ...then the one farthest from the line through them...
+	const glm::vec3& a = positions[tetrahedron[0]];
+	const glm::vec3& b = positions[tetrahedron[1]];
+
+	tetrahedron[2] = farthestFromLine(positions, numPositions, a, b, epsilon);
+
+	if (tetrahedron[2] == -1)
+	{
+		hullPositions.push_back(a);
+		hullPositions.push_back(b);
+		hullIndices.push_back(0);
+		hullIndices.push_back(1);
+		hullIndices.push_back(1);
+		return;
+	}
+
+	// ...and the one farthest from the plane through all three.
+	glm::vec3 normal = glm::normalize(glm::cross(b - a, positions[tetrahedron[2]] - a));
+	float farthestDistance = epsilon;
+
+	for (int i = 0; i < numPositions; i++)
+	{
+		float distance = glm::abs(glm::dot(positions[i] - a, normal));
+
+		if (distance > farthestDistance)
+		{
+			tetrahedron[3] = i;
+			farthestDistance = distance;
+		}
+	}
+
+	if (tetrahedron[3] == -1)
+	{
+		buildFlatHull(positions, numPositions, normal, hullPositions, hullIndices);
+		return;
+	}
+
+	quickHull.Build(tetrahedron, numPositions, hullPositions, hullIndices);
+}
+
+#endif // _CONVEX_HULL_CPP
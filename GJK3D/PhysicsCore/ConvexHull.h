@@ -0,0 +1,180 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ConvexHull.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _CONVEX_HULL_H
+#define _CONVEX_HULL_H
+
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include <vector>
+
+// A convex hull that knows which of its vertices are connected by an edge.
+// With that, the farthest vertex in a direction can be found by "hill-climbing": start at any vertex, and keep moving to whichever
+// neighbor is farther along the direction until none of them are. Because the hull is convex, the vertex we stop at is the farthest
+// one overall. If we start from the answer to the last query (which barely changes while things move slowly), we usually only
+// have to look at a handful of neighbors, instead of every vertex like getFarthestPointInDirection(HullShape) does.
+class ConvexHull
+{
+	// The unique vertex positions of the hull, in local space.
+	std::vector<glm::vec3> points;
+
+	// The neighbors of vertex i are neighbors[neighborStart[i]] up to (but not including) neighbors[neighborStart[i + 1]].
+	// Storing them all in one array like this keeps the whole graph in two allocations.
+	std::vector<int> neighborStart;
+	std::vector<int> neighbors;
+
+public:
+	// An empty hull, to be built or loaded later.
+	ConvexHull()
+	{
+		neighborStart.push_back(0);
+	}
+
+	// Builds the hull from a triangle mesh of its surface (such as a Model's vertices and indices).
+	// Vertices that share a position (like the same corner with different colors) are merged into one hull vertex.
+	// mapping (if given) gets filled with the hull vertex each of the given positions ended up as.
+	ConvexHull(const glm::vec3* positions, int numPositions, const unsigned int* indices, int numIndices, std::vector<int>* mapping = nullptr);
+
+	// Puts back a hull exactly as it was, from what Points, NeighborStarts and Neighbors(0) gave (see HullCache).
+	// neighborStart has numPoints + 1 entries, and the last one is how many neighbors there are in all.
+	ConvexHull(const glm::vec3* hullPoints, int numPoints, const int* hullNeighborStart, const int* hullNeighbors);
+
+	// Builds the hull around any cloud of points (such as all of an imported mesh's vertices, which needn't be convex), with quickhull.
+	static ConvexHull FromPoints(const glm::vec3* positions, int numPositions);
+
+	// A hull with no more than maxVertices vertices that the whole of hull fits inside, for a support function that costs less. (Searching
+	// every vertex, like getFarthestPointInDirection(HullShape) does, costs as much as there are vertices, so capping every hull at something
+	// like 32 caps what one support call can cost.)
+	// The vertices are picked one at a time, each time the one furthest outside the hull of those picked so far, and then the hull of them
+	// is scaled up about its middle just enough to take in every vertex it left out. enlargement (if given) is set to the furthest that
+	// scaling moved any vertex, which is as far as any point of the new hull can be from the old one.
+	// A hull that already fits, or is flat, is given back as it is, and maxVertices can't be less than 4.
+	static ConvexHull Simplify(const ConvexHull& hull, int maxVertices, float* enlargement = nullptr);
+
+	int NumPoints() const
+	{
+		return (int)points.size();
+	}
+	const glm::vec3* Points() const
+	{
+		return points.data();
+	}
+	int NumNeighbors(int vertex) const
+	{
+		return neighborStart[vertex + 1] - neighborStart[vertex];
+	}
+	const int* Neighbors(int vertex) const
+	{
+		return neighbors.data() + neighborStart[vertex];
+	}
+	const int* NeighborStarts() const
+	{
+		return neighborStart.data();
+	}
+
+	// Hill-climbs from the start vertex to the farthest vertex in dir, and returns its index.
+	// worldPoints are the hull's points in whatever space dir is in (pass Points() for local space). They must be in the same order as Points().
+	int FindFarthestVertex(const glm::vec3* worldPoints, const glm::vec3& dir, int start) const;
+};
+
+// Finds the convex hull of a cloud of points with quickhull, as a triangle mesh of its surface: the points on the hull, and three indices
+// into them per triangle, wound counterclockwise seen from outside. Points inside the hull (or within a rounding error of its surface) are
+// left out. If the points are all in a plane, the hull is the flat polygon around them (fanned into triangles); if they're all on a line,
+// it's the two ends (as one triangle with a repeated corner), and a single point is a triangle with all three corners the same.
+void BuildQuickHull(const glm::vec3* positions, int numPositions, std::vector<glm::vec3>& hullPositions, std::vector<unsigned int>& hullIndices);
+
+// A hull shape that uses hill-climbing for its support function.
+// lastVertex should belong to one pair of objects (or one object), and it remembers where the last search ended so the next one can start there.
+// Like HullShape, the points can already be in world space, or be the hull's own (local) points with a pose to put them in the world, which
+// saves transforming any of them.
+struct HillClimbHullShape
+{
+	const ConvexHull* hull;
+	const glm::vec3* points;
+	int* lastVertex;
+	bool posed;
+	glm::vec3 position;
+	glm::quat orientation;
+
+	HillClimbHullShape()
+	{
+		hull = nullptr;
+		points = nullptr;
+		lastVertex = nullptr;
+		posed = false;
+		position = glm::vec3(0.0f);
+		orientation = glm::quat();
+	}
+
+	HillClimbHullShape(const ConvexHull* h, const glm::vec3* pts, int* last)
+	{
+		hull = h;
+		points = pts;
+		lastVertex = last;
+		posed = false;
+		position = glm::vec3(0.0f);
+		orientation = glm::quat();
+	}
+
+	// The hull's own points, placed by a pose.
+	HillClimbHullShape(const ConvexHull* h, const glm::vec3& inPosition, const glm::quat& inOrientation, int* last)
+	{
+		hull = h;
+		points = h->Points();
+		lastVertex = last;
+		posed = true;
+		position = inPosition;
+		orientation = inOrientation;
+	}
+};
+
+// Gets the farthest point of a given HillClimbHullShape in a given direction, starting the search from the last one found. The search is
+// done in the points' space, the same as for HullShape.
+inline glm::vec3 getFarthestPointInDirection(const HillClimbHullShape& obj, const glm::vec3& dir)
+{
+	if (!obj.posed)
+	{
+		*obj.lastVertex = obj.hull->FindFarthestVertex(obj.points, dir, *obj.lastVertex);
+
+		return obj.points[*obj.lastVertex];
+	}
+
+	*obj.lastVertex = obj.hull->FindFarthestVertex(obj.points, glm::conjugate(obj.orientation) * dir, *obj.lastVertex);
+
+	return obj.position + obj.orientation * obj.points[*obj.lastVertex];
+}
+
+#endif //_CONVEX_HULL_H
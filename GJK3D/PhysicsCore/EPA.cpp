@@ -0,0 +1,157 @@
+/*
+Title: GJK-3D (OBB)
+File Name: EPA.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _EPA_CPP
+#define _EPA_CPP
+
+#include "EPA.h"
+
+int EPASolver::addVertex(const glm::vec3& point, const glm::vec3& pointA)
+{
+	if (arena.numVertices >= EPAArena::MAX_VERTICES)
+	{
+		return -1;
+	}
+
+	EPAVertex& vertex = arena.vertices[arena.numVertices];
+	vertex.point = point;
+	vertex.pointA = pointA;
+
+	return arena.numVertices++;
+}
+
+bool EPASolver::addFace(int a, int b, int c)
+{
+	if (arena.numFaces >= EPAArena::MAX_FACES)
+	{
+		return false;
+	}
+
+	glm::vec3 normal = glm::cross(arena.vertices[b].point - arena.vertices[a].point, arena.vertices[c].point - arena.vertices[a].point);
+	float length = glm::length(normal);
+
+	if (length <= 0.0f)
+	{
+		return false;
+	}
+
+	EPAFace& face = arena.faces[arena.numFaces++];
+	face.vertices[0] = a;
+	face.vertices[1] = b;
+	face.vertices[2] = c;
+	face.normal = normal / length;
+
+	// The origin is inside the polytope, so this can only come out negative through rounding (when the origin is right on the face).
+	face.distance = glm::max(glm::dot(face.normal, arena.vertices[a].point), 0.0f);
+
+	return true;
+}
+
+void EPASolver::addEdge(int a, int b)
+{
+	for (int i = 0; i < arena.numEdges; i++)
+	{
+		// The face on the other side of this edge goes around it the opposite way.
+		if (arena.edges[i].vertices[0] == b && arena.edges[i].vertices[1] == a)
+		{
+			arena.edges[i] = arena.edges[--arena.numEdges];
+			return;
+		}
+	}
+
+	if (arena.numEdges < EPAArena::MAX_EDGES)
+	{
+		arena.edges[arena.numEdges].vertices[0] = a;
+		arena.edges[arena.numEdges].vertices[1] = b;
+		arena.numEdges++;
+	}
+}
+
+int EPASolver::closestFace()
+{
+	int best = 0;
+
+	for (int i = 1; i < arena.numFaces; i++)
+	{
+		if (arena.faces[i].distance < arena.faces[best].distance)
+		{
+			best = i;
+		}
+	}
+
+	return best;
+}
+
+void EPASolver::finish(const EPAFace& face, EPAResult& result)
+{
+	result.normal = face.normal;
+	result.depth = face.distance;
+
+	// The point of the face closest to the origin is normal * depth. Its barycentric coordinates on the face, applied to the shape points,
+	// give the contact points on each shape.
+	const EPAVertex& a = arena.vertices[face.vertices[0]];
+	const EPAVertex& b = arena.vertices[face.vertices[1]];
+	const EPAVertex& c = arena.vertices[face.vertices[2]];
+
+	glm::vec3 p = face.normal * face.distance;
+
+	glm::vec3 v0 = b.point - a.point;
+	glm::vec3 v1 = c.point - a.point;
+	glm::vec3 v2 = p - a.point;
+
+	float d00 = glm::dot(v0, v0);
+	float d01 = glm::dot(v0, v1);
+	float d11 = glm::dot(v1, v1);
+	float d20 = glm::dot(v2, v0);
+	float d21 = glm::dot(v2, v1);
+	float denominator = d00 * d11 - d01 * d01;
+
+	float u = 1.0f / 3.0f, v = 1.0f / 3.0f, w = 1.0f / 3.0f;
+
+	if (denominator > 0.0f)
+	{
+		v = (d11 * d20 - d01 * d21) / denominator;
+		w = (d00 * d21 - d01 * d20) / denominator;
+		u = 1.0f - v - w;
+	}
+
+	result.pointA = u * a.pointA + v * b.pointA + w * c.pointA;
+
+	// Each shape point on B is its point on A minus the Minkowski point.
+	result.pointB = result.pointA - p;
+}
+
+#endif //_EPA_CPP
@@ -0,0 +1,340 @@
+/*
+Title: GJK-3D (OBB)
+File Name: EPA.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _EPA_H
+#define _EPA_H
+
+#include "GJK.h"
+
+// What EPA found out about two overlapping shapes.
+// normal points from A to B, and depth is how far they overlap along it, so moving B by normal * depth (or A by the opposite) just separates
+// them. pointA and pointB are the deepest points of the contact on each shape.
+struct EPAResult
+{
+	glm::vec3 normal;
+	glm::vec3 pointA;
+	glm::vec3 pointB;
+	float depth;
+	int iterations;
+
+	EPAResult()
+	{
+		normal = glm::vec3(0.0f);
+		pointA = glm::vec3(0.0f);
+		pointB = glm::vec3(0.0f);
+		depth = 0.0f;
+		iterations = 0;
+	}
+};
+
+// A point of the polytope, with the point on shape A that made it (like in Simplex).
+struct EPAVertex
+{
+	glm::vec3 point;
+	glm::vec3 pointA;
+};
+
+// A triangle of the polytope. The vertices are in counter-clockwise order seen from outside, so normal faces away from the origin.
+struct EPAFace
+{
+	int vertices[3];
+	glm::vec3 normal;
+	float distance; // How far the face's plane is from the origin.
+};
+
+// An edge on the horizon: the boundary between the faces the new point can see and the ones it can't.
+struct EPAEdge
+{
+	int vertices[2];
+};
+
+// All of the memory EPA works in. It is a fixed size and lives inside the solver, so a query never allocates. Give each thread its own
+// solver and the arena gets reused for every query that thread runs.
+// Each iteration adds a vertex, so the limits here also cap how far EPA can expand.
+struct EPAArena
+{
+	static const int MAX_VERTICES = 68;
+	static const int MAX_FACES = 256;
+	static const int MAX_EDGES = 128;
+
+	EPAVertex vertices[MAX_VERTICES];
+	EPAFace faces[MAX_FACES];
+	EPAEdge edges[MAX_EDGES];
+
+	int numVertices;
+	int numFaces;
+	int numEdges;
+
+	void clear()
+	{
+		numVertices = 0;
+		numFaces = 0;
+		numEdges = 0;
+	}
+};
+
+// The Expanding Polytope Algorithm. GJK can tell us that two shapes overlap, but not by how much or in which direction. EPA takes the
+// tetrahedron GJK finished with (which contains the origin) and keeps pushing its face closest to the origin outward, by adding the support
+// point in that face's normal direction, until the face can't move any farther. That face is then part of the surface of the Minkowski
+// Difference, so its normal is the contact normal and its distance to the origin is the penetration depth.
+class EPASolver
+{
+	EPAArena arena;
+
+	int maxIterations;
+	float tolerance;
+
+	// Adds a vertex and returns its index, or -1 if the arena is full.
+	int addVertex(const glm::vec3& point, const glm::vec3& pointA);
+
+	// Adds the face abc, working out its normal and distance. Returns false if the arena is full or the face is too thin to have a normal.
+	bool addFace(int a, int b, int c);
+
+	// Adds an edge to the horizon. If the same edge was already added (the other way around) both faces it belonged to are being removed,
+	// so it isn't on the horizon after all and we take it out instead.
+	void addEdge(int a, int b);
+
+	// Turns a Simplex from GJK into the starting tetrahedron. A simplex with fewer than 4 points (GJK stopped because the shapes were just
+	// touching) is first grown into a tetrahedron using extra support points. Returns false if no proper tetrahedron could be built.
+	template<typename ShapeA, typename ShapeB>
+	bool buildTetrahedron(const ShapeA& a, const ShapeB& b, const Simplex& simplex);
+
+	// Fills in result from the face closest to the origin.
+	void finish(const EPAFace& face, EPAResult& result);
+
+	int closestFace();
+
+public:
+	EPASolver()
+	{
+		maxIterations = 64;
+		tolerance = 1e-4f;
+	}
+
+	void SetMaxIterations(int max)
+	{
+		maxIterations = max;
+	}
+	int GetMaxIterations()
+	{
+		return maxIterations;
+	}
+
+	// EPA stops once the closest face moves less than this far when expanded.
+	void SetTolerance(float t)
+	{
+		tolerance = t;
+	}
+	float GetTolerance()
+	{
+		return tolerance;
+	}
+
+	// Works out the contact normal and penetration depth of two overlapping shapes. The simplex has to come from a GJK query on the same two
+	// shapes, in the same order, that returned true.
+	// Returns false if there isn't enough to go on (a degenerate simplex), in which case the shapes are touching and result is left at zero depth.
+	template<typename ShapeA, typename ShapeB>
+	bool Penetration(const ShapeA& a, const ShapeB& b, const Simplex& simplex, EPAResult& result);
+};
+
+template<typename ShapeA, typename ShapeB>
+bool EPASolver::buildTetrahedron(const ShapeA& a, const ShapeB& b, const Simplex& simplex)
+{
+	arena.clear();
+
+	for (int i = 0; i < simplex.size(); i++)
+	{
+		addVertex(simplex.points[i], simplex.pointsA[i]);
+	}
+
+	// If GJK stopped early, add support points until we have 4 that don't all lie on one plane. We try the coordinate axes first, then (once
+	// we have a triangle) its normal.
+	static const glm::vec3 axes[6] = { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) };
+
+	for (int i = 0; i < 8 && arena.numVertices < 4; i++)
+	{
+		glm::vec3 dir;
+
+		if (arena.numVertices == 3)
+		{
+			dir = glm::cross(arena.vertices[1].point - arena.vertices[0].point, arena.vertices[2].point - arena.vertices[0].point);
+
+			// On the second try, go the other way.
+			if (i % 2 == 1)
+			{
+				dir = -dir;
+			}
+		}
+		else
+		{
+			dir = axes[i % 6];
+		}
+
+		glm::vec3 pointA = getFarthestPointInDirection(a, dir);
+		glm::vec3 point = pointA - getFarthestPointInDirection(b, -dir);
+
+		// Only keep the point if it adds a dimension: a new point for 0 points, off the line for 2, off the plane for 3.
+		bool useful = true;
+
+		if (arena.numVertices >= 1 && point == arena.vertices[0].point)
+		{
+			useful = false;
+		}
+		else if (arena.numVertices == 2)
+		{
+			glm::vec3 cross = glm::cross(arena.vertices[1].point - arena.vertices[0].point, point - arena.vertices[0].point);
+			useful = glm::dot(cross, cross) > 0.0f;
+		}
+		else if (arena.numVertices == 3)
+		{
+			useful = glm::dot(dir, point - arena.vertices[0].point) > 0.0f;
+		}
+
+		if (useful)
+		{
+			addVertex(point, pointA);
+		}
+	}
+
+	if (arena.numVertices < 4)
+	{
+		return false;
+	}
+
+	// Wind the faces so they all face outward. If d is on the front side of abc, abc is the wrong way around, so we swap b and c.
+	int v0 = 0, v1 = 1, v2 = 2, v3 = 3;
+
+	glm::vec3 normal = glm::cross(arena.vertices[v1].point - arena.vertices[v0].point, arena.vertices[v2].point - arena.vertices[v0].point);
+	float side = glm::dot(normal, arena.vertices[v3].point - arena.vertices[v0].point);
+
+	// A flat tetrahedron has no inside to expand from.
+	if (side == 0.0f)
+	{
+		return false;
+	}
+
+	if (side > 0.0f)
+	{
+		v1 = 2;
+		v2 = 1;
+	}
+
+	return addFace(v0, v1, v2) && addFace(v0, v3, v1) && addFace(v0, v2, v3) && addFace(v1, v3, v2);
+}
+
+template<typename ShapeA, typename ShapeB>
+bool EPASolver::Penetration(const ShapeA& a, const ShapeB& b, const Simplex& simplex, EPAResult& result)
+{
+	result = EPAResult();
+
+	if (!buildTetrahedron(a, b, simplex))
+	{
+		return false;
+	}
+
+	int best = closestFace();
+
+	while (result.iterations < maxIterations)
+	{
+		result.iterations++;
+
+		// A copy, because removing faces below moves them around in the arena.
+		EPAFace face = arena.faces[best];
+
+		// Push the closest face out as far as the Minkowski Difference goes in its direction.
+		glm::vec3 pointA = getFarthestPointInDirection(a, face.normal);
+		glm::vec3 point = pointA - getFarthestPointInDirection(b, -face.normal);
+
+		// If it barely moves, that face is on the surface and we have our answer.
+		if (glm::dot(point, face.normal) - face.distance < tolerance)
+		{
+			break;
+		}
+
+		int newVertex = addVertex(point, pointA);
+
+		if (newVertex < 0)
+		{
+			break;
+		}
+
+		// Remove every face the new point can see, keeping track of the edges around the hole that leaves.
+		// Faces are removed by moving the last face into their spot, which is why i only moves on when we keep a face.
+		arena.numEdges = 0;
+
+		for (int i = 0; i < arena.numFaces;)
+		{
+			EPAFace& current = arena.faces[i];
+
+			if (glm::dot(current.normal, point - arena.vertices[current.vertices[0]].point) > 0.0f)
+			{
+				addEdge(current.vertices[0], current.vertices[1]);
+				addEdge(current.vertices[1], current.vertices[2]);
+				addEdge(current.vertices[2], current.vertices[0]);
+
+				arena.faces[i] = arena.faces[--arena.numFaces];
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		// Patch the hole with faces from each horizon edge to the new point.
+		bool patched = true;
+
+		for (int i = 0; i < arena.numEdges; i++)
+		{
+			patched = addFace(arena.edges[i].vertices[0], arena.edges[i].vertices[1], newVertex) && patched;
+		}
+
+		// If we couldn't patch the hole (the arena filled up or rounding gave us a sliver), the polytope isn't closed any more. The best face we
+		// had before is still a good answer, so we stop with that.
+		if (!patched || arena.numFaces == 0)
+		{
+			finish(face, result);
+			return true;
+		}
+
+		best = closestFace();
+	}
+
+	finish(arena.faces[best], result);
+
+	return true;
+}
+
+#endif //_EPA_H
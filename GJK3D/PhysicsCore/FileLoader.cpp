@@ -0,0 +1,341 @@
+/*
+Title: GJK-3D (OBB)
+File Name: FileLoader.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _FILE_LOADER_CPP
+#define _FILE_LOADER_CPP
+
+#include "FileLoader.h"
+#include <algorithm>
+#include <cstdio>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+	#define GJK_READ_POSIX
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+bool ReadWholeFile(const std::string& fileName, std::vector<char>& buffer)
+{
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	buffer.resize((size_t)fileSize.QuadPart);
+
+	// ReadFile can only read 4GB at a time, so anything bigger takes more than one.
+	size_t total = 0;
+
+	while (total < buffer.size())
+	{
+		DWORD read = 0;
+		DWORD wanted = (DWORD)std::min<size_t>(buffer.size() - total, 0x80000000u);
+
+		if (!ReadFile(file, buffer.data() + total, wanted, &read, nullptr) || read == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		total += read;
+	}
+
+	CloseHandle(file);
+	return true;
+#elif defined(GJK_READ_POSIX)
+	int file = open(fileName.c_str(), O_RDONLY);
+
+	if (file == -1)
+	{
+		return false;
+	}
+
+	struct stat status;
+
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		return false;
+	}
+
+	buffer.resize((size_t)status.st_size);
+
+	// read can stop short (on some file systems, or past 2GB), in which case we carry on from where it got to.
+	size_t total = 0;
+
+	while (total < buffer.size())
+	{
+		ssize_t bytes = read(file, buffer.data() + total, buffer.size() - total);
+
+		if (bytes <= 0)
+		{
+			close(file);
+			return false;
+		}
+
+		total += (size_t)bytes;
+	}
+
+	close(file);
+	return true;
+#else
+	FILE* in = fopen(fileName.c_str(), "rb");
+
+	if (in == nullptr)
+	{
+		return false;
+	}
+
+	fseek(in, 0, SEEK_END);
+	long length = ftell(in);
+	fseek(in, 0, SEEK_SET);
+
+	bool read = length >= 0;
+
+	if (read)
+	{
+		buffer.resize((size_t)length);
+		read = fread(buffer.data(), 1, buffer.size(), in) == buffer.size();
+	}
+
+	fclose(in);
+	return read;
+#endif
+}
+
+FileBatch::FileBatch()
+{
+	next = 0;
+}
+
+FileBatch::~FileBatch()
+{
+	Clear();
+
+	for (int i = 0; i < (int)freeBuffers.size(); i++)
+	{
+		delete freeBuffers[i];
+	}
+}
+
+int FileBatch::Add(const std::string& fileName, bool map)
+{
+	Entry* entry = new Entry();
+	entry->fileName = fileName;
+	entry->map = map;
+	entry->buffer = nullptr;
+	entry->mapping = nullptr;
+	entry->failed = false;
+	entry->done = false;
+
+	// The buffer comes out of the pool here, so the workers never have to touch it.
+	if (!map)
+	{
+		if (freeBuffers.empty())
+		{
+			entry->buffer = new std::vector<char>();
+		}
+		else
+		{
+			entry->buffer = freeBuffers.back();
+			freeBuffers.pop_back();
+		}
+	}
+
+	entries.push_back(entry);
+
+	return (int)entries.size() - 1;
+}
+
+void FileBatch::Start(int threadCount)
+{
+	if (!workers.empty() || next >= (int)entries.size())
+	{
+		return;
+	}
+
+	if (threadCount <= 0)
+	{
+		threadCount = std::min(4, (int)std::thread::hardware_concurrency());
+	}
+
+	threadCount = std::max(1, std::min(threadCount, (int)entries.size() - next));
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(&FileBatch::workerLoop, this));
+	}
+}
+
+void FileBatch::workerLoop()
+{
+	// Each worker takes the next file nobody's loaded yet, until there aren't any.
+	for (int i = next++; i < (int)entries.size(); i = next++)
+	{
+		load(*entries[i]);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			entries[i]->done.store(true, std::memory_order_release);
+		}
+
+		finished.notify_all();
+	}
+}
+
+void FileBatch::load(Entry& entry)
+{
+	if (entry.map)
+	{
+		entry.mapping = new MappedFile();
+
+		if (entry.mapping->Open(entry.fileName))
+		{
+			// Touch every page, so they're all paged in by the time anyone reads them.
+			const char* data = entry.mapping->GetData();
+			size_t size = entry.mapping->GetSize();
+			volatile char sum = 0;
+
+			for (size_t i = 0; i < size; i += 4096)
+			{
+				sum += data[i];
+			}
+
+			return;
+		}
+
+		// An empty file can't be mapped, so it (or anything else that can't be) gets read instead.
+		delete entry.mapping;
+		entry.mapping = nullptr;
+		entry.buffer = new std::vector<char>();
+	}
+
+	entry.failed = !ReadWholeFile(entry.fileName, *entry.buffer);
+}
+
+bool FileBatch::Wait(int index)
+{
+	Start();
+
+	Entry& entry = *entries[index];
+
+	if (!entry.done.load(std::memory_order_acquire))
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [&entry]() { return entry.done.load(std::memory_order_acquire); });
+	}
+
+	return !entry.failed;
+}
+
+void FileBatch::WaitAll()
+{
+	Start();
+	joinWorkers();
+}
+
+void FileBatch::joinWorkers()
+{
+	for (int i = 0; i < (int)workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	workers.clear();
+}
+
+const char* FileBatch::GetData(int index) const
+{
+	const Entry& entry = *entries[index];
+
+	if (entry.mapping != nullptr)
+	{
+		return entry.mapping->GetData();
+	}
+
+	return entry.failed || entry.buffer->empty() ? nullptr : entry.buffer->data();
+}
+
+size_t FileBatch::GetSize(int index) const
+{
+	const Entry& entry = *entries[index];
+
+	if (entry.mapping != nullptr)
+	{
+		return entry.mapping->GetSize();
+	}
+
+	return entry.failed ? 0 : entry.buffer->size();
+}
+
+void FileBatch::Clear()
+{
+	// (Anything that hasn't been started doesn't need to be.)
+	joinWorkers();
+
+	for (int i = 0; i < (int)entries.size(); i++)
+	{
+		// Buffers keep their memory when they go back in the pool, which is the point of it.
+		if (entries[i]->buffer != nullptr)
+		{
+			entries[i]->buffer->clear();
+			freeBuffers.push_back(entries[i]->buffer);
+		}
+
+		delete entries[i]->mapping;
+		delete entries[i];
+	}
+
+	entries.clear();
+	next = 0;
+}
+
+#endif //_FILE_LOADER_CPP
@@ -0,0 +1,134 @@
+/*
+Title: GJK-3D (OBB)
+File Name: FileLoader.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _FILE_LOADER_H
+#define _FILE_LOADER_H
+
+#include "MappedFile.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads a whole file into buffer: one look at how big it is, then one read straight into the buffer (no stream in between, and no copying
+// it from one buffer to another). The buffer is resized to fit, so passing the same one in again reuses its memory. Returns false if the
+// file can't be read.
+bool ReadWholeFile(const std::string& fileName, std::vector<char>& buffer);
+
+// Loads a batch of files on worker threads.
+// Add the files, then Start, and each one can be used as soon as it's in (IsDone or Wait), while the rest are still loading. A file is either
+// read (with ReadWholeFile) into a buffer from the batch's pool, or mapped (see MappedFile) and its pages touched on the worker, so that
+// reading it afterwards doesn't stop to wait on the disk either. Big files that are only read once are better mapped.
+// Clear puts the buffers back in the pool, so a batch that's used over and over (a loader that runs every so often) stops allocating.
+class FileBatch
+{
+	struct Entry
+	{
+		std::string fileName;
+		bool map;
+
+		// Where the file ended up: a buffer from the pool, or a mapping.
+		std::vector<char>* buffer;
+		MappedFile* mapping;
+		bool failed;
+
+		// Set by the worker once the above is filled in.
+		std::atomic<bool> done;
+	};
+
+	// Each entry is a separate allocation, since the atomic can't be moved around in a vector.
+	std::vector<Entry*> entries;
+	std::vector<std::vector<char>*> freeBuffers;
+
+	std::vector<std::thread> workers;
+	std::atomic<int> next;
+
+	// Wait sleeps on this until the entry it wants is done.
+	std::mutex mutex;
+	std::condition_variable finished;
+
+	void workerLoop();
+	void load(Entry& entry);
+
+	// Waits for the workers to run out of files.
+	void joinWorkers();
+
+	// Can't be copied, since it owns threads.
+	FileBatch(const FileBatch&);
+	FileBatch& operator=(const FileBatch&);
+
+public:
+	FileBatch();
+	~FileBatch();
+
+	// Adds a file to the batch, and returns its index. Files can only be added before Start (or after Clear).
+	int Add(const std::string& fileName, bool map = false);
+
+	// Starts loading every file that's been added, on up to threadCount threads (0 for a few, which is plenty for waiting on the disk).
+	void Start(int threadCount = 0);
+
+	// Whether a file's been loaded (or failed to). This never waits.
+	bool IsDone(int index) const
+	{
+		return entries[index]->done.load(std::memory_order_acquire);
+	}
+
+	// Waits for a file to be loaded (starting the batch if it hasn't been), and returns false if it couldn't be.
+	bool Wait(int index);
+
+	// Waits for every file.
+	void WaitAll();
+
+	// A file's contents once it's done (nothing, if it failed). They stay put until Clear.
+	const char* GetData(int index) const;
+	size_t GetSize(int index) const;
+
+	const std::string& GetFileName(int index) const
+	{
+		return entries[index]->fileName;
+	}
+	int Size() const
+	{
+		return (int)entries.size();
+	}
+
+	// Waits for everything, then forgets every file, ready for another batch.
+	void Clear();
+};
+
+#endif //_FILE_LOADER_H
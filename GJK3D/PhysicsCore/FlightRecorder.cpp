@@ -0,0 +1,149 @@
+/*
+Title: GJK-3D (OBB)
+File Name: FlightRecorder.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _FLIGHT_RECORDER_CPP
+#define _FLIGHT_RECORDER_CPP
+
+#include "FlightRecorder.h"
+#include <algorithm>
+#include <cstdio>
+
+FlightRecorder::FlightRecorder(int capacity)
+{
+	records.resize(std::max(capacity, 1));
+	threshold = 0.0;
+	dumpAfter = 0;
+	dumps = 0;
+
+	Clear();
+}
+
+void FlightRecorder::Clear()
+{
+	next = 0;
+	count = 0;
+	steps = 0;
+	spikeStep = -1;
+	lastDumpEnd = -1;
+}
+
+void FlightRecorder::SetSpikeDumps(const std::string& filePrefix, double thresholdSeconds, int stepsAfter)
+{
+	dumpPrefix = filePrefix;
+	threshold = thresholdSeconds;
+	dumpAfter = std::min(std::max(stepsAfter, 0), (int)records.size() - 1);
+	spikeStep = -1;
+}
+
+void FlightRecorder::Record(PhysicsWorld& world)
+{
+	const PhysicsStepStats& stats = world.GetStepStats();
+	const GJKStats& gjk = world.GetGJKStats();
+
+	FlightRecord& record = records[next];
+	record.step = steps;
+	record.time = clock.Now();
+	record.stats = stats;
+	record.bodies = world.NumObjects();
+	record.gjkQueries = gjk.queries;
+	record.gjkIterations = gjk.iterations;
+	record.gjkMaxIterations = 0;
+
+	for (int i = GJKStats::MAX_ITERATIONS; i > 0; i--)
+	{
+		if (gjk.iterationHistogram[i] > 0)
+		{
+			record.gjkMaxIterations = i;
+			break;
+		}
+	}
+
+	next = (next + 1) % (int)records.size();
+	count = std::min(count + 1, (int)records.size());
+
+	// A slow step sets off a dump, unless one is already waiting or the last one still covers some of the ring.
+	bool ringIsNew = lastDumpEnd == -1 || steps - lastDumpEnd >= (long long)records.size();
+
+	if (!dumpPrefix.empty() && spikeStep == -1 && stats.total >= threshold && ringIsNew)
+	{
+		spikeStep = steps;
+	}
+
+	if (spikeStep != -1 && steps - spikeStep >= dumpAfter)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%lld", spikeStep);
+
+		lastDumpFile = dumpPrefix + name + ".jsonl";
+		lastDumpEnd = steps;
+		dumps++;
+
+		write(lastDumpFile, spikeStep);
+		spikeStep = -1;
+	}
+
+	steps++;
+}
+
+bool FlightRecorder::write(const std::string& fileName, long long spike) const
+{
+	FILE* out = fopen(fileName.c_str(), "w");
+
+	if (out == nullptr)
+	{
+		return false;
+	}
+
+	// A line per step, with the times in milliseconds. The step that set the dump off (if any) has "spike":true.
+	for (int i = 0; i < count; i++)
+	{
+		const FlightRecord& record = GetRecord(i);
+		const PhysicsStepStats& stats = record.stats;
+
+		fprintf(out, "{\"step\":%lld,\"time\":%.6f,\"spike\":%s,\"ms\":{\"total\":%.4f,\"maintenance\":%.4f,\"transforms\":%.4f,\"refit\":%.4f,"
+			"\"broadphase\":%.4f,\"narrowphase\":%.4f,\"solve\":%.4f,\"integrate\":%.4f},\"bodies\":%d,\"pairs\":%d,\"contacts\":%d,"
+			"\"swept\":%d,\"impacts\":%d,\"speculative\":%d,\"sleeping\":%d,\"islands\":%d,\"overlaps\":%d,\"far\":%d,\"skipped\":%d,"
+			"\"moved\":%d,\"allocations\":%d,\"gjk\":{\"queries\":%lld,\"iterations\":%lld,\"max_iterations\":%d}}\n",
+			record.step, record.time, record.step == spike ? "true" : "false", stats.total * 1000.0, stats.maintenance * 1000.0,
+			stats.transforms * 1000.0, stats.refit * 1000.0, stats.broadphase * 1000.0, stats.narrowphase * 1000.0, stats.solve * 1000.0,
+			stats.integrate * 1000.0, record.bodies, stats.pairs, stats.contacts, stats.swept, stats.impacts, stats.speculative,
+			stats.sleeping, stats.islands, stats.overlaps, stats.far, stats.skipped, stats.moved, stats.allocations, record.gjkQueries,
+			record.gjkIterations, record.gjkMaxIterations);
+	}
+
+	return fclose(out) == 0;
+}
+
+#endif // _FLIGHT_RECORDER_CPP
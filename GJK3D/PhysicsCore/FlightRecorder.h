@@ -0,0 +1,132 @@
+/*
+Title: GJK-3D (OBB)
+File Name: FlightRecorder.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _FLIGHT_RECORDER_H
+#define _FLIGHT_RECORDER_H
+
+#include "Clock.h"
+#include "PhysicsWorld.h"
+#include <string>
+#include <vector>
+
+// One step, as a FlightRecorder saw it.
+struct FlightRecord
+{
+	long long step;				// How many steps the recorder had seen before this one.
+	double time;				// When it was recorded, on the recorder's clock, in seconds.
+	PhysicsStepStats stats;		// Every stage's time, and the step's counts.
+	int bodies;
+
+	// The step's GJK queries, only counted if the world was counting them (see PhysicsWorld::SetGJKStatsEnabled).
+	long long gjkQueries;
+	long long gjkIterations;
+	int gjkMaxIterations;		// The most any one query took.
+};
+
+// Keeps the last so many steps' stats (every stage's time, the counts, and how hard GJK worked) in a ring, and writes them all out to a file
+// by itself when a step takes longer than it should. A spike that happens once an hour on a server can't be caught with a profiler, and
+// by the time anyone looks, the metrics (see PhysicsMetrics) have averaged it away; this way there's a file with the few seconds leading
+// up to it, and a few steps after.
+// The ring is allocated up front and Record only copies into it, so recording every step costs next to nothing. Writing a dump is done by
+// Record too, right after the step that finished it, so it does take a moment (a few hundred steps of text); it's only on steps that are
+// already slow, though, and one dump won't follow another until the ring has been filled with new steps.
+// It isn't thread-safe: Record, Dump and the rest should all be called from the thread that steps the world.
+class FlightRecorder
+{
+	// The ring, oldest first from next once it's full.
+	std::vector<FlightRecord> records;
+	int next;
+	int count;
+	long long steps;
+
+	SteadyClock clock;
+
+	// Where spikes go (see SetSpikeDumps), how slow a step has to be, and how many steps after it to wait for before writing it out.
+	std::string dumpPrefix;
+	double threshold;
+	int dumpAfter;
+
+	// The step that set off the dump waiting to be written, or -1, and the last step of the last dump written, or -1 if there hasn't been
+	// one (so the next one doesn't start until there's a whole ring of new steps).
+	long long spikeStep;
+	long long lastDumpEnd;
+	int dumps;
+	std::string lastDumpFile;
+
+	bool write(const std::string& fileName, long long spike) const;
+
+public:
+	// capacity is how many steps the ring holds: 600 is 10 seconds at 60 steps a second.
+	FlightRecorder(int capacity = 600);
+
+	// Adds the step world just took, and writes a dump if it's time to.
+	void Record(PhysicsWorld& world);
+
+	// Starts writing a dump whenever a step takes thresholdSeconds or longer, stepsAfter steps after it, to filePrefix followed by the spike's
+	// step number and ".jsonl". An empty prefix stops it.
+	void SetSpikeDumps(const std::string& filePrefix, double thresholdSeconds, int stepsAfter = 30);
+
+	// Writes every step in the ring to fileName, oldest first, a line of JSON each (see FlightRecorder.cpp for what's in them). Returns false
+	// if the file couldn't be written.
+	bool Dump(const std::string& fileName) const
+	{
+		return write(fileName, -1);
+	}
+
+	// Forgets every step in the ring.
+	void Clear();
+
+	// The steps in the ring, oldest (0) to newest.
+	int Size() const
+	{
+		return count;
+	}
+	const FlightRecord& GetRecord(int index) const
+	{
+		return records[(next - count + index + (int)records.size()) % (int)records.size()];
+	}
+
+	// How many dumps spikes have set off, and the file the last one went to.
+	int GetDumpCount() const
+	{
+		return dumps;
+	}
+	const std::string& GetLastDumpFile() const
+	{
+		return lastDumpFile;
+	}
+};
+
+#endif //_FLIGHT_RECORDER_H
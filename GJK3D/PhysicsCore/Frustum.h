@@ -0,0 +1,147 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Frustum.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _FRUSTUM_H
+#define _FRUSTUM_H
+
+#include "AABB.h"
+
+// How a box sits relative to a frustum.
+enum FrustumTest
+{
+	FRUSTUM_OUTSIDE,	// Completely outside, so nothing in it can be seen.
+	FRUSTUM_INTERSECTS,	// Partly inside.
+	FRUSTUM_INSIDE		// Completely inside, so everything in it is visible (and there's no need to test anything inside it).
+};
+
+// The view frustum of a camera: the six planes (left, right, bottom, top, near and far) around everything the camera can see.
+// Each plane is stored as a normal pointing into the frustum (xyz) and a distance (w), so a point p is on the inside of a plane when
+// dot(normal, p) + w >= 0, and inside the frustum when it's on the inside of all six.
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	Frustum()
+	{
+	}
+
+	// Pulls the planes straight out of a projection * view matrix (the Gribb-Hartmann method).
+	// A point is visible when its clip coordinates satisfy -w <= x <= w (and the same for y and z), and each of those six comparisons is
+	// a plane in world space: for example x >= -w is the plane (row 3 + row 0) of the matrix.
+	Frustum(const glm::mat4& viewProjection)
+	{
+		// glm matrices are stored by column, so row i is element i of each column.
+		glm::vec4 rows[4];
+
+		for (int i = 0; i < 4; i++)
+		{
+			rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+		}
+
+		planes[0] = rows[3] + rows[0];	// Left
+		planes[1] = rows[3] - rows[0];	// Right
+		planes[2] = rows[3] + rows[1];	// Bottom
+		planes[3] = rows[3] - rows[1];	// Top
+		planes[4] = rows[3] + rows[2];	// Near
+		planes[5] = rows[3] - rows[2];	// Far
+
+		// Normalize them, so that w really is the distance from the origin.
+		for (int i = 0; i < 6; i++)
+		{
+			planes[i] /= glm::length(glm::vec3(planes[i]));
+		}
+	}
+
+	// The six sides of a box, for culling everything that overlaps it.
+	Frustum(const AABB& box)
+	{
+		planes[0] = glm::vec4(1.0f, 0.0f, 0.0f, -box.min.x);
+		planes[1] = glm::vec4(-1.0f, 0.0f, 0.0f, box.max.x);
+		planes[2] = glm::vec4(0.0f, 1.0f, 0.0f, -box.min.y);
+		planes[3] = glm::vec4(0.0f, -1.0f, 0.0f, box.max.y);
+		planes[4] = glm::vec4(0.0f, 0.0f, 1.0f, -box.min.z);
+		planes[5] = glm::vec4(0.0f, 0.0f, -1.0f, box.max.z);
+	}
+
+	// Moves every plane out by distance, so the frustum takes in everything within about that far of it.
+	Frustum Grown(float distance) const
+	{
+		Frustum grown = *this;
+
+		for (int i = 0; i < 6; i++)
+		{
+			grown.planes[i].w += distance;
+		}
+
+		return grown;
+	}
+
+	// Tests a box against every plane. For each plane we only need to look at two of the box's corners: the one farthest along the plane's
+	// normal (if even that one is behind the plane, the whole box is outside), and the one farthest against it (if that one is in front,
+	// the whole box is on the inside of that plane).
+	FrustumTest Classify(const AABB& box) const
+	{
+		FrustumTest result = FRUSTUM_INSIDE;
+
+		for (int i = 0; i < 6; i++)
+		{
+			glm::vec3 normal(planes[i]);
+
+			glm::vec3 farthest(normal.x >= 0.0f ? box.max.x : box.min.x, normal.y >= 0.0f ? box.max.y : box.min.y, normal.z >= 0.0f ? box.max.z : box.min.z);
+			glm::vec3 nearest(normal.x >= 0.0f ? box.min.x : box.max.x, normal.y >= 0.0f ? box.min.y : box.max.y, normal.z >= 0.0f ? box.min.z : box.max.z);
+
+			if (glm::dot(normal, farthest) + planes[i].w < 0.0f)
+			{
+				return FRUSTUM_OUTSIDE;
+			}
+
+			if (glm::dot(normal, nearest) + planes[i].w < 0.0f)
+			{
+				result = FRUSTUM_INTERSECTS;
+			}
+		}
+
+		return result;
+	}
+
+	// Returns true if any of the box could be visible.
+	// (This can say true for a box just outside one of the corners of the frustum, which only costs us drawing something we didn't need to.)
+	bool Overlaps(const AABB& box) const
+	{
+		return Classify(box) != FRUSTUM_OUTSIDE;
+	}
+};
+
+#endif //_FRUSTUM_H
@@ -0,0 +1,386 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GJK.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _GJK_CPP
+#define _GJK_CPP
+
+#include "GJK.h"
+
+const char* GetTerminationName(GJKTermination termination)
+{
+	switch (termination)
+	{
+	case GJK_SEPARATED_LINE:
+		return "separated (line)";
+	case GJK_SEPARATED_SUPPORT:
+		return "separated (support)";
+	case GJK_ORIGIN_ENCLOSED:
+		return "origin enclosed";
+	case GJK_TOUCHING:
+		return "touching";
+	case GJK_NO_PROGRESS:
+		return "no progress";
+	case GJK_ITERATION_CAP:
+		return "iteration cap";
+	default:
+		return "unknown";
+	}
+}
+
+void GJKStats::Reset()
+{
+	queries = 0;
+	iterations = 0;
+	supportCalls = 0;
+
+	for (int i = 0; i <= MAX_ITERATIONS; i++)
+	{
+		iterationHistogram[i] = 0;
+	}
+
+	for (int i = 0; i < GJK_NUM_TERMINATIONS; i++)
+	{
+		terminations[i] = 0;
+	}
+
+	for (int i = 0; i < 5; i++)
+	{
+		simplexSizes[i] = 0;
+	}
+
+	tetrahedronTests = 0;
+	tetrahedronRewinds = 0;
+
+	doubleQueries = 0;
+}
+
+void GJKStats::Add(const GJKStats& other)
+{
+	queries += other.queries;
+	iterations += other.iterations;
+	supportCalls += other.supportCalls;
+
+	for (int i = 0; i <= MAX_ITERATIONS; i++)
+	{
+		iterationHistogram[i] += other.iterationHistogram[i];
+	}
+
+	for (int i = 0; i < GJK_NUM_TERMINATIONS; i++)
+	{
+		terminations[i] += other.terminations[i];
+	}
+
+	for (int i = 0; i < 5; i++)
+	{
+		simplexSizes[i] += other.simplexSizes[i];
+	}
+
+	tetrahedronTests += other.tetrahedronTests;
+	tetrahedronRewinds += other.tetrahedronRewinds;
+
+	doubleQueries += other.doubleQueries;
+}
+
+// Gets the farthest point of a given OBB in a given direction
+glm::vec3 getFarthestPointInDirection(const OBB& obj, const glm::vec3& dir)
+{
+	// Project the first point onto the direction and make it the farthestPoint.
+	float maxDist = glm::dot(obj.corners[0], dir);
+	glm::vec3 farthestPoint = obj.corners[0];
+
+	for (int i = 1; i < 8; i++)
+	{
+		// Project point onto the direction, no need to divide by dir.length() as every point will have this same value, as it is an extra calculation
+		// that is not necessary, since we don't need the exact scalar projection value, just the maximum.
+		if (glm::dot(obj.corners[i], dir) > maxDist)
+		{
+			maxDist = glm::dot(obj.corners[i], dir);
+			farthestPoint = obj.corners[i];
+		}
+	}
+
+	return farthestPoint;
+}
+
+// Checks the tetrahedron for a proper value for dir and re-adjusts the simplex. (Returns false no matter what.)
+// This is the triangle case again, for whichever face of the tetrahedron the origin was in front of. The face's corners come in as indices,
+// so each outcome just keeps the points it needs, rather than shuffling them into place first and then erasing the rest.
+template<typename Scalar, int Dim>
+bool GJKSolverT<Scalar, Dim>::checkTetrahedron(int b, int c, const Vec& ao, const Vec& ab, const Vec& ac, const Vec& abc, Vec& dir)
+{
+	// Whichever way this goes, the origin wasn't inside the tetrahedron and we're about to drop at least one of its points.
+	if (stats != nullptr)
+	{
+		stats->tetrahedronRewinds++;
+	}
+
+	// Very similar to triangle checks
+	Vec ab_abc = glm::cross(ab, abc);
+
+	if (glm::dot(ab_abc, ao) > 0)
+	{
+		// Keep b and a. The direction is not a_abc because it does not point toward the origin.
+		simplex.keep(b, 3);
+
+		dir = glm::cross(glm::cross(ab, ao), ab);
+
+		return false;
+	}
+
+	Vec acp = glm::cross(abc, ac);
+
+	if (glm::dot(acp, ao) > 0)
+	{
+		// Keep c and a.
+		simplex.keep(c, 3);
+
+		dir = glm::cross(glm::cross(ac, ao), ac);
+
+		return false;
+	}
+
+	// Keep the whole face: c, b and a.
+	simplex.keep(c, b, 3);
+
+	dir = abc;
+
+	return false;
+}
+
+// Tests if the simplex contains the origin.
+template<typename Scalar, int Dim>
+bool GJKSolverT<Scalar, Dim>::ContainsOrigin(Vec& dir)
+{
+	Vec a = simplex.back(); // a will always equal the last value in the simplex
+	Vec b, c, ab, ac;
+
+	// If we have a triangle.
+	if (simplex.size() == 3)
+	{
+		// Setup up our b and c variables.
+		b = simplex[1];
+		c = simplex[0];
+
+		// Calculate ab, ac
+		ab = b - a;
+		ac = c - a;
+
+		// Create abc and ab_abc to test if the origin is away from the ab edge.
+		Vec abc = glm::cross(ab, ac);
+		Vec ab_abc = glm::cross(ab, abc);
+
+		// If this is true, then ab_abc is not pointing toward the origin.
+		if (glm::dot(ab_abc, -a) > 0)
+		{
+			// c's value is lost.
+			simplex.copy(0, 1); // c = b
+			simplex.copy(1, 2); // b = a
+
+			// doubleCross(ab, -a)
+			dir = glm::cross(glm::cross(ab, -a), ab); // The dir can't be ab_abc since it's in the wrong direction.
+
+			// Remove a.
+			simplex.pop_back();
+
+			return false;
+		}
+
+		Vec abc_ac = glm::cross(abc, ac);
+
+		if (glm::dot(abc_ac, -a) > 0)
+		{
+			simplex.copy(1, 2); // b = a
+
+			// doubleCross(ac, -a)
+			dir = glm::cross(glm::cross(ac, -a), ac);
+			simplex.pop_back();
+
+			return false;
+		}
+
+		// If we've made it this far, we still have 3 points.
+		// simplex[0] = c, simplex[1] = b, simplex[2] = a
+		// We wish to make a tetrahedron
+		
+		if (glm::dot(abc, -a) > 0)
+		{
+			// Leave simplex as-is
+			// d = c, c = b, b = a (naturally done)
+			// simplex[0] = d, simplex[1] = c, simplex[2] = b, simplex[3] = a (does not exist yet)
+			dir = abc;
+		}
+		else
+		{
+			// Upside down tetrahedron
+			// simplex[0] = d, simplex[1] = c, simplex[2] = b, simplex[3] = a (does not exist yet)
+			simplex.swap(0, 1); // c = oldC, d = b
+			// b = a (naturally done)
+
+			dir = -abc;
+		}
+
+		return false;
+	}
+	else if (simplex.size() == 2)
+	{
+		// Line segment
+		b = simplex[0];
+
+		ab = b - a;
+		
+		// Triple product
+		// doubleCross(ab, -a)
+		dir = glm::cross(glm::cross(ab, -a), ab);
+
+		// We still have 2 points
+		// simplex[0] = b, simplex[1] = a
+		// We wish to make a triangle such that:
+		// simplex[0] = c, simplex[1] = b, simplex[2] = a
+		// c = b, b = a (naturally done)
+
+		return false;
+
+		// ab, -a, ab
+		//dir = (-a * glm::dot(ab, ab)) - (ab * glm::dot(ab, -a));
+	}
+	else if (simplex.size() == 4) // We have a tetrahedron
+	{
+		if (stats != nullptr)
+		{
+			stats->tetrahedronTests++;
+		}
+
+		// simplex[0] = d, simplex[1] = c, simplex[2] = b, simplex[3] = a
+		Vec ao = -a;
+		Vec ad = simplex[0] - a;
+
+		ab = simplex[2] - a;
+		ac = simplex[1] - a;
+
+		// Only the three faces around a need checking. The fourth face, bcd, is the triangle we had before adding a, and we already know the
+		// origin is on a's side of that one. Each face passes its corners on as simplex indices (b then c), so checkTetrahedron can keep the
+		// points it wants straight from where they are.
+		Vec abc = glm::cross(ab, ac);
+
+		if (glm::dot(abc, ao) > 0)
+		{
+			// This is in front of triangle ABC.
+			return checkTetrahedron(2, 1, ao, ab, ac, abc, dir);
+		}
+
+		Vec acd = glm::cross(ac, ad);
+
+		if (glm::dot(acd, ao) > 0)
+		{
+			// This is in front of triangle ACD, so b is eliminated.
+			return checkTetrahedron(1, 0, ao, ac, ad, acd, dir);
+		}
+
+		Vec adb = glm::cross(ad, ab);
+
+		if (glm::dot(adb, ao) > 0)
+		{
+			// This is in front of triangle ADB, so c is eliminated.
+			return checkTetrahedron(0, 2, ao, ad, ab, adb, dir);
+		}
+
+		// If you made it this far and then you are overlapping the origin which means there is a collision!
+		return true;
+	}
+	/*else // If you have something unexpected coming through here, maybe your simplex is too big or too small? Uncomment below and add a break statement.
+	{
+		std::cout << "ERROR";
+	}*/
+
+	return false;
+}
+
+// The float solver is the one everything uses, and the double one is there for MixedGJKSolver (see MixedGJK.h). TestGJK itself lives in
+// the header, since it's a template on the shapes too, but these two don't care about the shapes so they only need building once each.
+template class GJKSolverT<float>;
+template class GJKSolverT<double>;
+
+// The same thing in the plane. With nowhere for the origin to hide above or below a triangle, the triangle is the last step: either the
+// origin is past one of the two edges that touch the new point a (the third edge, bc, is the line we had before, and the origin is on a's
+// side of that), or it's inside. Each edge's outward normal is worked out from the triangle's own edges with dot products alone.
+template<>
+bool GJKSolverT<float, 2>::ContainsOrigin(Vec& dir)
+{
+	Vec a = simplex.back();
+	Vec ao = -a;
+
+	if (simplex.size() == 2)
+	{
+		// Line segment. Search perpendicular to it, toward the origin.
+		dir = towardOrigin(simplex[0] - a, ao);
+
+		return false;
+	}
+
+	// simplex[0] = c, simplex[1] = b, simplex[2] = a
+	Vec ab = simplex[1] - a;
+	Vec ac = simplex[0] - a;
+
+	// The normal of ab that points away from c, and the normal of ac that points away from b.
+	Vec abPerp = ab * glm::dot(ab, ac) - ac * glm::dot(ab, ab);
+
+	if (glm::dot(abPerp, ao) > 0)
+	{
+		// c's value is lost.
+		simplex.keep(1, 2);
+
+		dir = abPerp;
+
+		return false;
+	}
+
+	Vec acPerp = ac * glm::dot(ac, ab) - ab * glm::dot(ac, ac);
+
+	if (glm::dot(acPerp, ao) > 0)
+	{
+		// b's value is lost.
+		simplex.keep(0, 2);
+
+		dir = acPerp;
+
+		return false;
+	}
+
+	// The origin is inside the triangle (or on its edge), so the shapes overlap.
+	return true;
+}
+
+#endif // _GJK_CPP
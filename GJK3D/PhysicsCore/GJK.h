@@ -0,0 +1,606 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GJK.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _GJK_H
+#define _GJK_H
+
+#include "glm\glm.hpp"
+#include "SIMD.h"
+
+struct OBB
+{
+	glm::vec3 corners[8];
+};
+
+// The vector type the GJK core works in, for each scalar type and number of dimensions. Everything is 3D unless asked otherwise, but the
+// solver can also run in the plane (see GJKSolver2D), which is all a 2.5D game needs to collide its objects.
+template<typename Scalar, int Dim>
+struct GJKVector;
+
+template<typename Scalar>
+struct GJKVector<Scalar, 3>
+{
+	typedef glm::tvec3<Scalar, glm::highp> Type;
+};
+
+template<typename Scalar>
+struct GJKVector<Scalar, 2>
+{
+	typedef glm::tvec2<Scalar, glm::highp> Type;
+};
+
+// The direction perpendicular to the segment ab that points at o (or zero if o is on the segment's line), scaled by ab's length squared.
+// That's the triple product ab x (ao x ab). In 3D it takes two cross products. In the plane there's no cross product to take, but it
+// comes out to ao * (ab . ab) - ab * (ab . ao), which is just two dot products.
+template<typename Scalar, glm::precision P>
+inline glm::tvec3<Scalar, P> towardOrigin(const glm::tvec3<Scalar, P>& ab, const glm::tvec3<Scalar, P>& ao)
+{
+	return glm::cross(glm::cross(ab, ao), ab);
+}
+
+template<typename Scalar, glm::precision P>
+inline glm::tvec2<Scalar, P> towardOrigin(const glm::tvec2<Scalar, P>& ab, const glm::tvec2<Scalar, P>& ao)
+{
+	return ao * glm::dot(ab, ab) - ab * glm::dot(ab, ao);
+}
+
+// A GJKCache always keeps its direction in float 3D. A planar direction is kept with a z of zero.
+template<typename Scalar, glm::precision P>
+inline glm::vec3 toCacheDirection(const glm::tvec3<Scalar, P>& dir)
+{
+	return glm::vec3(dir);
+}
+
+template<typename Scalar, glm::precision P>
+inline glm::vec3 toCacheDirection(const glm::tvec2<Scalar, P>& dir)
+{
+	return glm::vec3(glm::vec2(dir), 0.0f);
+}
+
+// The simplex is the set of (up to 4) points on the Minkowski Difference that GJK evolves toward the origin.
+// It used to be a global std::vector, but a GJK simplex never holds more than 4 points, so we store them inline. This means no heap
+// allocations per query, and since every query owns its own simplex, two queries can run at the same time (on different threads) safely.
+// The functions here mirror the std::vector calls the algorithm was originally written with, so the simplex logic reads the same.
+// Alongside each point we also keep the point on shape A that made it (the point on B is then pointA - point). GJK itself never looks at
+// these, but EPA needs them to work out where on each shape the contact is.
+// It's a template on the scalar type for the double precision solver (see GJKSolverT), but everything else uses the float one, Simplex.
+// It's also a template on how many dimensions it's in. A planar (2D) simplex never needs more than a triangle, so it holds up to 3 points.
+template<typename Scalar, int Dim = 3>
+struct SimplexT
+{
+	typedef typename GJKVector<Scalar, Dim>::Type Vec;
+
+	Vec points[Dim + 1];
+	Vec pointsA[Dim + 1];
+	int count;
+
+	SimplexT()
+	{
+		count = 0;
+	}
+
+	void clear()
+	{
+		count = 0;
+	}
+
+	int size() const
+	{
+		return count;
+	}
+
+	void push_back(const Vec& point, const Vec& pointA)
+	{
+		pointsA[count] = pointA;
+		points[count++] = point;
+	}
+
+	Vec& back()
+	{
+		return points[count - 1];
+	}
+
+	Vec& operator[](int index)
+	{
+		return points[index];
+	}
+
+	// Copies one point (and its shape point) over another. (Equivalent to simplex[to] = simplex[from].)
+	void copy(int to, int from)
+	{
+		points[to] = points[from];
+		pointsA[to] = pointsA[from];
+	}
+
+	// Swaps two points (and their shape points).
+	void swap(int first, int second)
+	{
+		Vec temp = points[first];
+		points[first] = points[second];
+		points[second] = temp;
+
+		temp = pointsA[first];
+		pointsA[first] = pointsA[second];
+		pointsA[second] = temp;
+	}
+
+	// Removes the first point, shifting the rest down by one. (Equivalent to simplex.erase(simplex.begin()).)
+	void erase_front()
+	{
+		for (int i = 1; i < count; i++)
+		{
+			copy(i - 1, i);
+		}
+
+		count--;
+	}
+
+	// Removes the last point. (Equivalent to simplex.erase(simplex.end() - 1).)
+	void pop_back()
+	{
+		count--;
+	}
+
+	// Keeps only the given points (and their shape points), in the given order, and drops the rest. This does in one go what would otherwise
+	// take a few copies, an erase_front and a pop_back, and any of the indices can be any of the points.
+	void keep(int first, int second)
+	{
+		Vec point0 = points[first], pointA0 = pointsA[first];
+		Vec point1 = points[second], pointA1 = pointsA[second];
+
+		points[0] = point0;
+		pointsA[0] = pointA0;
+		points[1] = point1;
+		pointsA[1] = pointA1;
+		count = 2;
+	}
+	void keep(int first, int second, int third)
+	{
+		Vec point0 = points[first], pointA0 = pointsA[first];
+		Vec point1 = points[second], pointA1 = pointsA[second];
+		Vec point2 = points[third], pointA2 = pointsA[third];
+
+		points[0] = point0;
+		pointsA[0] = pointA0;
+		points[1] = point1;
+		pointsA[1] = pointA1;
+		points[2] = point2;
+		pointsA[2] = pointA2;
+		count = 3;
+	}
+};
+
+typedef SimplexT<float> Simplex;
+typedef SimplexT<float, 2> Simplex2D;
+
+// Remembers where the last query between a pair of shapes ended up, so the next query for the same pair can start from there.
+// If the pair was separated, dir is the axis that separated them. Objects only move a little each step, so that axis (or one very close to it)
+// usually still separates them, and starting from it lets GJK finish in a support call or two instead of searching from scratch.
+// Keep one of these per pair of objects you test.
+struct GJKCache
+{
+	glm::vec3 dir;	// The last search direction.
+	bool valid;		// False until a query has filled in dir.
+
+	GJKCache()
+	{
+		dir = glm::vec3(1.0f);
+		valid = false;
+	}
+};
+
+// How a GJK query ended. Every query ends in exactly one of these, which GJKSolver::GetTermination reports.
+enum GJKTermination
+{
+	GJK_SEPARATED_LINE,		// The second point didn't pass the origin, so the line check found a separating axis.
+	GJK_SEPARATED_SUPPORT,	// A support point didn't pass the origin along the search direction, so that direction separates the shapes.
+	GJK_ORIGIN_ENCLOSED,	// The tetrahedron (or triangle, in 2D) contains the origin, so the shapes overlap.
+	GJK_TOUCHING,			// The search direction became zero, which means the origin lies right on the simplex (the shapes are touching).
+	GJK_NO_PROGRESS,		// The new support point was one we already had, so the simplex stopped changing (a degenerate, nearly flat case).
+	GJK_ITERATION_CAP,		// We ran out of iterations before reaching an answer.
+
+	GJK_NUM_TERMINATIONS	// Not a termination, just how many there are (for arrays indexed by termination).
+};
+
+// A readable name for a termination, for printing stats.
+const char* GetTerminationName(GJKTermination termination);
+
+// Adds up how a batch of GJK queries went, for tuning things like warm-starting and the iteration cap. Give one to a GJKSolver with SetStats
+// and every query it runs from then on gets counted in here.
+// A GJKStats isn't safe to share between threads, so give each thread its own and Add them together afterward.
+struct GJKStats
+{
+	// Iteration counts above this all land in the last bucket of the histogram. (The default iteration cap is 64, so nothing is lost there.)
+	static const int MAX_ITERATIONS = 64;
+
+	long long queries;
+	long long iterations;	// The main loop iterations of every query added together.
+	long long supportCalls;
+
+	// How many queries took each number of iterations, ended each way, and finished with each number of points in the simplex.
+	long long iterationHistogram[MAX_ITERATIONS + 1];
+	long long terminations[GJK_NUM_TERMINATIONS];
+	long long simplexSizes[5];
+
+	// How many times ContainsOrigin was handed a tetrahedron, and how many of those times the origin was outside of it, so checkTetrahedron
+	// had to throw a point away and fall back to a triangle. Lots of rewinds per query means the search is wandering around the origin.
+	long long tetrahedronTests;
+	long long tetrahedronRewinds;
+
+	// How many queries were run in double precision, either because they were asked for in double or because float couldn't decide them
+	// (see MixedGJKSolver).
+	long long doubleQueries;
+
+	GJKStats()
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	// Adds the counts from other into these.
+	void Add(const GJKStats& other);
+
+	// Counts one finished query.
+	void Record(GJKTermination termination, int queryIterations, int querySupportCalls, int simplexSize)
+	{
+		queries++;
+		iterations += queryIterations;
+		supportCalls += querySupportCalls;
+
+		iterationHistogram[queryIterations < MAX_ITERATIONS ? queryIterations : MAX_ITERATIONS]++;
+		terminations[termination]++;
+		simplexSizes[simplexSize]++;
+	}
+
+	double AverageIterations() const
+	{
+		return queries > 0 ? (double)iterations / queries : 0.0;
+	}
+};
+
+// The box shape from Shapes.h, which the box batch below takes.
+struct OBBShape;
+
+// How many pairs ahead TestGJKBatch starts loading the shapes of.
+static const int GJK_BATCH_PREFETCH = 4;
+
+// A GJKSolver holds all of the state needed for a single GJK query. Nothing in here is shared, so you can create one per thread
+// (or just one on the stack per test) and run as many queries side by side as you like.
+// The solver is a template on the scalar type it does its math in. GJKSolver is the float one, which is what everything uses by default. The
+// double one, GJKSolverT<double>, asks the shapes for their support points in double too (see the overloads below), so it's for when the
+// shapes are so far from the origin that float can't tell them apart any more. (MixedGJKSolver in MixedGJK.h decides when that is.)
+// It's also a template on the number of dimensions. GJKSolver2D, the planar one, takes shapes with a 2D support function (see Shapes2D.h),
+// and never builds a tetrahedron: a triangle is as far as it goes, and there isn't a cross product anywhere in it.
+template<typename Scalar, int Dim = 3>
+class GJKSolverT
+{
+public:
+	typedef typename GJKVector<Scalar, Dim>::Type Vec;
+	typedef SimplexT<Scalar, Dim> SimplexType;
+
+private:
+	SimplexType simplex;
+
+	// The most times the main loop can run before we give up, and how close two support points have to be to count as the same point.
+	// In well behaved cases a query takes a handful of iterations. Nearly degenerate ones can bounce between the same few simplices forever,
+	// so without the cap a single bad pair could stall the whole physics step.
+	int maxIterations;
+	Scalar epsilon;
+
+	// How the last query ended, how many times its main loop ran, and how many support points it asked for.
+	GJKTermination termination;
+	int iterations;
+	int supportCalls;
+
+	// Where to count each query, or nullptr to not bother.
+	GJKStats* stats;
+
+	// The origin is in front of the tetrahedron's face abc, where b and c are the simplex points at the given indices (and a is the newest).
+	// Works out which part of that face is closest to the origin, keeps just those points and points dir at the origin from there.
+	// (Returns false no matter what.)
+	bool checkTetrahedron(int b, int c, const Vec& ao, const Vec& ab, const Vec& ac, const Vec& abc, Vec& dir);
+
+	// Tests if our simplex contains the origin, and if not updates the simplex and dir to move closer to it.
+	// (The planar solver has its own version of this, see GJK.cpp. checkTetrahedron is only ever used in 3D.)
+	bool ContainsOrigin(Vec& dir);
+
+	// Stores the final direction of a query in the cache (if there is one) for the next query to start from.
+	// (The cache is always in float. A direction doesn't need to be exact to be a good place to start.)
+	void saveCache(GJKCache* cache, const Vec& dir)
+	{
+		// A zero direction is no use to start from, so in that case we keep whatever we had.
+		if (cache != nullptr && glm::dot(dir, dir) > Scalar(0))
+		{
+			cache->dir = toCacheDirection(dir);
+			cache->valid = true;
+		}
+	}
+
+	// Records how the query ended, saves its direction into the cache, and hands back the result.
+	bool finish(GJKTermination reason, GJKCache* cache, const Vec& dir, bool result)
+	{
+		termination = reason;
+
+		if (stats != nullptr)
+		{
+			stats->Record(reason, iterations, supportCalls, simplex.size());
+		}
+
+		saveCache(cache, dir);
+
+		return result;
+	}
+
+public:
+	GJKSolverT()
+	{
+		maxIterations = 64;
+		epsilon = Scalar(1e-6);
+		termination = GJK_SEPARATED_LINE;
+		iterations = 0;
+		supportCalls = 0;
+		stats = nullptr;
+	}
+
+	// Sets the iteration budget for each query. If it runs out, the query returns false with GJK_ITERATION_CAP as its termination.
+	void SetMaxIterations(int max)
+	{
+		maxIterations = max;
+	}
+	int GetMaxIterations()
+	{
+		return maxIterations;
+	}
+
+	// Sets the distance under which two support points count as the same point.
+	void SetEpsilon(Scalar e)
+	{
+		epsilon = e;
+	}
+	Scalar GetEpsilon()
+	{
+		return epsilon;
+	}
+
+	// How the last query ended, and how many iterations of the main loop it took.
+	GJKTermination GetTermination()
+	{
+		return termination;
+	}
+	int GetIterations()
+	{
+		return iterations;
+	}
+
+	// How many points on the Minkowski Difference the last query found (each one is a support call on both shapes).
+	int GetSupportCalls()
+	{
+		return supportCalls;
+	}
+
+	// Starts counting every query this solver runs into inStats (or stops, given nullptr). The solver doesn't own it.
+	void SetStats(GJKStats* inStats)
+	{
+		stats = inStats;
+	}
+	GJKStats* GetStats()
+	{
+		return stats;
+	}
+
+	// Returns true if the two shapes are colliding (the Minkowski Difference contains the origin).
+	// This is a template so that any shape with a getFarthestPointInDirection overload can be passed in, and the support calls get inlined.
+	// If a cache is given, the query starts from the direction it stores and saves its final direction back into it.
+	template<typename ShapeA, typename ShapeB>
+	bool TestGJK(const ShapeA& a, const ShapeB& b, GJKCache* cache = nullptr);
+
+	// Tests count pairs at once: out[i] is 1 if *a[i] and *b[i] are colliding and 0 if not, exactly what TestGJK(*a[i], *b[i], caches[i])
+	// would return. caches can be nullptr, and so can any cache in it. If simplices isn't nullptr, then for every pair that collides
+	// simplices[i] gets the tetrahedron GetSimplex would have given for it, ready for EPA. Every query is counted in the stats (if there are
+	// any), but the getters above and GetSimplex only describe the last pair.
+	// This version just runs the pairs one after another, loading each pair's shapes a few pairs before it gets to them.
+	template<typename ShapeA, typename ShapeB>
+	void TestGJKBatch(const ShapeA* const* a, const ShapeB* const* b, int count, unsigned char* out, GJKCache* const* caches = nullptr,
+		SimplexType* simplices = nullptr);
+
+	// Boxes against boxes have a faster version (see GJKBatch.cpp). Almost every pair the broadphase finds is decided by the very first
+	// support point along its cached axis, so that first support point is worked out for several pairs at once, one pair per SIMD lane.
+	// Only the pairs it doesn't separate go on to the rest of the query, one by one. (This one is only there in float.)
+	void TestGJKBatch(const OBBShape* const* a, const OBBShape* const* b, int count, unsigned char* out, GJKCache* const* caches = nullptr,
+		SimplexType* simplices = nullptr);
+
+	// The simplex from the last query. If the last query returned true, this is the tetrahedron (or in 2D, the triangle) that encloses the origin.
+	SimplexType& GetSimplex()
+	{
+		return simplex;
+	}
+};
+
+typedef GJKSolverT<float> GJKSolver;
+typedef GJKSolverT<float, 2> GJKSolver2D;
+
+// The planar simplex step (see GJK.cpp). It's only there in float.
+template<>
+bool GJKSolverT<float, 2>::ContainsOrigin(Vec& dir);
+
+// The box batch is written for float lanes only (see GJKBatch.cpp).
+template<>
+void GJKSolverT<float>::TestGJKBatch(const OBBShape* const* a, const OBBShape* const* b, int count, unsigned char* out,
+	GJKCache* const* caches, Simplex* simplices);
+
+// Note that the shapes are passed by const reference all the way down. An OBB is 96 bytes, and Support is called several times per query, so
+// copying it each time would cost more than the dot products we actually want.
+
+// Gets the farthest point of a given OBB in a given direction
+glm::vec3 getFarthestPointInDirection(const OBB& obj, const glm::vec3& dir);
+
+// The double precision solver asks for its support points in double. Shapes that have a double overload of their own (like OBBShape, see
+// Shapes.h) work the point out in double. Any other shape gets asked in float and has its answer widened, which still keeps the rest of the
+// query (the Minkowski Difference and the simplex) in double.
+template<typename Shape>
+inline glm::dvec3 getFarthestPointInDirection(const Shape& obj, const glm::dvec3& dir)
+{
+	return glm::dvec3(getFarthestPointInDirection(obj, glm::vec3(dir)));
+}
+
+// Gets the farthest points in opposite directions for two shapes and a given direction to project along, and then returns the difference between those points.
+// The right getFarthestPointInDirection is picked at compile time based on the shape types, so adding a new shape only needs a new overload.
+template<typename ShapeA, typename ShapeB>
+inline glm::vec3 Support(const ShapeA& a, const ShapeB& b, const glm::vec3& dir)
+{
+	glm::vec3 p1 = getFarthestPointInDirection(a, dir); // = a.getFarthestPointInDirection(dir)
+	glm::vec3 p2 = getFarthestPointInDirection(b, -dir); // = b.getFarthestPointInDirection(-dir)
+
+	glm::vec3 p3 = p1 - p2;
+
+	return p3;
+}
+
+template<typename Scalar, int Dim>
+template<typename ShapeA, typename ShapeB>
+bool GJKSolverT<Scalar, Dim>::TestGJK(const ShapeA& a, const ShapeB& b, GJKCache* cache)
+{
+	simplex.clear();
+	iterations = 0;
+	supportCalls = 1;
+	
+	// Choose a start direction. If we have the direction from the last query between these two shapes, that is a much better guess than an arbitrary one.
+	Vec dir = (cache != nullptr && cache->valid) ? Vec(cache->dir) : Vec(1);
+
+	Vec pointA = getFarthestPointInDirection(a, dir);
+	simplex.push_back(pointA - getFarthestPointInDirection(b, -dir), pointA); // c
+
+	// If even the farthest point in dir doesn't reach the origin, then dir separates the shapes and we're already done.
+	// When dir came from the cache this is by far the most common way out, costing just one support call.
+	if (glm::dot(simplex.back(), dir) < 0)
+	{
+		return finish(GJK_SEPARATED_SUPPORT, cache, dir, false);
+	}
+
+	dir = -simplex.back(); // -c
+
+	supportCalls++;
+	pointA = getFarthestPointInDirection(a, dir);
+	simplex.push_back(pointA - getFarthestPointInDirection(b, -dir), pointA); // b
+
+	if (glm::dot(simplex.back(), dir) < 0)
+	{
+		return finish(GJK_SEPARATED_LINE, cache, dir, false);
+	}
+
+	dir = towardOrigin(simplex[0] - simplex[1], -simplex[1]);
+
+	Scalar epsilonSquared = epsilon * epsilon;
+
+	while (iterations < maxIterations)
+	{
+		iterations++;
+
+		// If the direction is zero, the origin is exactly on the line or triangle we have (so the shapes are just touching), and there is nowhere left to search.
+		if (dir == Vec(0))
+		{
+			return finish(GJK_TOUCHING, cache, dir, true);
+		}
+
+		// This is Support(a, b, dir), written out so we can keep the point on A for EPA.
+		supportCalls++;
+		pointA = getFarthestPointInDirection(a, dir);
+		Vec point = pointA - getFarthestPointInDirection(b, -dir); // a
+
+		if (glm::dot(point, dir) <= 0)
+		{
+			// If the point added last was not past the origin in the direction of d, then the Minkowski Sum cannot contain the origin since the last 
+			// point added is on the edge of the Minkowski Difference.
+			// That also means dir separates the two shapes, which is exactly what we want to start from next time.
+			return finish(GJK_SEPARATED_SUPPORT, cache, dir, false);
+		}
+
+		// If the new point is (within epsilon of) one we already have, adding it can't get us any closer to the origin. This only happens when the
+		// simplex has gone flat or the shapes are just grazing, so rather than spin we call it separated.
+		for (int i = 0; i < simplex.size(); i++)
+		{
+			Vec difference = point - simplex[i];
+
+			if (glm::dot(difference, difference) <= epsilonSquared)
+			{
+				return finish(GJK_NO_PROGRESS, cache, dir, false);
+			}
+		}
+
+		simplex.push_back(point, pointA);
+
+		if (ContainsOrigin(dir))
+		{
+			return finish(GJK_ORIGIN_ENCLOSED, cache, dir, true);
+		}
+	}
+
+	// We ran out of iterations without an answer. Treat it as a miss, and the termination lets the caller know (and count) that it happened.
+	return finish(GJK_ITERATION_CAP, cache, dir, false);
+}
+
+template<typename Scalar, int Dim>
+template<typename ShapeA, typename ShapeB>
+void GJKSolverT<Scalar, Dim>::TestGJKBatch(const ShapeA* const* a, const ShapeB* const* b, int count, unsigned char* out, GJKCache* const* caches,
+	SimplexType* simplices)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (i + GJK_BATCH_PREFETCH < count)
+		{
+			GJK_PREFETCH(a[i + GJK_BATCH_PREFETCH]);
+			GJK_PREFETCH(b[i + GJK_BATCH_PREFETCH]);
+		}
+
+		out[i] = TestGJK(*a[i], *b[i], caches != nullptr ? caches[i] : nullptr) ? 1 : 0;
+
+		if (out[i] && simplices != nullptr)
+		{
+			simplices[i] = simplex;
+		}
+	}
+}
+
+// Convenience wrapper that runs a single query with its own solver on the stack.
+template<typename ShapeA, typename ShapeB>
+inline bool TestGJK(const ShapeA& a, const ShapeB& b, GJKCache* cache = nullptr)
+{
+	GJKSolver solver;
+
+	return solver.TestGJK(a, b, cache);
+}
+
+#endif //_GJK_H
@@ -0,0 +1,401 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GJKBatch.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _GJK_BATCH_CPP
+#define _GJK_BATCH_CPP
+
+#include "GJK.h"
+#include "Shapes.h"
+#include <algorithm>
+
+// The box batch works out the first support point of a query for 4 pairs at once. Each pair's numbers go down its own lane, so instead of
+// one pair's 3 axis tests, then the next pair's, we do the first axis test of all 4 pairs with one instruction.
+// Everything below is written in terms of a few operations on a whole register of lanes, with a version for each instruction set. (AVX
+// could fit 8 pairs, but turning 8 boxes around into lanes costs more than the wider math saves, so AVX builds use the SSE version.)
+static const int LANES = 4;
+
+// A box is 15 floats in a row: its center, its 3 axes and its half extents.
+static const int BOX_FLOATS = 15;
+
+#if defined(GJK_SIMD_SSE)
+typedef __m128 Lanes;
+
+static inline void store(float* values, Lanes lanes)
+{
+	_mm_store_ps(values, lanes);
+}
+static inline Lanes add(Lanes a, Lanes b)
+{
+	return _mm_add_ps(a, b);
+}
+static inline Lanes sub(Lanes a, Lanes b)
+{
+	return _mm_sub_ps(a, b);
+}
+static inline Lanes mul(Lanes a, Lanes b)
+{
+	return _mm_mul_ps(a, b);
+}
+// Flips the sign bit, which is exactly what the scalar unary minus does (even to 0).
+static inline Lanes negate(Lanes a)
+{
+	return _mm_xor_ps(a, _mm_set1_ps(-0.0f));
+}
+// ifNonNegative where test >= 0, and otherwise ifNegative (including where test is NaN, the same as the scalar comparison).
+static inline Lanes select(Lanes test, Lanes ifNonNegative, Lanes ifNegative)
+{
+	// SSE2 has no blend, so mask the two halves and put them together.
+	Lanes mask = _mm_cmpge_ps(test, _mm_setzero_ps());
+
+	return _mm_or_ps(_mm_and_ps(mask, ifNonNegative), _mm_andnot_ps(mask, ifNegative));
+}
+// A bit for each lane that's less than 0.
+static inline unsigned int negativeMask(Lanes lanes)
+{
+	return (unsigned int)_mm_movemask_ps(_mm_cmplt_ps(lanes, _mm_setzero_ps()));
+}
+static inline Lanes set(float lane0, float lane1, float lane2, float lane3)
+{
+	return _mm_setr_ps(lane0, lane1, lane2, lane3);
+}
+
+// Turns 4 boxes around into lanes: out[k] holds float k of every box. Each box is loaded 4 floats at a time and transposed, rather than
+// written out float by float and read back, which would stall on every read. The last block starts at float 11 (overlapping the one
+// before it) so we never read past the end of a box.
+static inline void loadBoxes(const OBBShape* const boxes[4], Lanes out[BOX_FLOATS])
+{
+	const int blocks[4] = { 0, 4, 8, 11 };
+
+	for (int block = 0; block < 4; block++)
+	{
+		Lanes rows[4];
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			rows[lane] = _mm_loadu_ps(reinterpret_cast<const float*>(boxes[lane]) + blocks[block]);
+		}
+
+		_MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+
+		for (int i = 0; i < 4; i++)
+		{
+			out[blocks[block] + i] = rows[i];
+		}
+	}
+}
+#else
+#if defined(GJK_SIMD_NEON)
+typedef float32x4_t Lanes;
+
+static inline Lanes load(const float* values)
+{
+	return vld1q_f32(values);
+}
+static inline void store(float* values, Lanes lanes)
+{
+	vst1q_f32(values, lanes);
+}
+static inline Lanes add(Lanes a, Lanes b)
+{
+	return vaddq_f32(a, b);
+}
+static inline Lanes sub(Lanes a, Lanes b)
+{
+	return vsubq_f32(a, b);
+}
+// We multiply and add separately (rather than vmlaq) so every lane matches the scalar query exactly.
+static inline Lanes mul(Lanes a, Lanes b)
+{
+	return vmulq_f32(a, b);
+}
+static inline Lanes negate(Lanes a)
+{
+	return vnegq_f32(a);
+}
+static inline Lanes select(Lanes test, Lanes ifNonNegative, Lanes ifNegative)
+{
+	return vbslq_f32(vcgeq_f32(test, vdupq_n_f32(0.0f)), ifNonNegative, ifNegative);
+}
+static inline unsigned int negativeMask(Lanes lanes)
+{
+	// NEON has no movemask, so check each lane.
+	float values[4];
+	vst1q_f32(values, lanes);
+
+	unsigned int mask = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		mask |= (values[i] < 0.0f ? 1u : 0u) << i;
+	}
+
+	return mask;
+}
+#else
+// No SIMD available, so a "register" is just 4 floats, and each operation is a loop over them.
+struct Lanes
+{
+	float values[4];
+};
+
+static inline Lanes load(const float* values)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < 4; i++)
+	{
+		lanes.values[i] = values[i];
+	}
+
+	return lanes;
+}
+static inline void store(float* values, Lanes lanes)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		values[i] = lanes.values[i];
+	}
+}
+static inline Lanes add(Lanes a, Lanes b)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		a.values[i] += b.values[i];
+	}
+
+	return a;
+}
+static inline Lanes sub(Lanes a, Lanes b)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		a.values[i] -= b.values[i];
+	}
+
+	return a;
+}
+static inline Lanes mul(Lanes a, Lanes b)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		a.values[i] *= b.values[i];
+	}
+
+	return a;
+}
+static inline Lanes negate(Lanes a)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		a.values[i] = -a.values[i];
+	}
+
+	return a;
+}
+static inline Lanes select(Lanes test, Lanes ifNonNegative, Lanes ifNegative)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		ifNegative.values[i] = test.values[i] >= 0.0f ? ifNonNegative.values[i] : ifNegative.values[i];
+	}
+
+	return ifNegative;
+}
+static inline unsigned int negativeMask(Lanes lanes)
+{
+	unsigned int mask = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		mask |= (lanes.values[i] < 0.0f ? 1u : 0u) << i;
+	}
+
+	return mask;
+}
+#endif
+
+static inline Lanes set(float lane0, float lane1, float lane2, float lane3)
+{
+	GJK_ALIGN(16) float values[4] = { lane0, lane1, lane2, lane3 };
+
+	return load(values);
+}
+
+// Without SSE's transpose, the boxes are copied out float by float into lanes.
+static inline void loadBoxes(const OBBShape* const boxes[4], Lanes out[BOX_FLOATS])
+{
+	GJK_ALIGN(16) float values[BOX_FLOATS][4];
+
+	for (int lane = 0; lane < 4; lane++)
+	{
+		const float* box = reinterpret_cast<const float*>(boxes[lane]);
+
+		for (int i = 0; i < BOX_FLOATS; i++)
+		{
+			values[i][lane] = box[i];
+		}
+	}
+
+	for (int i = 0; i < BOX_FLOATS; i++)
+	{
+		out[i] = load(values[i]);
+	}
+}
+#endif
+
+// getFarthestPointInDirection for 4 boxes at once, given as lanes by loadBoxes. The operations are the same ones, in the same order, as
+// the scalar version (and glm::dot), so each lane comes out exactly the same.
+static inline void farthestPoints(const Lanes box[BOX_FLOATS], const Lanes dir[3], Lanes point[3])
+{
+	point[0] = box[0];
+	point[1] = box[1];
+	point[2] = box[2];
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const Lanes* a = &box[3 + axis * 3];
+
+		Lanes along = add(add(mul(dir[0], a[0]), mul(dir[1], a[1])), mul(dir[2], a[2]));
+		Lanes halfExtent = box[12 + axis];
+		Lanes extent = select(along, halfExtent, negate(halfExtent));
+
+		point[0] = add(point[0], mul(a[0], extent));
+		point[1] = add(point[1], mul(a[1], extent));
+		point[2] = add(point[2], mul(a[2], extent));
+	}
+}
+
+template<>
+void GJKSolverT<float>::TestGJKBatch(const OBBShape* const* a, const OBBShape* const* b, int count, unsigned char* out, GJKCache* const* caches,
+	Simplex* simplices)
+{
+	// The boxes have to be laid out as 15 floats in a row for loadBoxes.
+	static_assert(sizeof(OBBShape) == BOX_FLOATS * sizeof(float), "OBBShape should be exactly its 15 floats");
+
+	for (int start = 0; start < count; start += LANES)
+	{
+		int lanes = std::min(LANES, count - start);
+
+		// Load the next batch's boxes while we work on this one.
+		for (int i = start + LANES; i < std::min(start + 2 * LANES, count); i++)
+		{
+			GJK_PREFETCH(a[i]);
+			GJK_PREFETCH(b[i]);
+		}
+
+		// A short last batch fills its empty lanes with copies of its first pair, and ignores them.
+		const OBBShape* boxesA[LANES];
+		const OBBShape* boxesB[LANES];
+		glm::vec3 dirs[LANES];
+
+		for (int lane = 0; lane < LANES; lane++)
+		{
+			int pair = start + (lane < lanes ? lane : 0);
+			GJKCache* cache = caches != nullptr ? caches[pair] : nullptr;
+
+			boxesA[lane] = a[pair];
+			boxesB[lane] = b[pair];
+
+			// The same starting direction TestGJK picks.
+			dirs[lane] = (cache != nullptr && cache->valid) ? cache->dir : glm::vec3(1.0f);
+		}
+
+		Lanes boxA[BOX_FLOATS], boxB[BOX_FLOATS];
+		loadBoxes(boxesA, boxA);
+		loadBoxes(boxesB, boxB);
+
+		Lanes dir[3], negativeDir[3];
+
+		for (int i = 0; i < 3; i++)
+		{
+			dir[i] = set(dirs[0][i], dirs[1][i], dirs[2][i], dirs[3][i]);
+			negativeDir[i] = negate(dir[i]);
+		}
+
+		// TestGJK's first support point, and whether it reaches the origin.
+		Lanes pointA[3], pointB[3], point[3];
+		farthestPoints(boxA, dir, pointA);
+		farthestPoints(boxB, negativeDir, pointB);
+
+		for (int i = 0; i < 3; i++)
+		{
+			point[i] = sub(pointA[i], pointB[i]);
+		}
+
+		unsigned int separated = negativeMask(add(add(mul(point[0], dir[0]), mul(point[1], dir[1])), mul(point[2], dir[2])));
+
+		GJK_ALIGN(16) float points[3][LANES];
+		GJK_ALIGN(16) float pointsA[3][LANES];
+
+		if (separated != 0)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				store(points[i], point[i]);
+				store(pointsA[i], pointA[i]);
+			}
+		}
+
+		for (int lane = 0; lane < lanes; lane++)
+		{
+			int pair = start + lane;
+			GJKCache* cache = caches != nullptr ? caches[pair] : nullptr;
+
+			if (separated & (1u << lane))
+			{
+				// This is where TestGJK would have stopped too, after its first support point, so finish the query the same way.
+				simplex.clear();
+				simplex.push_back(glm::vec3(points[0][lane], points[1][lane], points[2][lane]),
+					glm::vec3(pointsA[0][lane], pointsA[1][lane], pointsA[2][lane]));
+				iterations = 0;
+				supportCalls = 1;
+
+				out[pair] = finish(GJK_SEPARATED_SUPPORT, cache, dirs[lane], false) ? 1 : 0;
+			}
+			else
+			{
+				out[pair] = TestGJK(*a[pair], *b[pair], cache) ? 1 : 0;
+
+				if (out[pair] && simplices != nullptr)
+				{
+					simplices[pair] = simplex;
+				}
+			}
+		}
+	}
+}
+
+#endif // _GJK_BATCH_CPP
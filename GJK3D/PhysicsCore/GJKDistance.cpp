@@ -0,0 +1,506 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GJKDistance.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _GJK_DISTANCE_CPP
+#define _GJK_DISTANCE_CPP
+
+#include "GJKDistance.h"
+
+// Finds the weights of the point on segment ab closest to the origin.
+static void closestOnSegment(const glm::vec3& a, const glm::vec3& b, float weights[2])
+{
+	glm::vec3 ab = b - a;
+	float lengthSquared = glm::dot(ab, ab);
+
+	// A segment with no length is just a point.
+	float t = (lengthSquared > 0.0f) ? glm::clamp(glm::dot(-a, ab) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+
+	weights[0] = 1.0f - t;
+	weights[1] = t;
+}
+
+// Finds the weights of the point on triangle abc closest to the origin.
+// This checks which Voronoi region of the triangle (a corner, an edge or the face itself) the origin lies in, and only computes the point
+// for that region. See Christer Ericson's Real-Time Collision Detection, section 5.1.5, which this follows.
+static void closestOnTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float weights[3])
+{
+	glm::vec3 ab = b - a;
+	glm::vec3 ac = c - a;
+
+	// Corner a.
+	float d1 = glm::dot(ab, -a);
+	float d2 = glm::dot(ac, -a);
+
+	if (d1 <= 0.0f && d2 <= 0.0f)
+	{
+		weights[0] = 1.0f; weights[1] = 0.0f; weights[2] = 0.0f;
+		return;
+	}
+
+	// Corner b.
+	float d3 = glm::dot(ab, -b);
+	float d4 = glm::dot(ac, -b);
+
+	if (d3 >= 0.0f && d4 <= d3)
+	{
+		weights[0] = 0.0f; weights[1] = 1.0f; weights[2] = 0.0f;
+		return;
+	}
+
+	// Edge ab.
+	float vc = d1 * d4 - d3 * d2;
+
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		float t = d1 / (d1 - d3);
+		weights[0] = 1.0f - t; weights[1] = t; weights[2] = 0.0f;
+		return;
+	}
+
+	// Corner c.
+	float d5 = glm::dot(ab, -c);
+	float d6 = glm::dot(ac, -c);
+
+	if (d6 >= 0.0f && d5 <= d6)
+	{
+		weights[0] = 0.0f; weights[1] = 0.0f; weights[2] = 1.0f;
+		return;
+	}
+
+	// Edge ac.
+	float vb = d5 * d2 - d1 * d6;
+
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		float t = d2 / (d2 - d6);
+		weights[0] = 1.0f - t; weights[1] = 0.0f; weights[2] = t;
+		return;
+	}
+
+	// Edge bc.
+	float va = d3 * d6 - d5 * d4;
+
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+		float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		weights[0] = 0.0f; weights[1] = 1.0f - t; weights[2] = t;
+		return;
+	}
+
+	// The face. If the triangle is flat (all three points on a line) the sum is zero, and the closest point is on one of its edges instead.
+	float sum = va + vb + vc;
+
+	if (sum <= 0.0f)
+	{
+		float edge[2];
+		closestOnSegment(a, b, edge);
+		weights[0] = edge[0]; weights[1] = edge[1]; weights[2] = 0.0f;
+		float best = glm::dot(edge[0] * a + edge[1] * b, edge[0] * a + edge[1] * b);
+
+		closestOnSegment(a, c, edge);
+		glm::vec3 point = edge[0] * a + edge[1] * c;
+
+		if (glm::dot(point, point) < best)
+		{
+			weights[0] = edge[0]; weights[1] = 0.0f; weights[2] = edge[1];
+			best = glm::dot(point, point);
+		}
+
+		closestOnSegment(b, c, edge);
+		point = edge[0] * b + edge[1] * c;
+
+		if (glm::dot(point, point) < best)
+		{
+			weights[0] = 0.0f; weights[1] = edge[0]; weights[2] = edge[1];
+		}
+
+		return;
+	}
+
+	float v = vb / sum;
+	float w = vc / sum;
+	weights[0] = 1.0f - v - w; weights[1] = v; weights[2] = w;
+}
+
+// How close a tetrahedron's lowest corner can be to the face across from it, as a fraction of its longest edge, before Johnson's
+// sub-algorithm treats it as flat.
+static const float SLIVER_TOLERANCE = 1e-4f;
+
+// Returns true if the origin is on the other side of the plane through abc from d.
+static bool originOutsideFace(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d)
+{
+	glm::vec3 normal = glm::cross(b - a, c - a);
+
+	float signOrigin = glm::dot(-a, normal);
+	float signD = glm::dot(d - a, normal);
+
+	// If d is on the plane, the tetrahedron is flat and can't contain anything, so the face counts as outside.
+	return signOrigin * signD < 0.0f || signD == 0.0f;
+}
+
+// Whether a and b are both positive or both negative. (0 has no sign, so it never matches anything.)
+// The comparisons are combined with & and | rather than && and ||, so that they don't each need a branch (which would be mispredicted about
+// half the time, since which way each one goes depends on where the origin is).
+static bool sameSign(float a, float b)
+{
+	return ((a > 0.0f) & (b > 0.0f)) | ((a < 0.0f) & (b < 0.0f));
+}
+
+// Signed volumes for a segment: the weights of the point on ab closest to the origin.
+// Each end's weight is the signed length from the origin's projection onto the line to the other end, over the segment's length (all
+// measured along ab, so scaled by its length, which cancels out). Both are positive if the projection is between the ends; otherwise the
+// end it's past is the answer.
+static void signedVolumesSegment(const glm::vec3& a, const glm::vec3& b, float weights[2])
+{
+	glm::vec3 ab = b - a;
+
+	float toB = glm::dot(b, ab);
+	float fromA = -glm::dot(a, ab);
+
+	if ((toB > 0.0f) & (fromA > 0.0f))
+	{
+		float length = toB + fromA;
+
+		weights[0] = toB / length;
+		weights[1] = fromA / length;
+		return;
+	}
+
+	// (A segment with no length is just a, since fromA is 0.)
+	bool atA = fromA <= 0.0f;
+
+	weights[0] = atA ? 1.0f : 0.0f;
+	weights[1] = atA ? 0.0f : 1.0f;
+}
+
+// Signed volumes for a triangle: the weights of the point on abc closest to the origin.
+// Each corner's weight is the signed area of the triangle the origin's projection onto the plane makes with the other two corners, over
+// the whole triangle's (measured along the normal, so both are scaled by its length, which cancels out). Those areas are the volumes of
+// the tetrahedra the origin makes with each edge and the normal, so the projection itself never has to be worked out. The corners with
+// the wrong sign are across from the edges the projection is outside of, and the closest point is on one of those edges (any of them, if
+// the triangle is flat).
+static void signedVolumesTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float weights[3])
+{
+	glm::vec3 normal = glm::cross(b - a, c - a);
+
+	float areas[3] = { glm::dot(glm::cross(b, c), normal), glm::dot(glm::cross(c, a), normal), glm::dot(glm::cross(a, b), normal) };
+
+	if ((areas[0] > 0.0f) & (areas[1] > 0.0f) & (areas[2] > 0.0f))
+	{
+		float area = areas[0] + areas[1] + areas[2];
+
+		weights[0] = areas[0] / area;
+		weights[1] = areas[1] / area;
+		weights[2] = areas[2] / area;
+		return;
+	}
+
+	const glm::vec3* corners[3] = { &a, &b, &c };
+	float best = -1.0f;
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (areas[i] > 0.0f)
+		{
+			continue;
+		}
+
+		// The edge across from corner i.
+		int u = (i + 1) % 3;
+		int v = (i + 2) % 3;
+
+		float edge[2];
+		signedVolumesSegment(*corners[u], *corners[v], edge);
+
+		glm::vec3 point = edge[0] * *corners[u] + edge[1] * *corners[v];
+		float distanceSquared = glm::dot(point, point);
+
+		if (best < 0.0f || distanceSquared < best)
+		{
+			best = distanceSquared;
+
+			weights[i] = 0.0f;
+			weights[u] = edge[0];
+			weights[v] = edge[1];
+		}
+	}
+}
+
+// Signed volumes for a tetrahedron: the weights of the point on it closest to the origin. Returns true (with the origin's weights) if it's
+// inside.
+// Each corner's weight is the signed volume of the tetrahedron with that corner swapped for the origin, over the whole one's. A weight with
+// the wrong sign means the origin is on the other side of the face across from that corner, and the closest point is on one of those faces.
+// (A flat tetrahedron has no volume, and then every face is tried.)
+static bool signedVolumesTetrahedron(const glm::vec3 points[4], float weights[4])
+{
+	const glm::vec3& p0 = points[0];
+	const glm::vec3& p1 = points[1];
+	const glm::vec3& p2 = points[2];
+	const glm::vec3& p3 = points[3];
+
+	glm::vec3 e1 = p1 - p0;
+	glm::vec3 e2 = p2 - p0;
+	glm::vec3 e3 = p3 - p0;
+
+	float volume = glm::dot(e1, glm::cross(e2, e3));
+	float volumes[4] =
+	{
+		glm::dot(p1, glm::cross(p2, p3)),
+		glm::dot(-p0, glm::cross(e2, e3)),
+		glm::dot(e1, glm::cross(-p0, e3)),
+		glm::dot(e1, glm::cross(e2, -p0))
+	};
+
+	if (sameSign(volume, volumes[0]) & sameSign(volume, volumes[1]) & sameSign(volume, volumes[2]) & sameSign(volume, volumes[3]))
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			weights[i] = volumes[i] / volume;
+		}
+
+		return true;
+	}
+
+	// Each face lists its three corners and then the corner across from it.
+	static const int faces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+
+	float best = -1.0f;
+
+	for (int i = 0; i < 4; i++)
+	{
+		const int* face = faces[i];
+
+		if (sameSign(volume, volumes[face[3]]))
+		{
+			continue;
+		}
+
+		float faceWeights[3];
+		signedVolumesTriangle(points[face[0]], points[face[1]], points[face[2]], faceWeights);
+
+		glm::vec3 point = faceWeights[0] * points[face[0]] + faceWeights[1] * points[face[1]] + faceWeights[2] * points[face[2]];
+		float distanceSquared = glm::dot(point, point);
+
+		if (best < 0.0f || distanceSquared < best)
+		{
+			best = distanceSquared;
+
+			weights[face[0]] = faceWeights[0];
+			weights[face[1]] = faceWeights[1];
+			weights[face[2]] = faceWeights[2];
+			weights[face[3]] = 0.0f;
+		}
+	}
+
+	return false;
+}
+
+glm::vec3 DistanceSimplex::Solve(GJKSubAlgorithm algorithm)
+{
+	float newWeights[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	bool signedVolumes = algorithm == GJK_SUB_SIGNED_VOLUMES;
+
+	if (count == 1)
+	{
+		newWeights[0] = 1.0f;
+	}
+	else if (count == 2)
+	{
+		if (signedVolumes)
+		{
+			signedVolumesSegment(points[0], points[1], newWeights);
+		}
+		else
+		{
+			closestOnSegment(points[0], points[1], newWeights);
+		}
+	}
+	else if (count == 3)
+	{
+		if (signedVolumes)
+		{
+			signedVolumesTriangle(points[0], points[1], points[2], newWeights);
+		}
+		else
+		{
+			closestOnTriangle(points[0], points[1], points[2], newWeights);
+		}
+	}
+	else if (signedVolumes)
+	{
+		// The origin is inside the tetrahedron, so keep all 4 points.
+		if (signedVolumesTetrahedron(points, newWeights))
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				weights[i] = newWeights[i];
+			}
+
+			return glm::vec3(0.0f);
+		}
+	}
+	else
+	{
+		// For a tetrahedron, the closest point is on one of the faces the origin is outside of. If it's outside of none, it's inside.
+		// Each face lists its three corners and then the corner opposite to it.
+		static const int faces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+
+		// A sliver (a tetrahedron with a corner hardly off the face across from it, compared with how long it is) is flat as far as float
+		// is concerned: the signs the face tests depend on are mostly rounding, and can all come out saying the origin is inside when it's
+		// well outside. So it can't contain anything either, and every face is tried instead.
+		// The height of a corner over its face is the volume over the face's area (both scaled by the same amount here), so the lowest
+		// corner is the one across from the biggest face.
+		float volume = glm::dot(points[1] - points[0], glm::cross(points[2] - points[0], points[3] - points[0]));
+		float biggestFace = 0.0f;
+		float longestEdge = 0.0f;
+
+		for (int i = 0; i < 4; i++)
+		{
+			const int* face = faces[i];
+
+			biggestFace = glm::max(biggestFace, glm::length(glm::cross(points[face[1]] - points[face[0]], points[face[2]] - points[face[0]])));
+		}
+
+		static const int edges[6][2] = { { 0, 1 }, { 0, 2 }, { 0, 3 }, { 1, 2 }, { 1, 3 }, { 2, 3 } };
+
+		for (int i = 0; i < 6; i++)
+		{
+			longestEdge = glm::max(longestEdge, glm::length(points[edges[i][1]] - points[edges[i][0]]));
+		}
+
+		bool flat = glm::abs(volume) <= SLIVER_TOLERANCE * biggestFace * longestEdge;
+
+		float best = -1.0f;
+
+		for (int i = 0; i < 4; i++)
+		{
+			const int* face = faces[i];
+
+			if (!flat && !originOutsideFace(points[face[0]], points[face[1]], points[face[2]], points[face[3]]))
+			{
+				continue;
+			}
+
+			float faceWeights[3];
+			closestOnTriangle(points[face[0]], points[face[1]], points[face[2]], faceWeights);
+
+			glm::vec3 point = faceWeights[0] * points[face[0]] + faceWeights[1] * points[face[1]] + faceWeights[2] * points[face[2]];
+			float distanceSquared = glm::dot(point, point);
+
+			if (best < 0.0f || distanceSquared < best)
+			{
+				best = distanceSquared;
+
+				newWeights[face[0]] = faceWeights[0];
+				newWeights[face[1]] = faceWeights[1];
+				newWeights[face[2]] = faceWeights[2];
+				newWeights[face[3]] = 0.0f;
+			}
+		}
+
+		// The origin is inside the tetrahedron, so keep all 4 points.
+		if (best < 0.0f)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				weights[i] = 0.25f;
+			}
+
+			return glm::vec3(0.0f);
+		}
+	}
+
+	// Throw away the points that don't contribute to the closest point, so the simplex is only as big as it needs to be.
+	glm::vec3 closest(0.0f);
+	int kept = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (newWeights[i] > 0.0f)
+		{
+			points[kept] = points[i];
+			pointsA[kept] = pointsA[i];
+			pointsB[kept] = pointsB[i];
+			weights[kept] = newWeights[i];
+
+			closest += newWeights[i] * points[i];
+			kept++;
+		}
+	}
+
+	count = kept;
+
+	return closest;
+}
+
+void DistanceSimplex::GetClosestPoints(glm::vec3& pointA, glm::vec3& pointB) const
+{
+	pointA = glm::vec3(0.0f);
+	pointB = glm::vec3(0.0f);
+
+	for (int i = 0; i < count; i++)
+	{
+		pointA += weights[i] * pointsA[i];
+		pointB += weights[i] * pointsB[i];
+	}
+}
+
+void GJKDistanceSolver::finish(const glm::vec3& closest, bool overlapping, GJKDistanceResult& result, GJKCache* cache)
+{
+	simplex.GetClosestPoints(result.pointA, result.pointB);
+
+	// If we ran out of iterations right as v reached the origin, that's touching too.
+	if (overlapping || closest == glm::vec3(0.0f))
+	{
+		result.overlapping = true;
+		result.distance = 0.0f;
+		result.normal = glm::vec3(0.0f);
+		return;
+	}
+
+	// closest is pointA - pointB, so the normal from A to B is the other way around.
+	result.overlapping = false;
+	result.distance = glm::length(closest);
+	result.normal = -closest / result.distance;
+
+	if (cache != nullptr)
+	{
+		cache->dir = result.normal;
+		cache->valid = true;
+	}
+}
+
+#endif //_GJK_DISTANCE_CPP
@@ -0,0 +1,317 @@
+/*
+Title: GJK-3D (OBB)
+File Name: GJKDistance.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _GJK_DISTANCE_H
+#define _GJK_DISTANCE_H
+
+#include "GJK.h"
+
+// How a distance query finds the point of its simplex closest to the origin (the "sub-algorithm").
+enum GJKSubAlgorithm
+{
+	GJK_SUB_JOHNSON,		// Johnson's: works out which Voronoi region of the segment, triangle or tetrahedron the origin is in, from dot products.
+	GJK_SUB_SIGNED_VOLUMES	// Signed volumes (Montanari, Petrinic and Barbieri, 2017): see DistanceSimplex::Solve.
+};
+
+// The sub-algorithm every solver (and DistanceSimplex::Solve) uses unless it's told otherwise: Johnson's, or signed volumes if
+// GJK_SIGNED_VOLUMES is defined.
+#if defined(GJK_SIGNED_VOLUMES)
+static const GJKSubAlgorithm GJK_DEFAULT_SUB_ALGORITHM = GJK_SUB_SIGNED_VOLUMES;
+#else
+static const GJKSubAlgorithm GJK_DEFAULT_SUB_ALGORITHM = GJK_SUB_JOHNSON;
+#endif
+
+// The answer to a distance query.
+// When the shapes are separated, pointA and pointB are the closest points on each shape, distance is how far apart they are, and normal
+// points from A to B. (So it is also a separating axis, the same kind of direction GJKCache stores.)
+// When the shapes overlap, overlapping is true and distance is 0. The points and normal don't mean anything in that case; that's EPA's job.
+struct GJKDistanceResult
+{
+	glm::vec3 pointA;
+	glm::vec3 pointB;
+	glm::vec3 normal;
+	float distance;
+	bool overlapping;
+	int iterations;
+
+	GJKDistanceResult()
+	{
+		pointA = glm::vec3(0.0f);
+		pointB = glm::vec3(0.0f);
+		normal = glm::vec3(0.0f);
+		distance = 0.0f;
+		overlapping = false;
+		iterations = 0;
+	}
+};
+
+// The simplex used by the distance query. It is the same idea as Simplex, but for every point on the Minkowski Difference it also remembers
+// the two points (one on each shape) that made it, and a barycentric weight. Once we know which combination of the simplex points is closest
+// to the origin, the same weights applied to the shape points give us the closest points on the shapes themselves.
+struct DistanceSimplex
+{
+	glm::vec3 points[4];
+	glm::vec3 pointsA[4];
+	glm::vec3 pointsB[4];
+	float weights[4];
+	int count;
+
+	DistanceSimplex()
+	{
+		count = 0;
+	}
+
+	void clear()
+	{
+		count = 0;
+	}
+
+	int size() const
+	{
+		return count;
+	}
+
+	void push_back(const glm::vec3& pointA, const glm::vec3& pointB)
+	{
+		pointsA[count] = pointA;
+		pointsB[count] = pointB;
+		points[count] = pointA - pointB;
+		weights[count] = 0.0f;
+		count++;
+	}
+
+	// Finds the point of the simplex closest to the origin and returns it. The simplex is reduced to just the points needed to describe that
+	// point (a vertex, an edge or a face), and their weights are filled in. Returns the zero vector if the tetrahedron contains the origin,
+	// in which case all 4 points are kept.
+	// Johnson's sub-algorithm decides which part of the simplex is closest with differences of dot products, which lose most of their
+	// precision when the simplex is long and thin, or nearly flat, as it is when the shapes are almost touching. Signed volumes instead
+	// works out the origin's barycentric coordinates straight from ratios of signed volumes (triple products, for a triangle along its
+	// normal), and only looks at the faces or edges whose coordinate came out with the wrong sign. (The paper measures a triangle's areas in
+	// whichever axis-aligned plane it's biggest in; measuring them along the normal is at least as well conditioned, and needs no branches to
+	// pick the plane.)
+	glm::vec3 Solve(GJKSubAlgorithm algorithm = GJK_DEFAULT_SUB_ALGORITHM);
+
+	// The weighted sums of the shape points, which are the closest points on each shape once Solve has been called.
+	void GetClosestPoints(glm::vec3& pointA, glm::vec3& pointB) const;
+};
+
+// Works out how far apart two convex shapes are, using the distance form of GJK.
+// The boolean TestGJK only cares about which side of the origin the simplex is on. This version instead keeps moving the simplex toward the
+// point of the Minkowski Difference closest to the origin (using Johnson's sub-algorithm, written out as closest point on a segment, triangle
+// and tetrahedron, or signed volumes; see GJKSubAlgorithm), so when it finishes we know the actual distance and where it is on each shape.
+// That distance is what lets us skip work: two objects 3 metres apart that close at most 1 metre per second can't touch for 3 seconds.
+class GJKDistanceSolver
+{
+	DistanceSimplex simplex;
+
+	// The iteration budget for each query, and the relative tolerance for deciding the distance has stopped shrinking.
+	int maxIterations;
+	float tolerance;
+
+	GJKSubAlgorithm subAlgorithm;
+
+	// Gets the farthest points on both shapes for a direction. The distance query needs the points on each shape and not just their difference.
+	template<typename ShapeA, typename ShapeB>
+	static void support(const ShapeA& a, const ShapeB& b, const glm::vec3& dir, glm::vec3& pointA, glm::vec3& pointB)
+	{
+		pointA = getFarthestPointInDirection(a, dir);
+		pointB = getFarthestPointInDirection(b, -dir);
+	}
+
+	// Fills in result from the current simplex, and saves the normal into the cache if there is one.
+	void finish(const glm::vec3& closest, bool overlapping, GJKDistanceResult& result, GJKCache* cache);
+
+public:
+	GJKDistanceSolver()
+	{
+		maxIterations = 64;
+		tolerance = 1e-5f;
+		subAlgorithm = GJK_DEFAULT_SUB_ALGORITHM;
+	}
+
+	void SetMaxIterations(int max)
+	{
+		maxIterations = max;
+	}
+	int GetMaxIterations()
+	{
+		return maxIterations;
+	}
+
+	// The query stops once a new support point would shrink the squared distance by less than this fraction of it.
+	void SetTolerance(float t)
+	{
+		tolerance = t;
+	}
+	float GetTolerance()
+	{
+		return tolerance;
+	}
+
+	// Which sub-algorithm the queries use (see DistanceSimplex::Solve). The default is GJK_DEFAULT_SUB_ALGORITHM.
+	void SetSubAlgorithm(GJKSubAlgorithm algorithm)
+	{
+		subAlgorithm = algorithm;
+	}
+	GJKSubAlgorithm GetSubAlgorithm() const
+	{
+		return subAlgorithm;
+	}
+
+	// Runs the query and returns the distance between the two shapes (0 if they overlap). The rest of the answer is written into result.
+	// If a cache is given, the query starts from the normal it stores and saves the new normal back into it. It's the same cache the boolean
+	// test uses, so a pair can switch between the two queries without losing its warm start.
+	template<typename ShapeA, typename ShapeB>
+	float Distance(const ShapeA& a, const ShapeB& b, GJKDistanceResult& result, GJKCache* cache = nullptr);
+
+	// The simplex from the last query.
+	DistanceSimplex& GetSimplex()
+	{
+		return simplex;
+	}
+};
+
+template<typename ShapeA, typename ShapeB>
+float GJKDistanceSolver::Distance(const ShapeA& a, const ShapeB& b, GJKDistanceResult& result, GJKCache* cache)
+{
+	simplex.clear();
+	result.iterations = 0;
+
+	// The closest point (v) of the Minkowski Difference is also the farthest point in the direction -v. The cached normal is our best guess at
+	// -v, so we start with the support point in that direction.
+	glm::vec3 dir = (cache != nullptr && cache->valid) ? cache->dir : glm::vec3(1.0f);
+
+	glm::vec3 pointA, pointB;
+	support(a, b, dir, pointA, pointB);
+	simplex.push_back(pointA, pointB);
+	simplex.weights[0] = 1.0f;
+
+	glm::vec3 v = simplex.points[0];
+	bool overlapping = false;
+
+	while (result.iterations < maxIterations)
+	{
+		result.iterations++;
+
+		float vv = glm::dot(v, v);
+
+		// If v is (almost) the origin, the origin is on the simplex, so the shapes are touching. "Almost" is measured against the size of the
+		// simplex, since a fixed distance would mean something different for a pebble and a building.
+		float largest = 0.0f;
+
+		for (int i = 0; i < simplex.size(); i++)
+		{
+			largest = glm::max(largest, glm::dot(simplex.points[i], simplex.points[i]));
+		}
+
+		if (vv <= tolerance * tolerance * largest)
+		{
+			overlapping = true;
+			break;
+		}
+
+		support(a, b, -v, pointA, pointB);
+		glm::vec3 w = pointA - pointB;
+
+		// dot(v, w) is how far the shapes reach toward each other along v. If the new point doesn't get any closer to the origin than v
+		// already is, v is the closest point and we're done.
+		if (vv - glm::dot(v, w) <= tolerance * vv)
+		{
+			break;
+		}
+
+		// A point we already have can't make any progress either. (This catches the rounding cases the check above misses.) Support points
+		// that only differ by rounding count as the same, measured against the size of the simplex like above, since the simplex they'd make
+		// is too thin for its faces to mean anything.
+		bool duplicate = false;
+		largest = glm::max(largest, glm::dot(w, w));
+
+		for (int i = 0; i < simplex.size(); i++)
+		{
+			glm::vec3 offset = simplex.points[i] - w;
+
+			if (glm::dot(offset, offset) <= tolerance * tolerance * largest)
+			{
+				duplicate = true;
+				break;
+			}
+		}
+
+		if (duplicate)
+		{
+			break;
+		}
+
+		// Keep the simplex we have, in case the new one turns out worse.
+		DistanceSimplex previous = simplex;
+
+		simplex.push_back(pointA, pointB);
+
+		glm::vec3 next = simplex.Solve(subAlgorithm);
+
+		// The tetrahedron contains the origin, so the shapes overlap.
+		if (simplex.size() == 4)
+		{
+			overlapping = true;
+			break;
+		}
+
+		// Each step should bring v closer to the origin. When the simplex is nearly flat, rounding can make it land a little farther away
+		// instead, and from there GJK can go round in circles. The old simplex is then as good an answer as we're going to get.
+		if (glm::dot(next, next) >= vv)
+		{
+			simplex = previous;
+			break;
+		}
+
+		v = next;
+	}
+
+	finish(v, overlapping, result, cache);
+
+	return result.distance;
+}
+
+// Convenience wrapper that runs a single distance query with its own solver on the stack.
+template<typename ShapeA, typename ShapeB>
+inline float GJKDistance(const ShapeA& a, const ShapeB& b, GJKDistanceResult& result, GJKCache* cache = nullptr)
+{
+	GJKDistanceSolver solver;
+
+	return solver.Distance(a, b, result, cache);
+}
+
+#endif //_GJK_DISTANCE_H
@@ -0,0 +1,309 @@
+/*
+Title: GJK-3D (OBB)
+File Name: HashGrid.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _HASH_GRID_CPP
+#define _HASH_GRID_CPP
+
+#include "HashGrid.h"
+#include <algorithm>
+#include <cmath>
+
+HashGrid::HashGrid(float inCellSize, float inMargin)
+{
+	freeList = -1;
+	proxyCount = 0;
+
+	cellSize = inCellSize;
+	margin = inMargin;
+	displacementMultiplier = 2.0f;
+}
+
+int HashGrid::CreateProxy(const AABB& bounds, int userData)
+{
+	int proxy;
+
+	if (freeList != -1)
+	{
+		proxy = freeList;
+		freeList = proxies[proxy].next;
+	}
+	else
+	{
+		proxies.push_back(HashGridProxy());
+		proxy = (int)proxies.size() - 1;
+	}
+
+	proxies[proxy].bounds = AABB(bounds.min - glm::vec3(margin), bounds.max + glm::vec3(margin));
+	proxies[proxy].userData = userData;
+	proxies[proxy].next = -1;
+
+	proxyCount++;
+
+	return proxy;
+}
+
+void HashGrid::Reserve(int numProxies, int numPairs, int threads)
+{
+	Broadphase::Reserve(numProxies, numPairs, threads);
+
+	proxies.reserve(numProxies);
+	entries.reserve(8 * numProxies);
+
+	// The table is kept no more than half full (see rebuild).
+	int capacity = 16;
+
+	while (capacity < 16 * numProxies)
+	{
+		capacity *= 2;
+	}
+
+	slots.reserve(capacity);
+}
+
+void HashGrid::DestroyProxy(int proxy)
+{
+	proxies[proxy].userData = -1;
+	proxies[proxy].next = freeList;
+	freeList = proxy;
+
+	proxyCount--;
+}
+
+bool HashGrid::MoveProxy(int proxy, const AABB& bounds, const glm::vec3& displacement)
+{
+	if (proxies[proxy].bounds.Contains(bounds))
+	{
+		return false;
+	}
+
+	AABB fat = MakeFatBounds(bounds, margin, displacement, displacementMultiplier);
+
+	// The table is rebuilt from the bounds every step, so this is all there is to moving.
+	proxies[proxy].bounds = fat;
+
+	return true;
+}
+
+void HashGrid::ShiftOrigin(const glm::vec3& origin)
+{
+	// The table is built again from the bounds in the next FindPairs, with the proxies in whichever cells they're in by then.
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		proxies[i].bounds.min -= origin;
+		proxies[i].bounds.max -= origin;
+	}
+}
+
+int HashGrid::findSlot(int x, int y, int z)
+{
+	// A common spatial hash: multiply each coordinate by a large prime and mix them together. The table size is a power of two, so the mask
+	// picks the slot.
+	unsigned int hash = ((unsigned int)x * 73856093u) ^ ((unsigned int)y * 19349663u) ^ ((unsigned int)z * 83492791u);
+	unsigned int mask = (unsigned int)slots.size() - 1;
+	unsigned int index = hash & mask;
+
+	// Linear probing: if the slot is taken by another cell, try the next one. The table is kept at most half full, so this ends quickly.
+	while (true)
+	{
+		HashGridSlot& slot = slots[index];
+
+		if (slot.first == -1)
+		{
+			slot.x = x;
+			slot.y = y;
+			slot.z = z;
+
+			return (int)index;
+		}
+
+		if (slot.x == x && slot.y == y && slot.z == z)
+		{
+			return (int)index;
+		}
+
+		index = (index + 1) & mask;
+	}
+}
+
+void HashGrid::rebuild()
+{
+	entries.clear();
+
+	// Count the cells we are going to insert, so we can size the table to keep it no more than half full.
+	int cellCount = 0;
+
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		if (proxies[i].userData == -1)
+		{
+			continue;
+		}
+
+		glm::ivec3 low = glm::ivec3(glm::floor(proxies[i].bounds.min / cellSize));
+		glm::ivec3 high = glm::ivec3(glm::floor(proxies[i].bounds.max / cellSize));
+		glm::ivec3 size = high - low + glm::ivec3(1);
+
+		cellCount += size.x * size.y * size.z;
+	}
+
+	int capacity = 16;
+
+	while (capacity < cellCount * 2)
+	{
+		capacity *= 2;
+	}
+
+	HashGridSlot empty;
+	empty.x = 0;
+	empty.y = 0;
+	empty.z = 0;
+	empty.first = -1;
+
+	slots.assign(capacity, empty);
+
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		if (proxies[i].userData == -1)
+		{
+			continue;
+		}
+
+		glm::ivec3 low = glm::ivec3(glm::floor(proxies[i].bounds.min / cellSize));
+		glm::ivec3 high = glm::ivec3(glm::floor(proxies[i].bounds.max / cellSize));
+
+		for (int x = low.x; x <= high.x; x++)
+		{
+			for (int y = low.y; y <= high.y; y++)
+			{
+				for (int z = low.z; z <= high.z; z++)
+				{
+					int slot = findSlot(x, y, z);
+
+					HashGridEntry entry;
+					entry.proxy = i;
+					entry.next = slots[slot].first;
+
+					slots[slot].first = (int)entries.size();
+					entries.push_back(entry);
+				}
+			}
+		}
+	}
+}
+
+void HashGrid::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+	pairs.clear();
+
+	rebuild();
+
+	for (int s = 0; s < (int)slots.size(); s++)
+	{
+		const HashGridSlot& slot = slots[s];
+
+		for (int i = slot.first; i != -1; i = entries[i].next)
+		{
+			const AABB& a = proxies[entries[i].proxy].bounds;
+
+			for (int j = entries[i].next; j != -1; j = entries[j].next)
+			{
+				const AABB& b = proxies[entries[j].proxy].bounds;
+
+				if (!a.Overlaps(b))
+				{
+					continue;
+				}
+
+				// Two proxies that both cover several cells share more than one of them. To report each pair only once, we only report it from
+				// the cell that holds the minimum corner of where their bounds overlap.
+				glm::ivec3 cell = glm::ivec3(glm::floor(glm::max(a.min, b.min) / cellSize));
+
+				if (cell.x == slot.x && cell.y == slot.y && cell.z == slot.z &&
+					CanPair(proxies[entries[i].proxy].userData, proxies[entries[j].proxy].userData))
+				{
+					pairs.push_back(BroadphasePair(proxies[entries[i].proxy].userData, proxies[entries[j].proxy].userData));
+				}
+			}
+		}
+	}
+
+	// Sort them, so the narrowphase always sees the pairs in the same order as with any other broadphase.
+	SortPairs(pairs, sortScratch);
+
+	comparePairs(pairs);
+}
+
+void HashGrid::Cull(const Frustum& frustum, std::vector<int>& visible) const
+{
+	visible.clear();
+
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		// Skip the proxies on the free list.
+		if (proxies[i].userData == -1)
+		{
+			continue;
+		}
+
+		if (frustum.Overlaps(proxies[i].bounds))
+		{
+			visible.push_back(proxies[i].userData);
+		}
+	}
+}
+
+void HashGrid::CastSegment(const glm::vec3& from, const glm::vec3& to, const glm::vec3& extents, std::vector<int>& hits) const
+{
+	hits.clear();
+
+	glm::vec3 delta = to - from;
+
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		// Skip the proxies on the free list.
+		if (proxies[i].userData == -1)
+		{
+			continue;
+		}
+
+		if (proxies[i].bounds.SegmentOverlaps(from, delta, extents))
+		{
+			hits.push_back(proxies[i].userData);
+		}
+	}
+}
+
+#endif //_HASH_GRID_CPP
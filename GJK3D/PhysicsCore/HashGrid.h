@@ -0,0 +1,146 @@
+/*
+Title: GJK-3D (OBB)
+File Name: HashGrid.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _HASH_GRID_H
+#define _HASH_GRID_H
+
+#include "Broadphase.h"
+#include "MemoryTracker.h"
+
+struct HashGridProxy
+{
+	AABB bounds;	// The fat bounds.
+	int userData;
+	int next;		// The next free proxy, while this one is on the free list.
+};
+
+// One slot of the hash table: the cell it holds, and the first of that cell's entries.
+struct HashGridSlot
+{
+	int x;
+	int y;
+	int z;
+	int first;		// -1 if the slot is empty.
+};
+
+// One proxy in one cell. A cell's entries are a linked list through next.
+struct HashGridEntry
+{
+	int proxy;
+	int next;
+};
+
+// A uniform spatial hash grid broadphase.
+// Space is cut up into cubes of cellSize, and each proxy goes into every cell its bounds touch. Two proxies can only overlap if they share a
+// cell, so we only test the proxies within each cell against each other. Cells are looked up through a hash of their coordinates, so the grid
+// doesn't need any bounds of its own and empty space costs nothing.
+// This works best when the objects are all about the same size, with cellSize a bit bigger than them, since then each proxy is in only a few
+// cells and each cell holds only a few proxies. For a scene of thousands of identical debris cubes it is cheaper than the tree, because there
+// is nothing to keep balanced: the table is simply rebuilt every step.
+// The table uses open addressing (linear probing into one flat array), so the rebuild only writes into arrays that were allocated on an
+// earlier step, and never allocates once it has grown to fit the scene.
+class HashGrid : public Broadphase
+{
+	// Saves and loads the arrays straight from a file (see WorldSnapshot).
+	friend class WorldSnapshot;
+
+	TrackedVector<HashGridProxy, MEMORY_BROADPHASE> proxies;
+	int freeList;
+	int proxyCount;
+
+	TrackedVector<HashGridSlot, MEMORY_BROADPHASE> slots;
+	TrackedVector<HashGridEntry, MEMORY_BROADPHASE> entries;
+
+	float cellSize;
+	float margin;
+	float displacementMultiplier;
+
+	// Finds the slot for a cell, claiming an empty one for it if it isn't in the table yet.
+	int findSlot(int x, int y, int z);
+
+	// Empties the table and puts every proxy back into it.
+	void rebuild();
+
+public:
+	HashGrid(float inCellSize = 1.0f, float inMargin = 0.05f);
+
+	int CreateProxy(const AABB& bounds, int userData);
+
+	void DestroyProxy(int proxy);
+
+	bool MoveProxy(int proxy, const AABB& bounds, const glm::vec3& displacement);
+
+	void ShiftOrigin(const glm::vec3& origin);
+
+	const AABB& GetFatBounds(int proxy) const
+	{
+		return proxies[proxy].bounds;
+	}
+
+	int GetUserData(int proxy) const
+	{
+		return proxies[proxy].userData;
+	}
+
+	// Rebuilds the table, then tests the proxies in each cell against each other.
+	void FindPairs(std::vector<BroadphasePair>& pairs);
+
+	// Makes room for each proxy to be in up to 8 cells, which is as many as one no bigger than a cell can touch.
+	void Reserve(int numProxies, int numPairs, int threads);
+
+	// Tests every proxy. (Walking the cells inside the frustum would find proxies more than once, and still have to test each one.)
+	void Cull(const Frustum& frustum, std::vector<int>& visible) const;
+
+	// Tests every proxy as well. Walking the cells along the segment would only pay off for short segments through crowded grids.
+	void CastSegment(const glm::vec3& from, const glm::vec3& to, const glm::vec3& extents, std::vector<int>& hits) const;
+
+	const char* GetName() const
+	{
+		return "Hash grid";
+	}
+
+	// The cell size should be a bit bigger than a typical object. Changing it takes effect on the next FindPairs.
+	void SetCellSize(float size)
+	{
+		cellSize = size;
+	}
+	float GetCellSize() const
+	{
+		return cellSize;
+	}
+};
+
+#endif //_HASH_GRID_H
@@ -0,0 +1,122 @@
+/*
+Title: GJK-3D (OBB)
+File Name: HeightField.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _HEIGHT_FIELD_CPP
+#define _HEIGHT_FIELD_CPP
+
+#include "HeightField.h"
+#include <cmath>
+
+HeightField::HeightField()
+{
+	columns = 0;
+	rows = 0;
+	cellSize = 1.0f;
+	origin = glm::vec3(0.0f);
+}
+
+HeightField::HeightField(const float* inHeights, int inColumns, int inRows, float inCellSize, const glm::vec3& inOrigin)
+{
+	heights.assign(inHeights, inHeights + inColumns * inRows);
+	columns = inColumns;
+	rows = inRows;
+	cellSize = inCellSize;
+	origin = inOrigin;
+
+	float lowest = heights.empty() ? 0.0f : heights[0];
+	float highest = lowest;
+
+	for (int i = 1; i < (int)heights.size(); i++)
+	{
+		lowest = glm::min(lowest, heights[i]);
+		highest = glm::max(highest, heights[i]);
+	}
+
+	bounds.min = origin + glm::vec3(0.0f, lowest, 0.0f);
+	bounds.max = origin + glm::vec3(glm::max(columns - 1, 0) * cellSize, highest, glm::max(rows - 1, 0) * cellSize);
+}
+
+void HeightField::SetHeight(int column, int row, float height)
+{
+	heights[row * columns + column] = height;
+
+	bounds.min.y = glm::min(bounds.min.y, origin.y + height);
+	bounds.max.y = glm::max(bounds.max.y, origin.y + height);
+}
+
+void HeightField::Query(const AABB& box, std::vector<int>& found) const
+{
+	if (NumTriangles() == 0 || !bounds.Overlaps(box))
+	{
+		return;
+	}
+
+	// The cells the box's corners are over, kept inside the grid.
+	int firstColumn = glm::clamp((int)floorf((box.min.x - origin.x) / cellSize), 0, columns - 2);
+	int lastColumn = glm::clamp((int)floorf((box.max.x - origin.x) / cellSize), 0, columns - 2);
+	int firstRow = glm::clamp((int)floorf((box.min.z - origin.z) / cellSize), 0, rows - 2);
+	int lastRow = glm::clamp((int)floorf((box.max.z - origin.z) / cellSize), 0, rows - 2);
+
+	float bottom = box.min.y - origin.y;
+	float top = box.max.y - origin.y;
+
+	for (int row = firstRow; row <= lastRow; row++)
+	{
+		const float* rowHeights = &heights[row * columns];
+		const float* nextRowHeights = rowHeights + columns;
+
+		for (int column = firstColumn; column <= lastColumn; column++)
+		{
+			// Only a cell whose heights span some of the box's can touch it.
+			float lowest = glm::min(glm::min(rowHeights[column], rowHeights[column + 1]),
+				glm::min(nextRowHeights[column], nextRowHeights[column + 1]));
+			float highest = glm::max(glm::max(rowHeights[column], rowHeights[column + 1]),
+				glm::max(nextRowHeights[column], nextRowHeights[column + 1]));
+
+			if (lowest > top || highest < bottom)
+			{
+				continue;
+			}
+
+			int cell = row * (columns - 1) + column;
+
+			found.push_back(cell * 2);
+			found.push_back(cell * 2 + 1);
+		}
+	}
+}
+
+#endif //_HEIGHT_FIELD_CPP
@@ -0,0 +1,118 @@
+/*
+Title: GJK-3D (OBB)
+File Name: HeightField.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _HEIGHT_FIELD_H
+#define _HEIGHT_FIELD_H
+
+#include "TriangleMesh.h"
+
+// Terrain, as a grid of heights: columns along x and rows along z, cellSize apart, starting from origin. Each cell between four heights is
+// two triangles, split from its corner at the largest x and smallest z to the one at the smallest x and largest z.
+// This is the same surface a TriangleMesh of the grid would be, for the cost of one float per point instead of its position, three indices
+// per triangle and a tree. It doesn't need the tree either: the cells under a box are found straight from its corners, so a query only
+// costs the cells it covers. TestMesh and CollideMesh (see TriangleMesh.h) take a HeightField just as well.
+// A triangle's number is twice its cell's (which counts along each row, then row by row), plus one for the second triangle in the cell.
+class HeightField
+{
+	std::vector<float> heights;
+	int columns;
+	int rows;
+	float cellSize;
+	glm::vec3 origin;
+
+	AABB bounds;
+
+	glm::vec3 point(int column, int row) const
+	{
+		return origin + glm::vec3(column * cellSize, heights[row * columns + column], row * cellSize);
+	}
+
+public:
+	HeightField();
+
+	// Copies columns * rows heights, a row at a time. There have to be at least two of each, to make a cell.
+	HeightField(const float* inHeights, int inColumns, int inRows, float inCellSize, const glm::vec3& inOrigin = glm::vec3(0.0f));
+
+	int NumColumns() const
+	{
+		return columns;
+	}
+	int NumRows() const
+	{
+		return rows;
+	}
+	float GetCellSize() const
+	{
+		return cellSize;
+	}
+
+	float GetHeight(int column, int row) const
+	{
+		return heights[row * columns + column];
+	}
+
+	// Changes one height (for terrain that gets dug into, say). The bounds only ever grow to fit.
+	void SetHeight(int column, int row, float height);
+
+	int NumTriangles() const
+	{
+		return columns > 1 && rows > 1 ? (columns - 1) * (rows - 1) * 2 : 0;
+	}
+
+	TriangleShape GetTriangle(int triangle) const
+	{
+		int cell = triangle / 2;
+		int column = cell % (columns - 1);
+		int row = cell / (columns - 1);
+
+		if (triangle % 2 == 0)
+		{
+			return TriangleShape(point(column, row), point(column, row + 1), point(column + 1, row));
+		}
+
+		return TriangleShape(point(column + 1, row), point(column, row + 1), point(column + 1, row + 1));
+	}
+
+	const AABB& GetBounds() const
+	{
+		return bounds;
+	}
+
+	// Finds the triangles of the cells under box whose heights reach into it, and adds their numbers to found.
+	void Query(const AABB& box, std::vector<int>& found) const;
+};
+
+#endif //_HEIGHT_FIELD_H
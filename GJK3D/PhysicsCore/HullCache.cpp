@@ -0,0 +1,359 @@
+/*
+Title: GJK-3D (OBB)
+File Name: HullCache.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _HULL_CACHE_CPP
+#define _HULL_CACHE_CPP
+
+#include "HullCache.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+
+unsigned long long HashBytes(const void* data, size_t size, unsigned long long hash)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+HullCache::HullCache(const std::string& cacheDirectory)
+{
+	directory = cacheDirectory;
+	hits = 0;
+	misses = 0;
+}
+
+// Reads one hull (header and all) from the start of data, which is size bytes long, checking everything about it. used is set to how many
+// bytes it took up.
+static bool readHull(const char* data, size_t size, unsigned long long key, ConvexHull& hull, size_t& used)
+{
+	if (size < sizeof(HullCacheHeader))
+	{
+		return false;
+	}
+
+	// Copied out, since a hull after another one in a decomposition file is only sure to be 4 byte aligned.
+	HullCacheHeader copy;
+	memcpy(&copy, data, sizeof(copy));
+	const HullCacheHeader* header = &copy;
+
+	if (memcmp(header->magic, HULL_CACHE_MAGIC, sizeof(HULL_CACHE_MAGIC)) != 0 || header->version != HULL_CACHE_VERSION || header->key != key)
+	{
+		return false;
+	}
+
+	// There have to be as many bytes left as the header says, or the file was cut short (or is something else).
+	unsigned long long pointsSize = (unsigned long long)header->pointCount * sizeof(glm::vec3);
+	unsigned long long startsSize = ((unsigned long long)header->pointCount + 1) * sizeof(int);
+	unsigned long long neighborsSize = (unsigned long long)header->neighborCount * sizeof(int);
+
+	if (sizeof(HullCacheHeader) + pointsSize + startsSize + neighborsSize > size)
+	{
+		return false;
+	}
+
+	used = (size_t)(sizeof(HullCacheHeader) + pointsSize + startsSize + neighborsSize);
+
+	const glm::vec3* points = (const glm::vec3*)(data + sizeof(HullCacheHeader));
+	const int* neighborStart = (const int*)((const char*)points + pointsSize);
+	const int* neighbors = (const int*)((const char*)neighborStart + startsSize);
+
+	// Check the graph too, since hill-climbing trusts it completely.
+	if (neighborStart[0] != 0 || neighborStart[header->pointCount] != (int)header->neighborCount)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < header->pointCount; i++)
+	{
+		if (neighborStart[i + 1] < neighborStart[i])
+		{
+			return false;
+		}
+	}
+
+	for (unsigned int i = 0; i < header->neighborCount; i++)
+	{
+		if (neighbors[i] < 0 || neighbors[i] >= (int)header->pointCount)
+		{
+			return false;
+		}
+	}
+
+	hull = ConvexHull(points, (int)header->pointCount, neighborStart, neighbors);
+
+	return true;
+}
+
+// Writes one hull (header and all) to out. Whether it worked is up to ferror.
+static void writeHull(FILE* out, unsigned long long key, const ConvexHull& hull)
+{
+	HullCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, HULL_CACHE_MAGIC, sizeof(header.magic));
+	header.version = HULL_CACHE_VERSION;
+	header.key = key;
+	header.pointCount = (unsigned int)hull.NumPoints();
+	header.neighborCount = (unsigned int)hull.NeighborStarts()[hull.NumPoints()];
+
+	fwrite(&header, sizeof(header), 1, out);
+	fwrite(hull.Points(), sizeof(glm::vec3), header.pointCount, out);
+	fwrite(hull.NeighborStarts(), sizeof(int), header.pointCount + 1, out);
+	fwrite(hull.Neighbors(0), sizeof(int), header.neighborCount, out);
+}
+
+std::string HullCache::getFileName(unsigned long long key, const char* extension) const
+{
+	char name[40];
+	snprintf(name, sizeof(name), "%016llx.%s", key, extension);
+
+	if (directory.empty())
+	{
+		return name;
+	}
+
+	char last = directory[directory.size() - 1];
+
+	return directory + (last == '/' || last == '\\' ? "" : "/") + name;
+}
+
+ConvexHull HullCache::GetHull(const glm::vec3* positions, int numPositions, bool* fromCache)
+{
+	unsigned long long key = HashBytes(positions, numPositions * sizeof(glm::vec3));
+	ConvexHull hull;
+
+	bool found = Load(key, hull);
+
+	if (found)
+	{
+		hits++;
+	}
+	else
+	{
+		misses++;
+
+		hull = ConvexHull::FromPoints(positions, numPositions);
+		Save(key, hull);
+	}
+
+	if (fromCache != nullptr)
+	{
+		*fromCache = found;
+	}
+
+	return hull;
+}
+
+bool HullCache::Load(unsigned long long key, ConvexHull& hull) const
+{
+	MappedFile file;
+
+	if (!file.Open(getFileName(key)))
+	{
+		return false;
+	}
+
+	// The file has to be exactly one hull long.
+	size_t used = 0;
+
+	return readHull(file.GetData(), file.GetSize(), key, hull, used) && used == file.GetSize();
+}
+
+bool HullCache::Save(unsigned long long key, const ConvexHull& hull) const
+{
+	FILE* out = fopen(getFileName(key).c_str(), "wb");
+
+	if (out == nullptr)
+	{
+		return false;
+	}
+
+	writeHull(out, key, hull);
+
+	bool written = ferror(out) == 0;
+
+	// A half written file would only be thrown away by Load, but it may as well not be left lying around.
+	if (fclose(out) != 0 || !written)
+	{
+		remove(getFileName(key).c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void HullCache::GetDecomposition(const glm::vec3* positions, int numPositions, const unsigned int* indices, int numIndices,
+	const DecompositionSettings& settings, std::vector<ConvexHull>& hulls, bool* fromCache)
+{
+	// The settings are hashed one at a time, so padding between them can't change the key.
+	unsigned long long key = HashBytes(positions, numPositions * sizeof(glm::vec3));
+	key = HashBytes(indices, numIndices * sizeof(unsigned int), key);
+	key = HashBytes(&settings.resolution, sizeof(settings.resolution), key);
+	key = HashBytes(&settings.concavity, sizeof(settings.concavity), key);
+	key = HashBytes(&settings.maxHulls, sizeof(settings.maxHulls), key);
+	key = HashBytes(&settings.maxVertices, sizeof(settings.maxVertices), key);
+
+	bool found = LoadDecomposition(key, hulls);
+
+	if (found)
+	{
+		hits++;
+	}
+	else
+	{
+		misses++;
+
+		DecomposeMesh(positions, numPositions, indices, numIndices, settings, hulls);
+		SaveDecomposition(key, hulls);
+	}
+
+	if (fromCache != nullptr)
+	{
+		*fromCache = found;
+	}
+}
+
+bool HullCache::LoadDecomposition(unsigned long long key, std::vector<ConvexHull>& hulls) const
+{
+	MappedFile file;
+
+	if (!file.Open(getFileName(key, "hulls")) || file.GetSize() < sizeof(DecompositionCacheHeader))
+	{
+		return false;
+	}
+
+	const DecompositionCacheHeader* header = (const DecompositionCacheHeader*)file.GetData();
+
+	if (memcmp(header->magic, DECOMPOSITION_CACHE_MAGIC, sizeof(DECOMPOSITION_CACHE_MAGIC)) != 0 || header->version != DECOMPOSITION_CACHE_VERSION ||
+		header->key != key)
+	{
+		return false;
+	}
+
+	std::vector<ConvexHull> loaded(header->hullCount);
+	size_t offset = sizeof(DecompositionCacheHeader);
+
+	for (unsigned int i = 0; i < header->hullCount; i++)
+	{
+		size_t used = 0;
+
+		if (!readHull(file.GetData() + offset, file.GetSize() - offset, key, loaded[i], used))
+		{
+			return false;
+		}
+
+		offset += used;
+	}
+
+	// Anything left over means the file isn't what the header says it is.
+	if (offset != file.GetSize())
+	{
+		return false;
+	}
+
+	hulls.swap(loaded);
+
+	return true;
+}
+
+bool HullCache::SaveDecomposition(unsigned long long key, const std::vector<ConvexHull>& hulls) const
+{
+	DecompositionCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DECOMPOSITION_CACHE_MAGIC, sizeof(header.magic));
+	header.version = DECOMPOSITION_CACHE_VERSION;
+	header.key = key;
+	header.hullCount = (unsigned int)hulls.size();
+
+	FILE* out = fopen(getFileName(key, "hulls").c_str(), "wb");
+
+	if (out == nullptr)
+	{
+		return false;
+	}
+
+	fwrite(&header, sizeof(header), 1, out);
+
+	for (int i = 0; i < (int)hulls.size(); i++)
+	{
+		writeHull(out, key, hulls[i]);
+	}
+
+	bool written = ferror(out) == 0;
+
+	if (fclose(out) != 0 || !written)
+	{
+		remove(getFileName(key, "hulls").c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void HullCache::GetTriangleMesh(const glm::vec3* positions, int numPositions, const unsigned int* indices, int numIndices, TriangleMesh& mesh,
+	bool* fromCache)
+{
+	unsigned long long key = HashBytes(positions, numPositions * sizeof(glm::vec3));
+	key = HashBytes(indices, numIndices * sizeof(unsigned int), key);
+
+	std::string fileName = getFileName(key, "tris");
+	bool found = mesh.Open(fileName, key);
+
+	if (found)
+	{
+		hits++;
+	}
+	else
+	{
+		misses++;
+
+		mesh = TriangleMesh(positions, numPositions, indices, numIndices);
+		mesh.Save(fileName, key);
+	}
+
+	if (fromCache != nullptr)
+	{
+		*fromCache = found;
+	}
+}
+
+#endif //_HULL_CACHE_CPP
@@ -0,0 +1,126 @@
+/*
+Title: GJK-3D (OBB)
+File Name: HullCache.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _HULL_CACHE_H
+#define _HULL_CACHE_H
+
+#include "ConvexDecomposition.h"
+#include "ConvexHull.h"
+#include "TriangleMesh.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// A hull cache file is a header followed by the hull's points, its neighborStart array, and its neighbors, exactly as ConvexHull keeps them.
+static const char HULL_CACHE_MAGIC[4] = { 'G', 'J', 'K', 'H' };
+static const unsigned int HULL_CACHE_VERSION = 1;
+
+struct HullCacheHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned long long key;		// The hash of the points the hull was built from, so a cache file for different points is never used by mistake.
+	unsigned int pointCount;
+	unsigned int neighborCount;
+};
+
+// A decomposition cache file is this header, followed by each of the hulls as it would be in a hull cache file of its own (header and all).
+static const char DECOMPOSITION_CACHE_MAGIC[4] = { 'G', 'J', 'K', 'D' };
+static const unsigned int DECOMPOSITION_CACHE_VERSION = 1;
+
+struct DecompositionCacheHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned long long key;		// The hash of the mesh and the settings it was decomposed with.
+	unsigned int hullCount;
+	unsigned int padding;
+};
+
+// A 64 bit FNV-1a hash of some bytes. Pass the last hash back in to hash more bytes on the end of them.
+unsigned long long HashBytes(const void* data, size_t size, unsigned long long hash = 14695981039346656037ULL);
+
+// Saves the hulls built from imported meshes, so that they're only ever built once. Quickhull on a big mesh can take a while, and the same
+// meshes get loaded every time we start, so after the first time each hull is just read back from a file named after the hash of the
+// points it was built from (so a mesh that changes gets a new hull, and two files with the same mesh share one).
+// Level meshes' TriangleMeshes are kept the same way, and those aren't even read back: the file is mapped and the mesh used where it is.
+// The directory has to exist already. If it doesn't, or can't be written to, hulls are still built, just not saved.
+class HullCache
+{
+	std::string directory;
+
+	int hits;
+	int misses;
+
+	std::string getFileName(unsigned long long key, const char* extension = "hull") const;
+
+public:
+	HullCache(const std::string& cacheDirectory);
+
+	// The hull around the given points: from the cache if it's there, otherwise built with quickhull (and then saved in the cache).
+	// fromCache (if given) is set to whether it came from the cache.
+	ConvexHull GetHull(const glm::vec3* positions, int numPositions, bool* fromCache = nullptr);
+
+	// Reads the hull saved under key, returning false if there isn't one (or it's broken, or from another version).
+	bool Load(unsigned long long key, ConvexHull& hull) const;
+	bool Save(unsigned long long key, const ConvexHull& hull) const;
+
+	// The convex pieces of a mesh (see DecomposeMesh): from the cache if they're there, otherwise decomposed (and then saved in the cache).
+	// Decomposing takes far longer than building one hull, so this is the one to really not do every time we start.
+	void GetDecomposition(const glm::vec3* positions, int numPositions, const unsigned int* indices, int numIndices,
+		const DecompositionSettings& settings, std::vector<ConvexHull>& hulls, bool* fromCache = nullptr);
+
+	// Reads the hulls saved under key, returning false if there aren't any (or the file is broken, or from another version).
+	bool LoadDecomposition(unsigned long long key, std::vector<ConvexHull>& hulls) const;
+	bool SaveDecomposition(unsigned long long key, const std::vector<ConvexHull>& hulls) const;
+
+	// A TriangleMesh of a level mesh: mapped straight from the cache if it's there (see TriangleMesh::Open), otherwise built (and then
+	// saved in the cache, for next time). The key is the hash of the positions and indices.
+	void GetTriangleMesh(const glm::vec3* positions, int numPositions, const unsigned int* indices, int numIndices, TriangleMesh& mesh,
+		bool* fromCache = nullptr);
+
+	// How many GetHull, GetDecomposition and GetTriangleMesh calls found their hull in the cache, and how many had to build it.
+	int GetHits() const
+	{
+		return hits;
+	}
+	int GetMisses() const
+	{
+		return misses;
+	}
+};
+
+#endif //_HULL_CACHE_H
@@ -0,0 +1,212 @@
+/*
+Title: GJK-3D (OBB)
+File Name: HullHierarchy.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _HULL_HIERARCHY_CPP
+#define _HULL_HIERARCHY_CPP
+
+#include "HullHierarchy.h"
+#include <algorithm>
+#include <cfloat>
+
+// Vertices with more neighbors than this are never taken away, so that hill-climbing down a level only has a few of them to look at.
+static const int HIERARCHY_MAX_DEGREE = 8;
+
+// The top level is checked vertex by vertex, so it stops once it's about this small.
+static const int HIERARCHY_TOP_VERTICES = 16;
+
+// Orders points by x, then y, then z, so the vertices of a level can be found among those of the level below by where they are.
+static bool lessPosition(const glm::vec3& a, const glm::vec3& b)
+{
+	if (a.x != b.x)
+	{
+		return a.x < b.x;
+	}
+
+	if (a.y != b.y)
+	{
+		return a.y < b.y;
+	}
+
+	return a.z < b.z;
+}
+
+struct IndexedPoint
+{
+	glm::vec3 position;
+	int index;
+};
+
+static bool lessIndexedPoint(const IndexedPoint& a, const IndexedPoint& b)
+{
+	return lessPosition(a.position, b.position);
+}
+
+// Takes away each vertex of hull that hasn't too many neighbors, unless a neighbor of it already was, and builds the hull of what's left in
+// its place. toFiner has where each vertex is in the level below, and is brought up to date for the new hull. Returns false (leaving them
+// both as they were) if there's hardly anything to take away (every vertex has lots of neighbors), or too little would be left to be a
+// solid hull.
+static bool removeIndependentSet(ConvexHull& hull, std::vector<int>& toFiner)
+{
+	int numPoints = hull.NumPoints();
+	std::vector<char> blocked(numPoints, 0);
+	std::vector<IndexedPoint> kept;
+	std::vector<glm::vec3> keptPositions;
+	int removed = 0;
+
+	for (int i = 0; i < numPoints; i++)
+	{
+		if (!blocked[i] && hull.NumNeighbors(i) <= HIERARCHY_MAX_DEGREE)
+		{
+			const int* adjacent = hull.Neighbors(i);
+
+			for (int j = 0; j < hull.NumNeighbors(i); j++)
+			{
+				blocked[adjacent[j]] = 1;
+			}
+
+			removed++;
+			continue;
+		}
+
+		IndexedPoint point;
+		point.position = hull.Points()[i];
+		point.index = toFiner[i];
+		kept.push_back(point);
+		keptPositions.push_back(point.position);
+	}
+
+	if (removed * 16 < numPoints || (int)kept.size() < 4)
+	{
+		return false;
+	}
+
+	std::vector<glm::vec3> hullPositions;
+	std::vector<unsigned int> hullIndices;
+
+	BuildQuickHull(keptPositions.data(), (int)keptPositions.size(), hullPositions, hullIndices);
+
+	hull = ConvexHull(hullPositions.data(), (int)hullPositions.size(), hullIndices.data(), (int)hullIndices.size());
+
+	// Quickhull gives back the very same positions it was given, so each vertex is found exactly among the ones that were kept.
+	std::sort(kept.begin(), kept.end(), lessIndexedPoint);
+	toFiner.resize(hull.NumPoints());
+
+	for (int i = 0; i < hull.NumPoints(); i++)
+	{
+		IndexedPoint key;
+		key.position = hull.Points()[i];
+		key.index = -1;
+
+		std::vector<IndexedPoint>::const_iterator found = std::lower_bound(kept.begin(), kept.end(), key, lessIndexedPoint);
+		toFiner[i] = (found != kept.end() && found->position == key.position) ? found->index : 0;
+	}
+
+	return true;
+}
+
+HullHierarchy::HullHierarchy(const ConvexHull* hull)
+{
+	base = hull;
+
+	if (hull->NumPoints() < HULL_HIERARCHY_MIN_VERTICES)
+	{
+		return;
+	}
+
+	const ConvexHull* finer = hull;
+
+	while (finer->NumPoints() > HIERARCHY_TOP_VERTICES)
+	{
+		// Take vertices away a round at a time until there's at most half as many as the level below. Keeping only every few rounds as a
+		// level means half as many levels to walk down, for only a step or two more of hill-climbing on each.
+		Level level;
+		level.hull = *finer;
+		level.toFiner.resize(finer->NumPoints());
+
+		for (int i = 0; i < finer->NumPoints(); i++)
+		{
+			level.toFiner[i] = i;
+		}
+
+		while (level.hull.NumPoints() * 2 > finer->NumPoints())
+		{
+			if (!removeIndependentSet(level.hull, level.toFiner))
+			{
+				break;
+			}
+		}
+
+		if (level.hull.NumPoints() == finer->NumPoints())
+		{
+			break;
+		}
+
+		levels.push_back(level);
+		finer = &levels.back().hull;
+	}
+}
+
+int HullHierarchy::FindFarthestVertex(const glm::vec3& dir) const
+{
+	const ConvexHull* top = levels.empty() ? base : &levels.back().hull;
+
+	// Check every vertex of the top level.
+	int best = 0;
+	float bestDist = -FLT_MAX;
+
+	for (int i = 0; i < top->NumPoints(); i++)
+	{
+		float dist = glm::dot(top->Points()[i], dir);
+
+		if (dist > bestDist)
+		{
+			best = i;
+			bestDist = dist;
+		}
+	}
+
+	// Then walk down, starting each level's hill-climb from where the last one ended.
+	for (int i = (int)levels.size() - 1; i >= 0; i--)
+	{
+		const ConvexHull& below = i > 0 ? levels[i - 1].hull : *base;
+
+		best = below.FindFarthestVertex(below.Points(), dir, levels[i].toFiner[best]);
+	}
+
+	return best;
+}
+
+#endif // _HULL_HIERARCHY_CPP
@@ -0,0 +1,137 @@
+/*
+Title: GJK-3D (OBB)
+File Name: HullHierarchy.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _HULL_HIERARCHY_H
+#define _HULL_HIERARCHY_H
+
+#include "ConvexHull.h"
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include <vector>
+
+// Hulls with fewer vertices than this aren't worth a hierarchy: checking every vertex is about as quick as walking down the levels.
+static const int HULL_HIERARCHY_MIN_VERTICES = 64;
+
+// A Dobkin-Kirkpatrick hierarchy over a hull, for finding its farthest vertex in any direction without checking all of them.
+// Each level is the hull of the level below it with independent sets of its vertices taken away (no two of them neighbors, and none with
+// many neighbors) until at most half are left, so there are only O(log n) levels. The farthest vertex of the top level is found by checking
+// every vertex, and then on each level down the farthest vertex is near the one from the level above (among the vertices that were taken
+// away around it), so it's found by hill-climbing from there in a few steps. Unlike hill-climbing from the last answer (see
+// HillClimbHullShape), that's quick no matter how far the direction turned since the last search.
+class HullHierarchy
+{
+	// One level above the base hull: its hull, and where each of its vertices is in the level below.
+	struct Level
+	{
+		ConvexHull hull;
+		std::vector<int> toFiner;
+	};
+
+	const ConvexHull* base;
+	std::vector<Level> levels;		// From the one just above the base up to the coarsest.
+
+	// Not meant to be copied: each level's hull is a copy of part of the one below, and there's no need for two of them.
+	HullHierarchy(const HullHierarchy&);
+	HullHierarchy& operator=(const HullHierarchy&);
+
+public:
+	// Builds the levels above hull, which has to outlive this. A hull with fewer than HULL_HIERARCHY_MIN_VERTICES vertices gets none.
+	explicit HullHierarchy(const ConvexHull* hull);
+
+	const ConvexHull* Base() const
+	{
+		return base;
+	}
+
+	// How many levels there are, counting the base hull.
+	int NumLevels() const
+	{
+		return (int)levels.size() + 1;
+	}
+
+	// Finds the farthest vertex of the base hull in dir (which is in the hull's local space), and returns its index.
+	int FindFarthestVertex(const glm::vec3& dir) const;
+};
+
+// A hull shape whose support function walks down a HullHierarchy. Like a posed HullShape, it's the hull's own points placed by a pose, so
+// the direction is brought into the hull's space, not every point into the world.
+struct HierarchyHullShape
+{
+	const HullHierarchy* hierarchy;
+	bool posed;
+	glm::vec3 position;
+	glm::quat orientation;
+
+	HierarchyHullShape()
+	{
+		hierarchy = nullptr;
+		posed = false;
+		position = glm::vec3(0.0f);
+		orientation = glm::quat();
+	}
+
+	// The hull as it is (in world space already).
+	HierarchyHullShape(const HullHierarchy* h)
+	{
+		hierarchy = h;
+		posed = false;
+		position = glm::vec3(0.0f);
+		orientation = glm::quat();
+	}
+
+	HierarchyHullShape(const HullHierarchy* h, const glm::vec3& inPosition, const glm::quat& inOrientation)
+	{
+		hierarchy = h;
+		posed = true;
+		position = inPosition;
+		orientation = inOrientation;
+	}
+};
+
+// Gets the farthest point of a given HierarchyHullShape in a given direction.
+inline glm::vec3 getFarthestPointInDirection(const HierarchyHullShape& obj, const glm::vec3& dir)
+{
+	const glm::vec3* points = obj.hierarchy->Base()->Points();
+
+	if (!obj.posed)
+	{
+		return points[obj.hierarchy->FindFarthestVertex(dir)];
+	}
+
+	return obj.position + obj.orientation * points[obj.hierarchy->FindFarthestVertex(glm::conjugate(obj.orientation) * dir)];
+}
+
+#endif //_HULL_HIERARCHY_H
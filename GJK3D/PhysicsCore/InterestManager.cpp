@@ -0,0 +1,176 @@
+/*
+Title: GJK-3D (OBB)
+File Name: InterestManager.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _INTEREST_MANAGER_CPP
+#define _INTEREST_MANAGER_CPP
+
+#include "InterestManager.h"
+#include "PhysicsWorld.h"
+#include <algorithm>
+#include <iterator>
+
+InterestManager::InterestManager(PhysicsWorld& inWorld) : world(inWorld)
+{
+	margin = 1.0f;
+}
+
+int InterestManager::AddClient()
+{
+	int client;
+
+	if (freeClients.empty())
+	{
+		client = (int)clients.size();
+		clients.push_back(Client());
+	}
+	else
+	{
+		client = freeClients.back();
+		freeClients.pop_back();
+	}
+
+	Client& added = clients[client];
+	added.active = true;
+	added.shape = INTEREST_SPHERE;
+	added.center = glm::vec3(0.0f);
+	added.radius = 0.0f;
+	added.objects.clear();
+	added.entered.clear();
+	added.left.clear();
+
+	return client;
+}
+
+void InterestManager::RemoveClient(int client)
+{
+	Client& removed = clients[client];
+
+	if (!removed.active)
+	{
+		return;
+	}
+
+	removed.active = false;
+	removed.objects.clear();
+	removed.entered.clear();
+	removed.left.clear();
+
+	freeClients.push_back(client);
+}
+
+void InterestManager::Update()
+{
+	JobSystem* jobs = world.GetJobSystem();
+
+	auto updateClients = [this](int begin, int end, int thread)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			if (clients[i].active)
+			{
+				updateClient(clients[i]);
+			}
+		}
+	};
+
+	JobCounter done;
+
+	jobs->SubmitFor((int)clients.size(), 1, updateClients, done);
+	jobs->Wait(done);
+}
+
+void InterestManager::updateClient(Client& client)
+{
+	// Cull with the area grown by the margin, which takes in everything that could be in the set. Then each object is only in it if it's
+	// in the area itself, or it was in the set already.
+	Frustum outer;
+
+	if (client.shape == INTEREST_SPHERE)
+	{
+		glm::vec3 reach(client.radius + margin);
+
+		outer = Frustum(AABB(client.center - reach, client.center + reach));
+	}
+	else
+	{
+		outer = client.frustum.Grown(margin);
+	}
+
+	client.previous.swap(client.objects);
+	client.objects.clear();
+
+	world.Cull(outer, client.found, client.foundStatic);
+
+	for (int i = 0; i < (int)client.found.size(); i++)
+	{
+		int object = client.found[i];
+		AABB box = world.GetBounds(object);
+
+		bool inside;
+
+		if (client.shape == INTEREST_SPHERE)
+		{
+			// How far the center is from the closest point of the box.
+			glm::vec3 closest = glm::clamp(client.center, box.min, box.max);
+			float distance = glm::length(closest - client.center);
+
+			inside = distance <= client.radius || (distance <= client.radius + margin &&
+				std::binary_search(client.previous.begin(), client.previous.end(), object));
+		}
+		else
+		{
+			inside = client.frustum.Overlaps(box) || std::binary_search(client.previous.begin(), client.previous.end(), object);
+		}
+
+		if (inside)
+		{
+			client.objects.push_back(object);
+		}
+	}
+
+	std::sort(client.objects.begin(), client.objects.end());
+
+	// Both sets are in order, so one walk along them finds what's only in the new one and what's only in the old one.
+	client.entered.clear();
+	client.left.clear();
+
+	std::set_difference(client.objects.begin(), client.objects.end(), client.previous.begin(), client.previous.end(),
+		std::back_inserter(client.entered));
+	std::set_difference(client.previous.begin(), client.previous.end(), client.objects.begin(), client.objects.end(),
+		std::back_inserter(client.left));
+}
+
+#endif // _INTEREST_MANAGER_CPP
@@ -0,0 +1,149 @@
+/*
+Title: GJK-3D (OBB)
+File Name: InterestManager.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _INTEREST_MANAGER_H
+#define _INTEREST_MANAGER_H
+
+#include "Frustum.h"
+#include <vector>
+
+class PhysicsWorld;
+
+// What a client's area of interest is.
+enum InterestShape
+{
+	INTEREST_SPHERE,	// Everything within a radius of a point (what a player could ever see or hear, whichever way they're facing).
+	INTEREST_FRUSTUM	// Everything in a view volume (what their camera can see).
+};
+
+// Keeps track of which objects each of a number of clients is interested in, for replicating them over the network: every Update finds
+// the objects in each client's area of interest with the broadphase (see PhysicsWorld::Cull), and compares them with the last Update's,
+// so the replication only has to send what came into view (to start sending it) and what went out of it (to stop). The cost of an Update
+// goes with how many objects the clients can see, not with how many there are in the world.
+// An object that's already in a client's set stays in it until it's further than the margin outside the area, so one sitting on the edge
+// doesn't keep coming and going.
+// Disabled objects aren't in the broadphase, so an object that's disabled leaves every set it was in.
+class InterestManager
+{
+	struct Client
+	{
+		bool active;
+		InterestShape shape;
+		glm::vec3 center;
+		float radius;
+		Frustum frustum;
+
+		// The objects in its area as of the last Update, in order, and which of them came in and went out in that Update.
+		std::vector<int> objects;
+		std::vector<int> entered;
+		std::vector<int> left;
+
+		// Used by updateClient, so each one doesn't allocate.
+		std::vector<int> found;
+		std::vector<int> foundStatic;
+		std::vector<int> previous;
+	};
+
+	PhysicsWorld& world;
+
+	std::vector<Client> clients;
+
+	// The clients that have been removed, whose slots are free to be used again.
+	std::vector<int> freeClients;
+
+	float margin;
+
+	// Finds the objects in a client's area, and what's changed since last time.
+	void updateClient(Client& client);
+
+public:
+	// Keeps track of objects in world, which has to outlive the manager.
+	InterestManager(PhysicsWorld& inWorld);
+
+	// Adds a client, and returns its index. Its area starts out as a sphere with a radius of 0, so it isn't interested in anything until it's
+	// given an area.
+	int AddClient();
+
+	// Removes a client. Its index may be given to the next client added.
+	void RemoveClient(int client);
+
+	// Sets a client's area to everything within radius of center, or everything in a frustum. Either takes effect in the next Update.
+	void SetSphere(int client, const glm::vec3& center, float radius)
+	{
+		clients[client].shape = INTEREST_SPHERE;
+		clients[client].center = center;
+		clients[client].radius = radius;
+	}
+	void SetFrustum(int client, const Frustum& frustum)
+	{
+		clients[client].shape = INTEREST_FRUSTUM;
+		clients[client].frustum = frustum;
+	}
+
+	// How far outside its area an object that's already in a client's set has to get before it leaves. It's 1 to begin with.
+	void SetMargin(float distance)
+	{
+		margin = glm::max(0.0f, distance);
+	}
+
+	// Finds what's in every client's area now, and what came in and went out since the last Update. The clients are spread across the
+	// world's job system. Call this between steps, on the thread that steps the world.
+	void Update();
+
+	int NumClients() const
+	{
+		return (int)clients.size();
+	}
+
+	// The objects in a client's area as of the last Update, in order.
+	const std::vector<int>& GetObjects(int client) const
+	{
+		return clients[client].objects;
+	}
+
+	// The objects that came into a client's area, and that went out of it, in the last Update (each in order). A client's first Update has
+	// everything in its area come in.
+	const std::vector<int>& GetEntered(int client) const
+	{
+		return clients[client].entered;
+	}
+	const std::vector<int>& GetLeft(int client) const
+	{
+		return clients[client].left;
+	}
+};
+
+#endif //_INTEREST_MANAGER_H
@@ -0,0 +1,748 @@
+/*
+Title: GJK-3D (OBB)
+File Name: JobSystem.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _JOB_SYSTEM_CPP
+#define _JOB_SYSTEM_CPP
+
+#include "JobSystem.h"
+#include "glm\glm.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+// Visual Studio before 2015 has no thread_local, only its own __declspec(thread), which does the same for plain values like these.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define JOB_THREAD_LOCAL __declspec(thread)
+#else
+#define JOB_THREAD_LOCAL thread_local
+#endif
+
+// The index of the thread we're on. The workers set theirs when they start, and any other thread counts as 0 (see Wait). It's also which
+// queue and arena a job that waits inside another job uses.
+static JOB_THREAD_LOCAL int currentThread = 0;
+
+// The priority of the job the thread is running, which is what a batch submitted with JOB_INHERIT gets.
+static JOB_THREAD_LOCAL JobPriority currentPriority = JOB_NORMAL;
+
+// The deadline of a background batch without one.
+static const double NO_DEADLINE = 1e300;
+
+// Reads a list of numbers like "0-3,8-11" (the way Linux lists processors and nodes) into numbers.
+static void parseNumberList(const char* text, std::vector<int>& numbers)
+{
+	while (*text != '\0')
+	{
+		char* end;
+		long first = strtol(text, &end, 10);
+
+		if (end == text)
+		{
+			break;
+		}
+
+		long last = first;
+		text = end;
+
+		if (*text == '-')
+		{
+			last = strtol(text + 1, &end, 10);
+			text = end;
+		}
+
+		for (long i = first; i <= last; i++)
+		{
+			numbers.push_back((int)i);
+		}
+
+		while (*text == ',' || *text == '\n' || *text == ' ')
+		{
+			text++;
+		}
+	}
+}
+
+// Reads the first line of a (small) file, returning false if there isn't one.
+static bool readLine(const std::string& fileName, char* line, int size)
+{
+	FILE* in = fopen(fileName.c_str(), "r");
+
+	if (in == nullptr)
+	{
+		return false;
+	}
+
+	bool read = fgets(line, size, in) != nullptr;
+	fclose(in);
+
+	return read;
+}
+
+void GetNumaNodes(std::vector<std::vector<int>>& nodes)
+{
+	nodes.clear();
+
+#if defined(_WIN32)
+	ULONG highest = 0;
+
+	if (GetNumaHighestNodeNumber(&highest))
+	{
+		for (ULONG node = 0; node <= highest; node++)
+		{
+			ULONGLONG mask = 0;
+
+			if (!GetNumaNodeProcessorMask((UCHAR)node, &mask) || mask == 0)
+			{
+				continue;
+			}
+
+			nodes.push_back(std::vector<int>());
+
+			for (int processor = 0; processor < 64; processor++)
+			{
+				if ((mask >> processor) & 1)
+				{
+					nodes.back().push_back(processor);
+				}
+			}
+		}
+	}
+#elif defined(__linux__)
+	char line[4096];
+	std::vector<int> online;
+
+	if (readLine("/sys/devices/system/node/online", line, sizeof(line)))
+	{
+		parseNumberList(line, online);
+	}
+
+	for (int i = 0; i < (int)online.size(); i++)
+	{
+		std::vector<int> processors;
+
+		if (readLine("/sys/devices/system/node/node" + std::to_string(online[i]) + "/cpulist", line, sizeof(line)))
+		{
+			parseNumberList(line, processors);
+		}
+
+		// A node can have memory and no processors, which is no use to us.
+		if (!processors.empty())
+		{
+			nodes.push_back(processors);
+		}
+	}
+#endif
+
+	if (nodes.empty())
+	{
+		int count = glm::max((int)std::thread::hardware_concurrency(), 1);
+
+		nodes.push_back(std::vector<int>());
+
+		for (int i = 0; i < count; i++)
+		{
+			nodes.back().push_back(i);
+		}
+	}
+}
+
+// Pins the calling thread to the given processors. Returns false if it can't (or we don't know how, here).
+static bool pinCurrentThread(const std::vector<int>& processors)
+{
+#if defined(_WIN32)
+	DWORD_PTR mask = 0;
+
+	for (int i = 0; i < (int)processors.size(); i++)
+	{
+		if (processors[i] < (int)sizeof(DWORD_PTR) * 8)
+		{
+			mask |= (DWORD_PTR)1 << processors[i];
+		}
+	}
+
+	return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	for (int i = 0; i < (int)processors.size(); i++)
+	{
+		if (processors[i] < CPU_SETSIZE)
+		{
+			CPU_SET(processors[i], &set);
+		}
+	}
+
+	return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+JobSystem::JobSystem(int threadCount)
+{
+	start(JobSystemSettings(threadCount));
+}
+
+JobSystem::JobSystem(const JobSystemSettings& settings)
+{
+	start(settings);
+}
+
+void JobSystem::start(const JobSystemSettings& settings)
+{
+	int threadCount = settings.threadCount;
+
+	if (threadCount <= 0)
+	{
+		threadCount = (int)std::thread::hardware_concurrency();
+
+		// hardware_concurrency is allowed to return 0 if it can't tell.
+		if (threadCount <= 0)
+		{
+			threadCount = 1;
+		}
+	}
+
+	queued = 0;
+	quit = false;
+	earliestDeadline = NO_DEADLINE;
+
+	for (int i = 0; i < JOB_PRIORITY_COUNT; i++)
+	{
+		queuedAt[i] = 0;
+	}
+
+	nextQueue = 0;
+	unfinished = 0;
+	pinnedThreads = 0;
+	started = 0;
+
+	std::vector<std::vector<int>> nodes;
+	GetNumaNodes(nodes);
+
+	// The order processors are handed out in: a processor from each node in turn, or every processor of one node and then the next, or
+	// (with no NUMA policy) just every processor in order.
+	std::vector<int> order;
+	std::vector<int> processorNodes;
+
+	if (settings.numa == NUMA_SPREAD)
+	{
+		for (int i = 0; (int)order.size() < threadCount || i == 0; i++)
+		{
+			bool any = false;
+
+			for (int node = 0; node < (int)nodes.size(); node++)
+			{
+				if (i < (int)nodes[node].size())
+				{
+					order.push_back(nodes[node][i]);
+					processorNodes.push_back(node);
+					any = true;
+				}
+			}
+
+			if (!any)
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		for (int node = 0; node < (int)nodes.size(); node++)
+		{
+			for (int i = 0; i < (int)nodes[node].size(); i++)
+			{
+				order.push_back(nodes[node][i]);
+				processorNodes.push_back(settings.numa == NUMA_OFF ? 0 : node);
+			}
+		}
+
+		if (settings.numa == NUMA_OFF)
+		{
+			std::sort(order.begin(), order.end());
+		}
+	}
+
+	threadNodes.resize(threadCount, 0);
+	threadProcessors.resize(threadCount);
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		if (!settings.affinityMasks.empty())
+		{
+			unsigned long long mask = settings.affinityMasks[i % settings.affinityMasks.size()];
+
+			for (int processor = 0; processor < 64; processor++)
+			{
+				if ((mask >> processor) & 1)
+				{
+					threadProcessors[i].push_back(processor);
+				}
+			}
+
+			// The node of the lowest processor in the mask.
+			for (int node = 0; node < (int)nodes.size() && settings.numa != NUMA_OFF && !threadProcessors[i].empty(); node++)
+			{
+				if (std::find(nodes[node].begin(), nodes[node].end(), threadProcessors[i][0]) != nodes[node].end())
+				{
+					threadNodes[i] = node;
+					break;
+				}
+			}
+		}
+		else if (!order.empty())
+		{
+			int slot = i % (int)order.size();
+
+			threadNodes[i] = processorNodes[slot];
+
+			if (settings.pinThreads)
+			{
+				threadProcessors[i].push_back(order[slot]);
+			}
+		}
+	}
+
+	nodeThreads.resize(settings.numa == NUMA_OFF ? 1 : nodes.size());
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		nodeThreads[threadNodes[i]].push_back(i);
+	}
+
+	// Each thread steals from the rest of its node first, starting with the next thread along so that thieves spread out over the queues,
+	// and then from the other nodes' threads the same way.
+	stealOrder.resize(threadCount);
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (int j = 1; j < threadCount; j++)
+			{
+				int other = (i + j) % threadCount;
+
+				if ((threadNodes[other] == threadNodes[i]) == (pass == 0))
+				{
+					stealOrder[i].push_back(other);
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		queues.push_back(new JobQueue());
+		arenas.push_back(nullptr);
+		threadStats.push_back(new ThreadStats());
+	}
+
+	ResetStats();
+
+	// Thread 0 is the calling thread, so it's pinned here (if it's to be), and its arena is made here. The workers do both for themselves.
+	pin(0);
+	arenas[0] = new StepArena();
+
+	for (int i = 1; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+	}
+
+	while (started < threadCount - 1)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void JobSystem::pin(int thread)
+{
+	if (!threadProcessors[thread].empty() && pinCurrentThread(threadProcessors[thread]))
+	{
+		pinnedThreads++;
+	}
+}
+
+JobSystemStats JobSystem::GetStats() const
+{
+	JobSystemStats stats;
+	stats.jobs = 0;
+	stats.steals = 0;
+	stats.remoteSteals = 0;
+	stats.pinnedThreads = pinnedThreads;
+
+	for (int i = 0; i < (int)threadStats.size(); i++)
+	{
+		stats.jobs += threadStats[i]->jobs.load(std::memory_order_relaxed);
+		stats.steals += threadStats[i]->steals.load(std::memory_order_relaxed);
+		stats.remoteSteals += threadStats[i]->remoteSteals.load(std::memory_order_relaxed);
+	}
+
+	return stats;
+}
+
+void JobSystem::ResetStats()
+{
+	for (int i = 0; i < (int)threadStats.size(); i++)
+	{
+		threadStats[i]->jobs.store(0, std::memory_order_relaxed);
+		threadStats[i]->steals.store(0, std::memory_order_relaxed);
+		threadStats[i]->remoteSteals.store(0, std::memory_order_relaxed);
+	}
+}
+
+void JobSystem::Reserve(int count, JobPriority priority)
+{
+	for (int i = 0; i < (int)queues.size(); i++)
+	{
+		std::lock_guard<std::mutex> lock(queues[i]->mutex);
+		JobRing& ring = queues[i]->rings[priority];
+
+		if (count > (int)ring.jobs.size())
+		{
+			ring.Resize(count);
+		}
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		quit = true;
+	}
+
+	wake.notify_all();
+
+	for (int i = 0; i < (int)workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	for (int i = 0; i < (int)queues.size(); i++)
+	{
+		delete queues[i];
+		delete arenas[i];
+		delete threadStats[i];
+	}
+}
+
+void JobSystem::Submit(JobFunction function, void* data, int begin, int end, JobCounter& counter, JobCounter* dependency)
+{
+	Job job;
+	job.function = function;
+	job.data = data;
+	job.begin = begin;
+	job.end = end;
+	job.counter = &counter;
+	job.priority = counter.priority == JOB_INHERIT ? currentPriority : counter.priority;
+
+	counter.remaining++;
+	unfinished++;
+
+	// If the job has to wait, park it on the counter it's waiting for. The check is made under that counter's lock, and the thread that
+	// finishes its last job takes the same lock to release the parked jobs, so a job can't get parked just after they were released.
+	if (dependency != nullptr)
+	{
+		std::lock_guard<std::mutex> lock(dependency->mutex);
+
+		if (dependency->remaining > 0)
+		{
+			ParkedJob* parked = arenas[currentThread]->Allocate<ParkedJob>(1);
+			parked->job = job;
+			parked->next = nullptr;
+
+			if (dependency->lastDependent != nullptr)
+			{
+				dependency->lastDependent->next = parked;
+			}
+			else
+			{
+				dependency->firstDependent = parked;
+			}
+
+			dependency->lastDependent = parked;
+			return;
+		}
+	}
+
+	enqueue(job);
+}
+
+void JobSystem::enqueue(const Job& job)
+{
+	// Round-robin over the threads on the submitting thread's node (which, with no NUMA policy, is all of them).
+	const std::vector<int>& local = nodeThreads[threadNodes[currentThread]];
+	JobQueue* queue = queues[local[nextQueue++ % local.size()]];
+
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->rings[job.priority].PushBack(job);
+	}
+
+	queuedAt[job.priority]++;
+
+	if (job.priority == JOB_BACKGROUND && job.counter->deadline > 0.0)
+	{
+		double earliest = earliestDeadline;
+
+		while (job.counter->deadline < earliest && !earliestDeadline.compare_exchange_weak(earliest, job.counter->deadline))
+		{
+		}
+	}
+
+	// Taking the sleep lock before notifying means a worker can't check queued, miss this job and then go to sleep right after we notify.
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		queued++;
+	}
+
+	wake.notify_one();
+}
+
+bool JobSystem::takeJob(int thread, JobPriority lowest, Job& job)
+{
+	// Overdue background jobs first. The clock is only read when there are background jobs about, and what it says is only acted on when the
+	// earliest deadline has gone by.
+	if (queuedAt[JOB_BACKGROUND] > 0 && earliestDeadline <= clock.Now() && takeJobAt(thread, JOB_BACKGROUND, true, job))
+	{
+		return true;
+	}
+
+	for (int priority = JOB_CRITICAL; priority <= lowest; priority++)
+	{
+		if (queuedAt[priority] > 0 && takeJobAt(thread, priority, false, job))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool JobSystem::takeJobAt(int thread, int priority, bool overdue, Job& job)
+{
+	double now = overdue ? clock.Now() : 0.0;
+	double earliest = NO_DEADLINE;
+
+	// Our own queue first, from the back. (Unless we're after overdue jobs, which are the oldest, so they're at the front like anyone else's.)
+	if (!overdue)
+	{
+		JobQueue* queue = queues[thread];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		JobRing& ring = queue->rings[priority];
+
+		if (!ring.Empty())
+		{
+			job = ring.PopBack();
+			queuedAt[priority]--;
+			queued--;
+
+			return true;
+		}
+	}
+
+	// Then everyone else's (ours too, for overdue jobs), from the front, in the thread's steal order (the rest of its node first).
+	const std::vector<int>& order = stealOrder[thread];
+
+	for (int i = overdue ? -1 : 0; i < (int)order.size(); i++)
+	{
+		int owner = i < 0 ? thread : order[i];
+		JobQueue* queue = queues[owner];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		JobRing& ring = queue->rings[priority];
+
+		if (ring.Empty())
+		{
+			continue;
+		}
+
+		if (overdue)
+		{
+			double deadline = ring.Front().counter->deadline > 0.0 ? ring.Front().counter->deadline : NO_DEADLINE;
+
+			if (deadline > now)
+			{
+				earliest = glm::min(earliest, deadline);
+				continue;
+			}
+		}
+
+		job = ring.PopFront();
+		queuedAt[priority]--;
+		queued--;
+
+		if (owner != thread)
+		{
+			threadStats[thread]->steals.fetch_add(1, std::memory_order_relaxed);
+
+			if (threadNodes[owner] != threadNodes[thread])
+			{
+				threadStats[thread]->remoteSteals.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		return true;
+	}
+
+	// Nothing was overdue after all (the one that set the hint has been taken), so the hint moves on to the earliest deadline at the front
+	// of a queue. One further back that's earlier still is found once the jobs in front of it have gone. (A job queued while we were
+	// looking can lose its deadline from the hint here. It still runs, just not ahead of the rest.)
+	if (overdue)
+	{
+		earliestDeadline = earliest;
+	}
+
+	return false;
+}
+
+void JobSystem::runJob(const Job& job, int thread)
+{
+	// A job can wait on jobs of its own, running other jobs meanwhile, so the priority it's replacing is put back after.
+	JobPriority outer = currentPriority;
+
+	currentPriority = job.priority;
+	job.function(job.data, job.begin, job.end, thread);
+	currentPriority = outer;
+
+	threadStats[thread]->jobs.fetch_add(1, std::memory_order_relaxed);
+
+	JobCounter* counter = job.counter;
+
+	// Hold the counter's lock while it reaches zero, so that Submit can't park a job on it after we've released the waiting ones.
+	ParkedJob* ready = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(counter->mutex);
+
+		if (--counter->remaining == 0)
+		{
+			ready = counter->firstDependent;
+
+			counter->firstDependent = nullptr;
+			counter->lastDependent = nullptr;
+		}
+	}
+
+	// That was the last job in the batch, so everything that was waiting on it can go now.
+	for (ParkedJob* parked = ready; parked != nullptr; parked = parked->next)
+	{
+		enqueue(parked->job);
+	}
+
+	// Only once the jobs it released are queued (and counted), so unfinished can't touch 0 while any are still parked.
+	unfinished--;
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	// Rather than block, the waiting thread runs jobs too. If there's nothing left to take, the last jobs are running on other threads, so
+	// we just yield until they're done.
+	int thread = currentThread;
+	JobPriority lowest = counter.priority == JOB_INHERIT ? currentPriority : counter.priority;
+
+	while (counter.remaining > 0)
+	{
+		Job job;
+
+		if (takeJob(thread, lowest, job))
+		{
+			runJob(job, thread);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// The thread that ran the last job may still be letting go of the counter's lock. Take it once ourselves, so that the counter can be
+	// safely destroyed as soon as we return.
+	{
+		std::lock_guard<std::mutex> lock(counter.mutex);
+	}
+
+	// If that was all of the work, nothing is using the arenas, and the workers won't touch them again until we submit more.
+	if (unfinished == 0)
+	{
+		for (int i = 0; i < (int)arenas.size(); i++)
+		{
+			arenas[i]->Reset();
+		}
+	}
+}
+
+void JobSystem::workerLoop(int thread)
+{
+	currentThread = thread;
+
+	// The arena is made here rather than by the constructor, so its memory is first touched by (and so placed on the node of) this thread.
+	pin(thread);
+	arenas[thread] = new StepArena();
+	started++;
+
+	while (true)
+	{
+		Job job;
+
+		if (takeJob(thread, JOB_BACKGROUND, job))
+		{
+			runJob(job, thread);
+			continue;
+		}
+
+		// Nothing to do, so sleep until a job is submitted (or we're told to quit).
+		std::unique_lock<std::mutex> lock(sleepMutex);
+
+		wake.wait(lock, [this]() { return quit || queued > 0; });
+
+		if (quit)
+		{
+			return;
+		}
+	}
+}
+
+#endif //_JOB_SYSTEM_CPP
@@ -0,0 +1,444 @@
+/*
+Title: GJK-3D (OBB)
+File Name: JobSystem.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _JOB_SYSTEM_H
+#define _JOB_SYSTEM_H
+
+#include "Clock.h"
+#include "StepArena.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The function a job runs. It gets the data it was created with, the range of items to work on, and the index of the thread running it
+// (0 is the thread that created the JobSystem, the workers are 1 and up). The thread index is what lets jobs write into per-thread buffers
+// without any locking.
+typedef void (*JobFunction)(void* data, int begin, int end, int thread);
+
+struct Job;
+struct ParkedJob;
+
+// How urgent a batch of jobs is. Ready jobs are always taken most urgent first, whichever thread's queue they're in, so the step's critical
+// path (broadphase, then narrowphase, then the solver) isn't held up behind work that could wait, like building debug drawing or gathering
+// statistics.
+enum JobPriority
+{
+	JOB_CRITICAL,		// On the path to the end of the step. The physics step's own stages are critical.
+	JOB_NORMAL,
+	JOB_BACKGROUND,		// Nice to have done, but nothing is waiting on it right now. Only threads with nothing else to do take these.
+	JOB_PRIORITY_COUNT,
+
+	JOB_INHERIT = JOB_PRIORITY_COUNT	// Whatever the job submitting it is running at (JOB_NORMAL outside of any job).
+};
+
+// Counts the jobs in a batch that haven't finished yet. Wait on it to know the whole batch is done, or submit jobs that depend on it.
+// A job can add children to the counter it is running under (by submitting them with it). Since the children are added before the job
+// itself finishes, the counter can't reach zero until the children are done as well.
+// Every job in a batch has the counter's priority. A background batch can also have a deadline, a time on the job system's clock (see
+// JobSystem::Now): once that has passed, its jobs are taken ahead of everything else, so a long run of critical work can't hold them off
+// forever.
+struct JobCounter
+{
+	std::atomic<int> remaining;
+
+	JobPriority priority;
+	double deadline;
+
+	// The jobs waiting for this counter to reach zero (first to last, in the order they were submitted), and the lock that protects them.
+	std::mutex mutex;
+	ParkedJob* firstDependent;
+	ParkedJob* lastDependent;
+
+	JobCounter(JobPriority priority = JOB_INHERIT, double deadline = 0.0)
+	{
+		remaining = 0;
+		this->priority = priority;
+		this->deadline = deadline;
+		firstDependent = nullptr;
+		lastDependent = nullptr;
+	}
+};
+
+struct Job
+{
+	JobFunction function;
+	void* data;
+	int begin;
+	int end;
+	JobCounter* counter;
+	JobPriority priority;
+};
+
+// A job waiting on a counter. These come out of the submitting thread's arena, since they're gone by the time the job system runs dry.
+struct ParkedJob
+{
+	Job job;
+	ParkedJob* next;
+};
+
+// The jobs of one priority waiting on one thread. The owner takes jobs from the back (the newest, whose data is most likely still in its
+// cache) and other threads steal from the front (the oldest, which tend to be the biggest pieces of work left).
+// The jobs are kept in a ring, which only ever grows, so once it's big enough for a step, queueing never touches the heap. (A deque
+// allocates and frees its chunks as it fills up and empties, which it does every step.)
+struct JobRing
+{
+	std::vector<Job> jobs;
+	int first;
+	int count;
+
+	JobRing()
+	{
+		jobs.resize(64);
+		first = 0;
+		count = 0;
+	}
+
+	bool Empty() const
+	{
+		return count == 0;
+	}
+
+	// Unrolls the ring into one of the given size (which has to be at least count).
+	void Resize(int size)
+	{
+		std::vector<Job> bigger(size);
+
+		for (int i = 0; i < count; i++)
+		{
+			bigger[i] = jobs[(first + i) % jobs.size()];
+		}
+
+		jobs.swap(bigger);
+		first = 0;
+	}
+
+	void PushBack(const Job& job)
+	{
+		// Full, so double it.
+		if (count == (int)jobs.size())
+		{
+			Resize((int)jobs.size() * 2);
+		}
+
+		jobs[(first + count) % jobs.size()] = job;
+		count++;
+	}
+
+	Job PopBack()
+	{
+		count--;
+
+		return jobs[(first + count) % jobs.size()];
+	}
+
+	Job PopFront()
+	{
+		Job job = jobs[first];
+
+		first = (first + 1) % jobs.size();
+		count--;
+
+		return job;
+	}
+
+	const Job& Front() const
+	{
+		return jobs[first];
+	}
+};
+
+// The jobs waiting on one thread, a ring for each priority, and the lock that protects them.
+struct JobQueue
+{
+	std::mutex mutex;
+	JobRing rings[JOB_PRIORITY_COUNT];
+};
+
+// How a JobSystem places its threads on a machine with more than one NUMA node (a dual socket server, say, where each socket has its own
+// memory, and reaching the other socket's is slower).
+enum NumaPolicy
+{
+	NUMA_OFF,		// Pay no attention to the nodes: every thread counts as being on the same one. (The default.)
+	NUMA_SPREAD,	// Deal the threads out over the nodes in turn, so each node gets its share of them.
+	NUMA_COMPACT	// Fill one node's processors before going on to the next, so a few threads all stay on one node.
+};
+
+// How a JobSystem starts its threads.
+// With a NUMA policy, each thread belongs to a node: a thread's jobs are queued on threads of its own node, and a thread out of work steals
+// from the other threads on its node before it goes to another node for work. Memory ends up on the node of the thread that first writes to
+// it (that's how Windows and Linux both place it by default), so work that stays on one node keeps using that node's memory. Each thread's
+// arena is made on the thread itself, for the same reason.
+// The nodes only mean something if the threads stay on them, so a NUMA policy usually wants pinThreads as well.
+struct JobSystemSettings
+{
+	// How many threads in total, counting the calling thread. 0 means one per hardware thread.
+	int threadCount;
+
+	NumaPolicy numa;
+
+	// Whether to pin each thread (the calling thread too, since it runs jobs as thread 0) to the processors it's given. Without affinity masks,
+	// each thread gets one processor, in the order the NUMA policy gives them out (or in order, with NUMA_OFF), going around again if there
+	// are more threads than processors.
+	bool pinThreads;
+
+	// If not empty, thread i is pinned to the processors set in affinityMasks[i % affinityMasks.size()] (bit n for processor n, so only the
+	// first 64 processors can be named), and is on the node its lowest processor is on. These override pinThreads.
+	std::vector<unsigned long long> affinityMasks;
+
+	JobSystemSettings(int threads = 0)
+	{
+		threadCount = threads;
+		numa = NUMA_OFF;
+		pinThreads = false;
+	}
+};
+
+// What a JobSystem's threads have done since it started (or since ResetStats).
+struct JobSystemStats
+{
+	long long jobs;			// Jobs run, on every thread.
+	long long steals;		// Jobs a thread took from another thread's queue.
+	long long remoteSteals;	// The steals from a thread on another node. Each is a job that's likely to be using the other node's memory.
+	int pinnedThreads;		// How many threads were pinned (pinning can fail, or not be supported, which just leaves the thread where it is).
+};
+
+// The processors on each of the machine's NUMA nodes, by the numbers the operating system gives them. Where we can't tell (or there's only
+// one), that's one node with every processor on it.
+void GetNumaNodes(std::vector<std::vector<int>>& nodes);
+
+// A pool of worker threads that run jobs, with work stealing.
+// Every thread (including the one that owns the JobSystem) has its own queue. A thread runs the jobs in its own queue first, and when it runs
+// out it steals from the other queues, so no thread sits idle while there is still work anywhere. The owning thread helps out while it waits,
+// so a JobSystem with 1 thread simply runs everything on the calling thread.
+class JobSystem
+{
+	std::vector<std::thread> workers;
+	std::vector<JobQueue*> queues;
+
+	// How many jobs are sitting in queues, and the lock and condition idle workers sleep on until that is more than zero.
+	std::atomic<int> queued;
+
+	// How many of those are at each priority, so that taking a job can skip the priorities with nothing in them without locking anything.
+	std::atomic<int> queuedAt[JOB_PRIORITY_COUNT];
+
+	// The clock deadlines are measured on, and the earliest deadline of any background job that's been queued, or a very large number if
+	// there isn't one. It's only a hint for when to go looking for overdue jobs: it's worked out again each time we do.
+	SteadyClock clock;
+	std::atomic<double> earliestDeadline;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+
+	bool quit;
+
+	// Which queue the next job goes to. Jobs are handed out round-robin so every thread starts off with some of its own.
+	std::atomic<unsigned int> nextQueue;
+
+	// Each thread's arena, and how many jobs have been submitted but haven't finished (running, queued or parked). When that gets back to 0,
+	// nothing can be using the arenas any more, so Wait resets them.
+	std::vector<StepArena*> arenas;
+	std::atomic<int> unfinished;
+
+	// Which node each thread is on, the threads on each node, and the order each thread goes through the others' queues when it steals:
+	// the rest of its own node first, then the other nodes. (With NUMA_OFF there's one node, and the order is just the next thread along.)
+	std::vector<int> threadNodes;
+	std::vector<std::vector<int>> nodeThreads;
+	std::vector<std::vector<int>> stealOrder;
+
+	// What each thread has done (see JobSystemStats), which only that thread writes, and its processors if it's to be pinned (empty if not).
+	// The counters are padded out to their own cache line, since every thread bumps its own all the time.
+	struct ThreadStats
+	{
+		std::atomic<long long> jobs;
+		std::atomic<long long> steals;
+		std::atomic<long long> remoteSteals;
+		char padding[64 - 3 * sizeof(long long)];
+	};
+
+	std::vector<ThreadStats*> threadStats;
+	std::vector<std::vector<int>> threadProcessors;
+	std::atomic<int> pinnedThreads;
+
+	// How many workers have made their arenas. The constructor waits for all of them.
+	std::atomic<int> started;
+
+	// Works out the threads' nodes and processors, and starts the workers.
+	void start(const JobSystemSettings& settings);
+
+	// Pins the calling thread to thread's processors, if it has any.
+	void pin(int thread);
+
+	// Puts a job that is ready to run into a queue.
+	void enqueue(const Job& job);
+
+	// Takes the most urgent job there is, no less urgent than lowest, from thread's own queue or stolen from another. Background jobs past
+	// their deadline come first. Returns false if there are none.
+	bool takeJob(int thread, JobPriority lowest, Job& job);
+
+	// Takes a job of the given priority, from thread's own queue or stolen from another. With overdue, it only takes background jobs past
+	// their deadline (and works out earliestDeadline again from the ones it looks at).
+	bool takeJobAt(int thread, int priority, bool overdue, Job& job);
+
+	void runJob(const Job& job, int thread);
+
+	void workerLoop(int thread);
+
+public:
+	// Starts the pool with the given number of threads in total, counting the calling thread. 0 means one per hardware thread.
+	JobSystem(int threadCount = 0);
+
+	// Starts the pool as settings says (see JobSystemSettings).
+	explicit JobSystem(const JobSystemSettings& settings);
+
+	// Waits for the workers to finish what they are running and stops them. Jobs still in the queues are not run.
+	~JobSystem();
+
+	int GetThreadCount() const
+	{
+		return (int)queues.size();
+	}
+
+	// How many NUMA nodes the threads are spread over (1 with NUMA_OFF), and which one a thread is on.
+	int GetNodeCount() const
+	{
+		return (int)nodeThreads.size();
+	}
+	int GetThreadNode(int thread) const
+	{
+		return threadNodes[thread];
+	}
+
+	JobSystemStats GetStats() const;
+	void ResetStats();
+
+	// Makes room in every thread's queue for count jobs of the given priority at once, so queueing that many never has to grow one. (Which
+	// queue a job goes in depends on which thread submits it, so each one gets room for them all.)
+	void Reserve(int count, JobPriority priority = JOB_CRITICAL);
+
+	// The time on the clock deadlines are set against (see JobCounter), in seconds.
+	double Now()
+	{
+		return clock.Now();
+	}
+
+	// A thread's arena (see StepArena), for memory a job only needs for a little while: a job can allocate from the arena of the thread
+	// it's running on without any locking. Everything in the arenas stays valid until the job system next runs out of work (when a Wait
+	// finds nothing left running, queued or waiting). For the physics, that's the end of the step.
+	StepArena& GetArena(int thread)
+	{
+		return *arenas[thread];
+	}
+
+	// Queues a job, adding it to counter. If dependency is given, the job doesn't start until every job in dependency has finished.
+	// This can be called from inside a job, which is how a job adds children to its own counter.
+	void Submit(JobFunction function, void* data, int begin, int end, JobCounter& counter, JobCounter* dependency = nullptr);
+
+	// Runs jobs on the calling thread until every job in counter is done.
+	// It only runs jobs at least as urgent as counter's (and background jobs past their deadline), so waiting on the step doesn't start on
+	// some long piece of background work just as the step is about to finish. That leaves the background jobs to the workers, or to a
+	// Wait on their own counter, so a batch must not depend on one less urgent than itself.
+	// The calling thread works as thread 0, so only one thread that isn't a worker can use the job system (usually the one that created it,
+	// but it can be handed over to another, like a physics thread, as long as the first one stops using it).
+	// A job can wait too. Its worker keeps running jobs as itself until counter is done, so the thread is never idle (which is how
+	// StepWorlds steps many worlds at once, each waiting on its own step inside a job). Whatever it picks up runs on top of the waiting job,
+	// so a job that waits mustn't be holding a lock, or anything else a job it might run could need.
+	void Wait(JobCounter& counter);
+
+	// Submits function(begin, end, thread) over the range [0, count), split into jobs of at most grainSize items, without waiting.
+	// function has to stay alive until counter is done. If count is 0, counter still isn't done until dependency is.
+	template<typename Function>
+	void SubmitFor(int count, int grainSize, Function& function, JobCounter& counter, JobCounter* dependency = nullptr);
+
+	// Submits function(0, 1, thread) as a single job, for work that can't be split up.
+	template<typename Function>
+	void SubmitSingle(Function& function, JobCounter& counter, JobCounter* dependency = nullptr)
+	{
+		SubmitFor(1, 1, function, counter, dependency);
+	}
+
+	// Runs function(begin, end, thread) over the range [0, count), split into jobs of at most grainSize items, and waits for all of them.
+	template<typename Function>
+	void ParallelFor(int count, int grainSize, Function& function);
+};
+
+// A job that does nothing, for SubmitFor to hold a counter back on a dependency with when it has nothing else to submit.
+inline void emptyJobFunction(void* /*data*/, int /*begin*/, int /*end*/, int /*thread*/)
+{
+}
+
+// Turns a call through a JobFunction back into a call on the function object we were given.
+template<typename Function>
+void callJobFunction(void* data, int begin, int end, int thread)
+{
+	(*(Function*)data)(begin, end, thread);
+}
+
+template<typename Function>
+void JobSystem::SubmitFor(int count, int grainSize, Function& function, JobCounter& counter, JobCounter* dependency)
+{
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+
+	// An empty range still has to wait for dependency. Otherwise counter would be done straight away, and whatever waits on it (like the end
+	// of a step that waits on its last stage) would go on while everything before it is still running.
+	if (count <= 0 && dependency != nullptr)
+	{
+		Submit(&emptyJobFunction, nullptr, 0, 0, counter, dependency);
+		return;
+	}
+
+	for (int begin = 0; begin < count; begin += grainSize)
+	{
+		int end = begin + grainSize < count ? begin + grainSize : count;
+
+		Submit(&callJobFunction<Function>, &function, begin, end, counter, dependency);
+	}
+}
+
+template<typename Function>
+void JobSystem::ParallelFor(int count, int grainSize, Function& function)
+{
+	JobCounter counter;
+
+	SubmitFor(count, grainSize, function, counter);
+
+	Wait(counter);
+}
+
+#endif //_JOB_SYSTEM_H
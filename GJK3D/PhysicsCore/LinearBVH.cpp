@@ -0,0 +1,896 @@
+/*
+Title: GJK-3D (OBB)
+File Name: LinearBVH.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _LINEAR_BVH_CPP
+#define _LINEAR_BVH_CPP
+
+#include "LinearBVH.h"
+#include "JobSystem.h"
+#include "Morton.h"
+#include "SIMD.h"
+#include <algorithm>
+
+// The top 8 of the codes' 30 bits pick the bucket, and each bucket is sorted on the other 22 in two passes of 11.
+static const int BUCKET_SHIFT = 22;
+static const int SORT_BITS = 11;
+
+// Buckets this small are sorted by insertion instead, which is quicker than going over two tables of 2048 counts.
+static const int INSERTION_SORT_SIZE = 32;
+
+// Where the sorted codes[first, last] split into two: all the codes in a range share the bits above the highest one that differs between
+// the first and the last, and they're sorted, so the ones with that bit clear come first. Returns the last of those. Ranges where every
+// code is the same are split down the middle.
+static int findSplit(const unsigned int* codes, int first, int last)
+{
+	unsigned int differ = codes[first] ^ codes[last];
+
+	if (differ == 0)
+	{
+		return (first + last) / 2;
+	}
+
+	// Smear the highest bit that differs down over every bit below it, and then take them off, which leaves only that bit.
+	differ |= differ >> 1;
+	differ |= differ >> 2;
+	differ |= differ >> 4;
+	differ |= differ >> 8;
+	differ |= differ >> 16;
+
+	unsigned int bit = differ ^ (differ >> 1);
+
+	// codes[low] has the bit clear and codes[high] has it set, and that stays true as they close in.
+	int low = first;
+	int high = last;
+
+	while (high - low > 1)
+	{
+		int middle = (low + high) / 2;
+
+		if (codes[middle] & bit)
+		{
+			high = middle;
+		}
+		else
+		{
+			low = middle;
+		}
+	}
+
+	return low;
+}
+
+LinearBVH::LinearBVH(float inMargin)
+{
+	freeList = -1;
+	proxyCount = 0;
+
+	margin = inMargin;
+	displacementMultiplier = 2.0f;
+
+	root = -1;
+	stale = true;
+}
+
+int LinearBVH::CreateProxy(const AABB& bounds, int userData)
+{
+	int proxy;
+
+	if (freeList != -1)
+	{
+		proxy = freeList;
+		freeList = proxies[proxy].next;
+	}
+	else
+	{
+		proxies.push_back(LinearBVHProxy());
+		proxy = (int)proxies.size() - 1;
+	}
+
+	proxies[proxy].bounds = AABB(bounds.min - glm::vec3(margin), bounds.max + glm::vec3(margin));
+	proxies[proxy].userData = userData;
+	proxies[proxy].next = -1;
+
+	proxyCount++;
+	stale = true;
+
+	return proxy;
+}
+
+void LinearBVH::Reserve(int numProxies, int numPairs, int threads)
+{
+	Broadphase::Reserve(numProxies, numPairs, threads);
+
+	proxies.reserve(numProxies);
+	nodes.reserve(numProxies);
+	leafBounds.reserve(numProxies);
+	leafData.reserve(numProxies);
+
+	buildProxies.reserve(numProxies);
+	codes.reserve(numProxies);
+	sortProxies.reserve(numProxies);
+	sortCodes.reserve(numProxies);
+	blockCounts.reserve((numProxies + LBVH_BLOCK - 1) / LBVH_BLOCK * LBVH_BUCKETS);
+
+	// Any one thread could find every pair.
+	if ((int)threadPairs.size() < threads)
+	{
+		threadPairs.resize(threads);
+	}
+
+	for (int i = 0; i < (int)threadPairs.size(); i++)
+	{
+		threadPairs[i].reserve(numPairs);
+	}
+}
+
+void LinearBVH::DestroyProxy(int proxy)
+{
+	proxies[proxy].userData = -1;
+	proxies[proxy].next = freeList;
+	freeList = proxy;
+
+	proxyCount--;
+	stale = true;
+}
+
+bool LinearBVH::MoveProxy(int proxy, const AABB& bounds, const glm::vec3& displacement)
+{
+	if (proxies[proxy].bounds.Contains(bounds))
+	{
+		return false;
+	}
+
+	AABB fat = MakeFatBounds(bounds, margin, displacement, displacementMultiplier);
+
+	// The tree is built again from the bounds every step, so this is all there is to moving.
+	proxies[proxy].bounds = fat;
+	stale = true;
+
+	return true;
+}
+
+void LinearBVH::ShiftOrigin(const glm::vec3& origin)
+{
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		proxies[i].bounds.min -= origin;
+		proxies[i].bounds.max -= origin;
+	}
+
+	// Everything moves together, so the tree stays the same shape, and only its boxes have to move with the proxies.
+	for (int i = 0; i < (int)nodes.size(); i++)
+	{
+		nodes[i].bounds.min -= origin;
+		nodes[i].bounds.max -= origin;
+	}
+	for (int i = 0; i < (int)leafBounds.size(); i++)
+	{
+		leafBounds[i].min -= origin;
+		leafBounds[i].max -= origin;
+	}
+}
+
+void LinearBVH::Build(JobSystem* jobs)
+{
+	int blocks = PrepareBuild();
+
+	if (jobs == nullptr)
+	{
+		for (int i = 0; i < blocks; i++)
+		{
+			RunCodeTask(i);
+		}
+
+		PrepareScatter();
+
+		for (int i = 0; i < blocks; i++)
+		{
+			RunScatterTask(i);
+		}
+		for (int i = 0; i < LBVH_BUCKETS; i++)
+		{
+			RunBucketTask(i);
+		}
+	}
+	else
+	{
+		auto code = [this](int begin, int end, int thread)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				RunCodeTask(i);
+			}
+		};
+		auto scatter = [this](int begin, int end, int thread)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				RunScatterTask(i);
+			}
+		};
+		auto bucket = [this](int begin, int end, int thread)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				RunBucketTask(i);
+			}
+		};
+
+		jobs->ParallelFor(blocks, 1, code);
+
+		PrepareScatter();
+
+		jobs->ParallelFor(blocks, 1, scatter);
+		jobs->ParallelFor(LBVH_BUCKETS, LBVH_BUCKET_GRAIN, bucket);
+	}
+
+	FinishBuild();
+}
+
+int LinearBVH::PrepareBuild()
+{
+	buildProxies.clear();
+
+	// The codes are of the proxies' centers, cut up across the box around all of them.
+	glm::vec3 centerMin(0.0f);
+	glm::vec3 centerMax(0.0f);
+
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		// Skip the proxies on the free list.
+		if (proxies[i].userData == -1)
+		{
+			continue;
+		}
+
+		glm::vec3 center = (proxies[i].bounds.min + proxies[i].bounds.max) * 0.5f;
+
+		centerMin = buildProxies.empty() ? center : glm::min(centerMin, center);
+		centerMax = buildProxies.empty() ? center : glm::max(centerMax, center);
+
+		buildProxies.push_back(i);
+	}
+
+	codeOrigin = centerMin;
+	codeScale = mortonScale(centerMin, centerMax);
+
+	int count = (int)buildProxies.size();
+	int blocks = (count + LBVH_BLOCK - 1) / LBVH_BLOCK;
+
+	codes.resize(count);
+	sortCodes.resize(count);
+	sortProxies.resize(count);
+	leafBounds.resize(count);
+	leafData.resize(count);
+	nodes.resize(count > 0 ? count - 1 : 0);
+	blockCounts.assign(blocks * LBVH_BUCKETS, 0);
+
+	stale = true;
+
+	return blocks;
+}
+
+void LinearBVH::RunCodeTask(int block)
+{
+	int begin = block * LBVH_BLOCK;
+	int end = std::min(begin + LBVH_BLOCK, (int)buildProxies.size());
+	int* counts = &blockCounts[block * LBVH_BUCKETS];
+
+	for (int i = begin; i < end; i++)
+	{
+		const AABB& bounds = proxies[buildProxies[i]].bounds;
+
+		codes[i] = mortonCode((bounds.min + bounds.max) * 0.5f, codeOrigin, codeScale);
+		counts[codes[i] >> BUCKET_SHIFT]++;
+	}
+}
+
+void LinearBVH::PrepareScatter()
+{
+	int blocks = (int)blockCounts.size() / LBVH_BUCKETS;
+	int nonEmpty = 0;
+
+	// Each bucket's leaves start after every bucket before it, and within a bucket, each block's leaves start after the blocks before it's.
+	// Going through the blocks in order, and through each block's leaves in order, keeps leaves with the same code in the order their
+	// proxies are in, so the tree comes out the same however the tasks are run.
+	bucketStarts[0] = 0;
+
+	for (int bucket = 0; bucket < LBVH_BUCKETS; bucket++)
+	{
+		int start = bucketStarts[bucket];
+
+		for (int block = 0; block < blocks; block++)
+		{
+			int& count = blockCounts[block * LBVH_BUCKETS + bucket];
+			int blockStart = start;
+
+			start += count;
+			count = blockStart;
+		}
+
+		bucketStarts[bucket + 1] = start;
+
+		if (start > bucketStarts[bucket])
+		{
+			nonEmpty++;
+		}
+	}
+
+	// A bucket of n leaves has n - 1 nodes above them. The nodes above the buckets come first, then each bucket's in order.
+	int next = nonEmpty - 1;
+
+	for (int bucket = 0; bucket < LBVH_BUCKETS; bucket++)
+	{
+		int count = bucketStarts[bucket + 1] - bucketStarts[bucket];
+
+		bucketNodes[bucket] = next;
+
+		if (count > 0)
+		{
+			next += count - 1;
+		}
+	}
+}
+
+void LinearBVH::RunScatterTask(int block)
+{
+	int begin = block * LBVH_BLOCK;
+	int end = std::min(begin + LBVH_BLOCK, (int)buildProxies.size());
+	int* starts = &blockCounts[block * LBVH_BUCKETS];
+
+	for (int i = begin; i < end; i++)
+	{
+		int to = starts[codes[i] >> BUCKET_SHIFT]++;
+
+		sortCodes[to] = codes[i];
+		sortProxies[to] = buildProxies[i];
+	}
+}
+
+void LinearBVH::RunBucketTask(int bucket)
+{
+	int first = bucketStarts[bucket];
+	int end = bucketStarts[bucket + 1];
+	int count = end - first;
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	unsigned int* bucketCodes = &sortCodes[first];
+	int* bucketProxies = &sortProxies[first];
+
+	if (count <= INSERTION_SORT_SIZE)
+	{
+		for (int i = 1; i < count; i++)
+		{
+			unsigned int code = bucketCodes[i];
+			int proxy = bucketProxies[i];
+			int j = i;
+
+			for (; j > 0 && bucketCodes[j - 1] > code; j--)
+			{
+				bucketCodes[j] = bucketCodes[j - 1];
+				bucketProxies[j] = bucketProxies[j - 1];
+			}
+
+			bucketCodes[j] = code;
+			bucketProxies[j] = proxy;
+		}
+	}
+	else
+	{
+		// A radix sort on the low 22 bits, 11 at a time, from the sorted arrays into this bucket's part of codes and buildProxies (which
+		// the scatter is done with) and back. Each pass keeps the order of the leaves it doesn't tell apart, so after the second they're
+		// sorted on all 22, with leaves of the same code still in the order they came in.
+		unsigned int* scratchCodes = &codes[first];
+		int* scratchProxies = &buildProxies[first];
+		int starts[1 << SORT_BITS];
+
+		for (int pass = 0; pass < 2; pass++)
+		{
+			int shift = pass * SORT_BITS;
+			unsigned int mask = (1u << SORT_BITS) - 1;
+			const unsigned int* fromCodes = pass == 0 ? bucketCodes : scratchCodes;
+			const int* fromProxies = pass == 0 ? bucketProxies : scratchProxies;
+			unsigned int* toCodes = pass == 0 ? scratchCodes : bucketCodes;
+			int* toProxies = pass == 0 ? scratchProxies : bucketProxies;
+
+			std::fill(starts, starts + (1 << SORT_BITS), 0);
+
+			for (int i = 0; i < count; i++)
+			{
+				starts[(fromCodes[i] >> shift) & mask]++;
+			}
+
+			int start = 0;
+
+			for (int digit = 0; digit < (1 << SORT_BITS); digit++)
+			{
+				int digitCount = starts[digit];
+
+				starts[digit] = start;
+				start += digitCount;
+			}
+
+			for (int i = 0; i < count; i++)
+			{
+				int to = starts[(fromCodes[i] >> shift) & mask]++;
+
+				toCodes[to] = fromCodes[i];
+				toProxies[to] = fromProxies[i];
+			}
+		}
+	}
+
+	// The leaves' bounds and user data, in their sorted order, so the queries go straight through them.
+	for (int i = first; i < end; i++)
+	{
+		leafBounds[i] = proxies[sortProxies[i]].bounds;
+		leafData[i] = proxies[sortProxies[i]].userData;
+	}
+
+	if (count == 1)
+	{
+		bucketRoots[bucket] = ~first;
+	}
+	else
+	{
+		int next = bucketNodes[bucket];
+
+		bucketRoots[bucket] = buildNodes(first, end - 1, next);
+	}
+}
+
+int LinearBVH::buildNodes(int first, int last, int& next)
+{
+	int node = next++;
+	int split = findSplit(sortCodes.data(), first, last);
+	int left = split == first ? ~first : buildNodes(first, split, next);
+	int right = split + 1 == last ? ~last : buildNodes(split + 1, last, next);
+
+	nodes[node].children[0] = left;
+	nodes[node].children[1] = right;
+	nodes[node].bounds = AABB::Union(childBounds(left), childBounds(right));
+	nodes[node].last = last;
+
+	return node;
+}
+
+void LinearBVH::FinishBuild()
+{
+	// The buckets are the top 8 bits of the codes, so the nodes above them split the same way as the ones below, on the bucket numbers.
+	unsigned int nonEmpty[LBVH_BUCKETS];
+	int count = 0;
+
+	for (int bucket = 0; bucket < LBVH_BUCKETS; bucket++)
+	{
+		if (bucketStarts[bucket + 1] > bucketStarts[bucket])
+		{
+			nonEmpty[count++] = (unsigned int)bucket;
+		}
+	}
+
+	if (count == 0)
+	{
+		root = -1;
+	}
+	else if (count == 1)
+	{
+		root = bucketRoots[nonEmpty[0]];
+	}
+	else
+	{
+		int next = 0;
+
+		root = buildTop(nonEmpty, 0, count - 1, next);
+	}
+
+	stale = false;
+}
+
+int LinearBVH::buildTop(const unsigned int* nonEmpty, int first, int last, int& next)
+{
+	int node = next++;
+	int split = findSplit(nonEmpty, first, last);
+	int left = split == first ? bucketRoots[nonEmpty[first]] : buildTop(nonEmpty, first, split, next);
+	int right = split + 1 == last ? bucketRoots[nonEmpty[last]] : buildTop(nonEmpty, split + 1, last, next);
+
+	nodes[node].children[0] = left;
+	nodes[node].children[1] = right;
+	nodes[node].bounds = AABB::Union(childBounds(left), childBounds(right));
+	nodes[node].last = childLast(right);
+
+	return node;
+}
+
+void LinearBVH::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+	Build();
+
+	int count = PreparePairs(1);
+
+	FindPairsRange(0, count, 0);
+	FinishPairs(pairs);
+}
+
+int LinearBVH::PreparePairs(int threads)
+{
+	if ((int)threadPairs.size() < threads)
+	{
+		threadPairs.resize(threads);
+	}
+
+	return (int)leafData.size();
+}
+
+void LinearBVH::FindPairsRange(int begin, int end, int thread)
+{
+	std::vector<BroadphasePair>& found = threadPairs[thread];
+
+	// Each leaf only looks for the leaves after it, so every pair is found once, and whole subtrees of leaves before it are skipped.
+	for (int leaf = begin; leaf < end; leaf++)
+	{
+		const AABB& bounds = leafBounds[leaf];
+		int stack[256];
+		int count = 0;
+
+		stack[count++] = root;
+
+		while (count > 0)
+		{
+			int child = stack[--count];
+
+			if (childLast(child) <= leaf || !childBounds(child).Overlaps(bounds))
+			{
+				continue;
+			}
+
+			if (child < 0)
+			{
+				if (CanPair(leafData[leaf], leafData[~child]))
+				{
+					found.push_back(BroadphasePair(leafData[leaf], leafData[~child]));
+				}
+			}
+			else
+			{
+				stack[count++] = nodes[child].children[1];
+				stack[count++] = nodes[child].children[0];
+			}
+		}
+	}
+}
+
+void LinearBVH::FinishPairs(std::vector<BroadphasePair>& pairs)
+{
+	pairs.clear();
+
+	// Which thread found which pair depends on how the jobs were picked up, but sorting puts them back in the one order there is.
+	for (int i = 0; i < (int)threadPairs.size(); i++)
+	{
+		pairs.insert(pairs.end(), threadPairs[i].begin(), threadPairs[i].end());
+		threadPairs[i].clear();
+	}
+
+	// Any thread could find all of them next time, so each one gets room for that rather than growing whenever it gets the most.
+	for (int i = 0; i < (int)threadPairs.size(); i++)
+	{
+		threadPairs[i].reserve(pairs.size());
+	}
+
+	SortPairs(pairs, sortScratch);
+
+	comparePairs(pairs);
+}
+
+void LinearBVH::Cull(const Frustum& frustum, std::vector<int>& visible) const
+{
+	visible.clear();
+
+	if (stale)
+	{
+		for (int i = 0; i < (int)proxies.size(); i++)
+		{
+			if (proxies[i].userData != -1 && frustum.Overlaps(proxies[i].bounds))
+			{
+				visible.push_back(proxies[i].userData);
+			}
+		}
+
+		return;
+	}
+
+	if (leafData.empty())
+	{
+		return;
+	}
+
+	int stack[256];
+	int count = 0;
+
+	stack[count++] = root;
+
+	while (count > 0)
+	{
+		int child = stack[--count];
+
+		if (!frustum.Overlaps(childBounds(child)))
+		{
+			continue;
+		}
+
+		if (child < 0)
+		{
+			visible.push_back(leafData[~child]);
+		}
+		else
+		{
+			stack[count++] = nodes[child].children[0];
+			stack[count++] = nodes[child].children[1];
+		}
+	}
+}
+
+void LinearBVH::CastSegment(const glm::vec3& from, const glm::vec3& to, const glm::vec3& extents, std::vector<int>& hits) const
+{
+	hits.clear();
+
+	glm::vec3 delta = to - from;
+
+	if (stale)
+	{
+		for (int i = 0; i < (int)proxies.size(); i++)
+		{
+			if (proxies[i].userData != -1 && proxies[i].bounds.SegmentOverlaps(from, delta, extents))
+			{
+				hits.push_back(proxies[i].userData);
+			}
+		}
+
+		return;
+	}
+
+	if (leafData.empty())
+	{
+		return;
+	}
+
+	int stack[256];
+	int count = 0;
+
+	stack[count++] = root;
+
+	while (count > 0)
+	{
+		int child = stack[--count];
+
+		if (!childBounds(child).SegmentOverlaps(from, delta, extents))
+		{
+			continue;
+		}
+
+		if (child < 0)
+		{
+			hits.push_back(leafData[~child]);
+		}
+		else
+		{
+			stack[count++] = nodes[child].children[0];
+			stack[count++] = nodes[child].children[1];
+		}
+	}
+}
+
+// The segments of a packet, a structure of arrays, so the same coordinate of four segments is one SSE load. Instead of dividing by each
+// segment's delta for every box, each has the inverse of its delta kept (with a huge number standing in for 1 / 0, which puts a box the
+// segment runs alongside either all the way in front of it or all the way behind, as the slab test needs).
+struct GJK_ALIGN(16) SegmentPacket
+{
+	float fromX[LBVH_PACKET];
+	float fromY[LBVH_PACKET];
+	float fromZ[LBVH_PACKET];
+	float inverseX[LBVH_PACKET];
+	float inverseY[LBVH_PACKET];
+	float inverseZ[LBVH_PACKET];
+	float extentX[LBVH_PACKET];
+	float extentY[LBVH_PACKET];
+	float extentZ[LBVH_PACKET];
+};
+
+static float inverseDelta(float delta)
+{
+	if (delta == 0.0f)
+	{
+		return 1e30f;
+	}
+
+	return 1.0f / delta;
+}
+
+// Which of the four segments from first on go through bounds, as the low four bits of a mask (the same slab test as AABB::SegmentOverlaps).
+static unsigned int segmentGroupOverlaps(const SegmentPacket& packet, int first, const AABB& bounds)
+{
+#if defined(GJK_SIMD_SSE)
+	__m128 enter = _mm_setzero_ps();
+	__m128 exit = _mm_set1_ps(1.0f);
+
+	const float* from[3] = { packet.fromX + first, packet.fromY + first, packet.fromZ + first };
+	const float* inverse[3] = { packet.inverseX + first, packet.inverseY + first, packet.inverseZ + first };
+	const float* extent[3] = { packet.extentX + first, packet.extentY + first, packet.extentZ + first };
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		__m128 origin = _mm_load_ps(from[axis]);
+		__m128 grow = _mm_load_ps(extent[axis]);
+		__m128 scale = _mm_load_ps(inverse[axis]);
+
+		__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_set1_ps(bounds.min[axis]), grow), origin), scale);
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_set1_ps(bounds.max[axis]), grow), origin), scale);
+
+		enter = _mm_max_ps(enter, _mm_min_ps(t0, t1));
+		exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+	}
+
+	return (unsigned int)_mm_movemask_ps(_mm_cmple_ps(enter, exit));
+#else
+	unsigned int mask = 0;
+
+	for (int i = first; i < first + 4; i++)
+	{
+		float enter = 0.0f;
+		float exit = 1.0f;
+
+		float t0 = (bounds.min.x - packet.extentX[i] - packet.fromX[i]) * packet.inverseX[i];
+		float t1 = (bounds.max.x + packet.extentX[i] - packet.fromX[i]) * packet.inverseX[i];
+		enter = glm::max(enter, glm::min(t0, t1));
+		exit = glm::min(exit, glm::max(t0, t1));
+
+		t0 = (bounds.min.y - packet.extentY[i] - packet.fromY[i]) * packet.inverseY[i];
+		t1 = (bounds.max.y + packet.extentY[i] - packet.fromY[i]) * packet.inverseY[i];
+		enter = glm::max(enter, glm::min(t0, t1));
+		exit = glm::min(exit, glm::max(t0, t1));
+
+		t0 = (bounds.min.z - packet.extentZ[i] - packet.fromZ[i]) * packet.inverseZ[i];
+		t1 = (bounds.max.z + packet.extentZ[i] - packet.fromZ[i]) * packet.inverseZ[i];
+		enter = glm::max(enter, glm::min(t0, t1));
+		exit = glm::min(exit, glm::max(t0, t1));
+
+		if (enter <= exit)
+		{
+			mask |= 1u << (i - first);
+		}
+	}
+
+	return mask;
+#endif
+}
+
+void LinearBVH::CastSegmentPacket(const glm::vec3* from, const glm::vec3* to, const glm::vec3* extents, int count, std::vector<int>* hits)
+	const
+{
+	for (int i = 0; i < count; i++)
+	{
+		hits[i].clear();
+	}
+
+	if (stale)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			CastSegment(from[i], to[i], extents != nullptr ? extents[i] : glm::vec3(0.0f), hits[i]);
+		}
+
+		return;
+	}
+
+	if (leafData.empty() || count == 0)
+	{
+		return;
+	}
+
+	// The slots past count are filled in with the last segment, so whole groups of four can be tested, and their bits are never looked at.
+	SegmentPacket packet;
+
+	for (int i = 0; i < LBVH_PACKET; i++)
+	{
+		int segment = i < count ? i : count - 1;
+		glm::vec3 delta = to[segment] - from[segment];
+		glm::vec3 extent = extents != nullptr ? extents[segment] : glm::vec3(0.0f);
+
+		packet.fromX[i] = from[segment].x;
+		packet.fromY[i] = from[segment].y;
+		packet.fromZ[i] = from[segment].z;
+		packet.inverseX[i] = inverseDelta(delta.x);
+		packet.inverseY[i] = inverseDelta(delta.y);
+		packet.inverseZ[i] = inverseDelta(delta.z);
+		packet.extentX[i] = extent.x;
+		packet.extentY[i] = extent.y;
+		packet.extentZ[i] = extent.z;
+	}
+
+	// Each entry is a node (or leaf) and which of the segments went through its parent.
+	int stack[256];
+	unsigned int masks[256];
+	int depth = 0;
+
+	stack[depth] = root;
+	masks[depth++] = count == LBVH_PACKET ? 0xFFFFFFFF : (1u << count) - 1;
+
+	while (depth > 0)
+	{
+		depth--;
+
+		int child = stack[depth];
+		unsigned int mask = masks[depth];
+		const AABB& bounds = childBounds(child);
+		unsigned int through = 0;
+
+		// Only the groups of four with a segment still going are tested.
+		for (int first = 0; first < LBVH_PACKET; first += 4)
+		{
+			if (((mask >> first) & 15) != 0)
+			{
+				through |= segmentGroupOverlaps(packet, first, bounds) << first;
+			}
+		}
+
+		through &= mask;
+
+		if (through == 0)
+		{
+			continue;
+		}
+
+		if (child < 0)
+		{
+			for (; through != 0; through &= through - 1)
+			{
+				hits[lowestSetBit(through)].push_back(leafData[~child]);
+			}
+		}
+		else
+		{
+			stack[depth] = nodes[child].children[0];
+			masks[depth++] = through;
+			stack[depth] = nodes[child].children[1];
+			masks[depth++] = through;
+		}
+	}
+}
+
+#endif //_LINEAR_BVH_CPP
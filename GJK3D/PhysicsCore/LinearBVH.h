@@ -0,0 +1,212 @@
+/*
+Title: GJK-3D (OBB)
+File Name: LinearBVH.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _LINEAR_BVH_H
+#define _LINEAR_BVH_H
+
+#include "Broadphase.h"
+#include "MemoryTracker.h"
+
+class JobSystem;
+
+// How many of the leaves each code task (and scatter task) of a build works through.
+static const int LBVH_BLOCK = 4096;
+
+// How many buckets the first pass of the sort splits the leaves into, by the top 8 bits of their codes. Each bucket is sorted and built
+// into a subtree of its own (see LinearBVH::RunBucketTask).
+static const int LBVH_BUCKETS = 256;
+
+// How many buckets each job sorts and builds, when they're run as jobs.
+static const int LBVH_BUCKET_GRAIN = 4;
+
+// How many segments CastSegmentPacket takes down the tree at once (one bit each of a mask).
+static const int LBVH_PACKET = 16;
+
+struct LinearBVHProxy
+{
+	AABB bounds;	// The fat bounds.
+	int userData;
+	int next;		// The next free proxy, while this one is on the free list.
+};
+
+// A node above the leaves. Each child is another node (0 and up) or a leaf (~leaf, so below 0), where the leaves are numbered in the order
+// they were sorted into.
+struct LinearBVHNode
+{
+	AABB bounds;
+	int children[2];
+
+	// The highest numbered leaf under this node. FindPairsRange only looks for leaves after its own, so it can skip any node where this
+	// is no higher than its own.
+	int last;
+};
+
+// A linear bounding volume hierarchy (LBVH) broadphase, built from scratch every step.
+// Each proxy's center gets a Morton code (x, y and z each cut into 1024 steps across the bounds of all of them, with their bits interleaved),
+// and sorting the proxies by it lines them up along a Z-shaped curve through space, so the ones near each other in the order are near each
+// other in space. A range of sorted codes that all start with the same bits is a box of space, so splitting each range where the highest
+// bit that differs across it changes gives a tree straight from the sorted order, with no searching for good splits at all.
+// The sort is a radix sort: one pass on the top 8 bits scatters the proxies into 256 buckets, then each bucket is sorted on the rest of
+// its bits and built into a subtree on its own. Every part of that is split up across threads (see PrepareBuild), so building the whole
+// tree costs about as much as refitting one, and takes the same time whatever the objects did last step.
+// The AABB tree keeps its tree from one step to the next and only moves the proxies that left their fat bounds, which is quicker when
+// most objects are still. But when nearly everything moves every step (a big explosion's worth of debris), it spends the step taking
+// leaves out and putting them back in, and the tree gets worse as it goes. This tree never does either.
+// Every pair is found again each step, from every proxy, so it finds pairs like the hash grid does, but without needing a cell size.
+class LinearBVH : public Broadphase
+{
+	// Saves and loads the arrays straight from a file (see WorldSnapshot).
+	friend class WorldSnapshot;
+
+	AlignedTrackedVector<LinearBVHProxy, MEMORY_BROADPHASE> proxies;
+	int freeList;
+	int proxyCount;
+
+	float margin;
+	float displacementMultiplier;
+
+	// The tree from the last build: its nodes, the root (a node, or a leaf if there's only one), and each leaf's bounds and user data, in
+	// the order they were sorted into. stale is whether any proxy has changed since, in which case Cull and CastSegment test every proxy.
+	// (These and the proxies can go on huge pages; see AllocatePages.)
+	AlignedTrackedVector<LinearBVHNode, MEMORY_BROADPHASE> nodes;
+	int root;
+	AlignedTrackedVector<AABB, MEMORY_BROADPHASE> leafBounds;
+	AlignedTrackedVector<int, MEMORY_BROADPHASE> leafData;
+	bool stale;
+
+	// While a build is going: the proxies, their codes, each code block's count of the leaves going into each bucket (and then where in
+	// its bucket they start), and where each bucket's leaves and nodes start. The sort goes back and forth between codes and sortCodes.
+	std::vector<int> buildProxies;
+	std::vector<unsigned int> codes;
+	std::vector<int> sortProxies;
+	std::vector<unsigned int> sortCodes;
+	std::vector<int> blockCounts;
+	int bucketStarts[LBVH_BUCKETS + 1];
+	int bucketNodes[LBVH_BUCKETS];
+	int bucketRoots[LBVH_BUCKETS];
+	glm::vec3 codeOrigin;
+	glm::vec3 codeScale;
+
+	// What each thread has found so far in FindPairsRange.
+	std::vector<std::vector<BroadphasePair> > threadPairs;
+
+	// Builds the subtree over the sorted leaves [first, last] from the top down, using the nodes from next on, and returns its root.
+	int buildNodes(int first, int last, int& next);
+
+	// The same, but over the buckets with leaves in them, from nonEmpty[first] to nonEmpty[last]. These are the nodes above the buckets.
+	int buildTop(const unsigned int* nonEmpty, int first, int last, int& next);
+
+	const AABB& childBounds(int child) const
+	{
+		return child >= 0 ? nodes[child].bounds : leafBounds[~child];
+	}
+
+	int childLast(int child) const
+	{
+		return child >= 0 ? nodes[child].last : ~child;
+	}
+
+public:
+	LinearBVH(float inMargin = 0.05f);
+
+	int CreateProxy(const AABB& bounds, int userData);
+
+	void DestroyProxy(int proxy);
+
+	bool MoveProxy(int proxy, const AABB& bounds, const glm::vec3& displacement);
+
+	void ShiftOrigin(const glm::vec3& origin);
+
+	const AABB& GetFatBounds(int proxy) const
+	{
+		return proxies[proxy].bounds;
+	}
+
+	int GetUserData(int proxy) const
+	{
+		return proxies[proxy].userData;
+	}
+
+	// Builds the tree, then looks for each leaf's pairs in it.
+	void FindPairs(std::vector<BroadphasePair>& pairs);
+
+	void Reserve(int numProxies, int numPairs, int threads);
+
+	// These go through the tree from the last build if nothing has changed since (as is the case between steps), and test every proxy
+	// if something has.
+	void Cull(const Frustum& frustum, std::vector<int>& visible) const;
+	void CastSegment(const glm::vec3& from, const glm::vec3& to, const glm::vec3& extents, std::vector<int>& hits) const;
+
+	// CastSegment for count segments (up to LBVH_PACKET) at once, each grown by its own extents (or none, if extents is nullptr), on one trip
+	// down the tree. A node is only tested against the segments that went through its parent, and only opened if any of them go through
+	// it as well, so segments that are close together (like the rays a batch of queries has been sorted into; see SceneQuerySnapshot) share
+	// the loads and stack work of every node they go through. hits[i] is filled with the hits of segment i.
+	void CastSegmentPacket(const glm::vec3* from, const glm::vec3* to, const glm::vec3* extents, int count, std::vector<int>* hits) const;
+
+	const char* GetName() const
+	{
+		return "Linear BVH";
+	}
+
+	// Builds the tree again from the proxies as they are now. With jobs, every part of it is split across the threads (from the thread that
+	// owns the job system, outside of any job).
+	void Build(JobSystem* jobs = nullptr);
+
+	// Build in parts, for running them as jobs from inside another job. Each has to finish before the next starts, but the tasks within one
+	// can all run on different threads at once:
+	// - PrepareBuild gathers the proxies and returns how many blocks of them there are.
+	// - RunCodeTask works out the codes of one block, and counts how many of them go into each bucket.
+	// - PrepareScatter works out where each block's leaves go in each bucket.
+	// - RunScatterTask puts one block's leaves into their buckets.
+	// - RunBucketTask sorts the leaves in one bucket (0 to LBVH_BUCKETS - 1) and builds them into a subtree.
+	// - FinishBuild builds the nodes above the buckets.
+	// Nothing else can use the broadphase in between.
+	int PrepareBuild();
+	void RunCodeTask(int block);
+	void PrepareScatter();
+	void RunScatterTask(int block);
+	void RunBucketTask(int bucket);
+	void FinishBuild();
+
+	// Finding the pairs in a built tree in three parts, as with the AABB tree: PreparePairs gets ready for up to threads threads and returns
+	// how many leaves there are, FindPairsRange finds the pairs of the leaves from begin up to end on the given thread, and FinishPairs puts
+	// together what they all found and fills pairs.
+	int PreparePairs(int threads);
+	void FindPairsRange(int begin, int end, int thread);
+	void FinishPairs(std::vector<BroadphasePair>& pairs);
+};
+
+#endif //_LINEAR_BVH_H
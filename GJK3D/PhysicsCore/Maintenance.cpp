@@ -0,0 +1,143 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Maintenance.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MAINTENANCE_CPP
+#define _MAINTENANCE_CPP
+
+#include "Maintenance.h"
+
+// How many leaves a slice of TreeOptimizeTask takes out and puts back: somewhere around 50 microseconds' work in a big scene.
+static const int TREE_SLICE = 256;
+
+MaintenanceScheduler::MaintenanceScheduler()
+{
+	next = 0;
+}
+
+int MaintenanceScheduler::Add(MaintenanceTask* task, int interval)
+{
+	Entry entry;
+	entry.task = task;
+	entry.interval = interval;
+	entry.stepsSince = 0;
+	entry.running = false;
+
+	tasks.push_back(entry);
+
+	return (int)tasks.size() - 1;
+}
+
+void MaintenanceScheduler::Reset()
+{
+	for (int i = 0; i < (int)tasks.size(); i++)
+	{
+		tasks[i].stepsSince = 0;
+		tasks[i].running = false;
+	}
+
+	next = 0;
+}
+
+int MaintenanceScheduler::Run(Clock& clock, double budget, bool fixed)
+{
+	int count = (int)tasks.size();
+	int running = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		Entry& entry = tasks[i];
+
+		if (entry.interval > 0 && ++entry.stepsSince >= entry.interval && !entry.running)
+		{
+			entry.running = entry.task->Begin();
+			entry.stepsSince = 0;
+		}
+
+		running += entry.running ? 1 : 0;
+	}
+
+	if (running == 0)
+	{
+		return 0;
+	}
+
+	double end = clock.Now() + budget;
+	int slices = 0;
+
+	// Go round the running tasks a slice at a time. With fixed, that's once round; otherwise it's until the time's up (checked after
+	// each slice, so there's always at least one).
+	for (int turn = 0; running > 0; turn++)
+	{
+		Entry& entry = tasks[(next + turn) % count];
+
+		if (entry.running)
+		{
+			entry.running = !entry.task->RunSlice();
+			running -= entry.running ? 0 : 1;
+			slices++;
+		}
+
+		if (fixed ? turn + 1 >= count : clock.Now() >= end)
+		{
+			break;
+		}
+	}
+
+	next = (next + 1) % count;
+
+	return slices;
+}
+
+TreeOptimizeTask::TreeOptimizeTask(AABBTree* inTree)
+{
+	tree = inTree;
+	node = -1;
+}
+
+bool TreeOptimizeTask::Begin()
+{
+	node = 0;
+
+	return true;
+}
+
+bool TreeOptimizeTask::RunSlice()
+{
+	node = tree->ReinsertLeaves(node, TREE_SLICE);
+
+	return node == -1;
+}
+
+#endif //_MAINTENANCE_CPP
@@ -0,0 +1,124 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Maintenance.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MAINTENANCE_H
+#define _MAINTENANCE_H
+
+#include "AABBTree.h"
+#include "Clock.h"
+#include <vector>
+
+// Upkeep that keeps the world quick, but doesn't have to happen in any particular step, like putting the AABB tree back in shape. Done all
+// at once it's a spike every so often, so instead a MaintenanceScheduler does it a slice at a time over as many steps as it takes.
+// A pass starts from however things are then, and the world goes on changing between slices, so every slice has to leave things in a state
+// the rest of the step can use.
+class MaintenanceTask
+{
+public:
+	virtual ~MaintenanceTask()
+	{
+	}
+
+	// Starts a pass. Returns false if there's nothing to do this time.
+	virtual bool Begin() = 0;
+
+	// Does a slice of the pass: a small, fixed amount of work (tens of microseconds, so the scheduler can stop close to its budget). Returns
+	// whether the pass is finished.
+	virtual bool RunSlice() = 0;
+};
+
+// Runs MaintenanceTasks a slice at a time, within a time budget each step.
+// Each task is started every so many steps (its interval). Then, each step, the tasks with a pass going take turns running a slice, until
+// the budget is used up or there's nothing left to do. At least one slice runs whenever there's a pass going, so even with a tiny budget
+// every pass gets finished in the end, and a task that comes due while its last pass is still going just carries on with that one.
+// The tasks take turns from one step to the next as well, so a task with a big pass doesn't starve the others.
+// How many slices fit in the budget depends on how fast the machine is, so for things that have to come out the same every time (see
+// PhysicsWorld::SetDeterministic), Run can be told to ignore the clock and run exactly one slice of each pass per step.
+class MaintenanceScheduler
+{
+	struct Entry
+	{
+		MaintenanceTask* task;
+		int interval;
+		int stepsSince;
+		bool running;
+	};
+
+	std::vector<Entry> tasks;
+
+	// The task whose turn it is to go first.
+	int next;
+
+public:
+	MaintenanceScheduler();
+
+	// Adds a task, to be started every interval steps (or never, for 0), and returns its number. The scheduler doesn't own it.
+	int Add(MaintenanceTask* task, int interval);
+
+	void SetInterval(int task, int interval)
+	{
+		tasks[task].interval = interval;
+	}
+
+	bool IsRunning(int task) const
+	{
+		return tasks[task].running;
+	}
+
+	// Stops any pass that's going, and starts counting every task's interval again from now.
+	void Reset();
+
+	// Once a step: starts the tasks that are due, then runs slices until budget seconds (by clock) have gone, or every pass is done. With
+	// fixed, it runs one slice of each pass instead. Returns how many slices it ran.
+	int Run(Clock& clock, double budget, bool fixed);
+};
+
+// Puts an AABB tree back in shape a few leaves at a time (see AABBTree::ReinsertLeaves): the time-sliced version of rebuilding it every so
+// often.
+class TreeOptimizeTask : public MaintenanceTask
+{
+	AABBTree* tree;
+
+	// The node to carry on from.
+	int node;
+
+public:
+	TreeOptimizeTask(AABBTree* inTree = nullptr);
+
+	bool Begin();
+	bool RunSlice();
+};
+
+#endif //_MAINTENANCE_H
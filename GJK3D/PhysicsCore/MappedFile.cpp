@@ -0,0 +1,211 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MappedFile.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _MAPPED_FILE_CPP
+#define _MAPPED_FILE_CPP
+
+#include "MappedFile.h"
+#include <cstdio>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+	#define GJK_MAP_POSIX
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+	data = nullptr;
+	size = 0;
+	owned = false;
+
+#if defined(_WIN32)
+	file = INVALID_HANDLE_VALUE;
+	mapping = nullptr;
+#else
+	file = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& fileName)
+{
+	Close();
+
+#if defined(_WIN32)
+	file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	size = (size_t)fileSize.QuadPart;
+#elif defined(GJK_MAP_POSIX)
+	file = open(fileName.c_str(), O_RDONLY);
+
+	if (file == -1)
+	{
+		return false;
+	}
+
+	struct stat status;
+
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+
+	void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+	if (view == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	data = (const char*)view;
+	size = (size_t)status.st_size;
+#else
+	FILE* in = fopen(fileName.c_str(), "rb");
+
+	if (in == nullptr)
+	{
+		return false;
+	}
+
+	fseek(in, 0, SEEK_END);
+	long length = ftell(in);
+	fseek(in, 0, SEEK_SET);
+
+	if (length > 0)
+	{
+		char* buffer = new char[length];
+
+		if (fread(buffer, 1, (size_t)length, in) == (size_t)length)
+		{
+			data = buffer;
+			size = (size_t)length;
+			owned = true;
+		}
+		else
+		{
+			delete[] buffer;
+		}
+	}
+
+	fclose(in);
+#endif
+
+	if (data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (owned)
+	{
+		delete[] data;
+	}
+#if defined(_WIN32)
+	else if (data != nullptr)
+	{
+		UnmapViewOfFile(data);
+	}
+
+	if (mapping != nullptr)
+	{
+		CloseHandle(mapping);
+		mapping = nullptr;
+	}
+
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file);
+		file = INVALID_HANDLE_VALUE;
+	}
+#elif defined(GJK_MAP_POSIX)
+	else if (data != nullptr)
+	{
+		munmap((void*)data, size);
+	}
+
+	if (file != -1)
+	{
+		close(file);
+		file = -1;
+	}
+#endif
+
+	data = nullptr;
+	size = 0;
+	owned = false;
+}
+
+#endif //_MAPPED_FILE_CPP
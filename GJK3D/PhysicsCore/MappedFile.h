@@ -0,0 +1,83 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MappedFile.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _MAPPED_FILE_H
+#define _MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// A file mapped into memory, read-only. The operating system pages it in as it's read, so opening even a big file costs next to nothing,
+// and data laid out the way it's used in memory can be used straight from the file without being read or parsed first.
+// (Where we don't know how to map files, the whole file is read into memory instead, which works the same, just not as quickly.)
+class MappedFile
+{
+	const char* data;
+	size_t size;
+
+#if defined(_WIN32)
+	void* file;
+	void* mapping;
+#else
+	int file;
+#endif
+
+	// Whether data was read into memory we own, rather than mapped.
+	bool owned;
+
+	// The file is unmapped when this goes away, so it can't be copied.
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	// Maps a file, closing whatever was open before. Returns false if it can't be opened (or is empty).
+	bool Open(const std::string& fileName);
+	void Close();
+
+	const char* GetData() const
+	{
+		return data;
+	}
+	size_t GetSize() const
+	{
+		return size;
+	}
+};
+
+#endif //_MAPPED_FILE_H
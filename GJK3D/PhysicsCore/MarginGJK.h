@@ -0,0 +1,293 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MarginGJK.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MARGIN_GJK_H
+#define _MARGIN_GJK_H
+
+#include "EPA.h"
+#include "GJKDistance.h"
+#include "Shapes.h"
+
+// A shape with a collision margin is a "core" shape with every point pushed out by a radius: a sphere is a point plus its radius, a capsule
+// is a segment plus its radius, and a rounded box is a slightly smaller box plus a radius (so its edges and corners are rounded off).
+// The nice thing about them is that two of them touch exactly when their cores are within the two margins added together of each other. So
+// instead of finding the contact with GJK and then EPA on the full shapes, we can run GJK's distance query on the cores, and as long as the
+// cores don't overlap, the closest points and normal it finds are the contact. Resting and touching contacts, which are most of the contacts
+// in a scene that has settled, never overlap that deeply, so they never need EPA at all. Only a pair that has sunk in further than its margins
+// needs the full GJK and EPA.
+
+// A single point, which is the core of a sphere.
+struct PointShape
+{
+	glm::vec3 point;
+
+	PointShape()
+	{
+		point = glm::vec3(0.0f);
+	}
+
+	PointShape(const glm::vec3& p)
+	{
+		point = p;
+	}
+};
+
+inline glm::vec3 getFarthestPointInDirection(const PointShape& obj, const glm::vec3& dir)
+{
+	return obj.point;
+}
+
+// A line segment, which is the core of a capsule.
+struct SegmentShape
+{
+	glm::vec3 pointA;
+	glm::vec3 pointB;
+
+	SegmentShape()
+	{
+		pointA = glm::vec3(0.0f);
+		pointB = glm::vec3(0.0f);
+	}
+
+	SegmentShape(const glm::vec3& a, const glm::vec3& b)
+	{
+		pointA = a;
+		pointB = b;
+	}
+};
+
+inline glm::vec3 getFarthestPointInDirection(const SegmentShape& obj, const glm::vec3& dir)
+{
+	return glm::dot(obj.pointA, dir) > glm::dot(obj.pointB, dir) ? obj.pointA : obj.pointB;
+}
+
+// Any core shape with a margin around it. It has a support function of its own too (the core's, pushed out along dir), so it can still go
+// through the plain TestGJK and EPA like any other shape.
+template<typename Core>
+struct RoundedShape
+{
+	Core core;
+	float margin;
+
+	RoundedShape()
+	{
+		margin = 0.0f;
+	}
+
+	RoundedShape(const Core& c, float m)
+	{
+		core = c;
+		margin = m;
+	}
+};
+
+template<typename Core>
+inline glm::vec3 getFarthestPointInDirection(const RoundedShape<Core>& obj, const glm::vec3& dir)
+{
+	return getFarthestPointInDirection(obj.core, dir) + safeNormalize(dir) * obj.margin;
+}
+
+// Makes a box with rounded edges that fits in box, with margin as its radius. (The core is box shrunk by margin on every side, so margin
+// can't be more than the smallest half extent.)
+inline RoundedShape<OBBShape> MakeRoundedBox(const OBBShape& box, float margin)
+{
+	OBBShape core = box;
+	core.halfExtents -= glm::vec3(margin);
+
+	return RoundedShape<OBBShape>(core, margin);
+}
+
+// Splits a shape into its core and its margin. Shapes that aren't round (boxes, hulls, and the rest) are their own core, with no margin.
+template<typename Shape>
+struct ShapeMargin
+{
+	typedef Shape Core;
+
+	static const Shape& GetCore(const Shape& shape)
+	{
+		return shape;
+	}
+	static float GetMargin(const Shape& shape)
+	{
+		return 0.0f;
+	}
+};
+
+template<>
+struct ShapeMargin<SphereShape>
+{
+	typedef PointShape Core;
+
+	static PointShape GetCore(const SphereShape& shape)
+	{
+		return PointShape(shape.center);
+	}
+	static float GetMargin(const SphereShape& shape)
+	{
+		return shape.radius;
+	}
+};
+
+template<>
+struct ShapeMargin<CapsuleShape>
+{
+	typedef SegmentShape Core;
+
+	static SegmentShape GetCore(const CapsuleShape& shape)
+	{
+		return SegmentShape(shape.pointA, shape.pointB);
+	}
+	static float GetMargin(const CapsuleShape& shape)
+	{
+		return shape.radius;
+	}
+};
+
+template<typename CoreShape>
+struct ShapeMargin<RoundedShape<CoreShape> >
+{
+	typedef CoreShape Core;
+
+	static const CoreShape& GetCore(const RoundedShape<CoreShape>& shape)
+	{
+		return shape.core;
+	}
+	static float GetMargin(const RoundedShape<CoreShape>& shape)
+	{
+		return shape.margin;
+	}
+};
+
+// Tests and finds contacts between shapes using their cores and margins (see above).
+// Like GJKSolver there is nothing shared in here, so keep one per thread.
+class MarginGJKSolver
+{
+	GJKDistanceSolver distance;
+	GJKSolver gjk;
+	EPASolver epa;
+
+	// What the last query did: how many iterations it took (GJK and EPA together, when it needed them), and whether the cores overlapped so
+	// it had to fall back to EPA.
+	int iterations;
+	bool deep;
+
+public:
+	MarginGJKSolver()
+	{
+		iterations = 0;
+		deep = false;
+	}
+
+	int GetIterations()
+	{
+		return iterations;
+	}
+
+	// True if the last query's cores overlapped, so the full shapes went through GJK and EPA.
+	bool UsedEPA()
+	{
+		return deep;
+	}
+
+	// Returns true if the two shapes are colliding (touching counts). If a cache is given, the distance query starts from it and saves its
+	// normal back into it.
+	template<typename ShapeA, typename ShapeB>
+	bool TestGJK(const ShapeA& a, const ShapeB& b, GJKCache* cache = nullptr)
+	{
+		deep = false;
+
+		GJKDistanceResult core;
+		float gap = distance.Distance(ShapeMargin<ShapeA>::GetCore(a), ShapeMargin<ShapeB>::GetCore(b), core, cache);
+
+		iterations = core.iterations;
+
+		return gap <= ShapeMargin<ShapeA>::GetMargin(a) + ShapeMargin<ShapeB>::GetMargin(b);
+	}
+
+	// Works out the contact between two shapes, the same as GJK then EPA would (result means the same as it does for EPASolver::Penetration).
+	// Returns false if they aren't colliding, or (like EPA) if there's too little to go on to find a normal.
+	template<typename ShapeA, typename ShapeB>
+	bool Penetration(const ShapeA& a, const ShapeB& b, EPAResult& result, GJKCache* cache = nullptr);
+};
+
+template<typename ShapeA, typename ShapeB>
+bool MarginGJKSolver::Penetration(const ShapeA& a, const ShapeB& b, EPAResult& result, GJKCache* cache)
+{
+	deep = false;
+
+	float marginA = ShapeMargin<ShapeA>::GetMargin(a);
+	float marginB = ShapeMargin<ShapeB>::GetMargin(b);
+
+	GJKDistanceResult core;
+	float gap = distance.Distance(ShapeMargin<ShapeA>::GetCore(a), ShapeMargin<ShapeB>::GetCore(b), core, cache);
+
+	iterations = core.iterations;
+
+	if (!core.overlapping)
+	{
+		if (gap > marginA + marginB)
+		{
+			return false;
+		}
+
+		// The cores are apart but the margins overlap. Pushing the closest points of the cores out by their margins along the normal gives
+		// the deepest points of the contact on the full shapes, and the depth is however much of the margins the gap didn't use up.
+		result.normal = core.normal;
+		result.pointA = core.pointA + core.normal * marginA;
+		result.pointB = core.pointB - core.normal * marginB;
+		result.depth = marginA + marginB - gap;
+		result.iterations = 0;
+
+		return true;
+	}
+
+	// The cores overlap too, so there's no closest point to go on, and the full shapes have to go through GJK and EPA.
+	deep = true;
+
+	bool colliding = gjk.TestGJK(a, b, cache);
+	iterations += gjk.GetIterations();
+
+	if (!colliding)
+	{
+		return false;
+	}
+
+	bool found = epa.Penetration(a, b, gjk.GetSimplex(), result);
+	iterations += result.iterations;
+
+	return found;
+}
+
+#endif //_MARGIN_GJK_H
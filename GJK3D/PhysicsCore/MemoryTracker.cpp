@@ -0,0 +1,326 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MemoryTracker.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MEMORY_TRACKER_CPP
+#define _MEMORY_TRACKER_CPP
+
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cstdint>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(__linux__)
+	#define GJK_PAGES_LINUX
+	#include <sys/mman.h>
+#endif
+
+// Each tag's counts, on a cache line of its own, since the allocations of different subsystems often happen on different threads at once.
+struct TagCounts
+{
+	std::atomic<long long> current;
+	std::atomic<long long> peak;
+	std::atomic<long long> allocations;
+	char padding[64 - 3 * sizeof(long long)];
+};
+
+// Zero-initialized before anything runs, so allocations made while other globals are being constructed are counted too.
+static TagCounts tagCounts[MEMORY_TAG_COUNT];
+
+static const char* tagNames[MEMORY_TAG_COUNT] = { "models", "objects", "bodies", "broadphase", "contacts", "arena", "gpu" };
+
+// How many steps are running right now, the allocations made while any were, and who to tell about them.
+static std::atomic<int> stepsRunning(0);
+static std::atomic<long long> stepAllocations(0);
+static std::atomic<StepAllocationHandler> stepAllocationHandler(nullptr);
+
+// Whether AllocatePages asks for huge pages, and how that's gone.
+static std::atomic<bool> hugePages(false);
+static std::atomic<long long> hugePagesRequested(0);
+static std::atomic<long long> hugePagesGranted(0);
+static std::atomic<long long> hugePageBytes(0);
+
+// What AllocatePages keeps just in front of the memory it hands out: where the memory it got really starts, and how much of it there is if it
+// came from the OS (or 0 if it came from operator new).
+struct PageHeader
+{
+	void* memory;
+	size_t mapped;
+};
+
+// Asks the OS for bytes (a multiple of HUGE_PAGE_SIZE) on huge pages, starting on a huge page. Returns nullptr if it won't give us any.
+static void* mapHugePages(size_t bytes)
+{
+#if defined(_WIN32)
+	// Large pages have to be asked for in multiples of the large page size, which is 2 MB on everything we run on. Without the privilege to
+	// lock pages in memory this fails, and we fall back.
+	size_t largePage = GetLargePageMinimum();
+
+	if (largePage == 0 || bytes % largePage != 0)
+	{
+		return nullptr;
+	}
+
+	return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+#elif defined(GJK_PAGES_LINUX)
+	// Explicit huge pages first, which only works if some have been set aside (in /proc/sys/vm/nr_hugepages).
+#if defined(MAP_HUGETLB)
+	void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+	if (memory != MAP_FAILED)
+	{
+		return memory;
+	}
+#endif
+
+	// Otherwise ordinary pages, marked for the kernel to back with transparent huge pages. It can only do that for whole 2 MB stretches
+	// that start on a multiple of 2 MB, so map a huge page extra and trim it back to one that does.
+	char* mapped = (char*)mmap(nullptr, bytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (mapped == (char*)MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	char* start = (char*)(((uintptr_t)mapped + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+
+	if (start > mapped)
+	{
+		munmap(mapped, start - mapped);
+	}
+
+	munmap(start + bytes, mapped + HUGE_PAGE_SIZE - start);
+
+#if defined(MADV_HUGEPAGE)
+	madvise(start, bytes, MADV_HUGEPAGE);
+#endif
+
+	return start;
+#else
+	return nullptr;
+#endif
+}
+
+static void unmapHugePages(void* memory, size_t bytes)
+{
+#if defined(_WIN32)
+	VirtualFree(memory, 0, MEM_RELEASE);
+#elif defined(GJK_PAGES_LINUX)
+	munmap(memory, bytes);
+#endif
+}
+
+void TrackAllocation(MemoryTag tag, size_t bytes)
+{
+	if (bytes == 0)
+	{
+		return;
+	}
+
+	TagCounts& counts = tagCounts[tag];
+
+	long long now = counts.current.fetch_add((long long)bytes, std::memory_order_relaxed) + (long long)bytes;
+	long long peak = counts.peak.load(std::memory_order_relaxed);
+
+	while (now > peak && !counts.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+	{
+	}
+
+	counts.allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TrackFree(MemoryTag tag, size_t bytes)
+{
+	if (bytes == 0)
+	{
+		return;
+	}
+
+	TagCounts& counts = tagCounts[tag];
+
+	counts.current.fetch_sub((long long)bytes, std::memory_order_relaxed);
+	counts.allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void TrackResize(MemoryTag tag, size_t oldBytes, size_t newBytes)
+{
+	TrackFree(tag, oldBytes);
+	TrackAllocation(tag, newBytes);
+}
+
+MemoryUsage GetMemoryUsage(MemoryTag tag)
+{
+	MemoryUsage usage;
+	usage.current = tagCounts[tag].current.load(std::memory_order_relaxed);
+	usage.peak = tagCounts[tag].peak.load(std::memory_order_relaxed);
+	usage.allocations = tagCounts[tag].allocations.load(std::memory_order_relaxed);
+
+	return usage;
+}
+
+const char* GetMemoryTagName(MemoryTag tag)
+{
+	return tagNames[tag];
+}
+
+void CountHeapAllocation(size_t bytes)
+{
+	// Every allocation in the program comes through here, so when no step is running this has to cost as little as possible.
+	if (stepsRunning.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	stepAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	StepAllocationHandler handler = stepAllocationHandler.load(std::memory_order_relaxed);
+
+	if (handler != nullptr)
+	{
+		handler(bytes);
+	}
+}
+
+void BeginStepAllocations()
+{
+	stepsRunning.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EndStepAllocations()
+{
+	stepsRunning.fetch_sub(1, std::memory_order_relaxed);
+}
+
+long long GetStepAllocationCount()
+{
+	return stepAllocations.load(std::memory_order_relaxed);
+}
+
+void SetStepAllocationHandler(StepAllocationHandler handler)
+{
+	stepAllocationHandler.store(handler, std::memory_order_relaxed);
+}
+
+void SetHugePages(bool enabled)
+{
+	hugePages.store(enabled, std::memory_order_relaxed);
+}
+
+bool GetHugePages()
+{
+	return hugePages.load(std::memory_order_relaxed);
+}
+
+void* AllocatePages(size_t bytes, size_t alignment)
+{
+	// Room for the header in front, on a multiple of alignment.
+	size_t front = (sizeof(PageHeader) + alignment - 1) & ~(alignment - 1);
+	size_t total = bytes + front + alignment;
+
+	char* memory = nullptr;
+	size_t mapped = 0;
+
+	if (total >= HUGE_PAGE_SIZE && hugePages.load(std::memory_order_relaxed))
+	{
+		size_t pages = (total + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+		hugePagesRequested.fetch_add(1, std::memory_order_relaxed);
+		memory = (char*)mapHugePages(pages);
+
+		if (memory != nullptr)
+		{
+			mapped = pages;
+
+			hugePagesGranted.fetch_add(1, std::memory_order_relaxed);
+			hugePageBytes.fetch_add((long long)pages, std::memory_order_relaxed);
+			CountHeapAllocation(pages);
+		}
+	}
+
+	if (memory == nullptr)
+	{
+		memory = (char*)::operator new(total);
+	}
+
+	char* aligned = (char*)(((uintptr_t)memory + front + alignment - 1) & ~(uintptr_t)(alignment - 1));
+
+	PageHeader* header = (PageHeader*)aligned - 1;
+	header->memory = memory;
+	header->mapped = mapped;
+
+	return aligned;
+}
+
+void FreePages(void* memory, size_t bytes)
+{
+	if (memory == nullptr)
+	{
+		return;
+	}
+
+	PageHeader* header = (PageHeader*)memory - 1;
+
+	if (header->mapped != 0)
+	{
+		hugePageBytes.fetch_sub((long long)header->mapped, std::memory_order_relaxed);
+		unmapHugePages(header->memory, header->mapped);
+	}
+	else
+	{
+		::operator delete(header->memory);
+	}
+}
+
+HugePageUsage GetHugePageUsage()
+{
+	HugePageUsage usage;
+	usage.requested = hugePagesRequested.load(std::memory_order_relaxed);
+	usage.granted = hugePagesGranted.load(std::memory_order_relaxed);
+	usage.bytes = hugePageBytes.load(std::memory_order_relaxed);
+
+	return usage;
+}
+
+void ResetMemoryPeaks()
+{
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+	{
+		tagCounts[i].peak.store(tagCounts[i].current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+#endif // _MEMORY_TRACKER_CPP
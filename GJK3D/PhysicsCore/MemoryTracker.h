@@ -0,0 +1,205 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MemoryTracker.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MEMORY_TRACKER_H
+#define _MEMORY_TRACKER_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// What a piece of memory is for. Everything big the engine (and the demo) keeps is counted under one of these, so when a scene grows you can
+// see which part of it the memory is going to.
+enum MemoryTag
+{
+	MEMORY_MODELS,		// The models' vertices and indices, on our side.
+	MEMORY_OBJECTS,		// The demo's GameObjects.
+	MEMORY_BODIES,		// The BodyStore's arrays.
+	MEMORY_BROADPHASE,	// The broadphases' proxies and nodes.
+	MEMORY_CONTACTS,	// The pair caches, with their contact manifolds.
+	MEMORY_ARENA,		// The job system's step arenas (see StepArena).
+	MEMORY_GPU,			// Buffers on the GPU. These are only what we asked the driver for, which is all we can know about them.
+	MEMORY_TAG_COUNT
+};
+
+// How much memory is counted under a tag: right now, the most there has been at once (since the start, or since ResetMemoryPeaks) and how
+// many allocations made it up.
+struct MemoryUsage
+{
+	long long current;
+	long long peak;
+	long long allocations;
+};
+
+// Counts bytes as allocated or freed under a tag. These only count: the memory comes from wherever it came from. They can be called from any
+// thread, and cost an atomic add or two. Nothing of 0 bytes is counted, so freeing something that was never allocated is fine as long as
+// its size is 0.
+void TrackAllocation(MemoryTag tag, size_t bytes);
+void TrackFree(MemoryTag tag, size_t bytes);
+
+// For something reallocated at a new size (with realloc, or a GPU buffer made again bigger): counts oldBytes as freed and newBytes as
+// allocated.
+void TrackResize(MemoryTag tag, size_t oldBytes, size_t newBytes);
+
+MemoryUsage GetMemoryUsage(MemoryTag tag);
+
+// A short name for a tag, like "bodies".
+const char* GetMemoryTagName(MemoryTag tag);
+
+// Starts every tag's peak again from what it's using now.
+void ResetMemoryPeaks();
+
+// Heap allocations made while a physics step is running. Once a scene has warmed up (its containers have grown as big as it needs), a step
+// shouldn't allocate anything at all: an allocation is a lock or two inside malloc, shared by every thread, and a step's jobs on every
+// thread contending for it shows up as a spike. These are how to check.
+// The engine doesn't replace the global operator new (that belongs to the program), so allocations are only counted if the program's own
+// operator new calls CountHeapAllocation, which the benchmarks' does. PhysicsWorld::Step calls BeginStepAllocations and EndStepAllocations
+// around itself, and everything allocated in between, on any thread, counts. (So with several worlds stepping at once, or a thread of the
+// program's own allocating alongside a step, those count too.)
+void CountHeapAllocation(size_t bytes);
+void BeginStepAllocations();
+void EndStepAllocations();
+
+// How many allocations have been counted during steps, altogether.
+long long GetStepAllocationCount();
+
+// A function to call (as well as counting it) whenever something is allocated during a step. A debug build can break or assert in it to
+// find out what allocated, with the call stack that did it right there. Pass nullptr to stop.
+typedef void (*StepAllocationHandler)(size_t bytes);
+void SetStepAllocationHandler(StepAllocationHandler handler);
+
+// How many bytes long a cache line is (on every x86 and ARM core we run on).
+static const size_t CACHE_LINE = 64;
+
+// How big a huge page is: 2 MB, on x86 and on ARM with 4 KB pages.
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Memory for the engine's big arrays (the bodies', the broadphases' nodes and the step arenas), which can optionally come from huge pages.
+// Each 4 KB page the CPU touches needs an entry in the TLB, which only holds a couple of thousand of them, so a pass streaming through the
+// arrays of a million bodies (tens of megabytes) misses the TLB every few kilobytes. With 2 MB pages the same arrays are a few dozen pages.
+// Huge pages are off to begin with. With them on, anything of at least HUGE_PAGE_SIZE comes straight from the OS: on Windows as large pages,
+// which needs the "Lock pages in memory" privilege, and on Linux as explicit huge pages if any have been set aside, or else as transparent
+// huge pages. If the OS won't give us huge pages it comes from operator new after all, so turning them on never makes an allocation fail.
+// Everything allocated here starts on a multiple of alignment (a power of 2), and has to go back to FreePages
+// with the same size. Memory from the OS is passed to CountHeapAllocation, the same as memory from operator new is.
+void SetHugePages(bool enabled);
+bool GetHugePages();
+void* AllocatePages(size_t bytes, size_t alignment = CACHE_LINE);
+void FreePages(void* memory, size_t bytes);
+
+// How AllocatePages has done since the start: how many allocations asked for huge pages, how many of them got them, and how many bytes are
+// on huge pages right now.
+struct HugePageUsage
+{
+	long long requested;
+	long long granted;
+	long long bytes;
+};
+
+HugePageUsage GetHugePageUsage();
+
+// An allocator that counts what it allocates under Tag, for the containers that hold a subsystem's memory. Apart from the counting, it's
+// the same as std::allocator.
+// With an Alignment (see AllocatePages), its memory comes from AllocatePages, so it starts on a multiple of Alignment bytes, and big enough
+// arrays go on huge pages when they're turned on.
+template<typename T, MemoryTag Tag, size_t Alignment = 0>
+struct TrackedAllocator
+{
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef TrackedAllocator<U, Tag, Alignment> other;
+	};
+
+	TrackedAllocator()
+	{
+	}
+
+	template<typename U>
+	TrackedAllocator(const TrackedAllocator<U, Tag, Alignment>&)
+	{
+	}
+
+	T* allocate(size_t count)
+	{
+		TrackAllocation(Tag, count * sizeof(T));
+
+		if (Alignment == 0)
+		{
+			return (T*)::operator new(count * sizeof(T));
+		}
+
+		return (T*)AllocatePages(count * sizeof(T), Alignment);
+	}
+
+	void deallocate(T* memory, size_t count)
+	{
+		TrackFree(Tag, count * sizeof(T));
+
+		if (Alignment == 0)
+		{
+			::operator delete(memory);
+		}
+		else
+		{
+			FreePages(memory, count * sizeof(T));
+		}
+	}
+
+	template<typename U>
+	bool operator==(const TrackedAllocator<U, Tag, Alignment>&) const
+	{
+		return true;
+	}
+
+	template<typename U>
+	bool operator!=(const TrackedAllocator<U, Tag, Alignment>&) const
+	{
+		return false;
+	}
+};
+
+// A std::vector whose memory is counted under Tag.
+template<typename T, MemoryTag Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag> >;
+
+// A TrackedVector that starts on a cache line, for arrays that jobs split up between threads by range: as long as each range starts on a
+// cache line too, no two threads ever write to the same line.
+template<typename T, MemoryTag Tag>
+using AlignedTrackedVector = std::vector<T, TrackedAllocator<T, Tag, CACHE_LINE> >;
+
+#endif //_MEMORY_TRACKER_H
@@ -0,0 +1,1115 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MeshImport.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _MESH_IMPORT_CPP
+#define _MESH_IMPORT_CPP
+
+#include "MeshImport.h"
+#include "MappedFile.h"
+#include "MeshOptimize.h"
+#include "glm\gtc\matrix_transform.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include "glm\gtc\type_ptr.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+// The part of a path after its last slash, and the part up to and including it.
+static std::string getFileName(const std::string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+
+	return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static std::string getDirectory(const std::string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+
+	return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+static std::string getExtension(const std::string& path)
+{
+	std::string name = getFileName(path);
+	size_t dot = name.find_last_of('.');
+	std::string extension = dot == std::string::npos ? std::string() : name.substr(dot + 1);
+
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+
+	return extension;
+}
+
+bool ImportMesh(const std::string& fileName, SceneModel& model, std::string& error)
+{
+	MappedFile file;
+
+	if (!file.Open(fileName))
+	{
+		error = "Couldn't open " + fileName + ".";
+		return false;
+	}
+
+	return ImportMesh(fileName, file.GetData(), file.GetSize(), model, error);
+}
+
+bool ImportMesh(const std::string& fileName, const char* data, size_t size, SceneModel& model, std::string& error)
+{
+	std::string extension = getExtension(fileName);
+	bool imported = false;
+
+	if (extension == "obj")
+	{
+		imported = ImportOBJ(data, size, model, error);
+	}
+	else if (extension == "gltf" || extension == "glb")
+	{
+		imported = ImportGLTF(data, size, getDirectory(fileName), model, error);
+	}
+	else
+	{
+		error = "Don't know how to import ." + extension + " files.";
+		return false;
+	}
+
+	if (!imported)
+	{
+		error = fileName + ": " + error;
+		return false;
+	}
+
+	std::string name = getFileName(fileName);
+	model.name = name.substr(0, name.find_last_of('.'));
+
+	// Files are rarely in a good order for the GPU (exporters tend to go material by material, or face by face), and this is the one place
+	// every model goes through before it's drawn.
+	OptimizeVertexCache(model.indices.data(), (int)model.indices.size(), (int)model.positions.size());
+	OptimizeOverdraw(model.positions.data(), model.indices.data(), (int)model.indices.size(), (int)model.positions.size());
+
+	return true;
+}
+
+// Reads a float from text, moving past it. Returns false if there isn't one.
+static bool readFloat(const char*& at, const char* end, float& value)
+{
+	while (at < end && (*at == ' ' || *at == '\t'))
+	{
+		at++;
+	}
+
+	// strtof needs the number to end before the text does, which the last line of a mapped file might not.
+	char number[64];
+	size_t length = 0;
+
+	while (at + length < end && length + 1 < sizeof(number) && !isspace((unsigned char)at[length]))
+	{
+		number[length] = at[length];
+		length++;
+	}
+
+	number[length] = '\0';
+
+	char* numberEnd;
+	value = strtof(number, &numberEnd);
+
+	if (numberEnd == number)
+	{
+		return false;
+	}
+
+	at += numberEnd - number;
+
+	return true;
+}
+
+bool ImportOBJ(const char* text, size_t size, SceneModel& model, std::string& error)
+{
+	model.positions.clear();
+	model.colors.clear();
+	model.indices.clear();
+
+	const char* end = text + size;
+	const char* line = text;
+	int lineNumber = 0;
+
+	std::vector<unsigned int> polygon;
+
+	while (line < end)
+	{
+		const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+
+		if (lineEnd == nullptr)
+		{
+			lineEnd = end;
+		}
+
+		lineNumber++;
+
+		const char* at = line;
+		line = lineEnd + 1;
+
+		while (at < lineEnd && (*at == ' ' || *at == '\t'))
+		{
+			at++;
+		}
+
+		if (lineEnd - at >= 2 && at[0] == 'v' && (at[1] == ' ' || at[1] == '\t'))
+		{
+			at += 2;
+
+			float values[6];
+			int count = 0;
+
+			while (count < 6 && readFloat(at, lineEnd, values[count]))
+			{
+				count++;
+			}
+
+			if (count < 3)
+			{
+				error = "line " + std::to_string(lineNumber) + ": a vertex needs a position.";
+				return false;
+			}
+
+			model.positions.push_back(glm::vec3(values[0], values[1], values[2]));
+
+			// Four numbers is a position and a w (which we don't need), six is a position and a color.
+			model.colors.push_back(count == 6 ? glm::vec4(values[3], values[4], values[5], 1.0f) : glm::vec4(1.0f));
+		}
+		else if (lineEnd - at >= 2 && at[0] == 'f' && (at[1] == ' ' || at[1] == '\t'))
+		{
+			at += 2;
+			polygon.clear();
+
+			while (at < lineEnd)
+			{
+				while (at < lineEnd && isspace((unsigned char)*at))
+				{
+					at++;
+				}
+
+				if (at == lineEnd)
+				{
+					break;
+				}
+
+				// Each corner is v, v/vt, v//vn or v/vt/vn, and we only want the v. Negative numbers count back from the last vertex so far.
+				char* numberEnd;
+				long index = strtol(at, &numberEnd, 10);
+
+				if (numberEnd == at || index == 0)
+				{
+					error = "line " + std::to_string(lineNumber) + ": couldn't read a face's corners.";
+					return false;
+				}
+
+				index = index > 0 ? index - 1 : (long)model.positions.size() + index;
+
+				if (index < 0 || index >= (long)model.positions.size())
+				{
+					error = "line " + std::to_string(lineNumber) + ": a face uses a vertex that isn't there.";
+					return false;
+				}
+
+				polygon.push_back((unsigned int)index);
+
+				at = numberEnd;
+
+				while (at < lineEnd && !isspace((unsigned char)*at))
+				{
+					at++;
+				}
+			}
+
+			for (int i = 1; i + 1 < (int)polygon.size(); i++)
+			{
+				model.indices.push_back(polygon[0]);
+				model.indices.push_back(polygon[i]);
+				model.indices.push_back(polygon[i + 1]);
+			}
+		}
+	}
+
+	if (model.indices.empty())
+	{
+		error = "there are no faces.";
+		return false;
+	}
+
+	return true;
+}
+
+// Just enough JSON to read glTF with: a tree of values, with objects' members kept in the order they came in.
+struct JsonValue
+{
+	enum Type
+	{
+		JSON_NULL,
+		JSON_BOOL,
+		JSON_NUMBER,
+		JSON_STRING,
+		JSON_ARRAY,
+		JSON_OBJECT
+	};
+
+	Type type;
+	double number;
+	std::string string;
+	std::vector<JsonValue> items;
+	std::vector<std::string> keys;		// For objects, the name of each item.
+
+	JsonValue()
+	{
+		type = JSON_NULL;
+		number = 0.0;
+	}
+
+	int Size() const
+	{
+		return (int)items.size();
+	}
+
+	const JsonValue* Find(const char* key) const
+	{
+		for (int i = 0; i < (int)keys.size(); i++)
+		{
+			if (keys[i] == key)
+			{
+				return &items[i];
+			}
+		}
+
+		return nullptr;
+	}
+
+	// A member that should be a number, or fallback if it isn't there.
+	double Number(const char* key, double fallback) const
+	{
+		const JsonValue* value = Find(key);
+
+		return value != nullptr && value->type == JSON_NUMBER ? value->number : fallback;
+	}
+
+	// An item of an array member, or nullptr if there isn't one.
+	const JsonValue* At(const char* key, int index) const
+	{
+		const JsonValue* value = Find(key);
+
+		return value != nullptr && value->type == JSON_ARRAY && index >= 0 && index < value->Size() ? &value->items[index] : nullptr;
+	}
+};
+
+class JsonParser
+{
+	const char* at;
+	const char* end;
+
+	// Deeper than any real glTF goes, but shallow enough that a broken file can't run us out of stack.
+	static const int MAX_DEPTH = 64;
+
+	void skipSpace()
+	{
+		while (at < end && isspace((unsigned char)*at))
+		{
+			at++;
+		}
+	}
+
+	bool match(const char* word)
+	{
+		size_t length = strlen(word);
+
+		if ((size_t)(end - at) < length || strncmp(at, word, length) != 0)
+		{
+			return false;
+		}
+
+		at += length;
+		return true;
+	}
+
+	bool parseString(std::string& string)
+	{
+		// We're on the opening quote.
+		at++;
+		string.clear();
+
+		while (at < end && *at != '"')
+		{
+			if (*at != '\\')
+			{
+				string += *at++;
+				continue;
+			}
+
+			if (++at == end)
+			{
+				return false;
+			}
+
+			char escaped = *at++;
+
+			switch (escaped)
+			{
+			case 'b': string += '\b'; break;
+			case 'f': string += '\f'; break;
+			case 'n': string += '\n'; break;
+			case 'r': string += '\r'; break;
+			case 't': string += '\t'; break;
+			case 'u':
+			{
+				// glTF only needs names and uris out of its strings, so anything past ASCII just becomes a '?'.
+				if (end - at < 4)
+				{
+					return false;
+				}
+
+				unsigned long code = strtoul(std::string(at, 4).c_str(), nullptr, 16);
+				string += code < 128 ? (char)code : '?';
+				at += 4;
+				break;
+			}
+			default: string += escaped; break;
+			}
+		}
+
+		if (at == end)
+		{
+			return false;
+		}
+
+		at++;
+		return true;
+	}
+
+	bool parseValue(JsonValue& value, int depth)
+	{
+		skipSpace();
+
+		if (at == end || depth > MAX_DEPTH)
+		{
+			return false;
+		}
+
+		if (*at == '{' || *at == '[')
+		{
+			bool object = *at == '{';
+			char close = object ? '}' : ']';
+
+			value.type = object ? JsonValue::JSON_OBJECT : JsonValue::JSON_ARRAY;
+			at++;
+			skipSpace();
+
+			if (at < end && *at == close)
+			{
+				at++;
+				return true;
+			}
+
+			while (true)
+			{
+				if (object)
+				{
+					skipSpace();
+
+					if (at == end || *at != '"')
+					{
+						return false;
+					}
+
+					value.keys.push_back(std::string());
+
+					if (!parseString(value.keys.back()))
+					{
+						return false;
+					}
+
+					skipSpace();
+
+					if (at == end || *at++ != ':')
+					{
+						return false;
+					}
+				}
+
+				value.items.push_back(JsonValue());
+
+				if (!parseValue(value.items.back(), depth + 1))
+				{
+					return false;
+				}
+
+				skipSpace();
+
+				if (at == end)
+				{
+					return false;
+				}
+
+				if (*at == close)
+				{
+					at++;
+					return true;
+				}
+
+				if (*at++ != ',')
+				{
+					return false;
+				}
+			}
+		}
+
+		if (*at == '"')
+		{
+			value.type = JsonValue::JSON_STRING;
+			return parseString(value.string);
+		}
+
+		if (match("true"))
+		{
+			value.type = JsonValue::JSON_BOOL;
+			value.number = 1.0;
+			return true;
+		}
+
+		if (match("false"))
+		{
+			value.type = JsonValue::JSON_BOOL;
+			return true;
+		}
+
+		if (match("null"))
+		{
+			value.type = JsonValue::JSON_NULL;
+			return true;
+		}
+
+		// A number. Like readFloat, copy it out first so strtod can't run off the end.
+		char number[64];
+		size_t length = 0;
+
+		while (at + length < end && length + 1 < sizeof(number) && strchr("+-0123456789.eE", at[length]) != nullptr)
+		{
+			number[length] = at[length];
+			length++;
+		}
+
+		number[length] = '\0';
+
+		char* numberEnd;
+		value.type = JsonValue::JSON_NUMBER;
+		value.number = strtod(number, &numberEnd);
+
+		if (numberEnd == number)
+		{
+			return false;
+		}
+
+		at += numberEnd - number;
+		return true;
+	}
+
+public:
+	bool Parse(const char* text, size_t size, JsonValue& root)
+	{
+		at = text;
+		end = text + size;
+
+		if (!parseValue(root, 0))
+		{
+			return false;
+		}
+
+		skipSpace();
+
+		// Allow the padding a GLB's JSON chunk can end with.
+		while (at < end && *at == '\0')
+		{
+			at++;
+		}
+
+		return at == end;
+	}
+};
+
+static bool decodeBase64(const char* text, size_t size, std::vector<unsigned char>& bytes)
+{
+	static const char* ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	unsigned int bits = 0;
+	int count = 0;
+
+	for (size_t i = 0; i < size && text[i] != '='; i++)
+	{
+		const char* found = strchr(ALPHABET, text[i]);
+
+		if (found == nullptr || text[i] == '\0')
+		{
+			return false;
+		}
+
+		bits = (bits << 6) | (unsigned int)(found - ALPHABET);
+		count += 6;
+
+		if (count >= 8)
+		{
+			count -= 8;
+			bytes.push_back((unsigned char)(bits >> count));
+		}
+	}
+
+	return true;
+}
+
+// Turns %xx escapes in a uri back into the characters they stand for.
+static std::string decodeUri(const std::string& uri)
+{
+	std::string decoded;
+
+	for (size_t i = 0; i < uri.size(); i++)
+	{
+		if (uri[i] == '%' && i + 2 < uri.size() && isxdigit((unsigned char)uri[i + 1]) && isxdigit((unsigned char)uri[i + 2]))
+		{
+			decoded += (char)strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16);
+			i += 2;
+		}
+		else
+		{
+			decoded += uri[i];
+		}
+	}
+
+	return decoded;
+}
+
+// The glTF being imported: its JSON, and the bytes of each of its buffers.
+struct GLTFFile
+{
+	JsonValue root;
+	std::vector<std::vector<unsigned char> > buffers;
+
+	// The GLB's binary chunk, which buffer 0 is when it has no uri.
+	const char* binary;
+	size_t binarySize;
+};
+
+enum GLTFComponentType
+{
+	GLTF_BYTE = 5120,
+	GLTF_UNSIGNED_BYTE = 5121,
+	GLTF_SHORT = 5122,
+	GLTF_UNSIGNED_SHORT = 5123,
+	GLTF_UNSIGNED_INT = 5125,
+	GLTF_FLOAT = 5126
+};
+
+static int getComponentSize(int componentType)
+{
+	switch (componentType)
+	{
+	case GLTF_BYTE:
+	case GLTF_UNSIGNED_BYTE:
+		return 1;
+	case GLTF_SHORT:
+	case GLTF_UNSIGNED_SHORT:
+		return 2;
+	case GLTF_UNSIGNED_INT:
+	case GLTF_FLOAT:
+		return 4;
+	}
+
+	return 0;
+}
+
+// One component of an accessor, as a float. Normalized integers are mapped to 0..1 (or -1..1), the way glTF says.
+static float readComponent(const unsigned char* bytes, int componentType, bool normalized)
+{
+	switch (componentType)
+	{
+	case GLTF_BYTE:
+	{
+		signed char value = (signed char)bytes[0];
+		return normalized ? glm::max(value / 127.0f, -1.0f) : (float)value;
+	}
+	case GLTF_UNSIGNED_BYTE:
+		return normalized ? bytes[0] / 255.0f : (float)bytes[0];
+	case GLTF_SHORT:
+	{
+		short value;
+		memcpy(&value, bytes, sizeof(value));
+		return normalized ? glm::max(value / 32767.0f, -1.0f) : (float)value;
+	}
+	case GLTF_UNSIGNED_SHORT:
+	{
+		unsigned short value;
+		memcpy(&value, bytes, sizeof(value));
+		return normalized ? value / 65535.0f : (float)value;
+	}
+	case GLTF_UNSIGNED_INT:
+	{
+		unsigned int value;
+		memcpy(&value, bytes, sizeof(value));
+		return (float)value;
+	}
+	case GLTF_FLOAT:
+	{
+		float value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+	}
+
+	return 0.0f;
+}
+
+// Reads every element of an accessor as floats, components components each (padding with the last of fill if the accessor has fewer).
+// indices are read the same way, since even a 32 bit index fits exactly in a float... up to 16 million, which is checked for.
+static bool readAccessor(const GLTFFile& gltf, int index, int components, const float* fill, std::vector<float>& values, std::string& error)
+{
+	const JsonValue* accessor = gltf.root.At("accessors", index);
+
+	if (accessor == nullptr)
+	{
+		error = "an accessor is missing.";
+		return false;
+	}
+
+	if (accessor->Find("sparse") != nullptr)
+	{
+		error = "sparse accessors aren't supported.";
+		return false;
+	}
+
+	const JsonValue* type = accessor->Find("type");
+	int typeComponents = 0;
+
+	if (type != nullptr && type->type == JsonValue::JSON_STRING)
+	{
+		typeComponents = type->string == "SCALAR" ? 1 : type->string == "VEC2" ? 2 : type->string == "VEC3" ? 3 : type->string == "VEC4" ? 4 : 0;
+	}
+
+	int componentType = (int)accessor->Number("componentType", 0);
+	int componentSize = getComponentSize(componentType);
+	int count = (int)accessor->Number("count", 0);
+	const JsonValue* normalizedValue = accessor->Find("normalized");
+	bool normalized = normalizedValue != nullptr && normalizedValue->number != 0.0;
+
+	if (typeComponents == 0 || componentSize == 0 || count < 0)
+	{
+		error = "an accessor has a type we can't read.";
+		return false;
+	}
+
+	const JsonValue* view = gltf.root.At("bufferViews", (int)accessor->Number("bufferView", -1));
+
+	if (view == nullptr)
+	{
+		error = "an accessor has no buffer view.";
+		return false;
+	}
+
+	int buffer = (int)view->Number("buffer", -1);
+
+	if (buffer < 0 || buffer >= (int)gltf.buffers.size())
+	{
+		error = "a buffer view's buffer is missing.";
+		return false;
+	}
+
+	const std::vector<unsigned char>& bytes = gltf.buffers[buffer];
+	size_t elementSize = (size_t)componentSize * typeComponents;
+	size_t stride = (size_t)view->Number("byteStride", 0);
+	size_t start = (size_t)view->Number("byteOffset", 0) + (size_t)accessor->Number("byteOffset", 0);
+	size_t viewEnd = (size_t)view->Number("byteOffset", 0) + (size_t)view->Number("byteLength", 0);
+
+	if (stride == 0)
+	{
+		stride = elementSize;
+	}
+
+	if (count > 0 && (start + (count - 1) * stride + elementSize > viewEnd || viewEnd > bytes.size()))
+	{
+		error = "an accessor goes past the end of its buffer.";
+		return false;
+	}
+
+	values.resize((size_t)count * components);
+
+	for (int i = 0; i < count; i++)
+	{
+		const unsigned char* element = bytes.data() + start + i * stride;
+
+		for (int j = 0; j < components; j++)
+		{
+			values[i * components + j] = j < typeComponents ? readComponent(element + j * componentSize, componentType, normalized) : fill[j];
+		}
+	}
+
+	return true;
+}
+
+// Adds one primitive to the model, with its positions moved by transform.
+static bool addPrimitive(const GLTFFile& gltf, const JsonValue& primitive, const glm::mat4& transform, SceneModel& model, std::string& error)
+{
+	// Only triangle lists (mode 4, which is also what no mode means). Points, lines and strips are skipped.
+	if ((int)primitive.Number("mode", 4) != 4)
+	{
+		return true;
+	}
+
+	const JsonValue* attributes = primitive.Find("attributes");
+
+	if (attributes == nullptr || attributes->Find("POSITION") == nullptr)
+	{
+		return true;
+	}
+
+	static const float FILL[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	std::vector<float> positions;
+	std::vector<float> colors;
+	std::vector<float> indices;
+
+	if (!readAccessor(gltf, (int)attributes->Number("POSITION", -1), 3, FILL, positions, error))
+	{
+		return false;
+	}
+
+	int count = (int)positions.size() / 3;
+
+	if (attributes->Find("COLOR_0") != nullptr && !readAccessor(gltf, (int)attributes->Number("COLOR_0", -1), 4, FILL, colors, error))
+	{
+		return false;
+	}
+
+	if (primitive.Find("indices") != nullptr)
+	{
+		if (!readAccessor(gltf, (int)primitive.Number("indices", -1), 1, FILL, indices, error))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		// No indices means every three vertices in order are a triangle.
+		for (int i = 0; i < count; i++)
+		{
+			indices.push_back((float)i);
+		}
+	}
+
+	unsigned int first = (unsigned int)model.positions.size();
+
+	for (int i = 0; i < count; i++)
+	{
+		model.positions.push_back(glm::vec3(transform * glm::vec4(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2], 1.0f)));
+		model.colors.push_back((int)colors.size() == count * 4 ? glm::make_vec4(&colors[i * 4]) : glm::vec4(1.0f));
+	}
+
+	for (int i = 0; i < (int)indices.size(); i++)
+	{
+		if (indices[i] < 0.0f || indices[i] >= (float)count || indices[i] >= 16777216.0f)
+		{
+			error = "a primitive uses a vertex that isn't there.";
+			return false;
+		}
+	}
+
+	// A transform that mirrors the mesh turns its triangles inside out, so they get wound the other way to keep them facing out.
+	bool mirrored = glm::determinant(glm::mat3(transform)) < 0.0f;
+
+	for (int i = 0; i + 2 < (int)indices.size(); i += 3)
+	{
+		model.indices.push_back(first + (unsigned int)indices[i]);
+		model.indices.push_back(first + (unsigned int)indices[mirrored ? i + 2 : i + 1]);
+		model.indices.push_back(first + (unsigned int)indices[mirrored ? i + 1 : i + 2]);
+	}
+
+	return true;
+}
+
+static bool addMesh(const GLTFFile& gltf, int index, const glm::mat4& transform, SceneModel& model, std::string& error)
+{
+	const JsonValue* mesh = gltf.root.At("meshes", index);
+	const JsonValue* primitives = mesh != nullptr ? mesh->Find("primitives") : nullptr;
+
+	if (primitives == nullptr)
+	{
+		error = "a mesh is missing.";
+		return false;
+	}
+
+	for (int i = 0; i < primitives->Size(); i++)
+	{
+		if (!addPrimitive(gltf, primitives->items[i], transform, model, error))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Adds a node's mesh and then its children's, each with the transforms of every node above it. depth stops a node that (wrongly) is its own
+// ancestor from going around forever.
+static bool addNode(const GLTFFile& gltf, int index, const glm::mat4& parent, int depth, SceneModel& model, std::string& error)
+{
+	const JsonValue* node = gltf.root.At("nodes", index);
+
+	if (node == nullptr || depth > 64)
+	{
+		error = "a node is missing, or is inside itself.";
+		return false;
+	}
+
+	glm::mat4 local(1.0f);
+	const JsonValue* matrix = node->Find("matrix");
+
+	if (matrix != nullptr && matrix->Size() == 16)
+	{
+		// Column by column, which is how glm stores them too.
+		for (int i = 0; i < 16; i++)
+		{
+			glm::value_ptr(local)[i] = (float)matrix->items[i].number;
+		}
+	}
+	else
+	{
+		const JsonValue* translation = node->Find("translation");
+		const JsonValue* rotation = node->Find("rotation");
+		const JsonValue* scale = node->Find("scale");
+
+		if (translation != nullptr && translation->Size() == 3)
+		{
+			local = glm::translate(local, glm::vec3(translation->items[0].number, translation->items[1].number, translation->items[2].number));
+		}
+
+		// glTF gives quaternions as x, y, z, w, where glm's constructor wants w first.
+		if (rotation != nullptr && rotation->Size() == 4)
+		{
+			local = local * glm::mat4_cast(glm::quat((float)rotation->items[3].number, (float)rotation->items[0].number,
+				(float)rotation->items[1].number, (float)rotation->items[2].number));
+		}
+
+		if (scale != nullptr && scale->Size() == 3)
+		{
+			local = glm::scale(local, glm::vec3(scale->items[0].number, scale->items[1].number, scale->items[2].number));
+		}
+	}
+
+	glm::mat4 transform = parent * local;
+
+	if (node->Find("mesh") != nullptr && !addMesh(gltf, (int)node->Number("mesh", -1), transform, model, error))
+	{
+		return false;
+	}
+
+	const JsonValue* children = node->Find("children");
+
+	for (int i = 0; children != nullptr && i < children->Size(); i++)
+	{
+		if (!addNode(gltf, (int)children->items[i].number, transform, depth + 1, model, error))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ImportGLTF(const char* data, size_t size, const std::string& directory, SceneModel& model, std::string& error)
+{
+	model.positions.clear();
+	model.colors.clear();
+	model.indices.clear();
+
+	GLTFFile gltf;
+	gltf.binary = nullptr;
+	gltf.binarySize = 0;
+
+	const char* json = data;
+	size_t jsonSize = size;
+
+	// A GLB is a 12 byte header ("glTF", the version, and the length), and then chunks: the JSON, and then (usually) the binary buffer.
+	if (size >= 12 && memcmp(data, "glTF", 4) == 0)
+	{
+		unsigned int header[3];
+		memcpy(header, data, sizeof(header));
+
+		json = nullptr;
+
+		for (size_t offset = 12; offset + 8 <= size && offset + 8 <= header[2];)
+		{
+			unsigned int chunk[2];
+			memcpy(chunk, data + offset, sizeof(chunk));
+
+			if (chunk[0] > size - offset - 8)
+			{
+				break;
+			}
+
+			if (chunk[1] == 0x4E4F534A && json == nullptr)
+			{
+				json = data + offset + 8;
+				jsonSize = chunk[0];
+			}
+			else if (chunk[1] == 0x004E4942 && gltf.binary == nullptr)
+			{
+				gltf.binary = data + offset + 8;
+				gltf.binarySize = chunk[0];
+			}
+
+			offset += 8 + ((chunk[0] + 3) & ~3u);
+		}
+
+		if (json == nullptr)
+		{
+			error = "the GLB has no JSON chunk.";
+			return false;
+		}
+	}
+
+	JsonParser parser;
+
+	if (!parser.Parse(json, jsonSize, gltf.root) || gltf.root.type != JsonValue::JSON_OBJECT)
+	{
+		error = "couldn't parse the JSON.";
+		return false;
+	}
+
+	const JsonValue* buffers = gltf.root.Find("buffers");
+	gltf.buffers.resize(buffers != nullptr ? buffers->Size() : 0);
+
+	for (int i = 0; i < (int)gltf.buffers.size(); i++)
+	{
+		const JsonValue* uri = buffers->items[i].Find("uri");
+		std::vector<unsigned char>& bytes = gltf.buffers[i];
+
+		if (uri == nullptr)
+		{
+			if (i != 0 || gltf.binary == nullptr)
+			{
+				error = "a buffer has no data.";
+				return false;
+			}
+
+			bytes.assign(gltf.binary, gltf.binary + gltf.binarySize);
+		}
+		else if (uri->string.compare(0, 5, "data:") == 0)
+		{
+			size_t comma = uri->string.find(',');
+
+			if (comma == std::string::npos || uri->string.rfind(";base64", comma) == std::string::npos ||
+				!decodeBase64(uri->string.c_str() + comma + 1, uri->string.size() - comma - 1, bytes))
+			{
+				error = "a buffer's embedded data isn't base64.";
+				return false;
+			}
+		}
+		else
+		{
+			MappedFile file;
+
+			if (!file.Open(directory + decodeUri(uri->string)))
+			{
+				error = "couldn't open the buffer " + uri->string + ".";
+				return false;
+			}
+
+			bytes.assign(file.GetData(), file.GetData() + file.GetSize());
+		}
+	}
+
+	// The default scene (or the first one) holds the nodes to import. Without any scenes, every mesh is imported as it is.
+	const JsonValue* scene = gltf.root.At("scenes", (int)gltf.root.Number("scene", 0));
+
+	if (scene != nullptr)
+	{
+		const JsonValue* nodes = scene->Find("nodes");
+
+		for (int i = 0; nodes != nullptr && i < nodes->Size(); i++)
+		{
+			if (!addNode(gltf, (int)nodes->items[i].number, glm::mat4(1.0f), 0, model, error))
+			{
+				return false;
+			}
+		}
+	}
+	else
+	{
+		const JsonValue* meshes = gltf.root.Find("meshes");
+
+		for (int i = 0; meshes != nullptr && i < meshes->Size(); i++)
+		{
+			if (!addMesh(gltf, i, glm::mat4(1.0f), model, error))
+			{
+				return false;
+			}
+		}
+	}
+
+	if (model.indices.empty())
+	{
+		error = "there are no triangles.";
+		return false;
+	}
+
+	return true;
+}
+
+bool LoadMeshAsset(const std::string& fileName, HullCache* cache, MeshAsset& asset, std::string& error, int maxHullVertices)
+{
+	if (!ImportMesh(fileName, asset.model, error))
+	{
+		return false;
+	}
+
+	const glm::vec3* positions = asset.model.positions.data();
+	int numPositions = (int)asset.model.positions.size();
+
+	asset.hullFromCache = false;
+	asset.hull = cache != nullptr ? cache->GetHull(positions, numPositions, &asset.hullFromCache) : ConvexHull::FromPoints(positions, numPositions);
+	asset.hullEnlargement = 0.0f;
+
+	if (maxHullVertices > 0)
+	{
+		asset.hull = ConvexHull::Simplify(asset.hull, maxHullVertices, &asset.hullEnlargement);
+	}
+
+	return true;
+}
+
+#endif //_MESH_IMPORT_CPP
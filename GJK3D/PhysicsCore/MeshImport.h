@@ -0,0 +1,79 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MeshImport.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _MESH_IMPORT_H
+#define _MESH_IMPORT_H
+
+#include "ConvexHull.h"
+#include "HullCache.h"
+#include "SceneFile.h"
+#include <cstddef>
+#include <string>
+
+// Reads a triangle mesh into a SceneModel (its vertices' positions and colors, and its triangles), picking the format from the file's
+// extension: .obj for Wavefront OBJ, .gltf for glTF 2.0 (with its buffers in files next to it, or embedded in base64), or .glb for binary
+// glTF. The model is named after the file. Returns false if the file can't be read, and error says why.
+// The triangles are then reordered for drawing, first for the vertex cache and then for overdraw (see MeshOptimize.h), so they won't be in
+// the order the file had them. (ImportOBJ and ImportGLTF leave them as they are.)
+bool ImportMesh(const std::string& fileName, SceneModel& model, std::string& error);
+
+// The same, for a file that's already been loaded (by a FileBatch, say). fileName is still needed for its extension and its directory.
+bool ImportMesh(const std::string& fileName, const char* data, size_t size, SceneModel& model, std::string& error);
+
+// OBJ files only give each vertex a position, and sometimes a color (as "v x y z r g b"); texture coordinates, normals, groups and
+// materials are all skipped. Faces with more than three corners are split into a fan of triangles.
+bool ImportOBJ(const char* text, size_t size, SceneModel& model, std::string& error);
+
+// Every triangle primitive of every mesh in the default scene is put into the one model, moved by the transforms of the nodes it hangs from
+// (or, if there are no scenes, every mesh as it is). Only POSITION, COLOR_0 and the indices are read. directory is where buffers with a
+// relative uri are looked for.
+bool ImportGLTF(const char* data, size_t size, const std::string& directory, SceneModel& model, std::string& error);
+
+// An imported mesh, for drawing, and the convex hull around it, for GJK (see HillClimbHullShape).
+struct MeshAsset
+{
+	SceneModel model;
+	ConvexHull hull;
+	bool hullFromCache;		// Whether the hull was read from the cache, rather than built.
+	float hullEnlargement;	// How far the hull was pushed out by simplifying it (0 if it wasn't).
+};
+
+// Imports a mesh and gets the hull around its vertices from the cache (which builds and saves it, the first time). Without a cache the hull
+// is just built. If maxHullVertices isn't 0, the hull is then simplified to that many vertices (see ConvexHull::Simplify). The cache keeps
+// the full hull, since simplifying it is quick next to building it.
+bool LoadMeshAsset(const std::string& fileName, HullCache* cache, MeshAsset& asset, std::string& error, int maxHullVertices = 0);
+
+#endif //_MESH_IMPORT_H
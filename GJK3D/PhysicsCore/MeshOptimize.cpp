@@ -0,0 +1,360 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MeshOptimize.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _MESH_OPTIMIZE_CPP
+#define _MESH_OPTIMIZE_CPP
+
+#include "MeshOptimize.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// The scores from Forsyth's article: the three vertices of the last triangle get a flat score (so it doesn't matter which order they went in),
+// the rest of the cache falls off from there, and vertices with few triangles left get a boost so they're finished off rather than left behind.
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+// A vertex's score, from where it is in the cache (-1 if it isn't) and how many of its triangles haven't been drawn yet.
+static float vertexScore(int cachePosition, int remaining)
+{
+	if (remaining == 0)
+	{
+		// Nothing left to draw with it, so it doesn't matter.
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+
+	if (cachePosition >= 3)
+	{
+		score = powf(1.0f - (float)(cachePosition - 3) / (VERTEX_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+	}
+	else if (cachePosition >= 0)
+	{
+		score = LAST_TRIANGLE_SCORE;
+	}
+
+	return score + VALENCE_BOOST_SCALE * powf((float)remaining, -VALENCE_BOOST_POWER);
+}
+
+void OptimizeVertexCache(unsigned int* indices, int numIndices, int numVertices)
+{
+	int numTriangles = numIndices / 3;
+
+	if (numTriangles < 2 || numVertices == 0)
+	{
+		return;
+	}
+
+	// Every vertex's triangles, as one list with each vertex's part starting at triangleStart[v] (found the same way as a counting sort).
+	std::vector<int> remaining(numVertices, 0);
+	std::vector<int> triangleStart(numVertices + 1, 0);
+	std::vector<int> vertexTriangles(numTriangles * 3);
+
+	for (int i = 0; i < numTriangles * 3; i++)
+	{
+		remaining[indices[i]]++;
+	}
+
+	for (int v = 0; v < numVertices; v++)
+	{
+		triangleStart[v + 1] = triangleStart[v] + remaining[v];
+	}
+
+	{
+		std::vector<int> next(triangleStart.begin(), triangleStart.end() - 1);
+
+		for (int i = 0; i < numTriangles * 3; i++)
+		{
+			vertexTriangles[next[indices[i]]++] = i / 3;
+		}
+	}
+
+	// Vertices and triangles start out scored as if nothing were in the cache.
+	std::vector<float> score(numVertices);
+	std::vector<float> triangleScore(numTriangles);
+	std::vector<bool> drawn(numTriangles, false);
+
+	for (int v = 0; v < numVertices; v++)
+	{
+		score[v] = vertexScore(-1, remaining[v]);
+	}
+
+	for (int t = 0; t < numTriangles; t++)
+	{
+		triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+	}
+
+	// The cache, most recent first, with room for a triangle's worth of vertices past the end to fall out of it.
+	std::vector<int> cache;
+	cache.reserve(VERTEX_CACHE_SIZE + 3);
+
+	std::vector<unsigned int> output;
+	output.reserve(numTriangles * 3);
+
+	int best = -1;
+	int nextUndrawn = 0;
+
+	for (int count = 0; count < numTriangles; count++)
+	{
+		// If none of the cache's triangles are left, start again from the next triangle that hasn't been drawn. (Forsyth scans every triangle
+		// for the best one here, but that's quadratic on meshes made of many pieces, and this does nearly as well.)
+		if (best == -1)
+		{
+			while (drawn[nextUndrawn])
+			{
+				nextUndrawn++;
+			}
+
+			best = nextUndrawn;
+		}
+
+		drawn[best] = true;
+
+		const unsigned int* triangle = indices + best * 3;
+		output.insert(output.end(), triangle, triangle + 3);
+
+		// Take the triangle off each of its vertices' lists, and move them to the front of the cache.
+		for (int corner = 0; corner < 3; corner++)
+		{
+			int v = (int)triangle[corner];
+			int* list = vertexTriangles.data() + triangleStart[v];
+
+			for (int i = 0; i < remaining[v]; i++)
+			{
+				if (list[i] == best)
+				{
+					std::swap(list[i], list[remaining[v] - 1]);
+					break;
+				}
+			}
+
+			remaining[v]--;
+
+			std::vector<int>::iterator at = std::find(cache.begin(), cache.end(), v);
+
+			if (at != cache.end())
+			{
+				cache.erase(at);
+			}
+		}
+
+		cache.insert(cache.begin(), triangle, triangle + 3);
+
+		// Rescore everything in the cache (and whatever just fell out of it), and their triangles, keeping the best one to draw next.
+		best = -1;
+		float bestScore = -1.0f;
+
+		for (int i = 0; i < (int)cache.size(); i++)
+		{
+			int v = cache[i];
+			int position = i < VERTEX_CACHE_SIZE ? i : -1;
+			float change = vertexScore(position, remaining[v]) - score[v];
+			score[v] += change;
+
+			int* list = vertexTriangles.data() + triangleStart[v];
+
+			for (int j = 0; j < remaining[v]; j++)
+			{
+				triangleScore[list[j]] += change;
+			}
+		}
+
+		for (int i = 0; i < (int)cache.size() && i < VERTEX_CACHE_SIZE; i++)
+		{
+			int v = cache[i];
+			int* list = vertexTriangles.data() + triangleStart[v];
+
+			for (int j = 0; j < remaining[v]; j++)
+			{
+				if (triangleScore[list[j]] > bestScore)
+				{
+					best = list[j];
+					bestScore = triangleScore[list[j]];
+				}
+			}
+		}
+
+		if ((int)cache.size() > VERTEX_CACHE_SIZE)
+		{
+			cache.resize(VERTEX_CACHE_SIZE);
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+// One run of triangles for OptimizeOverdraw to move as a whole, and how much it should be drawn before the others.
+struct OverdrawCluster
+{
+	int first;
+	int count;
+	float sortKey;
+};
+
+void OptimizeOverdraw(const glm::vec3* positions, unsigned int* indices, int numIndices, int numVertices)
+{
+	int numTriangles = numIndices / 3;
+
+	if (numTriangles < 2 || numVertices == 0)
+	{
+		return;
+	}
+
+	// Split the triangles wherever one misses the cache on all three of its vertices. The triangles after that wouldn't have had anything
+	// cached from before it anyway, so they can go anywhere without costing the cache much.
+	std::vector<int> timestamps(numVertices, -VERTEX_CACHE_SIZE - 1);
+	std::vector<OverdrawCluster> clusters;
+	int time = 0;
+
+	for (int t = 0; t < numTriangles; t++)
+	{
+		int misses = 0;
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			unsigned int v = indices[t * 3 + corner];
+
+			if (time - timestamps[v] > VERTEX_CACHE_SIZE)
+			{
+				timestamps[v] = time++;
+				misses++;
+			}
+		}
+
+		if (misses == 3 || clusters.empty())
+		{
+			OverdrawCluster cluster;
+			cluster.first = t;
+			cluster.count = 0;
+			cluster.sortKey = 0.0f;
+
+			clusters.push_back(cluster);
+		}
+
+		clusters.back().count++;
+	}
+
+	if (clusters.size() < 2)
+	{
+		return;
+	}
+
+	// The middle of the mesh, weighting every triangle by its area.
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+
+	for (int t = 0; t < numTriangles; t++)
+	{
+		glm::vec3 a = positions[indices[t * 3]], b = positions[indices[t * 3 + 1]], c = positions[indices[t * 3 + 2]];
+		float area = glm::length(glm::cross(b - a, c - a));
+
+		meshCenter += (a + b + c) * (area / 3.0f);
+		meshArea += area;
+	}
+
+	meshCenter = meshArea > 0.0f ? meshCenter / meshArea : meshCenter;
+
+	// A cluster that's far out from the middle and facing away from it is likely to be in front of the others, from wherever it's seen.
+	for (int i = 0; i < (int)clusters.size(); i++)
+	{
+		glm::vec3 center(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+
+		for (int t = clusters[i].first; t < clusters[i].first + clusters[i].count; t++)
+		{
+			glm::vec3 a = positions[indices[t * 3]], b = positions[indices[t * 3 + 1]], c = positions[indices[t * 3 + 2]];
+			glm::vec3 cross = glm::cross(b - a, c - a);
+			float triangleArea = glm::length(cross);
+
+			center += (a + b + c) * (triangleArea / 3.0f);
+			normal += cross;
+			area += triangleArea;
+		}
+
+		float normalLength = glm::length(normal);
+
+		if (area > 0.0f && normalLength > 0.0f)
+		{
+			clusters[i].sortKey = glm::dot(center / area - meshCenter, normal / normalLength);
+		}
+	}
+
+	// (Stable, so clusters that are just as far out keep the cache order.)
+	std::stable_sort(clusters.begin(), clusters.end(), [](const OverdrawCluster& a, const OverdrawCluster& b)
+	{
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<unsigned int> output;
+	output.reserve(numTriangles * 3);
+
+	for (int i = 0; i < (int)clusters.size(); i++)
+	{
+		output.insert(output.end(), indices + clusters[i].first * 3, indices + (clusters[i].first + clusters[i].count) * 3);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+float AnalyzeVertexCache(const unsigned int* indices, int numIndices, int numVertices, int cacheSize)
+{
+	if (numIndices < 3)
+	{
+		return 0.0f;
+	}
+
+	// A vertex is in a first-in first-out cache until cacheSize more vertices have been put in after it.
+	std::vector<int> timestamps(numVertices, -cacheSize - 1);
+	int time = 0;
+	int misses = 0;
+
+	for (int i = 0; i < numIndices; i++)
+	{
+		if (time - timestamps[indices[i]] > cacheSize)
+		{
+			timestamps[indices[i]] = time++;
+			misses++;
+		}
+	}
+
+	return (float)misses / (numIndices / 3);
+}
+
+#endif //_MESH_OPTIMIZE_CPP
@@ -0,0 +1,62 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MeshOptimize.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _MESH_OPTIMIZE_H
+#define _MESH_OPTIMIZE_H
+
+#include "glm\glm.hpp"
+
+// How many vertices OptimizeVertexCache assumes the GPU keeps transformed. Real caches are somewhere from 16 to 32 (and not always a plain
+// list of the last few vertices), but an order that's good for one size is good for the others too.
+static const int VERTEX_CACHE_SIZE = 32;
+
+// Reorders a triangle mesh's triangles (in place) so that the ones sharing vertices are drawn close together, and the GPU can reuse the
+// vertices it's just transformed instead of transforming them again. This is Tom Forsyth's linear-speed vertex cache optimization: each
+// vertex is scored by how recently it was used (as if in a cache of VERTEX_CACHE_SIZE) and how few of its triangles are left, and the next
+// triangle is always the one whose vertices score highest. Which way each triangle faces doesn't change.
+void OptimizeVertexCache(unsigned int* indices, int numIndices, int numVertices);
+
+// Reorders a mesh's triangles (in place) so that the outside of it tends to be drawn first, covering up more of the inside before it's drawn
+// (so less gets shaded and thrown away). The triangles are split into clusters where the order the vertex cache optimization picked starts
+// over anyway (a triangle none of whose vertices are still in the cache), and the clusters are sorted by how far out they are and how much
+// they face outwards. Nothing within a cluster moves, so call this after OptimizeVertexCache, and the cache does about as well as before.
+void OptimizeOverdraw(const glm::vec3* positions, unsigned int* indices, int numIndices, int numVertices);
+
+// How many vertices a GPU with a first-in first-out cache of cacheSize vertices would have to transform per triangle, drawing the mesh in the
+// order it's in (the average cache miss ratio). 3 is the worst it can be; 0.5 is about the best for a large, regular mesh.
+float AnalyzeVertexCache(const unsigned int* indices, int numIndices, int numVertices, int cacheSize = 16);
+
+#endif //_MESH_OPTIMIZE_H
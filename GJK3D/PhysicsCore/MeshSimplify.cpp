@@ -0,0 +1,250 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MeshSimplify.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _MESH_SIMPLIFY_CPP
+#define _MESH_SIMPLIFY_CPP
+
+#include "MeshSimplify.h"
+#include <algorithm>
+#include <cmath>
+
+// How many cells the grid can have along each axis, so that a cell's coordinates fit in 21 bits each of a 64 bit key.
+static const int SIMPLIFY_GRID_LIMIT = 1 << 21;
+
+// A triangle by its three vertices, turned so the smallest comes first (which keeps which way it faces), so that the same triangle always
+// looks the same and the copies can be found by sorting.
+struct SimplifiedTriangle
+{
+	unsigned int v[3];
+
+	SimplifiedTriangle(unsigned int a, unsigned int b, unsigned int c)
+	{
+		if (b < a && b < c)
+		{
+			v[0] = b;
+			v[1] = c;
+			v[2] = a;
+		}
+		else if (c < a && c < b)
+		{
+			v[0] = c;
+			v[1] = a;
+			v[2] = b;
+		}
+		else
+		{
+			v[0] = a;
+			v[1] = b;
+			v[2] = c;
+		}
+	}
+
+	bool operator<(const SimplifiedTriangle& other) const
+	{
+		return std::lexicographical_compare(v, v + 3, other.v, other.v + 3);
+	}
+
+	bool operator==(const SimplifiedTriangle& other) const
+	{
+		return v[0] == other.v[0] && v[1] == other.v[1] && v[2] == other.v[2];
+	}
+};
+
+// The box around the vertices.
+static void getMeshBounds(const glm::vec3* positions, int numVertices, glm::vec3& min, glm::vec3& max)
+{
+	min = max = numVertices > 0 ? positions[0] : glm::vec3(0.0f);
+
+	for (int i = 1; i < numVertices; i++)
+	{
+		min = glm::min(min, positions[i]);
+		max = glm::max(max, positions[i]);
+	}
+}
+
+void SimplifyMesh(const glm::vec3* positions, int numVertices, const unsigned int* indices, int numIndices, float cellSize,
+	std::vector<unsigned int>& out)
+{
+	out.clear();
+
+	if (numVertices == 0 || numIndices < 3)
+	{
+		return;
+	}
+
+	glm::vec3 min, max;
+	getMeshBounds(positions, numVertices, min, max);
+
+	// Cells any smaller than this would need more of them along an axis than fit in a key.
+	cellSize = std::max(cellSize, glm::max(max.x - min.x, glm::max(max.y - min.y, max.z - min.z)) / (SIMPLIFY_GRID_LIMIT - 1));
+
+	if (!(cellSize > 0.0f))
+	{
+		// Every vertex is in the same place, so there's nothing left but degenerate triangles.
+		return;
+	}
+
+	// Sort the vertices by the cell they're in, which brings each cell's vertices together. (The stable sort keeps them in order within a
+	// cell, so ties below go to the first.)
+	std::vector<unsigned long long> keys(numVertices);
+	std::vector<int> order(numVertices);
+
+	for (int i = 0; i < numVertices; i++)
+	{
+		glm::vec3 cell = glm::floor((positions[i] - min) / cellSize);
+
+		keys[i] = ((unsigned long long)cell.x << 42) | ((unsigned long long)cell.y << 21) | (unsigned long long)cell.z;
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&keys](int a, int b)
+	{
+		return keys[a] < keys[b];
+	});
+
+	// Then each cell's vertices all move onto the one closest to their average.
+	std::vector<unsigned int> moved(numVertices);
+
+	for (int start = 0; start < numVertices;)
+	{
+		int end = start + 1;
+		glm::vec3 sum = positions[order[start]];
+
+		while (end < numVertices && keys[order[end]] == keys[order[start]])
+		{
+			sum += positions[order[end]];
+			end++;
+		}
+
+		glm::vec3 average = sum / (float)(end - start);
+		int closest = order[start];
+
+		for (int i = start + 1; i < end; i++)
+		{
+			glm::vec3 offset = positions[order[i]] - average;
+			glm::vec3 closestOffset = positions[closest] - average;
+
+			if (glm::dot(offset, offset) < glm::dot(closestOffset, closestOffset))
+			{
+				closest = order[i];
+			}
+		}
+
+		for (int i = start; i < end; i++)
+		{
+			moved[order[i]] = (unsigned int)closest;
+		}
+
+		start = end;
+	}
+
+	// Keep the triangles that still have three different corners, once.
+	std::vector<SimplifiedTriangle> triangles;
+	triangles.reserve(numIndices / 3);
+
+	for (int i = 0; i + 2 < numIndices; i += 3)
+	{
+		unsigned int a = moved[indices[i]];
+		unsigned int b = moved[indices[i + 1]];
+		unsigned int c = moved[indices[i + 2]];
+
+		if (a != b && b != c && a != c)
+		{
+			triangles.push_back(SimplifiedTriangle(a, b, c));
+		}
+	}
+
+	std::sort(triangles.begin(), triangles.end());
+	triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+
+	out.resize(triangles.size() * 3);
+
+	for (int i = 0; i < (int)triangles.size(); i++)
+	{
+		out[i * 3] = triangles[i].v[0];
+		out[i * 3 + 1] = triangles[i].v[1];
+		out[i * 3 + 2] = triangles[i].v[2];
+	}
+}
+
+int BuildMeshLODs(const glm::vec3* positions, int numVertices, const unsigned int* indices, int numIndices, int maxLevels,
+	std::vector<MeshLOD>& lods, float ratio)
+{
+	lods.clear();
+
+	glm::vec3 min, max;
+	getMeshBounds(positions, numVertices, min, max);
+
+	float size = glm::length(max - min);
+
+	if (!(size > 0.0f))
+	{
+		return 0;
+	}
+
+	// Start with cells small enough that most of them would have a vertex or two, if the vertices were spread out evenly.
+	float cellSize = size / std::max(2.0f, powf((float)numVertices, 1.0f / 3.0f) * 2.0f);
+	int triangles = numIndices / 3;
+
+	std::vector<unsigned int> simplified;
+
+	while ((int)lods.size() < maxLevels && cellSize < size)
+	{
+		SimplifyMesh(positions, numVertices, indices, numIndices, cellSize, simplified);
+
+		int count = (int)simplified.size() / 3;
+
+		if (count == 0)
+		{
+			break;
+		}
+
+		if (count <= (int)(triangles * ratio))
+		{
+			lods.push_back(MeshLOD());
+			lods.back().indices = simplified;
+			lods.back().error = cellSize * sqrtf(3.0f) / size;
+
+			triangles = count;
+		}
+
+		cellSize *= 2.0f;
+	}
+
+	return (int)lods.size();
+}
+
+#endif //_MESH_SIMPLIFY_CPP
@@ -0,0 +1,69 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MeshSimplify.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _MESH_SIMPLIFY_H
+#define _MESH_SIMPLIFY_H
+
+#include "glm\glm.hpp"
+#include <vector>
+
+// One level of detail of a mesh: fewer triangles over the same vertices, and how far out of place they can be.
+struct MeshLOD
+{
+	std::vector<unsigned int> indices;
+
+	// The most any vertex was moved to make this level (the diagonal of the cells it was clustered in; see SimplifyMesh), as a fraction of
+	// the diagonal of the box around the whole mesh. Multiplied by how big the mesh is on screen, it's how far off the level looks there.
+	float error;
+};
+
+// Simplifies a triangle mesh by clustering its vertices: space is split into a grid of cells cellSize across, and every vertex in a cell
+// is moved onto one of them (the one closest to their average), so the triangles that end up with two corners in the same cell collapse
+// and are dropped, along with any that end up the same as another. out gets the triangles that are left, as indices into the same
+// positions, so a simplified mesh can share the original's vertex buffer (and keeps its colors, since every vertex it uses is one of the
+// originals).
+// This is quick (a sort of the vertices and a pass over the triangles) and never fails, but pays no attention to the shape: it's for
+// levels of detail that are only seen small, not for simplifying anything up close.
+void SimplifyMesh(const glm::vec3* positions, int numVertices, const unsigned int* indices, int numIndices, float cellSize,
+	std::vector<unsigned int>& out);
+
+// Builds a chain of up to maxLevels levels of detail for a mesh, each with at most ratio as many triangles as the one before it (starting
+// from the mesh itself), by clustering it (see SimplifyMesh) with cells twice as big each time until it's simplified that far. The chain
+// stops early once the cells would be bigger than the mesh, which leaves nothing. Returns how many levels there are in lods.
+int BuildMeshLODs(const glm::vec3* positions, int numVertices, const unsigned int* indices, int numIndices, int maxLevels,
+	std::vector<MeshLOD>& lods, float ratio = 0.5f);
+
+#endif //_MESH_SIMPLIFY_H
@@ -0,0 +1,255 @@
+/*
+Title: GJK-3D (OBB)
+File Name: MixedGJK.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _MIXED_GJK_H
+#define _MIXED_GJK_H
+
+#include "GJK.h"
+#include "Shapes.h"
+
+// Which precision the GJK math is done in.
+enum GJKPrecision
+{
+	GJK_PRECISION_FLOAT,	// Everything in float, exactly like a plain GJKSolver. (The default, and the fastest.)
+	GJK_PRECISION_DOUBLE,	// Everything in double. Slower, but the answer doesn't depend on how far from the origin the shapes are.
+	GJK_PRECISION_MIXED		// Float first, and double only for the queries float couldn't decide.
+};
+
+// A float has 24 bits of precision, so at 10,000 units from the origin two points can't be closer than about a millimeter apart. The
+// Minkowski Difference of two shapes out there gets built from points that have already lost that much, and a pair that is just touching
+// (or just apart) can come out either way.
+// This solver fixes that in two steps. First, both shapes are moved so that shape A's first support point sits at the origin. That move is
+// done in float, but the Minkowski Difference only depends on where the shapes are relative to each other, so nothing is lost by it, and
+// from then on every number GJK works with is small. Then in mixed mode the query runs in float, and only if it ends in a way that means
+// it was too close to call (touching, no progress, or out of iterations) does it run again in double. A clear hit or a clear miss never
+// needs double, and those are almost every query.
+// A shape that can't be moved (see translateShape in Shapes.h) is tested where it is.
+class MixedGJKSolver
+{
+	GJKSolver single;
+	GJKSolverT<double> precise;
+
+	// The last query's simplex, in world space and in float whichever solver made it.
+	Simplex simplex;
+
+	GJKPrecision precision;
+	bool usedDouble;
+
+	GJKStats* stats;
+
+	// Copies the double solver's simplex into ours, putting the points on A back where they were before the shapes were moved.
+	// (The Minkowski Difference points themselves don't change when both shapes move together.)
+	void copySimplex(const GJKSolverT<double>::SimplexType& from, const glm::vec3& origin)
+	{
+		simplex.count = from.count;
+
+		for (int i = 0; i < from.count; i++)
+		{
+			simplex.points[i] = glm::vec3(from.points[i]);
+			simplex.pointsA[i] = glm::vec3(from.pointsA[i] + glm::dvec3(origin));
+		}
+	}
+	void copySimplex(const Simplex& from, const glm::vec3& origin)
+	{
+		simplex.count = from.count;
+
+		for (int i = 0; i < from.count; i++)
+		{
+			simplex.points[i] = from.points[i];
+			simplex.pointsA[i] = from.pointsA[i] + origin;
+		}
+	}
+
+	// True if a float query ended in a way that means float wasn't sure.
+	static bool isAmbiguous(GJKTermination termination)
+	{
+		return termination == GJK_TOUCHING || termination == GJK_NO_PROGRESS || termination == GJK_ITERATION_CAP;
+	}
+
+public:
+	MixedGJKSolver(GJKPrecision inPrecision = GJK_PRECISION_MIXED)
+	{
+		precision = inPrecision;
+		usedDouble = false;
+		stats = nullptr;
+	}
+
+	void SetPrecision(GJKPrecision inPrecision)
+	{
+		precision = inPrecision;
+
+		// Which solver counts the queries depends on the precision.
+		SetStats(stats);
+	}
+	GJKPrecision GetPrecision()
+	{
+		return precision;
+	}
+
+	// Sets the iteration budget for each query, in both precisions.
+	void SetMaxIterations(int max)
+	{
+		single.SetMaxIterations(max);
+		precise.SetMaxIterations(max);
+	}
+	int GetMaxIterations()
+	{
+		return single.GetMaxIterations();
+	}
+
+	// Starts counting every query into inStats (or stops, given nullptr). A mixed query is counted once, as the float query it started as,
+	// and doubleQueries counts how many of them went on to double.
+	void SetStats(GJKStats* inStats)
+	{
+		stats = inStats;
+		single.SetStats(precision == GJK_PRECISION_DOUBLE ? nullptr : inStats);
+		precise.SetStats(precision == GJK_PRECISION_DOUBLE ? inStats : nullptr);
+	}
+	GJKStats* GetStats()
+	{
+		return stats;
+	}
+
+	// How the last query ended, from whichever solver gave the answer.
+	GJKTermination GetTermination()
+	{
+		return usedDouble ? precise.GetTermination() : single.GetTermination();
+	}
+	int GetIterations()
+	{
+		return usedDouble ? precise.GetIterations() : single.GetIterations();
+	}
+	int GetSupportCalls()
+	{
+		return usedDouble ? precise.GetSupportCalls() : single.GetSupportCalls();
+	}
+
+	// True if the last query's answer came from double.
+	bool UsedDouble()
+	{
+		return usedDouble;
+	}
+
+	// Returns true if the two shapes are colliding, the same as GJKSolver::TestGJK, but in the precision set above.
+	template<typename ShapeA, typename ShapeB>
+	bool TestGJK(const ShapeA& a, const ShapeB& b, GJKCache* cache = nullptr);
+
+	// The same as GJKSolver::TestGJKBatch, but every pair goes through TestGJK above, one after another.
+	template<typename ShapeA, typename ShapeB>
+	void TestGJKBatch(const ShapeA* const* a, const ShapeB* const* b, int count, unsigned char* out, GJKCache* const* caches = nullptr,
+		Simplex* simplices = nullptr);
+
+	// The simplex from the last query, in world space.
+	Simplex& GetSimplex()
+	{
+		return simplex;
+	}
+};
+
+template<typename ShapeA, typename ShapeB>
+bool MixedGJKSolver::TestGJK(const ShapeA& a, const ShapeB& b, GJKCache* cache)
+{
+	usedDouble = false;
+
+	if (precision == GJK_PRECISION_FLOAT)
+	{
+		bool result = single.TestGJK(a, b, cache);
+		simplex = single.GetSimplex();
+
+		return result;
+	}
+
+	// Move the pair so that one of A's support points is at the origin. Any point on A would do, it just has to be near the pair.
+	glm::vec3 origin = getFarthestPointInDirection(a, glm::vec3(1.0f));
+
+	ShapeA localA = a;
+	ShapeB localB = b;
+
+	if (!translateShape(localA, -origin) || !translateShape(localB, -origin))
+	{
+		localA = a;
+		localB = b;
+		origin = glm::vec3(0.0f);
+	}
+
+	if (precision == GJK_PRECISION_MIXED)
+	{
+		bool result = single.TestGJK(localA, localB, cache);
+
+		if (!isAmbiguous(single.GetTermination()))
+		{
+			copySimplex(single.GetSimplex(), origin);
+
+			return result;
+		}
+	}
+
+	// Either we were asked for double, or float couldn't decide. (The float query has left its last direction in the cache, which is as good a
+	// place as any for the double one to start from.)
+	usedDouble = true;
+
+	if (stats != nullptr)
+	{
+		stats->doubleQueries++;
+	}
+
+	bool result = precise.TestGJK(localA, localB, cache);
+	copySimplex(precise.GetSimplex(), origin);
+
+	return result;
+}
+
+template<typename ShapeA, typename ShapeB>
+void MixedGJKSolver::TestGJKBatch(const ShapeA* const* a, const ShapeB* const* b, int count, unsigned char* out, GJKCache* const* caches,
+	Simplex* simplices)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (i + GJK_BATCH_PREFETCH < count)
+		{
+			GJK_PREFETCH(a[i + GJK_BATCH_PREFETCH]);
+			GJK_PREFETCH(b[i + GJK_BATCH_PREFETCH]);
+		}
+
+		out[i] = TestGJK(*a[i], *b[i], caches != nullptr ? caches[i] : nullptr) ? 1 : 0;
+
+		if (out[i] && simplices != nullptr)
+		{
+			simplices[i] = simplex;
+		}
+	}
+}
+
+#endif //_MIXED_GJK_H
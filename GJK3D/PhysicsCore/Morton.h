@@ -0,0 +1,87 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Morton.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _MORTON_H
+#define _MORTON_H
+
+#include "glm\glm.hpp"
+
+// Morton codes: a point's x, y and z, each cut into 1024 steps, with their bits interleaved (z y x z y x ...). Sorting points by their codes
+// walks space in a Z shape, one block at a time, so the points that are near each other in space mostly end up near each other in the
+// order too. Codes that start with the same bits are all in the same block, which is what a linear BVH is built from (see LinearBVH).
+
+// Spreads the low 10 bits of v out to every third bit (bit i goes to bit 3i), so three of them can be interleaved into a Morton code.
+inline unsigned int spreadBits(unsigned int v)
+{
+	v = (v | (v << 16)) & 0x030000FF;
+	v = (v | (v << 8)) & 0x0300F00F;
+	v = (v | (v << 4)) & 0x030C30C3;
+	v = (v | (v << 2)) & 0x09249249;
+
+	return v;
+}
+
+// The 30-bit Morton code of a point with x, y and z each from 0 to 1023.
+inline unsigned int mortonCode(unsigned int x, unsigned int y, unsigned int z)
+{
+	return spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2);
+}
+
+// How many of the 1024 steps there are per unit on each axis, to cut the box from boundsMin to boundsMax into (or none, for an axis
+// everything's lined up on).
+inline glm::vec3 mortonScale(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	glm::vec3 extent = boundsMax - boundsMin;
+	glm::vec3 scale;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		scale[axis] = extent[axis] > 0.0f ? 1023.0f / extent[axis] : 0.0f;
+	}
+
+	return scale;
+}
+
+// The code of a point in the box starting at boundsMin, with scale from mortonScale. Points outside the box get the code of the nearest
+// step inside it.
+inline unsigned int mortonCode(const glm::vec3& point, const glm::vec3& boundsMin, const glm::vec3& scale)
+{
+	glm::vec3 cell = glm::clamp((point - boundsMin) * scale, glm::vec3(0.0f), glm::vec3(1023.0f));
+
+	return mortonCode((unsigned int)cell.x, (unsigned int)cell.y, (unsigned int)cell.z);
+}
+
+#endif //_MORTON_H
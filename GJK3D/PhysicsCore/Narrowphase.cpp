@@ -0,0 +1,123 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Narrowphase.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _NARROWPHASE_CPP
+#define _NARROWPHASE_CPP
+
+#include "Narrowphase.h"
+#include <algorithm>
+
+void addPairCost(std::vector<PairCost>& top, int count, const PairCost& cost)
+{
+	int cheapest = -1;
+
+	for (int i = 0; i < (int)top.size(); i++)
+	{
+		if (top[i].a == cost.a && top[i].b == cost.b)
+		{
+			if (cost.seconds > top[i].seconds)
+			{
+				top[i] = cost;
+			}
+
+			return;
+		}
+
+		if (cheapest == -1 || top[i].seconds < top[cheapest].seconds)
+		{
+			cheapest = i;
+		}
+	}
+
+	if ((int)top.size() < count)
+	{
+		top.push_back(cost);
+	}
+	else if (cheapest != -1 && cost.seconds > top[cheapest].seconds)
+	{
+		top[cheapest] = cost;
+	}
+}
+
+void sortPairCosts(std::vector<PairCost>& costs)
+{
+	std::sort(costs.begin(), costs.end(), [](const PairCost& x, const PairCost& y)
+	{
+		if (x.seconds != y.seconds)
+		{
+			return x.seconds > y.seconds;
+		}
+
+		return x.a < y.a || (x.a == y.a && x.b < y.b);
+	});
+}
+
+void mergeContacts(std::vector<std::vector<NarrowphaseContact> >& buffers, std::vector<NarrowphaseContact>& contacts)
+{
+	contacts.clear();
+
+	for (int i = 0; i < (int)buffers.size(); i++)
+	{
+		contacts.insert(contacts.end(), buffers[i].begin(), buffers[i].end());
+	}
+
+	for (int i = 0; i < (int)buffers.size(); i++)
+	{
+		buffers[i].reserve(contacts.size());
+	}
+
+	// Every pair shows up at most once, so sorting by pair gives the same order every time.
+	std::sort(contacts.begin(), contacts.end());
+}
+
+void mergeOverlaps(std::vector<std::vector<BroadphasePair> >& buffers, std::vector<BroadphasePair>& overlaps)
+{
+	overlaps.clear();
+
+	for (int i = 0; i < (int)buffers.size(); i++)
+	{
+		overlaps.insert(overlaps.end(), buffers[i].begin(), buffers[i].end());
+	}
+
+	for (int i = 0; i < (int)buffers.size(); i++)
+	{
+		buffers[i].reserve(overlaps.size());
+	}
+
+	std::sort(overlaps.begin(), overlaps.end());
+}
+
+#endif //_NARROWPHASE_CPP
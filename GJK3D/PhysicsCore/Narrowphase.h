@@ -0,0 +1,1035 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Narrowphase.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _NARROWPHASE_H
+#define _NARROWPHASE_H
+
+#include "Broadphase.h"
+#include "Clock.h"
+#include "EPA.h"
+#include "JobSystem.h"
+#include "MixedGJK.h"
+#include "PairCache.h"
+#include "Profiler.h"
+#include <algorithm>
+
+// A pair that the narrowphase found actually colliding, with EPA's answer for it. a and b are the user data of the two objects, a < b,
+// and contact.normal points from a to b. manifold is the pair's manifold in the PairCache, with this contact already added to it.
+// speculative is only ever set by PhysicsWorld, for a pair that isn't touching yet but is closing fast enough to (see
+// PhysicsWorld::SetSpeculativeContacts): its depth is minus the gap between them.
+struct NarrowphaseContact
+{
+	int a;
+	int b;
+	EPAResult contact;
+	ContactManifold* manifold;
+	bool speculative;
+
+	bool operator<(const NarrowphaseContact& other) const
+	{
+		return a < other.a || (a == other.a && b < other.b);
+	}
+};
+
+// How far two overlapping boxes are inside each other, as a contact like EPA's: along whichever axis they overlap least on, with the normal
+// pointing from a to b and the points in the middle of the overlap on the other two axes. This is all a simplified pair gets (see
+// Narrowphase::SetSimplified).
+inline EPAResult getBoxPenetration(const AABB& a, const AABB& b)
+{
+	glm::vec3 overlapMin = glm::max(a.min, b.min);
+	glm::vec3 overlapMax = glm::min(a.max, b.max);
+	glm::vec3 overlap = overlapMax - overlapMin;
+
+	int axis = 0;
+
+	if (overlap.y < overlap[axis])
+	{
+		axis = 1;
+	}
+	if (overlap.z < overlap[axis])
+	{
+		axis = 2;
+	}
+
+	EPAResult result;
+	result.depth = overlap[axis];
+	result.pointA = (overlapMin + overlapMax) * 0.5f;
+	result.pointB = result.pointA;
+
+	// Whichever way b's box is from a's along the axis, a's point is on its face on that side and b's on the face facing it.
+	if (a.min[axis] + a.max[axis] <= b.min[axis] + b.max[axis])
+	{
+		result.normal[axis] = 1.0f;
+		result.pointA[axis] = overlapMax[axis];
+		result.pointB[axis] = overlapMin[axis];
+	}
+	else
+	{
+		result.normal[axis] = -1.0f;
+		result.pointA[axis] = overlapMin[axis];
+		result.pointB[axis] = overlapMax[axis];
+	}
+
+	return result;
+}
+
+// What shadow checking found (see Narrowphase::SetShadowChecks): how many pairs were tested again with the plain TestGJK, and how many of
+// those it answered differently from the narrowphase. missed is the ones the narrowphase said weren't colliding but were, and extra the ones
+// it said were but weren't. firstA and firstB are the first pair (in pair order) that disagreed, or -1 if none did, to go and look at.
+struct ShadowCheckStats
+{
+	long long checks;
+	long long disagreements;
+	long long missed;
+	long long extra;
+	int firstA;
+	int firstB;
+
+	ShadowCheckStats()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		checks = 0;
+		disagreements = 0;
+		missed = 0;
+		extra = 0;
+		firstA = -1;
+		firstB = -1;
+	}
+
+	// Adds the counts from other into these, keeping whichever first pair comes first.
+	void Add(const ShadowCheckStats& other)
+	{
+		checks += other.checks;
+		disagreements += other.disagreements;
+		missed += other.missed;
+		extra += other.extra;
+
+		if (other.firstA != -1 && (firstA == -1 || other.firstA < firstA || (other.firstA == firstA && other.firstB < firstB)))
+		{
+			firstA = other.firstA;
+			firstB = other.firstB;
+		}
+	}
+};
+
+// Whether a pair gets shadow checked in a given run. It's a hash of the pair and the run, so which pairs are picked doesn't depend on the
+// threads, and a different sample is picked every run. limit is the fraction picked, out of 2^32.
+inline bool isShadowSampled(int a, int b, unsigned int run, unsigned long long limit)
+{
+	unsigned int hash = (unsigned int)a * 0x9E3779B1u ^ (unsigned int)b * 0x85EBCA77u ^ run * 0xC2B2AE3Du;
+	hash ^= hash >> 15;
+	hash *= 0x2C1B3C6Du;
+	hash ^= hash >> 12;
+
+	return hash < limit;
+}
+
+// What one pair cost the narrowphase (see Narrowphase::SetPairCosts): how long its GJK query took, and its EPA query if it had one, and how
+// many iterations each of them ran. a and b are the pair's objects, like in NarrowphaseContact, and the rest says what their shapes are
+// (see getShapeType and getShapePoints), since a pair is usually expensive because of the content it's made of.
+struct PairCost
+{
+	int a;
+	int b;
+	double seconds;
+	int gjkIterations;
+	int epaIterations;
+	ShapeType typeA;
+	ShapeType typeB;
+	int pointsA;
+	int pointsB;
+};
+
+// Adds cost to top, which keeps the count most expensive pairs (in no particular order). If the pair is in there already it keeps whichever
+// of the two cost more, so a pair that's expensive every step only takes up one place.
+void addPairCost(std::vector<PairCost>& top, int count, const PairCost& cost);
+
+// Sorts a list of pair costs with the most expensive first (and by pair after that, so ties come out the same every time).
+void sortPairCosts(std::vector<PairCost>& costs);
+
+// Puts the per-thread contact buffers together into contacts, sorted by pair. Then it makes room in every buffer for all of them, since
+// which thread gets which pairs next time is down to scheduling, and this way none of them has to grow unless the total does.
+void mergeContacts(std::vector<std::vector<NarrowphaseContact> >& buffers, std::vector<NarrowphaseContact>& contacts);
+
+// The same for the per-thread buffers of overlapping trigger pairs.
+void mergeOverlaps(std::vector<std::vector<BroadphasePair> >& buffers, std::vector<BroadphasePair>& overlaps);
+
+template<typename Shape>
+class Narrowphase;
+
+// How many pairs each job hands to GJK at once.
+static const int NARROWPHASE_BATCH = 32;
+
+// How many pairs ahead a job starts loading the shapes, bounds and state of.
+static const int NARROWPHASE_PREFETCH = 4;
+
+// The work each job does over its range of pairs.
+template<typename Shape>
+struct NarrowphaseTask
+{
+	Narrowphase<Shape>* narrowphase;
+
+	void operator()(int begin, int end, int thread);
+};
+
+// The job that starts the narrowphase off once the pairs are ready. It makes room in the PairCache, and then submits the lookups and the
+// job that adds the pairs they missed.
+template<typename Shape>
+struct NarrowphasePrepare
+{
+	Narrowphase<Shape>* narrowphase;
+
+	void operator()(int begin, int end, int thread);
+};
+
+// Looks up the states of a range of pairs that are already in the PairCache, leaving nullptr for the ones that aren't.
+template<typename Shape>
+struct NarrowphaseLookup
+{
+	Narrowphase<Shape>* narrowphase;
+
+	void operator()(int begin, int end, int thread);
+};
+
+// Once the lookups are done, adds the pairs they missed to the PairCache, one after another, and then submits the tasks as its own
+// children, so the narrowphase's counter covers all of them.
+template<typename Shape>
+struct NarrowphaseAdd
+{
+	Narrowphase<Shape>* narrowphase;
+
+	void operator()(int begin, int end, int thread);
+};
+
+// How many pairs each lookup job handles. A lookup is a lot less work than a test, so they're handed out in bigger ranges.
+static const int NARROWPHASE_LOOKUP_GRAIN = 256;
+
+// How much is taken off a separated pair's gap before it's counted down, so a pair that's only just apart is tested the usual way (where
+// GJK may well call it touching) rather than being skipped on the strength of a gap that's mostly rounding error.
+static const float NARROWPHASE_SEPARATION_MARGIN = 0.001f;
+
+// Runs GJK (and EPA for the pairs that collide) over the pairs from the broadphase, spread across the threads of a JobSystem.
+// - Each job has its own solvers (they're on the stack of the job), so nothing about a query is shared.
+// - Each pair's cache and manifold belong to that pair alone, and are looked up before the tests start, so the tests never touch the PairCache
+//   itself. The pairs it already has are looked up across the threads (see PairCache::Lookup), and then the new ones are added in one
+//   job, since adding to it isn't safe from several threads at once.
+// - Each thread writes its contacts into its own buffer. Afterward the buffers are merged and sorted by pair, so the contacts come out in
+//   the same order no matter how the pairs happened to be split between threads, and the simulation stays deterministic.
+// It is a template on the shape type so the support functions still get inlined into the tests.
+template<typename Shape>
+class Narrowphase
+{
+	friend struct NarrowphaseTask<Shape>;
+	friend struct NarrowphasePrepare<Shape>;
+	friend struct NarrowphaseLookup<Shape>;
+	friend struct NarrowphaseAdd<Shape>;
+
+	JobSystem* jobs;
+
+	std::vector<std::vector<NarrowphaseContact> > buffers;
+	std::vector<PairState*> states;
+
+	// Whether each object is a trigger (or nullptr, if none are), and each thread's buffer of the trigger pairs it found overlapping.
+	const std::vector<unsigned char>* triggers;
+	std::vector<std::vector<BroadphasePair> > overlapBuffers;
+
+	// Whether each object is simplified (or nullptr, if none are).
+	const std::vector<unsigned char>* simplified;
+
+	// Each object's hull in its own space, or one with no points for an object without one (or nullptr, if none have one), and somewhere for
+	// each thread to put the two hulls of a pair in world space while it tests them (two per thread).
+	const std::vector<HullShape>* hulls;
+	std::vector<std::vector<glm::vec3> > hullPoints;
+
+	// How many pairs each thread tested again with their hulls in the last run, and how many of those turned out not to be touching.
+	std::vector<int> threadRefined;
+	std::vector<int> threadRefinedMisses;
+
+	// Whether to count how every GJK query goes, and the counts, one set per thread like the contact buffers.
+	bool recordStats;
+	std::vector<GJKStats> threadStats;
+
+	// What precision GJK runs in (see MixedGJKSolver).
+	GJKPrecision precision;
+
+	// The fraction of the pairs that get shadow checked, the same out of 2^32 for the tasks, and what each thread's checks found.
+	float shadowFraction;
+	unsigned long long shadowLimit;
+	std::vector<ShadowCheckStats> threadShadowStats;
+
+	// How many of the most expensive pairs each thread keeps (or 0 to not time the pairs at all), and the ones it kept in the last run.
+	int costCount;
+	std::vector<std::vector<PairCost> > threadCosts;
+
+	// How far each object could have moved since the last run, by user data (or nullptr, if pairs aren't to be skipped), and how many pairs
+	// each thread skipped in the last run.
+	const std::vector<float>* motion;
+	std::vector<int> threadSkipped;
+
+	// How many runs there have been. The shadow checks pick a new sample with it each time, and a pair's separation is only any good if it
+	// was counted down in the run before.
+	unsigned int run;
+
+	// How many pairs each job handles. Small enough to keep every thread busy, big enough that handing out jobs isn't most of the work.
+	int grainSize;
+
+	// What the current run is working on.
+	const std::vector<BroadphasePair>* pairs;
+	const std::vector<Shape>* shapes;
+	const std::vector<ShapeBounds>* bounds;
+	const std::vector<const glm::mat4*>* transforms;
+	PairCache* pairCache;
+	JobCounter* counter;
+
+	// Counts the lookup jobs, which NarrowphaseAdd waits on.
+	JobCounter lookupsDone;
+
+	NarrowphaseTask<Shape> task;
+	NarrowphasePrepare<Shape> prepare;
+	NarrowphaseLookup<Shape> lookup;
+	NarrowphaseAdd<Shape> add;
+
+public:
+	Narrowphase(JobSystem* inJobs)
+	{
+		jobs = inJobs;
+		grainSize = 32;
+		recordStats = false;
+		precision = GJK_PRECISION_FLOAT;
+		shadowFraction = 0.0f;
+		shadowLimit = 0;
+		costCount = 0;
+		motion = nullptr;
+		run = 0;
+		triggers = nullptr;
+		simplified = nullptr;
+		hulls = nullptr;
+
+		task.narrowphase = this;
+		prepare.narrowphase = this;
+		lookup.narrowphase = this;
+		add.narrowphase = this;
+	}
+
+	void SetGrainSize(int size)
+	{
+		grainSize = size;
+	}
+	int GetGrainSize() const
+	{
+		return grainSize;
+	}
+
+	// Makes room for numPairs pairs and numContacts contacts, so a run with no more than that never grows anything. Any one thread could
+	// end up with every contact, so each thread's buffer gets room for them all.
+	void Reserve(int numPairs, int numContacts)
+	{
+		int threads = jobs->GetThreadCount();
+
+		buffers.resize(threads);
+		overlapBuffers.resize(threads);
+
+		for (int i = 0; i < threads; i++)
+		{
+			buffers[i].reserve(numContacts);
+			overlapBuffers[i].reserve(numPairs);
+		}
+
+		states.reserve(numPairs);
+		threadSkipped.reserve(threads);
+		threadRefined.reserve(threads);
+		threadRefinedMisses.reserve(threads);
+		threadStats.reserve(threads);
+		threadShadowStats.reserve(threads);
+		threadCosts.reserve(threads);
+	}
+
+	// Turns the GJK stats (see GJKStats) on or off, starting from the next run. They're off by default, since they cost a little on every query.
+	void SetStatsEnabled(bool enabled)
+	{
+		recordStats = enabled;
+	}
+	bool IsStatsEnabled() const
+	{
+		return recordStats;
+	}
+
+	// Sets the precision GJK runs in, starting from the next run. Float uses the batched tests, and the others go one pair at a time through a
+	// MixedGJKSolver, which is only worth it when the objects are far enough from the origin for float to start getting answers wrong.
+	void SetPrecision(GJKPrecision inPrecision)
+	{
+		precision = inPrecision;
+	}
+	GJKPrecision GetPrecision() const
+	{
+		return precision;
+	}
+
+	// Shadow checking, for making sure the fast paths (the batched and SIMD tests, the warm start from each pair's cache, mixed precision)
+	// still give the right answers: a fraction of the pairs that go through GJK, picked at random each run, are tested again from scratch
+	// with the plain TestGJK, with no cache, and any answer that's different is counted (see ShadowCheckStats). A pair that's only just
+	// touching can come out either way, so a few disagreements in a big scene aren't a bug, but more than a few are. It's off (0) by default,
+	// and costs about that fraction of a GJK query per pair on top of the usual work. Takes effect from the next run.
+	void SetShadowChecks(float fraction)
+	{
+		shadowFraction = fraction < 0.0f ? 0.0f : fraction > 1.0f ? 1.0f : fraction;
+	}
+	float GetShadowChecks() const
+	{
+		return shadowFraction;
+	}
+
+	// Times every pair that goes through GJK (and EPA, if it gets that far), and keeps the count most expensive of them each run (see
+	// PairCost), starting from the next run. Timing a pair means testing it on its own, so the box pairs lose the batch's SIMD first support
+	// point (see GJKSolver::TestGJKBatch) and the clock gets read twice a pair, which all makes the run slower. The answers are still the
+	// same. It's off (0) by default.
+	void SetPairCosts(int count)
+	{
+		costCount = count > 0 ? count : 0;
+	}
+	int GetPairCosts() const
+	{
+		return costCount;
+	}
+
+	// Which objects are triggers, by user data, from the next run on (see PhysicsWorld::SetTrigger). A pair with a trigger in it only needs
+	// to know whether it overlaps, so it stops at GJK: no EPA, no manifold and no contact, just the pair in the overlaps Finish gives back.
+	// The vector is only read during runs, so it can keep growing as objects are added. Pass nullptr if there are no triggers.
+	void SetTriggers(const std::vector<unsigned char>* inTriggers)
+	{
+		triggers = inTriggers;
+	}
+
+	// How far each object could have moved since the last run, by user data, from the next run on. Any point of either object's shape can't
+	// have moved further than this (it's a bound on how far it went, not how fast it was going), so a pair that was this far apart, plus the
+	// two objects' motion over the runs since, can't be touching yet. With this set, a pair that GJK finds separated also gets the gap
+	// between the shapes along the axis that separated them measured, and then skips the test altogether until its objects have moved far
+	// enough, in total, to close it. The gap is never more than the distance between them, so it's safe to count down, and it only takes
+	// two more support calls. (A full distance query, see GJKDistanceSolver, would let a pair skip a few more runs, but costs more than GJK
+	// from the cached axis does in the first place.) A pair can only be skipped if it was in the run before, since it's only counted down
+	// while it's in a run, so the world has to make sure the motion covers everything that happened in between, moving objects by hand
+	// included. Pass nullptr to test every pair every run.
+	void SetMotion(const std::vector<float>* inMotion)
+	{
+		motion = inMotion;
+	}
+
+	// Which objects are simplified, by user data, from the next run on. A pair of simplified objects is tested as the two boxes around them
+	// (see getBoxPenetration), with no GJK or EPA at all, which is as much as PhysicsWorld's level of detail gives the objects nobody is
+	// close enough to see (see PhysicsWorld::SetLevelOfDetail). A pair with only one simplified object is tested as usual. Like the
+	// triggers, the vector is only read during runs. Pass nullptr if there are none.
+	void SetSimplified(const std::vector<unsigned char>* inSimplified)
+	{
+		simplified = inSimplified;
+	}
+
+	// Each object's hull, by user data, from the next run on, for the pairs where the shapes themselves are only a cheap stand-in for it (like
+	// an OBB around a model). A pair whose shapes collide, with a hull on either side, is tested again with the hull instead of the shape
+	// for that side, and only counts as colliding if that hits too. Its contact then comes from EPA on the hulls. A pair whose shapes miss
+	// never gets that far, which is most of them, so the hulls only cost anything where it matters.
+	// The hulls' points are in the same space as the object's transform takes to the world (see Submit), and every one has to be inside
+	// its object's shape, or the shapes could miss where the hulls would have hit. An object without a hull has a HullShape with no points.
+	// Simplified pairs stay boxes. Like the triggers, the vector is only read during runs. Pass nullptr if no object has a hull.
+	void SetHulls(const std::vector<HullShape>* inHulls)
+	{
+		hulls = inHulls;
+	}
+
+	// Once a run is finished, adds how its GJK queries went into stats. (Nothing gets added if the stats are off.)
+	void AddStats(GJKStats& stats) const
+	{
+		for (int i = 0; i < (int)threadStats.size(); i++)
+		{
+			stats.Add(threadStats[i]);
+		}
+	}
+
+	// Once a run is finished, adds its most expensive pairs to top, which keeps the count most expensive of them (see addPairCost). (Nothing
+	// gets added if the pairs weren't being timed.)
+	void AddPairCosts(std::vector<PairCost>& top, int count) const
+	{
+		for (int i = 0; i < (int)threadCosts.size(); i++)
+		{
+			for (int j = 0; j < (int)threadCosts[i].size(); j++)
+			{
+				addPairCost(top, count, threadCosts[i][j]);
+			}
+		}
+	}
+
+	// How many pairs the last run skipped, since they were still too far apart to touch (see SetMotion).
+	int GetSkipped() const
+	{
+		int skipped = 0;
+
+		for (int i = 0; i < (int)threadSkipped.size(); i++)
+		{
+			skipped += threadSkipped[i];
+		}
+
+		return skipped;
+	}
+
+	// How many pairs the last run tested again with their hulls, and how many of those it threw out, since their hulls weren't touching
+	// after all (see SetHulls).
+	int GetRefined() const
+	{
+		int refined = 0;
+
+		for (int i = 0; i < (int)threadRefined.size(); i++)
+		{
+			refined += threadRefined[i];
+		}
+
+		return refined;
+	}
+	int GetRefinedMisses() const
+	{
+		int misses = 0;
+
+		for (int i = 0; i < (int)threadRefinedMisses.size(); i++)
+		{
+			misses += threadRefinedMisses[i];
+		}
+
+		return misses;
+	}
+
+	// The same for what its shadow checks found. (Nothing gets added if they're off.)
+	void AddShadowStats(ShadowCheckStats& stats) const
+	{
+		for (int i = 0; i < (int)threadShadowStats.size(); i++)
+		{
+			stats.Add(threadShadowStats[i]);
+		}
+	}
+
+	// Submits the tests for every pair to the job system, without waiting. shapes, bounds and transforms are indexed by the user data in the
+	// pairs, and (like the pairs themselves) only have to be filled in by the time dependency is done. A pair whose bounds don't overlap is
+	// thrown out without running GJK. A colliding pair has its manifold updated and a contact saved for Finish.
+	void Submit(const std::vector<BroadphasePair>& inPairs, const std::vector<Shape>& inShapes, const std::vector<ShapeBounds>& inBounds,
+		const std::vector<const glm::mat4*>& inTransforms, PairCache& inPairCache, JobCounter& inCounter, JobCounter* dependency = nullptr)
+	{
+		pairs = &inPairs;
+		shapes = &inShapes;
+		bounds = &inBounds;
+		transforms = &inTransforms;
+		pairCache = &inPairCache;
+		counter = &inCounter;
+
+		jobs->SubmitSingle(prepare, inCounter, dependency);
+	}
+
+	// Once the counter given to Submit is done, puts the contacts from every thread together into contacts, in pair order.
+	void Finish(std::vector<NarrowphaseContact>& contacts)
+	{
+		mergeContacts(buffers, contacts);
+	}
+
+	// The same, and puts the trigger pairs that were overlapping into overlaps, in pair order too.
+	void Finish(std::vector<NarrowphaseContact>& contacts, std::vector<BroadphasePair>& overlaps)
+	{
+		mergeContacts(buffers, contacts);
+		mergeOverlaps(overlapBuffers, overlaps);
+	}
+
+	// Submits, waits and finishes, all in one go.
+	void Run(const std::vector<BroadphasePair>& inPairs, const std::vector<Shape>& inShapes, const std::vector<ShapeBounds>& inBounds,
+		const std::vector<const glm::mat4*>& inTransforms, PairCache& inPairCache, std::vector<NarrowphaseContact>& contacts)
+	{
+		JobCounter done;
+
+		Submit(inPairs, inShapes, inBounds, inTransforms, inPairCache, done);
+		jobs->Wait(done);
+
+		Finish(contacts);
+	}
+
+private:
+	// The shape to test an object as once its shape has hit something: its hull in world space (put in points), or its shape if it has no
+	// hull.
+	ConvexShape getExactShape(int object, const Shape& shape, std::vector<glm::vec3>& points) const
+	{
+		const HullShape& hull = (*hulls)[object];
+
+		if (hull.numPoints == 0)
+		{
+			return ConvexShape(shape);
+		}
+
+		const glm::mat4& transform = *(*transforms)[object];
+
+		points.resize(hull.numPoints);
+
+		for (int i = 0; i < hull.numPoints; i++)
+		{
+			points[i] = glm::vec3(transform * glm::vec4(hull.points[i], 1.0f));
+		}
+
+		return ConvexShape(HullShape(points.data(), hull.numPoints));
+	}
+};
+
+template<typename Shape>
+void NarrowphasePrepare<Shape>::operator()(int begin, int end, int thread)
+{
+	Narrowphase<Shape>& n = *narrowphase;
+
+	n.buffers.resize(n.jobs->GetThreadCount());
+
+	n.overlapBuffers.resize(n.jobs->GetThreadCount());
+	n.threadSkipped.assign(n.jobs->GetThreadCount(), 0);
+	n.threadRefined.assign(n.jobs->GetThreadCount(), 0);
+	n.threadRefinedMisses.assign(n.jobs->GetThreadCount(), 0);
+	n.hullPoints.resize(n.jobs->GetThreadCount() * 2);
+
+	for (int i = 0; i < (int)n.buffers.size(); i++)
+	{
+		n.buffers[i].clear();
+		n.overlapBuffers[i].clear();
+	}
+
+	n.threadStats.resize(n.recordStats ? n.jobs->GetThreadCount() : 0);
+
+	for (int i = 0; i < (int)n.threadStats.size(); i++)
+	{
+		n.threadStats[i].Reset();
+	}
+
+	// Working the fraction out here means the tasks see the same one all run, even if it's changed partway through.
+	n.shadowLimit = (unsigned long long)((double)n.shadowFraction * 4294967296.0);
+	n.run++;
+	n.threadShadowStats.resize(n.shadowLimit > 0 ? n.jobs->GetThreadCount() : 0);
+
+	for (int i = 0; i < (int)n.threadShadowStats.size(); i++)
+	{
+		n.threadShadowStats[i].Reset();
+	}
+
+	n.threadCosts.resize(n.costCount > 0 ? n.jobs->GetThreadCount() : 0);
+
+	for (int i = 0; i < (int)n.threadCosts.size(); i++)
+	{
+		n.threadCosts[i].clear();
+		n.threadCosts[i].reserve(n.costCount);
+	}
+
+	// Look up (or create) every pair's state before any test runs. Adding a pair to the cache could move the states already looked up, so
+	// first there has to be room for all of them. The add job is one of the narrowphase's own, so the counter can't finish before it does.
+	n.states.resize(n.pairs->size());
+	n.pairCache->Reserve((int)n.pairs->size());
+
+	n.jobs->SubmitFor((int)n.pairs->size(), NARROWPHASE_LOOKUP_GRAIN, n.lookup, n.lookupsDone);
+	n.jobs->SubmitSingle(n.add, *n.counter, &n.lookupsDone);
+}
+
+template<typename Shape>
+void NarrowphaseLookup<Shape>::operator()(int begin, int end, int thread)
+{
+	Narrowphase<Shape>& n = *narrowphase;
+
+	for (int i = begin; i < end; i++)
+	{
+		n.states[i] = n.pairCache->Lookup((*n.pairs)[i].a, (*n.pairs)[i].b);
+	}
+}
+
+template<typename Shape>
+void NarrowphaseAdd<Shape>::operator()(int begin, int end, int thread)
+{
+	Narrowphase<Shape>& n = *narrowphase;
+
+	// Going through the pairs in order means the new ones go into the cache in the same order however the lookups were split up.
+	for (int i = 0; i < (int)n.pairs->size(); i++)
+	{
+		if (n.states[i] == nullptr)
+		{
+			n.states[i] = &n.pairCache->FindState((*n.pairs)[i].a, (*n.pairs)[i].b);
+		}
+	}
+
+	n.jobs->SubmitFor((int)n.pairs->size(), n.grainSize, n.task, *n.counter);
+}
+
+template<typename Shape>
+void NarrowphaseTask<Shape>::operator()(int begin, int end, int thread)
+{
+	Narrowphase<Shape>& n = *narrowphase;
+
+	GJK_PROFILE_ZONE("narrowphase");
+
+	// One set of solvers per job, reused for every pair in its range.
+	GJKSolver gjk;
+	MixedGJKSolver mixed(n.precision);
+	EPASolver epa;
+
+	// What the job's queries did, added up here and handed to the profiler (and the thread's stats) once at the end.
+	GJKStats stats;
+	gjk.SetStats(&stats);
+	mixed.SetStats(&stats);
+
+	long long penetrations = 0;
+	long long rejected = 0;
+	long long boxes = 0;
+	long long skipped = 0;
+	long long measured = 0;
+	long long refined = 0;
+	long long refinedMisses = 0;
+
+	// The pair being tested with its hulls (see SetHulls), and the simplex that test left for EPA.
+	ConvexShape exactA;
+	ConvexShape exactB;
+	Simplex exactSimplex;
+
+	// What the job's shadow checks found, and the solver they use, which has nothing to do with the others (and no stats, so they only count
+	// the real queries).
+	ShadowCheckStats shadow;
+	GJKSolver reference;
+
+	// What each pair in the batch cost, if they're being timed.
+	SteadyClock clock;
+	double seconds[NARROWPHASE_BATCH];
+	int gjkIterations[NARROWPHASE_BATCH];
+	int epaIterations[NARROWPHASE_BATCH];
+
+	// The pairs go through GJK a batch at a time (see GJKSolver::TestGJKBatch), and then the ones that collide go on to EPA. Only the pairs
+	// whose bounds overlap make it into a batch, so indices remembers which pair each one is.
+	const Shape* shapesA[NARROWPHASE_BATCH];
+	const Shape* shapesB[NARROWPHASE_BATCH];
+	GJKCache* caches[NARROWPHASE_BATCH];
+	int indices[NARROWPHASE_BATCH];
+	unsigned char colliding[NARROWPHASE_BATCH];
+	Simplex simplices[NARROWPHASE_BATCH];
+
+	for (int next = begin; next < end;)
+	{
+		int count = 0;
+
+		for (; next < end && count < NARROWPHASE_BATCH; next++)
+		{
+			const BroadphasePair& pair = (*n.pairs)[next];
+
+			// The pairs are sorted (see SortPairs), so a is usually the object the last pair had and is still in cache. b is the one that
+			// jumps around, so that's the one to load ahead.
+			if (next + NARROWPHASE_PREFETCH < end)
+			{
+				const BroadphasePair& ahead = (*n.pairs)[next + NARROWPHASE_PREFETCH];
+
+				GJK_PREFETCH(&(*n.shapes)[ahead.b]);
+				GJK_PREFETCH(&(*n.bounds)[ahead.b]);
+				GJK_PREFETCH(n.states[next + NARROWPHASE_PREFETCH]);
+			}
+
+			// Count the pair's separation down by how far its objects could have moved since the last run, and if there's still some left,
+			// it can't be touching: no need to test it at all.
+			if (n.motion != nullptr && n.states[next]->separationRun + 1 == n.run)
+			{
+				PairState& state = *n.states[next];
+				state.separation -= (*n.motion)[pair.a] + (*n.motion)[pair.b];
+				state.separationRun = n.run;
+
+				if (state.separation > 0.0f)
+				{
+					state.manifold.Update(*(*n.transforms)[pair.a], *(*n.transforms)[pair.b]);
+					skipped++;
+
+					// A skipped pair is still fair game for the shadow checks, since it's the skipping they're checking.
+					if (n.shadowLimit > 0 && isShadowSampled(pair.a, pair.b, n.run, n.shadowLimit))
+					{
+						shadow.checks++;
+
+						if (reference.TestGJK((*n.shapes)[pair.a], (*n.shapes)[pair.b]))
+						{
+							shadow.disagreements++;
+							shadow.missed++;
+
+							if (shadow.firstA == -1)
+							{
+								shadow.firstA = pair.a;
+								shadow.firstB = pair.b;
+							}
+						}
+					}
+
+					continue;
+				}
+			}
+
+			if (!(*n.bounds)[pair.a].Overlaps((*n.bounds)[pair.b]))
+			{
+				// The pair can't be touching, but any contacts it had from before still have to be dropped as it comes apart.
+				n.states[next]->manifold.Update(*(*n.transforms)[pair.a], *(*n.transforms)[pair.b]);
+				rejected++;
+
+				continue;
+			}
+
+			// A simplified pair's boxes already overlap, so that's its contact (or, with a trigger in it, its overlap) straight away.
+			if (n.simplified != nullptr && (*n.simplified)[pair.a] && (*n.simplified)[pair.b])
+			{
+				boxes++;
+
+				if (n.triggers != nullptr && ((*n.triggers)[pair.a] || (*n.triggers)[pair.b]))
+				{
+					n.overlapBuffers[thread].push_back(pair);
+
+					continue;
+				}
+
+				const glm::mat4& transformA = *(*n.transforms)[pair.a];
+				const glm::mat4& transformB = *(*n.transforms)[pair.b];
+
+				n.states[next]->manifold.Update(transformA, transformB);
+
+				NarrowphaseContact contact;
+				contact.a = pair.a;
+				contact.b = pair.b;
+				contact.contact = getBoxPenetration((*n.bounds)[pair.a].box, (*n.bounds)[pair.b].box);
+				contact.manifold = &n.states[next]->manifold;
+				contact.speculative = false;
+
+				n.states[next]->manifold.Add(contact.contact, transformA, transformB);
+
+				n.buffers[thread].push_back(contact);
+
+				continue;
+			}
+
+			// The pair's cache stores its axis from the smaller id to the larger, which is the order the pairs come in.
+			shapesA[count] = &(*n.shapes)[pair.a];
+			shapesB[count] = &(*n.shapes)[pair.b];
+			caches[count] = &n.states[next]->cache;
+			indices[count] = next;
+			count++;
+		}
+
+		if (n.costCount > 0)
+		{
+			// One at a time, so each pair's time is its own. (With float precision the mixed solver is just the float one.)
+			for (int j = 0; j < count; j++)
+			{
+				double start = clock.Now();
+
+				colliding[j] = mixed.TestGJK(*shapesA[j], *shapesB[j], caches[j]) ? 1 : 0;
+				simplices[j] = mixed.GetSimplex();
+
+				seconds[j] = clock.Now() - start;
+				gjkIterations[j] = mixed.GetIterations();
+				epaIterations[j] = 0;
+			}
+		}
+		else if (n.precision == GJK_PRECISION_FLOAT)
+		{
+			gjk.TestGJKBatch(shapesA, shapesB, count, colliding, caches, simplices);
+		}
+		else
+		{
+			mixed.TestGJKBatch(shapesA, shapesB, count, colliding, caches, simplices);
+		}
+
+		for (int j = 0; j < count; j++)
+		{
+			int a = (*n.pairs)[indices[j]].a;
+			int b = (*n.pairs)[indices[j]].b;
+			PairState& state = *n.states[indices[j]];
+
+			if (n.shadowLimit > 0 && isShadowSampled(a, b, n.run, n.shadowLimit))
+			{
+				bool expected = reference.TestGJK(*shapesA[j], *shapesB[j]);
+
+				shadow.checks++;
+
+				if (expected != (colliding[j] != 0))
+				{
+					shadow.disagreements++;
+					(expected ? shadow.missed : shadow.extra)++;
+
+					// The pairs come in order, so the job's first disagreement is its lowest pair.
+					if (shadow.firstA == -1)
+					{
+						shadow.firstA = a;
+						shadow.firstB = b;
+					}
+				}
+			}
+
+			// Shapes that hit are only a maybe for a pair with a hull in it, so test it again with the hulls, which decide.
+			bool exact = false;
+
+			if (colliding[j] && n.hulls != nullptr && ((*n.hulls)[a].numPoints != 0 || (*n.hulls)[b].numPoints != 0))
+			{
+				exactA = n.getExactShape(a, *shapesA[j], n.hullPoints[thread * 2]);
+				exactB = n.getExactShape(b, *shapesB[j], n.hullPoints[thread * 2 + 1]);
+				exact = true;
+				refined++;
+
+				if (mixed.TestGJK(exactA, exactB))
+				{
+					exactSimplex = mixed.GetSimplex();
+				}
+				else
+				{
+					colliding[j] = 0;
+					refinedMisses++;
+				}
+			}
+
+			// A trigger's pairs never have any contacts, so all there is to do is say whether they overlap.
+			if (n.triggers != nullptr && ((*n.triggers)[a] || (*n.triggers)[b]))
+			{
+				if (colliding[j])
+				{
+					n.overlapBuffers[thread].push_back(BroadphasePair(a, b));
+				}
+
+				continue;
+			}
+
+			const glm::mat4& transformA = *(*n.transforms)[a];
+			const glm::mat4& transformB = *(*n.transforms)[b];
+
+			// Move the contacts we already know about along with the objects, dropping any that have come apart.
+			state.manifold.Update(transformA, transformB);
+
+			if (!colliding[j])
+			{
+				// (A pair whose hulls missed still has shapes that hit, so there's no gap between them to measure.)
+				if (exact)
+				{
+					continue;
+				}
+
+				// Measure the gap along the axis GJK just found separating them (which it left in the cache), so the pair can be skipped
+				// until its objects could have closed it. The farthest point of the Minkowski Difference along the axis is how far short of
+				// the origin it stops.
+				if (n.motion != nullptr)
+				{
+					float length = glm::length(state.cache.dir);
+					float gap = 0.0f;
+
+					if (length > 0.0f)
+					{
+						gap = -glm::dot(Support(*shapesA[j], *shapesB[j], state.cache.dir), state.cache.dir) / length;
+					}
+
+					state.separation = gap - NARROWPHASE_SEPARATION_MARGIN;
+					state.separationRun = n.run;
+					measured++;
+				}
+
+				continue;
+			}
+
+			NarrowphaseContact contact;
+			contact.a = a;
+			contact.b = b;
+			contact.manifold = &state.manifold;
+			contact.speculative = false;
+
+			penetrations++;
+
+			double start = n.costCount > 0 ? clock.Now() : 0.0;
+			bool found = exact ? epa.Penetration(exactA, exactB, exactSimplex, contact.contact) :
+				epa.Penetration(*shapesA[j], *shapesB[j], simplices[j], contact.contact);
+
+			if (n.costCount > 0)
+			{
+				seconds[j] += clock.Now() - start;
+				epaIterations[j] = contact.contact.iterations;
+			}
+
+			if (!found)
+			{
+				continue;
+			}
+
+			state.manifold.Add(contact.contact, transformA, transformB);
+
+			n.buffers[thread].push_back(contact);
+		}
+
+		for (int j = 0; j < count && n.costCount > 0; j++)
+		{
+			PairCost cost;
+			cost.a = (*n.pairs)[indices[j]].a;
+			cost.b = (*n.pairs)[indices[j]].b;
+			cost.seconds = seconds[j];
+			cost.gjkIterations = gjkIterations[j];
+			cost.epaIterations = epaIterations[j];
+			cost.typeA = getShapeType(*shapesA[j]);
+			cost.typeB = getShapeType(*shapesB[j]);
+			cost.pointsA = getShapePoints(*shapesA[j]);
+			cost.pointsB = getShapePoints(*shapesB[j]);
+
+			addPairCost(n.threadCosts[thread], n.costCount, cost);
+		}
+	}
+
+	if (n.recordStats)
+	{
+		n.threadStats[thread].Add(stats);
+	}
+
+	n.threadSkipped[thread] += (int)skipped;
+	n.threadRefined[thread] += (int)refined;
+	n.threadRefinedMisses[thread] += (int)refinedMisses;
+
+	if (n.shadowLimit > 0)
+	{
+		n.threadShadowStats[thread].Add(shadow);
+
+		GJK_PROFILE_COUNT("shadow checks", shadow.checks);
+		GJK_PROFILE_COUNT("shadow disagreements", shadow.disagreements);
+	}
+
+	GJK_PROFILE_COUNT("gjk queries", end - begin - rejected - boxes - skipped);
+	GJK_PROFILE_COUNT("motion skipped", skipped);
+	GJK_PROFILE_COUNT("gaps measured", measured);
+	GJK_PROFILE_COUNT("bounds rejected", rejected);
+	GJK_PROFILE_COUNT("simplified pairs", boxes);
+	GJK_PROFILE_COUNT("hull refinements", refined);
+	GJK_PROFILE_COUNT("hull refinement misses", refinedMisses);
+	GJK_PROFILE_COUNT("gjk iterations", stats.iterations);
+	GJK_PROFILE_COUNT("gjk support calls", stats.supportCalls);
+	GJK_PROFILE_COUNT("gjk double queries", stats.doubleQueries);
+	GJK_PROFILE_COUNT("epa queries", penetrations);
+}
+
+#endif //_NARROWPHASE_H
@@ -0,0 +1,381 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PairCache.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PAIR_CACHE_H
+#define _PAIR_CACHE_H
+
+#include "GJK.h"
+#include "ContactManifold.h"
+#include "MemoryTracker.h"
+#include <vector>
+
+// Everything we remember about one pair of objects from step to step.
+struct PairState
+{
+	GJKCache cache;
+	ContactManifold manifold;
+
+	// Where the last hill-climbing support search on each object ended (see HillClimbHullShape), for pairs of hull shapes. A is the object
+	// with the smaller id, like the cache and the manifold.
+	int lastVertexA;
+	int lastVertexB;
+
+	// How far apart the pair is known to be, at least, and which narrowphase run that was as of. Each run the pair is in takes off how far
+	// the two objects could have moved, and the pair doesn't need testing until it's used up (see Narrowphase::SetMotion).
+	float separation;
+	unsigned int separationRun;
+
+	PairState()
+	{
+		lastVertexA = 0;
+		lastVertexB = 0;
+		separation = 0.0f;
+		separationRun = 0;
+	}
+};
+
+// Keeps a GJKCache (and a ContactManifold) for every pair of objects that has been tested, looked up by the two objects' ids.
+// Most pairs that were separated last step are still separated along the same axis this step. TestPair looks up that axis and GJK checks
+// it first, which costs two support calls (one per shape). Only if the axis no longer separates the pair do we fall into the full GJK loop.
+// The ids are the objects' indices in the world, which never get reused, so a pair's key means the same two objects for as long as the
+// cache holds it.
+// Every pair is stamped with the frame it was last looked up in, so that Evict can forget the ones nobody has asked about for a while,
+// whether or not anything said they were gone.
+class PairCache
+{
+	// Saves and loads the arrays straight from a file (see WorldSnapshot).
+	friend class WorldSnapshot;
+
+	// Every pair's key, state and stamp, in the order they were added, and an open addressing table (with linear probing) of where each key
+	// is in them, -1 for an empty slot. The table's size is a power of two, and it's kept at most half full.
+	// It's all flat arrays (rather than a map with a node per pair) so that copying a cache, as PhysicsWorld::SaveState does many times a
+	// frame for rollback, is four memcpys into arrays that are already big enough.
+	TrackedVector<unsigned long long, MEMORY_CONTACTS> keys;
+	TrackedVector<PairState, MEMORY_CONTACTS> states;
+	TrackedVector<unsigned int, MEMORY_CONTACTS> frames;
+	TrackedVector<int, MEMORY_CONTACTS> slots;
+
+	// The frame lookups are stamped with, moved on by NextFrame.
+	unsigned int frame;
+
+	// Builds the key for a pair. The smaller id always goes first, so (a, b) and (b, a) find the same entry.
+	static unsigned long long makeKey(unsigned int idA, unsigned int idB)
+	{
+		if (idA > idB)
+		{
+			unsigned int temp = idA;
+			idA = idB;
+			idB = temp;
+		}
+
+		return ((unsigned long long)idA << 32) | idB;
+	}
+
+	// Where a key wants to go in the table. Pairs' keys are close together, so they're scrambled first to spread them out.
+	int homeSlot(unsigned long long key) const
+	{
+		return (int)((key * 0x9E3779B97F4A7C15ull) >> 32) & ((int)slots.size() - 1);
+	}
+
+	// The slot a key is in, or the empty slot it would go in.
+	int findSlot(unsigned long long key) const
+	{
+		int mask = (int)slots.size() - 1;
+		int slot = homeSlot(key);
+
+		while (slots[slot] != -1 && keys[slots[slot]] != key)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		return slot;
+	}
+
+	// Doubles the table and puts every key back in it.
+	void grow()
+	{
+		slots.assign(slots.empty() ? 64 : slots.size() * 2, -1);
+
+		for (int i = 0; i < (int)keys.size(); i++)
+		{
+			slots[findSlot(keys[i])] = i;
+		}
+	}
+
+	// Finds a pair's state, adding an empty one if the pair hasn't been seen before.
+	PairState& findOrAdd(unsigned long long key)
+	{
+		if ((keys.size() + 1) * 2 > slots.size())
+		{
+			grow();
+		}
+
+		int slot = findSlot(key);
+
+		if (slots[slot] == -1)
+		{
+			slots[slot] = (int)keys.size();
+			keys.push_back(key);
+			states.push_back(PairState());
+			frames.push_back(frame);
+		}
+
+		frames[slots[slot]] = frame;
+		return states[slots[slot]];
+	}
+
+public:
+	PairCache()
+	{
+		frame = 0;
+	}
+
+	// Gets the cache for a pair, creating an empty one if the pair hasn't been seen before.
+	GJKCache& Find(unsigned int idA, unsigned int idB)
+	{
+		return findOrAdd(makeKey(idA, idB)).cache;
+	}
+
+	// Gets everything stored for a pair, creating it if the pair hasn't been seen before.
+	// The states are kept in one array, so adding or removing a pair can move the others: the reference is only good until then (unless
+	// Reserve has made room for the pairs being added).
+	PairState& FindState(unsigned int idA, unsigned int idB)
+	{
+		return findOrAdd(makeKey(idA, idB));
+	}
+
+	// Gets the contact manifold for a pair, creating an empty one if the pair hasn't been seen before.
+	// Like the cache, the manifold's A is the object with the smaller id.
+	ContactManifold& FindManifold(unsigned int idA, unsigned int idB)
+	{
+		return findOrAdd(makeKey(idA, idB)).manifold;
+	}
+
+	// Gets everything stored for a pair without adding it: nullptr if the pair hasn't been seen before.
+	// This doesn't change the table, only the pair's own stamp, so any number of threads can look pairs up at once, as long as no two of
+	// them look up the same pair and nothing is added or removed until they're done. (The narrowphase's jobs each look up their own
+	// range of pairs this way.)
+	PairState* Lookup(unsigned int idA, unsigned int idB)
+	{
+		if (slots.empty())
+		{
+			return nullptr;
+		}
+
+		int index = slots[findSlot(makeKey(idA, idB))];
+
+		if (index == -1)
+		{
+			return nullptr;
+		}
+
+		frames[index] = frame;
+		return &states[index];
+	}
+
+	// Forgets a pair, for example once the broadphase says the two objects are no longer close.
+	// The last pair is moved into its place, so the states stay packed.
+	void Remove(unsigned int idA, unsigned int idB);
+
+	// Starts a new frame: lookups from now on are stamped with it.
+	void NextFrame()
+	{
+		frame++;
+	}
+
+	// Forgets every pair that hasn't been looked up in the last maxAge frames (counting the current one as 0). Returns how many went.
+	// This catches the pairs that nothing says goodbye to, like a pair that stopped being tested while its objects slept, or one the
+	// broadphase reported as removed in a step that was later rolled back.
+	int Evict(unsigned int maxAge);
+
+	// Makes room for count more pairs, so that adding up to that many doesn't move the states that are already there.
+	void Reserve(int count)
+	{
+		size_t needed = states.size() + count;
+
+		// Grow by at least double, so that reserving a few more every step doesn't copy every state every step.
+		if (needed > states.capacity())
+		{
+			if (needed < states.capacity() * 2)
+			{
+				needed = states.capacity() * 2;
+			}
+
+			keys.reserve(needed);
+			states.reserve(needed);
+		}
+	}
+
+	// Makes room for count pairs in all, table and all, so the cache never grows while it holds no more than that.
+	void ReserveTotal(int count)
+	{
+		keys.reserve(count);
+		states.reserve(count);
+		frames.reserve(count);
+
+		while ((int)slots.size() < count * 2)
+		{
+			grow();
+		}
+	}
+
+	void Clear()
+	{
+		keys.clear();
+		states.clear();
+		frames.clear();
+		slots.assign(slots.size(), -1);
+	}
+
+	int Size() const
+	{
+		return (int)states.size();
+	}
+
+	// Runs GJK on a pair of shapes, starting from (and updating) the cached axis for their ids.
+	// The stored axis is the direction from the shape with the smaller id to the one with the larger id, so we always test in that order.
+	// (The collision result is the same either way, it's only the direction of the axis that would flip.)
+	template<typename ShapeA, typename ShapeB>
+	bool TestPair(GJKSolver& solver, const ShapeA& a, unsigned int idA, const ShapeB& b, unsigned int idB)
+	{
+		GJKCache& cache = Find(idA, idB);
+
+		if (idA <= idB)
+		{
+			return solver.TestGJK(a, b, &cache);
+		}
+		else
+		{
+			return solver.TestGJK(b, a, &cache);
+		}
+	}
+};
+
+inline void PairCache::Remove(unsigned int idA, unsigned int idB)
+{
+	if (slots.empty())
+	{
+		return;
+	}
+
+	int mask = (int)slots.size() - 1;
+	int slot = findSlot(makeKey(idA, idB));
+	int index = slots[slot];
+
+	if (index == -1)
+	{
+		return;
+	}
+
+	// Empty the slot, then shift back any key after it (up to the next empty slot) that's allowed to sit there, so that every key can still
+	// be found by probing from its home slot without hitting a gap.
+	slots[slot] = -1;
+
+	for (int next = (slot + 1) & mask; slots[next] != -1; next = (next + 1) & mask)
+	{
+		int home = homeSlot(keys[slots[next]]);
+
+		if (((next - home) & mask) >= ((next - slot) & mask))
+		{
+			slots[slot] = slots[next];
+			slots[next] = -1;
+			slot = next;
+		}
+	}
+
+	// Move the last pair into the hole.
+	int last = (int)states.size() - 1;
+
+	if (index != last)
+	{
+		slots[findSlot(keys[last])] = index;
+		keys[index] = keys[last];
+		states[index] = states[last];
+		frames[index] = frames[last];
+	}
+
+	keys.pop_back();
+	states.pop_back();
+	frames.pop_back();
+}
+
+inline int PairCache::Evict(unsigned int maxAge)
+{
+	// Squeeze the pairs we're keeping down to the front, in the order they were in, so that the cache ends up the same whichever thread
+	// count or timing got it here.
+	int kept = 0;
+
+	for (int i = 0; i < (int)keys.size(); i++)
+	{
+		// Unsigned, so this is still right once the frame count wraps around.
+		if (frame - frames[i] > maxAge)
+		{
+			continue;
+		}
+
+		if (kept != i)
+		{
+			keys[kept] = keys[i];
+			states[kept] = states[i];
+			frames[kept] = frames[i];
+		}
+
+		kept++;
+	}
+
+	int evicted = (int)keys.size() - kept;
+
+	if (evicted == 0)
+	{
+		return 0;
+	}
+
+	keys.resize(kept);
+	states.resize(kept);
+	frames.resize(kept);
+
+	// The pairs have moved, so the table is built again from scratch (at the size it already is).
+	slots.assign(slots.size(), -1);
+
+	for (int i = 0; i < kept; i++)
+	{
+		slots[findSlot(keys[i])] = i;
+	}
+
+	return evicted;
+}
+
+#endif //_PAIR_CACHE_H
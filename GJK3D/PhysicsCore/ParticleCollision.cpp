@@ -0,0 +1,330 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ParticleCollision.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _PARTICLE_COLLISION_CPP
+#define _PARTICLE_COLLISION_CPP
+
+#include "ParticleCollision.h"
+#include "ShapePairs.h"
+#include <cfloat>
+#include <cmath>
+
+// Runs check on every group of particles, which returns a bit for each particle in the group that might be touching, and then exact on each
+// of those. The spare slots past the last particle are left out of the last group's bits.
+template<typename Check, typename Exact>
+static void forEachGroup(const ParticleBuffer& particles, Check check, Exact exact)
+{
+	const float* x = particles.X();
+	const float* y = particles.Y();
+	const float* z = particles.Z();
+	int count = particles.Size();
+
+	for (int first = 0; first < count; first += PARTICLE_LANES)
+	{
+		int mask = check(laneLoad(x + first), laneLoad(y + first), laneLoad(z + first));
+
+		if (count - first < PARTICLE_LANES)
+		{
+			mask &= (1 << (count - first)) - 1;
+		}
+
+		while (mask != 0)
+		{
+			int lane = lowestSetBit(mask);
+			mask &= mask - 1;
+
+			exact(first + lane);
+		}
+	}
+}
+
+// The exact answer for a particle against a sphere, once it's known to be touching.
+static ParticleContact sphereContact(int particle, const glm::vec3& position, const glm::vec3& center, float radius)
+{
+	glm::vec3 offset = position - center;
+	float length = glm::length(offset);
+	ParticleContact contact;
+
+	// A particle right at the center could go out any way at all, so it goes up.
+	contact.particle = particle;
+	contact.normal = length > 0.0f ? offset / length : glm::vec3(0.0f, 1.0f, 0.0f);
+	contact.distance = length - radius;
+	contact.point = center + contact.normal * radius;
+
+	return contact;
+}
+
+int ParticleBuffer::Add(const glm::vec3& position, const glm::vec3& velocity)
+{
+	// Grow a whole group at a time, so there's always a full group to load at the end.
+	if (count == (int)x.size())
+	{
+		int size = count + PARTICLE_LANES;
+
+		x.resize(size, 0.0f);
+		y.resize(size, 0.0f);
+		z.resize(size, 0.0f);
+		vx.resize(size, 0.0f);
+		vy.resize(size, 0.0f);
+		vz.resize(size, 0.0f);
+	}
+
+	SetPosition(count, position);
+	SetVelocity(count, velocity);
+
+	return count++;
+}
+
+void ParticleBuffer::Integrate(float dt, const glm::vec3& acceleration)
+{
+	for (int i = 0; i < count; i++)
+	{
+		vx[i] += acceleration.x * dt;
+		vy[i] += acceleration.y * dt;
+		vz[i] += acceleration.z * dt;
+
+		x[i] += vx[i] * dt;
+		y[i] += vy[i] * dt;
+		z[i] += vz[i] * dt;
+	}
+}
+
+void ResolveParticleContacts(ParticleBuffer& particles, const std::vector<ParticleContact>& contacts, float restitution)
+{
+	float radius = particles.GetRadius();
+
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		const ParticleContact& contact = contacts[i];
+		glm::vec3 velocity = particles.GetVelocity(contact.particle);
+		float approach = glm::dot(velocity, contact.normal);
+
+		particles.SetPosition(contact.particle, particles.GetPosition(contact.particle) + contact.normal * (radius - contact.distance));
+
+		if (approach < 0.0f)
+		{
+			particles.SetVelocity(contact.particle, velocity - contact.normal * (approach * (1.0f + restitution)));
+		}
+	}
+}
+
+void ParticleCollisionSolver::gatherInBounds(const ParticleBuffer& particles, const AABB& bounds)
+{
+	float radius = particles.GetRadius();
+	Lanes minX = laneSet(bounds.min.x - radius), maxX = laneSet(bounds.max.x + radius);
+	Lanes minY = laneSet(bounds.min.y - radius), maxY = laneSet(bounds.max.y + radius);
+	Lanes minZ = laneSet(bounds.min.z - radius), maxZ = laneSet(bounds.max.z + radius);
+	Lanes zero = laneSet(0.0f);
+
+	candidates.clear();
+
+	// How far outside the box each particle is on the axis it's farthest out on, which is at most 0 for the ones inside.
+	auto check = [&](const Lanes& x, const Lanes& y, const Lanes& z)
+	{
+		Lanes outside = laneMax(laneMax(minX - x, x - maxX), laneMax(laneMax(minY - y, y - maxY), laneMax(minZ - z, z - maxZ)));
+
+		return laneLessEqual(outside, zero);
+	};
+
+	auto add = [this](int particle)
+	{
+		candidates.push_back(particle);
+	};
+
+	forEachGroup(particles, check, add);
+}
+
+void ParticleCollisionSolver::Collide(const OBBShape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts)
+{
+	float radius = particles.GetRadius();
+	Lanes centerX = laneSet(collider.center.x), centerY = laneSet(collider.center.y), centerZ = laneSet(collider.center.z);
+	Lanes zero = laneSet(0.0f);
+	Lanes radiusSquared = laneSet(radius * radius);
+
+	// The squared distance to the box, the same as closestPointOnBox: each particle's offset from the center along each of the box's axes,
+	// and how far that is past the half extent (or 0 if it isn't). It's 0 for every particle inside.
+	auto check = [&](const Lanes& x, const Lanes& y, const Lanes& z)
+	{
+		Lanes offsetX = x - centerX, offsetY = y - centerY, offsetZ = z - centerZ;
+		Lanes squared = zero;
+
+		for (int i = 0; i < 3; i++)
+		{
+			const glm::vec3& axis = collider.axes[i];
+			Lanes along = offsetX * laneSet(axis.x) + offsetY * laneSet(axis.y) + offsetZ * laneSet(axis.z);
+			Lanes past = laneMax(laneAbs(along) - laneSet(collider.halfExtents[i]), zero);
+
+			squared = squared + past * past;
+		}
+
+		return laneLessEqual(squared, radiusSquared);
+	};
+
+	auto exact = [&](int particle)
+	{
+		glm::vec3 position = particles.GetPosition(particle);
+		glm::vec3 offset = position - collider.center;
+		ParticleContact contact;
+		contact.particle = particle;
+
+		// Whether it's inside is decided in the box's frame. (The closest point is put back together from the axes, so for a turned box it
+		// can come out a rounding error away from a particle that's inside.) The nearest face is the axis where the particle is least far
+		// inside, out the side it's on.
+		float nearest = -FLT_MAX;
+
+		for (int i = 0; i < 3; i++)
+		{
+			float along = glm::dot(offset, collider.axes[i]);
+			float past = fabsf(along) - collider.halfExtents[i];
+
+			if (past > nearest)
+			{
+				nearest = past;
+				contact.normal = along >= 0.0f ? collider.axes[i] : -collider.axes[i];
+			}
+		}
+
+		if (nearest <= 0.0f)
+		{
+			contact.distance = nearest;
+			contact.point = position - contact.normal * nearest;
+		}
+		else
+		{
+			glm::vec3 closest = closestPointOnBox(collider, position);
+			glm::vec3 away = position - closest;
+			float length = glm::length(away);
+
+			// (Should the particle be so close that the offset rounds away to nothing, the nearest face's normal is kept.)
+			if (length > 0.0f)
+			{
+				contact.normal = away / length;
+			}
+
+			contact.distance = length;
+			contact.point = closest;
+		}
+
+		contacts.push_back(contact);
+	};
+
+	forEachGroup(particles, check, exact);
+}
+
+void ParticleCollisionSolver::Collide(const SphereShape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts)
+{
+	float reach = collider.radius + particles.GetRadius();
+	Lanes centerX = laneSet(collider.center.x), centerY = laneSet(collider.center.y), centerZ = laneSet(collider.center.z);
+	Lanes reachSquared = laneSet(reach * reach);
+
+	auto check = [&](const Lanes& x, const Lanes& y, const Lanes& z)
+	{
+		Lanes offsetX = x - centerX, offsetY = y - centerY, offsetZ = z - centerZ;
+
+		return laneLessEqual(offsetX * offsetX + offsetY * offsetY + offsetZ * offsetZ, reachSquared);
+	};
+
+	auto exact = [&](int particle)
+	{
+		contacts.push_back(sphereContact(particle, particles.GetPosition(particle), collider.center, collider.radius));
+	};
+
+	forEachGroup(particles, check, exact);
+}
+
+void ParticleCollisionSolver::Collide(const CapsuleShape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts)
+{
+	float reach = collider.radius + particles.GetRadius();
+	glm::vec3 segment = collider.pointB - collider.pointA;
+	float lengthSquared = glm::dot(segment, segment);
+
+	// A capsule with both ends in the same place is a sphere, which every point is closest to the start of.
+	float inverseLengthSquared = lengthSquared > 0.0f ? 1.0f / lengthSquared : 0.0f;
+
+	Lanes startX = laneSet(collider.pointA.x), startY = laneSet(collider.pointA.y), startZ = laneSet(collider.pointA.z);
+	Lanes segmentX = laneSet(segment.x), segmentY = laneSet(segment.y), segmentZ = laneSet(segment.z);
+	Lanes zero = laneSet(0.0f), one = laneSet(1.0f);
+	Lanes reachSquared = laneSet(reach * reach);
+
+	// The squared distance from each particle to the closest point of the segment, which is how far along the segment the particle is,
+	// clamped to the ends.
+	auto check = [&](const Lanes& x, const Lanes& y, const Lanes& z)
+	{
+		Lanes offsetX = x - startX, offsetY = y - startY, offsetZ = z - startZ;
+		Lanes along = (offsetX * segmentX + offsetY * segmentY + offsetZ * segmentZ) * laneSet(inverseLengthSquared);
+		Lanes t = laneMin(laneMax(along, zero), one);
+		Lanes awayX = offsetX - segmentX * t, awayY = offsetY - segmentY * t, awayZ = offsetZ - segmentZ * t;
+
+		return laneLessEqual(awayX * awayX + awayY * awayY + awayZ * awayZ, reachSquared);
+	};
+
+	auto exact = [&](int particle)
+	{
+		glm::vec3 position = particles.GetPosition(particle);
+		float t = glm::clamp(glm::dot(position - collider.pointA, segment) * inverseLengthSquared, 0.0f, 1.0f);
+
+		contacts.push_back(sphereContact(particle, position, collider.pointA + segment * t, collider.radius));
+	};
+
+	forEachGroup(particles, check, exact);
+}
+
+void ParticleCollisionSolver::Collide(const ConvexShape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts)
+{
+	switch (collider.type)
+	{
+	case SHAPE_SPHERE:
+		Collide(collider.As<SphereShape>(), particles, contacts);
+		break;
+	case SHAPE_CAPSULE:
+		Collide(collider.As<CapsuleShape>(), particles, contacts);
+		break;
+	case SHAPE_CYLINDER:
+		Collide(collider.As<CylinderShape>(), particles, contacts);
+		break;
+	case SHAPE_CONE:
+		Collide(collider.As<ConeShape>(), particles, contacts);
+		break;
+	case SHAPE_HULL:
+		Collide(collider.As<HullShape>(), particles, contacts);
+		break;
+	case SHAPE_BOX:
+	default:
+		Collide(collider.As<OBBShape>(), particles, contacts);
+		break;
+	}
+}
+
+#endif // _PARTICLE_COLLISION_CPP
@@ -0,0 +1,235 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ParticleCollision.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _PARTICLE_COLLISION_H
+#define _PARTICLE_COLLISION_H
+
+#include "AABB.h"
+#include "EPA.h"
+#include "GJKDistance.h"
+#include "SIMDLanes.h"
+#include "Shapes.h"
+#include <vector>
+
+// How many particles are tested against a collider at once: one Lanes (see SIMDLanes.h) of them.
+static const int PARTICLE_LANES = LANE_COUNT;
+
+// A particle effect's particles, kept as a structure of arrays (all of the x values, then all of the y values, and so on) so that
+// PARTICLE_LANES of them load into registers at once. The arrays are always a whole number of groups long: the spare slots at the end are
+// never set and never reported.
+// Every particle is a sphere of the same radius (which can be 0, for points).
+class ParticleBuffer
+{
+	std::vector<float> x, y, z;
+	std::vector<float> vx, vy, vz;
+	int count;
+	float radius;
+
+public:
+	ParticleBuffer(float particleRadius = 0.0f)
+	{
+		count = 0;
+		radius = particleRadius;
+	}
+
+	// Adds a particle and returns its index.
+	int Add(const glm::vec3& position, const glm::vec3& velocity);
+
+	// Takes out every particle, keeping the arrays' room.
+	void Clear()
+	{
+		count = 0;
+	}
+
+	// Moves every particle forward by its velocity, after speeding it up by acceleration (gravity, usually).
+	void Integrate(float dt, const glm::vec3& acceleration);
+
+	int Size() const
+	{
+		return count;
+	}
+	float GetRadius() const
+	{
+		return radius;
+	}
+	void SetRadius(float particleRadius)
+	{
+		radius = particleRadius;
+	}
+
+	glm::vec3 GetPosition(int particle) const
+	{
+		return glm::vec3(x[particle], y[particle], z[particle]);
+	}
+	void SetPosition(int particle, const glm::vec3& position)
+	{
+		x[particle] = position.x;
+		y[particle] = position.y;
+		z[particle] = position.z;
+	}
+	glm::vec3 GetVelocity(int particle) const
+	{
+		return glm::vec3(vx[particle], vy[particle], vz[particle]);
+	}
+	void SetVelocity(int particle, const glm::vec3& velocity)
+	{
+		vx[particle] = velocity.x;
+		vy[particle] = velocity.y;
+		vz[particle] = velocity.z;
+	}
+
+	// The arrays themselves, for the collision tests.
+	const float* X() const
+	{
+		return x.data();
+	}
+	const float* Y() const
+	{
+		return y.data();
+	}
+	const float* Z() const
+	{
+		return z.data();
+	}
+};
+
+// A particle touching (or inside) a collider. distance is from the collider's surface to the particle's center, and is negative if the center
+// is inside. normal points out of the collider toward the particle, and point is the closest point of the collider's surface to the center.
+struct ParticleContact
+{
+	int particle;
+	float distance;
+	glm::vec3 normal;
+	glm::vec3 point;
+};
+
+// Pushes every particle in contacts back out to its collider's surface (plus its radius), and bounces away the part of its velocity that was
+// going into the collider, keeping restitution of it (0 stops it dead against the surface, 1 bounces it back as fast as it came).
+void ResolveParticleContacts(ParticleBuffer& particles, const std::vector<ParticleContact>& contacts, float restitution);
+
+// Collides a ParticleBuffer against one collider at a time, adding a ParticleContact to contacts for every particle within its radius of the
+// collider. (contacts isn't cleared first, so one list can gather the contacts with several colliders.)
+// Most particles aren't anywhere near a given collider, so PARTICLE_LANES particles at a time are first checked with a few vector
+// instructions, and only the ones that pass get the exact answer one at a time:
+// - Boxes, spheres and capsules have a closest point that can be worked out directly, so the check is exact: the squared distance from
+//   every particle in the group to the shape at once, against the squared radius.
+// - Any other shape only needs a support function. The check is against the shape's bounds (from six support points, see
+//   getBoundsFromSupport), and each particle that passes gets a GJK distance query with a point as the other shape, where the Minkowski
+//   Difference is just the collider moved by the point, so GJK is down to finding the closest point of the collider. A particle that's
+//   inside gets EPA to find the way out.
+// Keep one solver per thread: it holds the working space for the queries.
+class ParticleCollisionSolver
+{
+	GJKDistanceSolver distance;
+	GJKSolver gjk;
+	EPASolver epa;
+
+	// The particles that passed the group check against the current collider.
+	std::vector<int> candidates;
+
+	// Fills candidates with every particle within the box (grown by the particles' radius).
+	void gatherInBounds(const ParticleBuffer& particles, const AABB& bounds);
+
+	// The exact answer for one particle against a shape with only a support function. Returns false if it isn't touching.
+	template<typename Shape>
+	bool collideSupport(const Shape& collider, const glm::vec3& position, float radius, ParticleContact& contact);
+
+public:
+	void Collide(const OBBShape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts);
+	void Collide(const SphereShape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts);
+	void Collide(const CapsuleShape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts);
+
+	// Picks whichever of the above is right for the shape a ConvexShape is holding.
+	void Collide(const ConvexShape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts);
+
+	// Any other shape with a support function (cylinders, cones, hulls and so on).
+	template<typename Shape>
+	void Collide(const Shape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts);
+};
+
+template<typename Shape>
+bool ParticleCollisionSolver::collideSupport(const Shape& collider, const glm::vec3& position, float radius, ParticleContact& contact)
+{
+	// A sphere with no radius is a point to GJK, since its support point is its center in every direction.
+	SphereShape point(position, 0.0f);
+	GJKDistanceResult result;
+
+	if (distance.Distance(collider, point, result) > radius)
+	{
+		return false;
+	}
+
+	if (!result.overlapping)
+	{
+		contact.distance = result.distance;
+		contact.normal = result.normal;
+		contact.point = result.pointA;
+
+		return true;
+	}
+
+	// The center is inside. EPA needs the boolean test's simplex to start from, and moving the point by normal * depth takes it out.
+	EPAResult penetration;
+
+	if (!gjk.TestGJK(collider, point) || !epa.Penetration(collider, point, gjk.GetSimplex(), penetration))
+	{
+		return false;
+	}
+
+	contact.distance = -penetration.depth;
+	contact.normal = penetration.normal;
+	contact.point = position + penetration.normal * penetration.depth;
+
+	return true;
+}
+
+template<typename Shape>
+void ParticleCollisionSolver::Collide(const Shape& collider, const ParticleBuffer& particles, std::vector<ParticleContact>& contacts)
+{
+	gatherInBounds(particles, getBoundsFromSupport(collider));
+
+	for (int i = 0; i < (int)candidates.size(); i++)
+	{
+		ParticleContact contact;
+		contact.particle = candidates[i];
+
+		if (collideSupport(collider, particles.GetPosition(contact.particle), particles.GetRadius(), contact))
+		{
+			contacts.push_back(contact);
+		}
+	}
+}
+
+#endif //_PARTICLE_COLLISION_H
@@ -0,0 +1,215 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PhysicsCommands.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PHYSICS_COMMANDS_CPP
+#define _PHYSICS_COMMANDS_CPP
+
+#include "PhysicsCommands.h"
+
+PhysicsCommandQueue::PhysicsCommandQueue(int capacity)
+{
+	unsigned int size = 2;
+
+	while (size < (unsigned int)capacity)
+	{
+		size *= 2;
+	}
+
+	slots = new Slot[size];
+	mask = size - 1;
+
+	// Slot i is free for the producer that gets push position i.
+	for (unsigned int i = 0; i < size; i++)
+	{
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	pushPosition.store(0, std::memory_order_relaxed);
+	popPosition.store(0, std::memory_order_relaxed);
+	dropped.store(0, std::memory_order_relaxed);
+}
+
+PhysicsCommandQueue::~PhysicsCommandQueue()
+{
+	delete[] slots;
+}
+
+bool PhysicsCommandQueue::Push(const PhysicsCommand& command)
+{
+	unsigned int position = pushPosition.load(std::memory_order_relaxed);
+	Slot* slot;
+
+	for (;;)
+	{
+		slot = &slots[position & mask];
+
+		int difference = (int)(slot->sequence.load(std::memory_order_acquire) - position);
+
+		if (difference == 0)
+		{
+			// It's free: claim it, unless another producer got there first (in which case position is now where they left it).
+			if (pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			// It still holds the command from the last time around the ring, which hasn't been made yet.
+			dropped.fetch_add(1, std::memory_order_relaxed);
+
+			return false;
+		}
+		else
+		{
+			// Another producer has claimed it since we looked.
+			position = pushPosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->command = command;
+	slot->sequence.store(position + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool PhysicsCommandQueue::Pop(PhysicsCommand& command)
+{
+	unsigned int position = popPosition.load(std::memory_order_relaxed);
+	Slot& slot = slots[position & mask];
+
+	// Not filled in yet (or never claimed).
+	if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+	{
+		return false;
+	}
+
+	command = slot.command;
+	popPosition.store(position + 1, std::memory_order_relaxed);
+
+	// Free it for the producer that gets this slot on the next time around.
+	slot.sequence.store(position + mask + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool PhysicsCommandQueue::AddBox(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& position,
+	const glm::quat& orientation, const glm::vec3& scale, std::atomic<int>* result)
+{
+	PhysicsCommand command;
+	command.type = COMMAND_ADD_BOX;
+	command.object = -1;
+	command.vector = position;
+	command.orientation = orientation;
+	command.center = center;
+	command.halfExtents = halfExtents;
+	command.scale = scale;
+	command.result = result;
+
+	return Push(command);
+}
+
+bool PhysicsCommandQueue::SetEnabled(int object, bool enable)
+{
+	PhysicsCommand command;
+	command.type = enable ? COMMAND_ENABLE : COMMAND_DISABLE;
+	command.object = object;
+
+	return Push(command);
+}
+
+bool PhysicsCommandQueue::SetPosition(int object, const glm::vec3& position)
+{
+	PhysicsCommand command;
+	command.type = COMMAND_SET_POSITION;
+	command.object = object;
+	command.vector = position;
+
+	return Push(command);
+}
+
+bool PhysicsCommandQueue::SetOrientation(int object, const glm::quat& orientation)
+{
+	PhysicsCommand command;
+	command.type = COMMAND_SET_ORIENTATION;
+	command.object = object;
+	command.orientation = orientation;
+
+	return Push(command);
+}
+
+bool PhysicsCommandQueue::SetVelocity(int object, const glm::vec3& velocity)
+{
+	PhysicsCommand command;
+	command.type = COMMAND_SET_VELOCITY;
+	command.object = object;
+	command.vector = velocity;
+
+	return Push(command);
+}
+
+bool PhysicsCommandQueue::SetAngularVelocity(int object, const glm::vec3& angularVelocity)
+{
+	PhysicsCommand command;
+	command.type = COMMAND_SET_ANGULAR_VELOCITY;
+	command.object = object;
+	command.vector = angularVelocity;
+
+	return Push(command);
+}
+
+bool PhysicsCommandQueue::SetBodyType(int object, BodyType type)
+{
+	PhysicsCommand command;
+	command.type = COMMAND_SET_BODY_TYPE;
+	command.object = object;
+	command.bodyType = type;
+
+	return Push(command);
+}
+
+bool PhysicsCommandQueue::SetKinematicTarget(int object, const glm::vec3& position, const glm::quat& orientation)
+{
+	PhysicsCommand command;
+	command.type = COMMAND_SET_KINEMATIC_TARGET;
+	command.object = object;
+	command.vector = position;
+	command.orientation = orientation;
+
+	return Push(command);
+}
+
+#endif //_PHYSICS_COMMANDS_CPP
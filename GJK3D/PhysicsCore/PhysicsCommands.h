@@ -0,0 +1,133 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PhysicsCommands.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PHYSICS_COMMANDS_H
+#define _PHYSICS_COMMANDS_H
+
+#include "BodyStore.h"
+#include <atomic>
+
+// What a PhysicsCommand does to its object.
+enum PhysicsCommandType
+{
+	COMMAND_ADD_BOX,				// Adds an object (see PhysicsWorld::AddBox), and stores its number in result.
+	COMMAND_ENABLE,					// Puts an object back in the world.
+	COMMAND_DISABLE,				// Takes an object out of the world. (Objects can't be removed, so this is what destroying one comes to.)
+	COMMAND_SET_POSITION,
+	COMMAND_SET_ORIENTATION,
+	COMMAND_SET_VELOCITY,
+	COMMAND_SET_ANGULAR_VELOCITY,
+	COMMAND_SET_BODY_TYPE,
+	COMMAND_SET_KINEMATIC_TARGET	// Moves a kinematic object to position and orientation over the next step.
+};
+
+// One change to make to the world the next time it's in between steps. Only the fields the type needs are used.
+struct PhysicsCommand
+{
+	PhysicsCommandType type;
+	int object;
+	int bodyType;						// A BodyType, for COMMAND_SET_BODY_TYPE.
+	glm::vec3 vector;					// The position, velocity or angular velocity to set, or the new box's position.
+	glm::quat orientation;
+	glm::vec3 center;					// The new box's center, half extents and scale.
+	glm::vec3 halfExtents;
+	glm::vec3 scale;
+	std::atomic<int>* result;			// Where to put the new object's number once it's been added (or nullptr).
+};
+
+// Lets any thread change the world's objects while the physics thread is stepping it, without either of them waiting on the other.
+// Setting a body's velocity or position straight through its GameObject from another thread races with the step reading and writing the
+// same arrays. Instead, commands go in here, and the thread that steps the world makes them all with PhysicsWorld::ApplyCommands, in the
+// order they were pushed, between steps, when nothing else is touching the bodies. (Step doesn't call it; SimulationRecorder::Step does.)
+// It's a ring of slots, each with a sequence number that says whose turn it is: a producer claims the next slot by bumping the push
+// position with a compare and swap, fills it in, and then bumps its sequence number to hand it to the physics thread, which hands it back
+// the same way once it's read it. Nobody ever takes a lock or waits on anyone else: a producer that finds the ring full is told so rather
+// than made to wait, and a slot that's been claimed but not filled in yet is simply left (with everything after it) for the next step.
+// Any number of threads can push at once, but only one thread (the one that steps the world) can pop.
+class PhysicsCommandQueue
+{
+	struct Slot
+	{
+		std::atomic<unsigned int> sequence;
+		PhysicsCommand command;
+	};
+
+	Slot* slots;
+	unsigned int mask;
+
+	// Kept a cache line apart, so producers bumping one don't keep taking the other's line away from the physics thread.
+	std::atomic<unsigned int> pushPosition;
+	char padding[64];
+	std::atomic<unsigned int> popPosition;
+
+	// Commands that didn't fit.
+	std::atomic<int> dropped;
+
+	PhysicsCommandQueue(const PhysicsCommandQueue&);
+	PhysicsCommandQueue& operator=(const PhysicsCommandQueue&);
+
+public:
+	// Makes room for capacity commands at once (rounded up to a power of 2). It has to hold every command pushed between two steps.
+	PhysicsCommandQueue(int capacity = 4096);
+	~PhysicsCommandQueue();
+
+	// Adds a command to be made before the next step. Returns false (and drops it) if the queue is full.
+	bool Push(const PhysicsCommand& command);
+
+	// Takes the oldest command out of the queue. Returns false if there's nothing ready.
+	// Only the thread that steps the world can call this.
+	bool Pop(PhysicsCommand& command);
+
+	// How many commands have been dropped because the queue was full.
+	int NumDropped() const
+	{
+		return dropped.load(std::memory_order_relaxed);
+	}
+
+	// The same as the PhysicsWorld functions of the same names, but made before the next step. The object's number can't be known until
+	// then, so AddBox stores it in result when it's added (if result isn't nullptr).
+	bool AddBox(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& position, const glm::quat& orientation,
+		const glm::vec3& scale, std::atomic<int>* result = nullptr);
+	bool SetEnabled(int object, bool enable);
+	bool SetPosition(int object, const glm::vec3& position);
+	bool SetOrientation(int object, const glm::quat& orientation);
+	bool SetVelocity(int object, const glm::vec3& velocity);
+	bool SetAngularVelocity(int object, const glm::vec3& angularVelocity);
+	bool SetBodyType(int object, BodyType type);
+	bool SetKinematicTarget(int object, const glm::vec3& position, const glm::quat& orientation);
+};
+
+#endif //_PHYSICS_COMMANDS_H
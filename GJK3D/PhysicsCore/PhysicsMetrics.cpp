@@ -0,0 +1,369 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PhysicsMetrics.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _PHYSICS_METRICS_CPP
+#define _PHYSICS_METRICS_CPP
+
+#include "PhysicsMetrics.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+	#include <psapi.h>
+#elif defined(__linux__)
+	#include <unistd.h>
+#endif
+
+long long GetResidentMemory()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return (long long)counters.WorkingSetSize;
+	}
+
+	return 0;
+#elif defined(__linux__)
+	// The second number in statm is the resident set, in pages.
+	FILE* in = fopen("/proc/self/statm", "r");
+	long long pages = 0;
+	long long resident = 0;
+
+	if (in == nullptr)
+	{
+		return 0;
+	}
+
+	if (fscanf(in, "%lld %lld", &pages, &resident) != 2)
+	{
+		resident = 0;
+	}
+
+	fclose(in);
+
+	return resident * sysconf(_SC_PAGESIZE);
+#else
+	return 0;
+#endif
+}
+
+PhysicsMetrics::PhysicsMetrics(int window)
+{
+	stepTimes.reserve(std::max(window, 1));
+	log = nullptr;
+	logInterval = 0.0;
+	lastLog = 0.0;
+
+	Reset();
+}
+
+PhysicsMetrics::~PhysicsMetrics()
+{
+	CloseLog();
+}
+
+void PhysicsMetrics::Reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	stepTimes.clear();
+	nextTime = 0;
+	steps = 0;
+	stepSeconds = 0.0;
+	last = PhysicsStepStats();
+	bodies = 0;
+	gjk.Reset();
+	arenaBytes = 0;
+}
+
+void PhysicsMetrics::Record(PhysicsWorld& world)
+{
+	const PhysicsStepStats& stats = world.GetStepStats();
+
+	// The arenas only grow, and only during a step, so this can be read between steps without any locking.
+	long long arenas = 0;
+	JobSystem* jobs = world.GetJobSystem();
+
+	for (int i = 0; i < jobs->GetThreadCount(); i++)
+	{
+		arenas += (long long)jobs->GetArena(i).GetCapacity();
+	}
+
+	bool writeLog = false;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if ((int)stepTimes.size() < (int)stepTimes.capacity())
+		{
+			stepTimes.push_back(stats.total);
+		}
+		else
+		{
+			stepTimes[nextTime] = stats.total;
+			nextTime = (nextTime + 1) % (int)stepTimes.size();
+		}
+
+		steps++;
+		stepSeconds += stats.total;
+		last = stats;
+		bodies = world.NumObjects();
+		gjk.Add(world.GetGJKStats());
+		arenaBytes = arenas;
+
+		writeLog = log != nullptr && clock.Now() - lastLog >= logInterval;
+	}
+
+	if (writeLog)
+	{
+		std::string line = FormatJSON();
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (log != nullptr)
+		{
+			fprintf(log, "%s\n", line.c_str());
+			fflush(log);
+			lastLog = clock.Now();
+		}
+	}
+}
+
+PhysicsMetricsSnapshot PhysicsMetrics::GetSnapshot() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return snapshot();
+}
+
+PhysicsMetricsSnapshot PhysicsMetrics::snapshot() const
+{
+	PhysicsMetricsSnapshot result;
+
+	result.steps = steps;
+	result.stepSeconds = stepSeconds;
+	result.stepMean = result.stepP50 = result.stepP90 = result.stepP99 = result.stepMax = 0.0;
+
+	if (!stepTimes.empty())
+	{
+		std::vector<double> sorted = stepTimes;
+		std::sort(sorted.begin(), sorted.end());
+
+		int count = (int)sorted.size();
+		double total = 0.0;
+
+		for (int i = 0; i < count; i++)
+		{
+			total += sorted[i];
+		}
+
+		// The nearest rank: the smallest time that at least that fraction of the steps took no longer than.
+		result.stepMean = total / count;
+		result.stepP50 = sorted[std::max((count * 50 + 99) / 100 - 1, 0)];
+		result.stepP90 = sorted[std::max((count * 90 + 99) / 100 - 1, 0)];
+		result.stepP99 = sorted[std::max((count * 99 + 99) / 100 - 1, 0)];
+		result.stepMax = sorted[count - 1];
+	}
+
+	result.bodies = bodies;
+	result.sleeping = last.sleeping;
+	result.pairs = last.pairs;
+	result.contacts = last.contacts;
+	result.islands = last.islands;
+
+	result.gjkQueries = gjk.queries;
+	result.gjkIterations = gjk.iterations;
+	result.gjkP99Iterations = 0;
+
+	long long seen = 0;
+
+	for (int i = 0; i <= GJKStats::MAX_ITERATIONS && gjk.queries > 0; i++)
+	{
+		seen += gjk.iterationHistogram[i];
+
+		if (seen * 100 >= gjk.queries * 99)
+		{
+			result.gjkP99Iterations = i;
+			break;
+		}
+	}
+
+	result.residentBytes = GetResidentMemory();
+	result.arenaBytes = arenaBytes;
+
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+	{
+		result.memory[i] = GetMemoryUsage((MemoryTag)i);
+	}
+
+	return result;
+}
+
+std::string PhysicsMetrics::FormatPrometheus(const std::string& prefix) const
+{
+	PhysicsMetricsSnapshot metrics = GetSnapshot();
+
+	std::string text;
+	char line[256];
+
+	auto add = [&](const char* name, const char* type, const char* help)
+	{
+		snprintf(line, sizeof(line), "# HELP %s_%s %s\n# TYPE %s_%s %s\n", prefix.c_str(), name, help, prefix.c_str(), name, type);
+		text += line;
+	};
+
+	add("step_seconds", "summary", "How long the physics steps took, over the last steps kept.");
+	snprintf(line, sizeof(line), "%s_step_seconds{quantile=\"0.5\"} %.9g\n", prefix.c_str(), metrics.stepP50);
+	text += line;
+	snprintf(line, sizeof(line), "%s_step_seconds{quantile=\"0.9\"} %.9g\n", prefix.c_str(), metrics.stepP90);
+	text += line;
+	snprintf(line, sizeof(line), "%s_step_seconds{quantile=\"0.99\"} %.9g\n", prefix.c_str(), metrics.stepP99);
+	text += line;
+	snprintf(line, sizeof(line), "%s_step_seconds{quantile=\"1\"} %.9g\n", prefix.c_str(), metrics.stepMax);
+	text += line;
+	snprintf(line, sizeof(line), "%s_step_seconds_sum %.9g\n%s_step_seconds_count %lld\n", prefix.c_str(), metrics.stepSeconds,
+		prefix.c_str(), metrics.steps);
+	text += line;
+
+	// The rest are one number each.
+	auto metric = [&](const char* name, const char* type, const char* help, long long value)
+	{
+		add(name, type, help);
+		snprintf(line, sizeof(line), "%s_%s %lld\n", prefix.c_str(), name, value);
+		text += line;
+	};
+
+	metric("bodies", "gauge", "Objects in the world.", metrics.bodies);
+	metric("sleeping", "gauge", "Objects asleep after the last step.", metrics.sleeping);
+	metric("pairs", "gauge", "Pairs the broadphase found in the last step.", metrics.pairs);
+	metric("contacts", "gauge", "Pairs that were touching in the last step.", metrics.contacts);
+	metric("islands", "gauge", "Groups of touching objects in the last step.", metrics.islands);
+	metric("gjk_queries_total", "counter", "GJK queries run.", metrics.gjkQueries);
+	metric("gjk_iterations_total", "counter", "GJK iterations, over every query.", metrics.gjkIterations);
+	metric("gjk_iterations_p99", "gauge", "The most iterations 99 in 100 GJK queries took.", metrics.gjkP99Iterations);
+	metric("resident_bytes", "gauge", "The process's resident memory.", metrics.residentBytes);
+	metric("arena_bytes", "gauge", "Memory the job system's arenas hold for the steps.", metrics.arenaBytes);
+
+	// Each subsystem's memory, now and at its peak, labelled with the subsystem.
+	add("memory_bytes", "gauge", "Memory counted under each subsystem.");
+
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+	{
+		snprintf(line, sizeof(line), "%s_memory_bytes{subsystem=\"%s\"} %lld\n", prefix.c_str(), GetMemoryTagName((MemoryTag)i),
+			metrics.memory[i].current);
+		text += line;
+	}
+
+	add("memory_peak_bytes", "gauge", "The most memory there has been under each subsystem at once.");
+
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+	{
+		snprintf(line, sizeof(line), "%s_memory_peak_bytes{subsystem=\"%s\"} %lld\n", prefix.c_str(), GetMemoryTagName((MemoryTag)i),
+			metrics.memory[i].peak);
+		text += line;
+	}
+
+	return text;
+}
+
+std::string PhysicsMetrics::FormatJSON() const
+{
+	PhysicsMetricsSnapshot metrics = GetSnapshot();
+	char line[1024];
+
+	snprintf(line, sizeof(line), "{\"time\":%.3f,\"steps\":%lld,\"step_ms\":{\"mean\":%.4f,\"p50\":%.4f,\"p90\":%.4f,\"p99\":%.4f,\"max\":%.4f},"
+		"\"bodies\":%d,\"sleeping\":%d,\"pairs\":%d,\"contacts\":%d,\"islands\":%d,"
+		"\"gjk\":{\"queries\":%lld,\"iterations\":%lld,\"iterations_p99\":%d},\"resident_bytes\":%lld,\"arena_bytes\":%lld}",
+		clock.Now(), metrics.steps, metrics.stepMean * 1000.0, metrics.stepP50 * 1000.0, metrics.stepP90 * 1000.0, metrics.stepP99 * 1000.0,
+		metrics.stepMax * 1000.0, metrics.bodies, metrics.sleeping, metrics.pairs, metrics.contacts, metrics.islands, metrics.gjkQueries,
+		metrics.gjkIterations, metrics.gjkP99Iterations, metrics.residentBytes, metrics.arenaBytes);
+
+	// The subsystems' memory goes on the end, as [current, peak] for each.
+	std::string json(line, strlen(line) - 1);
+
+	json += ",\"memory\":{";
+
+	for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+	{
+		snprintf(line, sizeof(line), "%s\"%s\":[%lld,%lld]", i > 0 ? "," : "", GetMemoryTagName((MemoryTag)i), metrics.memory[i].current,
+			metrics.memory[i].peak);
+		json += line;
+	}
+
+	return json + "}}";
+}
+
+bool PhysicsMetrics::OpenLog(const std::string& fileName, double intervalSeconds)
+{
+	CloseLog();
+
+	FILE* file = fopen(fileName.c_str(), "a");
+
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	log = file;
+	logInterval = intervalSeconds;
+	lastLog = clock.Now();
+
+	return true;
+}
+
+void PhysicsMetrics::CloseLog()
+{
+	if (log == nullptr)
+	{
+		return;
+	}
+
+	std::string line = FormatJSON();
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	fprintf(log, "%s\n", line.c_str());
+	fclose(log);
+	log = nullptr;
+}
+
+#endif // _PHYSICS_METRICS_CPP
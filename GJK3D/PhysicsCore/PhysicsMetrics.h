@@ -0,0 +1,138 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PhysicsMetrics.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _PHYSICS_METRICS_H
+#define _PHYSICS_METRICS_H
+
+#include "Clock.h"
+#include "GJK.h"
+#include "MemoryTracker.h"
+#include "PhysicsWorld.h"
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// What a PhysicsMetrics has seen, all in one go. The step times are over the last steps it kept (see PhysicsMetrics), in seconds. The
+// counts are from the last step. The GJK figures are over every step since the metrics were reset, and are only there if the world was
+// counting them (see PhysicsWorld::SetGJKStatsEnabled).
+struct PhysicsMetricsSnapshot
+{
+	long long steps;		// Every step recorded since the reset, not just the ones kept.
+
+	double stepMean;
+	double stepP50;
+	double stepP90;
+	double stepP99;
+	double stepMax;
+	double stepSeconds;		// All of the steps since the reset added together.
+
+	int bodies;
+	int sleeping;
+	int pairs;
+	int contacts;
+	int islands;
+
+	long long gjkQueries;
+	long long gjkIterations;
+	int gjkP99Iterations;	// 99 in 100 queries took no more iterations than this.
+
+	long long residentBytes;	// The whole process's memory, as the operating system counts it (0 where we can't ask).
+	long long arenaBytes;		// What the job system's arenas have grabbed for the steps (see StepArena).
+
+	MemoryUsage memory[MEMORY_TAG_COUNT];	// Each subsystem's memory, process-wide (see MemoryTracker.h).
+};
+
+// The process's resident memory in bytes, or 0 if we don't know how to find out here.
+long long GetResidentMemory();
+
+// Keeps track of how a world's steps are going, for a server with no window to show it in: how long the steps take (their percentiles, so
+// the occasional slow step doesn't vanish into an average), how much is in the world and touching, how hard GJK is working, and how much
+// memory is in use. Call Record after each step.
+// It can be read two ways. Another thread can pull it whenever it wants (GetSnapshot, or one of the Format functions, which give the text to
+// send back from a metrics endpoint), or it can write a line of JSON to a log every so often by itself (see OpenLog).
+class PhysicsMetrics
+{
+	// Guards everything below, since the reading is usually done by another thread.
+	mutable std::mutex mutex;
+
+	// The last so many steps' times, as a ring.
+	std::vector<double> stepTimes;
+	int nextTime;
+
+	long long steps;
+	double stepSeconds;
+	PhysicsStepStats last;
+	int bodies;
+	GJKStats gjk;
+	long long arenaBytes;
+
+	// The periodic log, if there is one.
+	mutable SteadyClock clock;
+	FILE* log;
+	double logInterval;
+	double lastLog;
+
+	PhysicsMetricsSnapshot snapshot() const;
+
+public:
+	// window is how many of the last steps the step time percentiles are over.
+	PhysicsMetrics(int window = 1024);
+
+	// Writes a last line to the log, if there is one, and closes it.
+	~PhysicsMetrics();
+
+	// Adds the step world just took.
+	void Record(PhysicsWorld& world);
+
+	// Forgets everything recorded so far.
+	void Reset();
+
+	PhysicsMetricsSnapshot GetSnapshot() const;
+
+	// The metrics in the Prometheus text format (the step times as a summary with its quantiles, and the rest as gauges and counters), ready
+	// to be served up to a scraper. Every name starts with prefix.
+	std::string FormatPrometheus(const std::string& prefix = "gjk_physics") const;
+
+	// The metrics as one line of JSON (without a newline on the end), with the time on the metrics' clock.
+	std::string FormatJSON() const;
+
+	// Starts appending FormatJSON to fileName, a line at a time, from the first Record at least intervalSeconds after the last line was
+	// written. Returns false if the file couldn't be opened.
+	bool OpenLog(const std::string& fileName, double intervalSeconds);
+	void CloseLog();
+};
+
+#endif //_PHYSICS_METRICS_H
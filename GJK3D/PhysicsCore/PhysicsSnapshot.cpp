@@ -0,0 +1,161 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PhysicsSnapshot.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PHYSICS_SNAPSHOT_CPP
+#define _PHYSICS_SNAPSHOT_CPP
+
+#include "PhysicsSnapshot.h"
+#include "BodyStore.h"
+
+SnapshotBuffer::SnapshotBuffer()
+{
+	published = 0;
+}
+
+void SnapshotBuffer::Publish()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// The latest becomes the previous one, and the one that was just written becomes the latest. What was the previous one is free to be written over next.
+	previous.Swap(current);
+	current.Swap(writing);
+
+	published++;
+}
+
+bool SnapshotBuffer::Interpolate(double now, double step, std::vector<glm::mat4>& transforms, std::vector<AABB>& bounds)
+{
+	if (!InterpolatePoses(now, step, blendedPositions, blendedOrientations, blendedScales, bounds))
+	{
+		return false;
+	}
+
+	int count = (int)blendedPositions.size();
+
+	transforms.resize(count);
+	BodyStore::BuildTransforms(blendedPositions.data(), blendedOrientations.data(), blendedScales.data(), transforms.data(), count);
+
+	return true;
+}
+
+bool SnapshotBuffer::InterpolatePoses(double now, double step, std::vector<glm::vec3>& positions, std::vector<glm::quat>& orientations,
+	std::vector<glm::vec3>& scales, std::vector<AABB>& bounds, std::vector<unsigned char>* resting)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (published == 0)
+	{
+		return false;
+	}
+
+	int count = (int)current.positions.size();
+
+	// If there's only been one snapshot, or the number of objects changed between the two, just draw the latest as it is.
+	if (published < 2 || (int)previous.positions.size() != count)
+	{
+		positions.assign(current.positions.begin(), current.positions.end());
+		orientations.assign(current.orientations.begin(), current.orientations.end());
+		scales.assign(current.scales.begin(), current.scales.end());
+		bounds.assign(current.bounds.begin(), current.bounds.end());
+
+		if (resting != nullptr)
+		{
+			resting->assign(current.resting.begin(), current.resting.end());
+		}
+
+		return true;
+	}
+
+	positions.resize(count);
+	orientations.resize(count);
+	scales.resize(count);
+	bounds.resize(count);
+
+	if (resting != nullptr)
+	{
+		resting->resize(count);
+	}
+
+	float alpha = (float)((current.accumulator + (now - current.time)) / step);
+
+	// Past the end of the blend means the physics has fallen behind. Hold on the latest rather than guessing where things went next.
+	alpha = glm::clamp(alpha, 0.0f, 1.0f);
+
+	for (int i = 0; i < count; i++)
+	{
+		if (resting != nullptr)
+		{
+			bool still = current.resting[i] && previous.positions[i] == current.positions[i] &&
+				previous.orientations[i] == current.orientations[i] && previous.scales[i] == current.scales[i] &&
+				previous.bounds[i].min == current.bounds[i].min && previous.bounds[i].max == current.bounds[i].max;
+
+			(*resting)[i] = still ? 1 : 0;
+
+			if (still)
+			{
+				positions[i] = current.positions[i];
+				orientations[i] = current.orientations[i];
+				scales[i] = current.scales[i];
+				bounds[i] = current.bounds[i];
+				continue;
+			}
+		}
+
+		positions[i] = glm::mix(previous.positions[i], current.positions[i], alpha);
+		orientations[i] = glm::slerp(previous.orientations[i], current.orientations[i], alpha);
+		scales[i] = glm::mix(previous.scales[i], current.scales[i], alpha);
+
+		bounds[i] = AABB::Union(previous.bounds[i], current.bounds[i]);
+	}
+
+	return true;
+}
+
+bool SnapshotBuffer::CopyLatest(PhysicsSnapshot& snapshot)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (published == 0)
+	{
+		return false;
+	}
+
+	snapshot = current;
+
+	return true;
+}
+
+#endif // _PHYSICS_SNAPSHOT_CPP
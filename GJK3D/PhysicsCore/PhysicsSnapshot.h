@@ -0,0 +1,158 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PhysicsSnapshot.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PHYSICS_SNAPSHOT_H
+#define _PHYSICS_SNAPSHOT_H
+
+#include "AABB.h"
+#include "Shapes.h"
+#include "Broadphase.h"
+#include "EPA.h"
+#include "glm\gtc\quaternion.hpp"
+#include <vector>
+#include <mutex>
+
+// Everything the renderer needs to know about the scene after one round of physics steps: where each object is, which way it's facing,
+// how big it is and the box around it (all in the same order as the objects).
+struct PhysicsSnapshot
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::quat> orientations;
+	std::vector<glm::vec3> scales;
+	std::vector<AABB> bounds;
+
+	// Whether each object was asleep or static (1) or not (0). Whoever takes the snapshot fills these in, and the renderer only uses them to
+	// tell which objects it might not have to send to the GPU again (see SnapshotBuffer::InterpolatePoses).
+	std::vector<unsigned char> resting;
+
+	// Optionally, what the collision detection worked with: every object's OBB, the pairs the broadphase found, which of them were
+	// colliding (sorted), and where and which way each of those was touching. Nothing about drawing the objects needs these, so they're only
+	// filled in for whoever asks (like a GPU cross-check of the narrowphase, or the debug lines), and otherwise left empty.
+	std::vector<OBBShape> shapes;
+	std::vector<BroadphasePair> pairs;
+	std::vector<BroadphasePair> contacts;
+	std::vector<EPAResult> contactPoints;
+
+	// When the snapshot was taken (in seconds, on the same clock the renderer reads), and how much time the physics had left over in its
+	// accumulator at that point, not yet stepped.
+	double time;
+	double accumulator;
+
+	PhysicsSnapshot()
+	{
+		time = 0.0;
+		accumulator = 0.0;
+	}
+
+	void Resize(int count)
+	{
+		positions.resize(count);
+		orientations.resize(count);
+		scales.resize(count);
+		bounds.resize(count);
+		resting.resize(count);
+	}
+
+	// Swaps the contents of two snapshots without copying the arrays.
+	void Swap(PhysicsSnapshot& other)
+	{
+		positions.swap(other.positions);
+		orientations.swap(other.orientations);
+		scales.swap(other.scales);
+		bounds.swap(other.bounds);
+		resting.swap(other.resting);
+		shapes.swap(other.shapes);
+		pairs.swap(other.pairs);
+		contacts.swap(other.contacts);
+		contactPoints.swap(other.contactPoints);
+		std::swap(time, other.time);
+		std::swap(accumulator, other.accumulator);
+	}
+};
+
+// Hands snapshots from the physics thread to the render thread.
+// The physics thread fills in a snapshot of its own without holding anything, then Publish swaps it in as the latest under a lock (which only
+// swaps the arrays around, so it never waits long). The renderer always has the two latest snapshots to draw from, and blends between them,
+// so it can draw as often as it likes no matter how long a physics step takes, and the motion is still smooth.
+class SnapshotBuffer
+{
+	// The second latest and latest snapshots, which the renderer reads, and the one the physics thread is filling in.
+	PhysicsSnapshot previous;
+	PhysicsSnapshot current;
+	PhysicsSnapshot writing;
+
+	// How many snapshots have been published (we need two before there's anything to blend between).
+	int published;
+
+	std::mutex mutex;
+
+	// The renderer's working space for the blended positions, orientations and scales.
+	std::vector<glm::vec3> blendedPositions;
+	std::vector<glm::quat> blendedOrientations;
+	std::vector<glm::vec3> blendedScales;
+
+public:
+	SnapshotBuffer();
+
+	// The snapshot for the physics thread to fill in next. Only the physics thread may touch it, and only until it calls Publish.
+	PhysicsSnapshot& GetWriting()
+	{
+		return writing;
+	}
+
+	// Makes the snapshot from GetWriting the latest one.
+	void Publish();
+
+	// Works out the transform and bounds of every object at time now (on the snapshots' clock), given the length of a physics step.
+	// The latest snapshot is really the state at time + step - accumulator: the leftover accumulator time hasn't been simulated yet. So we
+	// draw a step behind, blending from the previous snapshot to the latest with alpha = (accumulator + time since the snapshot) / step.
+	// That way the blend reaches the latest snapshot right about when the next one comes in. Positions and scales are blended linearly, and
+	// orientations with slerp. The bounds are the box around both snapshots' bounds, so they hold the object anywhere in between.
+	// Returns false (and leaves transforms and bounds alone) if nothing has been published yet.
+	bool Interpolate(double now, double step, std::vector<glm::mat4>& transforms, std::vector<AABB>& bounds);
+
+	// The same blend, but handing back the blended positions, orientations and scales themselves rather than building transforms from them,
+	// for a renderer that sends those to the GPU instead of matrices.
+	// With resting, each object also gets whether it's resting: asleep or static in the latest snapshot, and with the same pose and bounds in
+	// both, so the blend is the same whatever the time (and isn't worked out at all, just copied).
+	bool InterpolatePoses(double now, double step, std::vector<glm::vec3>& positions, std::vector<glm::quat>& orientations,
+		std::vector<glm::vec3>& scales, std::vector<AABB>& bounds, std::vector<unsigned char>* resting = nullptr);
+
+	// Copies the latest snapshot as it is (with no blending). Returns false (and leaves snapshot alone) if nothing has been published yet.
+	bool CopyLatest(PhysicsSnapshot& snapshot);
+};
+
+#endif //_PHYSICS_SNAPSHOT_H
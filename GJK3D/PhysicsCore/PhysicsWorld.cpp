@@ -0,0 +1,2870 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PhysicsWorld.cpp
+Copyright � 2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PHYSICS_WORLD_CPP
+#define _PHYSICS_WORLD_CPP
+
+#include "PhysicsWorld.h"
+#include "HullCache.h"
+#include "Profiler.h"
+#include "SIMDLanes.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+// The most objects updateShapes gathers up before building their OBBs. This is the same size as the transform stage's jobs, so each job is
+// usually one batch.
+static const int SHAPE_BLOCK = 64;
+
+// The furthest any point of a box with the given reach (how far its farthest point is from its transform's origin, before the transform)
+// can have moved going from one transform to another. The origin moves by the change in translation, and every other point by that plus
+// the change in the upper 3x3 times where it is, which is never more than the change's Frobenius norm times the reach.
+static float getMotionBound(const glm::mat4& from, const glm::mat4& to, float reach)
+{
+	float turn = 0.0f;
+
+	for (int column = 0; column < 3; column++)
+	{
+		glm::vec3 change = glm::vec3(to[column]) - glm::vec3(from[column]);
+		turn += glm::dot(change, change);
+	}
+
+	return glm::length(glm::vec3(to[3]) - glm::vec3(from[3])) + sqrtf(turn) * reach;
+}
+
+// How many islands each solve job takes. Most islands are a single pair, so one each would be more handing out jobs than solving.
+static const int ISLAND_GRAIN = 16;
+
+// How many proxies each of the broadphase's query jobs takes (both the AABB tree's changed proxies, and the objects looked up in the static
+// tree). Each query is only a microsecond or so.
+static const int PAIR_GRAIN = 256;
+
+// How many bodies each integrate job takes. This is a whole number of BODY_BLOCKs, so no two jobs write to the same cache line.
+static const int INTEGRATE_GRAIN = BODY_BLOCK * 4;
+
+PhysicsWorld::PhysicsWorld(int threadCount)
+{
+	jobs = new JobSystem(threadCount);
+	ownsJobs = true;
+
+	initialize();
+}
+
+PhysicsWorld::PhysicsWorld(JobSystem& sharedJobs)
+{
+	jobs = &sharedJobs;
+	ownsJobs = false;
+
+	initialize();
+}
+
+void PhysicsWorld::initialize()
+{
+	origin = glm::dvec3(0.0);
+
+	broadphase = &treeBroadphase;
+	broadphaseIndex = 0;
+
+	treeBroadphase.SetFilters(&filters);
+	sweepBroadphase.SetFilters(&filters);
+	gridBroadphase.SetFilters(&filters);
+	linearBroadphase.SetFilters(&filters);
+	staticTree.SetFilters(&filters);
+	staticTreeChanged = false;
+
+	pipelined = false;
+	predicting = false;
+
+	SetTreeRebuildInterval(60);
+	stepsSinceTreeRebuild = 0;
+	treeRebuilding = false;
+
+	treeOptimize = TreeOptimizeTask(&treeBroadphase);
+	treeOptimizeTask = maintenance.Add(&treeOptimize, 0);
+	maintenanceBudget = 0.0;
+
+	narrowphase = new Narrowphase<OBBShape>(jobs);
+	narrowphase->SetTriggers(&triggers);
+	narrowphase->SetSimplified(&farObjects);
+	pairCostCount = 0;
+	pairCostWindow = 60;
+	pairCostSteps = 0;
+	fastForward = false;
+	solvers.resize(jobs->GetThreadCount());
+	largeIslandContacts = 0;
+	threadStaticPairs.resize(jobs->GetThreadCount());
+
+	degraded = false;
+	deterministic = false;
+
+	continuous = true;
+	continuousThreshold = 1.0f;
+	sweptPairs = 0;
+	speculative = false;
+	speculativeContacts = 0;
+
+	sleepEnabled = true;
+	sleepVelocity = 0.05f;
+	sleepTime = 0.5f;
+
+	lodDistance = 0.0f;
+	lodInterval = 4;
+	lodSteps = 0;
+
+	slowIslandSpeed = 0.0f;
+	slowIslandInterval = 4;
+	rateSteps = 0;
+
+	pairCacheMaxAge = 60;
+
+	rayCastCapacity = 0;
+	rayCastCount = 0;
+	rayCastStep = 0;
+	rayCastHits = 0;
+	rayCastMisses = 0;
+
+	SetQuerySkipping(true);
+}
+
+PhysicsWorld::~PhysicsWorld()
+{
+	delete narrowphase;
+
+	if (ownsJobs)
+	{
+		delete jobs;
+	}
+}
+
+int PhysicsWorld::AddBox(const glm::vec3& center, const glm::vec3& halfExtents)
+{
+	return AddBox(center, halfExtents, glm::vec3(0.0f), glm::quat(), glm::vec3(1.0f));
+}
+
+int PhysicsWorld::AddBox(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& position, const glm::quat& orientation,
+	const glm::vec3& scale)
+{
+	int object = (int)handles.size();
+	const glm::mat4* oldTransforms = bodies.Transforms();
+	BodyHandle body = bodies.Create();
+
+	bodies.Position(body) = position;
+	bodies.Orientation(body) = orientation;
+	bodies.Scale(body) = scale;
+	bodies.MarkDirty(body);
+
+	handles.push_back(body);
+	boxCenters.push_back(center);
+	boxHalfExtents.push_back(halfExtents);
+	filters.push_back(CollisionFilter());
+	enabled.push_back(1);
+	disabledTypes.push_back(BODY_DYNAMIC);
+	triggers.push_back(0);
+	hulls.push_back(HullShape());
+
+	shapes.push_back(OBBShape());
+	shapeBounds.push_back(ShapeBounds());
+	transforms.push_back(nullptr);
+	shapeTransforms.push_back(glm::mat4());
+	fastObjects.push_back(0);
+	farObjects.push_back(0);
+	stepIntervals.push_back(1);
+	idleSteps.push_back(0);
+	shapeMotion.push_back(0.0f);
+	pendingMotion.push_back(0.0f);
+	proxyMoves.push_back(0);
+	predictMoves.push_back(0);
+	predictedBounds.push_back(AABB());
+	predictedTravel.push_back(glm::vec3(0.0f));
+	impacted.push_back(0);
+	stillTimes.push_back(0.0f);
+	islandFirst.push_back(-1);
+	islandNext.push_back(-1);
+	wakeRequests.push_back(0);
+	islandParents.push_back(object);
+	islandIds.push_back(-1);
+	islandStillTimes.push_back(0.0f);
+	islandLast.push_back(-1);
+	solverBodies.push_back(-1);
+
+	// Creating a body can move the BodyStore's arrays, and when it does every transform pointer has to be picked up again, not just the new
+	// one's. (Only doing it then keeps adding objects cheap, rather than going over every object each time, which adds up in big scenes.)
+	if (bodies.Transforms() != oldTransforms)
+	{
+		for (int i = 0; i < object; i++)
+		{
+			transforms[i] = &bodies.GetTransform(handles[i]);
+		}
+	}
+
+	updateShape(object);
+
+	// The proxy's user data is the object's number, which is what the pairs give back.
+	proxies.push_back(broadphase->CreateProxy(shapeBounds[object].box, object));
+	invalidateRayCasts(shapeBounds[object].box);
+
+	return object;
+}
+
+void PhysicsWorld::Reserve(int count)
+{
+	bodies.Reserve(count);
+
+	handles.reserve(count);
+	boxCenters.reserve(count);
+	boxHalfExtents.reserve(count);
+	filters.reserve(count);
+	enabled.reserve(count);
+	disabledTypes.reserve(count);
+	triggers.reserve(count);
+	hulls.reserve(count);
+	shapes.reserve(count);
+	shapeBounds.reserve(count);
+	transforms.reserve(count);
+	shapeTransforms.reserve(count);
+	proxies.reserve(count);
+	fastObjects.reserve(count);
+	farObjects.reserve(count);
+	stepIntervals.reserve(count);
+	idleSteps.reserve(count);
+	shapeMotion.reserve(count);
+	pendingMotion.reserve(count);
+	proxyMoves.reserve(count);
+	predictMoves.reserve(count);
+	predictedBounds.reserve(count);
+	predictedTravel.reserve(count);
+	sleepMoves.reserve(count);
+	impacted.reserve(count);
+	stillTimes.reserve(count);
+	islandFirst.reserve(count);
+	islandNext.reserve(count);
+	wakeRequests.reserve(count);
+	islandParents.reserve(count);
+	islandIds.reserve(count);
+	islandStillTimes.reserve(count);
+	islandLast.reserve(count);
+	solverBodies.reserve(count);
+}
+
+void PhysicsWorld::SetLimits(const PhysicsWorldLimits& newLimits)
+{
+	limits = newLimits;
+
+	int threads = jobs->GetThreadCount();
+
+	Reserve(limits.objects);
+
+	broadphase->Reserve(limits.objects, limits.pairs, threads);
+	staticTree.Reserve(limits.objects, 0, 1);
+	staticFlat.Reserve(limits.objects);
+
+	pairs.reserve(limits.pairs);
+	staticPairs.reserve(limits.pairs);
+	mergedPairs.reserve(limits.pairs);
+	predictedPairs.reserve(limits.pairs);
+	predictedRemovedPairs.reserve(limits.pairs);
+
+	for (int i = 0; i < (int)threadStaticPairs.size(); i++)
+	{
+		threadStaticPairs[i].reserve(limits.pairs);
+	}
+
+	// The cache still has the last step's pairs in it while it adds this step's (see Narrowphase's prepare), so it needs room for both.
+	pairCache.ReserveTotal(2 * limits.pairs);
+	narrowphase->Reserve(limits.pairs, limits.contacts);
+
+	contacts.reserve(limits.contacts);
+	contactEvents.reserve(limits.contacts);
+	overlaps.reserve(limits.pairs);
+	lastOverlaps.reserve(limits.pairs);
+	triggerEvents.reserve(limits.pairs);
+	impacts.reserve(limits.objects);
+	islandStarts.reserve(limits.contacts + 1);
+	islandContacts.reserve(limits.contacts);
+
+	for (int i = 0; i < (int)solvers.size(); i++)
+	{
+		solvers[i].Reserve(limits.objects, limits.contacts);
+	}
+
+	// Every batch of jobs a step submits, as if they were all queued at once. (A large island's colors are handed out a few blocks of
+	// points at a time, which is well under a job per SOLVER_LANES contacts.)
+	int stepJobs = limits.objects / 64 + limits.objects / INTEGRATE_GRAIN + 2 * (limits.objects / PAIR_GRAIN) +
+		limits.pairs / NARROWPHASE_LOOKUP_GRAIN + limits.pairs / glm::max(narrowphase->GetGrainSize(), 1) + limits.contacts / ISLAND_GRAIN +
+		limits.contacts / SOLVER_LANES;
+
+	jobs->Reserve(stepJobs + 64);
+
+	// The next step's queries, when the broadphase is pipelined (see SetPipelinedBroadphase), which aren't critical.
+	jobs->Reserve(limits.objects / PAIR_GRAIN + 64, JOB_NORMAL);
+}
+
+void PhysicsWorld::updateShape(int object)
+{
+	// Rather than transforming all 8 corners of the box, we just take the center, axes, and scale straight from the transform.
+	const glm::mat4& transform = bodies.GetTransform(handles[object]);
+
+	pendingMotion[object] += getMotionBound(shapeTransforms[object], transform, glm::length(boxCenters[object]) + glm::length(boxHalfExtents[object]));
+
+	shapes[object] = OBBShape(transform, boxCenters[object], boxHalfExtents[object]);
+	shapeBounds[object] = getShapeBounds(shapes[object]);
+	transforms[object] = &transform;
+	shapeTransforms[object] = transform;
+}
+
+void PhysicsWorld::updateShapes(int begin, int end)
+{
+	int moved[SHAPE_BLOCK];
+
+	for (int block = begin; block < end; block += SHAPE_BLOCK)
+	{
+		int blockEnd = std::min(block + SHAPE_BLOCK, end);
+		int numMoved = 0;
+
+		for (int i = block; i < blockEnd; i++)
+		{
+			const glm::mat4& transform = bodies.GetTransform(handles[i]);
+
+			transforms[i] = &transform;
+
+			if (transform != shapeTransforms[i])
+			{
+				pendingMotion[i] += getMotionBound(shapeTransforms[i], transform, glm::length(boxCenters[i]) + glm::length(boxHalfExtents[i]));
+
+				shapeTransforms[i] = transform;
+				moved[numMoved++] = i;
+
+				// A sleeping (or static) object doesn't move on its own, so something moved it by hand.
+				if (bodies.IsSleeping(handles[i]) || bodies.GetType(handles[i]) == BODY_STATIC)
+				{
+					wakeRequests[i] = 1;
+				}
+			}
+		}
+
+		BuildOBBShapes(moved, numMoved, transforms.data(), boxCenters.data(), boxHalfExtents.data(), shapes.data(), shapeBounds.data());
+
+		GJK_PROFILE_COUNT("shapes rebuilt", numMoved);
+	}
+}
+
+const char* PhysicsWorld::GetBroadphaseName(int index) const
+{
+	const Broadphase* broadphases[NUM_BROADPHASES] = { &treeBroadphase, &sweepBroadphase, &gridBroadphase, &linearBroadphase };
+
+	return broadphases[index]->GetName();
+}
+
+void PhysicsWorld::SetBroadphase(int index)
+{
+	Broadphase* broadphases[NUM_BROADPHASES] = { &treeBroadphase, &sweepBroadphase, &gridBroadphase, &linearBroadphase };
+	Broadphase* next = broadphases[index];
+
+	if (limits.objects > 0)
+	{
+		next->Reserve(limits.objects, limits.pairs, jobs->GetThreadCount());
+	}
+
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		// The static objects stay in their own tree, whichever broadphase is in use.
+		if (bodies.GetType(handles[i]) == BODY_STATIC)
+		{
+			continue;
+		}
+
+		broadphase->DestroyProxy(proxies[i]);
+
+		proxies[i] = next->CreateProxy(shapeBounds[i].box, i);
+	}
+
+	broadphase = next;
+	broadphaseIndex = index;
+	clearRayCasts();
+
+	// Putting every proxy in one at a time leaves the tree nowhere near as good as building it all at once.
+	if (index == 0)
+	{
+		treeBroadphase.Rebuild(jobs);
+		stepsSinceTreeRebuild = 0;
+	}
+
+	// Any pass over the tree that was going is over the wrong broadphase now, or has just been made pointless.
+	maintenance.Reset();
+}
+
+void PhysicsWorld::Refresh()
+{
+	updateShapes(0, (int)handles.size());
+	clearRayCasts();
+
+	for (int i = 0; i < (int)handles.size(); i++)
+	{
+		if (!enabled[i])
+		{
+			continue;
+		}
+
+		if (proxyBroadphase(i)->MoveProxy(proxies[i], shapeBounds[i].box, glm::vec3(0.0f)) && bodies.GetType(handles[i]) == BODY_STATIC)
+		{
+			staticTreeChanged = true;
+		}
+	}
+
+	if (broadphaseIndex == 0)
+	{
+		treeBroadphase.Rebuild(jobs);
+		stepsSinceTreeRebuild = 0;
+	}
+	else if (broadphaseIndex == 3)
+	{
+		// It's built again every step anyway, but this way it's there for queries before the first one.
+		linearBroadphase.Build(jobs);
+	}
+}
+
+void PhysicsWorld::ShiftOrigin(const glm::vec3& newOrigin)
+{
+	origin += glm::dvec3(newOrigin);
+
+	bodies.ShiftOrigin(newOrigin);
+	clearRayCasts();
+
+	// The transforms the shapes were built from are shifted exactly the way the bodies' were, so they still match and no shape gets built
+	// again (or looks like it was moved by hand).
+	for (int i = 0; i < (int)handles.size(); i++)
+	{
+		shapeTransforms[i][3].x -= newOrigin.x;
+		shapeTransforms[i][3].y -= newOrigin.y;
+		shapeTransforms[i][3].z -= newOrigin.z;
+
+		shapes[i].center -= newOrigin;
+		shapeBounds[i].box.min -= newOrigin;
+		shapeBounds[i].box.max -= newOrigin;
+		shapeBounds[i].center -= newOrigin;
+	}
+
+	broadphase->ShiftOrigin(newOrigin);
+	staticTree.ShiftOrigin(newOrigin);
+	staticTree.Flatten(staticFlat);
+
+	for (int i = 0; i < (int)kinematicTargets.size(); i++)
+	{
+		kinematicTargets[i].position -= newOrigin;
+	}
+
+	for (int i = 0; i < (int)interestPoints.size(); i++)
+	{
+		interestPoints[i] -= newOrigin;
+	}
+
+	// The last step's contacts, for whoever looks at them next. (The pair cache's manifolds keep their points in each object's own space,
+	// and work out where they are in the world again every step.)
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		contacts[i].contact.pointA -= newOrigin;
+		contacts[i].contact.pointB -= newOrigin;
+	}
+
+	for (int i = 0; i < (int)contactEvents.size(); i++)
+	{
+		contactEvents[i].point -= newOrigin;
+	}
+}
+
+void PhysicsWorld::SetBodyType(int object, BodyType type)
+{
+	BodyHandle body = handles[object];
+	BodyType old = bodies.GetType(body);
+
+	// Whatever it's asleep with is woken up along with it, since it may be about to start moving (or stop being something to rest on).
+	wakeIsland(object);
+
+	// A disabled object stays static (and out of every broadphase) until it's enabled, and only then becomes this.
+	if (!enabled[object])
+	{
+		disabledTypes[object] = type;
+	}
+	// Moving into or out of the static tree, so the proxy has to be where the object is now.
+	else if ((old == BODY_STATIC) != (type == BODY_STATIC))
+	{
+		updateShape(object);
+
+		proxyBroadphase(object)->DestroyProxy(proxies[object]);
+		bodies.SetType(body, type);
+		proxies[object] = proxyBroadphase(object)->CreateProxy(shapeBounds[object].box, object);
+		invalidateRayCasts(shapeBounds[object].box);
+
+		staticTreeChanged = true;
+	}
+
+	if (enabled[object])
+	{
+		bodies.SetType(body, type);
+	}
+
+	if (type == BODY_DYNAMIC)
+	{
+		if (bodies.InverseMass(body) == 0.0f)
+		{
+			bodies.InverseMass(body) = 1.0f;
+		}
+	}
+	else
+	{
+		bodies.InverseMass(body) = 0.0f;
+	}
+
+	if (type == BODY_STATIC)
+	{
+		bodies.Velocity(body) = glm::vec3(0.0f);
+		bodies.AngularVelocity(body) = glm::vec3(0.0f);
+		bodies.Acceleration(body) = glm::vec3(0.0f);
+	}
+}
+
+void PhysicsWorld::SetEnabled(int object, bool enable)
+{
+	if (enabled[object] == (enable ? 1 : 0))
+	{
+		return;
+	}
+
+	BodyHandle body = handles[object];
+
+	if (!enable)
+	{
+		// Anything that was resting on it has to find out it's gone, and so does any ray it was in the way of.
+		wakeIsland(object);
+		invalidateRayCasts(shapeBounds[object].box);
+
+		proxyBroadphase(object)->DestroyProxy(proxies[object]);
+		proxies[object] = -1;
+
+		if (bodies.GetType(body) == BODY_STATIC)
+		{
+			staticTreeChanged = true;
+		}
+
+		// A static body isn't integrated, and never goes to sleep, so the step doesn't touch it at all.
+		disabledTypes[object] = bodies.GetType(body);
+		bodies.SetType(body, BODY_STATIC);
+		enabled[object] = 0;
+	}
+	else
+	{
+		bodies.SetType(body, disabledTypes[object]);
+		enabled[object] = 1;
+
+		// Its body may have been moved while it was disabled, so the proxy is made wherever it is now.
+		updateShape(object);
+		proxies[object] = proxyBroadphase(object)->CreateProxy(shapeBounds[object].box, object);
+		invalidateRayCasts(shapeBounds[object].box);
+
+		if (disabledTypes[object] == BODY_STATIC)
+		{
+			staticTreeChanged = true;
+		}
+	}
+}
+
+void PhysicsWorld::SetBox(int object, const glm::vec3& center, const glm::vec3& halfExtents)
+{
+	boxCenters[object] = center;
+	boxHalfExtents[object] = halfExtents;
+
+	// The transform hasn't changed, so the step wouldn't notice; the shape and proxy are brought up to date here instead. The new box could
+	// reach anywhere, so none of its pairs can be skipped next step.
+	updateShape(object);
+	pendingMotion[object] = FLT_MAX;
+
+	if (!enabled[object])
+	{
+		return;
+	}
+
+	wakeIsland(object);
+	invalidateRayCasts(shapeBounds[object].box);
+
+	if (proxyBroadphase(object)->MoveProxy(proxies[object], shapeBounds[object].box, glm::vec3(0.0f)) &&
+		bodies.GetType(handles[object]) == BODY_STATIC)
+	{
+		staticTreeChanged = true;
+	}
+}
+
+void PhysicsWorld::Cull(const Frustum& frustum, std::vector<int>& visible)
+{
+	broadphase->Cull(frustum, visible);
+
+	// Cull clears what it's given, so the static objects go in another vector first.
+	staticTree.Cull(frustum, visibleStatic);
+
+	visible.insert(visible.end(), visibleStatic.begin(), visibleStatic.end());
+}
+
+void PhysicsWorld::Cull(const Frustum& frustum, std::vector<int>& visible, std::vector<int>& visibleStatic) const
+{
+	broadphase->Cull(frustum, visible);
+	staticTree.Cull(frustum, visibleStatic);
+
+	visible.insert(visible.end(), visibleStatic.begin(), visibleStatic.end());
+}
+
+void PhysicsWorld::SetRayCastCache(int capacity)
+{
+	rayCastCapacity = capacity > 0 ? capacity : 0;
+	rayCastHits = 0;
+	rayCastMisses = 0;
+
+	clearRayCasts();
+}
+
+bool PhysicsWorld::cachedRayCast(const glm::vec3& from, const glm::vec3& to, PhysicsCastHit& hit)
+{
+	AABB box(glm::min(from, to), glm::max(from, to));
+
+	// Any ray that's exactly the same has exactly the same box, so it's one of the rays whose boxes overlap this one.
+	int found = -1;
+
+	auto findRay = [this, &from, &to, &found](int proxy) -> bool
+	{
+		const CachedRayCast& ray = rayCasts[rayCastTree.GetUserData(proxy)];
+
+		if (ray.from == from && ray.to == to)
+		{
+			found = rayCastTree.GetUserData(proxy);
+			return false;
+		}
+
+		return true;
+	};
+
+	rayCastTree.Query(box, findRay);
+
+	if (found != -1)
+	{
+		CachedRayCast& ray = rayCasts[found];
+		bool unchanged = true;
+
+		// Nothing new has come near it (or it would have been dropped), but what was near it could have moved without its proxy moving.
+		for (int i = 0; i < (int)ray.candidates.size() && unchanged; i++)
+		{
+			unchanged = memcmp(&shapes[ray.candidates[i]], &ray.candidateShapes[i], sizeof(OBBShape)) == 0;
+		}
+
+		if (unchanged)
+		{
+			ray.lastUsed = rayCastStep;
+			rayCastHits++;
+
+			hit = ray.hit;
+			return hit.object != -1;
+		}
+
+		removeRayCast(found);
+	}
+
+	rayCastMisses++;
+
+	bool result = CastShape(SphereShape(from, 0.0f), to - from, hit);
+
+	if (rayCastCount >= rayCastCapacity)
+	{
+		return result;
+	}
+
+	// The cast leaves the broadphase's candidates (and the static ones) in castCandidates.
+	int entry;
+
+	if (!freeRayCasts.empty())
+	{
+		entry = freeRayCasts.back();
+		freeRayCasts.pop_back();
+	}
+	else
+	{
+		entry = (int)rayCasts.size();
+		rayCasts.push_back(CachedRayCast());
+	}
+
+	CachedRayCast& ray = rayCasts[entry];
+	ray.from = from;
+	ray.to = to;
+	ray.hit = hit;
+	ray.proxy = rayCastTree.CreateProxy(box, entry);
+	ray.lastUsed = rayCastStep;
+	ray.candidates = castCandidates;
+	ray.candidateShapes.resize(castCandidates.size());
+
+	for (int i = 0; i < (int)castCandidates.size(); i++)
+	{
+		ray.candidateShapes[i] = shapes[castCandidates[i]];
+	}
+
+	rayCastCount++;
+
+	return result;
+}
+
+void PhysicsWorld::invalidateRayCasts(const AABB& bounds)
+{
+	if (rayCastCount == 0)
+	{
+		return;
+	}
+
+	// The proxies can't be taken out of the tree while it's being gone through, so they're found first.
+	rayCastsFound.clear();
+
+	auto findRays = [this](int proxy) -> bool
+	{
+		rayCastsFound.push_back(rayCastTree.GetUserData(proxy));
+		return true;
+	};
+
+	rayCastTree.Query(bounds, findRays);
+
+	for (int i = 0; i < (int)rayCastsFound.size(); i++)
+	{
+		removeRayCast(rayCastsFound[i]);
+	}
+}
+
+void PhysicsWorld::removeRayCast(int entry)
+{
+	CachedRayCast& ray = rayCasts[entry];
+
+	rayCastTree.DestroyProxy(ray.proxy);
+	ray.proxy = -1;
+
+	freeRayCasts.push_back(entry);
+	rayCastCount--;
+}
+
+void PhysicsWorld::clearRayCasts()
+{
+	for (int i = 0; i < (int)rayCasts.size(); i++)
+	{
+		if (rayCasts[i].proxy != -1)
+		{
+			removeRayCast(i);
+		}
+	}
+}
+
+void PhysicsWorld::ageRayCasts()
+{
+	rayCastStep++;
+
+	if (rayCastCount == 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < (int)rayCasts.size(); i++)
+	{
+		if (rayCasts[i].proxy != -1 && rayCastStep - rayCasts[i].lastUsed > RAY_CAST_IDLE_STEPS)
+		{
+			removeRayCast(i);
+		}
+	}
+}
+
+void PhysicsWorld::OverlapSphere(const glm::vec3& center, float radius, std::vector<int>& objects, std::vector<float>* distances)
+{
+	objects.clear();
+
+	if (distances != nullptr)
+	{
+		distances->clear();
+	}
+
+	// A segment that goes nowhere, grown by radius, is the sphere's box. The static objects aren't in the broadphase, so they're looked up
+	// separately and added on.
+	broadphase->CastSegment(center, center, glm::vec3(radius), castCandidates);
+	staticTree.CastSegment(center, center, glm::vec3(radius), castStaticCandidates);
+	castCandidates.insert(castCandidates.end(), castStaticCandidates.begin(), castStaticCandidates.end());
+
+	int count = (int)castCandidates.size();
+	int padded = (count + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+
+	for (int f = 0; f < OVERLAP_BOX_FLOATS; f++)
+	{
+		overlapBoxes[f].resize(padded);
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		const OBBShape& box = shapes[castCandidates[i]];
+
+		for (int a = 0; a < 3; a++)
+		{
+			overlapBoxes[a][i] = box.center[a];
+			overlapBoxes[3 + a][i] = box.axes[0][a];
+			overlapBoxes[6 + a][i] = box.axes[1][a];
+			overlapBoxes[9 + a][i] = box.axes[2][a];
+			overlapBoxes[12 + a][i] = box.halfExtents[a];
+		}
+	}
+
+	// The squared distance from center to each box, the same way closestPointOnBox finds it: the offset from the box's center along each of
+	// its axes, and how far that is past the half extent (or 0 if it isn't).
+	Lanes centerX = laneSet(center.x), centerY = laneSet(center.y), centerZ = laneSet(center.z);
+	Lanes zero = laneSet(0.0f);
+	Lanes radiusSquared = laneSet(radius * radius);
+	float squaredDistances[LANE_COUNT];
+
+	for (int first = 0; first < count; first += LANE_COUNT)
+	{
+		Lanes offsetX = centerX - laneLoad(overlapBoxes[0].data() + first);
+		Lanes offsetY = centerY - laneLoad(overlapBoxes[1].data() + first);
+		Lanes offsetZ = centerZ - laneLoad(overlapBoxes[2].data() + first);
+		Lanes squared = zero;
+
+		for (int a = 0; a < 3; a++)
+		{
+			Lanes along = offsetX * laneLoad(overlapBoxes[3 + 3 * a].data() + first) + offsetY * laneLoad(overlapBoxes[4 + 3 * a].data() + first) +
+				offsetZ * laneLoad(overlapBoxes[5 + 3 * a].data() + first);
+			Lanes past = laneMax(laneAbs(along) - laneLoad(overlapBoxes[12 + a].data() + first), zero);
+
+			squared = squared + past * past;
+		}
+
+		int mask = laneLessEqual(squared, radiusSquared);
+
+		// The padding past the last candidate is whatever was there before, so its lanes are left out.
+		if (count - first < LANE_COUNT)
+		{
+			mask &= (1 << (count - first)) - 1;
+		}
+
+		laneStore(squaredDistances, squared);
+
+		while (mask != 0)
+		{
+			int lane = lowestSetBit(mask);
+			mask &= mask - 1;
+
+			objects.push_back(castCandidates[first + lane]);
+
+			if (distances != nullptr)
+			{
+				distances->push_back(sqrtf(squaredDistances[lane]));
+			}
+		}
+	}
+}
+
+int PhysicsWorld::Explode(const PhysicsExplosion* explosions, int count, std::vector<PhysicsExplosionHit>* hits)
+{
+	explosionHits.clear();
+
+	for (int e = 0; e < count; e++)
+	{
+		const PhysicsExplosion& explosion = explosions[e];
+
+		if (explosion.radius <= 0.0f)
+		{
+			continue;
+		}
+
+		OverlapSphere(explosion.center, explosion.radius, explosionObjects, &explosionDistances);
+
+		for (int i = 0; i < (int)explosionObjects.size(); i++)
+		{
+			int object = explosionObjects[i];
+			BodyHandle body = handles[object];
+
+			if (bodies.GetType(body) != BODY_DYNAMIC || bodies.InverseMass(body) == 0.0f)
+			{
+				continue;
+			}
+
+			glm::vec3 away = shapes[object].center - explosion.center;
+			float length = glm::length(away);
+			float falloff = 1.0f - explosionDistances[i] / explosion.radius;
+
+			PhysicsExplosionHit hit;
+			hit.explosion = e;
+			hit.object = object;
+			hit.distance = explosionDistances[i];
+			hit.impulse = (length > 0.0f ? away / length : glm::vec3(0.0f, 1.0f, 0.0f)) * (explosion.impulse * falloff);
+
+			explosionHits.push_back(hit);
+		}
+	}
+
+	// Every impulse goes on at once, now that nothing else is going to look at the velocities. Waking an island that's already awake costs
+	// nothing, so one that several explosions reach isn't any trouble.
+	for (int i = 0; i < (int)explosionHits.size(); i++)
+	{
+		const PhysicsExplosionHit& hit = explosionHits[i];
+		BodyHandle body = handles[hit.object];
+
+		wakeIsland(hit.object);
+		bodies.Velocity(body) += hit.impulse * bodies.InverseMass(body);
+	}
+
+	if (hits != nullptr)
+	{
+		*hits = explosionHits;
+	}
+
+	return (int)explosionHits.size();
+}
+
+void PhysicsWorld::ApplyKinematicTargets(float dt)
+{
+	for (int i = 0; i < (int)kinematicTargets.size(); i++)
+	{
+		const KinematicTarget& target = kinematicTargets[i];
+		BodyHandle body = handles[target.object];
+
+		if (bodies.GetType(body) != BODY_KINEMATIC)
+		{
+			continue;
+		}
+
+		// Integrating this velocity over the step ends up exactly at the target. (The transform stage wakes it up if it was asleep.)
+		bodies.Velocity(body) = (target.position - bodies.Position(body)) / dt;
+		bodies.Acceleration(body) = glm::vec3(0.0f);
+
+		bodies.Orientation(body) = target.orientation;
+		bodies.MarkDirty(body);
+	}
+
+	kinematicTargets.clear();
+}
+
+void PhysicsWorld::ApplyCommands()
+{
+	PhysicsCommand command;
+
+	while (commands.Pop(command))
+	{
+		if (command.type == COMMAND_ADD_BOX)
+		{
+			int object = AddBox(command.center, command.halfExtents, command.vector, command.orientation, command.scale);
+
+			if (command.result != nullptr)
+			{
+				command.result->store(object, std::memory_order_release);
+			}
+
+			continue;
+		}
+
+		if (command.object < 0 || command.object >= NumObjects())
+		{
+			continue;
+		}
+
+		BodyHandle body = handles[command.object];
+
+		switch (command.type)
+		{
+		case COMMAND_ENABLE:
+			SetEnabled(command.object, true);
+			break;
+		case COMMAND_DISABLE:
+			SetEnabled(command.object, false);
+			break;
+		case COMMAND_SET_POSITION:
+			bodies.Position(body) = command.vector;
+			bodies.MarkDirty(body);
+			break;
+		case COMMAND_SET_ORIENTATION:
+			bodies.Orientation(body) = command.orientation;
+			bodies.MarkDirty(body);
+			break;
+		case COMMAND_SET_VELOCITY:
+			bodies.Velocity(body) = command.vector;
+			break;
+		case COMMAND_SET_ANGULAR_VELOCITY:
+			bodies.AngularVelocity(body) = command.vector;
+			break;
+		case COMMAND_SET_BODY_TYPE:
+			SetBodyType(command.object, (BodyType)command.bodyType);
+			break;
+		case COMMAND_SET_KINEMATIC_TARGET:
+			SetKinematicTarget(command.object, command.vector, command.orientation);
+			break;
+		default:
+			break;
+		}
+
+		// Whatever was done to it, a sleeping body has to be woken up to notice.
+		if (command.type >= COMMAND_SET_POSITION && command.type <= COMMAND_SET_ANGULAR_VELOCITY && enabled[command.object])
+		{
+			WakeUp(command.object);
+		}
+	}
+}
+
+AABB PhysicsWorld::proxyBounds(int object, float dt)
+{
+	AABB bounds = shapeBounds[object].box;
+
+	// A fast object's bounds cover everywhere it goes this step, so the broadphase pairs it with anything it might pass through. (Spinning
+	// can take any corner up to spinSpeed * dt further out, whichever way.)
+	if (fastObjects[object])
+	{
+		glm::vec3 travel = stepVelocity(object, dt) * dt;
+		glm::vec3 spin = glm::vec3(spinSpeed(object) * dt);
+
+		bounds.min += glm::min(travel, glm::vec3(0.0f)) - spin;
+		bounds.max += glm::max(travel, glm::vec3(0.0f)) + spin;
+	}
+
+	return bounds;
+}
+
+void PhysicsWorld::findStaticPairs(int begin, int end, int thread)
+{
+	std::vector<BroadphasePair>& found = threadStaticPairs[thread];
+
+	for (int i = begin; i < end; i++)
+	{
+		if (bodies.GetType(handles[i]) == BODY_STATIC)
+		{
+			continue;
+		}
+
+		// The object's fat bounds already cover how far it's going this step (and all of the way, if it's fast).
+		auto addPair = [this, i, &found](int proxy)
+		{
+			int other = staticTree.GetUserData(proxy);
+
+			if (staticTree.CanPair(i, other))
+			{
+				found.push_back(BroadphasePair(i, other));
+			}
+
+			return true;
+		};
+
+		staticFlat.Query(broadphase->GetFatBounds(proxies[i]), addPair);
+	}
+}
+
+void PhysicsWorld::mergeStaticPairs()
+{
+	staticPairs.clear();
+
+	for (int i = 0; i < (int)threadStaticPairs.size(); i++)
+	{
+		staticPairs.insert(staticPairs.end(), threadStaticPairs[i].begin(), threadStaticPairs[i].end());
+		threadStaticPairs[i].clear();
+	}
+
+	// The same as the broadphases' own: any thread could find all of them next time.
+	for (int i = 0; i < (int)threadStaticPairs.size(); i++)
+	{
+		threadStaticPairs[i].reserve(staticPairs.size());
+	}
+
+	if (staticPairs.empty())
+	{
+		return;
+	}
+
+	// Both lists are sorted with no duplicates (a static object is never in the broadphase, so the two never share a pair), so merging them
+	// keeps the pairs sorted for the narrowphase. (Sorting also undoes any difference in which thread happened to find which pair.)
+	SortPairs(staticPairs, mergedPairs);
+
+	mergedPairs.resize(pairs.size() + staticPairs.size());
+	std::merge(pairs.begin(), pairs.end(), staticPairs.begin(), staticPairs.end(), mergedPairs.begin());
+	pairs.swap(mergedPairs);
+}
+
+void PhysicsWorld::SetSleeping(bool enabled, float velocity, float time)
+{
+	sleepEnabled = enabled;
+	sleepVelocity = velocity;
+	sleepTime = time;
+
+	if (!enabled)
+	{
+		for (int i = 0; i < (int)handles.size(); i++)
+		{
+			wakeIsland(i);
+		}
+	}
+}
+
+void PhysicsWorld::resolve(const NarrowphaseContact& contact, ContactSolver& solver, float dt)
+{
+	BodyHandle bodyA = handles[contact.a];
+	BodyHandle bodyB = handles[contact.b];
+	float inverseMassA = bodies.InverseMass(bodyA);
+	float inverseMassB = bodies.InverseMass(bodyB);
+	float inverseMassSum = inverseMassA + inverseMassB;
+
+	// Neither object can move, or one is still asleep because the other was only resting on it (see canWake).
+	if (inverseMassSum <= 0.0f || bodies.IsSleeping(bodyA) || bodies.IsSleeping(bodyB))
+	{
+		return;
+	}
+
+	// Push the objects back out along the normal, so they aren't still inside each other next update. Each one goes its share of the way
+	// by inverse mass, so an object that can't be moved stays put and the other one is pushed all the way out. (A speculative contact isn't
+	// inside anything yet: that's left to the solver, which only lets them close the gap.)
+	if (!contact.speculative)
+	{
+		glm::vec3 push = contact.contact.normal * (contact.contact.depth / inverseMassSum);
+
+		if (inverseMassA > 0.0f)
+		{
+			bodies.Position(bodyA) -= push * inverseMassA;
+			bodies.MarkDirty(bodyA);
+		}
+		if (inverseMassB > 0.0f)
+		{
+			bodies.Position(bodyB) += push * inverseMassB;
+			bodies.MarkDirty(bodyB);
+		}
+	}
+
+	// The velocities are left to the solver, once it has every contact in the island. A far object that's moving this step moves through
+	// more than dt (see SetLevelOfDetail), and so does its contact. (One that isn't moving has no time at all, so the other object's is used.)
+	float contactStep = glm::max(objectStep(contact.a, dt), objectStep(contact.b, dt));
+
+	solver.Add(contact, solverBody(contact.a, solver), solverBody(contact.b, solver), contactStep);
+}
+
+void PhysicsWorld::resolveIsland(int island, ContactSolver& solver, float dt)
+{
+	for (int i = islandStarts[island]; i < islandStarts[island + 1]; i++)
+	{
+		resolve(contacts[islandContacts[i]], solver, dt);
+	}
+}
+
+void PhysicsWorld::forgetSolverBodies(int island)
+{
+	// Objects that can't move never get a number, and can be in other threads' islands too, so they're only read.
+	for (int i = islandStarts[island]; i < islandStarts[island + 1]; i++)
+	{
+		const NarrowphaseContact& contact = contacts[islandContacts[i]];
+
+		if (solverBodies[contact.a] != -1)
+		{
+			solverBodies[contact.a] = -1;
+		}
+		if (solverBodies[contact.b] != -1)
+		{
+			solverBodies[contact.b] = -1;
+		}
+	}
+}
+
+int PhysicsWorld::solverBody(int object, ContactSolver& solver)
+{
+	BodyHandle body = handles[object];
+
+	// An object that can't move is never written to, so it's added fresh for every contact (see ContactSolver::AddBody).
+	if (solverBodies[object] != -1 && bodies.InverseMass(body) > 0.0f)
+	{
+		return solverBodies[object];
+	}
+
+	SolverBody solverBody;
+	solverBody.velocity = &bodies.Velocity(body);
+	solverBody.acceleration = bodies.Acceleration(body);
+	solverBody.inverseMass = bodies.InverseMass(body);
+
+	int index = solver.AddBody(solverBody);
+
+	if (solverBody.inverseMass > 0.0f)
+	{
+		solverBodies[object] = index;
+	}
+
+	return index;
+}
+
+void PhysicsWorld::bounce(int a, int b, const glm::vec3& normal)
+{
+	BodyHandle bodyA = handles[a];
+	BodyHandle bodyB = handles[b];
+	glm::vec3 velocityA = bodies.Velocity(bodyA);
+	glm::vec3 velocityB = bodies.Velocity(bodyB);
+
+	// Reflect the velocities about the collision normal. This is the "bounce", now along the actual axis of collision.
+	// We only bounce an object if it's moving into the other one; if it's already moving away, pushing it out was enough.
+	float approachA = glm::dot(velocityA, -normal);
+	float approachB = glm::dot(velocityB, normal);
+
+	// Something with an infinite mass doesn't bounce off anything.
+	if (bodies.InverseMass(bodyA) == 0.0f)
+	{
+		approachA = 0.0f;
+	}
+	if (bodies.InverseMass(bodyB) == 0.0f)
+	{
+		approachB = 0.0f;
+	}
+
+	if (approachA < 0.0f)
+	{
+		bodies.Velocity(bodyA) = velocityA + 2.0f * approachA * normal;
+	}
+	if (approachB < 0.0f)
+	{
+		bodies.Velocity(bodyB) = velocityB - 2.0f * approachB * normal;
+	}
+}
+
+glm::vec3 PhysicsWorld::stepVelocity(int object, float dt)
+{
+	BodyHandle body = handles[object];
+
+	return bodies.Velocity(body) + bodies.Acceleration(body) * dt;
+}
+
+float PhysicsWorld::spinSpeed(int object)
+{
+	return glm::length(bodies.AngularVelocity(handles[object])) * glm::length(shapes[object].halfExtents);
+}
+
+bool PhysicsWorld::isFast(int object, float dt)
+{
+	const glm::vec3& halfExtents = shapes[object].halfExtents;
+	float smallest = glm::min(halfExtents.x, glm::min(halfExtents.y, halfExtents.z));
+	float travel = (glm::length(stepVelocity(object, dt)) + spinSpeed(object)) * dt;
+
+	return continuous && travel > continuousThreshold * smallest;
+}
+
+bool PhysicsWorld::isFar(int object)
+{
+	// Static objects don't move anyway, and kinematic ones are steered a step at a time.
+	if (!enabled[object] || bodies.GetType(handles[object]) != BODY_DYNAMIC)
+	{
+		return false;
+	}
+
+	const glm::vec3& center = shapeBounds[object].center;
+
+	for (int i = 0; i < (int)interestPoints.size(); i++)
+	{
+		glm::vec3 offset = center - interestPoints[i];
+
+		if (glm::dot(offset, offset) <= lodDistance * lodDistance)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void PhysicsWorld::sweep(float dt)
+{
+	GJK_PROFILE_ZONE("sweep");
+
+	impacts.clear();
+	sweptPairs = 0;
+	int sweptRejected = 0;
+
+	for (int i = 0; i < (int)pairs.size(); i++)
+	{
+		int a = pairs[i].a;
+		int b = pairs[i].b;
+
+		// Nothing bounces off a trigger, so there's nothing for a fast object to hit in one either.
+		if ((!fastObjects[a] && !fastObjects[b]) || triggers[a] || triggers[b])
+		{
+			continue;
+		}
+
+		// A pair that's already colliding has been pushed apart and bounced, so there's nothing left for it to hit.
+		NarrowphaseContact key;
+		key.a = a;
+		key.b = b;
+
+		if (std::binary_search(contacts.begin(), contacts.end(), key))
+		{
+			continue;
+		}
+
+		sweptPairs++;
+
+		// Each box moves at its velocity and spins about its center at its angular velocity, the same as Integrate is about to move it.
+		ShapeMotion motionA(stepVelocity(a, dt), bodies.AngularVelocity(handles[a]), glm::length(shapes[a].halfExtents));
+		ShapeMotion motionB(stepVelocity(b, dt), bodies.AngularVelocity(handles[b]), glm::length(shapes[b].halfExtents));
+		TimeOfImpactResult result;
+
+		// Most fast pairs are only here because a fast object's bounds were stretched over its whole step, and never get near each other.
+		if (!timeOfImpact.MightHit(shapes[a], motionA, shapes[b], motionB, dt))
+		{
+			sweptRejected++;
+			continue;
+		}
+
+		if (timeOfImpact.TimeOfImpact(shapes[a], motionA, shapes[b], motionB, dt, result))
+		{
+			SweptImpact impact;
+			impact.a = a;
+			impact.b = b;
+			impact.time = result.time;
+			impact.normal = result.normal;
+
+			impacts.push_back(impact);
+		}
+	}
+
+	GJK_PROFILE_COUNT("swept pairs", sweptPairs);
+	GJK_PROFILE_COUNT("swept pairs rejected", sweptRejected);
+	GJK_PROFILE_COUNT("swept impacts", (long long)impacts.size());
+
+	// Earliest first, since an object's first impact changes where it goes after that. The pairs come in sorted, so a stable sort keeps ties
+	// in the same order every time.
+	std::stable_sort(impacts.begin(), impacts.end());
+
+	for (int i = 0; i < (int)impacts.size(); i++)
+	{
+		const SweptImpact& impact = impacts[i];
+
+		// Once an object has bounced, its other impacts were worked out for a path it's no longer on. They'll be found again next step
+		// if they still happen.
+		if (impacted[impact.a] || impacted[impact.b])
+		{
+			continue;
+		}
+
+		impacted[impact.a] = 1;
+		impacted[impact.b] = 1;
+
+		wakeIsland(impact.a);
+		wakeIsland(impact.b);
+
+		BodyHandle bodyA = handles[impact.a];
+		BodyHandle bodyB = handles[impact.b];
+		glm::vec3 before[2] = { bodies.Velocity(bodyA), bodies.Velocity(bodyB) };
+
+		bounce(impact.a, impact.b, impact.normal);
+
+		// Integrate is going to move each object by its new velocity for the whole step. Shifting it by the difference between its old and
+		// new velocities over the time before the impact means it ends up where it would be moving the old way up to the impact and the new
+		// way after it.
+		bodies.Position(bodyA) += (before[0] - bodies.Velocity(bodyA)) * impact.time;
+		bodies.Position(bodyB) += (before[1] - bodies.Velocity(bodyB)) * impact.time;
+
+		bodies.MarkDirty(bodyA);
+		bodies.MarkDirty(bodyB);
+	}
+
+	for (int i = 0; i < (int)impacts.size(); i++)
+	{
+		impacted[impacts[i].a] = 0;
+		impacted[impacts[i].b] = 0;
+	}
+}
+
+void PhysicsWorld::addSpeculativeContacts(float dt)
+{
+	GJK_PROFILE_ZONE("speculative contacts");
+
+	int touching = (int)contacts.size();
+
+	sweptPairs = 0;
+
+	for (int i = 0; i < (int)pairs.size(); i++)
+	{
+		int a = pairs[i].a;
+		int b = pairs[i].b;
+
+		// The same pairs sweep would have tested: ones with a fast object in them that aren't triggers and aren't already colliding.
+		if ((!fastObjects[a] && !fastObjects[b]) || triggers[a] || triggers[b])
+		{
+			continue;
+		}
+
+		NarrowphaseContact key;
+		key.a = a;
+		key.b = b;
+
+		if (std::binary_search(contacts.begin(), contacts.begin() + touching, key))
+		{
+			continue;
+		}
+
+		sweptPairs++;
+
+		// The narrowphase has already looked this pair up, so this doesn't add a state (which could move the ones the contacts point to).
+		PairState& state = pairCache.FindState(a, b);
+		GJKDistanceResult result;
+
+		distanceSolver.Distance(shapes[a], shapes[b], result, &state.cache);
+
+		if (result.overlapping)
+		{
+			continue;
+		}
+
+		// How fast the gap is closing: the objects' velocities along the normal, and the most their spinning could bring their corners
+		// in by (the same bound the time of impact query uses).
+		glm::vec3 relative = stepVelocity(b, dt) - stepVelocity(a, dt);
+		float closing = -glm::dot(relative, result.normal) + spinSpeed(a) + spinSpeed(b);
+
+		if (result.distance >= closing * dt)
+		{
+			continue;
+		}
+
+		NarrowphaseContact contact;
+		contact.a = a;
+		contact.b = b;
+		contact.contact.normal = result.normal;
+		contact.contact.pointA = result.pointA;
+		contact.contact.pointB = result.pointB;
+		contact.contact.depth = -result.distance;
+		contact.manifold = &state.manifold;
+		contact.speculative = true;
+
+		state.manifold.Add(contact.contact, *transforms[a], *transforms[b]);
+
+		contacts.push_back(contact);
+	}
+
+	speculativeContacts = (int)contacts.size() - touching;
+
+	GJK_PROFILE_COUNT("speculative contacts", speculativeContacts);
+
+	// Both halves are sorted by pair, and no pair is in both, so this keeps the contacts (and so the islands) in the same order every time.
+	std::inplace_merge(contacts.begin(), contacts.begin() + touching, contacts.end());
+}
+
+bool PhysicsWorld::isSleepingPair(const BroadphasePair& pair)
+{
+	BodyHandle a = handles[pair.a];
+	BodyHandle b = handles[pair.b];
+
+	// A trigger has to keep seeing what's in it, even once everything has gone to sleep, or it would look like it all left.
+	if (triggers[pair.a] || triggers[pair.b])
+	{
+		return false;
+	}
+
+	// A static object never moves, so to its pair it may as well be asleep, and neither does a far object in the steps it's left out of.
+	bool restingA = bodies.IsSleeping(a) || bodies.GetType(a) == BODY_STATIC || bodies.GetTimeScale(a) == 0.0f;
+	bool restingB = bodies.IsSleeping(b) || bodies.GetType(b) == BODY_STATIC || bodies.GetTimeScale(b) == 0.0f;
+
+	if (restingA && restingB)
+	{
+		return true;
+	}
+
+	return degraded && bodies.Velocity(a) == glm::vec3(0.0f) && bodies.Acceleration(a) == glm::vec3(0.0f) &&
+		bodies.AngularVelocity(a) == glm::vec3(0.0f) && bodies.Velocity(b) == glm::vec3(0.0f) &&
+		bodies.Acceleration(b) == glm::vec3(0.0f) && bodies.AngularVelocity(b) == glm::vec3(0.0f);
+}
+
+int PhysicsWorld::findIsland(int object)
+{
+	// Path halving: point each object we pass at its grandparent, so the next search is shorter.
+	while (islandParents[object] != object)
+	{
+		islandParents[object] = islandParents[islandParents[object]];
+		object = islandParents[object];
+	}
+
+	return object;
+}
+
+int PhysicsWorld::contactIsland(const NarrowphaseContact& contact)
+{
+	// A contact with an object that can't be moved goes in the other object's island.
+	return findIsland(bodies.InverseMass(handles[contact.a]) > 0.0f ? contact.a : contact.b);
+}
+
+void PhysicsWorld::buildTriggerEvents()
+{
+	triggerEvents.clear();
+
+	// Both lists are sorted, so walking them together finds the pairs that are only in the old one (exits), only in the new one (enters),
+	// or in both (stays).
+	int last = 0;
+	int now = 0;
+
+	while (last < (int)lastOverlaps.size() || now < (int)overlaps.size())
+	{
+		TriggerEvent event;
+
+		if (now == (int)overlaps.size() || (last < (int)lastOverlaps.size() && lastOverlaps[last] < overlaps[now]))
+		{
+			event.a = lastOverlaps[last].a;
+			event.b = lastOverlaps[last].b;
+			event.type = TRIGGER_EXIT;
+			last++;
+		}
+		else if (last == (int)lastOverlaps.size() || overlaps[now] < lastOverlaps[last])
+		{
+			event.a = overlaps[now].a;
+			event.b = overlaps[now].b;
+			event.type = TRIGGER_ENTER;
+			now++;
+		}
+		else
+		{
+			event.a = overlaps[now].a;
+			event.b = overlaps[now].b;
+			event.type = TRIGGER_STAY;
+			last++;
+			now++;
+		}
+
+		triggerEvents.push_back(event);
+	}
+}
+
+void PhysicsWorld::buildContactEvents()
+{
+	// The contacts are already sorted by pair, so the events are too. The speculative contacts haven't hit anything yet.
+	contactEvents.resize(contacts.size() - speculativeContacts);
+
+	for (int i = 0, next = 0; i < (int)contacts.size(); i++)
+	{
+		const NarrowphaseContact& contact = contacts[i];
+
+		if (contact.speculative)
+		{
+			continue;
+		}
+
+		const ContactManifold& manifold = *contact.manifold;
+		ContactEvent& event = contactEvents[next++];
+
+		event.a = contact.a;
+		event.b = contact.b;
+		event.bodyA = handles[contact.a];
+		event.bodyB = handles[contact.b];
+		event.normal = contact.contact.normal;
+		event.point = (contact.contact.pointA + contact.contact.pointB) * 0.5f;
+		event.impulse = 0.0f;
+
+		// The solver leaves each point's impulse in the manifold, so the total is just the sum of them, and the middle of the points is
+		// a better idea of where the hit was than the one point EPA found.
+		if (manifold.Size() > 0)
+		{
+			glm::vec3 sum(0.0f);
+
+			for (int j = 0; j < manifold.Size(); j++)
+			{
+				sum += (manifold[j].worldA + manifold[j].worldB) * 0.5f;
+				event.impulse += manifold[j].impulse;
+			}
+
+			event.point = sum / (float)manifold.Size();
+			event.normal = manifold.GetNormal();
+		}
+	}
+}
+
+bool PhysicsWorld::canWake(int object)
+{
+	BodyHandle body = handles[object];
+
+	return !bodies.IsSleeping(body) && (bodies.InverseMass(body) > 0.0f || bodies.Velocity(body) != glm::vec3(0.0f) ||
+		bodies.AngularVelocity(body) != glm::vec3(0.0f));
+}
+
+void PhysicsWorld::wakeIsland(int object)
+{
+	if (!bodies.IsSleeping(handles[object]))
+	{
+		return;
+	}
+
+	for (int i = islandFirst[object]; i != -1; i = islandNext[i])
+	{
+		bodies.SetSleeping(handles[i], false);
+		stillTimes[i] = 0.0f;
+	}
+}
+
+void PhysicsWorld::buildIslands()
+{
+	GJK_PROFILE_ZONE("islands");
+
+	int count = (int)handles.size();
+
+	for (int i = 0; i < count; i++)
+	{
+		islandParents[i] = i;
+	}
+
+	// Every contact joins two islands into one, unless one of its objects can't be moved. Nothing that pushes on that object can change
+	// anything else through it, so one floor doesn't tie everything sitting on it into a single island. (See contactIsland.)
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		const NarrowphaseContact& contact = contacts[i];
+
+		if (bodies.InverseMass(handles[contact.a]) == 0.0f || bodies.InverseMass(handles[contact.b]) == 0.0f)
+		{
+			continue;
+		}
+
+		int a = findIsland(contact.a);
+		int b = findIsland(contact.b);
+
+		if (a != b)
+		{
+			islandParents[a] = b;
+		}
+	}
+
+	// Number the islands in the order their first contacts come in, and count how many contacts each one has. (islandStarts[i + 1] holds
+	// island i's count for now.)
+	islandStarts.assign(1, 0);
+
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		int root = contactIsland(contacts[i]);
+
+		if (islandIds[root] == -1)
+		{
+			islandIds[root] = (int)islandStarts.size() - 1;
+			islandStarts.push_back(0);
+		}
+
+		islandStarts[islandIds[root] + 1]++;
+	}
+
+	// Adding up the counts turns islandStarts[i] into where island i starts.
+	for (int i = 1; i < (int)islandStarts.size(); i++)
+	{
+		islandStarts[i] += islandStarts[i - 1];
+	}
+
+	// Then put each contact in its island's place, keeping them in pair order within each island. Each island's start moves along as it
+	// fills up, so afterward every start has moved onto the next island's, and they all shift back down one.
+	islandContacts.resize(contacts.size());
+
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		int island = islandIds[contactIsland(contacts[i])];
+
+		islandContacts[islandStarts[island]++] = i;
+	}
+
+	for (int i = (int)islandStarts.size() - 2; i > 0; i--)
+	{
+		islandStarts[i] = islandStarts[i - 1];
+	}
+
+	islandStarts[0] = 0;
+
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		islandIds[contactIsland(contacts[i])] = -1;
+	}
+}
+
+void PhysicsWorld::reserveSolvers()
+{
+	int bodyCount = 0;
+	int constraintCount = 0;
+
+	for (int i = 0; i < (int)solvers.size(); i++)
+	{
+		bodyCount = std::max(bodyCount, solvers[i].GetPeakBodies());
+		constraintCount = std::max(constraintCount, solvers[i].GetPeakConstraints());
+	}
+
+	for (int i = 0; i < (int)solvers.size(); i++)
+	{
+		solvers[i].Reserve(bodyCount, constraintCount);
+	}
+
+	// The large islands' solvers only ever see their own island, so each one only needs room for the most it's had.
+	for (int i = 0; i < (int)largeIslandSolvers.size(); i++)
+	{
+		largeIslandSolvers[i].Reserve(largeIslandSolvers[i].GetPeakBodies(), largeIslandSolvers[i].GetPeakConstraints());
+	}
+}
+
+void PhysicsWorld::updateSleep(float dt)
+{
+	GJK_PROFILE_ZONE("sleep");
+
+	int count = (int)handles.size();
+
+	for (int i = 0; i < count; i++)
+	{
+		islandStillTimes[i] = sleepTime;
+		islandLast[i] = -1;
+
+		if (!bodies.IsSleeping(handles[i]))
+		{
+			// Spinning in place counts as moving too, by how fast it moves the box's corners.
+			bool still = glm::length(stepVelocity(i, dt)) + spinSpeed(i) < sleepVelocity;
+
+			stillTimes[i] = still ? stillTimes[i] + dt : 0.0f;
+		}
+	}
+
+	// The islands are the ones buildIslands found for solving. Any sleeping object in a contact was woken up by it, so they're all awake.
+	// Being pushed apart moves the objects just as much as a velocity would, so a contact that pushed them faster than sleepVelocity means
+	// neither of them is still.
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		const NarrowphaseContact& contact = contacts[i];
+
+		if (contact.contact.depth > sleepVelocity * dt)
+		{
+			stillTimes[contact.a] = 0.0f;
+			stillTimes[contact.b] = 0.0f;
+		}
+	}
+
+	// An island can only sleep once everything in it has been still for long enough.
+	for (int i = 0; i < count; i++)
+	{
+		if (!bodies.IsSleeping(handles[i]))
+		{
+			int root = findIsland(i);
+
+			islandStillTimes[root] = glm::min(islandStillTimes[root], stillTimes[i]);
+		}
+	}
+
+	int sleeping = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		BodyHandle body = handles[i];
+
+		if (bodies.IsSleeping(body))
+		{
+			sleeping++;
+			continue;
+		}
+
+		// A static object has nothing to gain from sleeping, and its proxy isn't in the broadphase.
+		if (bodies.GetType(body) == BODY_STATIC)
+		{
+			continue;
+		}
+
+		int root = findIsland(i);
+
+		if (islandStillTimes[root] < sleepTime)
+		{
+			continue;
+		}
+
+		bodies.SetSleeping(body, true);
+		bodies.Velocity(body) = glm::vec3(0.0f);
+		bodies.AngularVelocity(body) = glm::vec3(0.0f);
+		sleeping++;
+
+		// It may have been pushed out of a contact this step. Nothing updates a sleeping object's shape or proxy, and a transform that
+		// changed while asleep would look like it had been moved by hand, so bring them up to date now.
+		// (The tree might be busy with the next step's pairs, in which case it's done at the end of the step.)
+		updateShape(i);
+
+		if (predicting)
+		{
+			sleepMoves.push_back(i);
+		}
+		else
+		{
+			broadphase->MoveProxy(proxies[i], shapeBounds[i].box, glm::vec3(0.0f));
+		}
+
+		// Add it to the end of its island's list.
+		int last = islandLast[root];
+
+		islandFirst[i] = last == -1 ? i : islandFirst[last];
+		islandNext[i] = -1;
+
+		if (last != -1)
+		{
+			islandNext[last] = i;
+		}
+
+		islandLast[root] = i;
+	}
+
+	stats.sleeping = sleeping;
+
+	GJK_PROFILE_COUNT("sleeping objects", sleeping);
+}
+
+void PhysicsWorld::updateStepRates(float dt)
+{
+	GJK_PROFILE_ZONE("step rates");
+
+	int count = (int)handles.size();
+
+	// Each awake object's own interval is the longest (in powers of two) it can go without moving further than one step at
+	// slowIslandSpeed.
+	for (int i = 0; i < count; i++)
+	{
+		BodyHandle body = handles[i];
+
+		stepIntervals[i] = 1;
+
+		if (!enabled[i] || bodies.GetType(body) != BODY_DYNAMIC || bodies.IsSleeping(body))
+		{
+			continue;
+		}
+
+		float speed = glm::length(stepVelocity(i, dt)) + spinSpeed(i);
+		int interval = slowIslandInterval;
+
+		while (interval > 1 && speed * interval > slowIslandSpeed)
+		{
+			interval /= 2;
+		}
+
+		stepIntervals[i] = (unsigned char)interval;
+	}
+
+	// Most objects are an island on their own, and every object in a bigger island is in one of the contacts that joined it (see
+	// buildIslands), so going through those is enough to give each island the shortest of its objects' intervals. They're gathered at
+	// the island's root in islandIds, which is all -1 between uses.
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		const NarrowphaseContact& contact = contacts[i];
+
+		if (bodies.InverseMass(handles[contact.a]) == 0.0f || bodies.InverseMass(handles[contact.b]) == 0.0f)
+		{
+			continue;
+		}
+
+		int root = findIsland(contact.a);
+		int interval = glm::min(stepIntervals[contact.a], stepIntervals[contact.b]);
+
+		if (islandIds[root] == -1 || interval < islandIds[root])
+		{
+			islandIds[root] = interval;
+		}
+	}
+
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		const NarrowphaseContact& contact = contacts[i];
+
+		if (bodies.InverseMass(handles[contact.a]) == 0.0f || bodies.InverseMass(handles[contact.b]) == 0.0f)
+		{
+			continue;
+		}
+
+		int root = findIsland(contact.a);
+
+		stepIntervals[contact.a] = (unsigned char)islandIds[root];
+		stepIntervals[contact.b] = (unsigned char)islandIds[root];
+	}
+
+	for (int i = 0; i < (int)contacts.size(); i++)
+	{
+		islandIds[findIsland(contacts[i].a)] = -1;
+	}
+}
+
+unsigned long long PhysicsWorld::StateHash()
+{
+	// FNV-1a's starting value (see HashBytes).
+	unsigned long long hash = 14695981039346656037ULL;
+
+	// In object order, which is the same on every peer that added the same objects (unlike the BodyStore's order, which can change as
+	// bodies are removed).
+	for (int i = 0; i < (int)handles.size(); i++)
+	{
+		BodyHandle body = handles[i];
+		unsigned char asleep = bodies.IsSleeping(body) ? 1 : 0;
+
+		hash = HashBytes(&bodies.Position(body), sizeof(glm::vec3), hash);
+		hash = HashBytes(&bodies.Orientation(body), sizeof(glm::quat), hash);
+		hash = HashBytes(&bodies.Velocity(body), sizeof(glm::vec3), hash);
+		hash = HashBytes(&bodies.AngularVelocity(body), sizeof(glm::vec3), hash);
+		hash = HashBytes(&asleep, sizeof(asleep), hash);
+	}
+
+	return hash;
+}
+
+void PhysicsWorld::SaveState(PhysicsWorldState& state) const
+{
+	// Assigning a vector to one that already has room copies straight over it, without allocating.
+	state.objectCount = (int)handles.size();
+
+	state.bodies = bodies;
+
+	state.shapes = shapes;
+	state.shapeBounds = shapeBounds;
+	state.shapeTransforms = shapeTransforms;
+	state.stillTimes = stillTimes;
+	state.islandFirst = islandFirst;
+	state.islandNext = islandNext;
+	state.wakeRequests = wakeRequests;
+
+	state.broadphaseIndex = broadphaseIndex;
+	state.proxies = proxies;
+
+	switch (broadphaseIndex)
+	{
+	case 0:
+		state.treeBroadphase = treeBroadphase;
+		break;
+	case 1:
+		state.sweepBroadphase = sweepBroadphase;
+		break;
+	case 2:
+		state.gridBroadphase = gridBroadphase;
+		break;
+	default:
+		state.linearBroadphase = linearBroadphase;
+		break;
+	}
+
+	state.staticTree = staticTree;
+	state.staticFlat = staticFlat;
+	state.staticTreeChanged = staticTreeChanged;
+
+	state.pairCache = pairCache;
+	state.overlaps = overlaps;
+
+	state.enabled = enabled;
+	state.disabledTypes = disabledTypes;
+	state.origin = origin;
+	state.lodSteps = lodSteps;
+	state.stepIntervals = stepIntervals;
+	state.idleSteps = idleSteps;
+	state.rateSteps = rateSteps;
+}
+
+bool PhysicsWorld::RestoreState(const PhysicsWorldState& state)
+{
+	if (!state.IsSaved() || state.objectCount != (int)handles.size())
+	{
+		return false;
+	}
+
+	clearRayCasts();
+
+	const glm::mat4* oldTransforms = bodies.Transforms();
+
+	// If the broadphase has been changed since, take every object out of the one in use now, or it would still have them all when it next
+	// gets picked. (This goes by the objects' types as they are now, before the bodies are put back.)
+	if (state.broadphaseIndex != broadphaseIndex)
+	{
+		for (int i = 0; i < (int)proxies.size(); i++)
+		{
+			if (bodies.GetType(handles[i]) != BODY_STATIC)
+			{
+				broadphase->DestroyProxy(proxies[i]);
+			}
+		}
+	}
+
+	bodies = state.bodies;
+
+	shapes = state.shapes;
+	shapeBounds = state.shapeBounds;
+	shapeTransforms = state.shapeTransforms;
+	stillTimes = state.stillTimes;
+	islandFirst = state.islandFirst;
+	islandNext = state.islandNext;
+	wakeRequests = state.wakeRequests;
+
+	proxies = state.proxies;
+	staticTree = state.staticTree;
+	staticFlat = state.staticFlat;
+	staticTreeChanged = state.staticTreeChanged;
+
+	switch (state.broadphaseIndex)
+	{
+	case 0:
+		treeBroadphase = state.treeBroadphase;
+		broadphase = &treeBroadphase;
+		break;
+	case 1:
+		sweepBroadphase = state.sweepBroadphase;
+		broadphase = &sweepBroadphase;
+		break;
+	case 2:
+		gridBroadphase = state.gridBroadphase;
+		broadphase = &gridBroadphase;
+		break;
+	default:
+		linearBroadphase = state.linearBroadphase;
+		broadphase = &linearBroadphase;
+		break;
+	}
+
+	broadphaseIndex = state.broadphaseIndex;
+
+	// The copies came with the filters of whichever world they were saved from.
+	broadphase->SetFilters(&filters);
+	staticTree.SetFilters(&filters);
+
+	pairCache = state.pairCache;
+	overlaps = state.overlaps;
+
+	enabled = state.enabled;
+	disabledTypes = state.disabledTypes;
+	origin = state.origin;
+	lodSteps = state.lodSteps;
+	stepIntervals = state.stepIntervals;
+	idleSteps = state.idleSteps;
+	rateSteps = state.rateSteps;
+
+	// The contacts point into the pair cache, which may just have moved.
+	pairs.clear();
+	contacts.clear();
+	speculativeContacts = 0;
+	impacts.clear();
+	triggerEvents.clear();
+	contactEvents.clear();
+	kinematicTargets.clear();
+
+	// The same goes for the transform pointers, if the bodies' arrays had to grow to fit.
+	if (bodies.Transforms() != oldTransforms)
+	{
+		for (int i = 0; i < (int)handles.size(); i++)
+		{
+			transforms[i] = &bodies.GetTransform(handles[i]);
+		}
+	}
+
+	return true;
+}
+
+void PhysicsWorld::Step(float dt)
+{
+	GJK_PROFILE_ZONE("physics step");
+
+	double start = timer.Now();
+
+	// Everything the step allocates, on any thread, is counted from here to the end (see CountHeapAllocation).
+	BeginStepAllocations();
+	long long allocationsBefore = GetStepAllocationCount();
+
+	// Upkeep spread across the steps (see SetMaintenanceBudget) goes first, while nothing else is using the tree. That only applies while
+	// the tree is the broadphase.
+	if (maintenanceBudget > 0.0)
+	{
+		GJK_PROFILE_ZONE("maintenance");
+
+		maintenance.SetInterval(treeOptimizeTask, broadphaseIndex == 0 ? treeRebuildInterval : 0);
+		maintenance.Run(timer, maintenanceBudget, deterministic);
+	}
+
+	double maintained = timer.Now();
+
+	// When each stage finished (see PhysicsStepStats). The stages that run as a single job note the time; the stage after each one
+	// that's split across threads notes the time it starts, which is when the last of the split jobs finished.
+	// transforms, refit, broadphase, narrowphase, solve
+	double stageEnds[5];
+
+	// Remember where everything was before this step, for the renderer to blend from.
+	if (!fastForward)
+	{
+		bodies.SavePrevious();
+	}
+
+	ApplyKinematicTargets(dt);
+
+	// The far objects (see SetLevelOfDetail) only move every lodInterval steps, by that many steps' worth at once, and stay put in between.
+	bool levelOfDetail = hasLevelOfDetail();
+	float farScale = 0.0f;
+
+	if (levelOfDetail && ++lodSteps >= lodInterval)
+	{
+		farScale = (float)lodInterval;
+		lodSteps = 0;
+	}
+
+	// Only the tree can get ahead on the next step's pairs (see SetPipelinedBroadphase).
+	predicting = pipelined && broadphaseIndex == 0;
+
+	// Every interval a slow island can have divides MAX_STEP_INTERVAL, so counting round to it keeps them all in step (see SetIslandRates).
+	rateSteps = (rateSteps + 1) % MAX_STEP_INTERVAL;
+
+	// The step is split into stages, each one a set of jobs that waits on the stage before it:
+	// transforms -> refit -> broadphase -> pairs -> narrowphase -> solve -> sweep -> integrate
+	// Stages that work on each object (or pair, or island) on its own are split across every thread. The ones that change something shared
+	// (like the broadphase's structure) run as a single job. Since all of it goes through the job system, the threads that
+	// aren't needed for a single-job stage are free to pick up any other work that's ready.
+	// (The stages are lambdas, which the jobs call as function(begin, end, thread).)
+	// Every stage is on the way to the end of the step, so they're all critical: anything else on the job system (debug drawing, statistics
+	// and so on, submitted as less urgent) waits until they've been taken. Jobs the stages submit themselves are critical too.
+	JobCounter transformsDone(JOB_CRITICAL), refitDone(JOB_CRITICAL), broadphaseDone(JOB_CRITICAL), pairsDone(JOB_CRITICAL);
+	JobCounter narrowphaseDone(JOB_CRITICAL), solveDone(JOB_CRITICAL), sweepDone(JOB_CRITICAL), integrateDone(JOB_CRITICAL);
+
+	// The linear BVH's build goes through parts of its own within the refit stage (see refitStage).
+	JobCounter codesDone(JOB_CRITICAL), scanDone(JOB_CRITICAL), scatterDone(JOB_CRITICAL);
+
+	// The next step's refit and queries, when the broadphase is pipelined. This step doesn't need them, so they only come ahead of anything
+	// less urgent, and otherwise fill in around the stages.
+	JobCounter predictQueriesDone(JOB_NORMAL), predictDone(JOB_NORMAL);
+
+	// Re-calculate the Object-Oriented Bounding Box for each object.
+	// We do this because if the object's orientation changes, we should update the bounding box as well.
+	// Be warned: For some objects this can actually cause a collision to be missed, so be careful.
+	// (This is because we determine the collision based on the OBB, but if the OBB changes significantly, the time of collision can change between frames,
+	// and if that lines up just right you'll miss the collision altogether.)
+	// That's what the continuous collision is for: this is also where we find out which objects are fast enough to need it.
+	// The transforms live in the BodyStore's array, which moves whenever it grows, so the pointers are picked up again every step. Only the
+	// objects that have moved get their OBBs rebuilt, and those are built together in batches.
+	// It's also where the far objects are picked out, from where the OBBs are now.
+	auto transformStage = [this, dt, levelOfDetail, farScale](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("transforms");
+
+		updateShapes(begin, end);
+
+		for (int i = begin; i < end; i++)
+		{
+			// Everything that's moved the object since the last narrowphase, for this one to count its pairs down by.
+			shapeMotion[i] = pendingMotion[i];
+			pendingMotion[i] = 0.0f;
+
+			// Every object's time scale is set, far or not, so turning the level of detail off puts them all back.
+			farObjects[i] = levelOfDetail && isFar(i);
+
+			// One in a slow island only moves when its interval comes round, by every step it's sat out as well as this one. Once it's back
+			// to every step (or it's far, or the rates are off) it just starts again from there.
+			int interval = slowIslandSpeed > 0.0f ? stepIntervals[i] : 1;
+			float timeScale = 1.0f;
+
+			if (farObjects[i] || interval == 1)
+			{
+				timeScale = farObjects[i] ? farScale : 1.0f;
+				idleSteps[i] = 0;
+			}
+			else if (rateSteps % interval == 0)
+			{
+				timeScale = (float)(idleSteps[i] + 1);
+				idleSteps[i] = 0;
+			}
+			else
+			{
+				timeScale = 0.0f;
+				idleSteps[i]++;
+			}
+
+			bodies.SetTimeScale(handles[i], timeScale);
+
+			// A far object is only ever a box to the pairs it's in, so there's nothing for it to sweep.
+			fastObjects[i] = !farObjects[i] && isFast(i, dt);
+
+			// Sleeping objects have no velocity, so one that does was given it by hand.
+			if (bodies.IsSleeping(handles[i]) &&
+				(bodies.Velocity(handles[i]) != glm::vec3(0.0f) || bodies.AngularVelocity(handles[i]) != glm::vec3(0.0f)))
+			{
+				wakeRequests[i] = 1;
+			}
+
+			// Whether the refit needs to move the object's proxy. Every broadphase only changes a proxy whose fat bounds the new bounds
+			// don't fit in, so that's what we check. (Static objects aren't refit at all.)
+			proxyMoves[i] = bodies.GetType(handles[i]) != BODY_STATIC && !broadphase->GetFatBounds(proxies[i]).Contains(proxyBounds(i, dt));
+
+			// Where the proxy would need to be next step, if the object carries on as it's going now: the same bounds, moved on by a step.
+			// The solver changes the velocities later on in the step, so this is the last chance to read them while nothing is writing to
+			// them. (Far objects only move every so often, and sleeping ones not at all.)
+			if (predicting)
+			{
+				predictMoves[i] = bodies.GetType(handles[i]) != BODY_STATIC && !farObjects[i] && !bodies.IsSleeping(handles[i]);
+
+				if (predictMoves[i])
+				{
+					glm::vec3 travel = bodies.Velocity(handles[i]) * objectStep(i, dt);
+					AABB bounds = proxyBounds(i, dt);
+
+					bounds.min += travel;
+					bounds.max += travel;
+
+					predictedBounds[i] = bounds;
+					predictedTravel[i] = travel;
+				}
+			}
+		}
+	};
+
+	// Tell the broadphase where each object's bounds are now, and how far it's heading this step.
+	// Builds some of the subtrees of the AABB tree when it's being rebuilt (see treeRebuildInterval).
+	auto rebuildStage = [this](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("rebuild tree");
+
+		for (int i = begin; i < end; i++)
+		{
+			treeBroadphase.RunRebuildTask(i);
+		}
+	};
+
+	// The parts of building the linear BVH (see LinearBVH::PrepareBuild), each split across the threads but the scan, which is one job.
+	auto codeStage = [this](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("lbvh codes");
+
+		for (int i = begin; i < end; i++)
+		{
+			linearBroadphase.RunCodeTask(i);
+		}
+	};
+
+	auto scanStage = [this](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("lbvh scan");
+
+		linearBroadphase.PrepareScatter();
+	};
+
+	auto scatterStage = [this](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("lbvh scatter");
+
+		for (int i = begin; i < end; i++)
+		{
+			linearBroadphase.RunScatterTask(i);
+		}
+	};
+
+	auto bucketStage = [this](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("lbvh buckets");
+
+		for (int i = begin; i < end; i++)
+		{
+			linearBroadphase.RunBucketTask(i);
+		}
+	};
+
+	auto refitStage = [this, dt, &stageEnds, &rebuildStage, &refitDone, &codeStage, &scanStage, &scatterStage, &bucketStage, &codesDone,
+		&scanDone, &scatterDone](int begin, int end, int thread)
+	{
+		stageEnds[0] = timer.Now();
+
+		GJK_PROFILE_ZONE("refit");
+
+		for (int i = 0; i < (int)proxies.size(); i++)
+		{
+			if (wakeRequests[i])
+			{
+				wakeRequests[i] = 0;
+
+				// For a static object, it means it was moved by hand, which is the only time its proxy needs moving. (A disabled one
+				// doesn't have a proxy to move.)
+				if (bodies.GetType(handles[i]) == BODY_STATIC)
+				{
+					if (enabled[i] && staticTree.MoveProxy(proxies[i], shapeBounds[i].box, glm::vec3(0.0f)))
+					{
+						staticTreeChanged = true;
+						invalidateRayCasts(staticTree.GetFatBounds(proxies[i]));
+					}
+				}
+				else
+				{
+					wakeIsland(i);
+				}
+			}
+		}
+
+		if (staticTreeChanged)
+		{
+			staticTree.Rebuild();
+			staticTree.Flatten(staticFlat);
+			staticTreeChanged = false;
+		}
+
+		int moved = 0;
+
+		for (int i = 0; i < (int)proxies.size(); i++)
+		{
+			// Only the objects that have left their fat bounds, which the transform stage already found. A sleeping one hasn't moved (and
+			// one that was moved by hand has just been woken up), so its proxy is already where it should be.
+			if (!proxyMoves[i] || bodies.IsSleeping(handles[i]))
+			{
+				continue;
+			}
+
+			broadphase->MoveProxy(proxies[i], proxyBounds(i, dt), bodies.Velocity(handles[i]) * objectStep(i, dt));
+			invalidateRayCasts(broadphase->GetFatBounds(proxies[i]));
+			moved++;
+		}
+
+		stats.moved = moved;
+		GJK_PROFILE_COUNT("proxies moved", moved);
+
+		// Every so often, the tree is built again from scratch, with the proxies where they are now. Its subtrees are built across the
+		// threads as this job's children, so the broadphase waits for them, and then puts the top of the tree back together.
+		// (With a maintenance budget, it's put back in shape a slice at a time at the start of each step instead.)
+		if (broadphaseIndex == 0 && maintenanceBudget <= 0.0 && treeRebuildInterval > 0 && ++stepsSinceTreeRebuild >= treeRebuildInterval)
+		{
+			int tasks = treeBroadphase.PrepareRebuild(jobs->GetThreadCount() * 4);
+
+			jobs->SubmitFor(tasks, 1, rebuildStage, refitDone);
+
+			treeRebuilding = true;
+			stepsSinceTreeRebuild = 0;
+		}
+
+		// The linear BVH is built from scratch every step, from the proxies where they are now. Each part waits for the one before, and
+		// the last is this job's children, so the broadphase waits for the whole build.
+		if (broadphaseIndex == 3)
+		{
+			int blocks = linearBroadphase.PrepareBuild();
+
+			jobs->SubmitFor(blocks, 1, codeStage, codesDone);
+			jobs->SubmitSingle(scanStage, scanDone, &codesDone);
+			jobs->SubmitFor(blocks, 1, scatterStage, scatterDone, &scanDone);
+			jobs->SubmitFor(LBVH_BUCKETS, LBVH_BUCKET_GRAIN, bucketStage, refitDone, &scatterDone);
+		}
+	};
+
+	// Queries the AABB tree with some of the proxies that changed, or looks some of the objects up in the static tree.
+	auto treePairStage = [this](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("tree pairs");
+
+		treeBroadphase.FindPairsRange(begin, end, thread);
+	};
+
+	// With the broadphase pipelined, moves the tree's proxies to where the transform stage expects them to be next step, and then queries the
+	// ones that moved as this job's children, the same way the broadphase stage does. Nothing else in the step uses the tree once the pairs
+	// have been found, so this can run alongside the rest of it.
+	auto predictStage = [this, &treePairStage, &predictQueriesDone](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("predict refit");
+
+		int predicted = 0;
+
+		for (int i = 0; i < (int)proxies.size(); i++)
+		{
+			if (predictMoves[i] && treeBroadphase.MoveProxy(proxies[i], predictedBounds[i], predictedTravel[i]))
+			{
+				invalidateRayCasts(treeBroadphase.GetFatBounds(proxies[i]));
+				predicted++;
+			}
+		}
+
+		stats.predicted = predicted;
+		GJK_PROFILE_COUNT("proxies predicted", predicted);
+
+		int count = treeBroadphase.PreparePairs(jobs->GetThreadCount());
+
+		jobs->SubmitFor(count, PAIR_GRAIN, treePairStage, predictQueriesDone);
+	};
+
+	// The pairs themselves aren't needed (the next step's broadphase stage gives all of them again, along with any for the objects that
+	// didn't go where they were expected), but the ones that dropped out have to come out of the pair cache, which this step is still using.
+	auto predictPairStage = [this](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("predict pairs");
+
+		treeBroadphase.FinishPairs(predictedPairs);
+
+		predictedRemovedPairs.assign(treeBroadphase.GetRemovedPairs().begin(), treeBroadphase.GetRemovedPairs().end());
+	};
+
+	auto linearPairStage = [this](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("lbvh pairs");
+
+		linearBroadphase.FindPairsRange(begin, end, thread);
+	};
+
+	auto staticPairStage = [this](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("static pairs");
+
+		findStaticPairs(begin, end, thread);
+	};
+
+	// Only the pairs whose bounds overlap go on to the real collision test.
+	// The queries don't change anything, so the AABB tree's, the linear BVH's and the static tree's are split across the threads as this
+	// job's children, and each thread keeps the pairs it finds to itself. The pair stage then puts them all together.
+	auto broadphaseStage = [this, &stageEnds, &treePairStage, &linearPairStage, &staticPairStage, &broadphaseDone](int begin, int end, int thread)
+	{
+		stageEnds[1] = timer.Now();
+
+		GJK_PROFILE_ZONE("broadphase");
+
+		if (treeRebuilding)
+		{
+			treeBroadphase.FinishRebuild();
+			treeRebuilding = false;
+		}
+
+		if (broadphaseIndex == 0)
+		{
+			int count = treeBroadphase.PreparePairs(jobs->GetThreadCount());
+
+			jobs->SubmitFor(count, PAIR_GRAIN, treePairStage, broadphaseDone);
+		}
+		else if (broadphaseIndex == 3)
+		{
+			linearBroadphase.FinishBuild();
+
+			int count = linearBroadphase.PreparePairs(jobs->GetThreadCount());
+
+			jobs->SubmitFor(count, PAIR_GRAIN, linearPairStage, broadphaseDone);
+		}
+		else
+		{
+			broadphase->FindPairs(pairs);
+		}
+
+		if (staticTree.GetProxyCount() > 0)
+		{
+			jobs->SubmitFor((int)proxies.size(), PAIR_GRAIN, staticPairStage, broadphaseDone);
+		}
+	};
+
+	auto pairStage = [this, &stageEnds](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("pairs");
+
+		if (broadphaseIndex == 0)
+		{
+			treeBroadphase.FinishPairs(pairs);
+		}
+		else if (broadphaseIndex == 3)
+		{
+			linearBroadphase.FinishPairs(pairs);
+		}
+
+		// Forget what the pair cache had for the pairs the broadphase doesn't find any more, so that it only ever holds the pairs that are
+		// close, instead of growing with every pair that has ever been near each other. (Nothing is pointing into it between steps.)
+		const std::vector<BroadphasePair>& removed = broadphase->GetRemovedPairs();
+
+		for (int i = 0; i < (int)removed.size(); i++)
+		{
+			pairCache.Remove(removed[i].a, removed[i].b);
+		}
+
+		// Then the ones that haven't been tested in a while, and start a new frame for this step's lookups.
+		pairCache.Evict(pairCacheMaxAge);
+		pairCache.NextFrame();
+
+		if (staticTree.GetProxyCount() > 0)
+		{
+			mergeStaticPairs();
+		}
+
+		if (degraded || sleepEnabled || hasLevelOfDetail() || slowIslandSpeed > 0.0f)
+		{
+			pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [this](const BroadphasePair& pair) { return isSleepingPair(pair); }), pairs.end());
+		}
+
+		GJK_PROFILE_COUNT("pairs tested", (long long)pairs.size());
+
+		stageEnds[2] = timer.Now();
+	};
+
+	// Each contact moves both of its objects, so two contacts that share an object can't be solved at the same time. The contacts are split
+	// into islands (groups of objects that touch each other, directly or through others), which share no objects at all, and each job
+	// solves whole islands. Within an island the contacts stay in pair order, so the step plays out the same however the threads were
+	// scheduled, and the same as solving every contact in order on one thread.
+	// Each thread has its own solver, and since the islands share no objects, a job's islands can all go through it together.
+	auto resolveStage = [this, dt](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("resolve");
+
+		ContactSolver& solver = solvers[thread];
+
+		solver.Clear();
+
+		// The large islands have jobs of their own.
+		for (int island = begin; island < end; island++)
+		{
+			if (!isLargeIsland(island))
+			{
+				resolveIsland(island, solver, dt);
+			}
+		}
+
+		solver.Solve();
+
+		for (int island = begin; island < end; island++)
+		{
+			if (!isLargeIsland(island))
+			{
+				forgetSolverBodies(island);
+			}
+		}
+	};
+
+	// Each large island gets a solver to itself, which splits each color of its points between the threads. It waits on them, so the
+	// thread that runs this job helps out (or picks up other islands' jobs in the meantime).
+	auto largeIslandStage = [this, dt](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("resolve large island");
+
+		for (int i = begin; i < end; i++)
+		{
+			ContactSolver& solver = largeIslandSolvers[i];
+
+			solver.CopySettings(solvers[0]);
+			solver.Clear();
+
+			resolveIsland(largeIslands[i], solver, dt);
+
+			solver.Solve(jobs);
+
+			forgetSolverBodies(largeIslands[i]);
+		}
+	};
+
+	// Gathers the contacts (and makes the speculative ones), wakes up anything asleep that was hit, and splits the contacts into islands.
+	// Then it hands the islands out to be solved as its own children, since how many there are isn't known until now.
+	auto islandStage = [this, dt, &stageEnds, &resolveStage, &largeIslandStage, &solveDone](int begin, int end, int thread)
+	{
+		lastOverlaps.swap(overlaps);
+		narrowphase->Finish(contacts, overlaps);
+
+		if (fastForward)
+		{
+			triggerEvents.clear();
+		}
+		else
+		{
+			buildTriggerEvents();
+		}
+
+		speculativeContacts = 0;
+
+		if (speculative && continuous)
+		{
+			addSpeculativeContacts(dt);
+		}
+
+		stageEnds[3] = timer.Now();
+
+		GJK_PROFILE_ZONE("solve");
+		GJK_PROFILE_COUNT("contacts", (long long)contacts.size());
+
+		// An awake object has run into a sleeping one (pairs where both are asleep are never tested). Waking up an island touches every
+		// object in it, so this is done here, before the islands are split between threads.
+		for (int i = 0; i < (int)contacts.size(); i++)
+		{
+			bool wakesB = canWake(contacts[i].a);
+			bool wakesA = canWake(contacts[i].b);
+
+			if (wakesB)
+			{
+				wakeIsland(contacts[i].b);
+			}
+			if (wakesA)
+			{
+				wakeIsland(contacts[i].a);
+			}
+		}
+
+		buildIslands();
+
+		stats.islands = (int)islandStarts.size() - 1;
+
+		GJK_PROFILE_COUNT("islands", stats.islands);
+
+		largeIslands.clear();
+
+		for (int island = 0; island < stats.islands && largeIslandContacts > 0; island++)
+		{
+			if (isLargeIsland(island))
+			{
+				largeIslands.push_back(island);
+			}
+		}
+
+		while (largeIslandSolvers.size() < largeIslands.size())
+		{
+			largeIslandSolvers.push_back(ContactSolver());
+		}
+
+		stats.largeIslands = (int)largeIslands.size();
+
+		// The large islands go first, since they take the longest.
+		jobs->SubmitFor(stats.largeIslands, 1, largeIslandStage, solveDone);
+		jobs->SubmitFor(stats.islands, ISLAND_GRAIN, resolveStage, solveDone);
+	};
+
+	// The fast objects' sweeps and the sleeping can't be split up, since they go through every pair and every island.
+	auto sweepStage = [this, dt, &stageEnds](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("sweep and sleep");
+
+		if (fastForward)
+		{
+			contactEvents.clear();
+		}
+		else
+		{
+			buildContactEvents();
+		}
+
+		reserveSolvers();
+
+		// The speculative contacts have already been solved with the rest.
+		if (speculative && continuous)
+		{
+			impacts.clear();
+		}
+		else
+		{
+			sweep(dt);
+		}
+
+		if (sleepEnabled)
+		{
+			updateSleep(dt);
+		}
+		else
+		{
+			stats.sleeping = 0;
+		}
+
+		// With the islands and the sleeping worked out, the rates for next step can be too.
+		if (slowIslandSpeed > 0.0f)
+		{
+			updateStepRates(dt);
+		}
+
+		stageEnds[4] = timer.Now();
+	};
+
+	// Update the objects based on their velocities. This goes straight through the BodyStore's arrays (by index, not handle), so each job
+	// only streams through the positions, velocities and so on of its own range of bodies.
+	auto integrateStage = [this, dt](int begin, int end, int thread)
+	{
+		GJK_PROFILE_ZONE("integrate");
+
+		bodies.Integrate(dt, begin, end);
+	};
+
+	jobs->SubmitFor((int)handles.size(), 64, transformStage, transformsDone);
+	jobs->SubmitSingle(refitStage, refitDone, &transformsDone);
+	jobs->SubmitSingle(broadphaseStage, broadphaseDone, &refitDone);
+	jobs->SubmitSingle(pairStage, pairsDone, &broadphaseDone);
+
+	if (predicting)
+	{
+		jobs->SubmitSingle(predictStage, predictQueriesDone, &pairsDone);
+		jobs->SubmitSingle(predictPairStage, predictDone, &predictQueriesDone);
+	}
+	else
+	{
+		stats.predicted = 0;
+	}
+
+	// GJK on each pair, and EPA on the ones that collide, split across all of the threads. (The narrowphase adds its jobs for the pairs
+	// once the broadphase has found them.)
+	narrowphase->Submit(pairs, shapes, shapeBounds, transforms, pairCache, narrowphaseDone, &pairsDone);
+
+	// The islands are solved across all of the threads too. (The island stage adds the jobs for them once it has found them.)
+	jobs->SubmitSingle(islandStage, solveDone, &narrowphaseDone);
+	jobs->SubmitSingle(sweepStage, sweepDone, &solveDone);
+	jobs->SubmitFor(bodies.Size(), INTEGRATE_GRAIN, integrateStage, integrateDone, &sweepDone);
+
+	jobs->Wait(integrateDone);
+
+	// The tree has to be finished with before the step can end, and then what had to wait for it can be done.
+	if (predicting)
+	{
+		jobs->Wait(predictDone);
+
+		for (int i = 0; i < (int)predictedRemovedPairs.size(); i++)
+		{
+			pairCache.Remove(predictedRemovedPairs[i].a, predictedRemovedPairs[i].b);
+		}
+
+		for (int i = 0; i < (int)sleepMoves.size(); i++)
+		{
+			broadphase->MoveProxy(proxies[sleepMoves[i]], shapeBounds[sleepMoves[i]].box, glm::vec3(0.0f));
+		}
+
+		predictedRemovedPairs.clear();
+		sleepMoves.clear();
+		predicting = false;
+	}
+
+	ageRayCasts();
+
+	double finish = timer.Now();
+
+	stats.maintenance = maintained - start;
+	stats.transforms = stageEnds[0] - maintained;
+	stats.refit = stageEnds[1] - stageEnds[0];
+	stats.broadphase = stageEnds[2] - stageEnds[1];
+	stats.narrowphase = stageEnds[3] - stageEnds[2];
+	stats.solve = stageEnds[4] - stageEnds[3];
+	stats.integrate = finish - stageEnds[4];
+	stats.total = finish - start;
+
+	stats.pairs = (int)pairs.size();
+	stats.contacts = (int)contacts.size() - speculativeContacts;
+	stats.swept = sweptPairs;
+	stats.impacts = (int)impacts.size();
+	stats.speculative = speculativeContacts;
+	stats.overlaps = (int)overlaps.size();
+	stats.far = levelOfDetail ? (int)std::count(farObjects.begin(), farObjects.end(), (unsigned char)1) : 0;
+	stats.idle = slowIslandSpeed > 0.0f ? (int)(idleSteps.size() - std::count(idleSteps.begin(), idleSteps.end(), (unsigned char)0)) : 0;
+	stats.skipped = narrowphase->GetSkipped();
+	stats.refined = narrowphase->GetRefined();
+	stats.refinedMisses = narrowphase->GetRefinedMisses();
+
+	stats.overLimits = 0;
+
+	if (limits.objects > 0)
+	{
+		stats.overLimits = (NumObjects() > limits.objects ? 1 : 0) + ((int)pairs.size() > limits.pairs ? 1 : 0) +
+			((int)contacts.size() > limits.contacts ? 1 : 0);
+	}
+
+	gjkStats.Reset();
+	narrowphase->AddStats(gjkStats);
+
+	shadowStats.Reset();
+	narrowphase->AddShadowStats(shadowStats);
+
+	if (pairCostCount > 0 && !fastForward)
+	{
+		narrowphase->AddPairCosts(windowPairCosts, pairCostCount);
+
+		if (++pairCostSteps >= pairCostWindow)
+		{
+			sortPairCosts(windowPairCosts);
+			pairCostReport.swap(windowPairCosts);
+			windowPairCosts.clear();
+			pairCostSteps = 0;
+		}
+	}
+
+	stats.allocations = (int)(GetStepAllocationCount() - allocationsBefore);
+	EndStepAllocations();
+}
+
+void PhysicsWorld::Advance(int steps, float dt)
+{
+	if (steps <= 0)
+	{
+		return;
+	}
+
+	bool gjkStats = narrowphase->IsStatsEnabled();
+	float shadowChecks = narrowphase->GetShadowChecks();
+
+	narrowphase->SetStatsEnabled(false);
+	narrowphase->SetShadowChecks(0.0f);
+	narrowphase->SetPairCosts(0);
+	fastForward = true;
+
+	for (int i = 0; i < steps; i++)
+	{
+		// Everything goes back on for the last step.
+		if (i == steps - 1)
+		{
+			narrowphase->SetStatsEnabled(gjkStats);
+			narrowphase->SetShadowChecks(shadowChecks);
+			narrowphase->SetPairCosts(pairCostCount);
+			fastForward = false;
+		}
+
+		Step(dt);
+	}
+}
+
+void PhysicsWorld::SetPairCosts(int count, int windowSteps)
+{
+	pairCostCount = count > 0 ? count : 0;
+	pairCostWindow = windowSteps > 1 ? windowSteps : 1;
+	pairCostSteps = 0;
+
+	narrowphase->SetPairCosts(pairCostCount);
+
+	// Both lists get swapped at the end of every window, so they both need the room, or a step could allocate.
+	windowPairCosts.clear();
+	windowPairCosts.reserve(pairCostCount);
+	pairCostReport.clear();
+	pairCostReport.reserve(pairCostCount);
+}
+
+void StepWorlds(PhysicsWorld* const* worlds, int count, float dt, JobSystem& jobs)
+{
+	GJK_PROFILE_ZONE("step worlds");
+
+	// One job per thread, each taking worlds until there are none left. A job per world would work too, but a thread waiting on its step
+	// would start the next world's job on top of it, and the next, so the waits could pile up as deep as there are worlds. This way they
+	// can't go deeper than there are threads.
+	//
+	// The worlds are also split into a run for each NUMA node of the job system, sized by how many threads it has, and a thread takes from
+	// its own node's run before helping the others. The same world lands on the same node every step, so the memory it grows while
+	// stepping stays close to the threads stepping it. (With one node, which is the usual case, that's one run of every world.)
+	int nodeCount = jobs.GetNodeCount();
+	std::vector<int> first(nodeCount + 1, 0);
+	std::vector<std::atomic<int>> next(nodeCount);
+	int threadsBefore = 0;
+
+	for (int node = 0; node < nodeCount; node++)
+	{
+		for (int i = 0; i < jobs.GetThreadCount(); i++)
+		{
+			threadsBefore += jobs.GetThreadNode(i) == node ? 1 : 0;
+		}
+
+		first[node + 1] = (int)((long long)count * threadsBefore / jobs.GetThreadCount());
+		next[node] = first[node];
+	}
+
+	auto stepWorlds = [worlds, dt, nodeCount, &first, &next, &jobs](int begin, int end, int thread)
+	{
+		int home = jobs.GetThreadNode(thread);
+
+		for (int n = 0; n < nodeCount; n++)
+		{
+			int node = (home + n) % nodeCount;
+
+			for (int i = next[node]++; i < first[node + 1]; i = next[node]++)
+			{
+				worlds[i]->Step(dt);
+			}
+		}
+	};
+
+	JobCounter done;
+
+	jobs.SubmitFor(glm::min(jobs.GetThreadCount(), count), 1, stepWorlds, done);
+	jobs.Wait(done);
+}
+
+#endif // _PHYSICS_WORLD_CPP
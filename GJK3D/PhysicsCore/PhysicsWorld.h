@@ -0,0 +1,1511 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PhysicsWorld.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PHYSICS_WORLD_H
+#define _PHYSICS_WORLD_H
+
+#include "BodyStore.h"
+#include "Shapes.h"
+#include "AABBTree.h"
+#include "SweepAndPrune.h"
+#include "HashGrid.h"
+#include "LinearBVH.h"
+#include "Narrowphase.h"
+#include "PairCache.h"
+#include "TimeOfImpact.h"
+#include "ShapeCast.h"
+#include "ContactSolver.h"
+#include "JobSystem.h"
+#include "Clock.h"
+#include "Maintenance.h"
+#include "PhysicsCommands.h"
+#include <vector>
+
+// How long each stage of the last step took, in seconds, and how much it had to work on.
+// The stages run one after another (each one waits for the one before it), so each is timed from when the last one finished until it
+// did. That includes any time spent waiting for a thread to pick it up, and means the stages always add up to the whole step.
+struct PhysicsStepStats
+{
+	double transforms;	// Saving the previous poses and rebuilding the OBBs.
+	double refit;		// Moving the broadphase proxies.
+	double broadphase;	// Finding the pairs whose bounds overlap.
+	double narrowphase;	// GJK (and EPA) on every pair, and gathering the contacts.
+	double solve;		// Bouncing the colliding objects apart (an island at a time), sweeping the fast ones, and putting still islands to sleep.
+	double integrate;	// Moving everything forward.
+	double maintenance;	// Upkeep spread over the steps, before the rest of the step (see PhysicsWorld::SetMaintenanceBudget).
+	double total;
+
+	int pairs;			// The pairs the broadphase found (that weren't skipped for sleeping).
+	int contacts;		// The pairs that were actually colliding.
+	int swept;			// The pairs with a fast object in them that got a time of impact test (or a distance query, for speculative contacts).
+	int impacts;		// The swept pairs that would have hit during the step.
+	int speculative;	// The speculative contacts made for fast pairs that weren't touching yet (see PhysicsWorld::SetSpeculativeContacts).
+	int sleeping;		// The objects that were asleep at the end of the step.
+	int islands;		// The groups of touching objects the contacts were split into, to be solved in parallel.
+	int overlaps;		// The pairs with a trigger in them that were overlapping.
+	int far;			// The objects that were far from every interest point (see PhysicsWorld::SetLevelOfDetail).
+	int skipped;		// The pairs that were still too far apart to have closed the gap, so weren't tested (see PhysicsWorld::SetQuerySkipping).
+	int moved;			// The objects that left their fat bounds, so had their proxies moved in the broadphase.
+	int allocations;	// The heap allocations made during the step, if the program counts them (see CountHeapAllocation). 0 once warmed up.
+	int overLimits;		// How many of the world's limits (objects, pairs and contacts) the step went over (see PhysicsWorld::SetLimits).
+	int predicted;		// The proxies moved ahead for the next step, to where their objects were heading (see PhysicsWorld::SetPipelinedBroadphase).
+	int idle;			// The objects in slow islands that sat the step out, to move on a later one (see PhysicsWorld::SetIslandRates).
+	int refined;		// The pairs whose boxes hit that were tested again with their hulls (see PhysicsWorld::SetHull).
+	int refinedMisses;	// The refined pairs whose hulls weren't touching after all, so had no contact.
+	int largeIslands;	// The islands big enough to be solved a color at a time across the threads (see PhysicsWorld::SetLargeIslandSize).
+
+	PhysicsStepStats()
+	{
+		transforms = refit = broadphase = narrowphase = solve = integrate = maintenance = total = 0.0;
+		pairs = 0;
+		contacts = 0;
+		swept = 0;
+		impacts = 0;
+		speculative = 0;
+		sleeping = 0;
+		islands = 0;
+		overlaps = 0;
+		far = 0;
+		skipped = 0;
+		moved = 0;
+		allocations = 0;
+		overLimits = 0;
+		predicted = 0;
+		idle = 0;
+		refined = 0;
+		refinedMisses = 0;
+		largeIslands = 0;
+	}
+};
+
+// A pair with a fast object in it that isn't touching at the start of a step, but would hit something partway through it. time is how far
+// into the step they touch, and normal points from a to b.
+struct SweptImpact
+{
+	int a;
+	int b;
+	float time;
+	glm::vec3 normal;
+
+	bool operator<(const SweptImpact& other) const
+	{
+		return time < other.time;
+	}
+};
+
+// What happened between a trigger and another object (or another trigger) this step: they started overlapping, were still overlapping, or
+// stopped. a and b are the two objects, a < b (see PhysicsWorld::IsTrigger for which is the trigger).
+enum TriggerEventType
+{
+	TRIGGER_ENTER,
+	TRIGGER_STAY,
+	TRIGGER_EXIT
+};
+
+struct TriggerEvent
+{
+	int a;
+	int b;
+	TriggerEventType type;
+};
+
+// A contact between two objects in the last step, as it came out of the solver: which objects (by number and by handle), where they
+// touched (the middle of the contact area), the normal from a to b, and the total impulse the solver pushed them apart with. a < b.
+struct ContactEvent
+{
+	int a;
+	int b;
+	BodyHandle bodyA;
+	BodyHandle bodyB;
+	glm::vec3 point;
+	glm::vec3 normal;
+	float impulse;
+};
+
+// What a ray or shape cast into the world hit first: which object, how far along the cast, and where on the object's surface (which faces
+// along normal).
+struct PhysicsCastHit
+{
+	int object;
+	float fraction;
+	glm::vec3 normal;
+	glm::vec3 point;
+
+	PhysicsCastHit()
+	{
+		object = -1;
+		fraction = 0.0f;
+		normal = glm::vec3(0.0f);
+		point = glm::vec3(0.0f);
+	}
+};
+
+// An explosion (see PhysicsWorld::Explode): everything within radius of center is pushed straight away from it, with an impulse that's
+// impulse right at the center and falls off evenly to nothing at radius.
+struct PhysicsExplosion
+{
+	glm::vec3 center;
+	float radius;
+	float impulse;
+
+	PhysicsExplosion()
+	{
+		center = glm::vec3(0.0f);
+		radius = 0.0f;
+		impulse = 0.0f;
+	}
+
+	PhysicsExplosion(const glm::vec3& c, float r, float i)
+	{
+		center = c;
+		radius = r;
+		impulse = i;
+	}
+};
+
+// One object an explosion pushed: which explosion, how far the object's OBB was from its center (0 if the center was inside it), and the
+// impulse it was given.
+struct PhysicsExplosionHit
+{
+	int explosion;
+	int object;
+	float distance;
+	glm::vec3 impulse;
+};
+
+// How much a world is set up to hold (see PhysicsWorld::SetLimits).
+struct PhysicsWorldLimits
+{
+	int objects;	// Objects, static or not.
+	int pairs;		// Pairs the broadphase finds in a step.
+	int contacts;	// Pairs that are actually colliding in a step.
+
+	PhysicsWorldLimits(int inObjects = 0, int inPairs = 0, int inContacts = 0)
+	{
+		objects = inObjects;
+		pairs = inPairs;
+		contacts = inContacts;
+	}
+};
+
+// Everything a step depends on that changes as the world runs, saved by PhysicsWorld::SaveState so that RestoreState can put the world back
+// the way it was (for rollback, where a late input means going back a few steps and running them again).
+// The bodies are already stored an array per field, and everything else the world keeps per object or per pair is in flat arrays too, so a
+// save or restore is a memcpy per array and no walking over objects. Keep the states around and save over them (in a ring of the last few
+// steps, say) rather than making new ones, so the arrays are only allocated the first time.
+// The settings (sleeping, continuous collision, the solver's and so on) aren't part of it: those are set by hand, not changed by stepping.
+class PhysicsWorldState
+{
+	friend class PhysicsWorld;
+
+	int objectCount;
+
+	BodyStore bodies;
+
+	std::vector<OBBShape> shapes;
+	std::vector<ShapeBounds> shapeBounds;
+	std::vector<glm::mat4> shapeTransforms;
+	std::vector<float> stillTimes;
+	std::vector<int> islandFirst;
+	std::vector<int> islandNext;
+	std::vector<unsigned char> wakeRequests;
+
+	// Only the broadphase that was in use is saved.
+	int broadphaseIndex;
+	std::vector<int> proxies;
+	AABBTree treeBroadphase;
+	SweepAndPrune sweepBroadphase;
+	HashGrid gridBroadphase;
+	LinearBVH linearBroadphase;
+	AABBTree staticTree;
+	QBVH staticFlat;
+	bool staticTreeChanged;
+
+	PairCache pairCache;
+
+	// The trigger pairs that were overlapping, which the next step's events are worked out against.
+	std::vector<BroadphasePair> overlaps;
+
+	// Which objects were enabled, and what type each disabled one goes back to.
+	std::vector<unsigned char> enabled;
+	std::vector<BodyType> disabledTypes;
+
+	glm::dvec3 origin;
+
+	// How many steps it had been since the far objects last stepped (see PhysicsWorld::SetLevelOfDetail).
+	int lodSteps;
+
+	// Which steps each object moves on, and how many it has sat out since it last did (see PhysicsWorld::SetIslandRates).
+	std::vector<unsigned char> stepIntervals;
+	std::vector<unsigned char> idleSteps;
+	int rateSteps;
+
+public:
+	PhysicsWorldState()
+	{
+		objectCount = 0;
+		broadphaseIndex = -1;
+		origin = glm::dvec3(0.0);
+		lodSteps = 0;
+		rateSteps = 0;
+		staticTreeChanged = false;
+	}
+
+	// Whether anything has been saved into this yet.
+	bool IsSaved() const
+	{
+		return broadphaseIndex != -1;
+	}
+};
+
+// Everything it takes to simulate a scene of boxes, with nothing to do with drawing them: the bodies, an OBB around each one, the broadphases,
+// the narrowphase and the job system it runs on. This is the whole physics step that used to live in the demo's update, so it can run on its
+// own with no window or OpenGL at all (on a server, or in a benchmark), and the demo just draws what it does.
+// Every object is a body in Bodies() with a box around it (in the body's local space). Objects are numbered in the order they're added, and
+// that number is what the broadphase pairs and the contacts refer to.
+class PhysicsWorld
+{
+	// Saves and loads the arrays straight from a file (see WorldSnapshot).
+	friend class WorldSnapshot;
+
+	BodyStore bodies;
+
+	// Where (0, 0, 0) is, in the coordinates the world started out in (see ShiftOrigin). It's kept in doubles, since it's what every
+	// position far from the start is measured from.
+	glm::dvec3 origin;
+
+	// The body of each object, and its box in local space.
+	std::vector<BodyHandle> handles;
+	std::vector<glm::vec3> boxCenters;
+	std::vector<glm::vec3> boxHalfExtents;
+
+	// Which objects each object collides with. Every broadphase is given these, and leaves out the pairs that can't collide.
+	std::vector<CollisionFilter> filters;
+
+	// Whether each object is enabled (see SetEnabled). A disabled object has no proxy (its proxy is -1), and its body is made static so
+	// the step leaves it alone; disabledTypes is the type it goes back to when it's enabled again.
+	std::vector<unsigned char> enabled;
+	std::vector<BodyType> disabledTypes;
+
+	// Each object's proxy in the current broadphase (or the static tree, for a static object), its OBB as of the start of the current step (and the bounds around it), and its
+	// transform.
+	std::vector<int> proxies;
+	std::vector<OBBShape> shapes;
+	std::vector<ShapeBounds> shapeBounds;
+	std::vector<const glm::mat4*> transforms;
+
+	// The transform each object's OBB was last built from. Each step only rebuilds the OBBs of the objects whose transforms no longer match,
+	// so objects that haven't moved (or turned, or changed size) cost a compare and nothing more.
+	std::vector<glm::mat4> shapeTransforms;
+
+	// The broadphase keeps track of every object's bounds, so each step only the pairs of objects whose bounds overlap ever get to GJK.
+	// There are four to choose from (see SetBroadphase).
+	AABBTree treeBroadphase;
+	SweepAndPrune sweepBroadphase;
+	HashGrid gridBroadphase;
+	LinearBVH linearBroadphase;
+	Broadphase* broadphase;
+	int broadphaseIndex;
+
+	// The AABB tree's proxies are refit in place (see AABBTree::SetRefitInPlace), which is far quicker than re-inserting them but leaves the
+	// tree a little looser every step. Every treeRebuildInterval steps it's built from scratch again (see AABBTree::Rebuild), across the
+	// threads, during the refit. With an interval of 0 it's never rebuilt, so the proxies are re-inserted instead, to keep the tree in
+	// shape as they go. treeRebuilding is whether this step's rebuild still needs finishing.
+	int treeRebuildInterval;
+	int stepsSinceTreeRebuild;
+	bool treeRebuilding;
+
+	// With a maintenance budget (see SetMaintenanceBudget), the tree is put back in shape a slice at a time instead, every
+	// treeRebuildInterval steps.
+	MaintenanceScheduler maintenance;
+	TreeOptimizeTask treeOptimize;
+	int treeOptimizeTask;
+	double maintenanceBudget;
+
+	// The static objects (see SetBodyType) aren't in the broadphase, but in a tree of their own that only changes when one is added or moved
+	// by hand. The broadphase never has to refit them or pair them with each other; each step the objects that can move are looked up in
+	// the static tree instead, and what they find (staticPairs) is merged into the pairs.
+	// Static objects are added one at a time, usually all while a level is being set up, so rather than keep the tree the inserts left, the
+	// next step rebuilds it all at once with the surface area heuristic (see AABBTree::Rebuild) whenever staticTreeChanged says it has
+	// changed. Every step's lookups go through it, so that pays for itself straight away.
+	// The lookups don't even go through the tree itself, but staticFlat, a flattened four-wide copy of it (see QBVH) made after each rebuild.
+	AABBTree staticTree;
+	QBVH staticFlat;
+	bool staticTreeChanged;
+	std::vector<BroadphasePair> staticPairs;
+	std::vector<BroadphasePair> mergedPairs;
+
+	// The lookups in the static tree are split across the threads, and each thread keeps what it finds to itself until they're merged.
+	std::vector<std::vector<BroadphasePair> > threadStaticPairs;
+
+	// Which objects' bounds have left their proxies' fat bounds this step. That's checked for every object across the threads (in the
+	// transform stage), so that the refit, which changes the broadphase and can only run on one thread, only has to visit the ones that moved.
+	std::vector<unsigned char> proxyMoves;
+
+	// With the broadphase pipelined (see SetPipelinedBroadphase), the transform stage also works out where each object's proxy should be for
+	// the next step if it carries on the way it's going (predictedBounds, stretched by predictedTravel), for the objects it's worth doing for
+	// (predictMoves). predicting is whether this step is doing that. The tree's pairs for the next step are found in the meantime, into
+	// predictedPairs, and the pairs that dropped out are kept in predictedRemovedPairs until the step ends and the pair cache is free.
+	// Objects that fall asleep during the step have their proxies moved in sleepMoves once it ends, too, since the tree is busy until then.
+	bool pipelined;
+	bool predicting;
+	std::vector<unsigned char> predictMoves;
+	std::vector<AABB> predictedBounds;
+	std::vector<glm::vec3> predictedTravel;
+	std::vector<BroadphasePair> predictedPairs;
+	std::vector<BroadphasePair> predictedRemovedPairs;
+	std::vector<int> sleepMoves;
+
+	// Where the kinematic objects have been told to be by the end of the next step (see SetKinematicTarget).
+	struct KinematicTarget
+	{
+		int object;
+		glm::vec3 position;
+		glm::quat orientation;
+	};
+	std::vector<KinematicTarget> kinematicTargets;
+
+	// What other threads have asked to be changed before the next step (see Commands).
+	PhysicsCommandQueue commands;
+
+	std::vector<BroadphasePair> pairs;
+
+	// Remembers the last separating axis between each pair of objects, so each step's GJK test can check it first, and how many steps a
+	// pair can go without being tested before it's forgotten.
+	PairCache pairCache;
+	int pairCacheMaxAge;
+
+	// The worker threads, whether the world started them itself (or is sharing someone else's), and the narrowphase that runs the collision
+	// tests for each step's pairs across them.
+	JobSystem* jobs;
+	bool ownsJobs;
+	Narrowphase<OBBShape>* narrowphase;
+
+	std::vector<NarrowphaseContact> contacts;
+
+	// Whether each object is a trigger, the trigger pairs that were overlapping in the last step and the step before, and the events
+	// worked out from the difference.
+	std::vector<unsigned char> triggers;
+	std::vector<BroadphasePair> overlaps;
+	std::vector<BroadphasePair> lastOverlaps;
+	std::vector<TriggerEvent> triggerEvents;
+
+	// Each object's hull, for the pairs its box hits (see SetHull). An object without one has a HullShape with no points.
+	std::vector<HullShape> hulls;
+
+	// The contacts from the last step, with what the solver did about them, for gameplay to go through once the step is over.
+	std::vector<ContactEvent> contactEvents;
+
+	// A contact solver for each thread, to solve the islands with, and each object's number in the solver it's in (or -1) while its
+	// island is being solved.
+	std::vector<ContactSolver> solvers;
+	std::vector<int> solverBodies;
+
+	// The islands with at least largeIslandContacts contacts this step (0 for none), and a solver for each, the first for the first one and
+	// so on. They're kept from step to step, so a big pile that's still there next step lands in the same solver, which can use its colors
+	// again.
+	int largeIslandContacts;
+	std::vector<int> largeIslands;
+	std::vector<ContactSolver> largeIslandSolvers;
+
+	// Whether to skip the narrowphase for pairs where neither object is moving.
+	bool degraded;
+
+	// Whether to leave out everything that depends on more than the inputs (see SetDeterministic).
+	bool deterministic;
+
+	// Continuous collision: whether it's on, how far an object has to move in one step (as a fraction of its smallest half extent) to count
+	// as fast, which objects are fast this step, and the impacts the fast ones would have had.
+	bool continuous;
+	float continuousThreshold;
+	std::vector<unsigned char> fastObjects;
+	std::vector<unsigned char> impacted;
+	std::vector<SweptImpact> impacts;
+	TimeOfImpactSolver timeOfImpact;
+	int sweptPairs;
+
+	// Whether the fast objects' pairs get speculative contacts instead of being swept (see SetSpeculativeContacts), the solver for their
+	// distance queries, and how many were made in the last step.
+	bool speculative;
+	GJKDistanceSolver distanceSolver;
+	int speculativeContacts;
+
+	// Query skipping (see SetQuerySkipping): whether it's on, how far each object could have moved since the last step's narrowphase, and
+	// how far each has been moved since the transform stage last looked (by updateShape and updateShapes), which the next one picks up.
+	bool querySkipping;
+	std::vector<float> shapeMotion;
+	std::vector<float> pendingMotion;
+
+	// Level of detail (see SetLevelOfDetail): how far an object has to be from every interest point to be far (or 0 for never), how many
+	// steps each of a far object's steps stands for, the interest points, how many steps it's been since the far objects last stepped, and
+	// which objects are far this step.
+	float lodDistance;
+	int lodInterval;
+	std::vector<glm::vec3> interestPoints;
+	int lodSteps;
+	std::vector<unsigned char> farObjects;
+
+	// Islands that are only moving slowly are stepped every so often instead (see SetIslandRates). At the end of each step, every awake object
+	// is given the interval its island can go between steps (stepIntervals, a power of two), and it moves on the steps where rateSteps is a
+	// multiple of that, by every step since it last moved (idleSteps of them, and this one). Since the intervals are all powers of two, the
+	// objects with the same one always move together.
+	float slowIslandSpeed;
+	int slowIslandInterval;
+	std::vector<unsigned char> stepIntervals;
+	std::vector<unsigned char> idleSteps;
+	int rateSteps;
+
+	// Sleeping (see SetSleeping): whether it's on, how slow an object has to be going to count as still, how long it has to stay still
+	// before it can sleep, and how long each object has been still.
+	bool sleepEnabled;
+	float sleepVelocity;
+	float sleepTime;
+	std::vector<float> stillTimes;
+
+	// The sleeping objects are kept in islands (objects that were touching each other when they fell asleep), which wake up together.
+	// Each sleeping object knows the first object in its island, and the next one after it (or -1 for the last).
+	std::vector<int> islandFirst;
+	std::vector<int> islandNext;
+
+	// The sleeping objects that were moved by hand (or given a velocity) since the last step. These are found while the OBBs are being
+	// rebuilt, across threads, so they're only marked there and then woken up before the refit.
+	std::vector<unsigned char> wakeRequests;
+
+	// Each step's islands: groups of objects joined by contacts (see buildIslands). Each object has a parent in the union-find, which
+	// leads up to the root of its island.
+	std::vector<int> islandParents;
+
+	// The contacts grouped by island, so each island can be solved on its own: island i's contacts are
+	// contacts[islandContacts[islandStarts[i]]] up to (but not including) contacts[islandContacts[islandStarts[i + 1]]]. islandIds is
+	// which island each root is (or -1), only while they're being built.
+	std::vector<int> islandIds;
+	std::vector<int> islandStarts;
+	std::vector<int> islandContacts;
+
+	// For putting islands to sleep: for the root of each island, how long its least still object has been still and the last object put
+	// to sleep in it so far.
+	std::vector<float> islandStillTimes;
+	std::vector<int> islandLast;
+
+	// For casts: the objects the broadphase says a cast might hit, and the solver that casts against each of them.
+	std::vector<int> castCandidates;
+	std::vector<int> castStaticCandidates;
+
+	// The static objects Cull found, before they're added to the rest.
+	std::vector<int> visibleStatic;
+	ShapeCastSolver castSolver;
+
+	// The ray cast cache (see SetRayCastCache): each ray that's kept, with its hit, the objects the broadphase gave it and their OBBs as
+	// they were then. The entries not in use are in freeRayCasts. rayCastTree has a proxy for each ray's box, which is how a ray is found
+	// again, and how the rays a change could reach are found.
+	struct CachedRayCast
+	{
+		glm::vec3 from;
+		glm::vec3 to;
+		PhysicsCastHit hit;
+		int proxy;		// In rayCastTree, or -1 if the entry isn't in use.
+		int lastUsed;	// The rayCastStep it was last cast on.
+		std::vector<int> candidates;
+		std::vector<OBBShape> candidateShapes;
+	};
+
+	std::vector<CachedRayCast> rayCasts;
+	std::vector<int> freeRayCasts;
+	std::vector<int> rayCastsFound;
+	AABBTree rayCastTree;
+	int rayCastCapacity;
+	int rayCastCount;
+	int rayCastStep;
+	long long rayCastHits;
+	long long rayCastMisses;
+
+	// RayCast with the cache on: gives back the kept hit if there's one that's still good, and otherwise casts the ray and keeps it.
+	bool cachedRayCast(const glm::vec3& from, const glm::vec3& to, PhysicsCastHit& hit);
+
+	// Drops every kept ray whose box bounds overlaps, since whatever changed there could now be in its way. (Nothing to do while the cache
+	// is empty, which is checked here so that callers don't have to.)
+	void invalidateRayCasts(const AABB& bounds);
+	void removeRayCast(int entry);
+	void clearRayCasts();
+
+	// At the end of a step: drops the rays that haven't been cast for RAY_CAST_IDLE_STEPS steps.
+	void ageRayCasts();
+
+	// For OverlapSphere: the candidates' OBBs, laid out for testing a Lanes' worth at a time (see SIMDLanes.h), with one array for each of
+	// an OBB's floats (its center, then its axes, then its half extents), padded out to a whole number of Lanes.
+	static const int OVERLAP_BOX_FLOATS = 15;
+	std::vector<float> overlapBoxes[OVERLAP_BOX_FLOATS];
+
+	// For Explode: the objects each explosion reaches, how far away they are, and the impulses, before they're all applied.
+	std::vector<int> explosionObjects;
+	std::vector<float> explosionDistances;
+	std::vector<PhysicsExplosionHit> explosionHits;
+
+	// Times the stages of each step.
+	SteadyClock timer;
+	PhysicsStepStats stats;
+
+	// How the GJK queries went in the last step, if the narrowphase is counting them, and what its shadow checks found.
+	GJKStats gjkStats;
+	ShadowCheckStats shadowStats;
+
+	// The most expensive pairs so far in this window of steps, and in the last whole one (see SetPairCosts), how many of them are kept, how
+	// many steps a window is, and how many steps into this one we are.
+	std::vector<PairCost> windowPairCosts;
+	std::vector<PairCost> pairCostReport;
+	int pairCostCount;
+	int pairCostWindow;
+	int pairCostSteps;
+
+	// Whether the steps are being run by Advance, which leaves out everything that's only there for someone watching them (see Advance).
+	bool fastForward;
+
+	// What SetLimits made room for (all 0 if it hasn't been called).
+	PhysicsWorldLimits limits;
+
+	// Rebuilds one object's OBB and transform pointer from its body.
+	void updateShape(int object);
+
+	// Picks up the transform pointers of the objects in [begin, end), and rebuilds the OBBs of the ones that have moved, all at once (see
+	// BuildOBBShapes).
+	void updateShapes(int begin, int end);
+
+	// Pushes two colliding objects apart, and adds their contact to solver.
+	void resolve(const NarrowphaseContact& contact, ContactSolver& solver, float dt);
+
+	// Adds an object to solver, if it isn't in it already, and returns its number there.
+	int solverBody(int object, ContactSolver& solver);
+
+	// Adds every contact in an island to solver (see resolve), and afterward forgets the numbers it gave the island's objects.
+	void resolveIsland(int island, ContactSolver& solver, float dt);
+	void forgetSolverBodies(int island);
+
+	// Whether an island is solved on its own, a color at a time across the threads (see SetLargeIslandSize).
+	bool isLargeIsland(int island) const
+	{
+		return largeIslandContacts > 0 && islandStarts[island + 1] - islandStarts[island] >= largeIslandContacts;
+	}
+
+	// The broadphase an object's proxy is in.
+	Broadphase* proxyBroadphase(int object)
+	{
+		return bodies.GetType(handles[object]) == BODY_STATIC ? &staticTree : broadphase;
+	}
+
+	// The bounds an object's proxy has to hold this step.
+	AABB proxyBounds(int object, float dt);
+
+	// Looks up the objects from begin up to end that can move in the static tree, and adds the pairs they find to the thread's list.
+	void findStaticPairs(int begin, int end, int thread);
+
+	// Adds the pairs every thread found with findStaticPairs to pairs, keeping them sorted.
+	void mergeStaticPairs();
+
+	// Reflects the velocities of two objects about the normal between them (pointing from a to b), if they're moving into each other.
+	// This is for the fast objects' impacts, which happen partway through the step rather than at the start of it like the contacts.
+	void bounce(int a, int b, const glm::vec3& normal);
+
+	// The velocity an object will move at over this step, once Integrate has added its acceleration.
+	glm::vec3 stepVelocity(int object, float dt);
+
+	// The fastest any point of an object's box moves because of its spin alone: its angular speed times how far the box reaches from its
+	// center. Added to the speed of the center, that's the most any of it can move.
+	float spinSpeed(int object);
+
+	// Whether an object moves far enough this step that it could pass right through something.
+	bool isFast(int object, float dt);
+
+	// Whether the level of detail is on, and whether an object is far from every interest point this step.
+	bool hasLevelOfDetail() const
+	{
+		return lodDistance > 0.0f && !interestPoints.empty();
+	}
+	bool isFar(int object);
+
+	// How much time an object moves through in this step: dt, or a multiple of it (or none) if it's far (see SetLevelOfDetail) or in a slow
+	// island (see SetIslandRates).
+	float objectStep(int object, float dt)
+	{
+		return dt * bodies.GetTimeScale(handles[object]);
+	}
+
+	// Finds when the pairs with a fast object in them would first touch during the step, and stops each fast object there (see
+	// SetContinuousCollision).
+	void sweep(float dt);
+
+	// Instead of sweep: gives each pair with a fast object in it that isn't touching, but is closing faster than the gap between them can
+	// take in one step, a contact with a negative depth, and merges those in with the contacts (see SetSpeculativeContacts).
+	void addSpeculativeContacts(float dt);
+
+	// Whether both objects in a pair are asleep (or, in degraded mode, sitting still).
+	bool isSleepingPair(const BroadphasePair& pair);
+
+	// Follows an object up the union-find to the root of its island.
+	int findIsland(int object);
+
+	// The root of the island a contact is solved in.
+	int contactIsland(const NarrowphaseContact& contact);
+
+	// Whether an object touching a sleeping one wakes it up: it has to be awake, and either able to be pushed around or moving. (Otherwise
+	// everything sleeping on the floor would be woken up by the floor.)
+	bool canWake(int object);
+
+	// Works out the trigger events, from which trigger pairs were overlapping in the last step and which are now.
+	void buildTriggerEvents();
+
+	// Fills in contactEvents from the contacts, once the solver is done with them.
+	void buildContactEvents();
+
+	// Wakes up an object, and everything in its island along with it, if it's asleep.
+	void wakeIsland(int object);
+
+	// Joins the objects in each contact into islands, and groups the contacts by island.
+	void buildIslands();
+
+	// Gives every thread's solver room for the most objects and points any of them has had. Which thread solves which islands is down to
+	// scheduling, so otherwise each one would keep growing the first time it happened to get the biggest job.
+	void reserveSolvers();
+
+	// Works out which objects have been still for long enough, and puts to sleep every island whose objects have all been still for
+	// sleepTime.
+	void updateSleep(float dt);
+
+	// Gives every awake object the interval its island can go between steps next time, from how fast the fastest object in it is going
+	// (see SetIslandRates).
+	void updateStepRates(float dt);
+
+	// Sets up everything but the job system, which the constructors pick.
+	void initialize();
+
+public:
+	static const int NUM_BROADPHASES = 4;
+
+	// The longest a slow island can go between steps (see SetIslandRates).
+	static const int MAX_STEP_INTERVAL = 64;
+
+	// How many steps a kept ray can go without being cast before the ray cast cache drops it (see SetRayCastCache).
+	static const int RAY_CAST_IDLE_STEPS = 8;
+
+	// Starts the job system with threadCount threads in total, counting the calling thread (0 means one per hardware thread).
+	// The thread that calls Step has to be the only one (apart from the workers) that uses the job system.
+	PhysicsWorld(int threadCount = 0);
+
+	// Runs on a job system that's shared with other worlds, rather than starting one of its own (which it has to outlive). A server with
+	// many small matches can give each one a world of its own on the same set of threads, and step them all at once with StepWorlds.
+	// The world keeps one of a few buffers per thread of the job system, so it's the same size whichever way it was made.
+	explicit PhysicsWorld(JobSystem& sharedJobs);
+	~PhysicsWorld();
+
+	// Adds an object: a new body (at the origin, not moving, not rotated, with a scale of 1) with a box around it, in the body's local space,
+	// of the given center and half extents. Returns the object's number.
+	// Once you've moved the new bodies where they go, call Refresh so the broadphase knows.
+	int AddBox(const glm::vec3& center, const glm::vec3& halfExtents);
+
+	// The same, but with the body starting out at the given position, orientation and scale. Its shape and proxy are made there, so there's
+	// no need to Refresh for it.
+	int AddBox(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& position, const glm::quat& orientation,
+		const glm::vec3& scale);
+
+	// Makes room for count objects in total, so adding that many doesn't have to keep growing every array (or picking up every transform
+	// pointer again each time the bodies' arrays move).
+	void Reserve(int count);
+
+	// Sets aside the memory for everything the world keeps, and everything a step uses, all at once, sized for newLimits: for consoles and
+	// other targets where memory is budgeted up front. A world that stays inside its limits never touches the heap again once its objects
+	// are added, not even in its first step, or when a pile-up finds more pairs than it ever has before. (Without limits, each array grows
+	// to what the scene needs over the first few steps, and again whenever it needs more.)
+	// Going over a limit still works, since the arrays just grow as they always have, but every step that does says so (see
+	// PhysicsStepStats::overLimits), so a build that mustn't allocate can catch it in testing. Only the broadphase in use gets room; one
+	// picked with SetBroadphase afterward gets its room then. Call it before adding the objects.
+	void SetLimits(const PhysicsWorldLimits& newLimits);
+	const PhysicsWorldLimits& GetLimits() const
+	{
+		return limits;
+	}
+
+	int NumObjects() const
+	{
+		return (int)handles.size();
+	}
+
+	BodyStore& Bodies()
+	{
+		return bodies;
+	}
+
+	BodyHandle GetBody(int object) const
+	{
+		return handles[object];
+	}
+
+	// An object's box, in its body's local space.
+	const glm::vec3& GetBoxCenter(int object) const
+	{
+		return boxCenters[object];
+	}
+	const glm::vec3& GetBoxHalfExtents(int object) const
+	{
+		return boxHalfExtents[object];
+	}
+
+	// Each object's OBB, as of the start of the last step (or the last Refresh).
+	const std::vector<OBBShape>& GetShapes() const
+	{
+		return shapes;
+	}
+
+	// How an object moves (see BodyType). Objects start out dynamic.
+	// A static object's body is left alone by the step: it isn't integrated, and its proxy goes in a tree of its own rather than the
+	// broadphase, so a level full of static walls and floors costs nothing to refit, and only adds a tree lookup for each object that can
+	// move. It's given an inverse mass of 0, and no velocity. Moving one by hand still works (its proxy is moved to match), but is slower
+	// than moving a kinematic one, and doesn't wake up whatever is asleep on it.
+	// A kinematic object is given an inverse mass of 0, so nothing can push it, but still moves with its velocity. Making an object dynamic
+	// again gives it an inverse mass of 1 if it had none.
+	void SetBodyType(int object, BodyType type);
+	BodyType GetBodyType(int object) const
+	{
+		return enabled[object] ? bodies.GetType(handles[object]) : disabledTypes[object];
+	}
+
+	// Takes an object out of the world (or puts it back), without changing any object's number. A disabled object is in no broadphase, so
+	// it costs nothing to step and is never paired, hit by a cast or culled, and its body stays exactly where it was (velocity and all)
+	// until it's enabled again and carries on. Whatever was asleep on it is woken up.
+	// Objects can't be removed, so this is also how a slot is freed to be used again (see SetBox), which is what WorldStreamer does with
+	// the objects of the regions it unloads.
+	void SetEnabled(int object, bool enable);
+	bool IsEnabled(int object) const
+	{
+		return enabled[object] != 0;
+	}
+
+	// Changes an object's box (in its body's local space), and moves its proxy to match.
+	void SetBox(int object, const glm::vec3& center, const glm::vec3& halfExtents);
+
+	// Moves a kinematic object to position and orientation over the next step. Its velocity is set so that it gets there by the end of the
+	// step (which is what anything it pushes is pushed with), and it's turned to face orientation from the start of the step. Without
+	// another target it carries on at that velocity. Only lasts for the next step.
+	void SetKinematicTarget(int object, const glm::vec3& position, const glm::quat& orientation)
+	{
+		KinematicTarget target;
+		target.object = object;
+		target.position = position;
+		target.orientation = orientation;
+
+		kinematicTargets.push_back(target);
+	}
+
+	// Sets the velocity of each kinematic object with a target so it gets there in a step of dt, and turns it to face the target's way.
+	// Step does this itself, first thing; it only needs calling to see what the targets do to the bodies before the step (which is what
+	// SimulationRecorder does).
+	void ApplyKinematicTargets(float dt);
+
+	// Where other threads push their changes to the world's objects, to be made between steps (see PhysicsCommandQueue). Any thread can
+	// push to it at any time, even mid-step.
+	PhysicsCommandQueue& Commands()
+	{
+		return commands;
+	}
+
+	// Makes every change that's been pushed to Commands, in the order they were pushed. This is the one point where other threads' changes
+	// get made, so call it from the thread that steps the world, between steps (SimulationRecorder::Step calls it itself, before it looks
+	// for what's changed, so they're recorded too). A command for an object that doesn't exist is ignored.
+	void ApplyCommands();
+
+	// Fills visible with every object whose bounds are at least partly inside the frustum, from both the broadphase and the static
+	// objects' tree. (See Broadphase::Cull.)
+	void Cull(const Frustum& frustum, std::vector<int>& visible);
+
+	// The same, but the static objects go through a vector of the caller's own first, so more than one thread can cull at once (each with
+	// its own vectors), as long as none of them is stepping the world.
+	void Cull(const Frustum& frustum, std::vector<int>& visible, std::vector<int>& visibleStatic) const;
+
+	// Which objects an object collides with (see CollisionFilter). Every object starts out on layer 1, colliding with everything. The pairs
+	// that can't collide are left out by the broadphase as it finds them, so they never cost a GJK test (or a sort, or a pair cache
+	// lookup). A change takes effect from the next step.
+	void SetCollisionFilter(int object, const CollisionFilter& filter)
+	{
+		filters[object] = filter;
+
+		// The broadphase keeps the pairs it found from step to step, so it has to be told to look at this object's again.
+		if (enabled[object])
+		{
+			proxyBroadphase(object)->TouchProxy(proxies[object]);
+		}
+	}
+	const CollisionFilter& GetCollisionFilter(int object) const
+	{
+		return filters[object];
+	}
+
+	// The box around an object's OBB.
+	AABB GetBounds(int object) const
+	{
+		return shapeBounds[object].box;
+	}
+
+	// The pairs the broadphase found, and the contacts between the ones that were actually colliding, in the last step.
+	const std::vector<BroadphasePair>& GetPairs() const
+	{
+		return pairs;
+	}
+	const std::vector<NarrowphaseContact>& GetContacts() const
+	{
+		return contacts;
+	}
+
+	// Triggers (or sensors) are objects that only need to know what's in them, like a checkpoint or a pickup's area. A pair with a trigger in
+	// it stops at the boolean GJK test: it never gets EPA, a manifold, a contact, or the solver, so nothing bounces off a trigger, and a
+	// trigger doesn't get pushed around or swept against. Triggers are never skipped for sleeping, so a trigger still sees what's asleep in
+	// it. Objects aren't triggers to begin with. A change takes effect from the next step.
+	void SetTrigger(int object, bool trigger)
+	{
+		triggers[object] = trigger ? 1 : 0;
+	}
+	bool IsTrigger(int object) const
+	{
+		return triggers[object] != 0;
+	}
+
+	// Gives an object the convex hull of its model, for the pairs where its box isn't close enough. The box test stays as it is, and is
+	// all the pairs that miss (which is most of them) ever cost, but a pair whose boxes hit is tested again with the hull (and whatever
+	// the other object has, its own hull or its box), and only collides if that does too. Its contact comes from the hull as well, so
+	// things rest on the model rather than the corners of the box around it. (See Narrowphase::SetHulls.)
+	// The points are in the model's own space, the same as the box's center, and have to be inside the box. The world only points at them,
+	// so they have to stay where they are until the hull is taken away again (with no points) or the world is gone: a ConvexHull's Points,
+	// or a SharedMesh's hullPoints, are the usual place. Ray casts and the other queries still only see the box, and so do pairs simplified
+	// for being far away (see SetLevelOfDetail). Objects don't have hulls to begin with, and hulls aren't saved with the world (see
+	// WorldSnapshot). A change takes effect from the next step.
+	void SetHull(int object, const glm::vec3* points, int numPoints)
+	{
+		hulls[object] = numPoints > 0 ? HullShape(points, numPoints) : HullShape();
+
+		if (numPoints > 0)
+		{
+			narrowphase->SetHulls(&hulls);
+		}
+	}
+	const HullShape& GetHull(int object) const
+	{
+		return hulls[object];
+	}
+
+	// Every pair with a trigger in it that started overlapping, went on overlapping or stopped overlapping in the last step, all together
+	// in pair order, rather than a call per pair. A pair that was overlapping and then had its trigger turned off (or its filters changed
+	// so it can't collide) gets an exit like any other.
+	const std::vector<TriggerEvent>& GetTriggerEvents() const
+	{
+		return triggerEvents;
+	}
+
+	// Every contact from the last step, in pair order, with the impulse the solver used on it. The step never calls out to gameplay
+	// code; anything that wants to react to a hit (sounds, damage, sparks) reads these after Step returns and handles them all at once.
+	// They're only good until the next step.
+	const std::vector<ContactEvent>& GetContactEvents() const
+	{
+		return contactEvents;
+	}
+
+	// The broadphase in use, and which one it is: 0 is the AABB tree, 1 is sweep and prune, 2 is the hash grid and 3 is the linear BVH.
+	Broadphase* GetBroadphase() const
+	{
+		return broadphase;
+	}
+	int GetBroadphaseIndex() const
+	{
+		return broadphaseIndex;
+	}
+
+	// The name of one of the broadphases (see SetBroadphase). This never changes, so it's safe to call from any thread.
+	const char* GetBroadphaseName(int index) const;
+
+	// Moves every object over to a different broadphase.
+	void SetBroadphase(int index);
+
+	// In degraded mode, the pairs where neither object is moving (both "asleep") skip the narrowphase. Whatever they were doing to each
+	// other last step, they aren't going to start doing anything new without moving. (See StepScheduler, which decides when to degrade.)
+	// Ignored in deterministic mode.
+	void SetDegraded(bool inDegraded)
+	{
+		degraded = inDegraded && !deterministic;
+	}
+	bool IsDegraded() const
+	{
+		return degraded;
+	}
+
+	// Deterministic mode, for lockstep (where every peer runs the same steps from the same inputs, and only the inputs are sent over the
+	// wire) and for replays. A step already comes out the same however many threads it runs on: every broadphase gives its pairs back
+	// sorted, the contacts are sorted by pair after the narrowphase, and the islands are numbered in contact order and always split into
+	// the same jobs, so nothing depends on which thread got where first. What's left is anything that depends on time, which with this on
+	// is ignored: that's degraded mode, since when it kicks in depends on how long the steps take to run.
+	// Peers still have to agree on everything set by hand (the broadphase, the solver's settings, the GJK precision and so on), and run builds
+	// that do the math the same way: the same instruction sets, and no fused multiply-adds, which round differently. (MSVC only fuses them
+	// with /fp:contract, which the projects leave off. GCC and Clang need -ffp-contract=off.)
+	void SetDeterministic(bool enabled)
+	{
+		deterministic = enabled;
+
+		if (deterministic)
+		{
+			degraded = false;
+		}
+	}
+	bool IsDeterministic() const
+	{
+		return deterministic;
+	}
+
+	// A hash of every object's position, orientation, velocity and whether it's asleep, bit for bit. Peers in lockstep can compare these
+	// every so often, to find out as soon as they've drifted apart.
+	unsigned long long StateHash();
+
+	// Saves everything stepping changes into state (see PhysicsWorldState), overwriting whatever it held.
+	void SaveState(PhysicsWorldState& state) const;
+
+	// Puts the world back the way it was when state was saved. The last step's pairs, contacts and impacts are cleared, since they went with
+	// the state being thrown away. The state has to have been saved from this world with the same objects in it (objects added since then
+	// can't be taken back out), otherwise this does nothing and returns false.
+	bool RestoreState(const PhysicsWorldState& state);
+
+	// Continuous collision detection. Each step only tests where objects are at the start of it, so an object that moves farther than its own
+	// size in one step can jump straight over something thin without ever being seen to overlap it. With this on (which it is by default),
+	// any object that moves more than threshold times its smallest half extent in a step is fast: its broadphase bounds cover the whole
+	// distance it moves, and each pair it's in that isn't already colliding gets a time of impact query (see TimeOfImpactSolver). If it
+	// would hit something, it moves up to that point, bounces, and spends the rest of the step moving away.
+	// Only the fast objects pay for this, so the fixed step can stay large without things tunneling, rather than making every step smaller.
+	void SetContinuousCollision(bool enabled, float threshold = 1.0f)
+	{
+		continuous = enabled;
+		continuousThreshold = threshold;
+	}
+	bool IsContinuousCollision() const
+	{
+		return continuous;
+	}
+	float GetContinuousThreshold() const
+	{
+		return continuousThreshold;
+	}
+
+	// Speculative contacts, a cheaper way of doing the continuous collision. Rather than a time of impact query, each pair with a fast object
+	// in it that isn't touching gets one GJK distance query at the start of the step. If they're closing faster than the gap between them
+	// can take in a step, the pair gets a contact anyway, with a depth of minus the gap: the solver lets them close that gap and no more, so
+	// they end the step touching rather than through each other. It's one query per pair and nothing partway through the step.
+	// The catch is that the object only arrives with the speed it needed to close the gap, so it bounces less than it would have, and the
+	// contact is made along the closest points at the start of the step, so something that's spinning fast or passing at an angle can be
+	// stopped by a surface it would have missed. It does nothing unless continuous collision is on, since that's what decides which objects
+	// are fast. The speculative contacts are in GetContacts (marked speculative), but they never make contact events.
+	void SetSpeculativeContacts(bool enabled)
+	{
+		speculative = enabled;
+	}
+	bool IsSpeculativeContacts() const
+	{
+		return speculative;
+	}
+
+	// Query skipping: a pair that GJK finds separated has the gap between them measured, and then isn't tested again until its two objects
+	// could have moved far enough (going by how far each one's transform changed, turning included) to close it (see
+	// Narrowphase::SetMotion). For objects that are drifting apart slowly, or resting near each other without touching, that takes most of
+	// their GJK queries out of the step. It's on by default. Changing an object's box by hand (SetBox)
+	// makes its pairs be tested again.
+	void SetQuerySkipping(bool enabled)
+	{
+		querySkipping = enabled;
+		narrowphase->SetMotion(enabled ? &shapeMotion : nullptr);
+	}
+	bool IsQuerySkipping() const
+	{
+		return querySkipping;
+	}
+
+	// The contact solver's settings (see ContactSolver): how many iterations it runs, how many substeps it splits each step into, how bouncy
+	// collisions are, whether it warm starts, and whether it solves the points SOLVER_LANES at a time.
+	// By default that's 4 iterations in one step, perfectly bouncy, with warm starting and batching. For tall stacks, try 4 substeps of 1
+	// iteration each instead. Every object's mass is in the BodyStore (see
+	// InverseMass).
+	void SetSolverIterations(int iterations)
+	{
+		for (int i = 0; i < (int)solvers.size(); i++)
+		{
+			solvers[i].SetIterations(iterations);
+		}
+	}
+	void SetSolverSubsteps(int substeps)
+	{
+		for (int i = 0; i < (int)solvers.size(); i++)
+		{
+			solvers[i].SetSubsteps(substeps);
+		}
+	}
+	void SetRestitution(float restitution, float threshold = 0.1f)
+	{
+		for (int i = 0; i < (int)solvers.size(); i++)
+		{
+			solvers[i].SetRestitution(restitution, threshold);
+		}
+	}
+	void SetWarmStarting(bool enabled)
+	{
+		for (int i = 0; i < (int)solvers.size(); i++)
+		{
+			solvers[i].SetWarmStarting(enabled);
+		}
+	}
+	void SetSolverBatching(bool enabled)
+	{
+		for (int i = 0; i < (int)solvers.size(); i++)
+		{
+			solvers[i].SetBatching(enabled);
+		}
+	}
+	const ContactSolver& GetSolverSettings() const
+	{
+		return solvers[0];
+	}
+
+	// How many contacts an island needs to be solved on its own, with each color of its points split between the threads (see
+	// ContactSolver), rather than on one thread like the rest. A pile or a long stack can be most of a step's contacts in one island, which
+	// would otherwise leave every other thread waiting on the one solving it. 0 turns it off. The answer doesn't depend on how many threads
+	// there are, but it isn't quite the same as with it off, since the big islands' points are colored on their own.
+	void SetLargeIslandSize(int contacts)
+	{
+		largeIslandContacts = contacts > 0 ? contacts : 0;
+	}
+	int GetLargeIslandSize() const
+	{
+		return largeIslandContacts;
+	}
+
+	// Sleeping. Most objects in most scenes are sitting still, and still objects don't need to be moved, refit or tested against each other.
+	// With this on (which it is by default), an object counts as still while its speed is under velocity, and once every object in its
+	// island (everything it's touching, and everything they're touching, and so on) has been still for time seconds, the whole island goes
+	// to sleep: it stops moving, its proxies stay put, and the pairs where both objects are asleep are skipped.
+	// An island wakes up as soon as an awake object collides with any of it (unless that object can't be moved and isn't moving, like the
+	// floor), or any of it gets moved (or given a velocity) by hand.
+	// Turning sleeping off wakes everything up.
+	void SetSleeping(bool enabled, float velocity = 0.05f, float time = 0.5f);
+	bool IsSleeping() const
+	{
+		return sleepEnabled;
+	}
+	float GetSleepVelocity() const
+	{
+		return sleepVelocity;
+	}
+	float GetSleepTime() const
+	{
+		return sleepTime;
+	}
+
+	// Level of detail. Most of a big world is far from anything watching it, and doesn't need stepping as carefully as what's close to the
+	// players (or the cameras). With this on, each step every dynamic object that's further than distance from all of the interest points
+	// (see SetInterestPoints) is far: it only moves every interval steps, by interval steps' worth at once (see BodyStore::SetTimeScale), and
+	// in between it sits still, and its pairs with anything else that's sitting still are skipped like sleeping ones. A pair of far objects
+	// doesn't get GJK or EPA either, just the overlap of the boxes around them (see Narrowphase::SetSimplified), and far objects aren't swept
+	// for continuous collision.
+	// The far objects all step together, so the steps they move in cost more than the ones they don't: it's the average step that gets
+	// cheaper, by as much as (interval - 1) / interval of what the far objects cost. An object is back to full detail from the step it comes
+	// within distance of an interest point (less whatever time was left before its next step). Kinematic objects are always stepped in full,
+	// since they're steered a step at a time. A distance of 0 (the default) turns it off.
+	void SetLevelOfDetail(float distance, int interval = 4)
+	{
+		lodDistance = distance;
+		lodInterval = glm::max(interval, 1);
+	}
+	float GetLevelOfDetailDistance() const
+	{
+		return lodDistance;
+	}
+	int GetLevelOfDetailInterval() const
+	{
+		return lodInterval;
+	}
+
+	// Where the players (or cameras, or anything else that needs what's near it simulated in full) are. These stay until they're set again,
+	// so a game sets them before each step as its players move. With none, every object is stepped in full.
+	void SetInterestPoints(const std::vector<glm::vec3>& points)
+	{
+		interestPoints = points;
+	}
+	const std::vector<glm::vec3>& GetInterestPoints() const
+	{
+		return interestPoints;
+	}
+
+	// Whether an object was far in the last step (see SetLevelOfDetail).
+	bool IsFar(int object) const
+	{
+		return farObjects[object] != 0;
+	}
+
+	// Stepping slow islands less often. A pile that's slowly settling or a box sliding to a stop needs far less care than a projectile, but
+	// at one step rate for everything they cost the same. With this on, each island (a group of objects touching each other, or an object
+	// on its own) is stepped every 2, 4 or more steps, up to maxInterval (a power of two, at most 64), as long as its fastest object covers
+	// no more ground in that many steps than something going at slowSpeed does in one. In between it sits still, and its pairs with
+	// anything else sitting still are skipped like sleeping ones, the same as the far objects (see SetLevelOfDetail); on its steps it
+	// moves by every step it sat out as well, so it keeps up with everything else. Islands that touch each other become one island, which
+	// goes at the rate of its fastest object, so something slow that's hit by something fast is back to every step straight away. It
+	// starts again from there rather than catching up with the new speed it was hit with, so it drops whatever time it had sat out, which
+	// is never more than one step at slowSpeed. The step rate itself never changes: only how much of the world each step moves.
+	// Every jump a slow object makes is no further than one step at slowSpeed either, which is what keeps them smooth enough to draw with
+	// the usual blending between steps (see BodyStore::InterpolateTransforms). A speed of 0 (the default) turns it off.
+	void SetIslandRates(float slowSpeed, int maxInterval = 4)
+	{
+		slowIslandSpeed = slowSpeed;
+		slowIslandInterval = 1;
+
+		while (slowIslandInterval * 2 <= glm::min(maxInterval, MAX_STEP_INTERVAL))
+		{
+			slowIslandInterval *= 2;
+		}
+	}
+	float GetIslandRateSpeed() const
+	{
+		return slowIslandSpeed;
+	}
+	int GetIslandRateInterval() const
+	{
+		return slowIslandInterval;
+	}
+
+	// Whether an object is asleep, and wakes it (and its island) up.
+	bool IsAsleep(int object) const
+	{
+		return bodies.IsSleeping(handles[object]);
+	}
+	void WakeUp(int object)
+	{
+		wakeIsland(object);
+	}
+
+	// The impacts the fast objects had in the last step, earliest first. (Only the first for each object is acted on.)
+	const std::vector<SweptImpact>& GetImpacts() const
+	{
+		return impacts;
+	}
+
+	// Finds the first object the ray from from to to hits. Returns false if it doesn't hit any.
+	bool RayCast(const glm::vec3& from, const glm::vec3& to, PhysicsCastHit& hit)
+	{
+		if (rayCastCapacity > 0)
+		{
+			return cachedRayCast(from, to, hit);
+		}
+
+		return CastShape(SphereShape(from, 0.0f), to - from, hit);
+	}
+
+	// The ray cast cache, for rays that are cast again and again exactly the same (a sensor, or a turret's line of sight, every frame) at
+	// things that mostly stay put. It keeps up to capacity rays (0, the default, turns it off and empties it), each with its hit and the
+	// objects the broadphase gave it. A ray cast again from and to exactly the same points, with none of those objects' OBBs changed since,
+	// gets the same hit back without going through the broadphase or casting against anything.
+	// Something new can only get in a ray's way by moving a proxy (or adding one), so whenever a step moves a proxy, the rays whose boxes
+	// its fat bounds overlap are dropped, and the same goes for adding, enabling, disabling or resizing an object. A ray that hasn't been
+	// cast for RAY_CAST_IDLE_STEPS steps is dropped too, and once the cache is full, new rays are cast without being kept. Switching
+	// broadphases, shifting the origin, refreshing or restoring a state empties it.
+	void SetRayCastCache(int capacity);
+	int GetRayCastCache() const
+	{
+		return rayCastCapacity;
+	}
+
+	// How many rays are kept, and how many casts the cache has answered and how many it's had to cast since it was turned on.
+	int GetRayCastCacheSize() const
+	{
+		return rayCastCount;
+	}
+	long long GetRayCastCacheHits() const
+	{
+		return rayCastHits;
+	}
+	long long GetRayCastCacheMisses() const
+	{
+		return rayCastMisses;
+	}
+
+	// Finds the first object shape hits when moved along translation (any shape with a support function will do). Returns false if it
+	// doesn't hit any.
+	// The broadphase finds the objects whose bounds the shape's box passes through on the way, and only those get a GJK cast (see
+	// ShapeCastSolver). The casts are against the OBBs as of the start of the last step, and they share state, so don't cast during Step
+	// or from more than one thread at a time.
+	template<typename Shape>
+	bool CastShape(const Shape& shape, const glm::vec3& translation, PhysicsCastHit& hit);
+
+	// Fills objects with every object whose OBB is within radius of center (static ones too, but not disabled ones), in no particular order,
+	// and distances (if it's given) with how far each one's OBB is from center (0 if center is inside it). The broadphase gives the objects
+	// whose bounds overlap the sphere's box, and then their OBBs are tested against the sphere LANE_COUNT at a time.
+	void OverlapSphere(const glm::vec3& center, float radius, std::vector<int>& objects, std::vector<float>* distances = nullptr);
+
+	// Sets off count explosions at once, instead of going over the objects one at a time and changing their velocities. Each explosion finds
+	// the objects it reaches with OverlapSphere, and once they all have, every impulse is applied in one go: each dynamic object's velocity
+	// changes by its impulse times its inverse mass, and it's woken up along with its island. An object that more than one explosion reaches
+	// gets all of their impulses, and static and kinematic ones aren't pushed at all. (The impulse is along the line from the explosion's
+	// center to the object's, or straight up for an object right on the center, so nothing gets spun.)
+	// Returns how many impulses were applied, and fills hits with them, if it's given. Call it between steps, from the thread that steps.
+	int Explode(const PhysicsExplosion* explosions, int count, std::vector<PhysicsExplosionHit>* hits = nullptr);
+	int Explode(const PhysicsExplosion& explosion, std::vector<PhysicsExplosionHit>* hits = nullptr)
+	{
+		return Explode(&explosion, 1, hits);
+	}
+
+	JobSystem* GetJobSystem()
+	{
+		return jobs;
+	}
+
+	// How long each stage of the last step took.
+	const PhysicsStepStats& GetStepStats() const
+	{
+		return stats;
+	}
+
+	// Turns on (or off) counting how the GJK queries go in each step, and what they did in the last step. (See GJKStats.)
+	void SetGJKStatsEnabled(bool enabled)
+	{
+		narrowphase->SetStatsEnabled(enabled);
+	}
+	const GJKStats& GetGJKStats() const
+	{
+		return gjkStats;
+	}
+
+	// Tests a fraction of the pairs again every step with the plain TestGJK, and counts the ones where the narrowphase's answer was different
+	// (see Narrowphase::SetShadowChecks), in the last step. 0 turns it off.
+	void SetShadowChecks(float fraction)
+	{
+		narrowphase->SetShadowChecks(fraction);
+	}
+	float GetShadowChecks() const
+	{
+		return narrowphase->GetShadowChecks();
+	}
+	const ShadowCheckStats& GetShadowStats() const
+	{
+		return shadowStats;
+	}
+
+	// Times every pair the narrowphase tests, and reports the count most expensive ones over each window of windowSteps steps, with their
+	// shapes, so the content that needs simplifying to stay in budget can be found (see PairCost and Narrowphase::SetPairCosts). A pair
+	// that's expensive for the whole window only shows up once, with its worst step. The narrowphase is slower while it's on, since the pairs
+	// are tested one at a time to time them. 0 turns it off, which it is to begin with.
+	void SetPairCosts(int count, int windowSteps = 60);
+	int GetPairCosts() const
+	{
+		return pairCostCount;
+	}
+
+	// The most expensive pairs of the last whole window, the most expensive first. Empty until a window has finished.
+	const std::vector<PairCost>& GetPairCostReport() const
+	{
+		return pairCostReport;
+	}
+
+	// How many steps a pair can go without being tested before the pair cache forgets it (see PairCache::Evict). Pairs the broadphase
+	// stops finding are forgotten straight away; this is for the ones that just stop being tested, like the pairs of sleeping objects,
+	// which lose their warm start once they've slept this long. 60 by default.
+	void SetPairCacheMaxAge(int steps)
+	{
+		pairCacheMaxAge = steps < 0 ? 0 : steps;
+	}
+	int GetPairCacheMaxAge() const
+	{
+		return pairCacheMaxAge;
+	}
+	int GetPairCacheSize() const
+	{
+		return pairCache.Size();
+	}
+
+	// Sets what precision GJK runs in (see MixedGJKSolver). Float is plenty near the origin, so it's the default. For worlds that stretch
+	// thousands of units out, mixed keeps pairs that are only just touching from coming out either way, for a little extra cost.
+	void SetGJKPrecision(GJKPrecision precision)
+	{
+		narrowphase->SetPrecision(precision);
+	}
+	GJKPrecision GetGJKPrecision() const
+	{
+		return narrowphase->GetPrecision();
+	}
+
+	// Rebuilds every object's OBB from its body, and moves its proxy to match. Stepping does this anyway, so this is only needed after
+	// moving bodies around by hand outside of a step (like when setting up a scene). With the AABB tree in use, this also builds the tree
+	// again from scratch, across every thread (see AABBTree::Rebuild).
+	void Refresh();
+
+	// For adding a lot of objects at once, like when loading a scene: between these, the objects added aren't put into the AABB tree one at
+	// a time, and EndBulkAdd builds the whole tree around all of them at once instead (and does a Refresh, so the bodies can be moved after
+	// they're added). Don't step in between.
+	void BeginBulkAdd()
+	{
+		treeBroadphase.BeginBulkInsert();
+	}
+	void EndBulkAdd()
+	{
+		treeBroadphase.EndBulkInsert();
+
+		Refresh();
+	}
+
+	// Moves the world's origin to origin: every body, shape, proxy and contact has origin taken off it, so the world carries on exactly
+	// as it was, just somewhere else. Floats lose precision the further they get from zero (10km out, they can't tell apart points less
+	// than a millimetre apart), so a big world can move its origin to wherever the player is every so often and keep everything near them
+	// precise, without the whole step having to go over to doubles. It's one pass over each array, with nothing rebuilt. Call it between
+	// steps. (A state saved before a shift is still in the old coordinates, and puts the origin back too when it's restored.)
+	void ShiftOrigin(const glm::vec3& newOrigin);
+
+	// Where the origin is now, in the coordinates the world started out in. Add it to a position to get it in those.
+	const glm::dvec3& GetOrigin() const
+	{
+		return origin;
+	}
+
+	// How often (in steps) the AABB tree is built again from scratch to keep its queries quick, or 0 for never (see treeRebuildInterval).
+	// It's 60 to begin with (once a second at 60 steps a second).
+	void SetTreeRebuildInterval(int steps)
+	{
+		treeRebuildInterval = steps;
+		treeBroadphase.SetRefitInPlace(steps > 0);
+	}
+
+	// Pipelining the broadphase: once a step's pairs have gone to the narrowphase, the AABB tree isn't needed again until the next step, so
+	// the next step's refit and queries start straight away, alongside this step's narrowphase, solve and integrate. They can't know where
+	// the solver is going to send anything, so each proxy is moved to where its object will be if it keeps the velocity it had at the start
+	// of the step, with its fat bounds stretched the way it's going. When the next step comes, only the objects that have left those (the
+	// ones something hit, mostly) still need moving and querying, which is all that's left on its path to the narrowphase.
+	// The pairs come from bounds a step further ahead, so a few more of them get to the narrowphase, but it finds the same contacts. It only
+	// does anything while the tree is the broadphase: the others find every pair from scratch each step, so there's nothing to get ahead on.
+	// Steps still wait for the tree to be finished before they return, so nothing changes between steps. It's off to begin with.
+	void SetPipelinedBroadphase(bool enabled)
+	{
+		pipelined = enabled;
+	}
+	bool IsPipelinedBroadphase() const
+	{
+		return pipelined;
+	}
+
+	// How long (in seconds) each step can spend on upkeep spread across steps (see MaintenanceScheduler), or 0 for none. With a budget, the
+	// AABB tree isn't rebuilt all at once every treeRebuildInterval steps, but has its leaves put back in a slice at a time (see
+	// AABBTree::ReinsertLeaves), so a big world never has a whole rebuild land on one step. The tree isn't quite as good as a rebuild
+	// leaves it, so the broadphase costs a little more in between.
+	// In deterministic mode the budget is ignored and each step does one slice, so the same steps do the same work every time.
+	// It's 0 to begin with.
+	void SetMaintenanceBudget(double seconds)
+	{
+		maintenanceBudget = seconds;
+	}
+
+	// Runs one physics step of length dt: remembers where everything was (for interpolating), rebuilds the OBBs, runs the broadphase,
+	// tests the pairs it found, bounces apart the ones that collided, and moves everything forward by dt.
+	void Step(float dt);
+
+	// Runs steps steps of length dt back to back, as fast as the job system's threads can go, for a server that's fallen behind or a new
+	// instance that has to catch up with the rest. The simulation comes out exactly the same as calling Step that many times, but every
+	// step but the last leaves out what's only there for someone watching: the contact and trigger events, the previous poses for
+	// interpolating, and the GJK stats, shadow checks and pair costs. The last step is an ordinary one, so all of those describe it
+	// afterward as usual. (Which means a trigger pair that started overlapping partway through shows up as a stay, not an enter.)
+	void Advance(int steps, float dt);
+};
+
+// Steps count worlds by dt at once, on the job system they share (see PhysicsWorld(JobSystem&)), and waits for all of them. Each thread
+// takes the next world that hasn't been started and steps it. While a step waits on its stages, its thread runs whatever jobs are ready,
+// which can be stages of any of the worlds, or the next world altogether. So the threads are kept busy by many small steps at once rather
+// than each small step being spread across every thread, which for a world of a few hundred objects is mostly waiting.
+// The worlds have to be different, all on jobs, and not being stepped or changed anywhere else until this returns. Call it from the thread
+// that uses jobs (as with Step).
+void StepWorlds(PhysicsWorld* const* worlds, int count, float dt, JobSystem& jobs);
+
+// A world whose limits (see PhysicsWorld::SetLimits) are fixed when it's compiled, and set aside as it's made, so a console build always
+// knows what its world costs: a FixedPhysicsWorld<4096, 16384, 8192> has room for 4096 objects, 16384 pairs and 8192 contacts.
+template<int MaxObjects, int MaxPairs, int MaxContacts>
+class FixedPhysicsWorld : public PhysicsWorld
+{
+	static_assert(MaxObjects > 0 && MaxPairs >= 0 && MaxContacts >= 0, "A fixed world needs room for at least one object");
+
+public:
+	static const int MAX_OBJECTS = MaxObjects;
+	static const int MAX_PAIRS = MaxPairs;
+	static const int MAX_CONTACTS = MaxContacts;
+
+	FixedPhysicsWorld(int threadCount = 0) : PhysicsWorld(threadCount)
+	{
+		SetLimits(PhysicsWorldLimits(MaxObjects, MaxPairs, MaxContacts));
+	}
+
+	explicit FixedPhysicsWorld(JobSystem& sharedJobs) : PhysicsWorld(sharedJobs)
+	{
+		SetLimits(PhysicsWorldLimits(MaxObjects, MaxPairs, MaxContacts));
+	}
+};
+
+template<typename Shape>
+bool PhysicsWorld::CastShape(const Shape& shape, const glm::vec3& translation, PhysicsCastHit& hit)
+{
+	AABB bounds = getBoundsFromSupport(shape);
+	glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+
+	broadphase->CastSegment(center, center + translation, bounds.max - center, castCandidates);
+
+	// The static objects aren't in the broadphase, so they're looked up separately and added on.
+	staticTree.CastSegment(center, center + translation, bounds.max - center, castStaticCandidates);
+	castCandidates.insert(castCandidates.end(), castStaticCandidates.begin(), castStaticCandidates.end());
+
+	hit = PhysicsCastHit();
+
+	// The candidates come in no particular order, so each cast only looks as far as the closest hit so far.
+	float closest = 1.0f;
+
+	for (int i = 0; i < (int)castCandidates.size(); i++)
+	{
+		int object = castCandidates[i];
+		ShapeCastResult result;
+
+		if (castSolver.Cast(shape, translation, shapes[object], closest, result) && (hit.object == -1 || result.fraction < closest))
+		{
+			closest = result.fraction;
+
+			hit.object = object;
+			hit.fraction = result.fraction;
+			hit.normal = result.normal;
+			hit.point = result.point;
+		}
+	}
+
+	return hit.object != -1;
+}
+
+#endif //_PHYSICS_WORLD_H
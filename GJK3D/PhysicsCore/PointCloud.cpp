@@ -0,0 +1,227 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PointCloud.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _POINT_CLOUD_CPP
+#define _POINT_CLOUD_CPP
+
+#include "PointCloud.h"
+#include "SIMDLanes.h"
+#include <cfloat>
+#include <cmath>
+
+// Every lane's bit from laneLessEqual: none of the points in those lanes gets past the best so far.
+static const int ALL_LANES = (1 << LANE_COUNT) - 1;
+
+PointCloud::PointCloud()
+{
+	data = nullptr;
+	count = 0;
+	stride = 3;
+	numValid = 0;
+	built = false;
+}
+
+PointCloud::PointCloud(const glm::vec3* points, int numPoints)
+{
+	numValid = 0;
+	built = false;
+	SetPoints(points, numPoints);
+}
+
+PointCloud::PointCloud(const float* points, int numPoints, int pointStride)
+{
+	numValid = 0;
+	built = false;
+	SetPoints(points, numPoints, pointStride);
+}
+
+void PointCloud::SetPoints(const glm::vec3* points, int numPoints)
+{
+	SetPoints((const float*)points, numPoints, 3);
+}
+
+void PointCloud::SetPoints(const float* points, int numPoints, int pointStride)
+{
+	// A stride too short to hold a point would read the next point's x as this one's z, so it's taken as packed instead.
+	data = points;
+	count = points != nullptr && numPoints > 0 ? numPoints : 0;
+	stride = pointStride < 3 ? 3 : pointStride;
+	built.store(false, std::memory_order_release);
+}
+
+void PointCloud::Build() const
+{
+	// Checked again under the lock, so that two threads that both find it out of date don't both build it.
+	if (built.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(buildMutex);
+
+	if (!built.load(std::memory_order_relaxed))
+	{
+		build();
+		built.store(true, std::memory_order_release);
+	}
+}
+
+void PointCloud::build() const
+{
+	indices.clear();
+
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 p = GetPoint(i);
+
+		if (std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z))
+		{
+			indices.push_back(i);
+		}
+	}
+
+	numValid = (int)indices.size();
+	int numBlocks = (numValid + POINT_CLOUD_BLOCK - 1) / POINT_CLOUD_BLOCK;
+
+	// Only the last block can be short, and it's filled out to whole lanes with its first point again, which never beats itself.
+	int padded = numValid == 0 ? 0 : (numBlocks - 1) * POINT_CLOUD_BLOCK;
+	int lastBlock = numValid - padded;
+	padded += (lastBlock + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+
+	xs.resize(padded);
+	ys.resize(padded);
+	zs.resize(padded);
+	blockCenters.resize(numBlocks);
+	blockHalfSizes.resize(numBlocks);
+
+	for (int i = numValid; i < padded; i++)
+	{
+		indices.push_back(indices[(numBlocks - 1) * POINT_CLOUD_BLOCK]);
+	}
+
+	for (int block = 0; block < numBlocks; block++)
+	{
+		int start = block * POINT_CLOUD_BLOCK;
+		int end = start + POINT_CLOUD_BLOCK < padded ? start + POINT_CLOUD_BLOCK : padded;
+
+		glm::vec3 lower = glm::vec3(FLT_MAX);
+		glm::vec3 upper = glm::vec3(-FLT_MAX);
+
+		for (int i = start; i < end; i++)
+		{
+			glm::vec3 p = GetPoint(indices[i]);
+
+			xs[i] = p.x;
+			ys[i] = p.y;
+			zs[i] = p.z;
+			lower = glm::min(lower, p);
+			upper = glm::max(upper, p);
+		}
+
+		// The bounds are grown a little, so rounding in the test against them can't skip a block that has the farthest point in it.
+		glm::vec3 halfSize = (upper - lower) * 0.5f;
+		glm::vec3 center = lower + halfSize;
+		float slack = (glm::abs(center.x) + glm::abs(center.y) + glm::abs(center.z) + halfSize.x + halfSize.y + halfSize.z) * 1e-5f;
+
+		blockCenters[block] = center;
+		blockHalfSizes[block] = halfSize + glm::vec3(slack);
+	}
+}
+
+int PointCloud::NumValidPoints() const
+{
+	Build();
+
+	return numValid;
+}
+
+int PointCloud::FindFarthestPoint(const glm::vec3& dir) const
+{
+	Build();
+
+	int numBlocks = (int)blockCenters.size();
+
+	if (numBlocks == 0)
+	{
+		return -1;
+	}
+
+	// Starting from the first point, and only taking points strictly farther, means ties go to the first one.
+	int farthest = 0;
+	float maxDist = xs[0] * dir.x + ys[0] * dir.y + zs[0] * dir.z;
+
+	glm::vec3 absDir = glm::abs(dir);
+	Lanes dirX = laneSet(dir.x);
+	Lanes dirY = laneSet(dir.y);
+	Lanes dirZ = laneSet(dir.z);
+	float dists[LANE_COUNT];
+
+	for (int block = 0; block < numBlocks; block++)
+	{
+		// Nothing in the block's box reaches farther than its center plus the half size along each axis of dir.
+		if (glm::dot(blockCenters[block], dir) + glm::dot(blockHalfSizes[block], absDir) <= maxDist)
+		{
+			continue;
+		}
+
+		int start = block * POINT_CLOUD_BLOCK;
+		int end = start + POINT_CLOUD_BLOCK < (int)xs.size() ? start + POINT_CLOUD_BLOCK : (int)xs.size();
+
+		for (int i = start; i < end; i += LANE_COUNT)
+		{
+			Lanes dist = laneLoad(&xs[i]) * dirX + laneLoad(&ys[i]) * dirY + laneLoad(&zs[i]) * dirZ;
+
+			if (laneLessEqual(dist, laneSet(maxDist)) == ALL_LANES)
+			{
+				continue;
+			}
+
+			laneStore(dists, dist);
+
+			for (int lane = 0; lane < LANE_COUNT; lane++)
+			{
+				if (dists[lane] > maxDist)
+				{
+					maxDist = dists[lane];
+					farthest = i + lane;
+				}
+			}
+		}
+	}
+
+	return indices[farthest];
+}
+
+#endif //_POINT_CLOUD_CPP
@@ -0,0 +1,164 @@
+/*
+Title: GJK-3D (OBB)
+File Name: PointCloud.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _POINT_CLOUD_H
+#define _POINT_CLOUD_H
+
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// How many points share one set of bounds in a PointCloud's support structure. It's a multiple of LANE_COUNT (see SIMDLanes.h).
+static const int POINT_CLOUD_BLOCK = 64;
+
+// Points from somewhere else (a depth camera or a lidar's capture buffer, say), used as a convex shape without copying them into a Model or
+// building a hull first. The points aren't owned: the buffer has to stay as it is for as long as the cloud is queried, and SetPoints is
+// called when the next frame arrives.
+// Finding the farthest point takes a support structure, built the first time it's needed (or by Build, to keep that cost out of the first
+// query): the points again as separate x, y and z arrays so they can be projected several at a time, in blocks with a bounding box each,
+// so that a whole block that can't beat the best point so far is skipped. Points that aren't finite (a sensor's "no return") are left out of
+// it. Queries from several threads at once are fine; SetPoints while something is querying isn't.
+class PointCloud
+{
+	const float* data;
+	int count;
+	int stride;				// In floats, from one point to the next.
+
+	mutable std::vector<float> xs;
+	mutable std::vector<float> ys;
+	mutable std::vector<float> zs;
+	mutable std::vector<int> indices;				// Which point each entry in xs, ys and zs is.
+	mutable int numValid;
+	mutable std::vector<glm::vec3> blockCenters;
+	mutable std::vector<glm::vec3> blockHalfSizes;
+	mutable std::atomic<bool> built;
+	mutable std::mutex buildMutex;
+
+	void build() const;
+
+	// Not meant to be copied: the copy would share the points but have to build its own structure, and there's no need for two.
+	PointCloud(const PointCloud&);
+	PointCloud& operator=(const PointCloud&);
+
+public:
+	PointCloud();
+
+	// A cloud over count points, tightly packed.
+	PointCloud(const glm::vec3* points, int count);
+
+	// A cloud over count points, each starting stride floats after the last (at least 3), with x, y and z first. That covers capture
+	// buffers that interleave colors or intensities with the positions.
+	PointCloud(const float* points, int count, int stride);
+
+	// Points the cloud at a new frame. The support structure is built again the next time it's needed.
+	void SetPoints(const glm::vec3* points, int count);
+	void SetPoints(const float* points, int count, int stride);
+
+	// Builds the support structure now if it's out of date.
+	void Build() const;
+
+	int NumPoints() const
+	{
+		return count;
+	}
+
+	glm::vec3 GetPoint(int i) const
+	{
+		const float* p = data + (size_t)i * stride;
+
+		return glm::vec3(p[0], p[1], p[2]);
+	}
+
+	// How many points the support structure has, leaving out those that weren't finite. (This builds it.)
+	int NumValidPoints() const;
+
+	// Finds the farthest point in dir, and returns its index, or -1 if there are no finite points. Of points that are equally far, it's
+	// the first.
+	int FindFarthestPoint(const glm::vec3& dir) const;
+};
+
+// A PointCloud as a shape for GJK. Like a posed HullShape, the direction is brought into the cloud's space, not every point into the world.
+struct PointCloudShape
+{
+	const PointCloud* cloud;
+	bool posed;
+	glm::vec3 position;
+	glm::quat orientation;
+
+	PointCloudShape()
+	{
+		cloud = nullptr;
+		posed = false;
+		position = glm::vec3(0.0f);
+		orientation = glm::quat();
+	}
+
+	// The points as they are (in world space already).
+	PointCloudShape(const PointCloud* c)
+	{
+		cloud = c;
+		posed = false;
+		position = glm::vec3(0.0f);
+		orientation = glm::quat();
+	}
+
+	PointCloudShape(const PointCloud* c, const glm::vec3& inPosition, const glm::quat& inOrientation)
+	{
+		cloud = c;
+		posed = true;
+		position = inPosition;
+		orientation = inOrientation;
+	}
+};
+
+// Gets the farthest point of a given PointCloudShape in a given direction. A cloud with no finite points is treated as a single point at
+// its position, so GJK still gets an answer.
+inline glm::vec3 getFarthestPointInDirection(const PointCloudShape& obj, const glm::vec3& dir)
+{
+	if (!obj.posed)
+	{
+		int farthest = obj.cloud->FindFarthestPoint(dir);
+
+		return farthest < 0 ? glm::vec3(0.0f) : obj.cloud->GetPoint(farthest);
+	}
+
+	int farthest = obj.cloud->FindFarthestPoint(glm::conjugate(obj.orientation) * dir);
+
+	return farthest < 0 ? obj.position : obj.position + obj.orientation * obj.cloud->GetPoint(farthest);
+}
+
+#endif //_POINT_CLOUD_H
@@ -0,0 +1,306 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Primitives.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _PRIMITIVES_CPP
+#define _PRIMITIVES_CPP
+
+#include "Primitives.h"
+#include <vector>
+
+static const char* PRIMITIVE_NAMES[NUM_PRIMITIVES] = { "box", "sphere", "capsule", "cylinder" };
+
+// Where the light comes from when the vertices are shaded (up, and a little towards the camera and the right).
+static const glm::vec3 PRIMITIVE_LIGHT = glm::normalize(glm::vec3(0.3f, 0.8f, 0.5f));
+
+// One ring of a round primitive, going around y: how far out it is and how high up, and the radial and upward parts of the normal on it.
+// A ring with no radius is a single vertex, a pole.
+struct PrimitiveRing
+{
+	float radius;
+	float height;
+	float normalRadius;
+	float normalHeight;
+};
+
+const char* GetPrimitiveTypeName(PrimitiveType type)
+{
+	return type >= 0 && type < NUM_PRIMITIVES ? PRIMITIVE_NAMES[type] : "";
+}
+
+bool FindPrimitiveType(const std::string& name, PrimitiveType& type)
+{
+	for (int i = 0; i < NUM_PRIMITIVES; i++)
+	{
+		if (name == PRIMITIVE_NAMES[i])
+		{
+			type = (PrimitiveType)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Adds a vertex at position facing normal, shaded from color (see BuildPrimitive).
+static void addVertex(SceneModel& model, const glm::vec3& position, const glm::vec3& normal, const glm::vec4& color)
+{
+	float shade = 0.65f + 0.35f * glm::dot(normal, PRIMITIVE_LIGHT);
+
+	model.positions.push_back(position);
+	model.colors.push_back(glm::vec4(glm::vec3(color) * shade, color.a));
+}
+
+static void addTriangle(SceneModel& model, int a, int b, int c)
+{
+	model.indices.push_back((unsigned int)a);
+	model.indices.push_back((unsigned int)b);
+	model.indices.push_back((unsigned int)c);
+}
+
+// Sweeps rings (from the top down) around y. Each ring is joined to the next by a band of quads (or a fan, at a pole), except where the
+// next ring is in the same place, which is only there to start a new normal (the edge of a cylinder's cap, say).
+// Seen from outside, a higher angle is to the left, so each quad goes top left, top right, bottom right to stay clockwise.
+static void addRings(SceneModel& model, const PrimitiveRing* rings, int numRings, int segments, const glm::vec4& color)
+{
+	std::vector<int> firstVertex(numRings);
+
+	for (int i = 0; i < numRings; i++)
+	{
+		const PrimitiveRing& ring = rings[i];
+
+		firstVertex[i] = (int)model.positions.size();
+
+		if (ring.radius == 0.0f)
+		{
+			addVertex(model, glm::vec3(0.0f, ring.height, 0.0f), glm::vec3(0.0f, ring.normalHeight > 0.0f ? 1.0f : -1.0f, 0.0f), color);
+			continue;
+		}
+
+		for (int k = 0; k < segments; k++)
+		{
+			float angle = 6.28318531f * k / segments;
+			float c = cosf(angle);
+			float s = sinf(angle);
+
+			addVertex(model, glm::vec3(ring.radius * c, ring.height, ring.radius * s),
+				glm::vec3(ring.normalRadius * c, ring.normalHeight, ring.normalRadius * s), color);
+		}
+	}
+
+	for (int i = 0; i + 1 < numRings; i++)
+	{
+		const PrimitiveRing& top = rings[i];
+		const PrimitiveRing& bottom = rings[i + 1];
+
+		if ((top.radius == bottom.radius && top.height == bottom.height) || (top.radius == 0.0f && bottom.radius == 0.0f))
+		{
+			continue;
+		}
+
+		int a = firstVertex[i];
+		int b = firstVertex[i + 1];
+
+		for (int k = 0; k < segments; k++)
+		{
+			int next = (k + 1) % segments;
+
+			if (top.radius == 0.0f)
+			{
+				addTriangle(model, a, b + k, b + next);
+			}
+			else if (bottom.radius == 0.0f)
+			{
+				addTriangle(model, a + next, a + k, b);
+			}
+			else
+			{
+				addTriangle(model, a + next, a + k, b + k);
+				addTriangle(model, a + next, b + k, b + next);
+			}
+		}
+	}
+}
+
+// Adds count rings of a half sphere of radius around center, from the angle first down to last (0 being straight up, and pi straight down).
+static void addSphereRings(std::vector<PrimitiveRing>& rings, float center, float radius, float first, float last, int count)
+{
+	for (int i = 0; i <= count; i++)
+	{
+		float angle = first + (last - first) * i / count;
+		PrimitiveRing ring;
+
+		ring.normalRadius = sinf(angle);
+		ring.normalHeight = cosf(angle);
+
+		// The poles have to come out exactly 0, to be single vertices.
+		if (fabsf(ring.normalRadius) < 1e-6f)
+		{
+			ring.normalRadius = 0.0f;
+		}
+
+		ring.radius = radius * ring.normalRadius;
+		ring.height = center + radius * ring.normalHeight;
+		rings.push_back(ring);
+	}
+}
+
+void BuildPrimitive(PrimitiveType type, SceneModel& model, int segments, const glm::vec4& color)
+{
+	segments = segments > MIN_PRIMITIVE_SEGMENTS ? segments : MIN_PRIMITIVE_SEGMENTS;
+
+	std::vector<PrimitiveRing> rings;
+
+	switch (type)
+	{
+	case PRIMITIVE_BOX:
+	{
+		// Each face, by its normal and the two axes across it, with u x v = normal, so that going -u +v, +u +v, +u -v is clockwise from outside.
+		static const glm::vec3 axes[6][3] =
+		{
+			{ glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1) },
+			{ glm::vec3(-1, 0, 0), glm::vec3(0, 0, 1), glm::vec3(0, 1, 0) },
+			{ glm::vec3(0, 1, 0), glm::vec3(0, 0, 1), glm::vec3(1, 0, 0) },
+			{ glm::vec3(0, -1, 0), glm::vec3(1, 0, 0), glm::vec3(0, 0, 1) },
+			{ glm::vec3(0, 0, 1), glm::vec3(1, 0, 0), glm::vec3(0, 1, 0) },
+			{ glm::vec3(0, 0, -1), glm::vec3(0, 1, 0), glm::vec3(1, 0, 0) }
+		};
+
+		for (int f = 0; f < 6; f++)
+		{
+			const glm::vec3& normal = axes[f][0];
+			const glm::vec3& u = axes[f][1];
+			const glm::vec3& v = axes[f][2];
+			int first = (int)model.positions.size();
+
+			addVertex(model, 0.5f * (normal - u + v), normal, color);
+			addVertex(model, 0.5f * (normal + u + v), normal, color);
+			addVertex(model, 0.5f * (normal + u - v), normal, color);
+			addVertex(model, 0.5f * (normal - u - v), normal, color);
+
+			addTriangle(model, first, first + 1, first + 2);
+			addTriangle(model, first, first + 2, first + 3);
+		}
+
+		return;
+	}
+	case PRIMITIVE_SPHERE:
+		addSphereRings(rings, 0.0f, 0.5f, 0.0f, 3.14159265f, segments / 2 > 2 ? segments / 2 : 2);
+		break;
+	case PRIMITIVE_CAPSULE:
+	{
+		// Two half spheres, with the straight part between them being the band from the top one's last ring to the bottom one's first.
+		int capRings = segments / 4 > 1 ? segments / 4 : 1;
+
+		addSphereRings(rings, 0.25f, 0.25f, 0.0f, 1.57079633f, capRings);
+		addSphereRings(rings, -0.25f, 0.25f, 1.57079633f, 3.14159265f, capRings);
+		break;
+	}
+	case PRIMITIVE_CYLINDER:
+	{
+		// The caps' rims are there twice, once facing up (or down) for the cap and once facing out for the side.
+		static const PrimitiveRing cylinder[6] =
+		{
+			{ 0.0f, 0.5f, 0.0f, 1.0f },
+			{ 0.5f, 0.5f, 0.0f, 1.0f },
+			{ 0.5f, 0.5f, 1.0f, 0.0f },
+			{ 0.5f, -0.5f, 1.0f, 0.0f },
+			{ 0.5f, -0.5f, 0.0f, -1.0f },
+			{ 0.0f, -0.5f, 0.0f, -1.0f }
+		};
+
+		rings.assign(cylinder, cylinder + 6);
+		break;
+	}
+	default:
+		return;
+	}
+
+	addRings(model, rings.data(), (int)rings.size(), segments, color);
+}
+
+const ConvexShape& GetPrimitiveShape(PrimitiveType type)
+{
+	struct PrimitiveShapes
+	{
+		ConvexShape shapes[NUM_PRIMITIVES];
+
+		PrimitiveShapes()
+		{
+			OBBShape box;
+			box.halfExtents = glm::vec3(0.5f);
+
+			shapes[PRIMITIVE_BOX] = ConvexShape(box);
+			shapes[PRIMITIVE_SPHERE] = ConvexShape(SphereShape(glm::vec3(0.0f), 0.5f));
+			shapes[PRIMITIVE_CAPSULE] = ConvexShape(CapsuleShape(glm::vec3(0.0f, 0.25f, 0.0f), glm::vec3(0.0f, -0.25f, 0.0f), 0.25f));
+			shapes[PRIMITIVE_CYLINDER] = ConvexShape(CylinderShape(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.5f, 0.5f));
+		}
+	};
+
+	// Made the first time it's asked for (which C++ makes safe from any thread).
+	static const PrimitiveShapes primitives;
+
+	return primitives.shapes[type >= 0 && type < NUM_PRIMITIVES ? type : PRIMITIVE_BOX];
+}
+
+std::string GetPrimitiveAssetName(PrimitiveType type, int segments)
+{
+	// The box is the same however many segments it's asked for with, so it's only ever kept once.
+	if (type == PRIMITIVE_BOX)
+	{
+		return "primitive box";
+	}
+
+	segments = segments > MIN_PRIMITIVE_SEGMENTS ? segments : MIN_PRIMITIVE_SEGMENTS;
+
+	return std::string("primitive ") + GetPrimitiveTypeName(type) + " " + std::to_string(segments);
+}
+
+const SharedMesh* AcquirePrimitive(AssetStore& store, PrimitiveType type, int segments, HullCache* cache)
+{
+	std::string name = GetPrimitiveAssetName(type, segments);
+
+	if (const SharedMesh* asset = store.Acquire(name))
+	{
+		return asset;
+	}
+
+	// Two threads can both get here for the same primitive, but only one of them gets to add it: AddMesh hands the other the one that's there.
+	SceneModel model;
+	BuildPrimitive(type, model, segments);
+
+	return store.AddMesh(name, model.positions.data(), (int)model.positions.size(), model.indices.data(), (int)model.indices.size(), cache);
+}
+
+#endif // _PRIMITIVES_CPP
@@ -0,0 +1,88 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Primitives.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _PRIMITIVES_H
+#define _PRIMITIVES_H
+
+#include "AssetStore.h"
+#include "SceneFile.h"
+#include "Shapes.h"
+#include <string>
+
+// The shapes that can be built without a model file: a mesh to draw, and the collision shape that matches it exactly.
+// Every primitive is unit sized, filling the box from -0.5 to 0.5 on each axis (scale the body to get other sizes), and the round ones stand
+// along y: the sphere has a radius of 0.5, the capsule a radius of 0.25 around a segment from -0.25 to 0.25, and the cylinder a radius and
+// half height of 0.5.
+enum PrimitiveType
+{
+	PRIMITIVE_BOX,
+	PRIMITIVE_SPHERE,
+	PRIMITIVE_CAPSULE,
+	PRIMITIVE_CYLINDER,
+
+	NUM_PRIMITIVES	// Not a type, just how many there are.
+};
+
+// How many segments the round primitives have around y, unless they're asked for with some other number. The sphere has half as many
+// rings from pole to pole, and each of the capsule's caps a quarter as many.
+static const int PRIMITIVE_SEGMENTS = 16;
+
+// The fewest segments a round primitive can have (anything less is taken as this).
+static const int MIN_PRIMITIVE_SEGMENTS = 3;
+
+// A primitive's name ("box", "sphere", "capsule" or "cylinder"), and the type with a given name. Returns false if there isn't one.
+const char* GetPrimitiveTypeName(PrimitiveType type);
+bool FindPrimitiveType(const std::string& name, PrimitiveType& type);
+
+// Adds a primitive's vertices and triangles to model, after any it already has, all in color. The triangles are clockwise seen from
+// outside (as the demo draws them). There's no lighting to draw with, so each vertex's color is shaded by which way it faces, brightest
+// facing up and towards the camera, which is enough to tell the faces apart.
+// The box has its own four vertices on each face (so each face is shaded flat), and the round primitives have segments around y (see
+// PRIMITIVE_SEGMENTS). segments means nothing to the box.
+void BuildPrimitive(PrimitiveType type, SceneModel& model, int segments = PRIMITIVE_SEGMENTS, const glm::vec4& color = glm::vec4(1.0f));
+
+// The collision shape of a primitive, in its own space: an OBBShape, SphereShape, CapsuleShape or CylinderShape of the sizes above. These
+// are made once, and every caller gets the same ones. It's exact, unlike the hull around the primitive's mesh (which is a little inside the
+// round ones), so use this for GJK where the shape is known.
+const ConvexShape& GetPrimitiveShape(PrimitiveType type);
+
+// The name a primitive is kept under in an AssetStore, which says what it is and how many segments it has ("primitive sphere 16", say).
+std::string GetPrimitiveAssetName(PrimitiveType type, int segments = PRIMITIVE_SEGMENTS);
+
+// Returns a primitive from store with a reference added, building it (and its hull, from cache if one is given) the first time it's asked
+// for. So however many bodies are "a unit box", they all share the one mesh and hull. Release it to the store like any other asset.
+const SharedMesh* AcquirePrimitive(AssetStore& store, PrimitiveType type, int segments = PRIMITIVE_SEGMENTS, HullCache* cache = nullptr);
+
+#endif //_PRIMITIVES_H
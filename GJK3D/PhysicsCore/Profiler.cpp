@@ -0,0 +1,292 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Profiler.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PROFILER_CPP
+#define _PROFILER_CPP
+
+#include "Profiler.h"
+#include <cstring>
+#include <fstream>
+
+// The one profiler. It's a global rather than a static inside Get, since Visual Studio 2013 doesn't make those thread safe, and any thread
+// can be the first to profile something.
+static Profiler globalProfiler;
+
+Profiler& Profiler::Get()
+{
+	return globalProfiler;
+}
+
+Profiler::Profiler()
+{
+	enabled = false;
+
+	frameStart = 0.0;
+	lastFrameTime = 0.0;
+
+	capturing = false;
+	maxCapturedEvents = 1000000;
+}
+
+int Profiler::threadIndex()
+{
+	std::thread::id id = std::this_thread::get_id();
+
+	for (int i = 0; i < (int)threads.size(); i++)
+	{
+		if (threads[i] == id)
+		{
+			return i;
+		}
+	}
+
+	threads.push_back(id);
+
+	return (int)threads.size() - 1;
+}
+
+// Whether two names are the same. They're nearly always the very same literal, so the pointers are checked first.
+static bool sameName(const char* a, const char* b)
+{
+	return a == b || strcmp(a, b) == 0;
+}
+
+void Profiler::AddZone(const char* name, double start, double end)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	ProfileEvent event;
+	event.name = name;
+	event.start = start;
+	event.end = end;
+	event.thread = threadIndex();
+
+	frameEvents.push_back(event);
+}
+
+void Profiler::AddCount(const char* name, long long value)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (int i = 0; i < (int)frameCounters.size(); i++)
+	{
+		if (sameName(frameCounters[i].name, name))
+		{
+			frameCounters[i].value += value;
+			return;
+		}
+	}
+
+	ProfileCounterStats counter;
+	counter.name = name;
+	counter.value = value;
+
+	frameCounters.push_back(counter);
+}
+
+void Profiler::EndFrame()
+{
+	double now = clock.Now();
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (enabled)
+	{
+		ProfileEvent frame;
+		frame.name = "frame";
+		frame.start = frameStart;
+		frame.end = now;
+		frame.thread = threadIndex();
+
+		frameEvents.push_back(frame);
+	}
+
+	// Add up each zone's runs, in the order they first ran.
+	lastZones.clear();
+
+	for (int i = 0; i < (int)frameEvents.size(); i++)
+	{
+		const ProfileEvent& event = frameEvents[i];
+		int zone = 0;
+
+		while (zone < (int)lastZones.size() && !sameName(lastZones[zone].name, event.name))
+		{
+			zone++;
+		}
+
+		if (zone == (int)lastZones.size())
+		{
+			ProfileZoneStats stats;
+			stats.name = event.name;
+			stats.calls = 0;
+			stats.seconds = 0.0;
+
+			lastZones.push_back(stats);
+		}
+
+		lastZones[zone].calls++;
+		lastZones[zone].seconds += event.end - event.start;
+	}
+
+	lastCounters = frameCounters;
+	lastFrameTime = now - frameStart;
+
+	if (capturing)
+	{
+		capturedEvents.insert(capturedEvents.end(), frameEvents.begin(), frameEvents.end());
+
+		for (int i = 0; i < (int)frameCounters.size(); i++)
+		{
+			ProfileCounterSample sample;
+			sample.name = frameCounters[i].name;
+			sample.time = now;
+			sample.value = frameCounters[i].value;
+
+			capturedCounters.push_back(sample);
+		}
+
+		// Don't let a capture that was left running eat all of the memory.
+		if ((int)capturedEvents.size() >= maxCapturedEvents)
+		{
+			capturing = false;
+		}
+	}
+
+	// Keep the counters (at 0) from one frame to the next, so that anything showing them doesn't see them come and go.
+	frameEvents.clear();
+
+	for (int i = 0; i < (int)frameCounters.size(); i++)
+	{
+		frameCounters[i].value = 0;
+	}
+
+	frameStart = now;
+}
+
+std::vector<ProfileZoneStats> Profiler::GetFrameZones() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return lastZones;
+}
+
+std::vector<ProfileCounterStats> Profiler::GetFrameCounters() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return lastCounters;
+}
+
+double Profiler::GetFrameTime() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return lastFrameTime;
+}
+
+void Profiler::StartCapture()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	capturedEvents.clear();
+	capturedCounters.clear();
+	capturing = true;
+}
+
+void Profiler::StopCapture()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	capturing = false;
+}
+
+bool Profiler::IsCapturing() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return capturing;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& fileName) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::ofstream file(fileName.c_str());
+
+	if (!file)
+	{
+		return false;
+	}
+
+	// The trace is a list of events. Zones are complete ("X") events and counters are counter ("C") events, with every time in microseconds.
+	// The thread names ("M" events) just make the trace easier to read.
+	file << "{\"traceEvents\":[\n";
+
+	file.setf(std::ios::fixed);
+	file.precision(3);
+
+	bool first = true;
+
+	for (int i = 0; i < (int)threads.size(); i++)
+	{
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":\"Thread " << i << "\"}}";
+		first = false;
+	}
+
+	for (int i = 0; i < (int)capturedEvents.size(); i++)
+	{
+		const ProfileEvent& event = capturedEvents[i];
+
+		file << (first ? "" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread <<
+			",\"ts\":" << event.start * 1e6 << ",\"dur\":" << (event.end - event.start) * 1e6 << "}";
+		first = false;
+	}
+
+	for (int i = 0; i < (int)capturedCounters.size(); i++)
+	{
+		const ProfileCounterSample& sample = capturedCounters[i];
+
+		file << (first ? "" : ",\n") << "{\"name\":\"" << sample.name << "\",\"ph\":\"C\",\"pid\":1,\"ts\":" << sample.time * 1e6 <<
+			",\"args\":{\"value\":" << sample.value << "}}";
+		first = false;
+	}
+
+	file << "\n]}\n";
+
+	return file.good();
+}
+
+#endif // _PROFILER_CPP
@@ -0,0 +1,210 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Profiler.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include "Clock.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Everything the profiler records goes through the GJK_PROFILE_ macros at the bottom of this file. Define GJK_PROFILE_DISABLE before
+// including it (or for the whole build) and they compile down to nothing, so a build without profiling doesn't even check whether it's on.
+
+// One run of a zone: some span of code, on one thread, from start to end (in seconds, on the profiler's clock).
+struct ProfileEvent
+{
+	const char* name;
+	double start;
+	double end;
+	int thread;
+};
+
+// How many times a zone ran over a frame, and how long it took all together.
+// The time is added up over every thread, so a zone split across 4 threads can take 4 times as long as the frame did.
+struct ProfileZoneStats
+{
+	const char* name;
+	int calls;
+	double seconds;
+};
+
+// What a counter added up to over a frame.
+struct ProfileCounterStats
+{
+	const char* name;
+	long long value;
+};
+
+// A counter's value at the end of one frame, for the trace.
+struct ProfileCounterSample
+{
+	const char* name;
+	double time;
+	long long value;
+};
+
+// Collects timed zones and counters from every thread, and adds them up once a frame. What the last frame added up to is there for anything
+// that wants to show it, and while capturing, every zone of every frame is kept so it can be written out as a trace.
+// Zones and counters are named with string literals (the name is never copied, only pointed to), so the names have to last as long as
+// the program does, and shouldn't have any quotes or backslashes in them.
+// The traces are in the Chrome trace event format, which chrome://tracing and Perfetto open as they are, and Tracy can import (with its
+// import-chrome tool).
+// Each zone takes a lock when it ends, so zones belong around whole stages and jobs, not around each query. Hot loops should add up their
+// counts as they go, and add them to a counter once at the end.
+class Profiler
+{
+	SteadyClock clock;
+
+	// Whether to record anything at all. It starts off, so nothing piles up for programs that never call EndFrame.
+	std::atomic<bool> enabled;
+
+	// Guards everything below.
+	mutable std::mutex mutex;
+
+	// The threads seen so far. A thread's number in the events is where it is in here.
+	std::vector<std::thread::id> threads;
+
+	// What's been recorded since the last EndFrame.
+	std::vector<ProfileEvent> frameEvents;
+	std::vector<ProfileCounterStats> frameCounters;
+	double frameStart;
+
+	// What the last frame added up to.
+	std::vector<ProfileZoneStats> lastZones;
+	std::vector<ProfileCounterStats> lastCounters;
+	double lastFrameTime;
+
+	// Everything recorded while capturing, up to maxCapturedEvents events (after which the capture stops by itself).
+	bool capturing;
+	std::vector<ProfileEvent> capturedEvents;
+	std::vector<ProfileCounterSample> capturedCounters;
+	int maxCapturedEvents;
+
+	// The number of the calling thread. The mutex has to be held.
+	int threadIndex();
+
+public:
+	Profiler();
+
+	// The profiler every macro records into.
+	static Profiler& Get();
+
+	void SetEnabled(bool inEnabled)
+	{
+		enabled = inEnabled;
+	}
+	bool IsEnabled() const
+	{
+		return enabled;
+	}
+
+	// The time now, on the profiler's clock.
+	double Now()
+	{
+		return clock.Now();
+	}
+
+	// Records one run of a zone, on the calling thread. (ProfileZone does this for you.)
+	void AddZone(const char* name, double start, double end);
+
+	// Adds to a counter for this frame.
+	void AddCount(const char* name, long long value);
+
+	// Ends the frame: adds up its zones and counters for GetFrameZones and GetFrameCounters, adds them to the capture if there is one, and starts
+	// the next frame. Call this once a frame, from one thread. The frame itself shows up in the trace as a zone called "frame".
+	void EndFrame();
+
+	// What the last frame added up to. These are copies, so they're safe to call from any thread.
+	std::vector<ProfileZoneStats> GetFrameZones() const;
+	std::vector<ProfileCounterStats> GetFrameCounters() const;
+	double GetFrameTime() const;
+
+	// Starts keeping every zone (throwing away any earlier capture), and stops again.
+	void StartCapture();
+	void StopCapture();
+	bool IsCapturing() const;
+
+	// Writes what was captured as a Chrome trace. Returns false if the file couldn't be written.
+	bool WriteChromeTrace(const std::string& fileName) const;
+};
+
+// Times the rest of the scope it's declared in, as a zone with the given name. Use GJK_PROFILE_ZONE rather than making these yourself.
+class ProfileZone
+{
+	const char* name;
+	double start;
+	bool active;
+
+public:
+	ProfileZone(const char* inName)
+	{
+		Profiler& profiler = Profiler::Get();
+
+		name = inName;
+		active = profiler.IsEnabled();
+		start = active ? profiler.Now() : 0.0;
+	}
+
+	~ProfileZone()
+	{
+		if (active)
+		{
+			Profiler& profiler = Profiler::Get();
+
+			profiler.AddZone(name, start, profiler.Now());
+		}
+	}
+};
+
+#define GJK_PROFILE_CONCAT_INNER(a, b) a##b
+#define GJK_PROFILE_CONCAT(a, b) GJK_PROFILE_CONCAT_INNER(a, b)
+
+#if !defined(GJK_PROFILE_DISABLE)
+	// Times from here to the end of the scope as a zone called name.
+	#define GJK_PROFILE_ZONE(name) ProfileZone GJK_PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+	// Adds value to the counter called name, for this frame.
+	#define GJK_PROFILE_COUNT(name, value) do { Profiler& profiler = Profiler::Get(); if (profiler.IsEnabled()) profiler.AddCount(name, value); } while (0)
+#else
+	#define GJK_PROFILE_ZONE(name) do { } while (0)
+	#define GJK_PROFILE_COUNT(name, value) do { } while (0)
+#endif
+
+#endif //_PROFILER_H
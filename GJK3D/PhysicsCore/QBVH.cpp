@@ -0,0 +1,156 @@
+/*
+Title: GJK-3D (OBB)
+File Name: QBVH.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _QBVH_CPP
+#define _QBVH_CPP
+
+#include "QBVH.h"
+#include "AABBTree.h"
+#include <limits>
+
+void QBVH::Build(const AABBTreeNode* treeNodes, int treeRoot)
+{
+	nodes.clear();
+	proxyCount = 0;
+
+	if (treeRoot == -1)
+	{
+		return;
+	}
+
+	// Taking the tree nodes off a stack, last pushed first, gives each node its index in depth first order.
+	pending.clear();
+
+	Pending first = { treeRoot, -1, 0 };
+	pending.push_back(first);
+
+	while (!pending.empty())
+	{
+		Pending next = pending.back();
+		pending.pop_back();
+
+		int index = (int)nodes.size();
+		nodes.push_back(QBVHNode());
+
+		if (next.parent != -1)
+		{
+			nodes[next.parent].children[next.slot] = index;
+		}
+
+		// Start with the tree node's two children (or the node itself, if the whole tree is one leaf), and keep opening up the one with the
+		// biggest box until there are four. Opening the biggest ones keeps the boxes of a node's children about the same size, which is what
+		// a query going down the tree needs, to be able to skip as many of them as it can.
+		int children[4];
+		int childCount = 0;
+
+		if (treeNodes[next.treeNode].IsLeaf())
+		{
+			children[childCount++] = next.treeNode;
+		}
+		else
+		{
+			children[childCount++] = treeNodes[next.treeNode].left;
+			children[childCount++] = treeNodes[next.treeNode].right;
+		}
+
+		while (childCount < 4)
+		{
+			int largest = -1;
+			float largestArea = -1.0f;
+
+			for (int i = 0; i < childCount; i++)
+			{
+				const AABBTreeNode& child = treeNodes[children[i]];
+
+				if (!child.IsLeaf() && child.bounds.Area() > largestArea)
+				{
+					largest = i;
+					largestArea = child.bounds.Area();
+				}
+			}
+
+			if (largest == -1)
+			{
+				break;
+			}
+
+			int opened = children[largest];
+			children[largest] = treeNodes[opened].left;
+			children[childCount++] = treeNodes[opened].right;
+		}
+
+		// Fill in the slots. The nodes go on the stack last to first, so the first child's node is the very next one in the array.
+		QBVHNode& node = nodes[index];
+		float empty = std::numeric_limits<float>::quiet_NaN();
+
+		for (int i = 0; i < 4; i++)
+		{
+			if (i >= childCount)
+			{
+				node.minX[i] = node.minY[i] = node.minZ[i] = empty;
+				node.maxX[i] = node.maxY[i] = node.maxZ[i] = empty;
+				node.children[i] = ~0;
+				continue;
+			}
+
+			const AABBTreeNode& child = treeNodes[children[i]];
+
+			node.minX[i] = child.bounds.min.x;
+			node.minY[i] = child.bounds.min.y;
+			node.minZ[i] = child.bounds.min.z;
+			node.maxX[i] = child.bounds.max.x;
+			node.maxY[i] = child.bounds.max.y;
+			node.maxZ[i] = child.bounds.max.z;
+
+			if (child.IsLeaf())
+			{
+				node.children[i] = ~children[i];
+				proxyCount++;
+			}
+		}
+
+		for (int i = childCount - 1; i >= 0; i--)
+		{
+			if (!treeNodes[children[i]].IsLeaf())
+			{
+				Pending child = { children[i], index, i };
+				pending.push_back(child);
+			}
+		}
+	}
+}
+
+#endif //_QBVH_CPP
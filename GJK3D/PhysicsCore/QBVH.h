@@ -0,0 +1,198 @@
+/*
+Title: GJK-3D (OBB)
+File Name: QBVH.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _QBVH_H
+#define _QBVH_H
+
+#include "AABB.h"
+#include "SIMD.h"
+#include <vector>
+
+struct AABBTreeNode;
+
+// A node of a QBVH: the boxes of up to four children side by side, all of their min x values, then all of their min y values, and so on, so
+// one SSE compare tests the same side of all four boxes. The six loads and compares test a query box against every child at once, where
+// the binary tree takes four nodes (and four cache misses, when they're spread around) to look at the same boxes.
+// 112 bytes of it is used, and it's aligned to 64 so that it takes up exactly two cache lines, instead of sometimes spilling into a third.
+struct GJK_ALIGN(64) QBVHNode
+{
+	float minX[4];
+	float minY[4];
+	float minZ[4];
+	float maxX[4];
+	float maxY[4];
+	float maxZ[4];
+
+	// For each child: zero or more is the index of another node, and below zero is a leaf, holding ~proxy. Children a node doesn't have get
+	// a box of NaNs, which fails every comparison (even against a query box that covers everything), so they never pass the test and don't
+	// need to be checked for separately.
+	int children[4];
+};
+
+// A flattened, four-wide copy of an AABBTree, for querying a tree that's going to be queried far more often than it changes.
+// The AABBTree is built to change cheaply: its nodes are wherever they ended up after all of the inserts and removals, and each holds one
+// box. That makes going down it a chain of scattered loads. This copy is built from it in one go (every other level of the binary tree is
+// folded into the one above it, so each node has up to four children and the tree is half as deep) and its nodes are stored depth first,
+// so a node's first child is the very next node in the array, and a query mostly walks forwards through memory.
+// It can't be changed, only built again from the tree. The proxies it hands back are the tree's, so they can be passed straight to
+// AABBTree::GetUserData.
+class QBVH
+{
+	// Saves and loads the arrays straight from a file (see WorldSnapshot).
+	friend class WorldSnapshot;
+
+	std::vector<QBVHNode> nodes;
+	int proxyCount;
+
+	// The tree nodes still to be turned into QBVH nodes while building, and which slot of which node each one goes in.
+	struct Pending
+	{
+		int treeNode;
+		int parent;
+		int slot;
+	};
+	std::vector<Pending> pending;
+
+public:
+	QBVH()
+	{
+		proxyCount = 0;
+	}
+
+	// Builds the copy from the tree with the given nodes and root (see AABBTree::Flatten).
+	void Build(const AABBTreeNode* treeNodes, int treeRoot);
+
+	void Clear()
+	{
+		nodes.clear();
+		proxyCount = 0;
+	}
+
+	// Makes room for a copy of a tree of up to proxies proxies, so building one never grows the arrays. (A four-wide node holds at least
+	// two children, so there are fewer nodes than proxies.)
+	void Reserve(int proxies)
+	{
+		nodes.reserve(proxies);
+		pending.reserve(proxies);
+	}
+
+	int GetProxyCount() const
+	{
+		return proxyCount;
+	}
+
+	int GetNodeCount() const
+	{
+		return (int)nodes.size();
+	}
+
+	// Calls callback(proxy) for every proxy whose fat bounds overlap bounds, exactly like AABBTree::Query (the same boxes, tested the same
+	// way, so it finds the same proxies, although not necessarily in the same order). If the callback returns false, the query stops.
+	template<typename Callback>
+	void Query(const AABB& bounds, Callback& callback) const;
+};
+
+template<typename Callback>
+void QBVH::Query(const AABB& bounds, Callback& callback) const
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	// Each node swaps itself for at most four children, and the tree is half as deep as the AABBTree it came from.
+	int stack[256];
+	int count = 0;
+
+	stack[count++] = 0;
+
+#if defined(GJK_SIMD_SSE)
+	__m128 queryMinX = _mm_set1_ps(bounds.min.x);
+	__m128 queryMinY = _mm_set1_ps(bounds.min.y);
+	__m128 queryMinZ = _mm_set1_ps(bounds.min.z);
+	__m128 queryMaxX = _mm_set1_ps(bounds.max.x);
+	__m128 queryMaxY = _mm_set1_ps(bounds.max.y);
+	__m128 queryMaxZ = _mm_set1_ps(bounds.max.z);
+#endif
+
+	while (count > 0)
+	{
+		const QBVHNode& node = nodes[stack[--count]];
+
+#if defined(GJK_SIMD_SSE)
+		// The same six comparisons as AABB::Overlaps, for all four children. (The loads are unaligned ones, which cost the same on aligned
+		// memory, because not every std::vector lines its elements up to more than 16 bytes.)
+		__m128 overlaps = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(node.minX), queryMaxX), _mm_cmpge_ps(_mm_loadu_ps(node.maxX), queryMinX));
+		overlaps = _mm_and_ps(overlaps, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(node.minY), queryMaxY), _mm_cmpge_ps(_mm_loadu_ps(node.maxY), queryMinY)));
+		overlaps = _mm_and_ps(overlaps, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(node.minZ), queryMaxZ), _mm_cmpge_ps(_mm_loadu_ps(node.maxZ), queryMinZ)));
+		unsigned int mask = (unsigned int)_mm_movemask_ps(overlaps);
+#else
+		unsigned int mask = 0;
+
+		for (int i = 0; i < 4; i++)
+		{
+			if (node.minX[i] <= bounds.max.x && node.maxX[i] >= bounds.min.x &&
+				node.minY[i] <= bounds.max.y && node.maxY[i] >= bounds.min.y &&
+				node.minZ[i] <= bounds.max.z && node.maxZ[i] >= bounds.min.z)
+			{
+				mask |= 1u << i;
+			}
+		}
+#endif
+
+		// Push the child nodes last to first, so the first comes off the stack next, and the walk goes through the array in order.
+		for (int i = 3; i >= 0; i--)
+		{
+			if ((mask & (1u << i)) == 0)
+			{
+				continue;
+			}
+
+			int child = node.children[i];
+
+			if (child >= 0)
+			{
+				stack[count++] = child;
+			}
+			else if (!callback(~child))
+			{
+				return;
+			}
+		}
+	}
+}
+
+#endif //_QBVH_H
@@ -0,0 +1,103 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SIMD.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SIMD_H
+#define _SIMD_H
+
+// This header figures out which vector instruction set we can use, so that the rest of the code can just check one define.
+// GJK_SIMD_SSE is set on x86/x64 (SSE2 is always available there), GJK_SIMD_NEON is set on ARM, and if neither is set the
+// code falls back to plain scalar loops. Define GJK_SIMD_DISABLE before including this to force the scalar path (handy for testing).
+#if !defined(GJK_SIMD_DISABLE)
+	#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM) || defined(_M_ARM64)
+		#define GJK_SIMD_NEON
+		#include <arm_neon.h>
+	#elif defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+		#define GJK_SIMD_SSE
+		#include <emmintrin.h>
+		#if defined(__AVX__)
+			#define GJK_SIMD_AVX
+			#include <immintrin.h>
+		#endif
+	#endif
+#endif
+
+// Aligns a struct or variable to n bytes, which the aligned SIMD loads require.
+#ifdef _MSC_VER
+	#define GJK_ALIGN(n) __declspec(align(n))
+#else
+	#define GJK_ALIGN(n) __attribute__((aligned(n)))
+#endif
+
+// Asks for the cache line at address to be loaded, without waiting for it. Memory we're about to need can be on its way while we work on
+// something else. (On compilers where we don't know how, this does nothing, which is always safe.)
+#if defined(GJK_SIMD_SSE)
+	#define GJK_PREFETCH(address) _mm_prefetch((const char*)(address), _MM_HINT_T0)
+#elif defined(__GNUC__)
+	#define GJK_PREFETCH(address) __builtin_prefetch(address)
+#else
+	#define GJK_PREFETCH(address) ((void)0)
+#endif
+
+// Returns the index of the lowest set bit in a mask. The mask must not be zero.
+// It's one instruction where the compiler lets us ask for it, which matters to the loops that go through a mask a bit at a time.
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+inline int lowestSetBit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+
+	_BitScanForward(&index, mask);
+
+	return (int)index;
+#elif defined(__GNUC__)
+	return __builtin_ctz(mask);
+#else
+	int index = 0;
+
+	while ((mask & 1) == 0)
+	{
+		mask >>= 1;
+		index++;
+	}
+
+	return index;
+#endif
+}
+
+#endif //_SIMD_H
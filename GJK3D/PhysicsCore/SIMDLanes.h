@@ -0,0 +1,497 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SIMDLanes.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _SIMD_LANES_H
+#define _SIMD_LANES_H
+
+#include "SIMD.h"
+#include <cmath>
+
+// How many floats a Lanes holds. With AVX that's one register, and with SSE or NEON two.
+static const int LANE_COUNT = 8;
+
+// LANE_COUNT floats, and the handful of operations that the code working on that many things at once (particles against a collider, see
+// ParticleCollision.cpp, or copies of a world, see WorldBatch.cpp) needs. That code is written once in terms of these, and this is the only
+// part that changes with the instruction set: one AVX register, two SSE or NEON ones, or a plain array.
+// The loads and stores are unaligned, since the arrays are only as aligned as std::vector makes them.
+// There are no masks: a comparison either picks between two values per lane (laneSelectLess), or comes back as a bit per lane
+// (laneLessEqual), for the caller to skip work with.
+#if defined(GJK_SIMD_AVX)
+struct Lanes
+{
+	__m256 v;
+};
+
+static inline Lanes laneLoad(const float* values)
+{
+	Lanes lanes = { _mm256_loadu_ps(values) };
+	return lanes;
+}
+static inline void laneStore(float* values, const Lanes& a)
+{
+	_mm256_storeu_ps(values, a.v);
+}
+static inline Lanes laneSet(float value)
+{
+	Lanes lanes = { _mm256_set1_ps(value) };
+	return lanes;
+}
+static inline Lanes operator+(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm256_add_ps(a.v, b.v) };
+	return lanes;
+}
+static inline Lanes operator-(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm256_sub_ps(a.v, b.v) };
+	return lanes;
+}
+static inline Lanes operator-(const Lanes& a)
+{
+	Lanes lanes = { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)) };
+	return lanes;
+}
+static inline Lanes operator*(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm256_mul_ps(a.v, b.v) };
+	return lanes;
+}
+static inline Lanes operator/(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm256_div_ps(a.v, b.v) };
+	return lanes;
+}
+static inline Lanes laneMin(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm256_min_ps(a.v, b.v) };
+	return lanes;
+}
+static inline Lanes laneMax(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm256_max_ps(a.v, b.v) };
+	return lanes;
+}
+static inline Lanes laneAbs(const Lanes& a)
+{
+	Lanes lanes = { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) };
+	return lanes;
+}
+static inline Lanes laneSqrt(const Lanes& a)
+{
+	Lanes lanes = { _mm256_sqrt_ps(a.v) };
+	return lanes;
+}
+
+// a < b ? ifLess : otherwise, in each lane.
+static inline Lanes laneSelectLess(const Lanes& a, const Lanes& b, const Lanes& ifLess, const Lanes& otherwise)
+{
+	Lanes lanes = { _mm256_blendv_ps(otherwise.v, ifLess.v, _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)) };
+	return lanes;
+}
+
+// A bit for each lane where a <= b.
+static inline int laneLessEqual(const Lanes& a, const Lanes& b)
+{
+	return _mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ));
+}
+#elif defined(GJK_SIMD_SSE)
+struct Lanes
+{
+	__m128 lo;
+	__m128 hi;
+};
+
+static inline Lanes laneLoad(const float* values)
+{
+	Lanes lanes = { _mm_loadu_ps(values), _mm_loadu_ps(values + 4) };
+	return lanes;
+}
+static inline void laneStore(float* values, const Lanes& a)
+{
+	_mm_storeu_ps(values, a.lo);
+	_mm_storeu_ps(values + 4, a.hi);
+}
+static inline Lanes laneSet(float value)
+{
+	Lanes lanes = { _mm_set1_ps(value), _mm_set1_ps(value) };
+	return lanes;
+}
+static inline Lanes operator+(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes operator-(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes operator-(const Lanes& a)
+{
+	__m128 sign = _mm_set1_ps(-0.0f);
+	Lanes lanes = { _mm_xor_ps(a.lo, sign), _mm_xor_ps(a.hi, sign) };
+	return lanes;
+}
+static inline Lanes operator*(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes operator/(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes laneMin(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes laneMax(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { _mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes laneAbs(const Lanes& a)
+{
+	__m128 sign = _mm_set1_ps(-0.0f);
+	Lanes lanes = { _mm_andnot_ps(sign, a.lo), _mm_andnot_ps(sign, a.hi) };
+	return lanes;
+}
+static inline Lanes laneSqrt(const Lanes& a)
+{
+	Lanes lanes = { _mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi) };
+	return lanes;
+}
+
+// SSE2 has no blend, so the comparison's all-ones or all-zeros answer picks with and, andnot and or.
+static inline Lanes laneSelectLess(const Lanes& a, const Lanes& b, const Lanes& ifLess, const Lanes& otherwise)
+{
+	__m128 lo = _mm_cmplt_ps(a.lo, b.lo);
+	__m128 hi = _mm_cmplt_ps(a.hi, b.hi);
+	Lanes lanes = { _mm_or_ps(_mm_and_ps(lo, ifLess.lo), _mm_andnot_ps(lo, otherwise.lo)),
+		_mm_or_ps(_mm_and_ps(hi, ifLess.hi), _mm_andnot_ps(hi, otherwise.hi)) };
+	return lanes;
+}
+
+static inline int laneLessEqual(const Lanes& a, const Lanes& b)
+{
+	return _mm_movemask_ps(_mm_cmple_ps(a.lo, b.lo)) | (_mm_movemask_ps(_mm_cmple_ps(a.hi, b.hi)) << 4);
+}
+#elif defined(GJK_SIMD_NEON)
+struct Lanes
+{
+	float32x4_t lo;
+	float32x4_t hi;
+};
+
+static inline Lanes laneLoad(const float* values)
+{
+	Lanes lanes = { vld1q_f32(values), vld1q_f32(values + 4) };
+	return lanes;
+}
+static inline void laneStore(float* values, const Lanes& a)
+{
+	vst1q_f32(values, a.lo);
+	vst1q_f32(values + 4, a.hi);
+}
+static inline Lanes laneSet(float value)
+{
+	Lanes lanes = { vdupq_n_f32(value), vdupq_n_f32(value) };
+	return lanes;
+}
+static inline Lanes operator+(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { vaddq_f32(a.lo, b.lo), vaddq_f32(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes operator-(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { vsubq_f32(a.lo, b.lo), vsubq_f32(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes operator-(const Lanes& a)
+{
+	Lanes lanes = { vnegq_f32(a.lo), vnegq_f32(a.hi) };
+	return lanes;
+}
+static inline Lanes operator*(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { vmulq_f32(a.lo, b.lo), vmulq_f32(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes laneMin(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { vminq_f32(a.lo, b.lo), vminq_f32(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes laneMax(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { vmaxq_f32(a.lo, b.lo), vmaxq_f32(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes laneAbs(const Lanes& a)
+{
+	Lanes lanes = { vabsq_f32(a.lo), vabsq_f32(a.hi) };
+	return lanes;
+}
+
+// 64 bit ARM can divide and take square roots outright. 32 bit ARM only has estimates, which two Newton-Raphson steps bring to full
+// precision. (The square root is x times its reciprocal square root, with 0 kept at 0 rather than going through infinity.)
+#if defined(__aarch64__) || defined(_M_ARM64)
+static inline Lanes operator/(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { vdivq_f32(a.lo, b.lo), vdivq_f32(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes laneSqrt(const Lanes& a)
+{
+	Lanes lanes = { vsqrtq_f32(a.lo), vsqrtq_f32(a.hi) };
+	return lanes;
+}
+#else
+static inline float32x4_t neonDivide(float32x4_t a, float32x4_t b)
+{
+	float32x4_t reciprocal = vrecpeq_f32(b);
+
+	reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(b, reciprocal));
+	reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(b, reciprocal));
+
+	return vmulq_f32(a, reciprocal);
+}
+static inline float32x4_t neonSqrt(float32x4_t a)
+{
+	float32x4_t reciprocal = vrsqrteq_f32(a);
+
+	reciprocal = vmulq_f32(reciprocal, vrsqrtsq_f32(vmulq_f32(a, reciprocal), reciprocal));
+	reciprocal = vmulq_f32(reciprocal, vrsqrtsq_f32(vmulq_f32(a, reciprocal), reciprocal));
+
+	return vbslq_f32(vceqq_f32(a, vdupq_n_f32(0.0f)), a, vmulq_f32(a, reciprocal));
+}
+
+static inline Lanes operator/(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes = { neonDivide(a.lo, b.lo), neonDivide(a.hi, b.hi) };
+	return lanes;
+}
+static inline Lanes laneSqrt(const Lanes& a)
+{
+	Lanes lanes = { neonSqrt(a.lo), neonSqrt(a.hi) };
+	return lanes;
+}
+#endif
+
+static inline Lanes laneSelectLess(const Lanes& a, const Lanes& b, const Lanes& ifLess, const Lanes& otherwise)
+{
+	Lanes lanes = { vbslq_f32(vcltq_f32(a.lo, b.lo), ifLess.lo, otherwise.lo), vbslq_f32(vcltq_f32(a.hi, b.hi), ifLess.hi, otherwise.hi) };
+	return lanes;
+}
+
+// NEON has no movemask, so each lane's all-ones or all-zeros answer is masked down to its own bit and the bits are added up.
+static inline int laneLessEqual(const Lanes& a, const Lanes& b)
+{
+	static const uint32_t bits[4] = { 1, 2, 4, 8 };
+	uint32x4_t weights = vld1q_u32(bits);
+	uint32x4_t lo = vandq_u32(vcleq_f32(a.lo, b.lo), weights);
+	uint32x4_t hi = vandq_u32(vcleq_f32(a.hi, b.hi), weights);
+	uint32x2_t sum = vpadd_u32(vget_low_u32(lo), vget_high_u32(lo));
+	uint32x2_t sumHi = vpadd_u32(vget_low_u32(hi), vget_high_u32(hi));
+
+	sum = vpadd_u32(sum, sum);
+	sumHi = vpadd_u32(sumHi, sumHi);
+
+	return (int)(vget_lane_u32(sum, 0) | (vget_lane_u32(sumHi, 0) << 4));
+}
+#else
+struct Lanes
+{
+	float v[LANE_COUNT];
+};
+
+static inline Lanes laneLoad(const float* values)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = values[i];
+	}
+
+	return lanes;
+}
+static inline void laneStore(float* values, const Lanes& a)
+{
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		values[i] = a.v[i];
+	}
+}
+static inline Lanes laneSet(float value)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = value;
+	}
+
+	return lanes;
+}
+static inline Lanes operator+(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = a.v[i] + b.v[i];
+	}
+
+	return lanes;
+}
+static inline Lanes operator-(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = a.v[i] - b.v[i];
+	}
+
+	return lanes;
+}
+static inline Lanes operator-(const Lanes& a)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = -a.v[i];
+	}
+
+	return lanes;
+}
+static inline Lanes operator*(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = a.v[i] * b.v[i];
+	}
+
+	return lanes;
+}
+static inline Lanes operator/(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = a.v[i] / b.v[i];
+	}
+
+	return lanes;
+}
+static inline Lanes laneMin(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i];
+	}
+
+	return lanes;
+}
+static inline Lanes laneMax(const Lanes& a, const Lanes& b)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = b.v[i] > a.v[i] ? b.v[i] : a.v[i];
+	}
+
+	return lanes;
+}
+static inline Lanes laneAbs(const Lanes& a)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = fabsf(a.v[i]);
+	}
+
+	return lanes;
+}
+static inline Lanes laneSqrt(const Lanes& a)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = sqrtf(a.v[i]);
+	}
+
+	return lanes;
+}
+
+static inline Lanes laneSelectLess(const Lanes& a, const Lanes& b, const Lanes& ifLess, const Lanes& otherwise)
+{
+	Lanes lanes;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		lanes.v[i] = a.v[i] < b.v[i] ? ifLess.v[i] : otherwise.v[i];
+	}
+
+	return lanes;
+}
+
+static inline int laneLessEqual(const Lanes& a, const Lanes& b)
+{
+	int mask = 0;
+
+	for (int i = 0; i < LANE_COUNT; i++)
+	{
+		mask |= (a.v[i] <= b.v[i] ? 1 : 0) << i;
+	}
+
+	return mask;
+}
+#endif
+
+#endif //_SIMD_LANES_H
@@ -0,0 +1,129 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SIMDSupport.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SIMD_SUPPORT_CPP
+#define _SIMD_SUPPORT_CPP
+
+#include "SIMDSupport.h"
+
+glm::vec3 getFarthestPointInDirection(const OBBSoA& obj, const glm::vec3& dir)
+{
+	// The projection of every corner is x * dir.x + y * dir.y + z * dir.z, added up in that order so that we match glm::dot exactly.
+	int index;
+
+#if defined(GJK_SIMD_AVX)
+	// With AVX all 8 corners fit in one register, so the projection is a single multiply-add chain.
+	__m256 proj = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(obj.x), _mm256_set1_ps(dir.x)),
+		_mm256_mul_ps(_mm256_load_ps(obj.y), _mm256_set1_ps(dir.y))),
+		_mm256_mul_ps(_mm256_load_ps(obj.z), _mm256_set1_ps(dir.z)));
+
+	// Find the maximum by comparing the register against itself with its halves, then its pairs, then its neighbors swapped.
+	__m256 maxProj = _mm256_max_ps(proj, _mm256_permute2f128_ps(proj, proj, 1));
+	maxProj = _mm256_max_ps(maxProj, _mm256_shuffle_ps(maxProj, maxProj, _MM_SHUFFLE(1, 0, 3, 2)));
+	maxProj = _mm256_max_ps(maxProj, _mm256_shuffle_ps(maxProj, maxProj, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	// Every lane now holds the maximum, so the lanes that equal it are the farthest corners. Take the first one.
+	// (If dir had a NaN in it nothing will match, so we fall back on the first corner just like the scalar loop does.)
+	int mask = _mm256_movemask_ps(_mm256_cmp_ps(proj, maxProj, _CMP_EQ_OQ));
+	index = mask != 0 ? lowestSetBit(mask) : 0;
+#elif defined(GJK_SIMD_SSE)
+	// With SSE we need two registers, one for corners 0-3 and one for corners 4-7.
+	__m128 dx = _mm_set1_ps(dir.x);
+	__m128 dy = _mm_set1_ps(dir.y);
+	__m128 dz = _mm_set1_ps(dir.z);
+
+	__m128 proj0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(obj.x), dx), _mm_mul_ps(_mm_load_ps(obj.y), dy)), _mm_mul_ps(_mm_load_ps(obj.z), dz));
+	__m128 proj1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(obj.x + 4), dx), _mm_mul_ps(_mm_load_ps(obj.y + 4), dy)), _mm_mul_ps(_mm_load_ps(obj.z + 4), dz));
+
+	// Horizontal max: first across the two registers, then across the 4 lanes.
+	__m128 maxProj = _mm_max_ps(proj0, proj1);
+	maxProj = _mm_max_ps(maxProj, _mm_shuffle_ps(maxProj, maxProj, _MM_SHUFFLE(1, 0, 3, 2)));
+	maxProj = _mm_max_ps(maxProj, _mm_shuffle_ps(maxProj, maxProj, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	// Build an 8 bit mask of which corners hit the maximum, and take the first one.
+	// (If dir had a NaN in it nothing will match, so we fall back on the first corner just like the scalar loop does.)
+	int mask = _mm_movemask_ps(_mm_cmpeq_ps(proj0, maxProj)) | (_mm_movemask_ps(_mm_cmpeq_ps(proj1, maxProj)) << 4);
+	index = mask != 0 ? lowestSetBit(mask) : 0;
+#elif defined(GJK_SIMD_NEON)
+	// Same as the SSE path, only with NEON intrinsics. We multiply and add separately (rather than vmlaq) to match glm::dot exactly.
+	float32x4_t dx = vdupq_n_f32(dir.x);
+	float32x4_t dy = vdupq_n_f32(dir.y);
+	float32x4_t dz = vdupq_n_f32(dir.z);
+
+	float32x4_t proj0 = vaddq_f32(vaddq_f32(vmulq_f32(vld1q_f32(obj.x), dx), vmulq_f32(vld1q_f32(obj.y), dy)), vmulq_f32(vld1q_f32(obj.z), dz));
+	float32x4_t proj1 = vaddq_f32(vaddq_f32(vmulq_f32(vld1q_f32(obj.x + 4), dx), vmulq_f32(vld1q_f32(obj.y + 4), dy)), vmulq_f32(vld1q_f32(obj.z + 4), dz));
+
+	float32x4_t maxProj = vmaxq_f32(proj0, proj1);
+	float32x2_t maxPair = vpmax_f32(vget_low_f32(maxProj), vget_high_f32(maxProj));
+	maxPair = vpmax_f32(maxPair, maxPair);
+	float maxDist = vget_lane_f32(maxPair, 0);
+
+	// NEON has no movemask, so just find the first lane that matches the maximum.
+	float projections[8];
+	vst1q_f32(projections, proj0);
+	vst1q_f32(projections + 4, proj1);
+
+	index = 0;
+	while (index < 8 && projections[index] != maxDist)
+	{
+		index++;
+	}
+
+	if (index == 8)
+	{
+		index = 0;
+	}
+#else
+	// No SIMD available, so fall back to the same loop as the OBB version.
+	float maxDist = obj.x[0] * dir.x + obj.y[0] * dir.y + obj.z[0] * dir.z;
+	index = 0;
+
+	for (int i = 1; i < 8; i++)
+	{
+		float dist = obj.x[i] * dir.x + obj.y[i] * dir.y + obj.z[i] * dir.z;
+
+		if (dist > maxDist)
+		{
+			maxDist = dist;
+			index = i;
+		}
+	}
+#endif
+
+	return obj.GetCorner(index);
+}
+
+#endif // _SIMD_SUPPORT_CPP
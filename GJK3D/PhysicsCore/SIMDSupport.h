@@ -0,0 +1,83 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SIMDSupport.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SIMD_SUPPORT_H
+#define _SIMD_SUPPORT_H
+
+#include "SIMD.h"
+#include "GJK.h"
+
+// The same 8 corners as an OBB, but stored as a structure of arrays (all of the x values, then all of the y values, then all of the z values).
+// Laid out this way, we can load 4 (or 8 with AVX) x values at once and project 4 (or 8) corners onto the direction with a couple of
+// multiplies and adds, instead of one dot product per corner.
+struct GJK_ALIGN(32) OBBSoA
+{
+	float x[8];
+	float y[8];
+	float z[8];
+
+	OBBSoA()
+	{
+	}
+
+	// Converts a regular OBB into the SoA layout.
+	OBBSoA(const OBB& obb)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			SetCorner(i, obb.corners[i]);
+		}
+	}
+
+	void SetCorner(int i, const glm::vec3& corner)
+	{
+		x[i] = corner.x;
+		y[i] = corner.y;
+		z[i] = corner.z;
+	}
+
+	glm::vec3 GetCorner(int i) const
+	{
+		return glm::vec3(x[i], y[i], z[i]);
+	}
+};
+
+// Gets the farthest corner of a given OBBSoA in a given direction.
+// This is a drop-in replacement for the OBB version, so Support and TestGJK pick it up automatically when they are given OBBSoA shapes.
+// It returns the exact same corner as the scalar loop (ties go to the lowest index), so switching between the two never changes a result.
+glm::vec3 getFarthestPointInDirection(const OBBSoA& obj, const glm::vec3& dir);
+
+#endif //_SIMD_SUPPORT_H
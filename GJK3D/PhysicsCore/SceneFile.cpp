@@ -0,0 +1,695 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SceneFile.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SCENE_FILE_CPP
+#define _SCENE_FILE_CPP
+
+#include "SceneFile.h"
+#include "FileLoader.h"
+#include "MeshImport.h"
+#include "PhysicsWorld.h"
+#include "Primitives.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// The binary format is the bodies' memory, byte for byte, so their layout can't change by accident.
+static_assert(sizeof(SceneBody) == 4 + 6 * sizeof(glm::vec3) + sizeof(glm::quat) + 4, "SceneBody has changed size");
+
+static unsigned int alignSection(unsigned int offset)
+{
+	return (offset + 15) & ~15u;
+}
+
+int Scene::FindModel(const std::string& name) const
+{
+	for (int i = 0; i < (int)models.size(); i++)
+	{
+		if (models[i].name == name)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void Scene::GetModelBounds(int model, glm::vec3& center, glm::vec3& halfExtents) const
+{
+	const std::vector<glm::vec3>& positions = models[model].positions;
+
+	if (positions.empty())
+	{
+		center = glm::vec3(0.0f);
+		halfExtents = glm::vec3(0.0f);
+		return;
+	}
+
+	glm::vec3 min = positions[0];
+	glm::vec3 max = positions[0];
+
+	for (int i = 1; i < (int)positions.size(); i++)
+	{
+		min = glm::min(min, positions[i]);
+		max = glm::max(max, positions[i]);
+	}
+
+	center = (min + max) * 0.5f;
+	halfExtents = (max - min) * 0.5f;
+}
+
+// Reads count floats from a line into values, returning false if there aren't that many.
+static bool readFloats(std::istringstream& line, float* values, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (!(line >> values[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Scene::LoadText(const std::string& fileName)
+{
+	std::vector<char> fileText;
+
+	if (!ReadWholeFile(fileName, fileText))
+	{
+		error = "Couldn't open " + fileName + ".";
+		return false;
+	}
+
+	models.clear();
+	bodies.clear();
+
+	// Bodies can name models before they're fully read, so their boxes are only filled in from the models at the end.
+	std::vector<unsigned char> hasBox;
+
+	// The same goes for the meshes models are imported from. They're all loaded at once once the scene's been read, and each one is imported
+	// as soon as it's in, while the rest are still loading. These are which model each one is for, and where it was in the scene.
+	FileBatch meshFiles;
+	std::vector<int> meshModels;
+	std::vector<std::string> meshLines;
+
+	std::string text;
+	int lineNumber = 0;
+	size_t lineStart = 0;
+
+	while (lineStart < fileText.size())
+	{
+		size_t lineEnd = std::find(fileText.begin() + lineStart, fileText.end(), '\n') - fileText.begin();
+
+		text.assign(fileText.data() + lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		lineNumber++;
+
+		if (!text.empty() && text.back() == '\r')
+		{
+			text.pop_back();
+		}
+
+		size_t comment = text.find('#');
+
+		if (comment != std::string::npos)
+		{
+			text.erase(comment);
+		}
+
+		std::istringstream line(text);
+		std::string keyword;
+
+		if (!(line >> keyword))
+		{
+			continue;
+		}
+
+		std::ostringstream where;
+		where << fileName << " line " << lineNumber << ": ";
+
+		if (keyword == "model")
+		{
+			SceneModel model;
+
+			std::string name;
+			std::string meshFileName;
+
+			if (!(line >> name))
+			{
+				error = where.str() + "model needs a name.";
+				return false;
+			}
+
+			if (line >> meshFileName)
+			{
+				size_t slash = fileName.find_last_of("/\\");
+
+				meshFiles.Add(fileName.substr(0, slash == std::string::npos ? 0 : slash + 1) + meshFileName, true);
+				meshModels.push_back((int)models.size());
+				meshLines.push_back(where.str());
+			}
+
+			model.name = name;
+			models.push_back(model);
+		}
+		else if (keyword == "vertex" || keyword == "triangle")
+		{
+			if (models.empty())
+			{
+				error = where.str() + keyword + " has to come after a model.";
+				return false;
+			}
+
+			SceneModel& model = models.back();
+
+			if (keyword == "vertex")
+			{
+				float values[7] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+
+				if (!readFloats(line, values, 3))
+				{
+					error = where.str() + "vertex needs a position.";
+					return false;
+				}
+
+				// The color is optional, but all or nothing.
+				float color[4];
+
+				if (readFloats(line, color, 4))
+				{
+					memcpy(values + 3, color, sizeof(color));
+				}
+
+				model.positions.push_back(glm::vec3(values[0], values[1], values[2]));
+				model.colors.push_back(glm::vec4(values[3], values[4], values[5], values[6]));
+			}
+			else
+			{
+				for (int i = 0; i < 3; i++)
+				{
+					unsigned int index;
+
+					if (!(line >> index))
+					{
+						error = where.str() + "triangle needs 3 indices.";
+						return false;
+					}
+
+					model.indices.push_back(index);
+				}
+			}
+		}
+		else if (keyword == "primitive")
+		{
+			if (models.empty())
+			{
+				error = where.str() + "primitive has to come after a model.";
+				return false;
+			}
+
+			std::string typeName;
+			PrimitiveType type;
+
+			if (!(line >> typeName) || !FindPrimitiveType(typeName, type))
+			{
+				error = where.str() + "primitive needs a type (box, sphere, capsule or cylinder).";
+				return false;
+			}
+
+			// The segments and the color are both optional, but the color needs the segments before it.
+			int segments = PRIMITIVE_SEGMENTS;
+			glm::vec4 color(1.0f);
+			int count;
+			float values[4];
+
+			if (line >> count)
+			{
+				segments = count;
+
+				if (readFloats(line, values, 4))
+				{
+					color = glm::vec4(values[0], values[1], values[2], values[3]);
+				}
+			}
+
+			BuildPrimitive(type, models.back(), segments, color);
+		}
+		else if (keyword == "body")
+		{
+			SceneBody body;
+			bool box = false;
+			std::string word;
+
+			while (line >> word)
+			{
+				float values[6];
+
+				if (word == "box" && readFloats(line, values, 6))
+				{
+					body.center = glm::vec3(values[0], values[1], values[2]);
+					body.halfExtents = glm::vec3(values[3], values[4], values[5]);
+					box = true;
+				}
+				else if (word == "position" && readFloats(line, values, 3))
+				{
+					body.position = glm::vec3(values[0], values[1], values[2]);
+				}
+				else if (word == "orientation" && readFloats(line, values, 4))
+				{
+					body.orientation = glm::normalize(glm::quat(values[0], values[1], values[2], values[3]));
+				}
+				else if (word == "rotation" && readFloats(line, values, 3))
+				{
+					body.orientation = glm::quat(glm::radians(glm::vec3(values[0], values[1], values[2])));
+				}
+				else if (word == "scale" && readFloats(line, values, 3))
+				{
+					body.scale = glm::vec3(values[0], values[1], values[2]);
+				}
+				else if (word == "velocity" && readFloats(line, values, 3))
+				{
+					body.velocity = glm::vec3(values[0], values[1], values[2]);
+				}
+				else if (word == "acceleration" && readFloats(line, values, 3))
+				{
+					body.acceleration = glm::vec3(values[0], values[1], values[2]);
+				}
+				else if (word == "mass" && readFloats(line, values, 1) && values[0] > 0.0f)
+				{
+					body.inverseMass = 1.0f / values[0];
+				}
+				else if (word == "static")
+				{
+					body.inverseMass = 0.0f;
+				}
+				else if (body.model == -1 && (body.model = FindModel(word)) != -1)
+				{
+					// That was the model's name.
+				}
+				else
+				{
+					error = where.str() + "didn't understand \"" + word + "\" (or the values after it).";
+					return false;
+				}
+			}
+
+			bodies.push_back(body);
+			hasBox.push_back(box ? 1 : 0);
+		}
+		else
+		{
+			error = where.str() + "didn't understand \"" + keyword + "\".";
+			return false;
+		}
+	}
+
+	meshFiles.Start();
+
+	for (int i = 0; i < meshFiles.Size(); i++)
+	{
+		SceneModel mesh;
+		std::string meshError;
+
+		if (!meshFiles.Wait(i))
+		{
+			error = meshLines[i] + "Couldn't open " + meshFiles.GetFileName(i) + ".";
+			return false;
+		}
+
+		if (!ImportMesh(meshFiles.GetFileName(i), meshFiles.GetData(i), meshFiles.GetSize(i), mesh, meshError))
+		{
+			error = meshLines[i] + meshError;
+			return false;
+		}
+
+		// The mesh's vertices come first, and then any the scene added after it (whose triangles were already counting from after the mesh's).
+		// Only the vertices and triangles are taken: ImportMesh names the model after its file, but the scene's name for it is the one that counts.
+		SceneModel& model = models[meshModels[i]];
+
+		model.positions.insert(model.positions.begin(), mesh.positions.begin(), mesh.positions.end());
+		model.colors.insert(model.colors.begin(), mesh.colors.begin(), mesh.colors.end());
+		model.indices.insert(model.indices.begin(), mesh.indices.begin(), mesh.indices.end());
+	}
+
+	for (int i = 0; i < (int)models.size(); i++)
+	{
+		for (int j = 0; j < (int)models[i].indices.size(); j++)
+		{
+			if (models[i].indices[j] >= models[i].positions.size())
+			{
+				error = fileName + ": model " + models[i].name + " has a triangle with a vertex it doesn't have.";
+				return false;
+			}
+		}
+	}
+
+	for (int i = 0; i < (int)bodies.size(); i++)
+	{
+		if (!hasBox[i] && bodies[i].model != -1)
+		{
+			GetModelBounds(bodies[i].model, bodies[i].center, bodies[i].halfExtents);
+		}
+	}
+
+	error.clear();
+	return true;
+}
+
+bool Scene::SaveText(const std::string& fileName)
+{
+	FILE* out = fopen(fileName.c_str(), "w");
+
+	if (out == nullptr)
+	{
+		error = "Couldn't write to " + fileName + ".";
+		return false;
+	}
+
+	// %.9g is enough digits to read back exactly the same float.
+	for (int i = 0; i < (int)models.size(); i++)
+	{
+		const SceneModel& model = models[i];
+
+		fprintf(out, "model %s\n", model.name.c_str());
+
+		for (int j = 0; j < (int)model.positions.size(); j++)
+		{
+			const glm::vec3& p = model.positions[j];
+			const glm::vec4& c = model.colors[j];
+
+			fprintf(out, "vertex %.9g %.9g %.9g %.9g %.9g %.9g %.9g\n", p.x, p.y, p.z, c.x, c.y, c.z, c.w);
+		}
+
+		for (int j = 0; j + 2 < (int)model.indices.size(); j += 3)
+		{
+			fprintf(out, "triangle %u %u %u\n", model.indices[j], model.indices[j + 1], model.indices[j + 2]);
+		}
+
+		fprintf(out, "\n");
+	}
+
+	for (int i = 0; i < (int)bodies.size(); i++)
+	{
+		const SceneBody& body = bodies[i];
+
+		fprintf(out, "body");
+
+		if (body.model != -1)
+		{
+			fprintf(out, " %s", models[body.model].name.c_str());
+		}
+
+		fprintf(out, " box %.9g %.9g %.9g %.9g %.9g %.9g", body.center.x, body.center.y, body.center.z, body.halfExtents.x,
+			body.halfExtents.y, body.halfExtents.z);
+		fprintf(out, " position %.9g %.9g %.9g", body.position.x, body.position.y, body.position.z);
+		fprintf(out, " orientation %.9g %.9g %.9g %.9g", body.orientation.w, body.orientation.x, body.orientation.y, body.orientation.z);
+		fprintf(out, " scale %.9g %.9g %.9g", body.scale.x, body.scale.y, body.scale.z);
+		fprintf(out, " velocity %.9g %.9g %.9g", body.velocity.x, body.velocity.y, body.velocity.z);
+		fprintf(out, " acceleration %.9g %.9g %.9g", body.acceleration.x, body.acceleration.y, body.acceleration.z);
+
+		if (body.inverseMass > 0.0f)
+		{
+			fprintf(out, " mass %.9g\n", 1.0f / body.inverseMass);
+		}
+		else
+		{
+			fprintf(out, " static\n");
+		}
+	}
+
+	bool written = ferror(out) == 0;
+
+	fclose(out);
+
+	if (!written)
+	{
+		error = "Couldn't write to " + fileName + ".";
+		return false;
+	}
+
+	error.clear();
+	return true;
+}
+
+bool Scene::LoadBinary(const std::string& fileName)
+{
+	SceneView view;
+
+	if (!view.Open(fileName))
+	{
+		error = fileName + " couldn't be opened, or isn't a scene file.";
+		return false;
+	}
+
+	models.resize(view.GetModelCount());
+
+	for (int i = 0; i < view.GetModelCount(); i++)
+	{
+		SceneModel& model = models[i];
+
+		model.name = view.GetModelName(i);
+		model.positions.assign(view.GetPositions(i), view.GetPositions(i) + view.GetVertexCount(i));
+		model.colors.assign(view.GetColors(i), view.GetColors(i) + view.GetVertexCount(i));
+		model.indices.assign(view.GetIndices(i), view.GetIndices(i) + view.GetIndexCount(i));
+	}
+
+	bodies.assign(view.GetBodies(), view.GetBodies() + view.GetBodyCount());
+
+	error.clear();
+	return true;
+}
+
+bool Scene::SaveBinary(const std::string& fileName)
+{
+	SceneFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SCENE_FILE_MAGIC, sizeof(header.magic));
+	header.version = SCENE_FILE_VERSION;
+	header.modelCount = (unsigned int)models.size();
+	header.bodyCount = (unsigned int)bodies.size();
+
+	std::vector<SceneModelRecord> records(models.size());
+
+	for (int i = 0; i < (int)models.size(); i++)
+	{
+		memset(&records[i], 0, sizeof(SceneModelRecord));
+		strncpy(records[i].name, models[i].name.c_str(), sizeof(records[i].name) - 1);
+
+		records[i].firstVertex = header.vertexCount;
+		records[i].vertexCount = (unsigned int)models[i].positions.size();
+		records[i].firstIndex = header.indexCount;
+		records[i].indexCount = (unsigned int)models[i].indices.size();
+
+		header.vertexCount += records[i].vertexCount;
+		header.indexCount += records[i].indexCount;
+	}
+
+	header.modelsOffset = alignSection(sizeof(SceneFileHeader));
+	header.positionsOffset = alignSection(header.modelsOffset + header.modelCount * sizeof(SceneModelRecord));
+	header.colorsOffset = alignSection(header.positionsOffset + header.vertexCount * sizeof(glm::vec3));
+	header.indicesOffset = alignSection(header.colorsOffset + header.vertexCount * sizeof(glm::vec4));
+	header.bodiesOffset = alignSection(header.indicesOffset + header.indexCount * sizeof(unsigned int));
+
+	std::ofstream out(fileName.c_str(), std::ios::binary);
+
+	if (!out)
+	{
+		error = "Couldn't write to " + fileName + ".";
+		return false;
+	}
+
+	// Writes a section, after padding out to where it starts.
+	auto writeSection = [&out](unsigned int offset, const void* data, size_t size)
+	{
+		static const char zeros[16] = { 0 };
+
+		while ((unsigned int)out.tellp() < offset)
+		{
+			out.write(zeros, std::min<size_t>(16, offset - (unsigned int)out.tellp()));
+		}
+
+		if (size > 0)
+		{
+			out.write((const char*)data, size);
+		}
+	};
+
+	writeSection(0, &header, sizeof(header));
+	writeSection(header.modelsOffset, records.data(), records.size() * sizeof(SceneModelRecord));
+
+	writeSection(header.positionsOffset, nullptr, 0);
+
+	for (int i = 0; i < (int)models.size(); i++)
+	{
+		writeSection(0, models[i].positions.data(), models[i].positions.size() * sizeof(glm::vec3));
+	}
+
+	writeSection(header.colorsOffset, nullptr, 0);
+
+	for (int i = 0; i < (int)models.size(); i++)
+	{
+		writeSection(0, models[i].colors.data(), models[i].colors.size() * sizeof(glm::vec4));
+	}
+
+	writeSection(header.indicesOffset, nullptr, 0);
+
+	for (int i = 0; i < (int)models.size(); i++)
+	{
+		writeSection(0, models[i].indices.data(), models[i].indices.size() * sizeof(unsigned int));
+	}
+
+	writeSection(header.bodiesOffset, bodies.data(), bodies.size() * sizeof(SceneBody));
+
+	if (!out)
+	{
+		error = "Couldn't write to " + fileName + ".";
+		return false;
+	}
+
+	error.clear();
+	return true;
+}
+
+SceneView::SceneView()
+{
+	header = nullptr;
+	models = nullptr;
+	positions = nullptr;
+	colors = nullptr;
+	indices = nullptr;
+	bodies = nullptr;
+}
+
+bool SceneView::Open(const std::string& fileName)
+{
+	Close();
+
+	if (!file.Open(fileName) || file.GetSize() < sizeof(SceneFileHeader))
+	{
+		Close();
+		return false;
+	}
+
+	const char* data = file.GetData();
+	const SceneFileHeader* fileHeader = (const SceneFileHeader*)data;
+
+	if (memcmp(fileHeader->magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC)) != 0 || fileHeader->version != SCENE_FILE_VERSION)
+	{
+		Close();
+		return false;
+	}
+
+	// Make sure every section fits in the file (in 64 bits, so a broken header can't overflow), and that the models stay inside the
+	// shared arrays, so nothing read through the view can go past the end.
+	unsigned long long size = file.GetSize();
+
+	if (fileHeader->modelsOffset + (unsigned long long)fileHeader->modelCount * sizeof(SceneModelRecord) > size ||
+		fileHeader->positionsOffset + (unsigned long long)fileHeader->vertexCount * sizeof(glm::vec3) > size ||
+		fileHeader->colorsOffset + (unsigned long long)fileHeader->vertexCount * sizeof(glm::vec4) > size ||
+		fileHeader->indicesOffset + (unsigned long long)fileHeader->indexCount * sizeof(unsigned int) > size ||
+		fileHeader->bodiesOffset + (unsigned long long)fileHeader->bodyCount * sizeof(SceneBody) > size)
+	{
+		Close();
+		return false;
+	}
+
+	const SceneModelRecord* records = (const SceneModelRecord*)(data + fileHeader->modelsOffset);
+
+	for (unsigned int i = 0; i < fileHeader->modelCount; i++)
+	{
+		if ((unsigned long long)records[i].firstVertex + records[i].vertexCount > fileHeader->vertexCount ||
+			(unsigned long long)records[i].firstIndex + records[i].indexCount > fileHeader->indexCount ||
+			records[i].name[sizeof(records[i].name) - 1] != '\0')
+		{
+			Close();
+			return false;
+		}
+	}
+
+	header = fileHeader;
+	models = records;
+	positions = (const glm::vec3*)(data + header->positionsOffset);
+	colors = (const glm::vec4*)(data + header->colorsOffset);
+	indices = (const unsigned int*)(data + header->indicesOffset);
+	bodies = (const SceneBody*)(data + header->bodiesOffset);
+
+	return true;
+}
+
+void SceneView::Close()
+{
+	file.Close();
+
+	header = nullptr;
+	models = nullptr;
+	positions = nullptr;
+	colors = nullptr;
+	indices = nullptr;
+	bodies = nullptr;
+}
+
+int AddSceneBodies(PhysicsWorld& world, const SceneBody* bodies, int count)
+{
+	int first = world.NumObjects();
+
+	world.Reserve(first + count);
+
+	BodyStore& store = world.Bodies();
+
+	world.BeginBulkAdd();
+
+	for (int i = 0; i < count; i++)
+	{
+		const SceneBody& body = bodies[i];
+
+		int object = world.AddBox(body.center, body.halfExtents, body.position, body.orientation, body.scale);
+		BodyHandle handle = world.GetBody(object);
+
+		store.Velocity(handle) = body.velocity;
+		store.Acceleration(handle) = body.acceleration;
+		store.InverseMass(handle) = body.inverseMass;
+	}
+
+	world.EndBulkAdd();
+
+	return first;
+}
+
+#endif //_SCENE_FILE_CPP
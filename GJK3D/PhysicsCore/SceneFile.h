@@ -0,0 +1,225 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SceneFile.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SCENE_FILE_H
+#define _SCENE_FILE_H
+
+#include "MappedFile.h"
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include <string>
+#include <vector>
+
+class PhysicsWorld;
+
+// A model in a scene: its vertices (a position and a color each) and the triangles between them, three indices each.
+struct SceneModel
+{
+	std::string name;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec4> colors;
+	std::vector<unsigned int> indices;
+};
+
+// A body in a scene: the model it's drawn with (an index into the scene's models, or -1 for none), the box around it in its own space,
+// and how it starts out.
+// This is exactly how bodies are laid out in a binary scene file, so it has to stay plain data, and its size can't change without bumping
+// SCENE_FILE_VERSION.
+struct SceneBody
+{
+	int model;
+	glm::vec3 center;
+	glm::vec3 halfExtents;
+	glm::vec3 position;
+	glm::quat orientation;
+	glm::vec3 scale;
+	glm::vec3 velocity;
+	glm::vec3 acceleration;
+	float inverseMass;		// 0 for a body that can't be moved.
+
+	// A unit box at the origin, with no model, not moving and with a mass of 1.
+	SceneBody()
+	{
+		model = -1;
+		center = glm::vec3(0.0f);
+		halfExtents = glm::vec3(0.5f);
+		position = glm::vec3(0.0f);
+		orientation = glm::quat();
+		scale = glm::vec3(1.0f);
+		velocity = glm::vec3(0.0f);
+		acceleration = glm::vec3(0.0f);
+		inverseMass = 1.0f;
+	}
+};
+
+// The binary scene format. Every section starts on a 16 byte boundary, and is stored exactly as it's used in memory (little-endian), so a
+// scene can be used straight out of a mapped file (see SceneView).
+static const char SCENE_FILE_MAGIC[4] = { 'G', 'J', 'K', 'S' };
+static const unsigned int SCENE_FILE_VERSION = 1;
+
+struct SceneFileHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned int modelCount;
+	unsigned int vertexCount;	// The total over every model.
+	unsigned int indexCount;	// The total over every model.
+	unsigned int bodyCount;
+
+	// Where each section starts, in bytes from the start of the file.
+	unsigned int modelsOffset;
+	unsigned int positionsOffset;
+	unsigned int colorsOffset;
+	unsigned int indicesOffset;
+	unsigned int bodiesOffset;
+};
+
+// Where one model's vertices and indices are in the shared arrays.
+struct SceneModelRecord
+{
+	char name[32];
+	unsigned int firstVertex;
+	unsigned int vertexCount;
+	unsigned int firstIndex;
+	unsigned int indexCount;
+};
+
+// A scene that can be edited, and loaded and saved as text (for writing scenes by hand) or binary (for loading them quickly).
+// The text form is one thing per line, and # starts a comment:
+//     model <name> [<file>]            Starts a model, imported from an OBJ or glTF file (relative to the scene's) if one is given (see
+//                                      ImportMesh). The vertex and triangle lines after it are added to it.
+//     vertex <x y z> [<r g b a>]       A vertex, with a color (white if there isn't one).
+//     triangle <i j k>                 A triangle, by the indices of its vertices in the model (from 0).
+//     primitive <type> [<segments> [<r g b a>]]
+//                                      Adds a box, sphere, capsule or cylinder to the model, after the vertices it has so far (see
+//                                      BuildPrimitive), with that many segments around (PRIMITIVE_SEGMENTS if not), in one color.
+//     body [<model>] <property>...     A body, drawn with the named model (or none). Each property is a name and its values:
+//                                      box <cx cy cz> <hx hy hz>, position <x y z>, orientation <w x y z>, rotation <x y z> (in degrees),
+//                                      scale <x y z>, velocity <x y z>, acceleration <x y z>, mass <m>, or static (which can't be moved).
+//                                      Anything left out is as in SceneBody(), except a body with a model gets the box around its vertices.
+class Scene
+{
+	std::string error;
+
+public:
+	std::vector<SceneModel> models;
+	std::vector<SceneBody> bodies;
+
+	// The index of the model with the given name, or -1.
+	int FindModel(const std::string& name) const;
+
+	// The box around a model's vertices.
+	void GetModelBounds(int model, glm::vec3& center, glm::vec3& halfExtents) const;
+
+	// Each of these replaces what's in the scene (or writes it out), and returns false if it can't. GetError says why.
+	bool LoadText(const std::string& fileName);
+	bool SaveText(const std::string& fileName);
+	bool LoadBinary(const std::string& fileName);
+	bool SaveBinary(const std::string& fileName);
+
+	const std::string& GetError() const
+	{
+		return error;
+	}
+};
+
+// A binary scene file, used where it is. Opening one maps the file and checks its header, and that's all: the models and bodies are read
+// straight out of the file as they're used, with nothing to parse or copy, so opening a scene of any size is about as fast as opening the
+// file. The pointers are good until the view is closed.
+class SceneView
+{
+	MappedFile file;
+
+	const SceneFileHeader* header;
+	const SceneModelRecord* models;
+	const glm::vec3* positions;
+	const glm::vec4* colors;
+	const unsigned int* indices;
+	const SceneBody* bodies;
+
+public:
+	SceneView();
+
+	// Returns false if the file can't be opened, or isn't a scene file this version can read.
+	bool Open(const std::string& fileName);
+	void Close();
+
+	int GetModelCount() const
+	{
+		return header ? (int)header->modelCount : 0;
+	}
+	int GetBodyCount() const
+	{
+		return header ? (int)header->bodyCount : 0;
+	}
+	const SceneBody* GetBodies() const
+	{
+		return bodies;
+	}
+
+	// A model's name, its vertices, and its indices (which count from its own first vertex).
+	const char* GetModelName(int model) const
+	{
+		return models[model].name;
+	}
+	int GetVertexCount(int model) const
+	{
+		return (int)models[model].vertexCount;
+	}
+	const glm::vec3* GetPositions(int model) const
+	{
+		return positions + models[model].firstVertex;
+	}
+	const glm::vec4* GetColors(int model) const
+	{
+		return colors + models[model].firstVertex;
+	}
+	int GetIndexCount(int model) const
+	{
+		return (int)models[model].indexCount;
+	}
+	const unsigned int* GetIndices(int model) const
+	{
+		return indices + models[model].firstIndex;
+	}
+};
+
+// Adds bodies to a world as boxes, all at once, and returns the object number of the first one (the rest follow it in order). The world
+// makes room for all of them first, each one's shape and proxy are made where it starts out, so none of them has to be moved after, and
+// the AABB tree is built around all of them at once (see PhysicsWorld::BeginBulkAdd).
+int AddSceneBodies(PhysicsWorld& world, const SceneBody* bodies, int count);
+
+#endif //_SCENE_FILE_H
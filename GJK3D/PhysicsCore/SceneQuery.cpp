@@ -0,0 +1,365 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SceneQuery.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SCENE_QUERY_CPP
+#define _SCENE_QUERY_CPP
+
+#include "SceneQuery.h"
+#include "JobSystem.h"
+#include "Morton.h"
+#include <algorithm>
+
+SceneQuerySnapshot::SceneQuerySnapshot() : tree(0.0f)
+{
+	origin = glm::dvec3(0.0);
+}
+
+void SceneQuerySnapshot::Capture(PhysicsWorld& world)
+{
+	int count = world.NumObjects();
+	BodyStore& bodies = world.Bodies();
+
+	shapes = world.GetShapes();
+	bounds.resize(count);
+	positions.resize(count);
+	orientations.resize(count);
+	velocities.resize(count);
+	filters.resize(count);
+	enabled.resize(count);
+	proxies.resize(count, -1);
+	origin = world.GetOrigin();
+
+	for (int i = 0; i < count; i++)
+	{
+		BodyHandle body = world.GetBody(i);
+
+		bounds[i] = world.GetBounds(i);
+		positions[i] = bodies.Position(body);
+		orientations[i] = bodies.Orientation(body);
+		velocities[i] = bodies.Velocity(body);
+		filters[i] = world.GetCollisionFilter(i);
+		enabled[i] = world.IsEnabled(i) ? 1 : 0;
+
+		if (!enabled[i])
+		{
+			if (proxies[i] != -1)
+			{
+				tree.DestroyProxy(proxies[i]);
+				proxies[i] = -1;
+			}
+		}
+		else if (proxies[i] == -1)
+		{
+			proxies[i] = tree.CreateProxy(bounds[i], i);
+		}
+		else
+		{
+			tree.MoveProxy(proxies[i], bounds[i], glm::vec3(0.0f));
+		}
+	}
+
+	tree.Build(world.GetJobSystem());
+}
+
+void SceneQuerySnapshot::filterCandidates(unsigned int layers, std::vector<int>& candidates) const
+{
+	if (layers == 0xFFFFFFFF)
+	{
+		return;
+	}
+
+	int kept = 0;
+
+	for (int i = 0; i < (int)candidates.size(); i++)
+	{
+		if ((filters[candidates[i]].layers & layers) != 0)
+		{
+			candidates[kept++] = candidates[i];
+		}
+	}
+
+	candidates.resize(kept);
+}
+
+void SceneQuerySnapshot::Overlap(const AABB& box, std::vector<int>& objects, SceneQueryScratch& scratch, unsigned int layers) const
+{
+	glm::vec3 center = (box.min + box.max) * 0.5f;
+
+	// A segment that doesn't go anywhere, grown by the box's half size, is the box.
+	tree.CastSegment(center, center, box.max - center, scratch.candidates);
+	filterCandidates(layers, scratch.candidates);
+
+	// A proxy's bounds can be bigger than its object's (they're only moved when the object leaves them), so check the object's own.
+	objects.clear();
+
+	for (int i = 0; i < (int)scratch.candidates.size(); i++)
+	{
+		if (bounds[scratch.candidates[i]].Overlaps(box))
+		{
+			objects.push_back(scratch.candidates[i]);
+		}
+	}
+}
+
+int SceneQuerySnapshot::sortBatch(const glm::vec3* from, const glm::vec3* to, const glm::vec3* extents, int count,
+	SceneQueryBatchScratch& scratch, JobSystem* jobs) const
+{
+	scratch.order.resize(count);
+	scratch.from.resize(count);
+	scratch.to.resize(count);
+	scratch.extents.resize(extents != nullptr ? count : 0);
+	scratch.threads.resize(jobs != nullptr ? jobs->GetThreadCount() : 1);
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	glm::vec3 boundsMin = (from[0] + to[0]) * 0.5f;
+	glm::vec3 boundsMax = boundsMin;
+
+	for (int i = 1; i < count; i++)
+	{
+		glm::vec3 middle = (from[i] + to[i]) * 0.5f;
+
+		boundsMin = glm::min(boundsMin, middle);
+		boundsMax = glm::max(boundsMax, middle);
+	}
+
+	glm::vec3 scale = mortonScale(boundsMin, boundsMax);
+
+	for (int i = 0; i < count; i++)
+	{
+		unsigned long long code = mortonCode((from[i] + to[i]) * 0.5f, boundsMin, scale);
+
+		scratch.order[i] = (code << 32) | (unsigned int)i;
+	}
+
+	std::sort(scratch.order.begin(), scratch.order.end());
+
+	for (int i = 0; i < count; i++)
+	{
+		int query = (int)(scratch.order[i] & 0xFFFFFFFF);
+
+		scratch.from[i] = from[query];
+		scratch.to[i] = to[query];
+
+		if (extents != nullptr)
+		{
+			scratch.extents[i] = extents[query];
+		}
+	}
+
+	return (count + LBVH_PACKET - 1) / LBVH_PACKET;
+}
+
+void SceneQuerySnapshot::RayCastBatch(const glm::vec3* from, const glm::vec3* to, int count, PhysicsCastHit* hits,
+	SceneQueryBatchScratch& scratch, JobSystem* jobs, unsigned int layers) const
+{
+	int numPackets = sortBatch(from, to, nullptr, count, scratch, jobs);
+
+	auto castPackets = [&](int begin, int end, int thread)
+	{
+		SceneQueryScratch& local = scratch.threads[thread];
+
+		for (int packet = begin; packet < end; packet++)
+		{
+			int first = packet * LBVH_PACKET;
+			int size = std::min(LBVH_PACKET, count - first);
+
+			tree.CastSegmentPacket(&scratch.from[first], &scratch.to[first], nullptr, size, local.packetCandidates);
+
+			for (int i = 0; i < size; i++)
+			{
+				int query = (int)(scratch.order[first + i] & 0xFFFFFFFF);
+				const glm::vec3& rayFrom = scratch.from[first + i];
+				glm::vec3 translation = scratch.to[first + i] - rayFrom;
+
+				filterCandidates(layers, local.packetCandidates[i]);
+				closestHit(SphereShape(rayFrom, 0.0f), translation, local.packetCandidates[i], local.castSolver, hits[query]);
+			}
+		}
+	};
+
+	if (jobs != nullptr)
+	{
+		jobs->ParallelFor(numPackets, QUERY_PACKET_GRAIN, castPackets);
+	}
+	else
+	{
+		castPackets(0, numPackets, 0);
+	}
+}
+
+void SceneQuerySnapshot::OverlapBatch(const AABB* boxes, int count, std::vector<int>& objects, std::vector<int>& firsts,
+	SceneQueryBatchScratch& scratch, JobSystem* jobs, unsigned int layers) const
+{
+	// Each box is a segment that doesn't go anywhere, from its center, grown by its half size (as in Overlap).
+	scratch.boxCenters.resize(count);
+	scratch.boxHalfSizes.resize(count);
+	scratch.boxThreads.resize(count);
+	scratch.boxStarts.resize(count);
+	firsts.assign(count + 1, 0);
+
+	for (int i = 0; i < count; i++)
+	{
+		scratch.boxCenters[i] = (boxes[i].min + boxes[i].max) * 0.5f;
+		scratch.boxHalfSizes[i] = boxes[i].max - scratch.boxCenters[i];
+	}
+
+	int numPackets = sortBatch(scratch.boxCenters.data(), scratch.boxCenters.data(), scratch.boxHalfSizes.data(), count, scratch, jobs);
+
+	for (int i = 0; i < (int)scratch.threads.size(); i++)
+	{
+		scratch.threads[i].objects.clear();
+	}
+
+	// Each thread keeps the objects it finds to itself, and notes where each box's start, so they can be put in order afterwards.
+	auto overlapPackets = [&](int begin, int end, int thread)
+	{
+		SceneQueryScratch& local = scratch.threads[thread];
+
+		for (int packet = begin; packet < end; packet++)
+		{
+			int first = packet * LBVH_PACKET;
+			int size = std::min(LBVH_PACKET, count - first);
+
+			tree.CastSegmentPacket(&scratch.from[first], &scratch.to[first], &scratch.extents[first], size, local.packetCandidates);
+
+			for (int i = 0; i < size; i++)
+			{
+				int query = (int)(scratch.order[first + i] & 0xFFFFFFFF);
+				std::vector<int>& candidates = local.packetCandidates[i];
+				int start = (int)local.objects.size();
+
+				filterCandidates(layers, candidates);
+
+				for (int j = 0; j < (int)candidates.size(); j++)
+				{
+					if (bounds[candidates[j]].Overlaps(boxes[query]))
+					{
+						local.objects.push_back(candidates[j]);
+					}
+				}
+
+				scratch.boxThreads[query] = thread;
+				scratch.boxStarts[query] = start;
+				firsts[query + 1] = (int)local.objects.size() - start;
+			}
+		}
+	};
+
+	if (jobs != nullptr)
+	{
+		jobs->ParallelFor(numPackets, QUERY_PACKET_GRAIN, overlapPackets);
+	}
+	else
+	{
+		overlapPackets(0, numPackets, 0);
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		firsts[i + 1] += firsts[i];
+	}
+
+	objects.resize(firsts[count]);
+
+	for (int i = 0; i < count; i++)
+	{
+		const std::vector<int>& found = scratch.threads[scratch.boxThreads[i]].objects;
+		int start = scratch.boxStarts[i];
+
+		std::copy(found.begin() + start, found.begin() + start + (firsts[i + 1] - firsts[i]), objects.begin() + firsts[i]);
+	}
+}
+
+SceneQueryBuffer::SceneQueryBuffer()
+{
+	latest.store(-1);
+	readers[0].store(0);
+	readers[1].store(0);
+}
+
+bool SceneQueryBuffer::Publish(PhysicsWorld& world)
+{
+	int next = latest.load() == 0 ? 1 : 0;
+
+	// A query that takes this snapshot from now on finds it isn't the latest any more and lets go of it again before reading anything (see
+	// Acquire), so once there are no readers, there won't be any until it's made the latest.
+	if (readers[next].load() != 0)
+	{
+		return false;
+	}
+
+	snapshots[next].Capture(world);
+	latest.store(next);
+
+	return true;
+}
+
+const SceneQuerySnapshot* SceneQueryBuffer::Acquire()
+{
+	for (;;)
+	{
+		int index = latest.load();
+
+		if (index == -1)
+		{
+			return nullptr;
+		}
+
+		readers[index].fetch_add(1);
+
+		// If it was copied over in between, it's the other one that's the latest now, so try again with that.
+		if (latest.load() == index)
+		{
+			return &snapshots[index];
+		}
+
+		readers[index].fetch_sub(1);
+	}
+}
+
+void SceneQueryBuffer::Release(const SceneQuerySnapshot* snapshot)
+{
+	if (snapshot != nullptr)
+	{
+		readers[snapshot - snapshots].fetch_sub(1);
+	}
+}
+
+#endif //_SCENE_QUERY_CPP
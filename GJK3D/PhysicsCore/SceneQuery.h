@@ -0,0 +1,283 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SceneQuery.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SCENE_QUERY_H
+#define _SCENE_QUERY_H
+
+#include "PhysicsWorld.h"
+#include "LinearBVH.h"
+#include "GJK.h"
+#include <atomic>
+
+class JobSystem;
+
+// How many packets of queries (of LBVH_PACKET each) each job runs, when a batch is split across threads.
+static const int QUERY_PACKET_GRAIN = 2;
+
+// What each thread that queries a SceneQuerySnapshot needs for working space. Every thread has to have its own (which is what lets them all
+// query the same snapshot at once), and should keep it from one query to the next so its arrays aren't allocated every time.
+struct SceneQueryScratch
+{
+	std::vector<int> candidates;
+	ShapeCastSolver castSolver;
+	GJKSolver gjk;
+
+	// For a packet of a batch: each query's candidates, and the objects the boxes of an OverlapBatch found on this thread.
+	std::vector<int> packetCandidates[LBVH_PACKET];
+	std::vector<int> objects;
+};
+
+// What RayCastBatch and OverlapBatch need for working space: the order the queries are sorted into, their segments in that order, and
+// scratch for each thread they run on. Keep it from one batch to the next, so none of it is allocated again.
+struct SceneQueryBatchScratch
+{
+	std::vector<unsigned long long> order;	// Each query's Morton code in the high 32 bits, and its number in the low 32.
+	std::vector<glm::vec3> from;
+	std::vector<glm::vec3> to;
+	std::vector<glm::vec3> extents;
+	std::vector<SceneQueryScratch> threads;
+
+	// For OverlapBatch: each box's center and half size, which thread found its objects, and where they start in that thread's objects.
+	std::vector<glm::vec3> boxCenters;
+	std::vector<glm::vec3> boxHalfSizes;
+	std::vector<int> boxThreads;
+	std::vector<int> boxStarts;
+};
+
+// A copy of the world as it was after one step, for other threads to query while the next step runs: every object's OBB, bounds and body
+// state, and a tree over the bounds to find them with. Nothing in it changes while it's being read, so any number of threads can query it at
+// once, each with its own SceneQueryScratch.
+// The tree is a LinearBVH, built from scratch each time, since the copy is of wherever everything ended up, and each copy is only around for
+// a step or two. Static objects go in it along with everything else, and disabled ones are left out.
+class SceneQuerySnapshot
+{
+	std::vector<OBBShape> shapes;
+	std::vector<AABB> bounds;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::quat> orientations;
+	std::vector<glm::vec3> velocities;
+	std::vector<CollisionFilter> filters;
+	std::vector<unsigned char> enabled;
+	glm::dvec3 origin;
+
+	// Each object's proxy in the tree (or -1 while it's disabled). The proxies are kept from one copy to the next, and moved.
+	std::vector<int> proxies;
+	LinearBVH tree;
+
+	// Takes the candidates that aren't on any of layers back out of candidates.
+	void filterCandidates(unsigned int layers, std::vector<int>& candidates) const;
+
+	// Casts shape along translation against each of the candidates, and fills hit with the closest one it hits (if any).
+	template<typename Shape>
+	bool closestHit(const Shape& shape, const glm::vec3& translation, const std::vector<int>& candidates, ShapeCastSolver& solver,
+		PhysicsCastHit& hit) const;
+
+	// Sorts a batch's queries (the segments from from to to, grown by extents if there are any) by the Morton codes of their middles into
+	// scratch, and makes sure there's scratch for every thread. Returns how many packets there are.
+	int sortBatch(const glm::vec3* from, const glm::vec3* to, const glm::vec3* extents, int count, SceneQueryBatchScratch& scratch,
+		JobSystem* jobs) const;
+
+	SceneQuerySnapshot(const SceneQuerySnapshot&);
+	SceneQuerySnapshot& operator=(const SceneQuerySnapshot&);
+
+public:
+	// The bounds in the tree are exactly the objects' bounds, with no margin.
+	SceneQuerySnapshot();
+
+	// Copies the world as it is now, and builds the tree (across the world's job system). Call it from the thread that steps the world,
+	// between steps.
+	void Capture(PhysicsWorld& world);
+
+	int NumObjects() const
+	{
+		return (int)shapes.size();
+	}
+
+	// The same as the PhysicsWorld functions of the same names, as of the step that was copied.
+	bool IsEnabled(int object) const
+	{
+		return enabled[object] != 0;
+	}
+	const OBBShape& GetShape(int object) const
+	{
+		return shapes[object];
+	}
+	const AABB& GetBounds(int object) const
+	{
+		return bounds[object];
+	}
+	const glm::vec3& GetPosition(int object) const
+	{
+		return positions[object];
+	}
+	const glm::quat& GetOrientation(int object) const
+	{
+		return orientations[object];
+	}
+	const glm::vec3& GetVelocity(int object) const
+	{
+		return velocities[object];
+	}
+	const glm::dvec3& GetOrigin() const
+	{
+		return origin;
+	}
+
+	// These all only look at objects on at least one of layers (see CollisionFilter), which is every object to begin with.
+
+	// Finds the first object the ray from from to to hits. Returns false if it doesn't hit any.
+	bool RayCast(const glm::vec3& from, const glm::vec3& to, PhysicsCastHit& hit, SceneQueryScratch& scratch,
+		unsigned int layers = 0xFFFFFFFF) const
+	{
+		return CastShape(SphereShape(from, 0.0f), to - from, hit, scratch, layers);
+	}
+
+	// Finds the first object shape hits when moved along translation, the same way PhysicsWorld::CastShape does.
+	template<typename Shape>
+	bool CastShape(const Shape& shape, const glm::vec3& translation, PhysicsCastHit& hit, SceneQueryScratch& scratch,
+		unsigned int layers = 0xFFFFFFFF) const;
+
+	// Fills objects with every object whose bounds overlap box, in no particular order.
+	void Overlap(const AABB& box, std::vector<int>& objects, SceneQueryScratch& scratch, unsigned int layers = 0xFFFFFFFF) const;
+
+	// Fills objects with every object shape overlaps (by a GJK test against its OBB, once its bounds overlap shape's), in no particular order.
+	template<typename Shape>
+	void OverlapShape(const Shape& shape, std::vector<int>& objects, SceneQueryScratch& scratch, unsigned int layers = 0xFFFFFFFF) const;
+
+	// For thousands of queries at once (every agent's lines of sight, every sound's occlusion rays), these are much cheaper than one query
+	// at a time. The queries are sorted by where they are, so each packet of LBVH_PACKET of them is a bunch that are close together, and
+	// each packet goes down the tree together (see LinearBVH::CastSegmentPacket). With jobs, the packets are split across its threads (so
+	// it has to be a job system this thread can use; the world's is only for the thread that steps it).
+
+	// RayCast for count rays, from from[i] to to[i]. hits[i] is the hit of ray i (with an object of -1 if it didn't hit anything).
+	void RayCastBatch(const glm::vec3* from, const glm::vec3* to, int count, PhysicsCastHit* hits, SceneQueryBatchScratch& scratch,
+		JobSystem* jobs = nullptr, unsigned int layers = 0xFFFFFFFF) const;
+
+	// Overlap for count boxes. The objects box i overlaps are objects[firsts[i]] up to (but not including) objects[firsts[i + 1]], so
+	// firsts ends up count + 1 long.
+	void OverlapBatch(const AABB* boxes, int count, std::vector<int>& objects, std::vector<int>& firsts, SceneQueryBatchScratch& scratch,
+		JobSystem* jobs = nullptr, unsigned int layers = 0xFFFFFFFF) const;
+};
+
+template<typename Shape>
+bool SceneQuerySnapshot::closestHit(const Shape& shape, const glm::vec3& translation, const std::vector<int>& candidates,
+	ShapeCastSolver& solver, PhysicsCastHit& hit) const
+{
+	hit = PhysicsCastHit();
+
+	// The candidates come in no particular order, so each cast only looks as far as the closest hit so far.
+	float closest = 1.0f;
+
+	for (int i = 0; i < (int)candidates.size(); i++)
+	{
+		int object = candidates[i];
+		ShapeCastResult result;
+
+		if (solver.Cast(shape, translation, shapes[object], closest, result) && (hit.object == -1 || result.fraction < closest))
+		{
+			closest = result.fraction;
+
+			hit.object = object;
+			hit.fraction = result.fraction;
+			hit.normal = result.normal;
+			hit.point = result.point;
+		}
+	}
+
+	return hit.object != -1;
+}
+
+template<typename Shape>
+bool SceneQuerySnapshot::CastShape(const Shape& shape, const glm::vec3& translation, PhysicsCastHit& hit, SceneQueryScratch& scratch,
+	unsigned int layers) const
+{
+	AABB box = getBoundsFromSupport(shape);
+	glm::vec3 center = (box.min + box.max) * 0.5f;
+
+	tree.CastSegment(center, center + translation, box.max - center, scratch.candidates);
+	filterCandidates(layers, scratch.candidates);
+
+	return closestHit(shape, translation, scratch.candidates, scratch.castSolver, hit);
+}
+
+template<typename Shape>
+void SceneQuerySnapshot::OverlapShape(const Shape& shape, std::vector<int>& objects, SceneQueryScratch& scratch, unsigned int layers) const
+{
+	Overlap(getBoundsFromSupport(shape), scratch.candidates, scratch, layers);
+
+	objects.clear();
+
+	for (int i = 0; i < (int)scratch.candidates.size(); i++)
+	{
+		if (scratch.gjk.TestGJK(shape, shapes[scratch.candidates[i]]))
+		{
+			objects.push_back(scratch.candidates[i]);
+		}
+	}
+}
+
+// Two SceneQuerySnapshots, so other threads can query the last step while the physics thread runs the next one, without either waiting on
+// the other.
+// The physics thread copies the world into whichever snapshot isn't the latest, and then makes it the latest. A query starts by taking the
+// latest one (counting itself as one of its readers) and lets go of it when it's done. Nothing ever locks: if a snapshot the physics thread
+// wants to copy over still has readers (who took it before the last copy, and are still going), it skips the copy for that step instead of
+// waiting, and queries carry on seeing the step before.
+class SceneQueryBuffer
+{
+	SceneQuerySnapshot snapshots[2];
+
+	// Which snapshot is the latest (or -1 before the first copy), and how many queries are reading each.
+	std::atomic<int> latest;
+	std::atomic<int> readers[2];
+
+	SceneQueryBuffer(const SceneQueryBuffer&);
+	SceneQueryBuffer& operator=(const SceneQueryBuffer&);
+
+public:
+	SceneQueryBuffer();
+
+	// Copies the world into the snapshot that isn't the latest and makes it the latest. Call it from the thread that steps the world,
+	// between steps (after each step, for queries to see each one). Returns false if the snapshot still had readers, so nothing was copied.
+	bool Publish(PhysicsWorld& world);
+
+	// Takes the latest snapshot to query, which stays the same until it's given back to Release (so hold on to it for no longer than a
+	// query or a few, or the physics thread has to keep skipping copies). Returns nullptr if nothing has been published yet.
+	// Any thread can call these.
+	const SceneQuerySnapshot* Acquire();
+	void Release(const SceneQuerySnapshot* snapshot);
+};
+
+#endif //_SCENE_QUERY_H
@@ -0,0 +1,265 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ShapeCast.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SHAPE_CAST_H
+#define _SHAPE_CAST_H
+
+#include "GJKDistance.h"
+#include "Shapes.h"
+
+// The answer to a cast. If hit is true, the moving shape first touches the other one fraction of the way along its translation, at point
+// (on the surface of the shape that was hit), where that surface faces along normal (back toward the moving shape).
+// A cast that starts out already touching hits at a fraction of 0, and then there's no telling which way the surface faces, so normal is zero.
+struct ShapeCastResult
+{
+	bool hit;
+	float fraction;
+	glm::vec3 normal;
+	glm::vec3 point;
+	int iterations;
+
+	ShapeCastResult()
+	{
+		hit = false;
+		fraction = 0.0f;
+		normal = glm::vec3(0.0f);
+		point = glm::vec3(0.0f);
+		iterations = 0;
+	}
+};
+
+// Casts a convex shape along a straight line against another one, using GJK (Gino van den Bergen's "Ray Casting against General Convex
+// Objects with Application to Continuous Collision Detection").
+// Moving shape A by fraction * translation makes it touch B exactly when fraction * translation is in B - A, the Minkowski Difference
+// (the other way around from the one TestGJK uses). So casting a shape is the same as casting a ray from the origin against B - A, which
+// we can do with nothing but the support functions:
+// - Keep a point x = fraction * translation on the ray, and a simplex of points of B - A, and find v, the point of the simplex closest to x.
+// - The support point p of B - A in the direction v (toward x) gives a plane, with normal v, that all of B - A is behind. If x is in front
+//   of it, then if the ray is heading away from the plane it can never reach B - A (a miss), and otherwise we can move x forward to where
+//   the ray crosses the plane without skipping over any of B - A.
+// - Add p to the simplex and repeat, until x is (within the tolerance) on B - A.
+// A ray is just a cast of a single point, which is a sphere with a radius of 0 (see RayCast below). None of this needs triangles, so any
+// shape with a support function can be cast against, or be cast.
+class ShapeCastSolver
+{
+	DistanceSimplex simplex;
+
+	int maxIterations;
+	float tolerance;
+	float relativeTolerance;
+
+public:
+	ShapeCastSolver()
+	{
+		maxIterations = 64;
+		tolerance = 1e-4f;
+		relativeTolerance = 1e-7f;
+	}
+
+	void SetMaxIterations(int max)
+	{
+		maxIterations = max;
+	}
+	int GetMaxIterations()
+	{
+		return maxIterations;
+	}
+
+	// How close x has to get to B - A to count as a hit.
+	void SetTolerance(float t)
+	{
+		tolerance = t;
+	}
+	float GetTolerance()
+	{
+		return tolerance;
+	}
+
+	// The cast also counts as a hit once a new support point would get x closer to B - A by less than this fraction of the squared size of
+	// the simplex (as seen from x).
+	void SetRelativeTolerance(float t)
+	{
+		relativeTolerance = t;
+	}
+	float GetRelativeTolerance()
+	{
+		return relativeTolerance;
+	}
+
+	// Moves a along translation and finds where it first touches b, if it does before getting maxFraction of the way. Returns result.hit.
+	template<typename ShapeA, typename ShapeB>
+	bool Cast(const ShapeA& a, const glm::vec3& translation, const ShapeB& b, float maxFraction, ShapeCastResult& result);
+};
+
+template<typename ShapeA, typename ShapeB>
+bool ShapeCastSolver::Cast(const ShapeA& a, const glm::vec3& translation, const ShapeB& b, float maxFraction, ShapeCastResult& result)
+{
+	result = ShapeCastResult();
+	simplex.clear();
+
+	float fraction = 0.0f;
+	glm::vec3 x(0.0f);
+	glm::vec3 normal(0.0f);
+
+	// Start v off from any point of B - A. The one farthest back along the ray is as good a guess as any.
+	glm::vec3 pointA = getFarthestPointInDirection(a, translation);
+	glm::vec3 pointB = getFarthestPointInDirection(b, -translation);
+	glm::vec3 v = x - (pointB - pointA);
+
+	float toleranceSquared = tolerance * tolerance;
+
+	while (glm::dot(v, v) > toleranceSquared)
+	{
+		if (result.iterations >= maxIterations)
+		{
+			// If x never moved, we haven't got anywhere near B - A, so the best we can say is that it's a miss. Once it has, though, every
+			// step only moved it up to a plane that all of B - A is behind, so it's still short of the hit, and only by about as much as we
+			// were still trying to shave off. That's a better answer than pretending the ray missed.
+			if (fraction == 0.0f)
+			{
+				return false;
+			}
+
+			break;
+		}
+
+		result.iterations++;
+
+		// The support point of B - A in the direction v is the farthest point of B along v, minus the farthest point of A along -v.
+		pointA = getFarthestPointInDirection(a, -v);
+		pointB = getFarthestPointInDirection(b, v);
+		glm::vec3 w = x - (pointB - pointA);
+
+		float vw = glm::dot(v, w);
+		float vv = glm::dot(v, v);
+		bool moved = vw > 0.0f;
+
+		if (moved)
+		{
+			float vr = glm::dot(v, translation);
+
+			// x is in front of the plane, and the ray is heading away from it (or along it), so it never gets to B - A.
+			if (vr >= 0.0f)
+			{
+				return false;
+			}
+
+			// Move x forward to where the ray meets the plane.
+			fraction -= vw / vr;
+
+			if (fraction > maxFraction)
+			{
+				return false;
+			}
+
+			x = translation * fraction;
+			normal = v;
+		}
+		else
+		{
+			// x didn't move, and the support point gets (next to) no closer to it than v already is, so v is as close as B - A gets to x.
+			// If that's still over tolerance, it's because the shapes are big (or far from the origin) and v can't be worked out to better
+			// than a fraction of their size. "Next to no closer" is measured against the farthest point of the simplex from x, for the same
+			// reason.
+			float largest = glm::dot(w, w);
+
+			for (int i = 0; i < simplex.size(); i++)
+			{
+				largest = glm::max(largest, glm::dot(simplex.points[i], simplex.points[i]));
+			}
+
+			if (vv - vw <= relativeTolerance * largest)
+			{
+				break;
+			}
+		}
+
+		// Keep the simplex we have, in case the new one turns out worse.
+		DistanceSimplex previous = simplex;
+
+		// Add the new point, and find the point of the simplex closest to x. Every point of the simplex is measured from x, which moves, so
+		// they're all worked out again from the points on each shape (which don't).
+		if (simplex.size() < 4)
+		{
+			simplex.push_back(pointA, pointB);
+		}
+
+		for (int i = 0; i < simplex.size(); i++)
+		{
+			simplex.points[i] = x - (simplex.pointsB[i] - simplex.pointsA[i]);
+		}
+
+		glm::vec3 next = simplex.Solve();
+
+		// With x where it was, each step should bring v closer. Once x has moved up to B - A and rounding stops that happening (Solve can't do
+		// any better with a long thin simplex), carrying on would only use up the iterations, so give the answer running out of them would.
+		if (!moved && fraction > 0.0f && glm::dot(next, next) >= vv)
+		{
+			simplex = previous;
+			break;
+		}
+
+		v = next;
+	}
+
+	glm::vec3 hitA, hitB;
+	simplex.GetClosestPoints(hitA, hitB);
+
+	result.hit = true;
+	result.fraction = fraction;
+	result.normal = (normal != glm::vec3(0.0f)) ? glm::normalize(normal) : normal;
+	result.point = hitB;
+
+	return true;
+}
+
+// Casts a over translation against b with its own solver on the stack.
+template<typename ShapeA, typename ShapeB>
+inline bool ShapeCast(const ShapeA& a, const glm::vec3& translation, const ShapeB& b, ShapeCastResult& result, float maxFraction = 1.0f)
+{
+	ShapeCastSolver solver;
+
+	return solver.Cast(a, translation, b, maxFraction, result);
+}
+
+// Casts a ray from from to to against a shape. fraction is how far along from to to the ray hits it.
+template<typename Shape>
+inline bool RayCast(const glm::vec3& from, const glm::vec3& to, const Shape& shape, ShapeCastResult& result, float maxFraction = 1.0f)
+{
+	return ShapeCast(SphereShape(from, 0.0f), to - from, shape, result, maxFraction);
+}
+
+#endif //_SHAPE_CAST_H
@@ -0,0 +1,224 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ShapePairs.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _SHAPE_PAIRS_CPP
+#define _SHAPE_PAIRS_CPP
+
+#include "ShapePairs.h"
+#include <cfloat>
+#include <cmath>
+
+// Added to every |cos| between A's and B's axes, so that when an edge of each is parallel (and their cross product is next to nothing, and
+// all rounding error) the boxes' shadows on it come out a little wider, rather than a separating axis being found that isn't there.
+static const float SAT_PARALLEL_EPSILON = 1e-5f;
+
+// How much shallower an edge pair's axis has to be than the shallowest face's to be the normal instead (see TestBoxesSAT), as a fraction
+// and a distance.
+static const float SAT_EDGE_RELATIVE_TOLERANCE = 0.95f;
+static const float SAT_EDGE_ABSOLUTE_TOLERANCE = 0.01f;
+
+bool TestBoxesSAT(const OBBShape& a, const OBBShape& b, glm::vec3* normal, float* depth)
+{
+	// r[i][j] is how much B's axis j points along A's axis i, which makes it B's axes in A's frame. t is B's center in A's frame.
+	float r[3][3];
+	float absR[3][3];
+	glm::vec3 offset = b.center - a.center;
+	glm::vec3 t = glm::vec3(glm::dot(offset, a.axes[0]), glm::dot(offset, a.axes[1]), glm::dot(offset, a.axes[2]));
+
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			r[i][j] = glm::dot(a.axes[i], b.axes[j]);
+			absR[i][j] = fabsf(r[i][j]) + SAT_PARALLEL_EPSILON;
+		}
+	}
+
+	bool wantsNormal = normal != nullptr && depth != nullptr;
+	float bestOverlap = FLT_MAX;
+	glm::vec3 bestAxis = a.axes[0];
+
+	// A's face normals.
+	for (int i = 0; i < 3; i++)
+	{
+		float radiusB = b.halfExtents[0] * absR[i][0] + b.halfExtents[1] * absR[i][1] + b.halfExtents[2] * absR[i][2];
+		float overlap = a.halfExtents[i] + radiusB - fabsf(t[i]);
+
+		if (overlap < 0.0f)
+		{
+			return false;
+		}
+
+		if (wantsNormal && overlap < bestOverlap)
+		{
+			bestOverlap = overlap;
+			bestAxis = t[i] < 0.0f ? -a.axes[i] : a.axes[i];
+		}
+	}
+
+	// B's face normals.
+	for (int j = 0; j < 3; j++)
+	{
+		float radiusA = a.halfExtents[0] * absR[0][j] + a.halfExtents[1] * absR[1][j] + a.halfExtents[2] * absR[2][j];
+		float distance = t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j];
+		float overlap = radiusA + b.halfExtents[j] - fabsf(distance);
+
+		if (overlap < 0.0f)
+		{
+			return false;
+		}
+
+		if (wantsNormal && overlap < bestOverlap)
+		{
+			bestOverlap = overlap;
+			bestAxis = distance < 0.0f ? -b.axes[j] : b.axes[j];
+		}
+	}
+
+	// The cross product of A's axis i with B's axis j, for every i and j. It isn't unit length (it's as long as the sine of the angle between
+	// them), which doesn't matter for whether the shadows overlap, but the overlap has to be divided by it to compare it with the faces'.
+	float bestFaceOverlap = bestOverlap;
+
+	for (int i = 0; i < 3; i++)
+	{
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+
+		for (int j = 0; j < 3; j++)
+		{
+			int j1 = (j + 1) % 3;
+			int j2 = (j + 2) % 3;
+
+			float radiusA = a.halfExtents[i1] * absR[i2][j] + a.halfExtents[i2] * absR[i1][j];
+			float radiusB = b.halfExtents[j1] * absR[i][j2] + b.halfExtents[j2] * absR[i][j1];
+			float distance = t[i2] * r[i1][j] - t[i1] * r[i2][j];
+			float overlap = radiusA + radiusB - fabsf(distance);
+
+			if (overlap < 0.0f)
+			{
+				return false;
+			}
+
+			if (!wantsNormal)
+			{
+				continue;
+			}
+
+			// Parallel edges have no cross product to speak of, and any overlap along it means nothing.
+			float length = sqrtf(glm::max(1.0f - r[i][j] * r[i][j], 0.0f));
+
+			if (length < 1e-3f)
+			{
+				continue;
+			}
+
+			overlap /= length;
+
+			if (overlap < bestOverlap && overlap < bestFaceOverlap * SAT_EDGE_RELATIVE_TOLERANCE - SAT_EDGE_ABSOLUTE_TOLERANCE)
+			{
+				bestOverlap = overlap;
+				bestAxis = glm::cross(a.axes[i], b.axes[j]) / length;
+
+				if (distance < 0.0f)
+				{
+					bestAxis = -bestAxis;
+				}
+			}
+		}
+	}
+
+	if (wantsNormal)
+	{
+		*normal = bestAxis;
+		*depth = bestOverlap;
+	}
+
+	return true;
+}
+
+// The ShapePairTest for one pair of types, behind the same signature for every pair so they can all go in one table.
+template<typename ShapeA, typename ShapeB>
+static bool convexPairTest(GJKSolver& solver, const ConvexShape& a, const ConvexShape& b, GJKCache* cache)
+{
+	return ShapePairTest<ShapeA, ShapeB>::Test(solver, a.As<ShapeA>(), b.As<ShapeB>(), cache);
+}
+
+// One row of the table: every type B can be, against one type for A. The columns are in ShapeType order.
+#define CONVEX_PAIR_ROW(ShapeA) \
+	{ \
+		convexPairTest<ShapeA, SphereShape>, \
+		convexPairTest<ShapeA, CapsuleShape>, \
+		convexPairTest<ShapeA, CylinderShape>, \
+		convexPairTest<ShapeA, ConeShape>, \
+		convexPairTest<ShapeA, OBBShape>, \
+		convexPairTest<ShapeA, HullShape> \
+	}
+
+static const ConvexPairTest convexPairTests[NUM_SHAPE_TYPES][NUM_SHAPE_TYPES] =
+{
+	CONVEX_PAIR_ROW(SphereShape),
+	CONVEX_PAIR_ROW(CapsuleShape),
+	CONVEX_PAIR_ROW(CylinderShape),
+	CONVEX_PAIR_ROW(ConeShape),
+	CONVEX_PAIR_ROW(OBBShape),
+	CONVEX_PAIR_ROW(HullShape)
+};
+
+#undef CONVEX_PAIR_ROW
+
+// The rows and columns above have to stay in the same order as ShapeType.
+static_assert(SHAPE_SPHERE == 0 && SHAPE_CAPSULE == 1 && SHAPE_CYLINDER == 2 && SHAPE_CONE == 3 && SHAPE_BOX == 4 && SHAPE_HULL == 5 &&
+	NUM_SHAPE_TYPES == 6, "convexPairTests is out of order with ShapeType.");
+
+ConvexPairTest GetConvexPairTest(ShapeType a, ShapeType b)
+{
+	return convexPairTests[a][b];
+}
+
+void TestConvexPairs(GJKSolver& solver, const std::vector<ConvexShape>& shapes, const std::vector<BroadphasePair>& pairs,
+	std::vector<unsigned char>& hits, GJKCache* caches)
+{
+	hits.resize(pairs.size());
+
+	for (int i = 0; i < (int)pairs.size(); i++)
+	{
+		const ConvexShape& a = shapes[pairs[i].a];
+		const ConvexShape& b = shapes[pairs[i].b];
+
+		hits[i] = convexPairTests[a.type][b.type](solver, a, b, caches != nullptr ? &caches[i] : nullptr) ? 1 : 0;
+	}
+}
+
+#endif // _SHAPE_PAIRS_CPP
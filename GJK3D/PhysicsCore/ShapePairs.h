@@ -0,0 +1,221 @@
+/*
+Title: GJK-3D (OBB)
+File Name: ShapePairs.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _SHAPE_PAIRS_H
+#define _SHAPE_PAIRS_H
+
+#include "Broadphase.h"
+#include "GJK.h"
+#include "Shapes.h"
+
+// TestGJK is already a template on both shape types, so any pair of concrete shapes gets its support functions inlined. On top of that, some
+// pairs don't need GJK at all: two spheres overlap if their centers are closer than their radii added together, a sphere overlaps a box
+// if the closest point of the box to its center is within its radius, and two boxes overlap unless one of 15 axes separates them (see
+// TestBoxesSAT). ShapePairTest picks whichever is right for a pair of types at compile time. It's GJK unless there's a specialization below.
+// Like TestGJK, touching counts as colliding. The shortcuts don't leave a simplex in the solver or change the cache, so a pair that needs EPA
+// afterward should go through GJK itself.
+template<typename ShapeA, typename ShapeB>
+struct ShapePairTest
+{
+	static bool Test(GJKSolver& solver, const ShapeA& a, const ShapeB& b, GJKCache* cache)
+	{
+		return solver.TestGJK(a, b, cache);
+	}
+};
+
+// Gets the point of a box closest to point (which is point itself if it is inside the box).
+inline glm::vec3 closestPointOnBox(const OBBShape& box, const glm::vec3& point)
+{
+	glm::vec3 offset = point - box.center;
+	glm::vec3 closest = box.center;
+
+	for (int i = 0; i < 3; i++)
+	{
+		float distance = glm::clamp(glm::dot(offset, box.axes[i]), -box.halfExtents[i], box.halfExtents[i]);
+
+		closest += box.axes[i] * distance;
+	}
+
+	return closest;
+}
+
+// Tests two boxes with the separating axis theorem: they're apart if and only if their shadows on some axis don't overlap, and for two boxes
+// the only axes that can be are the 3 face normals of each and the 9 cross products of an edge of one with an edge of the other. Each axis
+// is a few multiplies, with B's axes already in A's frame, and most separated pairs are ruled out by the first few, so it's usually quicker
+// than GJK. It also finds the contact normal on the way: if normal and depth are given, and the boxes overlap, they're set to the axis
+// they overlap least along (pointing from A to B) and by how much. (A face's normal is picked over an edge pair unless the edges are
+// clearly shallower, since resting boxes touch face to face and an edge axis that only wins by a rounding error would make them rock.)
+bool TestBoxesSAT(const OBBShape& a, const OBBShape& b, glm::vec3* normal = nullptr, float* depth = nullptr);
+
+template<>
+struct ShapePairTest<SphereShape, SphereShape>
+{
+	static bool Test(GJKSolver& /*solver*/, const SphereShape& a, const SphereShape& b, GJKCache* /*cache*/)
+	{
+		glm::vec3 offset = b.center - a.center;
+		float radii = a.radius + b.radius;
+
+		return glm::dot(offset, offset) <= radii * radii;
+	}
+};
+
+template<>
+struct ShapePairTest<SphereShape, OBBShape>
+{
+	static bool Test(GJKSolver& /*solver*/, const SphereShape& a, const OBBShape& b, GJKCache* /*cache*/)
+	{
+		glm::vec3 offset = a.center - closestPointOnBox(b, a.center);
+
+		return glm::dot(offset, offset) <= a.radius * a.radius;
+	}
+};
+
+template<>
+struct ShapePairTest<OBBShape, SphereShape>
+{
+	static bool Test(GJKSolver& solver, const OBBShape& a, const SphereShape& b, GJKCache* cache)
+	{
+		return ShapePairTest<SphereShape, OBBShape>::Test(solver, b, a, cache);
+	}
+};
+
+template<>
+struct ShapePairTest<OBBShape, OBBShape>
+{
+	static bool Test(GJKSolver& /*solver*/, const OBBShape& a, const OBBShape& b, GJKCache* /*cache*/)
+	{
+		return TestBoxesSAT(a, b);
+	}
+};
+
+// A posed hull would turn every search direction into its own space and its support point back out again, at every support call. Instead,
+// the pair is tested in the hull's frame: the other shape is brought into it once, with the inverse of the hull's pose, and the hull is
+// left with no pose at all, so only the other shape's support function has anything to transform. (It also means the numbers GJK works
+// with are all relative to the hull, rather than to a world origin that might be far away.) The simplex and the cache's direction are in
+// the hull's frame too.
+template<typename ShapeB>
+struct ShapePairTest<HullShape, ShapeB>
+{
+	static bool Test(GJKSolver& solver, const HullShape& a, const ShapeB& b, GJKCache* cache)
+	{
+		if (!a.posed)
+		{
+			return solver.TestGJK(a, b, cache);
+		}
+
+		glm::quat inverse = glm::conjugate(a.orientation);
+		ShapeB relativeB = b;
+		transformShape(relativeB, -(inverse * a.position), inverse);
+
+		return solver.TestGJK(HullShape(a.points, a.numPoints), relativeB, cache);
+	}
+};
+
+template<typename ShapeA>
+struct ShapePairTest<ShapeA, HullShape>
+{
+	static bool Test(GJKSolver& solver, const ShapeA& a, const HullShape& b, GJKCache* cache)
+	{
+		if (!b.posed)
+		{
+			return solver.TestGJK(a, b, cache);
+		}
+
+		glm::quat inverse = glm::conjugate(b.orientation);
+		ShapeA relativeA = a;
+		transformShape(relativeA, -(inverse * b.position), inverse);
+
+		return solver.TestGJK(relativeA, HullShape(b.points, b.numPoints), cache);
+	}
+};
+
+// Two hulls go into A's frame (unless only B has a pose), and B's pose becomes relative to A's.
+template<>
+struct ShapePairTest<HullShape, HullShape>
+{
+	static bool Test(GJKSolver& solver, const HullShape& a, const HullShape& b, GJKCache* cache)
+	{
+		if (!a.posed)
+		{
+			if (!b.posed)
+			{
+				return solver.TestGJK(a, b, cache);
+			}
+
+			glm::quat inverse = glm::conjugate(b.orientation);
+			HullShape relativeA = a;
+			transformShape(relativeA, -(inverse * b.position), inverse);
+
+			return solver.TestGJK(relativeA, HullShape(b.points, b.numPoints), cache);
+		}
+
+		glm::quat inverse = glm::conjugate(a.orientation);
+		HullShape relativeB = b;
+		transformShape(relativeB, -(inverse * a.position), inverse);
+
+		return solver.TestGJK(HullShape(a.points, a.numPoints), relativeB, cache);
+	}
+};
+
+// When the types are only known at runtime (ConvexShapes), passing them straight to TestGJK means a switch on the type at every support
+// call. Instead, the pair of types gets looked up in a table once, and the table holds the ShapePairTest for exactly those two types, with
+// everything inlined for them.
+typedef bool (*ConvexPairTest)(GJKSolver& solver, const ConvexShape& a, const ConvexShape& b, GJKCache* cache);
+
+// The test to use for a pair of shape types.
+ConvexPairTest GetConvexPairTest(ShapeType a, ShapeType b);
+
+template<>
+struct ShapePairTest<ConvexShape, ConvexShape>
+{
+	static bool Test(GJKSolver& solver, const ConvexShape& a, const ConvexShape& b, GJKCache* cache)
+	{
+		return GetConvexPairTest(a.type, b.type)(solver, a, b, cache);
+	}
+};
+
+// Tests any two shapes, the best way there is for their types. (For two ConvexShapes, that's the table.)
+template<typename ShapeA, typename ShapeB>
+inline bool TestShapes(GJKSolver& solver, const ShapeA& a, const ShapeB& b, GJKCache* cache = nullptr)
+{
+	return ShapePairTest<ShapeA, ShapeB>::Test(solver, a, b, cache);
+}
+
+// Tests every pair from a broadphase (whose user data index into shapes), setting hits[i] to 1 if pairs[i] is colliding and 0 if not.
+// caches can be nullptr, or hold one cache per pair.
+void TestConvexPairs(GJKSolver& solver, const std::vector<ConvexShape>& shapes, const std::vector<BroadphasePair>& pairs,
+	std::vector<unsigned char>& hits, GJKCache* caches = nullptr);
+
+#endif //_SHAPE_PAIRS_H
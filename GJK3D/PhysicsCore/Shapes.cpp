@@ -0,0 +1,201 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Shapes.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SHAPES_CPP
+#define _SHAPES_CPP
+
+#include "Shapes.h"
+#include "AABB.h"
+#include "SIMD.h"
+
+const char* GetShapeTypeName(ShapeType type)
+{
+	switch (type)
+	{
+	case SHAPE_SPHERE:
+		return "sphere";
+	case SHAPE_CAPSULE:
+		return "capsule";
+	case SHAPE_CYLINDER:
+		return "cylinder";
+	case SHAPE_CONE:
+		return "cone";
+	case SHAPE_BOX:
+		return "box";
+	case SHAPE_HULL:
+		return "hull";
+	default:
+		return "unknown";
+	}
+}
+
+OBBShape::OBBShape(const glm::mat4& transform, const glm::vec3& localCenter, const glm::vec3& localHalfExtents)
+{
+	// The center just gets transformed like any other point.
+	center = glm::vec3(transform * glm::vec4(localCenter, 1.0f));
+
+	// The first three columns of the transformation matrix are the object's local x, y, and z axes in world space, stretched by the scale.
+	// So the length of each column is how much that axis was scaled, and normalizing it gives us the box axis.
+	for (int i = 0; i < 3; i++)
+	{
+		glm::vec3 column = glm::vec3(transform[i]);
+		float length = glm::length(column);
+
+		axes[i] = length > 0.0f ? column / length : glm::vec3(0.0f);
+		halfExtents[i] = localHalfExtents[i] * length;
+	}
+}
+
+void BuildOBBShapes(const int* objects, int count, const glm::mat4* const* transforms, const glm::vec3* localCenters,
+	const glm::vec3* localHalfExtents, OBBShape* shapes, ShapeBounds* bounds)
+{
+	int i = 0;
+
+#if defined(GJK_SIMD_SSE)
+	// Each register holds one value (like the x of column 0, or the center's y) for all 4 boxes, the same way BodyStore builds 4 transforms
+	// at once. Every sum is added up in the same order as the one box version, so the boxes come out the same to the last bit.
+	__m128 zero = _mm_setzero_ps();
+	__m128 signBit = _mm_set1_ps(-0.0f);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const int* o = objects + i;
+		const glm::mat4* m[4] = { transforms[o[0]], transforms[o[1]], transforms[o[2]], transforms[o[3]] };
+
+		// After transposing, columns[k][j] is row j of column k, for each box.
+		__m128 columns[4][4];
+
+		for (int k = 0; k < 4; k++)
+		{
+			columns[k][0] = _mm_loadu_ps(&(*m[0])[k].x);
+			columns[k][1] = _mm_loadu_ps(&(*m[1])[k].x);
+			columns[k][2] = _mm_loadu_ps(&(*m[2])[k].x);
+			columns[k][3] = _mm_loadu_ps(&(*m[3])[k].x);
+			_MM_TRANSPOSE4_PS(columns[k][0], columns[k][1], columns[k][2], columns[k][3]);
+		}
+
+		const glm::vec3* c[4] = { &localCenters[o[0]], &localCenters[o[1]], &localCenters[o[2]], &localCenters[o[3]] };
+		const glm::vec3* h[4] = { &localHalfExtents[o[0]], &localHalfExtents[o[1]], &localHalfExtents[o[2]], &localHalfExtents[o[3]] };
+
+		// Everything each box needs, one value per row: the center, the three axes, the half extents, how far it reaches along each world
+		// axis, and the radius of its sphere.
+		GJK_ALIGN(16) float out[19][4];
+
+		__m128 local[3];
+
+		for (int k = 0; k < 3; k++)
+		{
+			local[k] = _mm_set_ps((*c[3])[k], (*c[2])[k], (*c[1])[k], (*c[0])[k]);
+		}
+
+		for (int j = 0; j < 3; j++)
+		{
+			// transform * vec4(localCenter, 1), row j.
+			__m128 sum0 = _mm_add_ps(_mm_mul_ps(columns[0][j], local[0]), _mm_mul_ps(columns[1][j], local[1]));
+			__m128 sum1 = _mm_add_ps(_mm_mul_ps(columns[2][j], local[2]), columns[3][j]);
+
+			_mm_store_ps(out[j], _mm_add_ps(sum0, sum1));
+		}
+
+		__m128 axes[3][3];
+		__m128 halfExtents[3];
+
+		for (int k = 0; k < 3; k++)
+		{
+			__m128 x = columns[k][0], y = columns[k][1], z = columns[k][2];
+			__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+
+			// A column with no length (a scale of 0) gives an axis of 0, rather than dividing by 0.
+			__m128 hasLength = _mm_cmpgt_ps(length, zero);
+
+			for (int j = 0; j < 3; j++)
+			{
+				axes[k][j] = _mm_and_ps(hasLength, _mm_div_ps(columns[k][j], length));
+				_mm_store_ps(out[3 + k * 3 + j], axes[k][j]);
+			}
+
+			halfExtents[k] = _mm_mul_ps(_mm_set_ps((*h[3])[k], (*h[2])[k], (*h[1])[k], (*h[0])[k]), length);
+			_mm_store_ps(out[12 + k], halfExtents[k]);
+		}
+
+		// The same as getBounds: the reach along each world axis is the sum of each box axis's reach along it.
+		for (int j = 0; j < 3; j++)
+		{
+			__m128 reach0 = _mm_mul_ps(_mm_andnot_ps(signBit, axes[0][j]), halfExtents[0]);
+			__m128 reach1 = _mm_mul_ps(_mm_andnot_ps(signBit, axes[1][j]), halfExtents[1]);
+			__m128 reach2 = _mm_mul_ps(_mm_andnot_ps(signBit, axes[2][j]), halfExtents[2]);
+
+			_mm_store_ps(out[15 + j], _mm_add_ps(_mm_add_ps(reach0, reach1), reach2));
+		}
+
+		__m128 hx = halfExtents[0], hy = halfExtents[1], hz = halfExtents[2];
+		_mm_store_ps(out[18], _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(hx, hx), _mm_mul_ps(hy, hy)), _mm_mul_ps(hz, hz))));
+
+		// Then each box gets its values back out of the rows.
+		for (int b = 0; b < 4; b++)
+		{
+			OBBShape& shape = shapes[o[b]];
+			ShapeBounds& shapeBounds = bounds[o[b]];
+
+			shape.center = glm::vec3(out[0][b], out[1][b], out[2][b]);
+
+			for (int k = 0; k < 3; k++)
+			{
+				shape.axes[k] = glm::vec3(out[3 + k * 3][b], out[4 + k * 3][b], out[5 + k * 3][b]);
+			}
+
+			shape.halfExtents = glm::vec3(out[12][b], out[13][b], out[14][b]);
+
+			glm::vec3 extent(out[15][b], out[16][b], out[17][b]);
+
+			shapeBounds.box = AABB(shape.center - extent, shape.center + extent);
+			shapeBounds.center = shape.center;
+			shapeBounds.radius = out[18][b];
+		}
+	}
+#endif
+
+	// Whatever is left over (or everything, without SIMD).
+	for (; i < count; i++)
+	{
+		int object = objects[i];
+
+		shapes[object] = OBBShape(*transforms[object], localCenters[object], localHalfExtents[object]);
+		bounds[object] = getShapeBounds(shapes[object]);
+	}
+}
+
+#endif // _SHAPES_CPP
@@ -0,0 +1,700 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Shapes.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SHAPES_H
+#define _SHAPES_H
+
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+
+// An OBB described by its center, its three (unit length) local axes and how far it extends along each of them.
+// This is all a box needs for its support function, so unlike the 8-corner OBB we never have to transform the corners into world space.
+struct OBBShape
+{
+	glm::vec3 center;
+	glm::vec3 axes[3];
+	glm::vec3 halfExtents;
+
+	OBBShape()
+	{
+		center = glm::vec3(0.0f);
+		axes[0] = glm::vec3(1.0f, 0.0f, 0.0f);
+		axes[1] = glm::vec3(0.0f, 1.0f, 0.0f);
+		axes[2] = glm::vec3(0.0f, 0.0f, 1.0f);
+		halfExtents = glm::vec3(0.0f);
+	}
+
+	// Builds the world space box from an object's transformation matrix and the box around its model in local space.
+	OBBShape(const glm::mat4& transform, const glm::vec3& localCenter, const glm::vec3& localHalfExtents);
+};
+
+// Gets the farthest point of a given OBBShape in a given direction.
+// For a box that is the corner on the positive side of every axis that points along dir: c + sign(dir . axis_i) * h_i * axis_i for each i.
+// That's three dot products, no matter how the box is oriented.
+inline glm::vec3 getFarthestPointInDirection(const OBBShape& obj, const glm::vec3& dir)
+{
+	glm::vec3 farthestPoint = obj.center;
+
+	for (int i = 0; i < 3; i++)
+	{
+		float extent = glm::dot(dir, obj.axes[i]) >= 0.0f ? obj.halfExtents[i] : -obj.halfExtents[i];
+
+		farthestPoint += obj.axes[i] * extent;
+	}
+
+	return farthestPoint;
+}
+
+// The same again in double, for the double precision solver (see GJKSolverT in GJK.h). The box itself is still stored in float, but
+// nothing is rounded back to float on the way, so a box far from the origin keeps every bit of its corners.
+inline glm::dvec3 getFarthestPointInDirection(const OBBShape& obj, const glm::dvec3& dir)
+{
+	glm::dvec3 farthestPoint = glm::dvec3(obj.center);
+
+	for (int i = 0; i < 3; i++)
+	{
+		glm::dvec3 axis = glm::dvec3(obj.axes[i]);
+		double extent = glm::dot(dir, axis) >= 0.0 ? obj.halfExtents[i] : -obj.halfExtents[i];
+
+		farthestPoint += axis * extent;
+	}
+
+	return farthestPoint;
+}
+
+// A sphere is just a center and a radius.
+struct SphereShape
+{
+	glm::vec3 center;
+	float radius;
+
+	SphereShape()
+	{
+		center = glm::vec3(0.0f);
+		radius = 0.0f;
+	}
+
+	SphereShape(const glm::vec3& c, float r)
+	{
+		center = c;
+		radius = r;
+	}
+};
+
+// A capsule is every point within radius of the line segment from pointA to pointB (a cylinder with two half-sphere caps).
+struct CapsuleShape
+{
+	glm::vec3 pointA;
+	glm::vec3 pointB;
+	float radius;
+
+	CapsuleShape()
+	{
+		pointA = glm::vec3(0.0f);
+		pointB = glm::vec3(0.0f);
+		radius = 0.0f;
+	}
+
+	CapsuleShape(const glm::vec3& a, const glm::vec3& b, float r)
+	{
+		pointA = a;
+		pointB = b;
+		radius = r;
+	}
+};
+
+// A cylinder centered on center, running halfHeight along its (unit length) axis in both directions.
+struct CylinderShape
+{
+	glm::vec3 center;
+	glm::vec3 axis;
+	float halfHeight;
+	float radius;
+
+	CylinderShape()
+	{
+		center = glm::vec3(0.0f);
+		axis = glm::vec3(0.0f, 1.0f, 0.0f);
+		halfHeight = 0.0f;
+		radius = 0.0f;
+	}
+
+	CylinderShape(const glm::vec3& c, const glm::vec3& a, float h, float r)
+	{
+		center = c;
+		axis = a;
+		halfHeight = h;
+		radius = r;
+	}
+};
+
+// A cone with its base circle centered on baseCenter, and its tip height away from it along the (unit length) axis.
+struct ConeShape
+{
+	glm::vec3 baseCenter;
+	glm::vec3 axis;
+	float height;
+	float radius;
+
+	ConeShape()
+	{
+		baseCenter = glm::vec3(0.0f);
+		axis = glm::vec3(0.0f, 1.0f, 0.0f);
+		height = 0.0f;
+		radius = 0.0f;
+	}
+
+	ConeShape(const glm::vec3& c, const glm::vec3& a, float h, float r)
+	{
+		baseCenter = c;
+		axis = a;
+		height = h;
+		radius = r;
+	}
+};
+
+// Any convex shape given by a list of points (the shape is the convex hull of those points), turned by orientation and then moved to
+// position. The points can be in world space already (with no pose), or in the hull's own local space, in which case moving the hull is
+// only a matter of changing its pose: none of its points ever need transforming, however many there are.
+// Note that the points are not copied, we just point at them. So make sure they are stored elsewhere and outlive the shape!
+struct HullShape
+{
+	const glm::vec3* points;
+	int numPoints;
+
+	// Whether there's a pose at all. Without one, the support function skips the rotations, which for a small hull cost as much as the search.
+	bool posed;
+	glm::vec3 position;
+	glm::quat orientation;
+
+	HullShape()
+	{
+		points = nullptr;
+		numPoints = 0;
+		posed = false;
+		position = glm::vec3(0.0f);
+		orientation = glm::quat();
+	}
+
+	HullShape(const glm::vec3* pts, int count)
+	{
+		points = pts;
+		numPoints = count;
+		posed = false;
+		position = glm::vec3(0.0f);
+		orientation = glm::quat();
+	}
+
+	HullShape(const glm::vec3* pts, int count, const glm::vec3& inPosition, const glm::quat& inOrientation)
+	{
+		points = pts;
+		numPoints = count;
+		posed = true;
+		position = inPosition;
+		orientation = inOrientation;
+	}
+};
+
+// A single triangle, from a mesh that isn't convex as a whole (see TriangleMesh). It's flat, but GJK only needs a support function, and
+// the Minkowski Difference of a triangle and any solid shape still has volume.
+struct TriangleShape
+{
+	glm::vec3 a;
+	glm::vec3 b;
+	glm::vec3 c;
+
+	TriangleShape()
+	{
+		a = b = c = glm::vec3(0.0f);
+	}
+
+	TriangleShape(const glm::vec3& inA, const glm::vec3& inB, const glm::vec3& inC)
+	{
+		a = inA;
+		b = inB;
+		c = inC;
+	}
+};
+
+// Returns dir scaled to unit length, or the x axis if dir has no length (every direction is as good as any other then).
+inline glm::vec3 safeNormalize(const glm::vec3& dir)
+{
+	float lengthSquared = glm::dot(dir, dir);
+
+	if (lengthSquared > 0.0f)
+	{
+		return dir / sqrtf(lengthSquared);
+	}
+
+	return glm::vec3(1.0f, 0.0f, 0.0f);
+}
+
+// For round shapes there are no corners to pick from, so each support function is worked out directly from the shape.
+
+// The farthest point on a sphere is straight out from the center along dir.
+inline glm::vec3 getFarthestPointInDirection(const SphereShape& obj, const glm::vec3& dir)
+{
+	return obj.center + safeNormalize(dir) * obj.radius;
+}
+
+// And in double. (The other round shapes just have their float point widened, see GJK.h.)
+inline glm::dvec3 getFarthestPointInDirection(const SphereShape& obj, const glm::dvec3& dir)
+{
+	double lengthSquared = glm::dot(dir, dir);
+	glm::dvec3 unit = lengthSquared > 0.0 ? dir / sqrt(lengthSquared) : glm::dvec3(1.0, 0.0, 0.0);
+
+	return glm::dvec3(obj.center) + unit * double(obj.radius);
+}
+
+// The farthest point on a capsule is the farthest end of its segment, pushed out by the radius like a sphere.
+inline glm::vec3 getFarthestPointInDirection(const CapsuleShape& obj, const glm::vec3& dir)
+{
+	glm::vec3 end = glm::dot(obj.pointA, dir) > glm::dot(obj.pointB, dir) ? obj.pointA : obj.pointB;
+
+	return end + safeNormalize(dir) * obj.radius;
+}
+
+// The farthest point on a cylinder is on the rim of whichever cap faces dir, on the side of the rim that faces dir.
+inline glm::vec3 getFarthestPointInDirection(const CylinderShape& obj, const glm::vec3& dir)
+{
+	float along = glm::dot(dir, obj.axis);
+
+	// Split dir into the part along the axis (which picks the cap) and the part across it (which picks the point on the rim).
+	glm::vec3 across = dir - obj.axis * along;
+	float acrossLengthSquared = glm::dot(across, across);
+
+	glm::vec3 farthestPoint = obj.center + obj.axis * (along >= 0.0f ? obj.halfHeight : -obj.halfHeight);
+
+	// If dir runs straight down the axis, the whole cap is equally far, so the center of the cap will do.
+	if (acrossLengthSquared > 0.0f)
+	{
+		farthestPoint += across * (obj.radius / sqrtf(acrossLengthSquared));
+	}
+
+	return farthestPoint;
+}
+
+// The farthest point on a cone is either its tip or the point on its base rim that faces dir, whichever projects farther.
+inline glm::vec3 getFarthestPointInDirection(const ConeShape& obj, const glm::vec3& dir)
+{
+	glm::vec3 tip = obj.baseCenter + obj.axis * obj.height;
+
+	glm::vec3 across = dir - obj.axis * glm::dot(dir, obj.axis);
+	float acrossLengthSquared = glm::dot(across, across);
+
+	glm::vec3 rim = obj.baseCenter;
+
+	if (acrossLengthSquared > 0.0f)
+	{
+		rim += across * (obj.radius / sqrtf(acrossLengthSquared));
+	}
+
+	return glm::dot(tip, dir) > glm::dot(rim, dir) ? tip : rim;
+}
+
+// The farthest point on a hull is just whichever of its points projects farthest, like the 8-corner OBB but for any number of points.
+// Rather than bring every point into world space, dir is turned back into the points' space, and only the one that's farthest there is
+// brought out again. So whatever the pose, that's two rotations on top of the dot products.
+inline glm::vec3 getFarthestPointInDirection(const HullShape& obj, const glm::vec3& dir)
+{
+	glm::vec3 localDir = obj.posed ? glm::conjugate(obj.orientation) * dir : dir;
+
+	int farthest = 0;
+	float maxDist = glm::dot(obj.points[0], localDir);
+
+	for (int i = 1; i < obj.numPoints; i++)
+	{
+		float dist = glm::dot(obj.points[i], localDir);
+
+		if (dist > maxDist)
+		{
+			maxDist = dist;
+			farthest = i;
+		}
+	}
+
+	return obj.posed ? obj.position + obj.orientation * obj.points[farthest] : obj.points[farthest];
+}
+
+// The farthest point on a triangle is whichever corner projects farthest.
+inline glm::vec3 getFarthestPointInDirection(const TriangleShape& obj, const glm::vec3& dir)
+{
+	float distA = glm::dot(obj.a, dir);
+	float distB = glm::dot(obj.b, dir);
+	float distC = glm::dot(obj.c, dir);
+
+	if (distA >= distB && distA >= distC)
+	{
+		return obj.a;
+	}
+
+	return distB >= distC ? obj.b : obj.c;
+}
+
+// The different kinds of shape a ConvexShape can hold.
+enum ShapeType
+{
+	SHAPE_SPHERE,
+	SHAPE_CAPSULE,
+	SHAPE_CYLINDER,
+	SHAPE_CONE,
+	SHAPE_BOX,
+	SHAPE_HULL,
+
+	NUM_SHAPE_TYPES	// Not a type, just how many there are (for tables indexed by type).
+};
+
+// A ConvexShape can hold any one of the shapes above, so that different kinds of shapes can be kept in the same array.
+// There are no virtual functions here. The shape is stored in place and the type tells us which support function to call,
+// so collections can be tested without a virtual call per support point. When both types are known ahead of time, just pass the
+// concrete shapes straight into TestGJK instead, and everything gets inlined.
+struct ConvexShape
+{
+	ShapeType type;
+
+	// Every shape type is plain data, so they can all share the same storage (this is a union in all but name).
+	union
+	{
+		float storage[sizeof(OBBShape) / sizeof(float)];
+		void* alignment;
+	};
+
+	ConvexShape()
+	{
+		Set(OBBShape());
+	}
+
+	ConvexShape(const SphereShape& shape)
+	{
+		Set(shape);
+	}
+	ConvexShape(const CapsuleShape& shape)
+	{
+		Set(shape);
+	}
+	ConvexShape(const CylinderShape& shape)
+	{
+		Set(shape);
+	}
+	ConvexShape(const ConeShape& shape)
+	{
+		Set(shape);
+	}
+	ConvexShape(const OBBShape& shape)
+	{
+		Set(shape);
+	}
+	ConvexShape(const HullShape& shape)
+	{
+		Set(shape);
+	}
+
+	void Set(const SphereShape& shape)
+	{
+		type = SHAPE_SPHERE;
+		As<SphereShape>() = shape;
+	}
+	void Set(const CapsuleShape& shape)
+	{
+		type = SHAPE_CAPSULE;
+		As<CapsuleShape>() = shape;
+	}
+	void Set(const CylinderShape& shape)
+	{
+		type = SHAPE_CYLINDER;
+		As<CylinderShape>() = shape;
+	}
+	void Set(const ConeShape& shape)
+	{
+		type = SHAPE_CONE;
+		As<ConeShape>() = shape;
+	}
+	void Set(const OBBShape& shape)
+	{
+		type = SHAPE_BOX;
+		As<OBBShape>() = shape;
+	}
+	void Set(const HullShape& shape)
+	{
+		type = SHAPE_HULL;
+		As<HullShape>() = shape;
+	}
+
+	// Gets the stored shape as the given type. Make sure it matches type!
+	template<typename Shape>
+	Shape& As()
+	{
+		return *reinterpret_cast<Shape*>(storage);
+	}
+	template<typename Shape>
+	const Shape& As() const
+	{
+		return *reinterpret_cast<const Shape*>(storage);
+	}
+};
+
+// The storage is sized for the OBB, so make sure every other shape fits in it too.
+static_assert(sizeof(SphereShape) <= sizeof(OBBShape) && sizeof(CapsuleShape) <= sizeof(OBBShape) && sizeof(CylinderShape) <= sizeof(OBBShape) &&
+	sizeof(ConeShape) <= sizeof(OBBShape) && sizeof(HullShape) <= sizeof(OBBShape), "ConvexShape storage is too small for one of the shapes.");
+
+// Gets the farthest point of whatever shape a ConvexShape is holding. The switch is the only cost on top of the shape's own support function.
+inline glm::vec3 getFarthestPointInDirection(const ConvexShape& obj, const glm::vec3& dir)
+{
+	switch (obj.type)
+	{
+	case SHAPE_SPHERE:
+		return getFarthestPointInDirection(obj.As<SphereShape>(), dir);
+	case SHAPE_CAPSULE:
+		return getFarthestPointInDirection(obj.As<CapsuleShape>(), dir);
+	case SHAPE_CYLINDER:
+		return getFarthestPointInDirection(obj.As<CylinderShape>(), dir);
+	case SHAPE_CONE:
+		return getFarthestPointInDirection(obj.As<ConeShape>(), dir);
+	case SHAPE_HULL:
+		return getFarthestPointInDirection(obj.As<HullShape>(), dir);
+	case SHAPE_BOX:
+	default:
+		return getFarthestPointInDirection(obj.As<OBBShape>(), dir);
+	}
+}
+
+// Moves a shape by offset, and returns true if it could. MixedGJKSolver (see MixedGJK.h) uses these to move a pair of shapes that are far
+// from the origin back next to it before testing them, since float has a lot more precision to spare near zero.
+inline bool translateShape(SphereShape& obj, const glm::vec3& offset)
+{
+	obj.center += offset;
+
+	return true;
+}
+inline bool translateShape(CapsuleShape& obj, const glm::vec3& offset)
+{
+	obj.pointA += offset;
+	obj.pointB += offset;
+
+	return true;
+}
+inline bool translateShape(CylinderShape& obj, const glm::vec3& offset)
+{
+	obj.center += offset;
+
+	return true;
+}
+inline bool translateShape(ConeShape& obj, const glm::vec3& offset)
+{
+	obj.baseCenter += offset;
+
+	return true;
+}
+inline bool translateShape(OBBShape& obj, const glm::vec3& offset)
+{
+	obj.center += offset;
+
+	return true;
+}
+
+// A hull's points live somewhere else, but its pose moves them all.
+inline bool translateShape(HullShape& obj, const glm::vec3& offset)
+{
+	obj.posed = true;
+	obj.position += offset;
+
+	return true;
+}
+
+inline bool translateShape(ConvexShape& obj, const glm::vec3& offset)
+{
+	switch (obj.type)
+	{
+	case SHAPE_SPHERE:
+		return translateShape(obj.As<SphereShape>(), offset);
+	case SHAPE_CAPSULE:
+		return translateShape(obj.As<CapsuleShape>(), offset);
+	case SHAPE_CYLINDER:
+		return translateShape(obj.As<CylinderShape>(), offset);
+	case SHAPE_CONE:
+		return translateShape(obj.As<ConeShape>(), offset);
+	case SHAPE_HULL:
+		return translateShape(obj.As<HullShape>(), offset);
+	case SHAPE_BOX:
+	default:
+		return translateShape(obj.As<OBBShape>(), offset);
+	}
+}
+
+// What kind of shape each one is, and how many points its support function has to choose between (0 for the round ones, which work theirs
+// out instead). A hull with a lot of points costs that much more in every support call, so these go into the reports of which pairs are
+// costing the narrowphase the most (see PairCost), to say which content needs simplifying.
+inline ShapeType getShapeType(const SphereShape&)
+{
+	return SHAPE_SPHERE;
+}
+inline ShapeType getShapeType(const CapsuleShape&)
+{
+	return SHAPE_CAPSULE;
+}
+inline ShapeType getShapeType(const CylinderShape&)
+{
+	return SHAPE_CYLINDER;
+}
+inline ShapeType getShapeType(const ConeShape&)
+{
+	return SHAPE_CONE;
+}
+inline ShapeType getShapeType(const OBBShape&)
+{
+	return SHAPE_BOX;
+}
+inline ShapeType getShapeType(const HullShape&)
+{
+	return SHAPE_HULL;
+}
+inline ShapeType getShapeType(const ConvexShape& obj)
+{
+	return obj.type;
+}
+
+inline int getShapePoints(const SphereShape&)
+{
+	return 0;
+}
+inline int getShapePoints(const CapsuleShape&)
+{
+	return 0;
+}
+inline int getShapePoints(const CylinderShape&)
+{
+	return 0;
+}
+inline int getShapePoints(const ConeShape&)
+{
+	return 0;
+}
+inline int getShapePoints(const OBBShape&)
+{
+	return 8;
+}
+inline int getShapePoints(const HullShape& obj)
+{
+	return obj.numPoints;
+}
+inline int getShapePoints(const ConvexShape& obj)
+{
+	switch (obj.type)
+	{
+	case SHAPE_HULL:
+		return getShapePoints(obj.As<HullShape>());
+	case SHAPE_BOX:
+		return getShapePoints(obj.As<OBBShape>());
+	default:
+		return 0;
+	}
+}
+
+// A readable name for a shape type, for printing reports.
+const char* GetShapeTypeName(ShapeType type);
+
+// Turns a shape by orientation (about the origin) and then moves it by position. This is how a shape is placed in a body's frame, or brought
+// back out of one (with the inverse pose), like the pair tests in ShapePairs.h do to test a hull in its own local space.
+inline void transformShape(SphereShape& obj, const glm::vec3& position, const glm::quat& orientation)
+{
+	obj.center = position + orientation * obj.center;
+}
+inline void transformShape(CapsuleShape& obj, const glm::vec3& position, const glm::quat& orientation)
+{
+	obj.pointA = position + orientation * obj.pointA;
+	obj.pointB = position + orientation * obj.pointB;
+}
+inline void transformShape(CylinderShape& obj, const glm::vec3& position, const glm::quat& orientation)
+{
+	obj.center = position + orientation * obj.center;
+	obj.axis = orientation * obj.axis;
+}
+inline void transformShape(ConeShape& obj, const glm::vec3& position, const glm::quat& orientation)
+{
+	obj.baseCenter = position + orientation * obj.baseCenter;
+	obj.axis = orientation * obj.axis;
+}
+inline void transformShape(OBBShape& obj, const glm::vec3& position, const glm::quat& orientation)
+{
+	obj.center = position + orientation * obj.center;
+
+	for (int i = 0; i < 3; i++)
+	{
+		obj.axes[i] = orientation * obj.axes[i];
+	}
+}
+inline void transformShape(TriangleShape& obj, const glm::vec3& position, const glm::quat& orientation)
+{
+	obj.a = position + orientation * obj.a;
+	obj.b = position + orientation * obj.b;
+	obj.c = position + orientation * obj.c;
+}
+
+// A hull's points stay where they are, and the transform goes on top of its pose instead.
+inline void transformShape(HullShape& obj, const glm::vec3& position, const glm::quat& orientation)
+{
+	obj.position = obj.posed ? position + orientation * obj.position : position;
+	obj.orientation = obj.posed ? orientation * obj.orientation : orientation;
+	obj.posed = true;
+}
+
+inline void transformShape(ConvexShape& obj, const glm::vec3& position, const glm::quat& orientation)
+{
+	switch (obj.type)
+	{
+	case SHAPE_SPHERE:
+		transformShape(obj.As<SphereShape>(), position, orientation);
+		break;
+	case SHAPE_CAPSULE:
+		transformShape(obj.As<CapsuleShape>(), position, orientation);
+		break;
+	case SHAPE_CYLINDER:
+		transformShape(obj.As<CylinderShape>(), position, orientation);
+		break;
+	case SHAPE_CONE:
+		transformShape(obj.As<ConeShape>(), position, orientation);
+		break;
+	case SHAPE_HULL:
+		transformShape(obj.As<HullShape>(), position, orientation);
+		break;
+	case SHAPE_BOX:
+	default:
+		transformShape(obj.As<OBBShape>(), position, orientation);
+		break;
+	}
+}
+
+#endif //_SHAPES_H
@@ -0,0 +1,150 @@
+/*
+Title: GJK-3D (OBB)
+File Name: Shapes2D.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SHAPES_2D_H
+#define _SHAPES_2D_H
+
+#include "glm\glm.hpp"
+
+// Shapes in the plane, for GJKSolver2D (see GJK.h). A 2.5D game that only ever collides its objects in the plane can describe them with
+// these and pay for two coordinates instead of three in every support call.
+
+// A circle is just a center and a radius.
+struct CircleShape
+{
+	glm::vec2 center;
+	float radius;
+
+	CircleShape()
+	{
+		center = glm::vec2(0.0f);
+		radius = 0.0f;
+	}
+
+	CircleShape(const glm::vec2& c, float r)
+	{
+		center = c;
+		radius = r;
+	}
+};
+
+// A rectangle described by its center, its two (unit length) local axes and how far it extends along each of them, like OBBShape.
+struct RectShape
+{
+	glm::vec2 center;
+	glm::vec2 axes[2];
+	glm::vec2 halfExtents;
+
+	RectShape()
+	{
+		center = glm::vec2(0.0f);
+		axes[0] = glm::vec2(1.0f, 0.0f);
+		axes[1] = glm::vec2(0.0f, 1.0f);
+		halfExtents = glm::vec2(0.0f);
+	}
+
+	// Builds the rectangle turned angle radians (counterclockwise) about its center.
+	RectShape(const glm::vec2& c, const glm::vec2& inHalfExtents, float angle)
+	{
+		float cosine = cosf(angle);
+		float sine = sinf(angle);
+
+		center = c;
+		axes[0] = glm::vec2(cosine, sine);
+		axes[1] = glm::vec2(-sine, cosine);
+		halfExtents = inHalfExtents;
+	}
+};
+
+// Any convex polygon given by a list of points (the shape is the convex hull of those points), in the plane's own space.
+// Like HullShape, the points are not copied, so make sure they are stored elsewhere and outlive the shape!
+struct PolygonShape
+{
+	const glm::vec2* points;
+	int numPoints;
+
+	PolygonShape()
+	{
+		points = nullptr;
+		numPoints = 0;
+	}
+
+	PolygonShape(const glm::vec2* pts, int count)
+	{
+		points = pts;
+		numPoints = count;
+	}
+};
+
+// The farthest point on a circle is straight out from the center along dir (or along the x axis, if dir has no length).
+inline glm::vec2 getFarthestPointInDirection(const CircleShape& obj, const glm::vec2& dir)
+{
+	float lengthSquared = glm::dot(dir, dir);
+	glm::vec2 unit = lengthSquared > 0.0f ? dir / sqrtf(lengthSquared) : glm::vec2(1.0f, 0.0f);
+
+	return obj.center + unit * obj.radius;
+}
+
+// The farthest point on a rectangle is the corner on the positive side of both axes that point along dir. Two dot products.
+inline glm::vec2 getFarthestPointInDirection(const RectShape& obj, const glm::vec2& dir)
+{
+	float extent0 = glm::dot(dir, obj.axes[0]) >= 0.0f ? obj.halfExtents.x : -obj.halfExtents.x;
+	float extent1 = glm::dot(dir, obj.axes[1]) >= 0.0f ? obj.halfExtents.y : -obj.halfExtents.y;
+
+	return obj.center + obj.axes[0] * extent0 + obj.axes[1] * extent1;
+}
+
+// The farthest point on a polygon is whichever of its points projects farthest.
+inline glm::vec2 getFarthestPointInDirection(const PolygonShape& obj, const glm::vec2& dir)
+{
+	int farthest = 0;
+	float maxDist = glm::dot(obj.points[0], dir);
+
+	for (int i = 1; i < obj.numPoints; i++)
+	{
+		float dist = glm::dot(obj.points[i], dir);
+
+		if (dist > maxDist)
+		{
+			maxDist = dist;
+			farthest = i;
+		}
+	}
+
+	return obj.points[farthest];
+}
+
+#endif //_SHAPES_2D_H
@@ -0,0 +1,696 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SimulationRecording.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _SIMULATION_RECORDING_CPP
+#define _SIMULATION_RECORDING_CPP
+
+#include "SimulationRecording.h"
+#include "PhysicsWorld.h"
+#include <cstring>
+
+// How much the recorder writes (and the replayer reads) at a time. Steps that change nothing only write a few dozen bytes, so this saves
+// going to the disk every step.
+static const size_t RECORDING_BUFFER = 1 << 20;
+
+// The most interest points a recording can have, so a broken count can't ask for gigabytes.
+static const int RECORDING_MAX_INTEREST_POINTS = 1 << 16;
+
+// The same for the points of a hull.
+static const int RECORDING_MAX_HULL_POINTS = 1 << 20;
+
+bool RecordedSettings::operator==(const RecordedSettings& other) const
+{
+	return memcmp(this, &other, sizeof(RecordedSettings)) == 0;
+}
+
+static RecordedSettings getSettings(const PhysicsWorld& world)
+{
+	const ContactSolver& solver = world.GetSolverSettings();
+	RecordedSettings settings;
+
+	// Zeroed first, so the padding compares the same too.
+	memset(&settings, 0, sizeof(settings));
+
+	settings.broadphase = world.GetBroadphaseIndex();
+	settings.gjkPrecision = world.GetGJKPrecision();
+	settings.solverIterations = solver.GetIterations();
+	settings.solverSubsteps = solver.GetSubsteps();
+	settings.largeIslandSize = world.GetLargeIslandSize();
+	settings.restitution = solver.GetRestitution();
+	settings.restitutionThreshold = solver.GetRestitutionThreshold();
+	settings.continuousThreshold = world.GetContinuousThreshold();
+	settings.sleepVelocity = world.GetSleepVelocity();
+	settings.sleepTime = world.GetSleepTime();
+	settings.lodDistance = world.GetLevelOfDetailDistance();
+	settings.lodInterval = world.GetLevelOfDetailInterval();
+	settings.islandRateSpeed = world.GetIslandRateSpeed();
+	settings.islandRateInterval = world.GetIslandRateInterval();
+	settings.pairCacheMaxAge = world.GetPairCacheMaxAge();
+	settings.degraded = world.IsDegraded();
+	settings.deterministic = world.IsDeterministic();
+	settings.continuous = world.IsContinuousCollision();
+	settings.sleeping = world.IsSleeping();
+	settings.warmStarting = solver.IsWarmStarting();
+	settings.batching = solver.IsBatching();
+	settings.speculative = world.IsSpeculativeContacts();
+
+	return settings;
+}
+
+static void setSettings(PhysicsWorld& world, const RecordedSettings& settings)
+{
+	// Only what's changed, since some of these (like switching broadphases) are a lot of work even when they change nothing.
+	RecordedSettings current = getSettings(world);
+
+	if (settings.broadphase != current.broadphase)
+	{
+		world.SetBroadphase(settings.broadphase);
+	}
+	if (settings.sleeping != current.sleeping || settings.sleepVelocity != current.sleepVelocity || settings.sleepTime != current.sleepTime)
+	{
+		world.SetSleeping(settings.sleeping != 0, settings.sleepVelocity, settings.sleepTime);
+	}
+
+	world.SetGJKPrecision((GJKPrecision)settings.gjkPrecision);
+	world.SetSolverIterations(settings.solverIterations);
+	world.SetSolverSubsteps(settings.solverSubsteps);
+	world.SetLargeIslandSize(settings.largeIslandSize);
+	world.SetRestitution(settings.restitution, settings.restitutionThreshold);
+	world.SetWarmStarting(settings.warmStarting != 0);
+	world.SetSolverBatching(settings.batching != 0);
+	world.SetContinuousCollision(settings.continuous != 0, settings.continuousThreshold);
+	world.SetSpeculativeContacts(settings.speculative != 0);
+	world.SetDeterministic(settings.deterministic != 0);
+	world.SetDegraded(settings.degraded != 0);
+	world.SetLevelOfDetail(settings.lodDistance, settings.lodInterval);
+	world.SetIslandRates(settings.islandRateSpeed, settings.islandRateInterval);
+	world.SetPairCacheMaxAge(settings.pairCacheMaxAge);
+}
+
+static RecordedBody getBody(PhysicsWorld& world, int object)
+{
+	BodyStore& bodies = world.Bodies();
+	BodyHandle body = world.GetBody(object);
+	RecordedBody recorded;
+
+	recorded.object = object;
+	recorded.position = bodies.Position(body);
+	recorded.orientation = bodies.Orientation(body);
+	recorded.scale = bodies.Scale(body);
+	recorded.velocity = bodies.Velocity(body);
+	recorded.angularVelocity = bodies.AngularVelocity(body);
+	recorded.acceleration = bodies.Acceleration(body);
+	recorded.inverseMass = bodies.InverseMass(body);
+	recorded.type = (int)world.GetBodyType(object);
+	recorded.enabled = world.IsEnabled(object) ? 1 : 0;
+
+	const CollisionFilter& filter = world.GetCollisionFilter(object);
+	recorded.layers = filter.layers;
+	recorded.mask = filter.mask;
+	recorded.group = filter.group;
+	recorded.trigger = world.IsTrigger(object) ? 1 : 0;
+
+	return recorded;
+}
+
+static void setBody(PhysicsWorld& world, const RecordedBody& recorded)
+{
+	BodyStore& bodies = world.Bodies();
+	BodyHandle body = world.GetBody(recorded.object);
+
+	// Changing the type sets the mass (and more), so it goes first, for the recorded mass to go over it.
+	if (world.GetBodyType(recorded.object) != (BodyType)recorded.type)
+	{
+		world.SetBodyType(recorded.object, (BodyType)recorded.type);
+	}
+
+	if (world.IsEnabled(recorded.object) != (recorded.enabled != 0))
+	{
+		world.SetEnabled(recorded.object, recorded.enabled != 0);
+	}
+
+	// Only when it's changed, since it has the broadphase look at the object's pairs again.
+	CollisionFilter filter(recorded.layers, recorded.mask, recorded.group);
+	const CollisionFilter& currentFilter = world.GetCollisionFilter(recorded.object);
+
+	if (filter.layers != currentFilter.layers || filter.mask != currentFilter.mask || filter.group != currentFilter.group)
+	{
+		world.SetCollisionFilter(recorded.object, filter);
+	}
+
+	world.SetTrigger(recorded.object, recorded.trigger != 0);
+
+	bodies.Position(body) = recorded.position;
+	bodies.Orientation(body) = recorded.orientation;
+	bodies.Scale(body) = recorded.scale;
+	bodies.Velocity(body) = recorded.velocity;
+	bodies.AngularVelocity(body) = recorded.angularVelocity;
+	bodies.Acceleration(body) = recorded.acceleration;
+	bodies.InverseMass(body) = recorded.inverseMass;
+	bodies.MarkDirty(body);
+}
+
+SimulationRecorder::SimulationRecorder()
+{
+	file = nullptr;
+	hashing = true;
+	failed = false;
+}
+
+SimulationRecorder::~SimulationRecorder()
+{
+	Close();
+}
+
+bool SimulationRecorder::Open(const std::string& inFileName, bool hashed)
+{
+	Close();
+
+	file = fopen(inFileName.c_str(), "wb");
+
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	setvbuf(file, nullptr, _IOFBF, RECORDING_BUFFER);
+
+	fileName = inFileName;
+	hashing = hashed;
+	failed = false;
+	origin = glm::dvec3(0.0);
+	interestPoints.clear();
+	expected.clear();
+	expectedBoxes.clear();
+	expectedAsleep.clear();
+	expectedHulls.clear();
+	expectedHullSizes.clear();
+
+	// Nothing matches the settings yet, so the first step records them.
+	memset(&settings, 0xFF, sizeof(settings));
+
+	RecordingHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+	header.version = RECORDING_VERSION;
+	header.hashed = hashing ? 1 : 0;
+
+	failed = fwrite(&header, sizeof(header), 1, file) != 1;
+
+	return !failed;
+}
+
+bool SimulationRecorder::Close()
+{
+	if (file == nullptr)
+	{
+		return true;
+	}
+
+	bool written = !failed && ferror(file) == 0;
+
+	// Don't leave half a recording behind.
+	if (fclose(file) != 0 || !written)
+	{
+		remove(fileName.c_str());
+		written = false;
+	}
+
+	file = nullptr;
+
+	return written;
+}
+
+void SimulationRecorder::write(unsigned int type, const void* data, size_t size)
+{
+	if (fwrite(&type, sizeof(type), 1, file) != 1 || fwrite(data, size, 1, file) != 1)
+	{
+		failed = true;
+	}
+}
+
+void SimulationRecorder::Step(PhysicsWorld& world, float dt)
+{
+	// Other threads' changes are made first, so they're compared (and recorded) along with everything else.
+	world.ApplyCommands();
+
+	if (file == nullptr)
+	{
+		world.Step(dt);
+		return;
+	}
+
+	RecordedSettings current = getSettings(world);
+
+	if (current != settings)
+	{
+		write(RECORD_SETTINGS, &current, sizeof(current));
+		settings = current;
+	}
+
+	// Moving the origin moves every body, so it's recorded as the one shift, and what's expected of the bodies is shifted the same way to
+	// compare with. (If it was moved more than once since the last step, the bodies can come out a little differently from one shift by
+	// the total, and those are recorded as having been moved too.)
+	if (world.GetOrigin() != origin)
+	{
+		glm::vec3 shift = glm::vec3(world.GetOrigin() - origin);
+
+		write(RECORD_ORIGIN, &shift, sizeof(shift));
+
+		for (int i = 0; i < (int)expected.size(); i++)
+		{
+			expected[i].position -= shift;
+		}
+
+		for (int i = 0; i < (int)interestPoints.size(); i++)
+		{
+			interestPoints[i] -= shift;
+		}
+
+		origin = world.GetOrigin();
+	}
+
+	// The interest points are usually moved every step, and there are only ever a few of them, so they're recorded all together.
+	if (world.GetInterestPoints() != interestPoints)
+	{
+		interestPoints = world.GetInterestPoints();
+
+		int count = (int)interestPoints.size();
+
+		write(RECORD_INTEREST, &count, sizeof(count));
+
+		if (count > 0 && fwrite(interestPoints.data(), sizeof(glm::vec3), count, file) != (size_t)count)
+		{
+			failed = true;
+		}
+	}
+
+	// Kinematic targets change the bodies inside the step, where they wouldn't be seen, so they're applied here first and recorded like
+	// any other change by hand.
+	world.ApplyKinematicTargets(dt);
+
+	int known = (int)expected.size();
+
+	// Anything that was asleep after the last step and isn't now was woken up by hand (a sleeping object can't wake itself up).
+	for (int i = 0; i < known; i++)
+	{
+		if (expectedAsleep[i] && !world.IsAsleep(i))
+		{
+			write(RECORD_WAKE, &i, sizeof(i));
+		}
+	}
+
+	for (int i = 0; i < known; i++)
+	{
+		RecordedBox box;
+		box.center = world.GetBoxCenter(i);
+		box.halfExtents = world.GetBoxHalfExtents(i);
+
+		if (memcmp(&box, &expectedBoxes[i], sizeof(box)) != 0)
+		{
+			write(RECORD_BOX, &i, sizeof(i));
+
+			if (fwrite(&box, sizeof(box), 1, file) != 1)
+			{
+				failed = true;
+			}
+		}
+	}
+
+	for (int i = 0; i < known; i++)
+	{
+		RecordedBody body = getBody(world, i);
+
+		if (memcmp(&body, &expected[i], sizeof(body)) != 0)
+		{
+			write(RECORD_BODY, &body, sizeof(body));
+		}
+	}
+
+	for (int i = known; i < world.NumObjects(); i++)
+	{
+		RecordedBox box;
+		box.center = world.GetBoxCenter(i);
+		box.halfExtents = world.GetBoxHalfExtents(i);
+
+		RecordedBody body = getBody(world, i);
+
+		write(RECORD_ADD, &box, sizeof(box));
+
+		if (fwrite(&body, sizeof(body), 1, file) != 1)
+		{
+			failed = true;
+		}
+	}
+
+	// After the adds, so the objects are there for the replay to give them their hulls.
+	for (int i = 0; i < world.NumObjects(); i++)
+	{
+		const HullShape& hull = world.GetHull(i);
+		bool changed = (i < known) ? (hull.points != expectedHulls[i] || hull.numPoints != expectedHullSizes[i]) : hull.numPoints > 0;
+
+		if (changed)
+		{
+			int hullRecord[2] = { i, hull.numPoints };
+
+			write(RECORD_HULL, hullRecord, sizeof(hullRecord));
+
+			if (hull.numPoints > 0 && fwrite(hull.points, sizeof(glm::vec3), hull.numPoints, file) != (size_t)hull.numPoints)
+			{
+				failed = true;
+			}
+		}
+	}
+
+	world.Step(dt);
+
+	const PhysicsStepStats& stats = world.GetStepStats();
+
+	RecordedStep step;
+	memset(&step, 0, sizeof(step));
+	step.seconds = stats.total;
+	step.stateHash = hashing ? world.StateHash() : 0;
+	step.dt = dt;
+	step.pairs = stats.pairs;
+	step.contacts = stats.contacts;
+	step.sleeping = stats.sleeping;
+
+	write(RECORD_STEP, &step, sizeof(step));
+
+	// Remember how the step left everything, for the next one to compare with.
+	expected.resize(world.NumObjects());
+	expectedBoxes.resize(world.NumObjects());
+	expectedAsleep.resize(world.NumObjects());
+	expectedHulls.resize(world.NumObjects());
+	expectedHullSizes.resize(world.NumObjects());
+
+	for (int i = 0; i < (int)expected.size(); i++)
+	{
+		expected[i] = getBody(world, i);
+		expectedBoxes[i].center = world.GetBoxCenter(i);
+		expectedBoxes[i].halfExtents = world.GetBoxHalfExtents(i);
+		expectedAsleep[i] = world.IsAsleep(i) ? 1 : 0;
+		expectedHulls[i] = world.GetHull(i).points;
+		expectedHullSizes[i] = world.GetHull(i).numPoints;
+	}
+}
+
+SimulationReplayer::SimulationReplayer()
+{
+	file = nullptr;
+	memset(&header, 0, sizeof(header));
+	memset(&recorded, 0, sizeof(recorded));
+	matched = true;
+}
+
+SimulationReplayer::~SimulationReplayer()
+{
+	Close();
+}
+
+bool SimulationReplayer::Open(const std::string& fileName)
+{
+	Close();
+
+	error.clear();
+	matched = true;
+	hulls.clear();
+
+	file = fopen(fileName.c_str(), "rb");
+
+	if (file == nullptr)
+	{
+		error = "Couldn't open " + fileName + ".";
+		return false;
+	}
+
+	setvbuf(file, nullptr, _IOFBF, RECORDING_BUFFER);
+
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, RECORDING_MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != RECORDING_VERSION)
+	{
+		error = fileName + " isn't a recording (or is from a different version).";
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void SimulationReplayer::Close()
+{
+	if (file != nullptr)
+	{
+		fclose(file);
+		file = nullptr;
+	}
+}
+
+bool SimulationReplayer::read(void* data, size_t size)
+{
+	if (fread(data, size, 1, file) != 1)
+	{
+		error = "The recording ends partway through a step.";
+		return false;
+	}
+
+	return true;
+}
+
+bool SimulationReplayer::Step(PhysicsWorld& world)
+{
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	unsigned int type;
+
+	while (fread(&type, sizeof(type), 1, file) == 1)
+	{
+		if (type == RECORD_SETTINGS)
+		{
+			RecordedSettings settings;
+
+			if (!read(&settings, sizeof(settings)))
+			{
+				return false;
+			}
+
+			if (settings.broadphase < 0 || settings.broadphase >= PhysicsWorld::NUM_BROADPHASES)
+			{
+				error = "The recording has a broadphase that doesn't exist.";
+				return false;
+			}
+
+			setSettings(world, settings);
+		}
+		else if (type == RECORD_WAKE)
+		{
+			int object;
+
+			if (!read(&object, sizeof(object)))
+			{
+				return false;
+			}
+
+			if (object < 0 || object >= world.NumObjects())
+			{
+				error = "The recording wakes up an object that doesn't exist.";
+				return false;
+			}
+
+			world.WakeUp(object);
+		}
+		else if (type == RECORD_BODY)
+		{
+			RecordedBody body;
+
+			if (!read(&body, sizeof(body)))
+			{
+				return false;
+			}
+
+			if (body.object < 0 || body.object >= world.NumObjects())
+			{
+				error = "The recording moves an object that doesn't exist.";
+				return false;
+			}
+
+			setBody(world, body);
+		}
+		else if (type == RECORD_ORIGIN)
+		{
+			glm::vec3 shift;
+
+			if (!read(&shift, sizeof(shift)))
+			{
+				return false;
+			}
+
+			world.ShiftOrigin(shift);
+		}
+		else if (type == RECORD_INTEREST)
+		{
+			int count;
+
+			if (!read(&count, sizeof(count)))
+			{
+				return false;
+			}
+
+			if (count < 0 || count > RECORDING_MAX_INTEREST_POINTS)
+			{
+				error = "The recording has more interest points than it could.";
+				return false;
+			}
+
+			interestPoints.resize(count);
+
+			if (count > 0 && !read(interestPoints.data(), sizeof(glm::vec3) * count))
+			{
+				return false;
+			}
+
+			world.SetInterestPoints(interestPoints);
+		}
+		else if (type == RECORD_BOX)
+		{
+			int object;
+			RecordedBox box;
+
+			if (!read(&object, sizeof(object)) || !read(&box, sizeof(box)))
+			{
+				return false;
+			}
+
+			if (object < 0 || object >= world.NumObjects())
+			{
+				error = "The recording changes the box of an object that doesn't exist.";
+				return false;
+			}
+
+			world.SetBox(object, box.center, box.halfExtents);
+		}
+		else if (type == RECORD_ADD)
+		{
+			RecordedBox box;
+			RecordedBody body;
+
+			if (!read(&box, sizeof(box)) || !read(&body, sizeof(body)))
+			{
+				return false;
+			}
+
+			if (body.object != world.NumObjects())
+			{
+				error = "The recording adds objects out of order.";
+				return false;
+			}
+
+			// Made where it goes, so the broadphase gets it there straight away, and then the rest of the body is filled in.
+			world.AddBox(box.center, box.halfExtents, body.position, body.orientation, body.scale);
+			setBody(world, body);
+		}
+		else if (type == RECORD_HULL)
+		{
+			int hullRecord[2];
+
+			if (!read(hullRecord, sizeof(hullRecord)))
+			{
+				return false;
+			}
+
+			int object = hullRecord[0];
+			int count = hullRecord[1];
+
+			if (object < 0 || object >= world.NumObjects())
+			{
+				error = "The recording gives a hull to an object that doesn't exist.";
+				return false;
+			}
+
+			if (count < 0 || count > RECORDING_MAX_HULL_POINTS)
+			{
+				error = "The recording has a hull with more points than it could.";
+				return false;
+			}
+
+			if ((int)hulls.size() < world.NumObjects())
+			{
+				hulls.resize(world.NumObjects());
+			}
+
+			// Read into a vector of its own first, since the world still points at the old one.
+			std::vector<glm::vec3> points(count);
+
+			if (count > 0 && !read(points.data(), sizeof(glm::vec3) * count))
+			{
+				return false;
+			}
+
+			hulls[object].swap(points);
+			world.SetHull(object, hulls[object].data(), count);
+		}
+		else if (type == RECORD_STEP)
+		{
+			if (!read(&recorded, sizeof(recorded)))
+			{
+				return false;
+			}
+
+			world.Step(recorded.dt);
+
+			matched = !header.hashed || world.StateHash() == recorded.stateHash;
+
+			return true;
+		}
+		else
+		{
+			error = "The recording has a record of a type that doesn't exist.";
+			return false;
+		}
+	}
+
+	// The end of the recording, unless it ended partway through a record's type.
+	if (ferror(file) != 0)
+	{
+		error = "Couldn't read the recording.";
+	}
+
+	return false;
+}
+
+#endif //_SIMULATION_RECORDING_CPP
@@ -0,0 +1,252 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SimulationRecording.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _SIMULATION_RECORDING_H
+#define _SIMULATION_RECORDING_H
+
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class PhysicsWorld;
+
+// The recording format: a header, and then one record after another, each a RecordType followed by the struct that goes with it. Everything
+// is stored exactly as it is in memory (little-endian). A step's records are everything that was changed by hand since the step before (the
+// settings first, then the origin if it was moved, then the interest points if they were, then objects woken up, given new boxes, moved or added,
+// then objects given new hulls), and then the step itself.
+static const char RECORDING_MAGIC[4] = { 'G', 'J', 'K', 'R' };
+static const unsigned int RECORDING_VERSION = 13;
+
+struct RecordingHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned int hashed;		// Whether each step has the world's StateHash after it.
+};
+
+enum RecordType
+{
+	RECORD_SETTINGS = 1,	// A RecordedSettings.
+	RECORD_WAKE,			// An int: the object that was woken up (see PhysicsWorld::WakeUp).
+	RECORD_BODY,			// A RecordedBody: an object that was moved (or given a velocity and so on).
+	RECORD_BOX,				// An int and then a RecordedBox: an object that was given a new box (see PhysicsWorld::SetBox).
+	RECORD_ADD,				// A RecordedBox and then a RecordedBody: an object that was added.
+	RECORD_ORIGIN,			// A glm::vec3: how far the origin was moved (see PhysicsWorld::ShiftOrigin).
+	RECORD_INTEREST,		// An int, and then that many glm::vec3s: the interest points (see PhysicsWorld::SetInterestPoints).
+	RECORD_STEP,			// A RecordedStep.
+	RECORD_HULL				// Two ints, the object and how many points, and then that many glm::vec3s: an object that was given a new hull, or
+							// had it taken away with no points (see PhysicsWorld::SetHull).
+};
+
+// Every setting of the world that changes what a step does.
+struct RecordedSettings
+{
+	int broadphase;
+	int gjkPrecision;
+	int solverIterations;
+	int solverSubsteps;
+	int largeIslandSize;	// See PhysicsWorld::SetLargeIslandSize.
+	float restitution;
+	float restitutionThreshold;
+	float continuousThreshold;
+	float sleepVelocity;
+	float sleepTime;
+	float lodDistance;
+	int lodInterval;
+	float islandRateSpeed;		// See PhysicsWorld::SetIslandRates.
+	int islandRateInterval;
+	int pairCacheMaxAge;		// See PhysicsWorld::SetPairCacheMaxAge.
+	unsigned char degraded;
+	unsigned char deterministic;
+	unsigned char continuous;
+	unsigned char sleeping;
+	unsigned char warmStarting;
+	unsigned char batching;
+	unsigned char speculative;	// This was padding before, so older recordings read it as off.
+	unsigned char padding[1];
+
+	bool operator==(const RecordedSettings& other) const;
+	bool operator!=(const RecordedSettings& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+struct RecordedBox
+{
+	glm::vec3 center;
+	glm::vec3 halfExtents;
+};
+
+// Everything about an object's body that can be set by hand.
+struct RecordedBody
+{
+	int object;
+	glm::vec3 position;
+	glm::quat orientation;
+	glm::vec3 scale;
+	glm::vec3 velocity;
+	glm::vec3 angularVelocity;
+	glm::vec3 acceleration;
+	float inverseMass;
+	int type;			// Its BodyType (the one it goes back to, if it's disabled).
+	int enabled;		// See PhysicsWorld::SetEnabled.
+	unsigned int layers;	// Its CollisionFilter (see PhysicsWorld::SetCollisionFilter).
+	unsigned int mask;
+	int group;
+	int trigger;		// See PhysicsWorld::SetTrigger.
+};
+
+// What a step did when it was recorded.
+struct RecordedStep
+{
+	double seconds;					// How long it took (see PhysicsStepStats::total).
+	unsigned long long stateHash;	// The world's StateHash after it (or 0 if the recording isn't hashed).
+	float dt;
+	int pairs;
+	int contacts;
+	int sleeping;
+};
+
+// Records a simulation as it runs, to a file that a SimulationReplayer can play back on its own, as fast as it can go. The replay runs the
+// exact same steps as the recording (given a deterministic world; see PhysicsWorld::SetDeterministic), so a step that was slow once is slow
+// every time it's replayed, which makes it something that can be looked at with a profiler and timed before and after a change.
+// Rather than recording whatever called for each change (which could be anything), the recorder compares the world with how the last step
+// left it: whatever is different was changed by hand, and is what gets recorded. So a step costs a compare per object and a record per
+// change, and most steps write next to nothing.
+// The file is written as it goes (through a buffer), so a recording can run for as long as there's disk to put it on.
+// The replay builds its broadphase from scratch, so how the broadphase is laid out inside (and so what it costs) can differ a little from
+// the recording, even though the pairs it finds are the same.
+class SimulationRecorder
+{
+	FILE* file;
+	std::string fileName;
+	bool hashing;
+	bool failed;
+
+	// How the last step left the world, to compare with.
+	RecordedSettings settings;
+	glm::dvec3 origin;
+	std::vector<glm::vec3> interestPoints;
+	std::vector<RecordedBody> expected;
+	std::vector<RecordedBox> expectedBoxes;
+	std::vector<unsigned char> expectedAsleep;
+
+	// The hulls the world pointed at after the last step. The world doesn't own a hull's points, and they have to stay where they are while
+	// it has them, so a hull that points somewhere else (or at a different number of points) is a new one.
+	std::vector<const glm::vec3*> expectedHulls;
+	std::vector<int> expectedHullSizes;
+
+	void write(unsigned int type, const void* data, size_t size);
+
+public:
+	SimulationRecorder();
+	~SimulationRecorder();
+
+	// Starts a new recording. Everything already in the world goes into it with the first step (the replay can't put anything to sleep, so
+	// start before anything has fallen asleep). If hashed is true, each step also records the world's StateHash after it, so the replay can
+	// tell whether it's still doing exactly what the recording did (which costs a pass over every object each step). Returns false if the
+	// file can't be created.
+	bool Open(const std::string& inFileName, bool hashed = true);
+
+	// Finishes the recording. Returns false if anything couldn't be written (in which case the file is deleted).
+	bool Close();
+
+	bool IsOpen() const
+	{
+		return file != nullptr;
+	}
+
+	// Makes the changes waiting in the world's Commands, records whatever has changed since the last step, runs world.Step(dt), and records
+	// the step. (It does the first even when nothing is being recorded, so it can stand in for world.Step.)
+	void Step(PhysicsWorld& world, float dt);
+};
+
+// Plays back a recording made by a SimulationRecorder, into a world of its own.
+class SimulationReplayer
+{
+	FILE* file;
+	RecordingHeader header;
+	RecordedStep recorded;
+	std::vector<glm::vec3> interestPoints;
+
+	// The points of each object's hull, which the world points at, so they have to be kept here for as long as the replay goes on.
+	std::vector<std::vector<glm::vec3> > hulls;
+
+	bool matched;
+	std::string error;
+
+	// Reads the struct that goes with a record, failing if the recording ends first.
+	bool read(void* data, size_t size);
+
+public:
+	SimulationReplayer();
+	~SimulationReplayer();
+
+	// Opens a recording to play back. Returns false (see GetError) if it can't be read or isn't a recording.
+	bool Open(const std::string& fileName);
+	void Close();
+
+	// Plays back the next step into world (which should start out empty, and only be changed by the replayer): makes the changes that were
+	// made by hand before it, then runs it. Returns false at the end of the recording, or if something's wrong with it (see GetError).
+	bool Step(PhysicsWorld& world);
+
+	// What the step that was just played back did when it was recorded.
+	const RecordedStep& GetRecordedStep() const
+	{
+		return recorded;
+	}
+
+	// Whether the world came out of the step exactly as it did when it was recorded. (Always true if the recording isn't hashed.)
+	bool StateMatched() const
+	{
+		return matched;
+	}
+
+	const RecordingHeader& GetHeader() const
+	{
+		return header;
+	}
+
+	// Why Open or Step failed (empty at the end of a recording that's fine).
+	const std::string& GetError() const
+	{
+		return error;
+	}
+};
+
+#endif //_SIMULATION_RECORDING_H
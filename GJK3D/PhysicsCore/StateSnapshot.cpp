@@ -0,0 +1,516 @@
+/*
+Title: GJK-3D (OBB)
+File Name: StateSnapshot.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _STATE_SNAPSHOT_CPP
+#define _STATE_SNAPSHOT_CPP
+
+#include "StateSnapshot.h"
+#include "PhysicsWorld.h"
+#include <cmath>
+#include <cstring>
+
+// The first thing in every encoded snapshot. Only the lowest bit means anything so far.
+static const unsigned int SNAPSHOT_DELTA = 1;
+
+// In a delta, what each object that changed sends: which of its values changed (and so follow), whether it's asleep, and which orientation
+// component was left out (in the top two bits).
+static const unsigned char CHANGED_POSITION = 1;
+static const unsigned char CHANGED_ORIENTATION = 2;
+static const unsigned char CHANGED_VELOCITY = 4;
+static const unsigned char BODY_ASLEEP = 8;
+static const int LARGEST_SHIFT = 4;
+
+// Rounded values are kept well inside an int, so the difference between two of them always fits in a long long.
+static const float MAX_ROUNDED = 1073741823.0f;
+
+bool SnapshotBody::operator==(const SnapshotBody& other) const
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (position[i] != other.position[i] || orientation[i] != other.orientation[i] || velocity[i] != other.velocity[i])
+		{
+			return false;
+		}
+	}
+
+	return largest == other.largest && asleep == other.asleep;
+}
+
+// Rounds value to the nearest multiple of step.
+static int roundToStep(float value, float step)
+{
+	float rounded = std::floor(value / step + 0.5f);
+
+	// NaNs become 0, and anything too far out stops at the edge.
+	if (!(rounded == rounded))
+	{
+		return 0;
+	}
+
+	return (int)glm::clamp(rounded, -MAX_ROUNDED, MAX_ROUNDED);
+}
+
+// What a kept orientation component is multiplied by before it's rounded: the largest value that fits in the bits, over the largest a kept
+// component can be (1/sqrt(2)).
+static float orientationScale(const SnapshotPrecision& precision)
+{
+	int bits = glm::clamp(precision.orientationBits, 2, 24);
+
+	return (float)((1 << (bits - 1)) - 1) * 1.41421356f;
+}
+
+static SnapshotBody roundBody(const glm::vec3& position, const glm::quat& orientation, const glm::vec3& velocity, bool asleep,
+	const SnapshotPrecision& precision)
+{
+	SnapshotBody body;
+	glm::quat q = glm::normalize(orientation);
+	float components[4] = { q.x, q.y, q.z, q.w };
+
+	// Ties go to the first, so the same quaternion always comes out the same way.
+	int largest = 0;
+
+	for (int i = 1; i < 4; i++)
+	{
+		if (std::fabs(components[i]) > std::fabs(components[largest]))
+		{
+			largest = i;
+		}
+	}
+
+	float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+	float scale = orientationScale(precision);
+
+	for (int i = 0, kept = 0; i < 4; i++)
+	{
+		if (i != largest)
+		{
+			body.orientation[kept++] = roundToStep(components[i] * sign * scale, 1.0f);
+		}
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		body.position[i] = roundToStep(position[i], precision.positionStep);
+		body.velocity[i] = roundToStep(velocity[i], precision.velocityStep);
+	}
+
+	body.largest = (unsigned char)largest;
+	body.asleep = asleep ? 1 : 0;
+
+	return body;
+}
+
+StateSnapshot::StateSnapshot()
+{
+	tick = 0;
+}
+
+void StateSnapshot::Capture(PhysicsWorld& world, unsigned int atTick, const SnapshotPrecision& precision)
+{
+	BodyStore& store = world.Bodies();
+
+	tick = atTick;
+	bodies.resize(world.NumObjects());
+
+	for (int i = 0; i < (int)bodies.size(); i++)
+	{
+		BodyHandle body = world.GetBody(i);
+
+		bodies[i] = roundBody(store.Position(body), store.Orientation(body), store.Velocity(body), world.IsAsleep(i), precision);
+	}
+}
+
+void StateSnapshot::Apply(PhysicsWorld& world, const SnapshotPrecision& precision) const
+{
+	BodyStore& store = world.Bodies();
+	float scale = orientationScale(precision);
+
+	for (int i = 0; i < (int)bodies.size(); i++)
+	{
+		const SnapshotBody& snapshot = bodies[i];
+		BodyHandle body = world.GetBody(i);
+
+		// An object that already rounds to the snapshot is left exactly as it is. Otherwise a sleeping object would be moved by the rounding,
+		// and moving a sleeping object by hand wakes it up.
+		if (roundBody(store.Position(body), store.Orientation(body), store.Velocity(body), world.IsAsleep(i), precision) == snapshot)
+		{
+			continue;
+		}
+
+		if (!snapshot.asleep && world.IsAsleep(i))
+		{
+			world.WakeUp(i);
+		}
+
+		// The left out component is whatever makes the quaternion a unit one again.
+		float components[4];
+		float sumSquares = 0.0f;
+
+		for (int c = 0, kept = 0; c < 4; c++)
+		{
+			if (c != snapshot.largest)
+			{
+				components[c] = snapshot.orientation[kept++] / scale;
+				sumSquares += components[c] * components[c];
+			}
+		}
+
+		components[snapshot.largest] = std::sqrt(glm::max(0.0f, 1.0f - sumSquares));
+
+		store.Position(body) = glm::vec3(snapshot.position[0], snapshot.position[1], snapshot.position[2]) * precision.positionStep;
+		store.Orientation(body) = glm::normalize(glm::quat(components[3], components[0], components[1], components[2]));
+		store.Velocity(body) = glm::vec3(snapshot.velocity[0], snapshot.velocity[1], snapshot.velocity[2]) * precision.velocityStep;
+		store.MarkDirty(body);
+	}
+}
+
+// Writes value 7 bits at a time, lowest first, with the top bit of each byte set if there's more to come.
+static void writeVarint(std::vector<unsigned char>& out, unsigned long long value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+
+	out.push_back((unsigned char)value);
+}
+
+// Signed values are zigzagged first (0, -1, 1, -2, 2... become 0, 1, 2, 3, 4...), so small negative numbers stay small too.
+static void writeSigned(std::vector<unsigned char>& out, long long value)
+{
+	writeVarint(out, ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+}
+
+// Reads encoded data, keeping track of whether it ran off the end (after which everything it reads is 0).
+struct SnapshotReader
+{
+	const unsigned char* data;
+	size_t size;
+	size_t offset;
+	bool failed;
+
+	SnapshotReader(const unsigned char* inData, size_t inSize)
+	{
+		data = inData;
+		size = inSize;
+		offset = 0;
+		failed = false;
+	}
+
+	unsigned long long ReadVarint()
+	{
+		unsigned long long value = 0;
+
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			if (offset >= size)
+			{
+				break;
+			}
+
+			unsigned char byte = data[offset++];
+			value |= (unsigned long long)(byte & 0x7F) << shift;
+
+			if ((byte & 0x80) == 0)
+			{
+				return value;
+			}
+		}
+
+		failed = true;
+		return 0;
+	}
+
+	long long ReadSigned()
+	{
+		unsigned long long value = ReadVarint();
+
+		return (long long)(value >> 1) ^ -(long long)(value & 1);
+	}
+
+	unsigned char ReadByte()
+	{
+		if (offset >= size)
+		{
+			failed = true;
+			return 0;
+		}
+
+		return data[offset++];
+	}
+};
+
+// Writes three values as their differences from base's.
+static void writeDifferences(std::vector<unsigned char>& out, const int* values, const int* base)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		writeSigned(out, (long long)values[i] - base[i]);
+	}
+}
+
+// And reads them back, failing if they come out bigger than a rounded value can be.
+static void readDifferences(SnapshotReader& reader, int* values, const int* base)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		long long difference = reader.ReadSigned();
+
+		// Two rounded values are never further apart than twice the biggest one. A difference that is (from a broken or made up packet)
+		// is turned away before it's added, since adding it could overflow.
+		if (difference < -2 * (long long)MAX_ROUNDED || difference > 2 * (long long)MAX_ROUNDED)
+		{
+			reader.failed = true;
+			values[i] = base[i];
+			continue;
+		}
+
+		long long value = base[i] + difference;
+
+		if (value < -(long long)MAX_ROUNDED || value > (long long)MAX_ROUNDED)
+		{
+			reader.failed = true;
+		}
+
+		values[i] = (int)value;
+	}
+}
+
+void StateSnapshot::Encode(std::vector<unsigned char>& out, const StateSnapshot* base) const
+{
+	static const int zero[3] = { 0, 0, 0 };
+
+	writeVarint(out, base != nullptr ? SNAPSHOT_DELTA : 0);
+	writeVarint(out, tick);
+
+	if (base != nullptr)
+	{
+		writeVarint(out, base->tick);
+	}
+
+	writeVarint(out, bodies.size());
+
+	// On its own, every object sends all of its values.
+	if (base == nullptr)
+	{
+		for (int i = 0; i < (int)bodies.size(); i++)
+		{
+			const SnapshotBody& body = bodies[i];
+
+			out.push_back((unsigned char)(body.largest << LARGEST_SHIFT | (body.asleep ? BODY_ASLEEP : 0)));
+			writeDifferences(out, body.position, zero);
+			writeDifferences(out, body.orientation, zero);
+			writeDifferences(out, body.velocity, zero);
+		}
+
+		return;
+	}
+
+	// As a delta, each object that changed is preceded by how many in a row didn't (which is usually 0 or a lot). The objects the base
+	// doesn't have are always sent, against nothing.
+	int baseCount = (int)base->bodies.size();
+	int unchanged = 0;
+
+	for (int i = 0; i < (int)bodies.size(); i++)
+	{
+		const SnapshotBody& body = bodies[i];
+		const SnapshotBody* old = i < baseCount ? &base->bodies[i] : nullptr;
+
+		if (old != nullptr && body == *old)
+		{
+			unchanged++;
+			continue;
+		}
+
+		writeVarint(out, unchanged);
+		unchanged = 0;
+
+		bool positionChanged = old == nullptr || memcmp(body.position, old->position, sizeof(body.position)) != 0;
+		bool orientationChanged = old == nullptr || body.largest != old->largest ||
+			memcmp(body.orientation, old->orientation, sizeof(body.orientation)) != 0;
+		bool velocityChanged = old == nullptr || memcmp(body.velocity, old->velocity, sizeof(body.velocity)) != 0;
+
+		out.push_back((unsigned char)(body.largest << LARGEST_SHIFT | (body.asleep ? BODY_ASLEEP : 0) |
+			(positionChanged ? CHANGED_POSITION : 0) | (orientationChanged ? CHANGED_ORIENTATION : 0) | (velocityChanged ? CHANGED_VELOCITY : 0)));
+
+		if (positionChanged)
+		{
+			writeDifferences(out, body.position, old != nullptr ? old->position : zero);
+		}
+
+		// When the left out component changes, the kept ones are different components altogether, so they're sent as they are.
+		if (orientationChanged)
+		{
+			writeDifferences(out, body.orientation, old != nullptr && body.largest == old->largest ? old->orientation : zero);
+		}
+
+		if (velocityChanged)
+		{
+			writeDifferences(out, body.velocity, old != nullptr ? old->velocity : zero);
+		}
+	}
+
+	if (unchanged > 0)
+	{
+		writeVarint(out, unchanged);
+	}
+}
+
+bool StateSnapshot::GetBaseTick(const unsigned char* data, size_t size, unsigned int& baseTick)
+{
+	SnapshotReader reader(data, size);
+
+	unsigned long long flags = reader.ReadVarint();
+	reader.ReadVarint();
+	baseTick = (unsigned int)reader.ReadVarint();
+
+	return !reader.failed && (flags & SNAPSHOT_DELTA) != 0;
+}
+
+bool StateSnapshot::Decode(const unsigned char* data, size_t size, const StateSnapshot* base)
+{
+	static const int zero[3] = { 0, 0, 0 };
+
+	SnapshotReader reader(data, size);
+
+	bool delta = (reader.ReadVarint() & SNAPSHOT_DELTA) != 0;
+	unsigned long long newTick = reader.ReadVarint();
+
+	if (delta && (base == nullptr || reader.ReadVarint() != base->tick))
+	{
+		return false;
+	}
+
+	// Every object takes at least a byte, apart from a delta's unchanged ones, which the base has to have. So a count bigger than that is
+	// corrupt, and we find out before making room for it.
+	unsigned long long count = reader.ReadVarint();
+	size_t baseCount = delta ? base->bodies.size() : 0;
+
+	if (reader.failed || newTick > 0xFFFFFFFFULL || count > baseCount + size)
+	{
+		return false;
+	}
+
+	std::vector<SnapshotBody> decoded((size_t)count);
+
+	for (size_t i = 0; i < decoded.size() && !reader.failed; i++)
+	{
+		const SnapshotBody* old = nullptr;
+
+		if (delta)
+		{
+			// Copy the unchanged ones over from the base. A run can't go past the end of the base, or the end of the snapshot.
+			unsigned long long unchanged = reader.ReadVarint();
+
+			if (unchanged > baseCount - glm::min(i, baseCount) || unchanged > decoded.size() - i)
+			{
+				return false;
+			}
+
+			for (unsigned long long u = 0; u < unchanged; u++, i++)
+			{
+				decoded[i] = base->bodies[i];
+			}
+
+			if (i == decoded.size())
+			{
+				break;
+			}
+
+			old = i < baseCount ? &base->bodies[i] : nullptr;
+		}
+
+		SnapshotBody& body = decoded[i];
+		unsigned char flags = reader.ReadByte();
+
+		body.largest = (unsigned char)(flags >> LARGEST_SHIFT & 3);
+		body.asleep = (flags & BODY_ASLEEP) != 0 ? 1 : 0;
+
+		// On its own every value is sent, and in a delta the ones that aren't sent are the same as the base's.
+		bool positionSent = !delta || (flags & CHANGED_POSITION) != 0;
+		bool orientationSent = !delta || (flags & CHANGED_ORIENTATION) != 0;
+		bool velocitySent = !delta || (flags & CHANGED_VELOCITY) != 0;
+
+		// An object the base doesn't have has nothing to be the same as.
+		if (delta && old == nullptr && !(positionSent && orientationSent && velocitySent))
+		{
+			return false;
+		}
+
+		if (positionSent)
+		{
+			readDifferences(reader, body.position, old != nullptr ? old->position : zero);
+		}
+		else
+		{
+			memcpy(body.position, old->position, sizeof(body.position));
+		}
+
+		if (orientationSent)
+		{
+			readDifferences(reader, body.orientation, old != nullptr && body.largest == old->largest ? old->orientation : zero);
+		}
+		else if (body.largest == old->largest)
+		{
+			memcpy(body.orientation, old->orientation, sizeof(body.orientation));
+		}
+		else
+		{
+			return false;
+		}
+
+		if (velocitySent)
+		{
+			readDifferences(reader, body.velocity, old != nullptr ? old->velocity : zero);
+		}
+		else
+		{
+			memcpy(body.velocity, old->velocity, sizeof(body.velocity));
+		}
+	}
+
+	if (reader.failed || reader.offset != size)
+	{
+		return false;
+	}
+
+	bodies.swap(decoded);
+	tick = (unsigned int)newTick;
+
+	return true;
+}
+
+#endif //_STATE_SNAPSHOT_CPP
@@ -0,0 +1,138 @@
+/*
+Title: GJK-3D (OBB)
+File Name: StateSnapshot.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _STATE_SNAPSHOT_H
+#define _STATE_SNAPSHOT_H
+
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include <vector>
+
+class PhysicsWorld;
+
+// How finely a StateSnapshot keeps each value. Whoever sends snapshots and whoever receives them have to use the same precision.
+struct SnapshotPrecision
+{
+	float positionStep;		// Positions are rounded to a multiple of this.
+	float velocityStep;		// And velocities to a multiple of this.
+	int orientationBits;	// How many bits (including the sign) each of the three orientation values that are kept gets, from 2 to 24.
+
+	// A millimeter (if a unit is a meter) for positions, a millimeter a second for velocities, and 12 bits for orientations, which is
+	// within about a twentieth of a degree.
+	SnapshotPrecision()
+	{
+		positionStep = 1.0f / 1024.0f;
+		velocityStep = 1.0f / 1024.0f;
+		orientationBits = 12;
+	}
+};
+
+// One object's state, rounded to whole steps.
+// The orientation is kept as the three components of the quaternion other than the largest one (largest says which that is), which is
+// flipped to be positive (q and -q are the same rotation): it's 1 minus the others squared, so it can be worked out again from them. The
+// three that are kept can only be from -1/sqrt(2) to 1/sqrt(2), so none of their bits go to waste.
+struct SnapshotBody
+{
+	int position[3];
+	int orientation[3];
+	int velocity[3];
+	unsigned char largest;
+	unsigned char asleep;
+
+	bool operator==(const SnapshotBody& other) const;
+	bool operator!=(const SnapshotBody& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+// The state of every object in a world (position, orientation, velocity and whether it's asleep), rounded off and packed small, for sending
+// over the network every tick.
+// A snapshot can be encoded on its own, or as a delta against an older snapshot that the receiver already has (typically the last one it
+// said it got). Both are a stream of variable-length integers: small numbers take a byte, and a delta is mostly small numbers. Objects
+// that haven't changed since the base cost next to nothing (a run of them is one number), which covers everything asleep, and an object
+// that has changed only sends the differences in the values that did. Full float state is 40 bytes an object; a snapshot is about 20, and
+// in a delta, an object moving along at a steady speed is about 5.
+// Since both ends hold exactly the same rounded values, a delta decodes to exactly the snapshot it was made from, and deltas can be stacked
+// on top of each other for as long as both ends agree on the base. The rounding only happens once, in Capture.
+class StateSnapshot
+{
+	std::vector<SnapshotBody> bodies;
+	unsigned int tick;
+
+public:
+	StateSnapshot();
+
+	// Rounds off the state of every object in the world, in object order, and remembers which tick it was taken on.
+	void Capture(PhysicsWorld& world, unsigned int atTick, const SnapshotPrecision& precision = SnapshotPrecision());
+
+	// Sets the state of the world's objects (the first NumBodies() of them, which the world has to have) to the snapshot's. An object the
+	// snapshot has awake is woken up if it isn't. One it has asleep is left to fall asleep on its own, stopped where the snapshot has it.
+	void Apply(PhysicsWorld& world, const SnapshotPrecision& precision = SnapshotPrecision()) const;
+
+	// Appends the snapshot to out: on its own if base is null, and as the difference from base otherwise. The receiver has to decode it
+	// against the same base (see GetBaseTick).
+	void Encode(std::vector<unsigned char>& out, const StateSnapshot* base = nullptr) const;
+
+	// Reads a snapshot that Encode wrote. A delta needs the base it was encoded against, and an error is returned if base is missing or is
+	// from the wrong tick, as well as if the data is cut short or doesn't make sense. On an error, the snapshot is left as it was.
+	bool Decode(const unsigned char* data, size_t size, const StateSnapshot* base = nullptr);
+
+	// The tick of the snapshot encoded data was made against, or false if it isn't a delta (or isn't a snapshot at all), so the receiver can
+	// find its base before decoding it.
+	static bool GetBaseTick(const unsigned char* data, size_t size, unsigned int& baseTick);
+
+	unsigned int GetTick() const
+	{
+		return tick;
+	}
+
+	int NumBodies() const
+	{
+		return (int)bodies.size();
+	}
+
+	const SnapshotBody& GetBody(int object) const
+	{
+		return bodies[object];
+	}
+
+	bool operator==(const StateSnapshot& other) const
+	{
+		return tick == other.tick && bodies == other.bodies;
+	}
+};
+
+#endif //_STATE_SNAPSHOT_H
@@ -0,0 +1,136 @@
+/*
+Title: GJK-3D (OBB)
+File Name: StepArena.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _STEP_ARENA_CPP
+#define _STEP_ARENA_CPP
+
+#include "StepArena.h"
+#include "MemoryTracker.h"
+#include <cstdint>
+
+StepArena::StepArena(size_t initialSize)
+{
+	used = 0;
+	allocated = 0;
+
+	addBlock(initialSize);
+}
+
+StepArena::~StepArena()
+{
+	for (int i = 0; i < (int)blocks.size(); i++)
+	{
+		TrackFree(MEMORY_ARENA, blocks[i].size);
+		FreePages(blocks[i].memory, blocks[i].size);
+	}
+}
+
+void StepArena::addBlock(size_t size)
+{
+	// A block big enough comes from huge pages, if they're turned on (see AllocatePages).
+	Block block;
+	block.memory = (char*)AllocatePages(size);
+	block.size = size;
+
+	TrackAllocation(MEMORY_ARENA, size);
+
+	blocks.push_back(block);
+	used = 0;
+}
+
+void* StepArena::Allocate(size_t size, size_t alignment)
+{
+	Block& block = blocks.back();
+
+	uintptr_t start = (uintptr_t)(block.memory + used);
+	uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+	if (aligned + size > (uintptr_t)(block.memory + block.size))
+	{
+		// This block is full, so start another, at least twice as big as the last so a growing step only needs a few.
+		size_t next = block.size * 2;
+
+		if (next < size + alignment)
+		{
+			next = size + alignment;
+		}
+
+		addBlock(next);
+
+		return Allocate(size, alignment);
+	}
+
+	used = (size_t)(aligned - (uintptr_t)block.memory) + size;
+	allocated += size;
+
+	return (void*)aligned;
+}
+
+void StepArena::Reset()
+{
+	// Having needed more than one block means the steps need more than the first one holds, so swap them all for one that holds the lot.
+	if (blocks.size() > 1)
+	{
+		size_t capacity = GetCapacity();
+
+		for (int i = 0; i < (int)blocks.size(); i++)
+		{
+			TrackFree(MEMORY_ARENA, blocks[i].size);
+			FreePages(blocks[i].memory, blocks[i].size);
+		}
+
+		blocks.clear();
+
+		addBlock(capacity);
+	}
+
+	used = 0;
+	allocated = 0;
+}
+
+size_t StepArena::GetCapacity() const
+{
+	size_t capacity = 0;
+
+	for (int i = 0; i < (int)blocks.size(); i++)
+	{
+		capacity += blocks[i].size;
+	}
+
+	return capacity;
+}
+
+#endif //_STEP_ARENA_CPP
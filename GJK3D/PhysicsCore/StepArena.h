@@ -0,0 +1,99 @@
+/*
+Title: GJK-3D (OBB)
+File Name: StepArena.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _STEP_ARENA_H
+#define _STEP_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// A linear ("bump") allocator, for memory that only has to last a short, known time, like one physics step.
+// Allocating just moves a pointer along a block of memory. Nothing is given back on its own: Reset lets go of everything at once. The blocks
+// are kept, so once the arena has grown big enough for a step, the steps after it don't touch the heap at all. If a step needs more than the
+// arena has, it gets another block, and the next Reset swaps them all for a single block big enough for the lot.
+// Nothing's destructor is ever called, so it's only for plain data. It isn't thread-safe either: each thread has its own (see
+// JobSystem::GetArena).
+class StepArena
+{
+	struct Block
+	{
+		char* memory;
+		size_t size;
+	};
+
+	std::vector<Block> blocks;
+
+	// How far into the last block we are, and how much has been handed out since the last Reset.
+	size_t used;
+	size_t allocated;
+
+	void addBlock(size_t size);
+
+	// The arena owns its blocks, so it can't be copied.
+	StepArena(const StepArena&);
+	StepArena& operator=(const StepArena&);
+
+public:
+	StepArena(size_t initialSize = 64 * 1024);
+	~StepArena();
+
+	// Returns size bytes, aligned to alignment (which has to be a power of 2), that stay valid until the next Reset.
+	void* Allocate(size_t size, size_t alignment = 16);
+
+	// Room for count Ts. They aren't constructed, so T should be plain data.
+	template<typename T>
+	T* Allocate(int count)
+	{
+		// Visual Studio before 2015 only has alignof as its own __alignof.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+		return (T*)Allocate(sizeof(T) * count, __alignof(T));
+#else
+		return (T*)Allocate(sizeof(T) * count, alignof(T));
+#endif
+	}
+
+	// Lets go of everything allocated so far.
+	void Reset();
+
+	// How much has been handed out since the last Reset, and how much memory the arena is holding on to.
+	size_t GetAllocated() const
+	{
+		return allocated;
+	}
+	size_t GetCapacity() const;
+};
+
+#endif //_STEP_ARENA_H
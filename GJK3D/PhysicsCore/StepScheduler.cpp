@@ -0,0 +1,122 @@
+/*
+Title: GJK-3D (OBB)
+File Name: StepScheduler.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _STEP_SCHEDULER_CPP
+#define _STEP_SCHEDULER_CPP
+
+#include "StepScheduler.h"
+
+StepScheduler::StepScheduler(double inStep, Clock* inClock)
+{
+	clock = inClock;
+	step = inStep;
+
+	maxFrameTime = 0.25;
+
+	// By default a round can spend up to 4 steps' worth of real time running at most 20 steps (which is what a 0.25 second frame
+	// would need at the default step).
+	budget = inStep * 4.0;
+	maxSteps = 20;
+
+	accumulator = 0.0;
+	lastTime = 0.0;
+	started = false;
+}
+
+int StepScheduler::stepsInBudget() const
+{
+	// Until we know how long a step takes, all we have to go on is the cap.
+	if (counters.averageStepCost <= 0.0)
+	{
+		return maxSteps;
+	}
+
+	int fit = (int)(budget / counters.averageStepCost);
+
+	// Always run at least one, or the simulation would stop altogether.
+	if (fit < 1)
+	{
+		fit = 1;
+	}
+
+	return fit < maxSteps ? fit : maxSteps;
+}
+
+void StepScheduler::recordStepCost(double cost)
+{
+	// The average is shared with the counters, so it has to be changed under the lock too.
+	std::lock_guard<std::mutex> lock(countersMutex);
+
+	// An exponential moving average, so one slow step doesn't count for much but a run of them soon does.
+	if (counters.averageStepCost <= 0.0)
+	{
+		counters.averageStepCost = cost;
+	}
+	else
+	{
+		counters.averageStepCost = counters.averageStepCost * 0.9 + cost * 0.1;
+	}
+}
+
+void StepScheduler::finishRound(int steps, int dropped, bool outOfBudget)
+{
+	std::lock_guard<std::mutex> lock(countersMutex);
+
+	counters.totalSteps += steps;
+	counters.droppedSteps += dropped;
+	counters.lastSteps = steps;
+
+	if (counters.degraded)
+	{
+		counters.degradedSteps += steps;
+	}
+
+	if (outOfBudget)
+	{
+		counters.budgetHits++;
+
+		// Falling behind, so cut back on the extra work.
+		counters.degraded = true;
+	}
+	else if (counters.averageStepCost < step * 0.5)
+	{
+		// Steps are back to taking well under the time they simulate, so there's room for everything again. (The gap between this and
+		// running out of budget stops it from flipping back and forth every round.)
+		counters.degraded = false;
+	}
+}
+
+#endif // _STEP_SCHEDULER_CPP
@@ -0,0 +1,234 @@
+/*
+Title: GJK-3D (OBB)
+File Name: StepScheduler.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _STEP_SCHEDULER_H
+#define _STEP_SCHEDULER_H
+
+#include "Clock.h"
+#include <mutex>
+
+// What the scheduler has been up to, for keeping an eye on how the physics is keeping up.
+struct StepCounters
+{
+	int totalSteps;			// Every step run so far.
+	int droppedSteps;		// Steps' worth of time that were thrown away instead of being run, because running them would have taken too long.
+	int budgetHits;			// How many rounds ran out of budget before they caught up.
+	int degradedSteps;		// How many steps ran in degraded mode.
+	int lastSteps;			// How many steps the last round ran.
+	double averageStepCost;	// How long a step takes, in seconds (averaged over the last several).
+	bool degraded;			// Whether the physics is in degraded mode right now.
+
+	StepCounters()
+	{
+		totalSteps = 0;
+		droppedSteps = 0;
+		budgetHits = 0;
+		degradedSteps = 0;
+		lastSteps = 0;
+		averageStepCost = 0.0;
+		degraded = false;
+	}
+};
+
+// Decides how many fixed-length physics steps to run each time around the loop.
+// The usual accumulator loop runs however many steps it takes to catch up. If a step takes longer to run than the time it simulates, that
+// makes the next frame longer, so it has even more to catch up on, and so on, until the program spends all its time on physics (the "spiral
+// of death"). Even short of that, one slow frame makes the next one slower.
+// So this keeps track of how long each step takes to run, and each round only runs as many steps as fit in a time budget. Whatever doesn't
+// fit is thrown away: the simulation falls behind real time for a moment instead of dragging the frame rate down with it. While it's
+// running out of budget it also goes into degraded mode, which the step can check to skip work that isn't strictly needed. It comes back out
+// once steps are cheap enough again.
+class StepScheduler
+{
+	// The clock to measure with.
+	Clock* clock;
+
+	double step;
+	double maxFrameTime;
+	double budget;
+	int maxSteps;
+
+	double accumulator;
+	double lastTime;
+	bool started;
+
+	StepCounters counters;
+
+	// Guards counters, which another thread may be reading.
+	mutable std::mutex countersMutex;
+
+	// How many steps the budget has room for this round.
+	int stepsInBudget() const;
+
+	// Updates the counters at the end of a round that ran steps steps (and dropped dropped), having used up its budget or not.
+	void finishRound(int steps, int dropped, bool outOfBudget);
+
+	// Adds how long one step took to the average.
+	void recordStepCost(double cost);
+
+public:
+	// step is the length of a physics step, and clock is what to time everything with. The clock isn't copied, so it has to outlive the scheduler.
+	StepScheduler(double inStep, Clock* inClock);
+
+	// Starts timing from now. Advance does this itself the first time it's called (so that first call never runs any steps), but calling
+	// it up front means the first Advance already counts the time since.
+	void Start()
+	{
+		lastTime = clock->Now();
+		started = true;
+	}
+
+	// Switches to a different clock. The time from the old clock that hasn't been stepped yet carries over, but nothing that happened in between.
+	void SetClock(Clock* inClock)
+	{
+		clock = inClock;
+		started = false;
+	}
+
+	// No round takes in more than this much time (in seconds) even if more than that has passed, like when the window is being dragged. This
+	// was always 0.25.
+	void SetMaxFrameTime(double seconds)
+	{
+		maxFrameTime = seconds;
+	}
+
+	// How much time (in seconds) a round can spend running steps, and the most steps it can run no matter how cheap they are.
+	void SetBudget(double seconds, int inMaxSteps)
+	{
+		budget = seconds;
+		maxSteps = inMaxSteps;
+	}
+
+	double GetStep() const
+	{
+		return step;
+	}
+
+	// The time that's passed but hasn't been stepped yet (always less than one step).
+	double GetAccumulator() const
+	{
+		return accumulator;
+	}
+
+	// How far along we are towards the next step, from 0 to 1, for blending between the last two steps.
+	double GetAlpha() const
+	{
+		return accumulator / step;
+	}
+
+	// When the last round started, on the scheduler's clock.
+	double GetLastTime() const
+	{
+		return lastTime;
+	}
+
+	// Whether to cut back on work. This is for the step to check, on the thread that calls Advance (GetCounters is for anywhere else).
+	bool IsDegraded() const
+	{
+		return counters.degraded;
+	}
+
+	// A copy of the counters. This is safe to call from any thread.
+	StepCounters GetCounters() const
+	{
+		std::lock_guard<std::mutex> lock(countersMutex);
+
+		return counters;
+	}
+
+	// Adds the time since the last call to the accumulator, then runs update(float dt) once per whole step in it, as far as the budget
+	// allows. Returns how many steps were run.
+	template<typename StepFunction>
+	int Advance(StepFunction& update);
+};
+
+template<typename StepFunction>
+int StepScheduler::Advance(StepFunction& update)
+{
+	double now = clock->Now();
+
+	if (!started)
+	{
+		Start();
+	}
+
+	double frameTime = now - lastTime;
+	lastTime = now;
+
+	// Limit the time so that we if we experience any sort of delay in processing power or the window is resizing/moving or anything, it doesn't update a bunch of times while the player can't see.
+	if (frameTime > maxFrameTime)
+	{
+		frameTime = maxFrameTime;
+	}
+
+	accumulator += frameTime;
+
+	int allowed = stepsInBudget();
+	int steps = 0;
+	int dropped = 0;
+	bool outOfBudget = false;
+
+	while (accumulator >= step)
+	{
+		// Out of budget: throw away the whole steps that are left (but keep the fraction, so the blend between steps carries on smoothly).
+		if (steps >= allowed || clock->Now() - now > budget)
+		{
+			while (accumulator >= step)
+			{
+				accumulator -= step;
+				dropped++;
+			}
+
+			outOfBudget = true;
+			break;
+		}
+
+		double before = clock->Now();
+
+		update((float)step);
+
+		recordStepCost(clock->Now() - before);
+
+		accumulator -= step;
+		steps++;
+	}
+
+	finishRound(steps, dropped, outOfBudget);
+
+	return steps;
+}
+
+#endif //_STEP_SCHEDULER_H
@@ -0,0 +1,330 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SweepAndPrune.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SWEEP_AND_PRUNE_CPP
+#define _SWEEP_AND_PRUNE_CPP
+
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+SweepAndPrune::SweepAndPrune(float inMargin)
+{
+	freeList = -1;
+	proxyCount = 0;
+
+	margin = inMargin;
+	displacementMultiplier = 2.0f;
+
+	swaps = 0;
+}
+
+int SweepAndPrune::CreateProxy(const AABB& bounds, int userData)
+{
+	int proxy;
+
+	if (freeList != -1)
+	{
+		proxy = freeList;
+		freeList = proxies[proxy].next;
+	}
+	else
+	{
+		proxies.push_back(SAPProxy());
+		proxy = (int)proxies.size() - 1;
+	}
+
+	proxies[proxy].bounds = AABB(bounds.min - glm::vec3(margin), bounds.max + glm::vec3(margin));
+	proxies[proxy].userData = userData;
+	proxies[proxy].next = -1;
+	proxies[proxy].activeIndex = -1;
+
+	// The new endpoints go on the end of each list, and the next sort moves them to where they belong.
+	for (int axis = 0; axis < 3; axis++)
+	{
+		SAPEndpoint endpoint;
+		endpoint.proxy = proxy;
+
+		endpoint.value = proxies[proxy].bounds.min[axis];
+		endpoint.isMax = false;
+		endpoints[axis].push_back(endpoint);
+
+		endpoint.value = proxies[proxy].bounds.max[axis];
+		endpoint.isMax = true;
+		endpoints[axis].push_back(endpoint);
+	}
+
+	proxyCount++;
+
+	return proxy;
+}
+
+// Matches the endpoints that belong to one proxy, for removing them.
+struct EndpointOfProxy
+{
+	int proxy;
+
+	bool operator()(const SAPEndpoint& endpoint) const
+	{
+		return endpoint.proxy == proxy;
+	}
+};
+
+void SweepAndPrune::Reserve(int numProxies, int numPairs, int threads)
+{
+	Broadphase::Reserve(numProxies, numPairs, threads);
+
+	proxies.reserve(numProxies);
+
+	// Every proxy has a min and a max on each axis.
+	for (int axis = 0; axis < 3; axis++)
+	{
+		endpoints[axis].reserve(2 * numProxies);
+	}
+
+	active.reserve(numProxies);
+}
+
+void SweepAndPrune::DestroyProxy(int proxy)
+{
+	EndpointOfProxy match;
+	match.proxy = proxy;
+
+	// Removing keeps the rest of each list in order, so it stays sorted.
+	for (int axis = 0; axis < 3; axis++)
+	{
+		endpoints[axis].erase(std::remove_if(endpoints[axis].begin(), endpoints[axis].end(), match), endpoints[axis].end());
+	}
+
+	proxies[proxy].userData = -1;
+	proxies[proxy].next = freeList;
+	freeList = proxy;
+
+	proxyCount--;
+}
+
+bool SweepAndPrune::MoveProxy(int proxy, const AABB& bounds, const glm::vec3& displacement)
+{
+	if (proxies[proxy].bounds.Contains(bounds))
+	{
+		return false;
+	}
+
+	AABB fat = MakeFatBounds(bounds, margin, displacement, displacementMultiplier);
+
+	// Only the bounds change here. The endpoints pick up the new values (and get re-sorted) in the next FindPairs.
+	proxies[proxy].bounds = fat;
+
+	return true;
+}
+
+void SweepAndPrune::ShiftOrigin(const glm::vec3& origin)
+{
+	// The endpoints pick up the new values in the next FindPairs, the same as after MoveProxy. Taking the same off every one of them keeps
+	// them in the same order, so the sort has nothing to do.
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		proxies[i].bounds.min -= origin;
+		proxies[i].bounds.max -= origin;
+	}
+}
+
+// Whether endpoint a goes before endpoint b. If they're at the same spot a min goes before a max, so that bounds which just touch count as
+// overlapping (the same as AABB::Overlaps).
+static bool endpointBefore(const SAPEndpoint& a, const SAPEndpoint& b)
+{
+	return a.value < b.value || (a.value == b.value && !a.isMax && b.isMax);
+}
+
+void SweepAndPrune::sortAxis(int axis)
+{
+	TrackedVector<SAPEndpoint, MEMORY_BROADPHASE>& list = endpoints[axis];
+
+	for (int i = 0; i < (int)list.size(); i++)
+	{
+		const AABB& bounds = proxies[list[i].proxy].bounds;
+
+		list[i].value = list[i].isMax ? bounds.max[axis] : bounds.min[axis];
+	}
+
+	// Insertion sort. Each endpoint only moves past the ones that it passed (or that passed it) since the last sort, which is usually none.
+	for (int i = 1; i < (int)list.size(); i++)
+	{
+		SAPEndpoint endpoint = list[i];
+		int j = i - 1;
+
+		while (j >= 0 && endpointBefore(endpoint, list[j]))
+		{
+			list[j + 1] = list[j];
+			j--;
+			swaps++;
+		}
+
+		list[j + 1] = endpoint;
+	}
+}
+
+int SweepAndPrune::chooseAxis() const
+{
+	glm::vec3 sum(0.0f);
+	glm::vec3 sumSquared(0.0f);
+	int count = 0;
+
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		if (proxies[i].userData == -1)
+		{
+			continue;
+		}
+
+		glm::vec3 center = (proxies[i].bounds.min + proxies[i].bounds.max) * 0.5f;
+
+		sum += center;
+		sumSquared += center * center;
+		count++;
+	}
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	// The variance of the centers on each axis. (We only compare them, so there's no need to divide by the count twice.)
+	glm::vec3 variance = sumSquared - sum * sum / (float)count;
+
+	if (variance.x >= variance.y && variance.x >= variance.z)
+	{
+		return 0;
+	}
+
+	return variance.y >= variance.z ? 1 : 2;
+}
+
+void SweepAndPrune::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+	pairs.clear();
+	swaps = 0;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		sortAxis(axis);
+	}
+
+	int axis = chooseAxis();
+	TrackedVector<SAPEndpoint, MEMORY_BROADPHASE>& list = endpoints[axis];
+
+	active.clear();
+
+	for (int i = 0; i < (int)list.size(); i++)
+	{
+		int proxy = list[i].proxy;
+
+		if (list[i].isMax)
+		{
+			// Take the proxy out of the active list by moving the last one into its place.
+			int index = proxies[proxy].activeIndex;
+			int last = active.back();
+
+			active[index] = last;
+			proxies[last].activeIndex = index;
+			active.pop_back();
+
+			proxies[proxy].activeIndex = -1;
+		}
+		else
+		{
+			// Everything already open overlaps this proxy on the sweep axis, so we only need to check the other two.
+			const AABB& bounds = proxies[proxy].bounds;
+
+			for (int j = 0; j < (int)active.size(); j++)
+			{
+				if (bounds.Overlaps(proxies[active[j]].bounds) && CanPair(proxies[proxy].userData, proxies[active[j]].userData))
+				{
+					pairs.push_back(BroadphasePair(proxies[proxy].userData, proxies[active[j]].userData));
+				}
+			}
+
+			proxies[proxy].activeIndex = (int)active.size();
+			active.push_back(proxy);
+		}
+	}
+
+	// Sort them, so the narrowphase always sees the pairs in the same order as with any other broadphase.
+	SortPairs(pairs, sortScratch);
+
+	comparePairs(pairs);
+}
+
+void SweepAndPrune::Cull(const Frustum& frustum, std::vector<int>& visible) const
+{
+	visible.clear();
+
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		// Skip the proxies on the free list.
+		if (proxies[i].userData == -1)
+		{
+			continue;
+		}
+
+		if (frustum.Overlaps(proxies[i].bounds))
+		{
+			visible.push_back(proxies[i].userData);
+		}
+	}
+}
+
+void SweepAndPrune::CastSegment(const glm::vec3& from, const glm::vec3& to, const glm::vec3& extents, std::vector<int>& hits) const
+{
+	hits.clear();
+
+	glm::vec3 delta = to - from;
+
+	for (int i = 0; i < (int)proxies.size(); i++)
+	{
+		// Skip the proxies on the free list.
+		if (proxies[i].userData == -1)
+		{
+			continue;
+		}
+
+		if (proxies[i].bounds.SegmentOverlaps(from, delta, extents))
+		{
+			hits.push_back(proxies[i].userData);
+		}
+	}
+}
+
+#endif //_SWEEP_AND_PRUNE_CPP
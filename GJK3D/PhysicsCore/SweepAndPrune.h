@@ -0,0 +1,134 @@
+/*
+Title: GJK-3D (OBB)
+File Name: SweepAndPrune.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _SWEEP_AND_PRUNE_H
+#define _SWEEP_AND_PRUNE_H
+
+#include "Broadphase.h"
+#include "MemoryTracker.h"
+
+// One end (the min or the max) of a proxy's bounds along one axis.
+struct SAPEndpoint
+{
+	float value;
+	int proxy;
+	bool isMax;
+};
+
+struct SAPProxy
+{
+	AABB bounds;		// The fat bounds.
+	int userData;
+	int next;			// The next free proxy, while this one is on the free list.
+	int activeIndex;	// Where this proxy is in the active list during a sweep.
+};
+
+// A sweep-and-prune broadphase.
+// For each axis we keep a list of every proxy's min and max along it, sorted. Sweeping along one of those lists, a proxy is "open" from its
+// min to its max, and any two proxies that are open at the same time overlap on that axis. Only those pairs need checking on the other two.
+// Objects only move a little each step, so the lists are almost sorted already and insertion sort puts them back in order in close to linear
+// time. This is what makes sweep-and-prune so cheap for coherent scenes (and so expensive when everything teleports).
+// All three axes are kept sorted, so each step we can sweep along whichever one the objects are most spread out on.
+class SweepAndPrune : public Broadphase
+{
+	// Saves and loads the arrays straight from a file (see WorldSnapshot).
+	friend class WorldSnapshot;
+
+	TrackedVector<SAPProxy, MEMORY_BROADPHASE> proxies;
+	int freeList;
+	int proxyCount;
+
+	TrackedVector<SAPEndpoint, MEMORY_BROADPHASE> endpoints[3];
+
+	// The proxies that are open at the current point of the sweep.
+	std::vector<int> active;
+
+	float margin;
+	float displacementMultiplier;
+
+	// How many swaps the insertion sorts took in the last FindPairs. Useful for seeing how coherent a scene actually is.
+	int swaps;
+
+	// Refreshes the endpoint values on an axis from the proxies' bounds, and insertion sorts it.
+	void sortAxis(int axis);
+
+	// Picks the axis the proxies' centers are most spread out along, since that axis has the fewest proxies open at once.
+	int chooseAxis() const;
+
+public:
+	SweepAndPrune(float inMargin = 0.05f);
+
+	int CreateProxy(const AABB& bounds, int userData);
+
+	void DestroyProxy(int proxy);
+
+	bool MoveProxy(int proxy, const AABB& bounds, const glm::vec3& displacement);
+
+	void ShiftOrigin(const glm::vec3& origin);
+
+	const AABB& GetFatBounds(int proxy) const
+	{
+		return proxies[proxy].bounds;
+	}
+
+	int GetUserData(int proxy) const
+	{
+		return proxies[proxy].userData;
+	}
+
+	// Sorts all three axes, then sweeps along the best one.
+	void FindPairs(std::vector<BroadphasePair>& pairs);
+
+	void Reserve(int numProxies, int numPairs, int threads);
+
+	// There's no hierarchy here, so this just tests every proxy.
+	void Cull(const Frustum& frustum, std::vector<int>& visible) const;
+
+	// Tests every proxy too.
+	void CastSegment(const glm::vec3& from, const glm::vec3& to, const glm::vec3& extents, std::vector<int>& hits) const;
+
+	const char* GetName() const
+	{
+		return "Sweep and prune";
+	}
+
+	int GetSwaps() const
+	{
+		return swaps;
+	}
+};
+
+#endif //_SWEEP_AND_PRUNE_H
@@ -0,0 +1,79 @@
+/*
+Title: GJK-3D (OBB)
+File Name: TimeOfImpact.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _TIME_OF_IMPACT_CPP
+#define _TIME_OF_IMPACT_CPP
+
+#include "TimeOfImpact.h"
+
+glm::quat spinOver(const ShapeMotion& motion, float time)
+{
+	float speed = glm::length(motion.angularVelocity);
+
+	if (speed <= 0.0f)
+	{
+		return glm::quat();
+	}
+
+	return glm::angleAxis(speed * time, motion.angularVelocity / speed);
+}
+
+OBBShape moveShape(const OBBShape& shape, const ShapeMotion& motion, float time)
+{
+	OBBShape moved = shape;
+	moved.center += motion.linearVelocity * time;
+
+	// Most of the time nothing is spinning, and the axes stay as they are.
+	if (motion.angularVelocity != glm::vec3(0.0f))
+	{
+		glm::quat spin = spinOver(motion, time);
+
+		for (int i = 0; i < 3; i++)
+		{
+			moved.axes[i] = spin * shape.axes[i];
+		}
+	}
+
+	return moved;
+}
+
+SphereShape moveShape(const SphereShape& shape, const ShapeMotion& motion, float time)
+{
+	// Spinning doesn't change a sphere.
+	return SphereShape(shape.center + motion.linearVelocity * time, shape.radius);
+}
+
+#endif // _TIME_OF_IMPACT_CPP
@@ -0,0 +1,292 @@
+/*
+Title: GJK-3D (OBB)
+File Name: TimeOfImpact.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _TIME_OF_IMPACT_H
+#define _TIME_OF_IMPACT_H
+
+#include "GJKDistance.h"
+#include "Shapes.h"
+#include "glm\gtc\quaternion.hpp"
+
+// How a shape moves over the time we're checking: in a straight line at linearVelocity, while spinning about its center at angularVelocity
+// (radians per second, around the axis it points along). radius is how far the shape reaches from that center, which bounds how fast any point
+// on it can move because of the spin.
+struct ShapeMotion
+{
+	glm::vec3 linearVelocity;
+	glm::vec3 angularVelocity;
+	float radius;
+
+	ShapeMotion()
+	{
+		linearVelocity = glm::vec3(0.0f);
+		angularVelocity = glm::vec3(0.0f);
+		radius = 0.0f;
+	}
+
+	ShapeMotion(const glm::vec3& linear, const glm::vec3& angular, float r)
+	{
+		linearVelocity = linear;
+		angularVelocity = angular;
+		radius = r;
+	}
+};
+
+// How a time of impact query ended.
+enum TimeOfImpactState
+{
+	TOI_SEPARATED,		// The shapes don't touch before the end of the time given.
+	TOI_HIT,			// They touch at time (to within the tolerance).
+	TOI_OVERLAPPING,	// They already overlap at the start, so there's no time of impact to find (that's a job for GJK and EPA).
+	TOI_ITERATION_CAP	// We ran out of iterations. Nothing touches before time, so it's still safe to treat it as a hit there.
+};
+
+// The answer to a time of impact query. normal points from A to B, and point is halfway between the closest points on the two shapes, both
+// at the time they touch.
+struct TimeOfImpactResult
+{
+	TimeOfImpactState state;
+	float time;
+	glm::vec3 normal;
+	glm::vec3 point;
+	int iterations;
+
+	TimeOfImpactResult()
+	{
+		state = TOI_SEPARATED;
+		time = 0.0f;
+		normal = glm::vec3(0.0f);
+		point = glm::vec3(0.0f);
+		iterations = 0;
+	}
+};
+
+// Where a shape is time seconds into its motion. Each shape the query should work with needs an overload of this.
+OBBShape moveShape(const OBBShape& shape, const ShapeMotion& motion, float time);
+SphereShape moveShape(const SphereShape& shape, const ShapeMotion& motion, float time);
+
+// The rotation a shape has made time seconds into its motion.
+glm::quat spinOver(const ShapeMotion& motion, float time);
+
+// The convex hull of a shape where it starts and where it ends up, grown by margin: everywhere a shape moving in a straight line passes
+// through on the way. Its support point is whichever of the two poses reaches farther along dir, pushed out by the margin, so one TestGJK
+// against it says whether the shape could have hit anything over the whole motion.
+template<typename Shape>
+struct SweptShape
+{
+	Shape start;
+	Shape end;
+	float margin;
+
+	SweptShape()
+	{
+		margin = 0.0f;
+	}
+
+	SweptShape(const Shape& s, const Shape& e, float m)
+	{
+		start = s;
+		end = e;
+		margin = m;
+	}
+};
+
+template<typename Shape>
+inline glm::vec3 getFarthestPointInDirection(const SweptShape<Shape>& obj, const glm::vec3& dir)
+{
+	glm::vec3 start = getFarthestPointInDirection(obj.start, dir);
+	glm::vec3 end = getFarthestPointInDirection(obj.end, dir);
+
+	return (glm::dot(start, dir) >= glm::dot(end, dir) ? start : end) + safeNormalize(dir) * obj.margin;
+}
+
+// Sweeps shape over time seconds of its motion. A spinning shape doesn't stay inside the hull of its two poses (its corners swing out on an
+// arc), so margin gets the most they can swing out by added to it: r * angle^2 / 8 for an arc of angle radians, and never more than the
+// shape's diameter.
+template<typename Shape>
+inline SweptShape<Shape> sweepShape(const Shape& shape, const ShapeMotion& motion, float time, float margin = 0.0f)
+{
+	float angle = glm::length(motion.angularVelocity) * time;
+
+	return SweptShape<Shape>(shape, moveShape(shape, motion, time), margin + motion.radius * glm::min(angle * angle * 0.125f, 2.0f));
+}
+
+// Finds when two moving shapes first touch, by conservative advancement.
+// GJK's distance query tells us how far apart the shapes are, d, and along which normal. Neither shape can close that gap along the normal
+// faster than their relative speed along it, plus the most the spin can move any point (|angular velocity| * radius for each). So we can move
+// both shapes forward by d divided by that speed and know they still haven't touched. Repeat that until the gap is within the tolerance, and
+// that's the time of impact. Each step only ever moves forward by a time that's safe, so we can't skip past a contact the way stepping the
+// objects by a fixed dt and testing where they end up can.
+class TimeOfImpactSolver
+{
+	GJKDistanceSolver distance;
+	GJKSolver overlap;
+
+	int maxIterations;
+	float tolerance;
+
+public:
+	TimeOfImpactSolver()
+	{
+		maxIterations = 32;
+		tolerance = 1e-3f;
+	}
+
+	void SetMaxIterations(int max)
+	{
+		maxIterations = max;
+	}
+	int GetMaxIterations()
+	{
+		return maxIterations;
+	}
+
+	// How close the shapes have to get to count as touching. Conservative advancement only ever gets closer to the contact without reaching
+	// it, so this can't be 0.
+	void SetTolerance(float t)
+	{
+		tolerance = t;
+	}
+	float GetTolerance()
+	{
+		return tolerance;
+	}
+
+	// Finds when a and b, moving as given, first come within the tolerance of each other, between now and maxTime seconds from now.
+	// Returns true if they do (a hit, or running out of iterations), with the details in result.
+	template<typename ShapeA, typename ShapeB>
+	bool TimeOfImpact(const ShapeA& a, const ShapeMotion& motionA, const ShapeB& b, const ShapeMotion& motionB, float maxTime,
+		TimeOfImpactResult& result);
+
+	// A cheap check to run before TimeOfImpact: a single boolean GJK test of a, swept over maxTime, against b where it starts. Most fast
+	// pairs never come near each other, and this rules them out without any of conservative advancement's distance queries. Returns false
+	// only if the shapes never come within the tolerance of each other, so there's no hit for TimeOfImpact to find.
+	// The sweep is of a's motion relative to b's, so only a's spin is in the hull. b's spin can move its points by a chord of at most
+	// 2 * radius * sin(angle / 2) towards a, so that (and the tolerance) goes in the margin instead.
+	template<typename ShapeA, typename ShapeB>
+	bool MightHit(const ShapeA& a, const ShapeMotion& motionA, const ShapeB& b, const ShapeMotion& motionB, float maxTime);
+};
+
+template<typename ShapeA, typename ShapeB>
+bool TimeOfImpactSolver::TimeOfImpact(const ShapeA& a, const ShapeMotion& motionA, const ShapeB& b, const ShapeMotion& motionB, float maxTime,
+	TimeOfImpactResult& result)
+{
+	result = TimeOfImpactResult();
+
+	// The most the spin can add to how fast the shapes close on each other, whichever way the normal points.
+	float spinSpeed = glm::length(motionA.angularVelocity) * motionA.radius + glm::length(motionB.angularVelocity) * motionB.radius;
+	glm::vec3 relativeVelocity = motionA.linearVelocity - motionB.linearVelocity;
+
+	// Each distance query starts from the normal the last one found, which is rarely far off since the shapes have only moved a little.
+	GJKCache cache;
+	GJKDistanceResult gap;
+
+	float time = 0.0f;
+
+	while (result.iterations < maxIterations)
+	{
+		result.iterations++;
+
+		ShapeA movedA = moveShape(a, motionA, time);
+		ShapeB movedB = moveShape(b, motionB, time);
+
+		distance.Distance(movedA, movedB, gap, &cache);
+
+		if (gap.overlapping)
+		{
+			// Only the first query can find them overlapping, since each step stops short of the contact. If a later one does, it's down to
+			// rounding right at the contact, and the last normal we had is still the right one.
+			result.state = (result.iterations == 1) ? TOI_OVERLAPPING : TOI_HIT;
+			result.time = time;
+
+			return result.state == TOI_HIT;
+		}
+
+		result.normal = gap.normal;
+		result.point = (gap.pointA + gap.pointB) * 0.5f;
+
+		if (gap.distance <= tolerance)
+		{
+			result.state = TOI_HIT;
+			result.time = time;
+
+			return true;
+		}
+
+		// The fastest the gap can be shrinking. If it can't shrink at all, they'll never touch.
+		float closingSpeed = glm::dot(relativeVelocity, gap.normal) + spinSpeed;
+
+		if (closingSpeed <= 0.0f)
+		{
+			return false;
+		}
+
+		// Stop half the tolerance short, so the next query comes out just within it rather than just outside.
+		time += (gap.distance - tolerance * 0.5f) / closingSpeed;
+
+		if (time > maxTime)
+		{
+			return false;
+		}
+	}
+
+	// We haven't touched anything up to time, so stopping there is still safe.
+	result.state = TOI_ITERATION_CAP;
+	result.time = time;
+
+	return true;
+}
+
+template<typename ShapeA, typename ShapeB>
+bool TimeOfImpactSolver::MightHit(const ShapeA& a, const ShapeMotion& motionA, const ShapeB& b, const ShapeMotion& motionB, float maxTime)
+{
+	ShapeMotion relative(motionA.linearVelocity - motionB.linearVelocity, motionA.angularVelocity, motionA.radius);
+	float spinB = glm::length(motionB.angularVelocity) * maxTime;
+
+	return overlap.TestGJK(sweepShape(a, relative, maxTime, tolerance + motionB.radius * glm::min(spinB, 2.0f)), b);
+}
+
+// Convenience wrapper that runs a single time of impact query with its own solver on the stack.
+template<typename ShapeA, typename ShapeB>
+inline bool TimeOfImpact(const ShapeA& a, const ShapeMotion& motionA, const ShapeB& b, const ShapeMotion& motionB, float maxTime,
+	TimeOfImpactResult& result)
+{
+	TimeOfImpactSolver solver;
+
+	return solver.TimeOfImpact(a, motionA, b, motionB, maxTime, result);
+}
+
+#endif //_TIME_OF_IMPACT_H
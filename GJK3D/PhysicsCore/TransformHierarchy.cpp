@@ -0,0 +1,220 @@
+/*
+Title: GJK-3D (OBB)
+File Name: TransformHierarchy.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _TRANSFORM_HIERARCHY_CPP
+#define _TRANSFORM_HIERARCHY_CPP
+
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+
+// The fewest nodes of one level that get split across the threads, and how many go in each job. A level smaller than this is quicker to do on
+// one thread than to hand out.
+static const int HIERARCHY_GRAIN = 512;
+
+TransformHierarchy::TransformHierarchy()
+{
+	unsorted = false;
+	levelStarts.push_back(0);
+}
+
+TransformNode TransformHierarchy::Add(TransformNode parent, const glm::mat4& local)
+{
+	TransformNode node = (TransformNode)parentNodes.size();
+	int index = (int)indexToHandle.size();
+
+	parentNodes.push_back(parent);
+	handleToIndex.push_back(index);
+
+	indexToHandle.push_back(node);
+	parents.push_back(parent >= 0 ? handleToIndex[parent] : -1);
+	locals.push_back(local);
+	worlds.push_back(local);
+	dirty.push_back(1);
+	changed.push_back(0);
+
+	// A root can go on the end of the first level as long as nothing deeper is there yet. Anything else has to wait for the sort.
+	if (parent < 0 && levelStarts.size() <= 2 && !unsorted)
+	{
+		if (levelStarts.size() == 1)
+		{
+			levelStarts.push_back(0);
+		}
+
+		levelStarts.back() = (int)indexToHandle.size();
+	}
+	else
+	{
+		unsorted = true;
+	}
+
+	return node;
+}
+
+bool TransformHierarchy::SetParent(TransformNode node, TransformNode parent)
+{
+	// Going up from the new parent mustn't come to the node, or it would end up under itself.
+	for (TransformNode above = parent; above >= 0; above = parentNodes[above])
+	{
+		if (above == node)
+		{
+			return false;
+		}
+	}
+
+	if (parentNodes[node] != parent)
+	{
+		parentNodes[node] = parent;
+		unsorted = true;
+	}
+
+	return true;
+}
+
+void TransformHierarchy::sort()
+{
+	int count = (int)parentNodes.size();
+
+	// Each node's depth, by handle. Going up from a node until we find one we already know, then back down, finds each depth once.
+	std::vector<int> depths(count, -1);
+	std::vector<TransformNode> path;
+	int numLevels = 0;
+
+	for (TransformNode node = 0; node < count; node++)
+	{
+		TransformNode above = node;
+
+		while (above >= 0 && depths[above] < 0)
+		{
+			path.push_back(above);
+			above = parentNodes[above];
+		}
+
+		int depth = above >= 0 ? depths[above] : -1;
+
+		while (!path.empty())
+		{
+			depths[path.back()] = ++depth;
+			path.pop_back();
+		}
+
+		numLevels = glm::max(numLevels, depths[node] + 1);
+	}
+
+	// A counting sort by depth, keeping the nodes of each level in the order they were added.
+	levelStarts.assign(numLevels + 1, 0);
+
+	for (int i = 0; i < count; i++)
+	{
+		levelStarts[depths[i] + 1]++;
+	}
+
+	for (int i = 0; i < numLevels; i++)
+	{
+		levelStarts[i + 1] += levelStarts[i];
+	}
+
+	std::vector<int> next(levelStarts.begin(), levelStarts.end() - 1);
+	std::vector<glm::mat4> sortedLocals(count);
+
+	for (TransformNode node = 0; node < count; node++)
+	{
+		int index = next[depths[node]]++;
+
+		sortedLocals[index] = locals[handleToIndex[node]];
+		indexToHandle[index] = node;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		handleToIndex[indexToHandle[i]] = i;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		TransformNode parent = parentNodes[indexToHandle[i]];
+
+		parents[i] = parent >= 0 ? handleToIndex[parent] : -1;
+	}
+
+	locals.swap(sortedLocals);
+	dirty.assign(count, 1);
+
+	unsorted = false;
+}
+
+void TransformHierarchy::Update(JobSystem* jobs)
+{
+	if (unsorted)
+	{
+		sort();
+	}
+
+	for (int level = 0; level < NumLevels(); level++)
+	{
+		int start = levelStarts[level];
+		int count = levelStarts[level + 1] - start;
+
+		// Every node of this level only reads its parent, which is in the level above and already done.
+		auto propagate = [this, start](int begin, int end, int /*thread*/)
+		{
+			for (int i = start + begin; i < start + end; i++)
+			{
+				int parent = parents[i];
+
+				if (!dirty[i] && (parent < 0 || !changed[parent]))
+				{
+					changed[i] = 0;
+					continue;
+				}
+
+				worlds[i] = parent >= 0 ? worlds[parent] * locals[i] : locals[i];
+				dirty[i] = 0;
+				changed[i] = 1;
+			}
+		};
+
+		if (jobs != nullptr && count >= HIERARCHY_GRAIN * 2)
+		{
+			jobs->ParallelFor(count, HIERARCHY_GRAIN, propagate);
+		}
+		else
+		{
+			propagate(0, count, 0);
+		}
+	}
+}
+
+#endif // _TRANSFORM_HIERARCHY_CPP
@@ -0,0 +1,138 @@
+/*
+Title: GJK-3D (OBB)
+File Name: TransformHierarchy.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _TRANSFORM_HIERARCHY_H
+#define _TRANSFORM_HIERARCHY_H
+
+#include "glm\glm.hpp"
+#include <vector>
+
+class JobSystem;
+
+// Refers to one node of a TransformHierarchy. Like a BodyHandle, it stays the same however the nodes get reordered.
+typedef int TransformNode;
+
+// Transforms attached to other transforms (props held by a body, a turret on a tank, the lights on a ship), where each node's world
+// transform is its parent's world transform times its own local one.
+// Walking down from each root and recursing into the children jumps all over memory, and can't be split across threads without sharing
+// out subtrees of very different sizes. Instead, the nodes are kept in one flat array sorted by depth: every root, then every node one
+// below a root, and so on. Each node's parent comes before it, so one pass from the front to the back finishes every parent before any of
+// its children, and every node in one level can be done at the same time, since they only read the level above. So Update goes a level at
+// a time, and splits each level across the threads.
+// Only the nodes whose local transform changed, and the ones under them, are rebuilt. Everything else costs a check of two flags.
+class TransformHierarchy
+{
+	// By handle: each node's parent (or -1 for a root), and where the node is in the arrays below.
+	std::vector<TransformNode> parentNodes;
+	std::vector<int> handleToIndex;
+
+	// By index, sorted by depth. parents[i] is the index of node i's parent (always less than i), or -1.
+	std::vector<int> indexToHandle;
+	std::vector<int> parents;
+	std::vector<glm::mat4> locals;
+	std::vector<glm::mat4> worlds;
+
+	// Whether each node's local transform has changed since the last Update, and whether Update rebuilt its world transform (which is what
+	// tells its children to rebuild theirs). Chars, so that threads working on different nodes don't share bytes.
+	std::vector<unsigned char> dirty;
+	std::vector<unsigned char> changed;
+
+	// Level d is the nodes from levelStarts[d] up to levelStarts[d + 1].
+	std::vector<int> levelStarts;
+
+	// Whether nodes have been added or moved to other parents since the arrays were last sorted. They're only sorted again at the next
+	// Update, so adding lots of nodes at once only sorts them once.
+	bool unsorted;
+
+	// Sorts the arrays by depth again, and marks every node dirty.
+	void sort();
+
+	// Not meant to be copied: it's usually big, and handles into one copy would look like they work in the other.
+	TransformHierarchy(const TransformHierarchy&);
+	TransformHierarchy& operator=(const TransformHierarchy&);
+
+public:
+	TransformHierarchy();
+
+	// Adds a node under parent (or a root, if parent is -1) with the given local transform. Its world transform is there after the next
+	// Update.
+	TransformNode Add(TransformNode parent, const glm::mat4& local);
+
+	// Moves a node (and everything under it) to another parent, or makes it a root with -1. Its local transform stays the same, so it's now
+	// that far from its new parent. Returns false, and leaves it where it was, if the new parent is the node itself or somewhere under it.
+	bool SetParent(TransformNode node, TransformNode parent);
+
+	TransformNode GetParent(TransformNode node) const
+	{
+		return parentNodes[node];
+	}
+
+	// Sets a node's transform relative to its parent (or for a root, its world transform, such as the transform of the body it follows).
+	void SetLocal(TransformNode node, const glm::mat4& local)
+	{
+		int index = handleToIndex[node];
+
+		locals[index] = local;
+		dirty[index] = 1;
+	}
+	const glm::mat4& GetLocal(TransformNode node) const
+	{
+		return locals[handleToIndex[node]];
+	}
+
+	// A node's world transform, as of the last Update.
+	const glm::mat4& GetWorld(TransformNode node) const
+	{
+		return worlds[handleToIndex[node]];
+	}
+
+	int Size() const
+	{
+		return (int)parentNodes.size();
+	}
+
+	// How many levels deep the hierarchy goes (1 if it's all roots), as of the last Update.
+	int NumLevels() const
+	{
+		return (int)levelStarts.size() - 1;
+	}
+
+	// Brings every world transform up to date with the local ones, a level at a time. With jobs, each level big enough to be worth it is
+	// split across every thread (from the thread that owns the job system, outside of any job).
+	void Update(JobSystem* jobs = nullptr);
+};
+
+#endif //_TRANSFORM_HIERARCHY_H
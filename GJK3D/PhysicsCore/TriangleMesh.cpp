@@ -0,0 +1,566 @@
+/*
+Title: GJK-3D (OBB)
+File Name: TriangleMesh.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _TRIANGLE_MESH_CPP
+#define _TRIANGLE_MESH_CPP
+
+#include "TriangleMesh.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// The most triangles a leaf holds. A few to a leaf makes the tree a fraction of the size, and they're next to each other in memory, so
+// checking each one's own box costs hardly more than checking one.
+static const int MAX_LEAF_TRIANGLES = 4;
+
+// The deepest the tree can be. Every split halves the triangles, so this is far more than any mesh will need.
+static const int MAX_DEPTH = 64;
+
+// How many units there are across the mesh (see TriangleMesh::toUnits). 2^30 leaves room for a unit past either end without overflowing an
+// int.
+static const float MESH_UNITS = 1073741824.0f;
+
+// Where the section after one that ends at offset starts.
+static size_t alignSection(size_t offset)
+{
+	return (offset + 15) & ~(size_t)15;
+}
+
+// Whether count items of itemSize bytes, starting offset bytes into a file, are all inside it (and aligned enough to be read in place).
+static bool sectionFits(unsigned int offset, unsigned int count, size_t itemSize, size_t fileSize)
+{
+	return offset % 16 == 0 && offset <= fileSize && count <= (fileSize - offset) / itemSize;
+}
+
+// Writes zeros up to offset (where the next section starts), then size bytes of data.
+static void writeSection(FILE* out, size_t& written, size_t offset, const void* data, size_t size)
+{
+	static const char zeros[16] = {};
+
+	fwrite(zeros, 1, offset - written, out);
+	fwrite(data, 1, size, out);
+	written = offset + size;
+}
+
+TriangleMesh::TriangleMesh()
+{
+	file = nullptr;
+	clear();
+}
+
+TriangleMesh::TriangleMesh(const glm::vec3* positions, int numPositions, const unsigned int* inIndices, int numIndices)
+{
+	file = nullptr;
+	build((const unsigned char*)positions, numPositions, sizeof(glm::vec3), inIndices, numIndices);
+}
+
+TriangleMesh::TriangleMesh(const glm::vec3* positions, int numPositions, int stride, const unsigned int* inIndices, int numIndices)
+{
+	file = nullptr;
+	build((const unsigned char*)positions, numPositions, stride, inIndices, numIndices);
+}
+
+TriangleMesh::TriangleMesh(const TriangleMesh& other)
+{
+	file = nullptr;
+	*this = other;
+}
+
+TriangleMesh& TriangleMesh::operator=(const TriangleMesh& other)
+{
+	if (this == &other)
+	{
+		return *this;
+	}
+
+	// Copied out of whatever arrays other uses, so this works the same for a mapped mesh.
+	std::vector<glm::vec3> copiedVertices(other.vertexData, other.vertexData + other.numVertices);
+	std::vector<unsigned short> copiedShort;
+	std::vector<unsigned int> copiedIndices;
+	std::vector<TriangleMeshNode> copiedNodes(other.nodeData, other.nodeData + other.numNodes);
+
+	if (other.shortIndexData != nullptr)
+	{
+		copiedShort.assign(other.shortIndexData, other.shortIndexData + other.numTriangles * 3);
+	}
+	else if (other.indexData != nullptr)
+	{
+		copiedIndices.assign(other.indexData, other.indexData + other.numTriangles * 3);
+	}
+
+	clear();
+
+	vertices.swap(copiedVertices);
+	shortIndices.swap(copiedShort);
+	indices.swap(copiedIndices);
+	nodes.swap(copiedNodes);
+	numTriangles = other.numTriangles;
+	bounds = other.bounds;
+	unitScale = other.unitScale;
+
+	useOwnArrays();
+
+	return *this;
+}
+
+TriangleMesh::~TriangleMesh()
+{
+	delete file;
+}
+
+void TriangleMesh::clear()
+{
+	delete file;
+	file = nullptr;
+
+	std::vector<glm::vec3>().swap(vertices);
+	std::vector<unsigned short>().swap(shortIndices);
+	std::vector<unsigned int>().swap(indices);
+	std::vector<TriangleMeshNode>().swap(nodes);
+
+	numTriangles = 0;
+	bounds = AABB();
+	unitScale = glm::vec3(0.0f);
+
+	useOwnArrays();
+}
+
+void TriangleMesh::useOwnArrays()
+{
+	// Empty vectors give nullptr back from data() or not, depending on the library, so be sure of it (vertexIndex goes by which is null).
+	vertexData = vertices.empty() ? nullptr : vertices.data();
+	shortIndexData = shortIndices.empty() ? nullptr : shortIndices.data();
+	indexData = indices.empty() ? nullptr : indices.data();
+	nodeData = nodes.empty() ? nullptr : nodes.data();
+	numVertices = (int)vertices.size();
+	numNodes = (int)nodes.size();
+}
+
+void TriangleMesh::build(const unsigned char* positions, int numPositions, int stride, const unsigned int* inIndices, int numIndices)
+{
+	clear();
+	vertices.resize(numPositions);
+
+	for (int i = 0; i < numPositions; i++)
+	{
+		vertices[i] = *(const glm::vec3*)(positions + (size_t)i * stride);
+	}
+
+	// Leave off any indices past the last whole triangle, and any triangle with an index that's out of range.
+	std::vector<unsigned int> source;
+	source.reserve(numIndices - numIndices % 3);
+
+	for (int i = 0; i + 2 < numIndices; i += 3)
+	{
+		if (inIndices[i] < (unsigned int)numPositions && inIndices[i + 1] < (unsigned int)numPositions && inIndices[i + 2] < (unsigned int)numPositions)
+		{
+			source.push_back(inIndices[i]);
+			source.push_back(inIndices[i + 1]);
+			source.push_back(inIndices[i + 2]);
+		}
+	}
+
+	int numSource = (int)source.size() / 3;
+
+	std::vector<AABB> triangleBounds(numSource);
+	std::vector<int> order(numSource);
+
+	bounds = AABB();
+
+	for (int i = 0; i < numSource; i++)
+	{
+		glm::vec3 a = vertices[source[i * 3]];
+		glm::vec3 b = vertices[source[i * 3 + 1]];
+		glm::vec3 c = vertices[source[i * 3 + 2]];
+
+		triangleBounds[i] = AABB(glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)));
+		order[i] = i;
+
+		bounds = i == 0 ? triangleBounds[i] : AABB(glm::min(bounds.min, triangleBounds[i].min), glm::max(bounds.max, triangleBounds[i].max));
+	}
+
+	// An axis the mesh is flat along (like a floor's up axis) is all one unit.
+	glm::vec3 size = bounds.max - bounds.min;
+
+	for (int i = 0; i < 3; i++)
+	{
+		unitScale[i] = size[i] > 0.0f ? MESH_UNITS / size[i] : 0.0f;
+	}
+
+	// The leaves put the triangles into indices in the order they're reached.
+	nodes.clear();
+	nodes.reserve(numSource > 0 ? (numSource * 4) / MAX_LEAF_TRIANGLES : 0);
+
+	indices.clear();
+	indices.reserve(source.size());
+	shortIndices.clear();
+	numTriangles = 0;
+
+	if (numSource > 0)
+	{
+		int rootMin[3], rootMax[3];
+		toUnits(bounds, rootMin, rootMax);
+
+		buildNode(order, 0, numSource, triangleBounds, rootMin, rootMax);
+	}
+
+	for (int i = 0; i < numTriangles; i++)
+	{
+		int triangle = order[i];
+
+		indices.push_back(source[triangle * 3]);
+		indices.push_back(source[triangle * 3 + 1]);
+		indices.push_back(source[triangle * 3 + 2]);
+	}
+
+	// Most meshes have few enough vertices for 16 bit indices, which halves the triangles.
+	if (numPositions <= 65536)
+	{
+		shortIndices.assign(indices.begin(), indices.end());
+		std::vector<unsigned int>().swap(indices);
+	}
+
+	useOwnArrays();
+}
+
+bool TriangleMesh::Save(const std::string& fileName, unsigned long long key) const
+{
+	size_t indexSize = shortIndexData != nullptr ? sizeof(unsigned short) : sizeof(unsigned int);
+	const void* indexArray = shortIndexData != nullptr ? (const void*)shortIndexData : (const void*)indexData;
+
+	// Value-initialized, so every field (and the padding) starts out zero.
+	TriangleMeshFileHeader header = TriangleMeshFileHeader();
+	memcpy(header.magic, TRIANGLE_MESH_MAGIC, sizeof(header.magic));
+	header.version = TRIANGLE_MESH_VERSION;
+	header.key = key;
+	header.vertexCount = (unsigned int)numVertices;
+	header.verticesOffset = (unsigned int)alignSection(sizeof(header));
+	header.indexSize = (unsigned int)indexSize;
+	header.triangleCount = (unsigned int)numTriangles;
+	header.indicesOffset = (unsigned int)alignSection(header.verticesOffset + numVertices * sizeof(glm::vec3));
+	header.nodeCount = (unsigned int)numNodes;
+	header.nodesOffset = (unsigned int)alignSection(header.indicesOffset + numTriangles * 3 * indexSize);
+	header.boundsMin = bounds.min;
+	header.boundsMax = bounds.max;
+	header.unitScale = unitScale;
+
+	FILE* out = fopen(fileName.c_str(), "wb");
+
+	if (out == nullptr)
+	{
+		return false;
+	}
+
+	size_t written = 0;
+	writeSection(out, written, 0, &header, sizeof(header));
+	writeSection(out, written, header.verticesOffset, vertexData, numVertices * sizeof(glm::vec3));
+	writeSection(out, written, header.indicesOffset, indexArray, numTriangles * 3 * indexSize);
+	writeSection(out, written, header.nodesOffset, nodeData, numNodes * sizeof(TriangleMeshNode));
+
+	bool succeeded = ferror(out) == 0;
+
+	// The same as HullCache::Save: a half written file would be turned away by Open, but may as well not be left lying around.
+	if (fclose(out) != 0 || !succeeded)
+	{
+		remove(fileName.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool TriangleMesh::Open(const std::string& fileName, unsigned long long key)
+{
+	MappedFile* opened = new MappedFile();
+
+	if (!opened->Open(fileName) || opened->GetSize() < sizeof(TriangleMeshFileHeader))
+	{
+		delete opened;
+		return false;
+	}
+
+	const char* data = opened->GetData();
+	size_t size = opened->GetSize();
+	const TriangleMeshFileHeader* header = (const TriangleMeshFileHeader*)data;
+
+	bool valid = memcmp(header->magic, TRIANGLE_MESH_MAGIC, sizeof(header->magic)) == 0 && header->version == TRIANGLE_MESH_VERSION &&
+		header->key == key && (header->indexSize == sizeof(unsigned short) || header->indexSize == sizeof(unsigned int)) &&
+		header->vertexCount <= 0x7fffffff && header->triangleCount <= 0x7fffffff / 3 && header->nodeCount <= 0x7fffffff &&
+		sectionFits(header->verticesOffset, header->vertexCount, sizeof(glm::vec3), size) &&
+		sectionFits(header->indicesOffset, header->triangleCount * 3, header->indexSize, size) &&
+		sectionFits(header->nodesOffset, header->nodeCount, sizeof(TriangleMeshNode), size);
+
+	const unsigned short* shortArray = (const unsigned short*)(data + header->indicesOffset);
+	const unsigned int* indexArray = (const unsigned int*)(data + header->indicesOffset);
+	const TriangleMeshNode* nodeArray = (const TriangleMeshNode*)(data + header->nodesOffset);
+
+	// A query trusts the indices and nodes completely, so check that every index is a vertex, and walk the tree the way a query does,
+	// checking that every leaf's triangles are in the mesh, and every subtree is inside its parent's and no deeper than a query can go.
+	for (unsigned int i = 0; valid && i < header->triangleCount * 3; i++)
+	{
+		unsigned int vertex = header->indexSize == sizeof(unsigned short) ? shortArray[i] : indexArray[i];
+		valid = vertex < header->vertexCount;
+	}
+
+	int ends[MAX_DEPTH + 1];
+	int depth = 1;
+	ends[0] = (int)header->nodeCount;
+
+	for (int i = 0; valid && i < (int)header->nodeCount; i++)
+	{
+		while (i >= ends[depth - 1])
+		{
+			depth--;
+		}
+
+		const TriangleMeshNode& node = nodeArray[i];
+
+		if (node.count > 0)
+		{
+			valid = node.index >= 0 && (unsigned int)node.index + node.count <= header->triangleCount;
+		}
+		else
+		{
+			valid = node.index > 1 && node.index <= ends[depth - 1] - i && depth <= MAX_DEPTH;
+
+			if (valid)
+			{
+				ends[depth] = i + node.index;
+				depth++;
+			}
+		}
+	}
+
+	if (!valid)
+	{
+		delete opened;
+		return false;
+	}
+
+	clear();
+
+	file = opened;
+	vertexData = header->vertexCount > 0 ? (const glm::vec3*)(data + header->verticesOffset) : nullptr;
+	shortIndexData = header->triangleCount > 0 && header->indexSize == sizeof(unsigned short) ? shortArray : nullptr;
+	indexData = header->triangleCount > 0 && header->indexSize == sizeof(unsigned int) ? indexArray : nullptr;
+	nodeData = header->nodeCount > 0 ? nodeArray : nullptr;
+	numVertices = (int)header->vertexCount;
+	numTriangles = (int)header->triangleCount;
+	numNodes = (int)header->nodeCount;
+	bounds = AABB(header->boundsMin, header->boundsMax);
+	unitScale = header->unitScale;
+
+	return true;
+}
+
+void TriangleMesh::toUnits(const AABB& box, int* min, int* max) const
+{
+	for (int i = 0; i < 3; i++)
+	{
+		// Clamped, so that a box bigger than the mesh can't overflow, and never below zero, so the cast rounds down.
+		float low = glm::clamp((box.min[i] - bounds.min[i]) * unitScale[i], 0.0f, MESH_UNITS);
+		float high = glm::clamp((box.max[i] - bounds.min[i]) * unitScale[i], 0.0f, MESH_UNITS);
+
+		min[i] = (int)low;
+		max[i] = (int)high + 1;
+	}
+}
+
+void TriangleMesh::buildNode(std::vector<int>& order, int first, int count, const std::vector<AABB>& triangleBounds, const int* parentMin,
+	const int* parentMax)
+{
+	int index = (int)nodes.size();
+	nodes.push_back(TriangleMeshNode());
+
+	AABB nodeBounds = triangleBounds[order[first]];
+	glm::vec3 centerMin = nodeBounds.min + nodeBounds.max;
+	glm::vec3 centerMax = centerMin;
+
+	for (int i = first + 1; i < first + count; i++)
+	{
+		const AABB& box = triangleBounds[order[i]];
+
+		nodeBounds.min = glm::min(nodeBounds.min, box.min);
+		nodeBounds.max = glm::max(nodeBounds.max, box.max);
+		centerMin = glm::min(centerMin, box.min + box.max);
+		centerMax = glm::max(centerMax, box.max + box.min);
+	}
+
+	// Find the slices of the parent the node's sides are in: the last slice that starts at or before its minimum, and the first that ends
+	// at or after its maximum. (Its box in units is inside the parent's, since the parent's was made to hold every triangle's.)
+	int unitMin[3], unitMax[3];
+	int steppedMin[3], steppedMax[3];
+
+	toUnits(nodeBounds, unitMin, unitMax);
+
+	for (int i = 0; i < 3; i++)
+	{
+		long long parentSize = parentMax[i] - parentMin[i];
+		int low = parentSize > 0 ? (int)(((long long)(unitMin[i] - parentMin[i]) << 8) / parentSize) : 0;
+		int high = parentSize > 0 ? (int)(((long long)(unitMax[i] - parentMin[i]) << 8) / parentSize) - 1 : 0;
+
+		low = glm::clamp(low, 0, 255);
+		high = glm::clamp(high, 0, 255);
+
+		while (low > 0 && sliceMin(parentMin[i], parentMax[i], low) > unitMin[i])
+		{
+			low--;
+		}
+
+		while (high < 255 && sliceMax(parentMin[i], parentMax[i], high) < unitMax[i])
+		{
+			high++;
+		}
+
+		nodes[index].min[i] = (unsigned char)low;
+		nodes[index].max[i] = (unsigned char)high;
+
+		// The children's slices are of this node's box as its slices give it, which is what a query will have to work from.
+		steppedMin[i] = sliceMin(parentMin[i], parentMax[i], low);
+		steppedMax[i] = sliceMax(parentMin[i], parentMax[i], high);
+	}
+
+	if (count <= MAX_LEAF_TRIANGLES)
+	{
+		// The leaves are reached in order, so the triangles in order[0] up to order[first] are already in earlier leaves, and these are next.
+		nodes[index].count = (unsigned short)count;
+		nodes[index].index = first;
+		numTriangles = first + count;
+
+		return;
+	}
+
+	// Split the triangles in half along the axis their centers are most spread out on. (The centers are doubled here, which doesn't change
+	// their order.)
+	glm::vec3 spread = centerMax - centerMin;
+	int axis = spread.x >= spread.y && spread.x >= spread.z ? 0 : (spread.y >= spread.z ? 1 : 2);
+	int half = count / 2;
+
+	std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count, [&](int a, int b)
+	{
+		return triangleBounds[a].min[axis] + triangleBounds[a].max[axis] < triangleBounds[b].min[axis] + triangleBounds[b].max[axis];
+	});
+
+	buildNode(order, first, half, triangleBounds, steppedMin, steppedMax);
+	buildNode(order, first + half, count - half, triangleBounds, steppedMin, steppedMax);
+
+	nodes[index].count = 0;
+	nodes[index].index = (int)nodes.size() - index;
+}
+
+void TriangleMesh::Query(const AABB& box, std::vector<int>& found) const
+{
+	if (numNodes == 0 || !bounds.Overlaps(box))
+	{
+		return;
+	}
+
+	int queryMin[3], queryMax[3];
+	toUnits(box, queryMin, queryMax);
+
+	// Each node's slices are of its parent's box, so keep the boxes of the nodes we've stepped into on the way down to the one we're at, with
+	// where each one's subtree ends. The mesh's own box is at the bottom, for the root.
+	QueryLevel levels[MAX_DEPTH + 1];
+	int depth = 1;
+
+	toUnits(bounds, levels[0].min, levels[0].max);
+	levels[0].end = numNodes;
+
+	// Walk the nodes in order, stepping into each one the box overlaps, and over the whole subtree of each one it doesn't.
+	int i = 0;
+
+	while (i < numNodes)
+	{
+		while (i >= levels[depth - 1].end)
+		{
+			depth--;
+		}
+
+		const TriangleMeshNode& node = nodeData[i];
+		const QueryLevel& parent = levels[depth - 1];
+
+		int nodeMin[3], nodeMax[3];
+		bool overlaps = true;
+
+		for (int j = 0; j < 3 && overlaps; j++)
+		{
+			nodeMin[j] = sliceMin(parent.min[j], parent.max[j], node.min[j]);
+			nodeMax[j] = sliceMax(parent.min[j], parent.max[j], node.max[j]);
+
+			overlaps = nodeMin[j] <= queryMax[j] && nodeMax[j] >= queryMin[j];
+		}
+
+		if (!overlaps)
+		{
+			i += node.count > 0 ? 1 : node.index;
+		}
+		else if (node.count > 0)
+		{
+			// Only hand back the triangles whose own boxes overlap.
+			for (int triangle = node.index; triangle < node.index + node.count; triangle++)
+			{
+				const glm::vec3& a = vertexData[vertexIndex(triangle, 0)];
+				const glm::vec3& b = vertexData[vertexIndex(triangle, 1)];
+				const glm::vec3& c = vertexData[vertexIndex(triangle, 2)];
+
+				if (AABB(glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c))).Overlaps(box))
+				{
+					found.push_back(triangle);
+				}
+			}
+
+			i++;
+		}
+		else
+		{
+			QueryLevel& level = levels[depth];
+
+			for (int j = 0; j < 3; j++)
+			{
+				level.min[j] = nodeMin[j];
+				level.max[j] = nodeMax[j];
+			}
+
+			level.end = i + node.index;
+			depth++;
+			i++;
+		}
+	}
+}
+
+#endif //_TRIANGLE_MESH_CPP
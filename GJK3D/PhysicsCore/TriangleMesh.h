@@ -0,0 +1,291 @@
+/*
+Title: GJK-3D (OBB)
+File Name: TriangleMesh.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _TRIANGLE_MESH_H
+#define _TRIANGLE_MESH_H
+
+#include "AABB.h"
+#include "EPA.h"
+#include "ShapePairs.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+// One node of a TriangleMesh's tree. Its bounds are stored as 8 bit steps across its parent's bounds (or the mesh's, for the root): the
+// parent is cut into 256 slices along each axis, and min and max are the slices the node's sides are in, so they only ever get a little
+// bigger. That makes a node 12 bytes instead of 28, and 256 slices is still plenty, since they're slices of the parent rather than the whole
+// mesh: a node deep in the tree is cut about as finely as the triangles near it are apart.
+// The nodes are laid out depth first, so a node's first child is right after it. A leaf (count above 0) holds count triangles, from triangle
+// index on, which are stored next to each other. For any other node, index is how many nodes its subtree takes up, so a query that misses
+// it can skip straight past all of them.
+struct TriangleMeshNode
+{
+	unsigned char min[3];
+	unsigned char max[3];
+	unsigned short count;
+	int index;
+};
+
+// A triangle mesh file is this header, then the mesh's vertices, indices (16 or 32 bit, whichever it uses) and nodes, exactly as TriangleMesh
+// keeps them. Every section starts on a 16 byte boundary, and says where it is in bytes from the start of the file (never as a pointer), so
+// the file can be mapped anywhere and the mesh used straight out of it.
+static const char TRIANGLE_MESH_MAGIC[4] = { 'G', 'J', 'K', 'T' };
+static const unsigned int TRIANGLE_MESH_VERSION = 1;
+
+struct TriangleMeshFileHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned long long key;		// Whatever the mesh was saved with (see HullCache::GetTriangleMesh), so a file for another mesh isn't used.
+	unsigned int vertexCount;
+	unsigned int verticesOffset;
+	unsigned int indexSize;		// 2 or 4 bytes.
+	unsigned int triangleCount;
+	unsigned int indicesOffset;
+	unsigned int nodeCount;
+	unsigned int nodesOffset;
+	unsigned int padding;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	glm::vec3 unitScale;
+	unsigned int padding2;
+};
+
+// A static triangle mesh, for level geometry: floors, walls, terrain, anything that doesn't move and isn't convex, so can't be a GJK shape
+// as a whole (and would otherwise have to be split up into convex pieces ahead of time). Every triangle is a convex shape on its own,
+// though, so a convex body is tested against the mesh by finding the triangles near it with a tree over them, and running GJK on just
+// those, which costs about the log of the number of triangles rather than all of them.
+// The mesh is in world space, and copies the vertices and indices it's built from, so they don't have to stay around.
+// It's built to be small, since level meshes are big and a query mostly waits on memory: besides the 8 bit bounds, each leaf holds a few
+// triangles, and a mesh of up to 65536 vertices keeps its indices in 16 bits. All together it takes about a third of the memory it would
+// with float bounds, a triangle to a leaf and 32 bit indices. The triangles are stored in the order the tree reaches them (so the ones a
+// query finds are mostly next to each other), which means they're numbered in that order too, not the order they were built from.
+// A mesh can be saved to a file (see TriangleMeshFileHeader) and opened again, which maps the file and uses it where it is, rather than
+// reading it in or building the tree again, so a level's collision loads in about the time it takes to open a file.
+class TriangleMesh
+{
+	// What a built mesh keeps its arrays in. A mesh opened from a file leaves these empty.
+	std::vector<glm::vec3> vertices;
+	std::vector<unsigned short> shortIndices;
+	std::vector<unsigned int> indices;
+	std::vector<TriangleMeshNode> nodes;
+
+	// The arrays the mesh uses, wherever they are: the ones above, or the file's. There are three indices to a triangle, and only one kind
+	// is used: 16 bit if every vertex fits, and 32 bit if not (the other is nullptr).
+	const glm::vec3* vertexData;
+	const unsigned short* shortIndexData;
+	const unsigned int* indexData;
+	const TriangleMeshNode* nodeData;
+	int numVertices;
+	int numTriangles;
+	int numNodes;
+
+	// The file an opened mesh is in, which stays mapped until the mesh goes away (or is built or opened again).
+	MappedFile* file;
+
+	// The box around the whole mesh, and how many units there are per unit of distance along each axis (see toUnits).
+	AABB bounds;
+	glm::vec3 unitScale;
+
+	// The nodes' boxes are worked out in whole units, 2^30 of them across the mesh along each axis, rather than in floats. That way a node's
+	// box comes out of its parent's exactly the same way every time, with no rounding, so if the build says a box is inside another, a query
+	// agrees.
+	// This turns a box into units, rounding the minimum down and the maximum up. (The same box always turns into the same units, and a
+	// bigger box never turns into fewer, which is all the tree needs.)
+	void toUnits(const AABB& box, int* min, int* max) const;
+
+	// Where a node's sides are, in units, from its parent's side (between low and high along the same axis) and the slice they're in.
+	// The first slice starts exactly at low, and the last one ends exactly at high.
+	static int sliceMin(int low, int high, int slice)
+	{
+		return low + (int)(((long long)(high - low) * slice) >> 8);
+	}
+	static int sliceMax(int low, int high, int slice)
+	{
+		return low + (int)(((long long)(high - low) * (slice + 1) + 255) >> 8);
+	}
+
+	// Builds the nodes for the triangles in order[first] up to (not including) order[first + count], inside a parent with the given box
+	// in units (as its slices give it, not its real bounds).
+	void buildNode(std::vector<int>& order, int first, int count, const std::vector<AABB>& triangleBounds, const int* parentMin,
+		const int* parentMax);
+
+	// A node a query has stepped into: its box in units, and where its subtree ends.
+	struct QueryLevel
+	{
+		int min[3];
+		int max[3];
+		int end;
+	};
+
+	// The number of the vertex at a triangle's corner.
+	unsigned int vertexIndex(int triangle, int corner) const
+	{
+		return shortIndexData == nullptr ? indexData[triangle * 3 + corner] : shortIndexData[triangle * 3 + corner];
+	}
+
+	void build(const unsigned char* positions, int numPositions, int stride, const unsigned int* inIndices, int numIndices);
+
+	// Points the arrays the mesh uses at the ones it keeps itself.
+	void useOwnArrays();
+
+	// Throws away the mesh, and closes its file if it has one.
+	void clear();
+
+public:
+	TriangleMesh();
+
+	// Builds the mesh from a list of positions and indices, three to a triangle (such as a SceneModel's).
+	TriangleMesh(const glm::vec3* positions, int numPositions, const unsigned int* inIndices, int numIndices);
+
+	// The same, but with each position stride bytes after the last, for vertices that hold more than a position (such as a Model's
+	// VertexFormats, where positions would be &vertices[0].position and stride sizeof(VertexFormat)).
+	TriangleMesh(const glm::vec3* positions, int numPositions, int stride, const unsigned int* inIndices, int numIndices);
+
+	// A copy always keeps its own arrays, even of a mesh that was opened from a file.
+	TriangleMesh(const TriangleMesh& other);
+	TriangleMesh& operator=(const TriangleMesh& other);
+	~TriangleMesh();
+
+	// Writes the mesh to a file that Open can map, with key in its header. Returns false if it can't be written.
+	bool Save(const std::string& fileName, unsigned long long key = 0) const;
+
+	// Maps a file written by Save and uses the mesh in it, replacing this one. Returns false (and leaves the mesh as it was) if it can't be
+	// opened, or isn't a triangle mesh file of this version saved with key, or is broken. Checking it costs a pass over the indices and
+	// nodes, so that a bad file can't send a query out of bounds, but nothing is copied or built.
+	bool Open(const std::string& fileName, unsigned long long key = 0);
+
+	// Whether the mesh is in a mapped file, rather than arrays of its own.
+	bool IsMapped() const
+	{
+		return file != nullptr;
+	}
+
+	int NumTriangles() const
+	{
+		return numTriangles;
+	}
+
+	TriangleShape GetTriangle(int triangle) const
+	{
+		return TriangleShape(vertexData[vertexIndex(triangle, 0)], vertexData[vertexIndex(triangle, 1)], vertexData[vertexIndex(triangle, 2)]);
+	}
+
+	const AABB& GetBounds() const
+	{
+		return bounds;
+	}
+
+	int NumNodes() const
+	{
+		return numNodes;
+	}
+
+	// How much memory the vertices, triangles and tree take up, in bytes (whether the mesh keeps them itself or they're mapped).
+	size_t GetBytes() const
+	{
+		return numVertices * sizeof(glm::vec3) + numTriangles * 3 * (shortIndexData != nullptr ? sizeof(unsigned short) : sizeof(unsigned int)) +
+			numNodes * sizeof(TriangleMeshNode);
+	}
+
+	// Finds the triangles whose boxes overlap box, and adds their numbers to found.
+	void Query(const AABB& box, std::vector<int>& found) const;
+};
+
+// What a shape touching a TriangleMesh touches: which triangle, and EPA's answer for the pair (with the triangle as A, so the normal points
+// from the mesh into the shape).
+struct TriangleMeshContact
+{
+	int triangle;
+	EPAResult contact;
+};
+
+// Tests any convex shape against a mesh (a TriangleMesh, or anything else with the same Query and GetTriangle, like a HeightField): only
+// the triangles whose boxes overlap the shape's run GJK. Returns true as soon as one of them
+// collides, with its number in triangle (if that isn't nullptr). found is just somewhere to put the triangles near the shape, which is worth
+// keeping around between calls.
+template<typename Mesh, typename Shape>
+bool TestMesh(GJKSolver& solver, const Mesh& mesh, const Shape& shape, std::vector<int>& found, int* triangle = nullptr)
+{
+	found.clear();
+	mesh.Query(getBoundsFromSupport(shape), found);
+
+	for (int i = 0; i < (int)found.size(); i++)
+	{
+		if (solver.TestGJK(mesh.GetTriangle(found[i]), shape))
+		{
+			if (triangle)
+			{
+				*triangle = found[i];
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Finds every triangle of a mesh (of either kind) a convex shape is touching, and adds a contact for each to contacts. Returns how many it
+// added. A box lying on a finely cut up mesh can touch dozens of triangles, so keep them with ContactManifold::AddReduced.
+template<typename Mesh, typename Shape>
+int CollideMesh(GJKSolver& solver, EPASolver& epa, const Mesh& mesh, const Shape& shape, std::vector<int>& found,
+	std::vector<TriangleMeshContact>& contacts)
+{
+	int added = 0;
+
+	found.clear();
+	mesh.Query(getBoundsFromSupport(shape), found);
+
+	for (int i = 0; i < (int)found.size(); i++)
+	{
+		TriangleShape triangle = mesh.GetTriangle(found[i]);
+		TriangleMeshContact contact;
+
+		if (solver.TestGJK(triangle, shape) && epa.Penetration(triangle, shape, solver.GetSimplex(), contact.contact))
+		{
+			contact.triangle = found[i];
+			contacts.push_back(contact);
+			added++;
+		}
+	}
+
+	return added;
+}
+
+#endif //_TRIANGLE_MESH_H
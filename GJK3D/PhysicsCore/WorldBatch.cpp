@@ -0,0 +1,511 @@
+/*
+Title: GJK-3D (OBB)
+File Name: WorldBatch.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _WORLD_BATCH_CPP
+#define _WORLD_BATCH_CPP
+
+#include "WorldBatch.h"
+#include <cfloat>
+
+// The same tolerances as TestBoxesSAT's (see ShapePairs.cpp), so a pair of boxes gets the same normal either way.
+static const float SAT_PARALLEL_EPSILON = 1e-5f;
+static const float SAT_EDGE_RELATIVE_TOLERANCE = 0.95f;
+static const float SAT_EDGE_ABSOLUTE_TOLERANCE = 0.01f;
+
+// How many groups of worlds a job steps, when Step is given a JobSystem.
+static const int GROUP_GRAIN = 16;
+
+// Three Lanes: a vector in each of LANE_COUNT worlds.
+struct LaneVector
+{
+	Lanes x, y, z;
+};
+
+static inline LaneVector loadVector(const float* x, const float* y, const float* z)
+{
+	LaneVector vector = { laneLoad(x), laneLoad(y), laneLoad(z) };
+	return vector;
+}
+static inline void storeVector(float* x, float* y, float* z, const LaneVector& vector)
+{
+	laneStore(x, vector.x);
+	laneStore(y, vector.y);
+	laneStore(z, vector.z);
+}
+static inline Lanes dot(const LaneVector& a, const LaneVector& b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+static inline LaneVector scale(const LaneVector& a, const Lanes& s)
+{
+	LaneVector vector = { a.x * s, a.y * s, a.z * s };
+	return vector;
+}
+
+// If a < b, the vector we found along this axis (flipped to point from A to B when distance is negative) becomes the best, in each world.
+static inline void pickAxis(const Lanes& a, const Lanes& b, const LaneVector& axis, const Lanes& distance, LaneVector& best)
+{
+	Lanes zero = laneSet(0.0f);
+
+	best.x = laneSelectLess(a, b, laneSelectLess(distance, zero, -axis.x, axis.x), best.x);
+	best.y = laneSelectLess(a, b, laneSelectLess(distance, zero, -axis.y, axis.y), best.y);
+	best.z = laneSelectLess(a, b, laneSelectLess(distance, zero, -axis.z, axis.z), best.z);
+}
+
+WorldBatch::WorldBatch(int worldCount)
+{
+	numWorlds = worldCount;
+	stride = (worldCount + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+	numBodies = 0;
+	restitution = 0.0f;
+	restitutionThreshold = 0.1f;
+
+	contacts.resize(stride, 0);
+}
+
+int WorldBatch::AddBox(const glm::vec3& boxHalfExtents, float inverseMass)
+{
+	halfExtents.push_back(boxHalfExtents);
+	inverseMasses.push_back(inverseMass);
+	numBodies++;
+
+	// Every world's copy starts at the origin, at rest, with no rotation. (The padding worlds past the end too, so they never hold garbage.)
+	int size = numBodies * stride;
+
+	positionX.resize(size, 0.0f);
+	positionY.resize(size, 0.0f);
+	positionZ.resize(size, 0.0f);
+	velocityX.resize(size, 0.0f);
+	velocityY.resize(size, 0.0f);
+	velocityZ.resize(size, 0.0f);
+	accelerationX.resize(size, 0.0f);
+	accelerationY.resize(size, 0.0f);
+	accelerationZ.resize(size, 0.0f);
+	orientationW.resize(size, 1.0f);
+	orientationX.resize(size, 0.0f);
+	orientationY.resize(size, 0.0f);
+	orientationZ.resize(size, 0.0f);
+	angularX.resize(size, 0.0f);
+	angularY.resize(size, 0.0f);
+	angularZ.resize(size, 0.0f);
+
+	for (int i = 0; i < 9; i++)
+	{
+		axes[i].resize(size, 0.0f);
+	}
+
+	return numBodies - 1;
+}
+
+void WorldBatch::Step(float dt, JobSystem* jobs)
+{
+	int groups = stride / LANE_COUNT;
+
+	if (jobs == nullptr)
+	{
+		for (int group = 0; group < groups; group++)
+		{
+			stepGroup(group * LANE_COUNT, dt);
+		}
+
+		return;
+	}
+
+	auto stepGroups = [this, dt](int begin, int end, int /*thread*/)
+	{
+		for (int group = begin; group < end; group++)
+		{
+			stepGroup(group * LANE_COUNT, dt);
+		}
+	};
+
+	jobs->ParallelFor(groups, GROUP_GRAIN, stepGroups);
+}
+
+void WorldBatch::stepGroup(int first, float dt)
+{
+	Lanes step = laneSet(dt);
+	Lanes halfStep = laneSet(dt * 0.5f);
+
+	for (int world = first; world < first + LANE_COUNT; world++)
+	{
+		contacts[world] = 0;
+	}
+
+	// Speed the boxes up, and work out their axes. (Boxes that can't move are never written to.)
+	for (int body = 0; body < numBodies; body++)
+	{
+		int i = index(first, body);
+
+		if (inverseMasses[body] > 0.0f)
+		{
+			LaneVector velocity = loadVector(&velocityX[i], &velocityY[i], &velocityZ[i]);
+			LaneVector acceleration = loadVector(&accelerationX[i], &accelerationY[i], &accelerationZ[i]);
+
+			velocity.x = velocity.x + acceleration.x * step;
+			velocity.y = velocity.y + acceleration.y * step;
+			velocity.z = velocity.z + acceleration.z * step;
+
+			storeVector(&velocityX[i], &velocityY[i], &velocityZ[i], velocity);
+		}
+
+		// The columns of the orientation's rotation matrix, the same as glm::mat3_cast gives.
+		Lanes w = laneLoad(&orientationW[i]);
+		Lanes x = laneLoad(&orientationX[i]);
+		Lanes y = laneLoad(&orientationY[i]);
+		Lanes z = laneLoad(&orientationZ[i]);
+		Lanes one = laneSet(1.0f);
+		Lanes two = laneSet(2.0f);
+
+		laneStore(&axes[0][i], one - two * (y * y + z * z));
+		laneStore(&axes[1][i], two * (x * y + w * z));
+		laneStore(&axes[2][i], two * (x * z - w * y));
+		laneStore(&axes[3][i], two * (x * y - w * z));
+		laneStore(&axes[4][i], one - two * (x * x + z * z));
+		laneStore(&axes[5][i], two * (y * z + w * x));
+		laneStore(&axes[6][i], two * (x * z + w * y));
+		laneStore(&axes[7][i], two * (y * z - w * x));
+		laneStore(&axes[8][i], one - two * (x * x + y * y));
+	}
+
+	// Every pair, in the order the boxes were added, with each pair seeing what the ones before it did.
+	for (int a = 0; a < numBodies; a++)
+	{
+		for (int b = a + 1; b < numBodies; b++)
+		{
+			if (inverseMasses[a] + inverseMasses[b] > 0.0f)
+			{
+				collidePair(first, a, b);
+			}
+		}
+	}
+
+	// Move the boxes, and turn them (the same way BodyStore does, with the renormalization done every time rather than when the length has
+	// drifted, since the check would cost as much as doing it).
+	for (int body = 0; body < numBodies; body++)
+	{
+		if (inverseMasses[body] <= 0.0f)
+		{
+			continue;
+		}
+
+		int i = index(first, body);
+		LaneVector position = loadVector(&positionX[i], &positionY[i], &positionZ[i]);
+		LaneVector velocity = loadVector(&velocityX[i], &velocityY[i], &velocityZ[i]);
+
+		position.x = position.x + velocity.x * step;
+		position.y = position.y + velocity.y * step;
+		position.z = position.z + velocity.z * step;
+
+		storeVector(&positionX[i], &positionY[i], &positionZ[i], position);
+
+		LaneVector spin = scale(loadVector(&angularX[i], &angularY[i], &angularZ[i]), halfStep);
+		Lanes w = laneLoad(&orientationW[i]);
+		Lanes x = laneLoad(&orientationX[i]);
+		Lanes y = laneLoad(&orientationY[i]);
+		Lanes z = laneLoad(&orientationZ[i]);
+
+		// q += (0, spin) * q
+		Lanes newW = w - (spin.x * x + spin.y * y + spin.z * z);
+		Lanes newX = x + spin.x * w + spin.y * z - spin.z * y;
+		Lanes newY = y + spin.y * w + spin.z * x - spin.x * z;
+		Lanes newZ = z + spin.z * w + spin.x * y - spin.y * x;
+
+		Lanes lengthSquared = newW * newW + newX * newX + newY * newY + newZ * newZ;
+		Lanes renormalize = (laneSet(3.0f) - lengthSquared) * laneSet(0.5f);
+
+		laneStore(&orientationW[i], newW * renormalize);
+		laneStore(&orientationX[i], newX * renormalize);
+		laneStore(&orientationY[i], newY * renormalize);
+		laneStore(&orientationZ[i], newZ * renormalize);
+	}
+}
+
+void WorldBatch::collidePair(int first, int a, int b)
+{
+	int indexA = index(first, a);
+	int indexB = index(first, b);
+	Lanes zero = laneSet(0.0f);
+
+	// The separating axis test from TestBoxesSAT, in every world at once. There's no stopping at the first axis that separates the boxes,
+	// since that's a different axis in each world: every axis is tried, and the smallest overlap along any of them says whether the boxes are
+	// touching. r[i][j] is B's axis j along A's axis i, and t is B's center in A's frame.
+	LaneVector axisA[3];
+	LaneVector axisB[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		axisA[i] = loadVector(&axes[i * 3][indexA], &axes[i * 3 + 1][indexA], &axes[i * 3 + 2][indexA]);
+		axisB[i] = loadVector(&axes[i * 3][indexB], &axes[i * 3 + 1][indexB], &axes[i * 3 + 2][indexB]);
+	}
+
+	LaneVector positionA = loadVector(&positionX[indexA], &positionY[indexA], &positionZ[indexA]);
+	LaneVector positionB = loadVector(&positionX[indexB], &positionY[indexB], &positionZ[indexB]);
+	LaneVector offset = { positionB.x - positionA.x, positionB.y - positionA.y, positionB.z - positionA.z };
+	Lanes t[3];
+	Lanes r[3][3];
+	Lanes absR[3][3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		t[i] = dot(offset, axisA[i]);
+
+		for (int j = 0; j < 3; j++)
+		{
+			r[i][j] = dot(axisA[i], axisB[j]);
+			absR[i][j] = laneAbs(r[i][j]) + laneSet(SAT_PARALLEL_EPSILON);
+		}
+	}
+
+	const glm::vec3& extentsA = halfExtents[a];
+	const glm::vec3& extentsB = halfExtents[b];
+	Lanes best = laneSet(FLT_MAX);
+	LaneVector normal = axisA[0];
+
+	// A's face normals.
+	for (int i = 0; i < 3; i++)
+	{
+		Lanes radiusB = laneSet(extentsB[0]) * absR[i][0] + laneSet(extentsB[1]) * absR[i][1] + laneSet(extentsB[2]) * absR[i][2];
+		Lanes overlap = laneSet(extentsA[i]) + radiusB - laneAbs(t[i]);
+
+		pickAxis(overlap, best, axisA[i], t[i], normal);
+
+		best = laneMin(best, overlap);
+	}
+
+	// B's face normals.
+	for (int j = 0; j < 3; j++)
+	{
+		Lanes radiusA = laneSet(extentsA[0]) * absR[0][j] + laneSet(extentsA[1]) * absR[1][j] + laneSet(extentsA[2]) * absR[2][j];
+		Lanes distance = t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j];
+		Lanes overlap = radiusA + laneSet(extentsB[j]) - laneAbs(distance);
+
+		pickAxis(overlap, best, axisB[j], distance, normal);
+
+		best = laneMin(best, overlap);
+	}
+
+	Lanes separation = best;
+
+	// Apart along a face normal in every world (the usual case, when the boxes aren't anywhere near each other), so there's no need for the
+	// edges.
+	if (laneLessEqual(zero, separation) == 0)
+	{
+		return;
+	}
+
+	// The edges' cross products, with the same preference for the faces as TestBoxesSAT. Parallel edges get an overlap too big to win.
+	Lanes edgeLimit = best * laneSet(SAT_EDGE_RELATIVE_TOLERANCE) - laneSet(SAT_EDGE_ABSOLUTE_TOLERANCE);
+	Lanes shortest = laneSet(1e-3f);
+
+	for (int i = 0; i < 3; i++)
+	{
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+
+		for (int j = 0; j < 3; j++)
+		{
+			int j1 = (j + 1) % 3;
+			int j2 = (j + 2) % 3;
+
+			Lanes radiusA = laneSet(extentsA[i1]) * absR[i2][j] + laneSet(extentsA[i2]) * absR[i1][j];
+			Lanes radiusB = laneSet(extentsB[j1]) * absR[i][j2] + laneSet(extentsB[j2]) * absR[i][j1];
+			Lanes distance = t[i2] * r[i1][j] - t[i1] * r[i2][j];
+			Lanes overlap = radiusA + radiusB - laneAbs(distance);
+
+			separation = laneMin(separation, overlap);
+
+			Lanes length = laneSqrt(laneMax(laneSet(1.0f) - r[i][j] * r[i][j], zero));
+			Lanes edgeOverlap = laneSelectLess(length, shortest, laneSet(FLT_MAX), overlap / laneMax(length, shortest));
+			Lanes limit = laneMin(best, edgeLimit);
+			Lanes inverseLength = laneSet(1.0f) / laneMax(length, shortest);
+			LaneVector axis = { (axisA[i].y * axisB[j].z - axisA[i].z * axisB[j].y) * inverseLength,
+				(axisA[i].z * axisB[j].x - axisA[i].x * axisB[j].z) * inverseLength,
+				(axisA[i].x * axisB[j].y - axisA[i].y * axisB[j].x) * inverseLength };
+
+			pickAxis(edgeOverlap, limit, axis, distance, normal);
+
+			best = laneSelectLess(edgeOverlap, limit, edgeOverlap, best);
+		}
+	}
+
+	// Which worlds the boxes touch in. (Only real worlds are counted, not the padding past the end.)
+	int touching = laneLessEqual(zero, separation);
+
+	if (first + LANE_COUNT > numWorlds)
+	{
+		touching &= (1 << (numWorlds - first)) - 1;
+	}
+
+	if (touching == 0)
+	{
+		return;
+	}
+
+	for (int bits = touching; bits != 0; bits &= bits - 1)
+	{
+		contacts[first + lowestSetBit(bits)]++;
+	}
+
+	// Push the boxes apart along the normal, each its share of the way by inverse mass, the same as PhysicsWorld::resolve. The worlds where
+	// they aren't touching get a push of nothing.
+	float inverseMassA = inverseMasses[a];
+	float inverseMassB = inverseMasses[b];
+	float inverseMassSum = inverseMassA + inverseMassB;
+	Lanes depth = laneSelectLess(separation, zero, zero, best);
+	Lanes push = depth * laneSet(1.0f / inverseMassSum);
+
+	// Then take out the velocity that's closing them, or bounce it back if it's closing fast enough, the same as a ContactSolver point would
+	// in one iteration.
+	LaneVector velocityA = loadVector(&velocityX[indexA], &velocityY[indexA], &velocityZ[indexA]);
+	LaneVector velocityB = loadVector(&velocityX[indexB], &velocityY[indexB], &velocityZ[indexB]);
+	LaneVector relative = { velocityB.x - velocityA.x, velocityB.y - velocityA.y, velocityB.z - velocityA.z };
+	Lanes closing = dot(relative, normal);
+	Lanes target = laneSelectLess(closing, laneSet(-restitutionThreshold), closing * laneSet(-restitution), zero);
+	Lanes impulse = laneMax(target - closing, zero) * laneSet(1.0f / inverseMassSum);
+
+	impulse = laneSelectLess(separation, zero, zero, impulse);
+
+	if (inverseMassA > 0.0f)
+	{
+		LaneVector move = scale(normal, push * laneSet(inverseMassA));
+		LaneVector change = scale(normal, impulse * laneSet(inverseMassA));
+
+		positionA.x = positionA.x - move.x;
+		positionA.y = positionA.y - move.y;
+		positionA.z = positionA.z - move.z;
+		velocityA.x = velocityA.x - change.x;
+		velocityA.y = velocityA.y - change.y;
+		velocityA.z = velocityA.z - change.z;
+
+		storeVector(&positionX[indexA], &positionY[indexA], &positionZ[indexA], positionA);
+		storeVector(&velocityX[indexA], &velocityY[indexA], &velocityZ[indexA], velocityA);
+	}
+	if (inverseMassB > 0.0f)
+	{
+		LaneVector move = scale(normal, push * laneSet(inverseMassB));
+		LaneVector change = scale(normal, impulse * laneSet(inverseMassB));
+
+		positionB.x = positionB.x + move.x;
+		positionB.y = positionB.y + move.y;
+		positionB.z = positionB.z + move.z;
+		velocityB.x = velocityB.x + change.x;
+		velocityB.y = velocityB.y + change.y;
+		velocityB.z = velocityB.z + change.z;
+
+		storeVector(&positionX[indexB], &positionY[indexB], &positionZ[indexB], positionB);
+		storeVector(&velocityX[indexB], &velocityY[indexB], &velocityZ[indexB], velocityB);
+	}
+}
+
+glm::vec3 WorldBatch::GetPosition(int world, int body) const
+{
+	int i = index(world, body);
+	return glm::vec3(positionX[i], positionY[i], positionZ[i]);
+}
+void WorldBatch::SetPosition(int world, int body, const glm::vec3& position)
+{
+	int i = index(world, body);
+
+	positionX[i] = position.x;
+	positionY[i] = position.y;
+	positionZ[i] = position.z;
+}
+glm::vec3 WorldBatch::GetVelocity(int world, int body) const
+{
+	int i = index(world, body);
+	return glm::vec3(velocityX[i], velocityY[i], velocityZ[i]);
+}
+void WorldBatch::SetVelocity(int world, int body, const glm::vec3& velocity)
+{
+	int i = index(world, body);
+
+	velocityX[i] = velocity.x;
+	velocityY[i] = velocity.y;
+	velocityZ[i] = velocity.z;
+}
+glm::vec3 WorldBatch::GetAcceleration(int world, int body) const
+{
+	int i = index(world, body);
+	return glm::vec3(accelerationX[i], accelerationY[i], accelerationZ[i]);
+}
+void WorldBatch::SetAcceleration(int world, int body, const glm::vec3& acceleration)
+{
+	int i = index(world, body);
+
+	accelerationX[i] = acceleration.x;
+	accelerationY[i] = acceleration.y;
+	accelerationZ[i] = acceleration.z;
+}
+glm::quat WorldBatch::GetOrientation(int world, int body) const
+{
+	int i = index(world, body);
+	return glm::quat(orientationW[i], orientationX[i], orientationY[i], orientationZ[i]);
+}
+void WorldBatch::SetOrientation(int world, int body, const glm::quat& orientation)
+{
+	int i = index(world, body);
+
+	orientationW[i] = orientation.w;
+	orientationX[i] = orientation.x;
+	orientationY[i] = orientation.y;
+	orientationZ[i] = orientation.z;
+}
+glm::vec3 WorldBatch::GetAngularVelocity(int world, int body) const
+{
+	int i = index(world, body);
+	return glm::vec3(angularX[i], angularY[i], angularZ[i]);
+}
+void WorldBatch::SetAngularVelocity(int world, int body, const glm::vec3& angularVelocity)
+{
+	int i = index(world, body);
+
+	angularX[i] = angularVelocity.x;
+	angularY[i] = angularVelocity.y;
+	angularZ[i] = angularVelocity.z;
+}
+
+void WorldBatch::SetAcceleration(const glm::vec3& acceleration)
+{
+	for (int body = 0; body < numBodies; body++)
+	{
+		for (int world = 0; world < numWorlds; world++)
+		{
+			SetAcceleration(world, body, acceleration);
+		}
+	}
+}
+
+#endif // _WORLD_BATCH_CPP
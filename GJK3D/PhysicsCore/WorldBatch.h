@@ -0,0 +1,154 @@
+/*
+Title: GJK-3D (OBB)
+File Name: WorldBatch.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+#ifndef _WORLD_BATCH_H
+#define _WORLD_BATCH_H
+
+#include "JobSystem.h"
+#include "SIMDLanes.h"
+#include "glm\glm.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include <vector>
+
+// Many copies of the same small scene (the same boxes, of the same sizes and masses), stepped together. This is for running thousands of
+// little worlds side by side, like the two cubes of the demo in a reinforcement learning setup, where a PhysicsWorld apiece spends nearly
+// all of its time on the bookkeeping that makes it fast for one big world (broadphase, islands, manifolds) and almost none on the boxes.
+// Since every world has the same boxes, the worlds are interleaved instead: every value is kept as an array over the worlds (body 0's x in
+// world 0, world 1 and so on, then body 1's), so that LANE_COUNT worlds load into registers at once and each step of the simulation works on
+// all of them with the same instructions (see SIMDLanes.h). Every pair of boxes is tested every step, with the same separating axis test as
+// TestBoxesSAT, so this is only for scenes of a handful of boxes; past that, a PhysicsWorld's broadphase wins.
+// The response is simpler than a PhysicsWorld's: each touching pair is pushed apart and its closing velocity taken out (or bounced) once per
+// step, in the order the boxes were added, with no warm starting, sleeping or spin from the contacts, so a tall stack won't settle the way
+// it does in a PhysicsWorld. Two boxes (or a few on a floor) behave the same.
+// The worlds are independent, so Step can spread them over a JobSystem, LANE_COUNT worlds to a piece.
+class WorldBatch
+{
+	int numWorlds;
+	int stride;		// numWorlds rounded up to a whole number of groups, so the last group's loads and stores stay in the arrays.
+	int numBodies;
+
+	// The scene: each box's half extents and inverse mass (0 for one that can't move), the same in every world.
+	std::vector<glm::vec3> halfExtents;
+	std::vector<float> inverseMasses;
+
+	// Body b in world w is at [b * stride + w] in each of these.
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> velocityX, velocityY, velocityZ;
+	std::vector<float> accelerationX, accelerationY, accelerationZ;
+	std::vector<float> orientationW, orientationX, orientationY, orientationZ;
+	std::vector<float> angularX, angularY, angularZ;
+
+	// Each box's axes (the columns of its rotation), worked out from its orientation at the start of the step.
+	std::vector<float> axes[9];
+
+	// How many pairs were touching in each world last step.
+	std::vector<int> contacts;
+
+	float restitution;
+	float restitutionThreshold;
+
+	// Steps the LANE_COUNT worlds starting at first.
+	void stepGroup(int first, float dt);
+
+	// Pushes boxes a and b apart and stops them closing, in the worlds of the group starting at first where they're touching.
+	void collidePair(int first, int a, int b);
+
+	int index(int world, int body) const
+	{
+		return body * stride + world;
+	}
+
+public:
+	// Makes numWorlds empty worlds. Add the boxes next: every world gets every box.
+	WorldBatch(int worldCount);
+
+	// Adds a box to every world, at the origin and at rest, and returns its number (the same in every world). An inverse mass of 0 makes a
+	// box that can't be moved (a floor, say).
+	int AddBox(const glm::vec3& boxHalfExtents, float inverseMass);
+
+	// Moves every world forward by dt. With jobs, the worlds are shared out over its threads.
+	void Step(float dt, JobSystem* jobs = nullptr);
+
+	// How bouncy collisions are, the same as ContactSolver::SetRestitution.
+	void SetRestitution(float inRestitution, float threshold = 0.1f)
+	{
+		restitution = inRestitution;
+		restitutionThreshold = threshold;
+	}
+	float GetRestitution() const
+	{
+		return restitution;
+	}
+
+	int GetWorldCount() const
+	{
+		return numWorlds;
+	}
+	int GetBodyCount() const
+	{
+		return numBodies;
+	}
+	glm::vec3 GetHalfExtents(int body) const
+	{
+		return halfExtents[body];
+	}
+	float GetInverseMass(int body) const
+	{
+		return inverseMasses[body];
+	}
+
+	// How many pairs of boxes were touching in a world during the last step.
+	int GetContactCount(int world) const
+	{
+		return contacts[world];
+	}
+
+	// Each box's state, in one world at a time. (Resetting a world is setting these back.)
+	glm::vec3 GetPosition(int world, int body) const;
+	void SetPosition(int world, int body, const glm::vec3& position);
+	glm::vec3 GetVelocity(int world, int body) const;
+	void SetVelocity(int world, int body, const glm::vec3& velocity);
+	glm::vec3 GetAcceleration(int world, int body) const;
+	void SetAcceleration(int world, int body, const glm::vec3& acceleration);
+	glm::quat GetOrientation(int world, int body) const;
+	void SetOrientation(int world, int body, const glm::quat& orientation);
+	glm::vec3 GetAngularVelocity(int world, int body) const;
+	void SetAngularVelocity(int world, int body, const glm::vec3& angularVelocity);
+
+	// The same acceleration (gravity, usually) for every moving box in every world.
+	void SetAcceleration(const glm::vec3& acceleration);
+};
+
+#endif //_WORLD_BATCH_H
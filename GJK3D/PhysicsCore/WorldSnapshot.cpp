@@ -0,0 +1,489 @@
+/*
+Title: GJK-3D (OBB)
+File Name: WorldSnapshot.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _WORLD_SNAPSHOT_CPP
+#define _WORLD_SNAPSHOT_CPP
+
+#include "WorldSnapshot.h"
+#include "MappedFile.h"
+#include "PhysicsWorld.h"
+#include <cstring>
+
+// Every part of a snapshot is a record: how many bytes it is, and then the bytes. A single value is a record of its own size, and an
+// array a record of some number of its elements.
+static void writeRecord(FILE* file, const void* data, size_t size)
+{
+	unsigned long long bytes = size;
+	fwrite(&bytes, sizeof(bytes), 1, file);
+
+	if (size > 0)
+	{
+		fwrite(data, size, 1, file);
+	}
+}
+
+template<typename T>
+static void writeValue(FILE* file, const T& value)
+{
+	writeRecord(file, &value, sizeof(T));
+}
+
+template<typename Vector>
+static void writeArray(FILE* file, const Vector& values)
+{
+	writeRecord(file, values.data(), values.size() * sizeof(typename Vector::value_type));
+}
+
+// Steps over the next record, returning where its bytes start and how many there are, or false if the file ends first.
+static bool nextRecord(const char*& data, const char* end, const char*& record, unsigned long long& size)
+{
+	if ((size_t)(end - data) < sizeof(size))
+	{
+		return false;
+	}
+
+	memcpy(&size, data, sizeof(size));
+	data += sizeof(size);
+
+	if ((unsigned long long)(end - data) < size)
+	{
+		return false;
+	}
+
+	record = data;
+	data += size;
+
+	return true;
+}
+
+template<typename T>
+static bool readValue(const char*& data, const char* end, T& value)
+{
+	const char* record;
+	unsigned long long size;
+
+	if (!nextRecord(data, end, record, size) || size != sizeof(T))
+	{
+		return false;
+	}
+
+	// (Through void*, since the glm types aren't trivially copyable as far as the compiler knows, even though they're only floats.)
+	memcpy(static_cast<void*>(&value), record, sizeof(T));
+
+	return true;
+}
+
+// The file is mapped, and a record can start anywhere, so the elements are copied out with memcpy rather than read where they are.
+template<typename Vector>
+static bool readArray(const char*& data, const char* end, Vector& values)
+{
+	const char* record;
+	unsigned long long size;
+	size_t elementSize = sizeof(typename Vector::value_type);
+
+	if (!nextRecord(data, end, record, size) || size % elementSize != 0)
+	{
+		return false;
+	}
+
+	values.resize((size_t)(size / elementSize));
+
+	if (size > 0)
+	{
+		memcpy(static_cast<void*>(values.data()), record, (size_t)size);
+	}
+
+	return true;
+}
+
+unsigned int WorldSnapshot::layout()
+{
+	// Any change to the size of something that's stored changes this, so a snapshot from before the change is turned away.
+	const size_t sizes[] =
+	{
+		sizeof(glm::vec3), sizeof(glm::quat), sizeof(glm::mat4), sizeof(BodyHandle), sizeof(BodyType), sizeof(CollisionFilter), sizeof(OBBShape),
+		sizeof(ShapeBounds), sizeof(BroadphasePair), sizeof(AABBTreeNode), sizeof(AABBTree::TrackedPair), sizeof(SAPProxy), sizeof(SAPEndpoint),
+		sizeof(HashGridProxy), sizeof(HashGridSlot), sizeof(HashGridEntry), sizeof(LinearBVHProxy), sizeof(LinearBVHNode), sizeof(QBVHNode),
+		sizeof(PairState)
+	};
+
+	unsigned int hash = 2166136261u;
+
+	for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++)
+	{
+		hash = (hash ^ (unsigned int)sizes[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+bool WorldSnapshot::fail(const std::string& message)
+{
+	error = message;
+
+	return false;
+}
+
+void WorldSnapshot::writeBodies(FILE* file, const BodyStore& bodies)
+{
+	writeArray(file, bodies.positions);
+	writeArray(file, bodies.velocities);
+	writeArray(file, bodies.accelerations);
+	writeArray(file, bodies.inverseMasses);
+	writeArray(file, bodies.orientations);
+	writeArray(file, bodies.angularVelocities);
+	writeArray(file, bodies.scales);
+	writeArray(file, bodies.transforms);
+	writeArray(file, bodies.previousPositions);
+	writeArray(file, bodies.previousOrientations);
+	writeArray(file, bodies.previousScales);
+	writeArray(file, bodies.dirty);
+	writeArray(file, bodies.sleeping);
+	writeArray(file, bodies.types);
+	writeArray(file, bodies.timeScales);
+	writeArray(file, bodies.handleToIndex);
+	writeArray(file, bodies.indexToHandle);
+	writeArray(file, bodies.generations);
+	writeValue(file, bodies.freeSlot);
+}
+
+bool WorldSnapshot::readBodies(const char*& data, const char* end, BodyStore& bodies)
+{
+	return readArray(data, end, bodies.positions) && readArray(data, end, bodies.velocities) && readArray(data, end, bodies.accelerations) &&
+		readArray(data, end, bodies.inverseMasses) && readArray(data, end, bodies.orientations) &&
+		readArray(data, end, bodies.angularVelocities) && readArray(data, end, bodies.scales) && readArray(data, end, bodies.transforms) &&
+		readArray(data, end, bodies.previousPositions) && readArray(data, end, bodies.previousOrientations) &&
+		readArray(data, end, bodies.previousScales) && readArray(data, end, bodies.dirty) && readArray(data, end, bodies.sleeping) &&
+		readArray(data, end, bodies.types) && readArray(data, end, bodies.timeScales) && readArray(data, end, bodies.handleToIndex) &&
+		readArray(data, end, bodies.indexToHandle) && readArray(data, end, bodies.generations) && readValue(data, end, bodies.freeSlot);
+}
+
+// The tree's margins are settings, and its flattened copy only lasts for one FindPairs, so neither is saved.
+void WorldSnapshot::writeTree(FILE* file, const AABBTree& tree)
+{
+	writeArray(file, tree.nodes);
+	writeValue(file, tree.root);
+	writeValue(file, tree.freeList);
+	writeValue(file, tree.proxyCount);
+	writeValue(file, tree.deferInserts);
+	writeArray(file, tree.trackedPairs);
+	writeArray(file, tree.moveBuffer);
+	writeArray(file, tree.moved);
+}
+
+bool WorldSnapshot::readTree(const char*& data, const char* end, AABBTree& tree)
+{
+	return readArray(data, end, tree.nodes) && readValue(data, end, tree.root) && readValue(data, end, tree.freeList) &&
+		readValue(data, end, tree.proxyCount) && readValue(data, end, tree.deferInserts) && readArray(data, end, tree.trackedPairs) &&
+		readArray(data, end, tree.moveBuffer) && readArray(data, end, tree.moved);
+}
+
+void WorldSnapshot::writeSweep(FILE* file, const SweepAndPrune& sweep)
+{
+	writeArray(file, sweep.proxies);
+	writeValue(file, sweep.freeList);
+	writeValue(file, sweep.proxyCount);
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		writeArray(file, sweep.endpoints[axis]);
+	}
+}
+
+bool WorldSnapshot::readSweep(const char*& data, const char* end, SweepAndPrune& sweep)
+{
+	return readArray(data, end, sweep.proxies) && readValue(data, end, sweep.freeList) && readValue(data, end, sweep.proxyCount) &&
+		readArray(data, end, sweep.endpoints[0]) && readArray(data, end, sweep.endpoints[1]) && readArray(data, end, sweep.endpoints[2]);
+}
+
+// Which slot a proxy's cells hash to depends on the cell size, so that goes with them.
+void WorldSnapshot::writeGrid(FILE* file, const HashGrid& grid)
+{
+	writeArray(file, grid.proxies);
+	writeValue(file, grid.freeList);
+	writeValue(file, grid.proxyCount);
+	writeArray(file, grid.slots);
+	writeArray(file, grid.entries);
+	writeValue(file, grid.cellSize);
+}
+
+bool WorldSnapshot::readGrid(const char*& data, const char* end, HashGrid& grid)
+{
+	return readArray(data, end, grid.proxies) && readValue(data, end, grid.freeList) && readValue(data, end, grid.proxyCount) &&
+		readArray(data, end, grid.slots) && readArray(data, end, grid.entries) && readValue(data, end, grid.cellSize);
+}
+
+void WorldSnapshot::writeLinear(FILE* file, const LinearBVH& linear)
+{
+	writeArray(file, linear.proxies);
+	writeValue(file, linear.freeList);
+	writeValue(file, linear.proxyCount);
+	writeArray(file, linear.nodes);
+	writeValue(file, linear.root);
+	writeArray(file, linear.leafBounds);
+	writeArray(file, linear.leafData);
+	writeValue(file, linear.stale);
+}
+
+bool WorldSnapshot::readLinear(const char*& data, const char* end, LinearBVH& linear)
+{
+	return readArray(data, end, linear.proxies) && readValue(data, end, linear.freeList) && readValue(data, end, linear.proxyCount) &&
+		readArray(data, end, linear.nodes) && readValue(data, end, linear.root) && readArray(data, end, linear.leafBounds) &&
+		readArray(data, end, linear.leafData) && readValue(data, end, linear.stale);
+}
+
+void WorldSnapshot::writeFlat(FILE* file, const QBVH& flat)
+{
+	writeArray(file, flat.nodes);
+	writeValue(file, flat.proxyCount);
+}
+
+bool WorldSnapshot::readFlat(const char*& data, const char* end, QBVH& flat)
+{
+	return readArray(data, end, flat.nodes) && readValue(data, end, flat.proxyCount);
+}
+
+void WorldSnapshot::writePairCache(FILE* file, const PairCache& pairCache)
+{
+	writeArray(file, pairCache.keys);
+	writeArray(file, pairCache.states);
+	writeArray(file, pairCache.frames);
+	writeArray(file, pairCache.slots);
+	writeValue(file, pairCache.frame);
+}
+
+bool WorldSnapshot::readPairCache(const char*& data, const char* end, PairCache& pairCache)
+{
+	return readArray(data, end, pairCache.keys) && readArray(data, end, pairCache.states) && readArray(data, end, pairCache.frames) &&
+		readArray(data, end, pairCache.slots) && readValue(data, end, pairCache.frame);
+}
+
+bool WorldSnapshot::Save(const PhysicsWorld& world, const std::string& fileName)
+{
+	FILE* file = fopen(fileName.c_str(), "wb");
+
+	if (file == nullptr)
+	{
+		return fail("Couldn't create " + fileName + ".");
+	}
+
+	WorldSnapshotHeader header;
+	memcpy(header.magic, WORLD_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = WORLD_SNAPSHOT_VERSION;
+	header.layout = layout();
+	header.objectCount = (unsigned int)world.handles.size();
+	header.broadphaseIndex = world.broadphaseIndex;
+
+	fwrite(&header, sizeof(header), 1, file);
+
+	writeBodies(file, world.bodies);
+
+	writeArray(file, world.handles);
+	writeArray(file, world.boxCenters);
+	writeArray(file, world.boxHalfExtents);
+	writeArray(file, world.filters);
+	writeArray(file, world.enabled);
+	writeArray(file, world.disabledTypes);
+	writeArray(file, world.triggers);
+	writeArray(file, world.proxies);
+	writeArray(file, world.shapes);
+	writeArray(file, world.shapeBounds);
+	writeArray(file, world.shapeTransforms);
+	writeArray(file, world.fastObjects);
+	writeArray(file, world.farObjects);
+	writeArray(file, world.shapeMotion);
+	writeArray(file, world.pendingMotion);
+	writeArray(file, world.stillTimes);
+	writeArray(file, world.islandFirst);
+	writeArray(file, world.islandNext);
+	writeArray(file, world.wakeRequests);
+	writeArray(file, world.overlaps);
+	writeValue(file, world.origin);
+	writeValue(file, world.lodSteps);
+	writeValue(file, world.stepsSinceTreeRebuild);
+	writeArray(file, world.stepIntervals);
+	writeArray(file, world.idleSteps);
+	writeValue(file, world.rateSteps);
+
+	// Only the broadphase in use is saved, like in PhysicsWorldState.
+	switch (world.broadphaseIndex)
+	{
+	case 0:
+		writeTree(file, world.treeBroadphase);
+		break;
+	case 1:
+		writeSweep(file, world.sweepBroadphase);
+		break;
+	case 2:
+		writeGrid(file, world.gridBroadphase);
+		break;
+	default:
+		writeLinear(file, world.linearBroadphase);
+		break;
+	}
+
+	writeTree(file, world.staticTree);
+	writeFlat(file, world.staticFlat);
+	writeValue(file, world.staticTreeChanged);
+
+	writePairCache(file, world.pairCache);
+
+	bool failed = ferror(file) != 0;
+
+	if (fclose(file) != 0 || failed)
+	{
+		return fail("Couldn't write all of " + fileName + ".");
+	}
+
+	return true;
+}
+
+bool WorldSnapshot::Load(PhysicsWorld& world, const std::string& fileName)
+{
+	if (world.NumObjects() != 0)
+	{
+		return fail("A snapshot can only be loaded into an empty world.");
+	}
+
+	MappedFile file;
+
+	if (!file.Open(fileName) || file.GetSize() < sizeof(WorldSnapshotHeader))
+	{
+		return fail("Couldn't read " + fileName + ".");
+	}
+
+	WorldSnapshotHeader header;
+	memcpy(&header, file.GetData(), sizeof(header));
+
+	if (memcmp(header.magic, WORLD_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != WORLD_SNAPSHOT_VERSION)
+	{
+		return fail(fileName + " isn't a world snapshot this version can read.");
+	}
+
+	if (header.layout != layout())
+	{
+		return fail(fileName + " was saved by a build that lays the world out differently.");
+	}
+
+	if (header.broadphaseIndex < 0 || header.broadphaseIndex >= PhysicsWorld::NUM_BROADPHASES)
+	{
+		return fail(fileName + " has a broadphase that doesn't exist.");
+	}
+
+	// Pick the broadphase while there's nothing in the world to move over to it.
+	world.SetBroadphase(header.broadphaseIndex);
+
+	const char* data = file.GetData() + sizeof(header);
+	const char* end = file.GetData() + file.GetSize();
+	bool read = readBodies(data, end, world.bodies);
+
+	read = read && readArray(data, end, world.handles) && readArray(data, end, world.boxCenters) && readArray(data, end, world.boxHalfExtents) &&
+		readArray(data, end, world.filters) && readArray(data, end, world.enabled) && readArray(data, end, world.disabledTypes) &&
+		readArray(data, end, world.triggers) && readArray(data, end, world.proxies) && readArray(data, end, world.shapes) &&
+		readArray(data, end, world.shapeBounds) && readArray(data, end, world.shapeTransforms) && readArray(data, end, world.fastObjects) &&
+		readArray(data, end, world.farObjects) && readArray(data, end, world.shapeMotion) && readArray(data, end, world.pendingMotion) &&
+		readArray(data, end, world.stillTimes) && readArray(data, end, world.islandFirst) && readArray(data, end, world.islandNext) &&
+		readArray(data, end, world.wakeRequests) && readArray(data, end, world.overlaps) && readValue(data, end, world.origin) &&
+		readValue(data, end, world.lodSteps) && readValue(data, end, world.stepsSinceTreeRebuild) &&
+		readArray(data, end, world.stepIntervals) && readArray(data, end, world.idleSteps) && readValue(data, end, world.rateSteps);
+
+	switch (header.broadphaseIndex)
+	{
+	case 0:
+		read = read && readTree(data, end, world.treeBroadphase);
+		break;
+	case 1:
+		read = read && readSweep(data, end, world.sweepBroadphase);
+		break;
+	case 2:
+		read = read && readGrid(data, end, world.gridBroadphase);
+		break;
+	default:
+		read = read && readLinear(data, end, world.linearBroadphase);
+		break;
+	}
+
+	read = read && readTree(data, end, world.staticTree) && readFlat(data, end, world.staticFlat) &&
+		readValue(data, end, world.staticTreeChanged) && readPairCache(data, end, world.pairCache);
+
+	// Every array that goes by object has to have been one per object, or the world would read past the end of the short ones.
+	int count = (int)header.objectCount;
+
+	read = read && data == end && (int)world.handles.size() == count && (int)world.boxCenters.size() == count &&
+		(int)world.boxHalfExtents.size() == count && (int)world.filters.size() == count && (int)world.enabled.size() == count &&
+		(int)world.disabledTypes.size() == count && (int)world.triggers.size() == count && (int)world.proxies.size() == count &&
+		(int)world.shapes.size() == count && (int)world.shapeBounds.size() == count && (int)world.shapeTransforms.size() == count &&
+		(int)world.fastObjects.size() == count && (int)world.farObjects.size() == count && (int)world.shapeMotion.size() == count &&
+		(int)world.pendingMotion.size() == count && (int)world.stillTimes.size() == count && (int)world.islandFirst.size() == count &&
+		(int)world.islandNext.size() == count && (int)world.wakeRequests.size() == count && (int)world.stepIntervals.size() == count &&
+		(int)world.idleSteps.size() == count && world.bodies.Size() == count;
+
+	if (!read)
+	{
+		return fail(fileName + " is cut short or doesn't make sense.");
+	}
+
+	// The rest of what the world keeps per object is worked out as it steps, so it only has to start out the way AddBox leaves it.
+	world.transforms.resize(count);
+	world.proxyMoves.assign(count, 0);
+	world.predictMoves.assign(count, 0);
+	world.predictedBounds.assign(count, AABB());
+	world.predictedTravel.assign(count, glm::vec3(0.0f));
+	world.impacted.assign(count, 0);
+	world.islandParents.resize(count);
+	world.islandIds.assign(count, -1);
+	world.islandStillTimes.assign(count, 0.0f);
+	world.islandLast.assign(count, -1);
+	world.solverBodies.assign(count, -1);
+
+	// Hulls are only pointed at, so they aren't saved. The program gives them back with SetHull if it wants them.
+	world.hulls.assign(count, HullShape());
+
+	for (int i = 0; i < count; i++)
+	{
+		world.transforms[i] = &world.bodies.GetTransform(world.handles[i]);
+		world.islandParents[i] = i;
+	}
+
+	world.broadphase->SetFilters(&world.filters);
+	world.staticTree.SetFilters(&world.filters);
+	world.maintenance.Reset();
+	world.clearRayCasts();
+
+	return true;
+}
+
+#endif //_WORLD_SNAPSHOT_CPP
@@ -0,0 +1,115 @@
+/*
+Title: GJK-3D (OBB)
+File Name: WorldSnapshot.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _WORLD_SNAPSHOT_H
+#define _WORLD_SNAPSHOT_H
+
+#include <cstdio>
+#include <string>
+
+class PhysicsWorld;
+class BodyStore;
+class AABBTree;
+class SweepAndPrune;
+class HashGrid;
+class LinearBVH;
+class QBVH;
+class PairCache;
+
+// The binary world snapshot format: a header, and then every array the world is built from, one after another, each starting with how
+// many elements it has and how big each one is (so a snapshot from a build with a different layout is turned away, rather than read wrong).
+// Everything is stored exactly as it is in memory (little-endian), so loading one is a copy per array.
+static const char WORLD_SNAPSHOT_MAGIC[4] = { 'G', 'J', 'K', 'W' };
+static const unsigned int WORLD_SNAPSHOT_VERSION = 2;
+
+struct WorldSnapshotHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned int layout;		// A hash of the sizes of everything stored (see WorldSnapshot::layout).
+	unsigned int objectCount;
+	int broadphaseIndex;
+};
+
+// Saves a world that's been set up (its bodies and boxes, the broadphase in use with its tree already built, the static tree and the pair
+// cache, warm starts and all) to a file, and loads it back into a new world. Loading is a copy per array, with no objects added one at a
+// time, no trees built and no pairs found over again, so a server can start from a snapshot of a level in a fraction of the time it takes
+// to build the level up from its scene. The world carries on from a snapshot exactly as the one it was saved from would have.
+// Like PhysicsWorldState, this is the world and not its settings (sleeping, continuous collision, the solver's and so on), which are set
+// by hand: give the new world the same ones. The previous step's pairs, contacts and events aren't saved either.
+class WorldSnapshot
+{
+	std::string error;
+
+	// Sets error, and returns false.
+	bool fail(const std::string& message);
+
+	// A hash of the sizes of everything that's stored.
+	static unsigned int layout();
+
+	// Each part of the world, written and read in the same order.
+	static void writeBodies(FILE* file, const BodyStore& bodies);
+	static void writeTree(FILE* file, const AABBTree& tree);
+	static void writeSweep(FILE* file, const SweepAndPrune& sweep);
+	static void writeGrid(FILE* file, const HashGrid& grid);
+	static void writeLinear(FILE* file, const LinearBVH& linear);
+	static void writeFlat(FILE* file, const QBVH& flat);
+	static void writePairCache(FILE* file, const PairCache& pairCache);
+
+	static bool readBodies(const char*& data, const char* end, BodyStore& bodies);
+	static bool readTree(const char*& data, const char* end, AABBTree& tree);
+	static bool readSweep(const char*& data, const char* end, SweepAndPrune& sweep);
+	static bool readGrid(const char*& data, const char* end, HashGrid& grid);
+	static bool readLinear(const char*& data, const char* end, LinearBVH& linear);
+	static bool readFlat(const char*& data, const char* end, QBVH& flat);
+	static bool readPairCache(const char*& data, const char* end, PairCache& pairCache);
+
+public:
+	// Writes the world to fileName. Returns false if it can't be written. GetError says why.
+	bool Save(const PhysicsWorld& world, const std::string& fileName);
+
+	// Reads a snapshot into world, which has to be empty (with nothing added to it yet). Returns false if the file can't be read or isn't a
+	// snapshot this build can read, which leaves the world as it was, or if the file is cut short, which leaves it half loaded, to be thrown
+	// away.
+	bool Load(PhysicsWorld& world, const std::string& fileName);
+
+	const std::string& GetError() const
+	{
+		return error;
+	}
+};
+
+#endif //_WORLD_SNAPSHOT_H
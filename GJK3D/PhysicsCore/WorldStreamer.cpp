@@ -0,0 +1,348 @@
+/*
+Title: GJK-3D (OBB)
+File Name: WorldStreamer.cpp
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _WORLD_STREAMER_CPP
+#define _WORLD_STREAMER_CPP
+
+#include "WorldStreamer.h"
+#include "PhysicsWorld.h"
+#include <algorithm>
+
+WorldStreamer::WorldStreamer(PhysicsWorld& inWorld) : world(inWorld)
+{
+	loadDistance = 100.0f;
+	unloadDistance = 150.0f;
+	insertLimit = 1000;
+	activeBodies = 0;
+	pendingLoads = 0;
+	stopping = false;
+}
+
+WorldStreamer::~WorldStreamer()
+{
+	if (loader.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		wake.notify_one();
+		loader.join();
+	}
+
+	// Whatever was still waiting to be read (or collected) has its scene in its request.
+	for (int i = 0; i < (int)requests.size(); i++)
+	{
+		delete requests[i].scene;
+	}
+
+	for (int i = 0; i < (int)finished.size(); i++)
+	{
+		delete finished[i].scene;
+	}
+
+	// (A region that's being read doesn't own its scene yet; its request does.)
+	for (int i = 0; i < (int)regions.size(); i++)
+	{
+		if (regions[i].state == REGION_INSERTING)
+		{
+			delete regions[i].scene;
+		}
+	}
+
+	for (int i = 0; i < (int)freeScenes.size(); i++)
+	{
+		delete freeScenes[i];
+	}
+}
+
+int WorldStreamer::AddRegion(const std::string& fileName, const AABB& bounds)
+{
+	Region region;
+	region.fileName = fileName;
+	region.bounds = bounds;
+	region.state = REGION_UNLOADED;
+	region.scene = nullptr;
+	region.inserted = 0;
+
+	regions.push_back(region);
+
+	return (int)regions.size() - 1;
+}
+
+void WorldStreamer::loaderLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (true)
+	{
+		wake.wait(lock, [this]() { return stopping || !requests.empty(); });
+
+		if (stopping)
+		{
+			return;
+		}
+
+		LoadRequest request = requests.front();
+		requests.erase(requests.begin());
+
+		// The file is read without the lock, so Update can carry on asking for more (and collecting what's done) in the meantime.
+		lock.unlock();
+		request.loaded = request.scene->LoadBinary(request.fileName);
+		lock.lock();
+
+		finished.push_back(request);
+		loaded.notify_all();
+	}
+}
+
+void WorldStreamer::WaitForLoads()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	loaded.wait(lock, [this]() { return (int)finished.size() == pendingLoads; });
+}
+
+int WorldStreamer::insertBody(const SceneBody& body)
+{
+	BodyStore& store = world.Bodies();
+	int object;
+
+	// The regions are in the coordinates the world started out in, which may not be where its origin is now.
+	glm::vec3 position = glm::vec3(glm::dvec3(body.position) - world.GetOrigin());
+
+	if (freeObjects.empty())
+	{
+		// Made where it goes, so its proxy is made there too.
+		object = world.AddBox(body.center, body.halfExtents, position, body.orientation, body.scale);
+	}
+	else
+	{
+		// A disabled object from a region that was unloaded. Everything about it is set again while it's still disabled, so its proxy is
+		// only made once, where it goes, when it's enabled.
+		object = freeObjects.back();
+		freeObjects.pop_back();
+
+		BodyHandle handle = world.GetBody(object);
+
+		store.Position(handle) = position;
+		store.Orientation(handle) = body.orientation;
+		store.Scale(handle) = body.scale;
+		store.MarkDirty(handle);
+
+		world.SetBox(object, body.center, body.halfExtents);
+		world.SetCollisionFilter(object, CollisionFilter());
+		world.SetTrigger(object, false);
+	}
+
+	BodyHandle handle = world.GetBody(object);
+
+	world.SetBodyType(object, body.inverseMass > 0.0f ? BODY_DYNAMIC : BODY_STATIC);
+
+	store.Velocity(handle) = body.velocity;
+	store.Acceleration(handle) = body.acceleration;
+	store.InverseMass(handle) = body.inverseMass;
+
+	world.SetEnabled(object, true);
+
+	return object;
+}
+
+void WorldStreamer::unload(int index)
+{
+	Region& region = regions[index];
+
+	for (int i = 0; i < (int)region.objects.size(); i++)
+	{
+		world.SetEnabled(region.objects[i], false);
+		freeObjects.push_back(region.objects[i]);
+	}
+
+	activeBodies -= (int)region.objects.size();
+	region.objects.clear();
+
+	if (region.scene != nullptr)
+	{
+		freeScenes.push_back(region.scene);
+		region.scene = nullptr;
+	}
+
+	if (region.state == REGION_INSERTING)
+	{
+		inserting.erase(std::find(inserting.begin(), inserting.end(), index));
+	}
+
+	region.state = REGION_UNLOADED;
+	region.inserted = 0;
+}
+
+void WorldStreamer::Update(const glm::vec3& focus)
+{
+	// Pick up whatever the loading thread has finished reading.
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		arrived.swap(finished);
+	}
+
+	pendingLoads -= (int)arrived.size();
+
+	for (int i = 0; i < (int)arrived.size(); i++)
+	{
+		const LoadRequest& request = arrived[i];
+		Region& region = regions[request.region];
+
+		// It was unloaded while it was being read (and may have been asked for again since, in which case that load is still to come).
+		if (region.state != REGION_LOADING || region.scene != request.scene)
+		{
+			freeScenes.push_back(request.scene);
+		}
+		else if (!request.loaded)
+		{
+			region.state = REGION_FAILED;
+			region.error = request.scene->GetError();
+			region.scene = nullptr;
+
+			freeScenes.push_back(request.scene);
+		}
+		else
+		{
+			region.state = REGION_INSERTING;
+			inserting.push_back(request.region);
+
+			// Make room for all of it at once, rather than growing the world's arrays a few times over as its bodies go in.
+			int needed = (int)region.scene->bodies.size() - (int)freeObjects.size();
+
+			if (needed > 0)
+			{
+				world.Reserve(world.NumObjects() + needed);
+			}
+		}
+	}
+
+	arrived.clear();
+
+	// Load what's close, and unload what's far. (The regions' bounds don't move with the world's origin, so the distances are worked out
+	// in the coordinates they're in, in doubles.)
+	std::vector<LoadRequest> newRequests;
+	glm::dvec3 point = glm::dvec3(focus) + world.GetOrigin();
+
+	for (int i = 0; i < (int)regions.size(); i++)
+	{
+		Region& region = regions[i];
+
+		glm::dvec3 closest = glm::clamp(point, glm::dvec3(region.bounds.min), glm::dvec3(region.bounds.max));
+		float distance = (float)glm::length(point - closest);
+
+		if (region.state == REGION_UNLOADED && distance <= loadDistance)
+		{
+			if (freeScenes.empty())
+			{
+				freeScenes.push_back(new Scene());
+			}
+
+			region.state = REGION_LOADING;
+			region.scene = freeScenes.back();
+			freeScenes.pop_back();
+
+			LoadRequest request;
+			request.region = i;
+			request.fileName = region.fileName;
+			request.scene = region.scene;
+			request.loaded = false;
+
+			newRequests.push_back(request);
+		}
+		else if (region.state == REGION_LOADING && distance > unloadDistance)
+		{
+			// The loading thread has its scene, and hands it back when it's done with it.
+			region.state = REGION_UNLOADED;
+			region.scene = nullptr;
+		}
+		else if ((region.state == REGION_INSERTING || region.state == REGION_LOADED) && distance > unloadDistance)
+		{
+			unload(i);
+		}
+	}
+
+	if (!newRequests.empty())
+	{
+		if (!loader.joinable())
+		{
+			loader = std::thread(&WorldStreamer::loaderLoop, this);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			requests.insert(requests.end(), newRequests.begin(), newRequests.end());
+		}
+
+		pendingLoads += (int)newRequests.size();
+		wake.notify_one();
+	}
+
+	// Then add the next batch of bodies, oldest region first. Each one goes straight into its broadphase (the static ones into the static
+	// tree, which is rebuilt once at the start of the next step however many went in), and the AABB tree's regular rebuild tidies up after
+	// the ones that went in one at a time (see PhysicsWorld::SetTreeRebuildInterval).
+	int budget = insertLimit;
+
+	while (budget > 0 && !inserting.empty())
+	{
+		Region& region = regions[inserting.front()];
+		int count = std::min(budget, (int)region.scene->bodies.size() - region.inserted);
+
+		for (int i = 0; i < count; i++)
+		{
+			region.objects.push_back(insertBody(region.scene->bodies[region.inserted + i]));
+		}
+
+		region.inserted += count;
+		activeBodies += count;
+		budget -= count;
+
+		if (region.inserted == (int)region.scene->bodies.size())
+		{
+			region.state = REGION_LOADED;
+
+			freeScenes.push_back(region.scene);
+			region.scene = nullptr;
+
+			inserting.erase(inserting.begin());
+		}
+	}
+}
+
+#endif //_WORLD_STREAMER_CPP
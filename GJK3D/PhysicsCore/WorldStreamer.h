@@ -0,0 +1,208 @@
+/*
+Title: GJK-3D (OBB)
+File Name: WorldStreamer.h
+Copyright  2015
+Original authors: Brockton Roth
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This is a Gilbert-Johnson-Keerthi test. (Called GJK for short.) This is in 3D.
+Contains two cubes, one that is stationary and one that is moving. They are bounded
+by OBBs (Object-Oriented Bounding Boxes) and when these OBBs collide the moving object
+"bounces" on the x axis (because that is the only direction the object is moving).
+The algorithm will detect any axis of collision, but will not output the axis that was
+collided (because it doesn't know). Thus, we assume x and hardcode in the x axis bounce.
+There is a physics timestep such that every update runs at the same delta time, regardless
+of how fast or slow the computer is running. The cubes would be the exact same as their OBBs,
+since they are aligned on the same axis.
+*/
+
+
+#ifndef _WORLD_STREAMER_H
+#define _WORLD_STREAMER_H
+
+#include "AABB.h"
+#include "SceneFile.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PhysicsWorld;
+
+// Where a region is in being streamed in or out.
+enum RegionState
+{
+	REGION_UNLOADED,	// None of it is in the world.
+	REGION_LOADING,		// Its file is being read on the loading thread.
+	REGION_INSERTING,	// Its file has been read, and its bodies are being added to the world a batch at a time.
+	REGION_LOADED,		// All of its bodies are in the world.
+	REGION_FAILED		// Its file couldn't be read (see WorldStreamer::GetRegionError). It isn't tried again.
+};
+
+// Streams the bodies of a big world in and out around a point (the player, or the camera), so that only the area around it is ever in the
+// PhysicsWorld: the memory and the cost of a step go with how much is nearby, not with the size of the whole level.
+// The world is split into regions, each a binary scene file (see Scene::SaveBinary) and the bounds its bodies are in. Once a region comes
+// within the load distance of the point it's read on a thread of the streamer's own, so the step never waits on the disk, and once it's
+// been read its bodies are added to the world over the next few updates, no more than the insert limit each time, so a big region doesn't
+// make for one long step. A region is taken out again once it's further than the unload distance, which is further than the load
+// distance so that moving back and forth across the edge doesn't keep loading and unloading it.
+// Objects can't be removed from a world, so an unloaded region's objects are disabled (see PhysicsWorld::SetEnabled), and used again for
+// the next region's bodies. The world only ever has as many objects as were in at once.
+// The regions' files and bounds are in the coordinates the world started out in, and stay there if the world's origin is moved (see
+// PhysicsWorld::ShiftOrigin): the bodies are put in wherever the origin is by then, and the focus is in the world's coordinates as usual.
+// Bodies with no mass (see SceneBody) are made static, so a region's level geometry goes in the static tree. Which step a region's bodies
+// turn up in depends on how long its file took to read, so a streamed world isn't deterministic from one run to the next (but a recording
+// of one still plays back exactly; see SimulationRecorder).
+class WorldStreamer
+{
+	struct Region
+	{
+		std::string fileName;
+		AABB bounds;
+		RegionState state;
+		std::string error;
+
+		// Once it's been read, its bodies, and how many of them have been added so far.
+		Scene* scene;
+		int inserted;
+
+		// The objects its bodies went into.
+		std::vector<int> objects;
+	};
+
+	// A file for the loading thread to read, and what came of it.
+	struct LoadRequest
+	{
+		int region;
+		std::string fileName;
+		Scene* scene;
+		bool loaded;
+	};
+
+	PhysicsWorld& world;
+
+	std::vector<Region> regions;
+
+	// The regions whose bodies are being added, in the order they finished loading.
+	std::vector<int> inserting;
+
+	// The disabled objects that are free to be used again.
+	std::vector<int> freeObjects;
+
+	float loadDistance;
+	float unloadDistance;
+	int insertLimit;
+	int activeBodies;
+
+	// The scenes that aren't in use, kept (with their memory) for the next loads.
+	std::vector<Scene*> freeScenes;
+
+	// The loading thread takes requests in the order they're made, and hands them back once they're read. It's only started once there's
+	// something to load.
+	std::thread loader;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable loaded;
+	std::vector<LoadRequest> requests;
+	std::vector<LoadRequest> finished;
+	int pendingLoads;
+	bool stopping;
+
+	// Used by Update, so each one doesn't allocate.
+	std::vector<LoadRequest> arrived;
+
+	void loaderLoop();
+
+	// Adds a body to the world, in a free object if there is one, and returns its object.
+	int insertBody(const SceneBody& body);
+
+	// Takes a region's bodies back out of the world (or stops them being added), and puts its scene back.
+	void unload(int index);
+
+	// Can't be copied, since it owns a thread.
+	WorldStreamer(const WorldStreamer&);
+	WorldStreamer& operator=(const WorldStreamer&);
+
+public:
+	// Streams regions in and out of world, which has to outlive the streamer.
+	WorldStreamer(PhysicsWorld& inWorld);
+	~WorldStreamer();
+
+	// Adds a region: a binary scene file, and the bounds its bodies are in. Returns its index. Regions start out unloaded.
+	int AddRegion(const std::string& fileName, const AABB& bounds);
+
+	// How close the point has to be to a region's bounds for it to be loaded, and how far away for it to be unloaded again. They're 100 and
+	// 150 to begin with.
+	void SetDistances(float load, float unload)
+	{
+		loadDistance = load;
+		unloadDistance = glm::max(load, unload);
+	}
+
+	// The most bodies each Update adds to the world. It's 1000 to begin with.
+	void SetInsertLimit(int bodies)
+	{
+		insertLimit = glm::max(1, bodies);
+	}
+
+	// Loads the regions near focus and unloads the ones far from it, and adds the next batch of bodies from the regions that have been
+	// read. Call this between steps, on the thread that steps the world.
+	void Update(const glm::vec3& focus);
+
+	// Waits for the loading thread to finish reading every region it's been asked to (for a benchmark, or to load the first area before
+	// the world starts). The next Update starts adding them.
+	void WaitForLoads();
+
+	int NumRegions() const
+	{
+		return (int)regions.size();
+	}
+	RegionState GetRegionState(int region) const
+	{
+		return regions[region].state;
+	}
+
+	// The objects a region's bodies have been added as so far (in the order they're in its file).
+	const std::vector<int>& GetRegionObjects(int region) const
+	{
+		return regions[region].objects;
+	}
+
+	// Why a region's file couldn't be read.
+	const std::string& GetRegionError(int region) const
+	{
+		return regions[region].error;
+	}
+
+	// How many of the world's objects are streamed bodies that are in it right now.
+	int GetActiveBodies() const
+	{
+		return activeBodies;
+	}
+
+	// Whether any region is still being read or added.
+	bool IsBusy() const
+	{
+		return pendingLoads > 0 || !inserting.empty();
+	}
+};
+
+#endif //_WORLD_STREAMER_H